@@ -32,7 +32,9 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "App.h"
+#include "Archive/ArchiveBenchmark.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryDataCache.h"
 #include "Game/Configuration.h"
 #include "General/Clipboard.h"
 #include "General/ColourConfiguration.h"
@@ -47,6 +49,9 @@
 #include "Graphics/Palette/PaletteManager.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "MainEditor/MainEditor.h"
+#include "MapEditor/MapBackupManager.h"
+#include "MapEditor/MapBenchmark.h"
+#include "MapEditor/MapEditor.h"
 #include "MapEditor/NodeBuilders.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
@@ -58,7 +63,9 @@
 #include "UI/Dialogs/SetupWizard/SetupWizardDialog.h"
 #include "UI/SBrush.h"
 #include "UI/WxUtils.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 #include "thirdparty/dumb/dumb.h"
 #include <filesystem>
@@ -78,6 +85,19 @@ int             temp_fail_count = 0;
 bool            init_ok         = false;
 bool            exiting         = false;
 std::thread::id main_thread_id;
+string          batch_script;     // Lua script to run in batch mode (see runBatch)
+string          benchmark_report; // File to write benchmark results to in batch mode
+vector<string>  benchmark_paths;  // Archives to benchmark
+
+// Startup timing (see initPhaseDone)
+struct InitPhase
+{
+	string name;
+	long   time; // Time taken in ms
+};
+vector<InitPhase> init_phases;
+std::mutex        init_phases_mutex;
+long              init_phase_end = 0;
 
 // Version
 Version version_num{ 3, 2, 0, 3 };
@@ -323,12 +343,41 @@ vector<string> processCommandLine(vector<string>& args)
 	vector<string> to_open;
 
 	// Process command line args (except the first as it is normally the executable name)
-	for (auto& arg : args)
+	for (unsigned a = 0; a < args.size(); ++a)
 	{
+		auto& arg = args[a];
+
 		// -nosplash: Disable splash window
 		if (strutil::equalCI(arg, "-nosplash"))
 			ui::enableSplash(false);
 
+		// -batch <script>: Run a lua script without any UI, then exit
+		else if (strutil::equalCI(arg, "-batch") || strutil::equalCI(arg, "--batch"))
+		{
+			if (a + 1 < args.size())
+			{
+				batch_script = args[++a];
+				ui::enableSplash(false);
+				log::setEchoToStdout(true);
+			}
+			else
+				log::error("No script given for command line parameter \"{}\"", arg);
+		}
+
+		// -benchmark <report file>: Run the archive and map benchmarks (in batch
+		// mode) on any archives given and write the results to the report file
+		else if (strutil::equalCI(arg, "-benchmark") || strutil::equalCI(arg, "--benchmark"))
+		{
+			if (a + 1 < args.size())
+			{
+				benchmark_report = args[++a];
+				ui::enableSplash(false);
+				log::setEchoToStdout(true);
+			}
+			else
+				log::error("No report file given for command line parameter \"{}\"", arg);
+		}
+
 		// -debug: Enable debug mode
 		else if (strutil::equalCI(arg, "-debug"))
 		{
@@ -347,6 +396,105 @@ vector<string> processCommandLine(vector<string>& args)
 
 	return to_open;
 }
+
+// -----------------------------------------------------------------------------
+// Adds init phase [name] taking [time]ms to the startup timings
+// -----------------------------------------------------------------------------
+void addInitPhase(string_view name, long time)
+{
+	std::lock_guard lock(init_phases_mutex);
+	init_phases.push_back({ string{ name }, time });
+	log::info(2, "Startup: {} took {}ms", name, time);
+}
+
+// -----------------------------------------------------------------------------
+// Records init phase [name] as taking the time since the previous phase
+// ended (or the application started)
+// -----------------------------------------------------------------------------
+void initPhaseDone(string_view name)
+{
+	auto now = runTimer();
+	addInitPhase(name, now - init_phase_end);
+	init_phase_end = now;
+}
+
+// -----------------------------------------------------------------------------
+// Starts init phase [name] running [func] as a background job, recording its
+// time when done
+// -----------------------------------------------------------------------------
+shared_ptr<Job> startInitPhase(string_view name, std::function<void()> func)
+{
+	return Job::start([name = fmt::format("{} (background)", name), func = std::move(func)](Job&) {
+		auto start = runTimer();
+		func();
+		addInitPhase(name, runTimer() - start);
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Initialises the parts of SLADE needed to work with archives and maps from a
+// script in batch mode (no UI, OpenGL or main editor), then opens any archives
+// given on the command line ([paths_to_open]), or keeps them to be benchmarked.
+// Continues on from app::init after the program resource has been loaded
+// -----------------------------------------------------------------------------
+bool initBatch(const vector<string>& paths_to_open)
+{
+	// Nodebuilders and game executables are needed for some map/archive
+	// operations, so load them in the background along with everything else
+	vector<shared_ptr<Job>> init_jobs;
+	init_jobs.push_back(startInitPhase("Nodebuilders", []() { nodebuilders::init(); }));
+	init_jobs.push_back(startInitPhase("Game executables", []() { executables::init(); }));
+
+#ifdef USE_LUA
+	// Init lua
+	lua::init();
+#endif
+
+	// Init palettes
+	if (!palette_manager.init())
+	{
+		log::error("Failed to initialise palettes");
+		return false;
+	}
+
+	// Init SImage formats
+	SIFormat::initFormats();
+	initPhaseDone("Palettes and image formats");
+
+	// Load entry types
+	log::info("Loading entry types");
+	EntryType::loadEntryTypes();
+	initPhaseDone("Entry types");
+
+	// Wait for background init
+	for (auto& job : init_jobs)
+		job->wait();
+	initPhaseDone("Waiting for background init");
+
+	// Init game configuration
+	log::info("Loading game configurations");
+	game::init();
+	initPhaseDone("Game configurations");
+
+	// Init base resource
+	log::info("Loading base resource");
+	archive_manager.initBaseResource();
+	initPhaseDone("Base resource");
+
+	// Open any archives from the command line
+	if (benchmark_report.empty())
+	{
+		archive_manager.openArchives(paths_to_open);
+		initPhaseDone("Opening archives");
+	}
+	else
+		benchmark_paths = paths_to_open;
+
+	init_ok = true;
+	log::info("SLADE Batch Mode Initialisation OK ({}ms)", runTimer());
+
+	return true;
+}
 } // namespace slade::app
 
 // -----------------------------------------------------------------------------
@@ -413,6 +561,60 @@ bool app::isExiting()
 	return exiting;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if SLADE was started in batch mode (-batch <script> or
+// -benchmark <report file> on the command line), where there is no UI
+// -----------------------------------------------------------------------------
+bool app::isBatchMode()
+{
+	return !batch_script.empty() || !benchmark_report.empty();
+}
+
+// -----------------------------------------------------------------------------
+// Runs the batch mode script (or benchmarks) and shuts down the application.
+// Returns the process exit code (0 if successful)
+// -----------------------------------------------------------------------------
+int app::runBatch()
+{
+	int result = 1;
+
+	if (!benchmark_report.empty())
+	{
+		log::info("Running archive benchmarks");
+		auto results = benchmark::runArchiveBenchmarks(benchmark_paths);
+		log::info("Running map benchmarks");
+		auto map_results = benchmark::runMapBenchmarks(benchmark_paths);
+		results.insert(results.end(), map_results.begin(), map_results.end());
+
+		auto report = benchmark::formatResults(results);
+		if (fileutil::writeStringToFile(report, benchmark_report))
+		{
+			log::info("Wrote benchmark results to \"{}\"", benchmark_report);
+			result = 0;
+		}
+		else
+			log::error("Unable to write benchmark results to \"{}\"", benchmark_report);
+	}
+#ifdef USE_LUA
+	else
+	{
+		log::info("Running batch script \"{}\"", batch_script);
+		if (lua::runFile(batch_script))
+		{
+			log::info("Batch script completed ({}ms)", runTimer());
+			result = 0;
+		}
+	}
+#else
+	else
+		log::error("Can't run batch script \"{}\", SLADE was built without Lua support", batch_script);
+#endif
+
+	exit(false);
+
+	return result;
+}
+
 // -----------------------------------------------------------------------------
 // Application initialisation
 // -----------------------------------------------------------------------------
@@ -444,6 +646,7 @@ bool app::init(vector<string>& args, double ui_scale)
 	// Load configuration file
 	log::info("Loading configuration");
 	readConfigFile();
+	initPhaseDone("Configuration");
 
 	// Init entry types
 	EntryDataFormat::initBuiltinFormats();
@@ -454,6 +657,12 @@ bool app::init(vector<string>& args, double ui_scale)
 	archive_manager.init();
 	if (!archive_manager.resArchiveOK())
 	{
+		if (isBatchMode())
+		{
+			log::error("Unable to find slade.pk3, make sure it exists in the same directory as the SLADE executable");
+			return false;
+		}
+
 		wxMessageBox(
 			"Unable to find slade.pk3, make sure it exists in the same directory as the "
 			"SLADE executable",
@@ -461,6 +670,18 @@ bool app::init(vector<string>& args, double ui_scale)
 			wxICON_ERROR);
 		return false;
 	}
+	initPhaseDone("Program resource");
+
+	// Batch mode doesn't need any of the UI
+	if (isBatchMode())
+		return initBatch(paths_to_open);
+
+	// Load text languages, nodebuilders and game executables in the background,
+	// they aren't needed until the main editor is created
+	vector<shared_ptr<Job>> init_jobs;
+	init_jobs.push_back(startInitPhase("Text languages", []() { TextLanguage::loadLanguages(); }));
+	init_jobs.push_back(startInitPhase("Nodebuilders", []() { nodebuilders::init(); }));
+	init_jobs.push_back(startInitPhase("Game executables", []() { executables::init(); }));
 
 	// Init SActions
 	SAction::setBaseWxId(26000);
@@ -476,6 +697,7 @@ bool app::init(vector<string>& args, double ui_scale)
 
 	// Show splash screen
 	ui::showSplash("Starting up...");
+	initPhaseDone("UI");
 
 	// Init palettes
 	if (!palette_manager.init())
@@ -489,6 +711,7 @@ bool app::init(vector<string>& args, double ui_scale)
 
 	// Init brushes
 	SBrush::initBrushes();
+	initPhaseDone("Palettes and image formats");
 
 	// Load program icons
 	log::info("Loading icons");
@@ -496,14 +719,12 @@ bool app::init(vector<string>& args, double ui_scale)
 
 	// Load program fonts
 	drawing::initFonts();
+	initPhaseDone("Icons and fonts");
 
 	// Load entry types
 	log::info("Loading entry types");
 	EntryType::loadEntryTypes();
-
-	// Load text languages
-	log::info("Loading text languages");
-	TextLanguage::loadLanguages();
+	initPhaseDone("Entry types");
 
 	// Init text stylesets
 	log::info("Loading text style sets");
@@ -513,24 +734,25 @@ bool app::init(vector<string>& args, double ui_scale)
 	// Init colour configuration
 	log::info("Loading colour configuration");
 	colourconfig::init();
+	initPhaseDone("Styles and colours");
 
-	// Init nodebuilders
-	nodebuilders::init();
-
-	// Init game executables
-	executables::init();
+	// Wait for background init
+	for (auto& job : init_jobs)
+		job->wait();
+	initPhaseDone("Waiting for background init");
 
 	// Init main editor
 	maineditor::init();
+	initPhaseDone("Main editor");
 
-	// Init base resource
-	log::info("Loading base resource");
-	archive_manager.initBaseResource();
-	log::info("Base resource loaded");
+	// Start unloading least recently used entry data when over budget
+	entrycache::init();
 
-	// Init game configuration
+	// Init game configuration (zdoom.pk3 ZScript and MAPINFO are parsed in the
+	// background)
 	log::info("Loading game configurations");
 	game::init();
+	initPhaseDone("Game configurations");
 
 #ifdef USE_LUA
 	// Init script manager
@@ -541,16 +763,23 @@ bool app::init(vector<string>& args, double ui_scale)
 	maineditor::windowWx()->Show(true);
 	wxGetApp().SetTopWindow(maineditor::windowWx());
 	ui::showSplash("Starting up...", false, maineditor::windowWx());
+	initPhaseDone("Main window");
+
+	// Init base resource (after the main window is shown, since it can be large)
+	log::info("Loading base resource");
+	archive_manager.initBaseResource();
+	log::info("Base resource loaded");
+	initPhaseDone("Base resource");
 
 	// Open any archives from the command line
-	for (auto& path : paths_to_open)
-		archive_manager.openArchive(path);
+	archive_manager.openArchives(paths_to_open);
+	initPhaseDone("Opening archives");
 
 	// Hide splash screen
 	ui::hideSplash();
 
 	init_ok = true;
-	log::info("SLADE Initialisation OK");
+	log::info("SLADE Initialisation OK ({}ms)", runTimer());
 
 	// Show Setup Wizard if needed
 	if (!setup_wizard_run)
@@ -667,10 +896,20 @@ void app::exit(bool save_config)
 
 	// Close all open archives
 	archive_manager.closeAll();
+	entrycache::shutdown();
+
+	// Finish writing any map backup (queued tasks aren't run after shutdown)
+	mapeditor::backupManager().waitForBackups();
+
+	// Stop worker threads
+	threadpool::shutdown();
 
 	// Clean up
-	drawing::cleanupFonts();
-	gl::Texture::clearAll();
+	if (!isBatchMode())
+	{
+		drawing::cleanupFonts();
+		gl::Texture::clearAll();
+	}
 
 	// Clear temp folder
 	std::error_code error;
@@ -691,8 +930,12 @@ void app::exit(bool save_config)
 	// Close DUMB
 	dumb_exit();
 
-	// Exit wx Application
-	wxGetApp().Exit();
+	// Write any remaining log messages
+	log::shutdown();
+
+	// Exit wx Application (batch mode exits without starting the main loop)
+	if (!isBatchMode())
+		wxGetApp().Exit();
 }
 
 
@@ -782,3 +1025,11 @@ CONSOLE_COMMAND(setup_wizard, 0, false)
 	SetupWizardDialog dlg(maineditor::windowWx());
 	dlg.ShowModal();
 }
+
+CONSOLE_COMMAND(startup_times, 0, false)
+{
+	std::lock_guard lock(app::init_phases_mutex);
+	for (const auto& phase : app::init_phases)
+		log::console(fmt::format("{}: {}ms", phase.name, phase.time));
+	log::console(fmt::format("Total: {}ms", app::init_phase_end));
+}
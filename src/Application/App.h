@@ -25,6 +25,10 @@ namespace app
 	void saveConfigFile();
 	void exit(bool save_config);
 
+	// Batch mode (headless, runs a script or benchmarks then exits)
+	bool isBatchMode();
+	int  runBatch();
+
 	// Version
 	struct Version
 	{
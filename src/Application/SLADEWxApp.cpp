@@ -60,7 +60,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::global
 {
-string error;
+thread_local string error;
 
 #ifdef GIT_DESCRIPTION
 string sc_rev = GIT_DESCRIPTION;
@@ -246,9 +246,11 @@ public:
 
 		// Last 10 log lines
 		trace_ += "\nLast Log Messages:\n";
-		auto& log = log::history();
-		for (auto a = log.size() - 10; a < log.size(); a++)
-			trace_ += log[a].message + "\n";
+		vector<log::Message> log;
+		auto                 count = log::messageCount();
+		log::history(count > 10 ? count - 10 : 0, log);
+		for (auto& msg : log)
+			trace_ += msg.message + "\n";
 
 		// Add stack trace text area
 		text_stack_ = new wxTextCtrl(
@@ -498,8 +500,15 @@ bool SLADEWxApp::singleInstanceCheck()
 // -----------------------------------------------------------------------------
 bool SLADEWxApp::OnInit()
 {
+	// Check for batch mode, which can run alongside other instances of SLADE
+	bool batch_mode = false;
+	for (int a = 1; a < argc; a++)
+		if (argv[a].IsSameAs("-batch", false) || argv[a].IsSameAs("--batch", false)
+			|| argv[a].IsSameAs("-benchmark", false) || argv[a].IsSameAs("--benchmark", false))
+			batch_mode = true;
+
 	// Check if an instance of SLADE is already running
-	if (!singleInstanceCheck())
+	if (!batch_mode && !singleInstanceCheck())
 	{
 		printf("Found active instance. Quitting.\n");
 		return false;
@@ -509,8 +518,11 @@ bool SLADEWxApp::OnInit()
 	wxSocketBase::Initialize();
 
 	// Start up file listener
-	file_listener_ = new MainAppFileListener();
-	file_listener_->Create("SLADE_MAFL");
+	if (!batch_mode)
+	{
+		file_listener_ = new MainAppFileListener();
+		file_listener_->Create("SLADE_MAFL");
+	}
 
 	// Setup system options
 	wxSystemOptions::SetOption("mac.listctrl.always_use_generic", 1);
@@ -559,6 +571,10 @@ bool SLADEWxApp::OnInit()
 	if (!app::init(args, ui_scale))
 		return false;
 
+	// Nothing else is needed in batch mode, the script or benchmarks are run in OnRun
+	if (app::isBatchMode())
+		return true;
+
 		// Check for updates
 #ifdef __WXMSW__
 	wxHTTP::Initialize();
@@ -574,6 +590,18 @@ bool SLADEWxApp::OnInit()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Runs the application. In batch mode this runs the batch script and exits
+// (with the script result), otherwise it runs the main event loop
+// -----------------------------------------------------------------------------
+int SLADEWxApp::OnRun()
+{
+	if (app::isBatchMode())
+		return app::runBatch();
+
+	return wxApp::OnRun();
+}
+
 // -----------------------------------------------------------------------------
 // Application shutdown, run when program is closed
 // -----------------------------------------------------------------------------
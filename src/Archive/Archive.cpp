@@ -31,10 +31,18 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Archive.h"
+#include "App.h"
+#include "EntryDataReader.h"
+#include "EntryIO.h"
+#include "EntryType/EntryTypeCache.h"
 #include "General/UndoRedo.h"
+#include "Utility/FileUtils.h"
 #include "Utility/Parser.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 #include <filesystem>
+#include <mutex>
+#include <wx/thread.h>
 
 using namespace slade;
 
@@ -46,6 +54,9 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Bool, archive_load_data, false, CVar::Flag::Save)
 CVAR(Bool, backup_archives, true, CVar::Flag::Save)
+CVAR(Bool, archive_map_files, false, CVar::Flag::Save)
+CVAR(Bool, archive_type_cache, true, CVar::Flag::Save)
+CVAR(Int, archive_spill_size, 64, CVar::Flag::Save) // MB of streamed entry data to hold in memory before spilling
 bool                  Archive::save_backup = true;
 vector<ArchiveFormat> Archive::formats_;
 
@@ -267,6 +278,37 @@ private:
 };
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [entry] is directly within [dir], or within any of its
+// subdirectories if [subdirs] is true
+// -----------------------------------------------------------------------------
+bool inSearchDir(ArchiveEntry* entry, ArchiveDir* dir, bool subdirs)
+{
+	auto parent = entry->parentDir();
+	if (parent == dir)
+		return true;
+	if (!subdirs)
+		return false;
+
+	while (parent)
+	{
+		parent = parent->parent().get();
+		if (parent == dir)
+			return true;
+	}
+
+	return false;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Archive::MapDesc Class Functions
@@ -336,6 +378,21 @@ void Archive::MapDesc::updateMapFormatHints() const
 }
 
 
+// -----------------------------------------------------------------------------
+// Entry changes queued (from any thread) for the entries_changed signal, with
+// the index of each entry's change so they can be coalesced
+// -----------------------------------------------------------------------------
+struct Archive::ChangeQueue
+{
+	std::mutex                                             mutex;
+	Archive*                                               archive = nullptr; // Null once the archive is deleted
+	vector<EntryChange>                                    changes;
+	std::unordered_map<shared_ptr<ArchiveEntry>, unsigned> index;
+	bool                                                   blocked       = false;
+	bool                                                   flush_pending = false;
+};
+
+
 // -----------------------------------------------------------------------------
 //
 // Archive Class Functions
@@ -351,8 +408,10 @@ Archive::Archive(string_view format) :
 	on_disk_{ false },
 	read_only_{ false },
 	modified_{ true },
-	dir_root_{ new ArchiveDir("", nullptr, this) }
+	dir_root_{ new ArchiveDir("", nullptr, this) },
+	change_queue_{ std::make_shared<ChangeQueue>() }
 {
+	change_queue_->archive = this;
 }
 
 // -----------------------------------------------------------------------------
@@ -360,9 +419,17 @@ Archive::Archive(string_view format) :
 // -----------------------------------------------------------------------------
 Archive::~Archive()
 {
+	// Don't deliver any queued entry changes
+	{
+		std::lock_guard lock(change_queue_->mutex);
+		change_queue_->archive = nullptr;
+	}
+
 	// Clear out subdir archive pointers in case any are being kept around
 	// (eg. by a running script)
 	dir_root_->setArchive(nullptr);
+
+	removeSpillFiles();
 }
 
 // -----------------------------------------------------------------------------
@@ -370,7 +437,7 @@ Archive::~Archive()
 // -----------------------------------------------------------------------------
 ArchiveFormat Archive::formatDesc() const
 {
-	for (auto fmt : formats_)
+	for (const auto& fmt : formats_)
 		if (fmt.id == format_)
 			return fmt;
 
@@ -445,9 +512,18 @@ string Archive::filename(bool full) const
 // -----------------------------------------------------------------------------
 bool Archive::open(string_view filename)
 {
-	// Read the file into a MemChunk
-	MemChunk mc;
-	if (!mc.importFile(filename))
+	PROFILE_SCOPE("Archive::open");
+
+	// Memory-map the file if enabled and supported by the format
+	MemChunk               mc;
+	shared_ptr<MappedFile> mapping;
+	if (archive_map_files && canMapFile())
+		mapping = MappedFile::map(filename);
+
+	// Otherwise read the file into a MemChunk
+	if (mapping)
+		mc.importMapped(mapping, 0, mapping->size());
+	else if (!mc.importFile(filename))
 	{
 		global::error = "Unable to open file. Make sure it isn't in use by another program.";
 		return false;
@@ -456,18 +532,23 @@ bool Archive::open(string_view filename)
 	// Update filename before opening
 	auto backupname = filename_;
 	filename_       = filename;
+	file_mapping_   = mapping;
 
 	// Load from MemChunk
 	sf::Clock timer;
+	openTypeCache(filename);
 	if (open(mc))
 	{
+		closeTypeCache(true);
 		log::info(2, "Archive::open took {}ms", timer.getElapsedTime().asMilliseconds());
 		on_disk_ = true;
 		return true;
 	}
 	else
 	{
+		closeTypeCache(false);
 		filename_ = backupname;
+		file_mapping_.reset();
 		return false;
 	}
 }
@@ -633,6 +714,8 @@ bool Archive::write(string_view filename, bool update)
 // -----------------------------------------------------------------------------
 bool Archive::save(string_view filename)
 {
+	PROFILE_SCOPE("Archive::save");
+
 	bool success = false;
 
 	// Check if the archive is read-only
@@ -654,7 +737,7 @@ bool Archive::save(string_view filename)
 		if (!filename.empty())
 		{
 			// New filename is given (ie 'save as'), write to new file and change archive filename accordingly
-			success = write(filename);
+			success = file_mapping_ ? writeMapped(filename) : write(filename);
 			if (success)
 				filename_ = filename;
 
@@ -675,7 +758,7 @@ bool Archive::save(string_view filename)
 			}
 
 			// Write it to the file
-			success = write(filename_);
+			success = file_mapping_ ? writeMapped(filename_) : write(filename_);
 
 			// Update variables
 			on_disk_ = true;
@@ -692,6 +775,336 @@ bool Archive::save(string_view filename)
 	return success;
 }
 
+// -----------------------------------------------------------------------------
+// Sets [entry]'s data to a view of [size] bytes at [offset] in the
+// memory-mapped archive file.
+// Returns false if the archive file isn't memory-mapped or the given
+// offset/size are out of bounds
+// -----------------------------------------------------------------------------
+bool Archive::loadMappedEntryData(ArchiveEntry* entry, uint32_t offset, uint32_t size) const
+{
+	if (!file_mapping_ || !checkEntry(entry))
+		return false;
+
+	if (!entry->data_.importMapped(file_mapping_, offset, size))
+		return false;
+
+	entry->setLoaded();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// As above, but [entry]'s data is at [offset] in the memory-mapped data
+// [mapped] (eg. a nested archive's data) rather than the archive file
+// -----------------------------------------------------------------------------
+bool Archive::loadMappedEntryData(ArchiveEntry* entry, const MemChunk& mapped, uint32_t offset, uint32_t size)
+	const
+{
+	if (!mapped.isMapped() || offset + size > mapped.size() || !checkEntry(entry))
+		return false;
+
+	if (!entry->data_.importMapped(mapped.mapping(), mapped.mappedOffset() + offset, size))
+		return false;
+
+	entry->setLoaded();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Imports the data given in chunks by [stream] (eg. as it is decompressed)
+// into [entry]. Once the data grows past archive_spill_size MB it is written
+// to a temp file instead, which is then memory-mapped so that the entry data
+// doesn't need to be held in memory.
+// Returns false if [stream] failed
+// -----------------------------------------------------------------------------
+bool Archive::importStreamed(ArchiveEntry* entry, const std::function<bool(const DataSink&)>& stream)
+{
+	static unsigned spill_count = 0;
+
+	MemChunk data;
+	SFile    spill;
+	string   spill_file;
+	bool     can_spill = archive_spill_size > 0;
+	auto     sink      = [&](const uint8_t* chunk, size_t size)
+	{
+		if (spill.isOpen())
+			return spill.write(chunk, size);
+
+		if (!can_spill || data.size() + size <= static_cast<size_t>(archive_spill_size) * 1024 * 1024)
+			return data.write(chunk, size);
+
+		// Too big to keep in memory, move everything so far to a spill file
+		spill_file = app::path(
+			fmt::format("slade-spill-{}-{}.tmp", wxGetProcessId(), spill_count++), app::Dir::Temp);
+		if (!spill.open(spill_file, SFile::Mode::Write) || !spill.write(data.data(), data.size()))
+		{
+			log::warning("Unable to write spill file {}, keeping data in memory", spill_file);
+			spill.close();
+			fileutil::removeFile(spill_file);
+			can_spill = false;
+			return data.write(chunk, size);
+		}
+		data.clear();
+		return spill.write(chunk, size);
+	};
+
+	auto ok = stream(sink);
+	if (!spill.isOpen())
+	{
+		if (ok && data.hasData())
+			entry->importMemChunk(data);
+		return ok;
+	}
+	spill.close();
+
+	// Map the spill file, or read it back in if that isn't possible
+	shared_ptr<MappedFile> mapping;
+	if (ok)
+		mapping = MappedFile::map(spill_file);
+	if (!mapping)
+	{
+		if (ok)
+			ok = entry->importFile(spill_file);
+		fileutil::removeFile(spill_file);
+		return ok;
+	}
+
+	MemChunk view;
+	view.importMapped(mapping, 0, mapping->size());
+	entry->importMemChunk(view, 0, view.size());
+	spill_files_.push_back(spill_file);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a reader for (unloaded) [entry]'s data at [offset] in the archive
+// file, from the memory-mapped file if possible.
+// Returns null if the archive isn't a file on disk (eg. opened from memory)
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> Archive::fileDataReader(ArchiveEntry* entry, uint32_t offset) const
+{
+	if (!checkEntry(entry) || entry->isLoaded())
+		return nullptr;
+
+	if (file_mapping_)
+	{
+		MemChunk view;
+		if (!view.importMapped(file_mapping_, offset, entry->size()))
+			return nullptr;
+		return std::make_unique<MemDataReader>(view);
+	}
+
+	if (!on_disk_ || filename_.empty())
+		return nullptr;
+
+	auto reader = std::make_unique<FileDataReader>(filename_, offset, entry->size());
+	if (!reader->isOk())
+		return nullptr;
+
+	return reader;
+}
+
+// -----------------------------------------------------------------------------
+// Detects the types of all (loaded) entries in [batch] across worker threads,
+// then unloads their data if archive_load_data is disabled and [allow_unload]
+// is true, and sets them to unmodified. Used when opening archives, where
+// entries are batched up to limit the amount of data loaded at once.
+// [batch] is cleared afterwards so it can be re-used for the next batch
+// -----------------------------------------------------------------------------
+void Archive::detectEntryTypes(vector<ArchiveEntry*>& batch, bool allow_unload) const
+{
+	if (type_cache_)
+		type_cache_->detectEntryTypes(batch);
+	else
+		EntryType::detectEntryTypes(batch);
+
+	for (auto entry : batch)
+	{
+		// Unload entry data if needed
+		if (allow_unload && !archive_load_data)
+			entry->unloadData();
+
+		// Set entry to unchanged
+		entry->setState(ArchiveEntry::State::Unmodified);
+	}
+
+	batch.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Loads the entry type cache for [filename] (if archive_type_cache is enabled),
+// to be used by detectEntryTypes while opening the archive
+// -----------------------------------------------------------------------------
+void Archive::openTypeCache(string_view filename)
+{
+	if (archive_type_cache)
+		type_cache_ = std::make_unique<EntryTypeCache>(filename);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the entry type cache to disk if [save] is true and anything changed,
+// and closes it
+// -----------------------------------------------------------------------------
+void Archive::closeTypeCache(bool save)
+{
+	if (type_cache_ && save)
+		type_cache_->save();
+
+	type_cache_.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [entry] matches the type, name and namespace criteria in
+// [options] (the search directory isn't checked)
+// -----------------------------------------------------------------------------
+bool Archive::matchesSearch(ArchiveEntry* entry, const SearchOptions& options)
+{
+	// Check type
+	if (options.match_type)
+	{
+		if (entry->type() == EntryType::unknownType())
+		{
+			if (!options.match_type->isThisType(*entry))
+				return false;
+		}
+		else if (options.match_type != entry->type())
+			return false;
+	}
+
+	// Check name
+	if (!options.match_name.empty())
+	{
+		// Cut extension if ignoring
+		auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
+		if (!strutil::matches(check_name, options.match_name))
+			return false;
+	}
+
+	// Check namespace
+	if (!options.match_namespace.empty())
+	{
+		if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all entries in the archive that could be of [type] - those of that
+// type and those with an unknown type - in entry tree order
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> Archive::typeSearchCandidates(EntryType* type) const
+{
+	if (!type_index_valid_)
+		buildTypeIndex();
+
+	static const vector<std::pair<unsigned, ArchiveEntry*>> no_entries;
+	auto find_bucket = [this](EntryType* t) -> const vector<std::pair<unsigned, ArchiveEntry*>>& {
+		auto i = type_index_.find(t);
+		return i != type_index_.end() ? i->second : no_entries;
+	};
+	const auto& typed   = find_bucket(type);
+	const auto& unknown = type == EntryType::unknownType() ? no_entries : find_bucket(EntryType::unknownType());
+
+	// Merge both lists by tree position
+	vector<ArchiveEntry*> candidates;
+	candidates.reserve(typed.size() + unknown.size());
+	auto i1 = typed.begin();
+	auto i2 = unknown.begin();
+	while (i1 != typed.end() || i2 != unknown.end())
+	{
+		if (i2 == unknown.end() || (i1 != typed.end() && i1->first < i2->first))
+			candidates.push_back((i1++)->second);
+		else
+			candidates.push_back((i2++)->second);
+	}
+
+	return candidates;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the archive to [filename] while the archive file is memory-mapped.
+// All entries are first set to reference their data (which is cheap since it
+// is just a view into the mapping), so nothing needs to be read from the
+// original file once writing begins. Afterwards the written file is mapped so
+// any unloaded entries can be loaded from their (possibly new) offsets
+// -----------------------------------------------------------------------------
+bool Archive::writeMapped(string_view filename)
+{
+	// Ensure all entries reference their data
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
+	for (auto entry : entries)
+		entry->data();
+
+	bool success;
+	if (filename != file_mapping_->path())
+		success = write(filename);
+	else
+	{
+#ifdef __WXMSW__
+		// A mapped file can't be overwritten on windows, so any mapped entry
+		// data has to be copied out of it first
+		for (auto entry : entries)
+			entry->data_.detach();
+		file_mapping_.reset();
+		success = write(filename);
+#else
+		// Write to a temporary file and replace the original with it, the
+		// existing mapping (and entry data) will still reference the original
+		// file's contents
+		auto temp_file = fmt::format("{}.slade-tmp", filename);
+		success        = write(temp_file);
+		if (success)
+			success = wxRenameFile(temp_file, wxString{ filename.data(), filename.size() }, true);
+		else
+			wxRemoveFile(temp_file);
+#endif
+	}
+
+	// Map the written file
+	if (success)
+		file_mapping_ = MappedFile::map(filename);
+
+	return success;
+}
+
+// -----------------------------------------------------------------------------
+// Deletes any temp files created to hold streamed entry data
+// -----------------------------------------------------------------------------
+void Archive::removeSpillFiles()
+{
+	for (const auto& file : spill_files_)
+		if (!fileutil::removeFile(file))
+			log::warning("Unable to remove spill file {}", file);
+
+	spill_files_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the entry type index, adding every entry in the archive to the
+// list for its type in entry tree order (as searched by findAll)
+// -----------------------------------------------------------------------------
+void Archive::buildTypeIndex() const
+{
+	type_index_.clear();
+
+	unsigned                         position = 0;
+	std::function<void(ArchiveDir*)> add_dir  = [&](ArchiveDir* dir) {
+		for (const auto& entry : dir->entries())
+			type_index_[entry->type()].emplace_back(position++, entry.get());
+		for (const auto& subdir : dir->subdirs())
+			add_dir(subdir.get());
+	};
+	add_dir(dir_root_.get());
+
+	type_index_valid_ = true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the total number of entries in the archive
 // -----------------------------------------------------------------------------
@@ -707,6 +1120,8 @@ void Archive::close()
 {
 	// Clear the root dir
 	dir_root_->clear();
+	file_mapping_.reset();
+	removeSpillFiles();
 
 	// Announce
 	signals_.closed(*this);
@@ -724,6 +1139,8 @@ void Archive::entryStateChanged(ArchiveEntry* entry)
 
 	// Signal entry state change
 	signals_.entry_state_changed(*this, *entry);
+	queueEntryChange(entry->getShared(), ChangeType::Modified);
+	sendEntryChanges();
 
 	// If entry was set to unmodified, don't set the archive to modified
 	if (entry->state() == ArchiveEntry::State::Unmodified)
@@ -793,11 +1210,28 @@ bool Archive::paste(ArchiveDir* tree, unsigned position, shared_ptr<ArchiveDir>
 	for (const auto& cdir : created_dirs)
 		signals_.dir_added(*this, *cdir);
 	for (const auto& entry : created_entries)
+	{
 		signals_.entry_added(*this, *entry);
+		queueEntryChange(entry, ChangeType::Added);
+	}
+	sendEntryChanges();
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data. Formats that can read parts of an
+// unloaded entry's data directly from the archive override this, by default
+// the entry's data is loaded and read from memory
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> Archive::entryDataReader(ArchiveEntry* entry)
+{
+	if (!checkEntry(entry))
+		return nullptr;
+
+	return std::make_unique<MemDataReader>(entry->data());
+}
+
 // -----------------------------------------------------------------------------
 // Gets the directory matching [path], starting from [base].
 // If [base] is null, the root directory is used.
@@ -951,6 +1385,8 @@ shared_ptr<ArchiveEntry> Archive::addEntry(shared_ptr<ArchiveEntry> entry, unsig
 
 	// Signal entry addition
 	signals_.entry_added(*this, *entry);
+	queueEntryChange(entry, ChangeType::Added);
+	sendEntryChanges();
 
 	// Create undo step
 	if (undoredo::currentlyRecording())
@@ -1044,6 +1480,8 @@ bool Archive::removeEntry(ArchiveEntry* entry)
 	{
 		// Signal entry removed
 		signals_.entry_removed(*this, *dir, *entry);
+		queueEntryChange(entry_shared, ChangeType::Removed);
+		sendEntryChanges();
 
 		// Update variables etc
 		setModified(true);
@@ -1224,6 +1662,7 @@ bool Archive::renameEntry(ArchiveEntry* entry, string_view name)
 
 	// Announce modification
 	signals_.entry_renamed(*this, *entry, prev_name);
+	queueEntryChange(entry->getShared(), ChangeType::Renamed, prev_name);
 	entryStateChanged(entry);
 
 	return true;
@@ -1235,35 +1674,15 @@ bool Archive::renameEntry(ArchiveEntry* entry, string_view name)
 // -----------------------------------------------------------------------------
 bool Archive::importDir(string_view directory)
 {
-	// Get a list of all files in the directory
-	vector<string> files;
-	for (const auto& item : std::filesystem::recursive_directory_iterator{ directory })
-		if (item.is_regular_file())
-			files.push_back(item.path().string());
+	// Import all files in the directory (reading them in parallel)
+	auto files   = entryio::dirFilesToImport(directory);
+	auto entries = entryio::importFiles(*this, files, nullptr, 0xFFFFFFFF, nullptr, false);
 
-	// Go through files
-	for (const auto& file : files)
+	// Set unmodified
+	for (const auto& entry : entries)
 	{
-		strutil::Path fn{ strutil::replace(file, directory, "") }; // Remove directory from entry name
-
-		// Split filename into dir+name
-		auto ename = fn.fileName();
-		auto edir  = fn.path();
-
-		// Remove beginning \ or / from dir
-		if (strutil::startsWith(edir, '\\') || strutil::startsWith(edir, '/'))
-			edir.remove_prefix(1);
-
-		// Add the entry
-		auto dir   = createDir(edir);
-		auto entry = addNewEntry(ename, dir->numEntries() + 1, dir.get());
-
-		// Load data
-		entry->importFile(file);
-
-		// Set unmodified
 		entry->setState(ArchiveEntry::State::Unmodified);
-		dir->dirEntry()->setState(ArchiveEntry::State::Unmodified);
+		entry->parentDir()->dirEntry()->setState(ArchiveEntry::State::Unmodified);
 	}
 
 	return true;
@@ -1348,6 +1767,16 @@ ArchiveEntry* Archive::findFirst(SearchOptions& options)
 		dir = dir_root_.get();
 	strutil::upperIP(options.match_name); // Force case-insensitive
 
+	// Only check entries of the requested type if given
+	if (options.match_type)
+	{
+		for (auto entry : typeSearchCandidates(options.match_type))
+			if (inSearchDir(entry, dir, options.search_subdirs) && matchesSearch(entry, options))
+				return entry;
+
+		return nullptr;
+	}
+
 	// Begin search
 
 	// Search entries
@@ -1355,36 +1784,9 @@ ArchiveEntry* Archive::findFirst(SearchOptions& options)
 	{
 		auto entry = dir->entryAt(a);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		// Entry passed all checks, so we found a match
+		if (matchesSearch(entry, options))
+			return entry;
 	}
 
 	// Search subdirectories (if needed)
@@ -1418,6 +1820,18 @@ ArchiveEntry* Archive::findLast(SearchOptions& options)
 		dir = dir_root_.get();
 	strutil::upperIP(options.match_name); // Force case-insensitive
 
+	// Only check entries of the requested type if given (subdirectories are
+	// searched after the entries in [dir], so not in reverse tree order)
+	if (options.match_type && !options.search_subdirs)
+	{
+		auto candidates = typeSearchCandidates(options.match_type);
+		for (auto i = candidates.rbegin(); i != candidates.rend(); ++i)
+			if ((*i)->parentDir() == dir && matchesSearch(*i, options))
+				return *i;
+
+		return nullptr;
+	}
+
 	// Begin search
 
 	// Search entries (bottom-up)
@@ -1425,36 +1839,9 @@ ArchiveEntry* Archive::findLast(SearchOptions& options)
 	{
 		auto entry = dir->entryAt(a);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		// Entry passed all checks, so we found a match
+		if (matchesSearch(entry, options))
+			return entry;
 	}
 
 	// Search subdirectories (if needed) (bottom-up)
@@ -1488,6 +1875,16 @@ vector<ArchiveEntry*> Archive::findAll(SearchOptions& options)
 	vector<ArchiveEntry*> ret;
 	strutil::upperIP(options.match_name); // Force case-insensitive
 
+	// Only check entries of the requested type if given
+	if (options.match_type)
+	{
+		for (auto entry : typeSearchCandidates(options.match_type))
+			if (inSearchDir(entry, dir, options.search_subdirs) && matchesSearch(entry, options))
+				ret.push_back(entry);
+
+		return ret;
+	}
+
 	// Begin search
 
 	// Search entries
@@ -1495,36 +1892,9 @@ vector<ArchiveEntry*> Archive::findAll(SearchOptions& options)
 	{
 		auto entry = dir->entryAt(a);
 
-		// Check type
-		if (options.match_type)
-		{
-			if (entry->type() == EntryType::unknownType())
-			{
-				if (!options.match_type->isThisType(*entry))
-					continue;
-			}
-			else if (options.match_type != entry->type())
-				continue;
-		}
-
-		// Check name
-		if (!options.match_name.empty())
-		{
-			// Cut extension if ignoring
-			auto check_name = options.ignore_ext ? entry->upperNameNoExt() : entry->upperName();
-			if (!strutil::matches(check_name, options.match_name))
-				continue;
-		}
-
-		// Check namespace
-		if (!options.match_namespace.empty())
-		{
-			if (!strutil::equalCI(detectNamespace(entry), options.match_namespace))
-				continue;
-		}
-
-		// Entry passed all checks so far, so we found a match
-		ret.push_back(entry);
+		// Entry passed all checks, so we found a match
+		if (matchesSearch(entry, options))
+			ret.push_back(entry);
 	}
 
 	// Search subdirectories (if needed)
@@ -1602,6 +1972,122 @@ void Archive::blockModificationSignals(bool block)
 		signals_.entry_state_changed.unblock();
 		signals_.entry_renamed.unblock();
 	}
+
+	std::lock_guard lock(change_queue_->mutex);
+	change_queue_->blocked = block;
+}
+
+// -----------------------------------------------------------------------------
+// Sends the entries_changed signal with all entry changes queued since it was
+// last sent. This happens automatically on the main thread after changes are
+// made, but can be called (on the main thread only) if the changes need to be
+// seen immediately
+// -----------------------------------------------------------------------------
+void Archive::flushEntryChanges()
+{
+	vector<EntryChange> changes;
+	{
+		std::lock_guard lock(change_queue_->mutex);
+		changes.swap(change_queue_->changes);
+		change_queue_->index.clear();
+		change_queue_->flush_pending = false;
+	}
+
+	// Ignore entries that were added then removed again
+	changes.erase(
+		std::remove_if(
+			changes.begin(),
+			changes.end(),
+			[](const EntryChange& change) {
+				return !change.added && !change.removed && !change.modified && !change.renamed;
+			}),
+		changes.end());
+
+	if (!changes.empty())
+		signals_.entries_changed(*this, changes);
+}
+
+// -----------------------------------------------------------------------------
+// Queues a change of [type] to [entry] for the entries_changed signal,
+// combining it with any change to the entry already queued. Can be called from
+// any thread. Changes made on the main thread are sent at the end of the
+// operation that made them (see sendEntryChanges), and changes made on other
+// threads are sent on the main thread when it is next idle
+// -----------------------------------------------------------------------------
+void Archive::queueEntryChange(const shared_ptr<ArchiveEntry>& entry, ChangeType type, string_view prev_name)
+{
+	if (!entry)
+		return;
+
+	auto&            queue = *change_queue_;
+	std::unique_lock lock(queue.mutex);
+	if (queue.blocked)
+		return;
+
+	// Get the entry's queued change (keyed on the shared pointer, which the
+	// change holds, so the entry can't be freed and its address reused)
+	auto existing = queue.index.find(entry);
+	if (existing == queue.index.end())
+	{
+		existing = queue.index.emplace(entry, queue.changes.size()).first;
+		queue.changes.push_back({ entry });
+	}
+	auto& change = queue.changes[existing->second];
+
+	// Combine with the new change
+	switch (type)
+	{
+	case ChangeType::Added: change.added = true; break;
+	case ChangeType::Removed:
+		if (change.added && !change.removed)
+			change = { change.entry }; // Nothing to announce if it was added since the last signal
+		else
+		{
+			change.removed  = true;
+			change.added    = false;
+			change.modified = false;
+		}
+		break;
+	case ChangeType::Modified: change.modified = true; break;
+	case ChangeType::Renamed:
+		if (!change.renamed)
+		{
+			change.renamed   = true;
+			change.prev_name = prev_name;
+		}
+		break;
+	}
+
+	// Send the signal on the main thread once it's idle if the change wasn't
+	// made on the main thread
+	if (queue.flush_pending || wxThread::IsMain())
+		return;
+	queue.flush_pending = true;
+	lock.unlock();
+
+	if (wxTheApp)
+		wxTheApp->CallAfter([queue = change_queue_]() {
+			Archive* archive;
+			{
+				std::lock_guard lock(queue->mutex);
+				archive = queue->archive;
+			}
+			if (archive)
+				archive->flushEntryChanges();
+		});
+	else
+		flushEntryChanges();
+}
+
+// -----------------------------------------------------------------------------
+// Sends all queued entry changes if called on the main thread, so that
+// anything using the entries_changed signal (eg. the resource manager) is up
+// to date as soon as the operation making the changes is done
+// -----------------------------------------------------------------------------
+void Archive::sendEntryChanges()
+{
+	if (wxThread::IsMain())
+		flushEntryChanges();
 }
 
 
@@ -6,6 +6,9 @@
 
 namespace slade
 {
+class EntryDataReader;
+class EntryTypeCache;
+
 struct ArchiveFormat
 {
 	string             id;
@@ -96,6 +99,11 @@ public:
 	virtual bool     paste(ArchiveDir* tree, unsigned position = 0xFFFFFFFF, shared_ptr<ArchiveDir> base = nullptr);
 	virtual bool     importDir(string_view directory);
 	virtual bool     hasFlatHack() { return false; }
+	virtual bool     canMapFile() const { return false; }
+	bool             isFileMapped() const { return file_mapping_ != nullptr; }
+
+	// Entry data reading
+	virtual unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry);
 
 	// Directory stuff
 	ArchiveDir*                    dirAtPath(string_view path, ArchiveDir* base = nullptr) const;
@@ -158,6 +166,25 @@ public:
 	virtual ArchiveEntry*         findLast(SearchOptions& options);
 	virtual vector<ArchiveEntry*> findAll(SearchOptions& options);
 	virtual vector<ArchiveEntry*> findModifiedEntries(ArchiveDir* dir = nullptr);
+	void                          invalidateTypeIndex() { type_index_valid_ = false; }
+
+	// A change to an entry, queued from any thread and delivered in a batch
+	// (coalesced per entry) on the main thread by the entries_changed signal,
+	// at the end of the operation making the changes if it was on the main
+	// thread, otherwise when the main thread is next idle
+	struct EntryChange
+	{
+		shared_ptr<ArchiveEntry> entry;
+		bool                     added    = false;
+		bool                     removed  = false; // If also added, the entry was removed then added again
+		bool                     modified = false;
+		bool                     renamed  = false;
+		string                   prev_name; // Name before it was (first) renamed
+
+		// Whether the entry was in the archive before/after the changes
+		bool existedBefore() const { return removed || !added; }
+		bool existsAfter() const { return added || !removed; }
+	};
 
 	// Signals
 	struct Signals
@@ -172,9 +199,11 @@ public:
 		sigslot::signal<Archive&, ArchiveDir&, unsigned, unsigned> entries_swapped; // Archive, Dir, Index 1, Index 2
 		sigslot::signal<Archive&, ArchiveDir&>                     dir_added;
 		sigslot::signal<Archive&, ArchiveDir&, ArchiveDir&>        dir_removed; // Archive, Parent dir, Removed Dir
+		sigslot::signal<Archive&, const vector<EntryChange>&>      entries_changed; // Batched, see EntryChange
 	};
 	Signals& signals() { return signals_; }
 	void     blockModificationSignals(bool block = true);
+	void     flushEntryChanges();
 
 	// Static functions
 	static bool                   loadFormats(MemChunk& mc);
@@ -186,13 +215,55 @@ protected:
 	weak_ptr<ArchiveEntry> parent_;
 	bool                   on_disk_; // Specifies whether the archive exists on disk (as opposed to being newly created)
 	bool                   read_only_; // If true, the archive cannot be modified
+	shared_ptr<MappedFile> file_mapping_; // The memory-mapped archive file (if opened with archive_map_files)
+
+	// Max. number of entries to batch up for type detection when opening
+	static const size_t DETECT_BATCH_SIZE = 1024;
+
+	bool                  loadMappedEntryData(ArchiveEntry* entry, uint32_t offset, uint32_t size) const;
+	bool loadMappedEntryData(ArchiveEntry* entry, const MemChunk& mapped, uint32_t offset, uint32_t size) const;
+	vector<ArchiveEntry*> typeSearchCandidates(EntryType* type) const;
+	void                  detectEntryTypes(vector<ArchiveEntry*>& batch, bool allow_unload = true) const;
+	void                  openTypeCache(string_view filename);
+	void                  closeTypeCache(bool save);
+	EntryTypeCache*       typeCache() const { return type_cache_.get(); }
+	bool                  matchesSearch(ArchiveEntry* entry, const SearchOptions& options);
+
+	unique_ptr<EntryDataReader> fileDataReader(ArchiveEntry* entry, uint32_t offset) const;
+
+	// Streamed entry data (eg. decompressed a chunk at a time)
+	using DataSink = std::function<bool(const uint8_t* data, size_t size)>;
+	bool importStreamed(ArchiveEntry* entry, const std::function<bool(const DataSink&)>& stream);
 
 private:
-	bool                   modified_;
-	shared_ptr<ArchiveDir> dir_root_;
-	Signals                signals_;
+	enum class ChangeType
+	{
+		Added,
+		Removed,
+		Modified,
+		Renamed
+	};
+	struct ChangeQueue;
+
+	bool                       modified_;
+	shared_ptr<ArchiveDir>     dir_root_;
+	Signals                    signals_;
+	shared_ptr<ChangeQueue>    change_queue_; // Entry changes waiting for entries_changed
+	unique_ptr<EntryTypeCache> type_cache_; // Cached entry types for the file being opened
+	vector<string>             spill_files_; // Temp files holding (mapped) streamed entry data
+
+	// Entries of each type along with their position in the entry tree, for
+	// faster type searches. Rebuilt when needed after changes
+	mutable std::unordered_map<EntryType*, vector<std::pair<unsigned, ArchiveEntry*>>> type_index_;
+	mutable bool                                                                      type_index_valid_ = false;
 
 	static vector<ArchiveFormat> formats_;
+
+	bool writeMapped(string_view filename);
+	void buildTypeIndex() const;
+	void removeSpillFiles();
+	void queueEntryChange(const shared_ptr<ArchiveEntry>& entry, ChangeType type, string_view prev_name = {});
+	void sendEntryChanges();
 };
 
 // Base class for list-based archive formats
@@ -0,0 +1,378 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ArchiveBenchmark.cpp
+// Description: Benchmarks for archive opening, entry data loading, type
+//              detection, searching and writing, over a corpus of archives
+//              and synthetic (generated) archives with many entries.
+//              See Utility/Benchmark.cpp for the output format
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ArchiveBenchmark.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/DirArchive.h"
+#include "Archive/Formats/WadArchive.h"
+#include "Archive/Formats/ZipArchive.h"
+#include "General/Console.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+#include <filesystem>
+
+using namespace slade;
+using namespace benchmark;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Bool, archive_type_cache)
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Number of times each find_all query is run
+constexpr int FIND_REPEATS = 10;
+
+// Number of directories entries are spread over in synthetic zip archives
+constexpr unsigned SYNTHETIC_DIRS = 100;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the size of the file at [path], or 0 if it doesn't exist
+// -----------------------------------------------------------------------------
+uint64_t fileSize(const string& path)
+{
+	std::error_code error;
+	auto            size = std::filesystem::file_size(path, error);
+	return error ? 0 : static_cast<uint64_t>(size);
+}
+
+// -----------------------------------------------------------------------------
+// Runs the benchmark phases that work on an already opened [archive]
+// (named [corpus] in the results). If [save] is true the archive is also
+// written to a temporary file
+// -----------------------------------------------------------------------------
+void benchmarkOpenArchive(vector<Result>& results, Archive& archive, string_view corpus, bool save)
+{
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+	auto count = static_cast<unsigned>(entries.size());
+
+	// Load all entry data (lazily loaded entries are unloaded first)
+	for (auto entry : entries)
+		if (entry->isLoaded() && entry->state() == ArchiveEntry::State::Unmodified)
+			entry->unloadData();
+	timePhase(
+		results,
+		corpus,
+		"load_data",
+		count,
+		[&entries]()
+		{
+			uint64_t bytes = 0;
+			for (auto entry : entries)
+				bytes += entry->data().size();
+			return bytes;
+		});
+
+	// Detect the types of all entries from scratch
+	for (auto entry : entries)
+		entry->setType(EntryType::unknownType());
+	archive.invalidateTypeIndex();
+	timePhase(
+		results,
+		corpus,
+		"detect_types",
+		count,
+		[&entries]()
+		{
+			EntryType::detectEntryTypes(entries);
+			return uint64_t(0);
+		});
+
+	// Search by name and type (a typical mix of resource lookups)
+	timePhase(
+		results,
+		corpus,
+		"find_all",
+		count,
+		[&archive]()
+		{
+			vector<Archive::SearchOptions> queries(4);
+			queries[0].match_name = "MAP*";
+			queries[1].match_name = "*A*";
+			queries[2].match_type = EntryType::fromId("png");
+			queries[3].match_type = EntryType::fromId("wad");
+			for (auto& query : queries)
+				query.search_subdirs = true;
+
+			for (int a = 0; a < FIND_REPEATS; ++a)
+				for (auto& query : queries)
+					archive.findAll(query);
+
+			return uint64_t(0);
+		});
+
+	// Write to memory
+	timePhase(
+		results,
+		corpus,
+		"write",
+		count,
+		[&archive]()
+		{
+			MemChunk mc;
+			archive.write(mc, false);
+			return static_cast<uint64_t>(mc.size());
+		});
+
+	// Write to a temporary file
+	if (save)
+	{
+		auto path = app::path("slade_benchmark.tmp", app::Dir::Temp);
+		timePhase(
+			results,
+			corpus,
+			"save",
+			count,
+			[&archive, &path]()
+			{
+				archive.write(path, false);
+				return fileSize(path);
+			});
+		fileutil::removeFile(path);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks opening the archive at [path] and working with its entries
+// -----------------------------------------------------------------------------
+void benchmarkFile(vector<Result>& results, const string& path)
+{
+	shared_ptr<Archive> archive;
+	bool                is_dir = fileutil::dirExists(path);
+	if (is_dir)
+		archive = std::make_shared<DirArchive>();
+	else if (WadArchive::isWadArchive(path))
+		archive = std::make_shared<WadArchive>();
+	else if (ZipArchive::isZipArchive(path))
+		archive = std::make_shared<ZipArchive>();
+	else
+	{
+		log::warning("Benchmark: Skipping \"{}\", not a wad, zip or directory", path);
+		return;
+	}
+
+	// Open (without the type cache so that types are actually detected)
+	bool opened = false;
+	timePhase(
+		results,
+		path,
+		"open",
+		0,
+		[&]()
+		{
+			opened = archive->open(path);
+			return is_dir ? uint64_t(0) : fileSize(path);
+		});
+	if (!opened)
+	{
+		log::warning("Benchmark: Unable to open \"{}\": {}", path, global::error);
+		results.pop_back();
+		return;
+	}
+	results.back().count = archive->numEntries();
+
+	benchmarkOpenArchive(results, *archive, path, !is_dir);
+	archive->close();
+}
+
+// -----------------------------------------------------------------------------
+// Generates the data for synthetic entry [index]: a mix of text, small binary
+// lumps and empty markers, to give type detection something to do
+// -----------------------------------------------------------------------------
+void syntheticEntryData(unsigned index, MemChunk& mc)
+{
+	switch (index % 4)
+	{
+	case 0:
+	{
+		auto text = fmt::format("// Synthetic entry {}\nactor Thing{} {{ }}\n", index, index);
+		mc.importMem(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		break;
+	}
+	case 1:
+	case 2:
+	{
+		uint8_t data[256];
+		for (unsigned a = 0; a < sizeof(data); ++a)
+			data[a] = static_cast<uint8_t>(index * 31 + a * 7);
+		mc.importMem(data, 64 + index % 192);
+		break;
+	}
+	default: break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks a synthetic archive of [format] (wad or zip) with [count] entries,
+// generated, written to memory and then opened from there
+// -----------------------------------------------------------------------------
+void benchmarkSynthetic(vector<Result>& results, string_view format, unsigned count)
+{
+	auto corpus = fmt::format("synthetic_{}_{}", format, count);
+	bool is_zip = format == "zip";
+
+	// Generate
+	MemChunk data;
+	timePhase(
+		results,
+		corpus,
+		"generate",
+		count,
+		[&]()
+		{
+			shared_ptr<Archive> archive;
+			if (is_zip)
+				archive = std::make_shared<ZipArchive>();
+			else
+				archive = std::make_shared<WadArchive>();
+
+			ArchiveModSignalBlocker blocker{ *archive };
+			for (unsigned a = 0; a < count; ++a)
+			{
+				MemChunk entry_data;
+				syntheticEntryData(a, entry_data);
+				auto entry = std::make_shared<ArchiveEntry>(
+					is_zip ? fmt::format("E{:06d}.lmp", a) : fmt::format("E{:06d}", a));
+				entry->importMemChunk(entry_data);
+				if (is_zip)
+				{
+					auto dir = archive->createDir(fmt::format("dir{:03d}", a % SYNTHETIC_DIRS));
+					archive->addEntry(entry, 0xFFFFFFFF, dir.get());
+				}
+				else
+					archive->addEntry(entry);
+			}
+
+			archive->write(data);
+			return static_cast<uint64_t>(data.size());
+		});
+
+	// Open from memory
+	shared_ptr<Archive> archive;
+	if (is_zip)
+		archive = std::make_shared<ZipArchive>();
+	else
+		archive = std::make_shared<WadArchive>();
+	timePhase(
+		results,
+		corpus,
+		"open",
+		count,
+		[&]()
+		{
+			archive->open(data);
+			return static_cast<uint64_t>(data.size());
+		});
+
+	benchmarkOpenArchive(results, *archive, corpus, false);
+	archive->close();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Benchmark Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs all archive benchmarks on the archives (wad or zip files) or
+// directories in [paths], and on synthetic wad and zip archives with
+// [synthetic_entries] entries (none if 0). Returns the results of each phase
+// -----------------------------------------------------------------------------
+vector<Result> benchmark::runArchiveBenchmarks(const vector<string>& paths, unsigned synthetic_entries)
+{
+	vector<Result> results;
+
+	// Disable the entry type cache so that type detection is always measured
+	bool type_cache    = archive_type_cache;
+	archive_type_cache = false;
+
+	for (const auto& path : paths)
+		benchmarkFile(results, path);
+
+	if (synthetic_entries > 0)
+	{
+		benchmarkSynthetic(results, "wad", synthetic_entries);
+		benchmarkSynthetic(results, "zip", synthetic_entries);
+	}
+
+	archive_type_cache = type_cache;
+
+	return results;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the archive benchmarks and logs the results. Usage:
+// bench_archives <synthetic entry count> [paths...]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(bench_archives, 1, true)
+{
+	auto count = strutil::asInt(args[0]);
+	auto paths = vector<string>(args.begin() + 1, args.end());
+
+	logResults(runArchiveBenchmarks(paths, std::max(count, 0)));
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "Utility/Benchmark.h"
+
+namespace slade::benchmark
+{
+vector<Result> runArchiveBenchmarks(const vector<string>& paths, unsigned synthetic_entries = 100000);
+} // namespace slade::benchmark
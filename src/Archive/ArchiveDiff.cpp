@@ -0,0 +1,247 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ArchiveDiff.cpp
+// Description: Functions to compare two versions of an archive, finding the
+//              entries that were added, removed, changed or moved, and to
+//              write the added and changed entries to a patch archive.
+//              Entries are compared by size and content hash, so (for zip
+//              archives at least) unchanged entries never need to be loaded
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ArchiveDiff.h"
+#include "Archive/Archive.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Utility/StringUtils.h"
+#include <unordered_set>
+
+using namespace slade;
+using namespace archivediff;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a list of all entries in [archive] (excluding folders)
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> diffEntries(Archive& archive)
+{
+	vector<ArchiveEntry*> entries;
+	archive.putEntryTreeAsList(entries);
+	entries.erase(
+		std::remove_if(
+			entries.begin(),
+			entries.end(),
+			[](ArchiveEntry* entry) { return entry->type() == EntryType::folderType(); }),
+		entries.end());
+
+	return entries;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [left] and [right] have the same content. Sizes are checked
+// first so the (cached) content hash is only needed for entries of equal size
+// -----------------------------------------------------------------------------
+bool sameContent(ArchiveEntry* left, ArchiveEntry* right)
+{
+	return left->size() == right->size() && left->contentHash() == right->contentHash();
+}
+
+// -----------------------------------------------------------------------------
+// Returns a key combining the size and content hash of [entry]
+// -----------------------------------------------------------------------------
+uint64_t contentKey(ArchiveEntry* entry)
+{
+	return (static_cast<uint64_t>(entry->size()) << 32) | entry->contentHash();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveDiff Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Compares [old_archive] with [new_archive] and returns the differences.
+// Entries with the same path (case-insensitive) are matched, in order if there
+// are duplicates (eg. map lumps in a wad). Any unmatched entries in the new
+// archive with the same content as an unmatched entry in the old archive are
+// considered moved (or renamed), the rest are added/removed
+// -----------------------------------------------------------------------------
+Result archivediff::compare(Archive& old_archive, Archive& new_archive)
+{
+	Result result;
+
+	auto old_entries = diffEntries(old_archive);
+	auto new_entries = diffEntries(new_archive);
+
+	// Index old entries by path
+	std::unordered_map<string, vector<ArchiveEntry*>> old_paths;
+	for (auto* entry : old_entries)
+		old_paths[strutil::upper(entry->path(true))].push_back(entry);
+	std::unordered_map<string, unsigned> path_matches;
+
+	// Match new entries with old entries at the same path
+	vector<ArchiveEntry*> new_unmatched;
+	for (auto* entry : new_entries)
+	{
+		auto path  = strutil::upper(entry->path(true));
+		auto found = old_paths.find(path);
+		auto index = found != old_paths.end() ? path_matches[path]++ : 0;
+		if (found == old_paths.end() || index >= found->second.size())
+		{
+			new_unmatched.push_back(entry);
+			continue;
+		}
+
+		auto* old_entry      = found->second[index];
+		found->second[index] = nullptr;
+		if (sameContent(old_entry, entry))
+			++result.unchanged;
+		else
+			result.changed.push_back({ old_entry, entry });
+	}
+
+	// Index the old entries left over by content
+	std::unordered_set<ArchiveEntry*>                old_unmatched;
+	std::unordered_multimap<uint64_t, ArchiveEntry*> old_content;
+	for (const auto& same_path : old_paths)
+		for (auto* entry : same_path.second)
+			if (entry)
+			{
+				old_unmatched.insert(entry);
+				old_content.emplace(contentKey(entry), entry);
+			}
+
+	// Match the new entries left over by content
+	for (auto* entry : new_unmatched)
+	{
+		auto found = old_content.find(contentKey(entry));
+		if (found != old_content.end())
+		{
+			result.moved.push_back({ found->second, entry });
+			old_unmatched.erase(found->second);
+			old_content.erase(found);
+		}
+		else
+			result.added.push_back(entry);
+	}
+
+	// Anything still unmatched in the old archive was removed
+	for (auto* entry : old_entries)
+		if (old_unmatched.count(entry) > 0)
+			result.removed.push_back(entry);
+
+	return result;
+}
+
+// -----------------------------------------------------------------------------
+// Adds copies of all added, changed and moved entries in [diff] to [patch], at
+// the same path (or in the same namespace for treeless archives) as in the new
+// archive. Removed entries can't be represented in a patch and are ignored.
+// Returns the number of entries added to [patch]
+// -----------------------------------------------------------------------------
+unsigned archivediff::writePatch(const Result& diff, Archive& patch)
+{
+	vector<ArchiveEntry*> entries = diff.added;
+	for (const auto& pair : diff.changed)
+		entries.push_back(pair.new_entry);
+	for (const auto& pair : diff.moved)
+		entries.push_back(pair.new_entry);
+
+	unsigned count = 0;
+	for (auto* entry : entries)
+	{
+		auto copy = std::make_shared<ArchiveEntry>(*entry);
+		if (patch.isTreeless())
+		{
+			auto* archive = entry->parent();
+			if (patch.addEntry(copy, archive ? archive->detectNamespace(entry) : "global"))
+				++count;
+		}
+		else if (patch.addEntry(copy, 0xFFFFFFFF, patch.createDir(entry->path()).get()))
+			++count;
+	}
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a text summary of [diff], listing the paths of all differing entries
+// -----------------------------------------------------------------------------
+string archivediff::summary(const Result& diff)
+{
+	string text;
+
+	if (!diff.changed.empty())
+	{
+		text += fmt::format("Changed ({}):\n", diff.changed.size());
+		for (const auto& pair : diff.changed)
+			text += fmt::format(
+				"  {} ({} -> {})\n",
+				pair.new_entry->path(true),
+				pair.old_entry->sizeString(),
+				pair.new_entry->sizeString());
+		text += "\n";
+	}
+
+	if (!diff.added.empty())
+	{
+		text += fmt::format("Added ({}):\n", diff.added.size());
+		for (auto* entry : diff.added)
+			text += fmt::format("  {}\n", entry->path(true));
+		text += "\n";
+	}
+
+	if (!diff.removed.empty())
+	{
+		text += fmt::format("Removed ({}):\n", diff.removed.size());
+		for (auto* entry : diff.removed)
+			text += fmt::format("  {}\n", entry->path(true));
+		text += "\n";
+	}
+
+	if (!diff.moved.empty())
+	{
+		text += fmt::format("Moved/Renamed ({}):\n", diff.moved.size());
+		for (const auto& pair : diff.moved)
+			text += fmt::format("  {} -> {}\n", pair.old_entry->path(true), pair.new_entry->path(true));
+		text += "\n";
+	}
+
+	text += fmt::format("{} entries unchanged", diff.unchanged);
+
+	return text;
+}
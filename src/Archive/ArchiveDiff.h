@@ -0,0 +1,34 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+
+namespace archivediff
+{
+	// An entry in the old archive and its counterpart in the new archive
+	struct EntryPair
+	{
+		ArchiveEntry* old_entry;
+		ArchiveEntry* new_entry;
+	};
+
+	// The differences between two archives. Entries are matched by path first,
+	// then any left over are matched by content to find moved/renamed entries
+	struct Result
+	{
+		vector<ArchiveEntry*> added;     // Only in the new archive
+		vector<ArchiveEntry*> removed;   // Only in the old archive
+		vector<EntryPair>     changed;   // Same path, different content
+		vector<EntryPair>     moved;     // Different path, same content
+		unsigned              unchanged = 0;
+
+		bool identical() const { return added.empty() && removed.empty() && changed.empty() && moved.empty(); }
+	};
+
+	Result   compare(Archive& old_archive, Archive& new_archive);
+	unsigned writePatch(const Result& diff, Archive& patch);
+	string   summary(const Result& diff);
+} // namespace archivediff
+} // namespace slade
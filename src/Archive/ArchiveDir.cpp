@@ -34,9 +34,9 @@
 #include "ArchiveDir.h"
 #include "App.h"
 #include "Archive.h"
+#include "EntryIO.h"
 #include "General/Misc.h"
 #include "Utility/StringUtils.h"
-#include <filesystem>
 
 using namespace slade;
 
@@ -102,7 +102,9 @@ void ArchiveDir::setArchive(Archive* archive)
 
 // -----------------------------------------------------------------------------
 // Returns the index of [entry] within this directory, or -1 if the entry
-// doesn't exist
+// doesn't exist.
+// The entry's index_guess_ is kept up to date as entries are added, removed
+// and swapped, so the search will usually succeed immediately
 // -----------------------------------------------------------------------------
 int ArchiveDir::entryIndex(ArchiveEntry* entry, size_t startfrom) const
 {
@@ -110,8 +112,13 @@ int ArchiveDir::entryIndex(ArchiveEntry* entry, size_t startfrom) const
 	if (!entry)
 		return -1;
 
-	// Search for it
+	// Check the entry's cached index first
 	const size_t size = entries_.size();
+	if (entry->index_guess_ >= startfrom && entry->index_guess_ < size
+		&& entries_[entry->index_guess_].get() == entry)
+		return static_cast<int>(entry->index_guess_);
+
+	// Search for it
 	if (entry->index_guess_ < startfrom || entry->index_guess_ >= size)
 	{
 		for (auto a = startfrom; a < size; a++)
@@ -206,16 +213,9 @@ ArchiveEntry* ArchiveDir::entry(string_view name, bool cut_ext) const
 	if (name.empty())
 		return nullptr;
 
-	// Go through entries
-	for (auto& entry : entries_)
-	{
-		// Check for (non-case-sensitive) name match
-		if (strutil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
-			return entry.get();
-	}
-
-	// Not found
-	return nullptr;
+	// Find (non-case-sensitive) name match
+	auto index = findEntryIndex(name, cut_ext);
+	return index >= 0 ? entries_[index].get() : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -228,16 +228,9 @@ shared_ptr<ArchiveEntry> ArchiveDir::sharedEntry(string_view name, bool cut_ext)
 	if (name.empty())
 		return nullptr;
 
-	// Go through entries
-	for (auto& entry : entries_)
-	{
-		// Check for (non-case-sensitive) name match
-		if (strutil::equalCI(cut_ext ? entry->nameNoExt() : entry->name(), name))
-			return entry;
-	}
-
-	// Not found
-	return nullptr;
+	// Find (non-case-sensitive) name match
+	auto index = findEntryIndex(name, cut_ext);
+	return index >= 0 ? entries_[index] : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -289,9 +282,19 @@ bool ArchiveDir::addEntry(shared_ptr<ArchiveEntry> entry, unsigned index)
 
 	// Check index
 	if (index >= entries_.size())
+	{
 		entries_.push_back(entry); // 'Invalid' index, add to end of list
+		entry->index_guess_ = entries_.size() - 1;
+		addToNameIndex(entries_.size() - 1);
+	}
 	else
+	{
 		entries_.insert(entries_.begin() + index, entry); // Add it at index
+		updateEntryIndices(index);
+		name_index_valid_ = false;
+	}
+	if (archive_)
+		archive_->invalidateTypeIndex();
 
 	// Check entry name if duplicate names aren't allowed
 	if (!allow_duplicate_names_)
@@ -315,6 +318,10 @@ bool ArchiveDir::removeEntry(unsigned index)
 
 	// Remove it from the entry list
 	entries_.erase(entries_.begin() + index);
+	updateEntryIndices(index);
+	name_index_valid_ = false;
+	if (archive_)
+		archive_->invalidateTypeIndex();
 
 	return true;
 }
@@ -331,6 +338,11 @@ bool ArchiveDir::swapEntries(unsigned index1, unsigned index2)
 
 	// Swap entries
 	entries_[index1].swap(entries_[index2]);
+	entries_[index1]->index_guess_ = index1;
+	entries_[index2]->index_guess_ = index2;
+	name_index_valid_ = false;
+	if (archive_)
+		archive_->invalidateTypeIndex();
 
 	return true;
 }
@@ -385,6 +397,8 @@ bool ArchiveDir::addSubdir(shared_ptr<ArchiveDir> subdir, unsigned index)
 		subdirs_.push_back(subdir);
 	else
 		subdirs_.insert(subdirs_.begin() + index, subdir);
+	if (archive_)
+		archive_->invalidateTypeIndex();
 
 	// Copy some properties to the subdir
 	subdir->archive_               = archive_;
@@ -407,6 +421,8 @@ shared_ptr<ArchiveDir> ArchiveDir::removeSubdir(string_view name)
 		{
 			removed = subdirs_[i];
 			subdirs_.erase(subdirs_.begin() + i);
+			if (archive_)
+				archive_->invalidateTypeIndex();
 			break;
 		}
 
@@ -424,6 +440,8 @@ shared_ptr<ArchiveDir> ArchiveDir::removeSubdirAt(unsigned index)
 
 	auto removed = subdirs_[index];
 	subdirs_.erase(subdirs_.begin() + index);
+	if (archive_)
+		archive_->invalidateTypeIndex();
 
 	return removed;
 }
@@ -435,6 +453,9 @@ void ArchiveDir::clear()
 {
 	entries_.clear();
 	subdirs_.clear();
+	name_index_valid_ = false;
+	if (archive_)
+		archive_->invalidateTypeIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -467,63 +488,109 @@ shared_ptr<ArchiveDir> ArchiveDir::clone(shared_ptr<ArchiveDir> parent)
 // -----------------------------------------------------------------------------
 bool ArchiveDir::exportTo(string_view path)
 {
-	// Create directory if needed
-	if (!std::filesystem::exists(path))
-		std::filesystem::create_directory(path);
+	// Export entries as files (written in parallel)
+	entryio::exportDir(*this, path);
 
-	// Export entries as files
-	for (auto& entry : entries_)
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the first entry matching [name] (case-insensitive) in
+// this directory, or -1 if none match. If [cut_ext] is true, entry names are
+// compared without their extensions
+// -----------------------------------------------------------------------------
+int ArchiveDir::findEntryIndex(string_view name, bool cut_ext) const
+{
+	// Rebuild the name index if needed
+	if (!name_index_valid_)
 	{
-		// Setup entry filename
-		strutil::Path fn(entry->name());
-		fn.setPath(path);
+		name_index_.clear();
+		name_noext_index_.clear();
+		name_index_valid_ = true;
+		for (unsigned a = 0; a < entries_.size(); ++a)
+			addToNameIndex(a);
+	}
 
-		// Add file extension if it doesn't exist
-		if (!fn.hasExtension())
-			fn.setExtension(entry->type()->extension());
+	// Upper-case the name into a reused buffer, so long names don't allocate
+	thread_local string name_upper;
+	auto&               index = cut_ext ? name_noext_index_ : name_index_;
+	auto                found = index.find(strutil::upperTo(name, name_upper));
+	return found != index.end() ? static_cast<int>(found->second) : -1;
+}
 
-		// Do export
-		entry->exportFile(fn.fullPath());
-	}
+// -----------------------------------------------------------------------------
+// Adds the entry at [index] to the name index (if it is currently valid).
+// Any existing index for the same name is kept, since lookups return the first
+// matching entry
+// -----------------------------------------------------------------------------
+void ArchiveDir::addToNameIndex(unsigned index) const
+{
+	if (!name_index_valid_)
+		return;
 
-	// Export subdirectories
-	for (auto&& subdir : subdirs_)
-		subdir->exportTo(fmt::format("{}/{}", path, subdir->name()));
+	const auto& entry = entries_[index];
+	name_index_.emplace(entry->upperName(), index);
+	name_noext_index_.emplace(entry->upperNameNoExt(), index);
+}
 
-	return true;
+// -----------------------------------------------------------------------------
+// Updates the cached index of all entries in this directory from [from]
+// onwards, after entries have been inserted or removed
+// -----------------------------------------------------------------------------
+void ArchiveDir::updateEntryIndices(unsigned from) const
+{
+	for (auto a = from; a < entries_.size(); ++a)
+		entries_[a]->index_guess_ = a;
 }
 
 // -----------------------------------------------------------------------------
-// Ensures [entry] has an unique name within this directory
+// Returns true if any entry in this directory other than [entry] is named
+// [name] (case-insensitive)
+// -----------------------------------------------------------------------------
+bool ArchiveDir::nameTaken(string_view name, const ArchiveEntry* entry) const
+{
+	auto index = findEntryIndex(name, false);
+	if (index < 0)
+		return false;
+	if (entries_[index].get() != entry)
+		return true;
+
+	// [entry] is the first with the name, check for any others after it
+	for (auto a = static_cast<unsigned>(index) + 1; a < entries_.size(); ++a)
+		if (strutil::equalCI(entries_[a]->name(), name))
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Ensures [entry] has an unique name within this directory, by appending a
+// number to its name if needed
 // -----------------------------------------------------------------------------
 void ArchiveDir::ensureUniqueName(ArchiveEntry* entry)
 {
-	unsigned      index     = 0;
-	unsigned      number    = 0;
-	const auto    n_entries = entries_.size();
+	if (!nameTaken(entry->name(), entry))
+		return;
+
+	// Find the next free number for the name, starting from the one after the
+	// last number given to an entry with the same name
+	auto&         next_number = name_next_number_[entry->upperName()];
+	auto          number      = std::max(next_number, 1u);
 	strutil::Path fn(entry->name());
-	auto          name = fn.fileName();
-	while (index < n_entries)
+	fn.setFileName(fmt::format("{}{}", entry->nameNoExt(), number));
+	while (nameTaken(fn.fileName(), entry))
+		fn.setFileName(fmt::format("{}{}", entry->nameNoExt(), ++number));
+	next_number = number + 1;
+
+	// Rename the entry. The name index refers to another entry with the old
+	// name, so it can be kept and the new name added rather than rebuilding it
+	bool index_valid = name_index_valid_ && entries_[findEntryIndex(entry->name(), false)].get() != entry;
+	entry->rename(fn.fileName());
+	if (index_valid)
 	{
-		if (entries_[index].get() == entry)
-		{
-			index++;
-			continue;
-		}
-
-		if (strutil::equalCI(entries_[index]->name(), name))
-		{
-			fn.setFileName(fmt::format("{}{}", entry->nameNoExt(), ++number));
-			name  = fn.fileName();
-			index = 0;
-			continue;
-		}
-
-		index++;
+		name_index_valid_ = true;
+		addToNameIndex(entry->index());
 	}
-
-	if (number > 0)
-		entry->rename(name);
 }
 
 
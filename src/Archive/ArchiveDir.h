@@ -1,12 +1,14 @@
 #pragma once
 
 #include "ArchiveEntry.h"
+#include <unordered_map>
 
 namespace slade
 {
 class ArchiveDir
 {
 	friend class Archive;
+	friend class ArchiveEntry;
 
 public:
 	ArchiveDir(string_view name, const shared_ptr<ArchiveDir>& parent = nullptr, Archive* archive = nullptr);
@@ -84,6 +86,21 @@ private:
 	vector<shared_ptr<ArchiveDir>>   subdirs_;
 	bool                             allow_duplicate_names_ = true;
 
+	// Upper-case entry name (with/without extension) -> index of the first entry
+	// with that name, for fast name lookups. Rebuilt when needed after changes
+	mutable std::unordered_map<string, unsigned> name_index_;
+	mutable std::unordered_map<string, unsigned> name_noext_index_;
+	mutable bool                                 name_index_valid_ = false;
+
+	// Upper-case entry name -> next number to try when making an entry with
+	// that name unique (see ensureUniqueName)
+	std::unordered_map<string, unsigned> name_next_number_;
+
+	bool nameTaken(string_view name, const ArchiveEntry* entry) const;
 	void ensureUniqueName(ArchiveEntry* entry);
+	int  findEntryIndex(string_view name, bool cut_ext) const;
+	void addToNameIndex(unsigned index) const;
+	void invalidateNameIndex() { name_index_valid_ = false; }
+	void updateEntryIndices(unsigned from) const;
 };
 } // namespace slade
@@ -35,6 +35,8 @@
 #include "Main.h"
 #include "ArchiveEntry.h"
 #include "Archive.h"
+#include "EntryDataCache.h"
+#include "EntryDataReader.h"
 #include "General/Misc.h"
 #include "Utility/StringUtils.h"
 
@@ -85,22 +87,29 @@ ArchiveEntry::ArchiveEntry(ArchiveEntry& copy)
 	encrypted_   = copy.encrypted_;
 	index_guess_ = 0;
 
-	// Copy data
-	data_.importMem(copy.rawData(true), copy.size());
+	// Copy data (shared until either entry is modified)
+	data_.importShared(copy.data(true));
 
 	// Copy extra properties
 	ex_props_ = copy.exProps();
 
 	// Clear properties that shouldn't be copied
-	ex_props_.remove("ZipIndex");
-	ex_props_.remove("Offset");
 	ex_props_.remove("filePath");
+	format_info_.full_size = copy.format_info_.full_size;
 
 	// Set entry state
 	state_        = State::New;
 	state_locked_ = false;
 }
 
+// -----------------------------------------------------------------------------
+// ArchiveEntry class destructor
+// -----------------------------------------------------------------------------
+ArchiveEntry::~ArchiveEntry()
+{
+	entrycache::entryDeleted(this);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry name with no file extension
 // -----------------------------------------------------------------------------
@@ -164,8 +173,8 @@ string ArchiveEntry::path(bool include_name) const
 // -----------------------------------------------------------------------------
 const uint8_t* ArchiveEntry::rawData(bool allow_load)
 {
-	// Return entry data
-	return data(allow_load).data();
+	// Return entry data (const, so shared data isn't copied)
+	return std::as_const(data(allow_load)).data();
 }
 
 // -----------------------------------------------------------------------------
@@ -182,8 +191,14 @@ MemChunk& ArchiveEntry::data(bool allow_load)
 	{
 		data_loaded_ = parent_archive->loadEntryData(this);
 		setState(State::Unmodified);
+
+		// Data read into memory can be unloaded again if over budget
+		if (data_loaded_ && !data_.isMapped())
+			entrycache::dataLoaded(this);
 	}
 
+	last_access_.store(entrycache::currentTick(), std::memory_order_relaxed);
+
 	return data_;
 }
 
@@ -223,6 +238,18 @@ int ArchiveEntry::index()
 	return parent_ ? parent_->entryIndex(this) : -1;
 }
 
+// -----------------------------------------------------------------------------
+// Sets the entry's type to [type], with detection reliability [r]
+// -----------------------------------------------------------------------------
+void ArchiveEntry::setType(EntryType* type, int r)
+{
+	if (type != type_ && parent_ && parent_->archive())
+		parent_->archive()->invalidateTypeIndex();
+
+	type_        = type;
+	reliability_ = r;
+}
+
 // -----------------------------------------------------------------------------
 // Sets the entry's name (but doesn't change state to modified)
 // -----------------------------------------------------------------------------
@@ -230,6 +257,10 @@ void ArchiveEntry::setName(string_view name)
 {
 	name_       = name;
 	upper_name_ = strutil::upper(name);
+
+	// Parent dir name lookups need updating
+	if (parent_)
+		parent_->invalidateNameIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -238,6 +269,11 @@ void ArchiveEntry::setName(string_view name)
 // -----------------------------------------------------------------------------
 void ArchiveEntry::setState(State state, bool silent)
 {
+	// The data may have changed, so any cached content hash is no longer valid
+	// (even if the state itself is locked)
+	if (state != State::Unmodified)
+		ex_props_.remove("ContentHash");
+
 	if (state_locked_ || (state == State::Unmodified && state_ == State::Unmodified))
 		return;
 
@@ -260,8 +296,9 @@ void ArchiveEntry::unloadData()
 	if (!data_.hasData() || !data_loaded_)
 		return;
 
-	// Only unload if the data wasn't modified
-	if (state_ != State::Unmodified)
+	// Only unload if the data wasn't modified (partially loaded data is always
+	// unloaded, it can't be used as the entry's data)
+	if (state_ != State::Unmodified && !data_partial_)
 		return;
 
 	// Delete any data
@@ -271,6 +308,17 @@ void ArchiveEntry::unloadData()
 	setLoaded(false);
 }
 
+// -----------------------------------------------------------------------------
+// Flags the entry's loaded data as only the start of its full data, for type
+// detection when opening an archive. The entry's size stays its full size
+// (set when it was created), and the data is always dropped by unloadData
+// -----------------------------------------------------------------------------
+void ArchiveEntry::setPartiallyLoaded()
+{
+	data_loaded_  = true;
+	data_partial_ = true;
+}
+
 // -----------------------------------------------------------------------------
 // Locks the entry. A locked entry cannot be modified
 // -----------------------------------------------------------------------------
@@ -300,17 +348,12 @@ void ArchiveEntry::unlock()
 // -----------------------------------------------------------------------------
 void ArchiveEntry::formatName(const ArchiveFormat& format)
 {
-	bool changed = false;
-
 	// Perform character substitution if needed
 	name_ = misc::fileNameToLumpName(name_);
 
 	// Max length
 	if (format.max_name_length > 0 && static_cast<int>(name_.size()) > format.max_name_length)
-	{
 		strutil::truncateIP(name_, format.max_name_length);
-		changed = true;
-	}
 
 	// Uppercase
 	if (format.prefer_uppercase && wad_force_uppercase)
@@ -318,19 +361,17 @@ void ArchiveEntry::formatName(const ArchiveFormat& format)
 
 	// Remove \ or / if the format supports folders
 	if (format.supports_dirs && (name_.find('/') != string::npos || name_.find('\\') != string::npos))
-	{
-		name_   = misc::lumpNameToFileName(name_);
-		changed = true;
-	}
+		name_ = misc::lumpNameToFileName(name_);
 
 	// Remove extension if the format doesn't have them
 	if (!format.names_extensions)
 		if (const auto pos = name_.find('.'); pos != string::npos)
 			strutil::truncateIP(name_, pos);
 
-	// Update upper name
-	if (changed)
-		upper_name_ = strutil::upper(name_);
+	// Update upper name (character substitution above can change it too)
+	upper_name_ = strutil::upper(name_);
+	if (parent_)
+		parent_->invalidateNameIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -387,8 +428,9 @@ void ArchiveEntry::clearData()
 	data_.clear();
 
 	// Reset attributes
-	size_        = 0;
-	data_loaded_ = false;
+	size_         = 0;
+	data_loaded_  = false;
+	data_partial_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -426,19 +468,76 @@ bool ArchiveEntry::importMem(const void* data, uint32_t size)
 
 // -----------------------------------------------------------------------------
 // Imports data from a MemChunk object into the entry, resizing it and clearing
-// any currently existing data.
+// any currently existing data. The data is shared with [mc] until either is
+// modified, rather than copied.
 // Returns false if the MemChunk has no data, or true otherwise.
 // -----------------------------------------------------------------------------
 bool ArchiveEntry::importMemChunk(MemChunk& mc)
 {
 	// Check that the given MemChunk has data
-	if (mc.hasData())
+	if (!mc.hasData())
+		return false;
+
+	// Check if locked
+	if (locked_)
 	{
-		// Copy the data from the MemChunk into the entry
-		return importMem(mc.data(), mc.size());
+		global::error = "Entry is locked";
+		return false;
 	}
 
-	return false;
+	// Clear any current data
+	clearData();
+
+	// Share the data from the MemChunk with the entry
+	data_.importShared(mc);
+
+	// Update attributes
+	size_ = data_.size();
+	setLoaded();
+	setType(EntryType::unknownType());
+	setState(State::Modified);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Imports [size] bytes of data from [mc], starting at [offset].
+// If [mc] is a view into a memory-mapped file, the entry data will also be a
+// view into the same mapping rather than a copy (it will be copied once the
+// entry data is modified).
+// Returns false if the given offset/size are out of bounds, true otherwise
+// -----------------------------------------------------------------------------
+bool ArchiveEntry::importMemChunk(const MemChunk& mc, uint32_t offset, uint32_t size)
+{
+	// Check offset/size bounds
+	if (offset + size > mc.size())
+		return false;
+
+	// Copy the data if it isn't memory-mapped
+	if (!mc.isMapped())
+		return importMem(mc.data() + offset, size);
+
+	// Check if locked
+	if (locked_)
+	{
+		global::error = "Entry is locked";
+		return false;
+	}
+
+	// Clear any current data
+	clearData();
+
+	// Point the entry data at the mapped data
+	if (!data_.importMapped(mc.mapping(), mc.mappedOffset() + offset, size))
+		return false;
+
+	// Update attributes
+	size_ = size;
+	setLoaded();
+	setType(EntryType::unknownType());
+	setState(State::Modified);
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -531,8 +630,9 @@ bool ArchiveEntry::importEntry(ArchiveEntry* entry)
 	if (!entry)
 		return false;
 
-	// Copy entry data
-	importMem(entry->rawData(), entry->size());
+	// Copy entry data (shared until either entry is modified)
+	if (!importMemChunk(entry->data()))
+		importMem(entry->rawData(), entry->size());
 
 	return true;
 }
@@ -553,6 +653,26 @@ bool ArchiveEntry::exportFile(string_view filename)
 		return false;
 	}
 
+	// If the data isn't loaded, read it in chunks (directly from the parent
+	// archive where possible) rather than loading it all
+	if (!data_loaded_ && size() > 0)
+	{
+		auto            reader = dataReader();
+		vector<uint8_t> buffer(std::min<uint32_t>(reader->size(), 1 << 20));
+		while (reader->currentPos() < reader->size())
+		{
+			auto count = std::min<unsigned>(buffer.size(), reader->size() - reader->currentPos());
+			if (!reader->read(buffer.data(), count))
+			{
+				global::error = fmt::format("Unable to read data for entry {}", name_);
+				return false;
+			}
+			file.Write(buffer.data(), count);
+		}
+
+		return true;
+	}
+
 	// Write entry data to the file, if any
 	auto data = rawData();
 	if (data)
@@ -561,6 +681,22 @@ bool ArchiveEntry::exportFile(string_view filename)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for the entry's data. If the data isn't loaded it is read
+// directly from the parent archive where the format supports it, so parts of
+// very large entries can be read without loading them entirely.
+// The entry and its parent archive must remain unchanged while it is in use
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> ArchiveEntry::dataReader()
+{
+	auto archive = parent();
+	if (!data_loaded_ && archive)
+		if (auto reader = archive->entryDataReader(this))
+			return reader;
+
+	return std::make_unique<MemDataReader>(data());
+}
+
 // -----------------------------------------------------------------------------
 // Writes data to the entry MemChunk
 // -----------------------------------------------------------------------------
@@ -602,6 +738,26 @@ bool ArchiveEntry::read(void* buf, uint32_t size)
 	return data_.read(buf, size);
 }
 
+// -----------------------------------------------------------------------------
+// Returns a hash (CRC-32) of the entry's data. It is only computed when first
+// needed and then cached in the 'ContentHash' property until the entry is
+// modified, so comparing entry contents doesn't need their data each time
+// -----------------------------------------------------------------------------
+uint32_t ArchiveEntry::contentHash()
+{
+	if (ex_props_.contains("ContentHash"))
+		return exProp<unsigned>("ContentHash");
+
+	// Don't keep the data loaded if it was only loaded to hash it
+	bool was_loaded = data_loaded_;
+	auto hash       = data().crc();
+	if (!was_loaded)
+		unloadData();
+
+	ex_props_["ContentHash"] = hash;
+	return hash;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the entry's size as a string
 // -----------------------------------------------------------------------------
@@ -2,12 +2,14 @@
 
 #include "EntryType/EntryType.h"
 #include "Utility/Property.h"
+#include <atomic>
 
 namespace slade
 {
 struct ArchiveFormat;
 class ArchiveDir;
 class Archive;
+class EntryDataReader;
 
 class ArchiveEntry
 {
@@ -30,17 +32,26 @@ public:
 		New // Newly created (not saved on disk yet)
 	};
 
+	// Info used by archive formats to keep track of the entry in the archive
+	// file (kept out of exProps since every entry has it)
+	struct FormatInfo
+	{
+		int offset    = 0;  // Offset of the entry data in the archive file
+		int full_size = -1; // Full (uncompressed) size of the entry data, if compressed
+		int zip_index = -1; // Index of the entry in the zip file, if in it
+	};
+
 	// Constructor/Destructor
 	ArchiveEntry(string_view name = "", uint32_t size = 0);
 	ArchiveEntry(ArchiveEntry& copy);
-	~ArchiveEntry() = default;
+	~ArchiveEntry();
 
 	// Accessors
 	const string&            name() const { return name_; }
 	string_view              nameNoExt() const;
 	const string&            upperName() const { return upper_name_; }
 	string_view              upperNameNoExt() const;
-	uint32_t                 size() const { return data_loaded_ ? data_.size() : size_; }
+	uint32_t                 size() const { return data_loaded_ && !data_partial_ ? data_.size() : size_; }
 	MemChunk&                data(bool allow_load = true);
 	const uint8_t*           rawData(bool allow_load = true);
 	ArchiveDir*              parentDir() const { return parent_; }
@@ -52,9 +63,13 @@ public:
 	const PropertyList&      exProps() const { return ex_props_; }
 	Property&                exProp(const string& key) { return ex_props_[key]; }
 	template<typename T> T   exProp(const string& key);
+	FormatInfo&              formatInfo() { return format_info_; }
+	const FormatInfo&        formatInfo() const { return format_info_; }
 	State                    state() const { return state_; }
 	bool                     isLocked() const { return locked_; }
 	bool                     isLoaded() const { return data_loaded_; }
+	bool                     isPartiallyLoaded() const { return data_partial_; }
+	uint32_t                 lastAccess() const { return last_access_.load(std::memory_order_relaxed); }
 	Encryption               encryption() const { return encrypted_; }
 	ArchiveEntry*            nextEntry();
 	ArchiveEntry*            prevEntry();
@@ -63,12 +78,9 @@ public:
 
 	// Modifiers (won't change entry state, except setState of course :P)
 	void setName(string_view name);
-	void setLoaded(bool loaded = true) { data_loaded_ = loaded; }
-	void setType(EntryType* type, int r = 0)
-	{
-		type_        = type;
-		reliability_ = r;
-	}
+	void setLoaded(bool loaded = true) { data_loaded_ = loaded; data_partial_ = false; }
+	void setPartiallyLoaded();
+	void setType(EntryType* type, int r = 0);
 	void setState(State state, bool silent = false);
 	void setEncryption(Encryption enc) { encrypted_ = enc; }
 	void unloadData();
@@ -89,6 +101,7 @@ public:
 	// Data import
 	bool importMem(const void* data, uint32_t size);
 	bool importMemChunk(MemChunk& mc);
+	bool importMemChunk(const MemChunk& mc, uint32_t offset, uint32_t size);
 	bool importFile(string_view filename, uint32_t offset = 0, uint32_t size = 0);
 	bool importFileStream(wxFile& file, uint32_t len = 0);
 	bool importEntry(ArchiveEntry* entry);
@@ -101,6 +114,9 @@ public:
 	bool     read(void* buf, uint32_t size);
 	bool     seek(uint32_t offset, uint32_t start) { return data_.seek(offset, start); }
 	uint32_t currentPos() const { return data_.currentPos(); }
+	uint32_t contentHash();
+
+	unique_ptr<EntryDataReader> dataReader();
 
 	// Misc
 	string        sizeString() const;
@@ -108,6 +124,7 @@ public:
 	void          stateChanged();
 	void          setExtensionByType();
 	int           typeReliability() const { return (type_ ? (type()->reliability() * reliability_ / 255) : 0); }
+	int           rawTypeReliability() const { return reliability_; }
 	bool          isInNamespace(string_view ns);
 	ArchiveEntry* relativeEntry(string_view path, bool allow_absolute_path = true) const;
 
@@ -120,17 +137,22 @@ private:
 	EntryType*   type_   = nullptr;
 	ArchiveDir*  parent_ = nullptr;
 	PropertyList ex_props_;
+	FormatInfo   format_info_;
 
 	// Entry status
 	State      state_        = State::New;
 	bool       state_locked_ = false;            // If true the entry state cannot be changed (used for initial loading)
 	bool       locked_       = false;            // If true the entry data+info cannot be changed
 	bool       data_loaded_  = true;             // True if the entry's data is currently loaded into the data MemChunk
+	bool       data_partial_ = false;            // True if only the start of the data is loaded (see setPartiallyLoaded)
 	Encryption encrypted_    = Encryption::None; // Is there some encrypting on the archive?
 
 	// Misc stuff
 	int    reliability_ = 0; // The reliability of the entry's identification
 	size_t index_guess_ = 0; // for speed
+
+	// Data cache tick the entry's data was last accessed at (see EntryDataCache)
+	std::atomic<uint32_t> last_access_ = 0;
 };
 
 template<typename T> T ArchiveEntry::exProp(const string& key)
@@ -39,7 +39,9 @@
 #include "General/ResourceManager.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
+#include "Utility/MemoryStats.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -54,6 +56,124 @@ CVAR(Int, max_recent_files, 25, CVar::Flag::Save)
 CVAR(Bool, auto_open_wads_root, false, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A supported archive format, used to detect the format of an archive file
+struct ArchiveFormatProbe
+{
+	vector<string_view>                  extensions; // Usual file extensions (lower case)
+	vector<string_view>                  signatures; // Possible file signatures (none if the format has no signature)
+	bool                                 (*is_format)(const string&);
+	std::function<shared_ptr<Archive>()> create;
+};
+
+template<typename T>
+ArchiveFormatProbe formatProbe(
+	vector<string_view> extensions,
+	vector<string_view> signatures,
+	bool (*is_format)(const string&))
+{
+	return { std::move(extensions), std::move(signatures), is_format, [] { return std::make_shared<T>(); } };
+}
+
+// -----------------------------------------------------------------------------
+// Returns the list of supported archive file formats, in the order they are
+// checked (when more than one could match)
+// -----------------------------------------------------------------------------
+const vector<ArchiveFormatProbe>& archiveFormatProbes()
+{
+	static const vector<ArchiveFormatProbe> probes{
+		formatProbe<WadArchive>({ "wad", "iwad" }, { "IWAD", "PWAD" }, &WadArchive::isWadArchive),
+		formatProbe<ZipArchive>({ "zip", "pk3", "pke", "ipk3", "kpf" }, { "PK\x03\x04" }, &ZipArchive::isZipArchive),
+		formatProbe<ResArchive>({ "res" }, { "Res!" }, &ResArchive::isResArchive),
+		formatProbe<DatArchive>({ "dat" }, {}, &DatArchive::isDatArchive),
+		formatProbe<LibArchive>({ "lib" }, {}, &LibArchive::isLibArchive),
+		formatProbe<PakArchive>({ "pak" }, { "PACK" }, &PakArchive::isPakArchive),
+		formatProbe<BSPArchive>({ "bsp" }, {}, &BSPArchive::isBSPArchive),
+		formatProbe<GrpArchive>({ "grp" }, { "KenSilverman" }, &GrpArchive::isGrpArchive),
+		formatProbe<RffArchive>({ "rff" }, { "RFF\x1A" }, &RffArchive::isRffArchive),
+		formatProbe<GobArchive>({ "gob" }, { "GOB\n" }, &GobArchive::isGobArchive),
+		formatProbe<LfdArchive>({ "lfd" }, { "RMAP" }, &LfdArchive::isLfdArchive),
+		formatProbe<HogArchive>({ "hog" }, { "DHF" }, &HogArchive::isHogArchive),
+		formatProbe<ADatArchive>({ "dat" }, { "ADAT" }, &ADatArchive::isADatArchive),
+		formatProbe<Wad2Archive>({ "wad" }, { "WAD2", "WAD3" }, &Wad2Archive::isWad2Archive),
+		formatProbe<WadJArchive>({ "wad" }, { "IWAD", "PWAD" }, &WadJArchive::isWadJArchive),
+		formatProbe<WolfArchive>({ "wl1", "wl3", "wl6", "sod", "sd1", "sd2", "sd3", "sdm" }, {}, &WolfArchive::isWolfArchive),
+		formatProbe<GZipArchive>({ "gz" }, { "\x1F\x8B\x08" }, &GZipArchive::isGZipArchive),
+		formatProbe<BZip2Archive>({ "bz2" }, { "BZh" }, &BZip2Archive::isBZip2Archive),
+		formatProbe<TarArchive>({ "tar" }, {}, &TarArchive::isTarArchive),
+		formatProbe<DiskArchive>({ "disk" }, {}, &DiskArchive::isDiskArchive),
+		formatProbe<PodArchive>({ "pod" }, {}, &PodArchive::isPodArchive),
+		formatProbe<ChasmBinArchive>({ "bin" }, { "CSid" }, &ChasmBinArchive::isChasmBinArchive),
+		formatProbe<SiNArchive>({ "sin" }, { "SPAK" }, &SiNArchive::isSiNArchive),
+	};
+
+	return probes;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a new (empty) archive of the appropriate type to open the file at
+// [filename], or nullptr if its format is unsupported.
+// The start of the file is read once and checked against the signatures of
+// each format first, so only the full checks of formats with a matching (or
+// without any) signature need to read the file again. Formats with a matching
+// signature are checked before formats without one, and formats usually
+// having the file's extension are checked before others
+// -----------------------------------------------------------------------------
+shared_ptr<Archive> createArchiveForFile(string_view filename)
+{
+	string std_fn{ filename };
+
+	// Read file signature
+	string header;
+	{
+		wxFile file(std_fn);
+		if (file.IsOpened())
+		{
+			char buf[16];
+			auto read = file.Read(buf, sizeof(buf));
+			if (read != wxInvalidOffset)
+				header.assign(buf, read);
+		}
+	}
+
+	// Determine order to check formats in
+	auto extension = strutil::lower(strutil::afterLast(filename, '.'));
+	auto priority  = [&](const ArchiveFormatProbe& probe)
+	{
+		bool signature = false;
+		for (auto sig : probe.signatures)
+			if (strutil::startsWith(header, sig))
+				signature = true;
+		if (!signature && !probe.signatures.empty())
+			return -1; // Can't be this format
+
+		bool ext = std::find(probe.extensions.begin(), probe.extensions.end(), extension) != probe.extensions.end();
+		return (signature ? 2 : 0) + (ext ? 1 : 0);
+	};
+	vector<std::pair<int, const ArchiveFormatProbe*>> probes;
+	for (const auto& probe : archiveFormatProbes())
+		if (auto p = priority(probe); p >= 0)
+			probes.emplace_back(p, &probe);
+	std::stable_sort(probes.begin(), probes.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	// Check formats
+	for (const auto& probe : probes)
+		if (probe.second->is_format(std_fn))
+			return probe.second->create();
+
+	// Unsupported format
+	global::error = "Unsupported or invalid Archive format";
+	return nullptr;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ArchiveManager Class Functions
@@ -289,59 +409,9 @@ shared_ptr<Archive> ArchiveManager::openArchive(string_view filename, bool manag
 	}
 
 	// Determine file format
-	string std_fn{ filename };
-	if (WadArchive::isWadArchive(std_fn))
-		new_archive = std::make_shared<WadArchive>();
-	else if (ZipArchive::isZipArchive(std_fn))
-		new_archive = std::make_shared<ZipArchive>();
-	else if (ResArchive::isResArchive(std_fn))
-		new_archive = std::make_shared<ResArchive>();
-	else if (DatArchive::isDatArchive(std_fn))
-		new_archive = std::make_shared<DatArchive>();
-	else if (LibArchive::isLibArchive(std_fn))
-		new_archive = std::make_shared<LibArchive>();
-	else if (PakArchive::isPakArchive(std_fn))
-		new_archive = std::make_shared<PakArchive>();
-	else if (BSPArchive::isBSPArchive(std_fn))
-		new_archive = std::make_shared<BSPArchive>();
-	else if (GrpArchive::isGrpArchive(std_fn))
-		new_archive = std::make_shared<GrpArchive>();
-	else if (RffArchive::isRffArchive(std_fn))
-		new_archive = std::make_shared<RffArchive>();
-	else if (GobArchive::isGobArchive(std_fn))
-		new_archive = std::make_shared<GobArchive>();
-	else if (LfdArchive::isLfdArchive(std_fn))
-		new_archive = std::make_shared<LfdArchive>();
-	else if (HogArchive::isHogArchive(std_fn))
-		new_archive = std::make_shared<HogArchive>();
-	else if (ADatArchive::isADatArchive(std_fn))
-		new_archive = std::make_shared<ADatArchive>();
-	else if (Wad2Archive::isWad2Archive(std_fn))
-		new_archive = std::make_shared<Wad2Archive>();
-	else if (WadJArchive::isWadJArchive(std_fn))
-		new_archive = std::make_shared<WadJArchive>();
-	else if (WolfArchive::isWolfArchive(std_fn))
-		new_archive = std::make_shared<WolfArchive>();
-	else if (GZipArchive::isGZipArchive(std_fn))
-		new_archive = std::make_shared<GZipArchive>();
-	else if (BZip2Archive::isBZip2Archive(std_fn))
-		new_archive = std::make_shared<BZip2Archive>();
-	else if (TarArchive::isTarArchive(std_fn))
-		new_archive = std::make_shared<TarArchive>();
-	else if (DiskArchive::isDiskArchive(std_fn))
-		new_archive = std::make_shared<DiskArchive>();
-	else if (PodArchive::isPodArchive(std_fn))
-		new_archive = std::make_shared<PodArchive>();
-	else if (ChasmBinArchive::isChasmBinArchive(std_fn))
-		new_archive = std::make_shared<ChasmBinArchive>();
-	else if (SiNArchive::isSiNArchive(std_fn))
-		new_archive = std::make_shared<SiNArchive>();
-	else
-	{
-		// Unsupported format
-		global::error = "Unsupported or invalid Archive format";
+	new_archive = createArchiveForFile(filename);
+	if (!new_archive)
 		return nullptr;
-	}
 
 	// If it opened successfully, add it to the list if needed & return it,
 	// Otherwise, delete it and return nullptr
@@ -372,7 +442,93 @@ shared_ptr<Archive> ArchiveManager::openArchive(string_view filename, bool manag
 }
 
 // -----------------------------------------------------------------------------
-// Same as the above function, except it opens from an ArchiveEntry
+// Opens and adds (if [manage] is true) all archive files in [filenames].
+// The archive files are read concurrently, and are then added in the order
+// given. Returns a list of the opened archives, with nullptr for any that
+// couldn't be opened. If [errors] is given, it is filled with the error
+// message for each archive that couldn't be opened
+// -----------------------------------------------------------------------------
+vector<shared_ptr<Archive>> ArchiveManager::openArchives(
+	const vector<string>& filenames,
+	bool                  manage,
+	bool                  silent,
+	vector<string>*       errors)
+{
+	vector<shared_ptr<Archive>> archives(filenames.size());
+	vector<string>              open_errors(filenames.size());
+
+	// Create archives for files that need reading. Directories, already open
+	// archives and repeated filenames are left for openArchive below
+	vector<unsigned> to_read;
+	for (unsigned a = 0; a < filenames.size(); ++a)
+	{
+		const auto& filename = filenames[a];
+		if (fileutil::dirExists(filename) || getArchive(filename)
+			|| std::find(filenames.begin(), filenames.begin() + a, filename) != filenames.begin() + a)
+			continue;
+
+		archives[a] = createArchiveForFile(filename);
+		if (archives[a])
+			to_read.push_back(a);
+		else
+			open_errors[a] = global::error;
+	}
+
+	// Read archive files
+	threadpool::parallelFor(to_read.size(), [&](size_t index) {
+		auto a = to_read[index];
+		log::info("Opening archive {}", filenames[a]);
+		if (!archives[a]->open(filenames[a]))
+		{
+			open_errors[a] = global::error.empty() ? "Unable to open archive" : global::error;
+			archives[a].reset();
+		}
+	});
+
+	// Add opened archives in order
+	for (unsigned a = 0; a < filenames.size(); ++a)
+	{
+		const auto& filename = filenames[a];
+
+		// Open anything skipped above as normal
+		if (!archives[a] && open_errors[a].empty())
+		{
+			archives[a] = openArchive(filename, manage, silent);
+			if (!archives[a])
+				open_errors[a] = global::error;
+			continue;
+		}
+
+		// Check it opened ok
+		if (!archives[a])
+		{
+			log::error(open_errors[a]);
+			continue;
+		}
+
+		if (manage)
+		{
+			// Add the archive
+			auto index = open_archives_.size();
+			addArchive(archives[a]);
+
+			// Announce open
+			if (!silent)
+				signals_.archive_opened(index);
+
+			// Add to recent files
+			addRecentFile(filename);
+		}
+	}
+
+	if (errors)
+		*errors = std::move(open_errors);
+
+	return archives;
+}
+
+// -----------------------------------------------------------------------------
+// Same as openArchive(filename), except it opens from an ArchiveEntry
 // -----------------------------------------------------------------------------
 shared_ptr<Archive> ArchiveManager::openArchive(ArchiveEntry* entry, bool manage, bool silent)
 {
@@ -1325,7 +1481,47 @@ CONSOLE_COMMAND(list_archives, 0, true)
 // -----------------------------------------------------------------------------
 void c_open(const vector<string>& args)
 {
-	for (const auto& arg : args)
-		app::archiveManager().openArchive(arg);
+	app::archiveManager().openArchives(args);
 }
 ConsoleCommand am_open("open", &c_open, 1, true); // Can't use the macro with this name
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Entry data loaded into memory for each open archive (memory-mapped data is
+// not counted since it doesn't use any heap memory)
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(archive_data, "Archive Entry Data")
+{
+	auto count = [&usage](Archive* archive)
+	{
+		vector<ArchiveEntry*> entries;
+		archive->putEntryTreeAsList(entries);
+
+		memstats::Usage item;
+		item.name = archive->filename(false);
+		for (auto entry : entries)
+		{
+			if (!entry->isLoaded() || entry->data(false).isMapped() || entry->data(false).size() == 0)
+				continue;
+
+			item.bytes += entry->data(false).size();
+			++item.count;
+		}
+		usage.push_back(item);
+	};
+
+	auto& manager = app::archiveManager();
+	for (int a = 0; a < manager.numArchives(); a++)
+		count(manager.getArchive(a).get());
+	if (manager.baseResourceArchive())
+		count(manager.baseResourceArchive());
+	if (manager.programResourceArchive())
+		count(manager.programResourceArchive());
+}
@@ -20,6 +20,11 @@ public:
 	shared_ptr<Archive>         getArchive(ArchiveEntry* parent);
 	shared_ptr<Archive>         openArchive(string_view filename, bool manage = true, bool silent = false);
 	shared_ptr<Archive>         openArchive(ArchiveEntry* entry, bool manage = true, bool silent = false);
+	vector<shared_ptr<Archive>> openArchives(
+		const vector<string>& filenames,
+		bool                  manage = true,
+		bool                  silent = false,
+		vector<string>*       errors = nullptr);
 	shared_ptr<Archive>         openDirArchive(string_view dir, bool manage = true, bool silent = false);
 	shared_ptr<Archive>         newArchive(string_view format);
 	bool                        closeArchive(int index);
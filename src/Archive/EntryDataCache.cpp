@@ -0,0 +1,279 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryDataCache.cpp
+// Description: Keeps track of entry data loaded on demand from archives on
+//              disk, and unloads the least recently used unmodified entry data
+//              when more than the entry_data_budget cvar is loaded (it can be
+//              loaded again from the archive file when next needed)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryDataCache.h"
+#include "Archive.h"
+#include "ArchiveEntry.h"
+#include "General/Console.h"
+#include "General/Misc.h"
+#include "Utility/ThreadPool.h"
+#include <unordered_set>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, entry_data_budget, 1024, CVar::Flag::Save) // In MB, 0 for no limit
+namespace
+{
+// How often (in ms) the budget is checked, each check is one 'tick'
+constexpr int TICK_INTERVAL = 1000;
+
+// Entry data accessed within this many ticks is never unloaded, since
+// something may still be using it
+constexpr uint32_t GRACE_TICKS = 10;
+
+std::unordered_set<ArchiveEntry*> tracked;
+std::mutex                        tracked_mutex;
+std::atomic<unsigned>             n_tracked = 0;
+std::atomic<uint32_t>             tick      = 1;
+unique_ptr<wxTimer>               timer;
+unsigned                          n_unloaded     = 0;
+uint64_t                          unloaded_bytes = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [entry]'s data can be unloaded and loaded again later from
+// its archive file
+// -----------------------------------------------------------------------------
+bool canUnload(const ArchiveEntry* entry)
+{
+	if (!entry->isLoaded() || entry->isLocked() || entry->state() != ArchiveEntry::State::Unmodified)
+		return false;
+
+	// Entries in archives opened from another entry can't be reloaded
+	auto archive = entry->parent();
+	return archive && archive->isOnDisk() && !archive->parentEntry();
+}
+
+// -----------------------------------------------------------------------------
+// Called each tick on the main thread, unloads entry data if over budget
+// -----------------------------------------------------------------------------
+void onTick()
+{
+	++tick;
+
+	// Don't unload anything while background tasks might be reading entry data
+	if (entry_data_budget > 0 && threadpool::pool().idle())
+		entrycache::trim(static_cast<uint64_t>(entry_data_budget) * 1024 * 1024);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryCache Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Starts checking the loaded entry data against the budget periodically.
+// Must be called from the main thread
+// -----------------------------------------------------------------------------
+void entrycache::init()
+{
+	timer = std::make_unique<wxTimer>();
+	timer->Bind(wxEVT_TIMER, [](wxTimerEvent&) { onTick(); });
+	timer->Start(TICK_INTERVAL);
+}
+
+// -----------------------------------------------------------------------------
+// Stops checking the loaded entry data and clears all tracked entries
+// -----------------------------------------------------------------------------
+void entrycache::shutdown()
+{
+	if (timer)
+		timer->Stop();
+	timer.reset();
+
+	std::lock_guard lock(tracked_mutex);
+	tracked.clear();
+	n_tracked = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current tick, entries are marked with this when their data is
+// accessed
+// -----------------------------------------------------------------------------
+uint32_t entrycache::currentTick()
+{
+	return tick.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Starts tracking [entry], which has just had its data loaded from its archive
+// -----------------------------------------------------------------------------
+void entrycache::dataLoaded(ArchiveEntry* entry)
+{
+	std::lock_guard lock(tracked_mutex);
+	if (tracked.insert(entry).second)
+		++n_tracked;
+}
+
+// -----------------------------------------------------------------------------
+// Stops tracking [entry], called when it is deleted
+// -----------------------------------------------------------------------------
+void entrycache::entryDeleted(ArchiveEntry* entry)
+{
+	if (n_tracked == 0)
+		return;
+
+	std::lock_guard lock(tracked_mutex);
+	if (tracked.erase(entry) > 0)
+		--n_tracked;
+}
+
+// -----------------------------------------------------------------------------
+// Unloads the data of the least recently accessed tracked entries until no
+// more than [max_bytes] is loaded. Entries accessed recently are skipped
+// unless [force] is true
+// -----------------------------------------------------------------------------
+void entrycache::trim(uint64_t max_bytes, bool force)
+{
+	std::lock_guard lock(tracked_mutex);
+
+	// Stop tracking entries that were unloaded elsewhere, and get the total
+	// size of those still loaded
+	uint64_t loaded = 0;
+	for (auto i = tracked.begin(); i != tracked.end();)
+	{
+		if (!(*i)->isLoaded())
+		{
+			i = tracked.erase(i);
+			--n_tracked;
+			continue;
+		}
+
+		loaded += (*i)->size();
+		++i;
+	}
+	if (loaded <= max_bytes)
+		return;
+
+	// Get entries that can be unloaded, least recently accessed first
+	auto                  now = currentTick();
+	vector<ArchiveEntry*> candidates;
+	for (auto* entry : tracked)
+		if (canUnload(entry) && (force || now - entry->lastAccess() >= GRACE_TICKS))
+			candidates.push_back(entry);
+	std::sort(
+		candidates.begin(),
+		candidates.end(),
+		[](const ArchiveEntry* left, const ArchiveEntry* right) { return left->lastAccess() < right->lastAccess(); });
+
+	// Unload until within the limit
+	for (auto* entry : candidates)
+	{
+		if (loaded <= max_bytes)
+			break;
+
+		auto size = entry->size();
+		entry->unloadData();
+		if (entry->isLoaded())
+			continue;
+
+		loaded -= size;
+		unloaded_bytes += size;
+		++n_unloaded;
+		tracked.erase(entry);
+		--n_tracked;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current tracked entry data statistics
+// -----------------------------------------------------------------------------
+entrycache::Stats entrycache::stats()
+{
+	std::lock_guard lock(tracked_mutex);
+
+	Stats stats;
+	stats.tracked        = tracked.size();
+	stats.unloaded       = n_unloaded;
+	stats.unloaded_bytes = unloaded_bytes;
+	for (auto* entry : tracked)
+		if (entry->isLoaded())
+			stats.loaded_bytes += entry->size();
+
+	return stats;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Logs the entry data cache statistics, or unloads all unused entry data if
+// 'trim' is given. Usage:
+// entry_cache [trim]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(entry_cache, 0, true)
+{
+	if (!args.empty() && args[0] == "trim")
+	{
+		if (threadpool::pool().idle())
+			entrycache::trim(0, true);
+		else
+			log::console("Background tasks are running, try again later");
+	}
+
+	auto stats = entrycache::stats();
+	log::console(
+		fmt::format(
+			"Entry data budget: {}",
+			entry_data_budget > 0 ? fmt::format("{}MB", entry_data_budget.value) : "unlimited"));
+	log::console(
+		fmt::format(
+			"Loaded on demand: {} in {} entries",
+			misc::sizeAsString(static_cast<uint32_t>(std::min<uint64_t>(stats.loaded_bytes, UINT32_MAX))),
+			stats.tracked));
+	log::console(fmt::format("Unloaded: {} times, {}MB total", stats.unloaded, stats.unloaded_bytes / (1024 * 1024)));
+}
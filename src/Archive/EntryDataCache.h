@@ -0,0 +1,29 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+
+// Keeps track of entry data loaded on demand from archives on disk, unloading
+// the least recently used (unmodified) entry data when more than the
+// entry_data_budget cvar is loaded
+namespace entrycache
+{
+	struct Stats
+	{
+		unsigned tracked        = 0; // Number of entries with loaded data being tracked
+		uint64_t loaded_bytes   = 0;
+		unsigned unloaded       = 0; // Number of times entry data has been unloaded
+		uint64_t unloaded_bytes = 0;
+	};
+
+	void init();
+	void shutdown();
+
+	uint32_t currentTick();
+	void     dataLoaded(ArchiveEntry* entry);
+	void     entryDeleted(ArchiveEntry* entry);
+	void     trim(uint64_t max_bytes, bool force = false);
+	Stats    stats();
+} // namespace entrycache
+} // namespace slade
@@ -0,0 +1,163 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryDataReader.cpp
+// Description: EntryDataReader classes, for reading parts of an entry's data
+//              from memory or directly from a file on disk
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryDataReader.h"
+#include "UI/WxUtils.h"
+#include "Utility/FileUtils.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the number of bytes of [mc] to read from [offset], [size] or the
+// rest of [mc] if [size] is 0
+// -----------------------------------------------------------------------------
+unsigned readSize(const MemChunk& mc, unsigned offset, unsigned size)
+{
+	if (offset >= mc.size())
+		return 0;
+
+	auto left = mc.size() - offset;
+	return size > 0 && size < left ? size : left;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryDataReader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Moves the read position to [offset] from the start of the data.
+// Returns false if [offset] is past the end of the data
+// -----------------------------------------------------------------------------
+bool EntryDataReader::seekFromStart(unsigned offset)
+{
+	if (offset > size_)
+		return false;
+
+	pos_ = offset;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads [count] bytes from the current position into [buffer].
+// Returns false if there isn't enough data left or it couldn't be read
+// -----------------------------------------------------------------------------
+bool EntryDataReader::read(void* buffer, unsigned count)
+{
+	if (count == 0)
+		return true;
+	if (pos_ + count > size_ || pos_ + count < pos_)
+		return false;
+
+	if (!readAt(pos_, buffer, count))
+		return false;
+
+	pos_ += count;
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MemDataReader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MemDataReader class constructor, reads [size] bytes of [mc] starting at
+// [offset] (to the end of [mc] if [size] is 0)
+// -----------------------------------------------------------------------------
+MemDataReader::MemDataReader(const MemChunk& mc, unsigned offset, unsigned size) :
+	EntryDataReader{ readSize(mc, offset, size) },
+	mapping_{ mc.mapping() }
+{
+	if (offset < mc.size())
+		data_ = mc.data() + offset;
+}
+
+// -----------------------------------------------------------------------------
+// Copies [count] bytes at [offset] into [buffer]
+// -----------------------------------------------------------------------------
+bool MemDataReader::readAt(unsigned offset, void* buffer, unsigned count)
+{
+	if (!data_)
+		return false;
+
+	memcpy(buffer, data_ + offset, count);
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// FileDataReader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// FileDataReader class constructor, opens the file at [filename] to read
+// [size] bytes starting at [offset]
+// -----------------------------------------------------------------------------
+FileDataReader::FileDataReader(string_view filename, unsigned offset, unsigned size) :
+	EntryDataReader{ size },
+	offset_{ offset }
+{
+	if (fileutil::fileExists(filename))
+		file_.Open(wxutil::strFromView(filename));
+}
+
+// -----------------------------------------------------------------------------
+// Reads [count] bytes at [offset] (from the start of the data) in the file
+// into [buffer]
+// -----------------------------------------------------------------------------
+bool FileDataReader::readAt(unsigned offset, void* buffer, unsigned count)
+{
+	if (!file_.IsOpened() || file_.Seek(offset_ + offset, wxFromStart) == wxInvalidOffset)
+		return false;
+
+	return file_.Read(buffer, count) == static_cast<ssize_t>(count);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Utility/SeekableData.h"
+
+namespace slade
+{
+class MappedFile;
+class MemChunk;
+
+// Read-only SeekableData for reading an entry's data in parts, without needing
+// to load all of it into memory first
+class EntryDataReader : public SeekableData
+{
+public:
+	EntryDataReader(unsigned size) : size_{ size } {}
+	~EntryDataReader() override = default;
+
+	unsigned currentPos() const override { return pos_; }
+	unsigned size() const override { return size_; }
+
+	bool seek(unsigned offset) override { return seekFromStart(pos_ + offset); }
+	bool seekFromStart(unsigned offset) override;
+	bool seekFromEnd(unsigned offset) override { return offset <= size_ && seekFromStart(size_ - offset); }
+
+	bool read(void* buffer, unsigned count) override;
+	bool write(const void* buffer, unsigned count) override { return false; }
+
+protected:
+	// Reads [count] bytes at [offset] (within bounds) into [buffer]
+	virtual bool readAt(unsigned offset, void* buffer, unsigned count) = 0;
+
+private:
+	unsigned size_ = 0;
+	unsigned pos_  = 0;
+};
+
+// Reads data in memory. If the data is a view into a memory-mapped file the
+// mapping is kept open by the reader, otherwise the data must remain valid
+// while the reader is used
+class MemDataReader : public EntryDataReader
+{
+public:
+	MemDataReader(const MemChunk& mc, unsigned offset = 0, unsigned size = 0);
+	~MemDataReader() override = default;
+
+protected:
+	bool readAt(unsigned offset, void* buffer, unsigned count) override;
+
+private:
+	const uint8_t*         data_ = nullptr;
+	shared_ptr<MappedFile> mapping_;
+};
+
+// Reads [size] bytes starting at [offset] in a file on disk
+class FileDataReader : public EntryDataReader
+{
+public:
+	FileDataReader(string_view filename, unsigned offset, unsigned size);
+	~FileDataReader() override = default;
+
+	bool isOk() const { return file_.IsOpened(); }
+
+protected:
+	bool readAt(unsigned offset, void* buffer, unsigned count) override;
+
+private:
+	wxFile   file_;
+	unsigned offset_ = 0;
+};
+} // namespace slade
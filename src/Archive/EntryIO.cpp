@@ -0,0 +1,315 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryIO.cpp
+// Description: Functions for importing files to (or exporting entries from)
+//              an archive in bulk. File I/O is done in parallel on the thread
+//              pool, and the imported entries are added to the archive together
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryIO.h"
+#include "Archive.h"
+#include "EntryDataReader.h"
+#include "EntryType/EntryType.h"
+#include "General/UI.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+#include <filesystem>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr size_t   IO_BATCH_SIZE      = 256;     // Files read/written per batch (limits open files at once)
+constexpr unsigned EXPORT_BUFFER_SIZE = 1 << 20; // Size of the chunks entry data is exported in
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads the file at [path] into [data].
+// Returns an error message if it couldn't be read
+// -----------------------------------------------------------------------------
+string readFile(const string& path, MemChunk& data)
+{
+	SFile file;
+	if (!file.open(path))
+		return fmt::format("Unable to open file {}", path);
+
+	if (!file.read(data, file.size()))
+		return fmt::format("Unable to read file {}", path);
+
+	return {};
+}
+
+// -----------------------------------------------------------------------------
+// Writes all data from [reader] to a new file at [path].
+// Returns an error message if it couldn't be written
+// -----------------------------------------------------------------------------
+string writeFile(EntryDataReader& reader, const string& path)
+{
+	SFile file;
+	if (!file.open(path, SFile::Mode::Write))
+		return fmt::format("Unable to open file {} for writing", path);
+
+	vector<uint8_t> buffer(std::min(reader.size(), EXPORT_BUFFER_SIZE));
+	reader.seekFromStart(0);
+	while (reader.currentPos() < reader.size())
+	{
+		auto count = std::min<unsigned>(buffer.size(), reader.size() - reader.currentPos());
+		if (!reader.read(buffer.data(), count))
+			return fmt::format("Unable to read entry data for file {}", path);
+		if (!file.write(buffer.data(), count))
+			return fmt::format("Unable to write to file {}", path);
+	}
+
+	return {};
+}
+
+// -----------------------------------------------------------------------------
+// Adds all non-empty [messages] to [errors] (if given), one per line
+// -----------------------------------------------------------------------------
+void addErrors(string* errors, const vector<string>& messages)
+{
+	if (!errors)
+		return;
+
+	for (const auto& message : messages)
+		if (!message.empty())
+			*errors += fmt::format("{}\n", message);
+}
+
+// -----------------------------------------------------------------------------
+// Adds all entries in [dir] (and its subdirs) to [entries], with the paths to
+// export them to (within [path]) in [paths]. Directories to export to are
+// created as needed
+// -----------------------------------------------------------------------------
+void getDirExports(ArchiveDir& dir, const string& path, vector<ArchiveEntry*>& entries, vector<string>& paths)
+{
+	if (!fileutil::dirExists(path))
+		fileutil::createDir(path);
+
+	for (auto& entry : dir.entries())
+	{
+		// Setup entry filename, adding a file extension if it doesn't have one
+		strutil::Path fn(entry->name());
+		fn.setPath(path);
+		if (!fn.hasExtension())
+			fn.setExtension(entry->type()->extension());
+
+		entries.push_back(entry.get());
+		paths.push_back(fn.fullPath());
+	}
+
+	for (auto& subdir : dir.subdirs())
+		getDirExports(*subdir, fmt::format("{}/{}", path, subdir->name()), entries, paths);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryIO Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns import info for the files at [paths], using their filenames as entry
+// names
+// -----------------------------------------------------------------------------
+vector<entryio::ImportFile> entryio::filesToImport(const vector<string>& paths)
+{
+	vector<ImportFile> files;
+	files.reserve(paths.size());
+	for (const auto& path : paths)
+		files.push_back({ path, string{ strutil::Path::fileNameOf(path) }, {} });
+
+	return files;
+}
+
+// -----------------------------------------------------------------------------
+// Returns import info for all files in [directory] (including subdirectories),
+// keeping the same directory structure
+// -----------------------------------------------------------------------------
+vector<entryio::ImportFile> entryio::dirFilesToImport(string_view directory)
+{
+	vector<ImportFile> files;
+	for (const auto& item : std::filesystem::recursive_directory_iterator{ directory })
+	{
+		if (!item.is_regular_file())
+			continue;
+
+		auto          file = item.path().string();
+		strutil::Path fn{ strutil::replace(file, directory, "") }; // Remove directory from entry name
+
+		// Split filename into dir+name, removing any beginning \ or / from dir
+		auto edir = fn.path();
+		if (strutil::startsWith(edir, '\\') || strutil::startsWith(edir, '/'))
+			edir.remove_prefix(1);
+
+		files.push_back({ file, string{ fn.fileName() }, string{ edir } });
+	}
+
+	return files;
+}
+
+// -----------------------------------------------------------------------------
+// Imports [files] as new entries in [archive], added to [dir] (or the root dir)
+// from [position] onwards (or at the end).
+// The files are read in parallel, then the entries are added to the archive
+// in order on the calling thread and (if [detect_types] is true) their types
+// are detected in parallel.
+// Returns the entries that were added, any errors are added to [errors]
+// -----------------------------------------------------------------------------
+vector<shared_ptr<ArchiveEntry>> entryio::importFiles(
+	Archive&                  archive,
+	const vector<ImportFile>& files,
+	ArchiveDir*               dir,
+	unsigned                  position,
+	string*                   errors,
+	bool                      detect_types)
+{
+	vector<MemChunk> data(files.size());
+	vector<string>   messages(files.size());
+
+	// Read files
+	for (size_t start = 0; start < files.size(); start += IO_BATCH_SIZE)
+	{
+		ui::setSplashProgress(static_cast<float>(start) / static_cast<float>(files.size()));
+
+		auto count = std::min(IO_BATCH_SIZE, files.size() - start);
+		threadpool::parallelFor(count, [&](size_t index) {
+			messages[start + index] = readFile(files[start + index].path, data[start + index]);
+		});
+	}
+
+	// Add entries
+	auto dir_shared = dir ? ArchiveDir::getShared(dir) : nullptr;
+	vector<shared_ptr<ArchiveEntry>> entries;
+	entries.reserve(files.size());
+	for (size_t a = 0; a < files.size(); ++a)
+	{
+		if (!messages[a].empty())
+			continue;
+
+		// Get the dir to add the entry to
+		auto entry_dir = dir;
+		if (!files[a].dir.empty() && archive.formatDesc().supports_dirs)
+			entry_dir = archive.createDir(files[a].dir, dir_shared).get();
+
+		auto entry = archive.addNewEntry(files[a].name, position, entry_dir);
+		if (!entry)
+		{
+			messages[a] = fmt::format("Unable to add entry for file {}", files[a].path);
+			continue;
+		}
+
+		// Give the data to the entry (clearing it here so the entry doesn't
+		// share the data with anything)
+		if (data[a].hasData())
+			entry->importMemChunk(data[a]);
+		data[a].clear();
+
+		if (position != 0xFFFFFFFF && entry_dir == dir)
+			++position;
+
+		entries.push_back(entry);
+	}
+
+	// Detect types
+	if (detect_types)
+	{
+		vector<ArchiveEntry*> detect;
+		detect.reserve(entries.size());
+		for (const auto& entry : entries)
+			detect.push_back(entry.get());
+		EntryType::detectEntryTypes(detect);
+	}
+
+	addErrors(errors, messages);
+
+	return entries;
+}
+
+// -----------------------------------------------------------------------------
+// Exports [entries] to files at the matching [paths], written in parallel.
+// Returns the number of entries exported, any errors are added to [errors]
+// -----------------------------------------------------------------------------
+unsigned entryio::exportEntries(const vector<ArchiveEntry*>& entries, const vector<string>& paths, string* errors)
+{
+	vector<string> messages(entries.size());
+	auto           total = std::min(entries.size(), paths.size());
+	for (size_t start = 0; start < total; start += IO_BATCH_SIZE)
+	{
+		ui::setSplashProgress(static_cast<float>(start) / static_cast<float>(total));
+
+		// Get readers for the entries' data here, since it may need to be
+		// loaded from the archive (readers of data that isn't loaded have
+		// their own file handle, so they can be read from separate threads)
+		auto                                count = std::min(IO_BATCH_SIZE, total - start);
+		vector<unique_ptr<EntryDataReader>> readers(count);
+		for (size_t a = 0; a < count; ++a)
+			readers[a] = entries[start + a]->dataReader();
+
+		threadpool::parallelFor(count, [&](size_t index) {
+			messages[start + index] = writeFile(*readers[index], paths[start + index]);
+		});
+	}
+
+	addErrors(errors, messages);
+
+	return static_cast<unsigned>(std::count(messages.begin(), messages.begin() + total, string{}));
+}
+
+// -----------------------------------------------------------------------------
+// Exports all entries in [dir] (including subdirs) to files within [path],
+// written in parallel.
+// Returns the number of entries exported, any errors are added to [errors]
+// -----------------------------------------------------------------------------
+unsigned entryio::exportDir(ArchiveDir& dir, string_view path, string* errors)
+{
+	vector<ArchiveEntry*> entries;
+	vector<string>        paths;
+	getDirExports(dir, string{ path }, entries, paths);
+
+	return exportEntries(entries, paths, errors);
+}
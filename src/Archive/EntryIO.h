@@ -0,0 +1,37 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+class ArchiveDir;
+class ArchiveEntry;
+
+namespace entryio
+{
+	// A file to import as entry [name], in the dir at [dir] (relative to the
+	// dir being imported to)
+	struct ImportFile
+	{
+		string path;
+		string name;
+		string dir;
+	};
+
+	vector<ImportFile> filesToImport(const vector<string>& paths);
+	vector<ImportFile> dirFilesToImport(string_view directory);
+
+	vector<shared_ptr<ArchiveEntry>> importFiles(
+		Archive&                  archive,
+		const vector<ImportFile>& files,
+		ArchiveDir*               dir          = nullptr,
+		unsigned                  position     = 0xFFFFFFFF,
+		string*                   errors       = nullptr,
+		bool                      detect_types = true);
+
+	unsigned exportEntries(
+		const vector<ArchiveEntry*>& entries,
+		const vector<string>&        paths,
+		string*                      errors = nullptr);
+	unsigned exportDir(ArchiveDir& dir, string_view path, string* errors = nullptr);
+} // namespace entryio
+} // namespace slade
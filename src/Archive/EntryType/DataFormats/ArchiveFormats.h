@@ -6,7 +6,7 @@ public:
 	WadDataFormat() : EntryDataFormat("archive_wad") {}
 	~WadDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return WadArchive::isWadArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return WadArchive::isWadArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class ZipDataFormat : public EntryDataFormat
@@ -15,7 +15,7 @@ public:
 	ZipDataFormat() : EntryDataFormat("archive_zip") {}
 	~ZipDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return ZipArchive::isZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return ZipArchive::isZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class LibDataFormat : public EntryDataFormat
@@ -24,7 +24,7 @@ public:
 	LibDataFormat() : EntryDataFormat("archive_lib") {}
 	~LibDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return LibArchive::isLibArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return LibArchive::isLibArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class DatDataFormat : public EntryDataFormat
@@ -33,7 +33,7 @@ public:
 	DatDataFormat() : EntryDataFormat("archive_dat") {}
 	~DatDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return DatArchive::isDatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return DatArchive::isDatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class ResDataFormat : public EntryDataFormat
@@ -42,7 +42,7 @@ public:
 	ResDataFormat() : EntryDataFormat("archive_res") {}
 	~ResDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return ResArchive::isResArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return ResArchive::isResArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class PakDataFormat : public EntryDataFormat
@@ -51,7 +51,7 @@ public:
 	PakDataFormat() : EntryDataFormat("archive_pak") {}
 	~PakDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class BSPDataFormat : public EntryDataFormat
@@ -60,7 +60,7 @@ public:
 	BSPDataFormat() : EntryDataFormat("archive_bsp") {}
 	~BSPDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return BSPArchive::isBSPArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return BSPArchive::isBSPArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class Wad2DataFormat : public EntryDataFormat
@@ -69,7 +69,7 @@ public:
 	Wad2DataFormat() : EntryDataFormat("archive_wad2") {}
 	~Wad2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return Wad2Archive::isWad2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return Wad2Archive::isWad2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class WadJDataFormat : public EntryDataFormat
@@ -78,7 +78,7 @@ public:
 	WadJDataFormat() : EntryDataFormat("archive_wadj") {}
 	~WadJDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return WadJArchive::isWadJArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return WadJArchive::isWadJArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class GrpDataFormat : public EntryDataFormat
@@ -87,7 +87,7 @@ public:
 	GrpDataFormat() : EntryDataFormat("archive_grp") {}
 	~GrpDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return GrpArchive::isGrpArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return GrpArchive::isGrpArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class RffDataFormat : public EntryDataFormat
@@ -96,7 +96,7 @@ public:
 	RffDataFormat() : EntryDataFormat("archive_rff") {}
 	~RffDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return RffArchive::isRffArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return RffArchive::isRffArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class GobDataFormat : public EntryDataFormat
@@ -105,7 +105,7 @@ public:
 	GobDataFormat() : EntryDataFormat("archive_gob") {}
 	~GobDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return GobArchive::isGobArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return GobArchive::isGobArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class LfdDataFormat : public EntryDataFormat
@@ -114,7 +114,7 @@ public:
 	LfdDataFormat() : EntryDataFormat("archive_lfd") {}
 	~LfdDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return LfdArchive::isLfdArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return LfdArchive::isLfdArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class ADatDataFormat : public EntryDataFormat
@@ -123,7 +123,7 @@ public:
 	ADatDataFormat() : EntryDataFormat("archive_adat") {}
 	~ADatDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return ADatArchive::isADatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return ADatArchive::isADatArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class HogDataFormat : public EntryDataFormat
@@ -132,7 +132,7 @@ public:
 	HogDataFormat() : EntryDataFormat("archive_hog") {}
 	~HogDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return HogArchive::isHogArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return HogArchive::isHogArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class WolfDataFormat : public EntryDataFormat
@@ -141,7 +141,7 @@ public:
 	WolfDataFormat() : EntryDataFormat("archive_wolf") {}
 	~WolfDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return WolfArchive::isWolfArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return WolfArchive::isWolfArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class GZipDataFormat : public EntryDataFormat
@@ -150,7 +150,7 @@ public:
 	GZipDataFormat() : EntryDataFormat("archive_gzip") {}
 	~GZipDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return GZipArchive::isGZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return GZipArchive::isGZipArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class BZip2DataFormat : public EntryDataFormat
@@ -159,7 +159,7 @@ public:
 	BZip2DataFormat() : EntryDataFormat("archive_bz2") {}
 	~BZip2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return BZip2Archive::isBZip2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return BZip2Archive::isBZip2Archive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class TarDataFormat : public EntryDataFormat
@@ -168,7 +168,7 @@ public:
 	TarDataFormat() : EntryDataFormat("archive_tar") {}
 	~TarDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return TarArchive::isTarArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return TarArchive::isTarArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class DiskDataFormat : public EntryDataFormat
@@ -177,7 +177,7 @@ public:
 	DiskDataFormat() : EntryDataFormat("archive_disk") {}
 	~DiskDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return PakArchive::isPakArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
 
 class PodArchiveDataFormat : public EntryDataFormat
@@ -186,7 +186,7 @@ public:
 	PodArchiveDataFormat() : EntryDataFormat("archive_pod") {}
 	~PodArchiveDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return PodArchive::isPodArchive(mc) ? MATCH_PROBABLY : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return PodArchive::isPodArchive(mc) ? MATCH_PROBABLY : MATCH_FALSE; }
 };
 
 class ChasmBinArchiveDataFormat : public EntryDataFormat
@@ -194,7 +194,7 @@ class ChasmBinArchiveDataFormat : public EntryDataFormat
 public:
 	ChasmBinArchiveDataFormat() : EntryDataFormat("archive_chasm_bin") {}
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		return ChasmBinArchive::isChasmBinArchive(mc) ? MATCH_TRUE : MATCH_FALSE;
 	}
@@ -205,5 +205,5 @@ class SinArchiveDataFormat : public EntryDataFormat
 public:
 	SinArchiveDataFormat() : EntryDataFormat("archive_sin") {}
 
-	int isThisFormat(MemChunk& mc) override { return SiNArchive::isSiNArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return SiNArchive::isSiNArchive(mc) ? MATCH_TRUE : MATCH_FALSE; }
 };
@@ -8,7 +8,7 @@ public:
 	PNGDataFormat() : EntryDataFormat("img_png") {}
 	~PNGDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 8)
@@ -29,7 +29,7 @@ public:
 	BMPDataFormat() : EntryDataFormat("img_bmp"){};
 	~BMPDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 30)
@@ -61,7 +61,7 @@ public:
 	GIFDataFormat() : EntryDataFormat("img_gif"){};
 	~GIFDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 6)
@@ -82,7 +82,7 @@ public:
 	PCXDataFormat() : EntryDataFormat("img_pcx"){};
 	~PCXDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() < 129)
@@ -156,7 +156,7 @@ public:
 	TGADataFormat() : EntryDataFormat("img_tga"){};
 	~TGADataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Size check for the header
 		if (mc.size() < 18)
@@ -204,7 +204,7 @@ public:
 	TIFFDataFormat() : EntryDataFormat("img_tiff"){};
 	~TIFFDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size, minimum size is 26 if I'm not mistaken:
 		// 8 for the image header, +2 for at least one image
@@ -247,7 +247,7 @@ public:
 	JPEGDataFormat() : EntryDataFormat("img_jpeg"){};
 	~JPEGDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 128)
@@ -273,7 +273,7 @@ public:
 	ILBMDataFormat() : EntryDataFormat("img_ilbm"){};
 	~ILBMDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 48)
@@ -303,7 +303,7 @@ public:
 	DoomGfxDataFormat() : EntryDataFormat("img_doom"){};
 	~DoomGfxDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -353,7 +353,7 @@ public:
 	DoomGfxAlphaDataFormat() : EntryDataFormat("img_doom_alpha"){};
 	~DoomGfxAlphaDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > sizeof(gfx::OldPatchHeader))
@@ -409,7 +409,7 @@ public:
 	DoomGfxBetaDataFormat() : EntryDataFormat("img_doom_beta"){};
 	~DoomGfxBetaDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() <= sizeof(gfx::PatchHeader))
@@ -485,7 +485,7 @@ public:
 	 *	next WxH bytes contain the bitmap for columns 1, 5, 9,
 	 *	etc., and so on. No transparency.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() < 6)
@@ -518,7 +518,7 @@ public:
 	 * To be honest, I'm not actually sure there are offset fields
 	 * since those values always seem to be set to 0, but hey.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::PatchHeader))
 			return MATCH_FALSE;
@@ -547,7 +547,7 @@ public:
 
 	/* This format is used in the Jaguar Doom IWAD.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::JagPicHeader))
 			return MATCH_FALSE;
@@ -583,7 +583,7 @@ public:
 	/* This format is used in the Jaguar Doom IWAD. It can be recognized by the fact the last 320 bytes are a copy of
 	 * the first.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		// Smallest pic size 832 (32x16), largest pic size 33088 (256x128)
@@ -610,7 +610,7 @@ public:
 
 	/* This format is used in the Jaguar Doom IWAD. It is an annoying format.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 16)
@@ -649,7 +649,7 @@ public:
 	DoomPSXDataFormat() : EntryDataFormat("img_doom_psx"){};
 	~DoomPSXDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::PSXPicHeader))
 			return MATCH_FALSE;
@@ -677,7 +677,7 @@ public:
 	IMGZDataFormat() : EntryDataFormat("img_imgz"){};
 	~IMGZDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// A format created by Randy Heit and used by some crosshairs in ZDoom.
 		uint32_t size = mc.size();
@@ -714,7 +714,7 @@ public:
 
 	// A data format found while rifling through some Legacy mods,
 	// specifically High Tech Hell 2. It seems to be how it works.
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		uint32_t size = mc.size();
 		if (size < 9)
@@ -740,7 +740,7 @@ public:
 	~QuakeSpriteDataFormat() = default;
 
 	// A Quake sprite can contain several frames and each frame may contain several pictures.
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		uint32_t size = mc.size();
 		// Minimum size for a sprite with a single frame containing a single 2x2 picture
@@ -814,7 +814,7 @@ public:
 	QuakeTexDataFormat() : EntryDataFormat("img_quaketex"){};
 	~QuakeTexDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 125)
@@ -840,7 +840,7 @@ public:
 	QuakeIIWalDataFormat() : EntryDataFormat("img_quake2wal"){};
 	~QuakeIIWalDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 101)
@@ -884,7 +884,7 @@ public:
 	ShadowCasterGfxFormat() : EntryDataFormat("img_scgfx"){};
 	~ShadowCasterGfxFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// If those were static functions, then I could
 		// just do this instead of such copypasta:
@@ -914,7 +914,7 @@ public:
 	ShadowCasterSpriteFormat() : EntryDataFormat("img_scsprite"){};
 	~ShadowCasterSpriteFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		int size = mc.size();
 		if (size < 4)
@@ -969,7 +969,7 @@ public:
 	ShadowCasterWallFormat() : EntryDataFormat("img_scwall"){};
 	~ShadowCasterWallFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		int size = mc.size();
 		// Minimum valid size for such a picture to be
@@ -986,7 +986,7 @@ public:
 	AnaMipImageFormat() : EntryDataFormat("img_mipimage"){};
 	~AnaMipImageFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 4)
@@ -1006,7 +1006,7 @@ public:
 	BuildTileFormat() : EntryDataFormat("img_arttile"){};
 	~BuildTileFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 16)
@@ -1048,7 +1048,7 @@ public:
 	Heretic2M8Format() : EntryDataFormat("img_m8"){};
 	~Heretic2M8Format() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 1040)
@@ -1080,7 +1080,7 @@ public:
 	Heretic2M32Format() : EntryDataFormat("img_m32"){};
 	~Heretic2M32Format() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 1040)
@@ -1112,7 +1112,7 @@ public:
 	HalfLifeTextureFormat() : EntryDataFormat("img_hlt"){};
 	~HalfLifeTextureFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 812)
@@ -1147,7 +1147,7 @@ public:
 	RottGfxDataFormat() : EntryDataFormat("img_rott"){};
 	~RottGfxDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -1197,7 +1197,7 @@ public:
 	RottTransGfxDataFormat() : EntryDataFormat("img_rottmask"){};
 	~RottTransGfxDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -1248,7 +1248,7 @@ public:
 	RottLBMDataFormat() : EntryDataFormat("img_rottlbm"){};
 	~RottLBMDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		const uint8_t* data = mc.data();
 
@@ -1274,7 +1274,7 @@ public:
 	/* How many format does ROTT need? This is just like the raw data plus header
 	 * format from the Doom alpha, except that it's column-major instead of row-major.
 	 */
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() < sizeof(gfx::PatchHeader))
 			return MATCH_FALSE;
@@ -1302,7 +1302,7 @@ public:
 	~RottPicDataFormat() = default;
 
 	// Yet another ROTT image format. Cheesus.
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 8)
@@ -1322,7 +1322,7 @@ public:
 	~WolfPicDataFormat() = default;
 
 	// Wolf picture format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 4)
@@ -1341,7 +1341,7 @@ public:
 	~WolfSpriteDataFormat() = default;
 
 	// Wolf picture format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size < 8 || size > 4228)
@@ -1361,7 +1361,7 @@ public:
 	~JediBMFormat() = default;
 
 	// Jedi engine bitmap format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 32)
@@ -1388,7 +1388,7 @@ public:
 	~JediFMEFormat() = default;
 
 	// Jedi engine frame format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 64)
@@ -1441,7 +1441,7 @@ public:
 	~JediWAXFormat() = default;
 
 	// Jedi engine wax format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 460)
@@ -1475,7 +1475,7 @@ public:
 	Font0DataFormat() : EntryDataFormat("font_doom_alpha"){};
 	~Font0DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() <= 0x302)
 			return MATCH_FALSE;
@@ -1507,7 +1507,7 @@ public:
 	Font1DataFormat() : EntryDataFormat("font_zd_console"){};
 	~Font1DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -1526,7 +1526,7 @@ public:
 	Font2DataFormat() : EntryDataFormat("font_zd_big"){};
 	~Font2DataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -1545,7 +1545,7 @@ public:
 	BMFontDataFormat() : EntryDataFormat("font_bmf"){};
 	~BMFontDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -1564,7 +1564,7 @@ public:
 	FontWolfDataFormat() : EntryDataFormat("font_wolf"){};
 	~FontWolfDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		if (mc.size() <= 0x302)
 			return MATCH_FALSE;
@@ -1597,7 +1597,7 @@ public:
 	~JediFNTFormat() = default;
 
 	// Jedi engine fnt format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 35)
@@ -1625,7 +1625,7 @@ public:
 	~JediFONTFormat() = default;
 
 	// Jedi engine font format
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		size_t size = mc.size();
 		if (size > 16)
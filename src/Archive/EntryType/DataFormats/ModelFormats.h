@@ -6,7 +6,7 @@ public:
 	DMDModelDataFormat() : EntryDataFormat("mesh_dmd"){};
 	~DMDModelDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -25,7 +25,7 @@ public:
 	MDLModelDataFormat() : EntryDataFormat("mesh_mdl"){};
 	~MDLModelDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -44,7 +44,7 @@ public:
 	MD2ModelDataFormat() : EntryDataFormat("mesh_md2"){};
 	~MD2ModelDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -63,7 +63,7 @@ public:
 	MD3ModelDataFormat() : EntryDataFormat("mesh_md3"){};
 	~MD3ModelDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size
 		if (mc.size() > 4)
@@ -82,20 +82,15 @@ public:
 	VOXVoxelDataFormat() : EntryDataFormat("voxel_vox"){};
 	~VOXVoxelDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size: 12 bytes for dimensions and 768 for palette,
 		// so 780 bytes for an empty voxel object.
 		if (mc.size() > 780)
 		{
-			uint32_t x, y, z;
-			mc.seek(0, SEEK_SET);
-			mc.read(&x, 4);
-			x = wxINT32_SWAP_ON_BE(x);
-			mc.read(&y, 4);
-			y = wxINT32_SWAP_ON_BE(y);
-			mc.read(&z, 4);
-			z = wxINT32_SWAP_ON_BE(z);
+			uint32_t x = mc.readL32(0);
+			uint32_t y = mc.readL32(4);
+			uint32_t z = mc.readL32(8);
 			if (mc.size() == 780 + (x * y * z))
 				return MATCH_TRUE;
 		}
@@ -109,7 +104,7 @@ public:
 	KVXVoxelDataFormat() : EntryDataFormat("voxel_kvx"){};
 	~KVXVoxelDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override
+	int isThisFormat(const MemChunk& mc) override
 	{
 		// Check size: 28 bytes for dimensions and pivot,
 		// 4 minimum for offset info, and 768 for palette,
@@ -124,22 +119,20 @@ public:
 			// Take palette info into account
 			endofvox = mc.size() - 768;
 			parsed   = 0;
-			mc.seek(0, SEEK_SET);
 
 			// Start validation loop
 			for (int miplevel = 0; miplevel < 5; miplevel++)
 			{
-				mc.read(&szd, 4);
+				if (!mc.read(parsed, &szd, 4))
+					return MATCH_FALSE;
 				szd = wxINT32_SWAP_ON_BE(szd);
-				parsed += 4;
 				// Check that data doesn't run out of bounds
-				if (parsed + szd > endofvox)
+				if (parsed + 4 + szd > endofvox)
+					return MATCH_FALSE;
+				if (!mc.read(parsed + 4, &szx, 4) || !mc.read(parsed + 8, &szy, 4) || !mc.read(parsed + 12, &szz, 4))
 					return MATCH_FALSE;
-				mc.read(&szx, 4);
 				szx = wxINT32_SWAP_ON_BE(szx);
-				mc.read(&szy, 4);
 				szy = wxINT32_SWAP_ON_BE(szy);
-				mc.read(&szz, 4);
 				szz = wxINT32_SWAP_ON_BE(szz);
 				// Compute size of the different data segments to do some checks
 				szofx  = (szx + 1) << 2;
@@ -147,20 +140,16 @@ public:
 				szvxd  = szd - (szofx + szofxy);
 				if (szvxd < 0)
 					return MATCH_FALSE;
-				// Those are the coordinates of the pivot point.
-				// We don't care about it for this test.
-				mc.read(&dummy, 4);
-				mc.read(&dummy, 4);
-				mc.read(&dummy, 4);
-				// X offsets of the voxel. The first can be used for a check.
-				mc.read(&dummy, 4);
+				// Skip the coordinates of the pivot point (we don't care about it for this test).
+				// The first X offset of the voxel can be used for a check.
+				if (!mc.read(parsed + 28, &dummy, 4))
+					return MATCH_FALSE;
 				dummy = wxINT32_SWAP_ON_BE(dummy);
 				if (dummy != ((szx + 1) * 4 + 2 * szx * (szy + 1)))
 					return MATCH_FALSE;
 
 				// Update the parse count
-				parsed += szd;
-				mc.seek(parsed, SEEK_SET);
+				parsed += 4 + szd;
 
 				// We're at the end of a mip level,
 				// have we reached the palette yet?
@@ -93,7 +93,7 @@ EntryDataFormat* registerDataFormat(string_view id)
 // To be overridden by specific data types, returns true if the data in [mc]
 // matches the data format
 // -----------------------------------------------------------------------------
-int EntryDataFormat::isThisFormat(MemChunk& mc)
+int EntryDataFormat::isThisFormat(const MemChunk& mc)
 {
 	return MATCH_TRUE;
 }
@@ -181,7 +181,7 @@ public:
 	AnyDataFormat() : EntryDataFormat("any") {}
 	~AnyDataFormat() = default;
 
-	int isThisFormat(MemChunk& mc) override { return MATCH_FALSE; }
+	int isThisFormat(const MemChunk& mc) override { return MATCH_FALSE; }
 };
 
 // Format enumeration moved to separate files
@@ -17,7 +17,7 @@ public:
 
 	const string& id() const { return id_; }
 
-	virtual int isThisFormat(MemChunk& mc);
+	virtual int isThisFormat(const MemChunk& mc);
 	void        copyToFormat(EntryDataFormat& target) const;
 
 	static void             initBuiltinFormats();
@@ -37,7 +37,9 @@
 #include "General/Console.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/Parser.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include <filesystem>
 
 using namespace slade;
@@ -58,6 +60,15 @@ EntryType* etype_unknown = nullptr; // The default, 'unknown' entry type
 EntryType* etype_folder  = nullptr; // Folder entry type
 EntryType* etype_marker  = nullptr; // Marker entry type
 EntryType* etype_map     = nullptr; // Map marker type
+
+// Candidate types for detection, narrowed down by the criteria that can be
+// checked without looking at entry data. Types are kept in definition order
+struct TypeDispatch
+{
+	vector<EntryType*>                     types;       // Types with no exact size requirement
+	std::map<unsigned, vector<EntryType*>> sized_types; // Types requiring a specific size, by size
+};
+std::map<string, TypeDispatch, std::less<>> type_dispatch; // By archive entry format ("" = any other/none)
 } // namespace
 
 
@@ -133,9 +144,11 @@ string EntryType::fileFilterString() const
 }
 
 // -----------------------------------------------------------------------------
-// Returns true if [entry] matches the EntryType's criteria, false otherwise
+// Returns true if [entry] matches the EntryType's criteria, false otherwise.
+// If [format_matches] is given, data format check results are looked up in and
+// added to it, so a format shared between types is only checked once per entry
 // -----------------------------------------------------------------------------
-int EntryType::isThisType(ArchiveEntry& entry)
+int EntryType::isThisType(ArchiveEntry& entry, FormatMatches* format_matches)
 {
 	// Check type is detectable
 	if (!detectable_)
@@ -188,17 +201,38 @@ int EntryType::isThisType(ArchiveEntry& entry)
 	{
 		// Hack for identifying ACS script sources despite DB2 apparently appending
 		// two null bytes to them, which make the memchr test fail.
-		size_t end = entry.size() - 1;
+		// (The loaded data can be smaller than the entry if only its start was
+		// loaded for type detection)
+		const auto& data = entry.data();
+		size_t      end  = data.size() - 1;
 		if (end > 3)
 			end -= 2;
 		// Text is a special case, as other data formats can sometimes be detected as 'text',
 		// we'll only check for it if text data is specified in the entry type
-		if (entry.size() > 0 && memchr(entry.rawData(), 0, end) != nullptr)
+		if (data.size() > 0 && memchr(data.data(), 0, end) != nullptr)
 			return EntryDataFormat::MATCH_FALSE;
 	}
 	else if (format_ != EntryDataFormat::anyFormat() && entry.size() > 0)
 	{
-		r = format_->isThisFormat(entry.data());
+		// Check for an already known result for the format
+		r = -1;
+		if (format_matches)
+		{
+			for (const auto& match : *format_matches)
+				if (match.first == format_)
+				{
+					r = match.second;
+					break;
+				}
+		}
+
+		if (r < 0)
+		{
+			r = format_->isThisFormat(entry.data());
+			if (format_matches)
+				format_matches->emplace_back(format_, r);
+		}
+
 		if (r == EntryDataFormat::MATCH_FALSE)
 			return EntryDataFormat::MATCH_FALSE;
 	}
@@ -348,6 +382,8 @@ void slade::EntryType::initTypes()
 	etype_map           = et_map.get();
 	etype_map->index_   = entry_types.size();
 	entry_types.push_back(std::move(et_map));
+
+	updateDispatchIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -515,6 +551,8 @@ bool EntryType::readEntryTypeDefinition(MemChunk& mc, string_view source)
 		entry_types.push_back(std::move(ntype));
 	}
 
+	updateDispatchIndex();
+
 	return true;
 }
 
@@ -582,47 +620,172 @@ bool EntryType::loadEntryTypes()
 }
 
 // -----------------------------------------------------------------------------
-// Attempts to detect the given entry's type
+// Returns the most reliable type matching [entry], and sets [reliability] to
+// the match reliability. The entry itself is not modified, so this can be
+// called for different entries from multiple threads at once (as long as the
+// entry data is already loaded)
 // -----------------------------------------------------------------------------
-bool EntryType::detectEntryType(ArchiveEntry& entry)
+EntryType* EntryType::findType(ArchiveEntry& entry, int& reliability)
 {
-	// Do nothing if the entry is a folder or a map marker
-	if (entry.type() == etype_folder || entry.type() == etype_map)
-		return false;
-
-	// If the entry's size is zero, set it to marker type
-	if (entry.size() == 0)
+	EntryType* type             = etype_unknown;
+	int        type_reliability = 0;
+	reliability                 = 0;
+
+	// Get candidate types for the entry's archive format
+	auto dispatch = type_dispatch.end();
+	if (entry.parent())
+		dispatch = type_dispatch.find(entry.parent()->formatDesc().entry_format);
+	if (dispatch == type_dispatch.end())
+		dispatch = type_dispatch.find("");
+	if (dispatch == type_dispatch.end())
+		return type;
+
+	// Add any candidate types requiring the entry's exact size (keeping definition order)
+	auto               candidates = &dispatch->second.types;
+	vector<EntryType*> merged;
+	auto               sized = dispatch->second.sized_types.find(entry.size());
+	if (sized != dispatch->second.sized_types.end())
 	{
-		entry.setType(etype_marker);
-		return true;
+		merged.reserve(candidates->size() + sized->second.size());
+		std::merge(
+			candidates->begin(),
+			candidates->end(),
+			sized->second.begin(),
+			sized->second.end(),
+			std::back_inserter(merged),
+			[](EntryType* left, EntryType* right) { return left->index_ < right->index_; });
+		candidates = &merged;
 	}
 
-	// Reset entry type
-	entry.setType(etype_unknown);
-
-	// Go through all registered types
-	size_t entry_types_size = entry_types.size();
-	for (size_t a = 0; a < entry_types_size; a++)
+	// Go through all candidate types
+	FormatMatches format_matches;
+	for (auto candidate : *candidates)
 	{
 		// If the current type is more 'reliable' than this one, skip it
-		if (entry.typeReliability() >= entry_types[a]->reliability())
+		if (type_reliability >= candidate->reliability())
 			continue;
 
 		// Check for possible type match
-		int r = entry_types[a]->isThisType(entry);
+		int r = candidate->isThisType(entry, &format_matches);
 		if (r > 0)
 		{
 			// Type matches, set it
-			entry.setType(entry_types[a].get(), r);
+			type             = candidate;
+			reliability      = r;
+			type_reliability = type->reliability() * r / 255;
 
 			// No need to continue if the identification is 100% reliable
-			if (entry.typeReliability() >= 255)
-				return true;
+			if (type_reliability >= 255)
+				break;
+		}
+	}
+
+	return type;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the type detection dispatch index from all currently registered
+// entry types. Non-detectable types are left out, and each remaining type is
+// only added as a candidate for the archive formats and exact sizes (if any)
+// it is restricted to
+// -----------------------------------------------------------------------------
+void EntryType::updateDispatchIndex()
+{
+	type_dispatch.clear();
+
+	// Add a dispatch entry for each archive format any type is restricted to,
+	// plus the default for all other archive formats (or no archive)
+	type_dispatch[""];
+	for (const auto& type : entry_types)
+		for (const auto& archive : type->match_archive_)
+			type_dispatch[archive];
+
+	// Add detectable types where they can match
+	for (const auto& type : entry_types)
+	{
+		if (!type->detectable_)
+			continue;
+
+		for (auto& [archive, dispatch] : type_dispatch)
+		{
+			if (!type->match_archive_.empty() && !(VECTOR_EXISTS(type->match_archive_, archive)))
+				continue;
+
+			if (type->match_size_.empty())
+			{
+				dispatch.types.push_back(type.get());
+				continue;
+			}
+
+			for (auto size : type->match_size_)
+			{
+				auto& sized = dispatch.sized_types[static_cast<unsigned>(size)];
+				if (sized.empty() || sized.back() != type.get())
+					sized.push_back(type.get());
+			}
 		}
 	}
+}
+
+// -----------------------------------------------------------------------------
+// Attempts to detect the given entry's type
+// -----------------------------------------------------------------------------
+bool EntryType::detectEntryType(ArchiveEntry& entry)
+{
+	PROFILE_SCOPE("EntryType::detectEntryType");
+
+	// Do nothing if the entry is a folder or a map marker
+	if (entry.type() == etype_folder || entry.type() == etype_map)
+		return false;
+
+	// If the entry's size is zero, set it to marker type
+	if (entry.size() == 0)
+	{
+		entry.setType(etype_marker);
+		return true;
+	}
+
+	// Find and set the matching type
+	int  reliability;
+	auto type = findType(entry, reliability);
+	entry.setType(type, reliability);
 
 	// Return t/f depending on if a matching type was found
-	return entry.type() != etype_unknown;
+	return type != etype_unknown;
+}
+
+// -----------------------------------------------------------------------------
+// Attempts to detect the types of all given [entries].
+// Type matching is done across worker threads for entries that have their data
+// loaded, and the detected types are then applied to the entries on the
+// calling thread. Any context a type depends on (eg. archive namespaces) must
+// already be set up before calling this
+// -----------------------------------------------------------------------------
+void EntryType::detectEntryTypes(const vector<ArchiveEntry*>& entries)
+{
+	PROFILE_SCOPE("EntryType::detectEntryTypes");
+
+	vector<EntryType*> types(entries.size(), nullptr);
+	vector<int>        reliabilities(entries.size(), 0);
+
+	threadpool::parallelFor(entries.size(), [&](size_t index) {
+		auto entry = entries[index];
+
+		// Special cases and entries that would need to load their data are
+		// left to the calling thread
+		if (entry->type() == etype_folder || entry->type() == etype_map || entry->size() == 0 || !entry->isLoaded())
+			return;
+
+		types[index] = findType(*entry, reliabilities[index]);
+	});
+
+	for (size_t a = 0; a < entries.size(); ++a)
+	{
+		if (types[a])
+			entries[a]->setType(types[a], reliabilities[a]);
+		else
+			detectEntryType(*entries[a]);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -31,14 +31,18 @@ public:
 	void   copyToType(EntryType& target);
 	string fileFilterString() const;
 
+	// Data format match results for a single entry, so each format is only checked once
+	using FormatMatches = vector<std::pair<EntryDataFormat*, int>>;
+
 	// Magic goes here
-	int isThisType(ArchiveEntry& entry);
+	int isThisType(ArchiveEntry& entry, FormatMatches* format_matches = nullptr);
 
 	// Static functions
 	static void               initTypes();
 	static bool               readEntryTypeDefinition(MemChunk& mc, string_view source);
 	static bool               loadEntryTypes();
 	static bool               detectEntryType(ArchiveEntry& entry);
+	static void               detectEntryTypes(const vector<ArchiveEntry*>& entries);
 	static EntryType*         fromId(string_view id);
 	static EntryType*         unknownType();
 	static EntryType*         folderType();
@@ -48,6 +52,9 @@ public:
 	static vector<string>     allCategories();
 
 private:
+	static EntryType* findType(ArchiveEntry& entry, int& reliability);
+	static void       updateDispatchIndex();
+
 	// Type info
 	string  id_;
 	string  name_        = "Unknown";
@@ -0,0 +1,399 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryTypeCache.cpp
+// Description: EntryTypeCache class, keeps the entry types detected for an
+//              archive file on disk so they can be re-used next time the file
+//              is opened, as long as the file and entry types are unchanged.
+//              For directories, types are kept per file instead
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryTypeCache.h"
+#include "EntryType.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/Misc.h"
+#include "Utility/FileUtils.h"
+#include "Utility/ThreadPool.h"
+#include <filesystem>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+const char     CACHE_MAGIC[4] = { 'S', 'L', 'T', 'C' };
+const uint32_t CACHE_VERSION  = 2;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a checksum of the program version and all registered entry type ids,
+// so that cached types are discarded if the entry type definitions change
+// -----------------------------------------------------------------------------
+uint32_t typesSignature()
+{
+	auto sig = app::version().toString();
+	for (auto type : EntryType::allTypes())
+	{
+		sig += '\n';
+		sig += type->id();
+	}
+
+	return misc::crc(reinterpret_cast<const uint8_t*>(sig.data()), sig.size());
+}
+
+// -----------------------------------------------------------------------------
+// Writes [str] to [mc], prefixed with its length
+// -----------------------------------------------------------------------------
+void writeString(MemChunk& mc, string_view str)
+{
+	auto len = static_cast<uint16_t>(std::min<size_t>(str.size(), 0xFFFF));
+	mc.write(&len, 2);
+	mc.write(str.data(), len);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a length-prefixed string from [mc] into [str]
+// -----------------------------------------------------------------------------
+bool readString(MemChunk& mc, string& str)
+{
+	uint16_t len;
+	if (!mc.read(&len, 2) || mc.currentPos() + len > mc.size())
+		return false;
+
+	str.assign(reinterpret_cast<const char*>(mc.data() + mc.currentPos()), len);
+	return mc.seek(len, SEEK_CUR);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryTypeCache Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// EntryTypeCache class constructor, loads any existing cache for the archive
+// file at [archive_path]. If it is a directory, the cache isn't invalidated by
+// changes to the directory itself, since each file's type is checked
+// individually (see applyFileType)
+// -----------------------------------------------------------------------------
+EntryTypeCache::EntryTypeCache(string_view archive_path) : archive_path_{ archive_path }
+{
+	auto path_crc = misc::crc(reinterpret_cast<const uint8_t*>(archive_path.data()), archive_path.size());
+	cache_file_   = app::path(fmt::format("type_cache/{:08x}.dat", path_crc), app::Dir::User);
+
+	if (!fileutil::dirExists(archive_path_))
+	{
+		std::error_code ec;
+		file_size_     = std::filesystem::file_size(archive_path_, ec);
+		file_modified_ = fileutil::fileModifiedTime(archive_path_);
+	}
+
+	loaded_ = load();
+}
+
+// -----------------------------------------------------------------------------
+// Detects the types of the (loaded) [entries], taking them from the cache
+// where an entry's size and data checksum match the cached entry at the same
+// position. Entries are expected to be given in the same order each time the
+// archive is opened, in as many calls as needed.
+// Entries that aren't cached are detected via EntryType::detectEntryTypes and
+// the results are added to the cache
+// -----------------------------------------------------------------------------
+void EntryTypeCache::detectEntryTypes(const vector<ArchiveEntry*>& entries)
+{
+	// Get entry data checksums
+	vector<uint32_t> crcs(entries.size());
+	threadpool::parallelFor(entries.size(), [&](size_t index) { crcs[index] = entries[index]->data(false).crc(); });
+
+	// Apply cached types to unchanged entries
+	vector<ArchiveEntry*> uncached;
+	vector<unsigned>      uncached_index;
+	if (types_.size() < next_index_ + entries.size())
+		types_.resize(next_index_ + entries.size());
+	for (unsigned a = 0; a < entries.size(); ++a)
+	{
+		auto& cached = types_[next_index_ + a];
+		if (cached.type && cached.size == entries[a]->size() && cached.crc == crcs[a])
+			entries[a]->setType(cached.type, cached.reliability);
+		else
+		{
+			uncached.push_back(entries[a]);
+			uncached_index.push_back(a);
+		}
+	}
+
+	// Detect any other entry types and add them to the cache
+	if (!uncached.empty())
+	{
+		EntryType::detectEntryTypes(uncached);
+
+		for (unsigned a = 0; a < uncached.size(); ++a)
+		{
+			auto& cached       = types_[next_index_ + uncached_index[a]];
+			cached.size        = uncached[a]->size();
+			cached.crc         = crcs[uncached_index[a]];
+			cached.type        = uncached[a]->type();
+			cached.reliability = uncached[a]->rawTypeReliability();
+		}
+
+		modified_ = true;
+	}
+
+	next_index_ += entries.size();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the type of (unloaded) [entry] to the type cached for the file at
+// [path], if its size and [modified] time are unchanged.
+// Returns false if there is no valid cached type, in which case the entry's
+// data needs to be read to detect its type (and add it via addFileType)
+// -----------------------------------------------------------------------------
+bool EntryTypeCache::applyFileType(ArchiveEntry* entry, string_view path, int64_t modified)
+{
+	auto cached = file_types_.find(string{ path });
+	if (cached == file_types_.end() || !cached->second.type || cached->second.size != entry->size()
+		|| cached->second.modified != modified)
+		return false;
+
+	entry->setType(cached->second.type, cached->second.reliability);
+	file_types_in_use_[cached->first] = cached->second;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the detected type of [entry] to the cache for the file at [path], last
+// modified at [modified]
+// -----------------------------------------------------------------------------
+void EntryTypeCache::addFileType(ArchiveEntry* entry, string_view path, int64_t modified)
+{
+	auto& cached       = file_types_in_use_[string{ path }];
+	cached.size        = entry->size();
+	cached.modified    = modified;
+	cached.type        = entry->type();
+	cached.reliability = entry->rawTypeReliability();
+
+	modified_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the cache to disk if anything changed since it was loaded.
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool EntryTypeCache::save()
+{
+	// Remove any cached types past the last detected entry
+	if (types_.size() > next_index_)
+	{
+		types_.resize(next_index_);
+		modified_ = true;
+	}
+
+	// Same for cached files that weren't looked up (no longer exist)
+	if (file_types_in_use_.size() != file_types_.size())
+		modified_ = true;
+
+	if (!modified_)
+		return true;
+
+	// Build list of used type ids
+	vector<EntryType*>             type_list;
+	std::map<EntryType*, uint16_t> type_index;
+	auto add_type = [&](EntryType* type) {
+		if (type && type_index.find(type) == type_index.end())
+		{
+			type_index[type] = static_cast<uint16_t>(type_list.size());
+			type_list.push_back(type);
+		}
+	};
+	for (const auto& cached : types_)
+		add_type(cached.type);
+	for (const auto& file : file_types_in_use_)
+		add_type(file.second.type);
+
+	// Header
+	MemChunk mc;
+	uint32_t sig = typesSignature();
+	mc.write(CACHE_MAGIC, 4);
+	mc.write(&CACHE_VERSION, 4);
+	writeString(mc, archive_path_);
+	mc.write(&file_size_, 8);
+	mc.write(&file_modified_, 8);
+	mc.write(&sig, 4);
+
+	// Type ids
+	auto num_types = static_cast<uint32_t>(type_list.size());
+	mc.write(&num_types, 4);
+	for (auto type : type_list)
+		writeString(mc, type->id());
+
+	// Cached entry types
+	auto num_entries = static_cast<uint32_t>(types_.size());
+	mc.write(&num_entries, 4);
+	for (const auto& cached : types_)
+	{
+		uint16_t index       = cached.type ? type_index[cached.type] : 0xFFFF;
+		uint8_t  reliability = static_cast<uint8_t>(cached.reliability);
+		mc.write(&cached.size, 4);
+		mc.write(&cached.crc, 4);
+		mc.write(&index, 2);
+		mc.write(&reliability, 1);
+	}
+
+	// Cached file types
+	auto num_files = static_cast<uint32_t>(file_types_in_use_.size());
+	mc.write(&num_files, 4);
+	for (const auto& file : file_types_in_use_)
+	{
+		uint16_t index       = file.second.type ? type_index[file.second.type] : 0xFFFF;
+		uint8_t  reliability = static_cast<uint8_t>(file.second.reliability);
+		writeString(mc, file.first);
+		mc.write(&file.second.size, 4);
+		mc.write(&file.second.modified, 8);
+		mc.write(&index, 2);
+		mc.write(&reliability, 1);
+	}
+
+	// Write to file
+	auto cache_dir = app::path("type_cache", app::Dir::User);
+	if (!fileutil::dirExists(cache_dir) && !fileutil::createDir(cache_dir))
+		return false;
+	if (!mc.exportFile(cache_file_))
+	{
+		log::warning("Unable to write entry type cache file {}", cache_file_);
+		return false;
+	}
+
+	modified_ = false;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads the cache file for the archive. Returns false if it doesn't exist or
+// is out of date (the archive file or entry types have changed since it was
+// written)
+// -----------------------------------------------------------------------------
+bool EntryTypeCache::load()
+{
+	if (!fileutil::fileExists(cache_file_))
+		return false;
+
+	MemChunk mc;
+	if (!mc.importFile(cache_file_))
+		return false;
+
+	// Check header
+	char     magic[4];
+	uint32_t version = 0;
+	string   path;
+	uint64_t size     = 0;
+	int64_t  modified = 0;
+	uint32_t sig      = 0;
+	if (!mc.read(magic, 4) || memcmp(magic, CACHE_MAGIC, 4) != 0)
+		return false;
+	if (!mc.read(&version, 4) || version != CACHE_VERSION)
+		return false;
+	if (!readString(mc, path) || path != archive_path_)
+		return false;
+	if (!mc.read(&size, 8) || !mc.read(&modified, 8) || !mc.read(&sig, 4))
+		return false;
+	if (size != file_size_ || modified != file_modified_ || sig != typesSignature())
+		return false;
+
+	// Type ids (at least 2 bytes each)
+	uint32_t num_types = 0;
+	if (!mc.read(&num_types, 4) || num_types > (mc.size() - mc.currentPos()) / 2)
+		return false;
+	vector<EntryType*> type_list(num_types);
+	for (auto& type : type_list)
+	{
+		string id;
+		if (!readString(mc, id))
+			return false;
+		type = EntryType::fromId(id);
+	}
+
+	// Cached entry types (11 bytes each)
+	uint32_t num_entries = 0;
+	if (!mc.read(&num_entries, 4) || num_entries > (mc.size() - mc.currentPos()) / 11)
+		return false;
+	types_.resize(num_entries);
+	for (auto& cached : types_)
+	{
+		uint16_t index       = 0;
+		uint8_t  reliability = 0;
+		mc.read(&cached.size, 4);
+		mc.read(&cached.crc, 4);
+		mc.read(&index, 2);
+		mc.read(&reliability, 1);
+		cached.type        = index < type_list.size() ? type_list[index] : nullptr;
+		cached.reliability = reliability;
+	}
+
+	// Cached file types
+	uint32_t num_files = 0;
+	if (!mc.read(&num_files, 4))
+		return false;
+	for (unsigned a = 0; a < num_files; ++a)
+	{
+		string         path;
+		CachedFileType cached;
+		uint16_t       index       = 0;
+		uint8_t        reliability = 0;
+		if (!readString(mc, path) || mc.currentPos() + 15 > mc.size())
+		{
+			file_types_.clear();
+			return false;
+		}
+		mc.read(&cached.size, 4);
+		mc.read(&cached.modified, 8);
+		mc.read(&index, 2);
+		mc.read(&reliability, 1);
+		cached.type        = index < type_list.size() ? type_list[index] : nullptr;
+		cached.reliability = reliability;
+		file_types_[path]  = cached;
+	}
+
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class EntryType;
+
+// Persistent (on-disk) cache of the entry types detected when opening an
+// archive file, so types don't need to be detected again for entries that
+// haven't changed the next time the same file is opened
+class EntryTypeCache
+{
+public:
+	EntryTypeCache(string_view archive_path);
+	~EntryTypeCache() = default;
+
+	bool isLoaded() const { return loaded_; }
+	bool isModified() const { return modified_; }
+
+	void detectEntryTypes(const vector<ArchiveEntry*>& entries);
+	bool applyFileType(ArchiveEntry* entry, string_view path, int64_t modified);
+	void addFileType(ArchiveEntry* entry, string_view path, int64_t modified);
+	bool save();
+
+private:
+	struct CachedType
+	{
+		uint32_t   size        = 0;
+		uint32_t   crc         = 0;
+		EntryType* type        = nullptr;
+		int        reliability = 0;
+	};
+
+	// Cached type for a file in a directory, identified by its (relative)
+	// path, size and modification time rather than its data
+	struct CachedFileType
+	{
+		uint32_t   size        = 0;
+		int64_t    modified    = 0;
+		EntryType* type        = nullptr;
+		int        reliability = 0;
+	};
+
+	string             archive_path_;
+	string             cache_file_;
+	uint64_t           file_size_     = 0;
+	int64_t            file_modified_ = 0;
+	vector<CachedType> types_;
+	unsigned           next_index_ = 0; // Index (in detection order) of the next entry to look up
+	bool               loaded_     = false;
+	bool               modified_   = false;
+
+	std::map<string, CachedFileType> file_types_;        // As loaded from the cache file
+	std::map<string, CachedFileType> file_types_in_use_; // Looked up or added while opening, to be saved
+
+	bool load();
+};
+} // namespace slade
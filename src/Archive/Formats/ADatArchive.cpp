@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "ADatArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/Compression.h"
 #include "Utility/StringUtils.h"
@@ -121,9 +122,9 @@ bool ADatArchive::open(MemChunk& mc)
 		auto dir = createDir(strutil::Path::pathOf(name));
 
 		// Create entry
-		auto entry                = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), compsize);
-		entry->exProp("Offset")   = (int)offset;
-		entry->exProp("FullSize") = (int)decsize;
+		auto entry                    = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), compsize);
+		entry->formatInfo().offset    = (int)offset;
+		entry->formatInfo().full_size = (int)decsize;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -148,10 +149,16 @@ bool ADatArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->formatInfo().offset, entry->size());
 			MemChunk xdata;
-			if (compression::zlibInflate(edata, xdata, entry->exProp<int>("FullSize")))
+			int      full_size = entry->formatInfo().full_size;
+			size_t   inflated  = 0;
+			if (full_size > 0 && xdata.reSize(full_size, false)
+				&& compression::zlibInflateTo(edata, xdata.data(), full_size, &inflated) && inflated > 0)
+			{
+				xdata.reSize(inflated);
 				entry->importMemChunk(xdata);
+			}
 			else
 			{
 				log::warning("Entry {} couldn't be inflated", entry->name());
@@ -229,7 +236,7 @@ bool ADatArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 
 		///////////////////////////////////
@@ -334,7 +341,7 @@ bool ADatArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -353,7 +360,7 @@ bool ADatArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Anachronox dat archive
 // -----------------------------------------------------------------------------
-bool ADatArchive::isADatArchive(MemChunk& mc)
+bool ADatArchive::isADatArchive(const MemChunk& mc)
 {
 	// Check it opened ok
 	if (mc.size() < 16)
@@ -364,11 +371,11 @@ bool ADatArchive::isADatArchive(MemChunk& mc)
 	long dir_offset;
 	long dir_size;
 	long version;
-	mc.seek(0, SEEK_SET);
-	mc.read(magic, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
-	mc.read(&version, 4);
+	MemDataReader reader(mc);
+	reader.read(magic, 4);
+	reader.read(&dir_offset, 4);
+	reader.read(&dir_size, 4);
+	reader.read(&version, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
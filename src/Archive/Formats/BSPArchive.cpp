@@ -39,6 +39,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "BSPArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -68,7 +69,7 @@ uint32_t BSPArchive::entryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -223,7 +224,7 @@ bool BSPArchive::open(MemChunk& mc)
 			// Create & setup lump
 			auto nlump = std::make_shared<ArchiveEntry>(name, lumpsize);
 			nlump->setLoaded(false);
-			nlump->exProp("Offset") = (int)(offset + texoffset);
+			nlump->formatInfo().offset = (int)(offset + texoffset);
 			nlump->setState(ArchiveEntry::State::Unmodified);
 
 			// Add to entry list
@@ -312,7 +313,7 @@ bool BSPArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -332,7 +333,7 @@ bool BSPArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Quake BSP archive
 // -----------------------------------------------------------------------------
-bool BSPArchive::isBSPArchive(MemChunk& mc)
+bool BSPArchive::isBSPArchive(const MemChunk& mc)
 {
 	// If size is less than 64, there's not even enough room for a full header
 	size_t size = mc.size();
@@ -343,8 +344,8 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 	uint32_t version;
 	uint32_t texoffset = 0;
 	uint32_t texsize;
-	mc.seek(0, SEEK_SET);
-	mc.read(&version, 4);
+	MemDataReader reader(mc);
+	reader.read(&version, 4);
 	version = wxINT32_SWAP_ON_BE(version);
 	if (version != 0x17 && version != 0x1D)
 		return false;
@@ -355,8 +356,8 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 	for (int a = 0; a < 15; ++a)
 	{
 		uint32_t ofs, sz;
-		mc.read(&ofs, 4);
-		mc.read(&sz, 4);
+		reader.read(&ofs, 4);
+		reader.read(&sz, 4);
 
 		// Check that content stays within bounds
 		if (wxINT32_SWAP_ON_BE(sz) + wxINT32_SWAP_ON_BE(ofs) > size)
@@ -375,8 +376,8 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 
 	// Now validate miptex entry
 	uint32_t numtex;
-	mc.seek(texoffset, wxFromStart);
-	mc.read(&numtex, 4);
+	reader.seekFromStart(texoffset);
+	reader.read(&numtex, 4);
 	numtex = wxINT32_SWAP_ON_BE(numtex);
 
 	// Check that the offset table is within bounds
@@ -387,7 +388,7 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 	for (size_t a = 0; a < numtex; ++a)
 	{
 		size_t offset;
-		mc.read(&offset, 4);
+		reader.read(&offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 
 		// A texture header takes 40 bytes (16 bytes for name, 6 int32 for records),
@@ -398,19 +399,19 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 		if (offset != 0xFFFFFFFF)
 		{
 			// Keep track of where we are now to return to it later.
-			size_t currentpos = mc.currentPos();
+			size_t currentpos = reader.currentPos();
 
 			// Move to texture header
-			mc.seek(texoffset + offset, SEEK_SET);
+			reader.seekFromStart(texoffset + offset);
 			char     name[16];
 			uint32_t width, height, offset1, offset2, offset4, offset8;
-			mc.read(name, 16);
-			mc.read(&width, 4);
-			mc.read(&height, 4);
-			mc.read(&offset1, 4);
-			mc.read(&offset2, 4);
-			mc.read(&offset4, 4);
-			mc.read(&offset8, 4);
+			reader.read(name, 16);
+			reader.read(&width, 4);
+			reader.read(&height, 4);
+			reader.read(&offset1, 4);
+			reader.read(&offset2, 4);
+			reader.read(&offset4, 4);
+			reader.read(&offset8, 4);
 
 			// Byteswap values for big endian if needed
 			width   = wxINT32_SWAP_ON_BE(width);
@@ -436,7 +437,7 @@ bool BSPArchive::isBSPArchive(MemChunk& mc)
 				return false;
 
 			// Okay, that texture works, go back to where we were and check the next
-			mc.seek(currentpos, SEEK_SET);
+			reader.seekFromStart(currentpos);
 		}
 	}
 
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "BZip2Archive.h"
+#include "Archive/EntryDataReader.h"
 #include "Utility/Compression.h"
 #include "Utility/StringUtils.h"
 
@@ -73,10 +74,10 @@ bool BZip2Archive::open(MemChunk& mc)
 	// Let's create the entry
 	ArchiveModSignalBlocker sig_blocker{ *this };
 	auto                    entry = std::make_shared<ArchiveEntry>(fn.fileName(), size);
-	MemChunk                xdata;
-	if (compression::bzip2Decompress(mc, xdata))
-		entry->importMemChunk(xdata);
-	else
+
+	// Decompress a chunk at a time (spilling to a temp file if large)
+	if (!importStreamed(
+			entry.get(), [&mc](const DataSink& sink) { return compression::bzip2DecompressStream(mc, sink); }))
 		return false;
 	rootDir()->addEntry(entry);
 	EntryType::detectEntryType(*entry);
@@ -96,7 +97,7 @@ bool BZip2Archive::open(MemChunk& mc)
 bool BZip2Archive::write(MemChunk& mc, bool update)
 {
 	if (numEntries() == 1)
-		return compression::bzip2Compress(entryAt(0)->data(), mc);
+		return compression::bzip2CompressParallel(entryAt(0)->data(), mc);
 
 	return false;
 }
@@ -212,7 +213,7 @@ vector<ArchiveEntry*> BZip2Archive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid BZip2 archive
 // -----------------------------------------------------------------------------
-bool BZip2Archive::isBZip2Archive(MemChunk& mc)
+bool BZip2Archive::isBZip2Archive(const MemChunk& mc)
 {
 	size_t size = mc.size();
 	if (size < 14)
@@ -220,7 +221,8 @@ bool BZip2Archive::isBZip2Archive(MemChunk& mc)
 
 	// Read header
 	uint8_t header[4];
-	mc.read(header, 4);
+	MemDataReader reader(mc);
+	reader.read(header, 4);
 
 	// Check for BZip2 header (reject BZip1 headers)
 	if (header[0] == 'B' && header[1] == 'Z' && header[2] == 'h' && (header[3] >= '1' && header[3] <= '9'))
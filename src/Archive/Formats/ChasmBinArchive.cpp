@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "ChasmBinArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -135,7 +136,7 @@ bool ChasmBinArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(name, size);
-		entry->exProp("Offset") = static_cast<int>(offset);
+		entry->formatInfo().offset = static_cast<int>(offset);
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -162,7 +163,7 @@ bool ChasmBinArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->formatInfo().offset, entry->size());
 			entry->importMemChunk(edata);
 		}
 
@@ -233,7 +234,7 @@ bool ChasmBinArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = static_cast<int>(offset);
+			entry->formatInfo().offset = static_cast<int>(offset);
 		}
 
 		// Check entry name
@@ -306,7 +307,7 @@ bool ChasmBinArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -325,7 +326,7 @@ bool ChasmBinArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Chasm bin archive
 // -----------------------------------------------------------------------------
-bool ChasmBinArchive::isChasmBinArchive(MemChunk& mc)
+bool ChasmBinArchive::isChasmBinArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	if (mc.size() < HEADER_SIZE)
@@ -335,7 +336,8 @@ bool ChasmBinArchive::isChasmBinArchive(MemChunk& mc)
 
 	// Read bin header and check it
 	char magic[4] = {};
-	mc.read(magic, sizeof magic);
+	MemDataReader reader(mc);
+	reader.read(magic, sizeof magic);
 
 	if (magic[0] != 'C' || magic[1] != 'S' || magic[2] != 'i' || magic[3] != 'd')
 	{
@@ -343,7 +345,7 @@ bool ChasmBinArchive::isChasmBinArchive(MemChunk& mc)
 	}
 
 	uint16_t num_entries = 0;
-	mc.read(&num_entries, sizeof num_entries);
+	reader.read(&num_entries, sizeof num_entries);
 	num_entries = wxUINT16_SWAP_ON_BE(num_entries);
 
 	return num_entries > MAX_ENTRY_COUNT || (HEADER_SIZE + ENTRY_SIZE * MAX_ENTRY_COUNT) <= mc.size();
@@ -17,7 +17,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isChasmBinArchive(MemChunk& mc);
+	static bool isChasmBinArchive(const MemChunk& mc);
 	static bool isChasmBinArchive(const string& filename);
 
 private:
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "DatArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -144,7 +145,7 @@ bool DatArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(myname, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		if (flags & 1)
@@ -169,7 +170,6 @@ bool DatArchive::open(MemChunk& mc)
 	}
 
 	// Detect all entry types
-	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
@@ -182,9 +182,8 @@ bool DatArchive::open(MemChunk& mc)
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
+			// Read the entry data (will reference the data directly if mc is memory-mapped)
+			entry->importMemChunk(mc, getEntryOffset(entry), entry->size());
 		}
 
 		// Detect entry type
@@ -513,7 +512,7 @@ bool DatArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)wxINT32_SWAP_ON_BE(offset);
+			entry->formatInfo().offset = (int)wxINT32_SWAP_ON_BE(offset);
 		}
 	}
 
@@ -554,6 +553,10 @@ bool DatArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly if the datfile is memory-mapped
+	if (loadMappedEntryData(entry, getEntryOffset(entry), entry->size()))
+		return true;
+
 	// Open wadfile
 	wxFile file(filename_);
 
@@ -574,6 +577,18 @@ bool DatArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from the datfile if the
+// entry isn't loaded
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> DatArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (auto reader = fileDataReader(entry, getEntryOffset(entry)))
+		return reader;
+
+	return Archive::entryDataReader(entry);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -585,15 +600,15 @@ bool DatArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Shadowcaster dat archive
 // -----------------------------------------------------------------------------
-bool DatArchive::isDatArchive(MemChunk& mc)
+bool DatArchive::isDatArchive(const MemChunk& mc)
 {
 	// Read dat header
-	mc.seek(0, SEEK_SET);
 	uint16_t num_lumps;
 	uint32_t dir_offset, junk;
-	mc.read(&num_lumps, 2);  // Size
-	mc.read(&dir_offset, 4); // Directory offset
-	mc.read(&junk, 4);       // Unknown value
+	MemDataReader reader(mc);
+	reader.read(&num_lumps, 2);  // Size
+	reader.read(&dir_offset, 4); // Directory offset
+	reader.read(&junk, 4);       // Unknown value
 	num_lumps  = wxINT16_SWAP_ON_BE(num_lumps);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
 	junk       = wxINT32_SWAP_ON_BE(junk);
@@ -602,17 +617,17 @@ bool DatArchive::isDatArchive(MemChunk& mc)
 		return false;
 
 	// Read the directory
-	mc.seek(dir_offset, SEEK_SET);
+	reader.seekFromStart(dir_offset);
 	// Read lump info
 	uint32_t offset  = 0;
 	uint32_t size    = 0;
 	uint16_t nameofs = 0;
 	uint16_t flags   = 0;
 
-	mc.read(&offset, 4);  // Offset
-	mc.read(&size, 4);    // Size
-	mc.read(&nameofs, 2); // Name offset
-	mc.read(&flags, 2);   // Flags
+	reader.read(&offset, 4);  // Offset
+	reader.read(&size, 4);    // Size
+	reader.read(&nameofs, 2); // Name offset
+	reader.read(&flags, 2);   // Flags
 
 	// Byteswap values for big endian if needed
 	offset  = wxINT32_SWAP_ON_BE(offset);
@@ -11,8 +11,8 @@ public:
 	~DatArchive() = default;
 
 	// Dat specific
-	uint32_t getEntryOffset(ArchiveEntry* entry) const { return entry->exProp<int>("Offset"); }
-	void     setEntryOffset(ArchiveEntry* entry, uint32_t offset) const { entry->exProp("Offset") = (int)offset; }
+	uint32_t getEntryOffset(ArchiveEntry* entry) const { return entry->formatInfo().offset; }
+	void     setEntryOffset(ArchiveEntry* entry, uint32_t offset) const { entry->formatInfo().offset = (int)offset; }
 	void     updateNamespaces();
 
 	// Opening/writing
@@ -21,8 +21,12 @@ public:
 
 	// Misc
 	bool     loadEntryData(ArchiveEntry* entry) override;
+	bool     canMapFile() const override { return true; }
 	unsigned numEntries() override { return rootDir()->numEntries(); }
 
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
+
 	// Entry addition/removal
 	shared_ptr<ArchiveEntry> addEntry(
 		shared_ptr<ArchiveEntry> entry,
@@ -42,7 +46,7 @@ public:
 	string detectNamespace(size_t index, ArchiveDir* dir = nullptr) override;
 	string detectNamespace(ArchiveEntry* entry) override;
 
-	static bool isDatArchive(MemChunk& mc);
+	static bool isDatArchive(const MemChunk& mc);
 	static bool isDatArchive(const string& filename);
 
 private:
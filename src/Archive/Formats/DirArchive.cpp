@@ -34,10 +34,14 @@
 #include "Main.h"
 #include "DirArchive.h"
 #include "App.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "WadArchive.h"
+#include <filesystem>
+#include <unordered_set>
 
 using namespace slade;
 
@@ -88,22 +92,37 @@ bool DirArchive::open(string_view filename)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
+	// Get file sizes and modification times across worker threads
 	ui::setSplashProgressMessage("Reading files");
-	for (unsigned a = 0; a < files.size(); a++)
-	{
-		ui::setSplashProgress((float)a / (float)files.size());
-
-		// Cut off directory to get entry name + relative path
-		auto name = files[a];
+	vector<uint32_t> sizes(files.size());
+	vector<time_t>   modified_times(files.size());
+	threadpool::parallelFor(files.size(), [&](size_t index) {
+		std::error_code ec;
+		sizes[index]          = std::filesystem::file_size(files[index], ec);
+		modified_times[index] = wxFileModificationTime(files[index]);
+	});
+
+	// Use cached entry types for unchanged files where possible
+	openTypeCache(filename);
+	auto type_cache = typeCache();
+
+	// Cuts off the directory from a file path to get the entry name + relative path
+	auto entry_name = [&](const string& file) {
+		auto name = file;
 		name.erase(0, filename.size());
 		if (strutil::startsWith(name, separator_))
 			name.erase(0, 1);
+		return name;
+	};
 
-		// log::info(3, fn.GetPath(true, wxPATH_UNIX));
+	vector<std::pair<ArchiveEntry*, unsigned>> to_detect;
+	for (unsigned a = 0; a < files.size(); a++)
+	{
+		auto name = entry_name(files[a]);
 
 		// Create entry
 		auto fn        = strutil::Path{ name };
-		auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName());
+		auto new_entry = std::make_shared<ArchiveEntry>(fn.fileName(), sizes[a]);
 
 		// Setup entry info
 		new_entry->setLoaded(false);
@@ -114,23 +133,52 @@ bool DirArchive::open(string_view filename)
 		ndir->addEntry(new_entry);
 		ndir->dirEntry()->exProp("filePath") = fmt::format("{}{}", filename, fn.path());
 
-		// Read entry data
-		new_entry->importFile(files[a]);
-		new_entry->setLoaded(true);
+		file_modification_times_[new_entry.get()] = modified_times[a];
+
+		// The file data only needs to be read if its type isn't cached
+		if (!type_cache || !type_cache->applyFileType(new_entry.get(), name, modified_times[a]))
+			to_detect.emplace_back(new_entry.get(), a);
+	}
 
-		file_modification_times_[new_entry.get()] = wxFileModificationTime(files[a]);
+	// Read and detect the types of all other files in batches, across worker
+	// threads. The data is unloaded again afterwards unless archive_load_data
+	// is enabled, it will be read from the file when needed
+	vector<ArchiveEntry*> detect_batch;
+	for (size_t start = 0; start < to_detect.size(); start += DETECT_BATCH_SIZE)
+	{
+		ui::setSplashProgress(static_cast<float>(start) / static_cast<float>(to_detect.size()));
 
-		// Detect entry type
-		EntryType::detectEntryType(*new_entry);
+		size_t count = to_detect.size() - start;
+		if (count > DETECT_BATCH_SIZE)
+			count = DETECT_BATCH_SIZE;
+		threadpool::parallelFor(count, [&](size_t index) {
+			const auto& file = to_detect[start + index];
+			file.first->data(false).importFile(files[file.second]);
+		});
 
-		// Unload data if needed
-		if (!archive_load_data)
-			new_entry->unloadData();
+		for (size_t a = start; a < start + count; a++)
+		{
+			to_detect[a].first->setLoaded(true);
+			detect_batch.push_back(to_detect[a].first);
+		}
+		detectEntryTypes(detect_batch);
+
+		// Add the detected types to the cache
+		if (type_cache)
+			for (size_t a = start; a < start + count; a++)
+			{
+				const auto& file = to_detect[a];
+				type_cache->addFileType(file.first, entry_name(files[file.second]), modified_times[file.second]);
+			}
 	}
+	closeTypeCache(true);
 
 	// Add empty directories
+	disk_dirs_.clear();
 	for (const auto& subdir : dirs)
 	{
+		disk_dirs_.insert(subdir);
+
 		auto name = subdir;
 		name.erase(0, filename.size());
 		strutil::removePrefixIP(name, separator_);
@@ -195,7 +243,9 @@ bool DirArchive::write(string_view filename, bool update)
 }
 
 // -----------------------------------------------------------------------------
-// Saves any changes to the directory to the file system
+// Saves any changes to the directory to the file system. Only modified, new
+// and moved entries are written (in parallel), and only removed files and
+// directories are deleted, so the directory doesn't need to be re-read
 // -----------------------------------------------------------------------------
 bool DirArchive::save(string_view filename)
 {
@@ -204,25 +254,42 @@ bool DirArchive::save(string_view filename)
 	putEntryTreeAsList(entries);
 
 	// Get entry path list
-	vector<string> entry_paths;
+	vector<string>                  entry_paths;
+	std::unordered_set<string_view> entry_path_set;
+	entry_paths.reserve(entries.size());
 	for (auto& entry : entries)
 	{
 		entry_paths.push_back(filename_ + entry->path(true));
 		if (separator_ != '/')
 			std::replace(entry_paths.back().begin(), entry_paths.back().end(), '/', separator_);
 	}
+	for (const auto& path : entry_paths)
+		entry_path_set.insert(path);
 
-	// Get current directory structure
-	long                time = app::runTimer();
-	vector<string>      files, dirs;
-	DirArchiveTraverser traverser(files, dirs);
-	wxDir               dir(filename_);
-	dir.Traverse(traverser, "", wxDIR_FILES | wxDIR_DIRS);
-	log::info(2, "GetAllFiles took {}ms", app::runTimer() - time);
+	// Find entries that need to be (re)written
+	long             time = app::runTimer();
+	vector<unsigned> to_write, folders;
+	for (unsigned a = 0; a < entries.size(); a++)
+	{
+		if (entries[a]->type() == EntryType::folderType())
+		{
+			folders.push_back(a);
+			continue;
+		}
 
-	// Check for any files to remove
-	time = app::runTimer();
-	std::error_code ec;
+		auto file_path = entries[a]->exProps().getOr<string>("filePath", "");
+		if (entries[a]->state() == ArchiveEntry::State::Unmodified && entry_paths[a] == file_path)
+			continue;
+
+		// Entries that moved need to be read from their old file before it is
+		// removed (or overwritten)
+		if (!entries[a]->isLoaded() && !file_path.empty() && entry_paths[a] != file_path)
+			entries[a]->data();
+
+		to_write.push_back(a);
+	}
+
+	// Remove any deleted files
 	for (const auto& removed_file : removed_files_)
 	{
 		if (fileutil::fileExists(removed_file))
@@ -232,63 +299,58 @@ bool DirArchive::save(string_view filename)
 		}
 	}
 
-	// Check for any directories to remove
-	for (int a = dirs.size() - 1; a >= 0; a--)
+	// Remove any directories on disk that are no longer part of the archive,
+	// deepest first (note that this will fail if there are any untracked files
+	// in the directory)
+	vector<string> removed_dirs;
+	for (auto dir = disk_dirs_.rbegin(); dir != disk_dirs_.rend(); ++dir)
 	{
-		// Check if dir path matches an existing dir
-		bool found = false;
-		for (const auto& entry_path : entry_paths)
+		if (entry_path_set.count(*dir) == 0 && wxRmdir(*dir))
 		{
-			if (dirs[a] == entry_path)
-			{
-				found = true;
-				break;
-			}
+			log::info(2, "Removing directory {}", *dir);
+			removed_dirs.push_back(*dir);
 		}
-
-		// Dir on disk isn't part of the archive in memory
-		// (Note that this will fail if there are any untracked files in the
-		// directory)
-		if (!found && wxRmdir(dirs[a]))
-			log::info(2, "Removing directory {}", dirs[a]);
 	}
+	for (const auto& dir : removed_dirs)
+		disk_dirs_.erase(dir);
 	log::info(2, "Remove check took {}ms", app::runTimer() - time);
 
-	// Go through entries
-	vector<string> files_written;
-	for (unsigned a = 0; a < entries.size(); a++)
+	// Create directories
+	for (auto a : folders)
 	{
-		// Check for folder
-		auto path = entry_paths[a];
-		if (entries[a]->type() == EntryType::folderType())
-		{
-			// Create if needed
-			if (!wxDirExists(path))
-				wxMkdir(path);
-
-			// Set unmodified
-			entries[a]->exProp("filePath") = path;
-			entries[a]->setState(ArchiveEntry::State::Unmodified);
+		const auto& path = entry_paths[a];
+		if (disk_dirs_.count(path) == 0 && !wxDirExists(path))
+			wxMkdir(path);
+		disk_dirs_.insert(path);
 
-			continue;
-		}
+		// Set unmodified
+		entries[a]->exProp("filePath") = path;
+		entries[a]->setState(ArchiveEntry::State::Unmodified);
+	}
 
-		// Check if entry needs to be (re)written
-		if (entries[a]->state() == ArchiveEntry::State::Unmodified
-			&& entries[a]->exProps().contains("filePath")
-			&& path == entries[a]->exProp<string>("filePath"))
-			continue;
+	// Write entries to files across worker threads
+	time = app::runTimer();
+	vector<uint8_t> written(to_write.size());
+	threadpool::parallelFor(
+		to_write.size(),
+		[&](size_t index)
+		{
+			auto a         = to_write[index];
+			written[index] = entries[a]->exportFile(entry_paths[a]);
+		});
+	log::info(2, "Writing {} entries took {}ms", to_write.size(), app::runTimer() - time);
 
-		// Write entry to file
-		if (!entries[a]->exportFile(path))
-			log::error("Unable to save entry {}: {}", entries[a]->name(), global::error);
-		else
-			files_written.push_back(path);
+	// Update entries
+	for (unsigned index = 0; index < to_write.size(); index++)
+	{
+		auto a     = to_write[index];
+		auto entry = entries[a];
+		if (!written[index])
+			log::error("Unable to save entry {} to {}", entry->name(), entry_paths[a]);
 
-		// Set unmodified
-		entries[a]->setState(ArchiveEntry::State::Unmodified);
-		entries[a]->exProp("filePath")       = path;
-		file_modification_times_[entries[a]] = wxFileModificationTime(path);
+		entry->setState(ArchiveEntry::State::Unmodified);
+		entry->exProp("filePath")       = entry_paths[a];
+		file_modification_times_[entry] = wxFileModificationTime(entry_paths[a]);
 	}
 
 	removed_files_.clear();
@@ -312,6 +374,22 @@ bool DirArchive::loadEntryData(ArchiveEntry* entry)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from its file if the
+// entry isn't loaded
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> DirArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (checkEntry(entry) && !entry->isLoaded())
+	{
+		auto reader = std::make_unique<FileDataReader>(entry->exProp<string>("filePath"), 0, entry->size());
+		if (reader->isOk())
+			return reader;
+	}
+
+	return Archive::entryDataReader(entry);
+}
+
 // -----------------------------------------------------------------------------
 // Deletes the directory matching [path], starting from [base]. If [base] is
 // null, the root directory is used.
@@ -652,7 +730,10 @@ void DirArchive::updateChangedEntries(vector<DirEntryChange>& changes)
 
 		// Deleted Directories
 		else if (change.action == DirEntryChange::Action::DeletedDir)
+		{
 			removeDir(change.entry_path);
+			disk_dirs_.erase(change.file_path);
+		}
 
 		// New Directory
 		else if (change.action == DirEntryChange::Action::AddedDir)
@@ -665,6 +746,7 @@ void DirArchive::updateChangedEntries(vector<DirEntryChange>& changes)
 			auto ndir = createDir(name);
 			ndir->dirEntry()->setState(ArchiveEntry::State::Unmodified);
 			ndir->dirEntry()->exProp("filePath") = change.file_path;
+			disk_dirs_.insert(change.file_path);
 		}
 
 		// New Entry
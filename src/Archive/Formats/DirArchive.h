@@ -55,6 +55,9 @@ public:
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
 
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
+
 	// Dir stuff
 	shared_ptr<ArchiveDir> removeDir(string_view path, ArchiveDir* base = nullptr) override;
 	bool                   renameDir(ArchiveDir* dir, string_view new_name) override;
@@ -84,6 +87,7 @@ private:
 	std::map<ArchiveEntry*, time_t> file_modification_times_;
 	vector<string>                  removed_files_;
 	IgnoredFileChanges              ignored_file_changes_;
+	std::set<string>                disk_dirs_; // Directories on disk as of the last open/save
 };
 
 class DirArchiveTraverser : public wxDirTraverser
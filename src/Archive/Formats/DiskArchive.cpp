@@ -34,6 +34,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "DiskArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -118,7 +119,7 @@ bool DiskArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(fn.fileName(), dent.length);
-		entry->exProp("Offset") = (int)dent.offset;
+		entry->formatInfo().offset = (int)dent.offset;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -143,7 +144,7 @@ bool DiskArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->formatInfo().offset, entry->size());
 			entry->importMemChunk(edata);
 		}
 
@@ -215,7 +216,7 @@ bool DiskArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 
 		// Check entry name
@@ -302,7 +303,7 @@ bool DiskArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -322,7 +323,7 @@ bool DiskArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Nerve disk archive
 // -----------------------------------------------------------------------------
-bool DiskArchive::isDiskArchive(MemChunk& mc)
+bool DiskArchive::isDiskArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	size_t mcsize = mc.size();
@@ -332,8 +333,8 @@ bool DiskArchive::isDiskArchive(MemChunk& mc)
 	// Read disk header
 	uint32_t num_entries;
 	uint32_t size_entries;
-	mc.seek(0, SEEK_SET);
-	mc.read(&num_entries, 4);
+	MemDataReader reader(mc);
+	reader.read(&num_entries, 4);
 	num_entries = wxUINT32_SWAP_ON_LE(num_entries);
 
 	size_t start_offset = (72 * num_entries) + 8;
@@ -346,7 +347,7 @@ bool DiskArchive::isDiskArchive(MemChunk& mc)
 	{
 		// Read entry info
 		DiskEntry entry;
-		mc.read(&entry, 72);
+		reader.read(&entry, 72);
 
 		// Byteswap if needed
 		entry.length = wxUINT32_SWAP_ON_LE(entry.length);
@@ -359,7 +360,7 @@ bool DiskArchive::isDiskArchive(MemChunk& mc)
 		if (entry.offset + entry.length > mcsize)
 			return false;
 	}
-	mc.read(&size_entries, 4);
+	reader.read(&size_entries, 4);
 	size_entries = wxUINT32_SWAP_ON_LE(size_entries);
 	if (size_entries + start_offset != mcsize)
 		return false;
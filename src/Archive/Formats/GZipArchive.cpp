@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GZipArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/Misc.h"
 #include "Utility/Compression.h"
 #include "Utility/StringUtils.h"
@@ -38,6 +39,14 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, archive_spill_size)
+
+
 // -----------------------------------------------------------------------------
 //
 // GZipArchive Class Functions
@@ -155,10 +164,22 @@ bool GZipArchive::open(MemChunk& mc)
 	// Let's create the entry
 	ArchiveModSignalBlocker sig_blocker{ *this };
 	auto                    entry = std::make_shared<ArchiveEntry>(name, size - mds);
-	MemChunk                xdata;
-	if (compression::gzipInflate(mc, xdata))
+
+	// The (32bit) inflated size is at the end of the stream, so small data can
+	// usually be inflated straight into place
+	uint32_t isize = 0;
+	memcpy(&isize, mc.data() + size - 4, 4);
+	isize             = wxUINT32_SWAP_ON_BE(isize);
+	bool     in_place = archive_spill_size <= 0 || isize <= static_cast<size_t>(archive_spill_size) * 1024 * 1024;
+	size_t   inflated = 0;
+	MemChunk xdata;
+	if (isize > 0 && in_place && xdata.reSize(isize, false)
+		&& compression::gzipInflateTo(mc, xdata.data(), isize, &inflated) && inflated == isize)
 		entry->importMemChunk(xdata);
-	else
+
+	// Otherwise inflate it a chunk at a time (spilling to a temp file if large)
+	else if (!importStreamed(
+				 entry.get(), [&mc](const DataSink& sink) { return compression::gzipInflateStream(mc, sink); }))
 		return false;
 	rootDir()->addEntry(entry);
 	EntryType::detectEntryType(*entry);
@@ -183,7 +204,7 @@ bool GZipArchive::write(MemChunk& mc, bool update)
 	if (numEntries() == 1)
 	{
 		MemChunk stream;
-		if (compression::gzipDeflate(entryAt(0)->data(), stream, 9))
+		if (compression::gzipDeflateParallel(entryAt(0)->data(), stream, 9))
 		{
 			auto     data = stream.data();
 			uint32_t working;
@@ -383,7 +404,7 @@ vector<ArchiveEntry*> GZipArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid GZip archive
 // -----------------------------------------------------------------------------
-bool GZipArchive::isGZipArchive(MemChunk& mc)
+bool GZipArchive::isGZipArchive(const MemChunk& mc)
 {
 	// Minimal metadata size is 18: 10 for header, 8 for footer
 	size_t mds  = 18;
@@ -393,7 +414,8 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 
 	// Read header
 	uint8_t header[4];
-	mc.read(header, 4);
+	MemDataReader reader(mc);
+	reader.read(header, 4);
 
 	// Check for GZip header; we'll only accept deflated gzip files
 	// and reject any field using unknown flags
@@ -407,23 +429,23 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	bool fcmnt = (header[3] & FLG_FCMNT) != 0;
 
 	uint32_t mtime;
-	mc.read(&mtime, 4);
+	reader.read(&mtime, 4);
 
 	uint8_t xfl;
-	mc.read(&xfl, 1);
+	reader.read(&xfl, 1);
 	uint8_t os;
-	mc.read(&os, 1);
+	reader.read(&os, 1);
 
 	// Skip extra fields which may be there
 	if (fxtra)
 	{
 		uint16_t xlen;
-		mc.read(&xlen, 2);
+		reader.read(&xlen, 2);
 		xlen = wxUINT16_SWAP_ON_BE(xlen);
 		mds += xlen + 2;
 		if (mds > size)
 			return false;
-		mc.seek(xlen, SEEK_CUR);
+		reader.seek(xlen);
 	}
 
 	// Skip past name, if any
@@ -433,7 +455,7 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 		char   c;
 		do
 		{
-			mc.read(&c, 1);
+			reader.read(&c, 1);
 			if (c)
 				name += c;
 			++mds;
@@ -447,7 +469,7 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 		char   c;
 		do
 		{
-			mc.read(&c, 1);
+			reader.read(&c, 1);
 			if (c)
 				comment += c;
 			++mds;
@@ -458,12 +480,12 @@ bool GZipArchive::isGZipArchive(MemChunk& mc)
 	if (fhcrc)
 	{
 		uint16_t hcrc;
-		mc.read(&hcrc, 2);
+		reader.read(&hcrc, 2);
 		mds += 2;
 	}
 
 	// Header is over
-	if (mds > size || mc.currentPos() + 8 > size)
+	if (mds > size || reader.currentPos() + 8 > size)
 		return false;
 
 	// If it's passed to here it's probably a gzip file
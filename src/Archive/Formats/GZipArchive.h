@@ -49,7 +49,7 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isGZipArchive(MemChunk& mc);
+	static bool isGZipArchive(const MemChunk& mc);
 	static bool isGZipArchive(const string& filename);
 
 private:
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GobArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -61,7 +62,7 @@ uint32_t GobArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -73,7 +74,7 @@ void GobArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -150,7 +151,7 @@ bool GobArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -250,7 +251,7 @@ bool GobArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 	}
 
@@ -298,7 +299,7 @@ bool GobArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Dark Forces gob archive
 // -----------------------------------------------------------------------------
-bool GobArchive::isGobArchive(MemChunk& mc)
+bool GobArchive::isGobArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -310,8 +311,9 @@ bool GobArchive::isGobArchive(MemChunk& mc)
 
 	// Get directory offset
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&dir_offset, 4);
+	MemDataReader reader(mc);
+	reader.seekFromStart(4);
+	reader.read(&dir_offset, 4);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
 
 	// Check size
@@ -320,8 +322,8 @@ bool GobArchive::isGobArchive(MemChunk& mc)
 
 	// Get number of lumps
 	uint32_t num_lumps = 0;
-	mc.seek(dir_offset, SEEK_SET);
-	mc.read(&num_lumps, 4);
+	reader.seekFromStart(dir_offset);
+	reader.read(&num_lumps, 4);
 	num_lumps = wxINT32_SWAP_ON_BE(num_lumps);
 
 	// Compute directory size
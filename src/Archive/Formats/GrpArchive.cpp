@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "GrpArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -61,7 +62,7 @@ uint32_t GrpArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -73,7 +74,7 @@ void GrpArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -147,7 +148,7 @@ bool GrpArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -155,7 +156,6 @@ bool GrpArchive::open(MemChunk& mc)
 	}
 
 	// Detect all entry types
-	MemChunk edata;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
@@ -168,9 +168,8 @@ bool GrpArchive::open(MemChunk& mc)
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
-			entry->importMemChunk(edata);
+			// Read the entry data (will reference the data directly if mc is memory-mapped)
+			entry->importMemChunk(mc, getEntryOffset(entry), entry->size());
 		}
 
 		// Detect entry type
@@ -227,7 +226,7 @@ bool GrpArchive::write(MemChunk& mc, bool update)
 		{
 			long offset = getEntryOffset(entry);
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 	}
 
@@ -259,6 +258,10 @@ bool GrpArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly if the grpfile is memory-mapped
+	if (loadMappedEntryData(entry, getEntryOffset(entry), entry->size()))
+		return true;
+
 	// Open grpfile
 	wxFile file(filename_);
 
@@ -279,10 +282,22 @@ bool GrpArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from the grpfile if the
+// entry isn't loaded
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> GrpArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (auto reader = fileDataReader(entry, getEntryOffset(entry)))
+		return reader;
+
+	return Archive::entryDataReader(entry);
+}
+
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Duke Nukem 3D grp archive
 // -----------------------------------------------------------------------------
-bool GrpArchive::isGrpArchive(MemChunk& mc)
+bool GrpArchive::isGrpArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 16)
@@ -291,9 +306,9 @@ bool GrpArchive::isGrpArchive(MemChunk& mc)
 	// Get number of lumps
 	uint32_t num_lumps     = 0;
 	char     ken_magic[13] = "";
-	mc.seek(0, SEEK_SET);
-	mc.read(ken_magic, 12); // "KenSilverman"
-	mc.read(&num_lumps, 4); // No. of lumps in grp
+	MemDataReader reader(mc);
+	reader.read(ken_magic, 12); // "KenSilverman"
+	reader.read(&num_lumps, 4); // No. of lumps in grp
 
 	// Byteswap values for big endian if needed
 	num_lumps = wxINT32_SWAP_ON_BE(num_lumps);
@@ -310,8 +325,8 @@ bool GrpArchive::isGrpArchive(MemChunk& mc)
 	uint32_t size      = 0;
 	for (uint32_t a = 0; a < num_lumps; ++a)
 	{
-		mc.read(ken_magic, 12);
-		mc.read(&size, 4);
+		reader.read(ken_magic, 12);
+		reader.read(&size, 4);
 		totalsize += size;
 	}
 
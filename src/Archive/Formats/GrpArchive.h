@@ -20,9 +20,13 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool canMapFile() const override { return true; }
+
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isGrpArchive(MemChunk& mc);
+	static bool isGrpArchive(const MemChunk& mc);
 	static bool isGrpArchive(const string& filename);
 };
 } // namespace slade
@@ -128,7 +128,7 @@ uint32_t HogArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -140,7 +140,7 @@ void HogArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -195,7 +195,7 @@ bool HogArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Handle txb/ctb as archive level encryption. This is not strictly
@@ -269,7 +269,7 @@ bool HogArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 		offset += entry->size();
 	}
@@ -400,7 +400,7 @@ bool HogArchive::renameEntry(ArchiveEntry* entry, string_view name)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Descent hog archive
 // -----------------------------------------------------------------------------
-bool HogArchive::isHogArchive(MemChunk& mc)
+bool HogArchive::isHogArchive(const MemChunk& mc)
 {
 	// Check size
 	size_t size = mc.size();
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "LfdArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -62,7 +63,7 @@ uint32_t LfdArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -74,7 +75,7 @@ void LfdArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -151,7 +152,7 @@ bool LfdArchive::open(MemChunk& mc)
 		fn.setExtension(type);
 		auto nlump = std::make_shared<ArchiveEntry>(fn.fileName(), length);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -222,7 +223,7 @@ bool LfdArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)total_size;
+			entry->formatInfo().offset = (int)total_size;
 		}
 		total_size += entry->size();
 	}
@@ -328,7 +329,7 @@ bool LfdArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Dark Forces lfd archive
 // -----------------------------------------------------------------------------
-bool LfdArchive::isLfdArchive(MemChunk& mc)
+bool LfdArchive::isLfdArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -340,8 +341,9 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 
 	// Get offset of first entry
 	uint32_t dir_offset = 0;
-	mc.seek(12, SEEK_SET);
-	mc.read(&dir_offset, 4);
+	MemDataReader reader(mc);
+	reader.seekFromStart(12);
+	reader.read(&dir_offset, 4);
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset) + 16;
 	if (dir_offset % 16)
 		return false;
@@ -351,11 +353,11 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 	char     name2[9];
 	uint32_t len1;
 	uint32_t len2;
-	mc.read(type1, 4);
+	reader.read(type1, 4);
 	type1[4] = 0;
-	mc.read(name1, 8);
+	reader.read(name1, 8);
 	name1[8] = 0;
-	mc.read(&len1, 4);
+	reader.read(&len1, 4);
 	len1 = wxINT32_SWAP_ON_BE(len1);
 
 	// Check size
@@ -363,12 +365,12 @@ bool LfdArchive::isLfdArchive(MemChunk& mc)
 		return false;
 
 	// Compare
-	mc.seek(dir_offset, SEEK_SET);
-	mc.read(type2, 4);
+	reader.seekFromStart(dir_offset);
+	reader.read(type2, 4);
 	type2[4] = 0;
-	mc.read(name2, 8);
+	reader.read(name2, 8);
 	name2[8] = 0;
-	mc.read(&len2, 4);
+	reader.read(&len2, 4);
 	len2 = wxINT32_SWAP_ON_BE(len2);
 
 	if (strcmp(type1, type2) != 0 || strcmp(name1, name2) != 0 || len1 != len2)
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "LibArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -53,7 +54,7 @@ uint32_t LibArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -65,7 +66,7 @@ void LibArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -122,7 +123,7 @@ bool LibArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(myname, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -220,7 +221,7 @@ bool LibArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)wxINT32_SWAP_ON_BE(offset);
+			entry->formatInfo().offset = (int)wxINT32_SWAP_ON_BE(offset);
 		}
 	}
 
@@ -273,15 +274,16 @@ bool LibArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Shadowcaster lib archive
 // -----------------------------------------------------------------------------
-bool LibArchive::isLibArchive(MemChunk& mc)
+bool LibArchive::isLibArchive(const MemChunk& mc)
 {
 	if (mc.size() < 64)
 		return false;
 
 	// Read lib footer
-	mc.seek(2, SEEK_END);
+	MemDataReader reader(mc);
+	reader.seekFromEnd(2);
 	uint32_t num_lumps = 0;
-	mc.read(&num_lumps, 2); // Size
+	reader.read(&num_lumps, 2); // Size
 	num_lumps          = wxINT16_SWAP_ON_BE(num_lumps);
 	int32_t dir_offset = mc.size() - (2 + (num_lumps * 21));
 
@@ -290,15 +292,15 @@ bool LibArchive::isLibArchive(MemChunk& mc)
 		return false;
 
 	// Check directory offset is decent
-	mc.seek(dir_offset, SEEK_SET);
+	reader.seekFromStart(dir_offset);
 	char     myname[13] = "";
 	uint32_t offset     = 0;
 	uint32_t size       = 0;
 	uint8_t  dummy      = 0;
-	mc.read(&size, 4);   // Size
-	mc.read(&offset, 4); // Offset
-	mc.read(myname, 12); // Name
-	mc.read(&dummy, 1);  // Separator
+	reader.read(&size, 4);   // Size
+	reader.read(&offset, 4); // Offset
+	reader.read(myname, 12); // Name
+	reader.read(&dummy, 1);  // Separator
 	offset     = wxINT32_SWAP_ON_BE(offset);
 	size       = wxINT32_SWAP_ON_BE(size);
 	myname[12] = '\0';
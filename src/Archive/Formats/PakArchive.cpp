@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "PakArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -116,7 +117,7 @@ bool PakArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-		entry->exProp("Offset") = (int)offset;
+		entry->formatInfo().offset = (int)offset;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -125,7 +126,6 @@ bool PakArchive::open(MemChunk& mc)
 	}
 
 	// Detect all entry types
-	MemChunk              edata;
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
 	ui::setSplashProgressMessage("Detecting entry types");
@@ -140,9 +140,8 @@ bool PakArchive::open(MemChunk& mc)
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
+			// Read the entry data (will reference the data directly if mc is memory-mapped)
+			entry->importMemChunk(mc, entry->formatInfo().offset, entry->size());
 		}
 
 		// Detect entry type
@@ -215,7 +214,7 @@ bool PakArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 
 		// Check entry name
@@ -280,6 +279,10 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly if the pak file is memory-mapped
+	if (loadMappedEntryData(entry, entry->formatInfo().offset, entry->size()))
+		return true;
+
 	// Open archive file
 	wxFile file(filename_);
 
@@ -291,7 +294,7 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -300,6 +303,19 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from the pak file if the
+// entry isn't loaded
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> PakArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (checkEntry(entry) && !entry->isLoaded())
+		if (auto reader = fileDataReader(entry, entry->formatInfo().offset))
+			return reader;
+
+	return Archive::entryDataReader(entry);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -311,7 +327,7 @@ bool PakArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Quake pak archive
 // -----------------------------------------------------------------------------
-bool PakArchive::isPakArchive(MemChunk& mc)
+bool PakArchive::isPakArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	if (mc.size() < 12)
@@ -321,10 +337,10 @@ bool PakArchive::isPakArchive(MemChunk& mc)
 	char    pack[4];
 	int32_t dir_offset;
 	int32_t dir_size;
-	mc.seek(0, SEEK_SET);
-	mc.read(pack, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
+	MemDataReader reader(mc);
+	reader.read(pack, 4);
+	reader.read(&dir_offset, 4);
+	reader.read(&dir_size, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
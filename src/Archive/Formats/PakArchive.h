@@ -16,9 +16,13 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool canMapFile() const override { return true; }
+
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isPakArchive(MemChunk& mc);
+	static bool isPakArchive(const MemChunk& mc);
 	static bool isPakArchive(const string& filename);
 };
 } // namespace slade
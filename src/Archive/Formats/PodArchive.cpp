@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "PodArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/Console.h"
 #include "General/UI.h"
 #include "MainEditor/MainEditor.h"
@@ -104,7 +105,7 @@ bool PodArchive::open(MemChunk& mc)
 	{
 		// Create entry
 		auto new_entry = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(files[a].name), files[a].size);
-		new_entry->exProp("Offset") = files[a].offset;
+		new_entry->formatInfo().offset = files[a].offset;
 		new_entry->setLoaded(false);
 
 		// Add entry and directory to directory tree
@@ -134,7 +135,7 @@ bool PodArchive::open(MemChunk& mc)
 
 		// Read data
 		MemChunk edata;
-		mc.exportMemChunk(edata, all_entries[a]->exProp<int>("Offset"), all_entries[a]->size());
+		mc.exportMemChunk(edata, all_entries[a]->formatInfo().offset, all_entries[a]->size());
 		all_entries[a]->importMemChunk(edata);
 
 		// Detect entry type
@@ -220,7 +221,7 @@ bool PodArchive::write(MemChunk& mc, bool update)
 			5,
 			"entry {}: old={} new={} size={}",
 			fe.name,
-			entry->exProp<int>("Offset"),
+			entry->formatInfo().offset,
 			fe.offset,
 			entry->size());
 
@@ -265,7 +266,7 @@ bool PodArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to lump offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -285,22 +286,22 @@ bool PodArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid pod archive
 // -----------------------------------------------------------------------------
-bool PodArchive::isPodArchive(MemChunk& mc)
+bool PodArchive::isPodArchive(const MemChunk& mc)
 {
 	// Check size for header
 	if (mc.size() < 84)
 		return false;
 
 	// Read no. of files
-	mc.seek(0, 0);
 	uint32_t num_files;
-	mc.read(&num_files, 4);
+	MemDataReader reader(mc);
+	reader.read(&num_files, 4);
 	if (num_files == 0)
 		return false; // 0 files, unlikely to be a valid archive
 
 	// Read id
 	char id[80];
-	mc.read(id, 80);
+	reader.read(id, 80);
 
 	// Check size for directory
 	auto dir_end = 84 + (num_files * 40);
@@ -311,7 +312,7 @@ bool PodArchive::isPodArchive(MemChunk& mc)
 	FileEntry entry;
 	for (unsigned a = 0; a < num_files; a++)
 	{
-		mc.read(&entry, 40);
+		reader.read(&entry, 40);
 		auto end = entry.offset + entry.size;
 		if (end > mc.size() || end < dir_end)
 			return false;
@@ -23,7 +23,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isPodArchive(MemChunk& mc);
+	static bool isPodArchive(const MemChunk& mc);
 	static bool isPodArchive(const string& filename);
 
 private:
@@ -23,8 +23,8 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isResArchive(MemChunk& mc);
-	static bool isResArchive(MemChunk& mc, size_t& d_o, size_t& n_l);
+	static bool isResArchive(const MemChunk& mc);
+	static bool isResArchive(const MemChunk& mc, size_t& d_o, size_t& n_l);
 	static bool isResArchive(const string& filename);
 
 private:
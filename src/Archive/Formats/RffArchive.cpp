@@ -67,6 +67,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "RffArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -103,16 +104,84 @@ struct RFFLump
 	uint32_t IndexNum; // Used by .sfx, possibly others
 };
 
+// Only the first 256 bytes of encrypted lumps are encrypted
+constexpr unsigned LUMP_CRYPT_LENGTH = 256;
+
 // -----------------------------------------------------------------------------
-// From ZDoom: decrypts RFF data
+// Blood RFF encryption (from ZDoom): each byte i of the data is XORed with
+// (key + i / 2) & 0xFF. The keystream repeats every 512 bytes, so it is
+// generated once per key and then applied 8 bytes at a time
 // -----------------------------------------------------------------------------
-void bloodCrypt(void* data, int key, int len)
+class BloodCipher
 {
-	int p = (uint8_t)key, i;
+public:
+	BloodCipher(uint32_t key)
+	{
+		for (unsigned i = 0; i < sizeof(stream_); ++i)
+			stream_[i] = static_cast<uint8_t>(key + ((i % PERIOD) >> 1));
+	}
 
-	for (i = 0; i < len; ++i)
-		((uint8_t*)data)[i] ^= (unsigned char)(p + (i >> 1));
-}
+	// Decrypts (or encrypts) [len] bytes of [data] in place, where [data] is
+	// at byte [start] of the encrypted data
+	void apply(void* data, unsigned len, unsigned start = 0) const
+	{
+		auto     bytes = static_cast<uint8_t*>(data);
+		unsigned pos   = start % PERIOD;
+		unsigned i     = 0;
+		for (; i + 8 <= len; i += 8)
+		{
+			uint64_t word, key;
+			memcpy(&word, bytes + i, 8);
+			memcpy(&key, stream_ + pos, 8);
+			word ^= key;
+			memcpy(bytes + i, &word, 8);
+			pos = (pos + 8) % PERIOD;
+		}
+		for (; i < len; ++i)
+		{
+			bytes[i] ^= stream_[pos];
+			pos = (pos + 1) % PERIOD;
+		}
+	}
+
+private:
+	static constexpr unsigned PERIOD = 512;
+
+	// One period of the keystream, plus enough to read 8 bytes from anywhere
+	// in it
+	uint8_t stream_[PERIOD + 8];
+};
+
+// Cipher for encrypted lump data (always key 0)
+const BloodCipher lump_cipher{ 0 };
+
+// -----------------------------------------------------------------------------
+// Reads encrypted lump data from another reader, decrypting it as it is read
+// -----------------------------------------------------------------------------
+class BloodDataReader : public EntryDataReader
+{
+public:
+	BloodDataReader(unique_ptr<EntryDataReader> reader) :
+		EntryDataReader{ reader->size() },
+		reader_{ std::move(reader) }
+	{
+	}
+
+protected:
+	bool readAt(unsigned offset, void* buffer, unsigned count) override
+	{
+		if (!reader_->seekFromStart(offset) || !reader_->read(buffer, count))
+			return false;
+
+		if (offset < LUMP_CRYPT_LENGTH)
+			lump_cipher.apply(buffer, std::min(count, LUMP_CRYPT_LENGTH - offset), offset);
+
+		return true;
+	}
+
+private:
+	unique_ptr<EntryDataReader> reader_;
+};
 } // namespace
 
 
@@ -132,7 +201,7 @@ uint32_t RffArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -144,7 +213,7 @@ void RffArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -188,7 +257,7 @@ bool RffArchive::open(MemChunk& mc)
 	mc.seek(dir_offset, SEEK_SET);
 	ui::setSplashProgressMessage("Reading rff archive data");
 	mc.read(lumps, num_lumps * sizeof(RFFLump));
-	bloodCrypt(lumps, dir_offset, num_lumps * sizeof(RFFLump));
+	BloodCipher(dir_offset).apply(lumps, num_lumps * sizeof(RFFLump));
 	for (uint32_t d = 0; d < num_lumps; d++)
 	{
 		// Update splash window progress
@@ -222,7 +291,7 @@ bool RffArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Is the entry encrypted?
@@ -253,14 +322,7 @@ bool RffArchive::open(MemChunk& mc)
 
 			// If the entry is encrypted, decrypt it
 			if (entry->encryption() != ArchiveEntry::Encryption::None)
-			{
-				uint8_t* cdata = new uint8_t[entry->size()];
-				memcpy(cdata, edata.data(), entry->size());
-				int cryptlen = entry->size() < 256 ? entry->size() : 256;
-				bloodCrypt(cdata, 0, cryptlen);
-				edata.importMem(cdata, entry->size());
-				delete[] cdata;
-			}
+				lump_cipher.apply(edata.data(), std::min(entry->size(), LUMP_CRYPT_LENGTH));
 
 			// Import data
 			entry->importMemChunk(edata);
@@ -314,30 +376,64 @@ bool RffArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
-	// Open rfffile
-	wxFile file(filename_);
+	// Reference the data directly if the rff file is memory-mapped (and the
+	// lump isn't encrypted, since that needs its own copy to decrypt)
+	bool encrypted = entry->encryption() != ArchiveEntry::Encryption::None;
+	if (!encrypted && loadMappedEntryData(entry, getEntryOffset(entry), entry->size()))
+		return true;
 
-	// Check if opening the file failed
-	if (!file.IsOpened())
+	// Read the lump data, from the memory-mapped file if possible
+	MemChunk data;
+	if (!isFileMapped() || !data.importMapped(file_mapping_, getEntryOffset(entry), entry->size())
+		|| !data.detach())
 	{
-		log::error("RffArchive::loadEntryData: Failed to open rff file {}", filename_);
-		return false;
+		// Open rfffile
+		wxFile file(filename_);
+
+		// Check if opening the file failed
+		if (!file.IsOpened())
+		{
+			log::error("RffArchive::loadEntryData: Failed to open rff file {}", filename_);
+			return false;
+		}
+
+		// Seek to lump offset in file and read it in
+		file.Seek(getEntryOffset(entry), wxFromStart);
+		data.importFileStreamWx(file, entry->size());
 	}
 
-	// Seek to lump offset in file and read it in
-	file.Seek(getEntryOffset(entry), wxFromStart);
-	entry->importFileStream(file, entry->size());
+	// Decrypt it in place if needed
+	if (encrypted)
+		lump_cipher.apply(data.data(), std::min(data.size(), LUMP_CRYPT_LENGTH));
+	entry->importMemChunk(data);
 
 	// Set the lump to loaded
 	entry->setLoaded();
+	entry->setState(ArchiveEntry::State::Unmodified);
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from the rff file if the
+// entry isn't loaded (and decrypted as it is read if needed)
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> RffArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (auto reader = fileDataReader(entry, getEntryOffset(entry)))
+	{
+		if (entry->encryption() != ArchiveEntry::Encryption::None)
+			return std::make_unique<BloodDataReader>(std::move(reader));
+		return reader;
+	}
+
+	return Archive::entryDataReader(entry);
+}
+
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Duke Nukem 3D grp archive
 // -----------------------------------------------------------------------------
-bool RffArchive::isRffArchive(MemChunk& mc)
+bool RffArchive::isRffArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -347,11 +443,11 @@ bool RffArchive::isRffArchive(MemChunk& mc)
 	uint8_t  magic[4];
 	uint32_t version, dir_offset, num_lumps;
 
-	mc.seek(0, SEEK_SET);
-	mc.read(magic, 4);       // Should be "RFF\x18"
-	mc.read(&version, 4);    // 0x01 0x03 \x00 \x00
-	mc.read(&dir_offset, 4); // Offset to directory
-	mc.read(&num_lumps, 4);  // No. of lumps in rff
+	MemDataReader reader(mc);
+	reader.read(magic, 4);       // Should be "RFF\x18"
+	reader.read(&version, 4);    // 0x01 0x03 \x00 \x00
+	reader.read(&dir_offset, 4); // Offset to directory
+	reader.read(&num_lumps, 4);  // No. of lumps in rff
 
 	// Byteswap values for big endian if needed
 	dir_offset = wxINT32_SWAP_ON_BE(dir_offset);
@@ -365,10 +461,10 @@ bool RffArchive::isRffArchive(MemChunk& mc)
 
 	// Compute total size
 	auto lumps = new RFFLump[num_lumps];
-	mc.seek(dir_offset, SEEK_SET);
+	reader.seekFromStart(dir_offset);
 	ui::setSplashProgressMessage("Reading rff archive data");
-	mc.read(lumps, num_lumps * sizeof(RFFLump));
-	bloodCrypt(lumps, dir_offset, num_lumps * sizeof(RFFLump));
+	reader.read(lumps, num_lumps * sizeof(RFFLump));
+	BloodCipher(dir_offset).apply(lumps, num_lumps * sizeof(RFFLump));
 	uint32_t totalsize = 12 + num_lumps * sizeof(RFFLump);
 	uint32_t size      = 0;
 	for (uint32_t a = 0; a < num_lumps; ++a)
@@ -425,7 +521,7 @@ bool RffArchive::isRffArchive(const string& filename)
 	file.Seek(dir_offset, wxFromStart);
 	ui::setSplashProgressMessage("Reading rff archive data");
 	file.Read(lumps, num_lumps * sizeof(RFFLump));
-	bloodCrypt(lumps, dir_offset, num_lumps * sizeof(RFFLump));
+	BloodCipher(dir_offset).apply(lumps, num_lumps * sizeof(RFFLump));
 	uint32_t totalsize = 12 + num_lumps * sizeof(RFFLump);
 	for (uint32_t a = 0; a < num_lumps; ++a)
 		totalsize += lumps[a].Size;
@@ -20,9 +20,13 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool canMapFile() const override { return true; }
+
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isRffArchive(MemChunk& mc);
+	static bool isRffArchive(const MemChunk& mc);
 	static bool isRffArchive(const string& filename);
 };
 } // namespace slade
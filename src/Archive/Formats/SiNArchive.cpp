@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SiNArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -117,7 +118,7 @@ bool SiNArchive::open(MemChunk& mc)
 
 		// Create entry
 		auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-		entry->exProp("Offset") = (int)offset;
+		entry->formatInfo().offset = (int)offset;
 		entry->setLoaded(false);
 		entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -142,7 +143,7 @@ bool SiNArchive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->formatInfo().offset, entry->size());
 			entry->importMemChunk(edata);
 		}
 
@@ -216,7 +217,7 @@ bool SiNArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 
 		// Check entry name
@@ -291,7 +292,7 @@ bool SiNArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -311,7 +312,7 @@ bool SiNArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Ritual Entertainment SiN archive
 // -----------------------------------------------------------------------------
-bool SiNArchive::isSiNArchive(MemChunk& mc)
+bool SiNArchive::isSiNArchive(const MemChunk& mc)
 {
 	// Check given data is valid
 	if (mc.size() < 12)
@@ -321,10 +322,10 @@ bool SiNArchive::isSiNArchive(MemChunk& mc)
 	char    pack[4];
 	int32_t dir_offset;
 	int32_t dir_size;
-	mc.seek(0, SEEK_SET);
-	mc.read(pack, 4);
-	mc.read(&dir_offset, 4);
-	mc.read(&dir_size, 4);
+	MemDataReader reader(mc);
+	reader.read(pack, 4);
+	reader.read(&dir_offset, 4);
+	reader.read(&dir_size, 4);
 
 	// Byteswap values for big endian if needed
 	dir_size   = wxINT32_SWAP_ON_BE(dir_size);
@@ -18,7 +18,7 @@ public:
 	bool loadEntryData(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isSiNArchive(MemChunk& mc);
+	static bool isSiNArchive(const MemChunk& mc);
 	static bool isSiNArchive(const string& filename);
 };
 } // namespace slade
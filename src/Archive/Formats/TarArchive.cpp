@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "TarArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -272,6 +273,11 @@ bool TarArchive::open(MemChunk& mc)
 
 	mc.seek(0, SEEK_SET);
 
+	// Keep a view of the data if it is memory-mapped, to load entries from
+	mapped_data_.clear();
+	if (mc.isMapped())
+		mapped_data_.importMapped(mc.mapping(), mc.mappedOffset(), mc.size());
+
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 	ui::setSplashProgressMessage("Reading tar archive data");
@@ -330,7 +336,7 @@ bool TarArchive::open(MemChunk& mc)
 
 			// Create entry
 			auto entry              = std::make_shared<ArchiveEntry>(strutil::Path::fileNameOf(name), size);
-			entry->exProp("Offset") = (int)mc.currentPos();
+			entry->formatInfo().offset = (int)mc.currentPos();
 			entry->setLoaded(false);
 			entry->setState(ArchiveEntry::State::Unmodified);
 
@@ -356,7 +362,6 @@ bool TarArchive::open(MemChunk& mc)
 	}
 
 	// Detect all entry types
-	MemChunk              edata;
 	vector<ArchiveEntry*> all_entries;
 	putEntryTreeAsList(all_entries);
 	ui::setSplashProgressMessage("Detecting entry types");
@@ -368,13 +373,10 @@ bool TarArchive::open(MemChunk& mc)
 		// Get entry
 		auto entry = all_entries[a];
 
-		// Read entry data if it isn't zero-sized
+		// Read entry data if it isn't zero-sized (just a view of it if the
+		// data is memory-mapped)
 		if (entry->size() > 0)
-		{
-			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
-			entry->importMemChunk(edata);
-		}
+			entry->importMemChunk(mc, entry->formatInfo().offset, entry->size());
 
 		// Detect entry type
 		EntryType::detectEntryType(*entry);
@@ -414,6 +416,17 @@ bool TarArchive::write(MemChunk& mc, bool update)
 	putEntryTreeAsList(entries);
 	size_t listsize = entries.size();
 
+	// Preallocate the total size (a header for each entry, data padded to
+	// 512 bytes and two blank pages at the end)
+	uint32_t total_size = 1024;
+	for (auto entry : entries)
+	{
+		total_size += 512;
+		if (entry->type() != EntryType::folderType())
+			total_size += (entry->size() + 511) / 512 * 512;
+	}
+	mc.reserve(total_size);
+
 	for (size_t a = 0; a < listsize; ++a)
 	{
 		// MAYBE TODO: store the header variables as ExProps for the entries, then only change
@@ -480,6 +493,10 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Point the entry at its data if the tar data is memory-mapped
+	if (mapped_data_.isMapped())
+		return loadMappedEntryData(entry, mapped_data_, entry->formatInfo().offset, entry->size());
+
 	// Open archive file
 	wxFile file(filename_);
 
@@ -491,7 +508,7 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to entry offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -500,6 +517,21 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from the mapped tar data
+// or the tar file if the entry isn't loaded
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> TarArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (checkEntry(entry) && !entry->isLoaded() && mapped_data_.isMapped())
+		return std::make_unique<MemDataReader>(mapped_data_, entry->formatInfo().offset, entry->size());
+
+	if (auto reader = fileDataReader(entry, entry->formatInfo().offset))
+		return reader;
+
+	return Archive::entryDataReader(entry);
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -511,15 +543,15 @@ bool TarArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Unix tar archive
 // -----------------------------------------------------------------------------
-bool TarArchive::isTarArchive(MemChunk& mc)
+bool TarArchive::isTarArchive(const MemChunk& mc)
 {
-	mc.seek(0, SEEK_SET);
-	int blankcount = 0;
-	while ((mc.currentPos() + 512) <= mc.size() && blankcount < 3)
+	MemDataReader reader(mc);
+	int           blankcount = 0;
+	while ((reader.currentPos() + 512) <= mc.size() && blankcount < 3)
 	{
 		// Read tar header
 		TarHeader header;
-		mc.read(&header, 512);
+		reader.read(&header, 512);
 		if (!strutil::equalCI({header.magic, sizeof(header.magic)}, TMAGIC))
 		{
 			if (tarMakeChecksum(&header) == 0)
@@ -549,8 +581,9 @@ bool TarArchive::isTarArchive(MemChunk& mc)
 		size_t sum  = size % 512; // Do we need padding?
 		if (sum)
 			sum = 512 - sum;    // Compute it
-		sum += size;            // then add it
-		mc.seek(sum, SEEK_CUR); // and move on
+		sum += size;           // then add it
+		if (!reader.seek(sum)) // and move on
+			break;
 	}
 	// We should end with a blankcount of precisely 2
 	return (blankcount == 2);
@@ -16,9 +16,18 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool canMapFile() const override { return true; }
+
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
 
 	// Static functions
-	static bool isTarArchive(MemChunk& mc);
+	static bool isTarArchive(const MemChunk& mc);
 	static bool isTarArchive(const string& filename);
+
+private:
+	// View of the tar data if it was opened from a memory-mapped file (eg. the
+	// archive file itself or a spilled .tar.gz), entries are loaded from here
+	MemChunk mapped_data_;
 };
 } // namespace slade
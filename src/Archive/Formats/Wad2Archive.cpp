@@ -33,6 +33,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Wad2Archive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 
 using namespace slade;
@@ -118,7 +119,7 @@ bool Wad2Archive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(info.name, info.dsize);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)info.offset;
+		nlump->formatInfo().offset = (int)info.offset;
 		nlump->exProp("W2Type") = info.type;
 		nlump->exProp("W2Size") = (int)info.size;
 		nlump->exProp("W2Comp") = !!(info.cmprs);
@@ -143,7 +144,7 @@ bool Wad2Archive::open(MemChunk& mc)
 		if (entry->size() > 0)
 		{
 			// Read the entry data
-			mc.exportMemChunk(edata, entry->exProp<int>("Offset"), entry->size());
+			mc.exportMemChunk(edata, entry->formatInfo().offset, entry->size());
 			entry->importMemChunk(edata);
 		}
 
@@ -183,7 +184,7 @@ bool Wad2Archive::write(MemChunk& mc, bool update)
 	for (uint32_t l = 0; l < numEntries(); l++)
 	{
 		entry                   = entryAt(l);
-		entry->exProp("Offset") = (int)dir_offset;
+		entry->formatInfo().offset = (int)dir_offset;
 		dir_offset += entry->size();
 	}
 
@@ -222,7 +223,7 @@ bool Wad2Archive::write(MemChunk& mc, bool update)
 		info.cmprs  = entry->exProp<bool>("W2Comp");
 		info.dsize  = entry->size();
 		info.size   = entry->size();
-		info.offset = entry->exProp<int>("Offset");
+		info.offset = entry->formatInfo().offset;
 		info.type   = entry->exProp<int>("W2Type");
 
 		// Write it
@@ -264,7 +265,7 @@ bool Wad2Archive::loadEntryData(ArchiveEntry* entry)
 	}
 
 	// Seek to lump offset in file and read it in
-	file.Seek(entry->exProp<int>("Offset"), wxFromStart);
+	file.Seek(entry->formatInfo().offset, wxFromStart);
 	entry->importFileStream(file, entry->size());
 
 	// Set the lump to loaded
@@ -284,7 +285,7 @@ bool Wad2Archive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Quake wad2 archive
 // -----------------------------------------------------------------------------
-bool Wad2Archive::isWad2Archive(MemChunk& mc)
+bool Wad2Archive::isWad2Archive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -297,12 +298,10 @@ bool Wad2Archive::isWad2Archive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	int32_t num_lumps  = 0;
 	int32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	MemDataReader reader(mc);
+	reader.seekFromStart(4);
+	reader.read(&num_lumps, 4);
+	reader.read(&dir_offset, 4);
 
 	// Byteswap values for big endian if needed
 	num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
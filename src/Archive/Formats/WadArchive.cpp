@@ -31,11 +31,15 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/Misc.h"
 #include "General/UI.h"
+#include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
 #include "WadJArchive.h"
+#include <filesystem>
+#include <unordered_map>
 
 using namespace slade;
 
@@ -46,6 +50,10 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Bool, iwad_lock, true, CVar::Flag::Save)
+CVAR(Bool, wad_keep_clone_lumps, false, CVar::Flag::Save)
+CVAR(Bool, wad_incremental_save, true, CVar::Flag::Save)
+CVAR(Int, wad_compact_threshold, 25, CVar::Flag::Save) // Max. % of the file that can be unused before compacting
+CVAR(Bool, wad_share_duplicate_lumps, false, CVar::Flag::Save) // Lumps with identical data share it when saving
 
 namespace
 {
@@ -146,7 +154,7 @@ uint32_t WadArchive::getEntryOffset(ArchiveEntry* entry)
 	if (!checkEntry(entry))
 		return 0;
 
-	return (uint32_t)entry->exProp<int>("Offset");
+	return (uint32_t)entry->formatInfo().offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -158,7 +166,7 @@ void WadArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset)
 	if (!checkEntry(entry))
 		return;
 
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -301,6 +309,19 @@ void WadArchive::updateNamespaces()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Updates the start and end indices of all namespaces from their marker
+// entries, after non-marker entries have been added, removed or moved
+// -----------------------------------------------------------------------------
+void WadArchive::updateNamespaceIndices()
+{
+	for (auto& ns : namespaces_)
+	{
+		ns.start_index = entryIndex(ns.start);
+		ns.end_index   = entryIndex(ns.end);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Detects if the flat hack is used in this archive or not
 // -----------------------------------------------------------------------------
@@ -351,7 +372,13 @@ bool WadArchive::open(MemChunk& mc)
 	// Stop announcements (don't want to be announcing modification due to entries being added etc)
 	ArchiveModSignalBlocker sig_blocker{ *this };
 
-	vector<uint32_t> offsets;
+	// Keep track of the wad file's modified time (for incremental saving)
+	file_modified_ = fileutil::fileExists(filename_) ? fileutil::fileModifiedTime(filename_) : 0;
+
+	// Directory index and size of the first lump at each data offset, for
+	// clone detection
+	std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> lump_offsets;
+	lump_offsets.reserve(num_lumps);
 
 	// Read the directory
 	mc.seek(dir_offset, SEEK_SET);
@@ -376,6 +403,7 @@ bool WadArchive::open(MemChunk& mc)
 		size   = wxINT32_SWAP_ON_BE(size);
 
 		// Check to catch stupid shit
+		int clone_of = -1;
 		if (size > 0)
 		{
 			if (offset == 0)
@@ -383,12 +411,22 @@ bool WadArchive::open(MemChunk& mc)
 				log::info(2, "No.");
 				continue;
 			}
-			if (VECTOR_EXISTS(offsets, offset))
+
+			auto existing = lump_offsets.emplace(offset, std::make_pair(d, size));
+			if (!existing.second)
 			{
-				log::warning("Ignoring entry {}: {}, is a clone of a previous entry", d, name);
-				continue;
+				// Lump shares its data with a previous one, either keep it as a
+				// separate entry (marked as a clone) or ignore it. Exact
+				// duplicates (same size) are always kept, they are valid lumps
+				// that just had their data shared when the wad was saved
+				clone_of       = existing.first->second.first;
+				bool duplicate = existing.first->second.second == size;
+				if (!wad_keep_clone_lumps && !duplicate)
+				{
+					log::warning("Ignoring entry {}: {}, is a clone of a previous entry", d, name);
+					continue;
+				}
 			}
-			offsets.push_back(offset);
 		}
 
 		// Hack to open Operation: Rheingold WAD files
@@ -446,13 +484,16 @@ bool WadArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
+		if (clone_of >= 0)
+			nlump->exProp("CloneOf") = clone_of;
+
 		if (jaguarencrypt)
 		{
 			nlump->setEncryption(ArchiveEntry::Encryption::Jaguar);
-			nlump->exProp("FullSize") = (int)size;
+			nlump->formatInfo().full_size = (int)size;
 		}
 
 		// Add to entry list
@@ -464,7 +505,8 @@ bool WadArchive::open(MemChunk& mc)
 	updateNamespaces();
 
 	// Detect all entry types
-	MemChunk edata;
+	MemChunk              edata;
+	vector<ArchiveEntry*> detect_batch;
 	ui::setSplashProgressMessage("Detecting entry types");
 	for (size_t a = 0; a < numEntries(); a++)
 	{
@@ -477,32 +519,32 @@ bool WadArchive::open(MemChunk& mc)
 		// Read entry data if it isn't zero-sized
 		if (entry->size() > 0)
 		{
-			// Read the entry data
-			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
 			if (entry->encryption() != ArchiveEntry::Encryption::None)
 			{
-				if (entry->exProps().contains("FullSize")
-					&& static_cast<unsigned>(entry->exProp<int>("FullSize")) > entry->size())
-					edata.reSize((entry->exProp<int>("FullSize")), true);
+				// Read and decode the entry data
+				mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
+				if (entry->formatInfo().full_size >= 0
+					&& static_cast<unsigned>(entry->formatInfo().full_size) > entry->size())
+					edata.reSize((entry->formatInfo().full_size), true);
 				if (!WadJArchive::jaguarDecode(edata))
 					log::warning(
 						"{}: {} (following {}), did not decode properly",
 						a,
 						entry->name(),
 						a > 0 ? entryAt(a - 1)->name() : "nothing");
+				entry->importMemChunk(edata);
+			}
+			else
+			{
+				// Read the entry data (will reference the data directly if mc is memory-mapped)
+				entry->importMemChunk(mc, getEntryOffset(entry), entry->size());
 			}
-			entry->importMemChunk(edata);
 		}
 
-		// Detect entry type
-		EntryType::detectEntryType(*entry);
-
-		// Unload entry data if needed
-		if (!archive_load_data)
-			entry->unloadData();
-
-		// Set entry to unchanged
-		entry->setState(ArchiveEntry::State::Unmodified);
+		// Detect entry types in batches
+		detect_batch.push_back(entry);
+		if (detect_batch.size() >= DETECT_BATCH_SIZE || a == numEntries() - 1)
+			detectEntryTypes(detect_batch);
 	}
 
 	// Identify #included lumps (DECORATE, GLDEFS, etc.)
@@ -535,14 +577,13 @@ bool WadArchive::write(MemChunk& mc, bool update)
 	}
 
 	// Determine directory offset & individual lump offsets
-	uint32_t      dir_offset = 12;
+	vector<bool>  write_data;
+	uint32_t      dir_offset = setLumpOffsets(write_data);
 	ArchiveEntry* entry;
-	for (uint32_t l = 0; l < numEntries(); l++)
-	{
-		entry = entryAt(l);
-		setEntryOffset(entry, dir_offset);
-		dir_offset += entry->size();
-	}
+
+	// Entry offsets will no longer match the wad file (if any)
+	if (update)
+		file_modified_ = 0;
 
 	// Clear/init MemChunk
 	mc.clear();
@@ -568,7 +609,8 @@ bool WadArchive::write(MemChunk& mc, bool update)
 	for (uint32_t l = 0; l < num_lumps; l++)
 	{
 		entry = entryAt(l);
-		mc.write(entry->rawData(), entry->size());
+		if (write_data[l])
+			mc.write(entry->rawData(), entry->size());
 	}
 
 	// Write the directory
@@ -589,7 +631,7 @@ bool WadArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			entry->formatInfo().offset = (int)offset;
 		}
 	}
 
@@ -609,6 +651,33 @@ bool WadArchive::write(string_view filename, bool update)
 		return false;
 	}
 
+	// Only write what has changed if overwriting the wad file
+	if (update && writeIncremental(filename))
+		return true;
+
+	// Otherwise if overwriting the wad file, write to a temporary file and
+	// replace the original with it, so a failed write never leaves the original
+	// truncated or partially overwritten
+	if (update && filename == filename_ && fileutil::fileExists(filename))
+	{
+		auto temp_file = fmt::format("{}.slade-tmp", filename);
+		if (!write(temp_file, true))
+		{
+			wxRemoveFile(temp_file);
+			return false;
+		}
+		if (!wxRenameFile(temp_file, wxString{ filename.data(), filename.size() }, true))
+		{
+			wxRemoveFile(temp_file);
+			file_modified_ = 0;
+			global::error  = "Unable to replace the wad file";
+			return false;
+		}
+
+		file_modified_ = fileutil::fileModifiedTime(filename);
+		return true;
+	}
+
 	// Open file for writing
 	wxFile file;
 	file.Open(wxString{ filename.data(), filename.size() }, wxFile::write);
@@ -619,14 +688,13 @@ bool WadArchive::write(string_view filename, bool update)
 	}
 
 	// Determine directory offset & individual lump offsets
-	uint32_t      dir_offset = 12;
+	vector<bool>  write_data;
+	uint32_t      dir_offset = setLumpOffsets(write_data);
 	ArchiveEntry* entry;
-	for (uint32_t l = 0; l < numEntries(); l++)
-	{
-		entry = entryAt(l);
-		setEntryOffset(entry, dir_offset);
-		dir_offset += entry->size();
-	}
+
+	// Entry offsets will no longer match the wad file until it is written
+	if (update)
+		file_modified_ = 0;
 
 	// Setup wad type
 	char wad_type[4] = { 'P', 'W', 'A', 'D' };
@@ -635,22 +703,22 @@ bool WadArchive::write(string_view filename, bool update)
 
 	// Write the header
 	uint32_t num_lumps = numEntries();
-	file.Write(wad_type, 4);
-	file.Write(&num_lumps, 4);
-	file.Write(&dir_offset, 4);
+	bool     ok        = file.Write(wad_type, 4) == 4;
+	ok                 = ok && file.Write(&num_lumps, 4) == 4;
+	ok                 = ok && file.Write(&dir_offset, 4) == 4;
 
 	// Write the lumps
-	for (uint32_t l = 0; l < num_lumps; l++)
+	for (uint32_t l = 0; l < num_lumps && ok; l++)
 	{
 		entry = entryAt(l);
-		if (entry->size())
+		if (entry->size() && write_data[l])
 		{
-			file.Write(entry->rawData(), entry->size());
+			ok = file.Write(entry->rawData(), entry->size()) == entry->size();
 		}
 	}
 
 	// Write the directory
-	for (uint32_t l = 0; l < num_lumps; l++)
+	for (uint32_t l = 0; l < num_lumps && ok; l++)
 	{
 		entry        = entryAt(l);
 		char name[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -660,22 +728,222 @@ bool WadArchive::write(string_view filename, bool update)
 		for (size_t c = 0; c < entry->name().length() && c < 8; c++)
 			name[c] = entry->name()[c];
 
-		file.Write(&offset, 4);
-		file.Write(&size, 4);
-		file.Write(name, 8);
+		ok = file.Write(&offset, 4) == 4 && file.Write(&size, 4) == 4 && file.Write(name, 8) == 8;
+	}
 
-		if (update)
+	ok = file.Close() && ok;
+	if (!ok)
+	{
+		global::error = "Unable to write wad file";
+		return false;
+	}
+
+	if (update)
+	{
+		for (uint32_t l = 0; l < num_lumps; l++)
+			entryAt(l)->setState(ArchiveEntry::State::Unmodified);
+
+		file_modified_ = fileutil::fileModifiedTime(filename);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the wad archive to its existing file at [filename], keeping
+// unmodified lumps in place. Modified lumps are written after the last
+// unmodified lump's data, followed by the directory, and the header is updated.
+// Returns false if the wad can't be written incrementally, ie. [filename] isn't
+// the (unchanged) file the wad was opened from, the amount of unused space
+// left in the file would exceed wad_compact_threshold, or writing to the file
+// failed (the header is only updated once everything else is written). In this
+// case the whole wad should be written instead
+// -----------------------------------------------------------------------------
+bool WadArchive::writeIncremental(string_view filename)
+{
+	// Check the wad file is on disk and hasn't been changed externally
+	if (!wad_incremental_save || format_ != "wad" || file_mapping_ || filename != filename_ || file_modified_ == 0
+		|| !fileutil::fileExists(filename) || fileutil::fileModifiedTime(filename) != file_modified_)
+		return false;
+
+	// Determine which lumps can be kept where they are
+	uint32_t                              kept_end = 12; // End of the kept lump data in the file
+	vector<std::pair<uint32_t, uint32_t>> kept;          // Offset+size of kept lumps
+	vector<uint32_t>                      relocate;      // Indices of lumps to write
+	vector<uint32_t>                      offsets;       // New offset of each lump
+	ArchiveEntry*                         entry;
+	auto                                  num_lumps = static_cast<uint32_t>(numEntries());
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		entry = entryAt(l);
+		offsets.push_back(getEntryOffset(entry));
+		if (entry->size() == 0)
+			continue;
+
+		if (entry->state() == ArchiveEntry::State::Unmodified && entry->encryption() == ArchiveEntry::Encryption::None
+			&& offsets[l] >= 12)
 		{
-			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)offset;
+			kept.emplace_back(offsets[l], entry->size());
+			kept_end = std::max(kept_end, offsets[l] + entry->size());
+		}
+		else
+			relocate.push_back(l);
+	}
+
+	// Check how much of the file would be unused
+	uint64_t new_size = kept_end + static_cast<uint64_t>(num_lumps) * 16;
+	for (auto l : relocate)
+		new_size += entryAt(l)->size();
+	uint64_t used = 12;
+	uint32_t pos  = 12;
+	std::sort(kept.begin(), kept.end());
+	for (const auto& lump : kept)
+	{
+		auto start = std::max(pos, lump.first);
+		auto end   = lump.first + lump.second;
+		if (end > start)
+		{
+			used += end - start;
+			pos = end;
 		}
 	}
+	if ((kept_end - used) * 100 > new_size * wad_compact_threshold)
+	{
+		log::info(2, "Wad file has too much unused space, writing in full");
+		return false;
+	}
+	if (new_size > 0xFFFFFFFF)
+		return false;
+
+	// Make sure the data for lumps being written is loaded, since the space
+	// they are written to may currently hold their old data
+	for (auto l : relocate)
+		entryAt(l)->rawData();
+
+	// Open file for writing (without truncating)
+	wxFile file;
+	file.Open(wxString{ filename.data(), filename.size() }, wxFile::read_write);
+	if (!file.IsOpened())
+		return false;
+
+	// Write modified lumps after the kept lump data
+	uint32_t dir_offset = kept_end;
+	bool     ok         = file.Seek(dir_offset) != wxInvalidOffset;
+	for (auto l : relocate)
+	{
+		if (!ok)
+			break;
+
+		entry      = entryAt(l);
+		offsets[l] = dir_offset;
+		ok         = file.Write(entry->rawData(), entry->size()) == entry->size();
+		dir_offset += entry->size();
+	}
+
+	// Write the directory
+	MemChunk dir(num_lumps * 16);
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		entry        = entryAt(l);
+		char name[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		auto size    = entry->size();
+
+		// Zero-sized lumps keep their offset if it's still within the file
+		if (size == 0 && offsets[l] > dir_offset)
+			offsets[l] = dir_offset;
+
+		for (size_t c = 0; c < entry->name().length() && c < 8; c++)
+			name[c] = entry->name()[c];
+
+		dir.write(&offsets[l], 4);
+		dir.write(&size, 4);
+		dir.write(name, 8);
+	}
+	ok = ok && file.Write(dir.data(), dir.size()) == dir.size();
 
-	file.Close();
+	// Setup wad type
+	char wad_type[4] = { 'P', 'W', 'A', 'D' };
+	if (iwad_)
+		wad_type[0] = 'I';
+
+	// Write the header, only once everything it points to has been written
+	ok = ok && file.Seek(0) != wxInvalidOffset;
+	ok = ok && file.Write(wad_type, 4) == 4;
+	ok = ok && file.Write(&num_lumps, 4) == 4;
+	ok = ok && file.Write(&dir_offset, 4) == 4;
+	ok = file.Close() && ok;
+
+	// If anything failed the file may be partially overwritten, so the whole
+	// wad needs to be written instead
+	if (!ok)
+	{
+		log::warning("Unable to write modified lumps to {}, writing in full", filename);
+		file_modified_ = 0;
+		return false;
+	}
+
+	// Remove anything left past the end of the new directory
+	std::error_code ec;
+	std::filesystem::resize_file(string{ filename }, new_size, ec);
+	if (ec)
+		log::warning("Unable to truncate wad file {}: {}", filename, ec.message());
+
+	// Update lump offsets and states now they match the file
+	for (uint32_t l = 0; l < num_lumps; l++)
+	{
+		entry = entryAt(l);
+		setEntryOffset(entry, offsets[l]);
+		entry->setState(ArchiveEntry::State::Unmodified);
+	}
+
+	file_modified_ = fileutil::fileModifiedTime(filename);
+	log::info(2, "Wrote {} modified lumps to {}", relocate.size(), filename);
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Sets the offsets of all lumps for writing the whole wad, and returns the
+// offset of the directory after them. If wad_share_duplicate_lumps is enabled,
+// lumps with the same data as a previous lump share its offset rather than
+// having their own copy - [write_data] is set to false for those
+// -----------------------------------------------------------------------------
+uint32_t WadArchive::setLumpOffsets(vector<bool>& write_data)
+{
+	// Lumps with data written so far, by size and content hash
+	std::unordered_map<uint64_t, vector<ArchiveEntry*>> written;
+
+	uint32_t dir_offset = 12;
+	write_data.assign(numEntries(), true);
+	for (uint32_t l = 0; l < numEntries(); l++)
+	{
+		auto entry = entryAt(l);
+		if (wad_share_duplicate_lumps && entry->size() > 0)
+		{
+			// Look for a previous lump with the same data (comparing it, in case
+			// the hashes collide)
+			auto  data = entry->rawData();
+			auto& same = written[(static_cast<uint64_t>(entry->size()) << 32) | entry->contentHash()];
+			auto  dup  = std::find_if(same.begin(), same.end(), [&](ArchiveEntry* other) {
+				return memcmp(other->rawData(), data, entry->size()) == 0;
+			});
+			if (dup != same.end())
+			{
+				setEntryOffset(entry, getEntryOffset(*dup));
+				write_data[l] = false;
+				continue;
+			}
+
+			same.push_back(entry);
+		}
+
+		setEntryOffset(entry, dir_offset);
+		dir_offset += entry->size();
+	}
+
+	return dir_offset;
+}
+
 // -----------------------------------------------------------------------------
 // Loads an entry's data from the wadfile
 // Returns true if successful, false otherwise
@@ -694,6 +962,13 @@ bool WadArchive::loadEntryData(ArchiveEntry* entry)
 		return true;
 	}
 
+	// Reference the data directly if the wadfile is memory-mapped
+	if (loadMappedEntryData(entry, getEntryOffset(entry), entry->size()))
+	{
+		entry->setState(ArchiveEntry::State::Unmodified);
+		return true;
+	}
+
 	// Open wadfile
 	wxFile file(filename_);
 
@@ -715,6 +990,19 @@ bool WadArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data, read directly from the wadfile if the
+// entry isn't loaded
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> WadArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (entry->encryption() == ArchiveEntry::Encryption::None)
+		if (auto reader = fileDataReader(entry, getEntryOffset(entry)))
+			return reader;
+
+	return Archive::entryDataReader(entry);
+}
+
 // -----------------------------------------------------------------------------
 // Override of Archive::addEntry to force entry addition to the root directory,
 // update namespaces if needed and rename the entry if necessary to be
@@ -736,6 +1024,8 @@ shared_ptr<ArchiveEntry> WadArchive::addEntry(shared_ptr<ArchiveEntry> entry, un
 	// Update namespaces if necessary
 	if (isNamespaceEntry(entry.get()))
 		updateNamespaces();
+	else
+		updateNamespaceIndices();
 
 	return entry;
 }
@@ -790,6 +1080,8 @@ bool WadArchive::removeEntry(ArchiveEntry* entry)
 		// Update namespaces if necessary
 		if (ns_entry)
 			updateNamespaces();
+		else
+			updateNamespaceIndices();
 
 		return true;
 	}
@@ -860,6 +1152,8 @@ bool WadArchive::moveEntry(ArchiveEntry* entry, unsigned position, ArchiveDir* d
 		// Update namespaces if necessary
 		if (isNamespaceEntry(entry))
 			updateNamespaces();
+		else
+			updateNamespaceIndices();
 
 		return true;
 	}
@@ -1287,33 +1581,49 @@ ArchiveEntry* WadArchive::findFirst(SearchOptions& options)
 			return nullptr;
 	}
 
-	// Begin search
-	ArchiveEntry* entry;
-	for (; index < index_end; ++index)
-	{
-		entry = entryAt(index);
-
+	// Checks [entry] against the type and name criteria
+	auto matches = [&options](ArchiveEntry* entry) {
 		// Check type
 		if (options.match_type)
 		{
 			if (entry->type() == EntryType::unknownType())
 			{
 				if (!options.match_type->isThisType(*entry))
-					continue;
+					return false;
 			}
 			else if (options.match_type != entry->type())
-				continue;
+				return false;
 		}
 
 		// Check name
 		if (!options.match_name.empty())
 		{
 			if (!strutil::matches(options.match_name, entry->upperName()))
-				continue;
+				return false;
+		}
+
+		return true;
+	};
+
+	// Only check entries that could be of the requested type if given
+	if (options.match_type)
+	{
+		for (auto entry : typeSearchCandidates(options.match_type))
+		{
+			auto entry_index = static_cast<unsigned>(entry->index());
+			if (entry_index >= index && entry_index < index_end && matches(entry))
+				return entry;
 		}
 
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		return nullptr;
+	}
+
+	// Begin search
+	for (; index < index_end; ++index)
+	{
+		auto entry = entryAt(index);
+		if (matches(entry))
+			return entry;
 	}
 
 	// No match found
@@ -1360,33 +1670,50 @@ ArchiveEntry* WadArchive::findLast(SearchOptions& options)
 			return nullptr;
 	}
 
-	// Begin search
-	ArchiveEntry* entry;
-	for (; index >= index_start; --index)
-	{
-		entry = entryAt(index);
-
+	// Checks [entry] against the type and name criteria
+	auto matches = [&options](ArchiveEntry* entry) {
 		// Check type
 		if (options.match_type)
 		{
 			if (entry->type() == EntryType::unknownType())
 			{
 				if (!options.match_type->isThisType(*entry))
-					continue;
+					return false;
 			}
 			else if (options.match_type != entry->type())
-				continue;
+				return false;
 		}
 
 		// Check name
 		if (!options.match_name.empty())
 		{
 			if (!strutil::matches(entry->upperName(), options.match_name))
-				continue;
+				return false;
+		}
+
+		return true;
+	};
+
+	// Only check entries that could be of the requested type if given
+	if (options.match_type)
+	{
+		auto candidates = typeSearchCandidates(options.match_type);
+		for (auto i = candidates.rbegin(); i != candidates.rend(); ++i)
+		{
+			auto entry_index = (*i)->index();
+			if (entry_index >= index_start && entry_index <= index && matches(*i))
+				return *i;
 		}
 
-		// Entry passed all checks so far, so we found a match
-		return entry;
+		return nullptr;
+	}
+
+	// Begin search
+	for (; index >= index_start; --index)
+	{
+		auto entry = entryAt(index);
+		if (matches(entry))
+			return entry;
 	}
 
 	// No match found
@@ -1430,32 +1757,49 @@ vector<ArchiveEntry*> WadArchive::findAll(SearchOptions& options)
 			return ret;
 	}
 
-	ArchiveEntry* entry;
-	for (; index < index_end; ++index)
-	{
-		entry = entryAt(index);
-
+	// Checks [entry] against the type and name criteria
+	auto matches = [&options](ArchiveEntry* entry) {
 		// Check type
 		if (options.match_type)
 		{
 			if (entry->type() == EntryType::unknownType())
 			{
 				if (!options.match_type->isThisType(*entry))
-					continue;
+					return false;
 			}
 			else if (options.match_type != entry->type())
-				continue;
+				return false;
 		}
 
 		// Check name
 		if (!options.match_name.empty())
 		{
 			if (!strutil::matches(entry->upperName(), options.match_name))
-				continue;
+				return false;
 		}
 
-		// Entry passed all checks so far, so we found a match
-		ret.push_back(entry);
+		return true;
+	};
+
+	// Only check entries that could be of the requested type if given
+	if (options.match_type)
+	{
+		for (auto entry : typeSearchCandidates(options.match_type))
+		{
+			auto entry_index = static_cast<unsigned>(entry->index());
+			if (entry_index >= index && entry_index < index_end && matches(entry))
+				ret.push_back(entry);
+		}
+
+		return ret;
+	}
+
+	// Begin search
+	for (; index < index_end; ++index)
+	{
+		auto entry = entryAt(index);
+		if (matches(entry))
+			ret.push_back(entry);
 	}
 
 	// Return search result
@@ -1473,7 +1817,7 @@ vector<ArchiveEntry*> WadArchive::findAll(SearchOptions& options)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Doom wad archive
 // -----------------------------------------------------------------------------
-bool WadArchive::isWadArchive(MemChunk& mc)
+bool WadArchive::isWadArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -1486,12 +1830,10 @@ bool WadArchive::isWadArchive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	uint32_t num_lumps  = 0;
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	MemDataReader reader(mc);
+	reader.seekFromStart(4);
+	reader.read(&num_lumps, 4);
+	reader.read(&dir_offset, 4);
 
 	// Byteswap values for big endian if needed
 	num_lumps  = wxINT32_SWAP_ON_BE(num_lumps);
@@ -26,6 +26,10 @@ public:
 
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
+	bool canMapFile() const override { return true; }
+
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
 
 	// Entry addition/removal
 	shared_ptr<ArchiveEntry> addEntry(
@@ -56,7 +60,7 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isWadArchive(MemChunk& mc);
+	static bool isWadArchive(const MemChunk& mc);
 	static bool isWadArchive(const string& filename);
 
 	static bool exportEntriesAsWad(string_view filename, vector<ArchiveEntry*> entries)
@@ -88,7 +92,12 @@ private:
 		NSPair(ArchiveEntry* start, ArchiveEntry* end) : start{ start }, start_index{ 0 }, end{ end }, end_index{ 0 } {}
 	};
 
-	bool           iwad_ = false;
+	bool           iwad_          = false;
 	vector<NSPair> namespaces_;
+	time_t         file_modified_ = 0; // Modified time of the wad file when it was last opened/written
+
+	void     updateNamespaceIndices();
+	bool     writeIncremental(string_view filename);
+	uint32_t setLumpOffsets(vector<bool>& write_data);
 };
 } // namespace slade
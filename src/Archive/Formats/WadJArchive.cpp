@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WadJArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "Utility/StringUtils.h"
 
@@ -164,13 +165,13 @@ bool WadJArchive::open(MemChunk& mc)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, actualsize);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		if (jaguarencrypt)
 		{
 			nlump->setEncryption(ArchiveEntry::Encryption::Jaguar);
-			nlump->exProp("FullSize") = (int)size;
+			nlump->formatInfo().full_size = (int)size;
 		}
 
 		// Add to entry list
@@ -200,9 +201,9 @@ bool WadJArchive::open(MemChunk& mc)
 			mc.exportMemChunk(edata, getEntryOffset(entry), entry->size());
 			if (entry->encryption() != ArchiveEntry::Encryption::None)
 			{
-				if (entry->exProps().contains("FullSize")
-					&& (unsigned)(entry->exProp<int>("FullSize")) > entry->size())
-					edata.reSize((entry->exProp<int>("FullSize")), true);
+				if (entry->formatInfo().full_size >= 0
+					&& (unsigned)(entry->formatInfo().full_size) > entry->size())
+					edata.reSize((entry->formatInfo().full_size), true);
 				if (!jaguarDecode(edata))
 					log::warning(
 						"{}: {} (following {}), did not decode properly",
@@ -299,7 +300,7 @@ bool WadJArchive::write(MemChunk& mc, bool update)
 		if (update)
 		{
 			entry->setState(ArchiveEntry::State::Unmodified);
-			entry->exProp("Offset") = (int)wxINT32_SWAP_ON_LE(offset);
+			entry->formatInfo().offset = (int)wxINT32_SWAP_ON_LE(offset);
 		}
 	}
 
@@ -328,7 +329,7 @@ string WadJArchive::detectNamespace(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Jaguar Doom wad archive
 // -----------------------------------------------------------------------------
-bool WadJArchive::isWadJArchive(MemChunk& mc)
+bool WadJArchive::isWadJArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < 12)
@@ -341,12 +342,10 @@ bool WadJArchive::isWadJArchive(MemChunk& mc)
 	// Get number of lumps and directory offset
 	uint32_t num_lumps  = 0;
 	uint32_t dir_offset = 0;
-	mc.seek(4, SEEK_SET);
-	mc.read(&num_lumps, 4);
-	mc.read(&dir_offset, 4);
-
-	// Reset MemChunk (just in case)
-	mc.seek(0, SEEK_SET);
+	MemDataReader reader(mc);
+	reader.seekFromStart(4);
+	reader.read(&num_lumps, 4);
+	reader.read(&dir_offset, 4);
 
 	// Byteswap values for little endian
 	num_lumps  = wxINT32_SWAP_ON_LE(num_lumps);
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "WolfArchive.h"
+#include "Archive/EntryDataReader.h"
 #include "General/UI.h"
 #include "UI/WxUtils.h"
 #include "Utility/FileUtils.h"
@@ -366,7 +367,7 @@ void expandWolfGraphLump(ArchiveEntry* entry, size_t lumpnum, size_t numlumps, H
 // -----------------------------------------------------------------------------
 uint32_t WolfArchive::getEntryOffset(ArchiveEntry* entry) const
 {
-	return uint32_t(entry->exProp<int>("Offset"));
+	return uint32_t(entry->formatInfo().offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -374,7 +375,7 @@ uint32_t WolfArchive::getEntryOffset(ArchiveEntry* entry) const
 // -----------------------------------------------------------------------------
 void WolfArchive::setEntryOffset(ArchiveEntry* entry, uint32_t offset) const
 {
-	entry->exProp("Offset") = (int)offset;
+	entry->formatInfo().offset = (int)offset;
 }
 
 // -----------------------------------------------------------------------------
@@ -545,7 +546,7 @@ bool WolfArchive::open(MemChunk& mc)
 			// Create & setup lump
 			auto nlump = std::make_shared<ArchiveEntry>(name, size);
 			nlump->setLoaded(false);
-			nlump->exProp("Offset") = (int)pages[d].offset;
+			nlump->formatInfo().offset = (int)pages[d].offset;
 			nlump->setState(ArchiveEntry::State::Unmodified);
 
 			d = e;
@@ -724,7 +725,7 @@ bool WolfArchive::openAudio(MemChunk& head, MemChunk& data)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 
 		// Detect entry type
 		if (size > 0)
@@ -796,7 +797,7 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -816,7 +817,7 @@ bool WolfArchive::openMaps(MemChunk& head, MemChunk& data)
 			name        = fmt::format("PLANE{}", i);
 			auto nlump2 = std::make_shared<ArchiveEntry>(name, planelen[i]);
 			nlump2->setLoaded(false);
-			nlump2->exProp("Offset") = (int)planeofs[i];
+			nlump2->formatInfo().offset = (int)planeofs[i];
 			nlump2->setState(ArchiveEntry::State::Unmodified);
 			rootDir()->addEntry(nlump2);
 		}
@@ -937,7 +938,7 @@ bool WolfArchive::openGraph(MemChunk& head, MemChunk& data, MemChunk& dict)
 		// Create & setup lump
 		auto nlump = std::make_shared<ArchiveEntry>(name, size);
 		nlump->setLoaded(false);
-		nlump->exProp("Offset") = (int)offset;
+		nlump->formatInfo().offset = (int)offset;
 		nlump->setState(ArchiveEntry::State::Unmodified);
 
 		// Add to entry list
@@ -1077,18 +1078,18 @@ bool WolfArchive::loadEntryData(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid Wolfenstein VSWAP archive
 // -----------------------------------------------------------------------------
-bool WolfArchive::isWolfArchive(MemChunk& mc)
+bool WolfArchive::isWolfArchive(const MemChunk& mc)
 {
 	// Read Wolf header
-	mc.seek(0, SEEK_SET);
 	uint16_t num_lumps, sprites, sounds;
-	mc.read(&num_lumps, 2); // Size
+	MemDataReader reader(mc);
+	reader.read(&num_lumps, 2); // Size
 	num_lumps = wxINT16_SWAP_ON_BE(num_lumps);
 	if (num_lumps == 0)
 		return false;
 
-	mc.read(&sprites, 2); // Sprites start
-	mc.read(&sounds, 2);  // Sounds start
+	reader.read(&sprites, 2); // Sprites start
+	reader.read(&sounds, 2);  // Sounds start
 	sprites = wxINT16_SWAP_ON_BE(sprites);
 	sounds  = wxINT16_SWAP_ON_BE(sounds);
 	if (sprites > sounds)
@@ -1107,7 +1108,7 @@ bool WolfArchive::isWolfArchive(MemChunk& mc)
 	uint32_t           lastoffset = 0;
 	for (size_t a = 0; a < num_lumps; ++a)
 	{
-		mc.read(&offset, 4);
+		reader.read(&offset, 4);
 		offset = wxINT32_SWAP_ON_BE(offset);
 		if (offset < lastoffset || offset % 512)
 			return false;
@@ -1117,7 +1118,7 @@ bool WolfArchive::isWolfArchive(MemChunk& mc)
 	uint16_t lastsize = 0;
 	for (size_t b = 0; b < num_lumps; ++b)
 	{
-		mc.read(&size, 2);
+		reader.read(&size, 2);
 		size = wxINT16_SWAP_ON_BE(size);
 		pagesize += (size / 512) + ((size % 512) ? 1 : 0);
 		pages[b].size = size;
@@ -32,17 +32,45 @@
 #include "Main.h"
 #include "ZipArchive.h"
 #include "App.h"
+#include "Archive/EntryDataReader.h"
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "UI/WxUtils.h"
+#include "Utility/Compression.h"
 #include "Utility/FileUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "WadArchive.h"
 #include <fstream>
+#include <mutex>
+#include <wx/mstream.h>
+#include <wx/zstream.h>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, zip_compression_level, 9, CVar::Flag::Save) // 0-9, for new/modified entries when saving
+CVAR(Bool, zip_partial_detect, false, CVar::Flag::Save)
+CVAR(Int, zip_partial_detect_size, 262144, CVar::Flag::Save) // Entries larger than this are only partially inflated
+namespace
+{
+// Entries this size or larger are left unloaded when opening
+constexpr unsigned MAX_LOAD_SIZE = 250 * 1024 * 1024;
+
+// Entries this size or larger are compressed in parallel blocks when saving
+constexpr unsigned ZIP_PARALLEL_DEFLATE_SIZE = 1024 * 1024;
+
+// Zips can be opened concurrently, so temp file names are picked (and the
+// file created) one at a time to keep them unique
+std::mutex temp_file_mutex;
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // External Variables
@@ -73,6 +101,250 @@ struct ZipFileHeader
 	uint16_t len_fn;
 	uint16_t len_extra;
 };
+
+// Zip record signatures/sizes
+constexpr uint32_t ZIP_SIG_LOCAL_HEADER = 0x04034b50;
+constexpr uint32_t ZIP_SIG_CENTRAL_DIR  = 0x02014b50;
+constexpr uint32_t ZIP_SIG_END_OF_DIR   = 0x06054b50;
+constexpr unsigned ZIP_SIZE_LOCAL_HEADER = 30;
+constexpr unsigned ZIP_SIZE_CENTRAL_DIR  = 46;
+constexpr unsigned ZIP_SIZE_END_OF_DIR   = 22;
+
+// Compression methods not handled by wxZipInputStream
+constexpr uint16_t ZIP_METHOD_ZSTD = 93;
+
+// -----------------------------------------------------------------------------
+// Returns the 'version needed to extract' for entries compressed with [method]
+// -----------------------------------------------------------------------------
+uint16_t zipVersionNeeded(uint16_t method)
+{
+	return method == ZIP_METHOD_ZSTD ? 63 : 20;
+}
+
+// Info for an entry being written to a zip file
+struct ZipRecord
+{
+	string   name;
+	uint16_t flags        = 0;
+	uint16_t method       = wxZIP_METHOD_STORE;
+	uint16_t mod_time     = 0;
+	uint16_t mod_date     = 0;
+	uint32_t crc          = 0;
+	uint32_t size_comp    = 0;
+	uint32_t size_orig    = 0;
+	uint32_t local_offset = 0;
+	bool     dir          = false;
+};
+
+// -----------------------------------------------------------------------------
+// Writes [value] to [mc] as little-endian
+// -----------------------------------------------------------------------------
+void writeL16(MemChunk& mc, uint16_t value)
+{
+	value = wxUINT16_SWAP_ON_BE(value);
+	mc.write(&value, 2);
+}
+void writeL32(MemChunk& mc, uint32_t value)
+{
+	value = wxUINT32_SWAP_ON_BE(value);
+	mc.write(&value, 4);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the modified time/date of [record] to the current (local) time, in the
+// MS-DOS format used by zip files
+// -----------------------------------------------------------------------------
+void setRecordTimeNow(ZipRecord& record)
+{
+	auto now        = wxDateTime::Now();
+	record.mod_time = (now.GetHour() << 11) | (now.GetMinute() << 5) | (now.GetSecond() / 2);
+	record.mod_date = ((now.GetYear() - 1980) << 9) | ((now.GetMonth() + 1) << 5) | now.GetDay();
+}
+
+// -----------------------------------------------------------------------------
+// Writes a local file header for [record] to [mc]
+// -----------------------------------------------------------------------------
+void writeLocalHeader(MemChunk& mc, const ZipRecord& record)
+{
+	writeL32(mc, ZIP_SIG_LOCAL_HEADER);
+	writeL16(mc, zipVersionNeeded(record.method)); // Version needed to extract
+	writeL16(mc, record.flags);
+	writeL16(mc, record.method);
+	writeL16(mc, record.mod_time);
+	writeL16(mc, record.mod_date);
+	writeL32(mc, record.crc);
+	writeL32(mc, record.size_comp);
+	writeL32(mc, record.size_orig);
+	writeL16(mc, record.name.size());
+	writeL16(mc, 0); // Extra field length
+	mc.write(record.name.data(), record.name.size());
+}
+
+// -----------------------------------------------------------------------------
+// Writes a central directory record for [record] to [mc]
+// -----------------------------------------------------------------------------
+void writeCentralDirRecord(MemChunk& mc, const ZipRecord& record)
+{
+	writeL32(mc, ZIP_SIG_CENTRAL_DIR);
+	writeL16(mc, zipVersionNeeded(record.method)); // Version made by
+	writeL16(mc, zipVersionNeeded(record.method)); // Version needed to extract
+	writeL16(mc, record.flags);
+	writeL16(mc, record.method);
+	writeL16(mc, record.mod_time);
+	writeL16(mc, record.mod_date);
+	writeL32(mc, record.crc);
+	writeL32(mc, record.size_comp);
+	writeL32(mc, record.size_orig);
+	writeL16(mc, record.name.size());
+	writeL16(mc, 0);                     // Extra field length
+	writeL16(mc, 0);                     // Comment length
+	writeL16(mc, 0);                     // Disk number
+	writeL16(mc, 0);                     // Internal attributes
+	writeL32(mc, record.dir ? 0x10 : 0); // External attributes (MS-DOS directory flag)
+	writeL32(mc, record.local_offset);
+	mc.write(record.name.data(), record.name.size());
+}
+
+// Random-access reader for raw zip data, from [data] if it has any (for zips
+// opened from memory) or otherwise from the file at [filename]
+class ZipSource
+{
+public:
+	ZipSource(const MemChunk& data, string_view filename)
+	{
+		if (data.hasData())
+			data_ = &data;
+		else if (!filename.empty())
+			file_.Open(wxutil::strFromView(filename));
+	}
+
+	bool     isOk() const { return data_ || file_.IsOpened(); }
+	unsigned size() const { return data_ ? data_->size() : static_cast<unsigned>(file_.Length()); }
+
+	// Reads [size] bytes at [offset] into [out]. Memory-mapped data is
+	// referenced directly rather than copied
+	bool read(unsigned offset, unsigned size, MemChunk& out)
+	{
+		if (offset + size > this->size() || offset + size < offset)
+			return false;
+
+		if (size == 0)
+		{
+			out.clear();
+			return true;
+		}
+
+		if (data_)
+		{
+			if (data_->isMapped())
+				return out.importMapped(data_->mapping(), data_->mappedOffset() + offset, size);
+			return out.importMem(data_->data() + offset, size);
+		}
+
+		file_.Seek(offset, wxFromStart);
+		return out.importFileStreamWx(file_, size) && out.size() == size;
+	}
+
+private:
+	const MemChunk* data_ = nullptr;
+	wxFile          file_;
+};
+
+// Reads deflated zip entry data, inflating it as it's read. Reading from
+// before the current position restarts the inflation from the beginning
+class ZipInflateReader : public EntryDataReader
+{
+public:
+	ZipInflateReader(
+		const MemChunk& source_data,
+		const string&   filename,
+		unsigned        offset,
+		unsigned        size_comp,
+		unsigned        size_orig) :
+		EntryDataReader{ size_orig },
+		mapping_{ source_data.mapping() },
+		filename_{ filename },
+		offset_{ offset },
+		size_comp_{ size_comp }
+	{
+		if (source_data.hasData())
+			data_ = source_data.data() + offset;
+
+		restart();
+	}
+
+	bool isOk() const { return inflate_ != nullptr; }
+
+protected:
+	bool readAt(unsigned offset, void* buffer, unsigned count) override
+	{
+		if ((offset < inflated_ || !inflate_) && !restart())
+			return false;
+
+		// Skip to [offset]
+		uint8_t skip[4096];
+		while (inflated_ < offset)
+			if (!inflate(skip, std::min<unsigned>(sizeof(skip), offset - inflated_)))
+				return false;
+
+		return inflate(buffer, count);
+	}
+
+private:
+	const uint8_t*            data_ = nullptr;
+	shared_ptr<MappedFile>    mapping_;
+	string                    filename_;
+	unsigned                  offset_    = 0;
+	unsigned                  size_comp_ = 0;
+	unique_ptr<wxInputStream> in_;
+	unique_ptr<wxInputStream> inflate_;
+	unsigned                  inflated_ = 0;
+
+	// (Re)opens the compressed data and starts inflating it from the start
+	bool restart()
+	{
+		inflate_.reset();
+		inflated_ = 0;
+
+		if (data_)
+			in_ = std::make_unique<wxMemoryInputStream>(data_, size_comp_);
+		else
+		{
+			in_ = std::make_unique<wxFFileInputStream>(filename_);
+			if (!in_->IsOk() || in_->SeekI(offset_) == wxInvalidOffset)
+				return false;
+		}
+
+		inflate_ = std::make_unique<wxZlibInputStream>(*in_, wxZLIB_NO_HEADER);
+		return true;
+	}
+
+	// Inflates the next [count] bytes into [buffer]
+	bool inflate(void* buffer, unsigned count)
+	{
+		inflate_->Read(buffer, count);
+		if (inflate_->LastRead() != count)
+			return false;
+
+		inflated_ += count;
+		return true;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns the offset of the data for the zip entry with its local file header
+// at [local_offset] in [source], or 0 if the header is invalid
+// -----------------------------------------------------------------------------
+unsigned localDataOffset(ZipSource& source, unsigned local_offset)
+{
+	// The name/extra field lengths can differ from those in the central
+	// directory, so they are read from the local file header
+	MemChunk header;
+	if (!source.read(local_offset, ZIP_SIZE_LOCAL_HEADER, header) || header.readL32(0) != ZIP_SIG_LOCAL_HEADER)
+		return 0;
+
+	return local_offset + ZIP_SIZE_LOCAL_HEADER + header.readL16(26) + header.readL16(28);
+}
 } // namespace
 
 
@@ -106,7 +378,11 @@ bool ZipArchive::open(string_view filename)
 	}
 
 	// Copy the zip to a temp file (for use when saving)
-	generateTempFileName(filename);
+	{
+		std::lock_guard lock(temp_file_mutex);
+		generateTempFileName(filename);
+		wxFile().Create(wxutil::strFromView(temp_file_), true);
+	}
 	fileutil::copyFile(filename, temp_file_);
 
 	// Open the file
@@ -117,122 +393,55 @@ bool ZipArchive::open(string_view filename)
 		return false;
 	}
 
-	// Create zip stream
-	wxZipInputStream zip(in);
-	if (!zip.IsOk())
+	// Read the zip, using cached entry types where possible
+	source_data_.clear();
+	openTypeCache(filename);
+	if (!readZip(in, filename))
 	{
-		global::error = "Invalid zip file";
+		closeTypeCache(false);
 		return false;
 	}
-
-	// Stop announcements (don't want to be announcing modification due to entries being added etc)
-	ArchiveModSignalBlocker sig_blocker{ *this };
-
-	// Go through all zip entries
-	int  entry_index = 0;
-	auto zip_entry   = zip.GetNextEntry();
-	ui::setSplashProgressMessage("Reading zip data");
-	while (zip_entry)
-	{
-		ui::setSplashProgress(-1.0f);
-		if (zip_entry->GetMethod() != wxZIP_METHOD_DEFLATE && zip_entry->GetMethod() != wxZIP_METHOD_STORE)
-		{
-			global::error = "Unsupported zip compression method";
-			return false;
-		}
-
-		if (!zip_entry->IsDir())
-		{
-			// Get the entry name as a Path (so we can break it up)
-			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
-
-			// Create entry
-			auto new_entry = std::make_shared<ArchiveEntry>(
-				misc::fileNameToLumpName(fn.fileName()), zip_entry->GetSize());
-
-			// Setup entry info
-			new_entry->setLoaded(false);
-			new_entry->exProp("ZipIndex") = entry_index;
-
-			// Add entry and directory to directory tree
-			auto ndir = createDir(fn.path(true));
-			ndir->addEntry(new_entry);
-
-			// Read the data, if possible
-			auto ze_size = zip_entry->GetSize();
-			if (ze_size < 250 * 1024 * 1024)
-			{
-				if (ze_size > 0)
-				{
-					vector<uint8_t> data(ze_size);
-					zip.Read(data.data(), ze_size); // Note: this is where exceedingly large files cause an exception.
-					new_entry->importMem(data.data(), ze_size);
-				}
-				new_entry->setLoaded(true);
-
-				// Determine its type
-				EntryType::detectEntryType(*new_entry);
-
-				// Unload data if needed
-				if (!archive_load_data)
-					new_entry->unloadData();
-			}
-			else
-			{
-				global::error = fmt::format("Entry too large: {} is {} mb", fn.fullPath(), ze_size / (1 << 20));
-				return false;
-			}
-		}
-		else
-		{
-			// Zip entry is a directory, add it to the directory tree
-			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
-			createDir(fn.path(true));
-		}
-
-		// Go to next entry in the zip file
-		delete zip_entry;
-		zip_entry = zip.GetNextEntry();
-		entry_index++;
-	}
-	ui::updateSplash();
-
-	// Set all entries/directories to unmodified
-	vector<ArchiveEntry*> entry_list;
-	putEntryTreeAsList(entry_list);
-	for (auto& entry : entry_list)
-		entry->setState(ArchiveEntry::State::Unmodified);
-
-	// Enable announcements
-	sig_blocker.unblock();
+	closeTypeCache(true);
 
 	// Setup variables
 	filename_ = filename;
 	setModified(false);
 	on_disk_ = true;
 
-	ui::setSplashProgressMessage("");
-
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Reads zip format data from a MemChunk
+// Reads zip format data from a MemChunk.
+// The zip is read directly from (a copy of) [mc], which is also kept to load
+// entry data from later. If [mc] is a view into a memory-mapped file (eg. a
+// zip in a mapped wad), the mapped data is referenced rather than copied.
 // Returns true if successful, false otherwise
 // -----------------------------------------------------------------------------
 bool ZipArchive::open(MemChunk& mc)
 {
-	// Write the MemChunk to a temp file
-	auto tempfile = app::path("slade-temp-open.zip", app::Dir::Temp);
-	mc.exportFile(tempfile);
+	// Keep the zip data to read entries from
+	if (mc.isMapped())
+		source_data_.importMapped(mc.mapping(), mc.mappedOffset(), mc.size());
+	else
+		source_data_.importMem(mc);
+	if (!source_data_.hasData())
+	{
+		global::error = "Invalid zip file";
+		return false;
+	}
 
-	// Load the file
-	bool success = open(tempfile);
+	// Read the zip
+	wxMemoryInputStream in(source_data_.data(), source_data_.size());
+	if (!readZip(in, {}))
+	{
+		source_data_.clear();
+		return false;
+	}
 
-	// Clean up
-	fileutil::removeFile(tempfile);
+	setModified(false);
 
-	return success;
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -263,103 +472,237 @@ bool ZipArchive::write(MemChunk& mc, bool update)
 // -----------------------------------------------------------------------------
 bool ZipArchive::write(string_view filename, bool update)
 {
-	// Open the file
-	wxFFileOutputStream out(wxutil::strFromView(filename));
-	if (!out.IsOk())
-	{
-		global::error = "Unable to open file for saving. Make sure it isn't in use by another program.";
-		return false;
-	}
+	// Get a linear list of all entries in the archive
+	vector<ArchiveEntry*> entries;
+	putEntryTreeAsList(entries);
 
-	// Open as zip for writing
-	wxZipOutputStream zip(out, 9);
-	if (!zip.IsOk())
+	// Open old zip for copying, from the temp file that was copied on opening
+	// (or the zip data in memory if it was opened from a MemChunk).
+	// This is used to copy the compressed data of any entries that have been
+	// previously saved and are unmodified, to greatly speed up zip file saving
+	// by not having to recompress unchanged entries
+	bool      can_copy = !central_dir_.empty() && (source_data_.hasData() || fileutil::fileExists(temp_file_));
+	ZipSource in(source_data_, can_copy ? temp_file_ : "");
+
+	// Determine which entries can be copied from the old zip
+	vector<int> copy_index(entries.size(), -1);
+	for (size_t a = 0; a < entries.size(); a++)
 	{
-		global::error = "Unable to create zip for saving";
-		return false;
+		auto entry = entries[a];
+		if (entry->type() == EntryType::folderType())
+			continue;
+
+		if (can_copy && in.isOk() && entry->state() == ArchiveEntry::State::Unmodified
+			&& entry->formatInfo().zip_index >= 0)
+		{
+			int index = entry->formatInfo().zip_index;
+			if (index >= 0 && index < static_cast<int>(central_dir_.size()))
+			{
+				copy_index[a] = index;
+				continue;
+			}
+		}
+
+		// Entry needs to be (re)compressed, make sure its data is loaded now
+		// (it may be loaded from the file being written to)
+		entry->rawData();
 	}
 
-	// Open old zip for copying, from the temp file that was copied on opening.
-	// This is used to copy any entries that have been previously saved/compressed
-	// and are unmodified, to greatly speed up zip file saving by not having to
-	// recompress unchanged entries
-	unique_ptr<wxFFileInputStream> in;
-	unique_ptr<wxZipInputStream>   inzip;
-	vector<wxZipEntry*>            c_entries;
-	if (fileutil::fileExists(temp_file_))
-	{
-		in    = std::make_unique<wxFFileInputStream>(temp_file_);
-		inzip = std::make_unique<wxZipInputStream>(*in);
+	// Compress all new/modified entries across worker threads
+	vector<ZipRecord> records(entries.size());
+	vector<MemChunk>  compressed(entries.size());
+	threadpool::parallelFor(entries.size(), [&](size_t index) {
+		if (copy_index[index] >= 0 || entries[index]->type() == EntryType::folderType())
+			return;
+
+		auto& data               = entries[index]->data(false);
+		records[index].size_orig = data.size();
+		records[index].crc       = data.crc();
+		// Large entries are split into blocks that are deflated in parallel,
+		// internal zips use (fast) zstd compression instead
+		bool ok = false;
+		if (data.size() > 0)
+		{
+			if (zstd_compression_)
+				ok = compression::zstdCompress(data, compressed[index], 1);
+			else if (data.size() >= ZIP_PARALLEL_DEFLATE_SIZE)
+				ok = compression::zipDeflateParallel(data, compressed[index], zip_compression_level);
+			else
+				ok = compression::zipDeflate(data, compressed[index], zip_compression_level);
+		}
 
-		if (inzip->IsOk())
+		if (ok && compressed[index].size() < data.size())
 		{
-			// Get a list of all entries in the old zip
-			c_entries.resize(inzip->GetTotalEntries());
-			for (unsigned a = 0; a < c_entries.size(); a++)
-				c_entries[a] = inzip->GetNextEntry();
+			records[index].method    = zstd_compression_ ? ZIP_METHOD_ZSTD : wxZIP_METHOD_DEFLATE;
+			records[index].size_comp = compressed[index].size();
 		}
 		else
 		{
-			in    = nullptr;
-			inzip = nullptr;
+			// Store uncompressed if compression is disabled or wouldn't make it smaller
+			compressed[index].clear();
+			records[index].size_comp = data.size();
 		}
-	}
+	});
 
-	// Get a linear list of all entries in the archive
-	vector<ArchiveEntry*> entries;
-	putEntryTreeAsList(entries);
+	// Open the file
+	wxFile out;
+	out.Open(wxutil::strFromView(filename), wxFile::write);
+	if (!out.IsOpened())
+	{
+		global::error = "Unable to open file for saving. Make sure it isn't in use by another program.";
+		return false;
+	}
 
 	// Go through all entries
+	MemChunk buffer;
+	MemChunk header;
+	uint64_t offset      = 0;
+	unsigned copy_offset = 0;
 	for (size_t a = 0; a < entries.size(); a++)
 	{
-		if (entries[a]->type() == EntryType::folderType())
+		auto  entry  = entries[a];
+		auto& record = records[a];
+
+		if (entry->type() == EntryType::folderType())
 		{
-			// If the current entry is a folder, just write a directory entry and continue
-			zip.PutNextDirEntry(entries[a]->path(true));
-			if (update)
-				entries[a]->setState(ArchiveEntry::State::Unmodified);
-			continue;
+			// If the current entry is a folder, just write a directory entry
+			record.name = entry->path(true) + "/";
+			record.dir  = true;
+			setRecordTimeNow(record);
 		}
+		else
+			record.name = entry->path() + misc::lumpNameToFileName(entry->name());
+		if (!record.name.empty() && record.name[0] == '/')
+			record.name.erase(0, 1);
 
-		// Get entry zip index
-		int index = -1;
-		if (entries[a]->exProps().contains("ZipIndex"))
-			index = entries[a]->exProp<int>("ZipIndex");
+		// Check the zip is still within the size limit (no zip64 support)
+		if (offset > 0xFFFFFFFF)
+		{
+			global::error = "Zip file is too large (over 4GB)";
+			return false;
+		}
+		record.local_offset = static_cast<uint32_t>(offset);
 
-		auto saname = misc::lumpNameToFileName(entries[a]->name());
-		if (!inzip || entries[a]->state() != ArchiveEntry::State::Unmodified || index < 0
-			|| index >= inzip->GetTotalEntries())
+		if (copy_index[a] >= 0)
 		{
-			// If the current entry has been changed, or doesn't exist in the old zip,
-			// (re)compress its data and write it to the zip
-			auto zipentry = new wxZipEntry(entries[a]->path() + saname);
-			zip.PutNextEntry(zipentry);
-			zip.Write(entries[a]->rawData(), entries[a]->size());
+			// If the entry is unmodified and exists in the old zip, just copy its compressed data over
+			const auto& source = central_dir_[copy_index[a]];
+			record.flags       = source.flags & ~0x0008; // No data descriptor
+			record.method      = source.method;
+			record.mod_time    = source.mod_time;
+			record.mod_date    = source.mod_date;
+			record.crc         = source.crc;
+			record.size_comp   = source.size_comp;
+			record.size_orig   = source.size_orig;
+
+			// Find the start of the compressed data in the old zip
+			MemChunk old_header;
+			if (!in.read(source.local_offset, ZIP_SIZE_LOCAL_HEADER, old_header)
+				|| old_header.readL32(0) != ZIP_SIG_LOCAL_HEADER)
+			{
+				global::error = fmt::format("Unable to copy entry {} from the existing zip", record.name);
+				return false;
+			}
+			copy_offset = source.local_offset + ZIP_SIZE_LOCAL_HEADER + old_header.readL16(26) + old_header.readL16(28);
 		}
-		else
+		else if (!record.dir)
 		{
-			// If the entry is unmodified and exists in the old zip, just copy it over
-			c_entries[index]->SetName(entries[a]->path() + saname);
-			zip.CopyEntry(c_entries[index], *inzip);
-			inzip->Reset();
+			// If the current entry has been changed, or doesn't exist in the old zip,
+			// its data was (re)compressed above
+			setRecordTimeNow(record);
 		}
 
-		// Update entry info
-		if (update)
+		// Write the local header
+		header.clear();
+		writeLocalHeader(header, record);
+		out.Write(header.data(), header.size());
+
+		// Write the entry (compressed) data
+		if (copy_index[a] >= 0)
 		{
-			entries[a]->setState(ArchiveEntry::State::Unmodified);
-			entries[a]->exProp("ZipIndex") = (int)a;
+			uint32_t left = record.size_comp;
+			while (left > 0)
+			{
+				auto count = std::min<uint32_t>(left, 1 << 20);
+				if (!in.read(copy_offset, count, buffer))
+				{
+					global::error = fmt::format("Unable to copy entry {} from the existing zip", record.name);
+					return false;
+				}
+				out.Write(buffer.data(), count);
+				copy_offset += count;
+				left -= count;
+			}
+		}
+		else if (record.method != wxZIP_METHOD_STORE)
+		{
+			out.Write(compressed[a].data(), compressed[a].size());
+			compressed[a].clear();
 		}
+		else if (record.size_comp > 0)
+			out.Write(entry->rawData(false), record.size_comp);
+
+		offset += header.size() + record.size_comp;
 	}
 
-	// Clean up
-	zip.Close();
+	// Write the central directory
+	MemChunk dir;
+	for (const auto& record : records)
+		writeCentralDirRecord(dir, record);
+	if (offset + dir.size() > 0xFFFFFFFF || records.size() >= 0xFFFF)
+	{
+		global::error = "Zip file is too large (over 4GB or 65535 entries)";
+		return false;
+	}
+
+	// Write the end of central directory record
+	auto dir_size = dir.size();
+	writeL32(dir, ZIP_SIG_END_OF_DIR);
+	writeL16(dir, 0); // Disk number
+	writeL16(dir, 0); // Disk with central directory
+	writeL16(dir, records.size());
+	writeL16(dir, records.size());
+	writeL32(dir, dir_size);
+	writeL32(dir, offset);
+	writeL16(dir, 0); // Comment length
+	out.Write(dir.data(), dir.size());
 	out.Close();
 
-	// Update the temp file
-	if (temp_file_.empty())
-		generateTempFileName(filename);
-	fileutil::copyFile(filename, temp_file_);
+	// Update entry info and the central directory index (zip indices will have changed)
+	if (update)
+	{
+		central_dir_.resize(records.size());
+		for (size_t a = 0; a < entries.size(); a++)
+		{
+			entries[a]->setState(ArchiveEntry::State::Unmodified);
+			entries[a]->formatInfo().zip_index = (int)a;
+			if (entries[a]->type() != EntryType::folderType())
+				entries[a]->exProp("ContentHash") = records[a].crc;
+
+			auto& cd_entry        = central_dir_[a];
+			cd_entry.local_offset = records[a].local_offset;
+			cd_entry.size_comp    = records[a].size_comp;
+			cd_entry.size_orig    = records[a].size_orig;
+			cd_entry.crc          = records[a].crc;
+			cd_entry.method       = records[a].method;
+			cd_entry.flags        = records[a].flags;
+			cd_entry.mod_time     = records[a].mod_time;
+			cd_entry.mod_date     = records[a].mod_date;
+		}
+	}
+
+	// Update the temp file (or in-memory zip data)
+	if (update)
+	{
+		if (source_data_.hasData())
+			source_data_.importFile(filename);
+		else
+		{
+			if (temp_file_.empty())
+				generateTempFileName(filename);
+			fileutil::copyFile(filename, temp_file_);
+		}
+	}
 
 	return true;
 }
@@ -388,24 +731,44 @@ bool ZipArchive::loadEntryData(ArchiveEntry* entry)
 
 	// Check that the entry has a zip index
 	int zip_index;
-	if (entry->exProps().contains("ZipIndex"))
-		zip_index = entry->exProp<int>("ZipIndex");
+	if (entry->formatInfo().zip_index >= 0)
+		zip_index = entry->formatInfo().zip_index;
 	else
 	{
 		log::error("ZipArchive::loadEntryData: Entry {} has no zip entry index!", entry->name());
 		return false;
 	}
 
-	// Open the file
-	wxFFileInputStream in(filename_);
-	if (!in.IsOk())
+	// Read the entry data directly via the central directory index if possible
+	if (zip_index >= 0 && zip_index < static_cast<int>(central_dir_.size()))
+	{
+		MemChunk data;
+		if (readEntryData(central_dir_[zip_index], data))
+		{
+			entry->lockState();
+			entry->importMemChunk(data, 0, data.size()); // References the data if it is memory-mapped
+			entry->setLoaded();
+			entry->unlockState();
+			return true;
+		}
+
+		log::warning("ZipArchive::loadEntryData: Unable to read entry {} via central directory", entry->name());
+	}
+
+	// Open the file (or in-memory zip data)
+	unique_ptr<wxInputStream> in;
+	if (source_data_.hasData())
+		in = std::make_unique<wxMemoryInputStream>(source_data_.data(), source_data_.size());
+	else
+		in = std::make_unique<wxFFileInputStream>(filename_);
+	if (!in->IsOk())
 	{
 		log::error("ZipArchive::loadEntryData: Unable to open zip file \"{}\"!", filename_);
 		return false;
 	}
 
 	// Create zip stream
-	wxZipInputStream zip(in);
+	wxZipInputStream zip(*in);
 	if (!zip.IsOk())
 	{
 		log::error("ZipArchive::loadEntryData: Invalid zip file \"{}\"!", filename_);
@@ -445,6 +808,49 @@ bool ZipArchive::loadEntryData(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns a reader for [entry]'s data. If the entry isn't loaded, its data is
+// read (and inflated as needed) directly from the zip file or data
+// -----------------------------------------------------------------------------
+unique_ptr<EntryDataReader> ZipArchive::entryDataReader(ArchiveEntry* entry)
+{
+	if (!checkEntry(entry) || entry->isLoaded() || entry->formatInfo().zip_index < 0)
+		return Archive::entryDataReader(entry);
+
+	auto zip_index = entry->formatInfo().zip_index;
+	if (zip_index < 0 || zip_index >= static_cast<int>(central_dir_.size()))
+		return Archive::entryDataReader(entry);
+
+	// Find the entry data
+	const auto& cd_entry = central_dir_[zip_index];
+	ZipSource   source(source_data_, filename_);
+	unsigned    data_offset = source.isOk() ? localDataOffset(source, cd_entry.local_offset) : 0;
+	if (data_offset == 0 || cd_entry.size_comp == 0 || data_offset + cd_entry.size_comp > source.size())
+		return Archive::entryDataReader(entry);
+
+	// Stored data can be read as-is
+	if (cd_entry.method == wxZIP_METHOD_STORE)
+	{
+		if (source_data_.hasData())
+			return std::make_unique<MemDataReader>(source_data_, data_offset, cd_entry.size_comp);
+
+		auto reader = std::make_unique<FileDataReader>(filename_, data_offset, cd_entry.size_comp);
+		if (reader->isOk())
+			return reader;
+	}
+
+	// Deflated data is inflated as it is read
+	else if (cd_entry.method == wxZIP_METHOD_DEFLATE)
+	{
+		auto reader = std::make_unique<ZipInflateReader>(
+			source_data_, filename_, data_offset, cd_entry.size_comp, cd_entry.size_orig);
+		if (reader->isOk())
+			return reader;
+	}
+
+	return Archive::entryDataReader(entry);
+}
+
 // -----------------------------------------------------------------------------
 // Adds [entry] to the end of the namespace matching [add_namespace].
 // If [copy] is true a copy of the entry is added.
@@ -637,6 +1043,198 @@ vector<ArchiveEntry*> ZipArchive::findAll(SearchOptions& options)
 	return Archive::findAll(opt);
 }
 
+// -----------------------------------------------------------------------------
+// Reads the zip entries and directories from the zip data in [in], and indexes
+// the central directory of the zip [filename] (or the in-memory zip data if
+// opened from memory).
+// Returns true if successful, false otherwise
+// -----------------------------------------------------------------------------
+bool ZipArchive::readZip(wxInputStream& in, string_view filename)
+{
+	// Create zip stream
+	wxZipInputStream zip(in);
+	if (!zip.IsOk())
+	{
+		global::error = "Invalid zip file";
+		return false;
+	}
+
+	// Stop announcements (don't want to be announcing modification due to entries being added etc)
+	ArchiveModSignalBlocker sig_blocker{ *this };
+
+	// Index the central directory for fast entry data loading, and to read
+	// entries compressed with methods wxZipInputStream doesn't support
+	bool have_central_dir = readCentralDirectory(filename);
+
+	// Detects the types of the entries in detect_batch. Any partially loaded
+	// entries whose type couldn't be determined from the start of their data
+	// then have their full data read (via the central directory) and are
+	// detected again
+	vector<ArchiveEntry*> detect_batch;
+	auto                  detect_batch_types = [&]() {
+		vector<ArchiveEntry*> partial_entries;
+		for (auto entry : detect_batch)
+			if (entry->isPartiallyLoaded())
+				partial_entries.push_back(entry);
+
+		detectEntryTypes(detect_batch);
+
+		for (auto entry : partial_entries)
+		{
+			entry->unloadData();
+
+			auto index = entry->formatInfo().zip_index;
+			if (entry->type() != EntryType::unknownType() || !have_central_dir || entry->size() >= MAX_LOAD_SIZE
+				|| index < 0 || index >= static_cast<int>(central_dir_.size()))
+				continue;
+
+			MemChunk data;
+			if (!readEntryData(central_dir_[index], data, filename))
+				continue;
+			entry->importMemChunk(data);
+			entry->setLoaded(true);
+			EntryType::detectEntryType(*entry);
+			entry->setState(ArchiveEntry::State::Unmodified);
+			if (!archive_load_data)
+				entry->unloadData();
+		}
+	};
+
+	// Go through all zip entries
+	int  entry_index = 0;
+	auto zip_entry   = zip.GetNextEntry();
+	ui::setSplashProgressMessage("Reading zip data");
+	while (zip_entry)
+	{
+		ui::setSplashProgress(-1.0f);
+		bool zstd = zip_entry->GetMethod() == ZIP_METHOD_ZSTD;
+		if (zstd && (!have_central_dir || entry_index >= static_cast<int>(central_dir_.size())))
+		{
+			global::error = "Unable to read zstd-compressed zip entries (invalid central directory)";
+			return false;
+		}
+		if (zip_entry->GetMethod() != wxZIP_METHOD_DEFLATE && zip_entry->GetMethod() != wxZIP_METHOD_STORE && !zstd)
+		{
+			global::error = "Unsupported zip compression method";
+			return false;
+		}
+
+		if (!zip_entry->IsDir())
+		{
+			// Get the entry name as a Path (so we can break it up)
+			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
+
+			// Create entry
+			auto new_entry = std::make_shared<ArchiveEntry>(
+				misc::fileNameToLumpName(fn.fileName()), zip_entry->GetSize());
+
+			// Setup entry info
+			new_entry->setLoaded(false);
+			new_entry->formatInfo().zip_index = entry_index;
+
+			// Add entry and directory to directory tree
+			auto ndir = createDir(fn.path(true));
+			ndir->addEntry(new_entry);
+
+			// Read the data, if possible
+			auto     ze_size    = zip_entry->GetSize();
+			unsigned probe_size = std::max<int>(zip_partial_detect_size, 0);
+			bool     partial    = zip_partial_detect && !archive_load_data && probe_size > 0 && ze_size > probe_size;
+			if (ze_size >= MAX_LOAD_SIZE)
+			{
+				// Very large entries are never fully loaded when opening, only
+				// probed for type detection and read when (or as) needed
+				if (probe_size == 0)
+					probe_size = 262144;
+				partial = true;
+			}
+			if (zstd)
+			{
+				// Zstd entries are read via the central directory and always
+				// fully decompressed (unless they are very large)
+				if (ze_size < MAX_LOAD_SIZE)
+				{
+					MemChunk data;
+					if (!readEntryData(central_dir_[entry_index], data, filename))
+					{
+						global::error = fmt::format("Unable to decompress zip entry {}", fn.fullPath());
+						return false;
+					}
+					new_entry->importMemChunk(data);
+					new_entry->setLoaded(true);
+					detect_batch.push_back(new_entry.get());
+					if (detect_batch.size() >= DETECT_BATCH_SIZE)
+						detect_batch_types();
+				}
+			}
+			else if (partial)
+			{
+				// Only inflate the start of large entries for type detection,
+				// which is enough for most formats. The entry keeps its full size
+				// for size checks, and its data is dropped after detection (it
+				// is fully loaded when needed)
+				auto& data = new_entry->data(false);
+				data.reSize(probe_size, false);
+				zip.Read(data.data(), probe_size);
+				new_entry->setPartiallyLoaded();
+
+				detect_batch.push_back(new_entry.get());
+				if (detect_batch.size() >= DETECT_BATCH_SIZE)
+					detect_batch_types();
+			}
+			else
+			{
+				if (ze_size > 0)
+				{
+					vector<uint8_t> data(ze_size);
+					zip.Read(data.data(), ze_size); // Note: this is where exceedingly large files cause an exception.
+					new_entry->importMem(data.data(), ze_size);
+				}
+				new_entry->setLoaded(true);
+
+				// Determine entry types in batches
+				detect_batch.push_back(new_entry.get());
+				if (detect_batch.size() >= DETECT_BATCH_SIZE)
+					detect_batch_types();
+			}
+		}
+		else
+		{
+			// Zip entry is a directory, add it to the directory tree
+			strutil::Path fn(wxutil::strToView(zip_entry->GetName(wxPATH_UNIX)));
+			createDir(fn.path(true));
+		}
+
+		// Go to next entry in the zip file
+		delete zip_entry;
+		zip_entry = zip.GetNextEntry();
+		entry_index++;
+	}
+	detect_batch_types();
+	ui::updateSplash();
+
+	// Set all entries/directories to unmodified
+	vector<ArchiveEntry*> entry_list;
+	putEntryTreeAsList(entry_list);
+	for (auto& entry : entry_list)
+		entry->setState(ArchiveEntry::State::Unmodified);
+
+	// The central directory CRCs can also be used as the entries' content hashes
+	if (!have_central_dir || central_dir_.size() != static_cast<unsigned>(entry_index))
+		central_dir_.clear();
+	else
+		for (auto& entry : entry_list)
+			if (entry->formatInfo().zip_index >= 0)
+				entry->exProp("ContentHash") = central_dir_[entry->formatInfo().zip_index].crc;
+
+	// Enable announcements
+	sig_blocker.unblock();
+
+	ui::setSplashProgressMessage("");
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Generates the temp file path to use, from [filename].
 // The temp file will be in the configured temp folder
@@ -661,6 +1259,142 @@ void ZipArchive::generateTempFileName(string_view filename)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Reads the central directory of the zip file at [filename] (or the zip data in
+// memory if it was opened from a MemChunk), recording the
+// local header offset, sizes and compression method of each entry so that
+// entry data can be read directly without scanning through the zip.
+// Returns false if the central directory couldn't be read or uses unsupported
+// features (eg. zip64)
+// -----------------------------------------------------------------------------
+bool ZipArchive::readCentralDirectory(string_view filename)
+{
+	central_dir_.clear();
+
+	ZipSource source(source_data_, filename);
+	if (!source.isOk() || source.size() < ZIP_SIZE_END_OF_DIR)
+		return false;
+
+	// Read the end of the file, the end of central directory record will be
+	// somewhere in there (it can be followed by a comment of up to 64kb)
+	unsigned file_size = source.size();
+	unsigned tail_size = std::min<unsigned>(file_size, ZIP_SIZE_END_OF_DIR + 0xFFFF);
+	MemChunk tail;
+	if (!source.read(file_size - tail_size, tail_size, tail))
+		return false;
+
+	// Find the end of central directory record
+	int eocd = -1;
+	for (int a = tail_size - ZIP_SIZE_END_OF_DIR; a >= 0; --a)
+		if (tail.readL32(a) == ZIP_SIG_END_OF_DIR)
+		{
+			eocd = a;
+			break;
+		}
+	if (eocd < 0)
+		return false;
+
+	unsigned num_entries = tail.readL16(eocd + 10);
+	unsigned dir_size    = tail.readL32(eocd + 12);
+	unsigned dir_offset  = tail.readL32(eocd + 16);
+
+	// Zip64 isn't supported
+	if (num_entries == 0xFFFF || dir_size == 0xFFFFFFFF || dir_offset == 0xFFFFFFFF)
+		return false;
+	if (num_entries == 0)
+		return true;
+	if (dir_offset + dir_size > file_size)
+		return false;
+
+	// Read the central directory
+	MemChunk dir;
+	if (!source.read(dir_offset, dir_size, dir))
+		return false;
+
+	central_dir_.reserve(num_entries);
+	unsigned pos = 0;
+	for (unsigned a = 0; a < num_entries; ++a)
+	{
+		if (pos + ZIP_SIZE_CENTRAL_DIR > dir_size || dir.readL32(pos) != ZIP_SIG_CENTRAL_DIR)
+		{
+			central_dir_.clear();
+			return false;
+		}
+
+		CentralDirEntry cd_entry;
+		cd_entry.flags        = dir.readL16(pos + 8);
+		cd_entry.method       = dir.readL16(pos + 10);
+		cd_entry.mod_time     = dir.readL16(pos + 12);
+		cd_entry.mod_date     = dir.readL16(pos + 14);
+		cd_entry.crc          = dir.readL32(pos + 16);
+		cd_entry.size_comp    = dir.readL32(pos + 20);
+		cd_entry.size_orig    = dir.readL32(pos + 24);
+		cd_entry.local_offset = dir.readL32(pos + 42);
+		central_dir_.push_back(cd_entry);
+
+		// Go to next record (skip name, extra field and comment)
+		pos += ZIP_SIZE_CENTRAL_DIR + dir.readL16(pos + 28) + dir.readL16(pos + 30) + dir.readL16(pos + 32);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads and decompresses the data for the entry described by [cd_entry]
+// from the archive file (or in-memory zip data) into [out]. If given, the data
+// is read from [filename] rather than the archive's current file
+// -----------------------------------------------------------------------------
+bool ZipArchive::readEntryData(const CentralDirEntry& cd_entry, MemChunk& out, string_view filename) const
+{
+	if (cd_entry.method != wxZIP_METHOD_STORE && cd_entry.method != wxZIP_METHOD_DEFLATE
+		&& cd_entry.method != ZIP_METHOD_ZSTD)
+		return false;
+
+	ZipSource source(source_data_, filename.empty() ? string_view{ filename_ } : filename);
+	if (!source.isOk())
+		return false;
+
+	// Find the data via the local file header
+	auto data_offset = localDataOffset(source, cd_entry.local_offset);
+	if (data_offset == 0)
+		return false;
+
+	// Read the (compressed) data
+	if (cd_entry.size_comp == 0)
+	{
+		out.clear();
+		return true;
+	}
+
+	// Stored data can be read straight into [out]
+	if (cd_entry.method == wxZIP_METHOD_STORE)
+		return source.read(data_offset, cd_entry.size_comp, out);
+
+	MemChunk data;
+	if (!source.read(data_offset, cd_entry.size_comp, data))
+		return false;
+
+	// Decompress straight into [out], its size is known from the central directory
+	if (cd_entry.size_orig == 0)
+	{
+		out.clear();
+		return true;
+	}
+	size_t size = 0;
+	if (!out.reSize(cd_entry.size_orig, false))
+		return false;
+	if (cd_entry.method == ZIP_METHOD_ZSTD ? !compression::zstdDecompressTo(data, out.data(), out.size(), &size) :
+											 !compression::zipInflateTo(data, out.data(), out.size(), &size))
+		return false;
+	if (size != out.size())
+	{
+		log::warning("Zip stream decompressed to {}, expected {}", size, out.size());
+		out.reSize(size);
+	}
+
+	return true;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -672,7 +1406,7 @@ void ZipArchive::generateTempFileName(string_view filename)
 // -----------------------------------------------------------------------------
 // Checks if the given data is a valid zip archive
 // -----------------------------------------------------------------------------
-bool ZipArchive::isZipArchive(MemChunk& mc)
+bool ZipArchive::isZipArchive(const MemChunk& mc)
 {
 	// Check size
 	if (mc.size() < sizeof(ZipFileHeader))
@@ -680,8 +1414,8 @@ bool ZipArchive::isZipArchive(MemChunk& mc)
 
 	// Read first file header
 	ZipFileHeader header;
-	mc.seek(0, SEEK_SET);
-	mc.read(&header, sizeof(ZipFileHeader));
+	MemDataReader reader(mc);
+	reader.read(&header, sizeof(ZipFileHeader));
 
 	// Check header signature
 	if (header.sig != 0x04034b50)
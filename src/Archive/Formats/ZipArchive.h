@@ -18,9 +18,17 @@ public:
 	bool write(MemChunk& mc, bool update = true) override;         // Write to MemChunk
 	bool write(string_view filename, bool update = true) override; // Write to File
 
+	// Use zstd (zip method 93) rather than deflate for new/modified entries
+	// when saving. Only for internal use (eg. backups), as many zip tools
+	// can't read zstd entries
+	void setZstdCompression(bool zstd) { zstd_compression_ = zstd; }
+
 	// Misc
 	bool loadEntryData(ArchiveEntry* entry) override;
 
+	// Entry data reading
+	unique_ptr<EntryDataReader> entryDataReader(ArchiveEntry* entry) override;
+
 	// Entry addition/removal
 	shared_ptr<ArchiveEntry> addEntry(shared_ptr<ArchiveEntry> entry, string_view add_namespace) override;
 
@@ -34,12 +42,31 @@ public:
 	vector<ArchiveEntry*> findAll(SearchOptions& options) override;
 
 	// Static functions
-	static bool isZipArchive(MemChunk& mc);
+	static bool isZipArchive(const MemChunk& mc);
 	static bool isZipArchive(const string& filename);
 
 private:
-	string temp_file_;
+	// Central directory info for an entry in the zip file on disk
+	struct CentralDirEntry
+	{
+		uint32_t local_offset = 0;
+		uint32_t size_comp    = 0;
+		uint32_t size_orig    = 0;
+		uint32_t crc          = 0;
+		uint16_t method       = 0;
+		uint16_t flags        = 0;
+		uint16_t mod_time     = 0;
+		uint16_t mod_date     = 0;
+	};
+
+	string                  temp_file_;
+	MemChunk                source_data_; // The zip data, if opened from a MemChunk rather than a file
+	vector<CentralDirEntry> central_dir_; // Indexed by the 'ZipIndex' entry property
+	bool                    zstd_compression_ = false;
 
+	bool readZip(wxInputStream& in, string_view filename);
 	void generateTempFileName(string_view filename);
+	bool readCentralDirectory(string_view filename);
+	bool readEntryData(const CentralDirEntry& cd_entry, MemChunk& out, string_view filename = {}) const;
 };
 } // namespace slade
@@ -0,0 +1,773 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ResourceUsage.cpp
+// Description: UsageIndex class, an index of the resources (textures, flats,
+//              patches and sprites) referenced by the maps, texture
+//              definitions, animation definitions and scripts in an archive,
+//              used to quickly find unused resources (and why others are used)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ResourceUsage.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/WadArchive.h"
+#include "Graphics/CTexture/PatchTable.h"
+#include "Graphics/CTexture/TextureXList.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+#include "Utility/Tokenizer.h"
+
+using namespace slade;
+using namespace resourceusage;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::map<Archive*, unique_ptr<UsageIndex>> indexes;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// How references are read from an entry (or a lump within it)
+enum class Source
+{
+	MapSidedefs,
+	MapSectors,
+	MapTextmap,
+	AnimDefs,
+	Animated,
+	Switches,
+	ACS,
+	Decorate,
+	ZScript
+};
+
+// An entry (or a map lump in an embedded wad) to read references from
+struct ReadJob
+{
+	ArchiveEntry* entry = nullptr; // The indexed entry
+	ArchiveEntry* lump  = nullptr; // The entry to read (same as [entry] unless in an embedded wad)
+	Source        source;
+	string        context;
+};
+
+// -----------------------------------------------------------------------------
+// Counts references (by type, name and context) as they are read
+// -----------------------------------------------------------------------------
+class RefCounter
+{
+public:
+	RefCounter(string_view context = {}) : context_{ context } {}
+
+	void setContext(string_view context) { context_ = context; }
+
+	void add(ResourceType type, string name)
+	{
+		strutil::upperIP(name);
+		if (name.empty() || name == "-")
+			return;
+
+		++counts_[{ type, name, context_ }];
+	}
+
+	// Adds an (up to) 8-character, null-padded name from binary data
+	void add(ResourceType type, const char* name) { add(type, string(name, strnlen(name, 8))); }
+
+	void addTo(vector<Reference>& refs) const
+	{
+		for (auto& count : counts_)
+		{
+			auto& [type, name, context] = count.first;
+			refs.push_back({ type, name, context, count.second });
+		}
+	}
+
+private:
+	string                                                       context_;
+	std::map<std::tuple<ResourceType, string, string>, unsigned> counts_;
+};
+
+// -----------------------------------------------------------------------------
+// Reads the wall textures referenced in the binary SIDEDEFS [data]
+// -----------------------------------------------------------------------------
+void readSidedefs(const MemChunk& data, RefCounter& refs)
+{
+	DoomMapFormat::SideDef side;
+	for (unsigned a = 0; a + sizeof(side) <= data.size(); a += sizeof(side))
+	{
+		memcpy(&side, data.data() + a, sizeof(side));
+		refs.add(ResourceType::Texture, side.tex_upper);
+		refs.add(ResourceType::Texture, side.tex_middle);
+		refs.add(ResourceType::Texture, side.tex_lower);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the flats referenced in the binary SECTORS [data]
+// -----------------------------------------------------------------------------
+void readSectors(const MemChunk& data, RefCounter& refs)
+{
+	DoomMapFormat::Sector sector;
+	for (unsigned a = 0; a + sizeof(sector) <= data.size(); a += sizeof(sector))
+	{
+		memcpy(&sector, data.data() + a, sizeof(sector));
+		refs.add(ResourceType::Flat, sector.f_tex);
+		refs.add(ResourceType::Flat, sector.c_tex);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the textures and flats referenced by sidedefs and sectors in the UDMF
+// TEXTMAP [data]
+// -----------------------------------------------------------------------------
+void readTextmap(const MemChunk& data, RefCounter& refs)
+{
+	Tokenizer tz;
+	tz.setSpecialCharacters("{};=");
+	tz.openMem(data, "UDMF TEXTMAP");
+
+	string block;
+	while (!tz.atEnd())
+	{
+		if (tz.check('}'))
+			block.clear();
+		else if (tz.checkNext('{'))
+			block = strutil::lower(tz.current().text);
+		else if (tz.checkNext('=') && !block.empty())
+		{
+			auto property = strutil::lower(tz.current().text);
+			tz.adv(2);
+			if (block == "sidedef"
+				&& (property == "texturetop" || property == "texturemiddle" || property == "texturebottom"))
+				refs.add(ResourceType::Texture, tz.current().text);
+			else if (block == "sector" && (property == "texturefloor" || property == "textureceiling"))
+				refs.add(ResourceType::Flat, tz.current().text);
+		}
+
+		tz.adv();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the textures and flats referenced in the ANIMDEFS [data]
+// -----------------------------------------------------------------------------
+void readAnimDefs(const MemChunk& data, RefCounter& refs)
+{
+	Tokenizer tz;
+	tz.openMem(data, "ANIMDEFS");
+
+	auto type = ResourceType::Texture;
+	while (!tz.atEnd())
+	{
+		// Animation/warp definition
+		if (tz.checkNC("texture") || tz.checkNC("flat") || tz.checkNC("warp") || tz.checkNC("warp2"))
+		{
+			if (tz.checkNC("warp") || tz.checkNC("warp2"))
+				tz.adv();
+			type = tz.checkNC("flat") ? ResourceType::Flat : ResourceType::Texture;
+			tz.adv();
+			if (tz.checkNC("optional"))
+				tz.adv();
+			refs.add(type, tz.current().text);
+		}
+
+		// Switch definition
+		else if (tz.checkNC("switch"))
+		{
+			type = ResourceType::Texture;
+			tz.adv();
+			if (tz.checkNC("doom") || tz.checkNC("heretic") || tz.checkNC("hexen") || tz.checkNC("strife")
+				|| tz.checkNC("any"))
+				tz.adv();
+			refs.add(type, tz.current().text);
+		}
+
+		// Animated door
+		else if (tz.checkNC("animateddoor"))
+		{
+			tz.adv();
+			refs.add(ResourceType::Texture, tz.current().text);
+		}
+
+		// Frame (by name rather than by number) or range end
+		else if ((tz.checkNC("pic") || tz.checkNC("range")) && !tz.peek().isInteger())
+		{
+			tz.adv();
+			refs.add(type, tz.current().text);
+		}
+
+		tz.adv();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the textures and flats referenced in the Boom ANIMATED [data]
+// -----------------------------------------------------------------------------
+void readAnimated(const MemChunk& data, RefCounter& refs)
+{
+	// Each record is a type byte, last and first names (9 chars) and speed
+	for (unsigned a = 0; a + 23 <= data.size(); a += 23)
+	{
+		auto record = reinterpret_cast<const char*>(data.data() + a);
+		if (static_cast<uint8_t>(record[0]) == 0xFF)
+			break;
+
+		auto type = record[0] & 1 ? ResourceType::Texture : ResourceType::Flat;
+		refs.add(type, record + 10);
+		refs.add(type, record + 1);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the textures referenced in the Boom SWITCHES [data]
+// -----------------------------------------------------------------------------
+void readSwitches(const MemChunk& data, RefCounter& refs)
+{
+	// Each record is off and on names (9 chars) and an episode number
+	for (unsigned a = 0; a + 20 <= data.size(); a += 20)
+	{
+		auto    record  = reinterpret_cast<const char*>(data.data() + a);
+		int16_t episode = 0;
+		memcpy(&episode, record + 18, 2);
+		if (episode == 0)
+			break;
+
+		refs.add(ResourceType::Texture, record);
+		refs.add(ResourceType::Texture, record + 9);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the textures and flats given (as string literals) to texture-changing
+// functions in the ACS source [data]
+// -----------------------------------------------------------------------------
+void readACS(const MemChunk& data, RefCounter& refs)
+{
+	static const std::pair<const char*, ResourceType> functions[] = {
+		{ "SetLineTexture", ResourceType::Texture },
+		{ "ReplaceTextures", ResourceType::Texture },
+		{ "ChangeFloor", ResourceType::Flat },
+		{ "ChangeCeiling", ResourceType::Flat },
+	};
+
+	Tokenizer tz;
+	tz.setSpecialCharacters(";,:|={}/()");
+	tz.openMem(data, "ACS");
+
+	while (!tz.atEnd())
+	{
+		for (auto& function : functions)
+		{
+			if (!tz.checkNC(function.first) || !tz.checkNext('('))
+				continue;
+
+			// Add all string arguments
+			tz.adv(2);
+			int depth = 1;
+			while (depth > 0 && !tz.atEnd())
+			{
+				if (tz.check('('))
+					++depth;
+				else if (tz.check(')'))
+					--depth;
+				else if (tz.current().quoted_string)
+					refs.add(function.second, tz.current().text);
+				tz.adv();
+			}
+			break;
+		}
+
+		tz.adv();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [token] is a state frame sequence (eg. 'ABCD')
+// -----------------------------------------------------------------------------
+bool isFrames(const Tokenizer::Token& token)
+{
+	if (token.text.empty() || token.quoted_string)
+		return false;
+
+	for (auto c : token.text)
+		if (!(c >= 'A' && c <= 'Z') && !(c >= 'a' && c <= 'z') && c != '[' && c != ']' && c != '\\' && c != '#')
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the sprites used in actor states in the DECORATE or ZScript [data]
+// -----------------------------------------------------------------------------
+void readActorStates(const MemChunk& data, RefCounter& refs, bool zscript)
+{
+	Tokenizer tz;
+	tz.setSpecialCharacters(";,:|={}/()");
+	tz.openMem(data, zscript ? "ZScript" : "DECORATE");
+
+	int depth        = 0;
+	int states_depth = -1; // Depth of the current states block, -1 if not in one
+	while (!tz.atEnd())
+	{
+		if (tz.check('{'))
+			++depth;
+		else if (tz.check('}'))
+		{
+			if (--depth <= states_depth)
+				states_depth = -1;
+		}
+
+		// Actor/class definition
+		else if (depth == 0 && (tz.checkNC("actor") || tz.checkNC("class")))
+			refs.setContext(fmt::format("{} {}", zscript ? "class" : "actor", tz.peek().text));
+
+		// States block
+		else if (tz.checkNC("states") && (tz.checkNext('{') || tz.checkNext('(')))
+			states_depth = depth;
+
+		// State (sprite followed by frames)
+		else if (states_depth >= 0 && depth == states_depth + 1 && tz.current().text.size() == 4)
+		{
+			auto& sprite = tz.current().text;
+			if (!tz.checkNC("goto") && !tz.checkNC("loop") && !tz.checkNC("stop") && !tz.checkNC("wait")
+				&& !tz.checkNC("fail") && sprite != "####" && sprite != "----" && isFrames(tz.peek()))
+				refs.add(ResourceType::Sprite, sprite);
+		}
+
+		tz.adv();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the references for [job], adding them to [refs]
+// -----------------------------------------------------------------------------
+void readReferences(const ReadJob& job, vector<Reference>& refs)
+{
+	RefCounter  counter(job.context);
+	const auto& data = job.lump->data(false);
+	switch (job.source)
+	{
+	case Source::MapSidedefs: readSidedefs(data, counter); break;
+	case Source::MapSectors: readSectors(data, counter); break;
+	case Source::MapTextmap: readTextmap(data, counter); break;
+	case Source::AnimDefs: readAnimDefs(data, counter); break;
+	case Source::Animated: readAnimated(data, counter); break;
+	case Source::Switches: readSwitches(data, counter); break;
+	case Source::ACS: readACS(data, counter); break;
+	case Source::Decorate: readActorStates(data, counter, false); break;
+	case Source::ZScript: readActorStates(data, counter, true); break;
+	}
+
+	counter.addTo(refs);
+}
+
+// -----------------------------------------------------------------------------
+// Adds jobs to read the map lumps in [desc] (from [archive]) to [jobs]
+// -----------------------------------------------------------------------------
+void addMapJobs(
+	Archive&                archive,
+	const Archive::MapDesc& desc,
+	ArchiveEntry*           entry,
+	const string&           context,
+	vector<ReadJob>&        jobs)
+{
+	// Doom64 maps use hashes rather than names for textures
+	if (desc.format == MapFormat::Doom64 || desc.format == MapFormat::Unknown)
+		return;
+
+	for (auto lump : desc.entries(archive))
+	{
+		auto type = lump->type()->id();
+		if (type == "map_sidedefs")
+			jobs.push_back({ entry, lump, Source::MapSidedefs, context });
+		else if (type == "map_sectors")
+			jobs.push_back({ entry, lump, Source::MapSectors, context });
+		else if (type == "udmf_textmap")
+			jobs.push_back({ entry, lump, Source::MapTextmap, context });
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// UsageIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// UsageIndex class constructor
+// -----------------------------------------------------------------------------
+UsageIndex::UsageIndex(const shared_ptr<Archive>& archive) : archive_{ archive }
+{
+	// Keep up to date with changes to the archive
+	auto& signals = archive->signals();
+	signal_connections_ += signals.entry_added.connect([this](Archive&, ArchiveEntry& entry) { markStale(entry); });
+	signal_connections_ += signals.entry_state_changed.connect(
+		[this](Archive&, ArchiveEntry& entry) { markStale(entry); });
+	signal_connections_ += signals.entry_renamed.connect(
+		[this](Archive&, ArchiveEntry& entry, string_view) { markStale(entry); });
+	signal_connections_ += signals.entry_removed.connect(
+		[this](Archive&, ArchiveDir&, ArchiveEntry& entry)
+		{
+			stale_.erase(&entry);
+			removeEntry(&entry);
+		});
+	signal_connections_ += signals.dir_added.connect([this](Archive&, ArchiveDir&) { rescan_ = true; });
+	signal_connections_ += signals.dir_removed.connect([this](Archive&, ArchiveDir&, ArchiveDir&) { rescan_ = true; });
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the archive contains any (indexed) maps
+// -----------------------------------------------------------------------------
+bool UsageIndex::hasMaps()
+{
+	update();
+	return n_maps_ > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the resource [name] of [type] is referenced anywhere in the
+// archive
+// -----------------------------------------------------------------------------
+bool UsageIndex::isUsed(ResourceType type, string_view name)
+{
+	update();
+	return names_[static_cast<int>(type)].count(strutil::upper(name)) > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all references to the resource [name] of [type] in the archive,
+// along with the entries they are in
+// -----------------------------------------------------------------------------
+vector<std::pair<ArchiveEntry*, Reference>> UsageIndex::references(ResourceType type, string_view name)
+{
+	update();
+
+	vector<std::pair<ArchiveEntry*, Reference>> refs;
+	auto                                        upper = strutil::upper(name);
+	auto                                        found = names_[static_cast<int>(type)].find(upper);
+	if (found == names_[static_cast<int>(type)].end())
+		return refs;
+
+	for (auto& i : found->second)
+		for (auto& ref : entries_[i.first].refs)
+			if (ref.type == type && ref.name == upper)
+				refs.emplace_back(i.first, ref);
+
+	return refs;
+}
+
+// -----------------------------------------------------------------------------
+// Reads references from any new or changed entries in the archive
+// -----------------------------------------------------------------------------
+void UsageIndex::update()
+{
+	auto archive = archive_.lock();
+	if (!archive)
+		return;
+
+	// Check all entries if any may have been added or removed without a signal
+	// (eg. with a directory)
+	if (rescan_)
+	{
+		Archive::SearchOptions options;
+		options.search_subdirs = true;
+		auto all = archive->findAll(options);
+
+		entries_.clear();
+		for (auto& names : names_)
+			names.clear();
+		n_maps_ = 0;
+		for (auto entry : all)
+			markStale(*entry);
+
+		rescan_ = false;
+	}
+
+	if (stale_.empty())
+		return;
+
+	// Get stale entries that still exist. Texture lists need to be re-read if
+	// the patch table changed, and map lumps need the maps to be detected
+	vector<ArchiveEntry*> stale;
+	bool                  pnames_changed = false;
+	bool                  maps_changed   = false;
+	for (auto& i : stale_)
+	{
+		removeEntry(i.first);
+		auto entry = i.second.lock();
+		if (!entry || entry.get() != i.first || entry->parent() != archive.get())
+			continue;
+
+		auto& type = entry->type()->id();
+		if (type == "pnames")
+			pnames_changed = true;
+		else if (type == "map_sidedefs" || type == "map_sectors" || type == "udmf_textmap" || type == "wad")
+			maps_changed = true;
+		stale.push_back(entry.get());
+	}
+	stale_.clear();
+	if (pnames_changed)
+	{
+		Archive::SearchOptions opt;
+		opt.match_type = EntryType::fromId("texturex");
+		for (auto entry : archive->findAll(opt))
+			if (std::find(stale.begin(), stale.end(), entry) == stale.end())
+			{
+				removeEntry(entry);
+				stale.push_back(entry);
+			}
+	}
+
+	// Detect maps (including maps in embedded wads)
+	std::unordered_map<ArchiveEntry*, const Archive::MapDesc*> map_entries;
+	vector<Archive::MapDesc>                                   maps;
+	if (maps_changed)
+	{
+		maps = archive->detectMaps();
+		for (auto& desc : maps)
+		{
+			if (desc.archive)
+				map_entries[desc.head.lock().get()] = &desc;
+			else
+				for (auto entry : desc.entries(*archive))
+					map_entries[entry] = &desc;
+		}
+	}
+
+	// Build list of entries (and lumps within them) to read
+	vector<ReadJob>                       jobs;
+	vector<shared_ptr<WadArchive>>        embedded;
+	std::map<ArchiveEntry*, IndexedEntry> indexed;
+	unique_ptr<PatchTable>                ptable;
+	for (auto entry : stale)
+	{
+		auto& type = entry->type()->id();
+
+		// Map lump or embedded wad
+		auto map = map_entries.find(entry);
+		if (map != map_entries.end())
+		{
+			if (map->second->archive)
+			{
+				auto wad = std::make_shared<WadArchive>();
+				if (!wad->open(entry->data()))
+					continue;
+
+				for (auto& desc : wad->detectMaps())
+					addMapJobs(*wad, desc, entry, fmt::format("{}/{}", entry->name(), desc.name), jobs);
+				embedded.push_back(wad);
+			}
+			else
+				addMapJobs(*archive, *map->second, entry, map->second->name, jobs);
+
+			indexed[entry].map = true;
+		}
+
+		// Texture definitions (these are read here since the texture list
+		// parsers aren't thread-safe)
+		else if (type == "texturex" || type == "zdtextures")
+		{
+			TextureXList tx;
+			if (type == "texturex")
+			{
+				if (!ptable)
+				{
+					ptable = std::make_unique<PatchTable>();
+					Archive::SearchOptions opt;
+					opt.match_type = EntryType::fromId("pnames");
+					if (auto pnames = archive->findLast(opt))
+						ptable->loadPNAMES(pnames, archive.get());
+				}
+				tx.readTEXTUREXData(entry, *ptable);
+			}
+			else
+				tx.readTEXTURESData(entry);
+
+			RefCounter refs;
+			for (unsigned a = 0; a < tx.size(); ++a)
+			{
+				auto texture = tx.texture(a);
+				refs.setContext(fmt::format("texture {}", texture->name()));
+				for (unsigned p = 0; p < texture->nPatches(); ++p)
+					refs.add(ResourceType::Patch, texture->patch(p)->name());
+			}
+			refs.addTo(indexed[entry].refs);
+		}
+
+		// Animations, switches and scripts
+		else if (type == "animdefs")
+			jobs.push_back({ entry, entry, Source::AnimDefs });
+		else if (type == "animated")
+			jobs.push_back({ entry, entry, Source::Animated });
+		else if (type == "switches")
+			jobs.push_back({ entry, entry, Source::Switches });
+		else if (type == "acs")
+			jobs.push_back({ entry, entry, Source::ACS });
+		else if (type == "decorate")
+			jobs.push_back({ entry, entry, Source::Decorate });
+		else if (type == "zscript")
+			jobs.push_back({ entry, entry, Source::ZScript });
+	}
+
+	// Read references (in parallel), data is loaded beforehand since it can't
+	// be loaded while reading
+	for (auto& job : jobs)
+		job.lump->data(true);
+	vector<vector<Reference>> refs(jobs.size());
+	threadpool::parallelFor(jobs.size(), [&](size_t index) { readReferences(jobs[index], refs[index]); });
+
+	// Add to index
+	for (unsigned a = 0; a < jobs.size(); ++a)
+	{
+		auto& entry_refs = indexed[jobs[a].entry].refs;
+		entry_refs.insert(entry_refs.end(), refs[a].begin(), refs[a].end());
+	}
+	for (auto& i : indexed)
+		if (i.second.map || !i.second.refs.empty())
+		{
+			i.second.entry = i.first->getShared();
+			addEntry(i.first, std::move(i.second));
+		}
+
+	for (auto& wad : embedded)
+		wad->close();
+
+	log::info(2, "Indexed resource usage in {} entries in archive {}", indexed.size(), archive->filename());
+}
+
+// -----------------------------------------------------------------------------
+// Marks [entry] to be (re-)read on the next update
+// -----------------------------------------------------------------------------
+void UsageIndex::markStale(ArchiveEntry& entry)
+{
+	stale_[&entry] = entry.getShared();
+}
+
+// -----------------------------------------------------------------------------
+// Adds the references in [indexed] for [entry] to the index
+// -----------------------------------------------------------------------------
+void UsageIndex::addEntry(ArchiveEntry* entry, IndexedEntry indexed)
+{
+	for (auto& ref : indexed.refs)
+		names_[static_cast<int>(ref.type)][ref.name][entry] += ref.count;
+	if (indexed.map)
+		++n_maps_;
+
+	entries_[entry] = std::move(indexed);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] and its references from the index, if it is indexed
+// -----------------------------------------------------------------------------
+void UsageIndex::removeEntry(ArchiveEntry* entry)
+{
+	auto i = entries_.find(entry);
+	if (i == entries_.end())
+		return;
+
+	for (auto& ref : i->second.refs)
+	{
+		auto& names = names_[static_cast<int>(ref.type)];
+		auto  name  = names.find(ref.name);
+		if (name == names.end())
+			continue;
+
+		name->second.erase(entry);
+		if (name->second.empty())
+			names.erase(name);
+	}
+	if (i->second.map)
+		--n_maps_;
+
+	entries_.erase(i);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ResourceUsage Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the resource usage index for [archive], created if it doesn't exist
+// yet. Returns nullptr if the archive isn't managed by the archive manager
+// -----------------------------------------------------------------------------
+UsageIndex* resourceusage::archiveIndex(Archive* archive)
+{
+	// Remove indexes of archives that no longer exist
+	for (auto i = indexes.begin(); i != indexes.end();)
+	{
+		if (i->second->expired())
+			i = indexes.erase(i);
+		else
+			++i;
+	}
+
+	auto existing = indexes.find(archive);
+	if (existing != indexes.end())
+		return existing->second.get();
+
+	auto shared = app::archiveManager().shareArchive(archive);
+	if (!shared)
+		return nullptr;
+
+	return indexes.emplace(archive, std::make_unique<UsageIndex>(shared)).first->second.get();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name of resource [type]
+// -----------------------------------------------------------------------------
+const char* resourceusage::typeName(ResourceType type)
+{
+	switch (type)
+	{
+	case ResourceType::Texture: return "texture";
+	case ResourceType::Flat: return "flat";
+	case ResourceType::Patch: return "patch";
+	case ResourceType::Sprite: return "sprite";
+	default: return "unknown";
+	}
+}
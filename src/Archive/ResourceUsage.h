@@ -0,0 +1,73 @@
+#pragma once
+
+#include "General/Sigslot.h"
+#include <unordered_map>
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+
+namespace resourceusage
+{
+	enum class ResourceType
+	{
+		Texture,
+		Flat,
+		Patch,
+		Sprite
+	};
+
+	// A reference to the resource [name] (uppercase) from an entry, [context]
+	// describes where in the entry it is referenced from (eg. the map or
+	// texture name) and [count] is the number of times it is referenced there
+	struct Reference
+	{
+		ResourceType type;
+		string       name;
+		string       context;
+		unsigned     count = 0;
+	};
+
+	// An index of the textures, flats, patches and sprites referenced by the
+	// maps, texture definitions, animation definitions and scripts in an
+	// archive. It is kept up to date with changes to the archive, only new or
+	// changed entries are re-read when it is next queried
+	class UsageIndex
+	{
+	public:
+		UsageIndex(const shared_ptr<Archive>& archive);
+		~UsageIndex() = default;
+
+		bool expired() const { return archive_.expired(); }
+		bool hasMaps();
+		bool isUsed(ResourceType type, string_view name);
+
+		vector<std::pair<ArchiveEntry*, Reference>> references(ResourceType type, string_view name);
+
+	private:
+		struct IndexedEntry
+		{
+			weak_ptr<ArchiveEntry> entry;
+			vector<Reference>      refs;
+			bool                   map = false; // True if the entry is (or contains) map data
+		};
+
+		weak_ptr<Archive>                                                       archive_;
+		std::unordered_map<ArchiveEntry*, IndexedEntry>                         entries_;
+		std::unordered_map<string, std::unordered_map<ArchiveEntry*, unsigned>> names_[4]; // Name -> entries (by type)
+		std::unordered_map<ArchiveEntry*, weak_ptr<ArchiveEntry>>               stale_;
+		unsigned                                                                n_maps_ = 0;
+		bool                                                                    rescan_ = true;
+		ScopedConnectionList                                                    signal_connections_;
+
+		void update();
+		void markStale(ArchiveEntry& entry);
+		void addEntry(ArchiveEntry* entry, IndexedEntry indexed);
+		void removeEntry(ArchiveEntry* entry);
+	};
+
+	UsageIndex* archiveIndex(Archive* archive);
+	const char* typeName(ResourceType type);
+} // namespace resourceusage
+} // namespace slade
@@ -0,0 +1,515 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextIndex.cpp
+// Description: TextIndex class, a trigram index of the text entries in an
+//              archive that is used to narrow down the entries to search for a
+//              string. Indexes are saved to (and loaded from) the user dir
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextIndex.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Misc.h"
+#include "TextSearch.h"
+#include "Utility/BinaryIO.h"
+#include "Utility/Compression.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace textsearch;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr uint32_t TEXT_INDEX_VERSION = 1;
+
+std::map<Archive*, unique_ptr<TextIndex>> indexes;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the sorted, unique (case-folded) trigrams in [text]
+// -----------------------------------------------------------------------------
+vector<uint32_t> extractTrigrams(string_view text)
+{
+	vector<uint32_t> trigrams;
+	if (text.size() < 3)
+		return trigrams;
+
+	auto fold = [](char c) { return static_cast<uint32_t>(static_cast<uint8_t>(c >= 'A' && c <= 'Z' ? c + 32 : c)); };
+
+	trigrams.reserve(text.size() - 2);
+	auto key = fold(text[0]) << 8 | fold(text[1]);
+	for (size_t a = 2; a < text.size(); ++a)
+	{
+		key = (key << 8 | fold(text[a])) & 0xffffff;
+		trigrams.push_back(key);
+	}
+
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	return trigrams;
+}
+
+// -----------------------------------------------------------------------------
+// Appends [value] to [out] as a variable-length integer (7 bits per byte)
+// -----------------------------------------------------------------------------
+void writeVarInt(string& out, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		out += static_cast<char>((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a variable-length integer written by writeVarInt from [mc] into
+// [value]
+// -----------------------------------------------------------------------------
+bool readVarInt(MemChunk& mc, uint32_t& value)
+{
+	value    = 0;
+	auto pos = mc.currentPos();
+	for (unsigned shift = 0; shift < 32 && pos < mc.size(); shift += 7)
+	{
+		auto byte = mc[pos++];
+		value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			return mc.seek(pos, SEEK_SET);
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the index file for the archive at [filename]
+// -----------------------------------------------------------------------------
+string indexPath(const string& filename)
+{
+	auto crc = misc::crc(reinterpret_cast<const uint8_t*>(filename.data()), filename.size());
+	return app::path(fmt::format("text_index/{:08x}.idx", crc), app::Dir::User);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// TextIndex Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// TextIndex class constructor
+// -----------------------------------------------------------------------------
+TextIndex::TextIndex(const shared_ptr<Archive>& archive) : archive_{ archive }, filename_{ archive->filename() }
+{
+	load();
+
+	// Keep up to date with changes to the archive
+	auto& signals = archive->signals();
+	signal_connections_ += signals.entry_added.connect([this](Archive&, ArchiveEntry& entry) { markStale(entry); });
+	signal_connections_ += signals.entry_state_changed.connect(
+		[this](Archive&, ArchiveEntry& entry) { markStale(entry); });
+	signal_connections_ += signals.entry_renamed.connect(
+		[this](Archive&, ArchiveEntry& entry, string_view) { markStale(entry); });
+	signal_connections_ += signals.entry_removed.connect(
+		[this](Archive&, ArchiveDir&, ArchiveEntry& entry) {
+			stale_.erase(&entry);
+			removeEntry(&entry);
+		});
+	signal_connections_ += signals.dir_added.connect([this](Archive&, ArchiveDir&) { rescan_ = true; });
+	signal_connections_ += signals.dir_removed.connect([this](Archive&, ArchiveDir&, ArchiveDir&) { rescan_ = true; });
+	signal_connections_ += signals.saved.connect([this](Archive& archive) { filename_ = archive.filename(); });
+	signal_connections_ += signals.closed.connect([this](Archive&) { save(); });
+}
+
+// -----------------------------------------------------------------------------
+// Returns all text entries in the archive that could contain [find] (ignoring
+// case), or all text entries if it is shorter than 3 characters
+// -----------------------------------------------------------------------------
+std::unordered_set<ArchiveEntry*> TextIndex::candidates(string_view find)
+{
+	update();
+
+	// Get posting lists for all trigrams in [find], if any trigram isn't in the
+	// index there can't be any matches
+	std::unordered_set<ArchiveEntry*> found;
+	vector<const vector<uint32_t>*>   lists;
+	for (auto trigram : extractTrigrams(find))
+	{
+		auto list = postings_.find(trigram);
+		if (list == postings_.end())
+			return found;
+
+		lists.push_back(&list->second);
+	}
+
+	// Intersect the posting lists, smallest first
+	vector<uint32_t> ids;
+	if (lists.empty())
+	{
+		for (auto& i : ids_)
+			ids.push_back(i.second);
+	}
+	else
+	{
+		std::sort(lists.begin(), lists.end(), [](auto a, auto b) { return a->size() < b->size(); });
+		ids = *lists[0];
+		vector<uint32_t> merged;
+		for (unsigned a = 1; a < lists.size() && !ids.empty(); ++a)
+		{
+			merged.clear();
+			std::set_intersection(
+				ids.begin(), ids.end(), lists[a]->begin(), lists[a]->end(), std::back_inserter(merged));
+			ids.swap(merged);
+		}
+	}
+
+	for (auto id : ids)
+	{
+		auto entry = entries_[id].entry.lock();
+		if (entry)
+			found.insert(entry.get());
+	}
+
+	return found;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the index to its file in the user dir, if it has been modified since
+// it was last loaded or saved
+// -----------------------------------------------------------------------------
+void TextIndex::save()
+{
+	if (!modified_ || filename_.empty())
+		return;
+
+	auto dir = app::path("text_index", app::Dir::User);
+	if (!wxDirExists(dir))
+		wxMkdir(dir);
+
+	string out = "STIX";
+	binaryio::writeRaw(out, TEXT_INDEX_VERSION);
+	binaryio::writeString(out, filename_);
+
+	// Entries, with trigrams delta-encoded since they are sorted
+	binaryio::writeRaw(out, static_cast<uint32_t>(ids_.size()));
+	for (auto& i : ids_)
+	{
+		auto& indexed = entries_[i.second];
+		binaryio::writeString(out, indexed.path);
+		binaryio::writeRaw(out, indexed.size);
+		binaryio::writeRaw(out, indexed.hash);
+		writeVarInt(out, static_cast<uint32_t>(indexed.trigrams.size()));
+		uint32_t prev = 0;
+		for (auto trigram : indexed.trigrams)
+		{
+			writeVarInt(out, trigram - prev);
+			prev = trigram;
+		}
+	}
+
+	auto     path = indexPath(filename_);
+	MemChunk mc(reinterpret_cast<const uint8_t*>(out.data()), out.size());
+	if (!compression::compressInternal(mc) || !mc.exportFile(path))
+		log::warning("Unable to write text index file {}", path);
+
+	modified_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the indexed entries in the index file for the archive (if any), these
+// are used for entries that haven't changed when the archive is first scanned
+// -----------------------------------------------------------------------------
+void TextIndex::load()
+{
+	auto     path = indexPath(filename_);
+	MemChunk mc;
+	if (filename_.empty() || !wxFileExists(path) || !mc.importFile(path) || !compression::decompressInternal(mc))
+		return;
+
+	// Check header (version and archive filename)
+	char     magic[4];
+	uint32_t version = 0;
+	string   index_filename;
+	if (!mc.read(magic, 4) || memcmp(magic, "STIX", 4) != 0 || !mc.read(&version, 4) || version != TEXT_INDEX_VERSION
+		|| !binaryio::readString(mc, index_filename) || index_filename != filename_)
+		return;
+
+	// Entries
+	uint32_t count = 0;
+	if (!binaryio::readCount(mc, count))
+		return;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		IndexedEntry indexed;
+		uint32_t     n_trigrams = 0;
+		if (!binaryio::readString(mc, indexed.path) || !mc.read(&indexed.size, 4) || !mc.read(&indexed.hash, 4)
+			|| !readVarInt(mc, n_trigrams) || n_trigrams > mc.size() - mc.currentPos())
+		{
+			loaded_.clear();
+			return;
+		}
+
+		indexed.trigrams.resize(n_trigrams);
+		uint32_t prev = 0;
+		for (auto& trigram : indexed.trigrams)
+		{
+			uint32_t delta = 0;
+			if (!readVarInt(mc, delta))
+			{
+				loaded_.clear();
+				return;
+			}
+			trigram = prev + delta;
+			prev    = trigram;
+		}
+
+		auto path_key     = indexed.path;
+		loaded_[path_key] = std::move(indexed);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Indexes any new or changed text entries in the archive
+// -----------------------------------------------------------------------------
+void TextIndex::update()
+{
+	auto archive = archive_.lock();
+	if (!archive)
+		return;
+
+	// Check all entries if any may have been added or removed without a signal
+	// (eg. with a directory)
+	if (rescan_)
+	{
+		Archive::SearchOptions options;
+		options.search_subdirs = true;
+		auto                              all = archive->findAll(options);
+		std::unordered_set<ArchiveEntry*> current(all.begin(), all.end());
+
+		vector<ArchiveEntry*> removed;
+		for (auto& i : ids_)
+			if (current.count(i.first) == 0 || entries_[i.second].entry.lock().get() != i.first)
+				removed.push_back(i.first);
+		for (auto entry : removed)
+			removeEntry(entry);
+
+		for (auto entry : all)
+			if (ids_.count(entry) == 0)
+				markStale(*entry);
+
+		rescan_ = false;
+	}
+
+	// Check stale entries, any that are unchanged since last indexed (or since
+	// the index file was saved) are kept
+	vector<ArchiveEntry*> changed;
+	for (auto& i : stale_)
+	{
+		auto entry = i.second.lock();
+		if (!entry || entry.get() != i.first || entry->parent() != archive.get()
+			|| entry->type()->editor() != "text")
+		{
+			removeEntry(i.first);
+			continue;
+		}
+
+		auto size = entry->size();
+		auto hash = entry->contentHash();
+		auto path = entry->path(true);
+		auto id   = ids_.find(i.first);
+		if (id != ids_.end() && entries_[id->second].size == size && entries_[id->second].hash == hash)
+		{
+			if (entries_[id->second].path != path)
+			{
+				entries_[id->second].path = path;
+				modified_                 = true;
+			}
+			continue;
+		}
+
+		removeEntry(i.first);
+		auto loaded = loaded_.find(path);
+		if (loaded != loaded_.end() && loaded->second.size == size && loaded->second.hash == hash)
+		{
+			loaded->second.entry = entry;
+			addEntry(std::move(loaded->second));
+			loaded_.erase(loaded);
+			continue;
+		}
+
+		changed.push_back(i.first);
+	}
+	stale_.clear();
+	loaded_.clear();
+
+	if (changed.empty())
+		return;
+
+	// Index changed entries
+	auto                     sources = textSources(changed);
+	vector<vector<uint32_t>> trigrams(sources.size());
+	threadpool::parallelFor(
+		sources.size(), [&](size_t index) { trigrams[index] = extractTrigrams(sources[index].text()); });
+
+	for (unsigned a = 0; a < sources.size(); ++a)
+	{
+		auto& entry = sources[a].entry;
+		addEntry({ entry, entry->path(true), entry->size(), entry->contentHash(), std::move(trigrams[a]) });
+	}
+
+	log::info(2, "Indexed {} text entries in archive {}", sources.size(), archive->filename());
+}
+
+// -----------------------------------------------------------------------------
+// Marks [entry] to be (re-)indexed on the next update
+// -----------------------------------------------------------------------------
+void TextIndex::markStale(ArchiveEntry& entry)
+{
+	stale_[&entry] = entry.getShared();
+}
+
+// -----------------------------------------------------------------------------
+// Adds the [indexed] entry to the index
+// -----------------------------------------------------------------------------
+void TextIndex::addEntry(IndexedEntry indexed)
+{
+	auto entry = indexed.entry.lock();
+	if (!entry)
+		return;
+
+	uint32_t id;
+	if (free_ids_.empty())
+	{
+		id = static_cast<uint32_t>(entries_.size());
+		entries_.emplace_back();
+	}
+	else
+	{
+		id = free_ids_.back();
+		free_ids_.pop_back();
+	}
+
+	for (auto trigram : indexed.trigrams)
+	{
+		auto& ids = postings_[trigram];
+		ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+	}
+
+	ids_[entry.get()] = id;
+	entries_[id]      = std::move(indexed);
+	modified_         = true;
+}
+
+// -----------------------------------------------------------------------------
+// Removes [entry] from the index, if it is indexed
+// -----------------------------------------------------------------------------
+void TextIndex::removeEntry(ArchiveEntry* entry)
+{
+	auto i = ids_.find(entry);
+	if (i == ids_.end())
+		return;
+
+	auto id = i->second;
+	for (auto trigram : entries_[id].trigrams)
+	{
+		auto list = postings_.find(trigram);
+		if (list == postings_.end())
+			continue;
+
+		auto& ids = list->second;
+		auto  pos = std::lower_bound(ids.begin(), ids.end(), id);
+		if (pos != ids.end() && *pos == id)
+			ids.erase(pos);
+		if (ids.empty())
+			postings_.erase(list);
+	}
+
+	entries_[id] = {};
+	free_ids_.push_back(id);
+	ids_.erase(i);
+	modified_ = true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the text index for [archive], created (or loaded) if it doesn't
+// exist yet. Returns nullptr if the archive can't be indexed (ie. it isn't
+// managed by the archive manager or has never been saved)
+// -----------------------------------------------------------------------------
+TextIndex* textsearch::archiveIndex(Archive* archive)
+{
+	// Remove (and save) indexes of archives that no longer exist
+	for (auto i = indexes.begin(); i != indexes.end();)
+	{
+		if (!i->second->expired())
+		{
+			++i;
+			continue;
+		}
+
+		i->second->save();
+		i = indexes.erase(i);
+	}
+
+	auto existing = indexes.find(archive);
+	if (existing != indexes.end())
+		return existing->second.get();
+
+	auto shared = app::archiveManager().shareArchive(archive);
+	if (!shared || archive->filename().empty())
+		return nullptr;
+
+	return indexes.emplace(archive, std::make_unique<TextIndex>(shared)).first->second.get();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "General/Sigslot.h"
+#include <unordered_map>
+#include <unordered_set>
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+
+namespace textsearch
+{
+	// A (case-insensitive) trigram index of the text entries in an archive, used
+	// to quickly find the entries that could contain a search string. It is kept
+	// up to date with changes to the archive and saved in the user dir, so that
+	// only new or changed entries need to be indexed next time it is opened
+	class TextIndex
+	{
+	public:
+		TextIndex(const shared_ptr<Archive>& archive);
+		~TextIndex() = default;
+
+		bool                              expired() const { return archive_.expired(); }
+		std::unordered_set<ArchiveEntry*> candidates(string_view find);
+		void                              save();
+
+		// An indexed entry, [path], [size] and [hash] are used to check if the
+		// entry has changed since it was indexed
+		struct IndexedEntry
+		{
+			weak_ptr<ArchiveEntry> entry;
+			string                 path;
+			uint32_t               size = 0;
+			uint32_t               hash = 0;
+			vector<uint32_t>       trigrams; // Sorted
+		};
+
+	private:
+		weak_ptr<Archive>                                         archive_;
+		string                                                    filename_;
+		vector<IndexedEntry>                                      entries_;
+		vector<uint32_t>                                          free_ids_;
+		std::unordered_map<ArchiveEntry*, uint32_t>               ids_;
+		std::unordered_map<uint32_t, vector<uint32_t>>            postings_; // Trigram -> sorted entry ids
+		std::unordered_map<ArchiveEntry*, weak_ptr<ArchiveEntry>> stale_;
+		std::unordered_map<string, IndexedEntry>                  loaded_; // Read from the index file, by path
+		bool                                                      rescan_   = true;
+		bool                                                      modified_ = false;
+		ScopedConnectionList                                      signal_connections_;
+
+		void load();
+		void update();
+		void markStale(ArchiveEntry& entry);
+		void addEntry(IndexedEntry indexed);
+		void removeEntry(ArchiveEntry* entry);
+	};
+
+	TextIndex* archiveIndex(Archive* archive);
+} // namespace textsearch
+} // namespace slade
@@ -0,0 +1,360 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextSearch.cpp
+// Description: Functions for finding (and replacing) text in the text entries
+//              of one or more archives, searched in parallel
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextSearch.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
+#include "TextIndex.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace textsearch;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned MAX_LINE_TEXT = 200; // Maximum length of a match's line text
+} // namespace
+CVAR(Bool, textsearch_use_index, false, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the lowercase version of (ASCII) character [c]
+// -----------------------------------------------------------------------------
+char foldChar(char c)
+{
+	return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [c] can be part of a word
+// -----------------------------------------------------------------------------
+bool isWordChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// -----------------------------------------------------------------------------
+// Removes any entries from [entries] that can't contain [find] according to
+// the text index of their archive (if text search indexing is enabled)
+// -----------------------------------------------------------------------------
+void removeNonCandidates(vector<ArchiveEntry*>& entries, string_view find)
+{
+	if (!textsearch_use_index || find.size() < 3)
+		return;
+
+	std::map<Archive*, std::unordered_set<ArchiveEntry*>> candidates;
+	std::set<Archive*>                                    unindexed;
+	vector<ArchiveEntry*>                                 kept;
+	for (auto entry : entries)
+	{
+		auto archive = entry->parent();
+		if (unindexed.count(archive) > 0)
+		{
+			kept.push_back(entry);
+			continue;
+		}
+
+		auto archive_candidates = candidates.find(archive);
+		if (archive_candidates == candidates.end())
+		{
+			auto index = archiveIndex(archive);
+			if (!index)
+			{
+				unindexed.insert(archive);
+				kept.push_back(entry);
+				continue;
+			}
+
+			archive_candidates = candidates.emplace(archive, index->candidates(find)).first;
+		}
+
+		if (archive_candidates->second.count(entry) > 0)
+			kept.push_back(entry);
+	}
+
+	entries.swap(kept);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Matcher Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Matcher class constructor
+// -----------------------------------------------------------------------------
+Matcher::Matcher(const Options& options) :
+	find_{ options.find },
+	match_case_{ options.match_case },
+	whole_word_{ options.whole_word }
+{
+	if (match_case_)
+		return;
+
+	// Build (Horspool) skip table for case-insensitive searching, case-sensitive
+	// searching uses string_view::find (memchr/memcmp) which is faster
+	auto n = find_.size();
+	for (auto& c : find_)
+		c = foldChar(c);
+	for (auto& skip : skip_)
+		skip = n;
+	for (size_t a = 0; a + 1 < n; ++a)
+	{
+		auto c                 = static_cast<uint8_t>(find_[a]);
+		skip_[c]               = n - 1 - a;
+		skip_[std::toupper(c)] = n - 1 - a;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the position of the first match in [text] from [from], or npos if
+// there are no more matches
+// -----------------------------------------------------------------------------
+size_t Matcher::find(string_view text, size_t from) const
+{
+	auto pos = findNext(text, from);
+	while (whole_word_ && pos != string_view::npos)
+	{
+		auto end = pos + find_.size();
+		if ((pos == 0 || !isWordChar(text[pos - 1])) && (end == text.size() || !isWordChar(text[end])))
+			break;
+
+		pos = findNext(text, pos + 1);
+	}
+
+	return pos;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the position of the next occurrence of the search string in [text]
+// from [from], ignoring the whole word option
+// -----------------------------------------------------------------------------
+size_t Matcher::findNext(string_view text, size_t from) const
+{
+	auto n = find_.size();
+	if (n == 0 || from + n > text.size())
+		return string_view::npos;
+
+	if (match_case_)
+		return text.find(find_, from);
+
+	for (auto pos = from; pos + n <= text.size(); pos += skip_[static_cast<uint8_t>(text[pos + n - 1])])
+	{
+		auto a = n;
+		while (a > 0 && foldChar(text[pos + a - 1]) == find_[a - 1])
+			--a;
+		if (a == 0)
+			return pos;
+	}
+
+	return string_view::npos;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearch Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns search sources for all text entries in [entries]. If [find] is given,
+// entries that the text index shows can't contain it are skipped.
+// Must be called on the main thread, since entry data may need to be loaded
+// -----------------------------------------------------------------------------
+vector<Source> textsearch::textSources(vector<ArchiveEntry*> entries, string_view find)
+{
+	removeNonCandidates(entries, find);
+
+	vector<Source> sources;
+	for (auto entry : entries)
+	{
+		if (entry->type()->editor() != "text")
+			continue;
+
+		Source source;
+		source.entry = entry->getShared();
+		if (!source.entry)
+			continue;
+
+		auto& data = entry->data();
+		if (data.isMapped())
+		{
+			source.mapping = data.mapping();
+			source.mapped  = { reinterpret_cast<const char*>(data.data()), data.size() };
+		}
+		else
+			source.copy.assign(reinterpret_cast<const char*>(data.data()), data.size());
+
+		sources.push_back(std::move(source));
+	}
+
+	return sources;
+}
+
+// -----------------------------------------------------------------------------
+// Returns search sources for all text entries in [archive]
+// -----------------------------------------------------------------------------
+vector<Source> textsearch::archiveSources(Archive* archive, string_view find)
+{
+	Archive::SearchOptions options;
+	options.search_subdirs = true;
+
+	return textSources(archive->findAll(options), find);
+}
+
+// -----------------------------------------------------------------------------
+// Returns search sources for all text entries in all open archives
+// -----------------------------------------------------------------------------
+vector<Source> textsearch::openArchiveSources(string_view find)
+{
+	Archive::SearchOptions options;
+	options.search_subdirs = true;
+
+	vector<ArchiveEntry*> entries;
+	for (int a = 0; a < app::archiveManager().numArchives(); ++a)
+	{
+		auto archive_entries = app::archiveManager().getArchive(a)->findAll(options);
+		entries.insert(entries.end(), archive_entries.begin(), archive_entries.end());
+	}
+
+	return textSources(entries, find);
+}
+
+// -----------------------------------------------------------------------------
+// Returns search sources for all text entries in the base resource archive and
+// all open resource archives (except [ignore])
+// -----------------------------------------------------------------------------
+vector<Source> textsearch::resourceSources(string_view find, Archive* ignore)
+{
+	Archive::SearchOptions options;
+	options.search_subdirs = true;
+
+	return textSources(app::archiveManager().findAllResourceEntries(options, ignore), find);
+}
+
+// -----------------------------------------------------------------------------
+// Searches all [sources] for [options], spread across the thread pool.
+// [found] is called with the matches in each source that has any, from
+// whichever thread searched it
+// -----------------------------------------------------------------------------
+void textsearch::search(
+	const vector<Source>&                     sources,
+	const Options&                            options,
+	const Job&                                job,
+	const std::function<void(vector<Match>)>& found)
+{
+	Matcher matcher{ options };
+	if (matcher.length() == 0)
+		return;
+
+	threadpool::parallelFor(sources.size(), [&](size_t index) {
+		auto          text    = sources[index].text();
+		unsigned      line    = 0;
+		size_t        counted = 0;
+		vector<Match> matches;
+		for (auto pos = matcher.find(text); pos != string_view::npos; pos = matcher.find(text, pos + matcher.length()))
+		{
+			if (job.cancelled())
+				return;
+
+			// Count lines up to the match
+			line += static_cast<unsigned>(std::count(text.begin() + counted, text.begin() + pos, '\n'));
+			counted = pos;
+
+			// Get the line text
+			auto line_start = text.rfind('\n', pos);
+			line_start      = line_start == string_view::npos ? 0 : line_start + 1;
+			auto line_end   = std::min(text.find('\n', pos), text.size());
+			auto line_text  = strutil::trim(text.substr(line_start, line_end - line_start));
+
+			matches.push_back(
+				{ static_cast<unsigned>(index),
+				  line,
+				  static_cast<unsigned>(pos),
+				  strutil::truncate(line_text, MAX_LINE_TEXT) });
+		}
+
+		if (!matches.empty())
+			found(std::move(matches));
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Writes [text] to [out] with all matches of [matcher] replaced by
+// [replacement]. Returns the number of matches replaced ([out] is left
+// untouched if there were none)
+// -----------------------------------------------------------------------------
+unsigned textsearch::replace(string_view text, const Matcher& matcher, string_view replacement, string& out)
+{
+	if (matcher.length() == 0)
+		return 0;
+
+	unsigned count = 0;
+	size_t   last  = 0;
+	for (auto pos = matcher.find(text); pos != string_view::npos; pos = matcher.find(text, last))
+	{
+		if (count == 0)
+			out.clear();
+
+		out.append(text.substr(last, pos - last));
+		out.append(replacement);
+		last = pos + matcher.length();
+		++count;
+	}
+
+	if (count > 0)
+		out.append(text.substr(last));
+
+	return count;
+}
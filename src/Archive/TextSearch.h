@@ -0,0 +1,71 @@
+#pragma once
+
+#include <functional>
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+class Job;
+class MappedFile;
+
+namespace textsearch
+{
+	struct Options
+	{
+		string find;
+		bool   match_case = false;
+		bool   whole_word = false;
+	};
+
+	// The text of an entry to search. This is a view of the entry's data if
+	// it's in a memory-mapped file (kept open here), otherwise a copy of it
+	struct Source
+	{
+		shared_ptr<ArchiveEntry> entry;
+		shared_ptr<MappedFile>   mapping;
+		string_view              mapped;
+		string                   copy;
+
+		string_view text() const { return mapping ? mapped : string_view{ copy }; }
+	};
+
+	struct Match
+	{
+		unsigned source   = 0; // Index of the Source the match is in
+		unsigned line     = 0; // Line number (from 0)
+		unsigned position = 0; // Position of the match in the text
+		string   line_text;    // The line the match is on (trimmed)
+	};
+
+	// Finds occurrences of a string in text, with the given search options
+	class Matcher
+	{
+	public:
+		Matcher(const Options& options);
+
+		size_t find(string_view text, size_t from = 0) const;
+		size_t length() const { return find_.size(); }
+
+	private:
+		string find_;
+		bool   match_case_;
+		bool   whole_word_;
+		size_t skip_[256] = {};
+
+		size_t findNext(string_view text, size_t from) const;
+	};
+
+	vector<Source> textSources(vector<ArchiveEntry*> entries, string_view find = {});
+	vector<Source> archiveSources(Archive* archive, string_view find = {});
+	vector<Source> openArchiveSources(string_view find = {});
+	vector<Source> resourceSources(string_view find = {}, Archive* ignore = nullptr);
+
+	void search(
+		const vector<Source>&                     sources,
+		const Options&                            options,
+		const Job&                                job,
+		const std::function<void(vector<Match>)>& found);
+	unsigned replace(string_view text, const Matcher& matcher, string_view replacement, string& out);
+} // namespace textsearch
+} // namespace slade
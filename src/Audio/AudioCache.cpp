@@ -0,0 +1,327 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    AudioCache.cpp
+// Description: Conversion of audio entries to playable formats (in the
+//              background), and a cache of converted audio and waveforms so
+//              that previously viewed entries can be opened instantly
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "AudioCache.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "MainEditor/Conversions.h"
+#include "Utility/MemoryStats.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace audio;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, snd_cache_size, 64, CVar::Flag::Save) // Max memory used by cached decoded audio (MB)
+
+namespace
+{
+// Number of peaks in cached waveforms
+constexpr unsigned WAVEFORM_RESOLUTION = 1024;
+
+struct CacheItem
+{
+	weak_ptr<ArchiveEntry>         entry;
+	uint32_t                       hash = 0; // Content hash of the entry when it was decoded
+	string                         format;
+	shared_ptr<DecodedAudio> audio;
+	unsigned                       last_used = 0;
+};
+
+std::map<ArchiveEntry*, CacheItem> cache;
+unsigned                           cache_size = 0;
+unsigned                           cache_time = 0;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Removes the least recently used items from the cache until it is within the
+// configured size limit
+// -----------------------------------------------------------------------------
+void pruneCache()
+{
+	auto limit = static_cast<unsigned>(std::max<int>(snd_cache_size, 0)) * 1024 * 1024;
+	while (cache_size > limit && !cache.empty())
+	{
+		auto oldest = cache.begin();
+		for (auto i = cache.begin(); i != cache.end(); ++i)
+			if (i->second.last_used < oldest->second.last_used)
+				oldest = i;
+
+		cache_size -= oldest->second.audio->memoryUsage();
+		cache.erase(oldest);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads the sample at [data] in the given format as a value from -1 to 1
+// -----------------------------------------------------------------------------
+float readSample(const uint8_t* data, unsigned bps, bool is_float)
+{
+	switch (bps)
+	{
+	case 8: return (static_cast<int>(data[0]) - 128) / 128.f;
+	case 16: return static_cast<int16_t>(data[0] | data[1] << 8) / 32768.f;
+	case 24: return static_cast<int32_t>((data[0] << 8) | (data[1] << 16) | (data[2] << 24)) / 2147483648.f;
+	case 32:
+		if (is_float)
+		{
+			float value;
+			memcpy(&value, data, 4);
+			return value;
+		}
+		return static_cast<int32_t>(data[0] | data[1] << 8 | data[2] << 16 | data[3] << 24) / 2147483648.f;
+	default: return 0.f;
+	}
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Converts audio [data] of [format] (an entry format id) to a playable format
+// if needed, and reads its waveform if possible.
+// This doesn't access the archive the data came from so it can be called from
+// any thread
+// -----------------------------------------------------------------------------
+shared_ptr<DecodedAudio> audio::decodeAudio(MemChunk& data, string_view format)
+{
+	auto  decoded = std::make_shared<DecodedAudio>();
+	auto& out     = decoded->data;
+
+	if (format == "snd_doom" || format == "snd_doom_mac") // Doom Sound -> WAV
+		conversion::doomSndToWav(data, out);
+	else if (format == "snd_speaker") // Doom PC Speaker Sound -> WAV
+		conversion::spkSndToWav(data, out);
+	else if (format == "snd_audiot") // AudioT PC Speaker Sound -> WAV
+		conversion::spkSndToWav(data, out, true);
+	else if (format == "snd_wolf") // Wolfenstein 3D Sound -> WAV
+		conversion::wolfSndToWav(data, out);
+	else if (format == "snd_voc") // Creative Voice File -> WAV
+		conversion::vocToWav(data, out);
+	else if (format == "snd_jaguar") // Jaguar Doom Sound -> WAV
+		conversion::jagSndToWav(data, out);
+	else if (format == "snd_bloodsfx") // Blood Sound (already converted, see audiocache::decode)
+	{
+		out.importMem(data.data(), data.size());
+		decoded->extension = "wav";
+	}
+	else if (format == "midi_mus") // MUS -> MIDI
+	{
+		conversion::musToMidi(data, out);
+		decoded->extension = "mid";
+	}
+	else if (format == "midi_xmi" || format == "midi_hmi" || format == "midi_hmp") // HMI/HMP/XMI -> MIDI
+	{
+		conversion::zmusToMidi(data, out, 0, &decoded->num_tracks);
+		decoded->extension = "mid";
+	}
+	else if (format == "midi_gmid") // GMID -> MIDI
+	{
+		conversion::gmidToMidi(data, out);
+		decoded->extension = "mid";
+	}
+	else
+		out.importMem(data.data(), data.size());
+
+	// Read the waveform if the (converted) audio is WAV
+	if (!strutil::startsWith(format, "midi_") && !strutil::startsWith(format, "mod_"))
+		decoded->waveform = wavWaveform(out, WAVEFORM_RESOLUTION);
+
+	return decoded;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the waveform of PCM [wav] data downsampled to (at most) [resolution]
+// peaks, each covering the min/max sample values (of all channels) of a range
+// of sample frames. Returns an empty waveform if [wav] isn't a valid PCM WAV
+// -----------------------------------------------------------------------------
+vector<DecodedAudio::Peak> audio::wavWaveform(const MemChunk& wav, unsigned resolution)
+{
+	vector<DecodedAudio::Peak> waveform;
+	if (wav.size() < 12 || memcmp(wav.data(), "RIFF", 4) != 0 || memcmp(wav.data() + 8, "WAVE", 4) != 0)
+		return waveform;
+
+	// Find the format and data chunks
+	unsigned tag = 0, channels = 0, bps = 0;
+	unsigned data_offset = 0, data_size = 0;
+	unsigned pos         = 12;
+	while (pos + 8 <= wav.size())
+	{
+		auto size = wav.readL32(pos + 4);
+		if (memcmp(wav.data() + pos, "fmt ", 4) == 0 && size >= 16 && pos + 24 <= wav.size())
+		{
+			tag      = wav.readL16(pos + 8);
+			channels = wav.readL16(pos + 10);
+			bps      = wav.readL16(pos + 22);
+
+			// WAVE_FORMAT_EXTENSIBLE, the actual format is the start of the subformat GUID
+			if (tag == 0xFFFE && size >= 40 && pos + 34 <= wav.size())
+				tag = wav.readL16(pos + 32);
+		}
+		else if (memcmp(wav.data() + pos, "data", 4) == 0)
+		{
+			data_offset = pos + 8;
+			data_size   = std::min<unsigned>(size, wav.size() - data_offset);
+			break;
+		}
+
+		if (size > wav.size() - pos - 8)
+			break;
+		pos += 8 + size + (size & 1);
+	}
+
+	// Only PCM (1) and float (3) formats are supported
+	bool is_float = tag == 3 && bps == 32;
+	if ((tag != 1 && !is_float) || channels == 0 || (bps != 8 && bps != 16 && bps != 24 && bps != 32)
+		|| data_offset == 0)
+		return waveform;
+
+	unsigned frame_size = channels * (bps / 8);
+	unsigned frames     = data_size / frame_size;
+	if (frames == 0 || resolution == 0)
+		return waveform;
+
+	// Get min/max sample values for each range of frames
+	resolution = std::min(resolution, frames);
+	waveform.resize(resolution);
+	auto samples = wav.data() + data_offset;
+	for (unsigned a = 0; a < resolution; ++a)
+	{
+		auto  start = static_cast<uint64_t>(frames) * a / resolution;
+		auto  end   = static_cast<uint64_t>(frames) * (a + 1) / resolution;
+		auto& peak  = waveform[a];
+		for (auto frame = start; frame < end; ++frame)
+			for (unsigned c = 0; c < channels; ++c)
+			{
+				auto value = readSample(samples + frame * frame_size + c * (bps / 8), bps, is_float);
+				peak.min   = std::min(peak.min, value);
+				peak.max   = std::max(peak.max, value);
+			}
+	}
+
+	return waveform;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached decoded audio for [entry], or nullptr if it hasn't been
+// decoded or has been modified since it was
+// -----------------------------------------------------------------------------
+shared_ptr<DecodedAudio> audio::audiocache::get(ArchiveEntry& entry)
+{
+	auto i = cache.find(&entry);
+	if (i == cache.end())
+		return nullptr;
+
+	auto& item = i->second;
+	if (item.entry.lock().get() != &entry || item.format != entry.type()->formatId()
+		|| item.hash != entry.contentHash())
+	{
+		cache_size -= item.audio->memoryUsage();
+		cache.erase(i);
+		return nullptr;
+	}
+
+	item.last_used = ++cache_time;
+	return item.audio;
+}
+
+// -----------------------------------------------------------------------------
+// Starts decoding [entry]'s audio in the background. When finished, the
+// decoded audio is added to the cache and [callback] is called with it on the
+// main thread (unless the returned job is cancelled before then)
+// -----------------------------------------------------------------------------
+shared_ptr<Job> audio::audiocache::decode(ArchiveEntry& entry, std::function<void(shared_ptr<DecodedAudio>)> callback)
+{
+	// Get a copy of the entry data to decode.
+	// Blood sounds need their raw data from the archive, so are converted here
+	string format = entry.type()->formatId();
+	auto   data   = std::make_shared<MemChunk>();
+	if (format == "snd_bloodsfx")
+		conversion::bloodToWav(&entry, *data);
+	else
+		data->importMem(entry.data());
+
+	// Decode in the background
+	auto result = std::make_shared<shared_ptr<DecodedAudio>>();
+	auto job    = Job::start([data, result, format](Job&) { *result = decodeAudio(*data, format); });
+
+	job->onComplete([entry = entry.getShared(), hash = entry.contentHash(), format, result, callback]() {
+		auto& audio = *result;
+		if (entry && audio)
+		{
+			// Add to cache
+			auto& item = cache[entry.get()];
+			if (item.audio)
+				cache_size -= item.audio->memoryUsage();
+			item.entry     = entry;
+			item.hash      = hash;
+			item.format    = format;
+			item.audio     = audio;
+			item.last_used = ++cache_time;
+			cache_size += audio->memoryUsage();
+			pruneCache();
+		}
+
+		callback(audio);
+	});
+
+	return job;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counts memory used by cached decoded audio
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(audio_cache, "Audio Cache")
+{
+	usage.push_back({ {}, "Decoded audio", cache_size, static_cast<unsigned>(cache.size()) });
+}
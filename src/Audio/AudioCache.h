@@ -0,0 +1,38 @@
+#pragma once
+
+namespace slade
+{
+class ArchiveEntry;
+class Job;
+
+namespace audio
+{
+	// Audio entry data converted to a playable format (eg. Doom sound -> WAV,
+	// MUS -> MIDI), with a downsampled waveform if it is PCM audio
+	struct DecodedAudio
+	{
+		// Peak sample values (-1 to 1) for a range of samples
+		struct Peak
+		{
+			float min = 0.f;
+			float max = 0.f;
+		};
+
+		MemChunk     data;           // Converted data (or a copy of the original if no conversion is needed)
+		string       extension;      // File extension for the converted data, empty if not converted
+		int          num_tracks = 1; // Number of tracks (subsongs)
+		vector<Peak> waveform;       // Empty if the audio isn't (or couldn't be read as) PCM WAV
+
+		unsigned memoryUsage() const { return data.size() + waveform.size() * sizeof(Peak); }
+	};
+
+	shared_ptr<DecodedAudio>   decodeAudio(MemChunk& data, string_view format);
+	vector<DecodedAudio::Peak> wavWaveform(const MemChunk& wav, unsigned resolution);
+
+	namespace audiocache
+	{
+		shared_ptr<DecodedAudio> get(ArchiveEntry& entry);
+		shared_ptr<Job>          decode(ArchiveEntry& entry, std::function<void(shared_ptr<DecodedAudio>)> callback);
+	} // namespace audiocache
+} // namespace audio
+} // namespace slade
@@ -1659,7 +1659,7 @@ wxString audio::getAiffInfo(MemChunk& mc)
 // returns the index at which the true audio data begins.
 // Returns 0 if there is no tag before audio data.
 // -----------------------------------------------------------------------------
-size_t audio::checkForTags(MemChunk& mc)
+size_t audio::checkForTags(const MemChunk& mc)
 {
 	// Check for empty wasted space at the beginning, since it's apparently
 	// quite popular in MP3s to start with a useless blank frame.
@@ -14,5 +14,5 @@ wxString getVocInfo(MemChunk& mc);
 wxString getSunInfo(MemChunk& mc);
 wxString getRmidInfo(MemChunk& mc);
 wxString getAiffInfo(MemChunk& mc);
-size_t   checkForTags(MemChunk& mc);
+size_t   checkForTags(const MemChunk& mc);
 } // namespace slade::audio
@@ -0,0 +1,117 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    EntryStream.cpp
+// Description: Helpers for streaming audio data from an entry (via an
+//              EntryDataReader) to the audio decoders during playback
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "EntryStream.h"
+#include "Archive/EntryDataReader.h"
+
+using namespace slade;
+using namespace audio;
+
+
+// -----------------------------------------------------------------------------
+//
+// EntryInputStream Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// EntryInputStream class constructor
+// -----------------------------------------------------------------------------
+EntryInputStream::EntryInputStream(unique_ptr<EntryDataReader> reader) : reader_{ std::move(reader) } {}
+
+// -----------------------------------------------------------------------------
+// EntryInputStream class destructor
+// -----------------------------------------------------------------------------
+EntryInputStream::~EntryInputStream() = default;
+
+// -----------------------------------------------------------------------------
+// Reads up to [size] bytes into [data], returns the number of bytes read or -1
+// on error
+// -----------------------------------------------------------------------------
+sf::Int64 EntryInputStream::read(void* data, sf::Int64 size)
+{
+	if (size < 0)
+		return -1;
+
+	auto count = static_cast<unsigned>(std::min<sf::Int64>(size, reader_->size() - reader_->currentPos()));
+	if (!reader_->read(data, count))
+		return -1;
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Moves the read position to [position], returns the new position or -1 on
+// error
+// -----------------------------------------------------------------------------
+sf::Int64 EntryInputStream::seek(sf::Int64 position)
+{
+	if (position < 0 || !reader_->seekFromStart(static_cast<unsigned>(position)))
+		return -1;
+
+	return position;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current read position
+// -----------------------------------------------------------------------------
+sf::Int64 EntryInputStream::tell()
+{
+	return reader_->currentPos();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total size of the data
+// -----------------------------------------------------------------------------
+sf::Int64 EntryInputStream::getSize()
+{
+	return reader_->size();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Reads up to [count] bytes from [reader] into [buffer], stopping at the end
+// of the data. Returns the number of bytes read (0 on error)
+// -----------------------------------------------------------------------------
+unsigned audio::readAvailable(EntryDataReader& reader, void* buffer, unsigned count)
+{
+	count = std::min(count, reader.size() - reader.currentPos());
+	return reader.read(buffer, count) ? count : 0;
+}
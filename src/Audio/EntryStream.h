@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SFML/System/InputStream.hpp>
+
+namespace slade
+{
+class EntryDataReader;
+
+namespace audio
+{
+	// sf::InputStream that reads (compressed) audio data through an
+	// EntryDataReader, so audio can be streamed from an archive as it is
+	// played rather than loaded all at once
+	class EntryInputStream : public sf::InputStream
+	{
+	public:
+		EntryInputStream(unique_ptr<EntryDataReader> reader);
+		~EntryInputStream() override;
+
+		sf::Int64 read(void* data, sf::Int64 size) override;
+		sf::Int64 seek(sf::Int64 position) override;
+		sf::Int64 tell() override;
+		sf::Int64 getSize() override;
+
+	private:
+		unique_ptr<EntryDataReader> reader_;
+	};
+
+	unsigned readAvailable(EntryDataReader& reader, void* buffer, unsigned count);
+} // namespace audio
+} // namespace slade
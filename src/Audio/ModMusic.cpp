@@ -32,6 +32,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "ModMusic.h"
+#include "Archive/EntryDataReader.h"
+#include "EntryStream.h"
 #include "thirdparty/dumb/dumb.h"
 
 using namespace slade;
@@ -46,6 +48,46 @@ using namespace audio;
 bool ModMusic::init_done_ = false;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// DUMB file system functions for reading from an EntryDataReader
+int readerSkip(void* f, long n)
+{
+	auto reader = static_cast<EntryDataReader*>(f);
+	return n >= 0 && reader->seek(n) ? 0 : -1;
+}
+int readerGetc(void* f)
+{
+	uint8_t value;
+	return readAvailable(*static_cast<EntryDataReader*>(f), &value, 1) ? value : -1;
+}
+long readerGetnc(char* ptr, long n, void* f)
+{
+	return n > 0 ? readAvailable(*static_cast<EntryDataReader*>(f), ptr, n) : 0;
+}
+void readerClose(void* f)
+{
+	delete static_cast<EntryDataReader*>(f);
+}
+int readerSeek(void* f, long n)
+{
+	return n >= 0 && static_cast<EntryDataReader*>(f)->seekFromStart(n) ? 0 : -1;
+}
+long readerGetSize(void* f)
+{
+	return static_cast<EntryDataReader*>(f)->size();
+}
+
+const DUMBFILE_SYSTEM reader_dfs = { nullptr,     &readerSkip, &readerGetc,   &readerGetnc,
+									 &readerClose, &readerSeek, &readerGetSize };
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ModMusic Class Functions
@@ -114,6 +156,39 @@ bool ModMusic::loadFromMemory(const uint8_t* data, const uint32_t size)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Loads mod data for playback from [reader], which is read (and then closed)
+// by the module loader, so the raw data never needs to be held in memory
+// -----------------------------------------------------------------------------
+bool ModMusic::openFromReader(unique_ptr<EntryDataReader> reader)
+{
+	// Init DUMB if needed
+	if (!init_done_)
+		initDumb();
+
+	// Close current module if any
+	close();
+
+	// Load module
+	auto file = dumbfile_open_ex(reader.release(), &reader_dfs);
+	if (file)
+	{
+		dumb_module_ = dumb_read_any(file, 0, 0);
+		dumbfile_close(file);
+	}
+	if (dumb_module_ != nullptr)
+	{
+		initialize(2, 44100);
+		dumb_player_ = duh_start_sigrenderer(dumb_module_, 0, 2, 0);
+		return true;
+	}
+	else
+	{
+		log::error("Failed to load module music data");
+		return false;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Returns the duration of the currently loaded mod
 // -----------------------------------------------------------------------------
@@ -5,6 +5,11 @@
 struct DUH;
 struct DUH_SIGRENDERER;
 
+namespace slade
+{
+class EntryDataReader;
+}
+
 namespace slade::audio
 {
 class ModMusic : public sf::SoundStream
@@ -15,6 +20,7 @@ public:
 
 	bool     openFromFile(const string& filename);
 	bool     loadFromMemory(const uint8_t* data, const uint32_t size);
+	bool     openFromReader(unique_ptr<EntryDataReader> reader);
 	sf::Time duration() const;
 
 	static void initDumb();
@@ -1,6 +1,8 @@
 
 #include "Main.h"
 #include "Mp3Music.h"
+#include "Archive/EntryDataReader.h"
+#include "EntryStream.h"
 #include <iostream>
 
 using namespace slade;
@@ -57,6 +59,31 @@ void memoryDataCleanup(void* raw_mp3_data)
 	delete static_cast<Mp3MemoryData*>(raw_mp3_data);
 }
 
+ssize_t readerDataRead(void* reader, void* buffer, size_t nbyte)
+{
+	return readAvailable(*static_cast<EntryDataReader*>(reader), buffer, nbyte);
+}
+
+off_t readerDataLSeek(void* raw_reader, off_t offset, int whence)
+{
+	auto reader = static_cast<EntryDataReader*>(raw_reader);
+	switch (whence)
+	{
+	case SEEK_SET: break;
+	case SEEK_CUR: offset += reader->currentPos(); break;
+	case SEEK_END: offset += reader->size(); break;
+	default: return -1;
+	}
+	if (offset < 0 || !reader->seekFromStart(offset))
+		return -1;
+	return offset;
+}
+
+void readerDataCleanup(void* reader)
+{
+	delete static_cast<EntryDataReader*>(reader);
+}
+
 } // namespace slade::audio
 
 
@@ -148,6 +175,7 @@ bool Mp3Music::loadFromMemory(void* data, size_t size_in_bytes)
 	if (handle_)
 		mpg123_close(handle_);
 
+	mpg123_replace_reader_handle(handle_, &memoryDataRead, &memoryDataLSeek, &memoryDataCleanup);
 	auto mp3_data = new Mp3MemoryData{ data, size_in_bytes, 0 };
 	if (!mp3_data)
 	{
@@ -186,6 +214,46 @@ bool Mp3Music::loadFromMemory(void* data, size_t size_in_bytes)
 	return true;
 }
 
+bool Mp3Music::openFromReader(unique_ptr<EntryDataReader> reader)
+{
+	stop();
+
+	if (buffer_)
+	{
+		delete[] buffer_;
+		buffer_ = nullptr;
+	}
+
+	if (handle_)
+		mpg123_close(handle_);
+
+	// The reader is owned (and deleted) by the mpg123 handle once opened
+	mpg123_replace_reader_handle(handle_, &readerDataRead, &readerDataLSeek, &readerDataCleanup);
+	auto raw_reader = reader.release();
+	if (mpg123_open_handle(handle_, raw_reader) != MPG123_OK)
+	{
+		log::error(mpg123_strerror(handle_));
+		delete raw_reader;
+		return false;
+	}
+
+	long rate     = 0;
+	int  channels = 0, encoding = 0;
+	if (mpg123_getformat(handle_, &rate, &channels, &encoding) != MPG123_OK)
+	{
+		log::error("Failed to get format information for mp3 stream");
+		return false;
+	}
+	sampling_rate_ = rate;
+
+	buffer_size_ = mpg123_outblock(handle_);
+	buffer_      = new unsigned char[buffer_size_];
+
+	initialize(channels, rate);
+
+	return true;
+}
+
 sf::Time Mp3Music::duration() const
 {
 	if (!handle_ || sampling_rate_ == 0)
@@ -3,6 +3,11 @@
 #include <SFML/Audio.hpp>
 #include <mpg123.h>
 
+namespace slade
+{
+class EntryDataReader;
+}
+
 namespace slade::audio
 {
 class Mp3Music : public sf::SoundStream
@@ -13,6 +18,7 @@ public:
 
 	bool     openFromFile(const std::string& filename);
 	bool     loadFromMemory(void* data, size_t size_in_bytes);
+	bool     openFromReader(unique_ptr<EntryDataReader> reader);
 	sf::Time duration() const;
 
 protected:
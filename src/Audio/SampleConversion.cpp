@@ -0,0 +1,312 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    SampleConversion.cpp
+// Description: Functions for converting buffers of audio samples between
+//              formats, and resampling audio to a different sample rate.
+//              Conversions work on whole buffers with simple, branch-free
+//              loops so that they can be vectorised by the compiler
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "SampleConversion.h"
+#include "Utility/MathStuff.h"
+#include <array>
+#include <numeric>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Resampling filter parameters: the number of sinc zero crossings on each side
+// of the filter (in output samples when downsampling), and the number of
+// precomputed filter phases (between which coefficients are interpolated)
+constexpr int RESAMPLE_ZERO_CROSSINGS = 16;
+constexpr int RESAMPLE_PHASES         = 256;
+
+// Filter taps are padded to a multiple of this, to be processed in parallel
+constexpr int RESAMPLE_LANES = 8;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Builds a lookup table of the linear value (-1 to 1) for each 8-bit A-law or
+// µ-law sample. Adapted from Sun Microsystem's g711.c code
+// -----------------------------------------------------------------------------
+std::array<float, 256> buildCompandTable(bool alaw)
+{
+	std::array<float, 256> table{};
+	for (int a = 0; a < 256; ++a)
+	{
+		int value;
+		if (alaw)
+		{
+			int val = a ^ 0x55;
+			int seg = (val & 0x70) >> 4;
+			value   = (val & 0xf) << 4;
+			value += seg == 0 ? 8 : 0x108;
+			if (seg > 1)
+				value <<= seg - 1;
+			value = (val & 0x80) ? value : -value;
+		}
+		else
+		{
+			int val = ~a & 0xff;
+			value   = (((val & 0xf) << 3) + 0x84) << ((val & 0x70) >> 4);
+			value   = (val & 0x80) ? (0x84 - value) : (value - 0x84);
+		}
+
+		table[a] = value / 32768.f;
+	}
+
+	return table;
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] companded samples at [data] to float using [table]
+// -----------------------------------------------------------------------------
+void compandedToFloat(const uint8_t* data, size_t count, float* out, const std::array<float, 256>& table)
+{
+	for (size_t a = 0; a < count; ++a)
+		out[a] = table[data[a]];
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value of the sinc resampling filter at [x] (in input samples
+// from the filter centre), with the given [cutoff] (relative to the input
+// nyquist frequency) and [half_width] (in input samples)
+// -----------------------------------------------------------------------------
+double resampleFilter(double x, double cutoff, double half_width)
+{
+	if (std::abs(x) >= half_width)
+		return 0.;
+
+	// Windowed sinc (Blackman window)
+	double sinc   = x == 0. ? 1. : std::sin(math::PI * cutoff * x) / (math::PI * cutoff * x);
+	double u      = x / half_width;
+	double window = 0.42 + 0.5 * std::cos(math::PI * u) + 0.08 * std::cos(2. * math::PI * u);
+
+	return cutoff * sinc * window;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Converts [count] little-endian integer PCM samples of [bits] (8, 16, 24 or
+// 32) at [data] to float samples (-1 to 1) in [out].
+// 8-bit samples are unsigned, others are signed
+// -----------------------------------------------------------------------------
+void audio::pcmToFloat(const uint8_t* data, size_t count, unsigned bits, float* out)
+{
+	switch (bits)
+	{
+	case 8:
+		for (size_t a = 0; a < count; ++a)
+			out[a] = (static_cast<int>(data[a]) - 128) * (1.f / 128.f);
+		break;
+	case 16:
+		for (size_t a = 0; a < count; ++a)
+			out[a] = static_cast<int16_t>(data[a * 2] | data[a * 2 + 1] << 8) * (1.f / 32768.f);
+		break;
+	case 24:
+		for (size_t a = 0; a < count; ++a)
+		{
+			auto s = data + a * 3;
+			out[a] = static_cast<int32_t>(s[0] << 8 | s[1] << 16 | static_cast<uint32_t>(s[2]) << 24)
+					 * (1.f / 2147483648.f);
+		}
+		break;
+	case 32:
+		for (size_t a = 0; a < count; ++a)
+		{
+			auto s = data + a * 4;
+			out[a] = static_cast<int32_t>(s[0] | s[1] << 8 | s[2] << 16 | static_cast<uint32_t>(s[3]) << 24)
+					 * (1.f / 2147483648.f);
+		}
+		break;
+	default: std::fill_n(out, count, 0.f); break;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] little-endian 32-bit float samples at [data] to [out]
+// -----------------------------------------------------------------------------
+void audio::floatSamplesToFloat(const uint8_t* data, size_t count, float* out)
+{
+	memcpy(out, data, count * 4);
+#if wxBYTE_ORDER == wxBIG_ENDIAN
+	auto values = reinterpret_cast<uint32_t*>(out);
+	for (size_t a = 0; a < count; ++a)
+		values[a] = wxUINT32_SWAP_ALWAYS(values[a]);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 8-bit A-law samples at [data] to float samples in [out]
+// -----------------------------------------------------------------------------
+void audio::alawToFloat(const uint8_t* data, size_t count, float* out)
+{
+	static const auto table = buildCompandTable(true);
+	compandedToFloat(data, count, out, table);
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] 8-bit µ-law samples at [data] to float samples in [out]
+// -----------------------------------------------------------------------------
+void audio::mulawToFloat(const uint8_t* data, size_t count, float* out)
+{
+	static const auto table = buildCompandTable(false);
+	compandedToFloat(data, count, out, table);
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] float [samples] to 8-bit unsigned PCM samples in [out],
+// rounded to the nearest value and clamped
+// -----------------------------------------------------------------------------
+void audio::floatToPcm8(const float* samples, size_t count, uint8_t* out)
+{
+	for (size_t a = 0; a < count; ++a)
+	{
+		auto value = static_cast<int>(samples[a] * 128.f + 128.5f);
+		out[a]     = static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Converts [count] float [samples] to 16-bit signed PCM samples in [out],
+// rounded to the nearest value and clamped
+// -----------------------------------------------------------------------------
+void audio::floatToPcm16(const float* samples, size_t count, int16_t* out)
+{
+	for (size_t a = 0; a < count; ++a)
+	{
+		auto value = static_cast<int>(samples[a] * 32768.f + 32768.5f) - 32768;
+		out[a]     = static_cast<int16_t>(std::min(std::max(value, -32768), 32767));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Mixes [frames] of interleaved [samples] with [channels] down to a single
+// channel in [out] (which can be the same as [samples])
+// -----------------------------------------------------------------------------
+void audio::mixToMono(const float* samples, size_t frames, unsigned channels, float* out)
+{
+	if (channels == 1)
+	{
+		if (out != samples)
+			memcpy(out, samples, frames * sizeof(float));
+		return;
+	}
+
+	if (channels == 2)
+	{
+		for (size_t a = 0; a < frames; ++a)
+			out[a] = (samples[a * 2] + samples[a * 2 + 1]) * 0.5f;
+		return;
+	}
+
+	float scale = 1.f / channels;
+	for (size_t a = 0; a < frames; ++a)
+	{
+		float sum = 0.f;
+		for (unsigned c = 0; c < channels; ++c)
+			sum += samples[a * channels + c];
+		out[a] = sum * scale;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Resamples (single channel) [samples] from [from_rate] to [to_rate] using a
+// windowed sinc filter, which also low-pass filters the audio when
+// downsampling to avoid aliasing.
+// Returns the resampled audio
+// -----------------------------------------------------------------------------
+vector<float> audio::resample(const vector<float>& samples, unsigned from_rate, unsigned to_rate)
+{
+	if (from_rate == to_rate || from_rate == 0 || to_rate == 0 || samples.empty())
+		return samples;
+
+	// Setup filter, when downsampling the cutoff is lowered to the output
+	// nyquist frequency (slightly below to leave room for the transition band)
+	double ratio      = static_cast<double>(to_rate) / from_rate;
+	double cutoff     = std::min(1., ratio) * 0.95;
+	int    half_width = static_cast<int>(std::ceil(RESAMPLE_ZERO_CROSSINGS / cutoff));
+	int    taps       = (half_width * 2 + RESAMPLE_LANES - 1) / RESAMPLE_LANES * RESAMPLE_LANES;
+
+	// Precompute the filter coefficients for each phase (fractional position
+	// between input samples), with an extra phase at the end for interpolation
+	vector<float> filter((RESAMPLE_PHASES + 1) * taps, 0.f);
+	for (int phase = 0; phase <= RESAMPLE_PHASES; ++phase)
+	{
+		double frac = static_cast<double>(phase) / RESAMPLE_PHASES;
+		for (int tap = 0; tap < half_width * 2; ++tap)
+			filter[phase * taps + tap] = static_cast<float>(resampleFilter(tap - half_width + 1 - frac, cutoff, half_width));
+	}
+
+	// Pad the input so the filter never needs to check bounds
+	vector<float> input(samples.size() + taps * 2, 0.f);
+	std::copy(samples.begin(), samples.end(), input.begin() + taps);
+
+	// Apply the filter at each output sample position
+	auto          count = static_cast<size_t>(std::ceil(samples.size() * ratio));
+	vector<float> output(count);
+	for (size_t a = 0; a < count; ++a)
+	{
+		double pos     = a / ratio;
+		auto   ipos    = static_cast<size_t>(pos);
+		double fphase  = (pos - ipos) * RESAMPLE_PHASES;
+		auto   phase   = static_cast<int>(fphase);
+		auto   t       = static_cast<float>(fphase - phase);
+		auto   filter0 = filter.data() + phase * taps;
+		auto   filter1 = filter0 + taps;
+		auto   in      = input.data() + taps + ipos - half_width + 1;
+
+		// Accumulate in separate lanes (which can be done in parallel)
+		float lanes[RESAMPLE_LANES] = {};
+		for (int tap = 0; tap < taps; tap += RESAMPLE_LANES)
+			for (int lane = 0; lane < RESAMPLE_LANES; ++lane)
+			{
+				auto i = tap + lane;
+				lanes[lane] += in[i] * (filter0[i] + t * (filter1[i] - filter0[i]));
+			}
+
+		output[a] = std::accumulate(lanes, lanes + RESAMPLE_LANES, 0.f);
+	}
+
+	return output;
+}
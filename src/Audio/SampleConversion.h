@@ -0,0 +1,16 @@
+#pragma once
+
+namespace slade::audio
+{
+// Sample format conversion (of whole buffers at once)
+void pcmToFloat(const uint8_t* data, size_t count, unsigned bits, float* out);
+void floatSamplesToFloat(const uint8_t* data, size_t count, float* out);
+void alawToFloat(const uint8_t* data, size_t count, float* out);
+void mulawToFloat(const uint8_t* data, size_t count, float* out);
+void floatToPcm8(const float* samples, size_t count, uint8_t* out);
+void floatToPcm16(const float* samples, size_t count, int16_t* out);
+void mixToMono(const float* samples, size_t frames, unsigned channels, float* out);
+
+// Resampling
+vector<float> resample(const vector<float>& samples, unsigned from_rate, unsigned to_rate);
+} // namespace slade::audio
@@ -39,6 +39,7 @@
 #include "Decorate.h"
 #include "GenLineSpecial.h"
 #include "General/Console.h"
+#include "General/Misc.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
@@ -56,6 +57,75 @@ using namespace game;
 EXTERN_CVAR(String, game_configuration)
 EXTERN_CVAR(String, port_configuration)
 CVAR(Bool, debug_configuration, false, CVar::Flag::Save)
+CVAR(Bool, game_config_cache, true, CVar::Flag::Save)
+namespace
+{
+constexpr uint32_t CONFIG_CACHE_VERSION = 1;
+constexpr int      MAX_DIRECT_ID        = 65536; // Ids below this are looked up directly by index in an IdLookup
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the path to the parsed configuration cache file for [cache_name] and
+// map [format]
+// -----------------------------------------------------------------------------
+string configCachePath(string_view cache_name, MapFormat format)
+{
+	return app::path(fmt::format("config_cache/{}_{}.cfgbin", cache_name, static_cast<int>(format)), app::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Loads the cached parse tree of configuration text [cfg] into [root], if the
+// cache file at [path] was written from the same text.
+// Returns false if there is no valid cache for [cfg]
+// -----------------------------------------------------------------------------
+bool loadConfigCache(const string& path, string_view cfg, ParseTreeNode& root)
+{
+	MemChunk mc;
+	if (!wxFileExists(path) || !mc.importFile(path))
+		return false;
+
+	// Check header (version and source text hash)
+	char     magic[4];
+	uint32_t version = 0, crc = 0, size = 0;
+	if (!mc.read(magic, 4) || memcmp(magic, "SCFG", 4) != 0 || !mc.read(&version, 4) || !mc.read(&crc, 4)
+		|| !mc.read(&size, 4))
+		return false;
+	if (version != CONFIG_CACHE_VERSION || size != cfg.size()
+		|| crc != misc::crc(reinterpret_cast<const uint8_t*>(cfg.data()), cfg.size()))
+		return false;
+
+	return root.readBinary(mc);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the parse tree [root] of configuration text [cfg] to the cache file
+// at [path]
+// -----------------------------------------------------------------------------
+void saveConfigCache(const string& path, string_view cfg, const ParseTreeNode& root)
+{
+	auto dir = app::path("config_cache", app::Dir::User);
+	if (!wxDirExists(dir))
+		wxMkdir(dir);
+
+	string   out      = "SCFG";
+	auto     crc      = misc::crc(reinterpret_cast<const uint8_t*>(cfg.data()), cfg.size());
+	uint32_t header[] = { CONFIG_CACHE_VERSION, crc, static_cast<uint32_t>(cfg.size()) };
+	out.append(reinterpret_cast<const char*>(header), sizeof(header));
+	root.writeBinary(out);
+
+	MemChunk mc(reinterpret_cast<const uint8_t*>(out.data()), out.size());
+	if (!mc.exportFile(path))
+		log::warning("Unable to write configuration cache file {}", path);
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -102,6 +172,24 @@ string Configuration::udmfNamespace() const
 	return strutil::lower(udmf_namespace_);
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if [feature] is supported by the game configuration
+// -----------------------------------------------------------------------------
+bool Configuration::featureSupported(Feature feature) const
+{
+	auto supported = supported_features_.find(feature);
+	return supported != supported_features_.end() && supported->second;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if UDMF [feature] is supported by the game configuration
+// -----------------------------------------------------------------------------
+bool Configuration::featureSupported(UDMFFeature feature) const
+{
+	auto supported = udmf_features_.find(feature);
+	return supported != udmf_features_.end() && supported->second;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the light level interval for the game configuration
 // -----------------------------------------------------------------------------
@@ -298,6 +386,10 @@ void Configuration::readUDMFProperties(ParseTreeNode* block, UDMFPropMap& plist)
 
 				if (strutil::equalCI(def->type(), "property"))
 				{
+					// Add the property name to the global property key table, so
+					// map object properties with this name can be looked up by key
+					property::internKey(def->name());
+
 					// Parse group defaults
 					plist[def->name()].parse(group, groupname);
 
@@ -512,14 +604,17 @@ void Configuration::readGameSection(ParseTreeNode* node_game, bool port_section)
 #undef READ_BOOL
 
 // -----------------------------------------------------------------------------
-// Reads a full game configuration from [cfg]
+// Reads a full game configuration from [cfg].
+// If [cache_name] is given, the parsed configuration is cached (in the user
+// dir) under that name, and reused next time if [cfg] hasn't changed
 // -----------------------------------------------------------------------------
 bool Configuration::readConfiguration(
 	string_view cfg,
 	string_view source,
 	MapFormat   format,
 	bool        ignore_game,
-	bool        clear)
+	bool        clear,
+	string_view cache_name)
 {
 	// Clear current configuration
 	if (clear)
@@ -538,8 +633,10 @@ bool Configuration::readConfiguration(
 		tt_group_defaults_.clear();
 	}
 
-	// Parse the full configuration
+	// Parse the full configuration, or use its cached parse tree if [cache_name]
+	// is given and the cache is up to date
 	Parser parser;
+	Parser parser_cached;
 	switch (format)
 	{
 	case MapFormat::Doom: parser.define("MAP_DOOM"); break;
@@ -548,10 +645,12 @@ bool Configuration::readConfiguration(
 	case MapFormat::UDMF: parser.define("MAP_UDMF"); break;
 	default: parser.define("MAP_UNKNOWN"); break;
 	}
-	parser.parseText(cfg, source);
-
-	// Process parsed data
-	auto base = parser.parseTreeRoot();
+	auto base       = parser.parseTreeRoot();
+	auto cache_path = cache_name.empty() ? string{} : configCachePath(cache_name, format);
+	if (!cache_path.empty() && loadConfigCache(cache_path, cfg, *parser_cached.parseTreeRoot()))
+		base = parser_cached.parseTreeRoot();
+	else if (parser.parseText(cfg, source) && !cache_path.empty())
+		saveConfigCache(cache_path, cfg, *base);
 
 	// Read game/port section(s) if needed
 	ParseTreeNode* node_game = nullptr;
@@ -858,6 +957,10 @@ bool Configuration::readConfiguration(
 			log::warning("Unexpected game configuration section \"{}\", skipping", node->name());
 	}
 
+	// Rebuild id lookups for the (possibly) changed action specials and thing types
+	buildLookup(action_special_lookup_, action_specials_);
+	thingTypesUpdated();
+
 	return true;
 }
 
@@ -937,8 +1040,9 @@ bool Configuration::openConfig(const string& game, const string& port, MapFormat
 	}
 
 	// Read fully built configuration
-	bool ok = true;
-	if (readConfiguration(full_config, "full.cfg", format))
+	bool ok         = true;
+	auto cache_name = game_config_cache ? fmt::format("{}_{}", game, port) : string{};
+	if (readConfiguration(full_config, "full.cfg", format, false, true, cache_name))
 	{
 		current_game_      = game;
 		current_port_      = port;
@@ -972,19 +1076,52 @@ bool Configuration::openConfig(const string& game, const string& port, MapFormat
 	return ok;
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds [lookup] for the defined values in [map]
+// -----------------------------------------------------------------------------
+template<typename T> void Configuration::buildLookup(IdLookup<T>& lookup, const std::map<int, T>& map)
+{
+	lookup.direct.clear();
+	lookup.sparse.clear();
+	for (auto& i : map)
+	{
+		if (!i.second.defined())
+			continue;
+
+		if (i.first >= 0 && i.first < MAX_DIRECT_ID)
+		{
+			if (lookup.direct.size() <= static_cast<size_t>(i.first))
+				lookup.direct.resize(i.first + 1, nullptr);
+			lookup.direct[i.first] = &i.second;
+		}
+		else
+			lookup.sparse[i.first] = &i.second;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value in [lookup] with [id], or null if there isn't one
+// -----------------------------------------------------------------------------
+template<typename T> const T* Configuration::findById(const IdLookup<T>& lookup, int id)
+{
+	if (id >= 0 && id < MAX_DIRECT_ID)
+		return static_cast<size_t>(id) < lookup.direct.size() ? lookup.direct[id] : nullptr;
+
+	auto i = lookup.sparse.find(id);
+	return i == lookup.sparse.end() ? nullptr : i->second;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the action special definition for [id]
 // -----------------------------------------------------------------------------
 const ActionSpecial& Configuration::actionSpecial(unsigned id)
 {
-	auto& as = action_specials_[id];
-
 	// Defined Action Special
-	if (as.defined())
-		return as;
+	if (auto as = findById(action_special_lookup_, id))
+		return *as;
 
 	// Boom Generalised Special
-	if (supported_features_[Feature::Boom] && id >= 0x2f80)
+	if (featureSupported(Feature::Boom) && id >= 0x2f80)
 	{
 		if ((id & 7) >= 6)
 			return ActionSpecial::generalManual();
@@ -1007,9 +1144,10 @@ string Configuration::actionSpecialName(int special)
 	else if (special == 0)
 		return "None";
 
-	if (action_specials_[special].defined())
-		return action_specials_[special].name();
-	else if (special >= 0x2F80 && supported_features_[Feature::Boom])
+	auto as = action_specials_.find(special);
+	if (as != action_specials_.end() && as->second.defined())
+		return as->second.name();
+	else if (special >= 0x2F80 && featureSupported(Feature::Boom))
 		return genlinespecial::parseLineType(special);
 	else
 		return "Unknown";
@@ -1020,11 +1158,8 @@ string Configuration::actionSpecialName(int special)
 // -----------------------------------------------------------------------------
 const ThingType& Configuration::thingType(unsigned type)
 {
-	auto& ttype = thing_types_[type];
-	if (ttype.defined())
-		return ttype;
-	else
-		return ThingType::unknown();
+	auto ttype = findById(thing_type_lookup_, type);
+	return ttype ? *ttype : ThingType::unknown();
 }
 
 // -----------------------------------------------------------------------------
@@ -1119,7 +1254,7 @@ bool Configuration::thingBasicFlagSet(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			return thing->flagSet(512);
 		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 			return !thing->flagSet(64);
 		else
 			return true;
@@ -1130,7 +1265,7 @@ bool Configuration::thingBasicFlagSet(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			return thing->flagSet(1024);
 		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 			return !thing->flagSet(32);
 		else
 			return true;
@@ -1282,7 +1417,7 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			flag_val = 512;
 		// *Not* Not In Coop
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 		{
 			flag_val = 64;
 			set      = !set;
@@ -1297,7 +1432,7 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 		if (hexen)
 			flag_val = 1024;
 		// *Not* Not In DM
-		else if (supported_features_[Feature::Boom])
+		else if (featureSupported(Feature::Boom))
 		{
 			flag_val = 32;
 			set      = !set;
@@ -1346,7 +1481,18 @@ void Configuration::setThingBasicFlag(string_view flag, MapThing* thing, MapForm
 // -----------------------------------------------------------------------------
 bool Configuration::parseDecorateDefs(Archive* archive)
 {
-	return readDecorateDefs(archive, thing_types_, parsed_types_);
+	auto ok = readDecorateDefs(archive, thing_types_, parsed_types_);
+	thingTypesUpdated();
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the already parsed DECORATE thing definitions [defs]
+// -----------------------------------------------------------------------------
+void Configuration::addDecorateDefs(const vector<DecorateDef>& defs)
+{
+	game::addDecorateDefs(defs, thing_types_, parsed_types_);
+	thingTypesUpdated();
 }
 
 // -----------------------------------------------------------------------------
@@ -1357,6 +1503,7 @@ void Configuration::clearDecorateDefs()
 	for (auto def : thing_types_)
 		if (def.second.decorate() && def.second.defined())
 			def.second.define(-1, "", "");
+	thingTypesUpdated();
 }
 
 // -----------------------------------------------------------------------------
@@ -1367,14 +1514,7 @@ void Configuration::clearDecorateDefs()
 void Configuration::importZScriptDefs(zscript::Definitions& defs)
 {
 	defs.exportThingTypes(thing_types_, parsed_types_);
-}
-
-// -----------------------------------------------------------------------------
-// Parses all *MAPINFO definitions in [archive]
-// -----------------------------------------------------------------------------
-bool Configuration::parseMapInfo(const Archive& archive)
-{
-	return map_info_.readMapInfo(archive);
+	thingTypesUpdated();
 }
 
 // -----------------------------------------------------------------------------
@@ -1396,6 +1536,20 @@ void Configuration::linkDoomEdNums()
 			log::info(2, "Linked parsed class {} to DoomEdNum %d", parsed.className(), ednum);
 		}
 	}
+
+	thingTypesUpdated();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the thing type lookup and flags any thing type info derived
+// elsewhere (see thingTypesVersion) as out of date. Must be called (on the
+// main thread) whenever thing_types_ is modified, so that thing type lookups
+// never modify the configuration and can be done from any thread
+// -----------------------------------------------------------------------------
+void Configuration::thingTypesUpdated()
+{
+	buildLookup(thing_type_lookup_, thing_types_);
+	++thing_types_version_;
 }
 
 // -----------------------------------------------------------------------------
@@ -1733,24 +1887,29 @@ const string& Configuration::spacTriggerUDMFName(unsigned trigger_index)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the UDMF property definition matching [name] for MapObject [type]
+// Returns the UDMF property definition matching [name] for MapObject [type],
+// or nullptr if no such property is defined
 // -----------------------------------------------------------------------------
 UDMFProperty* Configuration::getUDMFProperty(const string& name, MapObject::Type type)
 {
 	using Type = MapObject::Type;
 
+	UDMFPropMap* props;
 	if (type == Type::Vertex)
-		return &udmf_vertex_props_[name];
+		props = &udmf_vertex_props_;
 	else if (type == Type::Line)
-		return &udmf_linedef_props_[name];
+		props = &udmf_linedef_props_;
 	else if (type == Type::Side)
-		return &udmf_sidedef_props_[name];
+		props = &udmf_sidedef_props_;
 	else if (type == Type::Sector)
-		return &udmf_sector_props_[name];
+		props = &udmf_sector_props_;
 	else if (type == Type::Thing)
-		return &udmf_thing_props_[name];
+		props = &udmf_thing_props_;
 	else
 		return nullptr;
+
+	auto prop = props->find(name);
+	return prop != props->end() ? &prop->second : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -1881,7 +2040,8 @@ string Configuration::sectorTypeName(int type)
 	}
 
 	// Get base type name
-	auto name = sector_types_[type];
+	auto   type_name = sector_types_.find(type);
+	string name      = type_name != sector_types_.end() ? type_name->second : "";
 	if (name.empty())
 		name = "Unknown";
 
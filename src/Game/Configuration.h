@@ -9,6 +9,7 @@
 #include "ThingType.h"
 #include "UDMFProperty.h"
 #include "Utility/Property.h"
+#include <unordered_map>
 
 namespace slade
 {
@@ -24,6 +25,8 @@ namespace zscript
 
 namespace game
 {
+	struct DecorateDef;
+
 	// Feature Support
 	enum class Feature
 	{
@@ -94,8 +97,8 @@ namespace game
 		const std::map<int, string>&        allSectorTypes() const { return sector_types_; }
 
 		// Feature Support
-		bool featureSupported(Feature feature) { return supported_features_[feature]; }
-		bool featureSupported(UDMFFeature feature) { return udmf_features_[feature]; }
+		bool featureSupported(Feature feature) const;
+		bool featureSupported(UDMFFeature feature) const;
 
 		// Configuration reading
 		void readActionSpecials(
@@ -110,7 +113,8 @@ namespace game
 			string_view source      = "",
 			MapFormat   format      = MapFormat::Unknown,
 			bool        ignore_game = false,
-			bool        clear       = true);
+			bool        clear       = true,
+			string_view cache_name  = "");
 		bool openConfig(const string& game, const string& port = "", MapFormat format = MapFormat::Unknown);
 
 		// Action specials
@@ -120,6 +124,7 @@ namespace game
 		// Thing types
 		const ThingType& thingType(unsigned type);
 		const ThingType& thingTypeGroupDefaults(const string& group);
+		unsigned         thingTypesVersion() const { return thing_types_version_; }
 
 		// Thing flags
 		int    nThingFlags() const { return flags_thing_.size(); }
@@ -134,13 +139,14 @@ namespace game
 
 		// DECORATE
 		bool parseDecorateDefs(Archive* archive);
+		void addDecorateDefs(const vector<DecorateDef>& defs);
 		void clearDecorateDefs();
 
 		// ZScript
 		void importZScriptDefs(zscript::Definitions& defs);
 
 		// MapInfo
-		bool parseMapInfo(const Archive& archive);
+		void addMapInfo(const MapInfo& info) { map_info_.merge(info); }
 		void clearMapInfo() { map_info_.clear(); }
 		void linkDoomEdNums();
 
@@ -208,11 +214,22 @@ namespace game
 		string                    script_language_;        // Scripting language (should be extended to allow multiple)
 		vector<int>               light_levels_;           // Light levels for up/down light in editor
 
+		// Direct (by index) and hashed lookups of the defined values in a
+		// map by id, rebuilt whenever the map changes (never when reading)
+		template<typename T> struct IdLookup
+		{
+			vector<const T*>                  direct;
+			std::unordered_map<int, const T*> sparse;
+		};
+
 		// Action specials
 		std::map<int, ActionSpecial> action_specials_;
+		IdLookup<ActionSpecial>      action_special_lookup_;
 
 		// Thing types
 		std::map<int, ThingType>    thing_types_;
+		IdLookup<ThingType>         thing_type_lookup_;
+		unsigned                    thing_types_version_ = 0;
 		std::map<string, ThingType> tt_group_defaults_;
 		vector<ThingType>           parsed_types_;
 		// std::map<string, ThingType> parsed_types_;		// ThingTypes parsed from definitions
@@ -253,6 +270,11 @@ namespace game
 
 		// Special Presets
 		vector<SpecialPreset> special_presets_;
+
+		void thingTypesUpdated();
+
+		template<typename T> static void     buildLookup(IdLookup<T>& lookup, const std::map<int, T>& map);
+		template<typename T> static const T* findById(const IdLookup<T>& lookup, int id);
 	};
 } // namespace game
 } // namespace slade
@@ -238,7 +238,7 @@ void parseStates(Tokenizer& tz, PropertyList& props)
 // -----------------------------------------------------------------------------
 // Parses a DECORATE 'actor' definition
 // -----------------------------------------------------------------------------
-void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateActor(Tokenizer& tz, vector<DecorateDef>& defs)
 {
 	// Get actor name
 	auto   name       = tz.next().text;
@@ -265,12 +265,11 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 	else
 		tz.next().toInt(ednum);
 
-	PropertyList found_props;
-	bool         available       = false;
-	bool         filters_present = false;
-	bool         sprite_given    = false;
-	bool         title_given     = false;
-	string       group;
+	PropertyList   found_props;
+	vector<string> filters;
+	bool           sprite_given = false;
+	bool           title_given  = false;
+	string         group;
 
 	// Skip "native" keyword if present
 	tz.advIfNextNC("native");
@@ -297,11 +296,7 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 
 			// Game filter
 			else if (tz.checkNC("game"))
-			{
-				filters_present = true;
-				if (gameDef(configuration().currentGame()).supportsFilter(tz.next().text))
-					available = true;
-			}
+				filters.push_back(tz.next().text);
 
 			// Tag
 			else if (!title_given && tz.checkNC("tag"))
@@ -426,61 +421,14 @@ void parseDecorateActor(Tokenizer& tz, std::map<int, ThingType>& types, vector<T
 	else
 		log::warning("Warning: Invalid actor definition for {}", name);
 
-	// Ignore actors filtered for other games,
-	// and actors with a negative or null type
-	if (available || !filters_present)
-	{
-		auto group_path = group.empty() ? "Decorate" : "Decorate/" + group;
-
-		// Find existing definition or create it
-		ThingType* def = nullptr;
-		if (ednum <= 0)
-		{
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), actor_name))
-				{
-					def = &ptype;
-					break;
-				}
-
-			if (!def)
-			{
-				parsed.emplace_back(name, group_path, actor_name);
-				def = &parsed.back();
-			}
-		}
-		else
-			def = &types[ednum];
-
-		// Add/update definition
-		def->define(ednum, name, group_path);
-
-		// Set group defaults (if any)
-		if (!group.empty())
-		{
-			auto& group_defaults = configuration().thingTypeGroupDefaults(group);
-			if (!group_defaults.group().empty())
-				def->copy(group_defaults);
-		}
-
-		// Inherit from parent
-		if (!parent.empty())
-			for (auto& ptype : parsed)
-				if (strutil::equalCI(ptype.className(), parent))
-				{
-					def->copy(ptype);
-					break;
-				}
-
-		// Set parsed properties
-		def->loadProps(found_props);
-	}
+	// Add definition (game filters are checked when it is added to the config)
+	defs.push_back({ name, actor_name, parent, group, ednum, false, filters, found_props });
 }
 
 // -----------------------------------------------------------------------------
 // Parses an old-style (non-actor) DECORATE definition
 // -----------------------------------------------------------------------------
-void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
+void parseDecorateOld(Tokenizer& tz, vector<DecorateDef>& defs)
 {
 	string       name, sprite, group;
 	bool         spritefound = false;
@@ -557,10 +505,7 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 			found_props["sprite"] = sprite + frame + '?';
 
 		// Add type
-		types[type].define(type, name, group.empty() ? "Decorate" : "Decorate/" + group);
-
-		// Set parsed properties
-		types[type].loadProps(found_props);
+		defs.push_back({ name, "", "", group, type, true, {}, found_props });
 
 		log::info(3, "Parsed {} {}: {}", group.length() ? group : "decoration", name, type);
 	}
@@ -569,10 +514,13 @@ void parseDecorateOld(Tokenizer& tz, std::map<int, ThingType>& types)
 }
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [entry] and adds them to [types]
+// Parses all DECORATE thing definitions in [entry] and adds them to [defs].
+// [entry] and any entries it #includes are added to [sources]
 // -----------------------------------------------------------------------------
-void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+void parseDecorateEntry(ArchiveEntry* entry, vector<DecorateDef>& defs, vector<ArchiveEntry*>& sources)
 {
+	sources.push_back(entry);
+
 	// Init tokenizer
 	Tokenizer tz;
 	tz.setSpecialCharacters(":,{}");
@@ -598,16 +546,16 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 					tz.current().line_no);
 			}
 			else
-				parseDecorateEntry(inc_entry, types, parsed);
+				parseDecorateEntry(inc_entry, defs, sources);
 
 			tz.adv();
 		}
 
 		// Check for actor definition
 		else if (tz.checkNC("actor"))
-			parseDecorateActor(tz, types, parsed);
+			parseDecorateActor(tz, defs);
 		else
-			parseDecorateOld(tz, types); // Old DECORATE definitions might be found
+			parseDecorateOld(tz, defs); // Old DECORATE definitions might be found
 
 		tz.advIf("}");
 	}
@@ -628,9 +576,10 @@ void parseDecorateEntry(ArchiveEntry* entry, std::map<int, ThingType>& types, ve
 
 
 // -----------------------------------------------------------------------------
-// Parses all DECORATE thing definitions in [archive] and adds them to [types]
+// Parses all DECORATE definitions in [archive] into [defs]. All entries the
+// definitions were read from (including #includes) are added to [sources]
 // -----------------------------------------------------------------------------
-bool game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+bool game::parseDecorate(Archive* archive, vector<DecorateDef>& defs, vector<ArchiveEntry*>& sources)
 {
 	if (!archive)
 		return false;
@@ -652,7 +601,95 @@ bool game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, v
 
 	// Parse DECORATE entries
 	for (auto entry : decorate_entries)
-		parseDecorateEntry(entry, types, parsed);
+		parseDecorateEntry(entry, defs, sources);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the parsed DECORATE definitions [defs] to [types] (or [parsed] for
+// actors without an editor number)
+// -----------------------------------------------------------------------------
+void game::addDecorateDefs(const vector<DecorateDef>& defs, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	for (const auto& ddef : defs)
+	{
+		auto group_path = ddef.group.empty() ? "Decorate" : "Decorate/" + ddef.group;
+		auto props      = ddef.props;
+
+		// Old DECORATE definition
+		if (ddef.old_format)
+		{
+			types[ddef.ednum].define(ddef.ednum, ddef.name, group_path);
+			types[ddef.ednum].loadProps(props);
+			continue;
+		}
+
+		// Ignore actors filtered for other games,
+		// and actors with a negative or null type
+		bool available = ddef.game_filters.empty();
+		for (const auto& filter : ddef.game_filters)
+			if (gameDef(configuration().currentGame()).supportsFilter(filter))
+				available = true;
+		if (!available)
+			continue;
+
+		// Find existing definition or create it
+		ThingType* def = nullptr;
+		if (ddef.ednum <= 0)
+		{
+			for (auto& ptype : parsed)
+				if (strutil::equalCI(ptype.className(), ddef.class_name))
+				{
+					def = &ptype;
+					break;
+				}
+
+			if (!def)
+			{
+				parsed.emplace_back(ddef.name, group_path, ddef.class_name);
+				def = &parsed.back();
+			}
+		}
+		else
+			def = &types[ddef.ednum];
+
+		// Add/update definition
+		def->define(ddef.ednum, ddef.name, group_path);
+
+		// Set group defaults (if any)
+		if (!ddef.group.empty())
+		{
+			auto& group_defaults = configuration().thingTypeGroupDefaults(ddef.group);
+			if (!group_defaults.group().empty())
+				def->copy(group_defaults);
+		}
+
+		// Inherit from parent
+		if (!ddef.parent.empty())
+			for (auto& ptype : parsed)
+				if (strutil::equalCI(ptype.className(), ddef.parent))
+				{
+					def->copy(ptype);
+					break;
+				}
+
+		// Set parsed properties
+		def->loadProps(props);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Parses all DECORATE thing definitions in [archive] and adds them to [types]
+// -----------------------------------------------------------------------------
+bool game::readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, vector<ThingType>& parsed)
+{
+	vector<DecorateDef>   defs;
+	vector<ArchiveEntry*> sources;
+	if (!parseDecorate(archive, defs, sources))
+		return false;
+
+	addDecorateDefs(defs, types, parsed);
 
 	return true;
 }
@@ -682,7 +719,12 @@ CONSOLE_COMMAND(test_decorate, 0, false)
 	{
 		auto entry = archive->entryAtPath(args[0]);
 		if (entry)
-			parseDecorateEntry(entry, types, parsed);
+		{
+			vector<DecorateDef>   defs;
+			vector<ArchiveEntry*> sources;
+			parseDecorateEntry(entry, defs, sources);
+			addDecorateDefs(defs, types, parsed);
+		}
 		else
 			log::console("Entry not found");
 	}
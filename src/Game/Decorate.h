@@ -1,10 +1,12 @@
 #pragma once
 
 #include "ThingType.h"
+#include "Utility/Property.h"
 
 namespace slade
 {
 class Archive;
+class ArchiveEntry;
 
 namespace game
 {
@@ -19,6 +21,21 @@ namespace game
 		Idle,
 	};
 
+	// A DECORATE actor (or old-style) definition, as parsed from an entry
+	struct DecorateDef
+	{
+		string         name;
+		string         class_name;
+		string         parent;
+		string         group;
+		int            ednum      = -1;
+		bool           old_format = false;
+		vector<string> game_filters;
+		PropertyList   props;
+	};
+
+	bool parseDecorate(Archive* archive, vector<DecorateDef>& defs, vector<ArchiveEntry*>& sources);
+	void addDecorateDefs(const vector<DecorateDef>& defs, std::map<int, ThingType>& types, vector<ThingType>& parsed);
 	bool readDecorateDefs(Archive* archive, std::map<int, ThingType>& types, vector<ThingType>& parsed);
 } // namespace game
 } // namespace slade
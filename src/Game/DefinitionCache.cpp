@@ -0,0 +1,559 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    DefinitionCache.cpp
+// Description: Caches parsed DECORATE/ZScript definitions per archive, in
+//              memory and on disk, keyed by the entries they were read from
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "DefinitionCache.h"
+#include "App.h"
+#include "Archive/Archive.h"
+#include "General/Misc.h"
+#include "Utility/BinaryIO.h"
+
+using namespace slade;
+using namespace game;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr uint32_t DEFINITION_CACHE_VERSION = 1;
+
+// An entry that cached definitions were read from
+struct Source
+{
+	string   path;
+	bool     base = false; // True if it's a base entry (ie. not #included)
+	uint32_t size = 0;
+	uint32_t crc  = 0;
+};
+
+// Definitions cached for an archive
+struct CachedDefinitions
+{
+	vector<Source>        sources;
+	vector<ArchiveEntry*> entries; // The entries [sources] were matched to when last checked
+	ArchiveDefinitions    defs;
+};
+
+// MAPINFO parsed for an archive
+struct CachedMapInfo
+{
+	vector<Source>        sources;
+	vector<ArchiveEntry*> entries;
+	MapInfo               info;
+};
+
+std::map<string, CachedDefinitions> definition_cache; // Keyed by cacheKey
+std::map<string, CachedMapInfo>     mapinfo_cache;    // Keyed by cacheKey
+} // namespace
+CVAR(Bool, game_definition_cache, true, CVar::Flag::Save)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Appends the DECORATE definition [def] to [out]
+// -----------------------------------------------------------------------------
+void writeDecorateDef(string& out, const DecorateDef& def)
+{
+	binaryio::writeString(out, def.name);
+	binaryio::writeString(out, def.class_name);
+	binaryio::writeString(out, def.parent);
+	binaryio::writeString(out, def.group);
+	binaryio::writeRaw(out, def.ednum);
+	out += def.old_format ? '\1' : '\0';
+
+	binaryio::writeRaw(out, static_cast<uint32_t>(def.game_filters.size()));
+	for (const auto& filter : def.game_filters)
+		binaryio::writeString(out, filter);
+
+	// Properties (name, type index and value)
+	binaryio::writeRaw(out, static_cast<uint32_t>(def.props.properties().size()));
+	for (const auto& prop : def.props.properties())
+	{
+		binaryio::writeString(out, prop.name());
+		out += static_cast<char>(prop.value.index());
+		switch (property::valueType(prop.value))
+		{
+		case property::ValueType::Bool: out += std::get<bool>(prop.value) ? '\1' : '\0'; break;
+		case property::ValueType::Int: binaryio::writeRaw(out, std::get<int>(prop.value)); break;
+		case property::ValueType::UInt: binaryio::writeRaw(out, std::get<unsigned int>(prop.value)); break;
+		case property::ValueType::Float: binaryio::writeRaw(out, std::get<double>(prop.value)); break;
+		default: binaryio::writeString(out, std::get<string>(prop.value)); break;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads a DECORATE definition written by writeDecorateDef from [mc] into [def]
+// -----------------------------------------------------------------------------
+bool readDecorateDef(MemChunk& mc, DecorateDef& def)
+{
+	uint8_t old_format = 0;
+	if (!binaryio::readString(mc, def.name) || !binaryio::readString(mc, def.class_name) || !binaryio::readString(mc, def.parent)
+		|| !binaryio::readString(mc, def.group) || !mc.read(&def.ednum, sizeof(int)) || !mc.read(&old_format, 1))
+		return false;
+	def.old_format = old_format != 0;
+
+	uint32_t count = 0;
+	if (!binaryio::readCount(mc, count))
+		return false;
+	def.game_filters.resize(count);
+	for (auto& filter : def.game_filters)
+		if (!binaryio::readString(mc, filter))
+			return false;
+
+	// Properties
+	if (!binaryio::readCount(mc, count))
+		return false;
+	for (uint32_t a = 0; a < count; a++)
+	{
+		string  name;
+		uint8_t type = 0;
+		if (!binaryio::readString(mc, name) || !mc.read(&type, 1))
+			return false;
+
+		bool  ok   = true;
+		auto& prop = def.props[name];
+		switch (static_cast<property::ValueType>(type))
+		{
+		case property::ValueType::Bool:
+		{
+			uint8_t value = 0;
+			ok            = mc.read(&value, 1);
+			prop          = value != 0;
+			break;
+		}
+		case property::ValueType::Int:
+		{
+			int value = 0;
+			ok        = mc.read(&value, sizeof(int));
+			prop      = value;
+			break;
+		}
+		case property::ValueType::UInt:
+		{
+			unsigned int value = 0;
+			ok                 = mc.read(&value, sizeof(unsigned int));
+			prop               = value;
+			break;
+		}
+		case property::ValueType::Float:
+		{
+			double value = 0;
+			ok           = mc.read(&value, sizeof(double));
+			prop         = value;
+			break;
+		}
+		case property::ValueType::String:
+		{
+			string value;
+			ok   = binaryio::readString(mc, value);
+			prop = std::move(value);
+			break;
+		}
+		default: return false;
+		}
+
+		if (!ok)
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Appends the ZScript [statement] (and its block) to [out]. The statement's
+// entry is written as its index in [entry_index]
+// -----------------------------------------------------------------------------
+void writeStatement(
+	string&                                  out,
+	const zscript::ParsedStatement&          statement,
+	const std::map<ArchiveEntry*, uint32_t>& entry_index)
+{
+	auto entry = entry_index.find(statement.entry);
+	binaryio::writeRaw(out, entry == entry_index.end() ? UINT32_MAX : entry->second);
+	binaryio::writeRaw(out, static_cast<uint32_t>(statement.line));
+
+	binaryio::writeRaw(out, static_cast<uint32_t>(statement.tokens.size()));
+	for (const auto& token : statement.tokens)
+		binaryio::writeString(out, token);
+
+	binaryio::writeRaw(out, static_cast<uint32_t>(statement.block.size()));
+	for (const auto& child : statement.block)
+		writeStatement(out, child, entry_index);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a ZScript statement written by writeStatement from [mc] into
+// [statement], with its entry looked up in [entries]
+// -----------------------------------------------------------------------------
+bool readStatement(MemChunk& mc, zscript::ParsedStatement& statement, const vector<ArchiveEntry*>& entries)
+{
+	uint32_t entry = 0, line = 0, count = 0;
+	if (!mc.read(&entry, 4) || !mc.read(&line, 4))
+		return false;
+	statement.entry = entry < entries.size() ? entries[entry] : nullptr;
+	statement.line  = line;
+
+	if (!binaryio::readCount(mc, count))
+		return false;
+	statement.tokens.resize(count);
+	string token;
+	for (auto& interned : statement.tokens)
+	{
+		if (!binaryio::readString(mc, token))
+			return false;
+		interned = zscript::internToken(token);
+	}
+
+	if (!binaryio::readCount(mc, count))
+		return false;
+	statement.block.resize(count);
+	for (auto& child : statement.block)
+		if (!readStatement(mc, child, entries))
+			return false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the in-memory cache key for [archive] (its filename, or its address
+// if it hasn't been saved to a file)
+// -----------------------------------------------------------------------------
+string cacheKey(Archive* archive)
+{
+	auto filename = archive->filename();
+	return filename.empty() ? fmt::format("<{}>", static_cast<void*>(archive)) : filename;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the base DECORATE and ZScript entries in [archive], in the order
+// they are parsed
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> baseEntries(Archive* archive)
+{
+	Archive::SearchOptions opt;
+	opt.ignore_ext = true;
+	opt.match_name = "decorate";
+	auto entries   = archive->findAll(opt);
+
+	opt.match_name = "zscript";
+	for (auto entry : archive->findAll(opt))
+		entries.push_back(entry);
+
+	return entries;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the *MAPINFO entries in the root of [archive] (any of which can be
+// read by MapInfo::readMapInfo)
+// -----------------------------------------------------------------------------
+vector<ArchiveEntry*> mapInfoEntries(Archive* archive)
+{
+	vector<ArchiveEntry*> entries;
+	for (const auto& entry : archive->rootDir()->entries())
+	{
+		auto& type = entry->type()->id();
+		if (type == "zmapinfo" || type == "mapinfo" || type == "emapinfo")
+			entries.push_back(entry.get());
+	}
+
+	return entries;
+}
+
+// -----------------------------------------------------------------------------
+// Finds the entries in [archive] matching [sources], adding them to
+// [entries]. Returns false if any source is missing or has changed, or there
+// are [base] entries that aren't in [sources]
+// -----------------------------------------------------------------------------
+bool matchSources(
+	Archive*                     archive,
+	const vector<ArchiveEntry*>& base,
+	const vector<Source>&        sources,
+	vector<ArchiveEntry*>&       entries)
+{
+	unsigned n_base = 0;
+
+	entries.clear();
+	for (const auto& source : sources)
+	{
+		ArchiveEntry* entry = nullptr;
+		if (source.base)
+			entry = n_base < base.size() ? base[n_base++] : nullptr;
+		else
+			entry = archive->entryAtPath(source.path);
+
+		if (!entry || entry->size() != source.size || entry->path(true) != source.path
+			|| entry->data().crc() != source.crc)
+			return false;
+
+		entries.push_back(entry);
+	}
+
+	return n_base == base.size();
+}
+
+// -----------------------------------------------------------------------------
+// Records the entries in [read] as [sources], flagging those that are [base]
+// entries (in order)
+// -----------------------------------------------------------------------------
+void recordSources(const vector<ArchiveEntry*>& base, const vector<ArchiveEntry*>& read, vector<Source>& sources)
+{
+	unsigned n_base = 0;
+	for (auto entry : read)
+	{
+		auto is_base = n_base < base.size() && base[n_base] == entry;
+		if (is_base)
+			++n_base;
+
+		sources.push_back({ entry->path(true), is_base, entry->size(), entry->data().crc() });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the path to the disk cache file for the archive at [filename]
+// -----------------------------------------------------------------------------
+string cachePath(const string& filename)
+{
+	auto crc = misc::crc(reinterpret_cast<const uint8_t*>(filename.data()), filename.size());
+	return app::path(fmt::format("definition_cache/{:08x}.defbin", crc), app::Dir::User);
+}
+
+// -----------------------------------------------------------------------------
+// Loads the cached definitions for [archive] from the disk cache into
+// [cached]. Returns false if there is no cache file or it is out of date
+// -----------------------------------------------------------------------------
+bool loadDiskCache(Archive* archive, CachedDefinitions& cached)
+{
+	auto     filename = archive->filename();
+	auto     path     = cachePath(filename);
+	MemChunk mc;
+	if (!wxFileExists(path) || !mc.importFile(path))
+		return false;
+
+	// Check header (version and archive filename)
+	char     magic[4];
+	uint32_t version = 0;
+	string   cache_filename;
+	if (!mc.read(magic, 4) || memcmp(magic, "SDEF", 4) != 0 || !mc.read(&version, 4)
+		|| version != DEFINITION_CACHE_VERSION || !binaryio::readString(mc, cache_filename) || cache_filename != filename)
+		return false;
+
+	// Sources
+	uint32_t count = 0;
+	if (!binaryio::readCount(mc, count))
+		return false;
+	cached.sources.resize(count);
+	for (auto& source : cached.sources)
+	{
+		uint8_t base = 0;
+		if (!binaryio::readString(mc, source.path) || !mc.read(&base, 1) || !mc.read(&source.size, 4)
+			|| !mc.read(&source.crc, 4))
+			return false;
+		source.base = base != 0;
+	}
+	if (!matchSources(archive, baseEntries(archive), cached.sources, cached.entries))
+		return false;
+
+	// DECORATE
+	if (!binaryio::readCount(mc, count))
+		return false;
+	cached.defs.decorate.resize(count);
+	for (auto& def : cached.defs.decorate)
+		if (!readDecorateDef(mc, def))
+			return false;
+
+	// ZScript
+	if (!binaryio::readCount(mc, count))
+		return false;
+	cached.defs.zscript.resize(count);
+	for (auto& blocks : cached.defs.zscript)
+	{
+		uint32_t n_blocks = 0;
+		if (!binaryio::readCount(mc, n_blocks))
+			return false;
+		blocks.resize(n_blocks);
+		for (auto& block : blocks)
+			if (!readStatement(mc, block, cached.entries))
+				return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the [cached] definitions for [archive] to the disk cache
+// -----------------------------------------------------------------------------
+void saveDiskCache(Archive* archive, const CachedDefinitions& cached)
+{
+	auto dir = app::path("definition_cache", app::Dir::User);
+	if (!wxDirExists(dir))
+		wxMkdir(dir);
+
+	string out = "SDEF";
+	binaryio::writeRaw(out, DEFINITION_CACHE_VERSION);
+	binaryio::writeString(out, archive->filename());
+
+	// Sources
+	std::map<ArchiveEntry*, uint32_t> entry_index;
+	binaryio::writeRaw(out, static_cast<uint32_t>(cached.sources.size()));
+	for (unsigned a = 0; a < cached.sources.size(); ++a)
+	{
+		auto& source = cached.sources[a];
+		binaryio::writeString(out, source.path);
+		out += source.base ? '\1' : '\0';
+		binaryio::writeRaw(out, source.size);
+		binaryio::writeRaw(out, source.crc);
+		entry_index.emplace(cached.entries[a], a);
+	}
+
+	// DECORATE
+	binaryio::writeRaw(out, static_cast<uint32_t>(cached.defs.decorate.size()));
+	for (const auto& def : cached.defs.decorate)
+		writeDecorateDef(out, def);
+
+	// ZScript
+	binaryio::writeRaw(out, static_cast<uint32_t>(cached.defs.zscript.size()));
+	for (const auto& blocks : cached.defs.zscript)
+	{
+		binaryio::writeRaw(out, static_cast<uint32_t>(blocks.size()));
+		for (const auto& block : blocks)
+			writeStatement(out, block, entry_index);
+	}
+
+	auto     path = cachePath(archive->filename());
+	MemChunk mc(reinterpret_cast<const uint8_t*>(out.data()), out.size());
+	if (!mc.exportFile(path))
+		log::warning("Unable to write definition cache file {}", path);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Game Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the parsed DECORATE and ZScript definitions in [archive].
+// These are only re-parsed if any of the entries they were read from have
+// changed since they were last parsed (or written to the disk cache)
+// -----------------------------------------------------------------------------
+ArchiveDefinitions& game::archiveDefinitions(Archive* archive)
+{
+	auto  filename = archive->filename();
+	auto& cached   = definition_cache[cacheKey(archive)];
+
+	// Check in-memory cache
+	vector<ArchiveEntry*> entries;
+	if (matchSources(archive, baseEntries(archive), cached.sources, entries) && entries == cached.entries)
+		return cached.defs;
+
+	// Check disk cache
+	auto use_disk = game_definition_cache && !filename.empty();
+	cached        = {};
+	if (use_disk && loadDiskCache(archive, cached))
+	{
+		log::info(2, "Using cached definitions for archive {}", filename);
+		return cached.defs;
+	}
+
+	// Parse definitions
+	cached = {};
+	parseDecorate(archive, cached.defs.decorate, cached.entries);
+	zscript::parseBlocks(archive, cached.defs.zscript, cached.entries);
+
+	// Record the entries they were read from
+	recordSources(baseEntries(archive), cached.entries, cached.sources);
+
+	if (use_disk && !cached.sources.empty())
+		saveDiskCache(archive, cached);
+
+	return cached.defs;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the parsed *MAPINFO definitions in [archive].
+// These are only re-parsed if any of the entries they were read from (or any
+// *MAPINFO entry in the archive) have changed since they were last parsed
+// -----------------------------------------------------------------------------
+const MapInfo& game::archiveMapInfo(Archive* archive)
+{
+	auto& cached = mapinfo_cache[cacheKey(archive)];
+	auto  base   = mapInfoEntries(archive);
+
+	// Check cache
+	vector<ArchiveEntry*> entries;
+	if (matchSources(archive, base, cached.sources, entries) && entries == cached.entries)
+		return cached.info;
+
+	// Parse MAPINFO, recording all *MAPINFO entries as sources (rather than
+	// just the one read) so that any additions or changes are picked up
+	cached = {};
+	vector<ArchiveEntry*> read;
+	cached.info.readMapInfo(*archive, &read);
+	cached.entries = base;
+	for (auto entry : read)
+		if (std::find(base.begin(), base.end(), entry) == base.end())
+			cached.entries.push_back(entry);
+	recordSources(base, cached.entries, cached.sources);
+
+	return cached.info;
+}
+
+// -----------------------------------------------------------------------------
+// Removes in-memory cached definitions and MAPINFO for any archives not in
+// [archives] (their disk cache is kept)
+// -----------------------------------------------------------------------------
+void game::pruneDefinitionCache(const vector<Archive*>& archives)
+{
+	auto isOpen = [&](const string& key) {
+		return std::any_of(
+			archives.begin(), archives.end(), [&](Archive* archive) { return cacheKey(archive) == key; });
+	};
+
+	for (auto i = definition_cache.begin(); i != definition_cache.end();)
+		i = isOpen(i->first) ? std::next(i) : definition_cache.erase(i);
+	for (auto i = mapinfo_cache.begin(); i != mapinfo_cache.end();)
+		i = isOpen(i->first) ? std::next(i) : mapinfo_cache.erase(i);
+}
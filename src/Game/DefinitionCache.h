@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Decorate.h"
+#include "MapInfo.h"
+#include "ZScript.h"
+
+namespace slade
+{
+class Archive;
+
+namespace game
+{
+	// DECORATE and ZScript definitions parsed from an archive
+	struct ArchiveDefinitions
+	{
+		vector<DecorateDef>                      decorate;
+		vector<vector<zscript::ParsedStatement>> zscript; // Statements/blocks for each base ZScript entry
+	};
+
+	ArchiveDefinitions& archiveDefinitions(Archive* archive);
+	const MapInfo&      archiveMapInfo(Archive* archive);
+	void                pruneDefinitionCache(const vector<Archive*>& archives);
+} // namespace game
+} // namespace slade
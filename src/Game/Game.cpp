@@ -36,11 +36,12 @@
 #include "Archive/ArchiveManager.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "Configuration.h"
+#include "DefinitionCache.h"
 #include "TextEditor/TextLanguage.h"
 #include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "ZScript.h"
-#include <thread>
 
 using namespace slade;
 using namespace game;
@@ -60,7 +61,8 @@ std::map<string, PortDef> port_defs;
 PortDef                   port_def_unknown;
 zscript::Definitions      zscript_base;
 zscript::Definitions      zscript_custom;
-unique_ptr<std::thread>   zscript_parse_thread;
+MapInfo                   mapinfo_base; // *MAPINFO in zdoom.pk3
+shared_ptr<Job>           zscript_base_job;
 } // namespace slade::game
 CVAR(String, game_configuration, "", CVar::Flag::Save)
 CVAR(String, port_configuration, "", CVar::Flag::Save)
@@ -228,37 +230,52 @@ Configuration& game::configuration()
 }
 
 // -----------------------------------------------------------------------------
-// Clears and re-parses custom definitions in all open archives
-// (DECORATE, *MAPINFO, ZScript etc.)
+// Clears and re-reads custom definitions in all open archives
+// (DECORATE, *MAPINFO, ZScript etc.). Definitions are only re-parsed for
+// archives where they have changed (see archiveDefinitions/archiveMapInfo)
 // -----------------------------------------------------------------------------
 void game::updateCustomDefinitions()
 {
 	// Clear out all existing custom definitions
 	config_current.clearDecorateDefs();
 	config_current.clearMapInfo();
+	config_current.addMapInfo(mapinfo_base);
 	zscript_custom.clear();
 
-	// Parse custom definitions in base resource
-	auto base_resource = app::archiveManager().baseResourceArchive();
+	auto base_resource     = app::archiveManager().baseResourceArchive();
+	auto resource_archives = app::archiveManager().allArchives(true);
+
+	// Get (cached) parsed DECORATE and ZScript definitions in all resource archives
+	vector<Archive*> archives;
+	if (base_resource)
+		archives.push_back(base_resource);
+	for (const auto& archive : resource_archives)
+		archives.push_back(archive.get());
+	pruneDefinitionCache(archives);
+	vector<ArchiveDefinitions*> defs;
+	for (auto archive : archives)
+		defs.push_back(&archiveDefinitions(archive));
+
+	// Add custom definitions in base resource
 	if (base_resource)
 	{
-		zscript_custom.parseZScript(base_resource);
-		config_current.parseDecorateDefs(base_resource);
-		config_current.parseMapInfo(*base_resource);
+		for (auto& blocks : defs[0]->zscript)
+			zscript_custom.parseStatements(blocks);
+		config_current.addDecorateDefs(defs[0]->decorate);
+		config_current.addMapInfo(archiveMapInfo(base_resource));
 	}
 
-	// Parse custom definitions in all resource archives
-	auto resource_archives = app::archiveManager().allArchives(true);
-
-	// ZScript first
-	for (const auto& archive : resource_archives)
-		zscript_custom.parseZScript(archive.get());
+	// Add custom definitions in all resource archives, ZScript first
+	auto first = base_resource ? 1u : 0u;
+	for (auto a = first; a < archives.size(); ++a)
+		for (auto& blocks : defs[a]->zscript)
+			zscript_custom.parseStatements(blocks);
 
 	// Other definitions
-	for (const auto& archive : resource_archives)
+	for (auto a = first; a < archives.size(); ++a)
 	{
-		config_current.parseDecorateDefs(archive.get());
-		config_current.parseMapInfo(*archive);
+		config_current.addDecorateDefs(defs[a]->decorate);
+		config_current.addMapInfo(archiveMapInfo(archives[a]));
 	}
 
 	// Process custom definitions
@@ -412,32 +429,51 @@ void game::init()
 	// Load zdoom.pk3 stuff
 	if (wxFileExists(zdoom_pk3_path))
 	{
-		zscript_parse_thread = std::make_unique<std::thread>([=]() {
-			ZipArchive zdoom_pk3;
-			if (!zdoom_pk3.open(zdoom_pk3_path))
+		// Open and parse zdoom.pk3 ZScript and MAPINFO in the background. Everything
+		// shared (the ZScript text language and current configuration) is only updated
+		// once it's done, on the main thread
+		struct ZScriptBase
+		{
+			ZipArchive           pk3;
+			zscript::Definitions defs;
+			MapInfo              mapinfo;
+			bool                 parsed = false;
+		};
+		auto   base = std::make_shared<ZScriptBase>();
+		string path = zdoom_pk3_path;
+
+		zscript_base_job = Job::start([base, path](Job& job) {
+			if (!base->pk3.open(path) || job.cancelled())
 				return;
 
 			// ZScript
-			auto zscript_entry = zdoom_pk3.entryAtPath("zscript.txt");
-
+			auto zscript_entry = base->pk3.entryAtPath("zscript.txt");
 			if (!zscript_entry)
 			{
 				// Bail out if no entry is found.
-				log::warning(1, "Could not find \'zscript.txt\' in " + zdoom_pk3_path);
+				log::warning(1, "Could not find \'zscript.txt\' in " + path);
+				return;
 			}
-			else
-			{
-				zscript_base.parseZScript(zscript_entry);
 
-				auto lang = TextLanguage::fromId("zscript");
-				if (lang)
-					lang->loadZScript(zscript_base);
+			base->defs.parseZScript(zscript_entry);
+			base->mapinfo.readMapInfo(base->pk3);
+			base->parsed = true;
+		});
 
-				// MapInfo
-				config_current.parseMapInfo(zdoom_pk3);
-			}
+		zscript_base_job->onComplete([base]() {
+			if (!base->parsed)
+				return;
+
+			zscript_base = std::move(base->defs);
+			mapinfo_base = std::move(base->mapinfo);
+
+			auto lang = TextLanguage::fromId("zscript");
+			if (lang)
+				lang->loadZScript(zscript_base);
+
+			// Re-add custom definitions on top of the zdoom.pk3 MAPINFO
+			updateCustomDefinitions();
 		});
-		zscript_parse_thread->detach();
 	}
 
 	// Update custom definitions when an archive is opened or closed
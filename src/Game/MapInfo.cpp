@@ -54,7 +54,8 @@ void MapInfo::clear(bool maps, bool editor_nums)
 	if (maps)
 	{
 		maps_.clear();
-		default_map_ = {};
+		default_map_     = {};
+		has_default_map_ = false;
 	}
 
 	if (editor_nums)
@@ -76,7 +77,7 @@ MapInfo::Map& MapInfo::getMap(string_view name)
 // -----------------------------------------------------------------------------
 // Adds [map] info, or updates the existing map info if it exists
 // -----------------------------------------------------------------------------
-bool MapInfo::addOrUpdateMap(Map& map)
+bool MapInfo::addOrUpdateMap(const Map& map)
 {
 	for (auto& m : maps_)
 		if (m.entry_name == map.entry_name)
@@ -104,15 +105,16 @@ int MapInfo::doomEdNumForClass(string_view actor_class)
 }
 
 // -----------------------------------------------------------------------------
-// Reads and parses all MAPINFO entries in [archive]
+// Reads and parses all MAPINFO entries in [archive].
+// All entries read (including includes) are added to [sources] if given
 // -----------------------------------------------------------------------------
-bool MapInfo::readMapInfo(const Archive& archive)
+bool MapInfo::readMapInfo(const Archive& archive, vector<ArchiveEntry*>* sources)
 {
 	for (const auto& entry : archive.rootDir()->entries())
 	{
 		// ZMapInfo
 		if (entry->type()->id() == "zmapinfo")
-			return parseZMapInfo(entry.get());
+			return parseZMapInfo(entry.get(), sources);
 
 		// TODO: EMapInfo
 		if (entry->type()->id() == "emapinfo")
@@ -126,7 +128,7 @@ bool MapInfo::readMapInfo(const Archive& archive)
 			{
 			case Format::Hexen:
 			case Format::ZDoomOld: log::info("MAPINFO (Hexen/Old ZDoom) parsing not yet implemented"); break;
-			case Format::ZDoomNew: return parseZMapInfo(entry.get());
+			case Format::ZDoomNew: return parseZMapInfo(entry.get(), sources);
 			case Format::Eternity: log::info("EMAPINFO parsing not yet implemented"); break;
 			case Format::Universal: log::info("UMAPINFO parsing not yet implemented"); break;
 			default: break;
@@ -137,6 +139,25 @@ bool MapInfo::readMapInfo(const Archive& archive)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Adds all maps and DoomEdNums from [other], replacing any that already exist
+// (as if [other]'s MAPINFO was parsed after this)
+// -----------------------------------------------------------------------------
+void MapInfo::merge(const MapInfo& other)
+{
+	for (const auto& map : other.maps_)
+		addOrUpdateMap(map);
+
+	if (other.has_default_map_)
+	{
+		default_map_     = other.default_map_;
+		has_default_map_ = true;
+	}
+
+	for (const auto& num : other.editor_nums_)
+		editor_nums_[num.first] = num.second;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if the next token in [tz] is '='. If not, logs an error message
 // -----------------------------------------------------------------------------
@@ -182,10 +203,14 @@ bool MapInfo::strToCol(const string& str, ColRGBA& col) const
 }
 
 // -----------------------------------------------------------------------------
-// Parses ZMAPINFO-format definitions in [entry]
+// Parses ZMAPINFO-format definitions in [entry].
+// [entry] and any entries it includes are added to [sources] if given
 // -----------------------------------------------------------------------------
-bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
+bool MapInfo::parseZMapInfo(ArchiveEntry* entry, vector<ArchiveEntry*>* sources)
 {
+	if (sources)
+		sources->push_back(entry);
+
 	Tokenizer tz;
 	tz.setReadLowerCase(true);
 	tz.openMem(entry->data(), entry->name());
@@ -206,7 +231,7 @@ bool MapInfo::parseZMapInfo(ArchiveEntry* entry)
 					tz.current().text,
 					tz.lineNo());
 			}
-			else if (!parseZMapInfo(include_entry))
+			else if (!parseZMapInfo(include_entry, sources))
 				return false;
 		}
 
@@ -430,7 +455,10 @@ bool MapInfo::parseZMap(Tokenizer& tz, string_view type)
 			maps_.push_back(map);
 	}
 	else if (type == "defaultmap")
-		default_map_ = map;
+	{
+		default_map_     = map;
+		has_default_map_ = true;
+	}
 
 	return true;
 }
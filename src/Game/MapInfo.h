@@ -65,7 +65,7 @@ namespace game
 		// Maps access
 		const vector<Map>& maps() const { return maps_; }
 		Map&               getMap(string_view name);
-		bool               addOrUpdateMap(Map& map);
+		bool               addOrUpdateMap(const Map& map);
 
 		// DoomEdNum access
 		const DoomEdNumMap& doomEdNums() const { return editor_nums_; }
@@ -73,14 +73,15 @@ namespace game
 		int                 doomEdNumForClass(string_view actor_class);
 
 		// MAPINFO loading
-		bool readMapInfo(const Archive& archive);
+		bool readMapInfo(const Archive& archive, vector<ArchiveEntry*>* sources = nullptr);
+		void merge(const MapInfo& other);
 
 		// General parsing helpers
 		bool checkEqualsToken(Tokenizer& tz, string_view parsing) const;
 		bool strToCol(const string& str, ColRGBA& col) const;
 
 		// ZDoom MAPINFO parsing
-		bool parseZMapInfo(ArchiveEntry* entry);
+		bool parseZMapInfo(ArchiveEntry* entry, vector<ArchiveEntry*>* sources = nullptr);
 		bool parseZMap(Tokenizer& tz, string_view type);
 		bool parseDoomEdNums(Tokenizer& tz);
 
@@ -93,6 +94,7 @@ namespace game
 	private:
 		vector<Map>  maps_;
 		Map          default_map_;
+		bool         has_default_map_ = false; // True if default_map_ was set by a 'defaultmap' definition
 		DoomEdNumMap editor_nums_;
 	};
 } // namespace game
@@ -35,7 +35,9 @@
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
 #include "Utility/StringUtils.h"
-#include "Utility/Tokenizer.h"
+#include <deque>
+#include <mutex>
+#include <unordered_set>
 
 using namespace slade;
 using namespace zscript;
@@ -64,6 +66,26 @@ bool dump_parsed_states    = false;
 bool dump_parsed_functions = false;
 
 string db_comment = "//$";
+
+// Interned token text (see internToken), never freed
+struct TokenPool
+{
+	std::mutex                      mutex;
+	vector<std::unique_ptr<char[]>> blocks;
+	size_t                          block_size = 0;
+	size_t                          block_used = 0;
+	std::unordered_set<string_view> tokens;
+};
+TokenPool          token_pool;
+constexpr unsigned TOKEN_POOL_BLOCK_SIZE = 65536;
+
+// Character classes for TokenStream
+enum CharClass : uint8_t
+{
+	Normal,
+	Whitespace,
+	Special
+};
 } // namespace slade::zscript
 
 
@@ -74,6 +96,50 @@ string db_comment = "//$";
 // -----------------------------------------------------------------------------
 namespace slade::zscript
 {
+// -----------------------------------------------------------------------------
+// Returns the (CharClass) lookup table for all 256 characters
+// -----------------------------------------------------------------------------
+const std::array<uint8_t, 256>& charClasses()
+{
+	static auto classes = []() {
+		std::array<uint8_t, 256> table{};
+		for (auto c : string_view{ " \t\r\n" })
+			table[static_cast<uint8_t>(c)] = Whitespace;
+		for (auto c : string_view{ ";,:|={}/()+-[]&!?." })
+			table[static_cast<uint8_t>(c)] = Special;
+		return table;
+	}();
+
+	return classes;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [text] interned in the token pool, token_pool.mutex must be locked
+// -----------------------------------------------------------------------------
+string_view internLocked(string_view text)
+{
+	if (text.empty())
+		return {};
+
+	auto existing = token_pool.tokens.find(text);
+	if (existing != token_pool.tokens.end())
+		return *existing;
+
+	// Start a new block if needed
+	if (token_pool.block_used + text.size() > token_pool.block_size)
+	{
+		token_pool.block_size = std::max<size_t>(TOKEN_POOL_BLOCK_SIZE, text.size());
+		token_pool.block_used = 0;
+		token_pool.blocks.push_back(std::make_unique<char[]>(token_pool.block_size));
+	}
+
+	auto data = token_pool.blocks.back().get() + token_pool.block_used;
+	memcpy(data, text.data(), text.size());
+	token_pool.block_used += text.size();
+
+	return *token_pool.tokens.emplace(data, text.size()).first;
+}
+
 // -----------------------------------------------------------------------------
 // Writes a log [message] of [type] beginning with the location of [statement]
 // -----------------------------------------------------------------------------
@@ -89,7 +155,7 @@ void logParserMessage(ParsedStatement& statement, log::MessageType type, string_
 // -----------------------------------------------------------------------------
 // Parses a ZScript type (eg. 'class<Actor>') from [tokens] beginning at [index]
 // -----------------------------------------------------------------------------
-string parseType(const vector<string>& tokens, unsigned& index)
+string parseType(const vector<string_view>& tokens, unsigned& index)
 {
 	string type;
 
@@ -105,18 +171,18 @@ string parseType(const vector<string>& tokens, unsigned& index)
 	type += tokens[index];
 
 	// Check for ...
-	if (index + 2 < tokens.size() && tokens[index] == '.' && tokens[index + 1] == '.' && tokens[index + 2] == '.')
+	if (index + 2 < tokens.size() && tokens[index] == "." && tokens[index + 1] == "." && tokens[index + 2] == ".")
 	{
 		type = "...";
 		index += 2;
 	}
 
 	// Check for <>
-	if (tokens[index + 1] == '<')
+	if (tokens[index + 1] == "<")
 	{
 		type += '<';
 		index += 2;
-		while (index < tokens.size() && tokens[index] != '>')
+		while (index < tokens.size() && tokens[index] != ">")
 			type += tokens[index++];
 		type += '>';
 		++index;
@@ -130,21 +196,21 @@ string parseType(const vector<string>& tokens, unsigned& index)
 // -----------------------------------------------------------------------------
 // Parses a ZScript value from [tokens] beginning at [index]
 // -----------------------------------------------------------------------------
-string parseValue(const vector<string>& tokens, unsigned& index)
+string parseValue(const vector<string_view>& tokens, unsigned& index)
 {
 	string value;
 	while (true)
 	{
 		// Read between ()
-		if (tokens[index] == '(')
+		if (tokens[index] == "(")
 		{
 			int level = 1;
 			value += tokens[index++];
 			while (level > 0)
 			{
-				if (tokens[index] == '(')
+				if (tokens[index] == "(")
 					++level;
-				if (tokens[index] == ')')
+				if (tokens[index] == ")")
 					--level;
 
 				value += tokens[index++];
@@ -153,7 +219,7 @@ string parseValue(const vector<string>& tokens, unsigned& index)
 			continue;
 		}
 
-		if (tokens[index] == ',' || tokens[index] == ';' || tokens[index] == ')')
+		if (tokens[index] == "," || tokens[index] == ";" || tokens[index] == ")")
 			break;
 
 		value += tokens[index++];
@@ -171,12 +237,12 @@ string parseValue(const vector<string>& tokens, unsigned& index)
 // Returns true if there is a keyword+value statement and writes the value to
 // [value]
 // -----------------------------------------------------------------------------
-bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, string_view word, string& value)
+bool checkKeywordValueStatement(const vector<string_view>& tokens, unsigned index, string_view word, string& value)
 {
 	if (index + 3 >= tokens.size())
 		return false;
 
-	if (strutil::equalCI(tokens[index], word) && tokens[index + 1] == '(' && tokens[index + 3] == ')')
+	if (strutil::equalCI(tokens[index], word) && tokens[index + 1] == "(" && tokens[index + 3] == ")")
 	{
 		value = tokens[index + 2];
 		return true;
@@ -186,26 +252,31 @@ bool checkKeywordValueStatement(const vector<string>& tokens, unsigned index, st
 }
 
 // -----------------------------------------------------------------------------
-// Parses all statements/blocks in [entry], adding them to [parsed]
+// Parses all statements/blocks in [entry], adding them to [parsed].
+// [entry] and any entries it #includes are added to [sources] if given
 // -----------------------------------------------------------------------------
-void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<ArchiveEntry*>& entry_stack)
+void parseBlocks(
+	ArchiveEntry*            entry,
+	vector<ParsedStatement>& parsed,
+	vector<ArchiveEntry*>&   entry_stack,
+	vector<ArchiveEntry*>*   sources = nullptr)
 {
-	Tokenizer tz;
-	tz.setSpecialCharacters(Tokenizer::DEFAULT_SPECIAL_CHARACTERS + "()+-[]&!?.");
-	tz.enableDecorate(true);
-	tz.setCommentTypes(Tokenizer::CommentTypes::CPPStyle | Tokenizer::CommentTypes::CStyle);
-	tz.openMem(entry->data(), "ZScript");
+	auto&       data = entry->data();
+	TokenStream ts{ { reinterpret_cast<const char*>(data.data()), data.size() } };
 
 	entry_stack.push_back(entry);
+	if (sources)
+		sources->push_back(entry);
 
-	while (!tz.atEnd())
+	while (!ts.atEnd())
 	{
 		// Preprocessor
-		if (strutil::startsWith(tz.current().text, '#'))
+		if (strutil::startsWith(ts.current().text, '#'))
 		{
-			if (tz.checkNC("#include"))
+			if (strutil::equalCI(ts.current().text, "#include"))
 			{
-				auto inc_entry = entry->relativeEntry(tz.next().text);
+				ts.adv();
+				auto inc_entry = entry->relativeEntry(ts.current().text);
 
 				// Check #include path could be resolved
 				if (!inc_entry)
@@ -214,8 +285,8 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 						"Warning parsing ZScript entry {}: "
 						"Unable to find #included entry \"{}\" at line {}, skipping",
 						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
+						ts.current().text,
+						ts.current().line);
 				}
 				else if (VECTOR_EXISTS(entry_stack, inc_entry))
 				{
@@ -223,28 +294,28 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 						"Warning parsing ZScript entry {}: "
 						"Detected circular #include \"{}\" on line {}, skipping",
 						entry->name(),
-						tz.current().text,
-						tz.current().line_no);
+						ts.current().text,
+						ts.current().line);
 				}
 				else
-					parseBlocks(inc_entry, parsed, entry_stack);
+					parseBlocks(inc_entry, parsed, entry_stack, sources);
 			}
 
-			tz.advToNextLine();
+			ts.advToNextLine();
 			continue;
 		}
 
 		// Version
-		else if (tz.checkNC("version"))
+		else if (strutil::equalCI(ts.current().text, "version"))
 		{
-			tz.advToNextLine();
+			ts.advToNextLine();
 			continue;
 		}
 
 		// ZScript
 		parsed.push_back({});
 		parsed.back().entry = entry;
-		if (!parsed.back().parse(tz))
+		if (!parsed.back().parse(ts))
 			parsed.pop_back();
 	}
 
@@ -255,6 +326,39 @@ void parseBlocks(ArchiveEntry* entry, vector<ParsedStatement>& parsed, vector<Ar
 	entry_stack.pop_back();
 }
 
+// -----------------------------------------------------------------------------
+// Parses all statements/blocks in the ZScript entries in [archive], adding
+// them to [entry_blocks] (one list of blocks per base ZScript entry).
+// All entries read (including #includes) are added to [sources]
+// -----------------------------------------------------------------------------
+bool parseBlocks(Archive* archive, vector<vector<ParsedStatement>>& entry_blocks, vector<ArchiveEntry*>& sources)
+{
+	// Get base ZScript file
+	Archive::SearchOptions opt;
+	opt.match_name      = "zscript";
+	opt.ignore_ext      = true;
+	auto zscript_enries = archive->findAll(opt);
+	if (zscript_enries.empty())
+		return false;
+
+	log::info(2, "Parsing ZScript entries found in archive {}", archive->filename());
+
+	// Get ZScript entry type (all parsed ZScript entries will be set to this)
+	etype_zscript = EntryType::fromId("zscript");
+	if (etype_zscript == EntryType::unknownType())
+		etype_zscript = nullptr;
+
+	// Parse ZScript entries
+	for (auto entry : zscript_enries)
+	{
+		vector<ArchiveEntry*> entry_stack;
+		entry_blocks.emplace_back();
+		parseBlocks(entry, entry_blocks.back(), entry_stack, &sources);
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if [word] is a ZScript keyword
 // -----------------------------------------------------------------------------
@@ -300,11 +404,11 @@ bool Enumerator::parse(ParsedStatement& statement)
 
 		// TODO: Parse value
 
-		values_.push_back({ val_name, 0 });
+		values_.push_back({ string{ val_name }, 0 });
 
 		// Skip past next ,
 		while (index + 1 < count)
-			if (statement.block[0].tokens[++index] == ',')
+			if (statement.block[0].tokens[++index] == ",")
 				break;
 
 		index++;
@@ -324,7 +428,7 @@ bool Enumerator::parse(ParsedStatement& statement)
 // -----------------------------------------------------------------------------
 // Parses a function parameter from [tokens] beginning at [index]
 // -----------------------------------------------------------------------------
-unsigned Function::Parameter::parse(const vector<string>& tokens, unsigned start_index)
+unsigned Function::Parameter::parse(const vector<string_view>& tokens, unsigned start_index)
 {
 	// Type
 	type = parseType(tokens, start_index);
@@ -338,12 +442,12 @@ unsigned Function::Parameter::parse(const vector<string>& tokens, unsigned start
 	}
 
 	// Name
-	if (start_index >= tokens.size() || tokens[start_index] == ')')
+	if (start_index >= tokens.size() || tokens[start_index] == ")")
 		return start_index;
 	name = tokens[start_index++];
 
 	// Default value
-	if (start_index < tokens.size() && tokens[start_index] == '=')
+	if (start_index < tokens.size() && tokens[start_index] == "=")
 	{
 		++start_index;
 		default_value = parseValue(tokens, start_index);
@@ -386,7 +490,7 @@ bool Function::parse(ParsedStatement& statement)
 			override_      = true;
 			last_qualifier = index;
 		}
-		else if ((int)index > last_qualifier + 2 && statement.tokens[index] == '(')
+		else if ((int)index > last_qualifier + 2 && statement.tokens[index] == "(")
 		{
 			name_        = statement.tokens[index - 1];
 			return_type_ = statement.tokens[index - 2];
@@ -412,7 +516,7 @@ bool Function::parse(ParsedStatement& statement)
 	}
 
 	// Parse parameters
-	while (statement.tokens[index] != '(')
+	while (statement.tokens[index] != "(")
 	{
 		if (index == statement.tokens.size())
 			return true;
@@ -420,12 +524,12 @@ bool Function::parse(ParsedStatement& statement)
 	}
 	++index; // Skip (
 
-	while (statement.tokens[index] != ')' && index < statement.tokens.size())
+	while (statement.tokens[index] != ")" && index < statement.tokens.size())
 	{
 		parameters_.emplace_back();
 		index = parameters_.back().parse(statement.tokens, index);
 
-		if (statement.tokens[index] == ',')
+		if (statement.tokens[index] == ",")
 			++index;
 	}
 
@@ -481,15 +585,15 @@ bool Function::isFunction(ParsedStatement& statement)
 	bool special_func = false;
 	for (auto& token : statement.tokens)
 	{
-		if (token == '=')
+		if (token == "=")
 			return false;
 
-		if (!special_func && token == '(')
+		if (!special_func && token == "(")
 			return true;
 
 		if (strutil::equalCI(token, "deprecated") || strutil::equalCI(token, "version"))
 			special_func = true;
-		else if (special_func && token == ')')
+		else if (special_func && token == ")")
 			special_func = false;
 	}
 
@@ -545,10 +649,10 @@ bool StateTable::parse(ParsedStatement& states)
 		// Check for state labels
 		for (auto a = 0u; a < statement.tokens.size(); ++a)
 		{
-			if (statement.tokens[a] == ':')
+			if (statement.tokens[a] == ":")
 			{
 				// Ignore ::
-				if (a + 1 < statement.tokens.size() && statement.tokens[a + 1] == ':')
+				if (a + 1 < statement.tokens.size() && statement.tokens[a + 1] == ":")
 				{
 					++a;
 					continue;
@@ -590,7 +694,7 @@ bool StateTable::parse(ParsedStatement& states)
 		{
 			// Parse duration
 			int duration = 0;
-			if (statement.tokens[index + 2] == '-' && index + 3 < statement.tokens.size())
+			if (statement.tokens[index + 2] == "-" && index + 3 < statement.tokens.size())
 			{
 				// Negative number
 				strutil::toInt(statement.tokens[index + 3], duration);
@@ -600,7 +704,8 @@ bool StateTable::parse(ParsedStatement& states)
 				strutil::toInt(statement.tokens[index + 2], duration);
 
 			for (auto& state : current_states)
-				states_[state].frames.push_back({ statement.tokens[index], statement.tokens[index + 1], duration });
+				states_[state].frames.push_back(
+					{ string{ statement.tokens[index] }, string{ statement.tokens[index + 1] }, duration });
 		}
 	}
 
@@ -665,7 +770,7 @@ bool Class::parse(ParsedStatement& class_statement, const vector<Class>& parsed_
 	for (unsigned a = 0; a < class_statement.tokens.size(); a++)
 	{
 		// Inherits
-		if (class_statement.tokens[a] == ':' && a < class_statement.tokens.size() - 1)
+		if (class_statement.tokens[a] == ":" && a < class_statement.tokens.size() - 1)
 		{
 			inherits_class_ = class_statement.tokens[a + 1];
 			for (const auto& pclass : parsed_classes)
@@ -892,9 +997,9 @@ bool Class::parseDefaults(vector<ParsedStatement>& defaults)
 		unsigned count = statement.tokens.size();
 		while (t < count)
 		{
-			if (statement.tokens[t] == '+')
+			if (statement.tokens[t] == "+")
 				default_properties_[strutil::lower(statement.tokens[++t])] = true;
-			else if (statement.tokens[t] == '-')
+			else if (statement.tokens[t] == "-")
 				default_properties_[strutil::lower(statement.tokens[++t])] = false;
 			else
 				break;
@@ -906,8 +1011,8 @@ bool Class::parseDefaults(vector<ParsedStatement>& defaults)
 			continue;
 
 		// Name
-		auto name = statement.tokens[t];
-		if (t + 2 < count && statement.tokens[t + 1] == '.')
+		string name{ statement.tokens[t] };
+		if (t + 2 < count && statement.tokens[t + 1] == ".")
 		{
 			name.append(".").append(statement.tokens[t + 2]);
 			t += 2;
@@ -918,7 +1023,7 @@ bool Class::parseDefaults(vector<ParsedStatement>& defaults)
 		// so stuff like arithmetic expressions or comma separated lists won't
 		// really work properly yet
 		if (t + 1 < count)
-			default_properties_[strutil::lower(name)] = statement.tokens[t + 1];
+			default_properties_[strutil::lower(name)] = string{ statement.tokens[t + 1] };
 
 		// Name only (no value), set as boolean true
 		else if (t < count)
@@ -958,7 +1063,17 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 	vector<ArchiveEntry*>   entry_stack;
 	parseBlocks(entry, parsed, entry_stack);
 	log::debug(2, "parseBlocks: {}ms", app::runTimer() - start);
-	start = app::runTimer();
+
+	return parseStatements(parsed);
+}
+
+// -----------------------------------------------------------------------------
+// Parses ZScript definitions from the statements/blocks in [parsed]
+// (see parseBlocks)
+// -----------------------------------------------------------------------------
+bool Definitions::parseStatements(vector<ParsedStatement>& parsed)
+{
+	auto start = app::runTimer();
 
 	for (auto& block : parsed)
 	{
@@ -1025,25 +1140,15 @@ bool Definitions::parseZScript(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 bool Definitions::parseZScript(Archive* archive)
 {
-	// Get base ZScript file
-	Archive::SearchOptions opt;
-	opt.match_name      = "zscript";
-	opt.ignore_ext      = true;
-	auto zscript_enries = archive->findAll(opt);
-	if (zscript_enries.empty())
+	vector<vector<ParsedStatement>> entry_blocks;
+	vector<ArchiveEntry*>           sources;
+	if (!parseBlocks(archive, entry_blocks, sources))
 		return false;
 
-	log::info(2, "Parsing ZScript entries found in archive {}", archive->filename());
-
-	// Get ZScript entry type (all parsed ZScript entries will be set to this)
-	etype_zscript = EntryType::fromId("zscript");
-	if (etype_zscript == EntryType::unknownType())
-		etype_zscript = nullptr;
-
 	// Parse ZScript entries
 	bool ok = true;
-	for (auto entry : zscript_enries)
-		if (!parseZScript(entry))
+	for (auto& blocks : entry_blocks)
+		if (!parseStatements(blocks))
 			ok = false;
 
 	return ok;
@@ -1060,6 +1165,184 @@ void Definitions::exportThingTypes(std::map<int, game::ThingType>& types, vector
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// ZScript Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns an interned copy of [text]. The returned view remains valid for the
+// lifetime of the program, and equal strings always share the same view
+// -----------------------------------------------------------------------------
+string_view zscript::internToken(string_view text)
+{
+	std::lock_guard lock(token_pool.mutex);
+	return internLocked(text);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// TokenStream Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// TokenStream class constructor, splits [text] into tokens using the same
+// rules as a Tokenizer set up for ZScript (C and C++ style comments, decorate
+// //$ tokens and quoted strings)
+// -----------------------------------------------------------------------------
+TokenStream::TokenStream(string_view text) : text_{ text }
+{
+	auto&              classes = charClasses();
+	std::deque<string> unescaped;
+	unsigned           line = 1;
+	size_t             pos  = 0;
+	auto               size = text.size();
+
+	auto tokenEnd = [&](size_t end) {
+		while (end < size && classes[static_cast<uint8_t>(text[end])] == Normal)
+			++end;
+		return end;
+	};
+
+	while (pos < size)
+	{
+		auto c = text[pos];
+
+		// Whitespace
+		if (classes[static_cast<uint8_t>(c)] == Whitespace)
+		{
+			if (c == '\n')
+				++line;
+			++pos;
+			continue;
+		}
+
+		// C++ style comment (or decorate //$ token)
+		if (c == '/' && pos + 1 < size && text[pos + 1] == '/')
+		{
+			if (pos + 2 < size && text[pos + 2] == '$')
+			{
+				auto end = tokenEnd(pos + 3);
+				tokens_.push_back({ text.substr(pos, end - pos), line, static_cast<unsigned>(pos) });
+				pos = end;
+			}
+			else
+				pos = std::min(text.find('\n', pos), size);
+
+			continue;
+		}
+
+		// C style comment
+		if (c == '/' && pos + 1 < size && text[pos + 1] == '*')
+		{
+			auto end = std::min(text.find("*/", pos + 2), size - 2) + 2;
+			line += std::count(text.begin() + pos, text.begin() + end, '\n');
+			pos = end;
+			continue;
+		}
+
+		// Special character
+		if (classes[static_cast<uint8_t>(c)] == Special)
+		{
+			tokens_.push_back({ text.substr(pos, 1), line, static_cast<unsigned>(pos) });
+			++pos;
+			continue;
+		}
+
+		// Quoted string
+		if (c == '"')
+		{
+			auto start   = ++pos;
+			bool escaped = false;
+			while (pos < size && text[pos] != '"')
+			{
+				if (text[pos] == '\\')
+				{
+					escaped = true;
+					++pos;
+				}
+				++pos;
+			}
+			pos = std::min(pos, size);
+
+			auto token = text.substr(start, pos - start);
+			if (escaped)
+			{
+				auto& str = unescaped.emplace_back();
+				for (size_t a = 0; a < token.size(); ++a)
+				{
+					if (token[a] == '\\' && a + 1 < token.size())
+						++a;
+					str += token[a];
+				}
+				token = str;
+			}
+
+			tokens_.push_back({ token, line, static_cast<unsigned>(start) });
+			line += std::count(text.begin() + start, text.begin() + pos, '\n');
+			++pos; // Closing "
+			continue;
+		}
+
+		// Token
+		auto end = tokenEnd(pos + 1);
+		tokens_.push_back({ text.substr(pos, end - pos), line, static_cast<unsigned>(pos) });
+		pos = end;
+	}
+
+	// End of text
+	tokens_.push_back({ {}, line, static_cast<unsigned>(size) });
+
+	// Intern token text, since parsed statements can outlive [text]
+	std::lock_guard lock(token_pool.mutex);
+	for (auto& token : tokens_)
+		token.text = internLocked(token.text);
+}
+
+// -----------------------------------------------------------------------------
+// Advances to the next token if the current token is [c].
+// Returns true if the current token was [c]
+// -----------------------------------------------------------------------------
+bool TokenStream::advIf(char c)
+{
+	if (!check(c))
+		return false;
+
+	adv();
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Advances to the first token on the next line
+// -----------------------------------------------------------------------------
+void TokenStream::advToNextLine()
+{
+	auto line = current().line;
+	while (!atEnd() && current().line <= line)
+		++index_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (interned) text from the next token to the end of its line, and
+// advances to the first token after it
+// -----------------------------------------------------------------------------
+string_view TokenStream::getLine()
+{
+	auto start = std::min<size_t>(peek().position, text_.size());
+	auto end   = std::min(text_.find_first_of("\r\n", start), text_.size());
+
+	while (!atEnd() && current().position < end)
+		++index_;
+
+	return internToken(text_.substr(start, end - start));
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // ParsedStatement Struct Functions
@@ -1083,41 +1366,41 @@ void Definitions::exportThingTypes(std::map<int, game::ThingType>& types, vector
 //     ...
 // }
 // -----------------------------------------------------------------------------
-bool ParsedStatement::parse(Tokenizer& tz)
+bool ParsedStatement::parse(TokenStream& ts)
 {
 	// Check for unexpected token
-	if (tz.check('}'))
+	if (ts.check('}'))
 	{
-		tz.adv();
+		ts.adv();
 		return false;
 	}
 
-	line = tz.lineNo();
+	line = ts.current().line;
 
 	// Tokens
 	bool in_initializer = false;
 	while (true)
 	{
 		// End of statement (;)
-		if (tz.advIf(';'))
+		if (ts.advIf(';'))
 			return true;
 
 		// DB comment
-		if (strutil::startsWith(tz.current().text, db_comment))
+		if (strutil::startsWith(ts.current().text, db_comment))
 		{
-			tokens.emplace_back(tz.current().text);
-			tokens.emplace_back(tz.getLine());
+			tokens.push_back(ts.current().text);
+			tokens.push_back(ts.getLine());
 			return true;
 		}
 
-		if (tz.check('}'))
+		if (ts.check('}'))
 		{
 			// End of array initializer
 			if (in_initializer)
 			{
 				in_initializer = false;
 				tokens.emplace_back("}");
-				tz.adv();
+				ts.adv();
 				continue;
 			}
 
@@ -1125,37 +1408,37 @@ bool ParsedStatement::parse(Tokenizer& tz)
 			return true;
 		}
 
-		if (tz.atEnd())
+		if (ts.atEnd())
 		{
 			log::debug("Failed parsing zscript statement/block beginning line {}", line);
 			return false;
 		}
 
 		// Beginning of block
-		if (tz.advIf('{'))
+		if (ts.advIf('{'))
 			break;
 
 		// Array initializer: ... = { ... }
-		if (tz.current() == '=' && tz.peek() == '{')
+		if (ts.check('=') && ts.peek().text == "{")
 		{
 			tokens.emplace_back("=");
 			tokens.emplace_back("{");
-			tz.adv(2);
+			ts.adv(2);
 			in_initializer = true;
 			continue;
 		}
 
-		tokens.emplace_back(tz.current().text);
-		tz.adv();
+		tokens.push_back(ts.current().text);
+		ts.adv();
 	}
 
 	// Block
 	while (true)
 	{
-		if (tz.advIf('}'))
+		if (ts.advIf('}'))
 			return true;
 
-		if (tz.atEnd())
+		if (ts.atEnd())
 		{
 			log::debug("Failed parsing zscript statement/block beginning line {}", line);
 			return false;
@@ -1163,7 +1446,7 @@ bool ParsedStatement::parse(Tokenizer& tz)
 
 		block.push_back({});
 		block.back().entry = entry;
-		if (!block.back().parse(tz) || block.back().tokens.empty())
+		if (!block.back().parse(ts) || block.back().tokens.empty())
 			block.pop_back();
 	}
 }
@@ -1179,7 +1462,7 @@ void ParsedStatement::dump(int indent)
 
 	// Tokens
 	for (auto& token : tokens)
-		line += token + " ";
+		line.append(token).append(" ");
 	log::debug(line);
 
 	// Blocks
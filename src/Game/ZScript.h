@@ -7,19 +7,51 @@ namespace slade
 {
 class Archive;
 class ArchiveEntry;
-class Tokenizer;
 
 namespace zscript
 {
+	string_view internToken(string_view text);
+
+	// A token in a TokenStream
+	struct Token
+	{
+		string_view text; // Interned (see internToken)
+		unsigned    line     = 0;
+		unsigned    position = 0; // Offset of the token in the source text
+	};
+
+	// Splits ZScript source text into tokens all at once, without any per-token
+	// allocations (token text is interned rather than copied)
+	class TokenStream
+	{
+	public:
+		TokenStream(string_view text);
+
+		const Token& current() const { return tokens_[index_]; }
+		const Token& peek() const { return tokens_[std::min(index_ + 1, tokens_.size() - 1)]; }
+		bool         atEnd() const { return index_ + 1 >= tokens_.size(); }
+		bool         check(char c) const { return current().text.size() == 1 && current().text[0] == c; }
+
+		void        adv(size_t inc = 1) { index_ = std::min(index_ + inc, tokens_.size() - 1); }
+		bool        advIf(char c);
+		void        advToNextLine();
+		string_view getLine();
+
+	private:
+		string_view   text_;
+		vector<Token> tokens_; // Always ends with an empty token marking the end of the text
+		size_t        index_ = 0;
+	};
+
 	struct ParsedStatement
 	{
 		ArchiveEntry* entry = nullptr;
 		unsigned      line;
 
-		vector<string>          tokens;
+		vector<string_view>     tokens; // Interned (see internToken)
 		vector<ParsedStatement> block;
 
-		bool parse(Tokenizer& tz);
+		bool parse(TokenStream& ts);
 		void dump(int indent = 0);
 	};
 
@@ -86,7 +118,7 @@ namespace zscript
 			string default_value;
 			Parameter() : name{ "<unknown>" }, type{ "<unknown>" }, default_value{ "" } {}
 
-			unsigned parse(const vector<string>& tokens, unsigned start_index);
+			unsigned parse(const vector<string_view>& tokens, unsigned start_index);
 		};
 
 		const string&            returnType() const { return return_type_; }
@@ -177,6 +209,8 @@ namespace zscript
 		bool parseDefaults(vector<ParsedStatement>& defaults);
 	};
 
+	bool parseBlocks(Archive* archive, vector<vector<ParsedStatement>>& entry_blocks, vector<ArchiveEntry*>& sources);
+
 	class Definitions // rename this also
 	{
 	public:
@@ -188,6 +222,7 @@ namespace zscript
 		void clear();
 		bool parseZScript(ArchiveEntry* entry);
 		bool parseZScript(Archive* archive);
+		bool parseStatements(vector<ParsedStatement>& parsed);
 
 		void exportThingTypes(std::map<int, game::ThingType>& types, vector<game::ThingType>& parsed);
 
@@ -33,6 +33,7 @@
 #include "Main.h"
 #include "Utility/StringUtils.h"
 #include <fmt/format.h>
+#include <unordered_map>
 
 using namespace slade;
 
@@ -56,6 +57,17 @@ uint16_t n_cvars;
 // -----------------------------------------------------------------------------
 namespace
 {
+// -----------------------------------------------------------------------------
+// Returns the CVar name -> CVar index.
+// CVars are added during static initialisation, so this is created on first
+// use rather than being a namespace variable
+// -----------------------------------------------------------------------------
+std::unordered_map<string, CVar*>& cvarIndex()
+{
+	static std::unordered_map<string, CVar*> index;
+	return index;
+}
+
 // -----------------------------------------------------------------------------
 // Adds a CVar to the CVar list
 // -----------------------------------------------------------------------------
@@ -64,6 +76,8 @@ void addCVarList(CVar* cvar)
 	cvars          = (CVar**)realloc(cvars, (n_cvars + 1) * sizeof(CVar*));
 	cvars[n_cvars] = cvar;
 	n_cvars++;
+
+	cvarIndex().emplace(cvar->name, cvar);
 }
 } // namespace
 
@@ -136,13 +150,8 @@ CStringCVar::CStringCVar(const string& NAME, const string& defval, uint16_t FLAG
 // -----------------------------------------------------------------------------
 CVar* CVar::get(const string& name)
 {
-	for (unsigned i = 0; i < n_cvars; ++i)
-	{
-		if (cvars[i]->name == name)
-			return cvars[i];
-	}
-
-	return nullptr;
+	auto i = cvarIndex().find(name);
+	return i == cvarIndex().end() ? nullptr : i->second;
 }
 
 // -----------------------------------------------------------------------------
@@ -211,22 +220,19 @@ string CVar::writeAll()
 // -----------------------------------------------------------------------------
 void CVar::set(const string& name, const string& value)
 {
-	for (unsigned i = 0; i < n_cvars; ++i)
-	{
-		auto cvar = cvars[i];
-		if (name == cvar->name)
-		{
-			if (cvar->type == Type::Integer)
-				*dynamic_cast<CIntCVar*>(cvar) = strutil::asInt(value);
+	auto cvar = get(name);
+	if (!cvar)
+		return;
 
-			if (cvar->type == Type::Boolean)
-				*dynamic_cast<CBoolCVar*>(cvar) = strutil::asBoolean(value);
+	if (cvar->type == Type::Integer)
+		*dynamic_cast<CIntCVar*>(cvar) = strutil::asInt(value);
 
-			if (cvar->type == Type::Float)
-				*dynamic_cast<CFloatCVar*>(cvar) = strutil::asFloat(value);
+	if (cvar->type == Type::Boolean)
+		*dynamic_cast<CBoolCVar*>(cvar) = strutil::asBoolean(value);
 
-			if (cvar->type == Type::String)
-				*dynamic_cast<CStringCVar*>(cvar) = value;
-		}
-	}
+	if (cvar->type == Type::Float)
+		*dynamic_cast<CFloatCVar*>(cvar) = strutil::asFloat(value);
+
+	if (cvar->type == Type::String)
+		*dynamic_cast<CStringCVar*>(cvar) = value;
 }
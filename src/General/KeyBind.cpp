@@ -33,6 +33,7 @@
 #include "KeyBind.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <unordered_map>
 
 using namespace slade;
 
@@ -44,10 +45,11 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-vector<KeyBind>         keybinds;
-vector<KeyBind>         keybinds_sorted;
-KeyBind                 kb_none("-none-");
-vector<KeyBindHandler*> kb_handlers;
+vector<KeyBind>                      keybinds;
+vector<KeyBind>                      keybinds_sorted;
+std::unordered_map<string, unsigned> keybind_index; // Keybind name -> index in keybinds
+KeyBind                              kb_none("-none-");
+vector<KeyBindHandler*>              kb_handlers;
 } // namespace
 
 
@@ -142,13 +144,19 @@ string KeyBind::keysAsString()
 // -----------------------------------------------------------------------------
 KeyBind& KeyBind::bind(string_view name)
 {
-	for (auto& keybind : keybinds)
-	{
-		if (keybind.name_ == name)
-			return keybind;
-	}
+	auto index = KeyBind::index(name);
+	return index < 0 ? kb_none : keybinds[index];
+}
 
-	return kb_none;
+// -----------------------------------------------------------------------------
+// Returns the index of keybind [name], or -1 if it doesn't exist.
+// Indices don't change once a keybind is added, so they can be looked up once
+// and kept for keybinds that are checked often (eg. every frame)
+// -----------------------------------------------------------------------------
+int KeyBind::index(string_view name)
+{
+	auto i = keybind_index.find(string{ name });
+	return i == keybind_index.end() ? -1 : static_cast<int>(i->second);
 }
 
 // -----------------------------------------------------------------------------
@@ -183,6 +191,14 @@ bool KeyBind::isPressed(string_view name)
 	return bind(name).pressed_;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the keybind at [index] is currently pressed
+// -----------------------------------------------------------------------------
+bool KeyBind::isPressed(int index)
+{
+	return index >= 0 && index < static_cast<int>(keybinds.size()) && keybinds[index].pressed_;
+}
+
 // -----------------------------------------------------------------------------
 // Adds a new keybind
 // -----------------------------------------------------------------------------
@@ -195,19 +211,15 @@ bool KeyBind::addBind(
 	int             priority)
 {
 	// Find keybind
-	KeyBind* bind = nullptr;
-	for (auto& keybind : keybinds)
-	{
-		if (keybind.name_ == name)
-		{
-			bind = &keybind;
-			break;
-		}
-	}
+	KeyBind* bind  = nullptr;
+	auto     index = KeyBind::index(name);
+	if (index >= 0)
+		bind = &keybinds[index];
 
 	// Add keybind if it doesn't exist
 	if (!bind)
 	{
+		keybind_index[string{ name }] = keybinds.size();
 		keybinds.emplace_back(name);
 		bind                = &keybinds.back();
 		bind->ignore_shift_ = ignore_shift;
@@ -447,17 +459,12 @@ bool KeyBind::keyReleased(string_view key)
 // -----------------------------------------------------------------------------
 void KeyBind::pressBind(string_view name)
 {
-	for (auto& keybind : keybinds)
-	{
-		if (keybind.name_ == name)
-		{
-			// Send key pressed event to keybind handlers
-			for (auto& kb_handler : kb_handlers)
-				kb_handler->onKeyBindPress(name);
+	if (index(name) < 0)
+		return;
 
-			return;
-		}
-	}
+	// Send key pressed event to keybind handlers
+	for (auto& kb_handler : kb_handlers)
+		kb_handler->onKeyBindPress(name);
 }
 
 // -----------------------------------------------------------------------------
@@ -75,8 +75,10 @@ public:
 
 	// Static functions
 	static KeyBind&       bind(string_view name);
+	static int            index(string_view name);
 	static vector<string> bindsForKey(Keypress key);
 	static bool           isPressed(string_view name);
+	static bool           isPressed(int index);
 	static bool           addBind(
 				  string_view     name,
 				  const Keypress& key,
@@ -32,8 +32,12 @@
 #include "Main.h"
 #include "App.h"
 #include <fmt/chrono.h>
+#include <condition_variable>
 #include <fmt/format.h>
 #include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
 
 using namespace slade;
 
@@ -43,12 +47,8 @@ using namespace slade;
 // Variables
 //
 // -----------------------------------------------------------------------------
-namespace slade::log
-{
-vector<Message> log;
-std::ofstream   log_file;
-} // namespace slade::log
 CVAR(Int, log_verbosity, 1, CVar::Flag::Save)
+CVAR(Int, log_history_size, 20000, CVar::Flag::Save) // Max number of messages kept in the log history
 
 
 // -----------------------------------------------------------------------------
@@ -75,6 +75,299 @@ template<> struct formatter<log::MessageType>
 } // namespace fmt
 
 
+// -----------------------------------------------------------------------------
+//
+// LogSink Class
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Receives log messages from any thread and writes them to the log file and
+// message history on a background thread, so logging doesn't hold up the
+// thread doing it. Messages are queued on a lock-free list, only the history
+// (which is read by the UI) is locked
+class LogSink
+{
+public:
+	LogSink() = default;
+	~LogSink() { stop(); }
+
+	std::ofstream& file() { return file_; }
+	void           setEcho(bool echo) { echo_ = echo; }
+
+	void   push(log::Message&& message);
+	void   start(unsigned history_size);
+	void   stop();
+	void   flush();
+	size_t count();
+	size_t history(size_t from, vector<log::Message>& messages);
+
+private:
+	struct Node
+	{
+		log::Message message;
+		Node*        next;
+	};
+
+	std::ofstream           file_;
+	std::atomic<Node*>      pending_ = nullptr; // Queued messages, most recent first
+	std::atomic<size_t>     pushed_  = 0;
+	std::thread             thread_;
+	std::atomic<bool>       running_ = false;
+	std::atomic<bool>       echo_    = false; // Also write messages to stdout
+	std::mutex              wake_mutex_;
+	std::condition_variable wake_cv_;
+	std::mutex              drain_mutex_;
+
+	// Ring buffer of the most recently processed messages
+	std::mutex              history_mutex_;
+	std::condition_variable processed_cv_;
+	vector<log::Message>    history_;
+	size_t                  history_size_ = 20000;
+	size_t                  processed_    = 0; // Total number of messages processed
+
+	size_t firstIndex() const { return processed_ > history_size_ ? processed_ - history_size_ : 0; }
+	void   run();
+	void   drain();
+};
+
+LogSink sink;
+
+// -----------------------------------------------------------------------------
+// Queues [message] to be written by the sink thread
+// -----------------------------------------------------------------------------
+void LogSink::push(log::Message&& message)
+{
+	auto node = new Node{ std::move(message), pending_.load(std::memory_order_relaxed) };
+	while (!pending_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+		;
+	++pushed_;
+
+	if (running_)
+		wake_cv_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Starts the sink thread, keeping the last [history_size] messages in the
+// message history
+// -----------------------------------------------------------------------------
+void LogSink::start(unsigned history_size)
+{
+	if (running_)
+		return;
+
+	history_size_ = std::max<size_t>(history_size, 1);
+	history_.reserve(std::min<size_t>(history_size_, 1024));
+	running_ = true;
+	thread_  = std::thread(&LogSink::run, this);
+}
+
+// -----------------------------------------------------------------------------
+// Stops the sink thread after writing any remaining messages
+// -----------------------------------------------------------------------------
+void LogSink::stop()
+{
+	if (running_)
+	{
+		{
+			std::lock_guard lock(wake_mutex_);
+			running_ = false;
+		}
+		wake_cv_.notify_one();
+		thread_.join();
+	}
+
+	drain();
+}
+
+// -----------------------------------------------------------------------------
+// Waits until all messages logged so far have been written and added to the
+// message history
+// -----------------------------------------------------------------------------
+void LogSink::flush()
+{
+	// Just write them here if the sink thread isn't running
+	if (!running_)
+	{
+		drain();
+		return;
+	}
+
+	auto             target = pushed_.load();
+	std::unique_lock lock(history_mutex_);
+	wake_cv_.notify_one();
+	processed_cv_.wait(lock, [this, target]() { return processed_ >= target || !running_; });
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total number of messages that have been processed
+// -----------------------------------------------------------------------------
+size_t LogSink::count()
+{
+	std::lock_guard lock(history_mutex_);
+	return processed_;
+}
+
+// -----------------------------------------------------------------------------
+// Adds copies of all messages in the history from index [from] (in all
+// messages ever logged) to [messages]. Messages that are no longer in the
+// history are skipped.
+// Returns the index after the last message added
+// -----------------------------------------------------------------------------
+size_t LogSink::history(size_t from, vector<log::Message>& messages)
+{
+	std::lock_guard lock(history_mutex_);
+	for (auto a = std::max(from, firstIndex()); a < processed_; ++a)
+		messages.push_back(history_[a % history_size_]);
+
+	return processed_;
+}
+
+// -----------------------------------------------------------------------------
+// Sink thread function, waits for messages to be queued and writes them
+// -----------------------------------------------------------------------------
+void LogSink::run()
+{
+	while (running_)
+	{
+		{
+			std::unique_lock lock(wake_mutex_);
+			wake_cv_.wait_for(
+				lock,
+				std::chrono::milliseconds(100),
+				[this]() { return !running_ || pending_.load(std::memory_order_relaxed); });
+		}
+
+		drain();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes all queued messages to the log file and adds them to the history
+// -----------------------------------------------------------------------------
+void LogSink::drain()
+{
+	std::lock_guard drain_lock(drain_mutex_);
+
+	// Take all queued messages, reversed so they are in the order they were
+	// logged
+	Node* first = nullptr;
+	auto  node  = pending_.exchange(nullptr, std::memory_order_acquire);
+	while (node)
+	{
+		auto next  = node->next;
+		node->next = first;
+		first      = node;
+		node       = next;
+	}
+	if (!first)
+		return;
+
+	// Write to log file
+	if (file_.is_open())
+	{
+		for (node = first; node; node = node->next)
+			if (node->message.type != log::MessageType::Console)
+				file_ << node->message.formattedMessageLine() << "\n";
+		file_.flush();
+	}
+
+	// Write to stdout
+	if (echo_)
+	{
+		for (node = first; node; node = node->next)
+			std::cout << node->message.formattedMessageLine() << "\n";
+		std::cout.flush();
+	}
+
+	// Add to history
+	{
+		std::lock_guard lock(history_mutex_);
+		while (first)
+		{
+			if (history_.size() < history_size_)
+				history_.push_back(std::move(first->message));
+			else
+				history_[processed_ % history_size_] = std::move(first->message);
+			++processed_;
+
+			node  = first;
+			first = first->next;
+			delete node;
+		}
+	}
+	processed_cv_.notify_all();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ErrorLineBuffer Class
+//
+// -----------------------------------------------------------------------------
+
+
+// Stream buffer for sf::err() that logs each complete line written to it as an
+// error message. The log file is only ever written by the sink thread, so
+// SFML's output can't write to it directly
+class ErrorLineBuffer : public std::streambuf
+{
+protected:
+	int_type        overflow(int_type c) override;
+	std::streamsize xsputn(const char* s, std::streamsize count) override;
+
+private:
+	std::mutex mutex_;
+	string     line_;
+
+	void put(char c);
+};
+
+ErrorLineBuffer sf_err_buffer;
+
+// -----------------------------------------------------------------------------
+// Adds [c] to the current line, logging the line if [c] ends it
+// -----------------------------------------------------------------------------
+void ErrorLineBuffer::put(char c)
+{
+	if (c != '\n')
+	{
+		line_ += c;
+		return;
+	}
+
+	if (!line_.empty())
+		log::error(line_);
+	line_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Writes a single character [c] (the buffer is unbuffered, so this is called
+// for anything written one character at a time)
+// -----------------------------------------------------------------------------
+ErrorLineBuffer::int_type ErrorLineBuffer::overflow(int_type c)
+{
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+
+	std::lock_guard lock(mutex_);
+	put(traits_type::to_char_type(c));
+	return c;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [count] characters from [s]
+// -----------------------------------------------------------------------------
+std::streamsize ErrorLineBuffer::xsputn(const char* s, std::streamsize count)
+{
+	std::lock_guard lock(mutex_);
+	for (std::streamsize a = 0; a < count; ++a)
+		put(s[a]);
+	return count;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // FreeImage Error Handler
@@ -125,9 +418,10 @@ string log::Message::formattedMessageLine() const
 // -----------------------------------------------------------------------------
 void log::init()
 {
-	// Redirect sf::err output to the log file
-	log_file.open(app::path("slade3.log", app::Dir::User));
-	sf::err().rdbuf(log_file.rdbuf());
+	// Redirect sf::err output to the log
+	sink.file().open(app::path("slade3.log", app::Dir::User));
+	sf::err().rdbuf(&sf_err_buffer);
+	sink.start(std::max<int>(log_history_size, 1));
 
 	// Write logfile header
 	auto t  = std::time(nullptr);
@@ -158,11 +452,38 @@ void log::init()
 }
 
 // -----------------------------------------------------------------------------
-// Returns the log message history
+// Writes any remaining log messages and stops the logging thread
 // -----------------------------------------------------------------------------
-const vector<log::Message>& log::history()
+void log::shutdown()
 {
-	return log;
+	sink.stop();
+}
+
+// -----------------------------------------------------------------------------
+// Waits until all messages logged so far have been written to the log file
+// and added to the history
+// -----------------------------------------------------------------------------
+void log::flush()
+{
+	sink.flush();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total number of messages logged (and added to the history) so
+// far. This includes messages that are no longer in the (limited size) history
+// -----------------------------------------------------------------------------
+size_t log::messageCount()
+{
+	return sink.count();
+}
+
+// -----------------------------------------------------------------------------
+// Adds copies of the messages in the history from index [from] onwards to
+// [messages]. Returns the index to continue from to get newer messages
+// -----------------------------------------------------------------------------
+size_t log::history(size_t from, vector<Message>& messages)
+{
+	return sink.history(from, messages);
 }
 
 // -----------------------------------------------------------------------------
@@ -183,22 +504,38 @@ void log::setVerbosity(int verbosity)
 }
 
 // -----------------------------------------------------------------------------
-// Logs a message [text] of [type]
+// Sets whether log messages are also written to stdout (eg. in batch mode,
+// where there is no UI to view the log)
 // -----------------------------------------------------------------------------
-void log::message(MessageType type, string_view text)
+void log::setEchoToStdout(bool echo)
 {
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
+	sink.setEcho(echo);
+}
 
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+// -----------------------------------------------------------------------------
+// Logs a message [text] of [type].
+// This can be called from any thread, the message is written to the log file
+// and history in the background
+// -----------------------------------------------------------------------------
+void log::message(MessageType type, string_view text)
+{
+	auto    t = std::time(nullptr);
+	std::tm timestamp;
+#ifdef _WIN32
+	localtime_s(&timestamp, &t);
+#else
+	localtime_r(&t, &timestamp);
+#endif
+	sink.push(Message{ text, type, timestamp });
 }
 
 void log::message(MessageType type, int level, string_view text, fmt::format_args args)
 {
-	message(type, level, fmt::vformat(text, args));
+	// Don't bother formatting messages that won't be logged
+	if (level > log_verbosity)
+		return;
+
+	message(type, fmt::vformat(text, args));
 }
 
 void log::message(MessageType type, string_view text, fmt::format_args args)
@@ -209,12 +546,15 @@ void log::message(MessageType type, string_view text, fmt::format_args args)
 // -----------------------------------------------------------------------------
 // Returns a list of log messages of [type] that have been recorded since [time]
 // -----------------------------------------------------------------------------
-vector<log::Message*> log::since(time_t time, MessageType type)
+vector<log::Message> log::since(time_t time, MessageType type)
 {
-	vector<Message*> list;
-	for (auto& msg : log)
+	sink.flush();
+
+	vector<Message> history, list;
+	sink.history(0, history);
+	for (auto& msg : history)
 		if (mktime(&msg.timestamp) >= time && (type == MessageType::Any || msg.type == type))
-			list.push_back(&msg);
+			list.push_back(std::move(msg));
 	return list;
 }
 
@@ -256,11 +596,5 @@ void log::message(MessageType type, int level, string_view text)
 	if (level > log_verbosity)
 		return;
 
-	// Add log message
-	auto t = std::time(nullptr);
-	log.emplace_back(text, type, *std::localtime(&t));
-
-	// Write to log file
-	if (log_file.is_open() && type != MessageType::Console)
-		sf::err() << log.back().formattedMessageLine() << "\n";
+	message(type, text);
 }
@@ -36,8 +36,11 @@
 #include "Archive/ArchiveEntry.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
+#include "Utility/MemoryStats.h"
 #include "Utility/StringUtils.h"
 #include "Utility/Tokenizer.h"
+#include <list>
+#include <mutex>
 
 using namespace slade;
 
@@ -49,12 +52,30 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Bool, size_as_string, true, CVar::Flag::Save)
 CVAR(Bool, percent_encoding, false, CVar::Flag::Save)
+CVAR(Int, image_cache_size, 64, CVar::Flag::Save) // In MB
 EXTERN_CVAR(Float, col_cie_tristim_x)
 EXTERN_CVAR(Float, col_cie_tristim_z)
 namespace slade::misc
 {
 vector<WindowInfo> window_info;
 }
+namespace
+{
+// Decoded entry images, most recently used first
+struct CachedImage
+{
+	ArchiveEntry*          entry;
+	int                    index;
+	weak_ptr<ArchiveEntry> entry_ref; // To check the entry still exists
+	uint32_t               hash;      // Entry content hash when the image was loaded
+	SImage                 image;
+	size_t                 size;
+};
+std::list<CachedImage>                                                   image_cache;
+std::map<std::pair<ArchiveEntry*, int>, std::list<CachedImage>::iterator> image_cache_index;
+size_t                                                                   image_cache_used = 0;
+std::mutex                                                               image_cache_mutex;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -149,6 +170,84 @@ bool misc::loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Same as loadImageFromEntry, but keeps a copy of the decoded image in a cache
+// shared by everything that loads images this way (up to image_cache_size MB,
+// least recently used images are removed first). The cached image is used
+// again as long as the entry still exists and hasn't been modified.
+// Intended for images that are loaded often, eg. composite texture patches
+// -----------------------------------------------------------------------------
+bool misc::loadCachedImageFromEntry(SImage* image, ArchiveEntry* entry, int index)
+{
+	if (!entry || image_cache_size <= 0)
+		return loadImageFromEntry(image, entry, index);
+
+	// Check the cache
+	auto key = std::make_pair(entry, index);
+	{
+		std::lock_guard lock(image_cache_mutex);
+		auto            i = image_cache_index.find(key);
+		if (i != image_cache_index.end())
+		{
+			auto cached = i->second;
+			if (!cached->entry_ref.expired() && cached->hash == entry->contentHash())
+			{
+				image->copyImage(&cached->image);
+				image_cache.splice(image_cache.begin(), image_cache, cached);
+				return true;
+			}
+
+			// Entry was modified or deleted
+			image_cache_used -= cached->size;
+			image_cache.erase(cached);
+			image_cache_index.erase(i);
+		}
+	}
+
+	// Not cached, load the image
+	if (!loadImageFromEntry(image, entry, index))
+		return false;
+
+	// Only entries in an archive can be cached (something has to own them)
+	auto entry_ref = entry->getShared();
+	if (!entry_ref)
+		return true;
+
+	// Add to the cache
+	std::lock_guard lock(image_cache_mutex);
+	if (image_cache_index.count(key) > 0)
+		return true; // Loaded by another thread in the meantime
+	auto size = static_cast<size_t>(image->stride()) * image->height();
+	if (image->type() == SImage::Type::PalMask)
+		size += static_cast<size_t>(image->width()) * image->height();
+	image_cache.push_front({ entry, index, entry_ref, entry->contentHash(), SImage{ *image }, size });
+	image_cache_index[key] = image_cache.begin();
+	image_cache_used += size;
+
+	// Remove least recently used images if over the size limit
+	auto max_size = static_cast<size_t>(image_cache_size) * 1024 * 1024;
+	while (image_cache_used > max_size && image_cache.size() > 1)
+	{
+		auto& last = image_cache.back();
+		image_cache_used -= last.size;
+		image_cache_index.erase(std::make_pair(last.entry, last.index));
+		image_cache.pop_back();
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Clears all images cached by loadCachedImageFromEntry
+// -----------------------------------------------------------------------------
+void misc::clearImageCache()
+{
+	std::lock_guard lock(image_cache_mutex);
+	image_cache.clear();
+	image_cache_index.clear();
+	image_cache_used = 0;
+}
+
 // -----------------------------------------------------------------------------
 // Detects the few known cases where a picture does not use PLAYPAL as its
 // default palette.
@@ -455,9 +554,6 @@ void misc::doMassRename(vector<string>& names, string_view name_filter)
 /* Table of CRCs of all 8-bit messages. */
 uint32_t crc_table[256];
 
-/* Flag: has the table been computed? Initially false. */
-int crc_table_computed = 0;
-
 /* Make the table for a fast CRC. */
 void make_crc_table(void)
 {
@@ -478,8 +574,6 @@ void make_crc_table(void)
 
 		crc_table[n] = c;
 	}
-
-	crc_table_computed = 1;
 }
 
 /* Update a running CRC with the bytes buf[0..len-1]--the CRC
@@ -490,8 +584,9 @@ uint32_t update_crc(uint32_t crc, const uint8_t* buf, uint32_t len)
 {
 	uint32_t c = crc;
 
-	if (!crc_table_computed)
-		make_crc_table();
+	// Compute the table on first use (only once, crcs can be calculated from multiple threads)
+	static std::once_flag table_computed;
+	std::call_once(table_computed, make_crc_table);
 
 	for (uint32_t n = 0; n < len; n++)
 		c = crc_table[(c ^ buf[n]) & 0xff] ^ (c >> 8);
@@ -620,3 +715,20 @@ void misc::writeWindowInfo(wxFile& file)
 	for (auto& a : window_info)
 		file.Write(wxString::Format("\t%s %d %d %d %d\n", a.id, a.width, a.height, a.left, a.top));
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counts memory used by the decoded entry image cache (see loadImageFromEntry)
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(image_cache, "Image Cache")
+{
+	std::lock_guard lock(image_cache_mutex);
+	usage.push_back({ {}, "Decoded images", image_cache_used, static_cast<unsigned>(image_cache.size()) });
+}
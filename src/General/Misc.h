@@ -11,6 +11,8 @@ class Tokenizer;
 namespace misc
 {
 	bool loadImageFromEntry(SImage* image, ArchiveEntry* entry, int index = 0);
+	bool loadCachedImageFromEntry(SImage* image, ArchiveEntry* entry, int index = 0);
+	void clearImageCache();
 
 	// Palette detection
 	namespace palhack
@@ -58,15 +58,6 @@ string ResourceManager::doom64_hash_table_[65536];
 // ----------------------------------------------------------------------------
 namespace
 {
-// ----------------------------------------------------------------------------
-// Removes all entries in resource [map] that are within [archive]
-// ----------------------------------------------------------------------------
-void removeArchiveFromMap(EntryResourceMap& map, Archive* archive)
-{
-	for (auto& i : map)
-		i.second.removeArchive(archive);
-}
-
 // ----------------------------------------------------------------------------
 // Removes [entry] from resource [map].
 // If [full_check] is true, all resources in the map are checked for the entry,
@@ -78,7 +69,41 @@ void removeEntryFromMap(EntryResourceMap& map, const string& name, shared_ptr<Ar
 		for (auto& i : map)
 			i.second.remove(entry);
 	else
-		map[name].remove(entry);
+	{
+		auto res = map.find(name);
+		if (res != map.end())
+			res->second.remove(entry);
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Returns the most relevant entry for resource [name] in [map], or nullptr if
+// there is no such resource (see EntryResource::getEntry)
+// ----------------------------------------------------------------------------
+ArchiveEntry* resourceEntry(
+	EntryResourceMap& map,
+	const string&     name,
+	Archive*          priority,
+	string_view       nspace      = "",
+	bool              ns_required = false)
+{
+	auto res = map.find(name);
+	return res != map.end() ? res->second.getEntry(priority, nspace, ns_required) : nullptr;
+}
+
+// ----------------------------------------------------------------------------
+// Returns all resources in [map], sorted by name
+// ----------------------------------------------------------------------------
+template<typename T> vector<std::pair<const string, T>*> sortedResources(std::unordered_map<string, T>& map)
+{
+	vector<std::pair<const string, T>*> sorted;
+	sorted.reserve(map.size());
+	for (auto& i : map)
+		sorted.push_back(&i);
+
+	std::sort(sorted.begin(), sorted.end(), [](auto* left, auto* right) { return left->first < right->first; });
+
+	return sorted;
 }
 } // namespace
 
@@ -239,31 +264,21 @@ void TextureResource::remove(Archive* parent)
 // -----------------------------------------------------------------------------
 void ResourceManager::addArchive(Archive* archive)
 {
-	// Check archive was given
-	if (!archive)
+	// Check archive was given and isn't already managed
+	if (!archive || archive_resources_.find(archive) != archive_resources_.end())
 		return;
 
 	// Go through entries
+	auto&                            resources = archive_resources_[archive];
 	vector<shared_ptr<ArchiveEntry>> entries;
 	archive->putEntryTreeAsList(entries);
 	for (auto& entry : entries)
 		addEntry(entry);
 
-	// Update entries from the archive when changed (added/removed/modified)
-	archive->signals().entry_added.connect([this](Archive&, ArchiveEntry& e) { updateEntry(e, false, true); });
-	archive->signals().entry_removed.connect(
-		[this](Archive&, ArchiveDir&, ArchiveEntry& e) { updateEntry(e, true, false); });
-	archive->signals().entry_state_changed.connect([this](Archive&, ArchiveEntry& e) { updateEntry(e, true, true); });
-
-	// Update entries from the archive when renamed
-	archive->signals().entry_renamed.connect([this](Archive&, ArchiveEntry& entry, string_view prev_name) {
-		auto prev_upper   = strutil::upper(prev_name);
-		auto entry_shared = entry.getShared();
-		removeEntry(entry_shared, prev_upper);
-		addEntry(entry_shared);
-
-		signals_.resources_updated();
-	});
+	// Update entries from the archive when changed (added/removed/modified/renamed),
+	// in batches on the main thread
+	resources.signal_connections += archive->signals().entries_changed.connect(
+		[this](Archive&, const vector<Archive::EntryChange>& changes) { updateEntries(changes); });
 
 	// Announce resource update
 	signals_.resources_updated();
@@ -274,30 +289,21 @@ void ResourceManager::addArchive(Archive* archive)
 // -----------------------------------------------------------------------------
 void ResourceManager::removeArchive(Archive* archive)
 {
-	// Check archive was given
-	if (!archive)
+	// Check archive was given and is managed
+	auto resources = archive_resources_.find(archive);
+	if (!archive || resources == archive_resources_.end())
 		return;
 
-	// Remove from palettes
-	removeArchiveFromMap(palettes_, archive);
-
-	// Remove from patches
-	removeArchiveFromMap(patches_, archive);
-	removeArchiveFromMap(patches_fp_, archive);
-	removeArchiveFromMap(patches_fp_only_, archive);
-
-	// Remove from flats
-	removeArchiveFromMap(flats_, archive);
-	removeArchiveFromMap(flats_fp_, archive);
-	removeArchiveFromMap(flats_fp_only_, archive);
-
-	// Remove from stand-alone textures
-	removeArchiveFromMap(satextures_, archive);
-	removeArchiveFromMap(satextures_fp_, archive);
+	// Remove from all resources with entries in the archive
+	for (auto* res : resources->second.entries)
+		res->removeArchive(archive);
 
 	// Remove any textures in the archive
-	for (auto& i : composites_)
-		i.second.remove(archive);
+	for (auto* res : resources->second.textures)
+		res->remove(archive);
+
+	// Stop listening for changes to the archive
+	archive_resources_.erase(resources);
 
 	// Announce resource update
 	signals_.resources_updated();
@@ -347,38 +353,47 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 
 	// Check for palette entry
 	if (type->id() == "palette")
-		palettes_[name].add(entry);
+		addToResource(palettes_, name, entry);
 
 	// Check for various image entries, so only accept images
 	if (type->editor() == "gfx")
 	{
+		// Get entry namespace (same as ArchiveEntry::isInNamespace, but only
+		// detected once)
+		auto archive   = entry->parent();
+		auto nspace    = archive->detectNamespace(entry.get());
+		auto is_wad    = archive->formatId() == "wad";
+		auto in_nspace = [&](string_view ns) {
+			return nspace == ns || (is_wad && ns == "graphics" && nspace == "global");
+		};
+
 		// Reject graphics that are not in a valid namespace:
 		// Patches in wads can be in the global namespace as well, and
 		// ZDoom textures can use sprites and graphics as patches
-		if (!entry->isInNamespace("global") && !entry->isInNamespace("patches") && !entry->isInNamespace("sprites")
-			&& !entry->isInNamespace("graphics") &&
+		if (!in_nspace("global") && !in_nspace("patches") && !in_nspace("sprites") && !in_nspace("graphics") &&
 			// Stand-alone textures can also be found in the hires namespace
-			!entry->isInNamespace("hires") && !entry->isInNamespace("textures") &&
+			!in_nspace("hires") && !in_nspace("textures") &&
 			// Flats are kinda boring in comparison
-			!entry->isInNamespace("flats"))
+			!in_nspace("flats"))
 			return;
 
 		bool addToFpOnly = true;
 
 		// Check for patch entry
-		if (type->extraProps().contains("patch") || entry->isInNamespace("patches") || entry->isInNamespace("sprites"))
+		if (type->extraProps().contains("patch") || in_nspace("patches") || in_nspace("sprites"))
 		{
-			if (patches_[name].length() == 0)
+			auto& patch = patches_[name];
+			if (patch.length() == 0)
 			{
 				addToFpOnly = false;
 			}
-			patches_[name].add(entry);
-			if (!entry->parent()->isTreeless())
+			addToResource(patches_, name, entry);
+			if (!archive->isTreeless())
 			{
-				patches_fp_[path].add(entry);
-				if ((lname.size() > 8 || patches_[name].length() > 0) && addToFpOnly)
+				addToResource(patches_fp_, path, entry);
+				if ((lname.size() > 8 || patch.length() > 0) && addToFpOnly)
 				{
-					patches_fp_only_[path].add(entry);
+					addToResource(patches_fp_only_, path, entry);
 				}
 			}
 		}
@@ -386,38 +401,39 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 		addToFpOnly = true;
 
 		// Check for flat entry
-		if (type->id() == "gfx_flat" || entry->isInNamespace("flats"))
+		if (type->id() == "gfx_flat" || in_nspace("flats"))
 		{
-			if (flats_[name].length() == 0)
+			auto& flat = flats_[name];
+			if (flat.length() == 0)
 			{
 				addToFpOnly = false;
 			}
-			flats_[name].add(entry);
-			if (!entry->parent()->isTreeless())
+			addToResource(flats_, name, entry);
+			if (!archive->isTreeless())
 			{
-				flats_fp_[path].add(entry);
-				if ((lname.size() > 8 || flats_[name].length() > 0) && addToFpOnly)
+				addToResource(flats_fp_, path, entry);
+				if ((lname.size() > 8 || flat.length() > 0) && addToFpOnly)
 				{
-					flats_fp_only_[path].add(entry);
+					addToResource(flats_fp_only_, path, entry);
 				}
 			}
 		}
 
 		// Check for stand-alone texture entry
-		if (entry->isInNamespace("textures"))
+		if (in_nspace("textures"))
 		{
-			satextures_[name].add(entry);
-			if (!entry->parent()->isTreeless())
+			addToResource(satextures_, name, entry);
+			if (!archive->isTreeless())
 			{
-				satextures_fp_[path].add(entry);
+				addToResource(satextures_fp_, path, entry);
 			}
 
 			// Add name to hash table
 			doom64_hash_table_[getTextureHash(name)] = name;
 		}
-		else if (entry->isInNamespace("hires"))
+		else if (in_nspace("hires"))
 		{ // Handle hi-res textures
-			hires_[name].add(entry);
+			addToResource(hires_, name, entry);
 		}
 	}
 
@@ -447,11 +463,13 @@ void ResourceManager::addEntry(shared_ptr<ArchiveEntry>& entry)
 			tx.readTEXTURESData(entry.get());
 
 		// Add all textures to resources
-		CTexture* tex;
+		auto& textures = archive_resources_[entry->parent()].textures;
 		for (unsigned a = 0; a < tx.size(); a++)
 		{
-			tex = tx.texture(a);
-			composites_[tex->name()].add(tex, entry->parent());
+			auto  tex = tx.texture(a);
+			auto& res = composites_[tex->name()];
+			res.add(tex, entry->parent());
+			textures.insert(&res);
 		}
 	}
 }
@@ -489,6 +507,9 @@ void ResourceManager::removeEntry(shared_ptr<ArchiveEntry>& entry, string_view e
 	removeEntryFromMap(satextures_, name, entry, full_check);
 	removeEntryFromMap(satextures_fp_, path, entry, full_check);
 
+	// Remove from hi-res textures
+	removeEntryFromMap(hires_, name, entry, full_check);
+
 	// Check for TEXTUREx entry
 	int txentry = 0;
 	if (entry->type()->id() == "texturex")
@@ -507,7 +528,11 @@ void ResourceManager::removeEntry(shared_ptr<ArchiveEntry>& entry, string_view e
 
 		// Remove all texture resources
 		for (unsigned a = 0; a < tx.size(); a++)
-			composites_[tx.texture(a)->name()].remove(entry->parent());
+		{
+			auto res = composites_.find(tx.texture(a)->name());
+			if (res != composites_.end())
+				res->second.remove(entry->parent());
+		}
 	}
 }
 
@@ -516,12 +541,12 @@ void ResourceManager::removeEntry(shared_ptr<ArchiveEntry>& entry, string_view e
 // -----------------------------------------------------------------------------
 void ResourceManager::listAllPatches()
 {
-	for (auto& i : patches_)
+	for (auto* i : sortedResources(patches_))
 	{
-		if (i.second.length() == 0)
+		if (i->second.length() == 0)
 			continue;
 
-		log::info("{} ({})", i.first, i.second.length());
+		log::info("{} ({})", i->first, i->second.length());
 	}
 }
 
@@ -530,9 +555,9 @@ void ResourceManager::listAllPatches()
 // -----------------------------------------------------------------------------
 void ResourceManager::putAllPatchEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath)
 {
-	for (auto& i : patches_)
+	for (auto* i : sortedResources(patches_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -540,9 +565,9 @@ void ResourceManager::putAllPatchEntries(vector<ArchiveEntry*>& list, Archive* p
 	if (!fullPath)
 		return;
 
-	for (auto& i : patches_fp_only_)
+	for (auto* i : sortedResources(patches_fp_only_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -554,13 +579,13 @@ void ResourceManager::putAllPatchEntries(vector<ArchiveEntry*>& list, Archive* p
 void ResourceManager::putAllTextures(vector<TextureResource::Texture*>& list, Archive* priority, Archive* ignore)
 {
 	// Add all primary textures to the list
-	for (auto& i : composites_)
+	for (auto* i : sortedResources(composites_))
 	{
 		// Skip if no entries
-		if (i.second.length() == 0)
+		if (i->second.length() == 0)
 			continue;
 
-		const auto& tex_res = i.second;
+		const auto& tex_res = i->second;
 
 		// Go through resource textures
 		auto* best_res = tex_res.textures_[0].get();
@@ -598,9 +623,9 @@ void ResourceManager::putAllTextures(vector<TextureResource::Texture*>& list, Ar
 void ResourceManager::putAllTextureNames(vector<string>& list)
 {
 	// Add all primary textures to the list
-	for (auto& i : composites_)
-		if (i.second.length() > 0) // Ignore if no entries
-			list.push_back(i.first);
+	for (auto* i : sortedResources(composites_))
+		if (i->second.length() > 0) // Ignore if no entries
+			list.push_back(i->first);
 }
 
 // -----------------------------------------------------------------------------
@@ -608,9 +633,9 @@ void ResourceManager::putAllTextureNames(vector<string>& list)
 // -----------------------------------------------------------------------------
 void ResourceManager::putAllFlatEntries(vector<ArchiveEntry*>& list, Archive* priority, bool fullPath)
 {
-	for (auto& i : flats_)
+	for (auto* i : sortedResources(flats_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -618,9 +643,9 @@ void ResourceManager::putAllFlatEntries(vector<ArchiveEntry*>& list, Archive* pr
 	if (!fullPath)
 		return;
 
-	for (auto& i : flats_fp_only_)
+	for (auto* i : sortedResources(flats_fp_only_))
 	{
-		auto* entry = i.second.getEntry(priority);
+		auto* entry = i->second.getEntry(priority);
 		if (entry)
 			list.push_back(entry);
 	}
@@ -632,9 +657,9 @@ void ResourceManager::putAllFlatEntries(vector<ArchiveEntry*>& list, Archive* pr
 void ResourceManager::putAllFlatNames(vector<string>& list)
 {
 	// Add all primary flats to the list
-	for (auto& i : flats_)
-		if (i.second.length() > 0) // Ignore if no entries
-			list.push_back(i.first);
+	for (auto* i : sortedResources(flats_))
+		if (i->second.length() > 0) // Ignore if no entries
+			list.push_back(i->first);
 }
 
 // -----------------------------------------------------------------------------
@@ -643,7 +668,7 @@ void ResourceManager::putAllFlatNames(vector<string>& list)
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getPaletteEntry(string_view palette, Archive* priority)
 {
-	return palettes_[strutil::upper(palette)].getEntry(priority);
+	return resourceEntry(palettes_, strutil::upper(palette), priority);
 }
 
 // -----------------------------------------------------------------------------
@@ -661,11 +686,11 @@ ArchiveEntry* ResourceManager::getPatchEntry(string_view patch, string_view nspa
 		return getTextureEntry(patch, "textures", priority);
 
 	auto  patch_upper = strutil::upper(patch);
-	auto* entry       = patches_[patch_upper].getEntry(priority, nspace, true);
+	auto* entry       = resourceEntry(patches_, patch_upper, priority, nspace, true);
 	if (entry)
 		return entry;
 
-	entry = patches_fp_[patch_upper].getEntry(priority, nspace, true);
+	entry = resourceEntry(patches_fp_, patch_upper, priority, nspace, true);
 	if (entry)
 		return entry;
 
@@ -678,16 +703,13 @@ ArchiveEntry* ResourceManager::getPatchEntry(string_view patch, string_view nspa
 // -----------------------------------------------------------------------------
 ArchiveEntry* ResourceManager::getFlatEntry(string_view flat, Archive* priority)
 {
-	// Check resource with matching name exists
-	auto  flat_upper = strutil::upper(flat);
-	auto& res        = flats_[flat_upper];
-
 	// Return most relevant entry
-	auto* entry = res.getEntry(priority);
+	auto  flat_upper = strutil::upper(flat);
+	auto* entry      = resourceEntry(flats_, flat_upper, priority);
 	if (entry)
 		return entry;
 
-	entry = flats_fp_[flat_upper].getEntry(priority, "flats", true);
+	entry = resourceEntry(flats_fp_, flat_upper, priority, "flats", true);
 	if (entry)
 		return entry;
 
@@ -701,11 +723,11 @@ ArchiveEntry* ResourceManager::getFlatEntry(string_view flat, Archive* priority)
 ArchiveEntry* ResourceManager::getTextureEntry(string_view texture, string_view nspace, Archive* priority)
 {
 	auto  tex_upper = strutil::upper(texture);
-	auto* entry     = satextures_[tex_upper].getEntry(priority, nspace, true);
+	auto* entry     = resourceEntry(satextures_, tex_upper, priority, nspace, true);
 	if (entry)
 		return entry;
 
-	entry = satextures_fp_[tex_upper].getEntry(priority, nspace, true);
+	entry = resourceEntry(satextures_fp_, tex_upper, priority, nspace, true);
 	if (entry)
 		return entry;
 
@@ -719,9 +741,10 @@ ArchiveEntry* ResourceManager::getTextureEntry(string_view texture, string_view
 CTexture* ResourceManager::getTexture(string_view texture, string_view type, Archive* priority, Archive* ignore)
 {
 	// Check texture resource with matching name exists
-	auto& res = composites_[strutil::upper(texture)];
-	if (res.textures_.empty())
+	auto found = composites_.find(strutil::upper(texture));
+	if (found == composites_.end() || found->second.textures_.empty())
 		return nullptr;
+	auto& res = found->second;
 
 	// Go through resource textures
 	auto* tex    = &res.textures_[0]->tex;
@@ -759,20 +782,37 @@ CTexture* ResourceManager::getTexture(string_view texture, string_view type, Arc
 ArchiveEntry* ResourceManager::getHiresEntry(string_view texture, Archive* priority)
 {
 	// Hi-res textures can only be used with a short name
-	return hires_[strutil::upper(texture)].getEntry(priority, "hires", true);
+	return resourceEntry(hires_, strutil::upper(texture), priority, "hires", true);
 }
 
-void ResourceManager::updateEntry(ArchiveEntry& entry, bool remove, bool add)
+// -----------------------------------------------------------------------------
+// Updates resources from a batch of entry [changes] in a managed archive
+// -----------------------------------------------------------------------------
+void ResourceManager::updateEntries(const vector<Archive::EntryChange>& changes)
 {
-	auto sptr = entry.getShared();
-	if (remove)
-		removeEntry(sptr);
-	if (add)
-		addEntry(sptr);
+	for (const auto& change : changes)
+	{
+		auto entry = change.entry;
+		if (change.existedBefore())
+			removeEntry(entry, change.renamed ? strutil::upper(change.prev_name) : "");
+		if (change.existsAfter())
+			addEntry(entry);
+	}
 
 	signals_.resources_updated();
 }
 
+// -----------------------------------------------------------------------------
+// Adds [entry] to the resource [name] in [map], and records that the entry's
+// archive has entries in that resource
+// -----------------------------------------------------------------------------
+void ResourceManager::addToResource(EntryResourceMap& map, const string& name, shared_ptr<ArchiveEntry>& entry)
+{
+	auto& res = map[name];
+	res.add(entry);
+	archive_resources_[entry->parent()].entries.insert(&res);
+}
+
 
 // -----------------------------------------------------------------------------
 //
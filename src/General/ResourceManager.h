@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Archive/Archive.h"
+#include "General/Sigslot.h"
 #include "Graphics/CTexture/CTexture.h"
+#include <unordered_set>
 
 namespace slade
 {
@@ -67,8 +69,8 @@ private:
 	vector<unique_ptr<Texture>> textures_;
 };
 
-typedef std::map<string, EntryResource>   EntryResourceMap;
-typedef std::map<string, TextureResource> TextureResourceMap;
+typedef std::unordered_map<string, EntryResource>   EntryResourceMap;
+typedef std::unordered_map<string, TextureResource> TextureResourceMap;
 
 class ResourceManager
 {
@@ -127,8 +129,19 @@ private:
 	TextureResourceMap composites_; // Composite textures (defined in a TEXTUREx/TEXTURES lump)
 	Signals            signals_;
 
+	// Resources containing entries/textures from each managed archive, so an
+	// archive can be removed without checking every resource
+	struct ArchiveResources
+	{
+		std::unordered_set<EntryResource*>   entries;
+		std::unordered_set<TextureResource*> textures;
+		ScopedConnectionList                 signal_connections;
+	};
+	std::unordered_map<Archive*, ArchiveResources> archive_resources_;
+
 	static string doom64_hash_table_[65536];
 
-	void updateEntry(ArchiveEntry& entry, bool remove, bool add);
+	void updateEntries(const vector<Archive::EntryChange>& changes);
+	void addToResource(EntryResourceMap& map, const string& name, shared_ptr<ArchiveEntry>& entry);
 };
 } // namespace slade
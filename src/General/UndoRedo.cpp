@@ -31,6 +31,9 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "General/UndoRedo.h"
+#include "App.h"
+#include "Utility/Compression.h"
+#include "Utility/FileUtils.h"
 
 using namespace slade;
 
@@ -40,9 +43,11 @@ using namespace slade;
 // Variables
 //
 // -----------------------------------------------------------------------------
+CVAR(Int, undo_memory_budget, 256, CVar::Flag::Save) // In MB, 0 for no limit
 namespace
 {
 UndoManager* current_undo_manager = nullptr;
+unsigned     spill_file_count     = 0;
 } // namespace
 
 
@@ -58,6 +63,15 @@ UndoManager* current_undo_manager = nullptr;
 // -----------------------------------------------------------------------------
 UndoLevel::UndoLevel(string_view name) : name_{ name }, timestamp_{ wxDateTime::Now() } {}
 
+// -----------------------------------------------------------------------------
+// UndoLevel class destructor
+// -----------------------------------------------------------------------------
+UndoLevel::~UndoLevel()
+{
+	if (isSpilled())
+		fileutil::removeFile(spill_file_);
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string representation of the time at which the undo level was
 // recorded
@@ -77,6 +91,9 @@ string UndoLevel::timeStamp(bool date, bool time) const
 // -----------------------------------------------------------------------------
 bool UndoLevel::doUndo()
 {
+	if (isSpilled() && !unspill())
+		return false;
+
 	log::info(3, "Performing undo \"{}\" ({} steps)", name_, undo_steps_.size());
 	bool ok = true;
 	for (int a = (int)undo_steps_.size() - 1; a >= 0; a--)
@@ -93,6 +110,9 @@ bool UndoLevel::doUndo()
 // -----------------------------------------------------------------------------
 bool UndoLevel::doRedo()
 {
+	if (isSpilled() && !unspill())
+		return false;
+
 	log::info(3, "Performing redo \"{}\" ({} steps)", name_, undo_steps_.size());
 	bool ok = true;
 	for (auto& undo_step : undo_steps_)
@@ -105,19 +125,33 @@ bool UndoLevel::doRedo()
 }
 
 // -----------------------------------------------------------------------------
-// Reads the undo level from a file
+// Reads the undo level's step data from a file
 // -----------------------------------------------------------------------------
 bool UndoLevel::readFile(string_view filename) const
 {
+	MemChunk mc;
+	if (!mc.importFile(filename) || !compression::decompressInternal(mc))
+		return false;
+
+	mc.seekFromStart(0);
+	for (auto& undo_step : undo_steps_)
+		if (!undo_step->readFile(mc))
+			return false;
+
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Writes the undo level to a file
+// Writes the undo level's step data to a file
 // -----------------------------------------------------------------------------
 bool UndoLevel::writeFile(string_view filename) const
 {
-	return true;
+	MemChunk mc;
+	for (auto& undo_step : undo_steps_)
+		if (!undo_step->writeFile(mc))
+			return false;
+
+	return compression::compressInternal(mc) && mc.exportFile(filename);
 }
 
 // -----------------------------------------------------------------------------
@@ -136,6 +170,62 @@ void UndoLevel::createMerged(vector<unique_ptr<UndoLevel>>& levels)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns the memory used by the level's undo step data
+// -----------------------------------------------------------------------------
+unsigned UndoLevel::memoryUsage() const
+{
+	unsigned usage = 0;
+	for (auto& undo_step : undo_steps_)
+		usage += undo_step->memoryUsage();
+
+	return usage;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the level's undo step data to [filename] and frees it from memory,
+// until it is needed again for an undo or redo
+// -----------------------------------------------------------------------------
+bool UndoLevel::spill(string_view filename)
+{
+	if (isSpilled())
+		return true;
+
+	if (!writeFile(filename))
+	{
+		log::warning("Unable to write undo level \"{}\" to {}", name_, filename);
+		fileutil::removeFile(filename);
+		return false;
+	}
+
+	for (auto& undo_step : undo_steps_)
+		undo_step->clearData();
+	spill_file_ = filename;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the level's undo step data back into memory, if it was spilled to a
+// file previously
+// -----------------------------------------------------------------------------
+bool UndoLevel::unspill()
+{
+	if (!isSpilled())
+		return true;
+
+	if (!readFile(spill_file_))
+	{
+		log::error("Unable to read undo level \"{}\" from {}", name_, spill_file_);
+		return false;
+	}
+
+	fileutil::removeFile(spill_file_);
+	spill_file_.clear();
+
+	return true;
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -198,9 +288,24 @@ void UndoManager::endRecord(bool success)
 	// Clear current undo manager
 	current_undo_manager = nullptr;
 
+	applyMemoryBudget();
+
 	signals_.level_recorded();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the memory used by all undo levels' data (not including levels
+// spilled to disk)
+// -----------------------------------------------------------------------------
+uint64_t UndoManager::memoryUsage() const
+{
+	uint64_t usage = 0;
+	for (auto& level : undo_levels_)
+		usage += level->memoryUsage();
+
+	return usage;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if this manager is currently recording an undo level
 // -----------------------------------------------------------------------------
@@ -342,6 +447,34 @@ bool UndoManager::createMergedLevel(UndoManager* manager, string_view name)
 }
 
 
+// -----------------------------------------------------------------------------
+// Writes the oldest undo levels to temp files (freeing their data from memory)
+// until the memory used by all levels is within the undo_memory_budget cvar
+// -----------------------------------------------------------------------------
+void UndoManager::applyMemoryBudget() const
+{
+	if (undo_memory_budget <= 0)
+		return;
+
+	uint64_t budget = static_cast<uint64_t>(undo_memory_budget) * 1024 * 1024;
+	uint64_t usage  = memoryUsage();
+
+	// Leave the most recent level in memory, it's the most likely to be undone
+	for (unsigned a = 0; usage > budget && a + 1 < undo_levels_.size(); a++)
+	{
+		auto& level = undo_levels_[a];
+		auto  size  = level->memoryUsage();
+		if (level->isSpilled() || size == 0)
+			continue;
+
+		auto filename = app::path(
+			fmt::format("slade-undo-{}-{}.tmp", wxGetProcessId(), spill_file_count++), app::Dir::Temp);
+		if (level->spill(filename))
+			usage -= size - level->memoryUsage();
+	}
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // UndoRedo Namespace Functions
@@ -13,13 +13,18 @@ public:
 	virtual bool writeFile(MemChunk& mc) { return true; }
 	virtual bool readFile(MemChunk& mc) { return true; }
 	virtual bool isOk() { return true; }
+
+	// Memory used by the step's data (that can be written to a file), and
+	// frees it once it has been written
+	virtual unsigned memoryUsage() const { return 0; }
+	virtual void     clearData() {}
 };
 
 class UndoLevel
 {
 public:
 	UndoLevel(string_view name);
-	~UndoLevel() = default;
+	~UndoLevel();
 
 	string name() const { return name_; }
 	bool   doUndo();
@@ -31,10 +36,16 @@ public:
 	bool readFile(string_view filename) const;
 	void createMerged(vector<unique_ptr<UndoLevel>>& levels);
 
+	unsigned memoryUsage() const;
+	bool     isSpilled() const { return !spill_file_.empty(); }
+	bool     spill(string_view filename);
+	bool     unspill();
+
 private:
 	string                       name_;
 	vector<unique_ptr<UndoStep>> undo_steps_;
 	wxDateTime                   timestamp_;
+	string                       spill_file_; // File the steps' data was written to, if it isn't in memory
 };
 
 class SLADEMap;
@@ -49,6 +60,7 @@ public:
 	int        currentIndex() const { return current_level_index_; }
 	unsigned   nUndoLevels() const { return undo_levels_.size(); }
 	UndoLevel* undoLevel(unsigned index) const { return undo_levels_[index].get(); }
+	uint64_t   memoryUsage() const;
 
 	void   beginRecord(string_view name);
 	void   endRecord(bool success);
@@ -79,6 +91,8 @@ private:
 	bool                          undo_running_        = false;
 	SLADEMap*                     map_                 = nullptr;
 	Signals                       signals_;
+
+	void applyMemoryBudget() const;
 };
 
 namespace undoredo
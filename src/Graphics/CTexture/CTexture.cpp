@@ -415,6 +415,15 @@ int CTexture::index() const
 	return in_list_->textureIndex(name());
 }
 
+// -----------------------------------------------------------------------------
+// Sets the texture name to [name]
+// -----------------------------------------------------------------------------
+void CTexture::setName(string_view name)
+{
+	name_ = name;
+	invalidateListIndexes(true, false);
+}
+
 // -----------------------------------------------------------------------------
 // Clears all texture data
 // -----------------------------------------------------------------------------
@@ -431,6 +440,7 @@ void CTexture::clear()
 	null_texture_  = false;
 	offset_        = { 0, 0 };
 	patches_.clear();
+	invalidateListIndexes(true, true);
 }
 
 // -----------------------------------------------------------------------------
@@ -456,6 +466,7 @@ bool CTexture::addPatch(string_view patch, int16_t offset_x, int16_t offset_y, i
 	defined_ = false;
 
 	// Announce
+	invalidateListIndexes(false, true);
 	signals_.patches_modified(*this);
 
 	return true;
@@ -478,6 +489,7 @@ bool CTexture::removePatch(size_t index)
 	defined_ = false;
 
 	// Announce
+	invalidateListIndexes(false, true);
 	signals_.patches_modified(*this);
 
 	return true;
@@ -505,7 +517,10 @@ bool CTexture::removePatch(string_view patch)
 	defined_ = false;
 
 	if (removed)
+	{
+		invalidateListIndexes(false, true);
 		signals_.patches_modified(*this);
+	}
 
 	return removed;
 }
@@ -525,6 +540,7 @@ bool CTexture::replacePatch(size_t index, string_view newpatch)
 	patches_[index]->setName(newpatch);
 
 	// Announce
+	invalidateListIndexes(false, true);
 	signals_.patches_modified(*this);
 
 	return true;
@@ -561,6 +577,7 @@ bool CTexture::duplicatePatch(size_t index, int16_t offset_x, int16_t offset_y)
 	defined_ = false;
 
 	// Announce
+	invalidateListIndexes(false, true);
 	signals_.patches_modified(*this);
 
 	return true;
@@ -580,6 +597,7 @@ bool CTexture::swapPatches(size_t p1, size_t p2)
 	patches_[p1].swap(patches_[p2]);
 
 	// Announce
+	invalidateListIndexes(false, true);
 	signals_.patches_modified(*this);
 
 	return true;
@@ -599,6 +617,7 @@ bool CTexture::parse(Tokenizer& tz, string_view type)
 	extended_ = true;
 	defined_  = false;
 	name_     = strutil::upper(tz.next().text);
+	invalidateListIndexes(true, true);
 	tz.adv(); // Skip ,
 	size_.x = tz.next().asInt();
 	tz.adv(); // Skip ,
@@ -678,6 +697,7 @@ bool CTexture::parseDefine(Tokenizer& tz)
 	extended_   = true;
 	defined_    = true;
 	name_       = strutil::upper(tz.next().text);
+	invalidateListIndexes(true, true);
 	def_size_.x = tz.next().asInt();
 	def_size_.y = tz.next().asInt();
 	size_       = def_size_;
@@ -917,7 +937,7 @@ bool CTexture::toImage(SImage& image, Archive* parent, Palette* pal, bool force_
 		// Add each patch to image
 		for (auto& patch : patches_)
 		{
-			if (misc::loadImageFromEntry(&p_img, patch->patchEntry(parent)))
+			if (misc::loadCachedImageFromEntry(&p_img, patch->patchEntry(parent)))
 				image.drawImage(p_img, patch->xOffset(), patch->yOffset(), dp, pal, pal);
 		}
 	}
@@ -973,13 +993,28 @@ bool CTexture::loadPatchImage(unsigned pindex, SImage& image, Archive* parent, P
 
 	// Load entry to image if valid
 	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+		return misc::loadCachedImageFromEntry(&image, entry);
 
 	// Maybe it's a texture?
 	entry = app::resources().getTextureEntry(patch->name(), "", parent);
 
 	if (entry)
-		return misc::loadImageFromEntry(&image, entry);
+		return misc::loadCachedImageFromEntry(&image, entry);
 
 	return false;
 }
+
+// -----------------------------------------------------------------------------
+// Invalidates the texture name ([name]) and/or patch usage ([patches]) indexes
+// of the list this texture is in, after it was modified
+// -----------------------------------------------------------------------------
+void CTexture::invalidateListIndexes(bool name, bool patches) const
+{
+	if (!in_list_)
+		return;
+
+	if (name)
+		in_list_->invalidateNameIndex();
+	if (patches)
+		in_list_->invalidatePatchUsage();
+}
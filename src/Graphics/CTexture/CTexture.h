@@ -141,7 +141,7 @@ public:
 	uint8_t        state() const { return state_; }
 	int            index() const;
 
-	void setName(string_view name) { name_ = name; }
+	void setName(string_view name);
 	void setSize(const Vec2<uint16_t>& size) { size_ = size; }
 	void setWidth(uint16_t width) { size_.x = width; }
 	void setHeight(uint16_t height) { size_.y = height; }
@@ -210,5 +210,7 @@ private:
 
 	// Signals
 	Signals signals_;
+
+	void invalidateListIndexes(bool name, bool patches) const;
 };
 } // namespace slade
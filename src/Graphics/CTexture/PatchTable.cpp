@@ -35,6 +35,7 @@
 #include "App.h"
 #include "CTexture.h"
 #include "General/ResourceManager.h"
+#include "TextureXList.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -65,14 +66,8 @@ PatchTable::Patch& PatchTable::patch(size_t index)
 // -----------------------------------------------------------------------------
 PatchTable::Patch& PatchTable::patch(string_view name)
 {
-	// Go through list
-	for (auto& patch : patches_)
-	{
-		if (patch.name == name)
-			return patch;
-	}
-
-	return patch_invalid_;
+	auto index = patchIndex(name);
+	return index < 0 ? patch_invalid_ : patches_[index];
 }
 
 // -----------------------------------------------------------------------------
@@ -113,15 +108,8 @@ ArchiveEntry* PatchTable::patchEntry(size_t index)
 // -----------------------------------------------------------------------------
 ArchiveEntry* PatchTable::patchEntry(string_view name)
 {
-	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return patchEntry(a);
-	}
-
-	// Not found
-	return nullptr;
+	auto index = patchIndex(name);
+	return index < 0 ? nullptr : patchEntry(index);
 }
 
 // -----------------------------------------------------------------------------
@@ -129,15 +117,8 @@ ArchiveEntry* PatchTable::patchEntry(string_view name)
 // -----------------------------------------------------------------------------
 int32_t PatchTable::patchIndex(string_view name) const
 {
-	// Search for patch by name
-	for (size_t a = 0; a < patches_.size(); a++)
-	{
-		if (strutil::equalCI(patches_[a].name, name))
-			return a;
-	}
-
-	// Not found
-	return -1;
+	auto i = name_index_.find(strutil::upper(name));
+	return i == name_index_.end() ? -1 : i->second;
 }
 
 // -----------------------------------------------------------------------------
@@ -170,6 +151,24 @@ bool PatchTable::removePatch(unsigned index)
 	// Remove the patch
 	patches_.erase(patches_.begin() + index);
 
+	// Update name index, shifting down the indices of patches after it
+	if (name_index_.size() == patches_.size() + 1)
+	{
+		for (auto i = name_index_.begin(); i != name_index_.end();)
+		{
+			if (i->second == static_cast<int32_t>(index))
+				i = name_index_.erase(i);
+			else
+			{
+				if (i->second > static_cast<int32_t>(index))
+					--i->second;
+				++i;
+			}
+		}
+	}
+	else
+		rebuildNameIndex(); // Duplicate names, the removed patch may not be the indexed one
+
 	// Announce
 	signals_.modified();
 
@@ -190,6 +189,7 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 
 	// Change the patch name
 	patches_[index].name = newname;
+	rebuildNameIndex();
 
 	// Announce
 	signals_.modified();
@@ -203,14 +203,9 @@ bool PatchTable::replacePatch(unsigned index, string_view newname)
 bool PatchTable::addPatch(string_view name, bool allow_dup)
 {
 	// Check patch doesn't already exist
-	if (!allow_dup)
-	{
-		for (auto& patch : patches_)
-		{
-			if (name == patch.name)
-				return false;
-		}
-	}
+	auto index = name_index_.try_emplace(strutil::upper(name), static_cast<int32_t>(patches_.size()));
+	if (!index.second && !allow_dup)
+		return false;
 
 	// Add the patch
 	patches_.emplace_back(name);
@@ -235,6 +230,8 @@ bool PatchTable::loadPNAMES(ArchiveEntry* pnames, Archive* parent)
 
 	// Clear current table
 	patches_.clear();
+	name_index_.clear();
+	texture_usage_.clear();
 
 	// Setup parent archive
 	if (!parent)
@@ -321,6 +318,8 @@ void PatchTable::clearPatchUsage()
 {
 	for (auto& patch : patches_)
 		patch.used_in.clear();
+	patch_invalid_.used_in.clear();
+	texture_usage_.clear();
 
 	// Announce
 	signals_.modified();
@@ -331,14 +330,53 @@ void PatchTable::clearPatchUsage()
 // -----------------------------------------------------------------------------
 void PatchTable::updatePatchUsage(CTexture* tex)
 {
-	// Remove texture from all patch usage tables
-	for (auto& patch : patches_)
-		patch.removeTextureUsage(tex->name());
+	// Remove texture from the usage tables of the patches it was last recorded
+	// as using
+	auto range = texture_usage_.equal_range(tex->name());
+	for (auto i = range.first; i != range.second; ++i)
+		patch(i->second).removeTextureUsage(tex->name());
+	texture_usage_.erase(range.first, range.second);
 
 	// Update patch usage counts for texture
-	for (unsigned a = 0; a < tex->nPatches(); a++)
-		patch(tex->patch(a)->name()).used_in.push_back(tex->name());
+	addTextureUsage(tex);
 
 	// Announce
 	signals_.modified();
 }
+
+// -----------------------------------------------------------------------------
+// Updates patch usage data for all textures in [list]
+// -----------------------------------------------------------------------------
+void PatchTable::updatePatchUsage(const TextureXList& list)
+{
+	signals_.modified.block();
+	for (auto& tex : list.textures())
+		updatePatchUsage(tex.get());
+	signals_.modified.unblock();
+
+	// Announce
+	signals_.modified();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the patch name -> index lookup
+// -----------------------------------------------------------------------------
+void PatchTable::rebuildNameIndex()
+{
+	name_index_.clear();
+	for (unsigned a = 0; a < patches_.size(); a++)
+		name_index_.try_emplace(strutil::upper(patches_[a].name), a);
+}
+
+// -----------------------------------------------------------------------------
+// Adds [tex] to the usage tables of all patches it uses
+// -----------------------------------------------------------------------------
+void PatchTable::addTextureUsage(CTexture* tex)
+{
+	for (unsigned a = 0; a < tex->nPatches(); a++)
+	{
+		auto& name = tex->patch(a)->name();
+		patch(name).used_in.push_back(tex->name());
+		texture_usage_.emplace(tex->name(), name);
+	}
+}
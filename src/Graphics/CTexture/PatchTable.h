@@ -1,10 +1,12 @@
 #pragma once
 
 #include "Archive/ArchiveEntry.h"
+#include <unordered_map>
 
 namespace slade
 {
 class CTexture;
+class TextureXList;
 
 class PatchTable
 {
@@ -53,6 +55,7 @@ public:
 
 	void clearPatchUsage();
 	void updatePatchUsage(CTexture* tex);
+	void updatePatchUsage(const TextureXList& list);
 
 	// Signals
 	struct Signals
@@ -66,5 +69,14 @@ private:
 	vector<Patch> patches_;
 	Patch         patch_invalid_{ "INVALID_PATCH" };
 	Signals       signals_;
+
+	// Upper-case patch name -> index of the (first) patch with that name
+	std::unordered_map<string, int32_t> name_index_;
+
+	// Texture name -> names of the patches it was recorded in the usage of
+	std::unordered_multimap<string, string> texture_usage_;
+
+	void rebuildNameIndex();
+	void addTextureUsage(CTexture* tex);
 };
 } // namespace slade
@@ -34,9 +34,11 @@
 #include "TextureXList.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveManager.h"
+#include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "MainEditor/MainEditor.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 
 using namespace slade;
@@ -105,9 +107,305 @@ struct StrifeTexDef
 	int16_t  height;
 	int16_t  patchcount;
 };
+
+// A run of top-level TEXTURES definitions to be parsed together
+struct DefinitionRange
+{
+	size_t start;
+	size_t end;
+	bool   main_thread; // True if the definitions look up resources, so must be parsed on the main thread
+};
+
+// A snapshot of a texture list's patch references for error checking, so that
+// it can be done off the main thread
+struct ErrorCheck
+{
+	struct Patch
+	{
+		string name;
+		int    x_offset;
+		int    image; // Index in [images], or -1 if no entry was found for the patch
+	};
+	struct Texture
+	{
+		string        name;
+		unsigned      width;
+		vector<Patch> patches;
+	};
+
+	vector<Texture>  textures;
+	vector<MemChunk> images;
+	vector<int>      image_widths;
+};
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned DEFINITIONS_PER_TASK = 256; // Max. TEXTURES definitions per thread pool task
+
+// TEXTURES top-level definition keywords (other than the HIRESTEX Define)
+const char* texture_types[] = { "Texture", "Sprite", "Graphic", "WallTexture", "Flat" };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Splits TEXTURES [data] into ranges of up to [batch_size] top-level
+// definitions, found by a quick scan for definition keywords outside of any
+// block, comment or string. Definitions that look up resources (HIRESTEX
+// defines and translation tables) are split into separate main thread ranges
+// -----------------------------------------------------------------------------
+vector<DefinitionRange> splitDefinitions(const MemChunk& data, unsigned batch_size)
+{
+	auto text = reinterpret_cast<const char*>(data.data());
+	auto size = static_cast<size_t>(data.size());
+
+	// Returns true if [c] is part of a plain (unquoted) token
+	auto is_token_char = [](char c) {
+		return !isspace(static_cast<unsigned char>(c)) && c != '"'
+			   && Tokenizer::DEFAULT_SPECIAL_CHARACTERS.find(c) == string::npos;
+	};
+
+	// Find the start of each definition
+	vector<std::pair<size_t, bool>> defs; // Start, main thread
+	int                             depth = 0;
+	size_t                          pos   = 0;
+	while (pos < size)
+	{
+		auto c    = text[pos];
+		auto next = pos + 1 < size ? text[pos + 1] : 0;
+
+		// Line comment
+		if ((c == '/' && next == '/') || (c == '#' && next == '#'))
+		{
+			while (pos < size && text[pos] != '\n')
+				++pos;
+		}
+
+		// Block comment
+		else if (c == '/' && next == '*')
+		{
+			auto end = string_view{ text, size }.find("*/", pos + 2);
+			pos      = end == string_view::npos ? size : end + 2;
+		}
+
+		// Quoted string ("$@" translation tables are looked up in resources)
+		else if (c == '"')
+		{
+			if (next == '$' && pos + 2 < size && text[pos + 2] == '@' && !defs.empty())
+				defs.back().second = true;
+			for (++pos; pos < size && text[pos] != '"'; ++pos)
+				if (text[pos] == '\\')
+					++pos;
+			++pos;
+		}
+
+		// Block
+		else if (c == '{' || c == '}')
+		{
+			depth = c == '{' ? depth + 1 : std::max(0, depth - 1);
+			++pos;
+		}
+
+		// Token, check for top-level definition keyword
+		else if (is_token_char(c))
+		{
+			auto end = pos;
+			while (end < size && is_token_char(text[end]))
+				++end;
+
+			if (depth == 0)
+			{
+				string_view token{ text + pos, end - pos };
+				if (strutil::equalCI(token, "Define"))
+					defs.emplace_back(pos, true);
+				else
+					for (auto type : texture_types)
+						if (strutil::equalCI(token, type))
+						{
+							defs.emplace_back(pos, false);
+							break;
+						}
+			}
+
+			pos = end;
+		}
+
+		else
+			++pos;
+	}
+
+	// Group definitions into ranges
+	vector<DefinitionRange> ranges;
+	unsigned                n_defs = 0;
+	for (auto& def : defs)
+	{
+		if (ranges.empty() || ranges.back().main_thread != def.second || n_defs >= batch_size)
+		{
+			if (!ranges.empty())
+				ranges.back().end = def.first;
+			ranges.push_back({ ranges.empty() ? 0 : def.first, size, def.second });
+			n_defs = 0;
+		}
+		++n_defs;
+	}
+
+	return ranges;
+}
+
+// -----------------------------------------------------------------------------
+// Parses all TEXTURES definitions from [tz], adding them to [textures]
+// -----------------------------------------------------------------------------
+void parseDefinitions(Tokenizer& tz, vector<unique_ptr<CTexture>>& textures)
+{
+	while (!tz.atEnd())
+	{
+		// Old HIRESTEX "Define"
+		if (tz.checkNC("Define"))
+		{
+			auto tex = std::make_unique<CTexture>();
+			if (tex->parseDefine(tz))
+				textures.push_back(std::move(tex));
+		}
+
+		// Texture/Sprite/Graphic/WallTexture/Flat definition
+		else
+		{
+			for (auto type : texture_types)
+				if (tz.checkNC(type))
+				{
+					auto tex = std::make_unique<CTexture>();
+					if (tex->parse(tz, type))
+						textures.push_back(std::move(tex));
+					break;
+				}
+		}
+
+		tz.adv();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns an error check snapshot of [textures]. Patch entries are looked up
+// once each, and the data of each entry found is copied so the check can be
+// finished on another thread
+// -----------------------------------------------------------------------------
+unique_ptr<ErrorCheck> prepareErrorCheck(const vector<unique_ptr<CTexture>>& textures)
+{
+	auto                                   check = std::make_unique<ErrorCheck>();
+	std::unordered_map<ArchiveEntry*, int> image_index;
+	vector<ArchiveEntry*>                  entries;
+
+	check->textures.resize(textures.size());
+	for (unsigned a = 0; a < textures.size(); a++)
+	{
+		auto& texture = check->textures[a];
+		texture.name  = textures[a]->name();
+		texture.width = textures[a]->width();
+		for (auto& patch : textures[a]->patches())
+		{
+			int image = -1;
+			if (auto entry = patch->patchEntry())
+			{
+				auto i = image_index.try_emplace(entry, static_cast<int>(entries.size()));
+				if (i.second)
+					entries.push_back(entry);
+				image = i.first->second;
+			}
+			texture.patches.push_back({ patch->name(), patch->xOffset(), image });
+		}
+	}
+
+	check->images.resize(entries.size());
+	for (unsigned a = 0; a < entries.size(); a++)
+		check->images[a].importMem(entries[a]->data());
+
+	return check;
+}
+
+// -----------------------------------------------------------------------------
+// Gets the width of each image in [check]. If [parallel] is true the images
+// are split across the thread pool
+// -----------------------------------------------------------------------------
+void measureImages(ErrorCheck& check, bool parallel)
+{
+	auto measure = [&check](size_t index) {
+		auto& data                = check.images[index];
+		check.image_widths[index] = SIFormat::determineFormat(data)->info(data).width;
+	};
+
+	check.image_widths.resize(check.images.size());
+	if (parallel)
+		threadpool::parallelFor(check.images.size(), measure);
+	else
+		for (size_t a = 0; a < check.images.size(); ++a)
+			measure(a);
+}
+
+// -----------------------------------------------------------------------------
+// Logs any errors found in [check] (see TextureXList::findErrors).
+// Returns true if any errors were found
+// -----------------------------------------------------------------------------
+bool logErrors(const ErrorCheck& check)
+{
+	bool ret = false;
+
+	for (unsigned a = 0; a < check.textures.size(); a++)
+	{
+		auto& texture = check.textures[a];
+		if (texture.patches.empty())
+		{
+			ret = true;
+			log::warning("Texture {}: {} does not have any patch", a, texture.name);
+			continue;
+		}
+
+		vector<uint8_t> columns(texture.width, 0);
+		for (auto& patch : texture.patches)
+		{
+			if (patch.image < 0)
+			{
+				ret = true;
+				log::warning(
+					"Texture {}: {}: patch {} cannot be found in any open archive", a, texture.name, patch.name);
+				// Don't list missing columns when we don't know the size of the patch
+				std::fill(columns.begin(), columns.end(), 1);
+			}
+			else
+			{
+				size_t start = std::max<int>(0, patch.x_offset);
+				size_t end   = std::min<size_t>(texture.width, check.image_widths[patch.image] + start);
+				for (size_t c = start; c < end; ++c)
+					columns[c] = 1;
+			}
+		}
+		for (size_t c = 0; c < texture.width; ++c)
+		{
+			if (columns[c] == 0)
+			{
+				ret = true;
+				log::warning("Texture {}: {}: column {} without a patch", a, texture.name, c);
+				break;
+			}
+		}
+	}
+
+	return ret;
+}
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -136,15 +434,8 @@ CTexture* TextureXList::texture(size_t index)
 // -----------------------------------------------------------------------------
 CTexture* TextureXList::texture(string_view name)
 {
-	// Search for texture by name
-	for (auto& texture : textures_)
-	{
-		if (strutil::equalCI(texture->name(), name))
-			return texture.get();
-	}
-
-	// Not found
-	return &tex_invalid_;
+	auto index = textureIndex(name);
+	return index < 0 ? &tex_invalid_ : textures_[index].get();
 }
 
 // -----------------------------------------------------------------------------
@@ -153,17 +444,13 @@ CTexture* TextureXList::texture(string_view name)
 int TextureXList::textureIndex(string_view name)
 {
 	// Search for texture by name
-	for (unsigned a = 0; a < textures_.size(); a++)
-	{
-		if (strutil::equalCI(textures_[a]->name(), name))
-		{
-			textures_[a]->index_ = a;
-			return a;
-		}
-	}
+	updateNameIndex();
+	auto i = name_index_.find(strutil::upper(name));
+	if (i == name_index_.end())
+		return -1;
 
-	// Not found
-	return -1;
+	textures_[i->second]->index_ = i->second;
+	return i->second;
 }
 
 // -----------------------------------------------------------------------------
@@ -173,16 +460,25 @@ void TextureXList::addTexture(unique_ptr<CTexture> tex, int position)
 {
 	// Add it to the list at position if valid
 	tex->in_list_ = this;
-	if (position >= 0 && (unsigned)position < textures_.size())
+	if (position < 0 || (unsigned)position >= textures_.size())
+		position = textures_.size();
+	tex->index_ = position;
+
+	// Update indexes
+	if (name_index_valid_ && name_index_.size() == textures_.size())
 	{
-		tex->index_ = position;
-		textures_.insert(textures_.begin() + position, std::move(tex));
+		for (auto& i : name_index_)
+			if (i.second >= static_cast<unsigned>(position))
+				++i.second;
+		if (!name_index_.try_emplace(strutil::upper(tex->name()), position).second)
+			name_index_valid_ = false; // Duplicate name
 	}
 	else
-	{
-		tex->index_ = textures_.size();
-		textures_.push_back(std::move(tex));
-	}
+		name_index_valid_ = false;
+	if (patch_usage_valid_)
+		addPatchUsage(tex.get());
+
+	textures_.insert(textures_.begin() + position, std::move(tex));
 }
 
 // -----------------------------------------------------------------------------
@@ -198,6 +494,19 @@ unique_ptr<CTexture> TextureXList::removeTexture(unsigned index)
 	auto removed = std::move(textures_[index]);
 	textures_.erase(textures_.begin() + index);
 
+	// Update indexes
+	if (name_index_valid_ && name_index_.size() == textures_.size() + 1)
+	{
+		name_index_.erase(strutil::upper(removed->name()));
+		for (auto& i : name_index_)
+			if (i.second > index)
+				--i.second;
+	}
+	else
+		name_index_valid_ = false;
+	if (patch_usage_valid_)
+		removePatchUsage(removed.get());
+
 	return removed;
 }
 
@@ -217,6 +526,15 @@ void TextureXList::swapTextures(unsigned index1, unsigned index2)
 	int ti                    = textures_[index1]->index_;
 	textures_[index1]->index_ = textures_[index2]->index_;
 	textures_[index2]->index_ = ti;
+
+	// Update name index
+	if (name_index_valid_ && name_index_.size() == textures_.size())
+	{
+		name_index_[strutil::upper(textures_[index1]->name())] = index1;
+		name_index_[strutil::upper(textures_[index2]->name())] = index2;
+	}
+	else
+		name_index_valid_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -230,8 +548,24 @@ unique_ptr<CTexture> TextureXList::replaceTexture(unsigned index, unique_ptr<CTe
 		return nullptr;
 
 	// Replace texture
-	auto replaced    = std::move(textures_[index]);
-	textures_[index] = std::move(replacement);
+	auto replaced              = std::move(textures_[index]);
+	textures_[index]           = std::move(replacement);
+	textures_[index]->in_list_ = this;
+
+	// Update indexes
+	if (name_index_valid_ && name_index_.size() == textures_.size())
+	{
+		name_index_.erase(strutil::upper(replaced->name()));
+		if (!name_index_.try_emplace(strutil::upper(textures_[index]->name()), index).second)
+			name_index_valid_ = false; // Duplicate name
+	}
+	else
+		name_index_valid_ = false;
+	if (patch_usage_valid_)
+	{
+		removePatchUsage(replaced.get());
+		addPatchUsage(textures_[index].get());
+	}
 
 	return replaced;
 }
@@ -242,6 +576,10 @@ unique_ptr<CTexture> TextureXList::replaceTexture(unsigned index, unique_ptr<CTe
 void TextureXList::clear(bool clear_patches)
 {
 	textures_.clear();
+	name_index_.clear();
+	patch_usage_.clear();
+	name_index_valid_  = true;
+	patch_usage_valid_ = true;
 }
 
 // -----------------------------------------------------------------------------
@@ -249,9 +587,69 @@ void TextureXList::clear(bool clear_patches)
 // -----------------------------------------------------------------------------
 void TextureXList::removePatch(string_view patch)
 {
-	// Go through all textures
+	// Get all textures using the patch
+	updatePatchUsage();
+	vector<CTexture*> textures;
+	auto              range = patch_usage_.equal_range(string{ patch });
+	for (auto i = range.first; i != range.second; ++i)
+		if (std::find(textures.begin(), textures.end(), i->second) == textures.end())
+			textures.push_back(i->second);
+	patch_usage_.erase(range.first, range.second);
+
+	// Remove patch from them (the usage index is already up to date)
+	for (auto texture : textures)
+		texture->removePatch(patch);
+	patch_usage_valid_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the texture name index if it was invalidated
+// -----------------------------------------------------------------------------
+void TextureXList::updateNameIndex()
+{
+	if (name_index_valid_)
+		return;
+
+	name_index_.clear();
+	for (unsigned a = 0; a < textures_.size(); a++)
+		name_index_.try_emplace(strutil::upper(textures_[a]->name()), a);
+	name_index_valid_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the patch usage index if it was invalidated
+// -----------------------------------------------------------------------------
+void TextureXList::updatePatchUsage()
+{
+	if (patch_usage_valid_)
+		return;
+
+	patch_usage_.clear();
 	for (auto& texture : textures_)
-		texture->removePatch(patch); // Remove patch from texture
+		addPatchUsage(texture.get());
+	patch_usage_valid_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the patches used by [tex] to the patch usage index
+// -----------------------------------------------------------------------------
+void TextureXList::addPatchUsage(CTexture* tex)
+{
+	for (auto& patch : tex->patches())
+		patch_usage_.emplace(patch->name(), tex);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [tex] from the patch usage index
+// -----------------------------------------------------------------------------
+void TextureXList::removePatchUsage(CTexture* tex)
+{
+	for (auto& patch : tex->patches())
+	{
+		auto range = patch_usage_.equal_range(patch->name());
+		for (auto i = range.first; i != range.second;)
+			i = i->second == tex ? patch_usage_.erase(i) : std::next(i);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -691,63 +1089,29 @@ bool TextureXList::readTEXTURESData(ArchiveEntry* textures)
 		return true;
 	}
 
-	// Get text to parse
-	Tokenizer tz;
-	tz.openMem(textures->data(), textures->name());
-
-	// Parsing gogo
-	while (!tz.atEnd())
-	{
-		// Texture definition
-		if (tz.checkNC("Texture"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Texture"))
-				addTexture(std::move(tex));
-		}
-
-		// Sprite definition
-		else if (tz.checkNC("Sprite"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Sprite"))
-				addTexture(std::move(tex));
-		}
-
-		// Graphic definition
-		else if (tz.checkNC("Graphic"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Graphic"))
-				addTexture(std::move(tex));
-		}
-
-		// WallTexture definition
-		else if (tz.checkNC("WallTexture"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "WallTexture"))
-				addTexture(std::move(tex));
-		}
-
-		// Flat definition
-		else if (tz.checkNC("Flat"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parse(tz, "Flat"))
-				addTexture(std::move(tex));
-		}
-
-		// Old HIRESTEX "Define"
-		else if (tz.checkNC("Define"))
-		{
-			auto tex = std::make_unique<CTexture>();
-			if (tex->parseDefine(tz))
-				addTexture(std::move(tex));
-		}
-
-		tz.adv();
-	}
+	// Split the definitions into ranges, and parse each with its own tokenizer
+	// across the thread pool (other than ranges that need the main thread)
+	auto ranges = splitDefinitions(textures->data(), DEFINITIONS_PER_TASK);
+	auto text   = reinterpret_cast<const char*>(textures->rawData());
+	auto parsed = vector<vector<unique_ptr<CTexture>>>(ranges.size());
+
+	auto parse_range = [&](size_t index) {
+		Tokenizer tz;
+		tz.openMem(text + ranges[index].start, ranges[index].end - ranges[index].start, textures->name());
+		parseDefinitions(tz, parsed[index]);
+	};
+	threadpool::parallelFor(ranges.size(), [&](size_t index) {
+		if (!ranges[index].main_thread)
+			parse_range(index);
+	});
+	for (size_t a = 0; a < ranges.size(); ++a)
+		if (ranges[a].main_thread)
+			parse_range(a);
+
+	// Add parsed textures in order
+	for (auto& range : parsed)
+		for (auto& tex : range)
+			addTexture(std::move(tex));
 
 	txformat_ = Format::Textures;
 
@@ -820,62 +1184,27 @@ bool TextureXList::convertToTEXTURES()
 }
 
 // -----------------------------------------------------------------------------
-// Search for errors in texture list, return true if any are found
+// Search for errors in texture list, return true if any are found:
+// 1. A texture without any patch
+// 2. A texture with missing patches
+// 3. A texture with columns not covered by a patch
 // -----------------------------------------------------------------------------
 bool TextureXList::findErrors()
 {
-	bool ret = false;
-
-	// Texture errors:
-	// 1. A texture without any patch
-	// 2. A texture with missing patches
-	// 3. A texture with columns not covered by a patch
+	auto check = prepareErrorCheck(textures_);
+	measureImages(*check, true);
+	return logErrors(*check);
+}
 
-	for (unsigned a = 0; a < textures_.size(); a++)
-	{
-		if (textures_[a]->nPatches() == 0)
-		{
-			ret = true;
-			log::warning("Texture {}: {} does not have any patch", a, textures_[a]->name());
-		}
-		else
-		{
-			vector<uint8_t> columns(textures_[a]->width());
-			memset(columns.data(), 0, textures_[a]->width());
-			for (size_t i = 0; i < textures_[a]->nPatches(); ++i)
-			{
-				auto patch = textures_[a]->patches_[i]->patchEntry();
-				if (patch == nullptr)
-				{
-					ret = true;
-					log::warning(
-						"Texture {}: {}: patch {} cannot be found in any open archive",
-						a,
-						textures_[a]->name(),
-						textures_[a]->patches_[i]->name());
-					// Don't list missing columns when we don't know the size of the patch
-					memset(columns.data(), 1, textures_[a]->width());
-				}
-				else
-				{
-					SImage img;
-					img.open(patch->data());
-					size_t start = std::max<size_t>(0, textures_[a]->patches_[i]->xOffset());
-					size_t end   = std::min<size_t>(textures_[a]->width(), img.width() + start);
-					for (size_t c = start; c < end; ++c)
-						columns[c] = 1;
-				}
-			}
-			for (size_t c = 0; c < textures_[a]->width(); ++c)
-			{
-				if (columns[c] == 0)
-				{
-					ret = true;
-					log::warning("Texture {}: {}: column {} without a patch", a, textures_[a]->name(), c);
-					break;
-				}
-			}
-		}
-	}
-	return ret;
+// -----------------------------------------------------------------------------
+// Searches for errors in the texture list as in findErrors, but finishes the
+// search (and logs any errors found) in the background
+// -----------------------------------------------------------------------------
+void TextureXList::findErrorsInBackground()
+{
+	auto check = shared_ptr<ErrorCheck>(prepareErrorCheck(textures_));
+	threadpool::pool().push([check]() {
+		measureImages(*check, false);
+		logErrors(*check);
+	});
 }
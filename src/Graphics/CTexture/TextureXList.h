@@ -46,6 +46,8 @@ public:
 	int       textureIndex(string_view name);
 
 	void setFormat(Format format) { txformat_ = format; }
+	void invalidateNameIndex() { name_index_valid_ = false; }
+	void invalidatePatchUsage() { patch_usage_valid_ = false; }
 
 	void                 addTexture(unique_ptr<CTexture> tex, int position = -1);
 	unique_ptr<CTexture> removeTexture(unsigned index);
@@ -63,10 +65,23 @@ public:
 
 	bool convertToTEXTURES();
 	bool findErrors();
+	void findErrorsInBackground();
 
 private:
 	vector<unique_ptr<CTexture>> textures_;
 	Format                       txformat_ = Format::Normal;
 	CTexture tex_invalid_{ static_cast<string_view>("INVALID_TEXTURE") }; // Deliberately set the invalid name to >8 characters
+
+	// Upper-case texture name -> index of the (first) texture with that name,
+	// and patch name -> textures using it. Rebuilt when needed after changes
+	std::unordered_map<string, unsigned>       name_index_;
+	std::unordered_multimap<string, CTexture*> patch_usage_;
+	bool                                       name_index_valid_  = false;
+	bool                                       patch_usage_valid_ = false;
+
+	void updateNameIndex();
+	void updatePatchUsage();
+	void addPatchUsage(CTexture* tex);
+	void removePatchUsage(CTexture* tex);
 };
 } // namespace slade
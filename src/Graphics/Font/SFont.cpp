@@ -185,6 +185,7 @@ void SFont::drawCharacter(char c, ColRGBA colour)
 		(double)ch.tex_bounds_.x1() / (double)tex_info.size.x, (double)ch.tex_bounds_.y1() / (double)tex_info.size.y);
 	tex_rect.br.set(
 		(double)ch.tex_bounds_.x2() / (double)tex_info.size.x, (double)ch.tex_bounds_.y2() / (double)tex_info.size.y);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2d(tex_rect.x1(), tex_rect.y1());
 	glVertex2d(0, 0);
@@ -254,6 +255,7 @@ void SFont::drawString(string_view str, ColRGBA colour, SFont::Align align)
 		tex_rect.br.set(
 			(double)ch.tex_bounds_.x2() / (double)tex_info.size.x,
 			(double)ch.tex_bounds_.y2() / (double)tex_info.size.y);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glTexCoord2d(tex_rect.x1(), tex_rect.y1());
 		glVertex2d(xoff, 0);
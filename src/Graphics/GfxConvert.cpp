@@ -0,0 +1,223 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    GfxConvert.cpp
+// Description: Batch image conversion - converts and writes a set of images
+//              to a format across the thread pool, and writes the results
+//              back to their entries
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "GfxConvert.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Misc.h"
+#include "General/UI.h"
+#include "General/UndoRedo.h"
+#include "Graphics/Palette/Palette.h"
+#include "Utility/ThreadPool.h"
+#include <atomic>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Calls [func] for each index from 0 to [count]-1 across the thread pool, in
+// batches so the splash window progress can be updated in between
+// -----------------------------------------------------------------------------
+void forEachItem(size_t count, const std::function<void(size_t)>& func)
+{
+	auto batch = (threadpool::pool().numThreads() + 1) * 8;
+	for (size_t start = 0; start < count; start += batch)
+	{
+		auto n = std::min<size_t>(batch, count - start);
+		threadpool::parallelFor(n, [&](size_t index) { func(start + index); });
+		ui::setSplashProgress(static_cast<float>(start + n) / static_cast<float>(count));
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Copies [palette] to [copy] and returns [copy], or nullptr if [palette] is
+// null. Palettes cache colour lookups, so each conversion task gets its own
+// copy rather than sharing them between threads
+// -----------------------------------------------------------------------------
+Palette* paletteCopy(const Palette* palette, Palette& copy)
+{
+	if (!palette)
+		return nullptr;
+
+	copy.copyPalette(palette);
+	return &copy;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// GFX Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Converts the images in [items] to be writable as [format], using conversion
+// options [opt]. Images that aren't loaded yet are loaded from their entries.
+// Returns the number of images converted
+// -----------------------------------------------------------------------------
+unsigned gfx::convertImages(vector<ConvertItem>& items, SIFormat* format, const SIFormat::ConvertOptions& opt)
+{
+	if (!format)
+		return 0;
+
+	// Entry types and data need to be ready before images can be loaded on
+	// worker threads
+	for (auto& item : items)
+	{
+		if (!item.entry || item.image.isValid())
+			continue;
+
+		if (item.entry->type() == EntryType::unknownType())
+			EntryType::detectEntryType(*item.entry);
+		item.entry->data();
+	}
+
+	std::atomic<unsigned> n_converted{ 0 };
+	forEachItem(items.size(), [&](size_t index) {
+		auto& item     = items[index];
+		item.converted = false;
+
+		// Load image
+		if (!item.image.isValid() && !misc::loadImageFromEntry(&item.image, item.entry))
+			return;
+
+		// Check it can be written
+		if (format->canWrite(item.image) == SIFormat::Writable::No)
+			return;
+
+		// Convert
+		Palette pal_current;
+		Palette pal_target;
+		auto    item_opt     = opt;
+		item_opt.pal_current = paletteCopy(item.pal_current ? item.pal_current : opt.pal_current, pal_current);
+		item_opt.pal_target  = paletteCopy(item.pal_target ? item.pal_target : opt.pal_target, pal_target);
+		format->convertWritable(item.image, item_opt);
+
+		// The image is written with the target palette
+		if (!item.pal_target)
+			item.pal_target = opt.pal_target;
+
+		item.format    = format;
+		item.converted = true;
+		++n_converted;
+	});
+
+	return n_converted;
+}
+
+// -----------------------------------------------------------------------------
+// Writes each converted image in [items] to its data in the format it was
+// converted to.
+// Returns the number of images written
+// -----------------------------------------------------------------------------
+unsigned gfx::writeImages(vector<ConvertItem>& items)
+{
+	std::atomic<unsigned> n_written{ 0 };
+	forEachItem(items.size(), [&](size_t index) {
+		auto& item = items[index];
+		item.data.clear();
+		if (!item.converted || !item.format)
+			return;
+
+		Palette pal;
+		if (item.format->saveImage(item.image, item.data, paletteCopy(item.pal_target, pal)))
+			++n_written;
+		else
+			item.data.clear();
+	});
+
+	return n_written;
+}
+
+// -----------------------------------------------------------------------------
+// Imports the written image data in [items] to their entries, recording it as
+// a single undo level in [undo_manager] (if given).
+// Returns the number of entries modified
+// -----------------------------------------------------------------------------
+unsigned gfx::applyToEntries(vector<ConvertItem>& items, UndoManager* undo_manager)
+{
+	if (undo_manager)
+		undo_manager->beginRecord("Gfx Format Conversion");
+
+	vector<ArchiveEntry*> modified;
+	for (auto& item : items)
+	{
+		if (!item.entry || !item.data.hasData())
+			continue;
+
+		if (item.entry->importMemChunk(item.data))
+			modified.push_back(item.entry);
+	}
+
+	// Update entry types
+	EntryType::detectEntryTypes(modified);
+	for (auto entry : modified)
+		entry->setExtensionByType();
+
+	if (undo_manager)
+		undo_manager->endRecord(!modified.empty());
+
+	return modified.size();
+}
+
+// -----------------------------------------------------------------------------
+// Converts the images in [entries] to [format] using conversion options [opt],
+// and writes them back to the entries (see applyToEntries).
+// Returns the number of entries converted
+// -----------------------------------------------------------------------------
+unsigned gfx::convertEntries(
+	const vector<ArchiveEntry*>&    entries,
+	SIFormat*                       format,
+	const SIFormat::ConvertOptions& opt,
+	UndoManager*                    undo_manager)
+{
+	vector<ConvertItem> items(entries.size());
+	for (size_t a = 0; a < entries.size(); ++a)
+		items[a].entry = entries[a];
+
+	if (convertImages(items, format, opt) == 0)
+		return 0;
+
+	writeImages(items);
+	return applyToEntries(items, undo_manager);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+
+namespace slade
+{
+class ArchiveEntry;
+class UndoManager;
+
+namespace gfx
+{
+	// An image in a batch conversion
+	struct ConvertItem
+	{
+		ArchiveEntry* entry = nullptr;       // Entry to load the image from and write the result back to
+		SImage        image;                 // Image to convert (loaded from [entry] if not valid)
+		SIFormat*     format      = nullptr; // Format the image was converted to
+		Palette*      pal_current = nullptr; // Overrides the conversion options' current palette, if set
+		Palette*      pal_target  = nullptr; // Overrides the conversion options' target palette, if set
+		bool          converted   = false;   // True if the image was converted
+		MemChunk      data;                  // The converted image written in [format]
+	};
+
+	unsigned convertImages(vector<ConvertItem>& items, SIFormat* format, const SIFormat::ConvertOptions& opt);
+	unsigned writeImages(vector<ConvertItem>& items);
+	unsigned applyToEntries(vector<ConvertItem>& items, UndoManager* undo_manager = nullptr);
+	unsigned convertEntries(
+		const vector<ArchiveEntry*>&    entries,
+		SIFormat*                       format,
+		const SIFormat::ConvertOptions& opt,
+		UndoManager*                    undo_manager = nullptr);
+} // namespace gfx
+} // namespace slade
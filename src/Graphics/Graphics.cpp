@@ -84,6 +84,47 @@ struct ChunkSize
 	uint32_t size;
 };
 
+// The position of a chunk in png data ([offset] of its length field, and
+// [size] of the whole chunk including length, name and crc)
+struct ChunkPos
+{
+	uint32_t offset;
+	uint32_t size;
+};
+
+// -----------------------------------------------------------------------------
+// Returns true if [chunk] in [png_data] is named [name]
+// -----------------------------------------------------------------------------
+bool chunkIs(const MemChunk& png_data, const ChunkPos& chunk, const char* name)
+{
+	return memcmp(png_data.data() + chunk.offset + 4, name, 4) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the positions of all chunks in [png_data] (up to and including the
+// IEND chunk), or an empty list if the data is invalid
+// -----------------------------------------------------------------------------
+vector<ChunkPos> pngChunks(const MemChunk& png_data)
+{
+	vector<ChunkPos> chunks;
+	uint32_t         pos = 8;
+	while (pos + 12 <= png_data.size())
+	{
+		auto length = memory::readB32(png_data.data(), pos);
+		if (length > png_data.size() - pos - 12)
+			return {};
+
+		chunks.push_back({ pos, length + 12 });
+		if (chunkIs(png_data, chunks.back(), "IEND"))
+			return chunks;
+
+		pos += length + 12;
+	}
+
+	// No IEND chunk
+	return {};
+}
+
 // -----------------------------------------------------------------------------
 // Sets the offsets to [xoff,yoff] in the given DoomGfx formatted [data]
 // -----------------------------------------------------------------------------
@@ -495,6 +536,77 @@ bool gfx::pngSetalPh(MemChunk& png_data, bool value)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Recompresses the image data (IDAT chunks) of the PNG in [png_data] at the
+// highest compression level, keeping all other chunks (grAb, tRNS etc.) as
+// they are. The new image data is only used if it was written in exactly the
+// same pixel format, and is smaller than the original.
+// Returns true if [png_data] was made smaller
+// -----------------------------------------------------------------------------
+bool gfx::pngRecompress(MemChunk& png_data)
+{
+	auto chunks = pngChunks(png_data);
+	if (chunks.empty() || !chunkIs(png_data, chunks[0], "IHDR"))
+		return false;
+
+	// Decode the image
+	auto mem = FreeImage_OpenMemory(const_cast<BYTE*>(png_data.data()), png_data.size());
+	auto bm  = FreeImage_LoadFromMemory(FIF_PNG, mem, PNG_IGNOREGAMMA);
+	FreeImage_CloseMemory(mem);
+	if (!bm)
+		return false;
+
+	// Encode it again at maximum compression
+	MemChunk encoded;
+	auto     fi_png = FreeImage_OpenMemory();
+	if (FreeImage_SaveToMemory(FIF_PNG, bm, fi_png, PNG_Z_BEST_COMPRESSION))
+	{
+		BYTE* data = nullptr;
+		DWORD size = 0;
+		FreeImage_AcquireMemory(fi_png, &data, &size);
+		if (size > 0)
+			encoded.importMem(data, size);
+	}
+	FreeImage_CloseMemory(fi_png);
+	FreeImage_Unload(bm);
+
+	// Check the IHDR chunk (size, bit depth, colour type, interlacing) is identical
+	auto new_chunks = pngChunks(encoded);
+	if (new_chunks.empty() || new_chunks[0].size != chunks[0].size
+		|| memcmp(encoded.data() + new_chunks[0].offset, png_data.data() + chunks[0].offset, chunks[0].size) != 0)
+		return false;
+
+	// Build the new png from the original chunks with the new IDAT chunks in
+	// place of the original ones
+	vector<uint8_t> npng(png_data.data(), png_data.data() + 8);
+	bool            idat_written = false;
+	for (const auto& chunk : chunks)
+	{
+		if (!chunkIs(png_data, chunk, "IDAT"))
+		{
+			npng.insert(npng.end(), png_data.data() + chunk.offset, png_data.data() + chunk.offset + chunk.size);
+			continue;
+		}
+
+		if (idat_written)
+			continue;
+
+		for (const auto& new_chunk : new_chunks)
+			if (chunkIs(encoded, new_chunk, "IDAT"))
+				npng.insert(
+					npng.end(),
+					encoded.data() + new_chunk.offset,
+					encoded.data() + new_chunk.offset + new_chunk.size);
+		idat_written = true;
+	}
+
+	if (npng.size() >= png_data.size())
+		return false;
+
+	png_data.importMem(npng.data(), npng.size());
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Calculates the offsets for a [width]x[height] graphic, for a sprite of [type]
 // -----------------------------------------------------------------------------
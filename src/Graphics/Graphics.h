@@ -14,6 +14,7 @@ namespace gfx
 	bool                 pngSettRNS(MemChunk& png_data, bool value);
 	bool                 pngGetalPh(const MemChunk& png_data);
 	bool                 pngSetalPh(MemChunk& png_data, bool value);
+	bool                 pngRecompress(MemChunk& png_data);
 
 	// Offsets
 	enum class OffsetType
@@ -47,26 +47,32 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(String, iconset_general, "Default", CVar::Flag::Save)
 CVAR(String, iconset_entry_list, "Default", CVar::Flag::Save)
+CVAR(Bool, icons_preload, false, CVar::Flag::Save) // Decode all icons at the default UI size on startup
 
 namespace slade::icons
 {
+// Icons are only indexed (by name) when loaded from slade.pk3, each image is
+// decoded from its resource entry the first time it is requested
 struct Icon
 {
 	struct Image
 	{
+		ArchiveEntry* resource_entry = nullptr; // nullptr if none for this size (scaled from 16x16)
 		wxImage       wx_image;
-		ArchiveEntry* resource_entry = nullptr;
+		wxBitmap      bitmap; // Created from wx_image on first request
+		bool          loaded = false;
 	};
 
-	string name;
-	Image  i16;
-	Image  i24;
-	Image  i32;
+	Image i16;
+	Image i24;
+	Image i32;
 };
 
-vector<Icon>   icons_general;
-vector<Icon>   icons_text_editor;
-vector<Icon>   icons_entry;
+using IconList = std::map<string, Icon, std::less<>>;
+
+IconList       icons_general;
+IconList       icons_text_editor;
+IconList       icons_entry;
 wxBitmap       icon_empty;
 vector<string> iconsets_entry;
 vector<string> iconsets_general;
@@ -83,7 +89,7 @@ namespace slade::icons
 // -----------------------------------------------------------------------------
 // Returns a list of all icons of [type]
 // -----------------------------------------------------------------------------
-vector<Icon>& iconList(Type type)
+IconList& iconList(Type type)
 {
 	if (type == Entry)
 		return icons_entry;
@@ -94,8 +100,48 @@ vector<Icon>& iconList(Type type)
 }
 
 // -----------------------------------------------------------------------------
-// Loads all icons in [dir] to the list for [type].
-// If [append_default] is true, we are only loading icons from the default set
+// Returns the icon [name] of [type], or nullptr if it doesn't exist
+// -----------------------------------------------------------------------------
+Icon* findIcon(Type type, string_view name)
+{
+	auto& icons = iconList(type);
+	auto  icon  = icons.find(name);
+	return icon != icons.end() ? &icon->second : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the png entries in [dir] to [icons] as the image for [size].
+// 16x16 entries add new icons (unless [append_default] is true and the icon
+// already exists), other sizes are only added to icons from the same set
+// -----------------------------------------------------------------------------
+void indexIconsDir(IconList& icons, ArchiveDir* dir, int size, bool append_default)
+{
+	for (const auto& entry : dir->allEntries())
+	{
+		// Ignore anything not png format
+		if (!strutil::endsWithCI(entry->name(), ".png"))
+		{
+			log::warning("Invalid {0}x{0} image format for icon \"{1}\", must be png", size, entry->nameNoExt());
+			continue;
+		}
+
+		auto name = entry->nameNoExt();
+		auto icon = icons.find(name);
+		if (size == 16)
+		{
+			if (icon != icons.end() && append_default)
+				continue;
+
+			icons[string{ name }].i16.resource_entry = entry.get();
+		}
+		else if (icon != icons.end() && icon->second.i16.resource_entry->parentDir()->parent().get() == dir->parent().get())
+			(size == 24 ? icon->second.i24 : icon->second.i32).resource_entry = entry.get();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Indexes all icons in [dir] to the list for [type].
+// If [append_default] is true, we are only adding icons from the default set
 // that don't already exist in the icon list
 // -----------------------------------------------------------------------------
 bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
@@ -130,162 +176,82 @@ bool loadIconsDir(Type type, ArchiveDir* dir, bool append_default)
 
 	auto& icons = iconList(type);
 
-	// Load 16x16 icons (these must exist)
-	bool  found  = false;
+	// Index 16x16 icons (these must exist)
 	auto* dir_16 = dir->subdir("16").get();
 	if (!dir_16)
 	{
 		log::error("Error loading icons, no 16x16 dir exists for set \"{}\" (in {})", icon_set_dir, dir->path());
 		return false;
 	}
-	for (const auto& entry : dir_16->allEntries())
-	{
-		// Ignore anything not png format
-		if (!strutil::endsWithCI(entry->name(), ".png"))
-		{
-			log::warning("Invalid 16x16 image format for icon \"{}\", must be png", entry->nameNoExt());
-			continue;
-		}
+	indexIconsDir(icons, dir_16, 16, append_default);
 
-		if (append_default)
-		{
-			found = false;
-			for (const auto& icon : icons)
-				if (icon.name == entry->nameNoExt())
-				{
-					found = true;
-					break;
-				}
-			if (found)
-				continue;
-		}
+	// Index 24x24 and 32x32 icons, any missing are scaled from 16x16 when
+	// first requested
+	if (auto* dir_24 = dir->subdir("24").get())
+		indexIconsDir(icons, dir_24, 24, append_default);
+	if (auto* dir_32 = dir->subdir("32").get())
+		indexIconsDir(icons, dir_32, 32, append_default);
 
-		// Load 16x16 icon image
-		Icon n_icon;
-		auto stream = wxMemoryInputStream(entry->rawData(), entry->size());
-		if (!n_icon.i16.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
-		{
-			log::warning("Unable to load 16x16 image for icon \"{}\" (is it not png format?)", entry->nameNoExt());
-			continue;
-		}
+	return true;
+}
 
-		// Add the icon
-		n_icon.name               = entry->nameNoExt();
-		n_icon.i16.resource_entry = entry.get();
-		icons.push_back(n_icon);
-	}
+// -----------------------------------------------------------------------------
+// Returns the image of [icon] for [size], decoding it from its resource entry
+// (or scaling the 16x16 image if there is no entry for the size) if it hasn't
+// been loaded yet. The returned image is not ok if it couldn't be loaded
+// -----------------------------------------------------------------------------
+Icon::Image& imageForSize(Icon& icon, int size)
+{
+	auto  image_size = size <= 16 ? 16 : size <= 24 ? 24 : 32;
+	auto& image      = image_size == 16 ? icon.i16 : image_size == 24 ? icon.i24 : icon.i32;
+	if (image.loaded)
+		return image;
 
-	// Load 24x24 icons
-	if (auto* dir_24 = dir->subdir("24").get())
+	image.loaded = true;
+	if (image.resource_entry)
 	{
-		for (const auto& entry : dir_24->allEntries())
-		{
-			// Ignore anything not png format
-			if (!strutil::endsWithCI(entry->name(), ".png"))
-			{
-				log::warning("Invalid 24x24 image format for icon \"{}\", must be png", entry->nameNoExt());
-				continue;
-			}
-
-			// Find existing icon
-			auto name = entry->nameNoExt();
-			for (auto& icon : icons)
-			{
-				if (icon.name == name)
-				{
-					// Load 24x24 icon image
-					auto stream = wxMemoryInputStream(entry->rawData(), entry->size());
-					if (!icon.i24.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
-						log::warning(
-							"Unable to load 24x24 image for icon \"{}\" (is it not png format?)", entry->nameNoExt());
-					icon.i24.resource_entry = entry.get();
-
-					break;
-				}
-			}
-		}
+		auto stream = wxMemoryInputStream(image.resource_entry->rawData(), image.resource_entry->size());
+		if (!image.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
+			log::warning(
+				"Unable to load {0}x{0} image for icon \"{1}\" (is it not png format?)",
+				image_size,
+				image.resource_entry->nameNoExt());
 	}
 
-	// Load 32x32 icons
-	if (auto* dir_32 = dir->subdir("32").get())
+	// Generate missing large icons
+	if (!image.wx_image.IsOk() && image_size > 16)
 	{
-		for (const auto& entry : dir_32->allEntries())
+		auto& i16 = imageForSize(icon, 16);
+		if (i16.wx_image.IsOk())
 		{
-			// Ignore anything not png format
-			if (!strutil::endsWithCI(entry->name(), ".png"))
-			{
-				log::warning("Invalid 32x32 image format for icon \"{}\", must be png", entry->nameNoExt());
-				continue;
-			}
-
-			// Find existing icon
-			auto name = entry->nameNoExt();
-			for (auto& icon : icons)
-			{
-				if (icon.name == name)
-				{
-					// Load 32x32 icon image
-					auto stream = wxMemoryInputStream(entry->rawData(), entry->size());
-					if (!icon.i32.wx_image.LoadFile(stream, wxBITMAP_TYPE_PNG))
-						log::warning(
-							"Unable to load 32x32 image for icon \"{}\" (is it not png format?)", entry->nameNoExt());
-					icon.i32.resource_entry = entry.get();
-
-					break;
-				}
-			}
+			image.resource_entry = i16.resource_entry;
+			image.wx_image       = i16.wx_image.Copy();
+			image.wx_image.Rescale(image_size, image_size, wxIMAGE_QUALITY_BICUBIC);
 		}
 	}
 
-	// Generate any missing large icons
-	for (auto& icon : icons)
-	{
-		if (!icon.i24.wx_image.IsOk())
-		{
-			icon.i24.resource_entry = icon.i16.resource_entry;
-			icon.i24.wx_image       = icon.i16.wx_image.Copy();
-			icon.i24.wx_image.Rescale(24, 24, wxIMAGE_QUALITY_BICUBIC);
-		}
-
-		if (!icon.i32.wx_image.IsOk())
-		{
-			icon.i32.resource_entry = icon.i16.resource_entry;
-			icon.i32.wx_image       = icon.i16.wx_image.Copy();
-			icon.i32.wx_image.Rescale(32, 32, wxIMAGE_QUALITY_BICUBIC);
-		}
-	}
+	if (image.wx_image.IsOk())
+		image.bitmap = wxBitmap(image.wx_image);
 
-	return true;
+	return image;
 }
 
-const Icon::Image& validImageForSize(const Icon& icon_def, int size)
+// -----------------------------------------------------------------------------
+// Decodes all icons in [icons] at [size]
+// -----------------------------------------------------------------------------
+void preloadIcons(IconList& icons, int size)
 {
-	if (size <= 16)
-		return icon_def.i16;
-
-	if (size <= 24)
-	{
-		if (icon_def.i24.wx_image.IsOk())
-			return icon_def.i24;
-		else
-			return icon_def.i16;
-	}
-
-	// Size >= 25
-	if (icon_def.i32.wx_image.IsOk())
-		return icon_def.i32;
-
-	return icon_def.i16;
+	for (auto& icon : icons)
+		imageForSize(icon.second, size);
 }
 } // namespace slade::icons
 
 // -----------------------------------------------------------------------------
-// Loads all icons from slade.pk3 (in the icons/ dir)
+// Indexes all icons from slade.pk3 (in the icons/ dir). Icon images are loaded
+// when first requested, unless the icons_preload cvar is set
 // -----------------------------------------------------------------------------
 bool icons::loadIcons()
 {
-	auto tempfile = app::path("sladetemp", app::Dir::Temp);
-
 	// Get slade.pk3
 	auto* res_archive = app::archiveManager().programResourceArchive();
 
@@ -311,6 +277,15 @@ bool icons::loadIcons()
 	if (iconset_general != "Default")
 		loadIconsDir(General, dir_icons->subdir("general").get(), true);
 
+	// Decode icons at the default size now if requested
+	if (icons_preload)
+	{
+		auto size = 16 * ui::scaleFactor();
+		preloadIcons(icons_general, size);
+		preloadIcons(icons_entry, size);
+		preloadIcons(icons_text_editor, size);
+	}
+
 	return true;
 }
 
@@ -337,9 +312,8 @@ wxBitmap icons::getIcon(Type type, string_view name, int size, bool log_missing)
 		return icon;
 	}
 
-	for (const auto& icon : iconList(type))
-		if (icon.name == name)
-			return wxBitmap(validImageForSize(icon, size).wx_image);
+	if (auto icon = findIcon(type, name))
+		return imageForSize(*icon, size).bitmap;
 
 	if (log_missing)
 		log::warning(2, "Icon \"{}\" does not exist", name);
@@ -367,17 +341,19 @@ wxBitmap icons::getPaddedIcon(Type type, string_view name, int size, Point2i pad
 		return icon;
 	}
 
-	for (const auto& icon : iconList(type))
-		if (icon.name == name)
-		{
-			const auto& image = validImageForSize(icon, size).wx_image;
-			wxImage     padded(image.GetWidth() + padding.x * 2, image.GetHeight() + padding.y * 2);
-			padded.SetMaskColour(0, 0, 0);
-			padded.InitAlpha();
-			padded.Paste(image, padding.x, padding.y);
+	if (auto icon = findIcon(type, name))
+	{
+		const auto& image = imageForSize(*icon, size).wx_image;
+		if (!image.IsOk())
+			return wxNullBitmap;
 
-			return wxBitmap(padded);
-		}
+		wxImage padded(image.GetWidth() + padding.x * 2, image.GetHeight() + padding.y * 2);
+		padded.SetMaskColour(0, 0, 0);
+		padded.InitAlpha();
+		padded.Paste(image, padding.x, padding.y);
+
+		return wxBitmap(padded);
+	}
 
 	return wxNullBitmap;
 }
@@ -407,12 +383,7 @@ bool icons::iconExists(Type type, string_view name)
 		return exists;
 	}
 
-	auto& icons = iconList(type);
-	for (const auto& icon : icons)
-		if (icon.name == name)
-			return true;
-
-	return false;
+	return findIcon(type, name) != nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -434,11 +405,11 @@ ArchiveEntry* icons::getIconEntry(Type type, string_view name, int size)
 		return entry;
 	}
 
-	auto& icons = iconList(type);
-	for (const auto& icon : icons)
+	// The entry for sizes without their own image is the 16x16 one
+	if (auto icon = findIcon(type, name))
 	{
-		if (icon.name == name)
-			return validImageForSize(icon, size).resource_entry;
+		auto& image = size <= 16 ? icon->i16 : size <= 24 ? icon->i24 : icon->i32;
+		return image.resource_entry ? image.resource_entry : icon->i16.resource_entry;
 	}
 
 	return nullptr;
@@ -449,13 +420,8 @@ ArchiveEntry* icons::getIconEntry(Type type, string_view name, int size)
 // -----------------------------------------------------------------------------
 bool icons::exportIconPNG(Type type, string_view name, string_view path)
 {
-	auto& icons = iconList(type);
-
-	for (auto& icon : icons)
-	{
-		if (icon.name == name)
-			return icon.i16.resource_entry->exportFile(path);
-	}
+	if (auto icon = findIcon(type, name))
+		return icon->i16.resource_entry->exportFile(path);
 
 	return false;
 }
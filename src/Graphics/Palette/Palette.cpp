@@ -34,8 +34,8 @@
 #include "Palette.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/Translation.h"
-#include "Utility/CIEDeltaEquations.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 
 using namespace slade;
@@ -58,6 +58,28 @@ EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the index of the first smallest of the [count] values in [delta]
+// -----------------------------------------------------------------------------
+template<typename T> short closestIndex(const T* delta, size_t count)
+{
+	short index = 0;
+	for (size_t a = 1; a < count; ++a)
+		if (delta[a] < delta[index])
+			index = static_cast<short>(a);
+
+	return index;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Palette Class Functions
@@ -110,6 +132,7 @@ bool Palette::loadMem(MemChunk& mc)
 			break;
 	}
 	mc.seek(0, SEEK_SET);
+	coloursChanged();
 
 	return true;
 }
@@ -136,6 +159,7 @@ bool Palette::loadMem(const uint8_t* data, uint32_t size)
 		if (++c == 256)
 			break;
 	}
+	coloursChanged();
 
 	return true;
 }
@@ -430,6 +454,7 @@ void Palette::setColour(uint8_t index, const ColRGBA& col)
 	colours_[index].index = index;
 	colours_lab_[index]   = colours_[index].asLAB();
 	colours_hsl_[index]   = colours_[index].asHSL();
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
@@ -440,6 +465,7 @@ void Palette::setColourR(uint8_t index, uint8_t val)
 	colours_[index].r   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
@@ -450,6 +476,7 @@ void Palette::setColourG(uint8_t index, uint8_t val)
 	colours_[index].g   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
@@ -460,6 +487,7 @@ void Palette::setColourB(uint8_t index, uint8_t val)
 	colours_[index].b   = val;
 	colours_lab_[index] = colours_[index].asLAB();
 	colours_hsl_[index] = colours_[index].asHSL();
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
@@ -528,59 +556,84 @@ short Palette::findColour(const ColRGBA& colour)
 }
 
 // -----------------------------------------------------------------------------
-// Returns the difference between the given colour [rgb]/[hsl]/[lab] and the
-// palette colour at [index], using the colour matching method specified in
-// [match]
+// Returns the index of the closest colour in the palette to [colour]
+// -----------------------------------------------------------------------------
+short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
+{
+	match = resolveMatch(match);
+
+	// Check if the match was already found
+	short index = 0;
+	if (nearest_cache_.find(match, colour, index))
+		return index;
+
+	updateLABArray();
+	index = findNearest(colour, match);
+	nearest_cache_.add(match, colour, index);
+	return index;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the index of the closest colour in the palette to each of the
+// [count] [colours] to [indices]. This is much quicker than calling
+// nearestColour for each when there are many colours to look up: each unique
+// colour is only looked up once, and those that aren't cached are looked up
+// across the thread pool
 // -----------------------------------------------------------------------------
-double Palette::colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match)
+void Palette::nearestColours(const ColRGBA* colours, uint8_t* indices, unsigned count, ColourMatch match)
 {
-	double d1, d2, d3;
-	switch (match)
+	match = resolveMatch(match);
+
+	// Get cached colours, and the (unique) colours that aren't cached
+	vector<unsigned> uncached;
+	vector<uint32_t> lookup;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		short index;
+		if (nearest_cache_.find(match, colours[a], index))
+		{
+			indices[a] = index;
+			continue;
+		}
+
+		uncached.push_back(a);
+		lookup.push_back((colours[a].r << 16) | (colours[a].g << 8) | colours[a].b);
+	}
+	if (uncached.empty())
+		return;
+	std::sort(lookup.begin(), lookup.end());
+	lookup.erase(std::unique(lookup.begin(), lookup.end()), lookup.end());
+
+	// Find the nearest colours, in blocks across the thread pool
+	updateLABArray();
+	static constexpr size_t BLOCK_SIZE = 256;
+	vector<uint8_t>         found(lookup.size());
+	auto                    rgb = [](uint32_t value) { return ColRGBA(value >> 16, (value >> 8) & 0xFF, value & 0xFF); };
+	threadpool::parallelFor(
+		(lookup.size() + BLOCK_SIZE - 1) / BLOCK_SIZE,
+		[&](size_t block)
+		{
+			auto end = std::min(lookup.size(), (block + 1) * BLOCK_SIZE);
+			for (auto a = block * BLOCK_SIZE; a < end; ++a)
+				found[a] = findNearest(rgb(lookup[a]), match);
+		});
+
+	// Write results and add them to the cache
+	for (auto a : uncached)
 	{
-	default:
-	case ColourMatch::Old: // Directly with integer values
-		d1 = rgb.r - colours_[index].r;
-		d2 = rgb.g - colours_[index].g;
-		d3 = rgb.b - colours_[index].b;
-		break;
-	case ColourMatch::RGB: // With doubles, more precise
-		d1 = rgb.dr() - colours_[index].dr();
-		d2 = rgb.dg() - colours_[index].dg();
-		d3 = rgb.db() - colours_[index].db();
-		d1 *= col_match_r;
-		d2 *= col_match_g;
-		d3 *= col_match_b;
-		break;
-	case ColourMatch::HSL:
-		d1 = hsl.h - colours_hsl_[index].h;
-		// Hue wraps around!
-		if (d1 > 0.5)
-			d1 -= 1.0;
-		if (d1 < -0.5)
-			d1 += 1.0;
-		d2 = hsl.s - colours_hsl_[index].s;
-		d3 = hsl.l - colours_hsl_[index].l;
-		d1 *= col_match_h;
-		d2 *= col_match_s;
-		d3 *= col_match_l;
-		break;
-	case ColourMatch::C76: return cie::CIE76(lab, colours_lab_[index]);
-	case ColourMatch::C94: return cie::CIE94(lab, colours_lab_[index]);
-	case ColourMatch::C2K: return cie::CIEDE2000(lab, colours_lab_[index]);
+		uint32_t value = (colours[a].r << 16) | (colours[a].g << 8) | colours[a].b;
+		indices[a]     = found[std::lower_bound(lookup.begin(), lookup.end(), value) - lookup.begin()];
 	}
-	return (d1 * d1) + (d2 * d2) + (d3 * d3);
+	for (unsigned a = 0; a < lookup.size(); ++a)
+		nearest_cache_.add(match, rgb(lookup[a]), found[a]);
 }
 
 // -----------------------------------------------------------------------------
-// Returns the index of the closest colour in the palette to [colour]
+// Returns [match], or the col_match cvar's colour match method if it is
+// ColourMatch::Default
 // -----------------------------------------------------------------------------
-short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
+Palette::ColourMatch Palette::resolveMatch(ColourMatch match)
 {
-	double min_d = 999999;
-	short  index = 0;
-	ColHSL chsl  = colour.asHSL();
-	ColLAB clab  = colour.asLAB();
-
 	// Be nice if there was an easier way to convert from int -> enum class,
 	// but then that's kind of the point of them I guess
 	static vector<ColourMatch> cm_convert = {
@@ -590,22 +643,150 @@ short Palette::nearestColour(const ColRGBA& colour, ColourMatch match)
 	if (match == ColourMatch::Default)
 		match = cm_convert[col_match];
 
-	double delta;
-	for (short a = 0; a < 256; a++)
+	return match;
+}
+
+// -----------------------------------------------------------------------------
+// Called when any palette colours change, invalidates the nearest colour
+// cache and LAB arrays
+// -----------------------------------------------------------------------------
+void Palette::coloursChanged()
+{
+	nearest_cache_.invalidate();
+	lab_array_valid_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the LAB arrays used for CIE colour matching if the palette colours
+// have changed since they were last updated
+// -----------------------------------------------------------------------------
+void Palette::updateLABArray()
+{
+	if (lab_array_valid_)
+		return;
+
+	lab_array_.set(colours_lab_.data(), std::min<unsigned>(colours_lab_.size(), 256));
+	lab_array_valid_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the closest colour in the palette to [colour] using
+// [match] (not Default), without using the cache. The LAB arrays must be up to
+// date for the CIE methods (see updateLABArray). Can be called from multiple
+// threads at once
+// -----------------------------------------------------------------------------
+short Palette::findNearest(const ColRGBA& colour, ColourMatch match) const
+{
+	// The difference to each palette colour is calculated in simple loops over
+	// the palette colours (or the LAB arrays for the CIE methods), which the
+	// compiler can vectorise. The first closest colour is returned
+	auto n_colours = std::min<size_t>(colours_.size(), 256);
+	if (match == ColourMatch::C76 || match == ColourMatch::C94 || match == ColourMatch::C2K)
 	{
-		delta = colourDiff(colour, chsl, clab, a, match);
+		float delta[256];
+		auto  clab = colour.asLAB();
+		if (match == ColourMatch::C76)
+			cie::CIE76(clab, lab_array_, delta);
+		else if (match == ColourMatch::C94)
+			cie::CIE94(clab, lab_array_, delta);
+		else
+			cie::CIEDE2000(clab, lab_array_, delta);
 
-		// Exact match?
-		if (delta == 0.0)
-			return a;
-		else if (delta < min_d)
+		return closestIndex(delta, std::min<size_t>(n_colours, lab_array_.size()));
+	}
+
+	double delta[256];
+	if (match == ColourMatch::HSL)
+	{
+		auto   chsl = colour.asHSL();
+		double wh = col_match_h, ws = col_match_s, wl = col_match_l;
+		for (size_t a = 0; a < n_colours; ++a)
 		{
-			min_d = delta;
-			index = a;
+			// Hue wraps around!
+			double d1 = chsl.h - colours_hsl_[a].h;
+			d1 += d1 > 0.5 ? -1.0 : (d1 < -0.5 ? 1.0 : 0.0);
+			d1 *= wh;
+			double d2 = (chsl.s - colours_hsl_[a].s) * ws;
+			double d3 = (chsl.l - colours_hsl_[a].l) * wl;
+			delta[a]  = (d1 * d1) + (d2 * d2) + (d3 * d3);
+		}
+	}
+	else if (match == ColourMatch::RGB)
+	{
+		double wr = col_match_r, wg = col_match_g, wb = col_match_b;
+		for (size_t a = 0; a < n_colours; ++a)
+		{
+			double d1 = (colour.dr() - colours_[a].dr()) * wr;
+			double d2 = (colour.dg() - colours_[a].dg()) * wg;
+			double d3 = (colour.db() - colours_[a].db()) * wb;
+			delta[a]  = (d1 * d1) + (d2 * d2) + (d3 * d3);
+		}
+	}
+	else
+	{
+		// Old: Directly with integer values
+		for (size_t a = 0; a < n_colours; ++a)
+		{
+			double d1 = colour.r - colours_[a].r;
+			double d2 = colour.g - colours_[a].g;
+			double d3 = colour.b - colours_[a].b;
+			delta[a]  = (d1 * d1) + (d2 * d2) + (d3 * d3);
 		}
 	}
 
-	return index;
+	return closestIndex(delta, n_colours);
+}
+
+// -----------------------------------------------------------------------------
+// Looks for the cached nearest colour index to [colour] using [match], and
+// writes it to [index] if found.
+// Returns false if it isn't cached
+// -----------------------------------------------------------------------------
+bool Palette::NearestCache::find(ColourMatch match, const ColRGBA& colour, short& index)
+{
+	validate();
+
+	auto& slots = slots_[static_cast<int>(match)];
+	if (slots.empty())
+		return false;
+
+	uint32_t rgb   = (colour.r << 16) | (colour.g << 8) | colour.b;
+	auto     value = slots[slot(rgb)];
+	if (value >> 8 != rgb + 1)
+		return false;
+
+	index = value & 0xFF;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [index] as the nearest colour to [colour] using [match] to the cache
+// (replacing any other colour cached in the same slot)
+// -----------------------------------------------------------------------------
+void Palette::NearestCache::add(ColourMatch match, const ColRGBA& colour, short index)
+{
+	auto& slots = slots_[static_cast<int>(match)];
+	if (slots.empty())
+		slots.resize(1 << SLOT_BITS);
+
+	uint32_t rgb     = (colour.r << 16) | (colour.g << 8) | colour.b;
+	slots[slot(rgb)] = (static_cast<uint64_t>(rgb + 1) << 8) | static_cast<uint8_t>(index);
+}
+
+// -----------------------------------------------------------------------------
+// Clears all cached colours if the palette was changed, or if the colour
+// matching weights have changed since the cache was last used
+// -----------------------------------------------------------------------------
+void Palette::NearestCache::validate()
+{
+	float weights[6] = { col_match_r, col_match_g, col_match_b, col_match_h, col_match_s, col_match_l };
+	if (valid_ && std::equal(weights, weights + 6, weights_))
+		return;
+
+	for (auto& slots : slots_)
+		std::fill(slots.begin(), slots.end(), 0);
+	std::copy(weights, weights + 6, weights_);
+	valid_ = true;
 }
 
 // -----------------------------------------------------------------------------
@@ -648,8 +829,9 @@ void Palette::applyTranslation(Translation* trans)
 	temp.copyPalette(this);
 
 	// Translate colors
+	auto table = trans->table(this);
 	for (size_t i = 0; i < 256; ++i)
-		temp.setColour(i, trans->translate(colours_[i], this));
+		temp.setColour(i, table[i]);
 
 	// Load translated palette
 	copyPalette(&temp);
@@ -776,6 +958,7 @@ void Palette::saturate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
@@ -804,6 +987,7 @@ void Palette::illuminate(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
@@ -832,6 +1016,7 @@ void Palette::shift(float amount, int start, int end)
 		colours_[i]     = colours_hsl_[i].asRGB();
 		colours_lab_[i] = colours_[i].asLAB();
 	}
+	coloursChanged();
 }
 
 // -----------------------------------------------------------------------------
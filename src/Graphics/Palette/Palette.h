@@ -1,4 +1,5 @@
 #pragma once
+#include "Utility/CIEDeltaEquations.h"
 #include "Utility/Colour.h"
 
 namespace slade
@@ -53,6 +54,7 @@ public:
 	void   copyPalette(const Palette* copy);
 	short  findColour(const ColRGBA& colour);
 	short  nearestColour(const ColRGBA& colour, ColourMatch match = ColourMatch::Default);
+	void   nearestColours(const ColRGBA* colours, uint8_t* indices, unsigned count, ColourMatch match = ColourMatch::Default);
 	size_t countColours();
 	void   applyTranslation(Translation* trans);
 
@@ -69,11 +71,51 @@ public:
 	void idtint(int r, int g, int b, int shift, int steps);
 
 private:
+	// Cache of nearestColour results for each colour match method. It is only
+	// marked invalid when the palette colours change and cleared on next use, so
+	// setting many colours at once is still cheap. Copies start with no cache
+	class NearestCache
+	{
+	public:
+		NearestCache() = default;
+		NearestCache(const NearestCache&) {}
+		NearestCache& operator=(const NearestCache&)
+		{
+			invalidate();
+			return *this;
+		}
+
+		void invalidate() { valid_ = false; }
+		bool find(ColourMatch match, const ColRGBA& colour, short& index);
+		void add(ColourMatch match, const ColRGBA& colour, short index);
+
+	private:
+		static constexpr unsigned SLOT_BITS = 15;
+
+		// Cached colours for each match method, as ((rgb + 1) << 8) | index (0 = empty)
+		vector<uint64_t> slots_[static_cast<int>(ColourMatch::Stop) + 1];
+		float            weights_[6] = {}; // col_match_* cvar values the cache is valid for
+		bool             valid_      = false;
+
+		void     validate();
+		unsigned slot(uint32_t rgb) const { return (rgb * 2654435761u) >> (32 - SLOT_BITS); }
+	};
+
 	vector<ColRGBA> colours_;
 	vector<ColHSL>  colours_hsl_;
 	vector<ColLAB>  colours_lab_;
 	short           index_trans_;
+	NearestCache    nearest_cache_;
+
+	// LAB colours as float arrays for the batch CIE functions, updated on
+	// next colour match after the palette colours change
+	cie::LABArray lab_array_;
+	bool          lab_array_valid_ = false;
+
+	void  coloursChanged();
+	void  updateLABArray();
+	short findNearest(const ColRGBA& colour, ColourMatch match) const;
 
-	double colourDiff(const ColRGBA& rgb, const ColHSL& hsl, const ColLAB& lab, int index, ColourMatch match);
+	static ColourMatch resolveMatch(ColourMatch match);
 };
 } // namespace slade
@@ -0,0 +1,195 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    PaletteTables.cpp
+// Description: Functions to generate palette lookup tables - COLORMAPs (and
+//              Hexen-style fog maps), 256x256 blending tables (Boom TRANMAP,
+//              Heretic/Hexen TINTTAB) and translation tables. All colours in a
+//              table are matched to the palette at once (see
+//              Palette::nearestColours), so even full 256x256 tables only take
+//              a moment to generate
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "PaletteTables.h"
+#include "Graphics/Translation.h"
+
+using namespace slade;
+using namespace palettetables;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Float, col_greyscale_r)
+EXTERN_CVAR(Float, col_greyscale_g)
+EXTERN_CVAR(Float, col_greyscale_b)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [value] faded towards [fade] for colormap light [level] (0-31)
+// -----------------------------------------------------------------------------
+uint8_t diminish(uint8_t value, uint8_t fade, unsigned level)
+{
+	return static_cast<uint8_t>(((float)value * (32.0 - level) + (float)fade * level + 16.0) / 32.0);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [value] clamped to 0-255 and rounded
+// -----------------------------------------------------------------------------
+uint8_t clampChannel(float value)
+{
+	return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.f, 255.f));
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// PaletteTables Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Generates a Doom-style COLORMAP for [palette] in [out], with 34 maps:
+// - 32 diminishing light levels, fading each colour towards [fade] (black for
+//   a standard COLORMAP, other colours for Hexen-style FOGMAPs)
+// - the inverted greyscale map used by invulnerability
+// - an empty map (all palette index 0)
+// -----------------------------------------------------------------------------
+void palettetables::colormap(Palette& palette, MemChunk& out, const ColRGBA& fade, Palette::ColourMatch match)
+{
+	vector<ColRGBA> colours(34 * 256);
+	for (unsigned l = 0; l < 34; ++l)
+	{
+		for (unsigned c = 0; c < 256; ++c)
+		{
+			auto rgb = palette.colour(c);
+			if (l < 32)
+			{
+				// Light maps
+				rgb.r = diminish(rgb.r, fade.r, l);
+				rgb.g = diminish(rgb.g, fade.g, l);
+				rgb.b = diminish(rgb.b, fade.b, l);
+			}
+			else if (l == 32)
+			{
+				// Inverse map
+				float grey = ((float)rgb.r / 256.0 * col_greyscale_r) + ((float)rgb.g / 256.0 * col_greyscale_g)
+							 + ((float)rgb.b / 256.0 * col_greyscale_b);
+				grey = 1.0 - grey;
+				// Clamp value: with Id Software's values, the sum is greater than 1.0 (0.299+0.587+0.144=1.030)
+				// This means the negation above can give a negative value (for example, with RGB values of 247 or
+				// more), which will not be converted correctly to unsigned 8-bit int in the ColRGBA struct.
+				if (grey < 0.0)
+					grey = 0;
+				rgb.r = rgb.g = rgb.b = grey * 255;
+			}
+			else
+				rgb = palette.colour(0);
+
+			colours[l * 256 + c] = rgb;
+		}
+	}
+
+	out.reSize(colours.size(), false);
+	palette.nearestColours(colours.data(), out.data(), colours.size(), match);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a 256x256 table in [out] of each palette colour blended with each
+// other palette colour, using [mode] and [amount] (0-1) of the foreground
+// colour. The table is laid out as [background * 256 + foreground], as used
+// for Boom TRANMAP and Heretic/Hexen TINTTAB lumps
+// -----------------------------------------------------------------------------
+void palettetables::blendTable(
+	Palette&             palette,
+	MemChunk&            out,
+	float                amount,
+	BlendMode            mode,
+	Palette::ColourMatch match)
+{
+	auto blend = [amount, mode](uint8_t bg, uint8_t fg)
+	{
+		switch (mode)
+		{
+		case BlendMode::Additive: return clampChannel(bg + fg * amount);
+		case BlendMode::Subtractive: return clampChannel(bg - fg * amount);
+		default: return clampChannel(bg + (fg - bg) * amount);
+		}
+	};
+
+	vector<ColRGBA> colours(256 * 256);
+	for (unsigned bg = 0; bg < 256; ++bg)
+	{
+		auto col_bg = palette.colour(bg);
+		for (unsigned fg = 0; fg < 256; ++fg)
+		{
+			auto col_fg = palette.colour(fg);
+			colours[bg * 256 + fg].set(
+				blend(col_bg.r, col_fg.r), blend(col_bg.g, col_fg.g), blend(col_bg.b, col_fg.b));
+		}
+	}
+
+	out.reSize(colours.size(), false);
+	palette.nearestColours(colours.data(), out.data(), colours.size(), match);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a 256-byte table in [out] of the palette index each palette colour
+// is translated to by [translation]
+// -----------------------------------------------------------------------------
+void palettetables::translationTable(
+	Palette&             palette,
+	Translation&         translation,
+	MemChunk&            out,
+	Palette::ColourMatch match)
+{
+	vector<ColRGBA> colours(256);
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		auto col   = palette.colour(a);
+		col.index  = a;
+		colours[a] = translation.translate(col, &palette);
+	}
+
+	// Colours translated to a palette index can use it directly
+	out.reSize(256, false);
+	palette.nearestColours(colours.data(), out.data(), 256, match);
+	for (unsigned a = 0; a < 256; ++a)
+		if (colours[a].index >= 0 && colours[a].index < 256)
+			out[a] = colours[a].index;
+}
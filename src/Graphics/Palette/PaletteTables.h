@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Palette.h"
+
+namespace slade
+{
+class Translation;
+
+// Generation of palette lookup tables (COLORMAP, TRANMAP, TINTTAB, etc.)
+namespace palettetables
+{
+	enum class BlendMode
+	{
+		Translucent,
+		Additive,
+		Subtractive
+	};
+
+	void colormap(
+		Palette&             palette,
+		MemChunk&            out,
+		const ColRGBA&       fade  = ColRGBA::BLACK,
+		Palette::ColourMatch match = Palette::ColourMatch::Default);
+	void blendTable(
+		Palette&             palette,
+		MemChunk&            out,
+		float                amount,
+		BlendMode            mode  = BlendMode::Translucent,
+		Palette::ColourMatch match = Palette::ColourMatch::Default);
+	void translationTable(
+		Palette&             palette,
+		Translation&         translation,
+		MemChunk&            out,
+		Palette::ColourMatch match = Palette::ColourMatch::Default);
+} // namespace palettetables
+} // namespace slade
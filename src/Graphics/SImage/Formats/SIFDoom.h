@@ -10,7 +10,7 @@ public:
 	}
 	~SIFDoomGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		if (EntryDataFormat::format("img_doom")->isThisFormat(mc))
 			return true;
@@ -434,7 +434,7 @@ public:
 	SIFDoomBetaGfx() : SIFDoomGfx("doom_beta", "Doom Gfx (Beta)", 160) {}
 	~SIFDoomBetaGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_beta")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_beta")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -458,7 +458,7 @@ public:
 	SIFDoomAlphaGfx() : SIFDoomGfx("doom_alpha", "Doom Gfx (Alpha)", 100) {}
 	~SIFDoomAlphaGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_alpha")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_alpha")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -490,7 +490,7 @@ public:
 	SIFDoomArah() : SIFormat("doom_arah", "Doom Arah", "lmp", 100) {}
 	~SIFDoomArah() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_arah")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_arah")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -552,7 +552,7 @@ public:
 	SIFDoomSnea() : SIFormat("doom_snea", "Doom Snea", "lmp") {}
 	~SIFDoomSnea() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_snea")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_snea")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -621,7 +621,7 @@ public:
 	SIFDoomPSX() : SIFormat("doom_psx", "Doom PSX", "lmp", 100) {}
 	~SIFDoomPSX() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_psx")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_psx")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -795,7 +795,7 @@ public:
 	SIFDoomJaguar() : SIFormat("doom_jaguar", "Doom Jaguar", "lmp", 85) {}
 	~SIFDoomJaguar() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_doom_jaguar")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_doom_jaguar")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -5,7 +5,7 @@ public:
 	SIFPlanar() : SIFormat("planar", "Planar", "lmp", 240) {}
 	~SIFPlanar() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Can only go by image size
 		if (mc.size() == 153648)
@@ -244,7 +244,7 @@ public:
 	SIF4BitChunk() : SIFormat("4bit", "4-bit", "lmp", 80) {}
 	~SIF4BitChunk() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Can only detect by size
 		return (mc.size() == 32 || mc.size() == 184);
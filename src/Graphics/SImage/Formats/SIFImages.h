@@ -79,11 +79,8 @@ class SIFPng : public SIFormat
 public:
 	SIFPng() : SIFormat("png", "PNG", "png") {}
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
-		// Reset MemChunk
-		mc.seek(0, SEEK_SET);
-
 		// Check size
 		if (mc.size() > 8)
 		{
@@ -505,15 +502,21 @@ protected:
 		// Flip the image
 		FreeImage_FlipVertical(bm);
 
-		// Write the image to memory
+		// Write the image to memory (at the compression level set in preferences)
+		int flags = PNG_Z_DEFAULT_COMPRESSION;
+		if (png_compression == 0)
+			flags = PNG_Z_BEST_SPEED;
+		else if (png_compression == 2)
+			flags = PNG_Z_BEST_COMPRESSION;
 		auto fi_png = FreeImage_OpenMemory();
-		FreeImage_SaveToMemory(FIF_PNG, bm, fi_png);
+		FreeImage_SaveToMemory(FIF_PNG, bm, fi_png, flags);
 
 		// Write PNG header and IHDR
 		DWORD png_size;
 		BYTE* png_data;
 		FreeImage_AcquireMemory(fi_png, &png_data, &png_size);
 		data.clear();
+		data.reserve(png_size + 32); // Room for grAb and alPh chunks
 		data.write(png_data, 33);
 
 		// Create grAb chunk with offsets (only if offsets exist)
@@ -210,7 +210,7 @@ public:
 	}
 	~SIFJediBM() {}
 
-	bool isThisFormat(MemChunk& mc)
+	bool isThisFormat(const MemChunk& mc)
 	{
 		if (EntryDataFormat::getFormat("img_jedi_bm")->isThisFormat(mc))
 			return true;
@@ -317,7 +317,7 @@ public:
 	}
 	~SIFJediFME() {}
 
-	bool isThisFormat(MemChunk& mc)
+	bool isThisFormat(const MemChunk& mc)
 	{
 		if (EntryDataFormat::getFormat("img_jedi_fme")->isThisFormat(mc))
 			return true;
@@ -449,7 +449,7 @@ public:
 	}
 	~SIFJediWAX() {}
 
-	bool isThisFormat(MemChunk& mc)
+	bool isThisFormat(const MemChunk& mc)
 	{
 		if (EntryDataFormat::getFormat("img_jedi_wax")->isThisFormat(mc))
 			return true;
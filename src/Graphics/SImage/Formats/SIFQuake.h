@@ -5,7 +5,7 @@ public:
 	SIFQuakeGfx() : SIFormat("quake", "Quake Gfx", "dat") {}
 	~SIFQuakeGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quake")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quake")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -124,7 +124,7 @@ public:
 	SIFQuakeSprite() : SIFormat("qspr", "Quake Sprite", "dat") {}
 	~SIFQuakeSprite() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_qspr")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_qspr")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -256,7 +256,7 @@ public:
 	SIFQuakeTex() : SIFormat("quaketex", "Quake Texture", "dat", 11) {}
 	~SIFQuakeTex() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quaketex")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quaketex")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -312,7 +312,7 @@ public:
 	SIFQuake2Wal() : SIFormat("quake2wal", "Quake II Wall", "dat", 21) {}
 	~SIFQuake2Wal() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_quake2wal")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_quake2wal")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
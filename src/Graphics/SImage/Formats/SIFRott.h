@@ -8,7 +8,7 @@ public:
 	}
 	~SIFRottGfx() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rott")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
@@ -128,7 +128,7 @@ public:
 	SIFRottGfxMasked() : SIFRottGfx("rottmask", "ROTT Masked Gfx", 120) {}
 	~SIFRottGfxMasked() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_rottmask")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_rottmask")->isThisFormat(mc); }
 
 protected:
 	bool readImage(SImage& image, MemChunk& data, int index) override { return readRottGfx(image, data, true); }
@@ -140,7 +140,7 @@ public:
 	SIFRottLbm() : SIFormat("rottlbm", "ROTT Lbm", "dat", 80) {}
 	~SIFRottLbm() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottlbm")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
@@ -229,7 +229,7 @@ public:
 	SIFRottRaw() : SIFormat("rottraw", "ROTT Raw", "dat", 101) {}
 	~SIFRottRaw() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottraw")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
@@ -279,7 +279,7 @@ public:
 	SIFRottPic() : SIFormat("rottpic", "ROTT Picture", "dat", 60) {}
 	~SIFRottPic() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		return EntryDataFormat::format("img_rottpic")->isThisFormat(mc) >= EntryDataFormat::MATCH_PROBABLY;
 	}
@@ -346,7 +346,7 @@ public:
 	SIFRottWall() : SIFormat("rottwall", "ROTT Flat", "dat", 10) {}
 	~SIFRottWall() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return (mc.size() == 4096 || mc.size() == 51200); }
+	bool isThisFormat(const MemChunk& mc) override { return (mc.size() == 4096 || mc.size() == 51200); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -5,7 +5,7 @@ public:
 	SIFImgz() : SIFormat("imgz", "IMGZ", "imgz") {}
 	~SIFImgz() = default;
 
-	bool isThisFormat(MemChunk& mc) override { return EntryDataFormat::format("img_imgz")->isThisFormat(mc); }
+	bool isThisFormat(const MemChunk& mc) override { return EntryDataFormat::format("img_imgz")->isThisFormat(mc); }
 
 	SImage::Info info(MemChunk& mc, int index) override
 	{
@@ -34,8 +34,10 @@
 #undef BOOL
 #include "Archive/Archive.h"
 #include "Archive/EntryType/EntryType.h"
+#include "General/Console.h"
 #include "General/Misc.h"
 #include "SIFormat.h"
+#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -54,6 +56,9 @@ SIFormat*         sif_general = nullptr;
 SIFormat*         sif_unknown = nullptr;
 } // namespace
 
+// PNG compression effort when saving: 0 = fast, 1 = normal, 2 = best
+CVAR(Int, png_compression, 1, CVar::Flag::Save)
+
 
 // -----------------------------------------------------------------------------
 //
@@ -92,7 +97,7 @@ public:
 	SIFUnknown() : SIFormat("unknown") { reliability_ = 0; }
 	~SIFUnknown() = default;
 
-	bool         isThisFormat(MemChunk& mc) override { return false; }
+	bool         isThisFormat(const MemChunk& mc) override { return false; }
 	SImage::Info info(MemChunk& mc, int index) override { return {}; }
 };
 
@@ -109,7 +114,7 @@ public:
 	SIFGeneralImage() : SIFormat("image", "Image", "dat") {}
 	~SIFGeneralImage() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		auto mem = FreeImage_OpenMemory((BYTE*)mc.data(), mc.size());
 		auto fif = FreeImage_GetFileTypeFromMemory(mem, 0);
@@ -254,7 +259,7 @@ public:
 	SIFRaw(string_view id = "raw") : SIFormat(id, "Raw", "dat") {}
 	~SIFRaw() = default;
 
-	bool isThisFormat(MemChunk& mc) override
+	bool isThisFormat(const MemChunk& mc) override
 	{
 		// Just check the size
 		return validSize(mc.size());
@@ -667,3 +672,93 @@ void SIFormat::putAllFormats(vector<SIFormat*>& list)
 	list.push_back(sif_raw);
 	list.push_back(sif_flat);
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Benchmarks detection and decoding for each image format, over all files in
+// the directory given (and its subdirectories). Usage:
+// bench_siformats <directory> [passes]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(bench_siformats, 1, false)
+{
+	// Load all files in the directory
+	wxArrayString files;
+	wxDir::GetAllFiles(args[0], &files);
+	vector<MemChunk> lumps(files.size());
+	uint64_t         total_size = 0;
+	for (unsigned a = 0; a < files.size(); ++a)
+	{
+		lumps[a].importFile(files[a].ToStdString());
+		total_size += lumps[a].size();
+	}
+	if (lumps.empty())
+	{
+		log::console(fmt::format("No files found in {}", args[0]));
+		return;
+	}
+
+	auto passes = args.size() > 1 ? std::max(1, strutil::asInt(args[1])) : 1;
+	log::console(fmt::format("Benchmarking {} files ({} bytes), {} passes", lumps.size(), total_size, passes));
+
+	// Returns [bytes] per [ms] as MB/s
+	auto mb_per_sec = [](uint64_t bytes, long ms) { return ms > 0 ? bytes / 1048.576 / ms : 0.0; };
+
+	vector<SIFormat*> formats;
+	SIFormat::putAllFormats(formats);
+	vector<MemChunk*> detected;
+	SImage            image;
+	for (auto format : formats)
+	{
+		// Detection over all files
+		detected.clear();
+		auto start = app::runTimer();
+		for (int pass = 0; pass < passes; ++pass)
+			for (auto& lump : lumps)
+				if (format->isThisFormat(lump) && pass == 0)
+					detected.push_back(&lump);
+		auto detect_time = app::runTimer() - start;
+
+		// Decoding of detected files
+		uint64_t decoded_size = 0;
+		unsigned failed       = 0;
+		auto     allocs       = MemChunk::allocationCount();
+		start                 = app::runTimer();
+		for (int pass = 0; pass < passes; ++pass)
+			for (auto lump : detected)
+			{
+				if (format->loadImage(image, *lump))
+					decoded_size += lump->size();
+				else if (pass == 0)
+					++failed;
+			}
+		auto decode_time = app::runTimer() - start;
+		allocs           = MemChunk::allocationCount() - allocs;
+
+		auto n_decodes = static_cast<uint64_t>(detected.size()) * passes;
+		log::console(fmt::format(
+			"{}: detected {} ({} failed) | detect {}ms, {:.1f} MB/s | decode {}ms, {:.1f} MB/s, {:.1f} allocs/image",
+			format->id(),
+			detected.size(),
+			failed,
+			detect_time,
+			mb_per_sec(total_size * passes, detect_time),
+			decode_time,
+			mb_per_sec(decoded_size, decode_time),
+			n_decodes > 0 ? static_cast<double>(allocs) / n_decodes : 0.0));
+	}
+
+	// Full format detection (as used when opening an image)
+	auto start = app::runTimer();
+	for (int pass = 0; pass < passes; ++pass)
+		for (auto& lump : lumps)
+			SIFormat::determineFormat(lump);
+	auto time = app::runTimer() - start;
+	log::console(fmt::format("determineFormat: {}ms, {:.1f} MB/s", time, mb_per_sec(total_size * passes, time)));
+}
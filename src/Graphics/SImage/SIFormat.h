@@ -34,7 +34,7 @@ public:
 	const string& name() const { return name_; }
 	const string& extension() const { return extension_; }
 
-	virtual bool isThisFormat(MemChunk& mc) = 0;
+	virtual bool isThisFormat(const MemChunk& mc) = 0;
 
 	// Reading
 	virtual SImage::Info info(MemChunk& mc, int index = 0) = 0;
@@ -51,6 +51,78 @@ EXTERN_CVAR(Float, col_greyscale_g)
 EXTERN_CVAR(Float, col_greyscale_b)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the brightness of [r],[g],[b] using 0.3/0.59/0.11 weights, in 16.16
+// fixed point so per-pixel loops can be vectorised
+// -----------------------------------------------------------------------------
+inline uint8_t brightness(uint8_t r, uint8_t g, uint8_t b)
+{
+	return (r * 19661 + g * 38666 + b * 7209) >> 16;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the colours of [palette] to [table] as 4-byte RGBA values (with full
+// alpha), one per palette index
+// -----------------------------------------------------------------------------
+void paletteRGBA(const Palette& palette, uint8_t* table)
+{
+	memset(table, 0, 256 * 4);
+
+	auto& colours = palette.colours();
+	auto  count   = std::min<size_t>(colours.size(), 256);
+	for (size_t a = 0; a < count; ++a)
+	{
+		table[a * 4]     = colours[a].r;
+		table[a * 4 + 1] = colours[a].g;
+		table[a * 4 + 2] = colours[a].b;
+		table[a * 4 + 3] = 255;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Copies [width]x[height] pixels of [Bpp] bytes from [src] to [dst], where
+// source pixel x,y is written to destination pixel
+// [first] + (x * [step_x]) + (y * [step_y])
+// -----------------------------------------------------------------------------
+template<unsigned Bpp> void remapPixels(
+	const uint8_t* src,
+	uint8_t*       dst,
+	int            width,
+	int            height,
+	int            first,
+	int            step_x,
+	int            step_y)
+{
+	for (int y = 0; y < height; ++y)
+	{
+		int j = first + y * step_y;
+
+		// Straight row copy
+		if (step_x == 1)
+		{
+			memcpy(dst + j * Bpp, src, width * Bpp);
+			src += width * Bpp;
+			continue;
+		}
+
+		for (int x = 0; x < width; ++x)
+		{
+			memcpy(dst + j * Bpp, src, Bpp);
+			src += Bpp;
+			j += step_x;
+		}
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SImage Class Functions
@@ -103,21 +175,19 @@ bool SImage::putRGBAData(MemChunk& mc, Palette* pal) const
 		// Get palette to use
 		const auto& palette = (has_palette_ || !pal) ? palette_ : *pal;
 
-		uint8_t rgba[4];
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get colour
-			ColRGBA col = palette.colour(data_[a]);
+		// Look up each pixel's colour from a table of the palette's RGBA values
+		uint8_t table[256 * 4];
+		paletteRGBA(palette, table);
+		auto       dst   = mc.data();
+		const auto src   = data_.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a)
+			memcpy(dst + a * 4, table + src[a] * 4, 4);
 
-			// Set alpha
-			if (mask_.data())
-				col.a = mask_[a];
-			else
-				col.a = 255;
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
+		// Set alpha from mask
+		if (const auto mask = mask_.data())
+			for (int a = 0; a < count; ++a)
+				dst[a * 4 + 3] = mask[a];
 
 		return true;
 	}
@@ -125,16 +195,12 @@ bool SImage::putRGBAData(MemChunk& mc, Palette* pal) const
 	// Convert if alpha map
 	else if (type_ == Type::AlphaMap)
 	{
-		uint8_t rgba[4];
-		ColRGBA col;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Get pixel as colour (greyscale)
-			col.set(data_[a], data_[a], data_[a], data_[a]);
-
-			col.write(rgba);   // Write colour to array
-			mc.write(rgba, 4); // Write array to MemChunk
-		}
+		// Get pixel as colour (greyscale)
+		auto       dst   = mc.data();
+		const auto src   = data_.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a)
+			memset(dst + a * 4, src[a], 4);
 	}
 
 	return false; // Invalid image type
@@ -216,6 +282,31 @@ bool SImage::putIndexedData(MemChunk& mc) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Loads the (paletted) image as pairs of palette index + alpha (from the mask,
+// or 255 if there is none) into [mc].
+// Returns false if image is invalid or not paletted, true otherwise
+// -----------------------------------------------------------------------------
+bool SImage::putIndexedMaskData(MemChunk& mc) const
+{
+	// Check the image is valid
+	if (!isValid() || type_ != Type::PalMask)
+		return false;
+
+	const auto count = width_ * height_;
+	mc.reSize(count * 2, false);
+	auto       dst  = mc.data();
+	const auto src  = data_.data();
+	const auto mask = mask_.hasData() ? mask_.data() : nullptr;
+	for (int a = 0; a < count; ++a)
+	{
+		dst[a * 2]     = src[a];
+		dst[a * 2 + 1] = mask ? mask[a] : 255;
+	}
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the number of bytes per image row
 // -----------------------------------------------------------------------------
@@ -665,9 +756,11 @@ bool SImage::convertPaletted(Palette* pal_target, Palette* pal_current)
 		mask_.reSize(width_ * height_);
 
 		// Get values from alpha channel
-		int c = 0;
-		for (int a = 3; a < width_ * height_ * 4; a += 4)
-			mask_[c++] = rgba_data[a];
+		auto       mask  = mask_.data();
+		const auto src   = rgba_data.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a)
+			mask[a] = src[a * 4 + 3];
 	}
 
 	// Load given palette
@@ -676,17 +769,26 @@ bool SImage::convertPaletted(Palette* pal_target, Palette* pal_current)
 	// Clear current image data (but not mask)
 	clearData(false);
 
-	// Do conversion
+	// Do conversion (neighbouring pixels are often the same colour, so only look
+	// up the nearest palette colour when it changes)
 	data_.reSize(width_ * height_);
-	unsigned i = 0;
+	auto     dst        = data_.data();
+	auto     src        = rgba_data.data();
+	uint32_t last_rgb   = 0xFFFFFFFF;
+	uint8_t  last_index = 0;
 	ColRGBA  col;
-	for (int a = 0; a < width_ * height_; a++)
+	for (int a = 0; a < width_ * height_; a++, src += 4)
 	{
-		col.r    = rgba_data[i++];
-		col.g    = rgba_data[i++];
-		col.b    = rgba_data[i++];
-		data_[a] = palette_.nearestColour(col);
-		i++; // Skip alpha
+		uint32_t rgb = src[0] | (src[1] << 8) | (src[2] << 16);
+		if (rgb != last_rgb)
+		{
+			col.r      = src[0];
+			col.g      = src[1];
+			col.b      = src[2];
+			last_index = palette_.nearestColour(col);
+			last_rgb   = rgb;
+		}
+		dst[a] = last_index;
 	}
 
 	// Update variables
@@ -749,31 +851,25 @@ bool SImage::maskFromColour(ColRGBA colour, Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
+		// Determine the mask value for each palette index
+		uint8_t alpha[256];
+		for (unsigned a = 0; a < 256; ++a)
+			alpha[a] = pal->colour(a).equals(colour) ? 0 : 255;
+
 		// Palette+Mask type, go through the mask
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			if (pal->colour(data_[a]).equals(colour))
-				mask_[a] = 0;
-			else
-				mask_[a] = 255;
-		}
+		auto       mask  = mask_.data();
+		const auto src   = data_.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a)
+			mask[a] = alpha[src[a]];
 	}
 	else if (type_ == Type::RGBA)
 	{
 		// RGBA type, go through alpha channel
-		uint32_t c = 0;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			ColRGBA pix_col(data_[c], data_[c + 1], data_[c + 2], 255);
-
-			if (pix_col.equals(colour))
-				data_[c + 3] = 0;
-			else
-				data_[c + 3] = 255;
-
-			// Skip to next pixel
-			c += 4;
-		}
+		auto       pixel = data_.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a, pixel += 4)
+			pixel[3] = (pixel[0] == colour.r && pixel[1] == colour.g && pixel[2] == colour.b) ? 0 : 255;
 	}
 	else
 		return false;
@@ -796,25 +892,28 @@ bool SImage::maskFromBrightness(Palette* pal)
 		if (has_palette_ || !pal)
 			pal = &palette_;
 
-		// Go through pixel data
-		for (int a = 0; a < width_ * height_; a++)
+		// Determine the brightness of each palette index
+		uint8_t alpha[256];
+		for (unsigned a = 0; a < 256; ++a)
 		{
-			// Set mask from pixel colour brightness value
-			ColRGBA col = pal->colour(data_[a]);
-			mask_[a]    = ((double)col.r * 0.3) + ((double)col.g * 0.59) + ((double)col.b * 0.11);
+			auto col = pal->colour(a);
+			alpha[a] = brightness(col.r, col.g, col.b);
 		}
+
+		// Set mask from pixel colour brightness value
+		auto       mask  = mask_.data();
+		const auto src   = data_.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a)
+			mask[a] = alpha[src[a]];
 	}
 	else if (type_ == Type::RGBA)
 	{
-		// Go through pixel data
-		unsigned c = 0;
-		for (int a = 0; a < width_ * height_; a++)
-		{
-			// Set alpha from pixel colour brightness value
-			data_[c + 3] = (double)data_[c] * 0.3 + (double)data_[c + 1] * 0.59 + (double)data_[c + 2] * 0.11;
-			// Skip alpha
-			c += 4;
-		}
+		// Set alpha from pixel colour brightness value
+		auto       pixel = data_.data();
+		const auto count = width_ * height_;
+		for (int a = 0; a < count; ++a, pixel += 4)
+			pixel[3] = brightness(pixel[0], pixel[1], pixel[2]);
 	}
 	// ALPHAMASK type is already a brightness mask
 
@@ -1027,36 +1126,41 @@ bool SImage::rotate(int angle)
 	else
 		return false;
 
+	// Determine where each source pixel goes in the new image
+	int first, step_x, step_y;
+	switch (angle)
+	{
+	case 90:
+		first  = (new_height - 1) * new_width;
+		step_x = -new_width;
+		step_y = 1;
+		break;
+	case 180:
+		first  = numpixels - 1;
+		step_x = -1;
+		step_y = -width_;
+		break;
+	case 270:
+		first  = new_width - 1;
+		step_x = new_width;
+		step_y = -1;
+		break;
+	default: return false;
+	}
+
 	// Create new data and mask
 	vector<uint8_t> new_data(numpixels * numbpp);
 	vector<uint8_t> new_mask;
 	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp, 0);
+		new_mask.resize(numpixels, 0);
 
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
-	{
-		switch (angle)
-		{
-			// Urgh maths...
-		case 90: j = (((new_height - 1) - (i % width_)) * new_width) + (i / width_); break;
-		case 180: j = (numpixels - 1) - i; break;
-		case 270: j = ((i % width_) * new_width) + ((new_width - 1) - (i / width_)); break;
-		default: return false;
-		}
-		if (j >= numpixels)
-		{
-			log::error("Pixel {} remapped to {}, how did this even happen?", i, j);
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
-		{
-			new_data[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_.hasData())
-				new_mask[(j * numbpp) + k] = mask_[(i * numbpp) + k];
-		}
-	}
+	// Remap pixels
+	if (numbpp == 4)
+		remapPixels<4>(data_.data(), new_data.data(), width_, height_, first, step_x, step_y);
+	else
+		remapPixels<1>(data_.data(), new_data.data(), width_, height_, first, step_x, step_y);
+	if (!new_mask.empty())
+		remapPixels<1>(mask_.data(), new_mask.data(), width_, height_, first, step_x, step_y);
 
 	// It worked, yay
 	clearData();
@@ -1090,28 +1194,21 @@ bool SImage::mirror(bool vertical)
 	vector<uint8_t> new_data(numpixels * numbpp);
 	vector<uint8_t> new_mask;
 	if (mask_.hasData())
-		new_mask.resize(numpixels * numbpp);
+		new_mask.resize(numpixels);
 
-	// Remapping loop
-	int i, j, k;
-	for (i = 0; i < numpixels; ++i)
-	{
-		if (vertical)
-			j = (((height_ - 1) - (i / width_)) * width_) + (i % width_);
-		else // horizontal
-			j = ((i / width_) * width_) + ((width_ - 1) - (i % width_));
-		if (j >= numpixels)
-		{
-			log::error("Pixel {} remapped to {}, how did this even happen?", i, j);
-			return false;
-		}
-		for (k = 0; k < numbpp; ++k)
-		{
-			new_data[(j * numbpp) + k] = data_[(i * numbpp) + k];
-			if (mask_.hasData())
-				new_mask[(j * numbpp) + k] = mask_[(i * numbpp) + k];
-		}
-	}
+	// Determine where each source pixel goes (vertical mirroring just reverses
+	// the row order, horizontal reverses each row)
+	int first  = vertical ? (height_ - 1) * width_ : width_ - 1;
+	int step_x = vertical ? 1 : -1;
+	int step_y = vertical ? -width_ : width_;
+
+	// Remap pixels
+	if (numbpp == 4)
+		remapPixels<4>(data_.data(), new_data.data(), width_, height_, first, step_x, step_y);
+	else
+		remapPixels<1>(data_.data(), new_data.data(), width_, height_, first, step_x, step_y);
+	if (!new_mask.empty())
+		remapPixels<1>(mask_.data(), new_mask.data(), width_, height_, first, step_x, step_y);
 
 	// It worked, yay
 	clearData();
@@ -1307,6 +1404,15 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 	else
 		newdata = data_.data();
 
+	// The translation of a colour doesn't depend on the pixel, so paletted
+	// pixels are looked up in the translation's compiled table, and truecolour
+	// pixels reuse the previous result for runs of the same colour
+	auto     table      = type_ == Type::PalMask ? tr->table(pal) : nullptr;
+	uint32_t last_rgba  = 0;
+	bool     last_done  = false;
+	bool     last_match = false;
+	ColRGBA  last_col;
+
 	// Go through pixels
 	for (int p = 0; p < width_ * height_; p++)
 	{
@@ -1317,19 +1423,28 @@ bool SImage::applyTranslation(Translation* tr, Palette* pal, bool truecolor)
 		ColRGBA col;
 		int     q = p * bpp;
 		if (type_ == Type::PalMask)
-			col.set(pal->colour(data_[p]));
+			col = table[data_[p]];
 		else if (type_ == Type::RGBA)
 		{
-			col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
-
-			// skip colours that don't match exactly to the palette
-			col.index = pal->nearestColour(col);
-			if (!col.equals(pal->colour(col.index)))
+			uint32_t rgba;
+			memcpy(&rgba, data_.data() + q, 4);
+			if (!last_done || rgba != last_rgba)
+			{
+				col.set(data_[q], data_[q + 1], data_[q + 2], data_[q + 3]);
+
+				// skip colours that don't match exactly to the palette
+				col.index  = pal->nearestColour(col);
+				last_match = col.equals(pal->colour(col.index));
+				if (last_match)
+					last_col = tr->translate(col, pal);
+				last_rgba = rgba;
+				last_done = true;
+			}
+			if (!last_match)
 				continue;
+			col = last_col;
 		}
 
-		col = tr->translate(col, pal);
-
 		if (truecolor)
 		{
 			q              = p * 4;
@@ -1568,37 +1683,49 @@ bool SImage::colourise(ColRGBA colour, Palette* pal, int start, int stop)
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	// Go through all pixels
-	uint8_t bpp = this->bpp();
-	ColRGBA col;
-	for (int a = 0; a < width_ * height_ * bpp; a += bpp)
+	// Colourise pixel data
+	float      grey_r = col_greyscale_r;
+	float      grey_g = col_greyscale_g;
+	float      grey_b = col_greyscale_b;
+	const auto count  = width_ * height_;
+	if (type_ == Type::RGBA)
 	{
-		// Skip colors out of range if desired
-		if (type_ == Type::PalMask && start >= 0 && stop >= start && stop < 256)
+		auto pixel = data_.data();
+		for (int a = 0; a < count; ++a, pixel += 4)
 		{
-			if (data_[a] < start || data_[a] > stop)
-				continue;
+			float grey = std::min((pixel[0] * grey_r + pixel[1] * grey_g + pixel[2] * grey_b) / 255.0f, 1.0f);
+			pixel[0]   = colour.r * grey;
+			pixel[1]   = colour.g * grey;
+			pixel[2]   = colour.b * grey;
 		}
 
-		// Get current pixel colour
-		if (type_ == Type::RGBA)
-			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
-		else
-			col.set(pal->colour(data_[a]));
+		return true;
+	}
 
-		// Colourise it
-		float grey = (col.r * col_greyscale_r + col.g * col_greyscale_g + col.b * col_greyscale_b) / 255.0f;
-		if (grey > 1.0)
-			grey = 1.0;
-		col.r = colour.r * grey;
-		col.g = colour.g * grey;
-		col.b = colour.b * grey;
+	// Paletted, so each palette index only needs to be colourised and matched
+	// to the palette once
+	bool  in_range = start >= 0 && stop >= start && stop < 256;
+	short mapped[256];
+	std::fill_n(mapped, 256, -1);
+	auto pixel = data_.data();
+	for (int a = 0; a < count; ++a)
+	{
+		// Skip colors out of range if desired
+		auto index = pixel[a];
+		if (in_range && (index < start || index > stop))
+			continue;
 
-		// Set pixel colour
-		if (type_ == Type::RGBA)
-			col.write(data_.data() + a);
-		else
-			data_[a] = pal->nearestColour(col);
+		if (mapped[index] < 0)
+		{
+			auto  col  = pal->colour(index);
+			float grey = std::min((col.r * grey_r + col.g * grey_g + col.b * grey_b) / 255.0f, 1.0f);
+			col.r      = colour.r * grey;
+			col.g      = colour.g * grey;
+			col.b      = colour.b * grey;
+
+			mapped[index] = pal->nearestColour(col);
+		}
+		pixel[a] = mapped[index];
 	}
 
 	return true;
@@ -1619,37 +1746,46 @@ bool SImage::tint(ColRGBA colour, float amount, Palette* pal, int start, int sto
 	if (has_palette_ || !pal)
 		pal = &palette_;
 
-	// Go through all pixels
-	uint8_t bpp = this->bpp();
-	ColRGBA col;
-	for (int a = 0; a < width_ * height_ * bpp; a += bpp)
+	// Tint pixel data
+	float      inv_amt = 1.0f - amount;
+	float      tint_r  = colour.r * amount;
+	float      tint_g  = colour.g * amount;
+	float      tint_b  = colour.b * amount;
+	const auto count   = width_ * height_;
+	if (type_ == Type::RGBA)
 	{
-		// Skip colors out of range if desired
-		if (type_ == Type::PalMask && start >= 0 && stop >= start && stop < 256)
+		auto pixel = data_.data();
+		for (int a = 0; a < count; ++a, pixel += 4)
 		{
-			if (data_[a] < start || data_[a] > stop)
-				continue;
+			pixel[0] = pixel[0] * inv_amt + tint_r;
+			pixel[1] = pixel[1] * inv_amt + tint_g;
+			pixel[2] = pixel[2] * inv_amt + tint_b;
 		}
 
-		// Get current pixel colour
-		if (type_ == Type::RGBA)
-			col.set(data_[a], data_[a + 1], data_[a + 2], data_[a + 3]);
-		else
-			col.set(pal->colour(data_[a]));
+		return true;
+	}
 
-		// Tint it
-		float inv_amt = 1.0f - amount;
-		col.set(
-			col.r * inv_amt + colour.r * amount,
-			col.g * inv_amt + colour.g * amount,
-			col.b * inv_amt + colour.b * amount,
-			col.a);
+	// Paletted, so each palette index only needs to be tinted and matched to the
+	// palette once
+	bool  in_range = start >= 0 && stop >= start && stop < 256;
+	short mapped[256];
+	std::fill_n(mapped, 256, -1);
+	auto pixel = data_.data();
+	for (int a = 0; a < count; ++a)
+	{
+		// Skip colors out of range if desired
+		auto index = pixel[a];
+		if (in_range && (index < start || index > stop))
+			continue;
 
-		// Set pixel colour
-		if (type_ == Type::RGBA)
-			col.write(data_.data() + a);
-		else
-			data_[a] = pal->nearestColour(col);
+		if (mapped[index] < 0)
+		{
+			auto col = pal->colour(index);
+			col.set(col.r * inv_amt + tint_r, col.g * inv_amt + tint_g, col.b * inv_amt + tint_b, col.a);
+
+			mapped[index] = pal->nearestColour(col);
+		}
+		pixel[a] = mapped[index];
 	}
 
 	return true;
@@ -83,6 +83,7 @@ public:
 	bool      putRGBAData(MemChunk& mc, Palette* pal = nullptr) const;
 	bool      putRGBData(MemChunk& mc, Palette* pal = nullptr) const;
 	bool      putIndexedData(MemChunk& mc) const;
+	bool      putIndexedMaskData(MemChunk& mc) const;
 	int       width() const { return width_; }
 	int       height() const { return height_; }
 	int       index() const { return imgindex_; }
@@ -456,6 +456,38 @@ TransRange* Translation::range(unsigned index)
 		return translations_[index].get();
 }
 
+// -----------------------------------------------------------------------------
+// Returns a table of the translated colour for each (of 256) index in [pal],
+// the same as calling translate on each palette colour.
+// The table is compiled once and kept until the translation (or palette)
+// changes. Ranges can be edited directly through range(), so this is checked
+// by comparing the translation's text definition rather than tracking edits
+// -----------------------------------------------------------------------------
+const ColRGBA* Translation::table(Palette* pal)
+{
+	if (pal == nullptr)
+		pal = maineditor::currentPalette();
+
+	auto def = fmt::format("{}|{}", asText(), desat_amount_);
+	if (table_.size() == 256 && def == table_def_
+		&& std::equal(
+			table_palette_.begin(),
+			table_palette_.end(),
+			pal->colours().begin(),
+			pal->colours().end(),
+			[](const ColRGBA& a, const ColRGBA& b) { return a.equals(b, true, true); }))
+		return table_.data();
+
+	// (Re)compile
+	table_.resize(256);
+	for (unsigned a = 0; a < 256; ++a)
+		table_[a] = translate(pal->colour(a), pal);
+	table_palette_ = pal->colours();
+	table_def_     = def;
+
+	return table_.data();
+}
+
 // -----------------------------------------------------------------------------
 // Apply the translation to the given color
 // -----------------------------------------------------------------------------
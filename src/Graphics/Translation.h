@@ -280,7 +280,8 @@ public:
 	void setBuiltInName(string_view name) { built_in_name_ = name; }
 	void setDesaturationAmount(uint8_t amount) { desat_amount_ = amount; }
 
-	ColRGBA translate(ColRGBA col, Palette* pal = nullptr);
+	ColRGBA        translate(ColRGBA col, Palette* pal = nullptr);
+	const ColRGBA* table(Palette* pal = nullptr);
 
 	TransRange* addRange(TransRange::Type type, int pos = -1, int range_start = 0, int range_end = 0);
 	void        removeRange(int pos);
@@ -293,5 +294,11 @@ private:
 	vector<unique_ptr<TransRange>> translations_;
 	string                         built_in_name_;
 	uint8_t                        desat_amount_ = 0;
+
+	// Compiled translation of each palette index, for the palette and
+	// translation definition it was compiled from (see table)
+	vector<ColRGBA> table_;
+	vector<ColRGBA> table_palette_;
+	string          table_def_;
 };
 } // namespace slade
@@ -32,12 +32,17 @@
 #include "Main.h"
 #include "ArchiveOperations.h"
 #include "App.h"
+#include "Archive/ArchiveDiff.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/ResourceUsage.h"
 #include "Archive/Formats/WadArchive.h"
 #include "General/Console.h"
 #include "General/ResourceManager.h"
+#include "General/UndoRedo.h"
 #include "Graphics/CTexture/TextureXList.h"
 #include "MainEditor/MainEditor.h"
+#include "MainEditor/UI/ArchiveManagerPanel.h"
+#include "MainEditor/UI/ArchivePanel.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "SLADEMap/MapFormat/Doom64MapFormat.h"
 #include "SLADEMap/MapFormat/DoomMapFormat.h"
@@ -46,8 +51,11 @@
 #include "SLADEMap/MapObject/MapThing.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/SFileDialog.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -91,18 +99,21 @@ bool archiveoperations::removeUnusedPatches(Archive* archive)
 	if (!pnames || tx_entries.empty())
 		return false;
 
+	// Get resource usage index
+	auto usage = resourceusage::archiveIndex(archive);
+	if (!usage)
+		return false;
+
 	// Open patch table
 	PatchTable ptable;
 	ptable.loadPNAMES(pnames, archive);
 
-	// Open texturex entries to update patch usage
+	// Open texturex entries
 	vector<TextureXList*> tx_lists;
 	for (auto& entry : tx_entries)
 	{
 		auto texturex = new TextureXList();
 		texturex->readTEXTUREXData(entry, ptable);
-		for (unsigned t = 0; t < texturex->size(); t++)
-			ptable.updatePatchUsage(texturex->texture(t));
 		tx_lists.push_back(texturex);
 	}
 
@@ -114,7 +125,7 @@ bool archiveoperations::removeUnusedPatches(Archive* archive)
 		auto& p = ptable.patch(a);
 
 		// Check if used in any texture
-		if (p.used_in.empty())
+		if (!usage->isUsed(resourceusage::ResourceType::Patch, p.name))
 		{
 			// Unused
 
@@ -285,7 +296,7 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 		other                  = bra->findLast(search);
 
 		// If there is one, and it is identical, remove it
-		if (other != nullptr && (other->data().crc() == entry->data().crc()))
+		if (other != nullptr && other->size() == entry->size() && other->contentHash() == entry->contentHash())
 		{
 			++count;
 			dups += wxString::Format("%s\n", search.match_name);
@@ -314,6 +325,69 @@ void archiveoperations::removeEntriesUnchangedFromIWAD(Archive* archive)
 	msg.ShowModal();
 }
 
+// -----------------------------------------------------------------------------
+// Compares [archive] with an older version of it selected by the user, and
+// displays a list of the entries that were added, removed, changed or moved.
+// If there are any added or changed entries, the user can choose to create a
+// new (unsaved) patch archive containing them
+// -----------------------------------------------------------------------------
+void archiveoperations::compareWithArchive(Archive* archive)
+{
+	if (!archive)
+		return;
+
+	// Browse for the archive to compare with
+	filedialog::FDInfo info;
+	if (!filedialog::openFile(
+			info, "Compare With Archive", app::archiveManager().getArchiveExtensionsString(), theMainWindow))
+		return;
+
+	// Open it (unmanaged, it's only needed here)
+	auto other = app::archiveManager().openArchive(info.filenames[0], false, true);
+	if (!other)
+	{
+		wxMessageBox(wxString::Format("Unable to open archive:\n%s", global::error), "Error", wxICON_ERROR);
+		return;
+	}
+
+	// Compare
+	archivediff::Result diff;
+	{
+		wxBusyCursor busy;
+		diff = archivediff::compare(*other, *archive);
+	}
+	if (diff.identical())
+	{
+		wxMessageBox(wxString::Format("No differences found (%d entries)", diff.unchanged), "Compare With Archive");
+		return;
+	}
+
+	// Display differences
+	ExtMessageDialog msg(theMainWindow, "Compare With Archive");
+	msg.setExt(archivediff::summary(diff));
+	msg.setMessage(wxString::Format(
+		"Differences from %s:\n%lu changed, %lu added, %lu removed, %lu moved",
+		other->filename(false),
+		static_cast<unsigned long>(diff.changed.size()),
+		static_cast<unsigned long>(diff.added.size()),
+		static_cast<unsigned long>(diff.removed.size()),
+		static_cast<unsigned long>(diff.moved.size())));
+	msg.ShowModal();
+
+	// Create patch archive if requested
+	if (diff.added.empty() && diff.changed.empty() && diff.moved.empty())
+		return;
+	if (wxMessageBox(
+			"Create a new archive containing the added, changed and moved entries?",
+			"Create Patch Archive",
+			wxYES_NO | wxICON_QUESTION)
+		!= wxYES)
+		return;
+
+	if (auto patch = app::archiveManager().newArchive(archive->formatId()))
+		archivediff::writePatch(diff, *patch);
+}
+
 // -----------------------------------------------------------------------------
 // Checks [archive] for multiple entries with the same data, and displays a list
 // of the duplicate entries' names if any are found
@@ -338,8 +412,9 @@ bool archiveoperations::checkDuplicateEntryContent(Archive* archive)
 		if (entry->type() == EntryType::mapMarkerType() || entry->size() == 0)
 			continue;
 
-		// Enqueue entries
-		map_entries[entry->data().crc()].push_back(entry);
+		// Enqueue entries (the content hash is cached, so their data only
+		// needs to be read the first time)
+		map_entries[entry->contentHash()].push_back(entry);
 	}
 
 	// Now iterate through the dupes to list the name of the duplicated entries
@@ -380,7 +455,13 @@ bool archiveoperations::checkDuplicateEntryContent(Archive* archive)
 }
 
 
-
+// -----------------------------------------------------------------------------
+//
+// Map Scanning
+//
+// -----------------------------------------------------------------------------
+namespace
+{
 // Hardcoded doom defaults for now
 int      n_tex_anim       = 13;
 wxString tex_anim_start[] = {
@@ -400,100 +481,364 @@ wxString flat_anim_end[] = {
 	"NUKAGE3", "FWATER4", "SWATER4", "LAVA4", "BLOOD3", "RROCK08", "SLIME04", "SLIME08", "SLIME12",
 };
 
-struct texused_t
+// -----------------------------------------------------------------------------
+// Returns a key for the (up to) 8-character, case-insensitive texture name
+// at [name], so names can be compared without creating strings
+// -----------------------------------------------------------------------------
+uint64_t nameKey(const char* name, size_t length = 8)
+{
+	uint64_t key = 0;
+	for (size_t c = 0; c < 8 && c < length && name[c]; ++c)
+		key |= static_cast<uint64_t>(toupper(static_cast<uint8_t>(name[c]))) << (c * 8);
+	return key;
+}
+uint64_t nameKey(string_view name)
+{
+	return nameKey(name.data(), name.size());
+}
+
+// A map found by a MapScan, with its lumps and any changes made to them
+struct ScanMap
 {
-	bool used;
-	texused_t() { used = false; }
+	string        name;
+	MapFormat     format   = MapFormat::Unknown;
+	unsigned      archive  = 0; // Index of the ScanArchive containing the map
+	ArchiveEntry* things   = nullptr;
+	ArchiveEntry* linedefs = nullptr;
+	ArchiveEntry* sidedefs = nullptr;
+	ArchiveEntry* sectors  = nullptr;
+	ArchiveEntry* textmap  = nullptr;
+
+	vector<std::pair<ArchiveEntry*, vector<uint8_t>>> changes; // Modified data for each changed lump
+	size_t                                            changed = 0; // Number of changed map objects
 };
-WX_DECLARE_STRING_HASH_MAP(texused_t, TexUsedMap);
-void archiveoperations::removeUnusedTextures(Archive* archive)
+
+// An archive scanned for maps: either the archive being operated on, or a
+// wad embedded in it (or in another embedded wad)
+struct ScanArchive
 {
-	// Check archive was given
-	if (!archive)
-		return;
+	Archive*               archive = nullptr;
+	shared_ptr<WadArchive> embedded;           // The opened embedded wad
+	ArchiveEntry*          head   = nullptr;   // The entry the embedded wad was opened from
+	int                    parent = -1;        // Index of the ScanArchive containing [head]
+	size_t                 changed = 0;        // Number of changed map objects in the archive
+	bool                   modified = false;
+};
+
+// -----------------------------------------------------------------------------
+// MapScan class
+//
+// Finds all maps in an archive (including maps in embedded wads), so that
+// they can be processed in parallel and any changes then written back to
+// the archive as a single undo level
+// -----------------------------------------------------------------------------
+class MapScan
+{
+public:
+	MapScan(Archive* archive)
+	{
+		archives_.push_back({ archive });
+		addMaps(0);
+	}
 
-	// --- Build list of used textures ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
+	vector<ScanMap>& maps() { return maps_; }
 
-	// Get all SIDEDEFS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sidedefs");
-	auto sidedefs  = archive->findAll(opt);
-	total_maps += sidedefs.size();
-
-	// Go through and add used textures to list
-	DoomMapFormat::SideDef sdef;
-	wxString               tex_lower, tex_middle, tex_upper;
-	for (auto& sidedef : sidedefs)
+	// -------------------------------------------------------------------------
+	// Runs [func] on each map in parallel.
+	// [func] must not modify any entries, only the map's changes list
+	// -------------------------------------------------------------------------
+	void process(const std::function<void(ScanMap&)>& func)
+	{
+		threadpool::parallelFor(maps_.size(), [&](size_t index) { func(maps_[index]); });
+	}
+
+	// -------------------------------------------------------------------------
+	// Writes all changes made while processing to their entries (recording a
+	// single undo level named [undo_name]), logging the number of [objects]
+	// changed in each map.
+	// Returns the total number of map objects changed
+	// -------------------------------------------------------------------------
+	size_t commit(string_view undo_name, string_view objects)
 	{
-		int nsides = sidedef->size() / 30;
-		sidedef->seek(0, SEEK_SET);
-		for (int s = 0; s < nsides; s++)
+		// Log changes
+		string report;
+		for (auto& map : maps_)
+			report += fmt::format("{}:\t{} {} changed\n", map.name, map.changed, objects);
+		log::info(1, report);
+
+		// Check anything was changed
+		bool changed = false;
+		for (auto& map : maps_)
+			if (!map.changes.empty())
+				changed = true;
+		if (!changed)
+			return 0;
+
+		// Begin undo level (if the archive is open in a tab)
+		auto panel        = theMainWindow->archiveManagerPanel()->tabForArchive(archives_[0].archive);
+		auto undo_manager = panel ? panel->undoManager() : nullptr;
+		if (undo_manager)
+			undo_manager->beginRecord(undo_name);
+
+		// Apply changes to map lumps
+		for (auto& map : maps_)
+		{
+			auto& archive = archives_[map.archive];
+			for (auto& change : map.changes)
+				setEntryData(archive, change.first, change.second.data(), change.second.size(), undo_manager);
+			if (!map.changes.empty())
+			{
+				archive.changed += map.changed;
+				archive.modified = true;
+			}
+		}
+
+		// Write modified embedded wads back to their entries (in reverse, so
+		// that any wads within embedded wads are written first)
+		for (int a = archives_.size() - 1; a > 0; --a)
 		{
-			// Read side data
-			sidedef->read(&sdef, 30);
-
-			// Get textures
-			tex_lower  = wxString::FromAscii(sdef.tex_lower, 8);
-			tex_middle = wxString::FromAscii(sdef.tex_middle, 8);
-			tex_upper  = wxString::FromAscii(sdef.tex_upper, 8);
-
-			// Add to used textures list
-			used_textures[tex_lower].used  = true;
-			used_textures[tex_middle].used = true;
-			used_textures[tex_upper].used  = true;
+			auto& archive = archives_[a];
+			if (!archive.modified)
+				continue;
+
+			MemChunk mc;
+			if (!archive.embedded->write(mc, true))
+			{
+				log::warning("Unable to write embedded wad {}", archive.head->name());
+				continue;
+			}
+			archive.embedded->close();
+
+			auto& parent = archives_[archive.parent];
+			if (undo_manager && archive.parent == 0)
+				undo_manager->recordUndoStep(std::make_unique<EntryDataUS>(archive.head));
+			if (archive.head->importMemChunk(mc))
+			{
+				parent.changed += archive.changed;
+				parent.modified = true;
+			}
 		}
+
+		if (undo_manager)
+			undo_manager->endRecord(true);
+
+		return archives_[0].changed;
 	}
 
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
+private:
+	vector<ScanArchive> archives_;
+	vector<ScanMap>     maps_;
 
-	// Go through and add used textures to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
+	// -------------------------------------------------------------------------
+	// Adds all maps in the ScanArchive at [index], opening any embedded wads.
+	// Map lump data is loaded here since it can't be loaded while processing
+	// -------------------------------------------------------------------------
+	void addMaps(unsigned index)
 	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
+		auto archive = archives_[index].archive;
+		for (auto& desc : archive->detectMaps())
 		{
-			// Check for sidedef definition
-			if (token == "sidedef")
+			auto head = desc.head.lock();
+			if (!head)
+				continue;
+
+			// Embedded wad
+			if (desc.archive)
 			{
-				tz.getToken(); // Skip {
+				auto wad = std::make_shared<WadArchive>();
+				if (!wad->open(head->data()))
+					continue;
 
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturetop" || token == "texturemiddle" || token == "texturebottom")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
+				ScanArchive embedded;
+				embedded.archive  = wad.get();
+				embedded.embedded = wad;
+				embedded.head     = head.get();
+				embedded.parent   = index;
+				archives_.push_back(embedded);
+				addMaps(archives_.size() - 1);
+				continue;
+			}
 
-					token = tz.getToken();
-				}
+			if (desc.format == MapFormat::Unknown)
+				log::warning("Unknown map format for " + head->name());
+
+			ScanMap map;
+			map.name    = head->name();
+			map.format  = desc.format;
+			map.archive = index;
+			for (auto entry : desc.entries(*archive))
+			{
+				auto type = entry->type();
+				if (type == EntryType::fromId("map_things"))
+					map.things = entry;
+				else if (type == EntryType::fromId("map_linedefs"))
+					map.linedefs = entry;
+				else if (type == EntryType::fromId("map_sidedefs"))
+					map.sidedefs = entry;
+				else if (type == EntryType::fromId("map_sectors"))
+					map.sectors = entry;
+				else if (type == EntryType::fromId("udmf_textmap"))
+					map.textmap = entry;
+				else
+					continue;
+
+				entry->data(true);
 			}
+			maps_.push_back(map);
+		}
+	}
+
+	// -------------------------------------------------------------------------
+	// Sets [entry]'s data in [archive], keeping its type, and records an undo
+	// step for it if it's in the archive being operated on
+	// -------------------------------------------------------------------------
+	void setEntryData(
+		const ScanArchive& archive,
+		ArchiveEntry*      entry,
+		const void*        data,
+		unsigned           size,
+		UndoManager*       undo_manager) const
+	{
+		if (undo_manager && !archive.embedded)
+			undo_manager->recordUndoStep(std::make_unique<EntryDataUS>(entry));
+
+		auto type = entry->type();
+		entry->importMem(data, size);
+		entry->setType(type, type->reliability());
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Runs [func] on each [T] record in [entry]'s data, where [func] returns true
+// if it changed the record. If any records were changed, the modified data is
+// added to [map]'s changes.
+// Returns the number of records changed
+// -----------------------------------------------------------------------------
+template<typename T, typename F> size_t modifyRecords(ScanMap& map, ArchiveEntry* entry, F func)
+{
+	if (!entry)
+		return 0;
+
+	const auto& data = entry->data(false);
+	size_t      num  = data.size() / sizeof(T);
+	if (num == 0)
+		return 0;
+
+	vector<uint8_t> modified(data.data(), data.data() + data.size());
+	size_t          changed = 0;
+	T               record;
+	for (size_t a = 0; a < num; ++a)
+	{
+		memcpy(&record, modified.data() + a * sizeof(T), sizeof(T));
+		if (func(record))
+		{
+			memcpy(modified.data() + a * sizeof(T), &record, sizeof(T));
+			++changed;
+		}
+	}
+
+	if (changed > 0)
+		map.changes.emplace_back(entry, std::move(modified));
+
+	return changed;
+}
+
+// -----------------------------------------------------------------------------
+// If the 8-character texture name [str] matches [oldtex] (which can contain
+// ? and * wildcards), replaces it with [newtex] (where ? and * keep the
+// original characters).
+// Returns true if the name was replaced
+// -----------------------------------------------------------------------------
+bool replaceTextureString(char* str, const string& oldtex, const string& newtex)
+{
+	for (unsigned c = 0; c < oldtex.size(); ++c)
+	{
+		if (oldtex[c] == '*')
+			break;
+		if (c >= 8 || (str[c] != oldtex[c] && oldtex[c] != '?'))
+			return false;
+	}
 
-			// Next token
-			token = tz.getToken();
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		if (i < newtex.size())
+		{
+			// Keep the rest of the name as-is?
+			if (newtex[i] == '*')
+				break;
+			// Keep just this character as-is?
+			if (newtex[i] == '?')
+				continue;
+			// Else, copy the character
+			str[i] = newtex[i];
 		}
+		else
+			str[i] = 0;
+	}
+
+	return true;
+}
+
+// Options for replacing specials
+struct SpecialReplace
+{
+	int  oldtype;
+	int  newtype;
+	bool lines;
+	bool things;
+	bool arg[5];
+	int  oldarg[5];
+	int  newarg[5];
+
+	// Returns true if [type] and [args] match the special to replace
+	bool matches(int type, const uint8_t* args) const
+	{
+		if (type != oldtype)
+			return false;
+		for (unsigned a = 0; a < 5; ++a)
+			if (arg[a] && args[a] != oldarg[a])
+				return false;
+		return true;
+	}
+
+	// Sets [type] and [args] to the replacement special
+	template<typename T> void replace(T& type, uint8_t* args) const
+	{
+		type = newtype;
+		for (unsigned a = 0; a < 5; ++a)
+			if (arg[a])
+				args[a] = newarg[a];
 	}
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ArchiveOperations Namespace Functions (Maps)
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Finds any textures in [archive]'s TEXTUREx lists that aren't used in any of
+// its maps, and shows a dialog to select which of them to remove
+// -----------------------------------------------------------------------------
+void archiveoperations::removeUnusedTextures(Archive* archive)
+{
+	// Check archive was given
+	if (!archive)
+		return;
 
-	// Check if any maps were found
-	if (total_maps == 0)
+	// Get resource usage index, nothing to check if there are no maps
+	auto usage = resourceusage::archiveIndex(archive);
+	if (!usage || !usage->hasMaps())
 		return;
+	auto is_used = [usage](const wxString& name)
+	{ return usage->isUsed(resourceusage::ResourceType::Texture, wxutil::strToView(name)); };
 
 	// Find all TEXTUREx entries
-	opt.match_name  = "";
+	Archive::SearchOptions opt;
 	opt.match_type  = EntryType::fromId("texturex");
 	auto tx_entries = archive->findAll(opt);
 
@@ -534,7 +879,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			}
 
 			// Mark if unused and not part of an animation
-			if (!used_textures[texname].used && !anim && !thisend)
+			if (!is_used(texname) && !anim && !thisend)
 				unused_tex.Add(txlist.texture(t)->name());
 		}
 	}
@@ -542,7 +887,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 	// Pop up a dialog with a checkbox list of unused textures
 	wxMultiChoiceDialog dialog(
 		theMainWindow,
-		"The following textures are not used in any map,\nselect which textures to delete",
+		"The following textures are not used in any map, animation or script,\nselect which textures to delete",
 		"Delete Unused Textures",
 		unused_tex);
 
@@ -555,9 +900,9 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 	TextureXList tx;
 	for (auto& texturex : base_tx_entries)
 		tx.readTEXTUREXData(texturex, pt_temp, true);
-	vector<wxString> base_resource_textures;
+	std::unordered_set<uint64_t> base_resource_textures;
 	for (unsigned a = 0; a < tx.size(); a++)
-		base_resource_textures.push_back(tx.texture(a)->name());
+		base_resource_textures.insert(nameKey(tx.texture(a)->name()));
 
 	// Determine which textures to check initially
 	wxArrayInt selection;
@@ -573,7 +918,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW1", "SW2", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (is_used(swname))
 				swtex = true;
 		}
 		else if (unused_tex[a].StartsWith("SW2"))
@@ -583,21 +928,14 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			swname.Replace("SW2", "SW1", false);
 
 			// Check if its counterpart is used
-			if (used_textures[swname].used)
+			if (is_used(swname))
 				swtex = true;
 		}
 
 		// Check for base resource texture
-		bool br_tex = false;
-		for (auto& texture : base_resource_textures)
-		{
-			if (texture.CmpNoCase(unused_tex[a]) == 0)
-			{
-				log::info(3, "Texture " + texture + " is in base resource");
-				br_tex = true;
-				break;
-			}
-		}
+		bool br_tex = base_resource_textures.count(nameKey(wxutil::strToView(unused_tex[a]))) > 0;
+		if (br_tex)
+			log::info(3, "Texture " + unused_tex[a] + " is in base resource");
 
 		if (!swtex && !br_tex)
 			selection.Add(a);
@@ -610,6 +948,12 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 		// Get selected textures
 		selection = dialog.GetSelections();
 
+		// Begin undo level (if the archive is open in a tab)
+		auto panel        = theMainWindow->archiveManagerPanel()->tabForArchive(archive);
+		auto undo_manager = panel ? panel->undoManager() : nullptr;
+		if (undo_manager)
+			undo_manager->beginRecord("Remove Unused Textures");
+
 		// Go through texture lists
 		for (auto& entry : tx_entries)
 		{
@@ -617,6 +961,7 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 			txlist.readTEXTUREXData(entry, ptable);
 
 			// Go through selected textures to delete
+			int n_list_removed = 0;
 			for (int i : selection)
 			{
 				// Get texture index
@@ -626,106 +971,45 @@ void archiveoperations::removeUnusedTextures(Archive* archive)
 				if (index >= 0)
 				{
 					txlist.removeTexture(index);
-					n_removed++;
+					n_list_removed++;
 				}
 			}
 
 			// Write texture list data back to entry
-			txlist.writeTEXTUREXData(entry, ptable);
+			if (n_list_removed > 0)
+			{
+				if (undo_manager)
+					undo_manager->recordUndoStep(std::make_unique<EntryDataUS>(entry));
+				txlist.writeTEXTUREXData(entry, ptable);
+				n_removed += n_list_removed;
+			}
 		}
+
+		if (undo_manager)
+			undo_manager->endRecord(n_removed > 0);
 	}
 
 	wxMessageBox(wxString::Format("Removed %d unused textures", n_removed));
 }
 
+// -----------------------------------------------------------------------------
+// Finds any flats in [archive] that aren't used in any of its maps, and shows
+// a dialog to select which of them to remove
+// -----------------------------------------------------------------------------
 void archiveoperations::removeUnusedFlats(Archive* archive)
 {
 	// Check archive was given
 	if (!archive)
 		return;
 
-	// --- Build list of used flats ---
-	TexUsedMap used_textures;
-	int        total_maps = 0;
-
-	// Get all SECTORS entries
-	Archive::SearchOptions opt;
-	opt.match_type = EntryType::fromId("map_sectors");
-	auto sectors   = archive->findAll(opt);
-	total_maps += sectors.size();
-
-	// Go through and add used flats to list
-	DoomMapFormat::Sector sec;
-	wxString              tex_floor, tex_ceil;
-	for (auto& sector : sectors)
-	{
-		int nsec = sector->size() / 26;
-		sector->seek(0, SEEK_SET);
-		for (int s = 0; s < nsec; s++)
-		{
-			// Read sector data
-			sector->read(&sec, 26);
-
-			// Get textures
-			tex_floor = wxString::FromAscii(sec.f_tex, 8);
-			tex_ceil  = wxString::FromAscii(sec.c_tex, 8);
-
-			// Add to used textures list
-			used_textures[tex_floor].used = true;
-			used_textures[tex_ceil].used  = true;
-		}
-	}
-
-	// Get all TEXTMAP entries
-	opt.match_name = "TEXTMAP";
-	opt.match_type = EntryType::fromId("udmf_textmap");
-	auto udmfmaps  = archive->findAll(opt);
-	total_maps += udmfmaps.size();
-
-	// Go through and add used flats to list
-	Tokenizer tz;
-	tz.setSpecialCharacters("{};=");
-	for (auto& udmfmap : udmfmaps)
-	{
-		// Open in tokenizer
-		tz.openMem(udmfmap->data(), "UDMF TEXTMAP");
-
-		// Go through text tokens
-		wxString token = tz.getToken();
-		while (!token.IsEmpty())
-		{
-			// Check for sector definition
-			if (token == "sector")
-			{
-				tz.getToken(); // Skip {
-
-				token = tz.getToken();
-				while (token != "}")
-				{
-					// Check for texture property
-					if (token == "texturefloor" || token == "textureceiling")
-					{
-						tz.getToken(); // Skip =
-						used_textures[tz.getToken()].used = true;
-					}
-
-					token = tz.getToken();
-				}
-			}
-
-			// Next token
-			token = tz.getToken();
-		}
-	}
-
-	// Check if any maps were found
-	if (total_maps == 0)
+	// Get resource usage index, nothing to check if there are no maps
+	auto usage = resourceusage::archiveIndex(archive);
+	if (!usage || !usage->hasMaps())
 		return;
 
 	// Find all flats
-	opt.match_name      = "";
+	Archive::SearchOptions opt;
 	opt.match_namespace = "flats";
-	opt.match_type      = nullptr;
 	auto flats          = archive->findAll(opt);
 
 	// Create list of all unused flats
@@ -738,7 +1022,7 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 			continue;
 
 		// Check for animation start
-		string flatname{ flat->nameNoExt() };
+		wxString flatname{ flat->nameNoExt() };
 		for (int b = 0; b < n_flat_anim; b++)
 		{
 			if (flatname == flat_anim_start[b])
@@ -763,14 +1047,14 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 		}
 
 		// Add if not animated
-		if (!used_textures[flatname].used && !anim && !thisend)
+		if (!usage->isUsed(resourceusage::ResourceType::Flat, wxutil::strToView(flatname)) && !anim && !thisend)
 			unused_tex.Add(flatname);
 	}
 
 	// Pop up a dialog with a checkbox list of unused textures
 	wxMultiChoiceDialog dialog(
 		theMainWindow,
-		"The following textures are not used in any map,\nselect which textures to delete",
+		"The following textures are not used in any map, animation or script,\nselect which textures to delete",
 		"Delete Unused Textures",
 		unused_tex);
 
@@ -783,6 +1067,12 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 	int n_removed = 0;
 	if (dialog.ShowModal() == wxID_OK)
 	{
+		// Begin undo level (if the archive is open in a tab)
+		auto panel        = theMainWindow->archiveManagerPanel()->tabForArchive(archive);
+		auto undo_manager = panel ? panel->undoManager() : nullptr;
+		if (undo_manager)
+			undo_manager->beginRecord("Remove Unused Flats");
+
 		// Go through selected flats
 		selection           = dialog.GetSelections();
 		opt.match_namespace = "flats";
@@ -790,9 +1080,12 @@ void archiveoperations::removeUnusedFlats(Archive* archive)
 		{
 			opt.match_name      = unused_tex[i];
 			ArchiveEntry* entry = archive->findFirst(opt);
-			archive->removeEntry(entry);
-			n_removed++;
+			if (entry && archive->removeEntry(entry))
+				n_removed++;
 		}
+
+		if (undo_manager)
+			undo_manager->endRecord(n_removed > 0);
 	}
 
 	wxMessageBox(wxString::Format("Removed %d unused flats", n_removed));
@@ -813,207 +1106,80 @@ CONSOLE_COMMAND(test_cleanflats, 0, false)
 		archiveoperations::removeUnusedFlats(current);
 }
 
-void importEntryDataKeepType(ArchiveEntry* entry, const void* data, unsigned size)
-{
-	auto type = entry->type();
-	entry->importMem(data, size);
-	entry->setType(type, type->reliability());
-}
-size_t replaceThingsDoom(ArchiveEntry* entry, int oldtype, int newtype)
+CONSOLE_COMMAND(resourcerefs, 1, true)
 {
-	if (entry == nullptr)
-		return 0;
-
-	size_t size      = entry->size();
-	size_t numthings = size / sizeof(DoomMapFormat::Thing);
-	size_t changed   = 0;
-
-	auto things = new DoomMapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+	auto current = maineditor::currentArchive();
+	auto usage   = current ? resourceusage::archiveIndex(current) : nullptr;
+	if (!usage)
+		return;
 
-	// Perform replacement
-	for (size_t t = 0; t < numthings; ++t)
-	{
-		if (things[t].type == oldtype)
+	// List everything referencing the resource (of any type) and where
+	using resourceusage::ResourceType;
+	unsigned count = 0;
+	for (auto type : { ResourceType::Texture, ResourceType::Flat, ResourceType::Patch, ResourceType::Sprite })
+		for (auto& ref : usage->references(type, args[0]))
 		{
-			things[t].type = newtype;
-			++changed;
+			log::console(fmt::format(
+				"{} {}: {} ({}x in {})",
+				resourceusage::typeName(type),
+				ref.second.name,
+				ref.first->path(true),
+				ref.second.count,
+				ref.second.context));
+			++count;
 		}
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
-	delete[] things;
 
-	return changed;
+	if (count == 0)
+		log::console(fmt::format("{} is not referenced in the archive", args[0]));
 }
-size_t replaceThingsDoom64(ArchiveEntry* entry, int oldtype, int newtype)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t size      = entry->size();
-	size_t numthings = size / sizeof(Doom64MapFormat::Thing);
-	size_t changed   = 0;
-
-	auto things = new Doom64MapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
-
-	// Perform replacement
-	for (size_t t = 0; t < numthings; ++t)
-	{
-		if (things[t].type == oldtype)
-		{
-			things[t].type = newtype;
-			++changed;
-		}
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
-	delete[] things;
 
-	return changed;
-}
-size_t replaceThingsHexen(ArchiveEntry* entry, int oldtype, int newtype)
+// -----------------------------------------------------------------------------
+// Replaces all things of type [oldtype] with [newtype] in all maps in
+// [archive] (including maps in embedded wads).
+// Returns the number of things changed
+// -----------------------------------------------------------------------------
+size_t archiveoperations::replaceThings(Archive* archive, int oldtype, int newtype)
 {
-	if (entry == nullptr)
+	// Check archive was given
+	if (!archive)
 		return 0;
 
-	size_t size      = entry->size();
-	size_t numthings = size / sizeof(HexenMapFormat::Thing);
-	size_t changed   = 0;
+	MapScan scan(archive);
+	scan.process(
+		[oldtype, newtype](ScanMap& map)
+		{
+			auto replace = [oldtype, newtype](auto& thing)
+			{
+				if (thing.type != oldtype)
+					return false;
 
-	auto things = new HexenMapFormat::Thing[numthings];
-	memcpy(things, entry->rawData(), size);
+				thing.type = newtype;
+				return true;
+			};
 
-	// Perform replacement
-	for (size_t t = 0; t < numthings; ++t)
-	{
-		if (things[t].type == oldtype)
-		{
-			things[t].type = newtype;
-			++changed;
-		}
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, things, size);
-	delete[] things;
+			switch (map.format)
+			{
+			case MapFormat::Doom: map.changed = modifyRecords<DoomMapFormat::Thing>(map, map.things, replace); break;
+			case MapFormat::Hexen: map.changed = modifyRecords<HexenMapFormat::Thing>(map, map.things, replace); break;
+			case MapFormat::Doom64:
+				map.changed = modifyRecords<Doom64MapFormat::Thing>(map, map.things, replace);
+				break;
+			case MapFormat::UDMF: break; // TODO: parse and replace code
+			default: break;
+			}
+		});
 
-	return changed;
+	return scan.commit("Replace Things", "things");
 }
-size_t replaceThingsUDMF(ArchiveEntry* entry, int oldtype, int newtype)
+
+CONSOLE_COMMAND(replacethings, 2, true)
 {
-	if (entry == nullptr)
-		return 0;
+	auto current = maineditor::currentArchive();
+	int  oldtype, newtype;
 
-	size_t changed = 0;
-	// TODO: parse and replace code
-	// Import the changes if needed
-	if (changed > 0)
+	if (current && strutil::toInt(args[0], oldtype) && strutil::toInt(args[1], newtype))
 	{
-		// entry->importMemChunk(mc);
-	}
-	return changed;
-}
-size_t archiveoperations::replaceThings(Archive* archive, int oldtype, int newtype)
-{
-	size_t changed = 0;
-	// Check archive was given
-	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
-
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
-		if (!m_head)
-			continue;
-
-		size_t achanged = 0;
-		// Is it an embedded wad?
-		if (map.archive)
-		{
-			// Attempt to open entry as wad archive
-			auto temp_archive = std::make_shared<WadArchive>();
-			if (temp_archive->open(m_head->data()))
-			{
-				achanged = archiveoperations::replaceThings(temp_archive.get(), oldtype, newtype);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
-				{
-					achanged = 0;
-				}
-				else
-				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
-				}
-			}
-		}
-		else
-		{
-			// Find the map entry to modify
-			auto          entries = map.entries(*archive);
-			ArchiveEntry* things  = nullptr;
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("map_things"))
-					{
-						things = mapentry;
-						break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						things = mapentry;
-						break;
-					}
-				}
-			}
-
-			// Did we get a map entry?
-			if (things)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom: achanged = replaceThingsDoom(things, oldtype, newtype); break;
-				case MapFormat::Hexen: achanged = replaceThingsHexen(things, oldtype, newtype); break;
-				case MapFormat::Doom64: achanged = replaceThingsDoom64(things, oldtype, newtype); break;
-				case MapFormat::UDMF: achanged = replaceThingsUDMF(things, oldtype, newtype); break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
-		}
-		report += wxString::Format("%s:\t%i things changed\n", m_head->name(), achanged);
-		changed += achanged;
-	}
-	log::info(1, report);
-	return changed;
-}
-
-CONSOLE_COMMAND(replacethings, 2, true)
-{
-	auto current = maineditor::currentArchive();
-	int  oldtype, newtype;
-
-	if (current && strutil::toInt(args[0], oldtype) && strutil::toInt(args[1], newtype))
-	{
-		archiveoperations::replaceThings(current, oldtype, newtype);
+		archiveoperations::replaceThings(current, oldtype, newtype);
 	}
 }
 
@@ -1086,188 +1252,14 @@ CONSOLE_COMMAND(convertmapchex2to3, 0, false)
 	}
 }
 
-size_t replaceSpecialsDoom(ArchiveEntry* entry, int oldtype, int newtype, bool tag, int oldtag, int newtag)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t size     = entry->size();
-	size_t numlines = size / sizeof(DoomMapFormat::LineDef);
-	size_t changed  = 0;
-
-	auto lines = new DoomMapFormat::LineDef[numlines];
-	memcpy(lines, entry->rawData(), size);
-
-	// Perform replacement
-	for (size_t l = 0; l < numlines; ++l)
-	{
-		if (lines[l].type == oldtype)
-		{
-			if (!tag || lines[l].sector_tag == oldtag)
-			{
-				lines[l].type = newtype;
-				if (tag)
-					lines[l].sector_tag = newtag;
-				++changed;
-			}
-		}
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, lines, size);
-	delete[] lines;
-
-	return changed;
-}
-size_t replaceSpecialsDoom64(ArchiveEntry* entry, int oldtype, int newtype, bool tag, int oldtag, int newtag)
-{
-	return 0;
-}
-size_t replaceSpecialsHexen(
-	ArchiveEntry* l_entry,
-	ArchiveEntry* t_entry,
-	int           oldtype,
-	int           newtype,
-	bool          arg0,
-	bool          arg1,
-	bool          arg2,
-	bool          arg3,
-	bool          arg4,
-	int           oldarg0,
-	int           oldarg1,
-	int           oldarg2,
-	int           oldarg3,
-	int           oldarg4,
-	int           newarg0,
-	int           newarg1,
-	int           newarg2,
-	int           newarg3,
-	int           newarg4)
-{
-	if (l_entry == nullptr && t_entry == nullptr)
-		return 0;
-
-	size_t size    = 0;
-	size_t changed = 0;
-
-	if (l_entry)
-	{
-		size            = l_entry->size();
-		size_t numlines = size / sizeof(HexenMapFormat::LineDef);
-
-		auto lines = new HexenMapFormat::LineDef[numlines];
-		memcpy(lines, l_entry->rawData(), size);
-		size_t lchanged = 0;
-
-		// Perform replacement
-		for (size_t l = 0; l < numlines; ++l)
-		{
-			if (lines[l].type == oldtype)
-			{
-				if ((!arg0 || lines[l].args[0] == oldarg0) && (!arg1 || lines[l].args[1] == oldarg1)
-					&& (!arg2 || lines[l].args[2] == oldarg2) && (!arg3 || lines[l].args[3] == oldarg3)
-					&& (!arg4 || lines[l].args[4] == oldarg4))
-				{
-					lines[l].type = newtype;
-					if (arg0)
-						lines[l].args[0] = newarg0;
-					if (arg1)
-						lines[l].args[1] = newarg1;
-					if (arg2)
-						lines[l].args[2] = newarg2;
-					if (arg3)
-						lines[l].args[3] = newarg3;
-					if (arg4)
-						lines[l].args[4] = newarg4;
-					++lchanged;
-				}
-			}
-		}
-		// Import the changes if needed
-		if (lchanged > 0)
-		{
-			importEntryDataKeepType(l_entry, lines, size);
-			changed += lchanged;
-		}
-		delete[] lines;
-	}
-
-	if (t_entry)
-	{
-		size             = t_entry->size();
-		size_t numthings = size / sizeof(HexenMapFormat::Thing);
-
-		auto things = new HexenMapFormat::Thing[numthings];
-		memcpy(things, t_entry->rawData(), size);
-		size_t tchanged = 0;
-
-		// Perform replacement
-		for (size_t t = 0; t < numthings; ++t)
-		{
-			if (things[t].type == oldtype)
-			{
-				if ((!arg0 || things[t].args[0] == oldarg0) && (!arg1 || things[t].args[1] == oldarg1)
-					&& (!arg2 || things[t].args[2] == oldarg2) && (!arg3 || things[t].args[3] == oldarg3)
-					&& (!arg4 || things[t].args[4] == oldarg4))
-				{
-					things[t].type = newtype;
-					if (arg0)
-						things[t].args[0] = newarg0;
-					if (arg1)
-						things[t].args[1] = newarg1;
-					if (arg2)
-						things[t].args[2] = newarg2;
-					if (arg3)
-						things[t].args[3] = newarg3;
-					if (arg4)
-						things[t].args[4] = newarg4;
-					++tchanged;
-				}
-			}
-		}
-		// Import the changes if needed
-		if (tchanged > 0)
-		{
-			importEntryDataKeepType(t_entry, things, size);
-			changed += tchanged;
-		}
-		delete[] things;
-	}
-
-	return changed;
-}
-size_t replaceSpecialsUDMF(
-	ArchiveEntry* entry,
-	int           oldtype,
-	int           newtype,
-	bool          arg0,
-	bool          arg1,
-	bool          arg2,
-	bool          arg3,
-	bool          arg4,
-	int           oldarg0,
-	int           oldarg1,
-	int           oldarg2,
-	int           oldarg3,
-	int           oldarg4,
-	int           newarg0,
-	int           newarg1,
-	int           newarg2,
-	int           newarg3,
-	int           newarg4)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t changed = 0;
-	// TODO: parse and replace code
-	// Import the changes if needed
-	if (changed > 0)
-	{
-		// entry->importMemChunk(mc);
-	}
-	return changed;
-}
+// -----------------------------------------------------------------------------
+// Replaces all specials of type [oldtype] with [newtype] in all maps in
+// [archive] (including maps in embedded wads), on [lines] and/or [things].
+// If any of [arg0]-[arg4] are true, only specials with the matching
+// [oldargX] value are replaced, and the arg is set to [newargX].
+// In Doom format maps, arg0 is the sector tag.
+// Returns the number of lines/things changed
+// -----------------------------------------------------------------------------
 size_t archiveoperations::replaceSpecials(
 	Archive* archive,
 	int      oldtype,
@@ -1290,173 +1282,78 @@ size_t archiveoperations::replaceSpecials(
 	int      oldarg4,
 	int      newarg4)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
-
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
-		if (!m_head)
-			continue;
-
-		size_t achanged = 0;
-		// Is it an embedded wad?
-		if (map.archive)
-		{
-			// Attempt to open entry as wad archive
-			Archive* temp_archive = new WadArchive();
-			if (temp_archive->open(m_head.get()))
-			{
-				achanged = archiveoperations::replaceSpecials(
-					temp_archive,
-					oldtype,
-					newtype,
-					lines,
-					things,
-					arg0,
-					oldarg0,
-					newarg0,
-					arg1,
-					oldarg1,
-					newarg1,
-					arg2,
-					oldarg2,
-					newarg2,
-					arg3,
-					oldarg3,
-					newarg3,
-					arg4,
-					oldarg4,
-					newarg4);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
-				{
-					achanged = 0;
-				}
-				else
-				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
-				}
-			}
+		return 0;
 
-			// Cleanup
-			delete temp_archive;
-		}
-		else
+	SpecialReplace rep{ oldtype,
+						newtype,
+						lines,
+						things,
+						{ arg0, arg1, arg2, arg3, arg4 },
+						{ oldarg0, oldarg1, oldarg2, oldarg3, oldarg4 },
+						{ newarg0, newarg1, newarg2, newarg3, newarg4 } };
+
+	MapScan scan(archive);
+	scan.process(
+		[&rep](ScanMap& map)
 		{
-			// Find the map entry to modify
-			ArchiveEntry* t_entry = nullptr;
-			ArchiveEntry* l_entry = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
-				{
-					if (things && mapentry->type() == EntryType::fromId("map_things"))
-					{
-						t_entry = mapentry;
-						if (l_entry || !lines)
-							break;
-					}
-					if (lines && mapentry->type() == EntryType::fromId("map_linedefs"))
-					{
-						l_entry = mapentry;
-						if (t_entry || !things)
-							break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
-			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						l_entry = t_entry = mapentry;
-						break;
-					}
-				}
-			}
-
-			// Did we get a map entry?
-			if (l_entry || t_entry)
+			switch (map.format)
 			{
-				switch (map.format)
-				{
-				case MapFormat::Doom:
-					if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
-						break;
-					achanged = replaceSpecialsDoom(l_entry, oldtype, newtype, arg0, oldarg0, newarg0);
-					break;
-				case MapFormat::Hexen:
-					if (oldtype > 255 || newtype > 255) // Do nothing if Doom specials are being modified
-						break;
-					achanged = replaceSpecialsHexen(
-						l_entry,
-						t_entry,
-						oldtype,
-						newtype,
-						arg0,
-						arg1,
-						arg2,
-						arg3,
-						arg4,
-						oldarg0,
-						oldarg1,
-						oldarg2,
-						oldarg3,
-						oldarg4,
-						newarg0,
-						newarg1,
-						newarg2,
-						newarg3,
-						newarg4);
-					break;
-				case MapFormat::Doom64:
-					if (arg1 || arg2 || arg3 || arg4) // Do nothing if Hexen specials are being modified
-						break;
-					achanged = replaceSpecialsDoom64(l_entry, oldtype, newtype, arg0, oldarg0, newarg0);
+			case MapFormat::Doom:
+				// Do nothing if Hexen specials are being modified
+				if (rep.arg[1] || rep.arg[2] || rep.arg[3] || rep.arg[4] || !rep.lines)
 					break;
-				case MapFormat::UDMF:
-					achanged = replaceSpecialsUDMF(
-						l_entry,
-						oldtype,
-						newtype,
-						arg0,
-						arg1,
-						arg2,
-						arg3,
-						arg4,
-						oldarg0,
-						oldarg1,
-						oldarg2,
-						oldarg3,
-						oldarg4,
-						newarg0,
-						newarg1,
-						newarg2,
-						newarg3,
-						newarg4);
+				map.changed = modifyRecords<DoomMapFormat::LineDef>(
+					map,
+					map.linedefs,
+					[&rep](DoomMapFormat::LineDef& line)
+					{
+						if (line.type != rep.oldtype || (rep.arg[0] && line.sector_tag != rep.oldarg[0]))
+							return false;
+
+						line.type = rep.newtype;
+						if (rep.arg[0])
+							line.sector_tag = rep.newarg[0];
+						return true;
+					});
+				break;
+			case MapFormat::Hexen:
+				// Do nothing if Doom specials are being modified
+				if (rep.oldtype > 255 || rep.newtype > 255)
 					break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
+				if (rep.lines)
+					map.changed += modifyRecords<HexenMapFormat::LineDef>(
+						map,
+						map.linedefs,
+						[&rep](HexenMapFormat::LineDef& line)
+						{
+							if (!rep.matches(line.type, line.args))
+								return false;
+
+							rep.replace(line.type, line.args);
+							return true;
+						});
+				if (rep.things)
+					map.changed += modifyRecords<HexenMapFormat::Thing>(
+						map,
+						map.things,
+						[&rep](HexenMapFormat::Thing& thing)
+						{
+							if (!rep.matches(thing.special, thing.args))
+								return false;
+
+							rep.replace(thing.special, thing.args);
+							return true;
+						});
+				break;
+			case MapFormat::Doom64: break; // Not supported
+			case MapFormat::UDMF: break;   // TODO: parse and replace code
+			default: break;
 			}
-		}
-		report += wxString::Format("%s:\t%i specials changed\n", m_head->name(), achanged);
-		changed += achanged;
-	}
-	log::info(1, report);
-	return changed;
+		});
+
+	return scan.commit("Replace Specials", "specials");
 }
 
 CONSOLE_COMMAND(replacespecials, 2, true)
@@ -1511,227 +1408,13 @@ CONSOLE_COMMAND(replacespecials, 2, true)
 	}
 }
 
-bool replaceTextureString(char* str, wxString oldtex, wxString newtex)
-{
-	bool go = true;
-	for (unsigned c = 0; c < oldtex.Length(); ++c)
-	{
-		if (str[c] != oldtex[c] && oldtex[c] != '?' && oldtex[c] != '*')
-			go = false;
-		if (oldtex[c] == '*')
-			break;
-	}
-	if (go)
-	{
-		for (unsigned i = 0; i < 8; ++i)
-		{
-			if (i < newtex.Len())
-			{
-				// Keep the rest of the name as-is?
-				if (newtex[i] == '*')
-					break;
-				// Keep just this character as-is?
-				if (newtex[i] == '?')
-					continue;
-				// Else, copy the character
-				str[i] = newtex[i];
-			}
-			else
-				str[i] = 0;
-		}
-	}
-	return go;
-}
-size_t replaceFlatsDoomHexen(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            floor,
-	bool            ceiling)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t size       = entry->size();
-	size_t numsectors = size / sizeof(DoomMapFormat::Sector);
-	bool   fchanged, cchanged;
-	size_t changed = 0;
-
-	auto sectors = new DoomMapFormat::Sector[numsectors];
-	memcpy(sectors, entry->rawData(), size);
-
-	// Perform replacement
-	for (size_t s = 0; s < numsectors; ++s)
-	{
-		fchanged = cchanged = false;
-		if (floor)
-			fchanged = replaceTextureString(sectors[s].f_tex, oldtex, newtex);
-		if (ceiling)
-			cchanged = replaceTextureString(sectors[s].c_tex, oldtex, newtex);
-		if (fchanged || cchanged)
-			++changed;
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sectors, size);
-	delete[] sectors;
-
-	return changed;
-}
-size_t replaceWallsDoomHexen(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            lower,
-	bool            middle,
-	bool            upper)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t size     = entry->size();
-	size_t numsides = size / sizeof(DoomMapFormat::SideDef);
-	bool   lchanged, mchanged, uchanged;
-	size_t changed = 0;
-
-	DoomMapFormat::SideDef* sides = new DoomMapFormat::SideDef[numsides];
-	memcpy(sides, entry->rawData(), size);
-	char compare[9];
-	compare[8] = 0;
-
-	// Perform replacement
-	for (size_t s = 0; s < numsides; ++s)
-	{
-		lchanged = mchanged = uchanged = false;
-		if (lower)
-			lchanged = replaceTextureString(sides[s].tex_lower, oldtex, newtex);
-		if (middle)
-			mchanged = replaceTextureString(sides[s].tex_middle, oldtex, newtex);
-		if (upper)
-			uchanged = replaceTextureString(sides[s].tex_upper, oldtex, newtex);
-		if (lchanged || mchanged || uchanged)
-			++changed;
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sides, size);
-	delete[] sides;
-
-	return changed;
-}
-size_t replaceFlatsDoom64(ArchiveEntry* entry, const wxString& oldtex, const wxString& newtex, bool floor, bool ceiling)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t size       = entry->size();
-	size_t numsectors = size / sizeof(Doom64MapFormat::Sector);
-	bool   fchanged, cchanged;
-	size_t changed = 0;
-
-	uint16_t oldhash = app::resources().getTextureHash(oldtex.ToStdString());
-	uint16_t newhash = app::resources().getTextureHash(newtex.ToStdString());
-
-	auto sectors = new Doom64MapFormat::Sector[numsectors];
-	memcpy(sectors, entry->rawData(), size);
-
-	// Perform replacement
-	for (size_t s = 0; s < numsectors; ++s)
-	{
-		fchanged = cchanged = false;
-		if (floor && oldhash == sectors[s].f_tex)
-		{
-			sectors[s].f_tex = newhash;
-			fchanged         = true;
-		}
-		if (ceiling && oldhash == sectors[s].c_tex)
-		{
-			sectors[s].c_tex = newhash;
-			cchanged         = true;
-		}
-		if (fchanged || cchanged)
-			++changed;
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sectors, size);
-	delete[] sectors;
-
-	return changed;
-}
-size_t replaceWallsDoom64(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            lower,
-	bool            middle,
-	bool            upper)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t size     = entry->size();
-	size_t numsides = size / sizeof(Doom64MapFormat::SideDef);
-	bool   lchanged, mchanged, uchanged;
-	size_t changed = 0;
-
-	uint16_t oldhash = app::resources().getTextureHash(oldtex.ToStdString());
-	uint16_t newhash = app::resources().getTextureHash(newtex.ToStdString());
-
-	auto sides = new Doom64MapFormat::SideDef[numsides];
-	memcpy(sides, entry->rawData(), size);
-
-	// Perform replacement
-	for (size_t s = 0; s < numsides; ++s)
-	{
-		lchanged = mchanged = uchanged = false;
-		if (lower && oldhash == sides[s].tex_lower)
-		{
-			sides[s].tex_lower = newhash;
-			lchanged           = true;
-		}
-		if (middle && oldhash == sides[s].tex_middle)
-		{
-			sides[s].tex_middle = newhash;
-			mchanged            = true;
-		}
-		if (upper && oldhash == sides[s].tex_upper)
-		{
-			sides[s].tex_upper = newhash;
-			uchanged           = true;
-		}
-		if (lchanged || mchanged || uchanged)
-			++changed;
-	}
-	// Import the changes if needed
-	if (changed > 0)
-		importEntryDataKeepType(entry, sides, size);
-	delete[] sides;
-
-	return changed;
-}
-size_t replaceTexturesUDMF(
-	ArchiveEntry*   entry,
-	const wxString& oldtex,
-	const wxString& newtex,
-	bool            floor,
-	bool            ceiling,
-	bool            lower,
-	bool            middle,
-	bool            upper)
-{
-	if (entry == nullptr)
-		return 0;
-
-	size_t changed = 0;
-	// TODO: parse and replace code
-	// Import the changes if needed
-	if (changed > 0)
-	{
-		// entry->importMemChunk(mc);
-	}
-	return changed;
-}
+// -----------------------------------------------------------------------------
+// Replaces all textures/flats matching [oldtex] with [newtex] in all maps in
+// [archive] (including maps in embedded wads), on the given sector and
+// sidedef parts. [oldtex] and [newtex] can contain ? and * wildcards in
+// Doom/Hexen format maps.
+// Returns the number of sectors/sidedefs changed
+// -----------------------------------------------------------------------------
 size_t archiveoperations::replaceTextures(
 	Archive*        archive,
 	const wxString& oldtex,
@@ -1742,117 +1425,97 @@ size_t archiveoperations::replaceTextures(
 	bool            middle,
 	bool            upper)
 {
-	size_t changed = 0;
 	// Check archive was given
 	if (!archive)
-		return changed;
-
-	// Get all maps
-	auto     maps   = archive->detectMaps();
-	wxString report = "";
-
-	for (auto& map : maps)
-	{
-		auto m_head = map.head.lock();
-		if (!m_head)
-			continue;
+		return 0;
 
-		size_t achanged = 0;
-		// Is it an embedded wad?
-		if (map.archive)
-		{
-			// Attempt to open entry as wad archive
-			Archive* temp_archive = new WadArchive();
-			if (temp_archive->open(m_head.get()))
-			{
-				achanged = archiveoperations::replaceTextures(
-					temp_archive, oldtex, newtex, floor, ceiling, lower, middle, upper);
-				MemChunk mc;
-				if (!(temp_archive->write(mc, true)))
-				{
-					achanged = 0;
-				}
-				else
-				{
-					temp_archive->close();
-					if (!(m_head->importMemChunk(mc)))
-					{
-						achanged = 0;
-					}
-				}
-			}
+	// Get names/hashes to replace
+	auto     oldname = oldtex.ToStdString();
+	auto     newname = newtex.ToStdString();
+	uint16_t oldhash = app::resources().getTextureHash(oldname);
+	uint16_t newhash = app::resources().getTextureHash(newname);
 
-			// Cleanup
-			delete temp_archive;
-		}
-		else
+	MapScan scan(archive);
+	scan.process(
+		[&](ScanMap& map)
 		{
-			// Find the map entry to modify
-			ArchiveEntry* sectors = nullptr;
-			ArchiveEntry* sides   = nullptr;
-			auto          entries = map.entries(*archive);
-			if (map.format == MapFormat::Doom || map.format == MapFormat::Doom64 || map.format == MapFormat::Hexen)
-			{
-				for (auto mapentry : entries)
-				{
-					if ((floor || ceiling) && (mapentry->type() == EntryType::fromId("map_sectors")))
-					{
-						sectors = mapentry;
-						if (sides || !(lower || middle || upper))
-							break;
-					}
-					if ((lower || middle || upper) && (mapentry->type() == EntryType::fromId("map_sidedefs")))
-					{
-						sides = mapentry;
-						if (sectors || !(floor || ceiling))
-							break;
-					}
-				}
-			}
-			else if (map.format == MapFormat::UDMF)
+			switch (map.format)
 			{
-				for (auto mapentry : entries)
-				{
-					if (mapentry->type() == EntryType::fromId("udmf_textmap"))
-					{
-						sectors = sides = mapentry;
-						break;
-					}
-				}
+			case MapFormat::Doom:
+			case MapFormat::Hexen:
+				if (floor || ceiling)
+					map.changed += modifyRecords<DoomMapFormat::Sector>(
+						map,
+						map.sectors,
+						[&](DoomMapFormat::Sector& sector)
+						{
+							bool fchanged = floor && replaceTextureString(sector.f_tex, oldname, newname);
+							bool cchanged = ceiling && replaceTextureString(sector.c_tex, oldname, newname);
+							return fchanged || cchanged;
+						});
+				if (lower || middle || upper)
+					map.changed += modifyRecords<DoomMapFormat::SideDef>(
+						map,
+						map.sidedefs,
+						[&](DoomMapFormat::SideDef& side)
+						{
+							bool lchanged = lower && replaceTextureString(side.tex_lower, oldname, newname);
+							bool mchanged = middle && replaceTextureString(side.tex_middle, oldname, newname);
+							bool uchanged = upper && replaceTextureString(side.tex_upper, oldname, newname);
+							return lchanged || mchanged || uchanged;
+						});
+				break;
+			case MapFormat::Doom64:
+				if (floor || ceiling)
+					map.changed += modifyRecords<Doom64MapFormat::Sector>(
+						map,
+						map.sectors,
+						[&](Doom64MapFormat::Sector& sector)
+						{
+							bool changed = false;
+							if (floor && sector.f_tex == oldhash)
+							{
+								sector.f_tex = newhash;
+								changed      = true;
+							}
+							if (ceiling && sector.c_tex == oldhash)
+							{
+								sector.c_tex = newhash;
+								changed      = true;
+							}
+							return changed;
+						});
+				if (lower || middle || upper)
+					map.changed += modifyRecords<Doom64MapFormat::SideDef>(
+						map,
+						map.sidedefs,
+						[&](Doom64MapFormat::SideDef& side)
+						{
+							bool changed = false;
+							if (lower && side.tex_lower == oldhash)
+							{
+								side.tex_lower = newhash;
+								changed        = true;
+							}
+							if (middle && side.tex_middle == oldhash)
+							{
+								side.tex_middle = newhash;
+								changed         = true;
+							}
+							if (upper && side.tex_upper == oldhash)
+							{
+								side.tex_upper = newhash;
+								changed        = true;
+							}
+							return changed;
+						});
+				break;
+			case MapFormat::UDMF: break; // TODO: parse and replace code
+			default: break;
 			}
+		});
 
-			// Did we get a map entry?
-			if (sectors || sides)
-			{
-				switch (map.format)
-				{
-				case MapFormat::Doom:
-				case MapFormat::Hexen:
-					achanged = 0;
-					if (sectors)
-						achanged += replaceFlatsDoomHexen(sectors, oldtex, newtex, floor, ceiling);
-					if (sides)
-						achanged += replaceWallsDoomHexen(sides, oldtex, newtex, lower, middle, upper);
-					break;
-				case MapFormat::Doom64:
-					achanged = 0;
-					if (sectors)
-						achanged += replaceFlatsDoom64(sectors, oldtex, newtex, floor, ceiling);
-					if (sides)
-						achanged += replaceWallsDoom64(sides, oldtex, newtex, lower, middle, upper);
-					break;
-				case MapFormat::UDMF:
-					achanged = replaceTexturesUDMF(sectors, oldtex, newtex, floor, ceiling, lower, middle, upper);
-					break;
-				default: log::warning("Unknown map format for " + m_head->name()); break;
-				}
-			}
-		}
-		report += wxString::Format("%s:\t%i elements changed\n", m_head->name(), achanged);
-		changed += achanged;
-	}
-	log::info(1, report);
-	return changed;
+	return scan.commit("Replace Textures", "elements");
 }
 
 CONSOLE_COMMAND(replacetextures, 2, true)
@@ -10,6 +10,7 @@ bool checkDuplicateEntryContent(Archive* archive);
 void removeUnusedTextures(Archive* archive);
 void removeUnusedFlats(Archive* archive);
 void removeEntriesUnchangedFromIWAD(Archive* archive);
+void compareWithArchive(Archive* archive);
 
 // Search and replace in maps
 size_t replaceThings(Archive* archive, int oldtype, int newtype);
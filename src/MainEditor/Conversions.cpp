@@ -33,6 +33,7 @@
 #include "Conversions.h"
 #include "Archive/Archive.h"
 #include "Archive/ArchiveEntry.h"
+#include "Audio/SampleConversion.h"
 #include "thirdparty/mus2mid/mus2mid.h"
 #include "thirdparty/zreaders/i_music.h"
 
@@ -46,14 +47,10 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace slade::conversion
 {
-const int16_t SIGN_BIT   = 0x80; // Sign bit = values are otherwise treated as unsigned).
-const int16_t QUANT_MASK = 0xf;  // Quantization field mask.
-const int16_t SEG_SHIFT  = 4;    // Left shift for segment number.
-const int16_t SEG_MASK   = 0x70; // Segment field mask.
-const int16_t BIAS       = 0x84; // Bias for linear code.
-const uint8_t WAV_PCM    = 1;
-const uint8_t WAV_ALAW   = 6;
-const uint8_t WAV_ULAW   = 7;
+const uint16_t WAV_PCM   = 1;
+const uint16_t WAV_FLOAT = 3;
+const uint16_t WAV_ALAW  = 6;
+const uint16_t WAV_ULAW  = 7;
 } // namespace slade::conversion
 CVAR(Bool, dmx_padding, true, CVar::Flag::Save)
 CVAR(Int, wolfsnd_rate, 7042, CVar::Flag::Save)
@@ -161,105 +158,82 @@ struct KvxColumnPostHeader
 namespace slade::conversion
 {
 // -----------------------------------------------------------------------------
-// Converts a 16-bit signed sample to an 8-bit unsigned one.
+// Reads the format of wav data [in] to [fmtchunk] and [wavfmt] (the actual
+// format tag, for WAVE_FORMAT_EXTENSIBLE files), and finds the offset and size
+// of its sample data.
+// Returns false (with global::error set) if [in] isn't a valid wav
 // -----------------------------------------------------------------------------
-uint8_t pcm16to8bits(int16_t val)
+bool readWav(MemChunk& in, WavFmtChunk& fmtchunk, uint16_t& wavfmt, size_t& data_offset, size_t& data_size)
 {
-	// Value is in the [-32768, 32767] range.
-	// Shift it eight bits to [-128, 127] range,
-	// and add 128 to put it in [0, 255] range.
-	uint8_t ret = 128 + (val >> 8);
-	// Round value up or down depending on value
-	// of shifted-off bits.
-	if ((val & 0x80FF) > 127)
-		ret++;
-	else if ((val & 0x80FF) < -128)
-		ret--;
-	// Send it.
-	return ret;
-}
-
-// -----------------------------------------------------------------------------
-// Converts a 24-bit signed sample to an 8-bit unsigned one.
-// -----------------------------------------------------------------------------
-uint8_t pcm24to8bits(int32_t val)
-{
-	int16_t ret = (val >> 8);
-	if ((val & 0x8000FF) > 127)
-		ret++;
-	else if ((val & 0x8000FF) < -128)
-		ret--;
-	return pcm16to8bits(ret);
-}
-
-// -----------------------------------------------------------------------------
-// Converts a 32-bit signed sample to an 8-bit unsigned one.
-// -----------------------------------------------------------------------------
-uint8_t pcm32to8bits(int32_t val)
-{
-	static const int32_t mod = 0x800000FF;
-	int32_t              ret = (val >> 8);
-	if ((val & mod) > 127)
-		ret++;
-	else if ((val & mod) < -128)
-		ret--;
-	return pcm24to8bits(ret);
-}
-
-// -----------------------------------------------------------------------------
-// Averages the values of two eight-bit unsigned samples into one.
-// -----------------------------------------------------------------------------
-uint8_t stereoToMono(uint8_t left, uint8_t right)
-{
-	uint16_t val = left + right;
-	val /= 2;
-	if (val > 255)
-		val = 255;
-	return (uint8_t)val;
-}
+	// Check header
+	if (in.size() < 12 || memcmp(in.data(), "RIFF", 4) != 0)
+	{
+		global::error = "Invalid WAV";
+		return false;
+	}
 
-// The following two functions are adapted from Sun Microsystem's g711.cpp code.
-// Unrestricted use and modifications are allowed.
+	// Check format
+	if (memcmp(in.data() + 8, "WAVE", 4) != 0)
+	{
+		global::error = "Invalid WAV format";
+		return false;
+	}
 
-// -----------------------------------------------------------------------------
-// Converts a 8-bit A-law sample to 16-bit signed linear PCM
-// -----------------------------------------------------------------------------
-int16_t alawToLinear(uint8_t alaw)
-{
-	int16_t t;
-	int16_t seg;
+	// Find fmt chunk
+	size_t ofs = 12;
+	while (ofs + 8 <= in.size())
+	{
+		if (in[ofs] == 'f' && in[ofs + 1] == 'm' && in[ofs + 2] == 't' && in[ofs + 3] == ' ')
+			break;
+		ofs += 8 + in.readL32((ofs + 4));
+	}
 
-	alaw ^= 0x55;
+	// Read fmt chunk
+	if (ofs + sizeof(WavFmtChunk) > in.size())
+	{
+		global::error = "Invalid WAV: no 'fmt ' chunk";
+		return false;
+	}
+	in.seek(ofs, SEEK_SET);
+	in.read(&fmtchunk, sizeof(WavFmtChunk));
+	wavfmt = fmtchunk.tag == 0xFFFE && ofs + 34 <= in.size() ? in.readL16(ofs + 32) : fmtchunk.tag;
 
-	t   = (alaw & QUANT_MASK) << 4;
-	seg = (alaw & SEG_MASK) >> SEG_SHIFT;
-	switch (seg)
+	// Find data chunk
+	ofs += 8 + wxUINT32_SWAP_ON_BE(fmtchunk.header.size);
+	while (ofs + 8 <= in.size())
 	{
-	case 0: t += 8; break;
-	case 1: t += 0x108; break;
-	default: t += 0x108; t <<= seg - 1;
+		if (in[ofs] == 'd' && in[ofs + 1] == 'a' && in[ofs + 2] == 't' && in[ofs + 3] == 'a')
+			break;
+		ofs += 8 + in.readL32((ofs + 4));
+	}
+	if (ofs + 8 > in.size())
+	{
+		global::error = "Invalid WAV: no 'data' chunk";
+		return false;
 	}
-	return ((alaw & SIGN_BIT) ? t : -t);
+
+	data_offset = ofs + 8;
+	data_size   = std::min<size_t>(in.readL32(ofs + 4), in.size() - data_offset);
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Converts a 8-bit µ-law sample to 16-bit signed linear PCM
+// Returns true if wav data in the given format can be converted to doom sound
 // -----------------------------------------------------------------------------
-int16_t mulawToLinear(uint8_t ulaw)
+bool canConvertWav(const WavFmtChunk& fmtchunk, uint16_t wavfmt)
 {
-	int t;
-
-	/* Complement to obtain normal u-law value. */
-	ulaw = ~ulaw;
-
-	/*
-	 * Extract and bias the quantization bits. Then
-	 * shift up by the segment number and subtract out the bias.
-	 */
-	t = ((ulaw & QUANT_MASK) << 3) + BIAS;
-	t <<= (ulaw & SEG_MASK) >> SEG_SHIFT;
+	if (fmtchunk.channels == 0)
+		return false;
 
-	return ((ulaw & SIGN_BIT) ? (BIAS - t) : (t - BIAS));
+	switch (wavfmt)
+	{
+	case WAV_PCM: return fmtchunk.bps == 8 || fmtchunk.bps == 16 || fmtchunk.bps == 24 || fmtchunk.bps == 32;
+	case WAV_FLOAT: return fmtchunk.bps == 32;
+	case WAV_ALAW:
+	case WAV_ULAW: return fmtchunk.bps == 8;
+	default: return false;
+	}
 }
 } // namespace slade::conversion
 
@@ -366,172 +340,137 @@ bool conversion::doomSndToWav(MemChunk& in, MemChunk& out)
 }
 
 // -----------------------------------------------------------------------------
-// Converts wav data [in] to doom sound format, written to [out]
+// Converts wav data [in] to doom sound format, written to [out]. The sound is
+// resampled to [samplerate] if it is given.
+// This doesn't ask for confirmation if the conversion is lossy (see
+// wavToDoomSndIsLossy), so can be used from any thread
 // -----------------------------------------------------------------------------
-bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out)
+bool conversion::wavToDoomSnd(MemChunk& in, MemChunk& out, unsigned samplerate)
 {
 	// --- Read WAV ---
-	WavChunk chunk;
-
-	// Read header
-	in.seek(0, SEEK_SET);
-	in.read(&chunk, 8);
-
-	// Check header
-	if (chunk.id[0] != 'R' || chunk.id[1] != 'I' || chunk.id[2] != 'F' || chunk.id[3] != 'F')
-	{
-		global::error = "Invalid WAV";
-		return false;
-	}
-
-	// Read format
-	char format[4];
-	in.read(format, 4);
-
-	// Check format
-	if (format[0] != 'W' || format[1] != 'A' || format[2] != 'V' || format[3] != 'E')
-	{
-		global::error = "Invalid WAV format";
-		return false;
-	}
-
-	// Find fmt chunk
-	size_t ofs = 12;
-	while (ofs < in.size())
-	{
-		if (in[ofs] == 'f' && in[ofs + 1] == 'm' && in[ofs + 2] == 't' && in[ofs + 3] == ' ')
-			break;
-		ofs += 8 + in.readL32((ofs + 4));
-	}
-
-	// Read fmt chunk
-	if (ofs + sizeof(WavFmtChunk) > in.size())
-	{
-		global::error = "Invalid WAV: no 'fmt ' chunk";
-		return false;
-	}
-	in.seek(ofs, SEEK_SET);
 	WavFmtChunk fmtchunk;
-	in.read(&fmtchunk, sizeof(WavFmtChunk));
-
-	// Get format
-	uint8_t wavfmt = fmtchunk.tag == 0xFFFE ? in.readL32(ofs + 32) : fmtchunk.tag;
-	// Get byte per samples (from bits per sample)
-	uint8_t wavbps = fmtchunk.bps / 8;
+	uint16_t    wavfmt;
+	size_t      data_offset, data_size;
+	if (!readWav(in, fmtchunk, wavfmt, data_offset, data_size))
+		return false;
 
 	// Check fmt chunk values
-	if (fmtchunk.channels > 2 || fmtchunk.bps % 8 || wavbps > 4
-		|| (wavfmt != WAV_PCM && wavfmt != WAV_ALAW && wavfmt != WAV_ULAW))
+	if (!canConvertWav(fmtchunk, wavfmt))
 	{
-		global::error = "Cannot convert WAV file, only stereo or monophonic sounds in PCM format can be converted";
+		global::error = "Cannot convert WAV file, only sounds in PCM, float, A-law or µ-law format can be converted";
 		return false;
 	}
 
-	// Warn
-	if (wavbps > 1 || wavfmt != WAV_PCM || fmtchunk.channels == 2)
+	// Read samples as float
+	size_t frames = data_size / (fmtchunk.bps / 8 * fmtchunk.channels);
+	if (frames == 0)
 	{
-		if (!(wxMessageBox(
-				  "Warning: conversion will result in loss of metadata and audio quality. Do you wish to proceed?",
-				  "Conversion warning",
-				  wxOK | wxCANCEL)
-			  == wxOK))
-		{
-			global::error = "Conversion aborted by user";
-			return false;
-		}
-	}
-
-	// Find data chunk
-	ofs += 8 + wxUINT32_SWAP_ON_BE(fmtchunk.header.size);
-	while (ofs < in.size())
-	{
-		if (in[ofs] == 'd' && in[ofs + 1] == 'a' && in[ofs + 2] == 't' && in[ofs + 3] == 'a')
-			break;
-		ofs += 8 + in.readL32((ofs + 4));
-	}
-
-	// Read data
-	if (ofs + sizeof(WavFmtChunk) > in.size())
-	{
-		global::error = "Invalid WAV: no 'data' chunk";
+		global::error = "Invalid WAV: no sample data";
 		return false;
 	}
-	in.seek(ofs, SEEK_SET);
-	in.read(&chunk, 8);
-
-	if (wavbps > 1)
-		chunk.size /= wavbps;
+	vector<float> samples(frames * fmtchunk.channels);
+	auto          data = in.data() + data_offset;
+	if (wavfmt == WAV_ALAW)
+		audio::alawToFloat(data, samples.size(), samples.data());
+	else if (wavfmt == WAV_ULAW)
+		audio::mulawToFloat(data, samples.size(), samples.data());
+	else if (wavfmt == WAV_FLOAT)
+		audio::floatSamplesToFloat(data, samples.size(), samples.data());
+	else
+		audio::pcmToFloat(data, samples.size(), fmtchunk.bps, samples.data());
 
-	vector<uint8_t> data(chunk.size);
-	uint8_t         padding[16];
+	// Merge channels into a single mono one
+	audio::mixToMono(samples.data(), frames, fmtchunk.channels, samples.data());
+	samples.resize(frames);
 
-	// Store sample data. A simple read for 8 bits per sample.
-	if (fmtchunk.bps == 8)
-		in.read(data.data(), chunk.size);
-	// For 16, 24, or 32 bits per sample, downsample to 8.
-	else
+	// Resample if needed
+	unsigned rate = fmtchunk.samplerate;
+	if (samplerate > 0 && samplerate != rate)
 	{
-		int32_t val = 0;
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			in.read(&val, wavbps);
-			if (wavbps == 4)
-				data[i] = pcm32to8bits(val);
-			else if (wavbps == 3)
-				data[i] = pcm24to8bits(val);
-			else if (wavbps == 2)
-				data[i] = pcm16to8bits((int16_t)val);
-		}
+		samples = audio::resample(samples, rate, samplerate);
+		rate    = samplerate;
 	}
-
-	// Convert A-law or µ-law to 8-bit linear
-	if (wavfmt == WAV_ALAW || wavfmt == WAV_ULAW)
+	if (rate > 0xFFFF)
 	{
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			int16_t val = (wavfmt == WAV_ALAW) ? alawToLinear(data[i]) : mulawToLinear(data[i]);
-			data[i]     = pcm16to8bits(val);
-		}
+		global::error = fmt::format("Sample rate {}Hz is too high for doom sound format", rate);
+		return false;
 	}
 
-	// Merge stereo channels into a single mono one
-	if (fmtchunk.channels == 2)
-	{
-		chunk.size /= 2;
-		for (size_t i = 0; i < chunk.size; ++i)
-		{
-			size_t j = 2 * i;
-			data[i]  = stereoToMono(data[j], data[j + 1]);
-		}
-	}
+	// Convert to 8-bit
+	vector<uint8_t> pcm(samples.size());
+	audio::floatToPcm8(samples.data(), samples.size(), pcm.data());
 
 	// --- Write Doom Sound ---
 
 	// Write header
 	DSndHeader ds_hdr;
 	ds_hdr.three      = 3;
-	ds_hdr.samplerate = fmtchunk.samplerate;
-	ds_hdr.samples    = chunk.size;
+	ds_hdr.samplerate = rate;
+	ds_hdr.samples    = pcm.size();
 	if (dmx_padding)
 		ds_hdr.samples += 32;
 	out.write(&ds_hdr, 8);
 
 	// Write data
+	uint8_t padding[16];
 	if (dmx_padding)
 	{
-		memset(padding, data[0], 16);
+		memset(padding, pcm.front(), 16);
 		out.write(padding, 16);
 	}
-	out.write(data.data(), chunk.size);
+	out.write(pcm.data(), pcm.size());
 	if (dmx_padding)
 	{
-		memset(padding, data[chunk.size - 1], 16);
+		memset(padding, pcm.back(), 16);
 		out.write(padding, 16);
 	}
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if converting wav data [in] to doom sound format (at
+// [samplerate] if given) would lose audio quality, ie. if it isn't already
+// 8-bit mono PCM at the same sample rate
+// -----------------------------------------------------------------------------
+bool conversion::wavToDoomSndIsLossy(MemChunk& in, unsigned samplerate)
+{
+	WavFmtChunk fmtchunk;
+	uint16_t    wavfmt;
+	size_t      data_offset, data_size;
+	if (!readWav(in, fmtchunk, wavfmt, data_offset, data_size))
+		return false;
+
+	return wavfmt != WAV_PCM || fmtchunk.bps != 8 || fmtchunk.channels != 1
+		   || (samplerate > 0 && samplerate != fmtchunk.samplerate);
+}
+
+// -----------------------------------------------------------------------------
+// Converts sound data [in] of [format] (an entry format id) to wav format,
+// written to [out]. Blood sounds aren't supported since they need their
+// archive, use bloodToWav for those
+// -----------------------------------------------------------------------------
+bool conversion::soundToWav(MemChunk& in, MemChunk& out, string_view format)
+{
+	if (format == "snd_doom" || format == "snd_doom_mac")
+		return doomSndToWav(in, out);
+	if (format == "snd_speaker")
+		return spkSndToWav(in, out);
+	if (format == "snd_audiot")
+		return spkSndToWav(in, out, true);
+	if (format == "snd_wolf")
+		return wolfSndToWav(in, out);
+	if (format == "snd_voc")
+		return vocToWav(in, out);
+	if (format == "snd_jaguar")
+		return jagSndToWav(in, out);
+	if (format == "snd_sun")
+		return auSndToWav(in, out);
+
+	global::error = fmt::format("Sound format {} can not be converted to WAV", format);
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Converts mus data [in] to midi, written to [out]
 // -----------------------------------------------------------------------------
@@ -6,7 +6,9 @@ class ArchiveEntry;
 
 namespace conversion
 {
-	bool wavToDoomSnd(MemChunk& in, MemChunk& out);
+	bool wavToDoomSnd(MemChunk& in, MemChunk& out, unsigned samplerate = 0);
+	bool wavToDoomSndIsLossy(MemChunk& in, unsigned samplerate = 0);
+	bool soundToWav(MemChunk& in, MemChunk& out, string_view format);
 	bool spkSndToWav(MemChunk& in, MemChunk& out, bool audioT = false);
 	bool doomSndToWav(MemChunk& in, MemChunk& out);
 	bool wolfSndToWav(MemChunk& in, MemChunk& out);
@@ -40,7 +40,10 @@
 #include "General/Misc.h"
 #include "Graphics/GameFormats.h"
 #include "Graphics/Graphics.h"
+#include "General/UndoRedo.h"
+#include "MainEditor/Conversions.h"
 #include "MainEditor/MainEditor.h"
+#include "MainEditor/UI/ArchivePanel.h"
 #include "SLADEWxApp.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
@@ -50,6 +53,7 @@
 #include "Utility/FileMonitor.h"
 #include "Utility/Memory.h"
 #include "Utility/SFileDialog.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 
 using namespace slade;
@@ -67,6 +71,7 @@ CVAR(String, path_pngcrush, "", CVar::Flag::Save);
 CVAR(String, path_deflopt, "", CVar::Flag::Save);
 CVAR(String, path_db2, "", CVar::Flag::Save)
 CVAR(Bool, acc_always_show_output, false, CVar::Flag::Save);
+CVAR(Bool, acc_cache_output, true, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -115,6 +120,270 @@ struct ChunkSize
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// ACS Compiling
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+unsigned next_compile_id = 0;
+
+// A script being compiled by ACC in the background
+struct ACSCompile
+{
+	weak_ptr<ArchiveEntry> entry;
+	weak_ptr<ArchiveEntry> target;
+	string                 dir;        // Temp dir containing the source and library files
+	string                 srcfile;
+	string                 ofile;
+	string                 cache_file; // Empty if the output isn't to be cached
+};
+
+// -----------------------------------------------------------------------------
+// Updates (FNV-1a) [hash] with [size] bytes of [data]
+// -----------------------------------------------------------------------------
+void hashData(uint64_t& hash, const void* data, size_t size)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t a = 0; a < size; ++a)
+		hash = (hash ^ bytes[a]) * 0x100000001b3ULL;
+}
+
+// -----------------------------------------------------------------------------
+// Updates [hash] with the contents of all files/libraries #included or
+// #imported by the ACS source [text], recursively. Includes are resolved the
+// same way as the compiler does: exported [libs] (by name), then the
+// [include_dirs] in order
+// -----------------------------------------------------------------------------
+void hashIncludes(
+	const MemChunk&                        text,
+	const std::map<string, ArchiveEntry*>& libs,
+	const vector<string>&                  include_dirs,
+	std::set<string>&                      visited,
+	uint64_t&                              hash)
+{
+	Tokenizer tz;
+	tz.openMem(text, "ACS");
+	while (!tz.atEnd())
+	{
+		if (!tz.checkNC("#include") && !tz.checkNC("#import"))
+		{
+			tz.adv();
+			continue;
+		}
+
+		auto name = strutil::lower(tz.next().text);
+		tz.adv();
+		if (!visited.insert(name).second)
+			continue;
+
+		// Always hash the name, so an include that can't be resolved (yet) or
+		// moves to a different location still changes the hash
+		hashData(hash, name.data(), name.size());
+
+		// Library exported from the archive
+		MemChunk inc_data;
+		auto     lib = libs.find(string{ strutil::Path::fileNameOf(name, false) });
+		if (lib != libs.end())
+			inc_data.importMem(lib->second->rawData(), lib->second->size());
+		else
+		{
+			// File in an include dir
+			for (const auto& dir : include_dirs)
+			{
+				auto path = fmt::format("{}/{}", dir, name);
+				if (fileutil::fileExists(path))
+				{
+					hashData(hash, path.data(), path.size());
+					inc_data.importFile(path);
+					break;
+				}
+			}
+		}
+
+		if (inc_data.size() == 0)
+			continue;
+
+		hashData(hash, inc_data.data(), inc_data.size());
+		hashIncludes(inc_data, libs, include_dirs, visited, hash);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Imports the compiled ACS [ofile] to [target], or if no target is given:
+// the BEHAVIOR entry before [entry] if it is SCRIPTS, otherwise a same-name
+// compiled library entry in the acs namespace
+// -----------------------------------------------------------------------------
+void importCompiledACS(ArchiveEntry* entry, ArchiveEntry* target, const string& ofile)
+{
+	if (target)
+	{
+		target->importFile(ofile);
+		return;
+	}
+
+	// Check if the script is a map script (BEHAVIOR)
+	if (entry->upperName() == "SCRIPTS")
+	{
+		// Get entry before SCRIPTS
+		auto prev = entry->parent()->entryAt(entry->parent()->entryIndex(entry) - 1);
+
+		// Create a new entry there if it isn't BEHAVIOR
+		if (!prev || prev->upperName() != "BEHAVIOR")
+			prev = entry->parent()->addNewEntry("BEHAVIOR", entry->parent()->entryIndex(entry)).get();
+
+		// Import compiled script
+		prev->importFile(ofile);
+	}
+	else
+	{
+		// Otherwise, treat it as a library
+
+		// See if the compiled library already exists as an entry
+		Archive::SearchOptions opt;
+		opt.match_namespace = "acs";
+		opt.match_name      = entry->nameNoExt();
+		if (entry->parent()->formatDesc().names_extensions)
+		{
+			opt.match_name += ".o";
+			opt.ignore_ext = false;
+		}
+		auto lib = entry->parent()->findLast(opt);
+
+		// If it doesn't exist, create it
+		if (!lib)
+			lib = entry->parent()
+					  ->addEntry(std::make_shared<ArchiveEntry>(fmt::format("{}.o", entry->nameNoExt())), "acs")
+					  .get();
+
+		// Import compiled script
+		lib->importFile(ofile);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds the contents of [stream] that can be read without blocking to [out]
+// -----------------------------------------------------------------------------
+void readStream(wxInputStream* stream, string& out)
+{
+	char buf[4096];
+	while (stream && stream->CanRead())
+	{
+		stream->Read(buf, sizeof(buf));
+		if (stream->LastRead() == 0)
+			break;
+		out.append(buf, stream->LastRead());
+	}
+}
+
+// ACC process run asynchronously. Its output is read as it runs (so the pipes
+// don't fill up), and when it terminates the result is imported and the
+// process deletes itself
+class ACCProcess : public wxProcess
+{
+public:
+	ACCProcess(ACSCompile compile) : wxProcess{ wxPROCESS_REDIRECT }, compile_{ std::move(compile) }, timer_{ this }
+	{
+		Bind(wxEVT_TIMER, [&](wxTimerEvent&) { readOutput(); });
+		timer_.Start(100);
+	}
+
+	void OnTerminate(int pid, int status) override
+	{
+		timer_.Stop();
+		readOutput();
+		finish();
+		delete this;
+	}
+
+private:
+	ACSCompile compile_;
+	wxTimer    timer_;
+	string     output_;
+	string     errout_;
+
+	void readOutput()
+	{
+		readStream(GetInputStream(), output_);
+		readStream(GetErrorStream(), errout_);
+	}
+
+	void finish() const
+	{
+		// Log output
+		log::console("ACS compiler output:");
+		string output_log;
+		if (!output_.empty())
+		{
+			const char* title1 = "=== Log: ===\n";
+			log::console(title1);
+			output_log += title1;
+			for (const auto& line : strutil::splitV(output_, '\n'))
+			{
+				log::console(line);
+				output_log += line;
+			}
+		}
+
+		if (!errout_.empty())
+		{
+			const char* title2 = "\n=== Error log: ===\n";
+			log::console(title2);
+			output_log += title2;
+			for (const auto& line : strutil::splitV(errout_, '\n'))
+			{
+				log::console(line);
+				output_log += fmt::format("{}\n", line);
+			}
+		}
+
+		// Import the compiled script (if the entries still exist)
+		bool success = fileutil::fileExists(compile_.ofile);
+		auto entry   = compile_.entry.lock();
+		auto target  = compile_.target.lock();
+		if (success && entry && (target || entry->parent()))
+		{
+			importCompiledACS(entry.get(), target.get(), compile_.ofile);
+
+			// Cache it
+			if (!compile_.cache_file.empty())
+				fileutil::copyFile(compile_.ofile, compile_.cache_file);
+		}
+
+		if (!success || acc_always_show_output)
+		{
+			wxString errors;
+			auto     err_file = fmt::format("{}/acs.err", compile_.dir);
+			if (fileutil::fileExists(err_file))
+			{
+				// Read acs.err to string
+				wxFile       file(err_file);
+				vector<char> buf(file.Length());
+				file.Read(buf.data(), file.Length());
+				errors = wxString::From8BitData(buf.data(), file.Length());
+			}
+			else
+				errors = output_log;
+
+			if (!errors.empty() || !success)
+			{
+				ExtMessageDialog dlg(nullptr, success ? "ACC Output" : "Error Compiling");
+				dlg.setMessage(
+					success ? "The following errors were encountered while compiling, please fix them and recompile:" :
+							  "Compiler output shown below: ");
+				dlg.setExt(errors);
+				dlg.ShowModal();
+			}
+		}
+
+		// Clean up temp files
+		wxFileName::Rmdir(compile_.dir, wxPATH_RMDIR_RECURSIVE);
+	}
+};
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // EntryOperations Namespace Functions
@@ -562,7 +831,10 @@ bool entryoperations::findTextureErrors(const vector<ArchiveEntry*>& entries)
 // Attempts to compile [entry] as an ACS script.
 // If the entry is named SCRIPTS, the compiled data is imported to the BEHAVIOR
 // entry previous to it, otherwise it is imported to a same-name compiled
-// library entry in the acs namespace
+// library entry in the acs namespace.
+// The compiler is run in the background and the result is imported when it
+// finishes. If the source and everything it includes is unchanged since it was
+// last compiled, the cached output is imported immediately instead
 // -----------------------------------------------------------------------------
 bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry* target, wxFrame* parent)
 {
@@ -593,9 +865,15 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 		return false;
 	}
 
-	// Setup some path strings
-	auto srcfile       = app::path(fmt::format("{}.acs", entry->nameNoExt()), app::Dir::Temp);
-	auto ofile         = app::path(fmt::format("{}.o", entry->nameNoExt()), app::Dir::Temp);
+	// Setup some path strings (each compile gets its own temp dir so multiple
+	// compiles can run at once)
+	ACSCompile compile;
+	compile.entry   = entry->getShared();
+	compile.target  = target ? target->getShared() : nullptr;
+	compile.dir     = app::path(fmt::format("acc{}", next_compile_id++), app::Dir::Temp);
+	compile.srcfile = fmt::format("{}/{}.acs", compile.dir, entry->nameNoExt());
+	compile.ofile   = fmt::format("{}/{}.o", compile.dir, entry->nameNoExt());
+
 	auto include_paths = wxSplit(path_acc_libs, ';');
 
 	// Setup command options
@@ -608,12 +886,13 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 			opt += wxString::Format(" -i \"%s\"", include_path);
 	}
 
-	// Find/export any resource libraries
+	// Find any resource libraries
 	Archive::SearchOptions sopt;
-	sopt.match_type       = EntryType::fromId("acs");
-	sopt.search_subdirs   = true;
-	auto          entries = app::archiveManager().findAllResourceEntries(sopt);
-	wxArrayString lib_paths;
+	sopt.match_type     = EntryType::fromId("acs");
+	sopt.search_subdirs = true;
+
+	auto                            entries = app::archiveManager().findAllResourceEntries(sopt);
+	std::map<string, ArchiveEntry*> libs;
 	for (auto& res_entry : entries)
 	{
 		// Ignore SCRIPTS
@@ -624,134 +903,56 @@ bool entryoperations::compileACS(ArchiveEntry* entry, bool hexen, ArchiveEntry*
 		if (entry->parent() && (entry->parent()->filename(true) != res_entry->parent()->filename(true)))
 			continue;
 
-		auto path = app::path(fmt::format("{}.acs", res_entry->nameNoExt()), app::Dir::Temp);
-		res_entry->exportFile(path);
-		lib_paths.Add(path);
-		log::info(2, "Exporting ACS library {}", res_entry->name());
+		libs[strutil::lower(res_entry->nameNoExt())] = res_entry;
 	}
 
-	// Export script to file
-	entry->exportFile(srcfile);
-
-	// Execute acc
-	wxString      command = "\"" + path_acc + "\"" + " " + opt + " \"" + srcfile + "\" \"" + ofile + "\"";
-	wxArrayString output;
-	wxArrayString errout;
-	wxGetApp().SetTopWindow(parent);
-	wxExecute(command, output, errout, wxEXEC_SYNC);
-	wxGetApp().SetTopWindow(maineditor::windowWx());
-
-	// Log output
-	log::console("ACS compiler output:");
-	wxString output_log;
-	if (!output.IsEmpty())
+	// Check for cached output, by a hash of the compiler options, the source
+	// and everything it includes (the compiler's own dir is searched last)
+	if (acc_cache_output)
 	{
-		const char* title1 = "=== Log: ===\n";
-		log::console(title1);
-		output_log += title1;
-		for (const auto& line : output)
+		vector<string> include_dirs;
+		for (const auto& include_path : include_paths)
+			include_dirs.push_back(include_path.ToStdString());
+		include_dirs.emplace_back(strutil::Path::pathOf(path_acc.value, false));
+
+		uint64_t         hash = 0xcbf29ce484222325ULL;
+		std::set<string> visited;
+		auto             command_opt = fmt::format("{}{}", path_acc.value, opt.ToStdString());
+		hashData(hash, command_opt.data(), command_opt.size());
+		hashData(hash, entry->rawData(), entry->size());
+		hashIncludes(entry->data(), libs, include_dirs, visited, hash);
+
+		auto cache_dir = app::path("acs_cache", app::Dir::User);
+		if (!fileutil::dirExists(cache_dir))
+			fileutil::createDir(cache_dir);
+		compile.cache_file = fmt::format("{}/{:016x}.o", cache_dir, hash);
+
+		if (fileutil::fileExists(compile.cache_file))
 		{
-			log::console(line);
-			output_log += line;
+			log::info(2, "ACS script {} unchanged, using cached compiled output", entry->name());
+			importCompiledACS(entry, target, compile.cache_file);
+			return true;
 		}
 	}
 
-	if (!errout.IsEmpty())
+	// Export script and libraries to the temp dir
+	fileutil::createDir(compile.dir);
+	entry->exportFile(compile.srcfile);
+	for (auto& lib : libs)
 	{
-		const char* title2 = "\n=== Error log: ===\n";
-		log::console(title2);
-		output_log += title2;
-		for (const auto& line : errout)
-		{
-			log::console(line);
-			output_log += line + "\n";
-		}
+		lib.second->exportFile(fmt::format("{}/{}.acs", compile.dir, lib.second->nameNoExt()));
+		log::info(2, "Exporting ACS library {}", lib.second->name());
 	}
 
-	// Delete source file
-	wxRemoveFile(srcfile);
-
-	// Delete library files
-	for (const auto& lib_path : lib_paths)
-		wxRemoveFile(lib_path);
-
-	// Check it compiled successfully
-	bool success = wxFileExists(ofile);
-	if (success)
+	// Execute acc in the background
+	wxString command = "\"" + path_acc + "\"" + " " + opt + " \"" + compile.srcfile + "\" \"" + compile.ofile + "\"";
+	auto     process = new ACCProcess(std::move(compile));
+	if (wxExecute(command, wxEXEC_ASYNC, process) == 0)
 	{
-		// If no target entry was given, find one
-		if (!target)
-		{
-			// Check if the script is a map script (BEHAVIOR)
-			if (entry->upperName() == "SCRIPTS")
-			{
-				// Get entry before SCRIPTS
-				auto prev = entry->parent()->entryAt(entry->parent()->entryIndex(entry) - 1);
-
-				// Create a new entry there if it isn't BEHAVIOR
-				if (!prev || prev->upperName() != "BEHAVIOR")
-					prev = entry->parent()->addNewEntry("BEHAVIOR", entry->parent()->entryIndex(entry)).get();
-
-				// Import compiled script
-				prev->importFile(ofile);
-			}
-			else
-			{
-				// Otherwise, treat it as a library
-
-				// See if the compiled library already exists as an entry
-				Archive::SearchOptions opt;
-				opt.match_namespace = "acs";
-				opt.match_name      = entry->nameNoExt();
-				if (entry->parent()->formatDesc().names_extensions)
-				{
-					opt.match_name += ".o";
-					opt.ignore_ext = false;
-				}
-				auto lib = entry->parent()->findLast(opt);
-
-				// If it doesn't exist, create it
-				if (!lib)
-					lib = entry->parent()
-							  ->addEntry(std::make_shared<ArchiveEntry>(fmt::format("{}.o", entry->nameNoExt())), "acs")
-							  .get();
-
-				// Import compiled script
-				lib->importFile(ofile);
-			}
-		}
-		else
-			target->importFile(ofile);
-
-		// Delete compiled script file
-		wxRemoveFile(ofile);
-	}
-
-	if (!success || acc_always_show_output)
-	{
-		wxString errors;
-		if (wxFileExists(app::path("acs.err", app::Dir::Temp)))
-		{
-			// Read acs.err to string
-			wxFile       file(app::path("acs.err", app::Dir::Temp));
-			vector<char> buf(file.Length());
-			file.Read(buf.data(), file.Length());
-			errors = wxString::From8BitData(buf.data(), file.Length());
-		}
-		else
-			errors = output_log;
-
-		if (!errors.empty() || !success)
-		{
-			ExtMessageDialog dlg(nullptr, success ? "ACC Output" : "Error Compiling");
-			dlg.setMessage(
-				success ? "The following errors were encountered while compiling, please fix them and recompile:" :
-						  "Compiler output shown below: ");
-			dlg.setExt(errors);
-			dlg.ShowModal();
-		}
-
-		return success;
+		log::error("Unable to execute ACC command: {}", command.ToStdString());
+		wxFileName::Rmdir(compile.dir, wxPATH_RMDIR_RECURSIVE);
+		delete process;
+		return false;
 	}
 
 	return true;
@@ -789,9 +990,12 @@ bool entryoperations::exportAsPNG(ArchiveEntry* entry, const wxString& filename)
 }
 
 // -----------------------------------------------------------------------------
-// Attempts to optimize [entry] using external PNG optimizers.
+// Attempts to optimize [entry] using external PNG optimizers. If [recompress]
+// is true, the image data is first recompressed at maximum compression (see
+// gfx::pngRecompress), which is all that is done if no external optimizers
+// are set up.
 // -----------------------------------------------------------------------------
-bool entryoperations::optimizePNG(ArchiveEntry* entry)
+bool entryoperations::optimizePNG(ArchiveEntry* entry, bool recompress)
 {
 	// Check entry was given
 	if (!entry)
@@ -808,15 +1012,25 @@ bool entryoperations::optimizePNG(ArchiveEntry* entry)
 		return false;
 	}
 
-	// Check if the PNG tools path are set up, at least one of them should be
+	// Recompress image data
+	bool recompressed = false;
+	if (recompress)
+	{
+		MemChunk png;
+		png.importMem(entry->data());
+		if (gfx::pngRecompress(png))
+			recompressed = entry->importMemChunk(png);
+	}
+
+	// Check if the PNG tools path are set up
 	wxString pngpathc = path_pngcrush;
 	wxString pngpatho = path_pngout;
 	wxString pngpathd = path_deflopt;
 	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
 		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
 	{
-		log::error(1, "PNG tool paths not defined or invalid, no optimization done.");
-		return false;
+		log::info(1, "PNG tool paths not defined or invalid, no external optimization done.");
+		return recompressed;
 	}
 
 	// Save special chunks
@@ -1003,6 +1217,93 @@ bool entryoperations::optimizePNG(ArchiveEntry* entry)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Converts all sound [entries] that can be converted to [format] ("snd_doom" or
+// "snd_wav"). When converting to doom sound, sounds are resampled to
+// [samplerate] if it is given.
+// The conversions are done in parallel, and each converted entry is recorded
+// in [undo_manager] if given (an undo level should already be started).
+// Returns the number of entries that were converted, any errors are logged
+// -----------------------------------------------------------------------------
+unsigned entryoperations::convertSounds(
+	const vector<ArchiveEntry*>& entries,
+	string_view                  format,
+	unsigned                     samplerate,
+	UndoManager*                 undo_manager)
+{
+	struct Conversion
+	{
+		ArchiveEntry* entry;
+		string        format;
+		MemChunk      in;
+		MemChunk      out;
+		bool          ok = false;
+		string        error;
+	};
+
+	// Get the data of each entry to convert (the entries themselves aren't
+	// accessed while converting)
+	bool               to_doom = format == "snd_doom";
+	vector<Conversion> conversions;
+	for (auto entry : entries)
+	{
+		auto entry_format = entry->type()->formatId();
+		bool convertible = to_doom ? entry_format == "snd_wav" :
+									 entry_format != "snd_wav" && strutil::startsWith(entry_format, "snd_");
+		if (!convertible)
+			continue;
+
+		auto& conv  = conversions.emplace_back();
+		conv.entry  = entry;
+		conv.format = entry_format;
+
+		// Blood sounds need the archive they are in, so are converted here
+		if (conv.format == "snd_bloodsfx")
+		{
+			conv.ok = conversion::bloodToWav(entry, conv.out);
+			if (!conv.ok)
+				conv.error = global::error;
+		}
+		else
+			conv.in.importMem(entry->data());
+	}
+
+	// Convert
+	threadpool::parallelFor(
+		conversions.size(),
+		[&conversions, to_doom, samplerate](size_t index)
+		{
+			auto& conv = conversions[index];
+			if (conv.format == "snd_bloodsfx")
+				return;
+
+			conv.ok = to_doom ? conversion::wavToDoomSnd(conv.in, conv.out, samplerate) :
+								conversion::soundToWav(conv.in, conv.out, conv.format);
+			if (!conv.ok)
+				conv.error = global::error;
+		});
+
+	// Update entries with the converted data
+	unsigned converted = 0;
+	for (auto& conv : conversions)
+	{
+		if (!conv.ok)
+		{
+			log::error("Unable to convert entry {}: {}", conv.entry->name(), conv.error);
+			continue;
+		}
+
+		if (undo_manager)
+			undo_manager->recordUndoStep(std::make_unique<EntryDataUS>(conv.entry));
+		conv.entry->importMemChunk(conv.out);
+		EntryType::detectEntryType(*conv.entry);
+		conv.entry->setExtensionByType();
+		++converted;
+	}
+
+	return converted;
+}
+
 // -----------------------------------------------------------------------------
 // Converts ANIMATED data in [entry] to ANIMDEFS format, written to [animdata]
 // -----------------------------------------------------------------------------
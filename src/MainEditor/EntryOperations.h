@@ -8,6 +8,7 @@ class wxFrame;
 namespace slade
 {
 class ModifyOffsetsDialog;
+class UndoManager;
 
 namespace entryoperations
 {
@@ -19,7 +20,12 @@ namespace entryoperations
 	bool findTextureErrors(const vector<ArchiveEntry*>& entries);
 	bool compileACS(ArchiveEntry* entry, bool hexen = false, ArchiveEntry* target = nullptr, wxFrame* parent = nullptr);
 	bool exportAsPNG(ArchiveEntry* entry, const wxString& filename);
-	bool optimizePNG(ArchiveEntry* entry);
+	bool optimizePNG(ArchiveEntry* entry, bool recompress = true);
+	unsigned convertSounds(
+		const vector<ArchiveEntry*>& entries,
+		string_view                  format,
+		unsigned                     samplerate   = 0,
+		UndoManager*                 undo_manager = nullptr);
 
 	// ANIMATED/SWITCHES
 	bool convertAnimated(ArchiveEntry* entry, MemChunk* animdata, bool animdefs);
@@ -87,9 +87,8 @@ public:
 		bool ok = entry_->exportFile(fn.fullPath());
 		if (ok)
 		{
-			filename_      = fn.fullPath();
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			filename_ = fn.fullPath();
+			startMonitoring();
 		}
 		else
 			global::error = "Failed to export entry";
@@ -180,8 +179,7 @@ public:
 		filename_ = fn.fullPath();
 		if (png.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -246,8 +244,7 @@ public:
 		filename_ = fn.fullPath();
 		if (convdata.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -284,7 +281,14 @@ public:
 		{
 			MemChunk in, out;
 			in.importFile(filename_);
-			if (conversion::wavToDoomSnd(in, out))
+			bool convert = !conversion::wavToDoomSndIsLossy(in)
+						   || wxMessageBox(
+								  "Warning: conversion will result in loss of metadata and audio quality. Do you wish "
+								  "to proceed?",
+								  "Conversion warning",
+								  wxOK | wxCANCEL)
+								  == wxOK;
+			if (convert && conversion::wavToDoomSnd(in, out))
 			{
 				// Import converted data to entry if successful
 				entry_->importMemChunk(out);
@@ -343,8 +347,7 @@ public:
 		filename_ = fn.fullPath();
 		if (convdata.exportFile(filename_))
 		{
-			file_modified_ = fileutil::fileModifiedTime(filename_);
-			Start(1000);
+			startMonitoring();
 			return true;
 		}
 
@@ -49,7 +49,11 @@
 #include "UI/Dialogs/DirArchiveUpdateDialog.h"
 #include "UI/Dialogs/NewArchiveDiaog.h"
 #include "UI/WxUtils.h"
+#include "Utility/MemoryStats.h"
 #include "Utility/StringUtils.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <wx/fswatcher.h>
 
 using namespace slade;
 
@@ -63,6 +67,7 @@ CVAR(Bool, close_archive_with_tab, true, CVar::Flag::Save)
 CVAR(Int, am_current_tab, 0, CVar::Flag::Save)
 CVAR(Bool, am_file_browser_tab, false, CVar::Flag::Save)
 CVAR(Int, dir_archive_change_action, 2, CVar::Flag::Save) // 0=always ignore, 1=always apply, 2+=ask
+CVAR(Bool, dir_archive_watch, true, CVar::Flag::Save) // Use native file system notifications to find dir changes
 
 
 // -----------------------------------------------------------------------------
@@ -146,57 +151,44 @@ wxThread::ExitCode DirArchiveCheck::Entry()
 		}
 	}
 
+	// Index entry info and removed files by file path
+	std::unordered_map<string, EntryInfo*> path_info;
+	for (auto& info : entry_info_)
+		path_info.emplace(info.file_path.ToStdString(), &info);
+	std::unordered_set<string> removed_files(removed_files_.begin(), removed_files_.end());
+
 	// Check for new/updated files
 	for (const auto& file : files)
 	{
 		// Ignore files removed from archive since last save
-		if (VECTOR_EXISTS(removed_files_, file))
+		if (removed_files.count(file) > 0)
 			continue;
 
 		// Find file in archive
-		EntryInfo inf;
-		bool      found = false;
-		for (auto& info : entry_info_)
-		{
-			if (info.file_path == file)
-			{
-				inf   = info;
-				found = true;
-				break;
-			}
-		}
+		auto info = path_info.find(file);
 
 		time_t mod = wxFileModificationTime(file);
 
 		// No match, added to archive
-		if (!found)
+		if (info == path_info.end())
 			addChange(DirEntryChange(DirEntryChange::Action::AddedFile, file, "", mod));
 		// Matched, check modification time
-		else if (mod > inf.file_modified)
-			addChange(DirEntryChange(DirEntryChange::Action::Updated, file, inf.entry_path.ToStdString(), mod));
+		else if (mod > info->second->file_modified)
+			addChange(
+				DirEntryChange(DirEntryChange::Action::Updated, file, info->second->entry_path.ToStdString(), mod));
 	}
 
 	// Check for new dirs
 	for (const auto& subdir : dirs)
 	{
 		// Ignore dirs removed from archive since last save
-		if (VECTOR_EXISTS(removed_files_, subdir))
+		if (removed_files.count(subdir) > 0)
 			continue;
 
-		bool found = false;
-		for (auto& info : entry_info_)
-		{
-			if (info.file_path == subdir)
-			{
-				found = true;
-				break;
-			}
-		}
-
 		time_t mod = wxDateTime::Now().GetTicks();
 
 		// No match, added to archive
-		if (!found)
+		if (path_info.find(subdir) == path_info.end())
 			addChange(DirEntryChange(DirEntryChange::Action::AddedDir, subdir, "", mod));
 	}
 
@@ -209,6 +201,144 @@ wxThread::ExitCode DirArchiveCheck::Entry()
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// DirArchiveWatcher Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// DirArchiveWatcher class constructor, starts watching [archive]'s directory
+// tree
+// -----------------------------------------------------------------------------
+DirArchiveWatcher::DirArchiveWatcher(DirArchive* archive) :
+	archive_{ archive },
+	watcher_{ std::make_unique<wxFileSystemWatcher>() }
+{
+	watcher_->SetOwner(this);
+	Bind(wxEVT_FSWATCHER, &DirArchiveWatcher::onFileSystemEvent, this);
+
+	// Watching can fail if eg. the system's watch limit is reached,
+	// in which case the directory will just be fully checked each time
+	wxLogNull no_log;
+	ok_ = watcher_->AddTree(
+		wxFileName::DirName(archive->filename()),
+		wxFSW_EVENT_CREATE | wxFSW_EVENT_DELETE | wxFSW_EVENT_RENAME | wxFSW_EVENT_MODIFY);
+}
+
+// -----------------------------------------------------------------------------
+// DirArchiveWatcher class destructor
+// -----------------------------------------------------------------------------
+DirArchiveWatcher::~DirArchiveWatcher()
+{
+	watcher_->RemoveAll();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (non-ignored) changes to the archive's directory since the last
+// call, found by checking each path that was reported as changed against the
+// archive's entries in the same way as DirArchiveCheck
+// -----------------------------------------------------------------------------
+vector<DirEntryChange> DirArchiveWatcher::takeChanges()
+{
+	vector<DirEntryChange> changes;
+	if (changed_paths_.empty())
+		return changes;
+
+	// Index entries by file path
+	vector<ArchiveEntry*> entries;
+	archive_->putEntryTreeAsList(entries);
+	std::unordered_map<string, ArchiveEntry*> path_entries;
+	for (auto entry : entries)
+	{
+		auto path = entry->exProps().getOr<string>("filePath", "");
+		if (!path.empty())
+			path_entries.emplace(path, entry);
+	}
+	const auto& removed_files = archive_->removedFiles();
+
+	// Check changed paths, in the same order as DirArchiveCheck (deletions
+	// first and new dirs last)
+	vector<DirEntryChange> deleted, added_dirs;
+	for (const auto& path : changed_paths_)
+	{
+		auto          found = path_entries.find(path);
+		ArchiveEntry* entry = found != path_entries.end() ? found->second : nullptr;
+
+		if (wxDirExists(path))
+		{
+			if (!entry && !VECTOR_EXISTS(removed_files, path))
+				added_dirs.emplace_back(DirEntryChange::Action::AddedDir, path, "", wxDateTime::Now().GetTicks());
+		}
+		else if (wxFileExists(path))
+		{
+			if (VECTOR_EXISTS(removed_files, path))
+				continue;
+
+			time_t mod = wxFileModificationTime(path);
+			if (!entry)
+				changes.emplace_back(DirEntryChange::Action::AddedFile, path, "", mod);
+			else if (mod > archive_->fileModificationTime(entry))
+				changes.emplace_back(DirEntryChange::Action::Updated, path, entry->path(true), mod);
+		}
+		else if (entry)
+		{
+			if (entry->type() == EntryType::folderType())
+				deleted.emplace_back(DirEntryChange::Action::DeletedDir, path, entry->path(true));
+			else
+				deleted.emplace_back(DirEntryChange::Action::DeletedFile, path, entry->path(true));
+		}
+	}
+	changed_paths_.clear();
+
+	changes.insert(changes.begin(), deleted.begin(), deleted.end());
+	changes.insert(changes.end(), added_dirs.begin(), added_dirs.end());
+
+	// Remove ignored changes
+	changes.erase(
+		std::remove_if(
+			changes.begin(),
+			changes.end(),
+			[this](DirEntryChange& change) { return archive_->shouldIgnoreEntryChange(change); }),
+		changes.end());
+
+	return changes;
+}
+
+// -----------------------------------------------------------------------------
+// Called when a file system change is reported for the watched directory
+// -----------------------------------------------------------------------------
+void DirArchiveWatcher::onFileSystemEvent(wxFileSystemWatcherEvent& e)
+{
+	// Events may have been lost, the whole directory will need to be checked
+	if (e.GetChangeType() == wxFSW_EVENT_WARNING || e.GetChangeType() == wxFSW_EVENT_ERROR)
+	{
+		ok_ = false;
+		return;
+	}
+
+	bool added    = e.GetChangeType() == wxFSW_EVENT_CREATE || e.GetChangeType() == wxFSW_EVENT_RENAME;
+	auto add_path = [this, added](const wxFileName& fn) {
+		auto path = fn.GetFullPath().ToStdString();
+		while (path.size() > 1 && wxFileName::IsPathSeparator(path.back()))
+			path.pop_back();
+
+		// New directories aren't necessarily watched (and their contents may
+		// not have been reported), so fall back to checking the whole
+		// directory next time
+		if (added && wxDirExists(path))
+			ok_ = false;
+
+		changed_paths_.insert(path);
+	};
+
+	add_path(e.GetPath());
+	if (e.GetChangeType() == wxFSW_EVENT_RENAME)
+		add_path(e.GetNewPath());
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // WMFileBrowser Class Functions
@@ -1102,12 +1232,30 @@ void ArchiveManagerPanel::openFile(const wxString& filename) const
 // -----------------------------------------------------------------------------
 void ArchiveManagerPanel::openFiles(wxArrayString& files) const
 {
-	// Go through each filename in the array
-	for (const auto& file : files)
+	// Just open normally if only one file
+	if (files.size() == 1)
 	{
-		// Open the archive
-		openFile(file);
+		openFile(files[0]);
+		return;
 	}
+
+	// Show splash screen
+	ui::showSplash("Opening Archives...", true);
+
+	// Open the files in the archive manager (all at once)
+	vector<string> filenames;
+	for (const auto& file : files)
+		filenames.push_back(file.ToStdString());
+	vector<string> errors;
+	auto           archives = app::archiveManager().openArchives(filenames, true, false, &errors);
+
+	// Hide splash screen
+	ui::hideSplash();
+
+	// Show error messages for any archives that didn't open ok
+	for (unsigned a = 0; a < archives.size(); ++a)
+		if (!archives[a])
+			wxMessageBox(wxString::Format("Error opening %s:\n%s", files[a], errors[a]), "Error", wxICON_ERROR);
 }
 
 // -----------------------------------------------------------------------------
@@ -1274,8 +1422,10 @@ void ArchiveManagerPanel::saveAll() const
 }
 
 // -----------------------------------------------------------------------------
-// Checks all open directory archives for changes on the file system in
-// background threads
+// Checks all open directory archives for changes on the file system.
+// Archives being watched for changes (if dir_archive_watch is enabled) only
+// have the reported changes checked, otherwise the whole directory is checked
+// in a background thread
 // -----------------------------------------------------------------------------
 void ArchiveManagerPanel::checkDirArchives()
 {
@@ -1291,9 +1441,34 @@ void ArchiveManagerPanel::checkDirArchives()
 		if (VECTOR_EXISTS(checking_archives_, archive.get()))
 			continue;
 
+		auto dir_archive = dynamic_cast<DirArchive*>(archive.get());
+		if (dir_archive_watch)
+		{
+			// Only check the changes reported since last time if possible
+			auto& watcher = dir_archive_watchers_[archive.get()];
+			if (watcher && watcher->isOk())
+			{
+				auto changes = watcher->takeChanges();
+				if (!changes.empty())
+				{
+					checking_archives_.push_back(archive.get());
+					auto event = new wxThreadEvent(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED);
+					event->SetPayload<DirArchiveChangeList>({ archive.get(), changes });
+					wxQueueEvent(this, event);
+				}
+				continue;
+			}
+
+			// Otherwise (re)start watching before checking everything, so
+			// nothing changed during or after the check is missed
+			watcher = std::make_unique<DirArchiveWatcher>(dir_archive);
+		}
+		else
+			dir_archive_watchers_.erase(archive.get());
+
 		log::info(2, "Checking {} for external changes...", archive->filename());
 		checking_archives_.push_back(archive.get());
-		auto check = new DirArchiveCheck(this, dynamic_cast<DirArchive*>(archive.get()));
+		auto check = new DirArchiveCheck(this, dir_archive);
 		check->Create();
 		check->Run();
 	}
@@ -2239,6 +2414,7 @@ void ArchiveManagerPanel::connectSignals()
 		closeTextureTab(index);
 		closeEntryTabs(app::archiveManager().getArchive(index).get());
 		closeTab(index);
+		dir_archive_watchers_.erase(app::archiveManager().getArchive(index).get());
 	});
 
 	// When an archive is opened, open its tab
@@ -2252,3 +2428,34 @@ void ArchiveManagerPanel::connectSignals()
 	signal_connections += signals.bookmarks_removed.connect(
 		[this](const vector<ArchiveEntry*>&) { refreshBookmarkList(); });
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counts memory used by the undo history of each open archive's tab
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(archive_undo, "Archive Undo")
+{
+	auto window = maineditor::window();
+	if (!window || !window->archiveManagerPanel())
+		return;
+
+	for (int a = 0; a < app::archiveManager().numArchives(); ++a)
+	{
+		auto archive = app::archiveManager().getArchive(a);
+		auto panel   = window->archiveManagerPanel()->tabForArchive(archive.get());
+		if (!panel || !panel->undoManager() || panel->undoManager()->nUndoLevels() == 0)
+			continue;
+
+		usage.push_back({ {},
+						  archive->filename(false),
+						  panel->undoManager()->memoryUsage(),
+						  panel->undoManager()->nUndoLevels() });
+	}
+}
@@ -8,6 +8,9 @@
 
 wxDECLARE_EVENT(wxEVT_COMMAND_DIRARCHIVECHECK_COMPLETED, wxThreadEvent);
 
+class wxFileSystemWatcher;
+class wxFileSystemWatcherEvent;
+
 namespace slade
 {
 class ArchiveManagerPanel;
@@ -58,6 +61,28 @@ private:
 	void addChange(DirEntryChange change);
 };
 
+// Watches the directory of a DirArchive for changes via the native file system
+// change notifications (wxFileSystemWatcher), so changes can be found without
+// rescanning the whole directory
+class DirArchiveWatcher : public wxEvtHandler
+{
+public:
+	DirArchiveWatcher(DirArchive* archive);
+	~DirArchiveWatcher();
+
+	bool isOk() const { return ok_; }
+
+	vector<DirEntryChange> takeChanges();
+
+private:
+	DirArchive*                     archive_;
+	unique_ptr<wxFileSystemWatcher> watcher_;
+	std::set<string>                changed_paths_;
+	bool                            ok_ = false; // False if any changes may have been missed
+
+	void onFileSystemEvent(wxFileSystemWatcherEvent& e);
+};
+
 class WMFileBrowser : public wxGenericDirCtrl
 {
 public:
@@ -185,6 +210,8 @@ private:
 	bool             checked_dir_archive_changes_ = false;
 	vector<Archive*> checking_archives_;
 
+	std::map<Archive*, unique_ptr<DirArchiveWatcher>> dir_archive_watchers_;
+
 	// Signal connections
 	ScopedConnectionList signal_connections;
 
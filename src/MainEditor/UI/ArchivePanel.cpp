@@ -35,6 +35,7 @@
 #include "ArchivePanel.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryIO.h"
 #include "Archive/Formats/ZipArchive.h"
 #include "ArchiveManagerPanel.h"
 #include "EntryPanel/ANSIEntryPanel.h"
@@ -52,6 +53,8 @@
 #include "General/KeyBind.h"
 #include "General/Misc.h"
 #include "General/UI.h"
+#include "Graphics/GfxConvert.h"
+#include "Graphics/Graphics.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
 #include "MainEditor/ArchiveOperations.h"
@@ -78,6 +81,7 @@
 #include "UI/WxUtils.h"
 #include "Utility/SFileDialog.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -105,6 +109,7 @@ CVAR(Bool, archive_build_skip_hidden, true, CVar::Flag::Save)
 CVAR(Bool, elist_show_filter, false, CVar::Flag::Save)
 CVAR(Int, ap_splitter_position_tree, 300, CVar::Flag::Save)
 CVAR(Int, ap_splitter_position_list, 300, CVar::Flag::Save)
+CVAR(Int, dsnd_convert_samplerate, 0, CVar::Flag::Save) // Resample to this when converting to doom sound (0 = keep)
 
 
 // -----------------------------------------------------------------------------
@@ -988,35 +993,17 @@ bool ArchivePanel::importFiles()
 		// Begin recording undo level
 		undo_manager_->beginRecord("Import Files");
 
-		// Go through the list of files
-		bool ok = false;
+		// Import the files
+		string errors;
 		entry_tree_->Freeze();
 		ui::showSplash("Importing Files...", true);
-		for (size_t a = 0; a < info.filenames.size(); a++)
-		{
-			// Get filename
-			wxString name = wxFileName(info.filenames[a]).GetFullName();
-
-			// Update splash window
-			ui::setSplashProgress(float(a) / float(info.filenames.size()));
-			ui::setSplashProgressMessage(name.ToStdString());
-
-			// Add the entry to the archive
-			auto new_entry = archive->addNewEntry(name.ToStdString(), index, dir);
-
-			// If the entry was created ok, load the file into it
-			if (new_entry)
-			{
-				new_entry->importFile(info.filenames[a]); // Import file to entry
-				EntryType::detectEntryType(*new_entry);   // Detect entry type
-				ok = true;
-			}
-
-			if (index > 0)
-				index++;
-		}
+		auto entries = entryio::importFiles(*archive, entryio::filesToImport(info.filenames), dir, index, &errors);
 		ui::hideSplash();
 		entry_tree_->Thaw();
+		bool ok = !entries.empty();
+
+		if (!errors.empty())
+			log::warning("Errors importing files:\n{}", errors);
 
 		// End recording undo level
 		undo_manager_->endRecord(true);
@@ -1818,7 +1805,7 @@ bool ArchivePanel::crc32() const
 	wxString checksums = "\nCRC-32:\n";
 	for (auto& entry : selection)
 	{
-		uint32_t crc = entry->data().crc();
+		uint32_t crc = entry->contentHash();
 		checksums += wxString::Format("%s:\t%x\n", entry->name(), crc);
 	}
 	log::info(1, checksums);
@@ -1966,7 +1953,8 @@ bool ArchivePanel::exportEntry()
 		filedialog::FDInfo info;
 		if (filedialog::saveFiles(info, "Export Multiple Entries (Filename is ignored)", "Any File (*.*)|*.*", this))
 		{
-			// Go through the selected entries
+			// Get the export filenames of the selected entries
+			vector<string> paths;
 			for (auto& entry : selection)
 			{
 				// Setup entry filename
@@ -1977,13 +1965,19 @@ bool ArchivePanel::exportEntry()
 				if (!fn.HasExt())
 					fn.SetExt(entry->type()->extension());
 
-				// Do export
-				entry->exportFile(fn.GetFullPath().ToStdString());
+				paths.push_back(fn.GetFullPath().ToStdString());
 			}
 
-			// Go through selected dirs
+			// Export selected entries and dirs
+			string errors;
+			ui::showSplash("Exporting Entries...", true);
+			entryio::exportEntries(selection, paths, &errors);
 			for (auto& dir : selected_dirs)
-				dir->exportTo(string{ info.path + "/" + dir->name() });
+				entryio::exportDir(*dir, string{ info.path + "/" + dir->name() }, &errors);
+			ui::hideSplash();
+
+			if (!errors.empty())
+				log::warning("Errors exporting entries:\n{}", errors);
 		}
 	}
 
@@ -2134,34 +2128,24 @@ bool ArchivePanel::gfxConvert() const
 	// Show splash window
 	ui::showSplash("Writing converted image data...", true);
 
-	// Begin recording undo level
-	undo_manager_->beginRecord("Gfx Format Conversion");
-
-	// Write any changes
+	// Get converted images
+	vector<gfx::ConvertItem> items(selection.size());
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
-		// Update splash window
-		ui::setSplashProgressMessage(selection[a]->name());
-		ui::setSplashProgress((float)a / (float)selection.size());
-
 		// Skip if the image wasn't converted
 		if (!gcd.itemModified(a))
 			continue;
 
-		// Get image and conversion info
-		auto image  = gcd.itemImage(a);
-		auto format = gcd.itemFormat(a);
-
-		// Write converted image back to entry
-		MemChunk mc;
-		format->saveImage(*image, mc, gcd.itemPalette(a));
-		selection[a]->importMemChunk(mc);
-		EntryType::detectEntryType(*selection[a]);
-		selection[a]->setExtensionByType();
+		items[a].entry      = selection[a];
+		items[a].format     = gcd.itemFormat(a);
+		items[a].pal_target = gcd.itemPalette(a);
+		items[a].converted  = true;
+		items[a].image.copyImage(gcd.itemImage(a));
 	}
 
-	// Finish recording undo level
-	undo_manager_->endRecord(true);
+	// Write converted images back to entries (as one undo level)
+	gfx::writeImages(items);
+	gfx::applyToEntries(items, undo_manager_.get());
 
 	// Hide splash window
 	ui::hideSplash();
@@ -2675,36 +2659,36 @@ bool ArchivePanel::wavDSndConvert() const
 	// Get selected entries
 	auto selection = entry_tree_->selectedEntries();
 
-	// Begin recording undo level
-	undo_manager_->beginRecord("Convert Wav -> Doom Sound");
-
-	// Go through selection
-	bool errors = false;
-	for (unsigned a = 0; a < selection.size(); a++)
+	// Check if any conversions will be lossy
+	unsigned samplerate = std::max<int>(dsnd_convert_samplerate, 0);
+	unsigned num_wav    = 0;
+	bool     lossy      = false;
+	for (auto entry : selection)
 	{
-		// Convert WAV -> Doom Sound if the entry is WAV format
-		if (selection[a]->type()->formatId() == "snd_wav")
-		{
-			MemChunk dsnd;
-			// Attempt conversion
-			if (!conversion::wavToDoomSnd(selection[a]->data(), dsnd))
-			{
-				log::error(wxString::Format("Unable to convert entry %s: %s", selection[a]->name(), global::error));
-				errors = true;
-				continue;
-			}
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a])); // Create undo step
-			selection[a]->importMemChunk(dsnd);                                         // Load doom sound data
-			EntryType::detectEntryType(*selection[a]);                                  // Update entry type
-			selection[a]->setExtensionByType();                                         // Update extension if necessary
-		}
+		if (entry->type()->formatId() != "snd_wav")
+			continue;
+
+		++num_wav;
+		if (!lossy)
+			lossy = conversion::wavToDoomSndIsLossy(entry->data(), samplerate);
 	}
 
-	// Finish recording undo level
+	// Ask once for all entries
+	if (lossy
+		&& wxMessageBox(
+			   "Warning: conversion will result in loss of metadata and audio quality. Do you wish to proceed?",
+			   "Conversion warning",
+			   wxOK | wxCANCEL)
+			   != wxOK)
+		return false;
+
+	// Convert WAV -> Doom Sound
+	undo_manager_->beginRecord("Convert Wav -> Doom Sound");
+	auto converted = entryoperations::convertSounds(selection, "snd_doom", samplerate, undo_manager_);
 	undo_manager_->endRecord(true);
 
 	// Show message if errors occurred
-	if (errors)
+	if (converted < num_wav)
 		wxMessageBox("Some entries could not be converted, see console log for details", "SLADE", wxICON_INFORMATION);
 
 	return true;
@@ -2716,56 +2700,19 @@ bool ArchivePanel::wavDSndConvert() const
 bool ArchivePanel::dSndWavConvert() const
 {
 	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
+	auto     selection = entry_tree_->selectedEntries();
+	unsigned num_sound = 0;
+	for (auto entry : selection)
+		if (entry->type()->formatId() != "snd_wav" && strutil::startsWith(entry->type()->formatId(), "snd_"))
+			++num_sound;
 
-	// Begin recording undo level
+	// Convert sounds -> WAV
 	undo_manager_->beginRecord("Convert Doom Sound -> Wav");
-
-	// Go through selection
-	bool errors = false;
-	for (unsigned a = 0; a < selection.size(); a++)
-	{
-		bool     worked = false;
-		MemChunk wav;
-		// Convert Doom Sound -> WAV if the entry is Doom Sound format
-		if (selection[a]->type()->formatId() == "snd_doom" || selection[a]->type()->formatId() == "snd_doom_mac")
-			worked = conversion::doomSndToWav(selection[a]->data(), wav);
-		// Or Doom Speaker sound format
-		else if (selection[a]->type()->formatId() == "snd_speaker")
-			worked = conversion::spkSndToWav(selection[a]->data(), wav);
-		// Or Jaguar Doom sound format
-		else if (selection[a]->type()->formatId() == "snd_jaguar")
-			worked = conversion::jagSndToWav(selection[a]->data(), wav);
-		// Or Wolfenstein 3D sound format
-		else if (selection[a]->type()->formatId() == "snd_wolf")
-			worked = conversion::wolfSndToWav(selection[a]->data(), wav);
-		// Or Creative Voice File format
-		else if (selection[a]->type()->formatId() == "snd_voc")
-			worked = conversion::vocToWav(selection[a]->data(), wav);
-		// Or Blood SFX format (this one needs to be given the entry, not just the mem chunk)
-		else if (selection[a]->type()->formatId() == "snd_bloodsfx")
-			worked = conversion::bloodToWav(selection[a], wav);
-		// If successfully converted, update the entry
-		if (worked)
-		{
-			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a])); // Create undo step
-			selection[a]->importMemChunk(wav);                                          // Load wav data
-			EntryType::detectEntryType(*selection[a]);                                  // Update entry type
-			selection[a]->setExtensionByType();                                         // Update extension if necessary
-		}
-		else
-		{
-			log::error(wxString::Format("Unable to convert entry %s: %s", selection[a]->name(), global::error));
-			errors = true;
-			continue;
-		}
-	}
-
-	// Finish recording undo level
+	auto converted = entryoperations::convertSounds(selection, "snd_wav", 0, undo_manager_);
 	undo_manager_->endRecord(true);
 
 	// Show message if errors occurred
-	if (errors)
+	if (converted < num_sound)
 		wxMessageBox("Some entries could not be converted, see console log for details", "SLADE", wxICON_INFORMATION);
 
 	return true;
@@ -2828,41 +2775,57 @@ bool ArchivePanel::compileACS(bool hexen) const
 }
 
 // -----------------------------------------------------------------------------
-// Compiles any selected text entries as ACS scripts
+// Optimizes any selected PNG entries, by recompressing them and then running
+// any external PNG optimizers that are set up
 // -----------------------------------------------------------------------------
 bool ArchivePanel::optimizePNG() const
 {
-	// Check if the PNG tools path are set up, at least one of them should be
-	wxString pngpathc = path_pngcrush;
-	wxString pngpatho = path_pngout;
-	wxString pngpathd = path_deflopt;
-	if ((pngpathc.IsEmpty() || !wxFileExists(pngpathc)) && (pngpatho.IsEmpty() || !wxFileExists(pngpatho))
-		&& (pngpathd.IsEmpty() || !wxFileExists(pngpathd)))
-	{
-		wxMessageBox(
-			"Error: PNG tool paths not defined or invalid, please configure in SLADE preferences",
-			"Error",
-			wxOK | wxCENTRE | wxICON_ERROR);
-		return false;
-	}
-
-	// Get selected entries
-	auto selection = entry_tree_->selectedEntries();
+	// Get selected PNG entries
+	vector<ArchiveEntry*> selection;
+	for (auto entry : entry_tree_->selectedEntries())
+		if (entry->type()->formatId() == "img_png")
+		{
+			entry->data(); // Load data before recompressing on worker threads
+			selection.push_back(entry);
+		}
 
-	ui::showSplash("Running external programs, please wait...", true);
+	ui::showSplash("Recompressing PNG data...", true);
 
 	// Begin recording undo level
 	undo_manager_->beginRecord("Optimize PNG");
 
-	// Go through selection
+	// Recompress all entries across worker threads
+	vector<MemChunk> recompressed(selection.size());
+	threadpool::parallelFor(selection.size(), [&](size_t index) {
+		recompressed[index].importMem(selection[index]->data());
+		if (!gfx::pngRecompress(recompressed[index]))
+			recompressed[index].clear();
+	});
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
-		ui::setSplashProgressMessage(selection[a]->nameNoExt());
-		ui::setSplashProgress(float(a) / float(selection.size()));
-		if (selection[a]->type()->formatId() == "img_png")
+		if (!recompressed[a].hasData())
+			continue;
+
+		undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a]));
+		selection[a]->importMemChunk(recompressed[a]);
+	}
+
+	// Check if the PNG tools path are set up
+	wxString pngpathc = path_pngcrush;
+	wxString pngpatho = path_pngout;
+	wxString pngpathd = path_deflopt;
+	if ((!pngpathc.IsEmpty() && wxFileExists(pngpathc)) || (!pngpatho.IsEmpty() && wxFileExists(pngpatho))
+		|| (!pngpathd.IsEmpty() && wxFileExists(pngpathd)))
+	{
+		ui::setSplashMessage("Running external programs, please wait...");
+
+		// Go through selection
+		for (unsigned a = 0; a < selection.size(); a++)
 		{
+			ui::setSplashProgressMessage(selection[a]->nameNoExt());
+			ui::setSplashProgress(float(a) / float(selection.size()));
 			undo_manager_->recordUndoStep(std::make_unique<EntryDataUS>(selection[a]));
-			entryoperations::optimizePNG(selection[a]);
+			entryoperations::optimizePNG(selection[a], false);
 		}
 	}
 	ui::hideSplash();
@@ -3322,6 +3285,10 @@ bool ArchivePanel::handleAction(string_view id)
 	else if (id == "arch_clean_iwaddupes")
 		archiveoperations::removeEntriesUnchangedFromIWAD(archive.get());
 
+	// Archive->Maintenance->Compare With Archive
+	else if (id == "arch_compare")
+		archiveoperations::compareWithArchive(archive.get());
+
 	// Archive->Maintenance->Replace in Maps
 	else if (id == "arch_replace_maps")
 	{
@@ -3559,6 +3526,7 @@ wxMenu* ArchivePanel::createMaintenanceMenu()
 	SAction::fromId("arch_clean_iwaddupes")->addToMenu(menu_clean);
 	SAction::fromId("arch_check_duplicates")->addToMenu(menu_clean);
 	SAction::fromId("arch_check_duplicates2")->addToMenu(menu_clean);
+	SAction::fromId("arch_compare")->addToMenu(menu_clean);
 	SAction::fromId("arch_replace_maps")->addToMenu(menu_clean);
 	return menu_clean;
 }
@@ -4235,9 +4203,9 @@ bool EntryDataUS::swapData()
 		if (!entry)
 			return false;
 
-		// Backup data
+		// Backup data (shared, so no copies are made)
 		MemChunk temp_data;
-		temp_data.importMem(entry->rawData(), entry->size());
+		temp_data.importShared(entry->data());
 		// log::info(1, "Backup current data, size %d", entry->getSize());
 
 		// Restore entry data
@@ -4254,7 +4222,7 @@ bool EntryDataUS::swapData()
 
 		// Store previous entry data
 		if (temp_data.size() > 0)
-			data_.importMem(temp_data.data(), temp_data.size());
+			data_.importShared(temp_data);
 		else
 			data_.clear();
 
@@ -177,7 +177,7 @@ class EntryDataUS : public UndoStep
 public:
 	EntryDataUS(ArchiveEntry* entry) : path_{ entry->path() }, index_{ entry->index() }, archive_{ entry->parent() }
 	{
-		data_.importMem(entry->rawData(), entry->size());
+		data_.importShared(entry->data());
 	}
 
 	bool swapData();
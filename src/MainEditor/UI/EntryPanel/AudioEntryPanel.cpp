@@ -32,7 +32,10 @@
 #include "Main.h"
 #include "AudioEntryPanel.h"
 #include "App.h"
+#include "Archive/EntryDataReader.h"
+#include "Audio/AudioCache.h"
 #include "Audio/AudioTags.h"
+#include "Audio/EntryStream.h"
 #include "Audio/MIDIPlayer.h"
 #include "Audio/ModMusic.h"
 #include "Audio/Mp3Music.h"
@@ -40,6 +43,7 @@
 #include "UI/Controls/SIconButton.h"
 #include "UI/WxUtils.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -54,6 +58,30 @@ using namespace slade;
 CVAR(Int, snd_volume, 100, CVar::Flag::Save)
 CVAR(Bool, snd_autoplay, false, CVar::Flag::Save)
 
+namespace
+{
+// Max amount of a streamed entry's data to read for its info (tags)
+constexpr unsigned STREAM_INFO_SIZE = 1024 * 1024;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if entries of [format] are played by streaming their data
+// (rather than being decoded before playback)
+// -----------------------------------------------------------------------------
+bool isStreamedFormat(string_view format)
+{
+	return format == "snd_mp3" || format == "snd_ogg" || format == "snd_flac" || strutil::startsWith(format, "mod_");
+}
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -79,28 +107,33 @@ AudioEntryPanel::AudioEntryPanel(wxWindow* parent) :
 	sizer_main_->Add(sizer_gb, 0, wxALIGN_CENTER);
 	sizer_main_->AddStretchSpacer();
 
+	// Add waveform display
+	pnl_waveform_ = new wxPanel(this, -1, wxDefaultPosition, { -1, ui::scalePx(64) });
+	pnl_waveform_->SetBackgroundStyle(wxBG_STYLE_PAINT);
+	sizer_gb->Add(pnl_waveform_, wxGBPosition(0, 0), wxGBSpan(1, 9), wxEXPAND);
+
 	// Add seekbar
 	slider_seek_ = new wxSlider(this, -1, 0, 0, 100);
-	sizer_gb->Add(slider_seek_, wxGBPosition(0, 0), wxGBSpan(1, 9), wxEXPAND);
+	sizer_gb->Add(slider_seek_, wxGBPosition(1, 0), wxGBSpan(1, 9), wxEXPAND);
 
 	// Add play controls
 	btn_play_ = new SIconButton(this, "play", "", 24);
-	sizer_gb->Add(btn_play_, wxGBPosition(1, 0));
+	sizer_gb->Add(btn_play_, wxGBPosition(2, 0));
 	btn_pause_ = new SIconButton(this, "pause", "", 24);
-	sizer_gb->Add(btn_pause_, wxGBPosition(1, 1));
+	sizer_gb->Add(btn_pause_, wxGBPosition(2, 1));
 	btn_stop_ = new SIconButton(this, "stop", "", 24);
-	sizer_gb->Add(btn_stop_, wxGBPosition(1, 2));
+	sizer_gb->Add(btn_stop_, wxGBPosition(2, 2));
 	btn_prev_ = new SIconButton(this, "prev", "", 24);
-	sizer_gb->Add(btn_prev_, wxGBPosition(1, 3));
+	sizer_gb->Add(btn_prev_, wxGBPosition(2, 3));
 	btn_next_ = new SIconButton(this, "next", "", 24);
-	sizer_gb->Add(btn_next_, wxGBPosition(1, 4));
+	sizer_gb->Add(btn_next_, wxGBPosition(2, 4));
 
 	// Separator
-	sizer_gb->Add(new wxStaticLine(this), { 2, 0 }, { 1, 9 }, wxEXPAND | wxTOP | wxBOTTOM, ui::pad());
+	sizer_gb->Add(new wxStaticLine(this), { 3, 0 }, { 1, 9 }, wxEXPAND | wxTOP | wxBOTTOM, ui::pad());
 
 	// Add title
 	txt_title_ = new wxStaticText(this, -1, wxEmptyString);
-	sizer_gb->Add(txt_title_, wxGBPosition(3, 0), wxGBSpan(1, 9));
+	sizer_gb->Add(txt_title_, wxGBPosition(4, 0), wxGBSpan(1, 9));
 
 	// Add info
 	txt_info_ = new wxTextCtrl(
@@ -110,24 +143,24 @@ AudioEntryPanel::AudioEntryPanel(wxWindow* parent) :
 		wxDefaultPosition,
 		{ -1, ui::scalePx(200) },
 		wxTE_MULTILINE | wxTE_READONLY | wxTE_BESTWRAP);
-	sizer_gb->Add(txt_info_, wxGBPosition(4, 0), wxGBSpan(1, 9), wxEXPAND | wxHORIZONTAL);
+	sizer_gb->Add(txt_info_, wxGBPosition(5, 0), wxGBSpan(1, 9), wxEXPAND | wxHORIZONTAL);
 
 	// Add track number
 	txt_track_ = new wxStaticText(this, -1, "1/1");
-	sizer_gb->Add(txt_track_, wxGBPosition(1, 5), wxDefaultSpan, wxALIGN_CENTER);
+	sizer_gb->Add(txt_track_, wxGBPosition(2, 5), wxDefaultSpan, wxALIGN_CENTER);
 
 	// Separator
 	sizer_gb->Add(
 		new wxStaticLine(this, -1, wxDefaultPosition, wxDefaultSize, wxLI_VERTICAL),
-		wxGBPosition(1, 6),
+		wxGBPosition(2, 6),
 		wxDefaultSpan,
 		wxEXPAND);
 
 	// Add volume slider
-	sizer_gb->Add(new wxStaticText(this, -1, "Volume:"), wxGBPosition(1, 7), wxDefaultSpan, wxALIGN_CENTER_VERTICAL);
+	sizer_gb->Add(new wxStaticText(this, -1, "Volume:"), wxGBPosition(2, 7), wxDefaultSpan, wxALIGN_CENTER_VERTICAL);
 	slider_volume_ = new wxSlider(this, -1, 0, 0, 100, wxDefaultPosition, wxSize(ui::scalePx(128), -1));
 	slider_volume_->SetValue(snd_volume);
-	sizer_gb->Add(slider_volume_, wxGBPosition(1, 8), { 1, 1 }, wxALIGN_CENTER_VERTICAL);
+	sizer_gb->Add(slider_volume_, wxGBPosition(2, 8), { 1, 1 }, wxALIGN_CENTER_VERTICAL);
 
 	// Set volume
 	sound_->setVolume(snd_volume);
@@ -150,6 +183,7 @@ AudioEntryPanel::AudioEntryPanel(wxWindow* parent) :
 	slider_seek_->Bind(wxEVT_SLIDER, &AudioEntryPanel::onSliderSeekChanged, this);
 	slider_volume_->Bind(wxEVT_SLIDER, &AudioEntryPanel::onSliderVolumeChanged, this);
 	Bind(wxEVT_TIMER, &AudioEntryPanel::onTimer, this);
+	pnl_waveform_->Bind(wxEVT_PAINT, &AudioEntryPanel::onWaveformPaint, this);
 
 	wxWindowBase::Layout();
 }
@@ -162,6 +196,9 @@ AudioEntryPanel::~AudioEntryPanel()
 	// Stop the timer to avoid crashes
 	timer_seek_->Stop();
 	resetStream();
+
+	if (decode_job_)
+		decode_job_->cancel();
 }
 
 // -----------------------------------------------------------------------------
@@ -176,10 +213,16 @@ bool AudioEntryPanel::loadEntry(ArchiveEntry* entry)
 	if (entry_.lock().get() == entry)
 		return true;
 
-	// Stop anything currently playing
+	// Stop anything currently playing (or being decoded)
 	stopStream();
 	resetStream();
-	opened_ = false;
+	opened_       = false;
+	play_on_open_ = false;
+	if (decode_job_)
+		decode_job_->cancel();
+	decode_job_.reset();
+	decoded_.reset();
+	pnl_waveform_->Refresh();
 
 	// Enable all playback controls initially
 	slider_seek_->Enable();
@@ -252,12 +295,14 @@ void AudioEntryPanel::setAudioDuration(int duration)
 }
 
 // -----------------------------------------------------------------------------
-// Opens the current entry and performs the appropriate conversions
+// Opens the current entry, converting it to a playable format if necessary.
+// Conversion is done in the background (or skipped if the entry was
+// previously converted), the entry is opened for playback when it's done
 // -----------------------------------------------------------------------------
 bool AudioEntryPanel::open(ArchiveEntry* entry)
 {
-	// Check if already opened
-	if (opened_)
+	// Check if already opened (or being opened)
+	if (opened_ || decode_job_)
 		return true;
 
 	// Stop if sound currently playing
@@ -266,63 +311,67 @@ bool AudioEntryPanel::open(ArchiveEntry* entry)
 	subsong_    = 0;
 	num_tracks_ = 1;
 
-	// Get entry data
-	auto& mcdata = entry->data();
-
-	// Setup temp filename
-	wxFileName path(app::path(entry->name(), app::Dir::Temp));
-	// Add extension if missing
-	if (path.GetExt().IsEmpty())
-		path.SetExt(entry->type()->extension());
-
-	// Convert if necessary, then write to file
-	data_.clear();
-	if (entry->type()->formatId() == "snd_doom" || // Doom Sound -> WAV
-		entry->type()->formatId() == "snd_doom_mac")
-		conversion::doomSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_speaker") // Doom PC Speaker Sound -> WAV
-		conversion::spkSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_audiot") // AudioT PC Speaker Sound -> WAV
-		conversion::spkSndToWav(mcdata, data_, true);
-	else if (entry->type()->formatId() == "snd_wolf") // Wolfenstein 3D Sound -> WAV
-		conversion::wolfSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_voc") // Creative Voice File -> WAV
-		conversion::vocToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_jaguar") // Jaguar Doom Sound -> WAV
-		conversion::jagSndToWav(mcdata, data_);
-	else if (entry->type()->formatId() == "snd_bloodsfx") // Blood Sound -> WAV
-		conversion::bloodToWav(entry, data_);
-	else if (entry->type()->formatId() == "midi_mus") // MUS -> MIDI
-	{
-		conversion::musToMidi(mcdata, data_);
-		path.SetExt("mid");
-	}
-	else if (
-		entry->type()->formatId() == "midi_xmi" || // HMI/HMP/XMI -> MIDI
-		entry->type()->formatId() == "midi_hmi" || entry->type()->formatId() == "midi_hmp")
+	// Compressed music is streamed so playback can start immediately
+	if (isStreamedFormat(entry->type()->formatId()))
 	{
-		conversion::zmusToMidi(mcdata, data_, 0, &num_tracks_);
-		path.SetExt("mid");
+		openStreamed(*entry);
+		return true;
 	}
-	else if (entry->type()->formatId() == "midi_gmid") // GMID -> MIDI
+
+	// Use the previously converted audio if possible
+	if (auto decoded = audio::audiocache::get(*entry))
 	{
-		conversion::gmidToMidi(mcdata, data_);
-		path.SetExt("mid");
+		openDecoded(*entry, decoded);
+		return true;
 	}
-	else
-		data_.importMem(mcdata.data(), mcdata.size());
 
-	// MIDI format
-	if (strutil::startsWith(entry->type()->formatId(), "midi_"))
-		openMidi(data_, path.GetFullPath());
+	// Disable play controls until the audio is converted
+	txt_title_->SetLabel(entry->path(true));
+	txt_info_->SetValue("Decoding...");
+	btn_play_->Disable();
+	btn_pause_->Disable();
+	btn_stop_->Disable();
+	btn_prev_->Disable();
+	btn_next_->Disable();
+	slider_seek_->Disable();
+
+	// Convert in the background
+	auto on_decoded = [this, entry = entry->getShared()](const shared_ptr<audio::DecodedAudio>& decoded) {
+		decode_job_.reset();
+		if (decoded && entry_.lock() == entry)
+		{
+			btn_play_->Enable();
+			btn_pause_->Enable();
+			btn_stop_->Enable();
+			btn_prev_->Enable();
+			btn_next_->Enable();
+			openDecoded(*entry, decoded);
+		}
+	};
+	decode_job_ = audio::audiocache::decode(*entry, on_decoded);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Opens the [decoded] audio of [entry] for playback
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::openDecoded(ArchiveEntry& entry, const shared_ptr<audio::DecodedAudio>& decoded)
+{
+	decoded_    = decoded;
+	num_tracks_ = decoded->num_tracks;
+	data_.importShared(decoded->data);
 
-	// MOD format
-	else if (strutil::startsWith(entry->type()->formatId(), "mod_"))
-		openMod(data_);
+	// Setup temp filename
+	wxFileName path(app::path(entry.name(), app::Dir::Temp));
+	if (!decoded->extension.empty())
+		path.SetExt(decoded->extension);
+	else if (path.GetExt().IsEmpty()) // Add extension if missing
+		path.SetExt(entry.type()->extension());
 
-	// Mp3 format
-	else if (strutil::startsWith(entry->type()->formatId(), "snd_mp3"))
-		openMp3(data_);
+	// MIDI format
+	if (strutil::startsWith(entry.type()->formatId(), "midi_"))
+		openMidi(data_, path.GetFullPath());
 
 	// Other format
 	else
@@ -331,9 +380,48 @@ bool AudioEntryPanel::open(ArchiveEntry* entry)
 	// Keep filename so we can delete it later
 	prevfile_ = path.GetFullPath();
 
-	txt_title_->SetLabel(entry->path(true));
+	onOpened(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Opens [entry] for playback by streaming its data to the decoder as it is
+// played. If the entry's data isn't loaded it is read directly from its
+// archive, otherwise it is shared (not copied) with the entry
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::openStreamed(ArchiveEntry& entry)
+{
+	unique_ptr<EntryDataReader> reader;
+	if (entry.isLoaded())
+	{
+		data_.importShared(entry.data());
+		reader = std::make_unique<MemDataReader>(data_);
+	}
+	else
+	{
+		data_.clear();
+		reader = entry.dataReader();
+	}
+
+	auto format = entry.type()->formatId();
+	if (strutil::startsWith(format, "mod_"))
+		openMod(std::move(reader));
+	else if (format == "snd_mp3")
+		openMp3(std::move(reader));
+	else
+		openMusicStream(std::move(reader));
+
+	onOpened(entry);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the panel after [entry] has been opened for playback
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::onOpened(ArchiveEntry& entry)
+{
+	txt_title_->SetLabel(entry.path(true));
 	txt_track_->SetLabel(wxString::Format("%d/%d", subsong_ + 1, num_tracks_));
-	updateInfo(*entry);
+	updateInfo(entry);
+	pnl_waveform_->Refresh();
 
 	// Disable prev/next track buttons if only one track is available
 	if (num_tracks_ < 2)
@@ -343,7 +431,15 @@ bool AudioEntryPanel::open(ArchiveEntry* entry)
 	}
 
 	opened_ = true;
-	return true;
+	updateStatus();
+
+	// Start playing if it was requested while decoding
+	if (play_on_open_)
+	{
+		play_on_open_ = false;
+		startStream();
+		timer_seek_->Start(10);
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -404,6 +500,38 @@ bool AudioEntryPanel::openAudio(MemChunk& audio, const wxString& filename)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Opens audio from [reader] for streamed playback via sf::Music
+// -----------------------------------------------------------------------------
+bool AudioEntryPanel::openMusicStream(unique_ptr<EntryDataReader> reader)
+{
+	// The stream must exist while the music is open, so keep the previous one
+	// until the music has been switched to the new one
+	auto stream = std::make_unique<audio::EntryInputStream>(std::move(reader));
+	if (music_->openFromStream(*stream))
+	{
+		music_stream_ = std::move(stream);
+		audio_type_   = Music;
+
+		// Enable play controls
+		setAudioDuration(music_->getDuration().asMilliseconds());
+		btn_play_->Enable();
+		btn_pause_->Enable();
+		btn_stop_->Enable();
+
+		return true;
+	}
+
+	// Unable to open audio, disable play controls
+	audio_type_ = Invalid;
+	setAudioDuration(0);
+	btn_play_->Enable(false);
+	btn_pause_->Enable(false);
+	btn_stop_->Enable(false);
+
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Opens a MIDI file for playback
 // -----------------------------------------------------------------------------
@@ -437,10 +565,10 @@ bool AudioEntryPanel::openMidi(MemChunk& data, const wxString& filename)
 // -----------------------------------------------------------------------------
 // Opens a Module file for playback
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::openMod(MemChunk& data)
+bool AudioEntryPanel::openMod(unique_ptr<EntryDataReader> reader)
 {
 	// Attempt to load the mod
-	if (mod_->loadFromMemory(data.data(), data.size()))
+	if (mod_->openFromReader(std::move(reader)))
 	{
 		audio_type_ = Mod;
 
@@ -469,10 +597,10 @@ bool AudioEntryPanel::openMod(MemChunk& data)
 // -----------------------------------------------------------------------------
 // Opens an mp3 file for playback
 // -----------------------------------------------------------------------------
-bool AudioEntryPanel::openMp3(MemChunk& data)
+bool AudioEntryPanel::openMp3(unique_ptr<EntryDataReader> reader)
 {
-	// Attempt to load the mp3
-	if (mp3_->loadFromMemory(data.data(), data.size()))
+	// Attempt to load the mp3 (it is decoded as it is played)
+	if (mp3_->openFromReader(std::move(reader)))
 	{
 		audio_type_ = Mp3;
 
@@ -506,6 +634,13 @@ void AudioEntryPanel::startStream()
 	if (!opened_ && entry_.lock())
 		open(entry_.lock().get());
 
+	// Play once decoded if the audio is still being converted
+	if (!opened_)
+	{
+		play_on_open_ = true;
+		return;
+	}
+
 	switch (audio_type_)
 	{
 	case Sound: sound_->play(); break;
@@ -556,8 +691,18 @@ bool AudioEntryPanel::updateInfo(ArchiveEntry& entry) const
 {
 	txt_info_->Clear();
 
+	// Only read the start of streamed entries that aren't loaded, which is
+	// where the tags are for streamed formats
+	MemChunk header;
+	if (!entry.isLoaded() && isStreamedFormat(entry.type()->formatId()))
+	{
+		auto reader = entry.dataReader();
+		header.reSize(std::min(reader->size(), STREAM_INFO_SIZE), false);
+		reader->read(header.data(), header.size());
+	}
+
 	wxString info = entry.typeString() + "\n";
-	auto&    mc   = entry.data();
+	auto&    mc   = header.hasData() ? header : entry.data();
 	switch (audio_type_)
 	{
 	case Sound:
@@ -735,6 +880,8 @@ void AudioEntryPanel::onTimer(wxTimerEvent& e)
 
 	// Set slider
 	slider_seek_->SetValue(pos);
+	if (decoded_ && !decoded_->waveform.empty())
+		pnl_waveform_->Refresh();
 
 	// Stop the timer if playback has reached the end
 	if (pos >= slider_seek_->GetMax() || (audio_type_ == Sound && sound_->getStatus() == sf::Sound::Stopped)
@@ -781,3 +928,37 @@ void AudioEntryPanel::onSliderVolumeChanged(wxCommandEvent& e)
 	default: break;
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Called when the waveform display needs to be drawn
+// -----------------------------------------------------------------------------
+void AudioEntryPanel::onWaveformPaint(wxPaintEvent& e)
+{
+	wxPaintDC dc(pnl_waveform_);
+
+	// Draw background
+	dc.SetBackground(wxBrush(GetBackgroundColour()));
+	dc.Clear();
+
+	if (!decoded_ || decoded_->waveform.empty())
+		return;
+
+	// Draw waveform (min-max line for each pixel column)
+	auto& waveform = decoded_->waveform;
+	auto  size     = pnl_waveform_->GetClientSize();
+	int   mid      = size.y / 2;
+	dc.SetPen(wxPen(wxSystemSettings::GetColour(wxSYS_COLOUR_HIGHLIGHT)));
+	for (int x = 0; x < size.x; ++x)
+	{
+		const auto& peak = waveform[static_cast<size_t>(x) * waveform.size() / size.x];
+		dc.DrawLine(x, mid - peak.max * mid, x, mid - peak.min * mid + 1);
+	}
+
+	// Draw playback position
+	if (slider_seek_->GetMax() > 0)
+	{
+		int pos = static_cast<int64_t>(slider_seek_->GetValue()) * size.x / slider_seek_->GetMax();
+		dc.SetPen(wxPen(wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOWTEXT)));
+		dc.DrawLine(pos, 0, pos, size.y);
+	}
+}
@@ -3,10 +3,17 @@
 #include "EntryPanel.h"
 
 // Forward declarations
+namespace slade
+{
+class EntryDataReader;
+class Job;
+} // namespace slade
 namespace slade::audio
 {
+class EntryInputStream;
 class ModMusic;
 class Mp3Music;
+struct DecodedAudio;
 } // namespace slade::audio
 namespace sf
 {
@@ -43,13 +50,17 @@ private:
 	};
 
 	wxString  prevfile_;
-	AudioType audio_type_  = Invalid;
-	int       num_tracks_  = 1;
-	int       subsong_     = 0;
-	int       song_length_ = 0;
-	bool      opened_      = false;
+	AudioType audio_type_   = Invalid;
+	int       num_tracks_   = 1;
+	int       subsong_      = 0;
+	int       song_length_  = 0;
+	bool      opened_       = false;
+	bool      play_on_open_ = false; // Start playback when the audio has been decoded
 	MemChunk  data_;
 
+	shared_ptr<Job>                 decode_job_;
+	shared_ptr<audio::DecodedAudio> decoded_;
+
 	wxBitmapButton* btn_play_      = nullptr;
 	wxBitmapButton* btn_pause_     = nullptr;
 	wxBitmapButton* btn_stop_      = nullptr;
@@ -61,18 +72,24 @@ private:
 	wxStaticText*   txt_title_     = nullptr;
 	wxStaticText*   txt_track_     = nullptr;
 	wxTextCtrl*     txt_info_      = nullptr;
+	wxPanel*        pnl_waveform_  = nullptr;
 
-	unique_ptr<sf::SoundBuffer> sound_buffer_;
-	unique_ptr<sf::Sound>       sound_;
-	unique_ptr<sf::Music>       music_;
-	unique_ptr<audio::ModMusic> mod_;
-	unique_ptr<audio::Mp3Music> mp3_;
+	unique_ptr<audio::EntryInputStream> music_stream_; // Declared before music_ so it's destroyed after
+	unique_ptr<sf::SoundBuffer>         sound_buffer_;
+	unique_ptr<sf::Sound>               sound_;
+	unique_ptr<sf::Music>               music_;
+	unique_ptr<audio::ModMusic>         mod_;
+	unique_ptr<audio::Mp3Music>         mp3_;
 
 	bool open(ArchiveEntry* entry);
+	void openDecoded(ArchiveEntry& entry, const shared_ptr<audio::DecodedAudio>& decoded);
+	void openStreamed(ArchiveEntry& entry);
+	void onOpened(ArchiveEntry& entry);
 	bool openAudio(MemChunk& audio, const wxString& filename);
+	bool openMusicStream(unique_ptr<EntryDataReader> reader);
 	bool openMidi(MemChunk& data, const wxString& filename);
-	bool openMod(MemChunk& data);
-	bool openMp3(MemChunk& data);
+	bool openMod(unique_ptr<EntryDataReader> reader);
+	bool openMp3(unique_ptr<EntryDataReader> reader);
 	bool updateInfo(ArchiveEntry& entry) const;
 	void startStream();
 	void stopStream() const;
@@ -87,5 +104,6 @@ private:
 	void onTimer(wxTimerEvent& e);
 	void onSliderSeekChanged(wxCommandEvent& e);
 	void onSliderVolumeChanged(wxCommandEvent& e);
+	void onWaveformPaint(wxPaintEvent& e);
 };
 } // namespace slade
@@ -39,6 +39,44 @@
 
 using namespace slade;
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Reads a [T] value at [offset] in [mc] into [value].
+// Returns false if it is out of bounds
+// -----------------------------------------------------------------------------
+template<typename T> bool readValue(const MemChunk& mc, unsigned offset, int64_t& value)
+{
+	T val;
+	if (!mc.read(offset, &val, sizeof(T)))
+		return false;
+
+	value = val;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads a [size]-byte integer at [offset] in [mc] into [value].
+// Returns false if [size] is invalid or the value is out of bounds
+// -----------------------------------------------------------------------------
+bool readInt(const MemChunk& mc, unsigned offset, unsigned size, bool is_signed, int64_t& value)
+{
+	switch (size)
+	{
+	case 1: return is_signed ? readValue<int8_t>(mc, offset, value) : readValue<uint8_t>(mc, offset, value);
+	case 2: return is_signed ? readValue<int16_t>(mc, offset, value) : readValue<uint16_t>(mc, offset, value);
+	case 4: return is_signed ? readValue<int32_t>(mc, offset, value) : readValue<uint32_t>(mc, offset, value);
+	case 8: return is_signed ? readValue<int64_t>(mc, offset, value) : readValue<uint64_t>(mc, offset, value);
+	default: return false;
+	}
+}
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -48,14 +86,11 @@ using namespace slade;
 
 
 // -----------------------------------------------------------------------------
-// Returns the number of rows contained in the data
+// Returns the number of rows currently shown in the grid
 // -----------------------------------------------------------------------------
 int DataEntryTable::GetNumberRows()
 {
-	if (row_stride_ == 0)
-		return 0;
-	else
-		return ((data_stop_ ? data_stop_ : data_.size()) - data_start_) / row_stride_;
+	return indexed_ ? index_.size() : numDataRows();
 }
 
 // -----------------------------------------------------------------------------
@@ -71,119 +106,7 @@ int DataEntryTable::GetNumberCols()
 // -----------------------------------------------------------------------------
 wxString DataEntryTable::GetValue(int row, int col)
 {
-	if (!data_.seek(data_start_ + ((row * row_stride_) + columns_[col].row_offset), 0))
-		return "INVALID";
-
-	// Signed integer column
-	if (columns_[col].type == ColType::IntSigned)
-	{
-		if (columns_[col].size == 1)
-		{
-			int8_t val;
-			data_.read(&val, 1);
-			return wxString::Format("%d", val);
-		}
-		else if (columns_[col].size == 2)
-		{
-			int16_t val;
-			data_.read(&val, 2);
-			return wxString::Format("%d", val);
-		}
-		else if (columns_[col].size == 4)
-		{
-			int32_t val;
-			data_.read(&val, 4);
-			return wxString::Format("%d", val);
-		}
-		else if (columns_[col].size == 8)
-		{
-			int64_t val;
-			data_.read(&val, 8);
-			return wxString::Format("%d", val);
-		}
-		return "INVALID SIZE";
-	}
-
-	// Unsigned integer column
-	else if (columns_[col].type == ColType::IntUnsigned)
-	{
-		if (columns_[col].size == 1)
-		{
-			uint8_t val;
-			data_.read(&val, 1);
-			return wxString::Format("%d", val);
-		}
-		else if (columns_[col].size == 2)
-		{
-			uint16_t val;
-			data_.read(&val, 2);
-			return wxString::Format("%d", val);
-		}
-		else if (columns_[col].size == 4)
-		{
-			uint32_t val;
-			data_.read(&val, 4);
-			return wxString::Format("%d", val);
-		}
-		else if (columns_[col].size == 8)
-		{
-			uint64_t val;
-			data_.read(&val, 8);
-			return wxString::Format("%d", val);
-		}
-		return "INVALID SIZE";
-	}
-
-	// Fixed-point float column
-	else if (columns_[col].type == ColType::Fixed)
-	{
-		if (columns_[col].size == 4)
-		{
-			int32_t val;
-			data_.read(&val, 4);
-			return wxString::Format("%1.3f", (double)val / 65536.0);
-		}
-		return "INVALID SIZE";
-	}
-
-	// String column
-	else if (columns_[col].type == ColType::String)
-	{
-		return wxString::FromAscii(data_.data() + data_.currentPos(), columns_[col].size);
-	}
-
-	// Custom value column
-	else if (columns_[col].type == ColType::CustomValue)
-	{
-		int value = 0;
-		if (columns_[col].size == 1)
-		{
-			int8_t val;
-			data_.read(&val, 1);
-			value = val;
-		}
-		else if (columns_[col].size == 2)
-		{
-			int16_t val;
-			data_.read(&val, 2);
-			value = val;
-		}
-		else if (columns_[col].size == 4)
-		{
-			int32_t val;
-			data_.read(&val, 4);
-			value = val;
-		}
-		else if (columns_[col].size == 8)
-		{
-			int64_t val;
-			data_.read(&val, 8);
-			value = val;
-		}
-		return wxString::Format("%d: %s", value, columns_[col].customValue(value));
-	}
-
-	return "UNKNOWN TYPE";
+	return cellValue(dataRow(row), col);
 }
 
 // -----------------------------------------------------------------------------
@@ -192,7 +115,8 @@ wxString DataEntryTable::GetValue(int row, int col)
 void DataEntryTable::SetValue(int row, int col, const wxString& value)
 {
 	// Seek to data position
-	if (!data_.seek(data_start_ + (row * row_stride_) + columns_[col].row_offset, 0))
+	auto data_row = dataRow(row);
+	if (!data_.seek(data_start_ + (data_row * row_stride_) + columns_[col].row_offset, 0))
 		return;
 
 	// Signed integer or custom value column
@@ -264,17 +188,9 @@ void DataEntryTable::SetValue(int row, int col, const wxString& value)
 	}
 
 	// Set cell to modified colour
-	bool set = true;
-	for (auto& cell : cells_modified_)
-	{
-		if (cell.x == row && cell.y == col)
-		{
-			set = false;
-			break;
-		}
-	}
-	if (set)
-		cells_modified_.emplace_back(row, col);
+	// (the sort/filter index isn't updated here, so the row doesn't jump away
+	// from the cursor while it is being edited)
+	cells_modified_.emplace(data_row, col);
 
 	// Set entry modified
 	parent_->setDataModified(true);
@@ -296,7 +212,7 @@ wxString DataEntryTable::GetColLabelValue(int col)
 // -----------------------------------------------------------------------------
 wxString DataEntryTable::GetRowLabelValue(int row)
 {
-	return row_prefix_ + wxString::Format("%d", row_first_ + row);
+	return row_prefix_ + wxString::Format("%d", row_first_ + dataRow(row));
 }
 
 // -----------------------------------------------------------------------------
@@ -304,42 +220,10 @@ wxString DataEntryTable::GetRowLabelValue(int row)
 // -----------------------------------------------------------------------------
 bool DataEntryTable::DeleteRows(size_t pos, size_t num)
 {
-	// Copy existing data
-	MemChunk copy;
-	copy.write(data_.data(), data_.size());
-
-	// Write new data (excluding deleted rows)
-	unsigned start = data_start_ + (row_stride_ * pos);
-	unsigned end   = data_start_ + (row_stride_ * (pos + num));
-	data_.clear();
-	data_.write(copy.data(), start);
-	data_.write(copy.data() + end, copy.size() - end);
-
-	// Update new rows
-	vector<int> new_rows_new;
-	for (int a : rows_new_)
-	{
-		if ((unsigned)a >= pos + num)
-			new_rows_new.push_back(a - num);
-		else if ((unsigned)a < pos)
-			new_rows_new.push_back(a);
-	}
-	rows_new_ = new_rows_new;
-
-	// Update modified cells
-	vector<Vec2i> new_cells_modified;
-	for (auto& cell : cells_modified_)
-	{
-		if ((unsigned)cell.x >= pos + num)
-			new_cells_modified.emplace_back(cell.x - (int)num, cell.y);
-		else if ((unsigned)cell.x < pos)
-			new_cells_modified.emplace_back(cell.x, cell.y);
-	}
-	cells_modified_ = new_cells_modified;
-
-	// Send message to grid
-	wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_DELETED, pos, num);
-	GetView()->ProcessTableMessage(msg);
+	vector<int> rows;
+	for (size_t a = 0; a < num; a++)
+		rows.push_back(pos + a);
+	deleteRows(rows);
 
 	return true;
 }
@@ -349,38 +233,7 @@ bool DataEntryTable::DeleteRows(size_t pos, size_t num)
 // -----------------------------------------------------------------------------
 bool DataEntryTable::InsertRows(size_t pos, size_t num)
 {
-	// Copy existing data
-	MemChunk copy;
-	copy.write(data_.data(), data_.size());
-
-	// Write leading rows
-	unsigned start = data_start_ + (row_stride_ * pos);
-	data_.clear();
-	data_.write(copy.data(), start);
-
-	// Write new (blank) rows
-	vector<uint8_t> temp(row_stride_ * num, 0);
-	data_.write(temp.data(), row_stride_ * num);
-
-	// Write ending rows
-	data_.write(copy.data() + start, copy.size() - start);
-
-	// Update new rows
-	for (int& row : rows_new_)
-		if ((unsigned)row >= pos)
-			row += num;
-	for (unsigned a = 0; a < num; a++)
-		rows_new_.push_back(pos + a);
-
-	// Update modified cells
-	for (auto& cell : cells_modified_)
-		if (cell.x >= (int)pos)
-			cell.x += num;
-
-	// Send message to grid
-	wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_INSERTED, pos, num);
-	GetView()->ProcessTableMessage(msg);
-
+	insertRows(pos, nullptr, num);
 	return true;
 }
 
@@ -389,34 +242,22 @@ bool DataEntryTable::InsertRows(size_t pos, size_t num)
 // -----------------------------------------------------------------------------
 wxGridCellAttr* DataEntryTable::GetAttr(int row, int col, wxGridCellAttr::wxAttrKind kind)
 {
-	auto attr = new wxGridCellAttr();
-
-	// Check if cell is part of a new row
-	bool new_row = false;
-	for (int i : rows_new_)
+	// Only new rows and modified cells need special attributes
+	auto data_row = dataRow(row);
+	if (rows_new_.count(data_row) > 0)
 	{
-		if (i == row)
-		{
-			attr->SetTextColour(colourconfig::colour("new").toWx());
-			new_row = true;
-			break;
-		}
+		auto attr = new wxGridCellAttr();
+		attr->SetTextColour(colourconfig::colour("new").toWx());
+		return attr;
 	}
-
-	// Check if cell is modified
-	if (!new_row)
+	if (cells_modified_.count({ data_row, col }) > 0)
 	{
-		for (auto& cell : cells_modified_)
-		{
-			if (cell.x == row && cell.y == col)
-			{
-				attr->SetTextColour(colourconfig::colour("modified").toWx());
-				break;
-			}
-		}
+		auto attr = new wxGridCellAttr();
+		attr->SetTextColour(colourconfig::colour("modified").toWx());
+		return attr;
 	}
 
-	return attr;
+	return nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -435,12 +276,17 @@ bool DataEntryTable::setupDataStructure(ArchiveEntry* entry)
 	data_stop_  = 0;
 	row_first_  = 0;
 	row_prefix_ = "";
+	indexed_    = false;
+	index_.clear();
+	sort_col_       = -1;
+	sort_ascending_ = true;
+	filter_.clear();
 
 	if (!entry)
 		return true;
 
-	// Load entry data
-	data_.write(entry->rawData(), entry->size());
+	// Share entry data (it is only copied if modified)
+	data_.importShared(entry->data());
 
 	// Setup columns
 	auto type = entry->type()->id();
@@ -812,7 +658,10 @@ void DataEntryTable::copyRows(int row, int num, bool add)
 	if (!add)
 		data_clipboard_.clear();
 
-	data_clipboard_.write(data_.data() + data_start_ + (row * row_stride_), num * row_stride_);
+	const auto& data  = data_;
+	int         count = GetNumberRows();
+	for (int a = row; a < row + num && a < count; a++)
+		data_clipboard_.write(data.data() + data_start_ + (dataRow(a) * row_stride_), row_stride_);
 }
 
 // -----------------------------------------------------------------------------
@@ -824,34 +673,288 @@ void DataEntryTable::pasteRows(int row)
 	if (data_clipboard_.size() == 0)
 		return;
 
-	// Copy existing data
-	MemChunk copy;
-	copy.write(data_.data(), data_.size());
+	insertRows(row, data_clipboard_.data(), data_clipboard_.size() / row_stride_);
+}
 
-	// Write leading rows
-	unsigned start = data_start_ + (row_stride_ * row);
-	data_.clear();
-	data_.write(copy.data(), start);
+// -----------------------------------------------------------------------------
+// Deletes the given grid [rows] (in any order)
+// -----------------------------------------------------------------------------
+void DataEntryTable::deleteRows(vector<int> rows)
+{
+	// Get the data rows to delete, in order
+	vector<unsigned> deleted;
+	int              count = GetNumberRows();
+	for (int row : rows)
+		if (row >= 0 && row < count)
+			deleted.push_back(dataRow(row));
+	std::sort(deleted.begin(), deleted.end());
+	deleted.erase(std::unique(deleted.begin(), deleted.end()), deleted.end());
+	if (deleted.empty())
+		return;
+
+	// Move the remaining rows down over the deleted ones, in a single pass
+	auto     data      = data_.data();
+	auto     data_rows = numDataRows();
+	unsigned dest      = deleted[0];
+	for (unsigned a = 0; a < deleted.size(); a++)
+	{
+		unsigned next = a + 1 < deleted.size() ? deleted[a + 1] : data_rows;
+		unsigned keep = next - deleted[a] - 1;
+		memmove(
+			data + data_start_ + (dest * row_stride_),
+			data + data_start_ + ((deleted[a] + 1) * row_stride_),
+			keep * row_stride_);
+		dest += keep;
+	}
+
+	// Move any data following the rows and shrink
+	unsigned rows_end = data_start_ + (data_rows * row_stride_);
+	unsigned removed  = deleted.size() * row_stride_;
+	memmove(data + rows_end - removed, data + rows_end, data_.size() - rows_end);
+	if (data_.size() > removed)
+		data_.reSize(data_.size() - removed);
+	else
+		data_.clear();
+	if (data_stop_)
+		data_stop_ -= removed;
+
+	// Update new rows and modified cells
+	auto shifted = [&deleted](unsigned data_row)
+	{ return data_row - (std::lower_bound(deleted.begin(), deleted.end(), data_row) - deleted.begin()); };
+	auto is_deleted = [&deleted](unsigned data_row)
+	{ return std::binary_search(deleted.begin(), deleted.end(), data_row); };
+	std::set<unsigned> rows_new;
+	for (auto data_row : rows_new_)
+		if (!is_deleted(data_row))
+			rows_new.insert(shifted(data_row));
+	rows_new_ = rows_new;
+	std::set<std::pair<unsigned, int>> cells_modified;
+	for (auto& cell : cells_modified_)
+		if (!is_deleted(cell.first))
+			cells_modified.emplace(shifted(cell.first), cell.second);
+	cells_modified_ = cells_modified;
+
+	// Update grid
+	updateIndex();
+	notifyRowCount(count);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the column to sort rows by ([col] -1 for unsorted) and the sort order
+// -----------------------------------------------------------------------------
+void DataEntryTable::setSorting(int col, bool ascending)
+{
+	int prev_count  = GetNumberRows();
+	sort_col_       = col < (int)columns_.size() ? col : -1;
+	sort_ascending_ = ascending;
+	updateIndex();
+	notifyRowCount(prev_count);
+}
 
-	// Write new rows
-	data_.write(data_clipboard_.data(), data_clipboard_.size());
+// -----------------------------------------------------------------------------
+// Shows only rows with a cell value containing [filter] (case-insensitive),
+// or all rows if [filter] is empty
+// -----------------------------------------------------------------------------
+void DataEntryTable::setFilter(const wxString& filter)
+{
+	int prev_count = GetNumberRows();
+	filter_        = filter.Lower();
+	updateIndex();
+	notifyRowCount(prev_count);
+}
 
-	// Write ending rows
-	data_.write(copy.data() + start, copy.size() - start);
+// -----------------------------------------------------------------------------
+// Returns the number of rows in the data (regardless of sorting/filtering)
+// -----------------------------------------------------------------------------
+unsigned DataEntryTable::numDataRows() const
+{
+	unsigned end = data_stop_ ? std::min(data_stop_, data_.size()) : data_.size();
+	if (row_stride_ == 0 || end <= data_start_)
+		return 0;
+
+	return (end - data_start_) / row_stride_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the string value for column [col] of [data_row], read directly from
+// the data
+// -----------------------------------------------------------------------------
+wxString DataEntryTable::cellValue(unsigned data_row, int col)
+{
+	const auto& data   = data_;
+	auto&       column = columns_[col];
+	unsigned    offset = data_start_ + (data_row * row_stride_) + column.row_offset;
+	if (offset + column.size > data.size())
+		return "INVALID";
 
-	// Update new rows
-	int num = data_clipboard_.size() / row_stride_;
-	for (int& new_row : rows_new_)
+	int64_t value = 0;
+	switch (column.type)
 	{
-		if (new_row >= row)
-			new_row += num;
+	// Integer column
+	case ColType::IntSigned:
+		if (!readInt(data, offset, column.size, true, value))
+			return "INVALID SIZE";
+		return wxString::Format("%lld", (long long)value);
+	case ColType::IntUnsigned:
+		if (!readInt(data, offset, column.size, false, value))
+			return "INVALID SIZE";
+		return wxString::Format("%llu", (unsigned long long)value);
+
+	// Fixed-point float column
+	case ColType::Fixed:
+		if (column.size != 4 || !readInt(data, offset, 4, true, value))
+			return "INVALID SIZE";
+		return wxString::Format("%1.3f", (double)value / 65536.0);
+
+	// String column
+	case ColType::String: return wxString::FromAscii((const char*)data.data() + offset, column.size);
+
+	// Custom value column
+	case ColType::CustomValue:
+		readInt(data, offset, column.size, true, value);
+		return wxString::Format("%d: %s", (int)value, column.customValue(value));
+
+	default: return "UNKNOWN TYPE";
 	}
-	for (int a = 0; a < num; a++)
-		rows_new_.push_back(row + a);
+}
 
-	// Send message to grid
-	wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_INSERTED, row, num);
-	GetView()->ProcessTableMessage(msg);
+// -----------------------------------------------------------------------------
+// Returns the numeric value for column [col] of [data_row] (for sorting)
+// -----------------------------------------------------------------------------
+double DataEntryTable::numericValue(unsigned data_row, int col) const
+{
+	auto&    column = columns_[col];
+	unsigned offset = data_start_ + (data_row * row_stride_) + column.row_offset;
+	int64_t  value  = 0;
+	if (!readInt(data_, offset, column.size, column.type != ColType::IntUnsigned, value))
+		return 0.;
+
+	return column.type == ColType::Fixed ? (double)value / 65536.0 : (double)value;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any cell value in [data_row] contains [filter]
+// ([filter] must be lowercase)
+// -----------------------------------------------------------------------------
+bool DataEntryTable::rowMatches(unsigned data_row, const wxString& filter)
+{
+	for (unsigned col = 0; col < columns_.size(); col++)
+		if (cellValue(data_row, col).Lower().Contains(filter))
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the index of data rows to show in the grid from the current sorting
+// and filter. New rows are always shown, even if they don't match the filter
+// -----------------------------------------------------------------------------
+void DataEntryTable::updateIndex()
+{
+	index_.clear();
+	indexed_ = sort_col_ >= 0 || !filter_.empty();
+	if (!indexed_)
+		return;
+
+	// Filter
+	auto data_rows = numDataRows();
+	for (unsigned a = 0; a < data_rows; a++)
+		if (filter_.empty() || rows_new_.count(a) > 0 || rowMatches(a, filter_))
+			index_.push_back(a);
+
+	if (sort_col_ < 0)
+		return;
+
+	// Sort (values are read once up-front rather than for every comparison)
+	if (columns_[sort_col_].type == ColType::String)
+	{
+		vector<wxString> values(data_rows);
+		for (auto a : index_)
+			values[a] = cellValue(a, sort_col_).Lower();
+		std::stable_sort(
+			index_.begin(),
+			index_.end(),
+			[&](unsigned a, unsigned b) { return sort_ascending_ ? values[a] < values[b] : values[b] < values[a]; });
+	}
+	else
+	{
+		vector<double> values(data_rows);
+		for (auto a : index_)
+			values[a] = numericValue(a, sort_col_);
+		std::stable_sort(
+			index_.begin(),
+			index_.end(),
+			[&](unsigned a, unsigned b) { return sort_ascending_ ? values[a] < values[b] : values[b] < values[a]; });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Inserts [num] rows at (grid) [row], copied from [data] or blank if [data] is
+// null
+// -----------------------------------------------------------------------------
+void DataEntryTable::insertRows(int row, const uint8_t* data, unsigned num)
+{
+	if (num == 0 || row_stride_ == 0)
+		return;
+
+	// Get data row to insert at
+	int      count    = GetNumberRows();
+	unsigned data_row = row < 0 ? 0 : row < count ? dataRow(row) : numDataRows();
+	unsigned offset   = data_start_ + (data_row * row_stride_);
+	unsigned size     = num * row_stride_;
+	unsigned old_size = data_.size();
+	if (offset > old_size)
+		return;
+
+	// Move following data up (in place) and write the new rows
+	if (!data_.reSize(old_size + size))
+		return;
+	auto dest = data_.data() + offset;
+	memmove(dest + size, dest, old_size - offset);
+	if (data)
+		memcpy(dest, data, size);
+	else
+		memset(dest, 0, size);
+	if (data_stop_)
+		data_stop_ += size;
+
+	// Update new rows and modified cells
+	std::set<unsigned> rows_new;
+	for (auto new_row : rows_new_)
+		rows_new.insert(new_row >= data_row ? new_row + num : new_row);
+	for (unsigned a = 0; a < num; a++)
+		rows_new.insert(data_row + a);
+	rows_new_ = rows_new;
+	std::set<std::pair<unsigned, int>> cells_modified;
+	for (auto& cell : cells_modified_)
+		cells_modified.emplace(cell.first >= data_row ? cell.first + num : cell.first, cell.second);
+	cells_modified_ = cells_modified;
+
+	// Update grid
+	updateIndex();
+	notifyRowCount(count);
+}
+
+// -----------------------------------------------------------------------------
+// Notifies the grid of any change in the number of rows shown, from
+// [prev_count]
+// -----------------------------------------------------------------------------
+void DataEntryTable::notifyRowCount(int prev_count)
+{
+	if (!GetView())
+		return;
+
+	int count = GetNumberRows();
+	if (count > prev_count)
+	{
+		wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_APPENDED, count - prev_count);
+		GetView()->ProcessTableMessage(msg);
+	}
+	else if (count < prev_count)
+	{
+		wxGridTableMessage msg(this, wxGRIDTABLE_NOTIFY_ROWS_DELETED, count, prev_count - count);
+		GetView()->ProcessTableMessage(msg);
+	}
 }
 
 
@@ -871,8 +974,16 @@ DataEntryPanel::DataEntryPanel(wxWindow* parent) :
 	// Cell value combo box
 	auto vbox = new wxBoxSizer(wxVERTICAL);
 	sizer_main_->Add(vbox, 1, wxEXPAND);
+	auto hbox = new wxBoxSizer(wxHORIZONTAL);
+	vbox->Add(hbox, 0, wxEXPAND | wxBOTTOM, ui::pad());
 	combo_cell_value_ = new wxComboBox(this, -1, "", wxDefaultPosition, wxDefaultSize, 0, nullptr, wxTE_PROCESS_ENTER);
-	vbox->Add(combo_cell_value_, 0, wxEXPAND | wxBOTTOM, ui::pad());
+	hbox->Add(combo_cell_value_, 1, wxEXPAND | wxRIGHT, ui::padLarge());
+
+	// Row filter
+	text_filter_ = new wxTextCtrl(this, -1);
+	text_filter_->SetToolTip("Show only rows with a value containing this text");
+	hbox->Add(new wxStaticText(this, -1, "Filter:"), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, ui::pad());
+	hbox->Add(text_filter_, 0, wxEXPAND);
 
 	// Create grid
 	grid_data_ = new wxGrid(this, -1);
@@ -891,6 +1002,8 @@ DataEntryPanel::DataEntryPanel(wxWindow* parent) :
 	Bind(wxEVT_KEY_DOWN, &DataEntryPanel::onKeyDown, this);
 	grid_data_->Bind(wxEVT_GRID_CELL_RIGHT_CLICK, &DataEntryPanel::onGridRightClick, this);
 	grid_data_->Bind(wxEVT_GRID_SELECT_CELL, &DataEntryPanel::onGridCursorChanged, this);
+	grid_data_->Bind(wxEVT_GRID_COL_SORT, &DataEntryPanel::onGridColSort, this);
+	text_filter_->Bind(wxEVT_TEXT, &DataEntryPanel::onFilterChanged, this);
 	combo_cell_value_->Bind(wxEVT_COMBOBOX, &DataEntryPanel::onComboCellValueSet, this);
 	combo_cell_value_->Bind(wxEVT_TEXT_ENTER, &DataEntryPanel::onComboCellValueSet, this);
 }
@@ -904,7 +1017,9 @@ bool DataEntryPanel::loadEntry(ArchiveEntry* entry)
 	table_data_->setupDataStructure(entry);
 	grid_data_->ClearGrid();
 	grid_data_->SetTable(table_data_);
+	grid_data_->UnsetSortingColumn();
 	combo_cell_value_->Clear();
+	text_filter_->ChangeValue("");
 
 	// Set column widths
 	grid_data_->SetColMinimalAcceptableWidth(ui::scalePx(64));
@@ -963,21 +1078,7 @@ void DataEntryPanel::deleteRow()
 	if (selected_rows.empty() && grid_data_->GetGridCursorRow() >= 0)
 		grid_data_->DeleteRows(grid_data_->GetGridCursorRow(), 1);
 	else if (!selected_rows.empty())
-	{
-		// Go through selected rows
-		for (unsigned a = 0; a < selected_rows.size(); a++)
-		{
-			// Delete row
-			grid_data_->DeleteRows(selected_rows[a], 1);
-
-			// Adjust remaining selection
-			for (unsigned b = a; b < selected_rows.size(); b++)
-			{
-				if (selected_rows[b] > selected_rows[a])
-					selected_rows[b] = selected_rows[b] - 1;
-			}
-		}
-	}
+		table_data_->deleteRows(vector<int>(selected_rows.begin(), selected_rows.end()));
 
 	// Update grid
 	grid_data_->ClearSelection();
@@ -1024,21 +1125,7 @@ void DataEntryPanel::copyRow(bool cut)
 
 		// Delete if cutting
 		if (cut)
-		{
-			// Go through selected rows
-			for (unsigned a = 0; a < selected_rows.size(); a++)
-			{
-				// Delete row
-				grid_data_->DeleteRows(selected_rows[a], 1);
-
-				// Adjust remaining selection
-				for (unsigned b = a; b < selected_rows.size(); b++)
-				{
-					if (selected_rows[b] > selected_rows[a])
-						selected_rows[b] = selected_rows[b] - 1;
-				}
-			}
-		}
+			table_data_->deleteRows(vector<int>(selected_rows.begin(), selected_rows.end()));
 	}
 
 	// Update grid
@@ -1164,19 +1251,38 @@ int DataEntryPanel::getColWithSelection() const
 // -----------------------------------------------------------------------------
 vector<Vec2i> DataEntryPanel::selection() const
 {
-	vector<Vec2i> selection;
+	// Go through the grid's selection rather than testing every cell, since
+	// there can be a very large number of rows
+	std::set<std::pair<int, int>> cells;
+	int                           rows = table_data_->GetNumberRows();
+	int                           cols = table_data_->GetNumberCols();
 
-	// Just go through entire grid
-	int rows = table_data_->GetNumberRows();
-	int cols = table_data_->GetNumberCols();
-	for (int r = 0; r < rows; r++)
-	{
+	// Selected rows/columns
+	auto selected_rows = grid_data_->GetSelectedRows();
+	for (unsigned a = 0; a < selected_rows.size(); a++)
 		for (int c = 0; c < cols; c++)
-		{
-			if (grid_data_->IsInSelection(r, c))
-				selection.emplace_back(r, c);
-		}
-	}
+			cells.emplace(selected_rows[a], c);
+	auto selected_cols = grid_data_->GetSelectedCols();
+	for (unsigned a = 0; a < selected_cols.size(); a++)
+		for (int r = 0; r < rows; r++)
+			cells.emplace(r, selected_cols[a]);
+
+	// Selected blocks
+	auto top_left     = grid_data_->GetSelectionBlockTopLeft();
+	auto bottom_right = grid_data_->GetSelectionBlockBottomRight();
+	for (unsigned a = 0; a < top_left.size() && a < bottom_right.size(); a++)
+		for (int r = top_left[a].GetRow(); r <= bottom_right[a].GetRow(); r++)
+			for (int c = top_left[a].GetCol(); c <= bottom_right[a].GetCol(); c++)
+				cells.emplace(r, c);
+
+	// Individually selected cells
+	auto selected_cells = grid_data_->GetSelectedCells();
+	for (unsigned a = 0; a < selected_cells.size(); a++)
+		cells.emplace(selected_cells[a].GetRow(), selected_cells[a].GetCol());
+
+	vector<Vec2i> selection;
+	for (auto& cell : cells)
+		selection.emplace_back(cell.first, cell.second);
 
 	// If no selection, add current cursor cell
 	if (selection.empty())
@@ -1251,6 +1357,32 @@ void DataEntryPanel::onGridCursorChanged(wxGridEvent& e)
 	combo_cell_value_->SetValue(grid_data_->GetCellValue(e.GetRow(), e.GetCol()));
 }
 
+// -----------------------------------------------------------------------------
+// Called when a column header is clicked on the grid
+// -----------------------------------------------------------------------------
+void DataEntryPanel::onGridColSort(wxGridEvent& e)
+{
+	// Sort by the column, reversing the order if it's already sorted by it
+	int  col       = e.GetCol();
+	bool ascending = !(grid_data_->IsSortingBy(col) && grid_data_->IsSortOrderAscending());
+	table_data_->setSorting(col, ascending);
+	grid_data_->SetSortingColumn(col, ascending);
+	grid_data_->ForceRefresh();
+
+	// The grid sort indicator is set above, don't let the grid set it again
+	e.Veto();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the row filter text is changed
+// -----------------------------------------------------------------------------
+void DataEntryPanel::onFilterChanged(wxCommandEvent& e)
+{
+	table_data_->setFilter(text_filter_->GetValue());
+	grid_data_->ClearSelection();
+	grid_data_->ForceRefresh();
+}
+
 // -----------------------------------------------------------------------------
 // Called when the cell value combo is changed (enter pressed or an option
 // selected from the dropdown)
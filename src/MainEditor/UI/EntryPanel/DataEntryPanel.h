@@ -70,19 +70,41 @@ public:
 	bool      setupDataStructure(ArchiveEntry* entry);
 	void      copyRows(int row, int num, bool add = false);
 	void      pasteRows(int row);
+	void      deleteRows(vector<int> rows);
+	int       sortColumn() const { return sort_col_; }
+	bool      sortAscending() const { return sort_ascending_; }
+	void      setSorting(int col, bool ascending = true);
+	void      setFilter(const wxString& filter);
 
 private:
-	MemChunk        data_;
-	vector<Column>  columns_;
-	unsigned        row_stride_ = 0;
-	unsigned        data_start_ = 0;
-	unsigned        data_stop_  = 0;
-	int             row_first_  = 0;
-	wxString        row_prefix_;
-	DataEntryPanel* parent_ = nullptr;
-	MemChunk        data_clipboard_;
-	vector<Vec2i>   cells_modified_;
-	vector<int>     rows_new_;
+	MemChunk                           data_;
+	vector<Column>                     columns_;
+	unsigned                           row_stride_ = 0;
+	unsigned                           data_start_ = 0;
+	unsigned                           data_stop_  = 0;
+	int                                row_first_  = 0;
+	wxString                           row_prefix_;
+	DataEntryPanel*                    parent_ = nullptr;
+	MemChunk                           data_clipboard_;
+	std::set<std::pair<unsigned, int>> cells_modified_; // Data row, column
+	std::set<unsigned>                 rows_new_;       // Data rows
+
+	// Sorting/filtering, if either is active [index_] is the data row shown in
+	// each grid row
+	bool             indexed_ = false;
+	vector<unsigned> index_;
+	int              sort_col_       = -1;
+	bool             sort_ascending_ = true;
+	wxString         filter_;
+
+	unsigned numDataRows() const;
+	unsigned dataRow(int row) const { return indexed_ ? index_[row] : row; }
+	wxString cellValue(unsigned data_row, int col);
+	double   numericValue(unsigned data_row, int col) const;
+	bool     rowMatches(unsigned data_row, const wxString& filter);
+	void     updateIndex();
+	void     insertRows(int row, const uint8_t* data, unsigned num);
+	void     notifyRowCount(int prev_count);
 };
 
 class DataEntryPanel : public EntryPanel
@@ -111,11 +133,14 @@ private:
 	wxGrid*         grid_data_        = nullptr;
 	DataEntryTable* table_data_       = nullptr;
 	wxComboBox*     combo_cell_value_ = nullptr;
+	wxTextCtrl*     text_filter_      = nullptr;
 
 	// Events
 	void onKeyDown(wxKeyEvent& e);
 	void onGridRightClick(wxGridEvent& e);
 	void onGridCursorChanged(wxGridEvent& e);
+	void onGridColSort(wxGridEvent& e);
+	void onFilterChanged(wxCommandEvent& e);
 	void onComboCellValueSet(wxCommandEvent& e);
 };
 } // namespace slade
@@ -601,7 +601,6 @@ void GfxEntryPanel::refreshPanel()
 void GfxEntryPanel::updateImagePalette() const
 {
 	gfx_canvas_->setPalette(maineditor::currentPalette());
-	gfx_canvas_->updateImageTexture();
 }
 
 // -----------------------------------------------------------------------------
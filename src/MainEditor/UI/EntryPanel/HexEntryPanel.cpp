@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "HexEntryPanel.h"
+#include "Archive/EntryDataReader.h"
 #include "UI/Controls/HexEditorPanel.h"
 
 using namespace slade;
@@ -68,6 +69,10 @@ bool HexEntryPanel::loadEntry(ArchiveEntry* entry)
 	if (!entry)
 		return false;
 
-	// Load entry data to hex editor
-	return hex_editor_->loadData(entry->data());
+	// Load entry data to hex editor, if the data isn't already loaded it is
+	// read from the archive file as needed rather than loading all of it
+	if (entry->isLoaded())
+		return hex_editor_->loadData(entry->data());
+	else
+		return hex_editor_->loadData(entry->dataReader());
 }
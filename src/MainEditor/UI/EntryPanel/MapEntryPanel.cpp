@@ -92,6 +92,23 @@ MapEntryPanel::MapEntryPanel(wxWindow* parent) : EntryPanel(parent, "map")
 
 	// Bind events
 	cb_show_things_->Bind(wxEVT_CHECKBOX, &MapEntryPanel::onCBShowThings, this);
+	map_canvas_->setOnMapLoaded([this](bool ok) {
+		if (!ok)
+		{
+			label_stats_->SetLabel("Invalid map");
+			return;
+		}
+
+		label_stats_->SetLabel(wxString::Format(
+			"Vertices: %d, Sides: %d, Lines: %d, Sectors: %d, Things: %d, Total Size: %dx%d",
+			map_canvas_->nVertices(),
+			map_canvas_->nSides(),
+			map_canvas_->nLines(),
+			map_canvas_->nSectors(),
+			map_canvas_->nThings(),
+			map_canvas_->width(),
+			map_canvas_->height()));
+	});
 
 	// Layout
 	wxWindowBase::Layout();
@@ -132,23 +149,9 @@ bool MapEntryPanel::loadEntry(ArchiveEntry* entry)
 		return false;
 	}
 
-	// Load map into preview canvas
-	if (map_canvas_->openMap(thismap))
-	{
-		label_stats_->SetLabel(wxString::Format(
-			"Vertices: %d, Sides: %d, Lines: %d, Sectors: %d, Things: %d, Total Size: %dx%d",
-			map_canvas_->nVertices(),
-			map_canvas_->nSides(),
-			map_canvas_->nLines(),
-			map_canvas_->nSectors(),
-			map_canvas_->nThings(),
-			map_canvas_->width(),
-			map_canvas_->height()));
-		return true;
-	}
-
+	// Load map into preview canvas (stats are updated when it has been read)
 	label_stats_->SetLabel("");
-	return false;
+	return map_canvas_->openMap(thismap);
 }
 
 // -----------------------------------------------------------------------------
@@ -38,6 +38,7 @@
 #include "General/UI.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
+#include "Graphics/Palette/PaletteTables.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
@@ -1034,108 +1035,61 @@ bool PaletteEntryPanel::gradient()
 }
 
 // -----------------------------------------------------------------------------
-// Generates a COLORMAP lump from the current palette
+// Generates a COLORMAP lump from the first palette
 // -----------------------------------------------------------------------------
-#define DIMINISH(color, level) color = (uint8_t)((((float)(color)) * (32.0 - level) + 16.0) / 32.0)
 bool PaletteEntryPanel::generateColormaps()
 {
-	static const int GREENMAP = 255;
-	static const int GRAYMAP  = 32;
+	if (!palettes_[0])
+		return false;
 
-	auto entry = entry_.lock();
-	if (!entry || !entry->parent() || !palettes_[0])
+	MemChunk mc;
+	palettetables::colormap(*palettes_[0], mc);
+	return writeTableEntry("COLORMAP", mc);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a TRANMAP (translucency table) lump from the first palette, with
+// a translucency percentage entered by the user
+// -----------------------------------------------------------------------------
+bool PaletteEntryPanel::generateTranmap()
+{
+	if (!palettes_[0])
+		return false;
+
+	auto percent = wxGetNumberFromUser(
+		"Enter the opacity (%) of the foreground colour", "Opacity", "Generate Translucency Table", 66, 0, 100, this);
+	if (percent < 0)
 		return false;
 
 	MemChunk mc;
-	SImage   img;
-	MemChunk imc;
-	mc.reSize(34 * 256);
-	mc.seek(0, SEEK_SET);
-	imc.reSize(34 * 256 * 4);
-	imc.seek(0, SEEK_SET);
-	uint8_t rgba[4];
-	rgba[3] = 255;
-
-	ColRGBA rgb;
-	float   grey;
-	// Generate 34 maps: the first 32 for diminishing light levels,
-	// the 33th for the inverted grey map used by invulnerability.
-	// The 34th colormap remains empty and black.
-	for (size_t l = 0; l < 34; ++l)
-	{
-		for (size_t c = 0; c < 256; ++c)
-		{
-			rgb = palettes_[0]->colour(c);
-			if (l < 32)
-			{
-				// Generate light maps
-				DIMINISH(rgb.r, l);
-				DIMINISH(rgb.g, l);
-				DIMINISH(rgb.b, l);
-#if (0)
-			}
-			else if (l == GREENMAP)
-			{
-				// Point of mostly useless trivia: the green "light amp" colormap in the Press Release beta
-				// have colors that, on average, correspond to a bit less than (R*75/256, G*225/256, B*115/256)
-#endif
-			}
-			else if (l == GRAYMAP)
-			{
-				// Generate inverse map
-				grey = ((float)rgb.r / 256.0 * col_greyscale_r) + ((float)rgb.g / 256.0 * col_greyscale_g)
-					   + ((float)rgb.b / 256.0 * col_greyscale_b);
-				grey = 1.0 - grey;
-				// Clamp value: with Id Software's values, the sum is greater than 1.0 (0.299+0.587+0.144=1.030)
-				// This means the negation above can give a negative value (for example, with RGB values of 247 or
-				// more), which will not be converted correctly to unsigned 8-bit int in the ColRGBA struct.
-				if (grey < 0.0)
-					grey = 0;
-				rgb.r = rgb.g = rgb.b = grey * 255;
-			}
-			else
-			{
-				// Fill with 0
-				rgb = palettes_[0]->colour(0);
-			}
-			rgba[0] = rgb.r;
-			rgba[1] = rgb.g;
-			rgba[2] = rgb.b;
-			imc.write(&rgba, 4);
-			mc[(256 * l) + c] = palettes_[0]->nearestColour(rgb);
-		}
-	}
-#if 0
-	// Create truecolor image
-	uint8_t* imd = new uint8_t[256*34*4];
-	memcpy(imd, imc.getData(), 256*34*4);
-	img.setImageData(imd, 256, 34, RGBA);
-	// imd will be freed by img's destructor
-	ArchiveEntry* tcolormap;
-	string name = entry->getName(true) + "-tcm.png";
-	tcolormap = new ArchiveEntry(name);
-	if (tcolormap)
-	{
-		entry->getParent()->addEntry(tcolormap);
-		SIFormat::getFormat("png")->saveImage(img, tcolormap->getMCData());
-		EntryType::detectEntryType(tcolormap);
-	}
-#endif
-	// Now override or create new entry
-	auto colormap = entry->parent()->entry("COLORMAP", true);
-	if (!colormap)
+	palettetables::blendTable(*palettes_[0], mc, static_cast<float>(percent) / 100.f);
+	return writeTableEntry("TRANMAP", mc);
+}
+
+// -----------------------------------------------------------------------------
+// Writes generated table data [mc] to the entry named [name] in the same
+// directory as the palette entry, creating it if it doesn't exist
+// -----------------------------------------------------------------------------
+bool PaletteEntryPanel::writeTableEntry(const string& name, MemChunk& mc) const
+{
+	auto entry = entry_.lock();
+	if (!entry || !entry->parent())
+		return false;
+
+	auto table = entry->parent()->entry(name, true);
+	if (!table)
 	{
 		// We need to create this entry
-		auto nc = std::make_shared<ArchiveEntry>("COLORMAP.lmp", 34 * 256);
+		auto nc = std::make_shared<ArchiveEntry>(name + ".lmp", mc.size());
 		entry->parent()->addEntry(nc);
-		colormap = nc.get();
+		table = nc.get();
 	}
-	if (!colormap)
+	if (!table)
 		return false;
-	colormap->importMemChunk(mc);
+
+	table->importMemChunk(mc);
 	return true;
 }
-#undef DIMINISH
 
 // -----------------------------------------------------------------------------
 // Just a helper for generatePalettes to make the code less redundant
@@ -1268,6 +1222,13 @@ bool PaletteEntryPanel::handleEntryPanelAction(string_view id)
 		return true;
 	}
 
+	// Generate TRANMAP
+	if (id == "ppal_tranmap")
+	{
+		generateTranmap();
+		return true;
+	}
+
 	// Colourise
 	else if (id == "ppal_colourise")
 	{
@@ -1372,6 +1333,7 @@ bool PaletteEntryPanel::fillCustomMenu(wxMenu* custom)
 	SAction::fromId("ppal_remove")->addToMenu(custom);
 	SAction::fromId("ppal_removeothers")->addToMenu(custom);
 	SAction::fromId("ppal_colormap")->addToMenu(custom);
+	SAction::fromId("ppal_tranmap")->addToMenu(custom);
 	custom->AppendSeparator();
 	SAction::fromId("ppal_moveup")->addToMenu(custom);
 	SAction::fromId("ppal_movedown")->addToMenu(custom);
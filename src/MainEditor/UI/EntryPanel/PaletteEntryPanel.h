@@ -38,6 +38,7 @@ public:
 
 	// Palette manipulation functions
 	bool generateColormaps();
+	bool generateTranmap();
 	bool generatePalettes();
 	bool clearOne();
 	bool clearOthers();
@@ -70,6 +71,8 @@ private:
 	// A helper for generatePalettes() which has no reason to be called outside
 	void generatePalette(int r, int g, int b, int shift, int steps);
 
+	bool writeTableEntry(const string& name, MemChunk& mc) const;
+
 	// Events
 	void onPalCanvasMouseEvent(wxMouseEvent& e);
 };
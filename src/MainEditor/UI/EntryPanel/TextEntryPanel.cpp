@@ -283,6 +283,14 @@ bool TextEntryPanel::redo()
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Moves the text editor cursor to [line] and scrolls to show it
+// -----------------------------------------------------------------------------
+void TextEntryPanel::showLine(int line) const
+{
+	text_area_->showLine(line);
+}
+
 // ----------------------------------------------------------------------------
 // Handles the action [id].
 // Returns true if the action was handled, false otherwise
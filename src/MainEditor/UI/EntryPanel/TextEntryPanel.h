@@ -18,6 +18,7 @@ public:
 	wxString statusString() override;
 	bool     undo() override;
 	bool     redo() override;
+	void     showLine(int line) const;
 
 	// SAction Handler
 	bool handleEntryPanelAction(string_view id) override;
@@ -48,6 +48,8 @@
 #include "UI/Controls/STabCtrl.h"
 #include "UI/Controls/UndoManagerHistoryPanel.h"
 #include "UI/Dialogs/Preferences/PreferencesDialog.h"
+#include "UI/Dialogs/MemoryUsageDialog.h"
+#include "UI/Dialogs/TextSearchDialog.h"
 #include "UI/SAuiTabArt.h"
 #include "UI/SToolBar/SToolBar.h"
 #include "UI/SToolBar/SToolBarButton.h"
@@ -97,8 +99,10 @@ public:
 
 	bool OnDropFiles(wxCoord x, wxCoord y, const wxArrayString& filenames) override
 	{
+		vector<string> files;
 		for (const auto& filename : filenames)
-			app::archiveManager().openArchive(filename.ToStdString());
+			files.push_back(filename.ToStdString());
+		app::archiveManager().openArchives(files);
 
 		return true;
 	}
@@ -317,7 +321,10 @@ void MainWindow::setupLayout()
 
 	// Tools menu
 	auto tools_menu = new wxMenu("");
+	SAction::fromId("main_textsearch")->addToMenu(tools_menu);
 	SAction::fromId("main_runscript")->addToMenu(tools_menu);
+	tools_menu->AppendSeparator();
+	SAction::fromId("main_memoryusage")->addToMenu(tools_menu);
 	menu->Append(tools_menu, "&Tools");
 
 	// Help menu
@@ -638,6 +645,28 @@ bool MainWindow::handleAction(string_view id)
 	if (id == "main_showstartpage")
 		openStartPageTab();
 
+	// Tools->Find in Archives
+	if (id == "main_textsearch")
+	{
+		if (!dlg_text_search_)
+			dlg_text_search_ = new TextSearchDialog(this);
+		dlg_text_search_->Show();
+		dlg_text_search_->Raise();
+		return true;
+	}
+
+	// Tools->Memory Usage
+	if (id == "main_memoryusage")
+	{
+		if (!dlg_memory_usage_)
+			dlg_memory_usage_ = new MemoryUsageDialog(this);
+		else
+			dlg_memory_usage_->refresh();
+		dlg_memory_usage_->Show();
+		dlg_memory_usage_->Raise();
+		return true;
+	}
+
 #ifdef USE_LUA
 	// Tools->Run Script
 	if (id == "main_runscript")
@@ -8,9 +8,11 @@ class wxAuiManager;
 namespace slade
 {
 class ArchiveManagerPanel;
+class MemoryUsageDialog;
 class PaletteChooser;
 class SToolBar;
 class STabCtrl;
+class TextSearchDialog;
 class UndoManagerHistoryPanel;
 class SStartPage;
 #ifdef USE_WEBVIEW_STARTPAGE
@@ -50,6 +52,8 @@ private:
 	wxAuiManager*            aui_mgr_              = nullptr;
 	int                      lasttipindex_         = 0;
 	PaletteChooser*          palette_chooser_      = nullptr;
+	TextSearchDialog*        dlg_text_search_      = nullptr;
+	MemoryUsageDialog*       dlg_memory_usage_     = nullptr;
 
 	// Start page
 	SStartPage* start_page_ = nullptr;
@@ -45,8 +45,10 @@
 #include "MainEditor/MainEditor.h"
 #include "MainEditor/UI/MainWindow.h"
 #include "OpenGL/GLTexture.h"
+#include "UI/Browser/Thumbnails.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/StringUtils.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -81,7 +83,7 @@ bool PatchBrowserItem::loadImage()
 
 		// Load entry to image, if it exists
 		if (entry)
-			misc::loadImageFromEntry(&img, entry);
+			misc::loadCachedImageFromEntry(&img, entry);
 		else
 			return false;
 	}
@@ -118,6 +120,8 @@ wxString PatchBrowserItem::itemInfo()
 		auto& tex_info = gl::Texture::info(image_tex_);
 		info += wxString::Format("%dx%d", tex_info.size.x, tex_info.size.y);
 	}
+	else if (auto thumb = thumbnails::get(thumb_key_))
+		info += wxString::Format("%dx%d", thumb->image_size.x, thumb->image_size.y);
 	else
 		info += "Unknown size";
 
@@ -147,6 +151,22 @@ void PatchBrowserItem::clearImage()
 	image_tex_ = 0;
 }
 
+// -----------------------------------------------------------------------------
+// Sets up [source] to generate the item's thumbnail from its patch entry or
+// composite texture
+// -----------------------------------------------------------------------------
+bool PatchBrowserItem::thumbnailSource(thumbnails::Source& source)
+{
+	if (type_ == Type::Patch)
+	{
+		auto entry = app::resources().getPatchEntry(name_.ToStdString(), nspace_.ToStdString(), archive_);
+		return thumbnails::entrySource(source, entry, parent_->palette());
+	}
+
+	auto tex = app::resources().getTexture(name_.ToStdString(), "", archive_);
+	return thumbnails::textureSource(source, tex, archive_, parent_->palette());
+}
+
 
 // -----------------------------------------------------------------------------
 //
@@ -323,7 +343,8 @@ bool PatchBrowser::openArchive(Archive* archive)
 		}
 	}
 
-	vector<wxString> usednames;
+	std::unordered_set<string> usednames;
+	usednames.reserve(patches.size());
 
 	// Go through the list
 	for (auto entry : patches)
@@ -361,24 +382,12 @@ bool PatchBrowser::openArchive(Archive* archive)
 			addItem(item, fnspace + "/" + arch);
 		}
 
-		wxString name = strutil::truncate(entry->upperNameNoExt(), 8);
-
-		bool duplicate = false;
-		for (auto& usedname : usednames)
-		{
-			if (usedname.Cmp(name) == 0)
-			{
-				duplicate = true;
-				break;
-			}
-		}
-
-		if (duplicate)
+		auto name = strutil::truncate(entry->upperNameNoExt(), 8);
+		if (!usednames.insert(name).second)
 			continue;
 
 		item = new PatchBrowserItem(name, archive, PatchBrowserItem::Type::Patch, ns);
 		addItem(item, nspace + "/" + arch);
-		usednames.push_back(name);
 	}
 
 	// Get list of all available textures (that aren't in the given archive)
@@ -35,6 +35,7 @@ public:
 	bool     loadImage() override;
 	wxString itemInfo() override;
 	void     clearImage() override;
+	bool     thumbnailSource(thumbnails::Source& source) override;
 
 private:
 	Archive* archive_ = nullptr;
@@ -46,6 +46,14 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, txed_check_errors, true, CVar::Flag::Save)
+
+
 // -----------------------------------------------------------------------------
 // CreateTextureXDialog Class
 //
@@ -350,6 +358,11 @@ bool TextureXEditor::openArchive(Archive* archive)
 		tx_panel->Show(true);
 	}
 
+	// Check the opened textures for errors in the background
+	if (txed_check_errors)
+		for (auto& texture_editor : texture_editors_)
+			texture_editor->txList().findErrorsInBackground();
+
 	// Update layout
 	Layout();
 	tabs_->Refresh();
@@ -683,14 +683,7 @@ bool TextureXPanel::openTEXTUREX(ArchiveEntry* entry)
 		texture_editor_ = new TextureEditorPanel(this, tx_editor_);
 
 		// Update patch table usage info
-		for (size_t a = 0; a < texturex_.size(); a++)
-		{
-			auto tex = texturex_.texture(a);
-
-			// Go through texture's patches
-			for (size_t p = 0; p < tex->nPatches(); p++)
-				tx_editor_->patchTable().patch(tex->patch(p)->name()).used_in.push_back(tex->name());
-		}
+		tx_editor_->patchTable().updatePatchUsage(texturex_);
 	}
 	else
 	{
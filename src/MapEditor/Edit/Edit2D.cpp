@@ -38,6 +38,7 @@
 #include "MapEditor/SectorBuilder.h"
 #include "MapEditor/UndoSteps.h"
 #include "Utility/MathStuff.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -660,9 +661,11 @@ void Edit2D::paste(Vec2d mouse_pos) const
 			context_.beginUndoRecord("Paste Map Architecture");
 			auto clip = dynamic_cast<MapArchClipboardItem*>(app::clipboard().item(a));
 			// Snap the geometry in such a way that it stays in the same position relative to the grid
-			auto pos       = context_.relativeSnapToGrid(clip->midpoint(), mouse_pos);
+			auto pos = context_.relativeSnapToGrid(clip->midpoint(), mouse_pos);
+			context_.map().beginGeometryEdit();
 			auto new_verts = clip->pasteToMap(&context_.map(), pos);
 			context_.map().mergeArch(new_verts);
+			context_.map().endGeometryEdit();
 			context_.addEditorMessage(fmt::format("Pasted {}", clip->info()));
 			context_.endUndoRecord(true);
 		}
@@ -990,9 +993,14 @@ void Edit2D::deleteVertex() const
 	// Begin undo step
 	context_.beginUndoRecord("Delete Vertices", map_merge_lines_on_delete_vertex, false, true);
 
-	// Delete them (if any)
-	for (auto& vertex : verts)
-		context_.map().removeVertex(vertex, map_merge_lines_on_delete_vertex);
+	// Delete them (if any), all at once unless connected lines are merged
+	if (map_merge_lines_on_delete_vertex)
+	{
+		for (auto& vertex : verts)
+			context_.map().removeVertex(vertex, true);
+	}
+	else
+		context_.map().removeVertices(verts);
 
 	// Remove detached vertices
 	context_.map().removeDetachedVertices();
@@ -1023,8 +1031,7 @@ void Edit2D::deleteLine() const
 	context_.beginUndoRecord("Delete Lines", false, false, true);
 
 	// Delete them (if any)
-	for (auto& line : lines)
-		context_.map().removeLine(line);
+	context_.map().removeLines(lines);
 
 	// Remove detached vertices
 	context_.map().removeDetachedVertices();
@@ -1055,8 +1062,7 @@ void Edit2D::deleteThing() const
 	context_.beginUndoRecord("Delete Things", false, false, true);
 
 	// Delete them (if any)
-	for (auto& thing : things)
-		context_.map().removeThing(thing);
+	context_.map().removeThings(things);
 
 	// Editor message
 	if (things.size() == 1)
@@ -1093,25 +1099,29 @@ void Edit2D::deleteSector() const
 		sector->putLines(connected_lines);
 	}
 
-	// Remove all connected sides
+	// Before removing the sides, flip any lines that will be left with only
+	// their back side
+	std::unordered_set<MapSide*> removing(connected_sides.begin(), connected_sides.end());
 	for (auto side : connected_sides)
 	{
-		// Before removing the side, check if we should flip the line
 		auto line = side->parentLine();
-		if (side == line->s1() && line->s2())
+		if (side == line->s1() && line->s2() && removing.count(line->s2()) == 0)
 			line->flip();
-
-		context_.map().removeSide(side);
 	}
 
+	// Remove all connected sides
+	context_.map().removeSides(connected_sides);
+
 	// Remove resulting invalid lines
 	if (map_remove_invalid_lines)
 	{
+		vector<MapLine*> invalid_lines;
 		for (auto line : connected_lines)
 		{
 			if (!line->s1() && !line->s2())
-				context_.map().removeLine(line);
+				invalid_lines.push_back(line);
 		}
+		context_.map().removeLines(invalid_lines);
 	}
 
 	// Try to fill in textures on any lines that just became one-sided
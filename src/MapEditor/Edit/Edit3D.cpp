@@ -209,8 +209,8 @@ void Edit3D::changeOffset(int amount, bool x) const
 	context_.beginUndoRecordLocked("Change Offset", true, false, false);
 
 	// Go through items
-	vector<int> done;
-	bool        changed = false;
+	vector<bool> done(context_.map().nSides(), false);
+	bool         changed = false;
 	for (auto& item : items)
 	{
 		// Wall
@@ -222,7 +222,7 @@ void Edit3D::changeOffset(int amount, bool x) const
 			if (link_offset_)
 			{
 				// Check we haven't processed this side already
-				if (VECTOR_EXISTS(done, item.index))
+				if (done[item.index])
 					continue;
 
 				// Change the appropriate offset
@@ -232,7 +232,7 @@ void Edit3D::changeOffset(int amount, bool x) const
 					side->setIntProperty("offsety", side->texOffsetY() + amount);
 
 				// Add to done list
-				done.push_back(item.index);
+				done[item.index] = true;
 			}
 
 			// Unlinked offsets
@@ -449,14 +449,11 @@ void Edit3D::autoAlignX(mapeditor::Item start) const
 	if (gl_tex)
 		tex_width = gl::Texture::info(gl_tex).size.x;
 
-	// Init aligned wall list
-	vector<mapeditor::Item> walls_done;
-
 	// Begin undo level
 	context_.beginUndoRecord("Auto Align X", true, false, false);
 
 	// Do alignment
-	doAlignX(side, side->texOffsetX(), tex, walls_done, tex_width);
+	doAlignX(side, side->texOffsetX(), tex, tex_width);
 
 	// End undo level
 	context_.endUndoRecord();
@@ -1560,60 +1557,57 @@ void Edit3D::getAdjacentFlats(mapeditor::Item item, vector<mapeditor::Item>& lis
 }
 
 // -----------------------------------------------------------------------------
-// Recursive function to align textures on the x axis
+// Aligns textures on the x axis along all walls connected to [start] with the
+// texture [tex], beginning with [offset] for [start].
+// The new offsets are all determined first (walking the connected walls in the
+// same order as they are connected) and then applied
 // -----------------------------------------------------------------------------
-void Edit3D::doAlignX(MapSide* side, int offset, string_view tex, vector<mapeditor::Item>& walls_done, int tex_width)
+void Edit3D::doAlignX(MapSide* start, int offset, string_view tex, int tex_width) const
 {
-	// Check if this wall has already been processed
-	for (auto& item : walls_done)
+	vector<std::pair<MapSide*, int>> offsets;
+	vector<std::pair<MapSide*, int>> stack{ { start, offset } };
+	vector<bool>                     done(context_.map().nSides(), false);
+	vector<MapSide*>                 next;
+	while (!stack.empty())
 	{
-		if (item.index == (int)side->index())
-			return;
-	}
-
-	// Add to 'done' list
-	walls_done.emplace_back((int)side->index(), ItemType::WallMiddle);
-
-	// Wrap offset
-	if (tex_width > 0)
-	{
-		while (offset >= tex_width)
-			offset -= tex_width;
-	}
+		auto [side, side_offset] = stack.back();
+		stack.pop_back();
 
-	// Set offset
-	side->setIntProperty("offsetx", offset);
+		// Check if this wall has already been processed
+		if (done[side->index()])
+			continue;
+		done[side->index()] = true;
 
-	// Get 'next' vertex
-	auto line   = side->parentLine();
-	auto vertex = line->v2();
-	if (side == line->s2())
-		vertex = line->v1();
+		// Wrap offset
+		if (tex_width > 0 && side_offset >= tex_width)
+			side_offset %= tex_width;
 
-	// Get integral length of line
-	int intlen = math::round(line->length());
+		offsets.emplace_back(side, side_offset);
 
-	// Go through connected lines
-	for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
-	{
-		auto l = vertex->connectedLine(a);
+		// Get 'next' vertex
+		auto line   = side->parentLine();
+		auto vertex = line->v2();
+		if (side == line->s2())
+			vertex = line->v1();
 
-		// First side
-		auto s = l->s1();
-		if (s)
+		// Get walls on connected lines with a matching texture
+		next.clear();
+		for (unsigned a = 0; a < vertex->nConnectedLines(); a++)
 		{
-			// Check for matching texture
-			if (s->texUpper() == tex || s->texMiddle() == tex || s->texLower() == tex)
-				doAlignX(s, offset + intlen, tex, walls_done, tex_width);
+			auto l = vertex->connectedLine(a);
+			for (auto s : { l->s1(), l->s2() })
+				if (s && !done[s->index()] && (s->texUpper() == tex || s->texMiddle() == tex || s->texLower() == tex))
+					next.push_back(s);
 		}
 
-		// Second side
-		s = l->s2();
-		if (s)
-		{
-			// Check for matching texture
-			if (s->texUpper() == tex || s->texMiddle() == tex || s->texLower() == tex)
-				doAlignX(s, offset + intlen, tex, walls_done, tex_width);
-		}
+		// Continue from the end of this wall (added in reverse so they are
+		// processed in order)
+		int next_offset = side_offset + math::round(line->length());
+		for (auto i = next.rbegin(); i != next.rend(); ++i)
+			stack.emplace_back(*i, next_offset);
 	}
+
+	// Apply new offsets
+	for (const auto& [side, side_offset] : offsets)
+		side->setIntProperty("offsetx", side_offset);
 }
@@ -72,12 +72,7 @@ private:
 	void        getAdjacentWalls(mapeditor::Item item, vector<mapeditor::Item>& list) const;
 	void        getAdjacentFlats(mapeditor::Item item, vector<mapeditor::Item>& list) const;
 
-	// Helper for autoAlignX3d
-	static void doAlignX(
-		MapSide*                 side,
-		int                      offset,
-		string_view              tex,
-		vector<mapeditor::Item>& walls_done,
-		int                      tex_width);
+	// Helper for autoAlignX
+	void doAlignX(MapSide* start, int offset, string_view tex, int tex_width) const;
 };
 } // namespace slade
@@ -1102,57 +1102,67 @@ bool Input::updateCamera3d(double mult) const
 	double speed  = shift_down_ ? mult * 8 : mult * 4;
 	auto&  r3d    = context_.renderer().renderer3D();
 
+	// Camera keybinds (indices looked up once)
+	static const int kb_forward    = KeyBind::index("me3d_camera_forward");
+	static const int kb_back       = KeyBind::index("me3d_camera_back");
+	static const int kb_left       = KeyBind::index("me3d_camera_left");
+	static const int kb_right      = KeyBind::index("me3d_camera_right");
+	static const int kb_up         = KeyBind::index("me3d_camera_up");
+	static const int kb_down       = KeyBind::index("me3d_camera_down");
+	static const int kb_turn_left  = KeyBind::index("me3d_camera_turn_left");
+	static const int kb_turn_right = KeyBind::index("me3d_camera_turn_right");
+
 	// Camera forward
-	if (KeyBind::isPressed("me3d_camera_forward"))
+	if (KeyBind::isPressed(kb_forward))
 	{
 		r3d.cameraMove(speed, !camera_3d_gravity);
 		moving = true;
 	}
 
 	// Camera backward
-	if (KeyBind::isPressed("me3d_camera_back"))
+	if (KeyBind::isPressed(kb_back))
 	{
 		r3d.cameraMove(-speed, !camera_3d_gravity);
 		moving = true;
 	}
 
 	// Camera left (strafe)
-	if (KeyBind::isPressed("me3d_camera_left"))
+	if (KeyBind::isPressed(kb_left))
 	{
 		r3d.cameraStrafe(-speed);
 		moving = true;
 	}
 
 	// Camera right (strafe)
-	if (KeyBind::isPressed("me3d_camera_right"))
+	if (KeyBind::isPressed(kb_right))
 	{
 		r3d.cameraStrafe(speed);
 		moving = true;
 	}
 
 	// Camera up
-	if (KeyBind::isPressed("me3d_camera_up"))
+	if (KeyBind::isPressed(kb_up))
 	{
 		r3d.cameraMoveUp(speed);
 		moving = true;
 	}
 
 	// Camera down
-	if (KeyBind::isPressed("me3d_camera_down"))
+	if (KeyBind::isPressed(kb_down))
 	{
 		r3d.cameraMoveUp(-speed);
 		moving = true;
 	}
 
 	// Camera turn left
-	if (KeyBind::isPressed("me3d_camera_turn_left"))
+	if (KeyBind::isPressed(kb_turn_left))
 	{
 		r3d.cameraTurn(shift_down_ ? mult * 2 : mult);
 		moving = true;
 	}
 
 	// Camera turn right
-	if (KeyBind::isPressed("me3d_camera_turn_right"))
+	if (KeyBind::isPressed(kb_turn_right))
 	{
 		r3d.cameraTurn(shift_down_ ? -mult * 2 : -mult);
 		moving = true;
@@ -49,6 +49,7 @@ CVAR(Int, shapedraw_shape, 0, CVar::Flag::Save)
 CVAR(Bool, shapedraw_centered, false, CVar::Flag::Save)
 CVAR(Bool, shapedraw_lockratio, false, CVar::Flag::Save)
 CVAR(Int, shapedraw_sides, 16, CVar::Flag::Save)
+CVAR(Int, linedraw_snap_radius, 32, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -76,20 +77,7 @@ Vec2d LineDraw::point(unsigned index)
 // -----------------------------------------------------------------------------
 bool LineDraw::addPoint(Vec2d point, bool nearest)
 {
-	// Snap to nearest vertex if necessary
-	if (nearest)
-	{
-		auto vertex = context_.map().vertices().nearest(point);
-		if (vertex)
-			point = vertex->position();
-	}
-
-	// Otherwise, snap to grid if necessary
-	else if (context_.gridSnap())
-	{
-		point.x = context_.snapToGrid(point.x);
-		point.y = context_.snapToGrid(point.y);
-	}
+	point = snapPoint(point, nearest);
 
 	// Check if this is the same as the last point
 	if (!draw_points_.empty() && point.x == draw_points_.back().x && point.y == draw_points_.back().y)
@@ -137,22 +125,45 @@ void LineDraw::removePoint()
 // -----------------------------------------------------------------------------
 void LineDraw::setShapeOrigin(Vec2d point, bool nearest)
 {
+	draw_origin_ = snapPoint(point, nearest);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [point] snapped to the nearest vertex within [linedraw_snap_radius]
+// pixels (at the current view scale) if [nearest] is true, otherwise (or if
+// there is no vertex that close) snapped to the grid if grid snap is enabled
+// -----------------------------------------------------------------------------
+Vec2d LineDraw::snapPoint(Vec2d point, bool nearest) const
+{
+	// The line draw preview snaps the mouse position every frame, reuse the
+	// last result if nothing it depends on has changed
+	auto radius        = std::max(1, *linedraw_snap_radius) / context_.renderer().view().scale();
+	auto modifications = MapObject::modificationCount();
+	if (last_snap_.valid && last_snap_.point == point && last_snap_.nearest == nearest
+		&& last_snap_.grid_snap == context_.gridSnap() && last_snap_.radius == radius
+		&& last_snap_.modifications == modifications)
+		return last_snap_.result;
+
+	last_snap_ = { true, point, nearest, context_.gridSnap(), radius, modifications, point };
+
 	// Snap to nearest vertex if necessary
 	if (nearest)
 	{
-		auto vertex = context_.map().vertices().nearest(point);
-		if (vertex)
-			point = vertex->position();
+		if (auto vertex = context_.map().vertices().nearest(point, radius))
+		{
+			last_snap_.result = vertex->position();
+			return last_snap_.result;
+		}
 	}
 
 	// Otherwise, snap to grid if necessary
-	else if (context_.gridSnap())
+	if (context_.gridSnap())
 	{
-		point.x = context_.snapToGrid(point.x);
-		point.y = context_.snapToGrid(point.y);
+		last_snap_.result.x = context_.snapToGrid(point.x);
+		last_snap_.result.y = context_.snapToGrid(point.y);
 	}
 
-	draw_origin_ = point;
+	return last_snap_.result;
 }
 
 // -----------------------------------------------------------------------------
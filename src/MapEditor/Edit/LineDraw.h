@@ -21,8 +21,9 @@ public:
 	Vec2d                point(unsigned index);
 	const vector<Vec2d>& points() const { return draw_points_; }
 
-	void setState(State new_state) { state_current_ = new_state; }
-	void setShapeOrigin(Vec2d point, bool nearest = false);
+	void  setState(State new_state) { state_current_ = new_state; }
+	void  setShapeOrigin(Vec2d point, bool nearest = false);
+	Vec2d snapPoint(Vec2d point, bool nearest) const;
 
 	bool addPoint(Vec2d point, bool nearest = false);
 	void removePoint();
@@ -35,5 +36,19 @@ private:
 	Vec2d           draw_origin_;
 	MapEditContext& context_;
 	State           state_current_ = State::Line;
+
+	// Inputs and result of the last snapPoint query, so the query can be
+	// skipped when the renderer asks again with nothing changed
+	struct SnapQuery
+	{
+		bool          valid = false;
+		Vec2d         point;
+		bool          nearest       = false;
+		bool          grid_snap     = false;
+		double        radius        = 0.;
+		unsigned long modifications = 0;
+		Vec2d         result;
+	};
+	mutable SnapQuery last_snap_;
 };
 } // namespace slade
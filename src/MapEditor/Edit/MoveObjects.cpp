@@ -116,6 +116,9 @@ bool MoveObjects::begin(Vec2d mouse_pos)
 		}
 	}
 
+	// Build the preview of the moving objects
+	context_.renderer().renderer2D().buildMovingPreview(items_, context_.editMode());
+
 	return true;
 }
 
@@ -216,7 +219,9 @@ void MoveObjects::end(bool accept)
 				move_verts[vertex->index()] = 1;
 		}
 
-		// Move vertices
+		// Move vertices (as one geometry edit, so connected geometry is only
+		// updated once at the end)
+		context_.map().beginGeometryEdit();
 		vector<MapVertex*> moved_verts;
 		for (unsigned a = 0; a < context_.map().nVertices(); a++)
 		{
@@ -238,6 +243,7 @@ void MoveObjects::end(bool accept)
 
 		// Do merge
 		bool merge = context_.map().mergeArch(moved_verts);
+		context_.map().endGeometryEdit();
 
 		context_.endUndoRecord(merge || !map_merge_undo_step);
 	}
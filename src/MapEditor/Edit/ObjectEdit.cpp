@@ -53,6 +53,99 @@ using namespace mapeditor;
 EXTERN_CVAR(Bool, map_merge_undo_step)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// An affine transform of points: linear part applied to the point relative to
+// [pre], then offset by [post]
+struct Transform
+{
+	double xx = 1, xy = 0;
+	double yx = 0, yy = 1;
+	Vec2d  pre;
+	Vec2d  post;
+
+	// Returns this transform followed by [next]
+	Transform then(const Transform& next) const
+	{
+		Transform t;
+		t.xx     = next.xx * xx + next.xy * yx;
+		t.xy     = next.xx * xy + next.xy * yy;
+		t.yx     = next.yx * xx + next.yy * yx;
+		t.yy     = next.yx * xy + next.yy * yy;
+		t.pre    = pre;
+		auto d   = post - next.pre;
+		t.post.x = next.xx * d.x + next.xy * d.y + next.post.x;
+		t.post.y = next.yx * d.x + next.yy * d.y + next.post.y;
+		return t;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Returns a transform moving points by [offset]
+// -----------------------------------------------------------------------------
+Transform moveTransform(Vec2d offset)
+{
+	Transform t;
+	t.post = offset;
+	return t;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a transform scaling points by [xscale,yscale] from [origin]
+// -----------------------------------------------------------------------------
+Transform scaleTransform(Vec2d origin, double xscale, double yscale)
+{
+	Transform t;
+	t.xx   = xscale;
+	t.yy   = yscale;
+	t.pre  = origin;
+	t.post = origin;
+	return t;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a transform rotating points around [origin] by [angle] degrees (see
+// math::rotatePoint)
+// -----------------------------------------------------------------------------
+Transform rotateTransform(Vec2d origin, double angle)
+{
+	double srot = sin(math::degToRad(angle));
+	double crot = cos(math::degToRad(angle));
+
+	Transform t;
+	t.xx   = crot;
+	t.xy   = -srot;
+	t.yx   = srot;
+	t.yy   = crot;
+	t.pre  = origin;
+	t.post = origin;
+	return t;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the first [count] points in [src] transformed by [t] to [dst].
+// There are no branches or calls in the loop so the compiler can vectorise it
+// -----------------------------------------------------------------------------
+void transformPoints(const Transform& t, const Vec2d* src, Vec2d* dst, unsigned count)
+{
+	const double xx = t.xx, xy = t.xy, yx = t.yx, yy = t.yy;
+	const double px = t.pre.x, py = t.pre.y, ox = t.post.x, oy = t.post.y;
+	for (unsigned a = 0; a < count; ++a)
+	{
+		double x = src[a].x - px;
+		double y = src[a].y - py;
+		dst[a].x = xx * x + xy * y + ox;
+		dst[a].y = yx * x + yy * y + oy;
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ObjectEditGroup Class Functions
@@ -61,21 +154,39 @@ EXTERN_CVAR(Bool, map_merge_undo_step)
 
 
 // -----------------------------------------------------------------------------
-// Adds [vertex] to the group.
+// Adds [vertex] to the group (if it isn't already in it).
 // If [ignored] is set, the vertex won't be modified by the object edit
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::addVertex(MapVertex* vertex, bool ignored)
 {
-	auto v = new Vertex{ { vertex->xPos(), vertex->yPos() }, { vertex->xPos(), vertex->yPos() }, vertex, ignored };
-
-	if (!ignored)
+	auto index = static_cast<unsigned>(positions_.size());
+	auto added = vertex_index_.try_emplace(vertex, index);
+	if (!added.second)
 	{
-		bbox_.extend(v->position.x, v->position.y);
-		old_bbox_.extend(v->position.x, v->position.y);
-		original_bbox_.extend(v->position.x, v->position.y);
+		// Already in the group, edit it if it was previously ignored
+		index = added.first->second;
+		if (ignored || index < n_edit_)
+			return;
+	}
+	else
+	{
+		Vec2d pos{ vertex->xPos(), vertex->yPos() };
+		positions_.push_back(pos);
+		old_positions_.push_back(pos);
+		map_positions_.push_back(pos);
+		map_vertices_.push_back(vertex);
+
+		if (ignored)
+			return;
 	}
 
-	vertices_.emplace_back(v);
+	// Keep edited vertices before ignored ones
+	swapVertices(index, n_edit_++);
+
+	auto& pos = map_positions_[n_edit_ - 1];
+	bbox_.extend(pos.x, pos.y);
+	old_bbox_.extend(pos.x, pos.y);
+	original_bbox_.extend(pos.x, pos.y);
 }
 
 // -----------------------------------------------------------------------------
@@ -83,33 +194,25 @@ void ObjectEditGroup::addVertex(MapVertex* vertex, bool ignored)
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::addConnectedLines()
 {
-	const auto n_v = vertices_.size();
+	const auto n_v = n_edit_;
 	for (unsigned v = 0; v < n_v; ++v) // Can't use a range-for loop here due to addVertex usage
 	{
-		auto map_vertex = vertices_[v]->map_vertex;
+		auto map_vertex = map_vertices_[v];
 		for (unsigned l = 0; l < map_vertex->nConnectedLines(); l++)
 		{
 			const auto map_line = map_vertex->connectedLine(l);
-			if (!hasLine(map_line))
-			{
-				// Create line
-				Line line{ findVertex(map_line->v1()), findVertex(map_line->v2()), map_line };
-
-				// Add extra vertex if needed (will be ignored for editing)
-				if (!line.v1)
-				{
-					addVertex(map_line->v1(), true);
-					line.v1 = vertices_.back().get();
-				}
-				if (!line.v2)
-				{
-					addVertex(map_line->v2(), true);
-					line.v2 = vertices_.back().get();
-				}
-
-				// Add line
-				lines_.push_back(line);
-			}
+			if (hasLine(map_line))
+				continue;
+
+			// Add extra vertices if needed (will be ignored for editing)
+			addVertex(map_line->v1(), true);
+			addVertex(map_line->v2(), true);
+
+			// Add line
+			auto v1 = vertex_index_[map_line->v1()];
+			auto v2 = vertex_index_[map_line->v2()];
+			line_index_.emplace(map_line, lines_.size());
+			lines_.push_back({ v1, v2, map_line, v1 >= n_edit_ || v2 >= n_edit_ });
 		}
 	}
 }
@@ -137,25 +240,18 @@ void ObjectEditGroup::addThing(MapThing* thing)
 // -----------------------------------------------------------------------------
 // Returns true if [line] is connected to the group vertices
 // -----------------------------------------------------------------------------
-bool ObjectEditGroup::hasLine(MapLine* line)
+bool ObjectEditGroup::hasLine(MapLine* line) const
 {
-	for (auto& l : lines_)
-		if (l.map_line == line)
-			return true;
-
-	return false;
+	return line_index_.find(line) != line_index_.end();
 }
 
 // -----------------------------------------------------------------------------
-// Returns the group info about [vertex]
+// Returns the index of [vertex] in the group, or -1 if it isn't in the group
 // -----------------------------------------------------------------------------
-ObjectEditGroup::Vertex* ObjectEditGroup::findVertex(MapVertex* vertex)
+int ObjectEditGroup::findVertex(MapVertex* vertex) const
 {
-	for (auto& v : vertices_)
-		if (v->map_vertex == vertex)
-			return v.get();
-
-	return nullptr;
+	auto i = vertex_index_.find(vertex);
+	return i != vertex_index_.end() ? static_cast<int>(i->second) : -1;
 }
 
 // -----------------------------------------------------------------------------
@@ -163,7 +259,13 @@ ObjectEditGroup::Vertex* ObjectEditGroup::findVertex(MapVertex* vertex)
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::clear()
 {
-	vertices_.clear();
+	positions_.clear();
+	old_positions_.clear();
+	map_positions_.clear();
+	map_vertices_.clear();
+	n_edit_ = 0;
+	vertex_index_.clear();
+	line_index_.clear();
 	lines_.clear();
 	things_.clear();
 	bbox_.reset();
@@ -179,9 +281,8 @@ void ObjectEditGroup::clear()
 void ObjectEditGroup::filterObjects(bool filter)
 {
 	// Vertices
-	for (auto& vertex : vertices_)
-		if (!vertex->ignored)
-			vertex->map_vertex->filter(filter);
+	for (unsigned a = 0; a < n_edit_; ++a)
+		map_vertices_[a]->filter(filter);
 
 	// Lines
 	for (auto& line : lines_)
@@ -201,13 +302,9 @@ void ObjectEditGroup::resetPositions()
 	bbox_.reset();
 
 	// Vertices
-	for (auto& vertex : vertices_)
-	{
-		vertex->old_position = vertex->position;
-
-		if (!vertex->ignored)
-			bbox_.extend(vertex->position.x, vertex->position.y);
-	}
+	old_positions_ = positions_;
+	for (unsigned a = 0; a < n_edit_; ++a)
+		bbox_.extend(positions_[a].x, positions_[a].y);
 
 	// Things
 	for (auto& thing : things_)
@@ -230,47 +327,19 @@ bool ObjectEditGroup::nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec
 	double min_dist = min;
 	for (auto& line : lines_)
 	{
-		double d = math::distanceToLineFast(pos, { line.v1->position, line.v2->position });
+		double d = math::distanceToLineFast(pos, { positions_[line.v1], positions_[line.v2] });
 
 		if (d < min_dist)
 		{
 			min_dist = d;
-			v1.set(line.v1->position);
-			v2.set(line.v2->position);
+			v1.set(positions_[line.v1]);
+			v2.set(positions_[line.v2]);
 		}
 	}
 
 	return (min_dist < min);
 }
 
-// -----------------------------------------------------------------------------
-// Fills [list] with the positions of all group vertices
-// -----------------------------------------------------------------------------
-void ObjectEditGroup::putVerticesToDraw(vector<Vec2d>& list)
-{
-	for (auto& vertex : vertices_)
-		if (!vertex->ignored)
-			list.push_back(vertex->position);
-}
-
-// -----------------------------------------------------------------------------
-// Fills [list] with all lines in the group
-// -----------------------------------------------------------------------------
-void ObjectEditGroup::putLinesToDraw(vector<Line>& list)
-{
-	for (auto line : lines_)
-		list.push_back(line);
-}
-
-// -----------------------------------------------------------------------------
-// Fills [list] with all things in the group
-// -----------------------------------------------------------------------------
-void ObjectEditGroup::putThingsToDraw(vector<Thing>& list)
-{
-	for (const auto& thing : things_)
-		list.push_back(thing);
-}
-
 // -----------------------------------------------------------------------------
 // Moves all group objects by [xoff,yoff]
 // -----------------------------------------------------------------------------
@@ -280,15 +349,7 @@ void ObjectEditGroup::doMove(double xoff, double yoff)
 		return;
 
 	// Update vertices
-	for (auto& vertex : vertices_)
-	{
-		// Skip ignored
-		if (vertex->ignored)
-			continue;
-
-		vertex->position.x = vertex->old_position.x + xoff;
-		vertex->position.y = vertex->old_position.y + yoff;
-	}
+	transformPoints(moveTransform({ xoff, yoff }), old_positions_.data(), positions_.data(), n_edit_);
 
 	// Update things
 	for (auto& thing : things_)
@@ -361,21 +422,9 @@ void ObjectEditGroup::doScale(double xoff, double yoff, bool left, bool top, boo
 	if (old_bbox_.height() > 0)
 		yscale = bbox_.height() / old_bbox_.height();
 
-	// Update vertices
-	for (auto& vertex : vertices_)
-	{
-		// Skip ignored
-		if (vertex->ignored)
-			continue;
-
-		// Scale
-		vertex->position.x = old_bbox_.min.x + ((vertex->old_position.x - old_bbox_.min.x) * xscale);
-		vertex->position.y = old_bbox_.min.y + ((vertex->old_position.y - old_bbox_.min.y) * yscale);
-
-		// Move
-		vertex->position.x += xofs;
-		vertex->position.y += yofs;
-	}
+	// Update vertices (scale then move)
+	auto transform = scaleTransform(old_bbox_.min, xscale, yscale).then(moveTransform({ xofs, yofs }));
+	transformPoints(transform, old_positions_.data(), positions_.data(), n_edit_);
 
 	// Update things
 	for (auto& thing : things_)
@@ -417,11 +466,7 @@ void ObjectEditGroup::doRotate(Vec2d p1, Vec2d p2, bool lock45)
 	}
 
 	// Rotate vertices
-	for (auto& vertex : vertices_)
-	{
-		if (!vertex->ignored)
-			vertex->position = math::rotatePoint(mid, vertex->old_position, rotation_);
-	}
+	transformPoints(rotateTransform(mid, rotation_), old_positions_.data(), positions_.data(), n_edit_);
 
 	// Rotate things
 	for (auto& thing : things_)
@@ -460,37 +505,14 @@ void ObjectEditGroup::doAll(
 	old_bbox_ = bbox_;
 
 
-	// Update vertices
-	for (auto& vertex : vertices_)
-	{
-		// Skip ignored
-		if (vertex->ignored)
-			continue;
-
-		// Reset first
-		vertex->position.x = vertex->map_vertex->xPos();
-		vertex->position.y = vertex->map_vertex->yPos();
-
-		// Mirror
-		if (mirror_x)
-			vertex->position.x = original_bbox_.midX() - (vertex->position.x - original_bbox_.midX());
-		if (mirror_y)
-			vertex->position.y = original_bbox_.midY() - (vertex->position.y - original_bbox_.midY());
-
-		// Scale
-		vertex->position.x = original_bbox_.midX() + (vertex->position.x - original_bbox_.midX()) * xscale;
-		vertex->position.y = original_bbox_.midY() + (vertex->position.y - original_bbox_.midY()) * yscale;
-
-		// Move
-		vertex->position.x += xoff;
-		vertex->position.y += yoff;
-
-		// Rotate
-		if (rotation != 0)
-			vertex->position = math::rotatePoint(bbox_.mid(), vertex->position, rotation);
-
-		vertex->old_position = vertex->position;
-	}
+	// Update vertices from their positions on the map:
+	// mirror and scale (from center), move, then rotate
+	auto transform = scaleTransform(original_bbox_.mid(), mirror_x ? -xscale : xscale, mirror_y ? -yscale : yscale)
+						 .then(moveTransform({ xoff, yoff }));
+	if (rotation != 0)
+		transform = transform.then(rotateTransform(bbox_.mid(), rotation));
+	transformPoints(transform, map_positions_.data(), positions_.data(), n_edit_);
+	std::copy_n(positions_.begin(), n_edit_, old_positions_.begin());
 
 
 	// Update things
@@ -538,9 +560,8 @@ void ObjectEditGroup::doAll(
 	if (rotation != 0)
 	{
 		bbox_.reset();
-		for (auto& vertex : vertices_)
-			if (!vertex->ignored)
-				bbox_.extend(vertex->position.x, vertex->position.y);
+		for (unsigned a = 0; a < n_edit_; ++a)
+			bbox_.extend(positions_[a].x, positions_[a].y);
 		for (auto& thing : things_)
 			bbox_.extend(thing.position.x, thing.position.y);
 		old_bbox_ = bbox_;
@@ -560,16 +581,16 @@ void ObjectEditGroup::applyEdit()
 {
 	// Get map
 	SLADEMap* map;
-	if (!vertices_.empty())
-		map = vertices_[0]->map_vertex->parentMap();
+	if (!map_vertices_.empty())
+		map = map_vertices_[0]->parentMap();
 	else if (!things_.empty())
 		map = things_[0].map_thing->parentMap();
 	else
 		return;
 
 	// Move vertices
-	for (auto& vertex : vertices_)
-		vertex->map_vertex->move(vertex->position.x, vertex->position.y);
+	for (unsigned a = 0; a < map_vertices_.size(); ++a)
+		map_vertices_[a]->move(positions_[a].x, positions_[a].y);
 
 	// Move things
 	for (auto& thing : things_)
@@ -583,7 +604,7 @@ void ObjectEditGroup::applyEdit()
 	{
 		for (auto& line : lines_)
 		{
-			if (!line.isExtra())
+			if (!line.extra)
 				line.map_line->flip(false);
 		}
 	}
@@ -594,10 +615,35 @@ void ObjectEditGroup::applyEdit()
 // -----------------------------------------------------------------------------
 void ObjectEditGroup::putMapVertices(vector<MapVertex*>& list)
 {
-	for (auto& vertex : vertices_)
+	list.insert(list.end(), map_vertices_.begin(), map_vertices_.begin() + n_edit_);
+}
+
+// -----------------------------------------------------------------------------
+// Swaps the group vertices at [index1] and [index2], updating any lines using
+// them
+// -----------------------------------------------------------------------------
+void ObjectEditGroup::swapVertices(unsigned index1, unsigned index2)
+{
+	if (index1 == index2)
+		return;
+
+	std::swap(positions_[index1], positions_[index2]);
+	std::swap(old_positions_[index1], old_positions_[index2]);
+	std::swap(map_positions_[index1], map_positions_[index2]);
+	std::swap(map_vertices_[index1], map_vertices_[index2]);
+	vertex_index_[map_vertices_[index1]] = index1;
+	vertex_index_[map_vertices_[index2]] = index2;
+
+	for (auto& line : lines_)
 	{
-		if (!vertex->ignored)
-			list.push_back(vertex->map_vertex);
+		for (auto* v : { &line.v1, &line.v2 })
+		{
+			if (*v == index1)
+				*v = index2;
+			else if (*v == index2)
+				*v = index1;
+		}
+		line.extra = line.v1 >= n_edit_ || line.v2 >= n_edit_;
 	}
 }
 
@@ -642,22 +688,29 @@ bool ObjectEdit::begin()
 		// Lines mode
 		else if (context_.editMode() == Mode::Lines)
 		{
-			// Get vertices of selected lines
+			// Get vertices of selected lines (duplicates are ignored when
+			// added to the group)
 			auto lines = context_.selection().selectedLines();
 			for (auto& line : lines)
 			{
-				VECTOR_ADD_UNIQUE(edit_objects, line->v1());
-				VECTOR_ADD_UNIQUE(edit_objects, line->v2());
+				edit_objects.push_back(line->v1());
+				edit_objects.push_back(line->v2());
 			}
 		}
 
 		// Sectors mode
 		else if (context_.editMode() == Mode::Sectors)
 		{
-			// Get vertices of selected sectors
-			auto sectors = context_.selection().selectedSectors();
+			// Get vertices of selected sectors (each sector's are gathered
+			// separately, duplicates are ignored when added to the group)
+			auto               sectors = context_.selection().selectedSectors();
+			vector<MapObject*> sector_vertices;
 			for (auto& sector : sectors)
-				sector->putVertices(edit_objects);
+			{
+				sector_vertices.clear();
+				sector->putVertices(sector_vertices);
+				edit_objects.insert(edit_objects.end(), sector_vertices.begin(), sector_vertices.end());
+			}
 		}
 
 		// Setup object group
@@ -706,6 +759,7 @@ void ObjectEdit::end(bool accept)
 		context_.beginUndoRecord(fmt::format("Edit {}", context_.modeString()));
 
 		// Apply changes
+		context_.map().beginGeometryEdit();
 		group_.applyEdit();
 
 		// Do merge
@@ -723,6 +777,7 @@ void ObjectEdit::end(bool accept)
 			group_.putMapVertices(vertices);
 			merge = context_.map().mergeArch(vertices);
 		}
+		context_.map().endGeometryEdit();
 
 		// Clear selection
 		context_.selection().clear();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utility/Structs.h"
+#include <unordered_map>
 
 namespace slade
 {
@@ -12,21 +13,14 @@ class MapThing;
 class ObjectEditGroup
 {
 public:
-	struct Vertex
-	{
-		Vec2d      position;
-		Vec2d      old_position;
-		MapVertex* map_vertex;
-		bool       ignored;
-	};
-
+	// A line connected to the group vertices. [v1] and [v2] are indices into
+	// the group vertex positions
 	struct Line
 	{
-		Vertex*  v1;
-		Vertex*  v2;
+		unsigned v1;
+		unsigned v2;
 		MapLine* map_line;
-
-		bool isExtra() const { return v1->ignored || v2->ignored; }
+		bool     extra; // Connected to a vertex that isn't being edited
 	};
 
 	struct Thing
@@ -40,22 +34,23 @@ public:
 	BBox   bbox() const { return bbox_; }
 	double rotation() const { return rotation_; }
 
-	void    addVertex(MapVertex* vertex, bool ignored = false);
-	void    addConnectedLines();
-	void    addThing(MapThing* thing);
-	bool    hasLine(MapLine* line);
-	Vertex* findVertex(MapVertex* vertex);
-	void    clear();
-	void    filterObjects(bool filter);
-	void    resetPositions();
-	bool    empty() const { return vertices_.empty() && things_.empty(); }
-	bool    nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec2d& v2);
-	void    putMapVertices(vector<MapVertex*>& list);
+	void addVertex(MapVertex* vertex, bool ignored = false);
+	void addConnectedLines();
+	void addThing(MapThing* thing);
+	bool hasLine(MapLine* line) const;
+	int  findVertex(MapVertex* vertex) const;
+	void clear();
+	void filterObjects(bool filter);
+	void resetPositions();
+	bool empty() const { return n_edit_ == 0 && things_.empty(); }
+	bool nearestLineEndpoints(Vec2d pos, double min, Vec2d& v1, Vec2d& v2);
+	void putMapVertices(vector<MapVertex*>& list);
 
 	// Drawing
-	void putVerticesToDraw(vector<Vec2d>& list);
-	void putLinesToDraw(vector<Line>& list);
-	void putThingsToDraw(vector<Thing>& list);
+	const vector<Vec2d>& vertexPositions() const { return positions_; }
+	unsigned             nEditVertices() const { return n_edit_; }
+	const vector<Line>&  lines() const { return lines_; }
+	const vector<Thing>& things() const { return things_; }
 
 	// Modification
 	void doMove(double xoff, double yoff);
@@ -65,15 +60,28 @@ public:
 	void applyEdit();
 
 private:
-	vector<unique_ptr<Vertex>> vertices_;
-	vector<Line>               lines_;
-	vector<Thing>              things_;
-	BBox                       bbox_;          // Current
-	BBox                       old_bbox_;      // Before drag operation
-	BBox                       original_bbox_; // From first init
-	Vec2d                      offset_prev_ = { 0, 0 };
-	double                     rotation_    = 0;
-	bool                       mirrored_    = false;
+	// Vertex positions, in contiguous arrays so they can all be transformed in
+	// one go. Vertices being edited come first ([0, n_edit_)), followed by
+	// the ignored vertices at the other end of connected lines
+	vector<Vec2d>      positions_;
+	vector<Vec2d>      old_positions_;  // Before drag operation
+	vector<Vec2d>      map_positions_;  // Current position on the actual map
+	vector<MapVertex*> map_vertices_;
+	unsigned           n_edit_ = 0;
+
+	std::unordered_map<MapVertex*, unsigned> vertex_index_;
+	std::unordered_map<MapLine*, unsigned>   line_index_;
+
+	vector<Line>  lines_;
+	vector<Thing> things_;
+	BBox          bbox_;          // Current
+	BBox          old_bbox_;      // Before drag operation
+	BBox          original_bbox_; // From first init
+	Vec2d         offset_prev_ = { 0, 0 };
+	double        rotation_    = 0;
+	bool          mirrored_    = false;
+
+	void swapVertices(unsigned index1, unsigned index2);
 };
 
 #undef None
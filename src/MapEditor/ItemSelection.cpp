@@ -41,6 +41,26 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a bounding box covering [rect]
+// -----------------------------------------------------------------------------
+BBox rectBBox(const Rectd& rect)
+{
+	BBox bbox;
+	bbox.min = { rect.left(), rect.top() };
+	bbox.max = { rect.right(), rect.bottom() };
+	return bbox;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ItemSelection Class Functions
@@ -125,6 +145,14 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 	if (hilight_lock_ || !context_)
 		return false;
 
+	// Reuse the last result if the mouse, view, mode and map haven't changed
+	// (and the hilight hasn't been changed elsewhere since)
+	auto modifications = MapObject::modificationCount();
+	if (last_query_.valid && last_query_.result == hilight_ && last_query_.mouse_pos == mouse_pos
+		&& last_query_.dist_scale == dist_scale && last_query_.edit_mode == context_->editMode()
+		&& last_query_.modifications == modifications)
+		return false;
+
 	int current = hilight_.index;
 
 	// Update hilighted object depending on mode
@@ -152,7 +180,7 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 		auto nearest = map.things().multiNearest(mouse_pos);
 		if (nearest.size() == 1)
 		{
-			auto& type = game::configuration().thingType(nearest[0]->type());
+			auto& type = nearest[0]->typeInfo();
 			if (math::distance(mouse_pos, nearest[0]->position()) <= type.radius() + (32 / dist_scale))
 				hilight_.index = nearest[0]->index();
 		}
@@ -160,7 +188,7 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 		{
 			for (auto& t : nearest)
 			{
-				auto& type = game::configuration().thingType(t->type());
+				auto& type = t->typeInfo();
 				if (math::distance(mouse_pos, t->position()) <= type.radius() + (32 / dist_scale))
 					hilight_.index = t->index();
 			}
@@ -186,6 +214,8 @@ bool ItemSelection::updateHilight(Vec2d mouse_pos, double dist_scale)
 		context_->resetLastUndoLevel();
 	}
 
+	last_query_ = { true, mouse_pos, dist_scale, context_->editMode(), modifications, hilight_ };
+
 	return current != hilight_.index;
 }
 
@@ -201,6 +231,7 @@ void ItemSelection::clear()
 
 	// Clear selection
 	selection_.clear();
+	selected_.clear();
 
 	if (context_)
 		context_->selectionUpdated();
@@ -229,8 +260,27 @@ void ItemSelection::select(const vector<mapeditor::Item>& items, bool select, bo
 	if (new_change)
 		last_change_.clear();
 
+	if (select)
+	{
+		for (auto& item : items)
+			selectItem(item);
+		return;
+	}
+
+	// When deselecting, remove all the items from the selection list at once
+	// rather than searching it for each item
+	auto count = selected_.size();
 	for (auto& item : items)
-		selectItem(item, select);
+		if (selected_.erase(itemKey(item)) > 0)
+			last_change_[item] = false;
+
+	if (selected_.size() != count)
+		selection_.erase(
+			std::remove_if(
+				selection_.begin(),
+				selection_.end(),
+				[this](const mapeditor::Item& item) { return selected_.count(itemKey(item)) == 0; }),
+			selection_.end());
 }
 
 // -----------------------------------------------------------------------------
@@ -312,9 +362,10 @@ void ItemSelection::selectVerticesWithin(const SLADEMap& map, const Rectd& rect)
 	last_change_.clear();
 
 	// Select vertices within bounds
-	for (unsigned a = 0; a < map.nVertices(); a++)
-		if (rect.contains(map.vertex(a)->position()))
-			selectItem({ (int)a, ItemType::Vertex });
+	vector<MapVertex*> vertices;
+	map.vertices().putAllInBox(rectBBox(rect), vertices);
+	for (auto vertex : vertices)
+		selectItem({ (int)vertex->index(), ItemType::Vertex });
 }
 
 // -----------------------------------------------------------------------------
@@ -325,10 +376,13 @@ void ItemSelection::selectLinesWithin(const SLADEMap& map, const Rectd& rect)
 	// Start new change set
 	last_change_.clear();
 
-	// Select lines within bounds
-	for (unsigned a = 0; a < map.nLines(); a++)
-		if (rect.contains(map.line(a)->v1()->position()) && rect.contains(map.line(a)->v2()->position()))
-			selectItem({ (int)a, ItemType::Line });
+	// Select lines within bounds (only lines overlapping the bounds need to be
+	// checked)
+	vector<MapLine*> lines;
+	map.lines().putAllInBox(rectBBox(rect), lines);
+	for (auto line : lines)
+		if (rect.contains(line->v1()->position()) && rect.contains(line->v2()->position()))
+			selectItem({ (int)line->index(), ItemType::Line });
 }
 
 // -----------------------------------------------------------------------------
@@ -339,10 +393,13 @@ void ItemSelection::selectSectorsWithin(const SLADEMap& map, const Rectd& rect)
 	// Start new change set
 	last_change_.clear();
 
-	// Select sectors within bounds
-	for (unsigned a = 0; a < map.nSectors(); a++)
-		if (map.sector(a)->boundingBox().isWithin(rect.tl, rect.br))
-			selectItem({ (int)a, ItemType::Sector });
+	// Select sectors within bounds (only sectors overlapping the bounds need to
+	// be checked)
+	vector<unsigned> indices;
+	map.sectors().putIndicesInBox(rectBBox(rect), indices);
+	for (auto index : indices)
+		if (map.sector(index)->boundingBox().isWithin(rect.tl, rect.br))
+			selectItem({ (int)index, ItemType::Sector });
 }
 
 // -----------------------------------------------------------------------------
@@ -353,10 +410,11 @@ void ItemSelection::selectThingsWithin(const SLADEMap& map, const Rectd& rect)
 	// Start new change set
 	last_change_.clear();
 
-	// Select vertices within bounds
-	for (unsigned a = 0; a < map.nThings(); a++)
-		if (rect.contains(map.thing(a)->position()))
-			selectItem({ (int)a, ItemType::Thing });
+	// Select things within bounds
+	vector<unsigned> indices;
+	map.things().putIndicesInBox(rectBBox(rect), indices);
+	for (auto index : indices)
+		selectItem({ (int)index, ItemType::Thing });
 }
 
 // -----------------------------------------------------------------------------
@@ -730,6 +788,9 @@ void ItemSelection::migrate(Mode from_edit_mode, Mode to_edit_mode)
 
 	// Apply new selection
 	selection_.assign(new_selection.begin(), new_selection.end());
+	selected_.clear();
+	for (auto& item : selection_)
+		selected_.insert(itemKey(item));
 }
 
 // -----------------------------------------------------------------------------
@@ -738,16 +799,16 @@ void ItemSelection::migrate(Mode from_edit_mode, Mode to_edit_mode)
 // -----------------------------------------------------------------------------
 void ItemSelection::selectItem(const mapeditor::Item& item, bool select)
 {
-	// Check if already selected
-	bool selected = VECTOR_EXISTS(selection_, item);
-
 	// (De)Select and update change set
-	if (select && !selected)
+	if (select)
 	{
-		selection_.push_back(item);
-		last_change_[item] = true;
+		if (selected_.insert(itemKey(item)).second)
+		{
+			selection_.push_back(item);
+			last_change_[item] = true;
+		}
 	}
-	if (!select && selected)
+	else if (selected_.erase(itemKey(item)) > 0)
 	{
 		VECTOR_REMOVE(selection_, item);
 		last_change_[item] = false;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapEditor.h"
+#include <unordered_set>
 
 namespace slade
 {
@@ -18,7 +19,6 @@ class ItemSelection
 public:
 	typedef std::map<mapeditor::Item, bool>         ChangeSet;
 	typedef vector<mapeditor::Item>::const_iterator const_iterator;
-	typedef vector<mapeditor::Item>::iterator       iterator;
 	typedef vector<mapeditor::Item>::value_type     value_type;
 
 	ItemSelection(MapEditContext* context = nullptr) : context_{ context } {}
@@ -31,9 +31,6 @@ public:
 	// Access to selection
 	const_iterator         begin() const { return selection_.begin(); }
 	const_iterator         end() const { return selection_.end(); }
-	iterator               begin() { return selection_.begin(); }
-	iterator               end() { return selection_.end(); }
-	mapeditor::Item&       operator[](unsigned index) { return selection_[index]; }
 	const mapeditor::Item& operator[](unsigned index) const { return selection_[index]; }
 
 	vector<mapeditor::Item> selectionOrHilight();
@@ -54,7 +51,7 @@ public:
 
 	bool hasHilight() const { return hilight_.index >= 0; }
 	bool hasHilightOrSelection() const { return !selection_.empty() || hilight_.index >= 0; }
-	bool isSelected(const mapeditor::Item& item) const { return VECTOR_EXISTS(selection_, item); }
+	bool isSelected(const mapeditor::Item& item) const { return selected_.count(itemKey(item)) > 0; }
 	bool isHilighted(const mapeditor::Item& item) const { return item == hilight_; }
 
 	bool updateHilight(Vec2d mouse_pos, double dist_scale);
@@ -95,6 +92,27 @@ private:
 	ChangeSet               last_change_;
 	MapEditContext*         context_ = nullptr;
 
+	// Keys (see itemKey) of all items in selection_, for quick lookup
+	std::unordered_set<uint64_t> selected_;
+
+	// Inputs and result of the last hilight query (see updateHilight), so the
+	// query can be skipped when nothing it depends on has changed
+	struct HilightQuery
+	{
+		bool            valid = false;
+		Vec2d           mouse_pos;
+		double          dist_scale    = 0.;
+		mapeditor::Mode edit_mode     = mapeditor::Mode::Vertices;
+		unsigned long   modifications = 0;
+		mapeditor::Item result;
+	};
+	HilightQuery last_query_;
+
+	static uint64_t itemKey(const mapeditor::Item& item)
+	{
+		return static_cast<uint64_t>(item.type) << 32 | static_cast<uint32_t>(item.index);
+	}
+
 	void selectItem(const mapeditor::Item& item, bool select = true);
 };
 } // namespace slade
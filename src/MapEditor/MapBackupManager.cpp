@@ -33,12 +33,13 @@
 #include "MapBackupManager.h"
 #include "App.h"
 #include "Archive/Formats/ZipArchive.h"
-#include "General/Misc.h"
 #include "MapEditor.h"
 #include "UI/MapBackupPanel.h"
 #include "UI/SDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/Compression.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -54,6 +55,94 @@ namespace
 // List of entry names to be ignored for backups
 string mb_ignore_entries[] = { "NODES",    "SSECTORS", "ZNODES",  "SEGS",     "REJECT",
 							   "BLOCKMAP", "GL_VERT",  "GL_SEGS", "GL_SSECT", "GL_NODES" };
+
+// Extension added to the names of entries stored as a delta against the same
+// entry in the previous backup
+constexpr string_view DELTA_EXT = ".delta";
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [entry1] and [entry2] have the same name and data
+// -----------------------------------------------------------------------------
+bool sameEntry(ArchiveEntry& entry1, ArchiveEntry& entry2)
+{
+	if (entry1.name() != entry2.name() || entry1.size() != entry2.size())
+		return false;
+
+	return entry1.size() == 0 || memcmp(entry1.rawData(), entry2.rawData(), entry1.size()) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the entry named [name] in [entries], checking [index] first
+// -----------------------------------------------------------------------------
+ArchiveEntry* findEntry(const vector<shared_ptr<ArchiveEntry>>& entries, unsigned index, string_view name)
+{
+	if (index < entries.size() && entries[index]->name() == name)
+		return entries[index].get();
+
+	for (auto& entry : entries)
+		if (entry->name() == name)
+			return entry.get();
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Writes a delta of [data] against [prev] to [delta]: the sizes of the data
+// at the start and end that is the same as [prev], then the data in between.
+// Returns false if the delta wouldn't be smaller than [data]
+// -----------------------------------------------------------------------------
+bool makeDelta(const MemChunk& data, const MemChunk& prev, MemChunk& delta)
+{
+	auto     size   = std::min(data.size(), prev.size());
+	uint32_t prefix = 0;
+	while (prefix < size && data[prefix] == prev[prefix])
+		++prefix;
+	uint32_t suffix = 0;
+	while (suffix < size - prefix && data[data.size() - suffix - 1] == prev[prev.size() - suffix - 1])
+		++suffix;
+
+	auto middle = data.size() - prefix - suffix;
+	if (middle + 8 >= data.size())
+		return false;
+
+	uint32_t sizes[] = { wxUINT32_SWAP_ON_BE(prefix), wxUINT32_SWAP_ON_BE(suffix) };
+	delta.clear();
+	delta.write(sizes, 8);
+	delta.write(data.data() + prefix, middle);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the original data of [delta] (see makeDelta) against [prev] to
+// [data]. Returns false if [delta] is invalid
+// -----------------------------------------------------------------------------
+bool applyDelta(const MemChunk& delta, const MemChunk& prev, MemChunk& data)
+{
+	if (delta.size() < 8)
+		return false;
+
+	auto prefix = delta.readL32(0);
+	auto suffix = delta.readL32(4);
+	if (prefix > prev.size() || suffix > prev.size() - prefix)
+		return false;
+
+	data.clear();
+	data.write(prev.data(), prefix);
+	data.write(delta.data() + 8, delta.size() - 8);
+	data.write(prev.data() + prev.size() - suffix, suffix);
+
+	return true;
+}
 } // namespace
 
 
@@ -64,30 +153,49 @@ string mb_ignore_entries[] = { "NODES",    "SSECTORS", "ZNODES",  "SEGS",     "R
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// MapBackupManager class destructor
+// -----------------------------------------------------------------------------
+MapBackupManager::~MapBackupManager()
+{
+	waitForBackups();
+}
+
 // -----------------------------------------------------------------------------
 // Writes a backup for [map_name] in [archive_name], with the map data entries
-// in [map_data]
+// in [map_data]. Entries that changed little since the previous backup are
+// stored as deltas against it. The backup archive is written to disk in the
+// background, returns false if the previous backup failed to be written or
+// this one couldn't be created
 // -----------------------------------------------------------------------------
 bool MapBackupManager::writeBackup(
 	vector<unique_ptr<ArchiveEntry>>& map_data,
 	std::string_view                  archive_name,
-	std::string_view                  map_name) const
+	std::string_view                  map_name)
 {
+	// Wait for any previous backup to be written
+	bool prev_ok = waitForBackups();
+
 	// Create backup directory if needed
 	auto backup_dir = app::path("backups", app::Dir::User);
 	if (!wxDirExists(backup_dir))
 		wxMkdir(backup_dir);
 
-	// Open or create backup zip
-	shared_ptr<Archive> backup = std::make_shared<ZipArchive>();
-	string              fname{ archive_name };
+	// Open or create backup zip (if not already open)
+	string fname{ archive_name };
 	std::replace(fname.begin(), fname.end(), '.', '_');
-	auto backup_file = fmt::format("{}/{}_backup.zip", backup_dir, fname);
-	if (!backup->open(backup_file))
-		backup->setFilename(backup_file);
+	auto  backup_file = fmt::format("{}/{}_backup.zip", backup_dir, fname);
+	auto& backup      = archives_[backup_file];
+	if (!backup)
+	{
+		backup = std::make_unique<ZipArchive>();
+		if (!backup->open(backup_file))
+			backup->setFilename(backup_file);
+		backup->setZstdCompression(compression::zstdInternal());
+	}
 
-	// Filter ignored entries
-	vector<ArchiveEntry*> backup_entries;
+	// Copy map data, without ignored entries
+	vector<shared_ptr<ArchiveEntry>> backup_entries;
 	for (auto& entry : map_data)
 	{
 		// Check for ignored entry
@@ -102,43 +210,32 @@ bool MapBackupManager::writeBackup(
 		}
 
 		if (!ignored)
-			backup_entries.push_back(entry.get());
+			backup_entries.push_back(std::make_shared<ArchiveEntry>(*entry));
 	}
 
-	// Compare with last backup (if any)
-	auto map_dir = backup->dirAtPath(map_name);
-	if (map_dir && map_dir->numSubdirs() > 0)
+	// Get the data of the last backup (if any)
+	auto& last_backup = last_backups_[fmt::format("{}/{}", backup_file, map_name)];
+	auto  map_dir     = backup->dirAtPath(map_name);
+	if (last_backup.empty() && map_dir && map_dir->numSubdirs() > 0)
+		last_backup = backupEntries(map_dir, map_dir->numSubdirs() - 1);
+
+	// Compare with last backup
+	if (!last_backup.empty() && last_backup.size() == backup_entries.size())
 	{
-		auto last_backup = map_dir->subdirAt(map_dir->numSubdirs() - 1);
-		bool same        = true;
-		if (last_backup->numEntries() != backup_entries.size())
-			same = false;
-		else
+		bool same = true;
+		for (unsigned a = 0; a < backup_entries.size(); a++)
 		{
-			for (unsigned a = 0; a < last_backup->numEntries(); a++)
+			if (!sameEntry(*backup_entries[a], *last_backup[a]))
 			{
-				auto e1 = backup_entries[a];
-				auto e2 = last_backup->entryAt(a);
-				if (e1->size() != e2->size())
-				{
-					same = false;
-					break;
-				}
-
-				uint32_t crc1 = misc::crc(e1->rawData(), e1->size());
-				uint32_t crc2 = misc::crc(e2->rawData(), e2->size());
-				if (crc1 != crc2)
-				{
-					same = false;
-					break;
-				}
+				same = false;
+				break;
 			}
 		}
 
 		if (same)
 		{
 			log::info(2, "Same data as previous backup - ignoring");
-			return true;
+			return prev_ok;
 		}
 	}
 
@@ -146,18 +243,77 @@ bool MapBackupManager::writeBackup(
 	auto timestamp = wxDateTime::Now().FormatISOCombined('_').ToStdString();
 	strutil::replaceIP(timestamp, ":", "");
 	auto dir = fmt::format("{}/{}", map_name, timestamp);
-	for (auto& entry : backup_entries)
-		backup->addEntry(std::make_shared<ArchiveEntry>(*entry), dir);
+	for (unsigned a = 0; a < backup_entries.size(); a++)
+	{
+		auto&    entry = backup_entries[a];
+		auto     prev  = findEntry(last_backup, a, entry->name());
+		MemChunk delta;
+		if (prev && makeDelta(entry->data(), prev->data(), delta))
+		{
+			auto delta_entry = std::make_shared<ArchiveEntry>(fmt::format("{}{}", entry->name(), DELTA_EXT));
+			delta_entry->importMemChunk(delta);
+			backup->addEntry(delta_entry, dir);
+		}
+		else
+			backup->addEntry(std::make_shared<ArchiveEntry>(*entry), dir);
+	}
+	last_backup = backup_entries;
 
 	// Check for max backups & remove old ones if over
 	map_dir = backup->dirAtPath(map_name);
-	while ((int)map_dir->numSubdirs() > max_map_backups)
+	while (static_cast<int>(map_dir->numSubdirs()) > max_map_backups && map_dir->numSubdirs() > 1)
+	{
+		// The next backup may be stored as deltas against the one being
+		// removed, if so replace them with the full data
+		auto next_data = backupEntries(map_dir, 1);
+		auto next      = map_dir->subdirAt(1);
+		for (unsigned a = 0; a < next->numEntries() && a < next_data.size(); a++)
+		{
+			auto entry = next->entryAt(a);
+			if (strutil::endsWith(entry->name(), DELTA_EXT))
+			{
+				entry->importMemChunk(next_data[a]->data());
+				backup->renameEntry(entry, next_data[a]->name());
+			}
+		}
+
 		backup->removeDir(map_dir->subdirAt(0)->name(), map_dir);
+	}
+
+	// Write backup file in the background. The archive itself isn't updated
+	// (entry states etc.) since that has to happen on the main thread, instead
+	// it is reopened from the written file in waitForBackups
+	auto ok     = std::make_shared<bool>(false);
+	write_file_ = backup_file;
+	write_ok_   = ok;
+	write_job_  = Job::start([archive = backup.get(), backup_file, ok](Job&) { *ok = archive->write(backup_file, false); });
+	write_job_->onComplete([backup_file, ok]() {
+		if (!*ok)
+			log::warning("Failed to write map backup file {}", backup_file);
+	});
+
+	return prev_ok;
+}
+
+// -----------------------------------------------------------------------------
+// Waits for any map backup currently being written to finish.
+// Returns false if it failed to be written
+// -----------------------------------------------------------------------------
+bool MapBackupManager::waitForBackups()
+{
+	if (!write_job_)
+		return true;
 
-	// Save backup file
-	Archive::save_backup = false;
-	bool ok              = backup->save();
-	Archive::save_backup = true;
+	write_job_->wait();
+	write_job_.reset();
+
+	// The open backup archive's entry info doesn't match the written file, so
+	// reopen it next time (if the write failed keep it, to write again)
+	bool ok = *write_ok_;
+	if (ok)
+		archives_.erase(write_file_);
+	write_file_.clear();
+	write_ok_.reset();
 
 	return ok;
 }
@@ -166,8 +322,11 @@ bool MapBackupManager::writeBackup(
 // Shows the map backups for [map_name] in [archive_name], returns the selected
 // map backup data in a WadArchive
 // -----------------------------------------------------------------------------
-Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_name) const
+Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_name)
 {
+	// Make sure the backup file is up to date
+	waitForBackups();
+
 	SDialog dlg(mapeditor::windowWx(), fmt::format("Restore {} backup", map_name), "map_backup", 500, 400);
 	auto    sizer = new wxBoxSizer(wxVERTICAL);
 	dlg.SetSizer(sizer);
@@ -191,3 +350,61 @@ Archive* MapBackupManager::openBackup(string_view archive_name, string_view map_
 
 	return nullptr;
 }
+
+// -----------------------------------------------------------------------------
+// Returns the map data entries of the backup at [index] in [map_dir] (the
+// backups directory for a map), applying any deltas against earlier backups
+// -----------------------------------------------------------------------------
+vector<shared_ptr<ArchiveEntry>> MapBackupManager::backupEntries(ArchiveDir* map_dir, unsigned index)
+{
+	if (!map_dir || index >= map_dir->numSubdirs())
+		return {};
+
+	// Find the most recent backup (up to [index]) with no deltas to start from
+	auto first = index;
+	while (first > 0)
+	{
+		auto dir       = map_dir->subdirAt(first);
+		bool has_delta = false;
+		for (unsigned a = 0; a < dir->numEntries() && !has_delta; a++)
+			has_delta = strutil::endsWith(dir->entryAt(a)->name(), DELTA_EXT);
+
+		if (!has_delta)
+			break;
+		--first;
+	}
+
+	// Build up the entries of each backup from there
+	vector<shared_ptr<ArchiveEntry>> entries;
+	vector<shared_ptr<ArchiveEntry>> prev_entries;
+	for (auto b = first; b <= index; b++)
+	{
+		auto dir = map_dir->subdirAt(b);
+		prev_entries.swap(entries);
+		entries.clear();
+		for (unsigned a = 0; a < dir->numEntries(); a++)
+		{
+			auto entry = dir->entryAt(a);
+			if (!strutil::endsWith(entry->name(), DELTA_EXT))
+			{
+				entries.push_back(std::make_shared<ArchiveEntry>(*entry));
+				continue;
+			}
+
+			// Apply delta to the entry in the previous backup
+			auto     name = entry->name().substr(0, entry->name().size() - DELTA_EXT.size());
+			auto     prev = findEntry(prev_entries, a, name);
+			MemChunk data;
+			if (!prev || !applyDelta(entry->data(), prev->data(), data))
+			{
+				log::error("Invalid map backup entry {}/{}", dir->name(), entry->name());
+				return {};
+			}
+			auto full = std::make_shared<ArchiveEntry>(name);
+			full->importMemChunk(data);
+			entries.push_back(full);
+		}
+	}
+
+	return entries;
+}
@@ -2,15 +2,34 @@
 
 namespace slade
 {
+class ArchiveDir;
 class ArchiveEntry;
 class Archive;
+class Job;
+class ZipArchive;
+
 class MapBackupManager
 {
 public:
-	MapBackupManager()  = default;
-	~MapBackupManager() = default;
+	MapBackupManager() = default;
+	~MapBackupManager();
+
+	bool     writeBackup(vector<unique_ptr<ArchiveEntry>>& map_data, string_view archive_name, string_view map_name);
+	Archive* openBackup(string_view archive_name, string_view map_name);
+	bool     waitForBackups();
+
+	static vector<shared_ptr<ArchiveEntry>> backupEntries(ArchiveDir* map_dir, unsigned index);
+
+private:
+	// Backup archives are written to disk by this job, one at a time
+	shared_ptr<Job>  write_job_;
+	string           write_file_;
+	shared_ptr<bool> write_ok_;
 
-	bool writeBackup(vector<unique_ptr<ArchiveEntry>>& map_data, string_view archive_name, string_view map_name) const;
-	Archive* openBackup(string_view archive_name, string_view map_name) const;
+	// Open backup archives (by filename) and the full data of the last backup
+	// of each map (by backup filename and map name), so they don't have to be
+	// reopened and rebuilt for each backup
+	std::map<string, unique_ptr<ZipArchive>>           archives_;
+	std::map<string, vector<shared_ptr<ArchiveEntry>>> last_backups_;
 };
 } // namespace slade
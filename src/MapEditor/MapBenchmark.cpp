@@ -0,0 +1,491 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapBenchmark.cpp
+// Description: Benchmarks for map reading/writing (with each map format
+//              handler), map checks and common editing operations (with undo
+//              recording), over maps in a corpus of archives and synthetic
+//              (generated) maps of different sizes.
+//              See Utility/Benchmark.cpp for the output format
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapBenchmark.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "Archive/Formats/WadArchive.h"
+#include "Game/Configuration.h"
+#include "General/Console.h"
+#include "General/UndoRedo.h"
+#include "MapChecks.h"
+#include "MapEditContext.h"
+#include "SLADEMap/MapFormat/MapFormatHandler.h"
+#include "SLADEMap/MapObject/MapLine.h"
+#include "SLADEMap/MapObject/MapVertex.h"
+#include "SLADEMap/SLADEMap.h"
+#include "SectorBuilder.h"
+#include "UndoSteps.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+#include <random>
+
+using namespace slade;
+using namespace benchmark;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Number of times each edit operation is run on a map
+constexpr unsigned EDIT_SAMPLES = 100;
+
+// Max. number of lines copied for each paste
+constexpr unsigned PASTE_LINES = 16;
+
+// Synthetic maps are a grid of square rooms, [rooms] x [rooms] (4 lines each)
+struct SyntheticMap
+{
+	const char* name;
+	unsigned    rooms;
+};
+constexpr SyntheticMap SYNTHETIC_MAPS[] = { { "small", 10 }, { "medium", 50 }, { "large", 160 } };
+constexpr double       ROOM_SIZE        = 128.;
+constexpr double       ROOM_SPACING     = 192.;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the name of map [format] for use in benchmark phase names
+// -----------------------------------------------------------------------------
+string formatName(MapFormat format)
+{
+	switch (format)
+	{
+	case MapFormat::Doom: return "doom";
+	case MapFormat::Hexen: return "hexen";
+	case MapFormat::Doom64: return "doom64";
+	case MapFormat::UDMF: return "udmf";
+	default: return "unknown";
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs [func], returning the time it took in ms
+// -----------------------------------------------------------------------------
+template<class F> double timed(const F& func)
+{
+	auto start = Clock::now();
+	func();
+	return elapsedMs(start);
+}
+
+// -----------------------------------------------------------------------------
+// Records undo levels for edits made to a map, the same way as
+// MapEditContext::beginUndoRecord/endUndoRecord
+// -----------------------------------------------------------------------------
+class UndoRecorder
+{
+public:
+	UndoRecorder(SLADEMap& map) : manager_{ &map } {}
+
+	UndoManager& manager() { return manager_; }
+
+	void begin(string_view name)
+	{
+		manager_.beginRecord(name);
+		MapObject::beginPropBackup(app::runTimer());
+		create_delete_ = std::make_unique<mapeditor::MapObjectCreateDeleteUS>();
+
+		// Make sure all modified objects will be picked up
+		wxMilliSleep(5);
+	}
+
+	void end()
+	{
+		MapObject::beginPropBackup(-1);
+		bool modified = manager_.recordUndoStep(std::make_unique<mapeditor::MultiMapObjectPropertyChangeUS>());
+		create_delete_->checkChanges();
+		bool created_deleted = manager_.recordUndoStep(std::move(create_delete_));
+		manager_.endRecord(modified || created_deleted);
+	}
+
+private:
+	UndoManager                                    manager_;
+	unique_ptr<mapeditor::MapObjectCreateDeleteUS> create_delete_;
+};
+
+// -----------------------------------------------------------------------------
+// Runs each standard map check (except those that need textures loaded, which
+// need an OpenGL context) on [map]
+// -----------------------------------------------------------------------------
+void benchmarkChecks(vector<Result>& results, SLADEMap& map, string_view corpus)
+{
+	for (int a = 0; a < MapCheck::NumStandardChecks; ++a)
+	{
+		auto type = static_cast<MapCheck::StandardCheck>(a);
+		if (type == MapCheck::UnknownTexture || type == MapCheck::UnknownFlat)
+			continue;
+
+		auto check = MapCheck::standardCheck(type, &map);
+		timePhase(
+			results,
+			corpus,
+			"check_" + MapCheck::standardCheckId(type),
+			map.nLines(),
+			[&check]()
+			{
+				check->doCheck();
+				return uint64_t(0);
+			});
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Runs a scripted (but randomised, with a fixed seed) sequence of editing
+// operations on [map], recording undo levels as the editor does, then undoes
+// and redoes them all. The latency of each operation is recorded
+// -----------------------------------------------------------------------------
+void benchmarkEdits(vector<Result>& results, SLADEMap& map, string_view corpus)
+{
+	if (map.nLines() == 0)
+		return;
+
+	UndoRecorder undo(map);
+	std::mt19937 rng(1234);
+	auto         bounds       = map.bounds(false);
+	auto         random_point = [&]()
+	{
+		std::uniform_real_distribution<double> x(bounds.min.x, bounds.max.x);
+		std::uniform_real_distribution<double> y(bounds.min.y, bounds.max.y);
+		return Vec2d{ std::round(x(rng)), std::round(y(rng)) };
+	};
+	auto random_line = [&]() { return map.line(rng() % map.nLines()); };
+
+	vector<double> create_line, correct_sectors, split_lines, merge_vertices, trace_sector, copy_arch, paste_arch;
+	for (unsigned a = 0; a < EDIT_SAMPLES; ++a)
+	{
+		// Line draw
+		undo.begin("Line Draw");
+		auto p1       = random_point();
+		auto p2       = p1 + Vec2d{ double(rng() % 512) - 256., double(rng() % 512) - 256. };
+		auto nl_start = map.nLines();
+		create_line.push_back(timed([&]() { map.createLine(p1, p2, 1); }));
+		vector<MapLine*> new_lines;
+		for (auto l = nl_start; l < map.nLines(); ++l)
+			new_lines.push_back(map.line(l));
+		correct_sectors.push_back(timed([&]() { map.correctSectors(new_lines); }));
+		undo.end();
+
+		// Split line
+		undo.begin("Split Line");
+		auto line   = random_line();
+		auto vertex = map.createVertex(line->getPoint(MapObject::Point::Mid));
+		split_lines.push_back(timed([&]() { map.splitLinesAt(vertex, 1); }));
+		undo.end();
+
+		// Merge vertices (as if the first vertex of a line was dragged onto
+		// the second)
+		undo.begin("Merge");
+		line     = random_line();
+		auto pos = line->v2()->position();
+		line->v1()->move(pos.x, pos.y);
+		merge_vertices.push_back(timed([&]() { map.mergeVerticesPoint(pos); }));
+		undo.end();
+
+		// Trace sector
+		SectorBuilder builder;
+		line = random_line();
+		trace_sector.push_back(timed([&]() { builder.traceSector(&map, line, rng() % 2 == 0); }));
+
+		// Copy and paste lines
+		MapArchClipboardItem clip;
+		auto                 first = rng() % map.nLines();
+		vector<MapLine*>     lines;
+		for (auto l = first; l < map.nLines() && lines.size() < PASTE_LINES; ++l)
+			lines.push_back(map.line(l));
+		copy_arch.push_back(timed([&]() { clip.addLines(lines); }));
+		undo.begin("Paste Map Architecture");
+		auto paste_pos = random_point();
+		paste_arch.push_back(timed(
+			[&]()
+			{
+				map.beginGeometryEdit();
+				auto new_verts = clip.pasteToMap(&map, paste_pos);
+				map.mergeArch(new_verts);
+				map.endGeometryEdit();
+			}));
+		undo.end();
+	}
+
+	addSampled(results, corpus, "create_line", create_line);
+	addSampled(results, corpus, "correct_sectors", correct_sectors);
+	addSampled(results, corpus, "split_lines_at", split_lines);
+	addSampled(results, corpus, "merge_vertices_point", merge_vertices);
+	addSampled(results, corpus, "trace_sector", trace_sector);
+	addSampled(results, corpus, "copy", copy_arch);
+	addSampled(results, corpus, "paste", paste_arch);
+
+	// Undo and redo everything
+	auto&          manager = undo.manager();
+	auto           levels  = manager.currentIndex() + 1;
+	vector<double> undo_times, redo_times;
+	for (int a = 0; a < levels; ++a)
+		undo_times.push_back(timed([&]() { manager.undo(); }));
+	for (int a = 0; a < levels; ++a)
+		redo_times.push_back(timed([&]() { manager.redo(); }));
+	addSampled(results, corpus, "undo", undo_times);
+	addSampled(results, corpus, "redo", redo_times);
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks reading the map described by [desc], writing it back out, map
+// checks and editing it
+// -----------------------------------------------------------------------------
+void benchmarkMap(vector<Result>& results, const Archive::MapDesc& desc, string_view corpus)
+{
+	SLADEMap map;
+	bool     ok = false;
+	timePhase(
+		results,
+		corpus,
+		"read_" + formatName(desc.format),
+		0,
+		[&]()
+		{
+			ok = map.readMap(desc);
+			return uint64_t(0);
+		});
+	if (!ok)
+	{
+		log::warning("Benchmark: Unable to read map {}", corpus);
+		results.pop_back();
+		return;
+	}
+	results.back().count = map.nLines();
+
+	timePhase(
+		results,
+		corpus,
+		"write_" + formatName(map.currentFormat()),
+		map.nLines(),
+		[&map]()
+		{
+			vector<ArchiveEntry*> entries;
+			map.writeMap(entries);
+			uint64_t bytes = 0;
+			for (auto entry : entries)
+			{
+				bytes += entry->size();
+				delete entry;
+			}
+			return bytes;
+		});
+
+	benchmarkChecks(results, map, corpus);
+	benchmarkEdits(results, map, corpus);
+}
+
+// -----------------------------------------------------------------------------
+// Generates a (UDMF) map in [map] with a grid of [rooms] x [rooms] square
+// sectors, each with a thing in the middle
+// -----------------------------------------------------------------------------
+void generateMap(SLADEMap& map, unsigned rooms)
+{
+	Archive::MapDesc desc;
+	desc.format = MapFormat::UDMF;
+	map.readMap(desc);
+
+	map.beginGeometryEdit();
+	for (unsigned y = 0; y < rooms; ++y)
+		for (unsigned x = 0; x < rooms; ++x)
+		{
+			auto sector = map.createSector();
+			sector->setFloorHeight(0);
+			sector->setCeilingHeight(128);
+			sector->setLightLevel(160);
+
+			// Vertices in clockwise order, so the sides face inwards
+			Vec2d      origin{ x * ROOM_SPACING, y * ROOM_SPACING };
+			MapVertex* verts[4] = { map.createVertex(origin),
+									map.createVertex(origin + Vec2d{ 0., ROOM_SIZE }),
+									map.createVertex(origin + Vec2d{ ROOM_SIZE, ROOM_SIZE }),
+									map.createVertex(origin + Vec2d{ ROOM_SIZE, 0. }) };
+			for (unsigned a = 0; a < 4; ++a)
+			{
+				auto line = map.createLine(verts[a], verts[(a + 1) % 4], true);
+				map.setLineSide(line, map.createSide(sector), true);
+			}
+
+			map.createThing(origin + Vec2d{ ROOM_SIZE * 0.5, ROOM_SIZE * 0.5 }, 3004);
+		}
+	map.endGeometryEdit();
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks a synthetic map with [rooms] x [rooms] sectors: generating it,
+// then writing and reading it with each map format handler. Map checks and
+// edits are run on the map read back in UDMF format
+// -----------------------------------------------------------------------------
+void benchmarkSynthetic(vector<Result>& results, string_view name, unsigned rooms)
+{
+	auto     corpus = fmt::format("synthetic_map_{}", name);
+	SLADEMap map;
+	timePhase(
+		results,
+		corpus,
+		"generate",
+		rooms * rooms * 4,
+		[&]()
+		{
+			generateMap(map, rooms);
+			return uint64_t(0);
+		});
+
+	for (auto format : { MapFormat::Doom, MapFormat::Hexen, MapFormat::Doom64, MapFormat::UDMF })
+	{
+		// Write
+		auto handler = MapFormatHandler::get(format);
+		handler->setUDMFNamespace(map.udmfNamespace());
+		vector<unique_ptr<ArchiveEntry>> entries;
+		timePhase(
+			results,
+			corpus,
+			"write_" + formatName(format),
+			map.nLines(),
+			[&]()
+			{
+				entries        = handler->writeMap(map.mapData(), {});
+				uint64_t bytes = 0;
+				for (auto& entry : entries)
+					bytes += entry->size();
+				return bytes;
+			});
+
+		// Add to a wad and read back
+		WadArchive wad;
+		wad.addNewEntry("MAP01");
+		for (auto& entry : entries)
+			wad.addEntry(shared_ptr<ArchiveEntry>(entry.release()));
+		if (format == MapFormat::UDMF)
+			wad.addNewEntry("ENDMAP");
+
+		auto maps = wad.detectMaps();
+		if (maps.empty())
+		{
+			log::warning("Benchmark: Unable to detect written {} format map", formatName(format));
+			continue;
+		}
+
+		if (format == MapFormat::UDMF)
+			benchmarkMap(results, maps[0], corpus);
+		else
+		{
+			SLADEMap read_map;
+			timePhase(
+				results,
+				corpus,
+				"read_" + formatName(format),
+				map.nLines(),
+				[&]()
+				{
+					read_map.readMap(maps[0]);
+					return uint64_t(0);
+				});
+		}
+	}
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Benchmark Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs all map benchmarks on each map in the archives (or directories) in
+// [paths], and on synthetic maps of different sizes if [synthetic] is true.
+// Returns the results of each phase
+// -----------------------------------------------------------------------------
+vector<Result> benchmark::runMapBenchmarks(const vector<string>& paths, bool synthetic)
+{
+	vector<Result> results;
+
+	for (const auto& path : paths)
+	{
+		auto archive = fileutil::dirExists(path) ? app::archiveManager().openDirArchive(path, false, true) :
+												   app::archiveManager().openArchive(path, false, true);
+		if (!archive)
+		{
+			log::warning("Benchmark: Unable to open \"{}\": {}", path, global::error);
+			continue;
+		}
+
+		for (const auto& desc : archive->detectMaps())
+			benchmarkMap(results, desc, fmt::format("{}:{}", path, desc.name));
+
+		archive->close();
+	}
+
+	if (synthetic)
+		for (const auto& map : SYNTHETIC_MAPS)
+			benchmarkSynthetic(results, map.name, map.rooms);
+
+	return results;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the map benchmarks and logs the results. Usage:
+// bench_maps <synthetic (0 or 1)> [paths...]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(bench_maps, 1, true)
+{
+	auto synthetic = strutil::asInt(args[0]) != 0;
+	auto paths     = vector<string>(args.begin() + 1, args.end());
+
+	logResults(runMapBenchmarks(paths, synthetic));
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "Utility/Benchmark.h"
+
+namespace slade::benchmark
+{
+vector<Result> runMapBenchmarks(const vector<string>& paths, bool synthetic = true);
+} // namespace slade::benchmark
@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapChecks.h"
+#include "Archive/Archive.h"
 #include "Game/Configuration.h"
 #include "Game/ThingType.h"
 #include "General/SAction.h"
@@ -41,7 +42,9 @@
 #include "UI/Dialogs/MapTextureBrowser.h"
 #include "UI/Dialogs/ThingTypeBrowser.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -78,6 +81,116 @@ std::map<MapCheck::StandardCheck, StandardCheckInfo> std_checks = {
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+struct Box
+{
+	double left, top, right, bottom;
+};
+
+// -----------------------------------------------------------------------------
+// Returns all pairs of indices (first < second) of [boxes] that overlap
+// (or touch), sorted by first then second index. Uses a sweep along the x
+// axis so only boxes that overlap on x are compared
+// -----------------------------------------------------------------------------
+vector<std::pair<unsigned, unsigned>> overlappingBoxes(const vector<Box>& boxes)
+{
+	// Sort boxes by left edge
+	vector<unsigned> order(boxes.size());
+	for (unsigned a = 0; a < order.size(); ++a)
+		order[a] = a;
+	std::sort(order.begin(), order.end(), [&](unsigned left, unsigned right) {
+		return boxes[left].left < boxes[right].left;
+	});
+
+	// Sweep through, comparing each box only with the following boxes that
+	// start before it ends
+	vector<std::pair<unsigned, unsigned>> pairs;
+	for (unsigned a = 0; a < order.size(); ++a)
+	{
+		const auto& box1 = boxes[order[a]];
+		for (auto b = a + 1; b < order.size() && boxes[order[b]].left <= box1.right; ++b)
+		{
+			const auto& box2 = boxes[order[b]];
+			if (box2.top > box1.bottom || box2.bottom < box1.top)
+				continue;
+
+			pairs.emplace_back(std::min(order[a], order[b]), std::max(order[a], order[b]));
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	return pairs;
+}
+
+// -----------------------------------------------------------------------------
+// Updates [problems] (map objects with a problem, sorted by type then index)
+// for any [objects] modified since [since] or not in the map at the last check,
+// using [has_problem] to check each one. [checked] is the sorted list of
+// objects that were in the map at the last check, and is updated to the
+// objects currently in the map
+// -----------------------------------------------------------------------------
+template<typename T, typename P, typename F>
+void recheckObjects(
+	const MapObjectList<T>& objects,
+	long                    since,
+	vector<T*>&             checked,
+	vector<P*>&             problems,
+	F&&                     has_problem)
+{
+	vector<T*> current(objects.begin(), objects.end());
+	std::sort(current.begin(), current.end());
+
+	// Remove problems for objects that were modified or are no longer in the map
+	auto stale = [&](P* problem) {
+		auto object = dynamic_cast<T*>(problem);
+		return object
+			   && (object->modifiedTime() > since || !std::binary_search(current.begin(), current.end(), object));
+	};
+	problems.erase(std::remove_if(problems.begin(), problems.end(), stale), problems.end());
+
+	// Check modified and added objects
+	for (auto object : objects)
+		if (object->modifiedTime() > since || !std::binary_search(checked.begin(), checked.end(), object))
+			if (has_problem(object))
+				problems.push_back(object);
+
+	std::sort(problems.begin(), problems.end(), [](P* left, P* right) {
+		if (left->objType() != right->objType())
+			return left->objType() < right->objType();
+		return left->index() < right->index();
+	});
+
+	checked = std::move(current);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the texture of [part] (a MapLine::Part) of [line] to [texture].
+// Returns false if [part] is invalid
+// -----------------------------------------------------------------------------
+bool setLineTexture(MapLine* line, int part, const string& texture)
+{
+	switch (part)
+	{
+	case MapLine::Part::FrontUpper: line->setStringProperty("side1.texturetop", texture); break;
+	case MapLine::Part::FrontMiddle: line->setStringProperty("side1.texturemiddle", texture); break;
+	case MapLine::Part::FrontLower: line->setStringProperty("side1.texturebottom", texture); break;
+	case MapLine::Part::BackUpper: line->setStringProperty("side2.texturetop", texture); break;
+	case MapLine::Part::BackMiddle: line->setStringProperty("side2.texturemiddle", texture); break;
+	case MapLine::Part::BackLower: line->setStringProperty("side2.texturebottom", texture); break;
+	default: return false;
+	}
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 // MissingTextureCheck Class
 //
@@ -90,6 +203,9 @@ public:
 
 	void doCheck() override
 	{
+		lines_.clear();
+		parts_.clear();
+
 		string sky_flat = game::configuration().skyFlat();
 		for (unsigned a = 0; a < map_->nLines(); a++)
 		{
@@ -199,18 +315,8 @@ public:
 
 				// Set texture if one selected
 				auto texture = browser.selectedItem()->name().ToStdString();
-				switch (parts_[index])
-				{
-				case MapLine::Part::FrontUpper: lines_[index]->setStringProperty("side1.texturetop", texture); break;
-				case MapLine::Part::FrontMiddle:
-					lines_[index]->setStringProperty("side1.texturemiddle", texture);
-					break;
-				case MapLine::Part::FrontLower: lines_[index]->setStringProperty("side1.texturebottom", texture); break;
-				case MapLine::Part::BackUpper: lines_[index]->setStringProperty("side2.texturetop", texture); break;
-				case MapLine::Part::BackMiddle: lines_[index]->setStringProperty("side2.texturemiddle", texture); break;
-				case MapLine::Part::BackLower: lines_[index]->setStringProperty("side2.texturebottom", texture); break;
-				default: return false;
-				}
+				if (!setLineTexture(lines_[index], parts_[index], texture))
+					return false;
 
 				editor->endUndoRecord();
 
@@ -226,6 +332,27 @@ public:
 		return false;
 	}
 
+	unsigned fixAll(unsigned fix_type, MapEditContext* editor) override
+	{
+		if (fix_type != 0 || lines_.empty())
+			return 0;
+
+		// Browse for one texture to set for all
+		MapTextureBrowser browser(mapeditor::windowWx(), mapeditor::TextureType::Texture, "-", map_);
+		if (browser.ShowModal() != wxID_OK)
+			return 0;
+
+		auto     texture = browser.selectedItem()->name().ToStdString();
+		unsigned fixed   = 0;
+		for (unsigned a = 0; a < lines_.size(); ++a)
+			if (setLineTexture(lines_[a], parts_[a], texture))
+				++fixed;
+
+		lines_.clear();
+		parts_.clear();
+		return fixed;
+	}
+
 	MapObject* getObject(unsigned index) override
 	{
 		if (index >= lines_.size())
@@ -244,6 +371,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Set All Textures..." : ""; }
+
 private:
 	vector<MapLine*> lines_;
 	vector<int>      parts_;
@@ -265,6 +394,7 @@ public:
 	{
 		using game::TagType;
 
+		objects_.clear();
 		for (auto& line : map_->lines())
 		{
 			if (line->special() == 0)
@@ -287,7 +417,7 @@ public:
 			for (unsigned a = 0; a < map_->nThings(); ++a)
 			{
 				// Ignore the Heresiarch which does not have a real special
-				auto& tt = game::configuration().thingType(map_->thing(a)->type());
+				auto& tt = map_->thing(a)->typeInfo();
 				if (tt.flags() & game::ThingType::Flags::Script)
 					continue;
 
@@ -368,6 +498,7 @@ public:
 	{
 		using game::TagType;
 
+		objects_.clear();
 		unsigned nlines  = map_->nLines();
 		unsigned nthings = 0;
 		if (map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF)
@@ -387,7 +518,7 @@ public:
 			// Ignore the Heresiarch which does not have a real special
 			if (thingmode)
 			{
-				auto& tt = game::configuration().thingType(((MapThing*)mo)->type());
+				auto& tt = ((MapThing*)mo)->typeInfo();
 				if (tt.flags() & game::ThingType::Flags::Script)
 					continue;
 			}
@@ -502,20 +633,24 @@ public:
 		// Clear existing intersections
 		intersections_.clear();
 
-		// Go through lines
-		for (unsigned a = 0; a < lines.size(); a++)
+		// Get line bounding boxes
+		vector<Box> boxes;
+		boxes.reserve(lines.size());
+		for (const auto& line : lines)
 		{
-			line1 = lines[a];
+			auto seg = line->seg();
+			boxes.push_back({ seg.left(), seg.top(), seg.right(), seg.bottom() });
+		}
 
-			// Go through uncompared lines
-			for (unsigned b = a + 1; b < lines.size(); b++)
-			{
-				line2 = lines[b];
+		// Go through lines with overlapping bounding boxes
+		for (const auto& pair : overlappingBoxes(boxes))
+		{
+			line1 = lines[pair.first];
+			line2 = lines[pair.second];
 
-				// Check intersection
-				if (line1->intersects(line2, pos))
-					intersections_.emplace_back(line1, line2, pos.x, pos.y);
-			}
+			// Check intersection
+			if (line1->intersects(line2, pos))
+				intersections_.emplace_back(line1, line2, pos.x, pos.y);
 		}
 	}
 
@@ -612,6 +747,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Split All Lines" : ""; }
+
 private:
 	struct Intersection
 	{
@@ -642,22 +779,31 @@ public:
 
 	void doCheck() override
 	{
-		// Go through lines
+		overlaps_.clear();
+
+		// Sort line indices by their (ordered) vertices, so lines sharing both
+		// vertices end up next to each other
+		typedef std::pair<MapVertex*, MapVertex*> VertexPair;
+		vector<std::pair<VertexPair, unsigned>>   lines;
 		for (unsigned a = 0; a < map_->nLines(); a++)
 		{
-			auto line1 = map_->line(a);
+			auto line = map_->line(a);
+			auto v1   = line->v1();
+			auto v2   = line->v2();
+			lines.push_back({ std::less<>()(v1, v2) ? VertexPair{ v1, v2 } : VertexPair{ v2, v1 }, a });
+		}
+		std::sort(lines.begin(), lines.end());
 
-			// Go through uncompared lines
-			for (unsigned b = a + 1; b < map_->nLines(); b++)
-			{
-				auto line2 = map_->line(b);
+		// Go through groups of lines sharing both vertices
+		vector<std::pair<unsigned, unsigned>> pairs;
+		for (unsigned a = 0; a < lines.size(); a++)
+			for (auto b = a + 1; b < lines.size() && lines[b].first == lines[a].first; b++)
+				pairs.emplace_back(lines[a].second, lines[b].second);
 
-				// Check for overlap (both vertices shared)
-				if ((line1->v1() == line2->v1() && line1->v2() == line2->v2())
-					|| (line1->v2() == line2->v1() && line1->v1() == line2->v2()))
-					overlaps_.emplace_back(line1, line2);
-			}
-		}
+		// Add overlaps in line order
+		std::sort(pairs.begin(), pairs.end());
+		for (const auto& pair : pairs)
+			overlaps_.emplace_back(map_->line(pair.first), map_->line(pair.second));
 	}
 
 	unsigned nProblems() override { return overlaps_.size(); }
@@ -723,6 +869,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Merge All Lines" : ""; }
+
 private:
 	struct Overlap
 	{
@@ -747,151 +895,145 @@ public:
 
 	void doCheck() override
 	{
-		double r1, r2;
+		overlaps_.clear();
 
-		// Go through things
+		// Get solid things with a radius
+		vector<MapThing*> things;
+		vector<Box>       boxes;
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
-			auto  thing1 = map_->thing(a);
-			auto& tt1    = game::configuration().thingType(thing1->type());
-			r1           = tt1.radius() - 1;
+			auto   thing = map_->thing(a);
+			auto&  tt    = thing->typeInfo();
+			double r     = tt.radius() - 1;
 
 			// Ignore if no radius
-			if (r1 < 0 || !tt1.solid())
+			if (r < 0 || !tt.solid())
 				continue;
 
-			// Go through uncompared things
-			auto map_format = map_->currentFormat();
-			bool udmf_zdoom =
-				(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "zdoom"));
-			bool udmf_eternity =
-				(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "eternity"));
-			int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
-			int max_skill = udmf_zdoom ? 17 : 5;
-			int max_class = udmf_zdoom ? 17 : 4;
-
-			for (unsigned b = a + 1; b < map_->nThings(); b++)
-			{
-				auto  thing2 = map_->thing(b);
-				auto& tt2    = game::configuration().thingType(thing2->type());
-				r2           = tt2.radius() - 1;
-
-				// Ignore if no radius
-				if (r2 < 0 || !tt2.solid())
-					continue;
+			things.push_back(thing);
+			boxes.push_back({ thing->xPos() - r, thing->yPos() - r, thing->xPos() + r, thing->yPos() + r });
+		}
 
-				// Check flags
-				// Case #1: different skill levels
-				bool shareflag = false;
-				for (int s = min_skill; s < max_skill; ++s)
+		auto map_format = map_->currentFormat();
+		bool udmf_zdoom =
+			(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "zdoom"));
+		bool udmf_eternity =
+			(map_format == MapFormat::UDMF && strutil::equalCI(game::configuration().udmfNamespace(), "eternity"));
+		int min_skill = udmf_zdoom || udmf_eternity ? 1 : 2;
+		int max_skill = udmf_zdoom ? 17 : 5;
+		int max_class = udmf_zdoom ? 17 : 4;
+
+		// Go through things with overlapping bounding boxes
+		for (const auto& pair : overlappingBoxes(boxes))
+		{
+			auto  thing1 = things[pair.first];
+			auto  thing2 = things[pair.second];
+			auto& tt1    = thing1->typeInfo();
+			auto& tt2    = thing2->typeInfo();
+
+			// Check flags
+			// Case #1: different skill levels
+			bool shareflag = false;
+			for (int s = min_skill; s < max_skill; ++s)
+			{
+				auto skill = fmt::format("skill{}", s);
+				if (game::configuration().thingBasicFlagSet(skill, thing1, map_format)
+					&& game::configuration().thingBasicFlagSet(skill, thing2, map_format))
 				{
-					auto skill = fmt::format("skill{}", s);
-					if (game::configuration().thingBasicFlagSet(skill, thing1, map_format)
-						&& game::configuration().thingBasicFlagSet(skill, thing2, map_format))
-					{
-						shareflag = true;
-						s         = max_skill;
-					}
+					shareflag = true;
+					s         = max_skill;
 				}
-				if (!shareflag)
-					continue;
+			}
+			if (!shareflag)
+				continue;
 
-				// Booleans for single, coop, deathmatch, and teamgame status for each thing
-				bool s1, s2, c1, c2, d1, d2, t1, t2;
-				s1 = game::configuration().thingBasicFlagSet("single", thing1, map_format);
-				s2 = game::configuration().thingBasicFlagSet("single", thing2, map_format);
-				c1 = game::configuration().thingBasicFlagSet("coop", thing1, map_format);
-				c2 = game::configuration().thingBasicFlagSet("coop", thing2, map_format);
-				d1 = game::configuration().thingBasicFlagSet("dm", thing1, map_format);
-				d2 = game::configuration().thingBasicFlagSet("dm", thing2, map_format);
-				t1 = t2 = false;
-
-				// Player starts
-				// P1 are automatically S and C; P2+ are automatically C;
-				// Deathmatch starts are automatically D, and team start are T.
-				if (tt1.flags() & game::ThingType::Flags::CoOpStart)
-				{
-					c1 = true;
-					d1 = t1 = false;
-					if (thing1->type() == 1)
-						s1 = true;
-					else
-						s1 = false;
-				}
-				else if (tt1.flags() & game::ThingType::Flags::DMStart)
-				{
-					s1 = c1 = t1 = false;
-					d1           = true;
-				}
-				else if (tt1.flags() & game::ThingType::Flags::TeamStart)
-				{
-					s1 = c1 = d1 = false;
-					t1           = true;
-				}
-				if (tt2.flags() & game::ThingType::Flags::CoOpStart)
-				{
-					c2 = true;
-					d2 = t2 = false;
-					if (thing2->type() == 1)
-						s2 = true;
-					else
-						s2 = false;
-				}
-				else if (tt2.flags() & game::ThingType::Flags::DMStart)
-				{
-					s2 = c2 = t2 = false;
-					d2           = true;
-				}
-				else if (tt2.flags() & game::ThingType::Flags::TeamStart)
-				{
-					s2 = c2 = d2 = false;
-					t2           = true;
-				}
+			// Booleans for single, coop, deathmatch, and teamgame status for each thing
+			bool s1, s2, c1, c2, d1, d2, t1, t2;
+			s1 = game::configuration().thingBasicFlagSet("single", thing1, map_format);
+			s2 = game::configuration().thingBasicFlagSet("single", thing2, map_format);
+			c1 = game::configuration().thingBasicFlagSet("coop", thing1, map_format);
+			c2 = game::configuration().thingBasicFlagSet("coop", thing2, map_format);
+			d1 = game::configuration().thingBasicFlagSet("dm", thing1, map_format);
+			d2 = game::configuration().thingBasicFlagSet("dm", thing2, map_format);
+			t1 = t2 = false;
+
+			// Player starts
+			// P1 are automatically S and C; P2+ are automatically C;
+			// Deathmatch starts are automatically D, and team start are T.
+			if (tt1.flags() & game::ThingType::Flags::CoOpStart)
+			{
+				c1 = true;
+				d1 = t1 = false;
+				if (thing1->type() == 1)
+					s1 = true;
+				else
+					s1 = false;
+			}
+			else if (tt1.flags() & game::ThingType::Flags::DMStart)
+			{
+				s1 = c1 = t1 = false;
+				d1           = true;
+			}
+			else if (tt1.flags() & game::ThingType::Flags::TeamStart)
+			{
+				s1 = c1 = d1 = false;
+				t1           = true;
+			}
+			if (tt2.flags() & game::ThingType::Flags::CoOpStart)
+			{
+				c2 = true;
+				d2 = t2 = false;
+				if (thing2->type() == 1)
+					s2 = true;
+				else
+					s2 = false;
+			}
+			else if (tt2.flags() & game::ThingType::Flags::DMStart)
+			{
+				s2 = c2 = t2 = false;
+				d2           = true;
+			}
+			else if (tt2.flags() & game::ThingType::Flags::TeamStart)
+			{
+				s2 = c2 = d2 = false;
+				t2           = true;
+			}
 
-				// Case #2: different game modes (single, coop, dm)
-				shareflag = false;
-				if ((c1 && c2) || (d1 && d2) || (t1 && t2))
-				{
-					shareflag = true;
-				}
-				if (!shareflag && s1 && s2)
+			// Case #2: different game modes (single, coop, dm)
+			shareflag = false;
+			if ((c1 && c2) || (d1 && d2) || (t1 && t2))
+			{
+				shareflag = true;
+			}
+			if (!shareflag && s1 && s2)
+			{
+				// Case #3: things flagged for single player with different class filters
+				for (int c = 1; c < max_class; ++c)
 				{
-					// Case #3: things flagged for single player with different class filters
-					for (int c = 1; c < max_class; ++c)
+					auto pclass = fmt::format("class{}", c);
+					if (game::configuration().thingBasicFlagSet(pclass, thing1, map_format)
+						&& game::configuration().thingBasicFlagSet(pclass, thing2, map_format))
 					{
-						auto pclass = fmt::format("class{}", c);
-						if (game::configuration().thingBasicFlagSet(pclass, thing1, map_format)
-							&& game::configuration().thingBasicFlagSet(pclass, thing2, map_format))
-						{
-							shareflag = true;
-							c         = max_class;
-						}
-					}
-				}
-				if (!shareflag)
-					continue;
-
-				// Also check player start spots in Hexen-style hubs
-				shareflag = false;
-				if (tt1.flags() & game::ThingType::Flags::CoOpStart && tt2.flags() & game::ThingType::Flags::CoOpStart)
-				{
-					if (thing1->arg(0) == thing2->arg(0))
 						shareflag = true;
+						c         = max_class;
+					}
 				}
-				if (!shareflag)
-					continue;
-
-				// Check x non-overlap
-				if (thing2->xPos() + r2 < thing1->xPos() - r1 || thing2->xPos() - r2 > thing1->xPos() + r1)
-					continue;
-
-				// Check y non-overlap
-				if (thing2->yPos() + r2 < thing1->yPos() - r1 || thing2->yPos() - r2 > thing1->yPos() + r1)
-					continue;
+			}
+			if (!shareflag)
+				continue;
 
-				// Overlap detected
-				overlaps_.emplace_back(thing1, thing2);
+			// Also check player start spots in Hexen-style hubs
+			shareflag = false;
+			if (tt1.flags() & game::ThingType::Flags::CoOpStart && tt2.flags() & game::ThingType::Flags::CoOpStart)
+			{
+				if (thing1->arg(0) == thing2->arg(0))
+					shareflag = true;
 			}
+			if (!shareflag)
+				continue;
+
+			// Overlap detected
+			overlaps_.emplace_back(thing1, thing2);
 		}
 	}
 
@@ -964,6 +1106,16 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override
+	{
+		if (fix_type == 0)
+			return "Delete All First Things";
+		if (fix_type == 1)
+			return "Delete All Second Things";
+
+		return "";
+	}
+
 private:
 	struct Overlap
 	{
@@ -987,6 +1139,9 @@ public:
 
 	void doCheck() override
 	{
+		lines_.clear();
+		parts_.clear();
+
 		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
 
 		// Go through lines
@@ -1056,6 +1211,9 @@ public:
 		}
 	}
 
+	// Textures can only be loaded on the main thread
+	bool threadSafe() const override { return false; }
+
 	unsigned nProblems() override { return lines_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1104,18 +1262,8 @@ public:
 				// Set texture if one selected
 				auto texture = browser.selectedItem()->name().ToStdString();
 				editor->beginUndoRecord("Change Texture", true, false, false);
-				switch (parts_[index])
-				{
-				case MapLine::Part::FrontUpper: lines_[index]->setStringProperty("side1.texturetop", texture); break;
-				case MapLine::Part::FrontMiddle:
-					lines_[index]->setStringProperty("side1.texturemiddle", texture);
-					break;
-				case MapLine::Part::FrontLower: lines_[index]->setStringProperty("side1.texturebottom", texture); break;
-				case MapLine::Part::BackUpper: lines_[index]->setStringProperty("side2.texturetop", texture); break;
-				case MapLine::Part::BackMiddle: lines_[index]->setStringProperty("side2.texturemiddle", texture); break;
-				case MapLine::Part::BackLower: lines_[index]->setStringProperty("side2.texturebottom", texture); break;
-				default: return false;
-				}
+				if (!setLineTexture(lines_[index], parts_[index], texture))
+					return false;
 
 				editor->endUndoRecord();
 
@@ -1131,6 +1279,27 @@ public:
 		return false;
 	}
 
+	unsigned fixAll(unsigned fix_type, MapEditContext* editor) override
+	{
+		if (fix_type != 0 || lines_.empty())
+			return 0;
+
+		// Browse for one texture to set for all
+		MapTextureBrowser browser(mapeditor::windowWx(), mapeditor::TextureType::Texture, "-", map_);
+		if (browser.ShowModal() != wxID_OK)
+			return 0;
+
+		auto     texture = browser.selectedItem()->name().ToStdString();
+		unsigned fixed   = 0;
+		for (unsigned a = 0; a < lines_.size(); ++a)
+			if (setLineTexture(lines_[a], parts_[a], texture))
+				++fixed;
+
+		lines_.clear();
+		parts_.clear();
+		return fixed;
+	}
+
 	MapObject* getObject(unsigned index) override
 	{
 		if (index >= lines_.size())
@@ -1149,6 +1318,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Set All Textures..." : ""; }
+
 private:
 	MapTextureManager* texman_ = nullptr;
 	vector<MapLine*>   lines_;
@@ -1168,6 +1339,9 @@ public:
 
 	void doCheck() override
 	{
+		sectors_.clear();
+		floor_.clear();
+
 		bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
 
 		// Go through sectors
@@ -1189,6 +1363,9 @@ public:
 		}
 	}
 
+	// Textures can only be loaded on the main thread
+	bool threadSafe() const override { return false; }
+
 	unsigned nProblems() override { return sectors_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1237,6 +1414,31 @@ public:
 		return false;
 	}
 
+	unsigned fixAll(unsigned fix_type, MapEditContext* editor) override
+	{
+		if (fix_type != 0 || sectors_.empty())
+			return 0;
+
+		// Browse for one flat to set for all
+		MapTextureBrowser browser(mapeditor::windowWx(), mapeditor::TextureType::Flat, "", map_);
+		if (browser.ShowModal() != wxID_OK)
+			return 0;
+
+		auto texture = browser.selectedItem()->name().ToStdString();
+		for (unsigned a = 0; a < sectors_.size(); ++a)
+		{
+			if (floor_[a])
+				sectors_[a]->setFloorTexture(texture);
+			else
+				sectors_[a]->setCeilingTexture(texture);
+		}
+
+		unsigned fixed = sectors_.size();
+		sectors_.clear();
+		floor_.clear();
+		return fixed;
+	}
+
 	MapObject* getObject(unsigned index) override
 	{
 		if (index >= sectors_.size())
@@ -1255,6 +1457,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Set All Flats..." : ""; }
+
 private:
 	MapTextureManager* texman_ = nullptr;
 	vector<MapSector*> sectors_;
@@ -1274,12 +1478,16 @@ public:
 
 	void doCheck() override
 	{
-		for (unsigned a = 0; a < map_->nThings(); a++)
-		{
-			auto& tt = game::configuration().thingType(map_->thing(a)->type());
-			if (!tt.defined())
-				things_.push_back(map_->thing(a));
-		}
+		things_.clear();
+		checked_.clear();
+		recheck(0);
+	}
+
+	void recheck(long since) override
+	{
+		recheckObjects(map_->things(), since, checked_, things_, [](MapThing* thing) {
+			return !thing->typeInfo().defined();
+		});
 	}
 
 	unsigned nProblems() override { return things_.size(); }
@@ -1314,6 +1522,24 @@ public:
 		return false;
 	}
 
+	unsigned fixAll(unsigned fix_type, MapEditContext* editor) override
+	{
+		if (fix_type != 0 || things_.empty())
+			return 0;
+
+		// Browse for one type to set for all
+		ThingTypeBrowser browser(mapeditor::windowWx());
+		if (browser.ShowModal() != wxID_OK)
+			return 0;
+
+		for (auto thing : things_)
+			thing->setIntProperty("type", browser.selectedType());
+
+		unsigned fixed = things_.size();
+		things_.clear();
+		return fixed;
+	}
+
 	MapObject* getObject(unsigned index) override
 	{
 		if (index >= things_.size())
@@ -1332,8 +1558,11 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Set All Types..." : ""; }
+
 private:
 	vector<MapThing*> things_;
+	vector<MapThing*> checked_;
 };
 
 
@@ -1349,6 +1578,9 @@ public:
 
 	void doCheck() override
 	{
+		things_.clear();
+		lines_.clear();
+
 		double radius;
 
 		// Get list of lines to check
@@ -1369,7 +1601,7 @@ public:
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
 			auto  thing = map_->thing(a);
-			auto& tt    = game::configuration().thingType(thing->type());
+			auto& tt    = thing->typeInfo();
 
 			// Skip if not a solid thing
 			if (!tt.solid())
@@ -1418,7 +1650,7 @@ public:
 			auto np = math::closestPointOnLine(thing->position(), line->seg());
 
 			// Get distance to move
-			double r    = game::configuration().thingType(thing->type()).radius();
+			double r    = thing->typeInfo().radius();
 			double dist = math::distance(Vec2d(), Vec2d(r, r));
 
 			editor->beginUndoRecord("Move Thing", true, false, false);
@@ -1452,6 +1684,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Move All Things" : ""; }
+
 private:
 	vector<MapLine*>  lines_;
 	vector<MapThing*> things_;
@@ -1486,10 +1720,14 @@ public:
 	void doCheck() override
 	{
 		// Go through map lines
+		invalid_refs_.clear();
 		for (unsigned a = 0; a < map_->nLines(); a++)
 			checkLine(map_->line(a));
 	}
 
+	// Map object list caches (eg. line and sector grids) may be updated
+	bool threadSafe() const override { return false; }
+
 	unsigned nProblems() override { return invalid_refs_.size(); }
 
 	string problemDesc(unsigned index) override
@@ -1591,6 +1829,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Fix All Sector References" : ""; }
+
 private:
 	struct SectorRef
 	{
@@ -1714,6 +1954,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Flip/Delete All Lines" : ""; }
+
 private:
 	vector<int> lines_;
 };
@@ -1765,7 +2007,10 @@ public:
 			int base    = game::configuration().baseSectorType(special);
 			special &= ~base;
 			sec->setIntProperty("special", special);
+			sectors_.erase(sectors_.begin() + index);
+			return true;
 		}
+
 		return false;
 	}
 
@@ -1787,6 +2032,8 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Reset All Sector Types" : ""; }
+
 private:
 	vector<int> sectors_;
 };
@@ -1804,28 +2051,31 @@ public:
 
 	void doCheck() override
 	{
-		// Go through map lines
 		objects_.clear();
-		for (unsigned a = 0; a < map_->nLines(); ++a)
-		{
-			int special = map_->line(a)->special();
-			if (game::configuration().actionSpecialName(special) == "Unknown")
-				objects_.push_back(map_->line(a));
-		}
+		checked_lines_.clear();
+		checked_things_.clear();
+		recheck(0);
+	}
+
+	void recheck(long since) override
+	{
+		// Go through map lines
+		recheckObjects(map_->lines(), since, checked_lines_, objects_, [](MapLine* line) {
+			return game::configuration().actionSpecialName(line->special()) == "Unknown";
+		});
+
 		// In Hexen or UDMF, go through map things too since they too can have specials
 		if (map_->currentFormat() == MapFormat::Hexen || map_->currentFormat() == MapFormat::UDMF)
 		{
-			for (unsigned a = 0; a < map_->nThings(); ++a)
-			{
+			recheckObjects(map_->things(), since, checked_things_, objects_, [](MapThing* thing) {
 				// Ignore the Heresiarch which does not have a real special
-				auto& tt = game::configuration().thingType(map_->thing(a)->type());
+				auto& tt = thing->typeInfo();
 				if (tt.flags() & game::ThingType::Flags::Script)
-					continue;
+					return false;
 
 				// Otherwise, check special
-				if (game::configuration().actionSpecialName(map_->thing(a)->special()) == "Unknown")
-					objects_.push_back(map_->thing(a));
-			}
+				return game::configuration().actionSpecialName(thing->special()) == "Unknown";
+			});
 		}
 	}
 
@@ -1877,8 +2127,12 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Reset All Specials" : ""; }
+
 private:
 	vector<MapObject*> objects_;
+	vector<MapLine*>   checked_lines_;
+	vector<MapThing*>  checked_things_;
 };
 
 
@@ -1894,15 +2148,16 @@ public:
 
 	void doCheck() override
 	{
-		// Go through map lines
 		things_.clear();
-		for (unsigned a = 0; a < map_->nThings(); ++a)
-		{
-			auto  thing = map_->thing(a);
-			auto& tt    = game::configuration().thingType(thing->type());
-			if (tt.flags() & game::ThingType::Flags::Obsolete)
-				things_.push_back(thing);
-		}
+		checked_.clear();
+		recheck(0);
+	}
+
+	void recheck(long since) override
+	{
+		recheckObjects(map_->things(), since, checked_, things_, [](MapThing* thing) {
+			return (thing->typeInfo().flags() & game::ThingType::Flags::Obsolete) != 0;
+		});
 	}
 
 	unsigned nProblems() override { return things_.size(); }
@@ -1951,11 +2206,43 @@ public:
 		return "";
 	}
 
+	string fixAllText(unsigned fix_type) override { return fix_type == 0 ? "Delete All Things" : ""; }
+
 private:
 	vector<MapThing*> things_;
+	vector<MapThing*> checked_;
 };
 
 
+// -----------------------------------------------------------------------------
+//
+// MapCheck Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Fixes all problems with [fix_type], returning the number fixed.
+// By default this calls fixProblem for each problem from last to first, so
+// problems removed from the list by a fix don't affect those still to be fixed
+// -----------------------------------------------------------------------------
+unsigned MapCheck::fixAll(unsigned fix_type, MapEditContext* editor)
+{
+	unsigned fixed = 0;
+	unsigned index = nProblems();
+	while (index > 0)
+	{
+		if (fixProblem(--index, fix_type, editor))
+			++fixed;
+
+		// A fix can remove other problems too
+		index = std::min(index, nProblems());
+	}
+
+	return fixed;
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // MapCheck Class Static Functions
@@ -2017,3 +2304,113 @@ string MapCheck::standardCheckId(StandardCheck type)
 {
 	return std_checks[type].id;
 }
+
+// -----------------------------------------------------------------------------
+// Runs all [checks], or rechecks anything modified since [since] if it is set.
+// Thread-safe checks are run at the same time on worker threads, then any
+// others are run on the calling thread. The map must not be modified until
+// this returns
+// -----------------------------------------------------------------------------
+void MapCheck::runChecks(const vector<MapCheck*>& checks, long since)
+{
+	PROFILE_SCOPE("MapCheck::runChecks");
+
+	vector<MapCheck*> parallel;
+	vector<MapCheck*> serial;
+	for (auto check : checks)
+		(check->threadSafe() ? parallel : serial).push_back(check);
+
+	auto run = [since](MapCheck* check) {
+		if (since >= 0)
+			check->recheck(since);
+		else
+			check->doCheck();
+	};
+
+	threadpool::parallelFor(parallel.size(), [&](size_t index) { run(parallel[index]); });
+	for (auto check : serial)
+		run(check);
+}
+
+// -----------------------------------------------------------------------------
+// Runs the standard checks [types] on every map in [archive], returning a
+// report of the problems found in each map.
+// Each map is loaded into its own SLADEMap on the calling (main) thread, since
+// reading a map uses shared state (game configuration, map specials etc.).
+// The thread-safe checks (see threadSafe) for all maps are then run on worker
+// threads, and the remaining checks on the calling thread. Checks that need
+// textures are skipped if [texman] is null
+// -----------------------------------------------------------------------------
+vector<MapCheck::MapReport> MapCheck::checkArchiveMaps(
+	Archive&                     archive,
+	const vector<StandardCheck>& types,
+	MapTextureManager*           texman)
+{
+	PROFILE_SCOPE("MapCheck::checkArchiveMaps");
+
+	auto maps = archive.detectMaps();
+
+	struct CheckedMap
+	{
+		unique_ptr<SLADEMap>         map;
+		vector<unique_ptr<MapCheck>> checks;
+	};
+	vector<CheckedMap> checked(maps.size());
+	vector<MapReport>  reports(maps.size());
+
+	// Load each map and create its checks
+	vector<MapCheck*> parallel;
+	for (unsigned a = 0; a < maps.size(); ++a)
+	{
+		auto& map = checked[a].map;
+
+		reports[a].map_name = maps[a].name;
+		map                 = std::make_unique<SLADEMap>();
+		if (!map->readMap(maps[a]))
+		{
+			reports[a].error = "Unable to read map";
+			map.reset();
+			continue;
+		}
+
+		for (auto type : types)
+		{
+			if (!texman && (type == UnknownTexture || type == UnknownFlat))
+				continue;
+
+			checked[a].checks.push_back(standardCheck(type, map.get(), texman));
+			if (checked[a].checks.back()->threadSafe())
+				parallel.push_back(checked[a].checks.back().get());
+		}
+	}
+
+	// Run thread-safe checks for all maps at once
+	threadpool::parallelFor(parallel.size(), [&](size_t index) { parallel[index]->doCheck(); });
+
+	// Run remaining checks and gather problems
+	for (unsigned a = 0; a < maps.size(); ++a)
+	{
+		for (auto& check : checked[a].checks)
+		{
+			if (!check->threadSafe())
+				check->doCheck();
+
+			for (unsigned p = 0; p < check->nProblems(); ++p)
+			{
+				MapProblem problem{ check->problemDesc(p) };
+				if (auto object = check->getObject(p))
+				{
+					problem.object_type  = object->objType();
+					problem.object_index = object->index();
+				}
+				reports[a].problems.push_back(problem);
+			}
+		}
+
+		// Done with the map
+		checked[a].checks.clear();
+		checked[a].map.reset();
+	}
+
+	return reports;
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "SLADEMap/MapObject/MapObject.h"
+
 namespace slade
 {
+class Archive;
 class SLADEMap;
 class MapTextureManager;
 class MapObject;
@@ -31,6 +34,22 @@ public:
 		NumStandardChecks
 	};
 
+	// A problem found in a map by checkArchiveMaps
+	struct MapProblem
+	{
+		string          description;
+		MapObject::Type object_type  = MapObject::Type::Object;
+		unsigned        object_index = 0;
+	};
+
+	// All problems found in a map by checkArchiveMaps
+	struct MapReport
+	{
+		string             map_name;
+		string             error; // Set if the map couldn't be read
+		vector<MapProblem> problems;
+	};
+
 	MapCheck(SLADEMap* map) : map_{ map } {}
 	virtual ~MapCheck() = default;
 
@@ -42,10 +61,30 @@ public:
 	virtual string     progressText() { return "Checking..."; }
 	virtual string     fixText(unsigned fix_type, unsigned index) { return ""; }
 
+	// Fixes all problems with [fix_type], returning the number fixed. Should be
+	// called within a batch edit (see MapEditContext::beginBatchEdit), and only
+	// if fixAllText is not empty for [fix_type]
+	virtual unsigned fixAll(unsigned fix_type, MapEditContext* editor);
+	virtual string   fixAllText(unsigned fix_type) { return ""; }
+
+	// Re-runs the check after the map was modified, only checking objects that
+	// were modified since [since] where possible (by default runs the full check)
+	virtual void recheck(long since) { doCheck(); }
+
+	// Returns false if the check can't be run on a worker thread (at the same
+	// time as other checks), eg. if it needs textures or modifies map caches
+	virtual bool threadSafe() const { return true; }
+
 	static unique_ptr<MapCheck> standardCheck(StandardCheck type, SLADEMap* map, MapTextureManager* texman = nullptr);
 	static unique_ptr<MapCheck> standardCheck(string_view type_id, SLADEMap* map, MapTextureManager* texman = nullptr);
 	static string               standardCheckDesc(StandardCheck type);
 	static string               standardCheckId(StandardCheck type);
+	static void                 runChecks(const vector<MapCheck*>& checks, long since = -1);
+
+	static vector<MapReport> checkArchiveMaps(
+		Archive&                     archive,
+		const vector<StandardCheck>& types,
+		MapTextureManager*           texman = nullptr);
 
 protected:
 	SLADEMap* map_;
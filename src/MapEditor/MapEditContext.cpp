@@ -50,7 +50,9 @@
 #include "UI/MapCanvas.h"
 #include "UI/MapEditorWindow.h"
 #include "UndoSteps.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
+#include <unordered_map>
 
 using namespace slade;
 
@@ -82,44 +84,6 @@ EXTERN_CVAR(Int, flat_drawtype)
 EXTERN_CVAR(Bool, thing_preview_lights)
 
 
-// -----------------------------------------------------------------------------
-//
-// Functions
-//
-// -----------------------------------------------------------------------------
-
-
-// -----------------------------------------------------------------------------
-// Template function to find something in an associative map.
-// M::mapped_type should be default constructible, or just provide
-// a value for the third argument (the default value if not found).
-// This really only works for value types right now, like maps to pointers.
-// -----------------------------------------------------------------------------
-template<typename M>
-#if defined(_MSC_VER) && (_MSC_VER < 1500)
-// MSVC++ 2005 will give error C2899 if attempting to compile "typename M::mapped_type()".
-typename M::mapped_type findInMap(M& m, const typename M::key_type& k, typename M::mapped_type def = M::mapped_type())
-{
-#else
-// On the other hand, other compilers will fail if this typename isn't there.
-typename M::mapped_type findInMap(
-	M&                          m,
-	const typename M::key_type& k,
-	typename M::mapped_type     def = typename M::mapped_type())
-{
-#endif
-	typename M::iterator i = m.find(k);
-	if (i == m.end())
-	{
-		return const_cast<typename M::mapped_type&>(def);
-	}
-	else
-	{
-		return i->second;
-	}
-}
-
-
 // -----------------------------------------------------------------------------
 //
 // MapEditContext Class Functions
@@ -242,7 +206,6 @@ void MapEditContext::setEditMode(Mode mode)
 		SAction::fromId("mapw_mode_3d")->setChecked();
 		KeyBind::releaseAll();
 		lockMouse(true);
-		renderer_.renderer3D().refresh();
 	}
 	mapeditor::window()->refreshToolBar();
 }
@@ -295,14 +258,22 @@ void MapEditContext::lockMouse(bool lock)
 // -----------------------------------------------------------------------------
 bool MapEditContext::update(long frametime)
 {
-	// Force an update if animations are active
-	if (renderer_.animationsActive() || selection_.hasHilight())
+	PROFILE_SCOPE("MapEditContext::update");
+
+	// Force an update if animations are active (or 3d mode is still building
+	// map geometry, or textures are still loading)
+	if (renderer_.animationsActive() || selection_.hasHilight()
+		|| (edit_mode_ == Mode::Visual && renderer_.renderer3D().updatesPending())
+		|| mapeditor::textureManager().hasPending())
 		next_frame_length_ = 2;
 
 	// Ignore if we aren't ready to update
 	if (frametime < next_frame_length_)
 		return false;
 
+	// Load textures that were deferred while rendering previous frames
+	mapeditor::textureManager().loadPending();
+
 	// Get frame time multiplier
 	double mult = (double)frametime / 10.0f;
 
@@ -619,11 +590,11 @@ void MapEditContext::updateTagged()
 			else // edit_mode == Mode::Things
 			{
 				auto thing = map_.thing(hilight_item);
-				if (game::configuration().thingType(thing->type()).flags() & game::ThingType::Flags::Script)
+				if (thing->typeInfo().flags() & game::ThingType::Flags::Script)
 					needs_tag = TagType::None;
 				else
 				{
-					needs_tag = game::configuration().thingType(thing->type()).needsTag();
+					needs_tag = thing->typeInfo().needsTag();
 					if (needs_tag == TagType::None)
 						needs_tag = game::configuration().actionSpecial(thing->special()).needsTag();
 					tag  = thing->arg(0);
@@ -1269,6 +1240,13 @@ bool MapEditContext::handleKeyBind(string_view key, Vec2d position)
 // -----------------------------------------------------------------------------
 void MapEditContext::updateDisplay()
 {
+	// Update once the current batch edit ends if there is one
+	if (batch_edit_)
+	{
+		batch_update_display_ = true;
+		return;
+	}
+
 	// Update map object properties panel
 	auto selection = selection_.selectedObjects();
 	mapeditor::openMultiObjectProperties(selection);
@@ -1377,6 +1355,10 @@ void MapEditContext::beginUndoRecordLocked(string_view name, bool mod, bool crea
 // -----------------------------------------------------------------------------
 void MapEditContext::endUndoRecord(bool success)
 {
+	// The record is ended by endBatchEdit in a batch edit
+	if (batch_edit_)
+		return;
+
 	auto manager = (edit_mode_ == Mode::Visual) ? edit_3d_.undoManager() : undo_manager_.get();
 
 	if (manager->currentlyRecording())
@@ -1402,6 +1384,40 @@ void MapEditContext::endUndoRecord(bool success)
 	map_.recomputeSpecials();
 }
 
+// -----------------------------------------------------------------------------
+// Begins a batch edit - many edits recorded as one undo level [name]. Until
+// endBatchEdit is called, any other undo records begun and ended are part of
+// the batch, and thing list, special and display updates are done only once
+// at the end
+// -----------------------------------------------------------------------------
+void MapEditContext::beginBatchEdit(string_view name)
+{
+	if (batch_edit_)
+		return;
+
+	beginUndoRecord(name);
+	batch_edit_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Ends the current batch edit, finishing its undo level (discarded if
+// [success] is false) and doing any updates deferred during it
+// -----------------------------------------------------------------------------
+void MapEditContext::endBatchEdit(bool success)
+{
+	if (!batch_edit_)
+		return;
+
+	batch_edit_ = false;
+	endUndoRecord(success);
+
+	if (batch_update_display_)
+	{
+		batch_update_display_ = false;
+		updateDisplay();
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Records an object property change undo step for [object]
 // -----------------------------------------------------------------------------
@@ -1426,6 +1442,7 @@ void MapEditContext::doUndo()
 	// Undo
 	int  time      = app::runTimer() - 1;
 	auto manager   = (edit_mode_ == Mode::Visual) ? edit_3d_.undoManager() : undo_manager_.get();
+	map_.beginGeometryEdit();
 	auto undo_name = manager->undo();
 
 	// Editor message
@@ -1441,6 +1458,7 @@ void MapEditContext::doUndo()
 		map_.updateGeometryInfo(time);
 		last_undo_level_ = "";
 	}
+	map_.endGeometryEdit();
 	updateThingLists();
 	map_.recomputeSpecials();
 }
@@ -1460,6 +1478,7 @@ void MapEditContext::doRedo()
 	// Redo
 	int  time      = app::runTimer() - 1;
 	auto manager   = (edit_mode_ == Mode::Visual) ? edit_3d_.undoManager() : undo_manager_.get();
+	map_.beginGeometryEdit();
 	auto undo_name = manager->redo();
 
 	// Editor message
@@ -1475,6 +1494,7 @@ void MapEditContext::doRedo()
 		map_.updateGeometryInfo(time);
 		last_undo_level_ = "";
 	}
+	map_.endGeometryEdit();
 	updateThingLists();
 	map_.recomputeSpecials();
 }
@@ -2045,57 +2065,42 @@ bool MapEditContext::handleAction(string_view id)
 // -----------------------------------------------------------------------------
 void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 {
-	// Get sectors and sides to copy
-	vector<MapSector*> copy_sectors;
-	vector<MapSide*>   copy_sides;
-	for (auto line : lines)
-	{
-		auto s1 = line->s1();
-		auto s2 = line->s2();
+	// Indices of the copied objects in this item
+	std::unordered_map<MapSector*, int> sector_index;
+	std::unordered_map<MapSide*, int>   side_index;
+	std::unordered_map<MapVertex*, int> vertex_index;
 
-		// Front side
-		if (s1)
-		{
-			copy_sides.push_back(s1);
-			if (std::find(copy_sectors.begin(), copy_sectors.end(), s1->sector()) == copy_sectors.end())
-				copy_sectors.push_back(s1->sector());
-		}
-
-		// Back side
-		if (s2)
+	// Copy sectors and sides
+	for (auto line : lines)
+		for (auto side : { line->s1(), line->s2() })
 		{
-			copy_sides.push_back(s2);
-			if (std::find(copy_sectors.begin(), copy_sectors.end(), s2->sector()) == copy_sectors.end())
-				copy_sectors.push_back(s2->sector());
-		}
-	}
-
-	// Copy sectors
-	for (auto& sector : copy_sectors)
-	{
-		auto copy = std::make_unique<MapSector>();
-		copy->copy(sector);
-		sectors_.push_back(std::move(copy));
-	}
-
-	// Copy sides
-	for (auto& side : copy_sides)
-	{
-		auto copy = std::make_unique<MapSide>();
-		copy->copy(side);
+			if (!side)
+				continue;
 
-		// Set relative sector
-		for (unsigned b = 0; b < copy_sectors.size(); b++)
-		{
-			if (side->sector() == copy_sectors[b])
+			// Copy sector if it hasn't been already
+			int sector = -1;
+			if (side->sector())
 			{
-				copy->setSector(sectors_[b].get());
-				break;
+				auto [i, added] = sector_index.emplace(side->sector(), static_cast<int>(sectors_.size()));
+				if (added)
+				{
+					auto copy = std::make_unique<MapSector>();
+					copy->copy(side->sector());
+					sectors_.push_back(std::move(copy));
+				}
+				sector = i->second;
 			}
-		}
 
-		sides_.push_back(std::move(copy));
-	}
+			// Copy side (with relative sector)
+			auto copy = std::make_unique<MapSide>();
+			copy->copy(side);
+			if (sector >= 0)
+				copy->setSector(sectors_[sector].get());
+
+			side_index[side] = static_cast<int>(sides_.size());
+			side_sectors_.push_back(sector);
+			sides_.push_back(std::move(copy));
+		}
 
 	// Get vertices to copy (and determine midpoint)
 	double             min_x = 9999999;
@@ -2104,34 +2109,18 @@ void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 	double             max_y = -9999999;
 	vector<MapVertex*> copy_verts;
 	for (auto line : lines)
-	{
-		auto v1 = line->v1();
-		auto v2 = line->v2();
-
-		// Add vertices to copy list
-		if (std::find(copy_verts.begin(), copy_verts.end(), v1) == copy_verts.end())
-			copy_verts.push_back(v1);
-		if (std::find(copy_verts.begin(), copy_verts.end(), v2) == copy_verts.end())
-			copy_verts.push_back(v2);
-
-		// Update min/max
-		if (v1->xPos() < min_x)
-			min_x = v1->xPos();
-		if (v1->xPos() > max_x)
-			max_x = v1->xPos();
-		if (v1->yPos() < min_y)
-			min_y = v1->yPos();
-		if (v1->yPos() > max_y)
-			max_y = v1->yPos();
-		if (v2->xPos() < min_x)
-			min_x = v2->xPos();
-		if (v2->xPos() > max_x)
-			max_x = v2->xPos();
-		if (v2->yPos() < min_y)
-			min_y = v2->yPos();
-		if (v2->yPos() > max_y)
-			max_y = v2->yPos();
-	}
+		for (auto vertex : { line->v1(), line->v2() })
+		{
+			// Add vertex to copy list
+			if (vertex_index.emplace(vertex, static_cast<int>(copy_verts.size())).second)
+				copy_verts.push_back(vertex);
+
+			// Update min/max
+			min_x = std::min(min_x, vertex->xPos());
+			max_x = std::max(max_x, vertex->xPos());
+			min_y = std::min(min_y, vertex->yPos());
+			max_y = std::max(max_y, vertex->yPos());
+		}
 
 	// Determine midpoint
 	double mid_x = min_x + ((max_x - min_x) * 0.5);
@@ -2149,46 +2138,22 @@ void MapArchClipboardItem::addLines(const vector<MapLine*>& lines)
 	// Copy lines
 	for (auto line : lines)
 	{
-		// Get relative sides
-		MapSide* s1       = nullptr;
-		MapSide* s2       = nullptr;
-		bool     s1_found = false;
-		bool     s2_found = !(line->s2());
-		for (unsigned i = 0; i < copy_sides.size(); i++)
-		{
-			if (line->s1() == copy_sides[i])
-			{
-				s1       = sides_[i].get();
-				s1_found = true;
-			}
-			if (line->s2() == copy_sides[i])
-			{
-				s2       = sides_[i].get();
-				s2_found = true;
-			}
-
-			if (s1_found && s2_found)
-				break;
-		}
-
-		// Get relative vertices
-		MapVertex* v1 = nullptr;
-		MapVertex* v2 = nullptr;
-		for (unsigned i = 0; i < copy_verts.size(); i++)
-		{
-			if (line->v1() == copy_verts[i])
-				v1 = vertices_[i].get();
-			if (line->v2() == copy_verts[i])
-				v2 = vertices_[i].get();
-
-			if (v1 && v2)
-				break;
-		}
+		// Get relative vertices and sides
+		LineRefs refs;
+		refs.v1 = vertex_index[line->v1()];
+		refs.v2 = vertex_index[line->v2()];
+		refs.s1 = line->s1() ? side_index[line->s1()] : -1;
+		refs.s2 = line->s2() ? side_index[line->s2()] : -1;
 
 		// Copy line
-		auto copy = std::make_unique<MapLine>(v1, v2, s1, s2);
+		auto copy = std::make_unique<MapLine>(
+			vertices_[refs.v1].get(),
+			vertices_[refs.v2].get(),
+			refs.s1 >= 0 ? sides_[refs.s1].get() : nullptr,
+			refs.s2 >= 0 ? sides_[refs.s2].get() : nullptr);
 		copy->copy(line);
 		lines_.push_back(std::move(copy));
+		line_refs_.push_back(refs);
 	}
 }
 
@@ -2210,65 +2175,46 @@ string MapArchClipboardItem::info() const
 // -----------------------------------------------------------------------------
 vector<MapVertex*> MapArchClipboardItem::pasteToMap(SLADEMap* map, Vec2d position)
 {
-	std::map<MapVertex*, MapVertex*> vertMap;
-	std::map<MapSector*, MapSector*> sectMap;
-	std::map<MapSide*, MapSide*>     sideMap;
-	// Not used yet...
-	// std::map<MapLine*, MapLine*> lineMap;
-
 	// Add vertices
 	vector<MapVertex*> new_verts;
+	new_verts.reserve(vertices_.size());
 	for (auto& vertex : vertices_)
 	{
 		new_verts.push_back(map->createVertex(position + vertex->position()));
 		new_verts.back()->copy(vertex.get());
-		vertMap[vertex.get()] = new_verts.back();
 	}
 
 	// Add sectors
+	vector<MapSector*> new_sectors;
+	new_sectors.reserve(sectors_.size());
 	for (auto& sector : sectors_)
 	{
-		auto new_sector = map->createSector();
-		new_sector->copy(sector.get());
-		sectMap[sector.get()] = new_sector;
+		new_sectors.push_back(map->createSector());
+		new_sectors.back()->copy(sector.get());
 	}
 
 	// Add sides
-	// int first_new_side = map->nSides();
-	for (auto& side : sides_)
+	vector<MapSide*> new_sides;
+	new_sides.reserve(sides_.size());
+	for (unsigned a = 0; a < sides_.size(); a++)
 	{
 		// Get relative sector
-		auto sector = findInMap(sectMap, side->sector());
+		auto sector = side_sectors_[a] >= 0 ? new_sectors[side_sectors_[a]] : nullptr;
 
-		auto new_side = map->createSide(sector);
-		new_side->copy(side.get());
-		sideMap[side.get()] = new_side;
+		new_sides.push_back(map->createSide(sector));
+		new_sides.back()->copy(sides_[a].get());
 	}
 
 	// Add lines
-	// int first_new_line = map->nLines();
-	for (auto& line : lines_)
+	for (unsigned a = 0; a < lines_.size(); a++)
 	{
-		// Get relative vertices
-		auto v1 = findInMap(vertMap, line->v1());
-		auto v2 = findInMap(vertMap, line->v2());
-
-		if (!v1)
-		{
-			log::info(1, "no v1");
-			continue;
-		}
-		if (!v2)
-		{
-			log::info(1, "no v2");
-		}
-
-		auto newline = map->createLine(v1, v2, true);
-		newline->copy(line.get());
+		const auto& refs    = line_refs_[a];
+		auto        newline = map->createLine(new_verts[refs.v1], new_verts[refs.v2], true);
+		newline->copy(lines_[a].get());
 
 		// Set relative sides
-		auto newS1 = findInMap(sideMap, line->s1());
-		auto newS2 = findInMap(sideMap, line->s2());
+		auto newS1 = refs.s1 >= 0 ? new_sides[refs.s1] : nullptr;
+		auto newS2 = refs.s2 >= 0 ? new_sides[refs.s2] : nullptr;
 		if (newS1)
 			newline->setS1(newS1);
 		if (newS2)
@@ -2449,12 +2395,14 @@ CONSOLE_COMMAND(m_check, 0, true)
 	}
 
 	// Run checks
+	vector<MapCheck*> run_checks;
 	for (auto& check : checks)
-	{
-		// Run
-		log::console(check->progressText());
-		check->doCheck();
+		run_checks.push_back(check.get());
+	log::console("Checking...");
+	MapCheck::runChecks(run_checks);
 
+	for (auto& check : checks)
+	{
 		// Check if no problems found
 		if (check->nProblems() == 0)
 			log::console(check->problemDesc(0));
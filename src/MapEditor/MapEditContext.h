@@ -120,6 +120,9 @@ public:
 	void doUndo();
 	void doRedo();
 	void resetLastUndoLevel() { last_undo_level_ = ""; }
+	void beginBatchEdit(string_view name);
+	void endBatchEdit(bool success = true);
+	bool batchEdit() const { return batch_edit_; }
 
 	// Overlays
 	MCOverlay* currentOverlay() const { return overlay_current_.get(); }
@@ -176,6 +179,10 @@ private:
 	bool   undo_deleted_  = false;
 	string last_undo_level_;
 
+	// Batch edit (see beginBatchEdit)
+	bool batch_edit_           = false;
+	bool batch_update_display_ = false;
+
 	// Tagged items
 	vector<MapSector*> tagged_sectors_;
 	vector<MapLine*>   tagged_lines_;
@@ -243,10 +250,22 @@ public:
 	Vec2d              midpoint() const { return midpoint_; }
 
 private:
+	// References from copied lines to their vertices and sides, as indices
+	// into vertices_ and sides_ (-1 for no side)
+	struct LineRefs
+	{
+		int v1 = -1;
+		int v2 = -1;
+		int s1 = -1;
+		int s2 = -1;
+	};
+
 	vector<unique_ptr<MapVertex>> vertices_;
 	vector<unique_ptr<MapSide>>   sides_;
 	vector<unique_ptr<MapLine>>   lines_;
 	vector<unique_ptr<MapSector>> sectors_;
+	vector<int>                   side_sectors_; // Index of each side's sector in sectors_ (or -1)
+	vector<LineRefs>              line_refs_;
 	Vec2d                         midpoint_;
 };
 
@@ -32,6 +32,7 @@
 //
 // -----------------------------------------------------------------------------
 #include "Main.h"
+#include "General/UndoRedo.h"
 #include "MapBackupManager.h"
 #include "MapEditContext.h"
 #include "MapEditor/UI/Dialogs/MapTextureBrowser.h"
@@ -45,6 +46,7 @@
 #include "UI/PropsPanel/MapObjectPropsPanel.h"
 #include "UI/SDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/MemoryStats.h"
 
 using namespace slade;
 
@@ -526,3 +528,30 @@ mapeditor::ItemType mapeditor::itemTypeFromObject(const MapObject* object)
 	default: return ItemType::Any;
 	}
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counts memory used by the currently open map (objects, undo levels and
+// textures)
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(map_editor, "Map Editor")
+{
+	if (!mapeditor::edit_context)
+		return;
+
+	auto map_usage = mapeditor::edit_context->map().mapData().memoryUsage();
+	usage.push_back({ {}, "Map objects", map_usage.objects, map_usage.count });
+	usage.push_back({ {}, "Map object properties", map_usage.properties });
+
+	if (auto undo_manager = mapeditor::edit_context->undoManager())
+		usage.push_back({ {}, "Undo levels", undo_manager->memoryUsage(), undo_manager->nUndoLevels() });
+
+	mapeditor::texture_manager.countMemory(usage);
+}
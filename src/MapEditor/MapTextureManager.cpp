@@ -46,6 +46,8 @@
 #include "MapEditor.h"
 #include "OpenGL/OpenGL.h"
 #include "UI/Controls/PaletteChooser.h"
+#include "Utility/MemoryStats.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -61,6 +63,41 @@ namespace
 MapTextureManager::Texture tex_invalid;
 }
 CVAR(Int, map_tex_filter, 0, CVar::Flag::Save)
+CVAR(Bool, map_tex_arrays, true, CVar::Flag::Save)
+CVAR(Int, map_tex_load_ms, 10, CVar::Flag::Save)
+CVAR(Int, map_tex_vram_budget, 512, CVar::Flag::Save) // In MB, 0 for no limit
+namespace
+{
+// Textures not drawn for this many frames can be evicted when over budget
+constexpr unsigned EVICT_UNUSED_FRAMES = 300;
+
+// How often (in frames) texture memory use is checked against the budget
+constexpr unsigned BUDGET_CHECK_FRAMES = 60;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the texture filter to use for map textures and flats
+// -----------------------------------------------------------------------------
+gl::TexFilter textureFilter()
+{
+	if (map_tex_filter == 0)
+		return gl::TexFilter::NearestLinearMin;
+	if (map_tex_filter == 2)
+		return gl::TexFilter::LinearMipmap;
+	if (map_tex_filter == 3)
+		return gl::TexFilter::NearestMipmap;
+
+	return gl::TexFilter::Linear;
+}
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -110,6 +147,47 @@ Palette* MapTextureManager::resourcePalette() const
 		return theMainWindow->paletteChooser()->selectedPalette();
 }
 
+// -----------------------------------------------------------------------------
+// Returns the resource that the texture matching [name] would be loaded from
+// by texture (not mixed), without loading it
+// -----------------------------------------------------------------------------
+MapTextureManager::Resource MapTextureManager::textureResource(string_view name) const
+{
+	Resource resource;
+	resource.archive = archive_.lock().get();
+
+	// Composite texture
+	resource.ctex = app::resources().getTexture(name, "WallTexture", resource.archive);
+	if (!resource.ctex)
+		resource.ctex = app::resources().getTexture(name, "", resource.archive);
+	if (resource.ctex)
+		return resource;
+
+	// HIRES or TEXTURES
+	resource.entry = app::resources().getHiresEntry(name, resource.archive);
+	if (!resource.entry)
+		resource.entry = app::resources().getTextureEntry(name, "textures", resource.archive);
+
+	return resource;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the resource that the flat matching [name] would be loaded from by
+// flat (not mixed), without loading it
+// -----------------------------------------------------------------------------
+MapTextureManager::Resource MapTextureManager::flatResource(string_view name) const
+{
+	Resource resource;
+	resource.archive = archive_.lock().get();
+
+	// HIRES or flat
+	resource.entry = app::resources().getHiresEntry(name, resource.archive);
+	if (!resource.entry)
+		resource.entry = app::resources().getFlatEntry(name, resource.archive);
+
+	return resource;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the texture matching [name], loading it from resources if necessary.
 // If [mixed] is true, flats are also searched if no matching texture is found
@@ -120,27 +198,18 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 	auto& mtex = textures_[strutil::upper(name)];
 
 	// Get desired filter type
-	auto filter = gl::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = gl::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = gl::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = gl::TexFilter::LinearMipmap;
-	else if (map_tex_filter == 3)
-		filter = gl::TexFilter::NearestMipmap;
+	auto filter = textureFilter();
 
-	// If the texture is loaded
-	if (mtex.gl_id)
-	{
-		// If the texture filter matches the desired one, return it
-		if (gl::Texture::info(mtex.gl_id).filter == filter)
-			return mtex;
+	// If the texture is loaded (and not evicted), return it
+	unsigned reload_id = 0;
+	if (mtex.gl_id && !checkReload(mtex, filter, reload_id))
+		return mtex;
 
-		// Otherwise, reload the texture
-		gl::Texture::clear(mtex.gl_id);
-		mtex.gl_id = 0;
-	}
+	// Check if loading should be deferred
+	if (deferLoad(mtex, { PendingLoad::Type::Texture, string{ name }, mixed }))
+		return mtex;
+
+	PROFILE_SCOPE("MapTextureManager::loadTexture");
 
 	// Texture not found or unloaded, look for it
 
@@ -154,7 +223,7 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 		SImage image;
 		if (ctex->toImage(image, archive, palette_.get(), true))
 		{
-			mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+			uploadImage(mtex, reload_id, image, palette_.get(), filter);
 
 			double sx = ctex->scaleX();
 			if (sx == 0.0)
@@ -171,41 +240,24 @@ const MapTextureManager::Texture& MapTextureManager::texture(string_view name, b
 	// No composite match, look for stand-alone textures
 	else
 	{
-		// HIRES
+		// HIRES (scaled to the size of the matching TEXTURES image, if any)
 		if (auto* etex = app::resources().getHiresEntry(name, archive))
 		{
-			SImage image;
-			if (misc::loadImageFromEntry(&image, etex))
-			{
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
-
-				if (auto* ref = app::resources().getTextureEntry(name, "textures", archive))
-				{
-					SImage imgref;
-					if (misc::loadImageFromEntry(&imgref, ref))
-					{
-						int w, h, sw, sh;
-						w                  = image.width();
-						h                  = image.height();
-						sw                 = imgref.width();
-						sh                 = imgref.height();
-						mtex.world_panning = true;
-						mtex.scale         = { (double)sw / (double)w, (double)sh / (double)h };
-					}
-				}
-			}
+			auto* ref = app::resources().getTextureEntry(name, "textures", archive);
+			loadEntryTexture(mtex, reload_id, etex, ref, CacheVariant::Tiled, filter);
 		}
 
 		// TEXTURES
 		else
 		{
-			SImage image;
 			etex = app::resources().getTextureEntry(name, "textures", archive);
-			if (misc::loadImageFromEntry(&image, etex))
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+			loadEntryTexture(mtex, reload_id, etex, nullptr, CacheVariant::Tiled, filter);
 		}
 	}
 
+	// Evicted texture couldn't be reloaded
+	gl::Texture::clear(reload_id);
+
 	// Not found
 	if (!mtex.gl_id)
 	{
@@ -230,32 +282,24 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 	auto& mtex = flats_[strutil::upper(name)];
 
 	// Get desired filter type
-	auto filter = gl::TexFilter::Linear;
-	if (map_tex_filter == 0)
-		filter = gl::TexFilter::NearestLinearMin;
-	else if (map_tex_filter == 1)
-		filter = gl::TexFilter::Linear;
-	else if (map_tex_filter == 2)
-		filter = gl::TexFilter::LinearMipmap;
-	else if (map_tex_filter == 3)
-		filter = gl::TexFilter::NearestMipmap;
+	auto filter = textureFilter();
 
-	// If the texture is loaded
-	if (mtex.gl_id)
-	{
-		// If the texture filter matches the desired one, return it
-		if (gl::Texture::info(mtex.gl_id).filter == filter)
-			return mtex;
-		
-		// Otherwise, reload the texture
-		gl::Texture::clear(mtex.gl_id);
-		mtex.gl_id = 0;
-	}
+	// If the texture is loaded (and not evicted), return it
+	unsigned reload_id = 0;
+	if (mtex.gl_id && !checkReload(mtex, filter, reload_id))
+		return mtex;
+
+	// Check if loading should be deferred
+	if (deferLoad(mtex, { PendingLoad::Type::Flat, string{ name }, mixed }))
+		return mtex;
+
+	PROFILE_SCOPE("MapTextureManager::loadFlat");
 
 	// Prioritize standalone textures
 	auto archive = archive_.lock().get();
 	if (mixed && app::resources().getTextureEntry(name, "textures", archive))
 	{
+		gl::Texture::clear(reload_id);
 		return texture(name, false);
 	}
 
@@ -267,7 +311,9 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 			SImage image;
 			if (ctex->toImage(image, archive, palette_.get(), true))
 			{
-				mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
+				uploadImage(mtex, reload_id, image, palette_.get(), filter);
+				if (mtex.gl_id)
+					addToFlatArray(mtex, image);
 
 				double sx = ctex->scaleX();
 				if (sx == 0.0)
@@ -287,37 +333,19 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 	// Try to search for an actual flat
 	if (!mtex.gl_id)
 	{
-		auto* entry = app::resources().getFlatEntry(name, archive);
+		auto* entry       = app::resources().getFlatEntry(name, archive);
 		auto* hires_entry = app::resources().getHiresEntry(name, archive);
-		auto* image_entry = hires_entry;
-		auto* scale_entry = entry;
-		
-		// No high-res texture found
-		if (!image_entry)
-		{
-			image_entry = entry;
-			scale_entry = nullptr;
-		}
-		
-		// Load the image
-		SImage image;
-		if (misc::loadImageFromEntry(&image, image_entry))
-			mtex.gl_id = gl::Texture::createFromImage(image, palette_.get(), filter);
-		
-		// Get high-res texture scale
-		if (scale_entry)
-		{
-			SImage lores_image;
-			if (misc::loadImageFromEntry(&lores_image, scale_entry))
-			{
-				double scale_x = static_cast<double>(lores_image.width()) / static_cast<double>(image.width());
-				double scale_y = static_cast<double>(lores_image.height()) / static_cast<double>(image.height());
-				mtex.world_panning = true;
-				mtex.scale = { scale_x, scale_y };
-			}
-		}
+
+		// Load the image (a high-res texture is scaled to the size of the flat)
+		if (hires_entry)
+			loadEntryTexture(mtex, reload_id, hires_entry, entry, CacheVariant::Tiled, filter, true);
+		else
+			loadEntryTexture(mtex, reload_id, entry, nullptr, CacheVariant::Tiled, filter, true);
 	}
 
+	// Evicted flat couldn't be reloaded
+	gl::Texture::clear(reload_id);
+
 	// Not found
 	if (!mtex.gl_id)
 	{
@@ -332,6 +360,119 @@ const MapTextureManager::Texture& MapTextureManager::flat(string_view name, bool
 	return mtex;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the GL id of flat texture array [index], (re)uploading it first if
+// any flats were added to it since it was last used
+// -----------------------------------------------------------------------------
+unsigned MapTextureManager::flatArray(int index)
+{
+	if (index < 0 || index >= static_cast<int>(flat_arrays_.size()))
+		return 0;
+
+	auto& array  = *flat_arrays_[index];
+	auto  filter = textureFilter();
+	if (array.updated && array.gl_id && gl::Texture::info(array.gl_id).filter == filter)
+		return array.gl_id;
+
+	gl::Texture::clear(array.gl_id);
+	array.gl_id = gl::Texture::create(filter);
+	if (!gl::Texture::loadArrayData(array.gl_id, array.data.data(), array.size.x, array.size.y, array.layers))
+	{
+		gl::Texture::clear(array.gl_id);
+		array.gl_id = 0;
+	}
+	array.updated = true;
+
+	return array.gl_id;
+}
+
+// -----------------------------------------------------------------------------
+// Loads textures, flats and sprites that were deferred (see setDeferLoading),
+// for up to
+// map_tex_load_ms. Any time left after that is used to load prefetched
+// textures and flats (see prefetchTexture). This also starts the time limit
+// for loading textures while rendering the next frame, so should be called
+// once before rendering each frame. Returns true if any were loaded
+// -----------------------------------------------------------------------------
+bool MapTextureManager::loadPending()
+{
+	load_start_ = app::runTimer();
+
+	// Evict unused textures if over budget, and queue evicted textures that
+	// were drawn last frame for reloading
+	gl::Texture::nextFrame();
+	updateResidency();
+
+	if (pending_.empty() && prefetch_.empty())
+		return false;
+
+	// Load (at least one) in the order they were requested
+	auto     defer  = defer_loading_;
+	unsigned loaded = 0;
+	defer_loading_  = false;
+	while (loaded < pending_.size() && (loaded == 0 || app::runTimer() - load_start_ < map_tex_load_ms))
+		load(pending_[loaded++]);
+	pending_.erase(pending_.begin(), pending_.begin() + loaded);
+	if (loaded > 0)
+		pending_loaded_time_ = app::runTimer();
+
+	// Then prefetched textures, only if there is time left
+	unsigned prefetched = 0;
+	while (pending_.empty() && prefetched < prefetch_.size() && app::runTimer() - load_start_ < map_tex_load_ms)
+		load(prefetch_[prefetched++]);
+	prefetch_.erase(prefetch_.begin(), prefetch_.begin() + prefetched);
+	defer_loading_ = defer;
+
+	return loaded > 0 || prefetched > 0;
+}
+
+// -----------------------------------------------------------------------------
+// Queues the texture [name] to be loaded at low priority, when there is time
+// left after loading deferred textures (see loadPending). Does nothing if the
+// texture has already been loaded or requested
+// -----------------------------------------------------------------------------
+void MapTextureManager::prefetchTexture(string_view name, bool mixed)
+{
+	auto& mtex = textures_[strutil::upper(name)];
+	if (mtex.gl_id || mtex.load_attempted || mtex.pending || mtex.prefetch)
+		return;
+
+	mtex.prefetch = true;
+	prefetch_.push_back({ PendingLoad::Type::Texture, string{ name }, mixed });
+}
+
+// -----------------------------------------------------------------------------
+// Queues the flat [name] to be loaded at low priority (see prefetchTexture)
+// -----------------------------------------------------------------------------
+void MapTextureManager::prefetchFlat(string_view name, bool mixed)
+{
+	auto& mtex = flats_[strutil::upper(name)];
+	if (mtex.gl_id || mtex.load_attempted || mtex.pending || mtex.prefetch)
+		return;
+
+	mtex.prefetch = true;
+	prefetch_.push_back({ PendingLoad::Type::Flat, string{ name }, mixed });
+}
+
+// -----------------------------------------------------------------------------
+// Loads the texture, flat or sprite requested by [request]
+// -----------------------------------------------------------------------------
+void MapTextureManager::load(const PendingLoad& request)
+{
+	switch (request.type)
+	{
+	case PendingLoad::Type::Texture:
+		textures_[strutil::upper(request.name)].prefetch = false;
+		texture(request.name, request.mixed);
+		break;
+	case PendingLoad::Type::Flat:
+		flats_[strutil::upper(request.name)].prefetch = false;
+		flat(request.name, request.mixed);
+		break;
+	case PendingLoad::Type::Sprite: sprite(request.name, request.translation, request.palette); break;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Returns the sprite matching [name], loading it from resources if necessary.
 // Sprite name also supports wildcards (?)
@@ -345,11 +486,22 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 	if (name.empty())
 		return tex_invalid;
 
+	// Wildcard, use the first matching sprite
+	if (name.back() == '?')
+	{
+		auto& resolved = resolveSpriteWildcard(name);
+		return resolved.empty() ? tex_invalid : sprite(resolved, translation, palette);
+	}
+
 	// Get sprite matching name
 	auto hashname = fmt::format("{}{}{}", name, translation, palette);
 	strutil::upperIP(hashname);
 	auto& mtex = sprites_[hashname];
 
+	// Already searched for and not found
+	if (!mtex.gl_id && mtex.load_attempted)
+		return tex_invalid;
+
 	// Get desired filter type
 	auto filter = gl::TexFilter::Linear;
 	if (map_tex_filter == 0)
@@ -361,22 +513,23 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 	else if (map_tex_filter == 3)
 		filter = gl::TexFilter::NearestMipmap;
 
-	// If the texture is loaded
-	if (mtex.gl_id)
-	{
-		// If the texture filter matches the desired one, return it
-		auto& tex_info = gl::Texture::info(mtex.gl_id);
-		if (tex_info.filter == filter)
-			return mtex;
-		else
-		{
-			// Otherwise, reload the texture
-			gl::Texture::clear(mtex.gl_id);
-			mtex.gl_id = 0;
-		}
-	}
+	// If the texture is loaded (and not evicted), return it
+	unsigned reload_id = 0;
+	if (mtex.gl_id && !checkReload(mtex, filter, reload_id))
+		return mtex;
+
+	// Check if loading should be deferred
+	if (deferLoad(mtex, { PendingLoad::Type::Sprite, string{ name }, false, string{ translation }, string{ palette } }))
+		return mtex;
+
+	PROFILE_SCOPE("MapTextureManager::loadSprite");
+
+	if (!sprite_sources_.count(hashname))
+		sprite_sources_[hashname] = {
+			PendingLoad::Type::Sprite, string{ name }, false, string{ translation }, string{ palette }
+		};
 
-	// Sprite not found, look for it
+	// Sprite not loaded, look for it
 	bool   found  = false;
 	bool   mirror = false;
 	SImage image;
@@ -395,10 +548,17 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 		if (entry)
 			mirror = true;
 	}
-	if (entry)
+	if (entry && translation.empty() && palette.empty())
+	{
+		// Untranslated sprites can use the resource texture cache
+		auto variant = mirror ? CacheVariant::SpriteMirrored : CacheVariant::Sprite;
+		if (loadEntryTexture(mtex, reload_id, entry, nullptr, variant, filter))
+			return mtex;
+	}
+	else if (entry)
 	{
 		found = true;
-		misc::loadImageFromEntry(&image, entry);
+		misc::loadCachedImageFromEntry(&image, entry);
 	}
 	else // Try composite textures then
 	{
@@ -414,7 +574,7 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 
 		// Apply translation
 		if (!translation.empty())
-			image.applyTranslation(translation, pal, true);
+			image.applyTranslation(&spriteTranslation(translation), pal, true);
 
 		// Apply palette override
 		if (!palette.empty())
@@ -432,32 +592,124 @@ const MapTextureManager::Texture& MapTextureManager::sprite(
 			image.mirror(false);
 
 		// Turn into GL texture
-		mtex.gl_id = gl::Texture::createFromImage(image, pal, filter, false);
+		uploadImage(mtex, reload_id, image, pal, filter, false);
 		return mtex;
 	}
-	else if (name.back() == '?')
+
+	// Evicted sprite couldn't be reloaded
+	gl::Texture::clear(reload_id);
+
+	return tex_invalid;
+}
+
+// -----------------------------------------------------------------------------
+// Builds the index of sprite lump names (in the sprites namespace) by sprite,
+// used to look up sprite frames without going through the resource manager
+// -----------------------------------------------------------------------------
+void MapTextureManager::buildSpriteIndex()
+{
+	sprite_frames_.clear();
+
+	vector<ArchiveEntry*> entries;
+	app::resources().putAllPatchEntries(entries, archive_.lock().get());
+	for (auto entry : entries)
+	{
+		if (!entry->isInNamespace("sprites") || entry->upperNameNoExt().size() <= 4)
+			continue;
+
+		auto name = strutil::toString(entry->upperNameNoExt());
+		sprite_frames_[name.substr(0, 4)].push_back(name);
+	}
+
+	for (auto& frames : sprite_frames_)
+		std::sort(frames.second.begin(), frames.second.end());
+
+	sprite_frames_built_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if a sprite lump (or mirrored sprite lump) named [name] exists.
+// Doesn't check for other patches or composite textures
+// -----------------------------------------------------------------------------
+bool MapTextureManager::spriteExists(string_view name)
+{
+	if (!sprite_frames_built_)
+		buildSpriteIndex();
+
+	auto frames = sprite_frames_.find(strutil::toString(name.substr(0, 4)));
+	if (frames == sprite_frames_.end())
+		return false;
+
+	auto exists = [&frames](const string& frame_name)
+	{ return std::binary_search(frames->second.begin(), frames->second.end(), frame_name); };
+
+	string frame_name{ name };
+	if (exists(frame_name))
+		return true;
+
+	// Mirrored (eg. POSSA2A8 is also used for POSSA8A2)
+	if (frame_name.size() == 8)
+	{
+		std::swap(frame_name[4], frame_name[6]);
+		std::swap(frame_name[5], frame_name[7]);
+		return exists(frame_name);
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the name of the first sprite matching wildcard sprite [name] (eg.
+// POSSA? -> POSSA1), or an empty string if none match. The result is cached
+// until resources are refreshed
+// -----------------------------------------------------------------------------
+const string& MapTextureManager::resolveSpriteWildcard(string_view name)
+{
+	auto key = strutil::upper(name);
+	if (auto i = sprite_wildcards_.find(key); i != sprite_wildcards_.end())
+		return i->second;
+
+	// Possible names, in order of preference
+	auto           base = string_view{ key }.substr(0, key.size() - 1);
+	vector<string> names{ fmt::format("{}0", base), fmt::format("{}1", base) };
+	if (base.length() == 5)
 	{
-		name.remove_suffix(1);
-		auto stex = &sprite(fmt::format("{}0", name), translation, palette);
-		if (!stex->gl_id)
-			stex = &sprite(fmt::format("{}1", name), translation, palette);
-		if (stex->gl_id)
-			return *stex;
-		if (!stex->gl_id && name.length() == 5)
+		for (char chr = 'A'; chr <= ']'; ++chr)
 		{
-			for (char chr = 'A'; chr <= ']'; ++chr)
-			{
-				stex = &sprite(fmt::format("{}0{}0", name, chr), translation, palette);
-				if (stex->gl_id)
-					return *stex;
-				stex = &sprite(fmt::format("{}1{}1", name, chr), translation, palette);
-				if (stex->gl_id)
-					return *stex;
-			}
+			names.push_back(fmt::format("{}0{}0", base, chr));
+			names.push_back(fmt::format("{}1{}1", base, chr));
 		}
 	}
 
-	return tex_invalid;
+	// Check sprite lumps first, then any other patches or composite textures
+	auto& resolved = sprite_wildcards_[key];
+	for (const auto& sprite_name : names)
+		if (spriteExists(sprite_name))
+			return resolved = sprite_name;
+
+	auto archive = archive_.lock().get();
+	for (const auto& sprite_name : names)
+		if (app::resources().getPatchEntry(sprite_name, "", archive)
+			|| app::resources().getTexture(sprite_name, "", archive))
+			return resolved = sprite_name;
+
+	return resolved;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the translation parsed from [definition], parsing it first if it
+// hasn't been used by any sprite yet
+// -----------------------------------------------------------------------------
+Translation& MapTextureManager::spriteTranslation(string_view definition)
+{
+	auto& translation = sprite_translations_[strutil::toString(definition)];
+	if (!translation)
+	{
+		translation = std::make_unique<Translation>();
+		translation->parse(definition);
+	}
+
+	return *translation;
 }
 
 // -----------------------------------------------------------------------------
@@ -471,6 +723,12 @@ int MapTextureManager::verticalOffset(string_view name) const
 	if (name.empty())
 		return 0;
 
+	// Check if it was already found
+	auto& offset = sprite_offsets_.try_emplace(strutil::upper(name), -1).first->second;
+	if (offset >= 0)
+		return offset;
+	offset = 0;
+
 	// Get sprite matching name
 	auto archive = archive_.lock().get();
 	auto entry   = app::resources().getPatchEntry(name, "sprites", archive);
@@ -483,12 +741,497 @@ int MapTextureManager::verticalOffset(string_view name) const
 		int h = image.height();
 		int o = image.offset().y;
 		if (o > h)
-			return o - h;
+			offset = o - h;
+	}
+
+	return offset;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [image] as a layer in the flat texture array matching its size, and
+// sets the array info for [mtex] accordingly. If [mtex] is already in an array
+// (ie. it is being reloaded), its existing layer is replaced
+// -----------------------------------------------------------------------------
+void MapTextureManager::addToFlatArray(Texture& mtex, const SImage& image)
+{
+	if (!map_tex_arrays || !gl::arrayTextureSupport())
+		return;
+
+	MemChunk rgba;
+	if (!image.putRGBAData(rgba, palette_.get()))
+		return;
+
+	Vec2i size{ image.width(), image.height() };
+	auto  layer_size = static_cast<size_t>(size.x) * size.y * 4;
+	if (rgba.size() != layer_size || !gl::validTexDimension(size.x) || !gl::validTexDimension(size.y))
+		return;
+
+	// Replace existing layer
+	if (mtex.array >= 0 && mtex.array < static_cast<int>(flat_arrays_.size()))
+	{
+		auto& array = *flat_arrays_[mtex.array];
+		if (array.size == size && mtex.array_layer < array.layers)
+		{
+			memcpy(array.data.data() + mtex.array_layer * layer_size, rgba.data(), layer_size);
+			array.updated = false;
+			return;
+		}
+	}
+
+	// Find an array of the same size with space for another layer
+	mtex.array = -1;
+	for (unsigned a = 0; a < flat_arrays_.size(); ++a)
+		if (flat_arrays_[a]->size == size && flat_arrays_[a]->layers < gl::maxArrayTextureLayers())
+		{
+			mtex.array = a;
+			break;
+		}
+
+	// Create a new array if needed
+	if (mtex.array < 0)
+	{
+		flat_arrays_.push_back(std::make_unique<TextureArray>());
+		flat_arrays_.back()->size = size;
+		mtex.array                = flat_arrays_.size() - 1;
+	}
+
+	// Add layer
+	auto& array      = *flat_arrays_[mtex.array];
+	mtex.array_layer = array.layers++;
+	array.data.insert(array.data.end(), rgba.data(), rgba.data() + layer_size);
+	array.updated = false;
+}
+
+// -----------------------------------------------------------------------------
+// Checks if the loaded [mtex] needs to be reloaded, because it was evicted or
+// doesn't use [filter]. If it was evicted its GL texture id is kept in
+// [reload_id] to reload it into (so anything still drawing that id shows it
+// again once reloaded), otherwise its GL texture is cleared.
+// Returns true if [mtex] needs to be reloaded
+// -----------------------------------------------------------------------------
+bool MapTextureManager::checkReload(Texture& mtex, gl::TexFilter filter, unsigned& reload_id) const
+{
+	auto& tex_info = gl::Texture::info(mtex.gl_id);
+	if (tex_info.filter == filter && !tex_info.evicted)
+		return false;
+
+	// Shared textures are reloaded (or replaced) via the resource texture cache
+	if (mtex.shared)
+		mtex.shared.reset();
+	else if (tex_info.evicted && tex_info.filter == filter)
+		reload_id = mtex.gl_id;
+	else
+		gl::Texture::clear(mtex.gl_id);
+
+	mtex.gl_id = 0;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Uploads [image] (using [pal]) to a GL texture for [mtex]. If [reload_id] is
+// set (see checkReload) the image is loaded into that texture, otherwise a new
+// one is created with [filter] and [tiling]
+// -----------------------------------------------------------------------------
+void MapTextureManager::uploadImage(
+	Texture&      mtex,
+	unsigned&     reload_id,
+	const SImage& image,
+	Palette*      pal,
+	gl::TexFilter filter,
+	bool          tiling) const
+{
+	if (reload_id)
+	{
+		auto id   = reload_id;
+		reload_id = 0;
+		if (gl::Texture::loadImage(id, image, pal, true))
+		{
+			mtex.gl_id = id;
+			return;
+		}
+
+		gl::Texture::clear(id);
+	}
+
+	mtex.gl_id = gl::Texture::createFromImage(image, pal, filter, tiling, true);
+}
+
+// -----------------------------------------------------------------------------
+// Loads the image in [entry] into [mtex], scaled to the size of the image in
+// [scale_entry] if given, and also adds it to a flat texture array if
+// [flat_array] is true.
+// The GL texture is shared via the resource texture cache, so if the same
+// image was already loaded (by any map or browser, as long as its entries
+// haven't been modified since) it is used again without loading anything.
+// Returns false if the image couldn't be loaded
+// -----------------------------------------------------------------------------
+bool MapTextureManager::loadEntryTexture(
+	Texture&      mtex,
+	unsigned&     reload_id,
+	ArchiveEntry* entry,
+	ArchiveEntry* scale_entry,
+	CacheVariant  variant,
+	gl::TexFilter filter,
+	bool          flat_array)
+{
+	if (!entry)
+		return false;
+
+	auto image_loaded = false;
+	auto load_image   = [entry, variant](SImage& image)
+	{
+		if (variant == CacheVariant::Tiled)
+			return misc::loadImageFromEntry(&image, entry);
+
+		if (!misc::loadCachedImageFromEntry(&image, entry))
+			return false;
+		if (variant == CacheVariant::SpriteMirrored)
+			image.mirror(false);
+		return true;
+	};
+
+	// Check if there is a (still valid) cached texture
+	CacheKey key{ entry, scale_entry, variant, filter };
+	auto&    cached = resource_cache_[key];
+	bool     valid  = cached.texture && !cached.entry.expired() && cached.entry_hash == entry->contentHash()
+				 && gl::Texture::isCreated(cached.texture->gl_id);
+	if (valid && scale_entry)
+		valid = !cached.scale_entry.expired() && cached.scale_hash == scale_entry->contentHash();
+
+	// Reload the cached texture if it was evicted
+	SImage image;
+	if (valid && gl::Texture::info(cached.texture->gl_id).evicted)
+	{
+		image_loaded = load_image(image);
+		valid        = image_loaded && gl::Texture::loadImage(cached.texture->gl_id, image, palette_.get(), true);
+	}
+
+	if (valid)
+	{
+		// Use the cached texture instead of any evicted one
+		gl::Texture::clear(reload_id);
+		reload_id          = 0;
+		mtex.gl_id         = cached.texture->gl_id;
+		mtex.shared        = cached.texture;
+		mtex.world_panning = cached.world_panning;
+		mtex.scale         = cached.scale;
+	}
+	else
+	{
+		cached = {};
+
+		// Load and upload the image
+		if (!image_loaded && !load_image(image))
+		{
+			resource_cache_.erase(key);
+			return false;
+		}
+		image_loaded = true;
+		uploadImage(mtex, reload_id, image, palette_.get(), filter, variant == CacheVariant::Tiled);
+		if (!mtex.gl_id)
+		{
+			resource_cache_.erase(key);
+			return false;
+		}
+
+		// Get scale
+		if (scale_entry)
+		{
+			SImage lores_image;
+			if (misc::loadImageFromEntry(&lores_image, scale_entry))
+			{
+				double scale_x     = static_cast<double>(lores_image.width()) / static_cast<double>(image.width());
+				double scale_y     = static_cast<double>(lores_image.height()) / static_cast<double>(image.height());
+				mtex.world_panning = true;
+				mtex.scale         = { scale_x, scale_y };
+			}
+		}
+
+		// Add to the cache (only entries in an archive can be cached, since
+		// something has to own them)
+		auto entry_ref       = entry->getShared();
+		auto scale_entry_ref = scale_entry ? scale_entry->getShared() : nullptr;
+		if (entry_ref && (!scale_entry || scale_entry_ref))
+		{
+			cached.entry          = entry_ref;
+			cached.entry_hash     = entry->contentHash();
+			cached.scale_entry    = scale_entry_ref;
+			cached.scale_hash     = scale_entry ? scale_entry->contentHash() : 0;
+			cached.texture        = std::make_shared<SharedTexture>();
+			cached.texture->gl_id = mtex.gl_id;
+			cached.world_panning  = mtex.world_panning;
+			cached.scale          = mtex.scale;
+			mtex.shared           = cached.texture;
+		}
+		else
+			resource_cache_.erase(key);
+	}
+
+	// Add to flat texture array if needed
+	if (!flat_array)
+		return true;
+	auto i = resource_cache_.find(key);
+	if (i != resource_cache_.end() && i->second.array >= 0 && i->second.array_generation == flat_arrays_generation_)
+	{
+		mtex.array       = i->second.array;
+		mtex.array_layer = i->second.array_layer;
+		return true;
+	}
+	if (!image_loaded)
+		image_loaded = load_image(image);
+	if (image_loaded)
+		addToFlatArray(mtex, image);
+	if (i != resource_cache_.end())
+	{
+		i->second.array            = mtex.array;
+		i->second.array_layer      = mtex.array_layer;
+		i->second.array_generation = flat_arrays_generation_;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Removes textures from the resource texture cache that can't be used again,
+// because their entries were deleted or modified or they were loaded with a
+// different palette or texture filter
+// -----------------------------------------------------------------------------
+void MapTextureManager::updateResourceCache()
+{
+	// Everything cached was converted with the old palette if it changed
+	MemChunk pal_data;
+	palette_->saveMem(pal_data);
+	if (pal_data.crc() != resource_cache_palette_)
+	{
+		resource_cache_.clear();
+		resource_cache_palette_ = pal_data.crc();
+		return;
+	}
+
+	auto filter = textureFilter();
+	for (auto i = resource_cache_.begin(); i != resource_cache_.end();)
+	{
+		auto& [entry, scale_entry, variant, tex_filter] = i->first;
+		auto& cached                                    = i->second;
+
+		bool keep = !cached.entry.expired() && entry->contentHash() == cached.entry_hash;
+		if (keep && scale_entry)
+			keep = !cached.scale_entry.expired() && scale_entry->contentHash() == cached.scale_hash;
+		if (keep && variant == CacheVariant::Tiled)
+			keep = tex_filter == filter;
+
+		if (keep)
+			++i;
 		else
-			return 0;
+			i = resource_cache_.erase(i);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Queues evicted textures that were drawn in the last frame for reloading.
+// Every BUDGET_CHECK_FRAMES frames, if the textures, flats and sprites use
+// more than map_tex_vram_budget video memory, those that haven't been drawn
+// in the last EVICT_UNUSED_FRAMES frames are evicted (least recently drawn
+// first) until they are within the budget
+// -----------------------------------------------------------------------------
+void MapTextureManager::updateResidency()
+{
+	auto frame = gl::Texture::currentFrame();
+
+	// Reload evicted textures that have been drawn since
+	for (auto i = evicted_.begin(); i != evicted_.end();)
+	{
+		auto& tex_info = gl::Texture::info(i->texture->gl_id);
+		if (tex_info.evicted && tex_info.last_used < i->frame)
+		{
+			++i;
+			continue;
+		}
+
+		// (Not queued if it was reloaded or cleared already)
+		if (tex_info.evicted)
+			pending_.push_back(std::move(i->load));
+		i = evicted_.erase(i);
+	}
+
+	if (map_tex_vram_budget <= 0 || frame % BUDGET_CHECK_FRAMES != 0)
+		return;
+
+	// Get video memory used and textures that can be evicted
+	struct Candidate
+	{
+		Texture*          texture;
+		const string*     key;
+		PendingLoad::Type type;
+		unsigned          last_used;
+		size_t            memory;
+	};
+	vector<Candidate> candidates;
+	size_t            used    = 0;
+	auto              missing = gl::Texture::missingTexture();
+	auto              check   = [&](MapTexHashMap& map, PendingLoad::Type type)
+	{
+		for (auto& [key, mtex] : map)
+		{
+			if (!mtex.gl_id || mtex.gl_id == missing)
+				continue;
+
+			auto& tex_info = gl::Texture::info(mtex.gl_id);
+			if (tex_info.memory == 0)
+				continue;
+
+			used += tex_info.memory;
+			if (frame - tex_info.last_used > EVICT_UNUSED_FRAMES)
+				candidates.push_back({ &mtex, &key, type, tex_info.last_used, tex_info.memory });
+		}
+	};
+	check(textures_, PendingLoad::Type::Texture);
+	check(flats_, PendingLoad::Type::Flat);
+	check(sprites_, PendingLoad::Type::Sprite);
+
+	// Cached resource textures that nothing is using count towards the budget
+	// too, and are removed from the cache before anything is evicted
+	size_t unused = 0;
+	for (auto& [key, cached] : resource_cache_)
+		if (cached.texture && cached.texture.use_count() == 1)
+			unused += gl::Texture::info(cached.texture->gl_id).memory;
+
+	auto budget = static_cast<size_t>(map_tex_vram_budget) * 1024 * 1024;
+	if (used + unused <= budget)
+		return;
+	if (unused > 0)
+	{
+		for (auto i = resource_cache_.begin(); i != resource_cache_.end();)
+		{
+			if (i->second.texture && i->second.texture.use_count() == 1)
+				i = resource_cache_.erase(i);
+			else
+				++i;
+		}
+		log::info(2, "Removed unused textures from the resource texture cache, {}MB", unused / (1024 * 1024));
+	}
+	if (used <= budget)
+		return;
+
+	// Evict least recently drawn first
+	std::sort(
+		candidates.begin(),
+		candidates.end(),
+		[](const Candidate& left, const Candidate& right) { return left.last_used < right.last_used; });
+	unsigned n_evicted = 0;
+	for (auto& candidate : candidates)
+	{
+		if (used <= budget)
+			break;
+
+		PendingLoad load{ candidate.type, *candidate.key };
+		if (candidate.type == PendingLoad::Type::Sprite)
+		{
+			auto source = sprite_sources_.find(*candidate.key);
+			if (source == sprite_sources_.end())
+				continue;
+			load = source->second;
+		}
+
+		gl::Texture::evict(candidate.texture->gl_id);
+		evicted_.push_back({ candidate.texture, std::move(load), frame });
+		used -= candidate.memory;
+		++n_evicted;
+	}
+
+	log::info(2, "Evicted {} map textures, {}MB video memory in use", n_evicted, used / (1024 * 1024));
+}
+
+// -----------------------------------------------------------------------------
+// Adds the estimated video memory used by loaded textures, flats and sprites
+// to [usage]. Textures shared between them are only counted once
+// -----------------------------------------------------------------------------
+void MapTextureManager::countMemory(vector<memstats::Usage>& usage) const
+{
+	std::set<unsigned> counted;
+	auto               missing = gl::Texture::missingTexture();
+	auto               count   = [&](const MapTexHashMap& map, string_view name)
+	{
+		memstats::Usage item;
+		item.name = name;
+		item.vram = true;
+		for (const auto& [key, mtex] : map)
+		{
+			if (!mtex.gl_id || mtex.gl_id == missing || !counted.insert(mtex.gl_id).second)
+				continue;
+
+			item.bytes += gl::Texture::info(mtex.gl_id).memory;
+			++item.count;
+		}
+		usage.push_back(item);
+	};
+	count(textures_, "Textures");
+	count(flats_, "Flats");
+	count(sprites_, "Sprites");
+	count(editor_images_, "Editor images");
+
+	// Flat array textures, and the image data kept to add more layers
+	memstats::Usage arrays;
+	memstats::Usage array_data;
+	arrays.name     = "Flat arrays";
+	arrays.vram     = true;
+	array_data.name = "Flat array data";
+	for (const auto& array : flat_arrays_)
+	{
+		if (array->gl_id)
+			arrays.bytes += gl::Texture::info(array->gl_id).memory;
+		array_data.bytes += array->data.capacity();
+		++arrays.count;
+	}
+	array_data.count = arrays.count;
+	usage.push_back(arrays);
+	usage.push_back(array_data);
+
+	// Cached resource textures not currently in use
+	memstats::Usage cached_unused;
+	cached_unused.name = "Unused cached textures";
+	cached_unused.vram = true;
+	for (const auto& [key, cached] : resource_cache_)
+	{
+		if (!cached.texture || !counted.insert(cached.texture->gl_id).second)
+			continue;
+
+		cached_unused.bytes += gl::Texture::info(cached.texture->gl_id).memory;
+		++cached_unused.count;
+	}
+	usage.push_back(cached_unused);
+}
+
+// -----------------------------------------------------------------------------
+// Checks if loading of [mtex] (the texture, flat or sprite in [load]) should
+// be deferred.
+// While deferred loading is enabled, textures are loaded immediately until
+// map_tex_load_ms has passed since loadPending was last called, after which
+// they are queued for loading later and left unloaded (gl_id 0) for now.
+// Returns true if [mtex] is queued and shouldn't be loaded yet
+// -----------------------------------------------------------------------------
+bool MapTextureManager::deferLoad(Texture& mtex, PendingLoad load)
+{
+	// Textures that were already searched for (eg. not found) can't be deferred,
+	// or they would be queued again every time
+	if (defer_loading_ && !mtex.load_attempted && map_tex_load_ms > 0)
+	{
+		if (!mtex.pending && app::runTimer() - load_start_ >= map_tex_load_ms)
+		{
+			mtex.pending = true;
+			pending_.push_back(std::move(load));
+		}
+
+		if (mtex.pending)
+		{
+			++n_deferred_;
+			return true;
+		}
 	}
 
-	return 0;
+	mtex.load_attempted = true;
+	mtex.pending        = false;
+	return false;
 }
 
 // -----------------------------------------------------------------------------
@@ -549,13 +1292,26 @@ const MapTextureManager::Texture& MapTextureManager::editorImage(string_view nam
 // -----------------------------------------------------------------------------
 void MapTextureManager::refreshResources()
 {
-	// Just clear all cached textures
+	// Just clear all textures (those loaded from unchanged resource entries
+	// are kept in the resource texture cache)
 	textures_.clear();
 	flats_.clear();
+	flat_arrays_.clear();
+	++flat_arrays_generation_;
 	sprites_.clear();
+	sprite_frames_.clear();
+	sprite_frames_built_ = false;
+	sprite_wildcards_.clear();
+	sprite_translations_.clear();
+	sprite_offsets_.clear();
+	sprite_sources_.clear();
+	pending_.clear();
+	prefetch_.clear();
+	evicted_.clear();
 	theMainWindow->paletteChooser()->setGlobalFromArchive(archive_.lock().get());
 	mapeditor::forceRefresh(true);
 	palette_->copyPalette(resourcePalette());
+	updateResourceCache();
 	buildTexInfoList();
 }
 
@@ -1,12 +1,20 @@
 #pragma once
 
+#include "Graphics/Translation.h"
 #include "OpenGL/GLTexture.h"
 
 namespace slade
 {
 class ArchiveDir;
+class ArchiveEntry;
 class Archive;
+class CTexture;
 class Palette;
+class SImage;
+namespace memstats
+{
+	struct Usage;
+}
 
 class MapTextureManager
 {
@@ -21,15 +29,52 @@ public:
 		HiRes
 	};
 
+	// A GL texture shared by everything loaded from the same resource entry
+	// (see the resource texture cache), cleared once nothing uses it
+	struct SharedTexture
+	{
+		unsigned gl_id = 0;
+		~SharedTexture() { gl::Texture::clear(gl_id); }
+	};
+
 	struct Texture
 	{
-		unsigned gl_id         = 0;
-		bool     world_panning = false;
-		Vec2d    scale         = { 1., 1. };
-		~Texture() { gl::Texture::clear(gl_id); }
+		unsigned                  gl_id          = 0;
+		bool                      world_panning  = false;
+		Vec2d                     scale          = { 1., 1. };
+		int                       array          = -1; // Index of the texture array this is also in (-1 if none)
+		unsigned                  array_layer    = 0;
+		bool                      load_attempted = false; // True once the texture has been searched for and loaded
+		bool                      pending        = false; // True if loading was deferred (see setDeferLoading)
+		bool                      prefetch       = false; // True if queued for low priority loading
+		shared_ptr<SharedTexture> shared;                 // Owner of gl_id if it is shared
+		~Texture()
+		{
+			if (!shared)
+				gl::Texture::clear(gl_id);
+		}
+	};
+
+	// A set of same-sized textures packed into the layers of a GL array texture
+	struct TextureArray
+	{
+		unsigned        gl_id = 0;
+		Vec2i           size;
+		unsigned        layers  = 0;
+		vector<uint8_t> data;            // RGBA data of all layers
+		bool            updated = false; // True if gl_id is up to date with data
+		~TextureArray() { gl::Texture::clear(gl_id); }
 	};
 	typedef std::map<string, Texture> MapTexHashMap;
 
+	// The resource a texture or flat image is loaded from (see textureResource)
+	struct Resource
+	{
+		Archive*      archive = nullptr; // Archive to load composite texture patches from
+		CTexture*     ctex    = nullptr; // Composite texture
+		ArchiveEntry* entry   = nullptr; // Image entry (if not a composite texture)
+	};
+
 	struct TexInfo
 	{
 		string   short_name;
@@ -65,11 +110,26 @@ public:
 	void buildTexInfoList();
 
 	Palette*       resourcePalette() const;
+	Palette*       palette() const { return palette_.get(); }
+	Resource       textureResource(string_view name) const;
+	Resource       flatResource(string_view name) const;
 	const Texture& texture(string_view name, bool mixed);
 	const Texture& flat(string_view name, bool mixed);
 	const Texture& sprite(string_view name, string_view translation = "", string_view palette = "");
 	const Texture& editorImage(string_view name);
+	unsigned       flatArray(int index);
+
+	// Deferred loading
+	void     setDeferLoading(bool defer) { defer_loading_ = defer; }
+	bool     hasPending() const { return !pending_.empty(); }
+	unsigned nDeferred() const { return n_deferred_; }
+	long     pendingLoadedTime() const { return pending_loaded_time_; }
+	bool     loadPending();
+	void     prefetchTexture(string_view name, bool mixed);
+	void     prefetchFlat(string_view name, bool mixed);
+	bool     prefetching() const { return !prefetch_.empty(); }
 	int            verticalOffset(string_view name) const;
+	void           countMemory(vector<memstats::Usage>& usage) const;
 
 	vector<TexInfo>& allTexturesInfo() { return tex_info_; }
 	vector<TexInfo>& allFlatsInfo() { return flat_info_; }
@@ -85,10 +145,105 @@ private:
 	vector<TexInfo>     tex_info_;
 	vector<TexInfo>     flat_info_;
 
+	vector<unique_ptr<TextureArray>> flat_arrays_;
+
+	// Sprite lookup
+	std::map<string, vector<string>>          sprite_frames_; // Sprite lump names, by sprite (first 4 characters)
+	bool                                      sprite_frames_built_ = false;
+	std::map<string, string>                  sprite_wildcards_; // Sprite names resolved from wildcard names
+	std::map<string, unique_ptr<Translation>> sprite_translations_;
+	mutable std::map<string, int>             sprite_offsets_; // See verticalOffset
+
+	// Deferred loading
+	struct PendingLoad
+	{
+		enum class Type
+		{
+			Texture,
+			Flat,
+			Sprite
+		};
+
+		Type   type;
+		string name;
+		bool   mixed = false;
+		string translation; // Sprites only
+		string palette;     // Sprites only
+	};
+	vector<PendingLoad> pending_;
+	vector<PendingLoad> prefetch_; // Low priority, loaded after pending_ (see prefetchTexture)
+	bool                defer_loading_       = false;
+	long                load_start_          = 0;
+	unsigned            n_deferred_          = 0; // Number of times a not-yet-loaded texture was given
+	long                pending_loaded_time_ = 0;
+
+	// Video memory budget (see updateResidency)
+	struct EvictedTexture
+	{
+		Texture*    texture;
+		PendingLoad load;  // To reload it when it is drawn again
+		unsigned    frame; // Frame it was evicted in
+	};
+	vector<EvictedTexture>        evicted_;
+	std::map<string, PendingLoad> sprite_sources_; // How each loaded sprite was requested (by sprites_ key)
+
+	// Resource texture cache - GL textures loaded from resource entries, kept
+	// across map/archive changes and resource refreshes and used again as long
+	// as the entries still exist and haven't been modified (see
+	// loadEntryTexture)
+	enum class CacheVariant
+	{
+		Tiled, // Textures and flats
+		Sprite,
+		SpriteMirrored
+	};
+	struct CachedTexture
+	{
+		weak_ptr<ArchiveEntry>    entry;
+		uint32_t                  entry_hash = 0;
+		weak_ptr<ArchiveEntry>    scale_entry;
+		uint32_t                  scale_hash = 0;
+		shared_ptr<SharedTexture> texture;
+		bool                      world_panning    = false;
+		Vec2d                     scale            = { 1., 1. };
+		int                       array            = -1; // Flat texture array info (if array_generation is current)
+		unsigned                  array_layer      = 0;
+		unsigned                  array_generation = 0;
+	};
+	typedef std::tuple<ArchiveEntry*, ArchiveEntry*, CacheVariant, gl::TexFilter> CacheKey;
+	std::map<CacheKey, CachedTexture> resource_cache_;
+	uint32_t                          resource_cache_palette_ = 0; // CRC of the palette the cached textures use
+	unsigned                          flat_arrays_generation_ = 1; // Incremented whenever flat_arrays_ is cleared
+
 	// Signal connections
 	sigslot::scoped_connection sc_resources_updated_;
 	sigslot::scoped_connection sc_palette_changed_;
 
-	void importEditorImages(MapTexHashMap& map, ArchiveDir* dir, string_view path) const;
+	void          importEditorImages(MapTexHashMap& map, ArchiveDir* dir, string_view path) const;
+	void          addToFlatArray(Texture& mtex, const SImage& image);
+	bool          deferLoad(Texture& mtex, PendingLoad load);
+	void          load(const PendingLoad& request);
+	bool          checkReload(Texture& mtex, gl::TexFilter filter, unsigned& reload_id) const;
+	void          uploadImage(
+		Texture&      mtex,
+		unsigned&     reload_id,
+		const SImage& image,
+		Palette*      pal,
+		gl::TexFilter filter,
+		bool          tiling = true) const;
+	bool          loadEntryTexture(
+		Texture&      mtex,
+		unsigned&     reload_id,
+		ArchiveEntry* entry,
+		ArchiveEntry* scale_entry,
+		CacheVariant  variant,
+		gl::TexFilter filter,
+		bool          flat_array = false);
+	void          updateResourceCache();
+	void          updateResidency();
+	void          buildSpriteIndex();
+	bool          spriteExists(string_view name);
+	const string& resolveSpriteWildcard(string_view name);
+	Translation&  spriteTranslation(string_view definition);
 };
 } // namespace slade
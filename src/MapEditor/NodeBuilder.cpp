@@ -0,0 +1,801 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    NodeBuilder.cpp
+// Description: NodeBuilder class - a built-in GL node builder, which builds a
+//              BSP tree for a map directly from its map data and writes it in
+//              ZDoom's extended GL node format (XGL3/ZGL3). This is intended
+//              for quickly test-running maps in ZDoom-based ports, rather than
+//              as a replacement for the external node builders.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "NodeBuilder.h"
+#include "SLADEMap/MapObject/MapLine.h"
+#include "SLADEMap/MapObject/MapVertex.h"
+#include "SLADEMap/MapSnapshot.h"
+#include "Utility/Compression.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr uint32_t NO_INDEX      = 0xFFFFFFFF;
+constexpr uint32_t CHILD_SUBSECT = 0x80000000;
+
+// Distance from a line within which a point is considered to be on it
+constexpr double SIDE_EPSILON = 0.001;
+
+// Partition line selection: cost of splitting a seg, extra cost for partition
+// lines that aren't axis-aligned, and the (max) number of partition lines to
+// try for each node
+constexpr int      SPLIT_COST          = 8;
+constexpr int      DIAGONAL_COST       = 16;
+constexpr unsigned CANDIDATES_OPTIMISE = 128;
+constexpr unsigned CANDIDATES_FAST     = 8;
+
+// Subtrees with at least this many segs are split up further before being
+// built in parallel
+constexpr unsigned PARALLEL_MIN_SEGS = 512;
+
+// Extra space around the map bounds for the initial subsector region
+constexpr double BOUNDS_MARGIN = 64.;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Structs
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A seg (part of one side of a line) being sorted into the tree
+struct BuildSeg
+{
+	Vec2d    start;
+	Vec2d    end;
+	int      v1 = -1; // Map vertex index at [start], -1 if it was created by a split
+	int      v2 = -1; // Map vertex index at [end]
+	uint32_t line;
+	uint8_t  side;
+};
+
+// A partition line above a subtree, and the side of it the subtree is on
+struct Plane
+{
+	Vec2d origin;
+	Vec2d dir; // Normalised
+	bool  front;
+};
+
+// A GL seg in a subsector. Its end is the start of the next seg in the
+// subsector
+struct LeafSeg
+{
+	Vec2d    pos;
+	int      vertex = -1; // Map vertex index at [pos], if any
+	uint32_t line   = NO_INDEX;
+	uint8_t  side   = 0;
+};
+
+// A built BSP (sub)tree, either a node with two children or a subsector
+struct BuildTree
+{
+	Vec2d                 origin; // Partition line start
+	Vec2d                 delta;  // Partition line direction (not normalised)
+	unique_ptr<BuildTree> children[2]; // Front, back
+	vector<LeafSeg>       leaf;        // Subsector segs
+
+	bool isLeaf() const { return !children[0]; }
+};
+
+// A subtree to be built in parallel with others
+struct BuildTask
+{
+	BuildTree*       tree;
+	vector<BuildSeg> segs;
+	vector<Plane>    planes;
+};
+
+// Settings for building a tree
+struct BuildContext
+{
+	unsigned      max_candidates;
+	vector<Vec2d> bounds; // Map bounds polygon (clockwise)
+};
+
+enum class SegSide
+{
+	Front,
+	Back,
+	Split
+};
+
+// Bounding box of (part of) the built tree
+struct Bounds
+{
+	double min_x = std::numeric_limits<double>::max();
+	double min_y = std::numeric_limits<double>::max();
+	double max_x = std::numeric_limits<double>::lowest();
+	double max_y = std::numeric_limits<double>::lowest();
+
+	void extend(Vec2d point)
+	{
+		min_x = std::min(min_x, point.x);
+		min_y = std::min(min_y, point.y);
+		max_x = std::max(max_x, point.x);
+		max_y = std::max(max_y, point.y);
+	}
+
+	void extend(const Bounds& other)
+	{
+		min_x = std::min(min_x, other.min_x);
+		min_y = std::min(min_y, other.min_y);
+		max_x = std::max(max_x, other.max_x);
+		max_y = std::max(max_y, other.max_y);
+	}
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [value] in 16.16 fixed point
+// -----------------------------------------------------------------------------
+int32_t toFixed(double value)
+{
+	return static_cast<int32_t>(std::lround(value * 65536.));
+}
+
+// -----------------------------------------------------------------------------
+// Returns [value] rounded to the nearest 16.16 fixed point value
+// -----------------------------------------------------------------------------
+double roundFixed(double value)
+{
+	return std::round(value * 65536.) / 65536.;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a key for the pair of values [a] and [b]
+// -----------------------------------------------------------------------------
+uint64_t pairKey(int32_t a, int32_t b)
+{
+	return static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32 | static_cast<uint32_t>(b);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the distance of [point] from the line through [origin] in (normalised)
+// direction [dir]. The distance is positive if [point] is on the front (right)
+// side of the line
+// -----------------------------------------------------------------------------
+double pointSide(Vec2d point, Vec2d origin, Vec2d dir)
+{
+	return (point.x - origin.x) * dir.y - (point.y - origin.y) * dir.x;
+}
+
+// -----------------------------------------------------------------------------
+// Returns which side of the line through [origin] in [dir] [seg] is on. If it
+// is split by the line, the distances of its start and end from the line are
+// written to [side_start] and [side_end]. Segs on the line are in front of it
+// if they face the same direction
+// -----------------------------------------------------------------------------
+SegSide segSide(const BuildSeg& seg, Vec2d origin, Vec2d dir, double& side_start, double& side_end)
+{
+	side_start = pointSide(seg.start, origin, dir);
+	side_end   = pointSide(seg.end, origin, dir);
+	if (std::abs(side_start) < SIDE_EPSILON)
+		side_start = 0.;
+	if (std::abs(side_end) < SIDE_EPSILON)
+		side_end = 0.;
+
+	if (side_start == 0. && side_end == 0.)
+		return (seg.end - seg.start).dot(dir) > 0. ? SegSide::Front : SegSide::Back;
+	if (side_start >= 0. && side_end >= 0.)
+		return SegSide::Front;
+	if (side_start <= 0. && side_end <= 0.)
+		return SegSide::Back;
+
+	return SegSide::Split;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cost of using [partition] as the partition line for [segs], or
+// -1 if it doesn't divide them (ie. all segs are in front of it).
+// Stops counting if the cost exceeds [max_cost]
+// -----------------------------------------------------------------------------
+int partitionCost(const vector<BuildSeg>& segs, const BuildSeg& partition, int max_cost)
+{
+	auto   delta = partition.end - partition.start;
+	auto   dir   = delta.normalized();
+	int    front = 0, back = 0, splits = 0;
+	double side_start, side_end;
+	for (const auto& seg : segs)
+	{
+		switch (segSide(seg, partition.start, dir, side_start, side_end))
+		{
+		case SegSide::Front: ++front; break;
+		case SegSide::Back: ++back; break;
+		default: ++splits; break;
+		}
+
+		if (splits * SPLIT_COST > max_cost)
+			return max_cost + 1;
+	}
+
+	if (back == 0 && splits == 0)
+		return -1;
+
+	int cost = splits * SPLIT_COST + std::abs(front - back);
+	if (delta.x != 0. && delta.y != 0.)
+		cost += DIAGONAL_COST;
+
+	return cost;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the seg in [segs] to use as the partition line for
+// them, or -1 if they form a convex subsector.
+// Segs are tried spread out through the list until [max_candidates] that
+// divide the segs have been found (or all of them have been tried)
+// -----------------------------------------------------------------------------
+int choosePartition(const vector<BuildSeg>& segs, unsigned max_candidates)
+{
+	auto     step       = std::max<size_t>(1, segs.size() / max_candidates);
+	int      best       = -1;
+	int      best_cost  = std::numeric_limits<int>::max();
+	unsigned candidates = 0;
+	for (size_t offset = 0; offset < step && candidates < max_candidates; ++offset)
+	{
+		for (size_t a = offset; a < segs.size() && candidates < max_candidates; a += step)
+		{
+			auto cost = partitionCost(segs, segs[a], best_cost);
+			if (cost < 0)
+				continue;
+
+			++candidates;
+			if (cost < best_cost)
+			{
+				best      = static_cast<int>(a);
+				best_cost = cost;
+			}
+		}
+	}
+
+	return best;
+}
+
+// -----------------------------------------------------------------------------
+// Sorts [segs] to the [front] and [back] of the partition line through
+// [origin] in [dir], splitting any segs that cross it
+// -----------------------------------------------------------------------------
+void splitSegs(vector<BuildSeg>& segs, Vec2d origin, Vec2d dir, vector<BuildSeg>& front, vector<BuildSeg>& back)
+{
+	double side_start, side_end;
+	for (auto& seg : segs)
+	{
+		switch (segSide(seg, origin, dir, side_start, side_end))
+		{
+		case SegSide::Front: front.push_back(seg); break;
+		case SegSide::Back: back.push_back(seg); break;
+		default:
+		{
+			// Split at the intersection with the partition line
+			auto  t     = side_start / (side_start - side_end);
+			Vec2d point = seg.start + (seg.end - seg.start) * t;
+			point.set(roundFixed(point.x), roundFixed(point.y));
+
+			auto first   = seg;
+			auto second  = seg;
+			first.end    = point;
+			first.v2     = -1;
+			second.start = point;
+			second.v1    = -1;
+
+			if (side_start > 0.)
+			{
+				front.push_back(first);
+				back.push_back(second);
+			}
+			else
+			{
+				back.push_back(first);
+				front.push_back(second);
+			}
+			break;
+		}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Clips the convex polygon [poly] (clockwise) to the [front] or back side of
+// the line through [origin] in (normalised) direction [dir]
+// -----------------------------------------------------------------------------
+void clipPolygon(vector<Vec2d>& poly, Vec2d origin, Vec2d dir, bool front)
+{
+	vector<Vec2d> clipped;
+	double        sign = front ? 1. : -1.;
+	for (unsigned a = 0; a < poly.size(); ++a)
+	{
+		auto p1 = poly[a];
+		auto p2 = poly[(a + 1) % poly.size()];
+		auto s1 = pointSide(p1, origin, dir) * sign;
+		auto s2 = pointSide(p2, origin, dir) * sign;
+
+		if (s1 > -SIDE_EPSILON)
+			clipped.push_back(p1);
+		if ((s1 > SIDE_EPSILON && s2 < -SIDE_EPSILON) || (s1 < -SIDE_EPSILON && s2 > SIDE_EPSILON))
+			clipped.push_back(p1 + (p2 - p1) * (s1 / (s1 - s2)));
+	}
+
+	// Remove (near) duplicate points
+	poly.clear();
+	for (const auto& point : clipped)
+		if (poly.empty() || point.distanceTo(poly.back()) > SIDE_EPSILON)
+			poly.push_back(point);
+	while (poly.size() > 1 && poly.back().distanceTo(poly[0]) <= SIDE_EPSILON)
+		poly.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Traces the outline of the subsector region [poly] (clockwise), adding [segs]
+// along its edges (and minisegs to fill any gaps between them) to [out].
+// Returns false if any of [segs] aren't on an edge of [poly]
+// -----------------------------------------------------------------------------
+bool traceLeaf(const vector<Vec2d>& poly, const vector<BuildSeg>& segs, vector<LeafSeg>& out)
+{
+	vector<bool>                   placed(segs.size());
+	vector<std::pair<double, int>> edge_segs;
+	for (unsigned a = 0; a < poly.size(); ++a)
+	{
+		auto start  = poly[a];
+		auto delta  = poly[(a + 1) % poly.size()] - start;
+		auto length = delta.magnitude();
+		auto dir    = delta.normalized();
+		if (length <= SIDE_EPSILON)
+			continue;
+
+		// Get segs along this edge, in order
+		edge_segs.clear();
+		for (unsigned s = 0; s < segs.size(); ++s)
+		{
+			auto& seg = segs[s];
+			if (placed[s] || std::abs(pointSide(seg.start, start, dir)) > SIDE_EPSILON
+				|| std::abs(pointSide(seg.end, start, dir)) > SIDE_EPSILON || (seg.end - seg.start).dot(dir) <= 0.)
+				continue;
+
+			edge_segs.emplace_back((seg.start - start).dot(dir), s);
+			placed[s] = true;
+		}
+		std::sort(edge_segs.begin(), edge_segs.end());
+
+		// Add segs, with minisegs between them
+		LeafSeg current{ start };
+		double  pos = 0.;
+		for (const auto& edge_seg : edge_segs)
+		{
+			auto& seg = segs[edge_seg.second];
+			if (edge_seg.first > pos + SIDE_EPSILON)
+				out.push_back(current);
+			out.push_back({ seg.start, seg.v1, seg.line, seg.side });
+
+			auto end = (seg.end - start).dot(dir);
+			if (end > pos)
+			{
+				pos     = end;
+				current = { seg.end, seg.v2 };
+			}
+		}
+		if (length > pos + SIDE_EPSILON)
+			out.push_back(current);
+	}
+
+	return std::all_of(placed.begin(), placed.end(), [](bool p) { return p; });
+}
+
+// -----------------------------------------------------------------------------
+// Adds [segs] to [out] ordered clockwise around their centre, with minisegs
+// between them where needed. Used when the subsector region couldn't be traced
+// -----------------------------------------------------------------------------
+void orderLeaf(const vector<BuildSeg>& segs, vector<LeafSeg>& out)
+{
+	Vec2d centre;
+	for (const auto& seg : segs)
+		centre = centre + (seg.start + seg.end) * 0.5;
+	centre = centre / static_cast<double>(segs.size());
+
+	vector<std::pair<double, const BuildSeg*>> sorted;
+	for (const auto& seg : segs)
+	{
+		auto mid = (seg.start + seg.end) * 0.5 - centre;
+		sorted.emplace_back(-std::atan2(mid.y, mid.x), &seg);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const auto& l, const auto& r) { return l.first < r.first; });
+
+	for (unsigned a = 0; a < sorted.size(); ++a)
+	{
+		auto seg  = sorted[a].second;
+		auto next = sorted[(a + 1) % sorted.size()].second;
+		out.push_back({ seg->start, seg->v1, seg->line, seg->side });
+		if (seg->end.distanceTo(next->start) > SIDE_EPSILON)
+			out.push_back({ seg->end, seg->v2 });
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Builds [tree] as a subsector containing [segs], where [planes] are the
+// partition lines above it
+// -----------------------------------------------------------------------------
+void buildLeaf(BuildTree& tree, const vector<BuildSeg>& segs, const vector<Plane>& planes, const BuildContext& context)
+{
+	// The subsector region is the map bounds clipped to the partition lines
+	// above it and the lines of its (convex) segs
+	auto poly = context.bounds;
+	for (const auto& plane : planes)
+		clipPolygon(poly, plane.origin, plane.dir, plane.front);
+	for (const auto& seg : segs)
+		clipPolygon(poly, seg.start, (seg.end - seg.start).normalized(), true);
+
+	if (poly.size() < 3 || !traceLeaf(poly, segs, tree.leaf))
+	{
+		tree.leaf.clear();
+		orderLeaf(segs, tree.leaf);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Chooses a partition line for [segs] and sorts them into [front] and [back].
+// Returns false if [segs] form a convex subsector (ie. [tree] is a leaf)
+// -----------------------------------------------------------------------------
+bool partitionSegs(
+	BuildTree&          tree,
+	vector<BuildSeg>&   segs,
+	vector<BuildSeg>&   front,
+	vector<BuildSeg>&   back,
+	const BuildContext& context,
+	Vec2d&              dir)
+{
+	auto partition = choosePartition(segs, context.max_candidates);
+	if (partition < 0)
+		return false;
+
+	tree.origin = segs[partition].start;
+	tree.delta  = segs[partition].end - segs[partition].start;
+	dir         = tree.delta.normalized();
+	splitSegs(segs, tree.origin, dir, front, back);
+
+	tree.children[0] = std::make_unique<BuildTree>();
+	tree.children[1] = std::make_unique<BuildTree>();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Builds [tree] from [segs], where [planes] are the partition lines above it
+// -----------------------------------------------------------------------------
+void buildTree(BuildTree& tree, vector<BuildSeg> segs, vector<Plane>& planes, const BuildContext& context)
+{
+	vector<BuildSeg> front, back;
+	Vec2d            dir;
+	if (!partitionSegs(tree, segs, front, back, context, dir))
+	{
+		buildLeaf(tree, segs, planes, context);
+		return;
+	}
+	segs.clear();
+	segs.shrink_to_fit();
+
+	planes.push_back({ tree.origin, dir, true });
+	buildTree(*tree.children[0], std::move(front), planes, context);
+	planes.back().front = false;
+	buildTree(*tree.children[1], std::move(back), planes, context);
+	planes.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Builds the top [depth] levels of [tree] from [segs], adding the subtrees
+// below them (or any with only a few segs) to [tasks] to be built in parallel
+// -----------------------------------------------------------------------------
+void splitTasks(
+	BuildTree&          tree,
+	vector<BuildSeg>    segs,
+	vector<Plane>&      planes,
+	unsigned            depth,
+	vector<BuildTask>&  tasks,
+	const BuildContext& context)
+{
+	vector<BuildSeg> front, back;
+	Vec2d            dir;
+	if (depth == 0 || segs.size() < PARALLEL_MIN_SEGS)
+	{
+		tasks.push_back({ &tree, std::move(segs), planes });
+		return;
+	}
+	if (!partitionSegs(tree, segs, front, back, context, dir))
+	{
+		buildLeaf(tree, segs, planes, context);
+		return;
+	}
+	segs.clear();
+	segs.shrink_to_fit();
+
+	planes.push_back({ tree.origin, dir, true });
+	splitTasks(*tree.children[0], std::move(front), planes, depth - 1, tasks, context);
+	planes.back().front = false;
+	splitTasks(*tree.children[1], std::move(back), planes, depth - 1, tasks, context);
+	planes.pop_back();
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// NodeBuilder Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Builds nodes for the map in snapshot [map]. Returns false if the map has no
+// lines to build nodes from
+// -----------------------------------------------------------------------------
+bool NodeBuilder::build(const MapSnapshot& map)
+{
+	error_.clear();
+	new_vertices_.clear();
+	subsectors_.clear();
+	segs_.clear();
+	nodes_.clear();
+
+	// Get map vertex positions (as they will be written to the map)
+	vector<Vec2d> vertices;
+	vertices.reserve(map.vertices().size());
+	for (const auto& vertex : map.vertices())
+	{
+		auto x = vertex->props_internal.get<double>(MapVertex::PROP_X);
+		auto y = vertex->props_internal.get<double>(MapVertex::PROP_Y);
+		if (options_.fractional_vertices)
+			vertices.emplace_back(roundFixed(x), roundFixed(y));
+		else
+			vertices.emplace_back(static_cast<int16_t>(x), static_cast<int16_t>(y));
+	}
+	n_org_vertices_ = vertices.size();
+
+	// Create initial segs from line sides
+	vector<BuildSeg> segs;
+	Bounds           bounds;
+	for (unsigned index = 0; index < map.lines().size(); ++index)
+	{
+		auto& line = *map.lines()[index];
+		int   v1   = map.indexOf(line.props_internal.get<unsigned>(MapLine::PROP_V1));
+		int   v2   = map.indexOf(line.props_internal.get<unsigned>(MapLine::PROP_V2));
+		if (v1 < 0 || v2 < 0 || vertices[v1] == vertices[v2])
+			continue;
+
+		if (line.props_internal.get<unsigned>("s1") > 0)
+			segs.push_back({ vertices[v1], vertices[v2], v1, v2, index, 0 });
+		if (line.props_internal.get<unsigned>("s2") > 0)
+			segs.push_back({ vertices[v2], vertices[v1], v2, v1, index, 1 });
+
+		bounds.extend(vertices[v1]);
+		bounds.extend(vertices[v2]);
+	}
+	if (segs.empty())
+	{
+		error_ = "Map has no lines to build nodes from";
+		return false;
+	}
+
+	// Setup build context
+	BuildContext context;
+	context.max_candidates = options_.fast ? CANDIDATES_FAST : CANDIDATES_OPTIMISE;
+	context.bounds         = { { bounds.min_x - BOUNDS_MARGIN, bounds.max_y + BOUNDS_MARGIN },
+							   { bounds.max_x + BOUNDS_MARGIN, bounds.max_y + BOUNDS_MARGIN },
+							   { bounds.max_x + BOUNDS_MARGIN, bounds.min_y - BOUNDS_MARGIN },
+							   { bounds.min_x - BOUNDS_MARGIN, bounds.min_y - BOUNDS_MARGIN } };
+
+	// Build the top of the tree, then the subtrees below it in parallel
+	BuildTree         root;
+	vector<BuildTask> tasks;
+	vector<Plane>     planes;
+	unsigned          depth = 2;
+	while ((1u << depth) < threadpool::pool().numThreads() * 4)
+		++depth;
+	splitTasks(root, std::move(segs), planes, depth, tasks, context);
+	threadpool::parallelFor(
+		tasks.size(),
+		[&](size_t index)
+		{
+			auto& task = tasks[index];
+			buildTree(*task.tree, std::move(task.segs), task.planes, context);
+		});
+	tasks.clear();
+
+	// Write tree to output, with vertices created by the builder merged by position
+	std::unordered_map<uint64_t, uint32_t> vertex_map;
+	for (unsigned a = 0; a < vertices.size(); ++a)
+		vertex_map.emplace(pairKey(toFixed(vertices[a].x), toFixed(vertices[a].y)), a);
+
+	std::function<uint32_t(BuildTree&, Bounds&)> write_tree = [&](BuildTree& tree, Bounds& tree_bounds) -> uint32_t {
+		// Subsector
+		if (tree.isLeaf())
+		{
+			for (const auto& seg : tree.leaf)
+			{
+				auto v = static_cast<uint32_t>(seg.vertex);
+				if (seg.vertex < 0)
+				{
+					auto x        = toFixed(seg.pos.x);
+					auto y        = toFixed(seg.pos.y);
+					auto inserted = vertex_map.emplace(pairKey(x, y), n_org_vertices_ + new_vertices_.size());
+					if (inserted.second)
+						new_vertices_.push_back({ x, y });
+					v = inserted.first->second;
+				}
+
+				segs_.push_back({ v, NO_INDEX, seg.line, seg.side });
+				tree_bounds.extend(seg.pos);
+			}
+
+			subsectors_.push_back(tree.leaf.size());
+			tree.leaf.clear();
+			tree.leaf.shrink_to_fit();
+			return (subsectors_.size() - 1) | CHILD_SUBSECT;
+		}
+
+		// Node (children are written first)
+		Node   node{};
+		Bounds child_bounds[2];
+		for (unsigned a = 0; a < 2; ++a)
+		{
+			node.children[a] = write_tree(*tree.children[a], child_bounds[a]);
+			tree.children[a].reset();
+
+			auto& box   = child_bounds[a];
+			auto  clamp = [](double value) { return static_cast<int16_t>(std::clamp(value, -32768., 32767.)); };
+			node.bbox[a][0] = clamp(std::ceil(box.max_y));
+			node.bbox[a][1] = clamp(std::floor(box.min_y));
+			node.bbox[a][2] = clamp(std::floor(box.min_x));
+			node.bbox[a][3] = clamp(std::ceil(box.max_x));
+			tree_bounds.extend(box);
+		}
+		node.x  = toFixed(tree.origin.x);
+		node.y  = toFixed(tree.origin.y);
+		node.dx = toFixed(tree.delta.x);
+		node.dy = toFixed(tree.delta.y);
+		nodes_.push_back(node);
+
+		return nodes_.size() - 1;
+	};
+	Bounds map_bounds;
+	write_tree(root, map_bounds);
+
+	// Find seg partners (the seg on the other side of the same line or miniseg)
+	std::unordered_map<uint64_t, uint32_t> seg_map;
+	seg_map.reserve(segs_.size());
+	uint32_t first = 0;
+	for (auto count : subsectors_)
+	{
+		for (uint32_t a = 0; a < count; ++a)
+		{
+			auto& seg   = segs_[first + a];
+			auto  v2    = segs_[first + (a + 1) % count].v1;
+			auto  other = seg_map.find(pairKey(v2, seg.v1));
+			if (other != seg_map.end() && segs_[other->second].partner == NO_INDEX)
+			{
+				seg.partner                  = other->second;
+				segs_[other->second].partner = first + a;
+			}
+			else
+				seg_map[pairKey(seg.v1, v2)] = first + a;
+		}
+		first += count;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the built nodes to [out] in XGL3 format, or ZGL3 (zlib compressed) if
+// the compress option is set
+// -----------------------------------------------------------------------------
+void NodeBuilder::write(MemChunk& out) const
+{
+	vector<uint8_t> data;
+	auto            write = [&data](const auto& value)
+	{
+		auto bytes = reinterpret_cast<const uint8_t*>(&value);
+		data.insert(data.end(), bytes, bytes + sizeof(value));
+	};
+
+	// Vertices
+	write(static_cast<uint32_t>(n_org_vertices_));
+	write(static_cast<uint32_t>(new_vertices_.size()));
+	for (const auto& vertex : new_vertices_)
+	{
+		write(vertex.x);
+		write(vertex.y);
+	}
+
+	// Subsectors
+	write(static_cast<uint32_t>(subsectors_.size()));
+	for (auto count : subsectors_)
+		write(count);
+
+	// Segs
+	write(static_cast<uint32_t>(segs_.size()));
+	for (const auto& seg : segs_)
+	{
+		write(seg.v1);
+		write(seg.partner);
+		write(seg.line);
+		write(seg.side);
+	}
+
+	// Nodes
+	write(static_cast<uint32_t>(nodes_.size()));
+	for (const auto& node : nodes_)
+	{
+		write(node.x);
+		write(node.y);
+		write(node.dx);
+		write(node.dy);
+		for (const auto& bbox : node.bbox)
+			for (auto value : bbox)
+				write(value);
+		write(node.children[0]);
+		write(node.children[1]);
+	}
+
+	// Write to output
+	out.clear();
+	MemChunk body{ data.data(), static_cast<uint32_t>(data.size()) };
+	MemChunk compressed;
+	if (options_.compress && compression::zlibDeflateParallel(body, compressed))
+	{
+		out.write(0, "ZGL3", 4, true);
+		out.write(4, compressed.data(), compressed.size(), true);
+	}
+	else
+	{
+		out.write(0, "XGL3", 4, true);
+		out.write(4, body.data(), body.size(), true);
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+namespace slade
+{
+class MapSnapshot;
+
+// Builds GL nodes for a map directly from a snapshot of its map data, in
+// ZDoom's extended node format (XGL3, or ZGL3 if compressed). Subtrees of the
+// BSP tree are built in parallel. Since it only reads the snapshot, a build
+// can run in the background while the map itself is written or edited
+class NodeBuilder
+{
+public:
+	struct Options
+	{
+		bool fast                = false; // Only try a few partition lines per node (unoptimised nodes)
+		bool compress            = true;  // Write compressed (ZGL3) nodes
+		bool fractional_vertices = false; // Map vertices can have fractional positions (UDMF)
+	};
+
+	NodeBuilder() = default;
+	NodeBuilder(const Options& options) : options_{ options } {}
+	~NodeBuilder() = default;
+
+	const string& error() const { return error_; }
+	unsigned      nNodes() const { return nodes_.size(); }
+	unsigned      nSubsectors() const { return subsectors_.size(); }
+	unsigned      nSegs() const { return segs_.size(); }
+
+	bool build(const MapSnapshot& map);
+	void write(MemChunk& out) const;
+
+private:
+	struct Vertex
+	{
+		int32_t x; // Fixed point (16.16)
+		int32_t y;
+	};
+
+	struct Seg
+	{
+		uint32_t v1;
+		uint32_t partner;
+		uint32_t line;
+		uint8_t  side;
+	};
+
+	struct Node
+	{
+		int32_t  x; // Fixed point (16.16) partition line
+		int32_t  y;
+		int32_t  dx;
+		int32_t  dy;
+		int16_t  bbox[2][4]; // Top, bottom, left, right of front and back children
+		uint32_t children[2];
+	};
+
+	Options          options_;
+	string           error_;
+	unsigned         n_org_vertices_ = 0;
+	vector<Vertex>   new_vertices_;
+	vector<uint32_t> subsectors_; // Number of segs in each subsector
+	vector<Seg>      segs_;
+	vector<Node>     nodes_;
+};
+} // namespace slade
@@ -50,6 +50,7 @@ namespace slade::nodebuilders
 vector<Builder> builders;
 Builder         invalid;
 Builder         none;
+Builder         internal;
 string          custom;
 vector<string>  builder_paths;
 } // namespace slade::nodebuilders
@@ -73,6 +74,14 @@ void nodebuilders::init()
 	none.name  = "Don't Build Nodes";
 	builders.push_back(none);
 
+	// Built-in builder
+	internal.id          = "slade";
+	internal.name        = "SLADE (Built-in, GL nodes for ZDoom-based ports)";
+	internal.internal    = true;
+	internal.options     = { "--fast", "--uncompressed" };
+	internal.option_desc = { "Fast, unoptimised nodes (for testing)", "Uncompressed nodes" };
+	builders.push_back(internal);
+
 	// Get nodebuilders configuration from slade.pk3
 	auto archive = app::archiveManager().programResourceArchive();
 	auto config  = archive->entryAtPath("config/nodebuilders.cfg");
@@ -11,6 +11,7 @@ struct Builder
 	string         exe;
 	vector<string> options;
 	vector<string> option_desc;
+	bool           internal = false; // Built-in node builder (see NodeBuilder)
 };
 
 void     init();
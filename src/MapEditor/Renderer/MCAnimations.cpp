@@ -91,6 +91,7 @@ void MCASelboxFader::draw()
 	// Outline
 	colourconfig::setGLColour("map_selbox_outline", fade_);
 	glLineWidth(2.0f);
+	gl::countDrawCall();
 	glBegin(GL_LINE_LOOP);
 	glVertex2d(tl_.x, tl_.y);
 	glVertex2d(tl_.x, br_.y);
@@ -100,6 +101,7 @@ void MCASelboxFader::draw()
 
 	// Fill
 	colourconfig::setGLColour("map_selbox_fill", fade_);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glVertex2d(tl_.x, tl_.y);
 	glVertex2d(tl_.x, br_.y);
@@ -180,6 +182,7 @@ void MCAThingSelection::draw()
 		r += radius_ * 0.2 * fade_;
 
 	// Draw
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2f(0.0f, 0.0f);
 	glVertex2d(x_ - r, y_ - r);
@@ -249,6 +252,7 @@ void MCALineSelection::draw()
 
 	// Draw lines
 	glLineWidth(line_width * colourconfig::lineSelectionWidth());
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	for (unsigned a = 0; a < lines_.size(); a++)
 	{
@@ -360,6 +364,7 @@ void MCAVertexSelection::draw()
 		glPointSize(size_ + (size_ * fade_));
 	else
 		glPointSize(size_);
+	gl::countDrawCall();
 	glBegin(GL_POINTS);
 	for (auto& v : vertices_)
 		glVertex2d(v.x, v.y);
@@ -468,6 +473,7 @@ void MCA3dWallSelection::draw()
 	// Draw quad outline
 	glLineWidth(2.0f);
 	glEnable(GL_LINE_SMOOTH);
+	gl::countDrawCall();
 	glBegin(GL_LINE_LOOP);
 	for (auto& point : points_)
 		glVertex3d(point.x, point.y, point.z);
@@ -475,6 +481,7 @@ void MCA3dWallSelection::draw()
 
 	// Draw quad fill
 	colourconfig::setGLColour("map_3d_selection", fade_ * 0.5f);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	for (auto& point : points_)
 		glVertex3d(point.x, point.y, point.z);
@@ -42,8 +42,11 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
 #include "Utility/Polygon2D.h"
+#include "Utility/Profiler.h"
 
 using namespace slade;
 
@@ -80,10 +83,52 @@ CVAR(Bool, action_lines, true, CVar::Flag::Save)
 CVAR(String, arrow_pathed_color, "#22FFFF", CVar::Flag::Save)
 CVAR(String, arrow_dragon_color, "#FF2222", CVar::Flag::Save)
 CVAR(Bool, test_ssplit, false, CVar::Flag::Save)
+CVAR(Float, map_lod_scale, 0.05f, CVar::Flag::Save)
 namespace
 {
 // Texture coordinates for rendering square things (since we can't just rotate these)
 float sq_thing_tc[] = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+
+// Thing render passes for the things VBO, in the order they are drawn
+enum class ThingPass
+{
+	Shadow,
+	Icon,
+	FittedSprite,
+	Arrow
+};
+
+struct GLThingVert
+{
+	float x, y;
+	float u, v;
+	float r, g, b, a;
+};
+
+// A single textured quad to add to the things VBO
+struct ThingQuad
+{
+	ThingPass   pass;
+	unsigned    texture;
+	GLThingVert verts[4];
+};
+
+// A map object snapped to the level of detail grid, [x1,y1]-[x2,y2] are cell
+// coordinates (x2,y2 are unused for things)
+struct LODItem
+{
+	int      x1, y1, x2, y2;
+	unsigned index;
+
+	bool sameCells(const LODItem& other) const
+	{
+		return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2;
+	}
+	bool operator<(const LODItem& other) const
+	{
+		return std::tie(x1, y1, x2, y2, index) < std::tie(other.x1, other.y1, other.x2, other.y2, other.index);
+	}
+};
 } // namespace
 
 
@@ -95,6 +140,120 @@ float sq_thing_tc[] = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
 EXTERN_CVAR(Bool, use_zeth_icons)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Calls [func] with the first index and count of each run of consecutive
+// non-zero values in [dirty]
+// -----------------------------------------------------------------------------
+template<typename F> void forEachDirtyRun(const vector<uint8_t>& dirty, F&& func)
+{
+	unsigned a = 0;
+	while (a < dirty.size())
+	{
+		if (!dirty[a])
+		{
+			++a;
+			continue;
+		}
+
+		auto first = a;
+		while (a < dirty.size() && dirty[a])
+			++a;
+		func(first, a - first);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the colour to draw a thing of [type] with [args] (point lights are
+// drawn in their light colour)
+// -----------------------------------------------------------------------------
+ColRGBA thingColour(const game::ThingType& type, const MapObject::ArgSet& args)
+{
+	auto arg = [&args](int index) { return static_cast<uint8_t>(std::clamp(args[index], 0, 255)); };
+
+	if (type.pointLight().empty())
+		return type.colour();
+	if (type.pointLight() == "zdoom")
+		return { arg(0), arg(1), arg(2) };
+	if (type.pointLight() == "vavoom")
+		return { arg(1), arg(2), arg(3) };
+
+	return ColRGBA::WHITE;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the LOD grid cell coordinate for map position [pos], with cells of
+// size [cell]
+// -----------------------------------------------------------------------------
+int lodCell(double pos, double cell)
+{
+	return static_cast<int>(std::floor(pos / cell));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the map position of the centre of LOD grid cell coordinate [coord]
+// -----------------------------------------------------------------------------
+float lodCentre(int coord, double cell)
+{
+	return static_cast<float>((coord + 0.5) * cell);
+}
+
+// -----------------------------------------------------------------------------
+// Adds a quad to [quads] covering [x1,y1]-[x2,y2] relative to [pos], rotated
+// by [angle] degrees around [pos]. Texture coordinates are taken from
+// sq_thing_tc starting at [tc_start]
+// -----------------------------------------------------------------------------
+void addThingQuad(
+	vector<ThingQuad>& quads,
+	ThingPass          pass,
+	unsigned           texture,
+	Vec2d              pos,
+	double             x1,
+	double             y1,
+	double             x2,
+	double             y2,
+	const ColRGBA&     colour,
+	float              alpha,
+	double             angle    = 0.,
+	int                tc_start = 0)
+{
+	double corners[] = { x1, y1, x1, y2, x2, y2, x2, y1 };
+	double sin_a     = 0.;
+	double cos_a     = 1.;
+	if (angle != 0.)
+	{
+		sin_a = sin(math::degToRad(angle));
+		cos_a = cos(math::degToRad(angle));
+	}
+
+	auto& quad   = quads.emplace_back();
+	quad.pass    = pass;
+	quad.texture = texture;
+	for (unsigned a = 0; a < 4; ++a)
+	{
+		auto  x  = corners[a * 2];
+		auto  y  = corners[a * 2 + 1];
+		auto  tc = (tc_start + a * 2) % 8;
+		auto& v  = quad.verts[a];
+		v.x      = pos.x + x * cos_a - y * sin_a;
+		v.y      = pos.y + x * sin_a + y * cos_a;
+		v.u      = sq_thing_tc[tc];
+		v.v      = sq_thing_tc[tc + 1];
+		v.r      = colour.fr();
+		v.g      = colour.fg();
+		v.b      = colour.fb();
+		v.a      = alpha;
+	}
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapRenderer2D Class Functions
@@ -113,6 +272,12 @@ MapRenderer2D::~MapRenderer2D()
 		glDeleteBuffers(1, &vbo_lines_);
 	if (vbo_flats_ > 0)
 		glDeleteBuffers(1, &vbo_flats_);
+	if (vbo_things_ > 0)
+		glDeleteBuffers(1, &vbo_things_);
+	if (vbo_lines_lod_ > 0)
+		glDeleteBuffers(1, &vbo_lines_lod_);
+	if (vbo_object_edit_ > 0)
+		glDeleteBuffers(1, &vbo_object_edit_);
 	if (list_vertices_ > 0)
 		glDeleteLists(list_vertices_, 1);
 	if (list_lines_ > 0)
@@ -182,12 +347,15 @@ bool MapRenderer2D::setupVertexRendering(float size_scale, bool overlay) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderVertices(float alpha)
 {
+	PROFILE_SCOPE("MapRenderer2D::renderVertices");
+
 	// Check there are any vertices to render
 	if (map_->nVertices() == 0)
 		return;
 
-	// Don't bother if (practically) invisible
-	if (alpha <= 0.01f)
+	// Don't bother if (practically) invisible, or zoomed out far enough that
+	// vertices would just be a mass of overlapping points
+	if (alpha <= 0.01f || lodLevel() > 0)
 		return;
 
 	// Setup rendering properties
@@ -218,7 +386,10 @@ void MapRenderer2D::renderVerticesImmediate()
 {
 	if (list_vertices_ > 0 && map_->nVertices() == n_vertices_ && map_->geometryUpdated() <= vertices_updated_
 		&& !map_->mapData().modifiedSince(vertices_updated_, MapObject::Type::Vertex))
+	{
+		gl::countDrawCall();
 		glCallList(list_vertices_);
+	}
 	else
 	{
 		// Rebuild display list
@@ -229,6 +400,7 @@ void MapRenderer2D::renderVerticesImmediate()
 		glNewList(list_vertices_, GL_COMPILE_AND_EXECUTE);
 
 		// Draw all vertices
+		gl::countDrawCall();
 		glBegin(GL_POINTS);
 		for (unsigned a = 0; a < map_->nVertices(); a++)
 			glVertex2d(map_->vertex(a)->xPos(), map_->vertex(a)->yPos());
@@ -249,9 +421,12 @@ void MapRenderer2D::renderVerticesVBO()
 	if (map_->nVertices() == 0)
 		return;
 
-	// Update vertices VBO if required
+	// Update vertices VBO if required (only modified vertices if possible)
 	if (vbo_vertices_ == 0 || map_->nVertices() != n_vertices_ || map_->geometryUpdated() > vertices_updated_)
-		updateVerticesVBO();
+	{
+		if (!updateModifiedVertices())
+			updateVerticesVBO();
+	}
 
 	// Set VBO arrays to use
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -263,6 +438,7 @@ void MapRenderer2D::renderVerticesVBO()
 	glVertexPointer(2, GL_FLOAT, 0, nullptr);
 
 	// Render the VBO
+	gl::countDrawCall();
 	glDrawArrays(GL_POINTS, 0, map_->nVertices());
 
 	// Cleanup state
@@ -290,6 +466,7 @@ void MapRenderer2D::renderVertexHilight(int index, float fade) const
 	bool point = setupVertexRendering(1.8f + (0.6f * fade), true);
 
 	// Draw vertex
+	gl::countDrawCall();
 	glBegin(GL_POINTS);
 	glVertex2d(map_->vertex(index)->xPos(), map_->vertex(index)->yPos());
 	glEnd();
@@ -322,6 +499,7 @@ void MapRenderer2D::renderVertexSelection(const ItemSelection& selection, float
 	bool point = setupVertexRendering(1.8f, true);
 
 	// Draw selected vertices
+	gl::countDrawCall();
 	glBegin(GL_POINTS);
 	for (const auto& item : selection)
 	{
@@ -371,6 +549,8 @@ ColRGBA MapRenderer2D::lineColour(MapLine* line, bool ignore_filter) const
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderLines(bool show_direction, float alpha)
 {
+	PROFILE_SCOPE("MapRenderer2D::renderLines");
+
 	// Check there are any lines to render
 	if (map_->nLines() == 0)
 		return;
@@ -389,7 +569,12 @@ void MapRenderer2D::renderLines(bool show_direction, float alpha)
 
 	// Render the lines depending on what features are supported
 	if (gl::vboSupport())
-		renderLinesVBO(show_direction, alpha);
+	{
+		if (lodLevel() > 0)
+			renderLinesLOD(alpha);
+		else
+			renderLinesVBO(show_direction, alpha);
+	}
 	else
 		renderLinesImmediate(show_direction, alpha);
 }
@@ -404,6 +589,7 @@ void MapRenderer2D::renderLinesImmediate(bool show_direction, float alpha)
 		&& map_->geometryUpdated() <= lines_updated_
 		&& !map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
 	{
+		gl::countDrawCall();
 		glCallList(list_lines_);
 		return;
 	}
@@ -420,6 +606,7 @@ void MapRenderer2D::renderLinesImmediate(bool show_direction, float alpha)
 	ColRGBA  col;
 	MapLine* line = nullptr;
 	double   x1, y1, x2, y2;
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
@@ -465,11 +652,14 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 	if (map_->nLines() == 0)
 		return;
 
-	// Update lines VBO if required
+	// Update lines VBO if required (only modified lines if possible)
 	if (vbo_lines_ == 0 || show_direction != lines_dirs_ || map_->nLines() != n_lines_
 		|| map_->geometryUpdated() > lines_updated_
 		|| map_->mapData().modifiedSince(lines_updated_, MapObject::Type::Line))
-		updateLinesVBO(show_direction, alpha);
+	{
+		if (!updateModifiedLines(show_direction, alpha))
+			updateLinesVBO(show_direction, alpha);
+	}
 
 	// Disable any blending
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -485,13 +675,19 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 
 	glColorPointer(4, GL_FLOAT, 24, ((char*)nullptr + 8));
 
+	// Use the flat colour shader if supported
+	if (auto shader = gl::shader(gl::ShaderType::FlatColour))
+		shader->bind();
+
 	// Render the VBO
+	gl::countDrawCall();
 	if (show_direction)
 		glDrawArrays(GL_LINES, 0, map_->nLines() * 4);
 	else
 		glDrawArrays(GL_LINES, 0, map_->nLines() * 2);
 
 	// Clean state
+	gl::Shader::unbind();
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -499,6 +695,43 @@ void MapRenderer2D::renderLinesVBO(bool show_direction, float alpha)
 	lines_dirs_ = show_direction;
 }
 
+// -----------------------------------------------------------------------------
+// Renders simplified map lines from the LOD lines VBO (see updateLinesLOD)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderLinesLOD(float alpha)
+{
+	// Update LOD lines VBO if required
+	auto level = lodLevel();
+	if (vbo_lines_lod_ == 0 || !lod_lines_.matches(level, alpha, map_->nLines())
+		|| map_->geometryUpdated() > lod_lines_.updated
+		|| map_->mapData().modifiedSince(lod_lines_.updated, MapObject::Type::Line))
+		updateLinesLOD(level, alpha);
+
+	// Set VBO arrays to use
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	// Setup VBO pointers
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_lod_);
+	glVertexPointer(2, GL_FLOAT, 24, nullptr);
+	glColorPointer(4, GL_FLOAT, 24, ((char*)nullptr + 8));
+
+	// Use the flat colour shader if supported
+	if (auto shader = gl::shader(gl::ShaderType::FlatColour))
+		shader->bind();
+
+	// Render the VBO
+	gl::countDrawCall();
+	glDrawArrays(GL_LINES, 0, lod_lines_.count);
+
+	// Clean state
+	gl::Shader::unbind();
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 // -----------------------------------------------------------------------------
 // Renders the line hilight overlay for line [index]
 // -----------------------------------------------------------------------------
@@ -524,6 +757,7 @@ void MapRenderer2D::renderLineHilight(int index, float fade) const
 	double y1   = line->v1()->yPos();
 	double x2   = line->v2()->xPos();
 	double y2   = line->v2()->yPos();
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(x1, y1);
 	glVertex2d(x2, y2);
@@ -532,6 +766,7 @@ void MapRenderer2D::renderLineHilight(int index, float fade) const
 	// Direction tab
 	auto mid = line->getPoint(MapObject::Point::Mid);
 	auto tab = line->dirTabPoint();
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(mid.x, mid.y);
 	glVertex2d(tab.x, tab.y);
@@ -559,6 +794,7 @@ void MapRenderer2D::renderLineSelection(const ItemSelection& selection, float fa
 
 	// Render selected lines
 	MapLine* line;
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	for (const auto& item : selection)
 	{
@@ -606,6 +842,7 @@ void MapRenderer2D::renderTaggedLines(vector<MapLine*>& lines, float fade) const
 		y1 = line->v1()->yPos();
 		x2 = line->v2()->xPos();
 		y2 = line->v2()->yPos();
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(x1, y1);
 		glVertex2d(x2, y2);
@@ -614,6 +851,7 @@ void MapRenderer2D::renderTaggedLines(vector<MapLine*>& lines, float fade) const
 		// Direction tab
 		auto mid = line->getPoint(MapObject::Point::Mid);
 		auto tab = line->dirTabPoint();
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(mid.x, mid.y);
 		glVertex2d(tab.x, tab.y);
@@ -663,6 +901,7 @@ void MapRenderer2D::renderTaggingLines(vector<MapLine*>& lines, float fade) cons
 		y1 = line->v1()->yPos();
 		x2 = line->v2()->xPos();
 		y2 = line->v2()->yPos();
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(x1, y1);
 		glVertex2d(x2, y2);
@@ -671,6 +910,7 @@ void MapRenderer2D::renderTaggingLines(vector<MapLine*>& lines, float fade) cons
 		// Direction tab
 		auto mid = line->getPoint(MapObject::Point::Mid);
 		auto tab = line->dirTabPoint();
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(mid.x, mid.y);
 		glVertex2d(tab.x, tab.y);
@@ -738,6 +978,7 @@ void MapRenderer2D::renderThingOverlay(double x, double y, double radius, bool p
 	if (thing_overlay_square && (thing_drawtype == ThingDrawType::Round || thing_drawtype == ThingDrawType::Sprite))
 	{
 		// Draw square
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glVertex2d(x - radius, y - radius);
 		glVertex2d(x - radius, y + radius);
@@ -756,6 +997,7 @@ void MapRenderer2D::renderThingOverlay(double x, double y, double radius, bool p
 	{
 		// Point sprite
 		glPointSize(ps);
+		gl::countDrawCall();
 		glBegin(GL_POINTS);
 		glVertex2d(x, y);
 		glEnd();
@@ -765,6 +1007,7 @@ void MapRenderer2D::renderThingOverlay(double x, double y, double radius, bool p
 		// Textured quad
 		if (point)
 			glDisable(GL_POINT_SPRITE);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glTexCoord2f(0.0f, 0.0f);
 		glVertex2d(x - radius, y - radius);
@@ -781,38 +1024,13 @@ void MapRenderer2D::renderThingOverlay(double x, double y, double radius, bool p
 }
 
 // -----------------------------------------------------------------------------
-// Renders a round thing icon at [x,y]
+// Returns the texture to use for a round thing of [type] facing [angle].
+// [rotate] is set to true if the texture should be rotated to the angle
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderRoundThing(
-	double                   x,
-	double                   y,
-	double                   angle,
-	const game::ThingType&   type,
-	const MapObject::ArgSet& args,
-	float                    alpha,
-	double                   radius_mult) const
+unsigned MapRenderer2D::roundThingTexture(const game::ThingType& type, double angle, bool& rotate) const
 {
-	// --- Determine texture to use ---
-	unsigned tex    = 0;
-	bool     rotate = false;
-
-	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	unsigned tex = 0;
+	rotate       = false;
 
 	// Check for custom thing icon
 	if (!type.icon().empty() && !thing_force_dir && !things_angles_)
@@ -838,6 +1056,134 @@ void MapRenderer2D::renderRoundThing(
 			tex = mapeditor::textureManager().editorImage("thing/normal_n").gl_id;
 	}
 
+	return tex;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the sprite texture for thing [index] of [type], cached in
+// thing_sprites_
+// -----------------------------------------------------------------------------
+unsigned MapRenderer2D::spriteTexture(unsigned index, const game::ThingType& type)
+{
+	// Refresh sprites list if needed
+	if (thing_sprites_.size() != map_->nThings())
+	{
+		thing_sprites_.clear();
+		for (unsigned a = 0; a < map_->nThings(); a++)
+			thing_sprites_.push_back(0);
+	}
+
+	auto tex = index < thing_sprites_.size() ? thing_sprites_[index] : 0;
+
+	// Attempt to get sprite texture
+	if (!tex)
+	{
+		tex = mapeditor::textureManager().sprite(type.sprite(), type.translation(), type.palette()).gl_id;
+
+		if (index < thing_sprites_.size())
+		{
+			thing_sprites_[index]  = tex;
+			thing_sprites_updated_ = app::runTimer();
+		}
+	}
+
+	return tex;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the texture to use for a square thing of [type] facing [angle].
+// [tc_start] is set to the index in sq_thing_tc of the first texture
+// coordinate to use, for rotating the texture to the angle
+// -----------------------------------------------------------------------------
+unsigned MapRenderer2D::squareThingTexture(
+	const game::ThingType& type,
+	double                 angle,
+	bool                   showicon,
+	bool                   framed,
+	int&                   tc_start) const
+{
+	unsigned tex = 0;
+	tc_start     = 0;
+
+	// Check for custom thing icon
+	if (!type.icon().empty() && showicon && !thing_force_dir && !things_angles_ && !framed)
+		tex = mapeditor::textureManager().editorImage(fmt::format("thing/square/{}", type.icon())).gl_id;
+
+	// Otherwise, no icon
+	if (!tex)
+	{
+		if (framed)
+		{
+			tex = mapeditor::textureManager().editorImage("thing/square/frame").gl_id;
+		}
+		else
+		{
+			tex = mapeditor::textureManager().editorImage("thing/square/normal_n").gl_id;
+
+			if ((type.angled() && showicon) || thing_force_dir || things_angles_)
+			{
+				tex = mapeditor::textureManager().editorImage("thing/square/normal_d1").gl_id;
+
+				// Setup variables depending on angle
+				switch ((int)angle)
+				{
+				case 0: // East: normal, texcoord 0
+					break;
+				case 45: // Northeast: diagonal, texcoord 0
+					tex = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
+					break;
+				case 90: // North: normal, texcoord 2
+					tc_start = 2;
+					break;
+				case 135: // Northwest: diagonal, texcoord 2
+					tex      = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
+					tc_start = 2;
+					break;
+				case 180: // West: normal, texcoord 4
+					tc_start = 4;
+					break;
+				case 225: // Southwest: diagonal, texcoord 4
+					tex      = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
+					tc_start = 4;
+					break;
+				case 270: // South: normal, texcoord 6
+					tc_start = 6;
+					break;
+				case 315: // Southeast: diagonal, texcoord 6
+					tex      = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
+					tc_start = 6;
+					break;
+				default: // Unsupported angle, don't draw arrow
+					tex = mapeditor::textureManager().editorImage("thing/square/normal_n").gl_id;
+					break;
+				};
+			}
+		}
+	}
+
+	return tex;
+}
+
+// -----------------------------------------------------------------------------
+// Renders a round thing icon at [x,y]
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderRoundThing(
+	double                   x,
+	double                   y,
+	double                   angle,
+	const game::ThingType&   type,
+	const MapObject::ArgSet& args,
+	float                    alpha,
+	double                   radius_mult) const
+{
+	// Determine texture to use
+	bool rotate;
+	auto tex = roundThingTexture(type, angle, rotate);
+
+	// Set colour
+	auto col = thingColour(type, args);
+	glColor4f(col.fr(), col.fg(), col.fb(), alpha);
+
 	// If for whatever reason the thing texture doesn't exist, just draw a basic, square thing
 	if (!tex)
 	{
@@ -861,6 +1207,7 @@ void MapRenderer2D::renderRoundThing(
 	double radius = type.radius() * radius_mult;
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2f(0.0f, 1.0f);
 	glVertex2d(x - radius, y - radius);
@@ -891,29 +1238,9 @@ bool MapRenderer2D::renderSpriteThing(
 	float                    alpha,
 	bool                     fitradius)
 {
-	// Refresh sprites list if needed
-	if (thing_sprites_.size() != map_->nThings())
-	{
-		thing_sprites_.clear();
-		for (unsigned a = 0; a < map_->nThings(); a++)
-			thing_sprites_.push_back(0);
-	}
-
 	// --- Determine texture to use ---
 	bool show_angle = false;
-	auto tex        = index < thing_sprites_.size() ? thing_sprites_[index] : 0;
-
-	// Attempt to get sprite texture
-	if (!tex)
-	{
-		tex = mapeditor::textureManager().sprite(type.sprite(), type.translation(), type.palette()).gl_id;
-
-		if (index < thing_sprites_.size())
-		{
-			thing_sprites_[index]  = tex;
-			thing_sprites_updated_ = app::runTimer();
-		}
-	}
+	auto tex        = spriteTexture(index, type);
 
 	// If sprite not found, just draw as a normal, round thing
 	if (!tex)
@@ -952,6 +1279,7 @@ bool MapRenderer2D::renderSpriteThing(
 		if (sz < 1)
 			sz = 1;
 		glColor4f(0.0f, 0.0f, 0.0f, alpha * (thing_shadow * 0.7));
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glTexCoord2f(0.0f, 1.0f);
 		glVertex2d(x - hw - sz, y - hh - sz);
@@ -962,6 +1290,7 @@ bool MapRenderer2D::renderSpriteThing(
 		glTexCoord2f(1.0f, 1.0f);
 		glVertex2d(x + hw + sz, y - hh - sz);
 		glEnd();
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glTexCoord2f(0.0f, 1.0f);
 		glVertex2d(x - hw - sz, y - hh - sz - sz);
@@ -975,6 +1304,7 @@ bool MapRenderer2D::renderSpriteThing(
 	}
 	// Draw thing
 	glColor4f(1.0f, 1.0f, 1.0f, alpha);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2f(0.0f, 1.0f);
 	glVertex2d(x - hw, y - hh);
@@ -1003,89 +1333,19 @@ bool MapRenderer2D::renderSquareThing(
 	bool                     showicon,
 	bool                     framed) const
 {
-	// --- Determine texture to use ---
-	unsigned tex = 0;
-
 	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	auto col = thingColour(type, args);
+	glColor4f(col.fr(), col.fg(), col.fb(), alpha);
 
 	// Show icon anyway if no sprite set
 	if (type.sprite().empty())
 		showicon = true;
 
-	// Check for custom thing icon
-	if (!type.icon().empty() && showicon && !thing_force_dir && !things_angles_ && !framed)
-		tex = mapeditor::textureManager().editorImage(fmt::format("thing/square/{}", type.icon())).gl_id;
+	// Determine texture to use
+	int  tc_start;
+	auto tex = squareThingTexture(type, angle, showicon, framed, tc_start);
 
-	// Otherwise, no icon
-	int tc_start = 0;
-	if (!tex)
-	{
-		if (framed)
-		{
-			tex = mapeditor::textureManager().editorImage("thing/square/frame").gl_id;
-		}
-		else
-		{
-			tex = mapeditor::textureManager().editorImage("thing/square/normal_n").gl_id;
-
-			if ((type.angled() && showicon) || thing_force_dir || things_angles_)
-			{
-				tex = mapeditor::textureManager().editorImage("thing/square/normal_d1").gl_id;
-
-				// Setup variables depending on angle
-				switch ((int)angle)
-				{
-				case 0: // East: normal, texcoord 0
-					break;
-				case 45: // Northeast: diagonal, texcoord 0
-					tex = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
-					break;
-				case 90: // North: normal, texcoord 2
-					tc_start = 2;
-					break;
-				case 135: // Northwest: diagonal, texcoord 2
-					tex      = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
-					tc_start = 2;
-					break;
-				case 180: // West: normal, texcoord 4
-					tc_start = 4;
-					break;
-				case 225: // Southwest: diagonal, texcoord 4
-					tex      = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
-					tc_start = 4;
-					break;
-				case 270: // South: normal, texcoord 6
-					tc_start = 6;
-					break;
-				case 315: // Southeast: diagonal, texcoord 6
-					tex      = mapeditor::textureManager().editorImage("thing/square/normal_d2").gl_id;
-					tc_start = 6;
-					break;
-				default: // Unsupported angle, don't draw arrow
-					tex = mapeditor::textureManager().editorImage("thing/square/normal_n").gl_id;
-					break;
-				};
-			}
-		}
-	}
-
-	// If for whatever reason the thing texture doesn't exist, just draw a basic, square thing
+	// If for whatever reason the thing texture doesn't exist, just draw a basic, square thing
 	if (!tex)
 	{
 		renderSimpleSquareThing(x, y, angle, type, args, alpha);
@@ -1099,6 +1359,7 @@ bool MapRenderer2D::renderSquareThing(
 	double radius = type.radius();
 	if (type.shrinkOnZoom())
 		radius = scaledRadius(radius);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	int tc = tc_start;
 	glTexCoord2f(sq_thing_tc[tc], sq_thing_tc[tc + 1]);
@@ -1146,6 +1407,7 @@ void MapRenderer2D::renderSimpleSquareThing(
 
 	// Draw background
 	glColor4f(0.0f, 0.0f, 0.0f, alpha);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glVertex2d(-radius, -radius);
 	glVertex2d(-radius, radius);
@@ -1154,24 +1416,11 @@ void MapRenderer2D::renderSimpleSquareThing(
 	glEnd();
 
 	// Set colour
-	if (type.pointLight().empty())
-		glColor4f(type.colour().fr(), type.colour().fg(), type.colour().fb(), alpha);
-	else if (type.pointLight() == "zdoom")
-		glColor4f(
-			static_cast<float>(args[0]) / 255.f,
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			alpha);
-	else if (type.pointLight() == "vavoom")
-		glColor4f(
-			static_cast<float>(args[1]) / 255.f,
-			static_cast<float>(args[2]) / 255.f,
-			static_cast<float>(args[3]) / 255.f,
-			alpha);
-	else
-		glColor4f(1.f, 1.f, 1.f, alpha);
+	auto col = thingColour(type, args);
+	glColor4f(col.fr(), col.fg(), col.fb(), alpha);
 
 	// Draw base
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glVertex2d(-radius + radius2, -radius + radius2);
 	glVertex2d(-radius + radius2, radius - radius2);
@@ -1184,6 +1433,7 @@ void MapRenderer2D::renderSimpleSquareThing(
 	{
 		glColor4f(0.0f, 0.0f, 0.0f, 1.0f);
 		glRotated(angle, 0, 0, 1);
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(0, 0);
 		glVertex2d(radius, 0);
@@ -1199,12 +1449,24 @@ void MapRenderer2D::renderSimpleSquareThing(
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderThings(float alpha, bool force_dir)
 {
+	PROFILE_SCOPE("MapRenderer2D::renderThings");
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
 
 	things_angles_ = force_dir;
-	renderThingsImmediate(alpha);
+
+	// Just draw thing density if zoomed out far enough
+	if (lodLevel() > 0)
+	{
+		renderThingsLOD(alpha);
+		return;
+	}
+
+	// Render the things depending on what features are supported
+	if (!gl::vboSupport() || !renderThingsVBO(alpha))
+		renderThingsImmediate(alpha);
 }
 
 // -----------------------------------------------------------------------------
@@ -1248,7 +1510,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				point = true;
 			}
 
-			for (unsigned a = 0; a < map_->nThings(); a++)
+			for (auto a : vis_t_near_)
 			{
 				if (vis_t_[a] > 0)
 					continue;
@@ -1259,7 +1521,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 					continue;
 
 				// Get thing info
-				auto&  tt     = game::configuration().thingType(thing->type());
+				auto&  tt     = thing->typeInfo();
 				double radius = (tt.radius() + 1);
 				if (tt.shrinkOnZoom())
 					radius = scaledRadius(radius);
@@ -1272,6 +1534,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				{
 					// Point sprite
 					glPointSize(radius * 2 * view_scale_);
+					gl::countDrawCall();
 					glBegin(GL_POINTS);
 					glVertex2d(x, y);
 					glEnd();
@@ -1281,6 +1544,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 					// Textured quad
 					if (point)
 						glDisable(GL_POINT_SPRITE);
+					gl::countDrawCall();
 					glBegin(GL_QUADS);
 					glTexCoord2f(0.0f, 1.0f);
 					glVertex2d(x - radius, y - radius);
@@ -1303,7 +1567,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 
 	// Draw things
 	double talpha;
-	for (unsigned a = 0; a < map_->nThings(); a++)
+	for (auto a : vis_t_near_)
 	{
 		if (vis_t_[a] > 0)
 			continue;
@@ -1321,7 +1585,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 			talpha = alpha;
 
 		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(thing->type());
+		auto& tt = thing->typeInfo();
 
 		// Reset thing sprite if modified
 		if (thing->modifiedTime() > last_update && thing_sprites_.size() > a)
@@ -1356,14 +1620,14 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 	{
 		glEnable(GL_TEXTURE_2D);
 
-		for (unsigned a = 0; a < map_->nThings(); a++)
+		for (auto a : vis_t_near_)
 		{
 			if (vis_t_[a] > 0)
 				continue;
 
 			// Get thing info
 			thing    = map_->thing(a);
-			auto& tt = game::configuration().thingType(thing->type());
+			auto& tt = thing->typeInfo();
 			x        = thing->xPos();
 			y        = thing->yPos();
 
@@ -1398,7 +1662,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				thing = map_->thing(things_arrow);
 				if (arrow_colour)
 				{
-					auto& tt = game::configuration().thingType(thing->type());
+					auto& tt = thing->typeInfo();
 					if (tt.defined())
 					{
 						acol.set(tt.colour());
@@ -1413,6 +1677,7 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 				glTranslated(x, y, 0);
 				glRotated(thing->angle(), 0, 0, 1);
 
+				gl::countDrawCall();
 				glBegin(GL_QUADS);
 				glTexCoord2f(0.0f, 1.0f);
 				glVertex2d(-32, -32);
@@ -1433,6 +1698,112 @@ void MapRenderer2D::renderThingsImmediate(float alpha)
 	glDisable(GL_TEXTURE_2D);
 }
 
+// -----------------------------------------------------------------------------
+// Renders map things using an OpenGL Vertex Buffer Object, with one draw call
+// per texture used.
+// Returns false if the things couldn't be built into the VBO (missing
+// textures), in which case they should be rendered in immediate mode instead
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::renderThingsVBO(float alpha)
+{
+	// Do nothing if there are no things in the map
+	if (map_->nThings() == 0)
+		return true;
+
+	// Check if any render settings have changed since the VBO was built
+	ThingsVBOState state;
+	state.drawtype     = thing_drawtype;
+	state.force_dir    = thing_force_dir;
+	state.angles       = things_angles_;
+	state.zeth_icons   = use_zeth_icons;
+	state.shadow       = thing_shadow;
+	state.alpha        = alpha;
+	state.arrow_alpha  = arrow_alpha;
+	state.arrow_colour = arrow_colour;
+	state.scale        = view_scale_ > 1.0 ? view_scale_ : 1.0;
+
+	bool update = vbo_things_ == 0 || !(state == things_vbo_state_) || map_->nThings() != n_things_
+				  || map_->thingsUpdated() > things_updated_
+				  || map_->mapData().modifiedSince(things_updated_, MapObject::Type::Thing);
+
+	// Filtering doesn't modify things, so check for changes separately
+	for (unsigned a = 0; !update && a < map_->nThings(); a++)
+		if (things_filtered_[a] != map_->thing(a)->isFiltered())
+			update = true;
+
+	// Update things VBO if required
+	if (update)
+	{
+		things_vbo_state_ = state;
+		if (!updateThingsVBO(alpha))
+			return false;
+	}
+
+	// Setup rendering properties
+	glEnable(GL_TEXTURE_2D);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Set VBO arrays to use
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	// Setup VBO pointers
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_things_);
+	glVertexPointer(2, GL_FLOAT, sizeof(GLThingVert), nullptr);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(GLThingVert), ((char*)nullptr + 8));
+	glColorPointer(4, GL_FLOAT, sizeof(GLThingVert), ((char*)nullptr + 16));
+
+	// Use the textured shader if supported
+	if (auto shader = gl::shader(gl::ShaderType::Textured))
+		shader->bind();
+
+	// Render each texture batch
+	for (auto& batch : thing_batches_)
+	{
+		gl::Texture::bind(batch.texture, false);
+		gl::countDrawCall();
+		glDrawArrays(GL_QUADS, batch.first, batch.count);
+	}
+
+	// Clean state
+	gl::Shader::unbind();
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDisable(GL_TEXTURE_2D);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Renders map things as points, one per LOD grid cell containing things (see
+// updateThingsLOD)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::renderThingsLOD(float alpha)
+{
+	// Update thing points if required
+	auto level = lodLevel();
+	if (!lod_things_.matches(level, alpha, map_->nThings())
+		|| map_->mapData().modifiedSince(lod_things_.updated, MapObject::Type::Thing))
+		updateThingsLOD(level, alpha);
+
+	// Each point covers its grid cell
+	glDisable(GL_TEXTURE_2D);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glPointSize(std::max(2.0f, static_cast<float>(std::ldexp(view_scale_, level))));
+
+	gl::countDrawCall();
+	glBegin(GL_POINTS);
+	for (auto& point : lod_thing_points_)
+	{
+		glColor4f(point.r, point.g, point.b, point.a);
+		glVertex2d(point.x, point.y);
+	}
+	glEnd();
+}
+
 // -----------------------------------------------------------------------------
 // Renders the thing hilight overlay for thing [index]
 // -----------------------------------------------------------------------------
@@ -1454,7 +1825,7 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 
 	// Get thing info
 	auto   thing = map_->thing(index);
-	auto&  tt    = game::configuration().thingType(thing->type());
+	auto&  tt    = thing->typeInfo();
 	double x     = thing->xPos();
 	double y     = thing->yPos();
 
@@ -1466,6 +1837,7 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 	{
 		glDisable(GL_TEXTURE_2D);
 		glLineWidth(3.0f);
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		glVertex2d(x - radius, y - radius);
 		glVertex2d(x - radius, y + radius);
@@ -1474,6 +1846,7 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 		glEnd();
 		col.a *= 0.5;
 		gl::setColour(col);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glVertex2d(x - radius, y - radius);
 		glVertex2d(x - radius, y + radius);
@@ -1508,6 +1881,7 @@ void MapRenderer2D::renderThingHilight(int index, float fade) const
 		gl::Texture::bind(tex);
 	}
 
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2f(0.0f, 0.0f);
 	glVertex2d(x - radius, y - radius);
@@ -1546,7 +1920,7 @@ void MapRenderer2D::renderThingSelection(const ItemSelection& selection, float f
 	{
 		if (auto thing = item.asThing(*map_))
 		{
-			auto&  tt     = game::configuration().thingType(thing->type());
+			auto&  tt     = thing->typeInfo();
 			double radius = tt.radius();
 			if (tt.shrinkOnZoom())
 				radius = scaledRadius(radius);
@@ -1588,7 +1962,7 @@ void MapRenderer2D::renderTaggedThings(vector<MapThing*>& things, float fade) co
 	// Draw all tagged overlays
 	for (auto thing : things)
 	{
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = thing->typeInfo();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -1643,7 +2017,7 @@ void MapRenderer2D::renderTaggingThings(vector<MapThing*>& things, float fade) c
 	// Draw all tagging overlays
 	for (auto thing : things)
 	{
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = thing->typeInfo();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -1687,173 +2061,30 @@ void MapRenderer2D::renderPathedThings(vector<MapThing*>& things)
 	if (!action_lines || things.empty())
 		return;
 
-	// Check if paths need updating
-	bool update = false;
-	if (thing_paths_.empty())
-		update = true;
-	else if (map_->thingsUpdated() > thing_paths_updated_)
-	{
-		for (auto& thing : things)
-		{
-			if (thing->modifiedTime() > thing_paths_updated_)
-			{
-				update = true;
-				break;
-			}
-		}
-		if (!update)
-			thing_paths_updated_ = app::runTimer();
-	}
-
 	// Get colours
 	wxColour col(arrow_pathed_color);
 	ColRGBA  pathedcol(col);
 	col.Set(arrow_dragon_color);
 	ColRGBA dragoncol(col);
 
-	if (update)
-	{
-		thing_paths_.clear();
-
-		// Find things that need to be pathed
-		for (unsigned a = 0; a < things.size(); ++a)
-		{
-			auto      thing = things[a];
-			ThingPath path;
-			path.from_index = 0;
-			path.to_index   = 0;
-
-			auto& tt = game::configuration().thingType(thing->type());
-
-			// Dragon Path
-			if (tt.flags() & game::ThingType::Flags::Dragon)
-			{
-				auto first = map_->things().firstWithId(thing->id());
-				if (first)
-				{
-					path.from_index = thing->index();
-					path.to_index   = first->index();
-					path.type       = PathType::Dragon;
-					thing_paths_.push_back(path);
-
-					vector<MapThing*> dragon_things;
-					dragon_things.clear();
-					map_->putDragonTargets(first, dragon_things);
-					for (unsigned d = 0; d < dragon_things.size(); ++d)
-					{
-						int   id1 = dragon_things[d]->id();
-						int   a11 = dragon_things[d]->arg(0);
-						int   a12 = dragon_things[d]->arg(1);
-						int   a13 = dragon_things[d]->arg(2);
-						int   a14 = dragon_things[d]->arg(3);
-						int   a15 = dragon_things[d]->arg(4);
-						auto& tt1 = game::configuration().thingType(dragon_things[d]->type());
-						for (unsigned e = d + 1; e < dragon_things.size(); ++e)
-						{
-							int   id2  = dragon_things[e]->id();
-							int   a21  = dragon_things[e]->arg(0);
-							int   a22  = dragon_things[e]->arg(1);
-							int   a23  = dragon_things[e]->arg(2);
-							int   a24  = dragon_things[e]->arg(3);
-							int   a25  = dragon_things[e]->arg(4);
-							auto& tt2  = game::configuration().thingType(dragon_things[e]->type());
-							bool l1to2 = ((a11 == id2) || (a12 == id2) || (a13 == id2) || (a14 == id2) || (a15 == id2));
-							bool l2to1 = ((a21 == id1) || (a22 == id1) || (a23 == id1) || (a24 == id1) || (a25 == id1));
-							if (!((tt1.flags() | tt2.flags()) & game::ThingType::Flags::Dragon))
-							{
-								ThingPath dpath;
-								if (l1to2)
-								{
-									dpath.from_index = dragon_things[e]->index();
-									dpath.to_index   = dragon_things[d]->index();
-									dpath.type       = l2to1 ? PathType::DragonBoth : PathType::Dragon;
-								}
-								else if (l2to1)
-								{
-									dpath.from_index = dragon_things[d]->index();
-									dpath.to_index   = dragon_things[e]->index();
-									dpath.type       = PathType::Dragon;
-								}
-								thing_paths_.push_back(dpath);
-							}
-						}
-					}
-				}
-				continue;
-			}
-
-			// Normal Path
-			int tid = -1, tid2 = -1;
-			int nexttype = tt.nextType();
-			int nextargs = tt.nextArgs();
-			if (nextargs)
-			{
-				int pos = nextargs % 10;
-				tid     = thing->arg(pos - 1);
-			}
-			if (nextargs >= 10)
-			{
-				int pos = nextargs / 10;
-				tid += (256 * thing->arg(pos - 1));
-			}
-			for (unsigned b = a + 1; b < things.size(); ++b)
-			{
-				auto thing2 = things[b];
-				if (thing2->type() == nexttype)
-				{
-					auto& tt2 = game::configuration().thingType(thing2->type());
-					nextargs  = tt2.nextArgs();
-					if (nextargs)
-					{
-						int pos = nextargs % 10;
-						tid2    = thing2->arg(pos - 1);
-					}
-					if (nextargs >= 10)
-					{
-						int pos = nextargs / 10;
-						tid2 += (256 * thing2->arg(pos - 1));
-					}
-					if (thing2->id() == tid)
-					{
-						path.from_index = thing->index();
-						path.to_index   = thing2->index();
-						path.type       = (tid2 == thing->id()) ? PathType::NormalBoth : PathType::Normal;
-					}
-					else if (thing->id() == tid2)
-					{
-						path.from_index = thing2->index();
-						path.to_index   = thing->index();
-						path.type       = PathType::Normal;
-					}
-					thing_paths_.push_back(path);
-				}
-			}
-		}
-		thing_paths_updated_ = app::runTimer();
-	}
-
 	// Setup GL stuff
 	glLineWidth(line_width * 1.5f);
 
-	for (auto& thing_path : thing_paths_)
+	// Draw paths (kept up to date by the map's thing list)
+	for (const auto& path : map_->things().paths())
 	{
-		if (thing_path.from_index == thing_path.to_index)
-			continue;
-
-		auto from = map_->thing(thing_path.from_index);
-
+		auto from = map_->thing(path.from);
 		if (from && ((from->arg(3) | (from->arg(4) << 8)) > 0))
 		{
-			auto to = map_->thing(thing_path.to_index);
+			auto to = map_->thing(path.to);
 			if (!to)
 				continue;
 
 			drawing::drawArrow(
 				to->getPoint(MapObject::Point::Mid),
 				from->getPoint(MapObject::Point::Mid),
-				(thing_path.type == PathType::DragonBoth || thing_path.type == PathType::Dragon) ? dragoncol :
-																								   pathedcol,
-				(thing_path.type == PathType::NormalBoth || thing_path.type == PathType::DragonBoth),
+				path.dragon ? dragoncol : pathedcol,
+				path.both,
 				arrowhead_angle,
 				arrowhead_length);
 		}
@@ -1877,7 +2108,7 @@ void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index) con
 
 	for (const auto& thing : map_->things())
 	{
-		const auto& ttype = game::configuration().thingType(thing->type());
+		const auto& ttype = thing->typeInfo();
 
 		// Not a point light
 		if (ttype.pointLight().empty())
@@ -1913,6 +2144,7 @@ void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index) con
 		light_radius *= 2; // Doubling the radius value matches better with in-game results
 		gl::setColour(light_col, gl::Blend::Additive);
 
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glTexCoord2f(0.0f, 0.0f);
 		glVertex2d(thing->xPos() - light_radius, thing->yPos() - light_radius);
@@ -1943,14 +2175,20 @@ void MapRenderer2D::renderPointLightPreviews(float alpha, int hilight_index) con
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderFlats(int type, bool texture, float alpha)
 {
+	PROFILE_SCOPE("MapRenderer2D::renderFlats");
+
 	// Don't bother if (practically) invisible
 	if (alpha <= 0.01f)
 		return;
 
+	// Flats that aren't loaded yet are left untextured until they are (the
+	// texture is checked again each frame while it is 0)
+	mapeditor::textureManager().setDeferLoading(true);
 	if (gl::vboSupport() && flats_use_vbo)
 		renderFlatsVBO(type, texture, alpha);
 	else
 		renderFlatsImmediate(type, texture, alpha);
+	mapeditor::textureManager().setDeferLoading(false);
 
 	flats_updated_ = app::runTimer();
 }
@@ -1995,7 +2233,7 @@ void MapRenderer2D::renderFlatsImmediate(int type, bool texture, float alpha)
 	// Go through sectors
 	unsigned tex_last = 0;
 	unsigned tex      = 0;
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	for (auto a : vis_s_near_)
 	{
 		auto sector = map_->sector(a);
 
@@ -2109,8 +2347,6 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 	using game::Feature;
 	using game::UDMFFeature;
 
-	bool vbo_updated = false;
-
 	if (flat_ignore_light)
 		glColor4f(flat_brightness, flat_brightness, flat_brightness, alpha);
 
@@ -2122,32 +2358,26 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 		alpha *= colourconfig::flatAlpha();
 
 	// Re-init flats texture list if invalid
-	if ((texture && tex_flats_.size() != map_->nSectors()) || last_flat_type_ != type)
+	if ((texture && (tex_flats_.size() != map_->nSectors() || tex_flats_array_.size() != map_->nSectors()))
+		|| last_flat_type_ != type)
 	{
 		tex_flats_.clear();
 		for (unsigned a = 0; a < map_->nSectors(); a++)
 			tex_flats_.push_back(0);
+		tex_flats_array_.assign(map_->nSectors(), { -1, 0 });
 
 		last_flat_type_ = type;
 	}
 
-	// First, check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
-		auto poly = map_->sector(a)->polygon();
-		if (poly && poly->vboUpdate() > 1)
-		{
-			updateFlatsVBO();
-			vbo_updated = true;
-		}
-	}
+	// Flats that are in a texture array are rendered afterwards in batches
+	// (by texture and colour), rather than binding textures for each sector
+	auto array_shader = texture ? gl::shader(gl::ShaderType::TexturedArray) : nullptr;
+	flat_batches_.clear();
 
-	// Create VBO if necessary
-	if (!vbo_updated && vbo_flats_ == 0)
-	{
+	// First, update any polygons whose vertex data has changed (or create the
+	// VBO if necessary)
+	if (!updateModifiedFlats())
 		updateFlatsVBO();
-		vbo_updated = true;
-	}
 
 	// Setup opengl state
 	if (texture)
@@ -2162,7 +2392,7 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 	unsigned tex      = 0;
 	bool     first    = true;
 	unsigned update   = 0;
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	for (auto a : vis_s_near_)
 	{
 		auto sector = map_->sector(a);
 
@@ -2183,8 +2413,9 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 				else
 					map_tex_props = &mapeditor::textureManager().flat(sector->ceiling().texture, mix_tex_flats);
 
-				tex           = map_tex_props->gl_id;
-				tex_flats_[a] = tex;
+				tex                 = map_tex_props->gl_id;
+				tex_flats_[a]       = tex;
+				tex_flats_array_[a] = { map_tex_props->array, map_tex_props->array_layer };
 			}
 			else
 				tex = tex_flats_[a];
@@ -2255,6 +2486,17 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 				break;
 		}
 
+		// Get sector colour
+		auto col = flat_ignore_light ? ColRGBA::WHITE : sector->colourAt(type);
+		col.ampf(flat_brightness, flat_brightness, flat_brightness, 1.0f);
+
+		// Add to a batch if the flat is in a texture array
+		if (array_shader && tex && tex_flats_array_[a].first >= 0)
+		{
+			flat_batches_.push_back({ tex_flats_array_[a].first, tex_flats_array_[a].second, col, a });
+			continue;
+		}
+
 		// Bind the texture if needed
 		if (tex)
 		{
@@ -2269,13 +2511,46 @@ void MapRenderer2D::renderFlatsVBO(int type, bool texture, float alpha)
 
 		// Render the polygon
 		if (!flat_ignore_light)
-		{
-			auto col = sector->colourAt(type);
-			col.ampf(flat_brightness, flat_brightness, flat_brightness, 1.0f);
 			glColor4f(col.fr(), col.fg(), col.fb(), alpha);
-		}
 		poly->renderVBO(false);
 	}
+
+	// Render texture array batches
+	if (!flat_batches_.empty())
+	{
+		std::sort(flat_batches_.begin(), flat_batches_.end(), [](const FlatBatch& left, const FlatBatch& right) {
+			return std::tie(left.array, left.layer, left.colour.r, left.colour.g, left.colour.b)
+				   < std::tie(right.array, right.layer, right.colour.r, right.colour.g, right.colour.b);
+		});
+
+		glDisable(GL_TEXTURE_2D);
+		array_shader->bind();
+		int         array = -1;
+		vector<int> firsts, counts;
+		for (unsigned i = 0; i < flat_batches_.size(); ++i)
+		{
+			auto& batch = flat_batches_[i];
+			map_->sector(batch.sector)->polygon()->putVBORanges(firsts, counts);
+			if (i + 1 < flat_batches_.size() && batch.sameBatch(flat_batches_[i + 1]))
+				continue;
+
+			// End of batch, render it
+			if (batch.array != array)
+			{
+				array = batch.array;
+				gl::Texture::bindArray(mapeditor::textureManager().flatArray(array));
+			}
+			array_shader->setUniform("layer", static_cast<float>(batch.layer));
+			glColor4f(batch.colour.fr(), batch.colour.fg(), batch.colour.fb(), alpha);
+			gl::countDrawCall();
+			glMultiDrawArrays(GL_TRIANGLE_FAN, firsts.data(), counts.data(), firsts.size());
+			firsts.clear();
+			counts.clear();
+		}
+		gl::Texture::bindArray(0);
+		gl::Shader::unbind();
+	}
+
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
@@ -2325,6 +2600,7 @@ void MapRenderer2D::renderFlatHilight(int index, float fade) const
 			continue;
 
 		// Draw line
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(line->v1()->xPos(), line->v1()->yPos());
 		glVertex2d(line->v2()->xPos(), line->v2()->yPos());
@@ -2392,6 +2668,7 @@ void MapRenderer2D::renderFlatSelection(const ItemSelection& selection, float fa
 			{
 				// Something went wrong with the polygon, just draw sector outline instead
 				glColor4f(col.fr(), col.fg(), col.fb(), col.fa());
+				gl::countDrawCall();
 				glBegin(GL_LINES);
 				for (auto& side : sides)
 				{
@@ -2410,6 +2687,7 @@ void MapRenderer2D::renderFlatSelection(const ItemSelection& selection, float fa
 	glColor4f(col.fr(), col.fg(), col.fb(), col.fa());
 	glLineWidth(line_width * 2);
 	vector<uint8_t> lines_drawn(map_->nLines(), 0);
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	for (auto& a : sides_selected)
 	{
@@ -2457,6 +2735,7 @@ void MapRenderer2D::renderTaggedFlats(vector<MapSector*>& sectors, float fade) c
 				continue;
 
 			// Draw line
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 			glVertex2d(line->v1()->xPos(), line->v1()->yPos());
 			glVertex2d(line->v2()->xPos(), line->v2()->yPos());
@@ -2487,194 +2766,185 @@ void MapRenderer2D::renderTaggedFlats(vector<MapSector*>& sectors, float fade) c
 }
 
 // -----------------------------------------------------------------------------
-// Renders the moving overlay for vertex indices in [vertices], to show movement
-// by [move_vec]
+// Builds the preview of [items] (of edit [mode]) being moved, drawn each frame
+// with renderMoving. This is done once when a move begins, so the preview
+// doesn't need to be rebuilt as the move offset changes.
+// Does nothing in things mode (see renderMovingThings)
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec) const
+void MapRenderer2D::buildMovingPreview(const vector<mapeditor::Item>& items, mapeditor::Mode mode)
 {
-	vector<uint8_t> lines_drawn(map_->nLines(), 0);
+	moving_verts_.clear();
+	moving_partial_.clear();
+	moving_partial_flags_.clear();
+	moving_overlay_ = moving_points_ = 0;
+	if (mode == mapeditor::Mode::Things)
+		return;
 
-	// Determine what lines need drawing (and which of their vertices are being moved)
-	for (const auto& item : vertices)
+	// Determine which vertices are moving, and the lines to show as moving
+	vector<uint8_t>  vertex_moving(map_->nVertices(), 0);
+	vector<uint8_t>  line_moving(map_->nLines(), 0);
+	vector<MapLine*> moving_lines;
+
+	auto add_line = [&](MapLine* line)
 	{
-		if (auto v = item.asVertex(*map_))
+		if (line_moving[line->index()])
+			return;
+
+		line_moving[line->index()]     = 1;
+		vertex_moving[line->v1Index()] = 1;
+		vertex_moving[line->v2Index()] = 1;
+		moving_lines.push_back(line);
+	};
+	for (const auto& item : items)
+	{
+		if (mode == mapeditor::Mode::Vertices)
 		{
-			for (const auto& line : v->connectedLines())
-			{
-				if (line->v1() == v)
-					lines_drawn[line->index()] |= 1;
-				if (line->v2() == v)
-					lines_drawn[line->index()] |= 2;
-			}
+			if (auto vertex = item.asVertex(*map_))
+				vertex_moving[vertex->index()] = 1;
+		}
+		else if (mode == mapeditor::Mode::Lines)
+		{
+			if (auto line = item.asLine(*map_))
+				add_line(line);
+		}
+		else if (auto sector = item.asSector(*map_))
+		{
+			for (auto& side : sector->connectedSides())
+				add_line(side->parentLine());
 		}
 	}
 
-	// Draw any lines attached to the moving vertices
-	glLineWidth(line_width);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_LINES);
+	auto add_vert = [](vector<GLVert>& verts, const Vec2d& pos, const ColRGBA& col)
+	{ verts.push_back({ (float)pos.x, (float)pos.y, col.fr(), col.fg(), col.fb(), col.fa() }); };
+
+	// Lines attached to moving vertices, split by whether both or only one of
+	// their vertices are moving
 	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
-		auto line  = map_->line(a);
-		auto drawn = lines_drawn[line->index()];
-
-		// Skip if not attached to any moving vertices
-		if (drawn == 0)
+		auto    line  = map_->line(a);
+		uint8_t flags = vertex_moving[line->v1Index()] | (vertex_moving[line->v2Index()] << 1);
+		if (flags == 0)
 			continue;
 
-		// Set line colour
-		gl::setColour(lineColour(line, true));
-
-		// First vertex
-		if (drawn & 1)
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-		else
-			glVertex2d(line->x1(), line->y1());
-
-		// Second vertex
-		if (drawn & 2)
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
+		auto col = lineColour(line, true);
+		if (flags == 3)
+		{
+			add_vert(moving_verts_, line->start(), col);
+			add_vert(moving_verts_, line->end(), col);
+		}
 		else
-			glVertex2d(line->x2(), line->y2());
+		{
+			add_vert(moving_partial_, line->start(), col);
+			add_vert(moving_partial_, line->end(), col);
+			moving_partial_flags_.push_back(flags & 1);
+			moving_partial_flags_.push_back(flags >> 1);
+		}
 	}
-	glEnd();
 
-	// Set 'moving' colour
-	colourconfig::setGLColour("map_moving");
-
-	// Draw moving vertex overlays
-	bool point = setupVertexRendering(1.5f);
-	glBegin(GL_POINTS);
-	for (const auto& item : vertices)
+	// Moving line overlays
+	auto col_moving = colourconfig::colour("map_moving");
+	moving_overlay_ = moving_verts_.size();
+	for (auto line : moving_lines)
 	{
-		if (auto v = item.asVertex(*map_))
-			glVertex2d(v->xPos() + move_vec.x, v->yPos() + move_vec.y);
+		add_vert(moving_verts_, line->start(), col_moving);
+		add_vert(moving_verts_, line->end(), col_moving);
 	}
-	glEnd();
 
-	// Clean up
-	if (point)
+	// Moving vertex overlays
+	moving_points_ = moving_verts_.size();
+	if (mode == mapeditor::Mode::Vertices)
+		for (unsigned a = 0; a < vertex_moving.size(); ++a)
+			if (vertex_moving[a])
+				add_vert(moving_verts_, map_->vertex(a)->position(), col_moving);
+
+	// Upload to the VBO if supported
+	if (gl::vboSupport() && !moving_verts_.empty())
 	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
+		if (vbo_moving_ == 0)
+			glGenBuffers(1, &vbo_moving_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_moving_);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * moving_verts_.size(), moving_verts_.data(), GL_STATIC_DRAW);
+		gl::countUpload(sizeof(GLVert) * moving_verts_.size());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 }
 
 // -----------------------------------------------------------------------------
-// Renders the moving overlay for line indices in [lines], to show movement by
+// Renders the moving preview built by buildMovingPreview, to show movement by
 // [move_vec]
 // -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec) const
+void MapRenderer2D::renderMoving(Vec2d move_vec)
 {
-	vector<uint8_t> lines_drawn(map_->nLines(), 0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
-	// Determine what lines need drawing (and which of their vertices are being moved)
-	for (const auto& item : lines)
+	// Lines with only one moving vertex
+	glLineWidth(line_width);
+	if (!moving_partial_.empty())
 	{
-		if (auto line = item.asLine(*map_))
+		moving_partial_draw_ = moving_partial_;
+		auto dx              = static_cast<float>(move_vec.x);
+		auto dy              = static_cast<float>(move_vec.y);
+		for (unsigned a = 0; a < moving_partial_draw_.size(); ++a)
 		{
-			// Check first vertex
-			auto v = line->v1();
-			for (unsigned l = 0; l < v->nConnectedLines(); l++)
-			{
-				auto cline = v->connectedLine(l);
-
-				if (cline->v1() == v)
-					lines_drawn[cline->index()] |= 1;
-				if (cline->v2() == v)
-					lines_drawn[cline->index()] |= 2;
-			}
-
-			// Check second vertex
-			v = line->v2();
-			for (unsigned l = 0; l < v->nConnectedLines(); l++)
-			{
-				auto cline = v->connectedLine(l);
-
-				if (cline->v1() == v)
-					lines_drawn[cline->index()] |= 1;
-				if (cline->v2() == v)
-					lines_drawn[cline->index()] |= 2;
-			}
+			moving_partial_draw_[a].x += dx * moving_partial_flags_[a];
+			moving_partial_draw_[a].y += dy * moving_partial_flags_[a];
 		}
+
+		glVertexPointer(2, GL_FLOAT, sizeof(GLVert), &moving_partial_draw_[0].x);
+		glColorPointer(4, GL_FLOAT, sizeof(GLVert), &moving_partial_draw_[0].r);
+		gl::countDrawCall();
+		glDrawArrays(GL_LINES, 0, moving_partial_draw_.size());
 	}
 
-	// Draw any lines attached to the moving vertices
-	glLineWidth(line_width);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glBegin(GL_LINES);
-	for (unsigned a = 0; a < map_->nLines(); a++)
+	// Everything else just needs translating
+	if (!moving_verts_.empty())
 	{
-		auto line  = map_->line(a);
-		auto drawn = lines_drawn[line->index()];
-
-		// Skip if not attached to any moving vertices
-		if (drawn == 0)
-			continue;
-
-		// Set line colour
-		gl::setColour(lineColour(line, true));
-
-		// First vertex
-		if (drawn & 1)
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-		else
-			glVertex2d(line->x1(), line->y1());
+		glPushMatrix();
+		glTranslated(move_vec.x, move_vec.y, 0);
 
-		// Second vertex
-		if (drawn & 2)
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
-		else
-			glVertex2d(line->x2(), line->y2());
-	}
-	glEnd();
+		auto base = reinterpret_cast<const char*>(moving_verts_.data());
+		if (vbo_moving_ > 0)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_moving_);
+			base = nullptr;
+		}
+		glVertexPointer(2, GL_FLOAT, sizeof(GLVert), base);
+		glColorPointer(4, GL_FLOAT, sizeof(GLVert), base + offsetof(GLVert, r));
 
-	// Set 'moving' colour
-	colourconfig::setGLColour("map_moving");
+		// Lines
+		gl::countDrawCall();
+		glDrawArrays(GL_LINES, 0, moving_overlay_);
 
-	// Draw moving line overlays
-	glLineWidth(line_width * 3);
-	glBegin(GL_LINES);
-	for (const auto& item : lines)
-	{
-		if (auto line = item.asLine(*map_))
+		// Line overlays
+		if (moving_points_ > moving_overlay_)
 		{
-			glVertex2d(line->x1() + move_vec.x, line->y1() + move_vec.y);
-			glVertex2d(line->x2() + move_vec.x, line->y2() + move_vec.y);
+			glLineWidth(line_width * 3);
+			gl::countDrawCall();
+			glDrawArrays(GL_LINES, moving_overlay_, moving_points_ - moving_overlay_);
 		}
-	}
-	glEnd();
-}
 
-// -----------------------------------------------------------------------------
-// Renders the moving overlay for sector indices in [sectors], to show movement
-// by [move_vec]
-// -----------------------------------------------------------------------------
-void MapRenderer2D::renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec) const
-{
-	// Determine what lines are being moved
-	vector<uint8_t> lines_moved(map_->nLines(), 0);
-	for (auto item : sectors)
-	{
-		if (auto sector = item.asSector(*map_))
+		// Vertex overlays
+		if (moving_verts_.size() > moving_points_)
 		{
-			// Go through connected sides
-			auto& sides = sector->connectedSides();
-			for (auto& side : sides)
-				lines_moved[side->parentLine()->index()] = 1; // Mark parent line as moved
+			bool point = setupVertexRendering(1.5f);
+			gl::countDrawCall();
+			glDrawArrays(GL_POINTS, moving_points_, moving_verts_.size() - moving_points_);
+			if (point)
+			{
+				glDisable(GL_POINT_SPRITE);
+				glDisable(GL_TEXTURE_2D);
+			}
 		}
-	}
 
-	// Build list of moving lines
-	vector<mapeditor::Item> lines;
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		if (lines_moved[a] > 0)
-			lines.emplace_back((int)a, mapeditor::ItemType::Line);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glPopMatrix();
 	}
 
-	// Draw moving lines
-	renderMovingLines(lines, move_vec);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
 }
 
 // -----------------------------------------------------------------------------
@@ -2683,6 +2953,10 @@ void MapRenderer2D::renderMovingSectors(const vector<mapeditor::Item>& sectors,
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Vec2d move_vec)
 {
+	// Draw things at their current positions, translated by [move_vec]
+	glPushMatrix();
+	glTranslated(move_vec.x, move_vec.y, 0);
+
 	// Enable textures
 	glEnable(GL_TEXTURE_2D);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
@@ -2698,12 +2972,12 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 			continue;
 
 		// Get thing info
-		x     = thing->xPos() + move_vec.x;
-		y     = thing->yPos() + move_vec.y;
+		x     = thing->xPos();
+		y     = thing->yPos();
 		angle = thing->angle();
 
 		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(thing->type());
+		auto& tt = thing->typeInfo();
 
 		// Draw thing depending on 'things_drawtype' cvar
 		if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
@@ -2732,9 +3006,9 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 			if ((thing = item.asThing(*map_)))
 			{
 				// Get thing info
-				auto& tt = game::configuration().thingType(thing->type());
-				x        = thing->xPos() + move_vec.x;
-				y        = thing->yPos() + move_vec.y;
+				auto& tt = thing->typeInfo();
+				x        = thing->xPos();
+				y        = thing->yPos();
 				angle    = thing->angle();
 
 				renderSpriteThing(x, y, angle, tt, thing->args(), item.index, 1.0f, true);
@@ -2753,7 +3027,7 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 		if (!thing)
 			continue;
 
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = thing->typeInfo();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -2762,7 +3036,7 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 		if (!thing_overlay_square)
 			radius += 8;
 
-		renderThingOverlay(thing->xPos() + move_vec.x, thing->yPos() + move_vec.y, radius, point);
+		renderThingOverlay(thing->xPos(), thing->yPos(), radius, point);
 	}
 
 	// Clean up gl state
@@ -2771,6 +3045,8 @@ void MapRenderer2D::renderMovingThings(const vector<mapeditor::Item>& things, Ve
 		glDisable(GL_POINT_SPRITE);
 		glDisable(GL_TEXTURE_2D);
 	}
+
+	glPopMatrix();
 }
 
 // -----------------------------------------------------------------------------
@@ -2793,7 +3069,7 @@ void MapRenderer2D::renderPasteThings(vector<MapThing*>& things, Vec2d pos)
 		angle = thing->angle();
 
 		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(thing->type());
+		auto& tt = thing->typeInfo();
 
 		// Draw thing depending on 'things_drawtype' cvar
 		if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
@@ -2820,7 +3096,7 @@ void MapRenderer2D::renderPasteThings(vector<MapThing*>& things, Vec2d pos)
 		for (auto thing : things)
 		{
 			// Get thing info
-			auto& tt = game::configuration().thingType(thing->type());
+			auto& tt = thing->typeInfo();
 			x        = thing->xPos() + pos.x;
 			y        = thing->yPos() + pos.y;
 			angle    = thing->angle();
@@ -2836,7 +3112,7 @@ void MapRenderer2D::renderPasteThings(vector<MapThing*>& things, Vec2d pos)
 	bool point = setupThingOverlay();
 	for (auto thing : things)
 	{
-		auto&  tt     = game::configuration().thingType(thing->type());
+		auto&  tt     = thing->typeInfo();
 		double radius = tt.radius();
 		if (tt.shrinkOnZoom())
 			radius = scaledRadius(radius);
@@ -2861,66 +3137,91 @@ void MapRenderer2D::renderPasteThings(vector<MapThing*>& things, Vec2d pos)
 // -----------------------------------------------------------------------------
 void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 {
-	// Simple test
-	vector<Vec2d> vertex_points;
-	group->putVerticesToDraw(vertex_points);
-	vector<ObjectEditGroup::Line> lines;
-	group->putLinesToDraw(lines);
-
-	// Set 'drawing' colour
-	colourconfig::setGLColour("map_linedraw");
-
-	// --- Lines ---
-
-	// Lines
-	glBegin(GL_LINES);
-	glLineWidth(line_width);
-	for (auto& line : lines)
+	const auto& positions = group->vertexPositions();
+	const auto& lines     = group->lines();
+
+	// Build vertices for the lines (in their own colours), the edit overlay
+	// lines and the edited vertices, to draw from one buffer
+	auto col_edit = colourconfig::colour("map_object_edit");
+	object_edit_verts_.clear();
+	auto add_vert = [this](const Vec2d& pos, const ColRGBA& col)
+	{ object_edit_verts_.push_back({ (float)pos.x, (float)pos.y, col.fr(), col.fg(), col.fb(), col.fa() }); };
+	for (const auto& line : lines)
 	{
-		gl::setColour(lineColour(line.map_line, true));
-		glVertex2d(line.v1->position.x, line.v1->position.y);
-		glVertex2d(line.v2->position.x, line.v2->position.y);
+		auto col = lineColour(line.map_line, true);
+		add_vert(positions[line.v1], col);
+		add_vert(positions[line.v2], col);
 	}
-	glEnd();
-
-	// Edit overlay
-	colourconfig::setGLColour("map_object_edit");
-	glLineWidth(line_width * 3);
-	glBegin(GL_LINES);
-	for (auto& line : lines)
+	unsigned n_overlay_start = object_edit_verts_.size();
+	for (const auto& line : lines)
 	{
-		if (line.isExtra())
+		if (line.extra)
 			continue;
 
-		glVertex2d(line.v1->position.x, line.v1->position.y);
-		glVertex2d(line.v2->position.x, line.v2->position.y);
+		add_vert(positions[line.v1], col_edit);
+		add_vert(positions[line.v2], col_edit);
 	}
-	glEnd();
+	unsigned n_points_start = object_edit_verts_.size();
+	for (unsigned a = 0; a < group->nEditVertices(); ++a)
+		add_vert(positions[a], col_edit);
 
-	// --- Vertices ---
+	if (!object_edit_verts_.empty())
+	{
+		// Upload to the VBO if supported (otherwise draw from memory)
+		auto base  = reinterpret_cast<const char*>(object_edit_verts_.data());
+		auto bytes = object_edit_verts_.size() * sizeof(GLVert);
+		if (gl::vboSupport())
+		{
+			if (vbo_object_edit_ == 0)
+				glGenBuffers(1, &vbo_object_edit_);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_object_edit_);
+			glBufferData(GL_ARRAY_BUFFER, bytes, base, GL_STREAM_DRAW);
+			gl::countUpload(bytes);
+			base = nullptr;
+		}
 
-	// Setup rendering properties
-	bool point = setupVertexRendering(1.0f);
-	gl::setColour(colourconfig::colour("map_object_edit"));
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glVertexPointer(2, GL_FLOAT, sizeof(GLVert), base);
+		glColorPointer(4, GL_FLOAT, sizeof(GLVert), base + offsetof(GLVert, r));
 
-	// Render vertices
-	glBegin(GL_POINTS);
-	for (auto& vertex_point : vertex_points)
-		glVertex2d(vertex_point.x, vertex_point.y);
-	glEnd();
+		// --- Lines ---
 
-	// Clean up
-	if (point)
-	{
-		glDisable(GL_POINT_SPRITE);
-		glDisable(GL_TEXTURE_2D);
+		// Lines
+		glLineWidth(line_width);
+		gl::countDrawCall();
+		glDrawArrays(GL_LINES, 0, n_overlay_start);
+
+		// Edit overlay
+		glLineWidth(line_width * 3);
+		gl::countDrawCall();
+		glDrawArrays(GL_LINES, n_overlay_start, n_points_start - n_overlay_start);
+
+		// --- Vertices ---
+
+		// Setup rendering properties
+		bool point = setupVertexRendering(1.0f);
+
+		// Render vertices
+		gl::countDrawCall();
+		glDrawArrays(GL_POINTS, n_points_start, object_edit_verts_.size() - n_points_start);
+
+		// Clean up
+		if (point)
+		{
+			glDisable(GL_POINT_SPRITE);
+			glDisable(GL_TEXTURE_2D);
+		}
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	// --- Things ---
 
 	// Get things to draw
-	vector<ObjectEditGroup::Thing> things;
-	group->putThingsToDraw(things);
+	const auto& things = group->things();
 
 	if (!things.empty())
 	{
@@ -2941,7 +3242,7 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 			angle = thing->angle();
 
 			// Get thing type properties from game configuration
-			auto& tt = game::configuration().thingType(thing->type());
+			auto& tt = thing->typeInfo();
 
 			// Draw thing depending on 'things_drawtype' cvar
 			if (thing_drawtype == ThingDrawType::Sprite) // Drawtype 2: Sprites
@@ -2969,7 +3270,7 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 			{
 				// Get thing info
 				thing    = item.map_thing;
-				auto& tt = game::configuration().thingType(thing->type());
+				auto& tt = thing->typeInfo();
 				x        = item.position.x;
 				y        = item.position.y;
 				angle    = thing->angle();
@@ -2986,7 +3287,7 @@ void MapRenderer2D::renderObjectEditGroup(ObjectEditGroup* group)
 		for (auto& item : things)
 		{
 			thing         = item.map_thing;
-			auto&  tt     = game::configuration().thingType(thing->type());
+			auto&  tt     = thing->typeInfo();
 			double radius = tt.radius();
 			if (tt.shrinkOnZoom())
 				radius = scaledRadius(radius);
@@ -3020,13 +3321,16 @@ void MapRenderer2D::updateVerticesVBO()
 	int             nfloats = map_->nVertices() * 2;
 	vector<GLfloat> verts(nfloats);
 	unsigned        i = 0;
+	vertex_slots_.resize(map_->nVertices());
 	for (unsigned a = 0; a < map_->nVertices(); a++)
 	{
-		verts[i++] = map_->vertex(a)->xPos();
-		verts[i++] = map_->vertex(a)->yPos();
+		verts[i++]       = map_->vertex(a)->xPos();
+		verts[i++]       = map_->vertex(a)->yPos();
+		vertex_slots_[a] = map_->vertex(a);
 	}
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * nfloats, verts.data(), GL_STATIC_DRAW);
+	gl::countUpload(sizeof(GLfloat) * nfloats);
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -3054,57 +3358,570 @@ void MapRenderer2D::updateLinesVBO(bool show_direction, float base_alpha)
 	// Fill lines VBO
 	int            nverts = map_->nLines() * vpl;
 	vector<GLVert> lines(nverts);
-	unsigned       v = 0;
-	ColRGBA        col;
-	float          alpha;
+	line_slots_.resize(map_->nLines());
 	for (unsigned a = 0; a < map_->nLines(); a++)
 	{
-		auto line = map_->line(a);
+		auto line      = map_->line(a);
+		line_slots_[a] = { line, line->s1() != nullptr, line->s2() != nullptr };
+		writeLineVerts(line, show_direction, base_alpha, &lines[a * vpl]);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
+	gl::countUpload(sizeof(GLVert) * nverts);
 
-		// Get line colour
-		col   = lineColour(line);
-		alpha = base_alpha * col.fa();
-
-		// Set line vertices
-		lines[v].x     = line->v1()->xPos();
-		lines[v].y     = line->v1()->yPos();
-		lines[v + 1].x = line->v2()->xPos();
-		lines[v + 1].y = line->v2()->yPos();
-
-		// Set line colour(s)
-		lines[v].r = lines[v + 1].r = col.fr();
-		lines[v].g = lines[v + 1].g = col.fg();
-		lines[v].b = lines[v + 1].b = col.fb();
-		lines[v].a = lines[v + 1].a = alpha;
-
-		// Direction tab if needed
-		if (show_direction)
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	n_lines_       = map_->nLines();
+	lines_alpha_   = base_alpha;
+	lines_updated_ = app::runTimer();
+}
+
+// -----------------------------------------------------------------------------
+// Writes the VBO vertices for [line] to [verts] (2, or 4 if [show_direction]
+// is true)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::writeLineVerts(MapLine* line, bool show_direction, float base_alpha, GLVert* verts) const
+{
+	// Get line colour
+	auto  col   = lineColour(line);
+	float alpha = base_alpha * col.fa();
+
+	// Set line vertices
+	verts[0].x = line->v1()->xPos();
+	verts[0].y = line->v1()->yPos();
+	verts[1].x = line->v2()->xPos();
+	verts[1].y = line->v2()->yPos();
+
+	// Set line colour(s)
+	verts[0].r = verts[1].r = col.fr();
+	verts[0].g = verts[1].g = col.fg();
+	verts[0].b = verts[1].b = col.fb();
+	verts[0].a = verts[1].a = alpha;
+
+	// Direction tab if needed
+	if (show_direction)
+	{
+		auto mid   = line->getPoint(MapObject::Point::Mid);
+		auto tab   = line->dirTabPoint();
+		verts[2].x = mid.x;
+		verts[2].y = mid.y;
+		verts[3].x = tab.x;
+		verts[3].y = tab.y;
+
+		// Colours
+		verts[2].r = verts[3].r = col.fr();
+		verts[2].g = verts[3].g = col.fg();
+		verts[2].b = verts[3].b = col.fb();
+		verts[2].a = verts[3].a = alpha * 0.6f;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the map things VBO, with [alpha] applied to all things.
+// The quads for all things are sorted by render pass (shadows, icons, sprites
+// within squares, direction arrows) and texture, so that each texture only
+// needs to be bound once per pass.
+// Returns false if any thing texture doesn't exist
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::updateThingsVBO(float alpha)
+{
+	log::info(3, "Updating things VBO");
+
+	auto& tm         = mapeditor::textureManager();
+	bool  sprites    = thing_drawtype == ThingDrawType::Sprite;
+	bool  squares    = !sprites && thing_drawtype != ThingDrawType::Round;
+	bool  shadows    = thing_shadow > 0.01f;
+	auto  tex_shadow = tm.editorImage(squares ? "thing/square/shadow" : "thing/shadow").gl_id;
+	auto  tex_arrow  = tm.editorImage("arrow").gl_id;
+
+	// Sprite textures of things modified since this are reset
+	auto last_update = thing_sprites_updated_;
+
+	vector<ThingQuad> quads;
+	quads.reserve(map_->nThings() * 2);
+
+	// Adds a round thing quad, as renderRoundThing would draw it
+	auto add_round = [&](ThingPass pass, const MapThing* thing, const game::ThingType& tt, float talpha, double mult) {
+		bool rotate;
+		auto tex = roundThingTexture(tt, thing->angle(), rotate);
+		if (!tex)
+			return false;
+
+		double radius = tt.radius() * mult;
+		if (tt.shrinkOnZoom())
+			radius = scaledRadius(radius);
+		addThingQuad(
+			quads,
+			pass,
+			tex,
+			thing->position(),
+			-radius,
+			-radius,
+			radius,
+			radius,
+			thingColour(tt, thing->args()),
+			talpha,
+			rotate ? thing->angle() : 0.);
+		return true;
+	};
+
+	things_filtered_.resize(map_->nThings());
+	for (unsigned a = 0; a < map_->nThings(); a++)
+	{
+		auto  thing  = map_->thing(a);
+		auto& tt     = thing->typeInfo();
+		auto  pos    = thing->position();
+		float talpha = thing->isFiltered() ? alpha * 0.25f : alpha;
+		bool  arrow  = false;
+
+		things_filtered_[a] = thing->isFiltered();
+
+		// Reset thing sprite if modified
+		if (thing->modifiedTime() > last_update && thing_sprites_.size() > a)
+			thing_sprites_[a] = 0;
+
+		// Shadow (sprite shadows are added with the sprite)
+		if (shadows && !sprites && tex_shadow && !thing->isFiltered())
+		{
+			double radius = tt.radius() + 1;
+			if (tt.shrinkOnZoom())
+				radius = scaledRadius(radius);
+			radius *= 1.3;
+			addThingQuad(
+				quads,
+				ThingPass::Shadow,
+				tex_shadow,
+				pos,
+				-radius,
+				-radius,
+				radius,
+				radius,
+				ColRGBA::BLACK,
+				alpha * thing_shadow);
+		}
+
+		if (sprites)
+		{
+			// Sprite, or round thing if the sprite isn't found
+			auto tex = spriteTexture(a, tt);
+			if (!tex)
+			{
+				if (!add_round(ThingPass::Icon, thing, tt, talpha, 1.0))
+					return false;
+			}
+			else
+			{
+				auto&  tex_info = gl::Texture::info(tex);
+				double hw       = tex_info.size.x * 0.5;
+				double hh       = tex_info.size.y * 0.5;
+
+				if (shadows && talpha >= 0.9f)
+				{
+					double sz     = std::max(std::min(hw, hh) * 0.1, 1.0);
+					float  salpha = talpha * (thing_shadow * 0.7f);
+					addThingQuad(
+						quads,
+						ThingPass::Shadow,
+						tex,
+						pos,
+						-hw - sz,
+						-hh - sz,
+						hw + sz,
+						hh + sz,
+						ColRGBA::BLACK,
+						salpha);
+					addThingQuad(
+						quads,
+						ThingPass::Shadow,
+						tex,
+						pos,
+						-hw - sz,
+						-hh - sz - sz,
+						hw + sz + sz,
+						hh + sz,
+						ColRGBA::BLACK,
+						salpha);
+				}
+
+				addThingQuad(quads, ThingPass::Icon, tex, pos, -hw, -hh, hw, hh, ColRGBA::WHITE, talpha);
+				arrow = tt.angled() || thing_force_dir || things_angles_;
+			}
+		}
+		else if (!squares)
+		{
+			// Round
+			if (!add_round(ThingPass::Icon, thing, tt, talpha, 1.0))
+				return false;
+		}
+		else
+		{
+			// Square
+			bool showicon = thing_drawtype < ThingDrawType::SquareSprite || tt.sprite().empty();
+			bool framed   = thing_drawtype == ThingDrawType::FramedSprite;
+			int  tc_start;
+			auto tex = squareThingTexture(tt, thing->angle(), showicon, framed, tc_start);
+			if (!tex)
+				return false;
+
+			double radius = tt.radius();
+			if (tt.shrinkOnZoom())
+				radius = scaledRadius(radius);
+			addThingQuad(
+				quads,
+				ThingPass::Icon,
+				tex,
+				pos,
+				-radius,
+				-radius,
+				radius,
+				radius,
+				thingColour(tt, thing->args()),
+				talpha,
+				0.,
+				tc_start);
+			arrow = (tt.angled() || thing_force_dir || things_angles_) && !showicon;
+
+			// Sprite within the square if that drawtype is set
+			if (thing_drawtype > ThingDrawType::Sprite
+				&& !(thing_drawtype == ThingDrawType::SquareSprite && tt.sprite().empty()))
+			{
+				auto sprite = spriteTexture(a, tt);
+				if (!sprite)
+				{
+					if (!add_round(ThingPass::FittedSprite, thing, tt, talpha, framed ? 0.7 : 1.0))
+						return false;
+				}
+				else
+				{
+					auto&  tex_info = gl::Texture::info(sprite);
+					double hw       = tex_info.size.x * 0.5;
+					double hh       = tex_info.size.y * 0.5;
+					double scale    = ((double)tt.radius() * 0.8) / std::max(hw, hh);
+					hw *= scale;
+					hh *= scale;
+					addThingQuad(quads, ThingPass::FittedSprite, sprite, pos, -hw, -hh, hw, hh, ColRGBA::WHITE, talpha);
+				}
+			}
+		}
+
+		// Direction arrow
+		if (arrow && tex_arrow)
+		{
+			auto acol = ColRGBA::WHITE;
+			if (arrow_colour && tt.defined())
+				acol = tt.colour();
+			addThingQuad(
+				quads,
+				ThingPass::Arrow,
+				tex_arrow,
+				pos,
+				-32,
+				-32,
+				32,
+				32,
+				acol,
+				alpha * arrow_alpha,
+				thing->angle());
+		}
+	}
+
+	// Sort quads by pass then texture, keeping thing order within each
+	std::stable_sort(
+		quads.begin(),
+		quads.end(),
+		[](const ThingQuad& l, const ThingQuad& r) {
+			return l.pass < r.pass || (l.pass == r.pass && l.texture < r.texture);
+		});
+
+	// Build vertex data and texture batches
+	vector<GLThingVert> verts(quads.size() * 4);
+	thing_batches_.clear();
+	for (unsigned a = 0; a < quads.size(); a++)
+	{
+		memcpy(&verts[a * 4], quads[a].verts, sizeof(quads[a].verts));
+
+		if (thing_batches_.empty() || thing_batches_.back().texture != quads[a].texture)
+			thing_batches_.push_back({ quads[a].texture, a * 4, 0 });
+		thing_batches_.back().count += 4;
+	}
+
+	// Create VBO if needed
+	if (vbo_things_ == 0)
+		glGenBuffers(1, &vbo_things_);
+
+	// Fill things VBO
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_things_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLThingVert) * verts.size(), verts.data(), GL_DYNAMIC_DRAW);
+	gl::countUpload(sizeof(GLThingVert) * verts.size());
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	n_things_       = map_->nThings();
+	things_updated_ = app::runTimer();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the LOD lines VBO for LOD [level], with [base_alpha] applied to
+// all lines. Line vertices are snapped to a grid of 2^[level] map unit cells,
+// lines within a single cell are dropped and lines that end up between the
+// same cells are merged (taking the colour of the first)
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateLinesLOD(int level, float base_alpha)
+{
+	log::info(3, "Updating LOD lines VBO (level {})", level);
+
+	// Create VBO if needed
+	if (vbo_lines_lod_ == 0)
+		glGenBuffers(1, &vbo_lines_lod_);
+
+	// Snap lines to the grid
+	double          cell = std::ldexp(1.0, level);
+	vector<LODItem> items;
+	items.reserve(map_->nLines());
+	for (unsigned a = 0; a < map_->nLines(); a++)
+	{
+		auto    line = map_->line(a);
+		LODItem item{ lodCell(line->x1(), cell), lodCell(line->y1(), cell), lodCell(line->x2(), cell),
+					  lodCell(line->y2(), cell), a };
+
+		if (item.x1 == item.x2 && item.y1 == item.y2)
+			continue;
+
+		// Same cells in either direction should merge
+		if (std::tie(item.x2, item.y2) < std::tie(item.x1, item.y1))
 		{
-			auto mid       = line->getPoint(MapObject::Point::Mid);
-			auto tab       = line->dirTabPoint();
-			lines[v + 2].x = mid.x;
-			lines[v + 2].y = mid.y;
-			lines[v + 3].x = tab.x;
-			lines[v + 3].y = tab.y;
+			std::swap(item.x1, item.x2);
+			std::swap(item.y1, item.y2);
+		}
 
-			// Colours
-			lines[v + 2].r = lines[v + 3].r = col.fr();
-			lines[v + 2].g = lines[v + 3].g = col.fg();
-			lines[v + 2].b = lines[v + 3].b = col.fb();
-			lines[v + 2].a = lines[v + 3].a = alpha * 0.6f;
+		items.push_back(item);
+	}
+
+	// Merge lines between the same cells
+	std::sort(items.begin(), items.end());
+	auto same_cells = [](const LODItem& a, const LODItem& b) { return a.sameCells(b); };
+	items.erase(std::unique(items.begin(), items.end(), same_cells), items.end());
+
+	// Fill LOD lines VBO
+	vector<GLVert> verts(items.size() * 2);
+	for (unsigned a = 0; a < items.size(); a++)
+	{
+		auto  col   = lineColour(map_->line(items[a].index));
+		float alpha = base_alpha * col.fa();
+
+		auto& item = items[a];
+		verts[a * 2]     = { lodCentre(item.x1, cell), lodCentre(item.y1, cell), col.fr(), col.fg(), col.fb(), alpha };
+		verts[a * 2 + 1] = { lodCentre(item.x2, cell), lodCentre(item.y2, cell), col.fr(), col.fg(), col.fb(), alpha };
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_lod_);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * verts.size(), verts.data(), GL_STATIC_DRAW);
+	gl::countUpload(sizeof(GLVert) * verts.size());
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	lod_lines_ = { level, base_alpha, app::runTimer(), static_cast<unsigned>(map_->nLines()), verts.size() };
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the LOD thing points for LOD [level], with [alpha] applied.
+// Things are grouped by the 2^[level] map unit grid cell they are in, with one
+// point per cell in the colour of its first thing, more opaque the more things
+// are in the cell
+// -----------------------------------------------------------------------------
+void MapRenderer2D::updateThingsLOD(int level, float alpha)
+{
+	// Snap things to the grid
+	double          cell = std::ldexp(1.0, level);
+	vector<LODItem> items(map_->nThings());
+	for (unsigned a = 0; a < map_->nThings(); a++)
+	{
+		auto thing = map_->thing(a);
+		items[a]   = { lodCell(thing->xPos(), cell), lodCell(thing->yPos(), cell), 0, 0, a };
+	}
+	std::sort(items.begin(), items.end());
+
+	// Add a point for each cell
+	lod_thing_points_.clear();
+	for (unsigned a = 0; a < items.size();)
+	{
+		// Count things in the cell
+		unsigned count = 1;
+		while (a + count < items.size() && items[a + count].sameCells(items[a]))
+			++count;
+
+		auto  thing      = map_->thing(items[a].index);
+		auto  col        = thingColour(thing->typeInfo(), thing->args());
+		float cell_alpha = alpha * col.fa() * std::min(1.0f, 0.4f + 0.15f * (count - 1));
+		lod_thing_points_.push_back(
+			{ lodCentre(items[a].x1, cell), lodCentre(items[a].y1, cell), col.fr(), col.fg(), col.fb(), cell_alpha });
+
+		a += count;
+	}
+
+	lod_things_ = { level, alpha, app::runTimer(), static_cast<unsigned>(map_->nThings()), lod_thing_points_.size() };
+}
+
+// -----------------------------------------------------------------------------
+// Updates the slots of vertices in the vertices VBO that have been modified
+// (or replaced) since it was last updated.
+// Returns false if the whole VBO needs to be rebuilt instead (the number of
+// vertices has changed, or most of them were modified)
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::updateModifiedVertices()
+{
+	auto count = map_->nVertices();
+	if (vbo_vertices_ == 0 || count != n_vertices_ || vertex_slots_.size() != count)
+		return false;
+
+	// Find modified vertices
+	vector<uint8_t> dirty(count);
+	unsigned        n_dirty = 0;
+	for (unsigned a = 0; a < count; a++)
+	{
+		auto vertex = map_->vertex(a);
+		if (vertex != vertex_slots_[a] || vertex->modifiedTime() >= vertices_updated_)
+		{
+			dirty[a]         = 1;
+			vertex_slots_[a] = vertex;
+			++n_dirty;
 		}
+	}
+	if (n_dirty > count / 4)
+		return false;
+
+	// Upload each run of modified vertices
+	vector<GLfloat> verts;
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_vertices_);
+	forEachDirtyRun(
+		dirty,
+		[&](unsigned first, unsigned n) {
+			verts.resize(n * 2);
+			for (unsigned a = 0; a < n; a++)
+			{
+				verts[a * 2]     = map_->vertex(first + a)->xPos();
+				verts[a * 2 + 1] = map_->vertex(first + a)->yPos();
+			}
+			glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 2 * first, sizeof(GLfloat) * n * 2, verts.data());
+			gl::countUpload(sizeof(GLfloat) * n * 2);
+		});
+
+	// Clean up
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	vertices_updated_ = app::runTimer();
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the slots of lines in the lines VBO that have been modified (or
+// replaced), or that have had a vertex moved, since it was last updated.
+// Returns false if the whole VBO needs to be rebuilt instead (the number of
+// lines or the VBO layout has changed, or most lines were modified)
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::updateModifiedLines(bool show_direction, float base_alpha)
+{
+	auto count = map_->nLines();
+	if (vbo_lines_ == 0 || count != n_lines_ || show_direction != lines_dirs_ || base_alpha != lines_alpha_
+		|| line_slots_.size() != count)
+		return false;
 
-		// Next line
-		v += vpl;
+	// Find modified lines
+	vector<uint8_t> dirty(count);
+	unsigned        n_dirty = 0;
+	for (unsigned a = 0; a < count; a++)
+	{
+		auto  line = map_->line(a);
+		auto& slot = line_slots_[a];
+		bool  s1   = line->s1() != nullptr;
+		bool  s2   = line->s2() != nullptr;
+		if (line != slot.line || s1 != slot.s1 || s2 != slot.s2 || line->modifiedTime() >= lines_updated_
+			|| line->v1()->modifiedTime() >= lines_updated_ || line->v2()->modifiedTime() >= lines_updated_)
+		{
+			dirty[a] = 1;
+			slot     = { line, s1, s2 };
+			++n_dirty;
+		}
 	}
+	if (n_dirty > count / 4)
+		return false;
+
+	// Upload each run of modified lines
+	unsigned       vpl = show_direction ? 4 : 2;
+	vector<GLVert> verts;
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLVert) * nverts, lines.data(), GL_STATIC_DRAW);
+	forEachDirtyRun(
+		dirty,
+		[&](unsigned first, unsigned n) {
+			verts.resize(n * vpl);
+			for (unsigned a = 0; a < n; a++)
+				writeLineVerts(map_->line(first + a), show_direction, base_alpha, &verts[a * vpl]);
+			glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLVert) * vpl * first, sizeof(GLVert) * n * vpl, verts.data());
+			gl::countUpload(sizeof(GLVert) * n * vpl);
+		});
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	n_lines_       = map_->nLines();
 	lines_updated_ = app::runTimer();
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Rewrites the polygons in the flats VBO that have been rebuilt (or whose
+// sector has been replaced) since it was last updated, in place.
+// Returns false if the whole VBO needs to be rebuilt instead (the number of
+// sectors has changed, or a polygon's size has changed). The layout is kept
+// the same as a full rebuild, since the polygons' VBO offsets are shared with
+// the 3d renderer's flat VBOs. Polygons' VBO update flags are also cleared by
+// the 3d renderer, so sector geometry times are checked as well
+// -----------------------------------------------------------------------------
+bool MapRenderer2D::updateModifiedFlats()
+{
+	auto count = map_->nSectors();
+	if (vbo_flats_ == 0 || flat_slots_.size() != count)
+		return false;
+
+	auto changed = [&](MapSector* sector, const FlatSlot& slot) {
+		return sector->polygon()->vboUpdate() > 1 || sector != slot.sector
+			   || flats_vbo_updated_ < sector->geometryUpdatedTime();
+	};
+
+	// Check all changed polygons are still the same size first
+	bool any = false;
+	for (unsigned a = 0; a < count; a++)
+	{
+		auto sector = map_->sector(a);
+		if (changed(sector, flat_slots_[a]))
+		{
+			if (sector->polygon()->vboDataSize() != flat_slots_[a].size)
+				return false;
+			any = true;
+		}
+	}
+	if (!any)
+		return true;
+
+	// Rewrite polygons
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_flats_);
+	for (unsigned a = 0; a < count; a++)
+	{
+		auto  sector = map_->sector(a);
+		auto& slot   = flat_slots_[a];
+		if (changed(sector, slot))
+		{
+			sector->polygon()->writeToVBO(slot.offset, slot.offset / sizeof(Polygon2D::Vertex));
+			slot.sector = sector;
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	flats_vbo_updated_ = app::runTimer();
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -3121,10 +3938,12 @@ void MapRenderer2D::updateFlatsVBO()
 
 	// Get total size needed
 	unsigned totalsize = 0;
+	flat_slots_.resize(map_->nSectors());
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
-		auto poly = map_->sector(a)->polygon();
-		totalsize += poly->vboDataSize();
+		auto sector    = map_->sector(a);
+		flat_slots_[a] = { sector, totalsize, sector->polygon()->vboDataSize() };
+		totalsize += flat_slots_[a].size;
 	}
 
 	// Allocate buffer data
@@ -3132,19 +3951,17 @@ void MapRenderer2D::updateFlatsVBO()
 	glBufferData(GL_ARRAY_BUFFER, totalsize, nullptr, GL_STATIC_DRAW);
 
 	// Write polygon data to VBO
-	unsigned offset = 0;
-	unsigned index  = 0;
 	for (unsigned a = 0; a < map_->nSectors(); a++)
 	{
-		auto poly = map_->sector(a)->polygon();
-		offset    = poly->writeToVBO(offset, index);
-		index += poly->totalVertices();
+		auto& slot = flat_slots_[a];
+		slot.sector->polygon()->writeToVBO(slot.offset, slot.offset / sizeof(Polygon2D::Vertex));
 	}
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	flats_updated_ = app::runTimer();
+	flats_updated_     = app::runTimer();
+	flats_vbo_updated_ = flats_updated_;
 }
 
 // -----------------------------------------------------------------------------
@@ -3152,60 +3969,64 @@ void MapRenderer2D::updateFlatsVBO()
 // -----------------------------------------------------------------------------
 void MapRenderer2D::updateVisibility(Vec2d view_tl, Vec2d view_br)
 {
+	// Only objects in or near the view (found via the sector/thing grids) are
+	// checked, anything else is marked as outside. The previous candidates are
+	// all that need resetting, unless the number of objects changed
+
 	// Sector visibility
+	BBox view;
+	view.extend(view_tl);
+	view.extend(view_br);
 	if (map_->nSectors() != vis_s_.size())
+		vis_s_.assign(map_->nSectors(), VIS_OUTSIDE);
+	else
+		for (auto index : vis_s_near_)
+			vis_s_[index] = VIS_OUTSIDE;
+	vis_s_near_.clear();
+	map_->sectors().putIndicesInBox(view, vis_s_near_);
+	for (auto index : vis_s_near_)
 	{
-		// Number of sectors changed, reset array
-		vis_s_.clear();
-		for (unsigned a = 0; a < map_->nSectors(); a++)
-			vis_s_.push_back(0);
-	}
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
-		// Check against sector bounding box
-		auto bbox = map_->sector(a)->boundingBox();
-		vis_s_[a] = 0;
-		if (bbox.max.x < view_tl.x)
-			vis_s_[a] = VIS_LEFT;
-		if (bbox.max.y < view_tl.y)
-			vis_s_[a] = VIS_ABOVE;
-		if (bbox.min.x > view_br.x)
-			vis_s_[a] = VIS_RIGHT;
-		if (bbox.min.y > view_br.y)
-			vis_s_[a] = VIS_BELOW;
-
 		// Check if the sector is worth drawing
+		auto bbox     = map_->sector(index)->boundingBox();
+		vis_s_[index] = 0;
 		if ((bbox.max.x - bbox.min.x) * view_scale_ < 4 || (bbox.max.y - bbox.min.y) * view_scale_ < 4)
-			vis_s_[a] = VIS_SMALL;
+			vis_s_[index] = VIS_SMALL;
 	}
 
 	// Thing visibility
+	// (things are found by position, so the view is expanded by the largest
+	// thing radius)
+	double max_radius = game::ThingType::unknown().radius();
+	for (auto& type : game::configuration().allThingTypes())
+		max_radius = std::max<double>(max_radius, type.second.radius());
+	max_radius *= 1.3;
+	view.extend(view_tl.x - max_radius, view_tl.y - max_radius);
+	view.extend(view_br.x + max_radius, view_br.y + max_radius);
 	if (map_->nThings() != vis_t_.size())
+		vis_t_.assign(map_->nThings(), VIS_OUTSIDE);
+	else
+		for (auto index : vis_t_near_)
+			vis_t_[index] = VIS_OUTSIDE;
+	vis_t_near_.clear();
+	map_->things().putIndicesInBox(view, vis_t_near_);
+	for (auto index : vis_t_near_)
 	{
-		// Number of things changed, reset array
-		vis_t_.clear();
-		for (unsigned a = 0; a < map_->nThings(); a++)
-			vis_t_.push_back(0);
-	}
-	double x, y;
-	double radius;
-	for (unsigned a = 0; a < vis_t_.size(); a++)
-	{
-		vis_t_[a] = 0;
-		x         = map_->thing(a)->xPos();
-		y         = map_->thing(a)->yPos();
+		auto thing = map_->thing(index);
+		auto x     = thing->xPos();
+		auto y     = thing->yPos();
 
 		// Get thing type properties from game configuration
-		auto& tt = game::configuration().thingType(map_->thing(a)->type());
-		radius   = tt.radius() * 1.3;
+		auto&  tt     = thing->typeInfo();
+		double radius = tt.radius() * 1.3;
 
 		// Ignore if outside of screen
+		vis_t_[index] = 0;
 		if (x + radius < view_tl.x || x - radius > view_br.x || y + radius < view_tl.y || y - radius > view_br.y)
-			vis_t_[a] = 1;
+			vis_t_[index] = VIS_OUTSIDE;
 
 		// Check if the thing is worth drawing
 		else if (radius * view_scale_ < 2)
-			vis_t_[a] = VIS_SMALL;
+			vis_t_[index] = VIS_SMALL;
 	}
 }
 
@@ -3217,8 +4038,11 @@ void MapRenderer2D::forceUpdate(float line_alpha)
 	// Update variables
 	view_scale_inv_ = 1.0 / view_scale_;
 	tex_flats_.clear();
+	tex_flats_array_.clear();
 	thing_sprites_.clear();
-	thing_paths_.clear();
+	things_updated_ = 0;
+	lod_lines_      = {};
+	lod_things_     = {};
 
 	if (gl::vboSupport())
 	{
@@ -3242,6 +4066,19 @@ void MapRenderer2D::forceUpdate(float line_alpha)
 	renderLines(lines_dirs_);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the level of detail to draw the map at for the current view scale.
+// 0 is full detail, otherwise lines and things are simplified to a grid of
+// 2^level map unit cells (at least 2 pixels across), and vertices aren't drawn
+// -----------------------------------------------------------------------------
+int MapRenderer2D::lodLevel() const
+{
+	if (map_lod_scale <= 0.0f || view_scale_ <= 0.0 || view_scale_ >= map_lod_scale)
+		return 0;
+
+	return std::max(1, static_cast<int>(std::ceil(std::log2(2.0 / view_scale_))));
+}
+
 // -----------------------------------------------------------------------------
 // Returns [radius] scaled such that it stays the same size on screen at all
 // zoom levels
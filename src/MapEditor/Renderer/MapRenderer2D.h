@@ -11,6 +11,7 @@ class ItemSelection;
 class MapLine;
 class MapSector;
 class MapThing;
+class MapVertex;
 class ObjectEditGroup;
 class SLADEMap;
 namespace game
@@ -39,6 +40,7 @@ public:
 	void    renderLines(bool show_direction, float alpha = 1.0f);
 	void    renderLinesVBO(bool show_direction, float alpha);
 	void    renderLinesImmediate(bool show_direction, float alpha);
+	void    renderLinesLOD(float alpha);
 	void    renderLineHilight(int index, float fade) const;
 	void    renderLineSelection(const ItemSelection& selection, float fade = 1.0f) const;
 	void    renderTaggedLines(vector<MapLine*>& lines, float fade) const;
@@ -90,6 +92,8 @@ public:
 		bool                     framed   = false) const;
 	void renderThings(float alpha = 1.0f, bool force_dir = false);
 	void renderThingsImmediate(float alpha);
+	bool renderThingsVBO(float alpha);
+	void renderThingsLOD(float alpha);
 	void renderThingHilight(int index, float fade) const;
 	void renderThingSelection(const ItemSelection& selection, float fade = 1.0f) const;
 	void renderTaggedThings(vector<MapThing*>& things, float fade) const;
@@ -97,6 +101,15 @@ public:
 	void renderPathedThings(vector<MapThing*>& things);
 	void renderPointLightPreviews(float alpha, int hilight_index) const;
 
+	unsigned roundThingTexture(const game::ThingType& type, double angle, bool& rotate) const;
+	unsigned spriteTexture(unsigned index, const game::ThingType& type);
+	unsigned squareThingTexture(
+		const game::ThingType& type,
+		double                 angle,
+		bool                   showicon,
+		bool                   framed,
+		int&                   tc_start) const;
+
 	// Flats (sectors)
 	void renderFlats(int type = 0, bool texture = true, float alpha = 1.0f);
 	void renderFlatsImmediate(int type, bool texture, float alpha);
@@ -106,9 +119,8 @@ public:
 	void renderTaggedFlats(vector<MapSector*>& sectors, float fade) const;
 
 	// Moving
-	void renderMovingVertices(const vector<mapeditor::Item>& vertices, Vec2d move_vec) const;
-	void renderMovingLines(const vector<mapeditor::Item>& lines, Vec2d move_vec) const;
-	void renderMovingSectors(const vector<mapeditor::Item>& sectors, Vec2d move_vec) const;
+	void buildMovingPreview(const vector<mapeditor::Item>& items, mapeditor::Mode mode);
+	void renderMoving(Vec2d move_vec);
 	void renderMovingThings(const vector<mapeditor::Item>& things, Vec2d move_vec);
 
 	// Paste
@@ -121,6 +133,12 @@ public:
 	void updateVerticesVBO();
 	void updateLinesVBO(bool show_direction, float base_alpha);
 	void updateFlatsVBO();
+	bool updateThingsVBO(float alpha);
+	bool updateModifiedVertices();
+	bool updateModifiedLines(bool show_direction, float base_alpha);
+	bool updateModifiedFlats();
+	void updateLinesLOD(int level, float base_alpha);
+	void updateThingsLOD(int level, float alpha);
 
 	// Misc
 	void setScale(double scale)
@@ -130,21 +148,29 @@ public:
 	}
 	void   updateVisibility(Vec2d view_tl, Vec2d view_br);
 	void   forceUpdate(float line_alpha = 1.0f);
+	int    lodLevel() const;
 	double scaledRadius(int radius) const;
 	bool   visOK() const;
-	void   clearTextureCache() { tex_flats_.clear(); }
+	void   clearTextureCache()
+	{
+		tex_flats_.clear();
+		tex_flats_array_.clear();
+	}
 
 private:
 	SLADEMap* map_ = nullptr;
 	// unsigned  tex_last_         = 0;
-	long vertices_updated_ = 0;
-	long lines_updated_    = 0;
-	long flats_updated_    = 0;
+	long vertices_updated_  = 0;
+	long lines_updated_     = 0;
+	long flats_updated_     = 0;
+	long things_updated_    = 0;
+	long flats_vbo_updated_ = 0; // Polygons last written to the flats VBO
 
 	// VBOs etc
 	unsigned vbo_vertices_ = 0;
 	unsigned vbo_lines_    = 0;
 	unsigned vbo_flats_    = 0;
+	unsigned vbo_things_   = 0;
 
 	// Display lists
 	unsigned list_vertices_ = 0;
@@ -153,16 +179,19 @@ private:
 	// Visibility
 	enum
 	{
-		VIS_LEFT  = 1,
-		VIS_RIGHT = 2,
-		VIS_ABOVE = 4,
-		VIS_BELOW = 8,
-		VIS_SMALL = 16,
+		VIS_LEFT    = 1,
+		VIS_RIGHT   = 2,
+		VIS_ABOVE   = 4,
+		VIS_BELOW   = 8,
+		VIS_SMALL   = 16,
+		VIS_OUTSIDE = 32,
 	};
-	vector<uint8_t> vis_v_;
-	vector<uint8_t> vis_l_;
-	vector<uint8_t> vis_t_;
-	vector<uint8_t> vis_s_;
+	vector<uint8_t>  vis_v_;
+	vector<uint8_t>  vis_l_;
+	vector<uint8_t>  vis_t_;
+	vector<uint8_t>  vis_s_;
+	vector<unsigned> vis_t_near_; // Indices of things in or near the view (sorted)
+	vector<unsigned> vis_s_near_; // Indices of sectors overlapping the view (sorted)
 
 	// Structs
 	struct GLVert
@@ -175,6 +204,96 @@ private:
 		GLVert v1, v2;   // The line itself
 		GLVert dv1, dv2; // Direction tab
 	};
+	struct ThingBatch
+	{
+		unsigned texture;
+		unsigned first; // First vertex in the things VBO
+		unsigned count;
+	};
+	struct FlatBatch
+	{
+		int      array; // Flat texture array index
+		unsigned layer;
+		ColRGBA  colour;
+		unsigned sector;
+
+		bool sameBatch(const FlatBatch& rhs) const
+		{
+			return array == rhs.array && layer == rhs.layer && colour.equals(rhs.colour);
+		}
+	};
+	struct ThingsVBOState // Render settings the things VBO was built with
+	{
+		int    drawtype     = -1;
+		bool   force_dir    = false;
+		bool   angles       = false;
+		bool   zeth_icons   = false;
+		float  shadow       = 0.f;
+		float  alpha        = 0.f;
+		float  arrow_alpha  = 0.f;
+		bool   arrow_colour = false;
+		double scale        = 1.;
+
+		bool operator==(const ThingsVBOState& other) const
+		{
+			return drawtype == other.drawtype && force_dir == other.force_dir && angles == other.angles
+				   && zeth_icons == other.zeth_icons && shadow == other.shadow && alpha == other.alpha
+				   && arrow_alpha == other.arrow_alpha && arrow_colour == other.arrow_colour && scale == other.scale;
+		}
+	};
+
+	// Objects last written to each VBO slot, to find the slots that need
+	// updating when only some objects have changed
+	struct LineSlot
+	{
+		MapLine* line;
+		bool     s1, s2;
+	};
+	struct FlatSlot
+	{
+		MapSector* sector;
+		unsigned   offset; // In bytes
+		unsigned   size;   // In bytes
+	};
+	vector<MapVertex*> vertex_slots_;
+	vector<LineSlot>   line_slots_;
+	vector<FlatSlot>   flat_slots_;
+	float              lines_alpha_ = 1.0f;
+
+	// Level of detail (see lodLevel)
+	struct LODState // What the LOD lines VBO/thing points were built from
+	{
+		int      level     = 0;
+		float    alpha     = 0.f;
+		long     updated   = 0;
+		unsigned n_objects = 0;
+		size_t   count     = 0; // Number of vertices/points built
+
+		bool matches(int level, float alpha, size_t n_objects) const
+		{
+			return level == this->level && alpha == this->alpha && n_objects == this->n_objects;
+		}
+	};
+	unsigned       vbo_lines_lod_ = 0;
+	LODState       lod_lines_;
+	LODState       lod_things_;
+	vector<GLVert> lod_thing_points_;
+
+	// Moving objects preview (see buildMovingPreview). Geometry that moves
+	// entirely is drawn translated by the move offset, lines with only one
+	// moving vertex are offset per-frame from their original positions
+	unsigned        vbo_moving_ = 0;
+	vector<GLVert>  moving_verts_;       // Lines, overlay lines, then vertices
+	unsigned        moving_overlay_ = 0; // First overlay line vertex
+	unsigned        moving_points_  = 0; // First vertex point
+	vector<GLVert>  moving_partial_;     // Lines with one moving vertex
+	vector<uint8_t> moving_partial_flags_;
+	vector<GLVert>  moving_partial_draw_;
+
+	// Object edit preview (lines, edit overlay lines then vertices), rebuilt
+	// each frame
+	unsigned       vbo_object_edit_ = 0;
+	vector<GLVert> object_edit_verts_;
 
 	// Other
 	bool     lines_dirs_     = false;
@@ -190,21 +309,15 @@ private:
 	vector<unsigned> thing_sprites_;
 	long             thing_sprites_updated_ = 0;
 
-	// Thing paths
-	enum class PathType
-	{
-		Normal,
-		NormalBoth,
-		Dragon,
-		DragonBoth
-	};
-	struct ThingPath
-	{
-		unsigned from_index;
-		unsigned to_index;
-		PathType type;
-	};
-	vector<ThingPath> thing_paths_;
-	long              thing_paths_updated_ = 0;
+	// Flat texture arrays
+	vector<std::pair<int, unsigned>> tex_flats_array_; // Texture array and layer of each flat (-1 if none)
+	vector<FlatBatch>                flat_batches_;
+
+	// Things VBO
+	vector<ThingBatch> thing_batches_;
+	vector<uint8_t>    things_filtered_;
+	ThingsVBOState     things_vbo_state_;
+
+	void writeLineVerts(MapLine* line, bool show_direction, float base_alpha, GLVert* verts) const;
 };
 } // namespace slade
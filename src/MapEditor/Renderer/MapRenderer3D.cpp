@@ -41,9 +41,11 @@
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapTextureManager.h"
 #include "OpenGL/OpenGL.h"
+#include "OpenGL/Shader.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Controls/PaletteChooser.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -72,6 +74,10 @@ CVAR(Bool, mlook_invert_y, false, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_x, 1.0f, CVar::Flag::Save)
 CVAR(Float, camera_3d_sensitivity_y, 1.0f, CVar::Flag::Save)
 CVAR(Int, render_fov, 90, CVar::Flag::Save)
+CVAR(Bool, render_3d_portal_vis, true, CVar::Flag::Save)
+CVAR(Bool, walls_use_vbo, true, CVar::Flag::Save)
+CVAR(Int, render_3d_update_ms, 10, CVar::Flag::Save)
+CVAR(Int, render_3d_prefetch_depth, 3, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -83,6 +89,101 @@ EXTERN_CVAR(Bool, flats_use_vbo)
 EXTERN_CVAR(Bool, use_zeth_icons)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if the opening between the front and back sectors of two-sided
+// [line] is closed off (eg. a closed door) along the whole line, so nothing
+// can be seen through it. Openings between two sky ceilings or floors are
+// never closed, since the walls between them aren't drawn
+// -----------------------------------------------------------------------------
+bool openingClosed(MapLine* line)
+{
+	auto  front = line->frontSector();
+	auto  back  = line->backSector();
+	auto& sky   = game::configuration().skyFlat();
+	if (strutil::equalCI(front->ceiling().texture, sky) && strutil::equalCI(back->ceiling().texture, sky))
+		return false;
+	if (strutil::equalCI(front->floor().texture, sky) && strutil::equalCI(back->floor().texture, sky))
+		return false;
+
+	for (auto point : { line->start(), line->end() })
+	{
+		auto floor   = std::max(front->floor().plane.heightAt(point), back->floor().plane.heightAt(point));
+		auto ceiling = std::min(front->ceiling().plane.heightAt(point), back->ceiling().plane.heightAt(point));
+		if (ceiling > floor)
+			return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the render state of [quad] (everything other than its geometry that
+// affects how it is drawn), for sorting quads into batches
+// -----------------------------------------------------------------------------
+auto quadBatchKey(const MapRenderer3D::Quad* quad)
+{
+	int flags = quad->flags & (MapRenderer3D::SKY | MapRenderer3D::MIDTEX | MapRenderer3D::TRANSADD);
+	return std::make_tuple(
+		quad->texture,
+		flags,
+		quad->light,
+		quad->alpha,
+		quad->colour.r,
+		quad->colour.g,
+		quad->colour.b,
+		quad->fogcolour.r,
+		quad->fogcolour.g,
+		quad->fogcolour.b);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the render state of [flat] (everything other than its geometry that
+// affects how it is drawn), for sorting flats into batches
+// -----------------------------------------------------------------------------
+auto flatBatchKey(const MapRenderer3D::Flat* flat)
+{
+	int flags = flat->flags & (MapRenderer3D::CEIL | MapRenderer3D::SKY);
+	return std::make_tuple(
+		flags,
+		flat->texture,
+		flat->light,
+		flat->alpha,
+		flat->colour.r,
+		flat->colour.g,
+		flat->colour.b,
+		flat->colour.a,
+		flat->fogcolour.r,
+		flat->fogcolour.g,
+		flat->fogcolour.b,
+		flat->tex_transform.xx,
+		flat->tex_transform.xy,
+		flat->tex_transform.xo,
+		flat->tex_transform.yx,
+		flat->tex_transform.yy,
+		flat->tex_transform.yo);
+}
+
+// -----------------------------------------------------------------------------
+// Loads [transform] as the OpenGL texture matrix
+// -----------------------------------------------------------------------------
+void loadTexTransform(const Polygon2D::TexTransform& transform)
+{
+	float matrix[16];
+	transform.toMatrix(matrix);
+	glMatrixMode(GL_TEXTURE);
+	glLoadMatrixf(matrix);
+	glMatrixMode(GL_MODELVIEW);
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapRenderer3D Class Functions
@@ -112,8 +213,8 @@ MapRenderer3D::MapRenderer3D(SLADEMap* map) : map_{ map }
 // -----------------------------------------------------------------------------
 MapRenderer3D::~MapRenderer3D()
 {
-	delete quads_;
-	delete flats_;
+	delete[] quads_;
+	delete[] flats_;
 
 	if (vbo_ceilings_ > 0)
 		glDeleteBuffers(1, &vbo_ceilings_);
@@ -121,6 +222,8 @@ MapRenderer3D::~MapRenderer3D()
 		glDeleteBuffers(1, &vbo_floors_);
 	if (vbo_walls_ > 0)
 		glDeleteBuffers(1, &vbo_walls_);
+	if (vbo_sprites_ > 0)
+		glDeleteBuffers(1, &vbo_sprites_);
 }
 
 // -----------------------------------------------------------------------------
@@ -147,6 +250,8 @@ void MapRenderer3D::refresh()
 {
 	// Clear any existing map data
 	dist_sectors_.clear();
+	vis_sectors_.clear();
+	vis_lines_.clear();
 	if (quads_)
 	{
 		delete[] quads_;
@@ -165,6 +270,20 @@ void MapRenderer3D::refresh()
 		glDeleteBuffers(1, &vbo_ceilings_);
 		vbo_floors_ = vbo_ceilings_ = 0;
 	}
+	if (vbo_walls_ != 0)
+	{
+		glDeleteBuffers(1, &vbo_walls_);
+		vbo_walls_ = 0;
+	}
+	if (vbo_sprites_ != 0)
+	{
+		glDeleteBuffers(1, &vbo_sprites_);
+		vbo_sprites_ = 0;
+	}
+	walls_vbo_data_.clear();
+	walls_vbo_capacity_ = 0;
+	for (auto& line : lines_)
+		line.vbo_size = 0;
 
 	floors_.clear();
 	ceilings_.clear();
@@ -218,8 +337,11 @@ void MapRenderer3D::clearData()
 	// Clear map structures
 	lines_.clear();
 	things_.clear();
+	thing_max_halfwidth_ = 0.;
 	floors_.clear();
 	ceilings_.clear();
+	cam_sector_      = nullptr;
+	cam_sector_time_ = -1;
 
 	// Clear everything else
 	refresh();
@@ -412,6 +534,18 @@ void MapRenderer3D::cameraSet(Vec3d position, Vec2d direction)
 	cameraUpdateVectors();
 }
 
+// -----------------------------------------------------------------------------
+// Sets the camera position, direction and pitch to [camera]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::setCamera(const Camera& camera)
+{
+	cam_position_  = camera.position;
+	cam_direction_ = camera.direction;
+	cam_pitch_     = camera.pitch;
+
+	cameraUpdateVectors();
+}
+
 // -----------------------------------------------------------------------------
 // Moves the camera to [position]
 // -----------------------------------------------------------------------------
@@ -426,7 +560,7 @@ void MapRenderer3D::cameraSetPosition(Vec3d position)
 void MapRenderer3D::cameraApplyGravity(double mult)
 {
 	// Get current sector
-	auto sector = map_->sectors().atPos(cam_position_.get2d());
+	auto sector = cameraSector();
 	if (!sector)
 		return;
 
@@ -454,6 +588,60 @@ void MapRenderer3D::cameraApplyGravity(double mult)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns the sector the camera is currently in, or nullptr if it isn't within
+// any sector.
+// The result is kept until the camera moves or the map geometry changes. When
+// the camera moves, the previous sector and its neighbours are checked first,
+// so a full search is only needed on teleporting or leaving the map
+// -----------------------------------------------------------------------------
+MapSector* MapRenderer3D::cameraSector()
+{
+	auto pos = cam_position_.get2d();
+
+	// Check the previous sector still exists
+	auto prev = cam_sector_;
+	if (prev && (cam_sector_index_ >= map_->nSectors() || map_->sector(cam_sector_index_) != prev))
+		prev = nullptr;
+
+	// Nothing changed
+	if (cam_sector_time_ >= 0 && prev == cam_sector_ && pos == cam_sector_pos_
+		&& map_->geometryUpdated() <= cam_sector_time_)
+		return cam_sector_;
+
+	// Check previous sector and its neighbours
+	MapSector* sector = nullptr;
+	if (prev)
+	{
+		if (prev->containsPoint(pos))
+			sector = prev;
+		else
+		{
+			for (auto side : prev->connectedSides())
+			{
+				auto line  = side->parentLine();
+				auto other = side == line->s1() ? line->backSector() : line->frontSector();
+				if (other && other != prev && other->containsPoint(pos))
+				{
+					sector = other;
+					break;
+				}
+			}
+		}
+	}
+
+	// Otherwise search all sectors (via the sector list's spatial index)
+	if (!sector)
+		sector = map_->sectors().atPos(pos);
+
+	cam_sector_       = sector;
+	cam_sector_index_ = sector ? sector->index() : 0;
+	cam_sector_pos_   = pos;
+	cam_sector_time_  = app::runTimer();
+
+	return sector;
+}
+
 // -----------------------------------------------------------------------------
 // Moves the camera direction/pitch based on [xrel],[yrel]
 // -----------------------------------------------------------------------------
@@ -508,6 +696,15 @@ void MapRenderer3D::setupView(int width, int height)
 // level
 // -----------------------------------------------------------------------------
 void MapRenderer3D::setLight(ColRGBA& colour, uint8_t light, float alpha) const
+{
+	auto col = lightColour(colour, light, alpha);
+	glColor4ub(col.r, col.g, col.b, col.a);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [colour] lit by [light], with [alpha] applied (see setLight)
+// -----------------------------------------------------------------------------
+ColRGBA MapRenderer3D::lightColour(const ColRGBA& colour, uint8_t light, float alpha) const
 {
 	// Force 255 light in fullbright mode
 	if (fullbright_)
@@ -521,7 +718,10 @@ void MapRenderer3D::setLight(ColRGBA& colour, uint8_t light, float alpha) const
 	// closer resemble the software renderer light level
 	float mult = (float)light / 255.0f;
 	mult *= (mult * 1.3f);
-	glColor4f(colour.fr() * mult, colour.fg() * mult, colour.fb() * mult, colour.fa() * alpha);
+	return { static_cast<uint8_t>(math::clamp(colour.r * mult, 0, 255)),
+			 static_cast<uint8_t>(math::clamp(colour.g * mult, 0, 255)),
+			 static_cast<uint8_t>(math::clamp(colour.b * mult, 0, 255)),
+			 static_cast<uint8_t>(colour.a * alpha) };
 }
 
 // -----------------------------------------------------------------------------
@@ -565,6 +765,8 @@ void MapRenderer3D::setFog(ColRGBA& fogcol, uint8_t light)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderMap()
 {
+	PROFILE_SCOPE("MapRenderer3D::renderMap");
+
 	// Setup GL stuff
 	glEnable(GL_DEPTH_TEST);
 	glCullFace(GL_BACK);
@@ -573,52 +775,35 @@ void MapRenderer3D::renderMap()
 	glDepthMask(GL_TRUE);
 	glAlphaFunc(GL_GREATER, 0.0f);
 
-	// Init VBO stuff
+	// Update VBOs and map structures if the map has changed
+	updateSharedData();
 	if (gl::vboSupport())
 	{
-		// Check if any polygon vertex data has changed (in this case we need to refresh the entire vbo)
-		bool vbo_updated = false;
-		for (unsigned a = 0; a < map_->nSectors(); a++)
-		{
-			auto poly = map_->sector(a)->polygon();
-			if (poly && poly->vboUpdate() > 1)
-			{
-				updateFlatsVBO();
-				vbo_updated = true;
-				break;
-			}
-		}
-
-		// Create VBO if necessary
-		if (!vbo_updated && vbo_floors_ == 0)
-			updateFlatsVBO();
-
 		glEnableClientState(GL_VERTEX_ARRAY);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	}
 
-	// Create flat arrays if needed
-	if (floors_.size() != map_->nSectors())
-	{
-		floors_.resize(map_->nSectors());
-		ceilings_.resize(map_->nSectors());
-	}
-
-	// Create lines array if empty
-	if (lines_.size() != map_->nLines())
-		lines_.resize(map_->nLines());
-
-	// Create things array if empty
-	if (things_.size() != map_->nThings())
-		things_.resize(map_->nThings());
-
 	// Quick distance vis check
 	sf::Clock clock;
 	quickVisDiscard();
 
-	// Build lists of quads and flats to render
+	// Flats and walls that need (re)building are updated nearest first, within
+	// the render_3d_update_ms time limit each frame
+	if (update_frame_ != frame_)
+	{
+		update_start_    = app::runTimer();
+		updates_pending_ = false;
+		update_frame_    = frame_;
+	}
+
+	// Build lists of quads and flats to render (any textures that aren't
+	// loaded yet are loaded later, and the flats and walls rebuilt then)
+	mapeditor::textureManager().setDeferLoading(true);
 	checkVisibleFlats();
 	checkVisibleQuads();
+	if (!render_view_)
+		prefetch();
+	mapeditor::textureManager().setDeferLoading(false);
 
 	// Render sky
 	if (render_3d_sky)
@@ -639,6 +824,14 @@ void MapRenderer3D::renderMap()
 			glHint(GL_FOG_HINT, GL_FASTEST);
 	}
 
+	// Use the world shader for walls and flats if supported
+	auto world_shader = gl::shader(gl::ShaderType::TexturedFog);
+	if (world_shader)
+	{
+		world_shader->bind();
+		world_shader->setUniform("fog", fog_ ? 1 : 0);
+	}
+
 	// Render walls
 	renderWalls();
 
@@ -646,11 +839,15 @@ void MapRenderer3D::renderMap()
 	renderFlats();
 
 	// Render things
+	gl::Shader::unbind();
 	if (render_3d_things > 0)
 		renderThings();
 
 	// Render transparent stuff
+	if (world_shader)
+		world_shader->bind();
 	renderTransparentWalls();
+	gl::Shader::unbind();
 
 	// Check elapsed time
 	if (render_max_dist_adaptive)
@@ -677,6 +874,25 @@ void MapRenderer3D::renderMap()
 	glDisable(GL_FOG);
 }
 
+// -----------------------------------------------------------------------------
+// Renders the map in 3d from [camera] to a [width]x[height] view, without
+// changing the renderer's own camera. Map data (VBOs, walls, flats and things)
+// is shared with all other views, only visibility is determined per-view
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderView(const Camera& camera, int width, int height)
+{
+	auto prev = this->camera();
+	setCamera(camera);
+
+	// Prefetching is only done for the renderer's own camera
+	render_view_ = true;
+	setupView(width, height);
+	renderMap();
+	render_view_ = false;
+
+	setCamera(prev);
+}
+
 // -----------------------------------------------------------------------------
 // Renders a cylindrical 'slice' of the sky between [top] and [bottom] on the z
 // axis
@@ -688,6 +904,7 @@ void MapRenderer3D::renderSkySlice(float top, float bottom, float atop, float ab
 	float tc_y1 = (-top + 1.0f) * (ty * 0.5f);
 	float tc_y2 = (-bottom + 1.0f) * (ty * 0.5f);
 
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 
 	// Go through circular points
@@ -793,6 +1010,7 @@ void MapRenderer3D::renderSky()
 		float size = 64.0f;
 		glDisable(GL_TEXTURE_2D);
 		gl::setColour(skycol_top_);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z + size);
 		glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z + size);
@@ -802,6 +1020,7 @@ void MapRenderer3D::renderSky()
 
 		// Render bottom cap
 		gl::setColour(skycol_bottom_);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glVertex3f(cam_position_.x - (size * 10), cam_position_.y - (size * 10), cam_position_.z - size);
 		glVertex3f(cam_position_.x - (size * 10), cam_position_.y + (size * 10), cam_position_.z - size);
@@ -865,9 +1084,12 @@ void MapRenderer3D::renderSky()
 }
 
 // -----------------------------------------------------------------------------
-// Updates the vertex texture coordinates of all polygons for sector [index]
+// Updates the texture coordinate transform of the floor or ceiling of sector
+// [index]. Flat texture coordinates are generated from the map position of
+// each vertex by this transform when rendering, so changing flat offsets,
+// scale or rotation doesn't need any vertex data to be rewritten
 // -----------------------------------------------------------------------------
-void MapRenderer3D::updateFlatTexCoords(unsigned index, bool floor)
+void MapRenderer3D::updateFlatTexTransform(unsigned index, bool floor)
 {
 	using game::UDMFFeature;
 
@@ -925,12 +1147,9 @@ void MapRenderer3D::updateFlatTexCoords(unsigned index, bool floor)
 	ox /= sx;
 	oy /= sy;
 
-	// Update polygon texture coordinates
-	if (floor)
-		sector->polygon()->setTexture(floors_[index].texture);
-	else
-		sector->polygon()->setTexture(ceilings_[index].texture);
-	sector->polygon()->updateTextureCoords(sx, sy, ox, oy, rot);
+	// Update texture transform
+	auto& flat         = floor ? floors_[index] : ceilings_[index];
+	flat.tex_transform = Polygon2D::textureTransform(flat.texture, sx, sy, ox, oy, rot);
 }
 
 // -----------------------------------------------------------------------------
@@ -943,6 +1162,7 @@ void MapRenderer3D::updateSector(unsigned index)
 		return;
 
 	// Update floor
+	auto  n_deferred         = mapeditor::textureManager().nDeferred();
 	bool  mix_tex_flats      = game::configuration().featureSupported(game::Feature::MixTexFlats);
 	auto  sector             = map_->sector(index);
 	auto& ftex               = mapeditor::textureManager().flat(sector->floor().texture, mix_tex_flats);
@@ -953,18 +1173,19 @@ void MapRenderer3D::updateSector(unsigned index)
 	floors_[index].fogcolour = sector->fogColour();
 	floors_[index].light     = sector->lightAt(1);
 	floors_[index].flags     = 0;
+	bool floor_moved         = !(floors_[index].plane == sector->floor().plane);
 	floors_[index].plane     = sector->floor().plane;
 	if (strutil::equalCI(sector->floor().texture, game::configuration().skyFlat()))
 		floors_[index].flags |= SKY;
+	updateFlatTexTransform(index, true);
 
-	// Update floor VBO
-	if (gl::vboSupport())
+	// Update floor VBO (only the vertex heights can change here)
+	if (gl::vboSupport() && floor_moved)
 	{
-		updateFlatTexCoords(index, true);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_floors_);
 		Polygon2D::setupVBOPointers();
 		sector->polygon()->setZ(floors_[index].plane);
-		sector->polygon()->updateVBOData();
+		sector->polygon()->updateVBOData(true);
 	}
 
 	// Update ceiling
@@ -976,23 +1197,25 @@ void MapRenderer3D::updateSector(unsigned index)
 	ceilings_[index].fogcolour = sector->fogColour();
 	ceilings_[index].light     = sector->lightAt(2);
 	ceilings_[index].flags     = CEIL;
+	bool ceiling_moved         = !(ceilings_[index].plane == sector->ceiling().plane);
 	ceilings_[index].plane     = sector->ceiling().plane;
 	if (strutil::equalCI(sector->ceiling().texture, game::configuration().skyFlat()))
 		ceilings_[index].flags |= SKY;
+	updateFlatTexTransform(index, false);
 
 	// Update ceiling VBO
-	if (gl::vboSupport())
+	if (gl::vboSupport() && ceiling_moved)
 	{
-		updateFlatTexCoords(index, false);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_ceilings_);
 		Polygon2D::setupVBOPointers();
 		sector->polygon()->setZ(ceilings_[index].plane);
-		sector->polygon()->updateVBOData();
+		sector->polygon()->updateVBOData(true);
 	}
 
 	// Finish up
 	floors_[index].updated_time   = app::runTimer();
 	ceilings_[index].updated_time = app::runTimer();
+	floors_[index].pending_tex    = mapeditor::textureManager().nDeferred() != n_deferred;
 	if (gl::vboSupport())
 	{
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1023,6 +1246,9 @@ void MapRenderer3D::renderFlat(Flat* flat)
 	// Setup fog colour
 	setFog(flat->fogcolour, flat->light);
 
+	// Setup texture transform
+	loadTexTransform(flat->tex_transform);
+
 	// Render flat
 	if (gl::vboSupport() && flats_use_vbo)
 	{
@@ -1068,7 +1294,7 @@ void MapRenderer3D::renderFlat(Flat* flat)
 		}
 
 		// Render
-		flat->sector->polygon()->render();
+		flat->sector->polygon()->render(true);
 
 		glPopMatrix();
 	}
@@ -1083,6 +1309,8 @@ void MapRenderer3D::renderFlat(Flat* flat)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderFlats()
 {
+	PROFILE_SCOPE("MapRenderer3D::renderFlats");
+
 	// Check for map
 	if (!map_)
 		return;
@@ -1094,6 +1322,8 @@ void MapRenderer3D::renderFlats()
 	unsigned a        = 0;
 	unsigned tex_last = 0;
 	flat_last_        = 0;
+	if (gl::vboSupport() && flats_use_vbo)
+		renderFlatsVBO();
 	while (n_flats_ > 0)
 	{
 		a        = 0;
@@ -1121,6 +1351,9 @@ void MapRenderer3D::renderFlats()
 
 	// Reset gl stuff
 	glDisable(GL_TEXTURE_2D);
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
 	if (gl::vboSupport())
 	{
 		glDisableClientState(GL_VERTEX_ARRAY);
@@ -1129,6 +1362,84 @@ void MapRenderer3D::renderFlats()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Renders all currently visible flats from the flats VBOs, sorted into batches
+// of flats with the same texture and render state and drawn with one call per
+// batch
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderFlatsVBO()
+{
+	// Sort into batches
+	std::sort(
+		flats_, flats_ + n_flats_, [](Flat* left, Flat* right) { return flatBatchKey(left) < flatBatchKey(right); });
+
+	unsigned        tex_last = 0;
+	vector<GLint>   firsts;
+	vector<GLsizei> counts;
+	for (unsigned a = 0; a < n_flats_;)
+	{
+		// Get vertex ranges for all flats in the batch
+		auto flat = flats_[a];
+		auto key  = flatBatchKey(flat);
+		firsts.clear();
+		counts.clear();
+		for (; a < n_flats_ && flatBatchKey(flats_[a]) == key; ++a)
+			if (flats_[a]->sector)
+				flats_[a]->sector->polygon()->putVBORanges(firsts, counts);
+		if (firsts.empty())
+			continue;
+
+		// Setup for floor or ceiling
+		if (flat->flags & CEIL)
+		{
+			if (flat_last_ != 2)
+			{
+				glCullFace(GL_BACK);
+				glBindBuffer(GL_ARRAY_BUFFER, vbo_ceilings_);
+				Polygon2D::setupVBOPointers();
+				flat_last_ = 2;
+			}
+		}
+		else if (flat_last_ != 1)
+		{
+			glCullFace(GL_FRONT);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_floors_);
+			Polygon2D::setupVBOPointers();
+			flat_last_ = 1;
+		}
+
+		// Bind texture if needed
+		if (flat->texture && flat->texture != tex_last)
+		{
+			gl::Texture::bind(flat->texture);
+			tex_last = flat->texture;
+		}
+
+		// Setup special rendering options
+		float alpha = flat->alpha;
+		if (flat->flags & SKY && render_3d_sky)
+		{
+			alpha = 0;
+			glDisable(GL_ALPHA_TEST);
+		}
+
+		// Setup colour/light and fog
+		setLight(flat->colour, flat->light, alpha);
+		setFog(flat->fogcolour, flat->light);
+		loadTexTransform(flat->tex_transform);
+
+		// Render batch
+		gl::countDrawCall();
+		glMultiDrawArrays(GL_TRIANGLE_FAN, firsts.data(), counts.data(), firsts.size());
+
+		// Reset settings
+		if (flat->flags & SKY && render_3d_sky)
+			glEnable(GL_ALPHA_TEST);
+	}
+
+	n_flats_ = 0;
+}
+
 // -----------------------------------------------------------------------------
 // Renders selection overlay for all selected flats
 // -----------------------------------------------------------------------------
@@ -1176,6 +1487,7 @@ void MapRenderer3D::renderFlatSelection(const ItemSelection& selection, float al
 		vector<MapLine*> lines;
 		sector->putLines(lines);
 		gl::setColour(col1);
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		for (auto& line : lines)
 		{
@@ -1307,6 +1619,8 @@ void MapRenderer3D::updateLine(unsigned index)
 
 	// Clear current line data
 	lines_[index].quads.clear();
+	lines_[index].pending_tex = false;
+	auto n_deferred           = mapeditor::textureManager().nDeferred();
 
 	// Skip invalid line
 	auto line = map_->line(index);
@@ -1411,6 +1725,7 @@ void MapRenderer3D::updateLine(unsigned index)
 		// Add middle quad and finish
 		lines_[index].quads.push_back(quad);
 		lines_[index].updated_time = app::runTimer();
+		lines_[index].pending_tex  = mapeditor::textureManager().nDeferred() != n_deferred;
 		return;
 	}
 
@@ -1895,12 +2210,37 @@ void MapRenderer3D::updateLine(unsigned index)
 
 	// Finished
 	lines_[index].updated_time = app::runTimer();
+	lines_[index].pending_tex  = mapeditor::textureManager().nDeferred() != n_deferred;
 }
 
 // -----------------------------------------------------------------------------
 // Renders [quad]
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderQuad(MapRenderer3D::Quad* quad, float alpha)
+{
+	setupQuadRendering(quad, alpha);
+
+	// Draw quad
+	gl::countDrawCall();
+	glBegin(GL_QUADS);
+	glTexCoord2f(quad->points[0].tx, quad->points[0].ty);
+	glVertex3f(quad->points[0].x, quad->points[0].y, quad->points[0].z);
+	glTexCoord2f(quad->points[1].tx, quad->points[1].ty);
+	glVertex3f(quad->points[1].x, quad->points[1].y, quad->points[1].z);
+	glTexCoord2f(quad->points[2].tx, quad->points[2].ty);
+	glVertex3f(quad->points[2].x, quad->points[2].y, quad->points[2].z);
+	glTexCoord2f(quad->points[3].tx, quad->points[3].ty);
+	glVertex3f(quad->points[3].x, quad->points[3].y, quad->points[3].z);
+	glEnd();
+
+	resetQuadRendering(quad);
+}
+
+// -----------------------------------------------------------------------------
+// Sets up OpenGL state (blending, colour, fog etc.) for rendering [quad] with
+// [alpha]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::setupQuadRendering(Quad* quad, float alpha)
 {
 	// Setup special rendering options
 	if (quad->colour.a == 255)
@@ -1925,20 +2265,13 @@ void MapRenderer3D::renderQuad(MapRenderer3D::Quad* quad, float alpha)
 
 	// Setup fog
 	setFog(quad->fogcolour, quad->light);
+}
 
-	// Draw quad
-	glBegin(GL_QUADS);
-	glTexCoord2f(quad->points[0].tx, quad->points[0].ty);
-	glVertex3f(quad->points[0].x, quad->points[0].y, quad->points[0].z);
-	glTexCoord2f(quad->points[1].tx, quad->points[1].ty);
-	glVertex3f(quad->points[1].x, quad->points[1].y, quad->points[1].z);
-	glTexCoord2f(quad->points[2].tx, quad->points[2].ty);
-	glVertex3f(quad->points[2].x, quad->points[2].y, quad->points[2].z);
-	glTexCoord2f(quad->points[3].tx, quad->points[3].ty);
-	glVertex3f(quad->points[3].x, quad->points[3].y, quad->points[3].z);
-	glEnd();
-
-	// Reset settings
+// -----------------------------------------------------------------------------
+// Resets any OpenGL state changed by setupQuadRendering for [quad]
+// -----------------------------------------------------------------------------
+void MapRenderer3D::resetQuadRendering(const Quad* quad) const
+{
 	if (quad->colour.a == 255)
 	{
 		if (quad->flags & SKY && render_3d_sky)
@@ -1953,6 +2286,8 @@ void MapRenderer3D::renderQuad(MapRenderer3D::Quad* quad, float alpha)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderWalls()
 {
+	PROFILE_SCOPE("MapRenderer3D::renderWalls");
+
 	// Init
 	quads_transparent_.clear();
 	glEnable(GL_TEXTURE_2D);
@@ -1961,6 +2296,8 @@ void MapRenderer3D::renderWalls()
 	// Render all visible quads, ordered by texture
 	unsigned a        = 0;
 	unsigned tex_last = 0;
+	if (gl::vboSupport() && walls_use_vbo)
+		renderWallsVBO();
 	while (n_quads_ > 0)
 	{
 		tex_last = 0;
@@ -1998,6 +2335,69 @@ void MapRenderer3D::renderWalls()
 	glDisable(GL_TEXTURE_2D);
 }
 
+// -----------------------------------------------------------------------------
+// Renders all currently visible opaque wall quads from the walls VBO, sorted
+// into batches of quads with the same texture and render state and drawn with
+// one call per batch. Transparent quads are added to quads_transparent_
+// -----------------------------------------------------------------------------
+void MapRenderer3D::renderWallsVBO()
+{
+	// Split off transparent quads
+	auto opaque_end = std::partition(quads_, quads_ + n_quads_, [](Quad* quad) { return quad->colour.a == 255; });
+	quads_transparent_.assign(opaque_end, quads_ + n_quads_);
+	n_quads_ = opaque_end - quads_;
+
+	// Sort into batches (and VBO order within each batch)
+	std::sort(quads_, quads_ + n_quads_, [](Quad* left, Quad* right) {
+		auto lk = quadBatchKey(left);
+		auto rk = quadBatchKey(right);
+		return lk < rk || (lk == rk && left->vbo_index < right->vbo_index);
+	});
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_walls_);
+	Polygon2D::setupVBOPointers();
+
+	unsigned        tex_last = 0;
+	vector<GLint>   firsts;
+	vector<GLsizei> counts;
+	for (unsigned a = 0; a < n_quads_;)
+	{
+		// Get vertex ranges for all quads in the batch, merging any that are
+		// next to each other in the VBO
+		auto quad = quads_[a];
+		auto key  = quadBatchKey(quad);
+		firsts.clear();
+		counts.clear();
+		for (; a < n_quads_ && quadBatchKey(quads_[a]) == key; ++a)
+		{
+			GLint first = quads_[a]->vbo_index;
+			if (!firsts.empty() && firsts.back() + counts.back() == first)
+				counts.back() += 4;
+			else
+			{
+				firsts.push_back(first);
+				counts.push_back(4);
+			}
+		}
+
+		// Bind texture if needed
+		if (quad->texture && quad->texture != tex_last)
+		{
+			gl::Texture::bind(quad->texture);
+			tex_last = quad->texture;
+		}
+
+		// Render batch
+		setupQuadRendering(quad, quad->alpha);
+		gl::countDrawCall();
+		glMultiDrawArrays(GL_QUADS, firsts.data(), counts.data(), firsts.size());
+		resetQuadRendering(quad);
+	}
+
+	n_quads_ = 0;
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 // -----------------------------------------------------------------------------
 // Renders all currently visible transparent wall quads
 // -----------------------------------------------------------------------------
@@ -2104,6 +2504,7 @@ void MapRenderer3D::renderWallSelection(const ItemSelection& selection, float al
 
 		// Render quad outline
 		gl::setColour(col1);
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		for (auto& point : quad->points)
 			glVertex3f(point.x, point.y, point.z);
@@ -2111,6 +2512,7 @@ void MapRenderer3D::renderWallSelection(const ItemSelection& selection, float al
 
 		// Render quad fill
 		gl::setColour(col2);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		for (auto& point : quad->points)
 			glVertex3f(point.x, point.y, point.z);
@@ -2128,17 +2530,23 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 		return;
 
 	// Setup thing info
-	things_[index].type   = &(game::configuration().thingType(thing->type()));
-	things_[index].sector = map_->sectors().atPos(thing->position());
-
-	// Get sprite texture
-	uint32_t theight      = render_thing_icon_size;
+	things_[index].type   = &(thing->typeInfo());
+	things_[index].sector = map_->thingSector(thing);
+
+	// Get sprite texture (if it isn't loaded yet the thing's icon is used until
+	// it is, see renderThings)
+	uint32_t theight    = render_thing_icon_size;
+	auto     n_deferred = mapeditor::textureManager().nDeferred();
+	mapeditor::textureManager().setDeferLoading(true);
 	things_[index].sprite = mapeditor::textureManager()
 								.sprite(
 									things_[index].type->sprite(),
 									things_[index].type->translation(),
 									things_[index].type->palette())
 								.gl_id;
+	mapeditor::textureManager().setDeferLoading(false);
+	things_[index].pending_tex = mapeditor::textureManager().nDeferred() != n_deferred;
+	things_[index].flags &= ~(ICON | ZETH);
 	if (!things_[index].sprite)
 	{
 		// Sprite not found, try an icon
@@ -2164,6 +2572,11 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 		things_[index].sprite = mapeditor::textureManager().editorImage("thing/unknown").gl_id;
 	}
 
+	// Keep track of the widest thing (for hilight checking)
+	double halfwidth = things_[index].flags & ICON ? render_thing_icon_size * 0.5
+												   : gl::Texture::info(things_[index].sprite).size.x * 0.5;
+	thing_max_halfwidth_ = std::max(thing_max_halfwidth_, halfwidth);
+
 	// Determine z position
 	if (things_[index].type->zHeightAbsolute())
 		things_[index].z = thing->zPos();
@@ -2195,6 +2608,31 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 	// Adjust height by sprite Y offset if needed
 	things_[index].z += mapeditor::textureManager().verticalOffset(things_[index].type->sprite());
 
+	// Determine colour/light
+	auto& info = things_[index];
+	info.colour.set(255, 255, 255, 255);
+	info.light     = 255;
+	info.fogcolour = info.sector ? info.sector->fogColour() : ColRGBA(0, 0, 0, 0);
+	// If a thing is defined as fullbright but the sprite is missing,
+	// we'll fallback on the icon, which needs to be colored as appropriate.
+	if (!info.type->fullbright() || (info.flags & ICON))
+	{
+		// Get light level from sector
+		if (info.sector)
+			info.light = info.sector->lightAt();
+
+		// Icon, use thing icon colour (not for Zeth icons, though)
+		if (info.flags & ICON)
+		{
+			if (!(info.flags & ZETH))
+				info.colour.set(info.type->colour());
+		}
+
+		// Otherwise use sector colour
+		else if (info.sector)
+			info.colour.set(info.sector->colourAt(0, true));
+	}
+
 	things_[index].updated_time = app::runTimer();
 }
 
@@ -2203,21 +2641,19 @@ void MapRenderer3D::updateThing(unsigned index, MapThing* thing)
 // -----------------------------------------------------------------------------
 void MapRenderer3D::renderThings()
 {
+	PROFILE_SCOPE("MapRenderer3D::renderThings");
+
 	// Init
 	glEnable(GL_TEXTURE_2D);
 	glCullFace(GL_BACK);
-	unsigned tex = 0;
 
 	// Go through things
-	double dist, halfwidth, theight;
 	double mdist = render_max_thing_dist;
 	if (mdist <= 0 || mdist > render_max_dist)
 		mdist = render_max_dist;
-	ColRGBA  col;
-	uint8_t  light;
-	float    x1, y1, x2, y2;
 	unsigned update = 0;
 	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
+	vis_things_.clear();
 	for (unsigned a = 0; a < map_->nThings(); a++)
 	{
 		auto thing       = map_->thing(a);
@@ -2231,12 +2667,13 @@ void MapRenderer3D::renderThings()
 		}
 
 		// Check thing distance if needed
-		dist = math::distance(cam_position_.get2d(), thing->position());
+		double dist = math::distance(cam_position_.get2d(), thing->position());
 		if (mdist > 0 && dist > mdist)
 			continue;
 
 		// Update thing if needed
 		if (things_[a].updated_time < thing->modifiedTime()
+			|| (things_[a].pending_tex && things_[a].updated_time < mapeditor::textureManager().pendingLoadedTime())
 			|| (things_[a].sector
 				&& (things_[a].updated_time < things_[a].sector->modifiedTime()
 					|| things_[a].updated_time < things_[a].sector->geometryUpdatedTime())))
@@ -2247,76 +2684,110 @@ void MapRenderer3D::renderThings()
 				break;
 		}
 
+		// Skip if the thing's sector isn't visible
+		if (things_[a].sector && dist_sectors_[things_[a].sector->index()] < 0)
+			continue;
+
 		// Skip if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
 			continue;
 
-		// Get thing sprite
-		tex = things_[a].sprite;
+		vis_things_.emplace_back(a, calcDistFade(dist, mdist));
+		things_[a].flags |= DRAWN;
+	}
 
-		// Bind texture if needed
-		gl::Texture::bind(tex, false);
+	// Sort visible things into batches by texture and fog (the light level
+	// only affects the fog depth, so isn't needed if fog is off)
+	auto batch_key = [this](const Thing& thing)
+	{
+		return std::make_tuple(
+			thing.sprite,
+			fog_ ? thing.light : 0,
+			thing.fogcolour.r,
+			thing.fogcolour.g,
+			thing.fogcolour.b);
+	};
+	std::sort(
+		vis_things_.begin(),
+		vis_things_.end(),
+		[this, &batch_key](const auto& left, const auto& right)
+		{ return batch_key(things_[left.first]) < batch_key(things_[right.first]); });
+
+	// Build sprite quads, billboarded to face the camera
+	sprite_vertices_.clear();
+	sprite_vertices_.reserve(vis_things_.size() * 4);
+	for (const auto& [index, fade] : vis_things_)
+	{
+		auto  thing = map_->thing(index);
+		auto& info  = things_[index];
 
 		// Determine coordinates
-		auto& tex_info = gl::Texture::info(tex);
-		halfwidth      = things_[a].type->scaleX() * tex_info.size.x * 0.5;
-		theight        = things_[a].type->scaleY() * tex_info.size.y;
-		if (things_[a].flags & ICON)
+		auto&  tex_info  = gl::Texture::info(info.sprite);
+		double halfwidth = info.type->scaleX() * tex_info.size.x * 0.5;
+		double theight   = info.type->scaleY() * tex_info.size.y;
+		if (info.flags & ICON)
 		{
 			halfwidth = render_thing_icon_size * 0.5;
 			theight   = render_thing_icon_size;
 		}
-		x1                = thing->xPos() - cam_strafe_.x * halfwidth;
-		y1                = thing->yPos() - cam_strafe_.y * halfwidth;
-		x2                = thing->xPos() + cam_strafe_.x * halfwidth;
-		y2                = thing->yPos() + cam_strafe_.y * halfwidth;
-		things_[a].height = theight;
+		float x1    = thing->xPos() - cam_strafe_.x * halfwidth;
+		float y1    = thing->yPos() - cam_strafe_.y * halfwidth;
+		float x2    = thing->xPos() + cam_strafe_.x * halfwidth;
+		float y2    = thing->yPos() + cam_strafe_.y * halfwidth;
+		float z1    = info.z;
+		float z2    = info.z + theight;
+		info.height = theight;
+
+		auto col = lightColour(info.colour, info.light, fade);
+		sprite_vertices_.push_back({ x1, y1, z2, 0.0f, 0.0f, col.r, col.g, col.b, col.a });
+		sprite_vertices_.push_back({ x1, y1, z1, 0.0f, 1.0f, col.r, col.g, col.b, col.a });
+		sprite_vertices_.push_back({ x2, y2, z1, 1.0f, 1.0f, col.r, col.g, col.b, col.a });
+		sprite_vertices_.push_back({ x2, y2, z2, 1.0f, 0.0f, col.r, col.g, col.b, col.a });
+	}
 
-		// Set colour/brightness
-		light = 255;
-		// If a thing is defined as fullbright but the sprite is missing,
-		// we'll fallback on the icon, which needs to be colored as appropriate.
-		if (things_[a].type->fullbright() && !(things_[a].flags & ICON))
-			col.set(255, 255, 255, 255);
-		else
+	// Draw sprites, one batch at a time
+	if (!sprite_vertices_.empty())
+	{
+		// Upload to the sprites VBO if supported (otherwise draw from memory)
+		auto base = reinterpret_cast<const char*>(sprite_vertices_.data());
+		if (gl::vboSupport())
 		{
-			// Get light level from sector
-			if (things_[a].sector)
-				light = things_[a].sector->lightAt();
-
-			// Icon, use thing icon colour (not for Zeth icons, though)
-			if (things_[a].flags & ICON)
-			{
-				if (things_[a].flags & ZETH)
-					col.set(255, 255, 255, 255);
-				else
-					col.set(things_[a].type->colour());
-			}
-
-			// Otherwise use sector colour
-			else if (things_[a].sector)
-				col.set(things_[a].sector->colourAt(0, true));
+			auto bytes = sprite_vertices_.size() * sizeof(SpriteVertex);
+			if (!vbo_sprites_)
+				glGenBuffers(1, &vbo_sprites_);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_sprites_);
+			glBufferData(GL_ARRAY_BUFFER, bytes, base, GL_STREAM_DRAW);
+			gl::countUpload(bytes);
+			base = nullptr;
 		}
-		setLight(col, light, calcDistFade(dist, mdist));
-		auto fogcol = ColRGBA(0, 0, 0, 0);
-		if (things_[a].sector)
-			fogcol = things_[a].sector->fogColour();
 
-		setFog(fogcol, light);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, sizeof(SpriteVertex), base);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(SpriteVertex), base + offsetof(SpriteVertex, u));
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SpriteVertex), base + offsetof(SpriteVertex, r));
 
-		// Draw thing
-		glBegin(GL_QUADS);
-		glTexCoord2f(0.0f, 0.0f);
-		glVertex3f(x1, y1, things_[a].z + theight);
-		glTexCoord2f(0.0f, 1.0f);
-		glVertex3f(x1, y1, things_[a].z);
-		glTexCoord2f(1.0f, 1.0f);
-		glVertex3f(x2, y2, things_[a].z);
-		glTexCoord2f(1.0f, 0.0f);
-		glVertex3f(x2, y2, things_[a].z + theight);
-		glEnd();
+		for (unsigned a = 0; a < vis_things_.size();)
+		{
+			auto& first = things_[vis_things_[a].first];
+			auto  key   = batch_key(first);
+			auto  end   = a + 1;
+			while (end < vis_things_.size() && batch_key(things_[vis_things_[end].first]) == key)
+				++end;
+
+			gl::Texture::bind(first.sprite, false);
+			setFog(first.fogcolour, first.light);
+			gl::countDrawCall();
+			glDrawArrays(GL_QUADS, a * 4, (end - a) * 4);
+
+			a = end;
+		}
 
-		things_[a].flags |= DRAWN;
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	// Draw thing borders if needed
@@ -2328,6 +2799,7 @@ void MapRenderer3D::renderThings()
 		glDisable(GL_CULL_FACE);
 		glLineWidth(3.5f);
 
+		ColRGBA col;
 		for (unsigned a = 0; a < map_->nThings(); a++)
 		{
 			// Skip if hidden
@@ -2354,6 +2826,7 @@ void MapRenderer3D::renderThings()
 				fogcol2 = things_[a].sector->fogColour();
 			}
 			setFog(fogcol2, light2);
+			gl::countDrawCall();
 			glBegin(GL_QUADS);
 			// Bottom
 			glVertex3f(thing->xPos() - radius, thing->yPos() - radius, bottom);
@@ -2393,6 +2866,7 @@ void MapRenderer3D::renderThings()
 			// Outline
 			glColor4f(col.fr(), col.fg(), col.fb(), 0.6f);
 			// Bottom
+			gl::countDrawCall();
 			glBegin(GL_LINE_LOOP);
 			glVertex3f(thing->xPos() - radius, thing->yPos() - radius, bottom);
 			glVertex3f(thing->xPos() + radius, thing->yPos() - radius, bottom);
@@ -2402,6 +2876,7 @@ void MapRenderer3D::renderThings()
 			if (render_3d_things_style == 2)
 			{
 				// Top
+				gl::countDrawCall();
 				glBegin(GL_LINE_LOOP);
 				glVertex3f(thing->xPos() - radius, thing->yPos() - radius, top);
 				glVertex3f(thing->xPos() + radius, thing->yPos() - radius, top);
@@ -2409,6 +2884,7 @@ void MapRenderer3D::renderThings()
 				glVertex3f(thing->xPos() - radius, thing->yPos() + radius, top);
 				glEnd();
 				// Corners
+				gl::countDrawCall();
 				glBegin(GL_LINES);
 				glVertex3f(thing->xPos() - radius, thing->yPos() - radius, bottom);
 				glVertex3f(thing->xPos() - radius, thing->yPos() - radius, top);
@@ -2425,6 +2901,7 @@ void MapRenderer3D::renderThings()
 			glPushMatrix();
 			glTranslatef(thing->xPos(), thing->yPos(), bottom);
 			glRotated(thing->angle(), 0, 0, 1);
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 			glVertex3f(0.0f, 0.0f, 0.0f);
 			glVertex3f(radius, 0.0f, 0.0f);
@@ -2502,6 +2979,7 @@ void MapRenderer3D::renderThingSelection(const ItemSelection& selection, float a
 		// Render outline
 		double z = things_[item.index].z;
 		gl::setColour(col1);
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		glVertex3f(x1, y1, z + theight);
 		glVertex3f(x1, y1, z);
@@ -2511,6 +2989,7 @@ void MapRenderer3D::renderThingSelection(const ItemSelection& selection, float a
 
 		// Render fill
 		gl::setColour(col2);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glVertex3f(x1, y1, z + theight);
 		glVertex3f(x1, y1, z);
@@ -2557,10 +3036,10 @@ void MapRenderer3D::updateFlatsVBO()
 	{
 		// Set polygon z height
 		auto poly = map_->sector(a)->polygon();
-		poly->setZ(map_->sector(a)->floor().height);
+		poly->setZ(map_->sector(a)->floor().plane);
 
 		// Write to VBO
-		offset = poly->writeToVBO(offset, index);
+		offset = poly->writeToVBO(offset, index, true);
 		index += poly->totalVertices();
 	}
 
@@ -2578,10 +3057,10 @@ void MapRenderer3D::updateFlatsVBO()
 	{
 		// Set polygon z height
 		auto poly = map_->sector(a)->polygon();
-		poly->setZ(map_->sector(a)->ceiling().height);
+		poly->setZ(map_->sector(a)->ceiling().plane);
 
 		// Write to VBO
-		offset = poly->writeToVBO(offset, index);
+		offset = poly->writeToVBO(offset, index, true);
 		index += poly->totalVertices();
 
 		// Reset polygon z
@@ -2590,17 +3069,151 @@ void MapRenderer3D::updateFlatsVBO()
 
 	// Clean up
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	flats_vbo_updated_ = app::runTimer();
+	flats_vbo_sectors_ = map_->nSectors();
+}
+
+// -----------------------------------------------------------------------------
+// Writes the quads for line [index] to its slot in the walls VBO data, moving
+// it to a new slot at the end if it no longer fits. The VBO itself is updated
+// in updateWallsVBO
+// -----------------------------------------------------------------------------
+void MapRenderer3D::writeLineToWallsVBO(unsigned index)
+{
+	auto&    line = lines_[index];
+	unsigned size = line.quads.size() * 4;
+	if (size > line.vbo_size)
+	{
+		line.vbo_first = walls_vbo_data_.size();
+		line.vbo_size  = size;
+		walls_vbo_data_.resize(walls_vbo_data_.size() + size);
+	}
+
+	for (unsigned a = 0; a < line.quads.size(); a++)
+	{
+		auto& quad     = line.quads[a];
+		quad.vbo_index = line.vbo_first + a * 4;
+		std::copy(quad.points, quad.points + 4, walls_vbo_data_.begin() + quad.vbo_index);
+	}
+
+	walls_vbo_dirty_start_ = std::min(walls_vbo_dirty_start_, line.vbo_first);
+	walls_vbo_dirty_end_   = std::max(walls_vbo_dirty_end_, line.vbo_first + size);
+}
+
+// -----------------------------------------------------------------------------
+// Uploads any modified walls VBO data (see writeLineToWallsVBO), reallocating
+// the buffer if it has grown and compacting it if too much of it is taken up
+// by line slots that are no longer used
+// -----------------------------------------------------------------------------
+void MapRenderer3D::updateWallsVBO()
+{
+	if (walls_vbo_dirty_start_ >= walls_vbo_dirty_end_)
+		return;
+
+	// Create VBO if needed
+	if (vbo_walls_ == 0)
+		glGenBuffers(1, &vbo_walls_);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_walls_);
+
+	if (walls_vbo_data_.size() > walls_vbo_capacity_)
+	{
+		// Compact line slots if over half of the data is unused
+		unsigned used = 0;
+		for (auto& line : lines_)
+			used += line.vbo_size;
+		if (used < walls_vbo_data_.size() / 2)
+		{
+			vector<GLVertex> data;
+			data.reserve(used);
+			for (auto& line : lines_)
+			{
+				if (line.vbo_size == 0)
+					continue;
+
+				auto first     = walls_vbo_data_.begin() + line.vbo_first;
+				line.vbo_first = data.size();
+				data.insert(data.end(), first, first + line.vbo_size);
+				for (unsigned a = 0; a < line.quads.size(); a++)
+					line.quads[a].vbo_index = line.vbo_first + a * 4;
+			}
+			walls_vbo_data_.swap(data);
+		}
+
+		// Reallocate (with extra space for lines to be added as they are
+		// first seen), and upload everything
+		walls_vbo_capacity_ = walls_vbo_data_.size() + walls_vbo_data_.size() / 2;
+		glBufferData(GL_ARRAY_BUFFER, walls_vbo_capacity_ * sizeof(GLVertex), nullptr, GL_STATIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, walls_vbo_data_.size() * sizeof(GLVertex), walls_vbo_data_.data());
+		gl::countUpload(walls_vbo_data_.size() * sizeof(GLVertex));
+	}
+	else
+	{
+		// Upload modified range only
+		glBufferSubData(
+			GL_ARRAY_BUFFER,
+			walls_vbo_dirty_start_ * sizeof(GLVertex),
+			(walls_vbo_dirty_end_ - walls_vbo_dirty_start_) * sizeof(GLVertex),
+			walls_vbo_data_.data() + walls_vbo_dirty_start_);
+		gl::countUpload((walls_vbo_dirty_end_ - walls_vbo_dirty_start_) * sizeof(GLVertex));
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	walls_vbo_dirty_start_ = -1;
+	walls_vbo_dirty_end_   = 0;
 }
 
 // -----------------------------------------------------------------------------
-// (Re)builds the walls Vertex Buffer Object
-// (or would, if it were used for wall rendering)
+// Rebuilds the flat VBOs if any sector polygons have changed, and resizes the
+// map structure arrays to match the map. Since the data is shared by all
+// views, the first view rendered after a change does the update and any other
+// views find it already up to date
 // -----------------------------------------------------------------------------
-void MapRenderer3D::updateWallsVBO() const {}
+void MapRenderer3D::updateSharedData()
+{
+	// Rebuild flat VBOs if any polygon vertex data has changed
+	if (gl::vboSupport())
+	{
+		bool update = vbo_floors_ == 0 || flats_vbo_sectors_ != map_->nSectors();
+		for (unsigned a = 0; !update && a < map_->nSectors(); a++)
+		{
+			auto sector = map_->sector(a);
+			auto poly   = sector->polygon();
+			if ((poly && poly->vboUpdate() > 1) || flats_vbo_updated_ < sector->geometryUpdatedTime())
+				update = true;
+		}
+
+		if (update)
+			updateFlatsVBO();
+	}
+
+	// Resize flat arrays if needed (the visible flats array is recreated at the
+	// new size when next needed)
+	if (floors_.size() != map_->nSectors())
+	{
+		floors_.resize(map_->nSectors());
+		ceilings_.resize(map_->nSectors());
+		delete[] flats_;
+		flats_ = nullptr;
+	}
+
+	// Resize lines array if needed (likewise for the visible quads array)
+	if (lines_.size() != map_->nLines())
+	{
+		lines_.resize(map_->nLines());
+		delete[] quads_;
+		quads_ = nullptr;
+	}
+
+	// Resize things array if needed
+	if (things_.size() != map_->nThings())
+		things_.resize(map_->nThings());
+}
 
 // -----------------------------------------------------------------------------
-// Runs a quick check of all sector bounding boxes against the current view to
-// hide any that are outside it
+// Finds all sectors that could be visible from the camera (see
+// floodVisibleSectors), and runs a quick check of their bounding boxes against
+// the current view to hide any that are outside it
 // -----------------------------------------------------------------------------
 void MapRenderer3D::quickVisDiscard()
 {
@@ -2608,11 +3221,21 @@ void MapRenderer3D::quickVisDiscard()
 	if (dist_sectors_.size() != map_->nSectors())
 		dist_sectors_.resize(map_->nSectors());
 
-	// Go through all sectors
+	// Find sectors to check, falling back to all of them if the portal flood
+	// can't be done from the camera position
+	std::fill(dist_sectors_.begin(), dist_sectors_.end(), -1.0f);
+	if (!render_3d_portal_vis || !floodVisibleSectors())
+	{
+		vis_sectors_.resize(map_->nSectors());
+		for (unsigned a = 0; a < map_->nSectors(); a++)
+			vis_sectors_[a] = a;
+	}
+
+	// Go through sectors
 	auto   cam = cam_position_.get2d();
 	double min_dist, dist;
 	Seg2d  strafe(cam, cam + cam_strafe_.get2d());
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	for (auto a : vis_sectors_)
 	{
 		// Get sector bbox
 		auto bbox = map_->sector(a)->boundingBox();
@@ -2657,15 +3280,82 @@ void MapRenderer3D::quickVisDiscard()
 		}
 	}
 
-	// Set all lines that are part of invisible sectors to invisible
-	for (unsigned a = 0; a < map_->nSides(); a++)
+	// Hide lines that were previously visible
+	for (auto index : vis_lines_)
+		if (index < lines_.size())
+			lines_[index].visible = false;
+
+	// Show all lines that are part of visible sectors
+	vis_lines_.clear();
+	for (auto a : vis_sectors_)
 	{
-		dist = dist_sectors_[map_->side(a)->sector()->index()];
+		dist = dist_sectors_[a];
 		if (dist < 0 || (render_max_dist > 0 && dist > render_max_dist))
-			lines_[map_->side(a)->parentLine()->index()].visible = false;
-		else
-			lines_[map_->side(a)->parentLine()->index()].visible = true;
+			continue;
+
+		for (auto side : map_->sector(a)->connectedSides())
+			vis_lines_.push_back(side->parentLine()->index());
+	}
+	std::sort(vis_lines_.begin(), vis_lines_.end());
+	vis_lines_.erase(std::unique(vis_lines_.begin(), vis_lines_.end()), vis_lines_.end());
+	for (auto index : vis_lines_)
+		lines_[index].visible = true;
+}
+
+// -----------------------------------------------------------------------------
+// Fills vis_sectors_ with all sectors that could be visible from the camera, by
+// flood filling from the sector the camera is in through two-sided lines that
+// are in front of the camera, within the max render distance and not closed
+// off. Visited sectors are marked with a distance of 0 in dist_sectors_.
+// Returns false if the camera isn't within the space of any sector (so could
+// potentially see anything)
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::floodVisibleSectors()
+{
+	PROFILE_SCOPE("MapRenderer3D::floodVisibleSectors");
+
+	// Check the camera is within a sector (and between its floor and ceiling)
+	auto cam   = cam_position_.get2d();
+	auto start = cameraSector();
+	if (!start || cam_position_.z < start->floor().plane.heightAt(cam)
+		|| cam_position_.z > start->ceiling().plane.heightAt(cam))
+		return false;
+
+	vis_sectors_.clear();
+	vis_sectors_.push_back(start->index());
+	dist_sectors_[start->index()] = 0.0f;
+
+	// Flood fill out from the camera sector (vis_sectors_ is the queue)
+	Seg2d strafe(cam, cam + cam_strafe_.get2d());
+	bool  check_side = cam_pitch_ > -0.9 && cam_pitch_ < 0.9;
+	for (unsigned a = 0; a < vis_sectors_.size(); a++)
+	{
+		for (auto side : map_->sector(vis_sectors_[a])->connectedSides())
+		{
+			auto line  = side->parentLine();
+			auto other = side == line->s1() ? line->backSector() : line->frontSector();
+			if (!other || dist_sectors_[other->index()] >= 0)
+				continue;
+
+			// Check side of camera
+			if (check_side && math::lineSide(line->start(), strafe) > 0 && math::lineSide(line->end(), strafe) > 0)
+				continue;
+
+			// Check distance
+			if (render_max_dist > 0 && math::distanceToLine(cam, line->seg()) > render_max_dist)
+				continue;
+
+			// Check the line can be seen through
+			if (openingClosed(line))
+				continue;
+
+			dist_sectors_[other->index()] = 0.0f;
+			vis_sectors_.push_back(other->index());
+		}
 	}
+
+	std::sort(vis_sectors_.begin(), vis_sectors_.end());
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -2692,72 +3382,71 @@ void MapRenderer3D::checkVisibleQuads()
 	if (!quads_)
 		quads_ = new Quad*[map_->nLines() * 4];
 
-	// Go through lines
+	// Go through lines, finding those in front of the camera and those that
+	// need updating
 	MapLine* line;
 	float    distfade;
-	n_quads_         = 0;
-	unsigned updates = 0;
-	bool     update  = false;
-	Seg2d    strafe(cam_position_.get2d(), (cam_position_ + cam_strafe_).get2d());
-	for (unsigned a = 0; a < lines_.size(); a++)
+	n_quads_           = 0;
+	bool     walls_vbo = gl::vboSupport();
+	auto     cam       = cam_position_.get2d();
+	Seg2d    strafe(cam, (cam_position_ + cam_strafe_).get2d());
+	quad_lines_.clear();
+	pending_updates_.clear();
+	for (auto a : vis_lines_)
 	{
 		line = map_->line(a);
 
-		// Skip if not visible
-		if (!lines_[a].visible)
-			continue;
-
 		// Check side of camera
 		if (cam_pitch_ > -0.9 && cam_pitch_ < 0.9)
 		{
 			if (math::lineSide(line->start(), strafe) > 0 && math::lineSide(line->end(), strafe) > 0)
 				continue;
 		}
+		quad_lines_.push_back(a);
+
+		// Check if the line needs updating
+		if (lineNeedsUpdate(a))
+			pending_updates_.emplace_back(math::distanceToLine(cam, line->seg()), a);
+	}
+
+	// Update lines, nearest first
+	std::sort(pending_updates_.begin(), pending_updates_.end());
+	for (unsigned a = 0; a < pending_updates_.size(); a++)
+	{
+		if (a > 0 && render_3d_update_ms > 0 && app::runTimer() - update_start_ >= render_3d_update_ms)
+		{
+			updates_pending_ = true;
+			break;
+		}
+
+		updateLine(pending_updates_[a].second);
+		if (walls_vbo)
+			writeLineToWallsVBO(pending_updates_[a].second);
+	}
+
+	for (auto a : quad_lines_)
+	{
+		line = map_->line(a);
+
+		// Skip if the line hasn't been built yet
+		if (lines_[a].line != line)
+			continue;
 
 		// Check for distance fade
 		if (render_max_dist > 0)
-			distfade = calcDistFade(math::distanceToLine(cam_position_.get2d(), line->seg()), render_max_dist);
+			distfade = calcDistFade(math::distanceToLine(cam, line->seg()), render_max_dist);
 		else
 			distfade = 1.0f;
 
-		// Update line if needed
-		update = false;
-		if (lines_[a].updated_time < line->modifiedTime()) // Check line modified
-			update = true;
-		if (lines_[a].line != line)
-			update = true;
-		if (!update && line->s1())
-		{
-			// Check front side/sector modified
-			if (lines_[a].updated_time < line->s1()->modifiedTime()
-				|| lines_[a].updated_time < line->frontSector()->modifiedTime()
-				|| lines_[a].updated_time < line->frontSector()->geometryUpdatedTime())
-				update = true;
-		}
-		if (!update && line->s2())
-		{
-			// Check back side/sector modified
-			if (lines_[a].updated_time < line->s2()->modifiedTime()
-				|| lines_[a].updated_time < line->backSector()->modifiedTime()
-				|| lines_[a].updated_time < line->backSector()->geometryUpdatedTime())
-				update = true;
-		}
-		if (update)
-		{
-			updateLine(a);
-			// updates++;
-			// if (updates > 500)
-			//	break;
-		}
+		// Write to the walls VBO if needed
+		if (walls_vbo && lines_[a].vbo_size < lines_[a].quads.size() * 4)
+			writeLineToWallsVBO(a);
 
 		// Determine quads to be drawn
 		for (auto& quad : lines_[a].quads)
 		{
 			// Check we're on the right side of the quad
-			if (math::lineSide(
-					cam_position_.get2d(),
-					Seg2d(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y))
-				< 0)
+			if (math::lineSide(cam, Seg2d(quad.points[0].x, quad.points[0].y, quad.points[2].x, quad.points[2].y)) < 0)
 				continue;
 
 			quads_[n_quads_] = &quad;
@@ -2765,6 +3454,10 @@ void MapRenderer3D::checkVisibleQuads()
 			n_quads_++;
 		}
 	}
+
+	// Upload any modified walls VBO data
+	if (walls_vbo)
+		updateWallsVBO();
 }
 
 // -----------------------------------------------------------------------------
@@ -2776,12 +3469,13 @@ void MapRenderer3D::checkVisibleFlats()
 	if (!flats_)
 		flats_ = new Flat*[map_->nSectors() * 2];
 
-	// Go through sectors
+	// Go through sectors, finding those in view and those that need updating
 	MapSector* sector;
 	n_flats_ = 0;
 	float alpha;
 	auto  cam = cam_position_.get2d();
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	pending_updates_.clear();
+	for (auto a : vis_sectors_)
 	{
 		sector = map_->sector(a);
 
@@ -2803,9 +3497,33 @@ void MapRenderer3D::checkVisibleFlats()
 			}
 		}
 
-		// Update sector info if needed
-		if (floors_[a].updated_time < sector->modifiedTime() || floors_[a].updated_time < sector->geometryUpdatedTime())
-			updateSector(a);
+		// Check if the sector info needs updating
+		if (sectorNeedsUpdate(a))
+			pending_updates_.emplace_back(math::distance(cam, sector->boundingBox().mid()), a);
+	}
+
+	// Update sectors, nearest first (using up to half of the time limit, the
+	// rest is left for walls). Any that haven't been built yet are hidden
+	std::sort(pending_updates_.begin(), pending_updates_.end());
+	for (unsigned a = 0; a < pending_updates_.size(); a++)
+	{
+		auto index = pending_updates_[a].second;
+		if (a > 0 && render_3d_update_ms > 0 && app::runTimer() - update_start_ >= render_3d_update_ms / 2)
+		{
+			updates_pending_ = true;
+			if (floors_[index].sector != map_->sector(index))
+				dist_sectors_[index] = -1;
+			continue;
+		}
+
+		updateSector(index);
+	}
+
+	for (auto a : vis_sectors_)
+	{
+		// Skip if invisible
+		if (dist_sectors_[a] < 0 || (render_max_dist > 0 && dist_sectors_[a] > render_max_dist))
+			continue;
 
 		// Set distance fade alpha
 		if (render_max_dist > 0)
@@ -2818,7 +3536,7 @@ void MapRenderer3D::checkVisibleFlats()
 		// Add floor flat
 		flats_[n_flats_++] = &(floors_[a]);
 	}
-	for (unsigned a = 0; a < map_->nSectors(); a++)
+	for (auto a : vis_sectors_)
 	{
 		// Skip if invisible
 		if (dist_sectors_[a] < 0)
@@ -2829,6 +3547,170 @@ void MapRenderer3D::checkVisibleFlats()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the walls for line [index] need to be (re)built
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::lineNeedsUpdate(unsigned index) const
+{
+	auto  line = map_->line(index);
+	auto& info = lines_[index];
+
+	// Check line modified
+	if (info.line != line || info.updated_time < line->modifiedTime())
+		return true;
+
+	// Check if built before its textures were loaded
+	if (info.pending_tex && info.updated_time < mapeditor::textureManager().pendingLoadedTime())
+		return true;
+
+	// Check front side/sector modified
+	if (line->s1()
+		&& (info.updated_time < line->s1()->modifiedTime() || info.updated_time < line->frontSector()->modifiedTime()
+			|| info.updated_time < line->frontSector()->geometryUpdatedTime()))
+		return true;
+
+	// Check back side/sector modified
+	if (line->s2()
+		&& (info.updated_time < line->s2()->modifiedTime() || info.updated_time < line->backSector()->modifiedTime()
+			|| info.updated_time < line->backSector()->geometryUpdatedTime()))
+		return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the flats for sector [index] need to be (re)built
+// -----------------------------------------------------------------------------
+bool MapRenderer3D::sectorNeedsUpdate(unsigned index) const
+{
+	auto  sector = map_->sector(index);
+	auto& floor  = floors_[index];
+
+	return floor.updated_time < sector->modifiedTime() || floor.updated_time < sector->geometryUpdatedTime()
+		   || (floor.pending_tex && floor.updated_time < mapeditor::textureManager().pendingLoadedTime());
+}
+
+// -----------------------------------------------------------------------------
+// Finds sectors that are likely to become visible soon, up to
+// render_3d_prefetch_depth sectors beyond the currently visible ones in the
+// direction the camera is moving (or facing if it isn't moving). Their
+// textures are queued for low priority loading, and their flats and walls
+// are built with any update time left over this frame
+// -----------------------------------------------------------------------------
+void MapRenderer3D::prefetch()
+{
+	if (render_3d_prefetch_depth <= 0)
+		return;
+
+	PROFILE_SCOPE("MapRenderer3D::prefetch");
+
+	// Estimate camera velocity (units/ms), smoothed over a few frames
+	auto cam  = cam_position_.get2d();
+	auto time = app::runTimer();
+	if (time > prefetch_time_)
+	{
+		if (prefetch_time_ > 0)
+			cam_velocity_ = cam_velocity_ * 0.5 + (cam - prefetch_cam_) * (0.5 / (time - prefetch_time_));
+		prefetch_cam_  = cam;
+		prefetch_time_ = time;
+	}
+
+	// Prefetch in the direction of movement if moving, otherwise facing
+	auto dir = cam_velocity_.magnitude() > 0.05 ? cam_velocity_.normalized() : cam_direction_;
+
+	// Find sectors to prefetch if the camera has moved or turned enough since
+	// last time, or the map has changed
+	if (prefetch_sectors_updated_ < map_->geometryUpdated() || math::distance(cam, prefetch_origin_) > 64
+		|| dir.dot(prefetch_dir_) < 0.9)
+	{
+		prefetch_origin_          = cam;
+		prefetch_dir_             = dir;
+		prefetch_sectors_updated_ = time;
+
+		// Flood fill out from the visible sectors through lines ahead of the
+		// camera, one level per pass
+		vector<uint8_t>  visited(map_->nSectors(), 0);
+		vector<unsigned> level;
+		for (auto a : vis_sectors_)
+			if (dist_sectors_[a] >= 0)
+			{
+				visited[a] = 1;
+				level.push_back(a);
+			}
+		prefetch_sectors_.clear();
+		for (int depth = 0; depth < render_3d_prefetch_depth && !level.empty(); depth++)
+		{
+			vector<unsigned> next;
+			for (auto index : level)
+			{
+				for (auto side : map_->sector(index)->connectedSides())
+				{
+					auto line  = side->parentLine();
+					auto other = side == line->s1() ? line->backSector() : line->frontSector();
+					if (!other || visited[other->index()])
+						continue;
+
+					// Check the line is ahead and can be seen through
+					if ((line->seg().middle() - cam).dot(dir) <= 0 || openingClosed(line))
+						continue;
+
+					visited[other->index()] = 1;
+					next.push_back(other->index());
+				}
+			}
+			prefetch_sectors_.insert(prefetch_sectors_.end(), next.begin(), next.end());
+			level.swap(next);
+		}
+
+		// Queue their textures
+		auto& textures = mapeditor::textureManager();
+		bool  mixed    = game::configuration().featureSupported(game::Feature::MixTexFlats);
+		for (auto index : prefetch_sectors_)
+		{
+			auto sector = map_->sector(index);
+			textures.prefetchFlat(sector->floor().texture, mixed);
+			textures.prefetchFlat(sector->ceiling().texture, mixed);
+			for (auto side : sector->connectedSides())
+				for (const auto& tex : { side->texUpper(), side->texMiddle(), side->texLower() })
+					if (tex != MapSide::TEX_NONE)
+						textures.prefetchTexture(tex, mixed);
+		}
+	}
+
+	// Build prefetched flats and walls once their textures are loaded, if
+	// everything visible is up to date and there is update time left
+	if (updates_pending_ || mapeditor::textureManager().prefetching())
+		return;
+	bool walls_vbo = gl::vboSupport();
+	bool walls     = false;
+	for (auto index : prefetch_sectors_)
+	{
+		if (render_3d_update_ms > 0 && app::runTimer() - update_start_ >= render_3d_update_ms)
+			break;
+		if (index >= map_->nSectors())
+			continue;
+
+		if (sectorNeedsUpdate(index))
+			updateSector(index);
+
+		for (auto side : map_->sector(index)->connectedSides())
+		{
+			auto line = side->parentLine()->index();
+			if (!lineNeedsUpdate(line))
+				continue;
+
+			updateLine(line);
+			if (walls_vbo)
+				writeLineToWallsVBO(line);
+			walls = true;
+		}
+	}
+
+	// Upload any modified walls VBO data
+	if (walls && walls_vbo)
+		updateWallsVBO();
+}
+
 // -----------------------------------------------------------------------------
 // Finds the closest wall/flat/thing to the camera along the view vector
 // -----------------------------------------------------------------------------
@@ -2844,13 +3726,11 @@ mapeditor::Item MapRenderer3D::determineHilight()
 		|| things_.size() != map_->nThings())
 		return current;
 
-	// Check lines
+	// Checks the visible quads of line [a] for intersection
 	double height, dist;
-	for (unsigned a = 0; a < map_->nLines(); a++)
-	{
-		// Ignore if not visible
+	auto   check_line = [&](unsigned a) {
 		if (!lines_[a].visible)
-			continue;
+			return;
 
 		auto line = map_->line(a);
 
@@ -2860,7 +3740,7 @@ mapeditor::Item MapRenderer3D::determineHilight()
 
 		// Ignore if no intersection or something was closer
 		if (dist < 0 || dist >= min_dist)
-			continue;
+			return;
 
 		// Find quad intersect if any
 		auto intersection = cam_position_ + cam_dir3d_ * dist;
@@ -2903,14 +3783,13 @@ mapeditor::Item MapRenderer3D::determineHilight()
 				min_dist = dist;
 			}
 		}
-	}
+	};
 
-	// Check sectors
-	for (unsigned a = 0; a < map_->nSectors(); a++)
-	{
+	// Checks the floor and ceiling of sector [a] for intersection
+	auto check_sector = [&](unsigned a) {
 		// Ignore if not visible
 		if (dist_sectors_[a] < 0)
-			continue;
+			return;
 
 		// Check distance to floor plane
 		dist = math::distanceRayPlane(cam_position_, cam_dir3d_, floors_[a].plane);
@@ -2945,32 +3824,23 @@ mapeditor::Item MapRenderer3D::determineHilight()
 				}
 			}
 		}
-	}
-
-	// Update item distance
-	if (min_dist >= 9999999 || min_dist < 0)
-		item_dist_ = -1;
-	else
-		item_dist_ = math::round(min_dist);
+	};
 
-	// Check things (if visible)
-	if (render_3d_things == 0)
-		return current;
+	// Checks the sprite of thing [a] for intersection
 	double halfwidth, theight;
-	for (unsigned a = 0; a < map_->nThings(); a++)
-	{
+	auto   check_thing = [&](unsigned a) {
 		// Ignore if no sprite
 		if (!things_[a].sprite)
-			continue;
+			return;
 
 		// Ignore if not visible
 		auto thing = map_->thing(a);
 		if (math::lineSide(thing->position(), strafe) > 0)
-			continue;
+			return;
 
 		// Ignore if not shown
 		if (!things_[a].type->decoration() && render_3d_things == 2)
-			continue;
+			return;
 
 		// Find distance to thing sprite
 		auto& tex_info = gl::Texture::info(things_[a].sprite);
@@ -2985,7 +3855,7 @@ mapeditor::Item MapRenderer3D::determineHilight()
 
 		// Ignore if no intersection or something was closer
 		if (dist < 0 || dist >= min_dist)
-			continue;
+			return;
 
 		// Check intersection height
 		theight = tex_info.size.y;
@@ -2998,6 +3868,74 @@ mapeditor::Item MapRenderer3D::determineHilight()
 			current.type  = mapeditor::ItemType::Thing;
 			min_dist      = dist;
 		}
+	};
+
+	// Rather than checking everything visible, go along the view ray in steps
+	// of (up to) 256 map units in 2d, only checking the lines, sectors and
+	// things in the area of each step. The ray can only hit a sector's flats
+	// after crossing one of its lines (or if the camera is in it), and once
+	// something is hit within a step nothing further along can be closer
+	auto   cam      = cam_position_.get2d();
+	auto   dir      = cam_dir3d_.get2d();
+	double dir_len  = dir.magnitude();
+	auto   bounds   = map_->bounds();
+	double max_dist = 0;
+	for (auto corner : { bounds.min, bounds.max, Vec2d(bounds.min.x, bounds.max.y), Vec2d(bounds.max.x, bounds.min.y) })
+		max_dist = std::max(max_dist, math::distance(cam, corner));
+	double step = 9999999;
+	if (dir_len > 0.0001)
+	{
+		step = 256 / dir_len;
+		max_dist /= dir_len;
+	}
+	else
+		max_dist = step;
+
+	std::set<unsigned> checked_lines, checked_sectors, checked_things;
+	vector<MapLine*>   step_lines;
+	vector<unsigned>   step_things;
+	if (auto sector = cameraSector())
+	{
+		checked_sectors.insert(sector->index());
+		check_sector(sector->index());
+	}
+	for (double start = 0; start < max_dist && start < min_dist; start += step)
+	{
+		// Get step area
+		auto end  = std::min(start + step, max_dist);
+		BBox area;
+		area.extend(cam + dir * start);
+		area.extend(cam + dir * end);
+
+		// Check lines in area, and sectors on either side of them
+		step_lines.clear();
+		map_->lines().putAllInBox(area, step_lines);
+		for (auto line : step_lines)
+		{
+			if (!checked_lines.insert(line->index()).second)
+				continue;
+
+			check_line(line->index());
+			for (auto sector : { line->frontSector(), line->backSector() })
+				if (sector && checked_sectors.insert(sector->index()).second)
+					check_sector(sector->index());
+		}
+
+		// Check things (if visible) near area
+		if (render_3d_things > 0)
+		{
+			area.extend(area.min.x - thing_max_halfwidth_, area.min.y - thing_max_halfwidth_);
+			area.extend(area.max.x + thing_max_halfwidth_, area.max.y + thing_max_halfwidth_);
+			step_things.clear();
+			map_->things().putIndicesInBox(area, step_things);
+			for (auto index : step_things)
+				if (checked_things.insert(index).second)
+					check_thing(index);
+		}
+
+		// Done if anything was hit within this step
+		if (min_dist <= end)
+			break;
 	}
 
 	// Update item distance
@@ -3077,6 +4015,7 @@ void MapRenderer3D::renderHilight(mapeditor::Item hilight, float alpha)
 			return;
 
 		// Render outline
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		for (auto& point : quad->points)
 			glVertex3f(point.x, point.y, point.z);
@@ -3088,6 +4027,7 @@ void MapRenderer3D::renderHilight(mapeditor::Item hilight, float alpha)
 			glCullFace(GL_BACK);
 			col_hilight.a *= 0.3;
 			gl::setColour(col_hilight);
+			gl::countDrawCall();
 			glBegin(GL_QUADS);
 			for (auto& point : quad->points)
 				glVertex3f(point.x, point.y, point.z);
@@ -3113,6 +4053,7 @@ void MapRenderer3D::renderHilight(mapeditor::Item hilight, float alpha)
 		// Render sector outline
 		vector<MapLine*> lines;
 		sector->putLines(lines);
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		for (auto& line : lines)
 		{
@@ -3159,6 +4100,7 @@ void MapRenderer3D::renderHilight(mapeditor::Item hilight, float alpha)
 
 		// Render outline of sprite
 		double z = things_[hilight.index].z;
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		glVertex3f(x1, y1, z + theight);
 		glVertex3f(x1, y1, z);
@@ -3172,6 +4114,7 @@ void MapRenderer3D::renderHilight(mapeditor::Item hilight, float alpha)
 			glCullFace(GL_BACK);
 			col_hilight.a *= 0.3;
 			gl::setColour(col_hilight);
+			gl::countDrawCall();
 			glBegin(GL_QUADS);
 			glVertex3f(x1, y1, z + theight);
 			glVertex3f(x1, y1, z);
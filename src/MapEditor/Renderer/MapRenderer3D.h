@@ -2,11 +2,11 @@
 
 #include "MapEditor/Edit/Edit3D.h"
 #include "SLADEMap/SLADEMap.h"
+#include "Utility/Polygon2D.h"
 
 namespace slade
 {
 class ItemSelection;
-class Polygon2D;
 
 namespace game
 {
@@ -49,10 +49,11 @@ public:
 		GLVertex points[4] = { {}, {}, {}, {} };
 		ColRGBA  colour;
 		ColRGBA  fogcolour;
-		uint8_t  light   = 0;
-		unsigned texture = 0;
-		uint8_t  flags   = 0;
-		float    alpha   = 1.f;
+		uint8_t  light     = 0;
+		unsigned texture   = 0;
+		uint8_t  flags     = 0;
+		float    alpha     = 1.f;
+		unsigned vbo_index = 0; // First vertex in the walls VBO
 
 		Quad() : colour{ 255, 255, 255, 255, 0 } {}
 	};
@@ -62,6 +63,9 @@ public:
 		long         updated_time = 0;
 		bool         visible      = true;
 		MapLine*     line         = nullptr;
+		unsigned     vbo_first    = 0; // Slot in the walls VBO (in vertices)
+		unsigned     vbo_size     = 0;
+		bool         pending_tex  = false; // Built with textures that weren't loaded yet
 	};
 	struct Thing
 	{
@@ -72,19 +76,31 @@ public:
 		float                  height       = 0.f;
 		unsigned               sprite       = 0;
 		long                   updated_time = 0;
+		bool                   pending_tex  = false; // Updated before its sprite was loaded
+		ColRGBA                colour; // Sprite colour and light (see updateThing)
+		uint8_t                light = 255;
+		ColRGBA                fogcolour;
 	};
 	struct Flat
 	{
-		uint8_t    flags = 0;
-		uint8_t    light = 255;
-		ColRGBA    colour;
-		ColRGBA    fogcolour;
-		unsigned   texture = 0;
-		Vec2d      scale;
-		Plane      plane;
-		float      alpha        = 1.f;
-		MapSector* sector       = nullptr;
-		long       updated_time = 0;
+		uint8_t                 flags = 0;
+		uint8_t                 light = 255;
+		ColRGBA                 colour;
+		ColRGBA                 fogcolour;
+		unsigned                texture = 0;
+		Vec2d                   scale;
+		Polygon2D::TexTransform tex_transform; // Applied to map x,y as the texture matrix
+		Plane                   plane;
+		float                   alpha        = 1.f;
+		MapSector*              sector       = nullptr;
+		long                    updated_time = 0;
+		bool                    pending_tex  = false; // Built with textures that weren't loaded yet
+	};
+	struct Camera
+	{
+		Vec3d  position;
+		Vec2d  direction = { 0, 1 };
+		double pitch     = 0.;
 	};
 
 	MapRenderer3D(SLADEMap* map = nullptr);
@@ -92,6 +108,7 @@ public:
 
 	bool fullbrightEnabled() const { return fullbright_; }
 	bool fogEnabled() const { return fog_; }
+	bool updatesPending() const { return updates_pending_; }
 	void enableFullbright(bool enable = true) { fullbright_ = enable; }
 	void enableFog(bool enable = true) { fog_ = enable; }
 	int  itemDistance() const { return item_dist_; }
@@ -119,16 +136,24 @@ public:
 	void cameraApplyGravity(double mult);
 	void cameraLook(double xrel, double yrel);
 
+	Camera camera() const { return { cam_position_, cam_direction_, cam_pitch_ }; }
+	void   setCamera(const Camera& camera);
+
+	MapSector* cameraSector();
+
 	double camPitch() const { return cam_pitch_; }
 	Vec3d  camPosition() const { return cam_position_; }
 	Vec2d  camDirection() const { return cam_direction_; }
 
 	// -- Rendering --
-	void setupView(int width, int height);
-	void setLight(ColRGBA& colour, uint8_t light, float alpha = 1.0f) const;
-	void setFog(ColRGBA& fogcol, uint8_t light);
-	void renderMap();
-	void renderSkySlice(
+	void    setupView(int width, int height);
+	void    setLight(ColRGBA& colour, uint8_t light, float alpha = 1.0f) const;
+	ColRGBA lightColour(const ColRGBA& colour, uint8_t light, float alpha = 1.0f) const;
+	void    setFog(ColRGBA& fogcol, uint8_t light);
+	void    renderMap();
+	void    renderView(const Camera& camera, int width, int height);
+	void    beginFrame() { ++frame_; }
+	void    renderSkySlice(
 		float top,
 		float bottom,
 		float atop,
@@ -136,13 +161,14 @@ public:
 		float size,
 		float tx = 0.125f,
 		float ty = 2.0f) const;
-	void renderSky();
+	void    renderSky();
 
 	// Flats
-	void updateFlatTexCoords(unsigned index, bool floor);
+	void updateFlatTexTransform(unsigned index, bool floor);
 	void updateSector(unsigned index);
 	void renderFlat(Flat* flat);
 	void renderFlats();
+	void renderFlatsVBO();
 	void renderFlatSelection(const ItemSelection& selection, float alpha = 1.0f) const;
 
 	// Walls
@@ -159,8 +185,11 @@ public:
 		double sx        = 1,
 		double sy        = 1) const;
 	void updateLine(unsigned index);
+	void setupQuadRendering(Quad* quad, float alpha);
+	void resetQuadRendering(const Quad* quad) const;
 	void renderQuad(Quad* quad, float alpha = 1.0f);
 	void renderWalls();
+	void renderWallsVBO();
 	void renderTransparentWalls();
 	void renderWallSelection(const ItemSelection& selection, float alpha = 1.0f);
 
@@ -171,13 +200,19 @@ public:
 
 	// VBO stuff
 	void updateFlatsVBO();
-	void updateWallsVBO() const;
+	void writeLineToWallsVBO(unsigned index);
+	void updateWallsVBO();
+	void updateSharedData();
 
 	// Visibility checking
 	void  quickVisDiscard();
+	bool  floodVisibleSectors();
 	float calcDistFade(double distance, double max = -1) const;
 	void  checkVisibleQuads();
 	void  checkVisibleFlats();
+	bool  lineNeedsUpdate(unsigned index) const;
+	bool  sectorNeedsUpdate(unsigned index) const;
+	void  prefetch();
 
 	// Hilight
 	mapeditor::Item determineHilight();
@@ -196,7 +231,31 @@ private:
 	float     fog_depth_last_ = 0.f;
 
 	// Visibility
-	vector<float> dist_sectors_;
+	vector<float>    dist_sectors_;
+	vector<unsigned> vis_sectors_; // Sectors that may be visible (sorted)
+	vector<unsigned> vis_lines_;   // Lines of visible sectors (sorted)
+	vector<unsigned> quad_lines_;  // Visible lines in front of the camera
+
+	// Flats/walls that need updating this frame (distance from camera, index)
+	vector<std::pair<double, unsigned>> pending_updates_;
+	long                                update_start_    = 0;
+	bool                                updates_pending_ = false;
+
+	// Frames (see beginFrame), the update time limit is shared by all views
+	// rendered in the same frame
+	unsigned long frame_        = 1;
+	unsigned long update_frame_ = 0;
+	bool          render_view_  = false; // True while rendering from another camera (see renderView)
+
+	// Sectors ahead of the camera to prefetch textures and geometry for (see
+	// prefetch), and the camera position/direction they were found from
+	vector<unsigned> prefetch_sectors_;
+	long             prefetch_sectors_updated_ = -1;
+	Vec2d            prefetch_origin_;
+	Vec2d            prefetch_dir_;
+	Vec2d            prefetch_cam_; // Camera position and time last frame, for velocity
+	long             prefetch_time_ = 0;
+	Vec2d            cam_velocity_;
 
 	// Camera
 	Vec3d  cam_position_;
@@ -208,11 +267,18 @@ private:
 	double gravity_   = 0.5;
 	int    item_dist_ = 0;
 
+	// Cached camera sector (see cameraSector)
+	MapSector* cam_sector_       = nullptr;
+	unsigned   cam_sector_index_ = 0;
+	Vec2d      cam_sector_pos_;
+	long       cam_sector_time_ = -1;
+
 	// Map Structures
 	vector<Line>  lines_;
 	Quad**        quads_ = nullptr;
 	vector<Quad*> quads_transparent_;
 	vector<Thing> things_;
+	double        thing_max_halfwidth_ = 0.; // Largest thing sprite half-width
 	vector<Flat>  floors_;
 	vector<Flat>  ceilings_;
 	Flat**        flats_ = nullptr;
@@ -222,6 +288,31 @@ private:
 	unsigned vbo_ceilings_ = 0;
 	unsigned vbo_walls_    = 0;
 
+	// When the flat VBOs were last built. Sector polygons' VBO update flags
+	// are also cleared by the 2d renderer, so sector geometry times are
+	// checked as well (see updateSharedData)
+	long     flats_vbo_updated_ = 0;
+	unsigned flats_vbo_sectors_ = 0;
+
+	// Walls VBO data (a copy of what's in the VBO), with a slot for each line
+	// (see Line::vbo_first/size) and the range modified since it was uploaded
+	vector<GLVertex> walls_vbo_data_;
+	unsigned         walls_vbo_capacity_    = 0;
+	unsigned         walls_vbo_dirty_start_ = -1;
+	unsigned         walls_vbo_dirty_end_   = 0;
+
+	// Thing sprite quads, rebuilt each frame and streamed to a VBO (if
+	// supported) so visible sprites are drawn with one call per texture/fog
+	struct SpriteVertex
+	{
+		float   x, y, z;
+		float   u, v;
+		uint8_t r, g, b, a;
+	};
+	vector<SpriteVertex>               sprite_vertices_;
+	vector<std::pair<unsigned, float>> vis_things_; // Index and distance fade
+	unsigned                           vbo_sprites_ = 0;
+
 	// Sky
 	struct GLVertexEx
 	{
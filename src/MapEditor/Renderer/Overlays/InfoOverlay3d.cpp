@@ -439,7 +439,7 @@ void InfoOverlay3D::update(int item_index, mapeditor::ItemType item_type, SLADEM
 
 
 		// Type
-		auto& tt = game::configuration().thingType(thing->type());
+		auto& tt = thing->typeInfo();
 		if (!tt.defined())
 			info2_.push_back(fmt::format("Type: {}", thing->type()));
 		else
@@ -463,7 +463,7 @@ void InfoOverlay3D::update(int item_index, mapeditor::ItemType item_type, SLADEM
 		}
 
 		// Sector
-		auto sector = map->sectors().atPos(thing->position());
+		auto sector = map->thingSector(thing);
 		if (sector)
 			info2_.emplace_back(fmt::format("In Sector #{}", sector->index()));
 		else
@@ -324,6 +324,7 @@ void QuickTextureOverlay3d::drawTexture(unsigned index, double x, double bottom,
 		textures_[index].texture, x - 48 * size, bottom - (96 * size), x + 48 * size, bottom, 0, 2);
 	glColor4f(brightness, brightness, brightness, brightness * fade);
 	gl::Texture::bind(textures_[index].texture);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2f(0.0f, 0.0f);
 	glVertex2d(rect.x1(), rect.y1());
@@ -83,7 +83,7 @@ void ThingInfoOverlay::update(MapThing* thing)
 	auto map_format = mapeditor::editContext().mapDesc().format;
 
 	// Index + type
-	auto& tt   = game::configuration().thingType(thing->type());
+	auto& tt   = thing->typeInfo();
 	auto  type = fmt::format("{} (Type {})", tt.name(), thing->type());
 	if (global::debug)
 		info_text += fmt::format("Thing #{} ({}): {}\n", thing->index(), thing->objId(), type);
@@ -231,6 +231,7 @@ void ThingInfoOverlay::draw(int bottom, int right, float alpha)
 			theight = 64;
 		}
 		gl::Texture::bind(tex);
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glTexCoord2f(0.0f, 0.0f);
 		glVertex2d(right - 8 - twidth, bottom - 8 - theight);
@@ -38,10 +38,12 @@
 #include "General/ColourConfiguration.h"
 #include "MapEditor/Edit/LineDraw.h"
 #include "MapEditor/MapEditContext.h"
+#include "MapEditor/UI/MapCanvas.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/OpenGL.h"
 #include "Overlays/MCOverlay.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 
 using namespace slade;
 using namespace mapeditor;
@@ -105,6 +107,17 @@ void Renderer::forceUpdate()
 	renderer_3d_.clearData();
 }
 
+// -----------------------------------------------------------------------------
+// Starts a new frame, called once per map editor update however many views of
+// the map are drawn. Map data shared by the views is only updated once within
+// the 3d renderer's time limit each frame
+// -----------------------------------------------------------------------------
+void Renderer::beginFrame()
+{
+	++frame_;
+	renderer_3d_.beginFrame();
+}
+
 // -----------------------------------------------------------------------------
 // Scrolls the view to be centered on map coordinates [x,y]
 // -----------------------------------------------------------------------------
@@ -298,7 +311,7 @@ void Renderer::setCameraThing(MapThing* thing)
 {
 	// Determine position
 	Vec3d pos(thing->position(), 40);
-	auto  sector = context_.map().sectors().atPos(thing->position());
+	auto  sector = context_.map().thingSector(thing);
 	if (sector)
 		pos.z += sector->floor().plane.heightAt(pos.x, pos.y);
 
@@ -360,6 +373,7 @@ void Renderer::drawGrid() const
 		int ofs = start_x % gridsize;
 		for (int x = start_x - ofs; x <= end_x; x += gridsize)
 		{
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 			glVertex2d(x, start_y);
 			glVertex2d(x, end_y);
@@ -370,6 +384,7 @@ void Renderer::drawGrid() const
 		ofs = start_y % gridsize;
 		for (int y = start_y - ofs; y <= end_y; y += gridsize)
 		{
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 			glVertex2d(start_x, y);
 			glVertex2d(end_x, y);
@@ -383,6 +398,7 @@ void Renderer::drawGrid() const
 		glEnable(GL_LINE_SMOOTH);
 		glLineWidth(3.0f);
 
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(0, start_y);
 		glVertex2d(0, end_y);
@@ -411,6 +427,7 @@ void Renderer::drawGrid() const
 		int ofs = start_x % 64;
 		for (int x = start_x - ofs; x <= end_x; x += 64)
 		{
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 
 			if (grid_64_style > 1)
@@ -438,6 +455,7 @@ void Renderer::drawGrid() const
 		ofs = start_y % 64;
 		for (int y = start_y - ofs; y <= end_y; y += 64)
 		{
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 
 			if (grid_64_style > 1)
@@ -484,6 +502,7 @@ void Renderer::drawGrid() const
 
 			gl::setBlend(def.blendMode());
 
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 			gl::setColour(col);
 			glVertex2d(x + one, y);
@@ -512,6 +531,7 @@ void Renderer::drawGrid() const
 		{
 			gl::setColour(col, def.blendMode());
 
+			gl::countDrawCall();
 			glBegin(GL_LINES);
 			glVertex2d(x, view_.mapBounds().tl.y);
 			glVertex2d(x, view_.mapBounds().br.y);
@@ -534,6 +554,7 @@ void Renderer::drawEditorMessages() const
 	auto col_bg = colourconfig::colour("map_editor_message_outline");
 	drawing::setTextState(true);
 	drawing::enableTextStateReset(false);
+	drawing::beginTextBatch();
 
 	// Go through editor messages
 	for (unsigned a = 0; a < context_.numEditorMessages(); a++)
@@ -567,6 +588,43 @@ void Renderer::drawEditorMessages() const
 
 		yoff += 16;
 	}
+	drawing::endTextBatch();
+	drawing::setTextOutline(0);
+	drawing::setTextState(false);
+	drawing::enableTextStateReset(true);
+}
+
+// -----------------------------------------------------------------------------
+// Draws the profiler timings for the last frame, if profiling is enabled
+// -----------------------------------------------------------------------------
+void Renderer::drawProfilerOverlay() const
+{
+	if (!profiler::enabled())
+		return;
+
+	auto col    = colourconfig::colour("map_editor_message");
+	auto col_bg = colourconfig::colour("map_editor_message_outline");
+	col_bg.a    = 255;
+	drawing::setTextState(true);
+	drawing::enableTextStateReset(false);
+	drawing::setTextOutline(1.0f, col_bg);
+	drawing::beginTextBatch();
+
+	// Draw the timing of each scope down the left side
+	auto stats = profiler::frameStats();
+	int  yoff  = view_.size().y / 2;
+	for (const auto& stat : stats)
+	{
+		drawing::drawText(
+			fmt::format("{:>8.3f}ms {:>4}x {}", stat.total_ms, stat.count, stat.name),
+			4,
+			yoff,
+			col,
+			drawing::Font::Monospace);
+		yoff += 16;
+	}
+
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::setTextState(false);
 	drawing::enableTextStateReset(true);
@@ -595,6 +653,7 @@ void Renderer::drawFeatureHelpText() const
 	glDisable(GL_TEXTURE_2D);
 	glLineWidth(1.0f);
 	gl::setColour(col);
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(bounds.right() + 8, bounds.bottom() + 1);
 	glVertex2d(bounds.left() + 16, bounds.bottom() + 1);
@@ -607,11 +666,13 @@ void Renderer::drawFeatureHelpText() const
 	int yoff = 22;
 	drawing::setTextState(true);
 	drawing::enableTextStateReset(false);
+	drawing::beginTextBatch();
 	for (unsigned a = 1; a < help_lines.size(); a++)
 	{
 		drawing::drawText(help_lines[a], view_.size().x - 2, yoff, col, drawing::Font::Bold, drawing::Align::Right);
 		yoff += 16;
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::setTextState(false);
 	drawing::enableTextStateReset(true);
@@ -635,12 +696,13 @@ void Renderer::drawSelectionNumbers() const
 	drawing::enableTextStateReset(false);
 	drawing::setTextState(true);
 	view_.setOverlayCoords(true);
-#if USE_SFML_RENDERWINDOW && ((SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR >= 4) || SFML_VERSION_MAJOR > 2)
-	drawing::setTextOutline(1.0f, ColRGBA::BLACK);
-#else
+#if USE_SFML_RENDERWINDOW && SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR < 4
 	if (context_.selection().size() <= map_max_selection_numbers * 0.5)
 		drawing::setTextOutline(1.0f, ColRGBA::BLACK);
+#else
+	drawing::setTextOutline(1.0f, ColRGBA::BLACK);
 #endif
+	drawing::beginTextBatch();
 	for (unsigned a = 0; a < selection.size(); a++)
 	{
 		if ((int)a > map_max_selection_numbers)
@@ -664,8 +726,9 @@ void Renderer::drawSelectionNumbers() const
 		}
 
 		// Draw text
-		drawing::drawText(fmt::format("{}", a + 1), tp.x, tp.y, col, drawing::Font::Bold);
+		drawing::drawText(text, tp.x, tp.y, col, drawing::Font::Bold);
 	}
+	drawing::endTextBatch();
 	drawing::setTextOutline(0);
 	drawing::enableTextStateReset();
 	drawing::setTextState(false);
@@ -691,6 +754,7 @@ void Renderer::drawThingQuickAngleLines() const
 	// Draw lines
 	auto mouse_pos_m = view_.mapPos(context_.input().mousePos(), true);
 	glLineWidth(2.0f);
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	for (auto& thing : selection)
 	{
@@ -735,30 +799,9 @@ void Renderer::drawLineDrawLines(bool snap_nearest_vertex) const
 	auto col = colourconfig::colour("map_linedraw");
 	gl::setColour(col);
 
-	// Determine end point
-	auto end = view_.mapPos(context_.input().mousePos(), true);
-	if (snap_nearest_vertex)
-	{
-		// If shift is held down, snap to the nearest vertex (if any)
-		auto vertex = context_.map().vertices().nearest(end);
-		if (vertex)
-		{
-			end.x = vertex->xPos();
-			end.y = vertex->yPos();
-		}
-		else if (context_.gridSnap())
-		{
-			// No nearest vertex, snap to grid if needed
-			end.x = context_.snapToGrid(end.x);
-			end.y = context_.snapToGrid(end.y);
-		}
-	}
-	else if (context_.gridSnap())
-	{
-		// Otherwise, snap to grid if needed
-		end.x = context_.snapToGrid(end.x);
-		end.y = context_.snapToGrid(end.y);
-	}
+	// Determine end point (snapped to the nearest vertex if shift is held
+	// down, otherwise the grid if needed)
+	auto end = context_.lineDraw().snapPoint(view_.mapPos(context_.input().mousePos(), true), snap_nearest_vertex);
 
 	// Draw lines
 	auto& line_draw = context_.lineDraw();
@@ -774,6 +817,7 @@ void Renderer::drawLineDrawLines(bool snap_nearest_vertex) const
 
 	// Draw line lengths
 	view_.setOverlayCoords(true);
+	drawing::beginTextBatch();
 	if (npoints > 1)
 	{
 		for (int a = 0; a < npoints - 1; a++)
@@ -781,12 +825,14 @@ void Renderer::drawLineDrawLines(bool snap_nearest_vertex) const
 	}
 	if (npoints > 0 && context_.lineDraw().state() == LineDraw::State::Line)
 		drawLineLength(line_draw.point(npoints - 1), end, col);
+	drawing::endTextBatch();
 	view_.setOverlayCoords(false);
 
 	// Draw points
 	glPointSize(vertex_size);
 	if (vertex_round)
 		glEnable(GL_POINT_SMOOTH);
+	gl::countDrawCall();
 	glBegin(GL_POINTS);
 	for (auto& point : line_draw.points())
 		glVertex2d(point.x, point.y);
@@ -826,6 +872,7 @@ void Renderer::drawPasteLines() const
 	// Draw
 	auto pos = context_.relativeSnapToGrid(c->midpoint(), view_.mapPos(context_.input().mousePos(), true));
 	glLineWidth(2.0f);
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	for (unsigned a = 0; a < lines.size(); a++)
 	{
@@ -1133,6 +1180,7 @@ void Renderer::drawMap2d()
 		// Outline
 		colourconfig::setGLColour("map_selbox_outline");
 		glLineWidth(2.0f);
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		glVertex2d(mdx, mdy);
 		glVertex2d(mdx, my);
@@ -1142,6 +1190,7 @@ void Renderer::drawMap2d()
 
 		// Fill
 		colourconfig::setGLColour("map_selbox_fill");
+		gl::countDrawCall();
 		glBegin(GL_QUADS);
 		glVertex2d(mdx, mdy);
 		glVertex2d(mdx, my);
@@ -1179,16 +1228,11 @@ void Renderer::drawMap2d()
 	// Draw moving stuff if needed
 	if (mouse_state == Input::MouseState::Move)
 	{
-		auto& items  = context_.moveObjects().items();
-		auto  offset = context_.moveObjects().offset();
-		switch (context_.editMode())
-		{
-		case Mode::Vertices: renderer_2d_.renderMovingVertices(items, offset); break;
-		case Mode::Lines: renderer_2d_.renderMovingLines(items, offset); break;
-		case Mode::Sectors: renderer_2d_.renderMovingSectors(items, offset); break;
-		case Mode::Things: renderer_2d_.renderMovingThings(items, offset); break;
-		default: break;
-		};
+		auto offset = context_.moveObjects().offset();
+		if (context_.editMode() == Mode::Things)
+			renderer_2d_.renderMovingThings(context_.moveObjects().items(), offset);
+		else
+			renderer_2d_.renderMoving(offset);
 	}
 }
 
@@ -1222,6 +1266,8 @@ void Renderer::drawMap3d()
 // -----------------------------------------------------------------------------
 void Renderer::draw()
 {
+	PROFILE_SCOPE("Renderer::draw");
+
 	// Setup the viewport
 	glViewport(0, 0, view_.size().x, view_.size().y);
 
@@ -1278,6 +1324,7 @@ void Renderer::draw()
 		double midy = view_.size().y * 0.5;
 		int    size = camera_3d_crosshair_size;
 
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		// Right
 		gl::setColour(col);
@@ -1318,22 +1365,19 @@ void Renderer::draw()
 		}
 	}
 
-	// FPS counter
-	/*if (map_showfps)
+	// Frame time stats
+	if (map_showfps && context_.canvas())
 	{
-		glEnable(GL_TEXTURE_2D);
-		if (frametime_last > 0)
-		{
-			int fps = MathStuff::round(1.0 / (frametime_last / 1000.0));
-			fps_avg.push_back(fps);
-			if (fps_avg.size() > 20) fps_avg.erase(fps_avg.begin());
-		}
-		int afps = 0;
-		for (unsigned a = 0; a < fps_avg.size(); a++)
-			afps += fps_avg[a];
-		if (fps_avg.size() > 0) afps /= fps_avg.size();
-		Drawing::drawText(fmt::format("FPS: {}", afps));
-	}*/
+		auto stats = context_.canvas()->frameStats();
+		drawing::setTextState(true);
+		drawing::drawText(
+			fmt::format("Frame time: {:.2f}ms avg, {:.2f}ms max", stats.avg_ms, stats.max_ms),
+			0,
+			0,
+			colourconfig::colour("map_editor_message"),
+			drawing::Font::Monospace);
+		drawing::setTextState(false);
+	}
 
 	// test
 	// Drawing::drawText(fmt::format("Render distance: {:1.2f}", (double)render_max_dist), 0, 100);
@@ -1341,6 +1385,9 @@ void Renderer::draw()
 	// Editor messages
 	drawEditorMessages();
 
+	// Profiler timings
+	drawProfilerOverlay();
+
 	// Help text
 	drawFeatureHelpText();
 }
@@ -1649,7 +1696,7 @@ void Renderer::animateSelectionChange(const mapeditor::Item& item, bool selected
 			return;
 
 		// Get thing type
-		auto& tt = game::configuration().thingType(t->type());
+		auto& tt = t->typeInfo();
 
 		// Start animation
 		double radius = tt.radius();
@@ -23,6 +23,10 @@ namespace mapeditor
 
 		void forceUpdate();
 
+		// Frames (each map editor update), map views are redrawn when this changes
+		unsigned long frame() const { return frame_; }
+		void          beginFrame();
+
 		// View manipulation
 		void   setView(double map_x, double map_y);
 		void   setViewSize(int width, int height);
@@ -55,6 +59,7 @@ namespace mapeditor
 		MapRenderer2D   renderer_2d_;
 		MapRenderer3D   renderer_3d_;
 		RenderView      view_;
+		unsigned long   frame_ = 0;
 
 		// MCAnimations
 		vector<unique_ptr<MCAnimation>> animations_;
@@ -77,6 +82,7 @@ namespace mapeditor
 		// Drawing
 		void drawGrid() const;
 		void drawEditorMessages() const;
+		void drawProfilerOverlay() const;
 		void drawFeatureHelpText() const;
 		void drawSelectionNumbers() const;
 		void drawThingQuickAngleLines() const;
@@ -0,0 +1,316 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    RendererBenchmark.cpp
+// Description: Benchmarks for the map renderers. Draws the map currently open
+//              in the map editor along a scripted 2d pan/zoom path and a 3d
+//              camera flight path, recording frame times and the GL work
+//              (draw calls, texture binds, buffer uploads) of each frame, with
+//              each rendering backend. See Utility/Benchmark.cpp for the
+//              output format
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "RendererBenchmark.h"
+#include "General/Console.h"
+#include "MapEditor/MapEditContext.h"
+#include "MapEditor/MapEditor.h"
+#include "MapEditor/UI/MapCanvas.h"
+#include "OpenGL/OpenGL.h"
+#include "Renderer.h"
+#include "SLADEMap/MapObject/MapSector.h"
+#include "SLADEMap/SLADEMap.h"
+#include "Utility/MathStuff.h"
+#include "Utility/StringUtils.h"
+
+using namespace slade;
+using namespace benchmark;
+using mapeditor::Mode;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Bool, gl_vbo)
+EXTERN_CVAR(Bool, flats_use_vbo)
+EXTERN_CVAR(Bool, walls_use_vbo)
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Rendering backends to compare, selected by the gl_vbo, flats_use_vbo and
+// walls_use_vbo cvars
+struct Backend
+{
+	const char* name;
+	bool        vbo;
+};
+constexpr Backend BACKENDS[] = { { "immediate", false }, { "vbo", true } };
+
+// Max. zoom (relative to the zoom that fits the whole map) on the 2d path
+constexpr double MAX_ZOOM_2D = 16.;
+
+// Number of zoom in/out cycles on the 2d path
+constexpr int ZOOM_CYCLES_2D = 3;
+
+// Max. number of sectors the 3d flight path passes through
+constexpr unsigned FLIGHT_POINTS = 32;
+
+// GL work and time taken for each frame drawn along a path
+struct FrameSamples
+{
+	vector<double> ms;
+	uint64_t       draw_calls    = 0;
+	uint64_t       texture_binds = 0;
+	uint64_t       upload_bytes  = 0;
+};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Draws a single frame on [canvas] and adds its time and GL work to [samples]
+// -----------------------------------------------------------------------------
+void drawFrame(MapCanvas& canvas, FrameSamples& samples)
+{
+	if (!canvas.setActive())
+		return;
+
+	gl::resetCounters();
+	auto start = Clock::now();
+	canvas.draw(); // Waits for the frame to finish (glFinish)
+	samples.ms.push_back(elapsedMs(start));
+
+	const auto& counters = gl::counters();
+	samples.draw_calls += counters.draw_calls;
+	samples.texture_binds += counters.texture_binds;
+	samples.upload_bytes += counters.upload_bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the frame times and GL work in [samples] as [phase] of [corpus] to
+// [results]
+// -----------------------------------------------------------------------------
+void addFrameResults(vector<Result>& results, string_view corpus, string_view phase, const FrameSamples& samples)
+{
+	addSampled(results, corpus, phase, samples.ms);
+
+	auto& result         = results.back();
+	result.bytes         = samples.upload_bytes;
+	result.draw_calls    = samples.draw_calls;
+	result.texture_binds = samples.texture_binds;
+}
+
+// -----------------------------------------------------------------------------
+// Draws [frames] frames in 2d (lines) mode, panning over the map along a
+// lissajous curve while zooming in and out
+// -----------------------------------------------------------------------------
+void benchmark2d(
+	vector<Result>& results,
+	MapEditContext& context,
+	string_view     corpus,
+	string_view     backend,
+	unsigned        frames)
+{
+	auto& renderer = context.renderer();
+	auto& view     = renderer.view();
+	auto  bbox     = context.map().bounds();
+
+	context.setEditMode(Mode::Lines);
+	renderer.viewFitToMap(true);
+	auto fit_scale = view.scale();
+
+	FrameSamples samples;
+	for (unsigned a = 0; a < frames; ++a)
+	{
+		double t    = static_cast<double>(a) / frames;
+		double x    = bbox.midX() + bbox.width() * 0.4 * std::sin(math::PI * 2. * t);
+		double y    = bbox.midY() + bbox.height() * 0.4 * std::sin(math::PI * 4. * t);
+		double zoom = std::pow(MAX_ZOOM_2D, 0.5 - 0.5 * std::cos(math::PI * 2. * ZOOM_CYCLES_2D * t));
+
+		renderer.zoom(fit_scale * zoom / view.scale());
+		renderer.setView(x, y);
+		view.resetInter(true, true, true);
+
+		drawFrame(*context.canvas(), samples);
+	}
+
+	addFrameResults(results, corpus, fmt::format("2d_{}", backend), samples);
+}
+
+// -----------------------------------------------------------------------------
+// Draws [frames] frames in 3d mode, flying the camera (at view height) through
+// the middle of up to FLIGHT_POINTS sectors spread over the map and back to
+// the first
+// -----------------------------------------------------------------------------
+void benchmark3d(
+	vector<Result>& results,
+	MapEditContext& context,
+	string_view     corpus,
+	string_view     backend,
+	unsigned        frames)
+{
+	auto& map      = context.map();
+	auto& renderer = context.renderer().renderer3D();
+
+	// Build flight path
+	vector<Vec2d> points;
+	unsigned      step = std::max(1u, static_cast<unsigned>(map.nSectors()) / FLIGHT_POINTS);
+	for (unsigned a = 0; a < map.nSectors(); a += step)
+		points.push_back(map.sector(a)->boundingBox().mid());
+	if (points.size() < 2)
+	{
+		log::warning("Benchmark: Not enough sectors in the map for a 3d flight path");
+		return;
+	}
+
+	context.setEditMode(Mode::Visual);
+
+	FrameSamples samples;
+	Vec2d        direction{ 1., 0. };
+	for (unsigned a = 0; a < frames; ++a)
+	{
+		double pos   = static_cast<double>(a) / frames * points.size();
+		auto   index = static_cast<unsigned>(pos);
+		auto&  p1    = points[index % points.size()];
+		auto&  p2    = points[(index + 1) % points.size()];
+		if (p1 != p2)
+			direction = (p2 - p1).normalized();
+
+		auto p = p1 + (p2 - p1) * (pos - index);
+		renderer.cameraSet({ p.x, p.y, renderer.camPosition().z }, direction);
+		renderer.cameraApplyGravity(10.);
+
+		drawFrame(*context.canvas(), samples);
+	}
+
+	addFrameResults(results, corpus, fmt::format("3d_{}", backend), samples);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Benchmark Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the 2d and 3d renderer benchmarks on the map open in [context], drawing
+// [frames] frames for each with each rendering backend. The view, camera, edit
+// mode and renderer settings are restored afterwards.
+// Returns the results of each path + backend
+// -----------------------------------------------------------------------------
+vector<Result> benchmark::runRendererBenchmarks(MapEditContext& context, unsigned frames)
+{
+	vector<Result> results;
+	if (!context.canvas() || frames == 0)
+		return results;
+
+	auto& renderer = context.renderer();
+	auto  corpus   = context.mapDesc().name;
+
+	// Save current state
+	bool vbo        = gl_vbo;
+	bool flats_vbo  = flats_use_vbo;
+	bool walls_vbo  = walls_use_vbo;
+	auto edit_mode  = context.editMode();
+	auto view_pos   = renderer.view().offset();
+	auto view_scale = renderer.view().scale();
+	auto cam_pos    = renderer.renderer3D().camPosition();
+	auto cam_dir    = renderer.renderer3D().camDirection();
+
+	for (const auto& backend : BACKENDS)
+	{
+		gl_vbo        = backend.vbo;
+		flats_use_vbo = backend.vbo;
+		walls_use_vbo = backend.vbo;
+		if (backend.vbo && !gl::vboSupport())
+		{
+			log::warning("Benchmark: Skipping {} renderer, not supported", backend.name);
+			continue;
+		}
+
+		// Start each backend with nothing built or uploaded
+		renderer.forceUpdate();
+		benchmark2d(results, context, corpus, backend.name, frames);
+
+		renderer.forceUpdate();
+		benchmark3d(results, context, corpus, backend.name, frames);
+	}
+
+	// Restore previous state
+	gl_vbo        = vbo;
+	flats_use_vbo = flats_vbo;
+	walls_use_vbo = walls_vbo;
+	renderer.forceUpdate();
+	renderer.renderer3D().cameraSet(cam_pos, cam_dir);
+	context.setEditMode(edit_mode);
+	renderer.zoom(view_scale / renderer.view().scale());
+	renderer.setView(view_pos.x, view_pos.y);
+	renderer.view().resetInter(true, true, true);
+
+	return results;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Runs the renderer benchmarks on the map currently open in the map editor
+// and logs the results. Usage:
+// bench_render [frames]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(bench_render, 0, true)
+{
+	if (!mapeditor::windowCreated() || !mapeditor::windowWx()->IsShown() || !mapeditor::editContext().canvas())
+	{
+		log::console("The map editor must be open to run the renderer benchmarks");
+		return;
+	}
+
+	auto frames = args.empty() ? 300 : strutil::asInt(args[0]);
+	logResults(runRendererBenchmarks(mapeditor::editContext(), std::max(frames, 1)));
+}
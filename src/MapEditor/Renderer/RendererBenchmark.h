@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Utility/Benchmark.h"
+
+namespace slade
+{
+class MapEditContext;
+}
+
+namespace slade::benchmark
+{
+vector<Result> runRendererBenchmarks(MapEditContext& context, unsigned frames = 300);
+} // namespace slade::benchmark
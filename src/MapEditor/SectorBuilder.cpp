@@ -48,7 +48,7 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-typedef std::map<MapLine*, int> MapLineSet;
+typedef std::unordered_map<MapLine*, int> MapLineSet;
 
 // -----------------------------------------------------------------------------
 // Finds the next adjacent edge to [edge], ie the adjacent edge that creates the
@@ -314,16 +314,41 @@ bool SectorBuilder::pointWithinOutline(double x, double y)
 // -----------------------------------------------------------------------------
 void SectorBuilder::discardOutsideVertices()
 {
+	// Vertices outside the outline bbox are either all kept (anticlockwise) or
+	// all discarded (clockwise), so only vertices within it need checking
+	vector<MapVertex*>  in_bbox;
+	vector<MapVertex*>* vertices = &inner_vertices_;
+	if (!outmost_found_)
+	{
+		map_->vertices().putAllInBox(o_bbox_, in_bbox);
+		vertices = &in_bbox;
+	}
+
 	// Go through valid vertices list
-	for (unsigned a = 0; a < vertex_valid_.size(); a++)
+	unsigned kept = 0;
+	for (auto vertex : *vertices)
 	{
 		// Skip if already discarded
-		if (!vertex_valid_[a])
+		if (!vertex_valid_[vertex->index()])
 			continue;
 
 		// Discard if outside the current outline
-		if (!pointWithinOutline(map_->vertex(a)->xPos(), map_->vertex(a)->yPos()))
-			vertex_valid_[a] = false;
+		if (!pointWithinOutline(vertex->xPos(), vertex->yPos()))
+		{
+			vertex_valid_[vertex->index()] = false;
+			continue;
+		}
+
+		(*vertices)[kept++] = vertex;
+	}
+	vertices->resize(kept);
+
+	// If the outline is clockwise it's the outmost one, everything outside
+	// its bbox is now discarded
+	if (!outmost_found_ && o_clockwise_)
+	{
+		outmost_found_  = true;
+		inner_vertices_ = std::move(in_bbox);
 	}
 }
 
@@ -346,10 +371,14 @@ SectorBuilder::Edge SectorBuilder::findOuterEdge() const
 	// LOG_DEBUG("Finding outer edge from vertex", vertex_right, "at", vertex_right->point());
 
 	// Fire a ray east from the vertex and find the first line it crosses
-	MapLine* line = nullptr;
-	for (unsigned a = 0; a < map_->nLines(); a++)
+	// (only lines with a bbox overlapping the ray can)
+	BBox ray;
+	ray.min = { vr_x, vr_y };
+	ray.max = { std::numeric_limits<double>::max(), vr_y };
+	vector<MapLine*> lines;
+	map_->lines().putAllInBox(ray, lines);
+	for (auto line : lines)
 	{
-		line = map_->line(a);
 
 		// Ignore if the line is completely left of the vertex
 		if (line->x1() <= vr_x && line->x2() <= vr_x)
@@ -412,22 +441,24 @@ SectorBuilder::Edge SectorBuilder::findInnerEdge()
 {
 	// Find rightmost non-discarded vertex
 	vertex_right_ = nullptr;
-	for (unsigned a = 0; a < vertex_valid_.size(); a++)
-	{
+	auto find_rightmost = [this](MapVertex* vertex) {
 		// Ignore if discarded
-		if (!vertex_valid_[a])
-			continue;
-
-		// Set rightmost if no current rightmost vertex
-		if (!vertex_right_)
-		{
-			vertex_right_ = map_->vertex(a);
-			continue;
-		}
-
-		// Check if the vertex is rightmost
-		if (map_->vertex(a)->xPos() > vertex_right_->xPos())
-			vertex_right_ = map_->vertex(a);
+		if (!vertex_valid_[vertex->index()])
+			return;
+
+		// Check if the vertex is rightmost (or no current rightmost vertex)
+		if (!vertex_right_ || vertex->xPos() > vertex_right_->xPos())
+			vertex_right_ = vertex;
+	};
+	if (outmost_found_)
+	{
+		for (auto vertex : inner_vertices_)
+			find_rightmost(vertex);
+	}
+	else
+	{
+		for (auto vertex : map_->vertices())
+			find_rightmost(vertex);
 	}
 
 	// If no vertex was found, we're done
@@ -608,9 +639,9 @@ bool SectorBuilder::traceSector(SLADEMap* map, MapLine* line, bool front)
 	error_ = "Unknown error";
 
 	// Create valid vertices list
-	vertex_valid_.clear();
-	for (unsigned a = 0; a < map->nVertices(); a++)
-		vertex_valid_.push_back(true);
+	vertex_valid_.assign(map->nVertices(), true);
+	outmost_found_ = false;
+	inner_vertices_.clear();
 
 	// Find outmost outline
 	for (unsigned a = 0; a < 10000; a++)
@@ -52,6 +52,11 @@ private:
 	vector<Edge> sector_edges_;
 	string       error_;
 
+	// Once the outmost outline is found, only the vertices within it (in index
+	// order) need to be considered when discarding vertices
+	bool               outmost_found_ = false;
+	vector<MapVertex*> inner_vertices_;
+
 	// Current outline
 	vector<Edge> o_edges_;
 	bool         o_clockwise_ = false;
@@ -37,6 +37,7 @@
 #include "MapEditor/MapEditor.h"
 #include "MapEditor/MapTextureManager.h"
 #include "SLADEMap/SLADEMap.h"
+#include "UI/Browser/Thumbnails.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -54,6 +55,26 @@ const wxString MapTexBrowserItem::TEXTURE = "texture";
 const wxString MapTexBrowserItem::FLAT    = "flat";
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the index of the last texture in [textures] with each name
+// -----------------------------------------------------------------------------
+std::unordered_map<string, unsigned> lastIndicesByName(const vector<MapTextureManager::TexInfo>& textures)
+{
+	std::unordered_map<string, unsigned> last;
+	for (unsigned a = 0; a < textures.size(); a++)
+		last[textures[a].short_name] = a;
+	return last;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapTexBrowserItem Class Functions
@@ -95,6 +116,22 @@ bool MapTexBrowserItem::loadImage()
 		return false;
 }
 
+// -----------------------------------------------------------------------------
+// Sets up [source] to generate the item's thumbnail from the texture/flat
+// resource, rather than loading the full texture in the texture manager
+// -----------------------------------------------------------------------------
+bool MapTexBrowserItem::thumbnailSource(thumbnails::Source& source)
+{
+	auto& manager = mapeditor::textureManager();
+	auto  name    = name_.ToStdString();
+
+	auto resource = type_ == FLAT ? manager.flatResource(name) : manager.textureResource(name);
+	if (resource.ctex)
+		return thumbnails::textureSource(source, resource.ctex, resource.archive, manager.palette());
+
+	return thumbnails::entrySource(source, resource.entry, manager.palette());
+}
+
 // -----------------------------------------------------------------------------
 // Returns a string with extra information about the texture/flat
 // -----------------------------------------------------------------------------
@@ -160,6 +197,7 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 		addGlobalItem(new MapTexBrowserItem("-", MapTexBrowserItem::TEXTURE, 0));
 
 		auto& textures = mapeditor::textureManager().allTexturesInfo();
+		auto  last     = lastIndicesByName(textures);
 		for (unsigned a = 0; a < textures.size(); a++)
 		{
 			if ((map_format != MapFormat::UDMF || !game::configuration().featureSupported(game::Feature::LongNames))
@@ -170,17 +208,7 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 			}
 
 			// Don't add two textures with the same name
-			bool dont_add = false;
-			for (unsigned b = 0; b < textures.size(); b++)
-			{
-				if (textures[b].short_name == textures[a].short_name && b > a)
-				{
-					dont_add = true;
-					break;
-				}
-			}
-
-			if (dont_add)
+			if (last[textures[a].short_name] != a)
 				continue;
 
 			// Add browser item
@@ -194,6 +222,7 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 	if (type == TextureType::Flat || game::configuration().featureSupported(game::Feature::MixTexFlats))
 	{
 		auto& flats = mapeditor::textureManager().allFlatsInfo();
+		auto  last  = lastIndicesByName(flats);
 		for (unsigned a = 0; a < flats.size(); a++)
 		{
 			if ((map_format != MapFormat::UDMF || !game::configuration().featureSupported(game::Feature::LongNames))
@@ -204,16 +233,7 @@ MapTextureBrowser::MapTextureBrowser(wxWindow* parent, TextureType type, const w
 			}
 
 			// Don't add two flats with the same name
-			bool dont_add = false;
-			for (unsigned b = 0; b < flats.size(); b++)
-			{
-				if (flats[b].short_name == flats[a].short_name && b > a)
-				{
-					dont_add = true;
-					break;
-				}
-			}
-			if (dont_add)
+			if (last[flats[a].short_name] != a)
 				continue;
 
 			// Determine tree path
@@ -331,12 +351,11 @@ void MapTextureBrowser::doSort(unsigned sort_type)
 	if (sort_type < 2)
 		return BrowserWindow::doSort(sort_type);
 
-	// Sort by usage
+	// Sort by usage (not cached, since usage counts can change)
 	else if (sort_type == 2)
 	{
 		updateUsage();
-		auto& items = canvas_->itemList();
-		std::sort(items.begin(), items.end(), sortBIUsage);
+		canvas_->sortItems(sort_type, sortBIUsage, false);
 	}
 }
 
@@ -348,13 +367,19 @@ void MapTextureBrowser::updateUsage() const
 	if (!map_)
 		return;
 
+	// Textures and flats can be used anywhere if mixed
+	bool mixed = game::configuration().featureSupported(game::Feature::MixTexFlats);
+
 	auto& items = canvas_->itemList();
 	for (auto& i : items)
 	{
 		auto item = dynamic_cast<MapTexBrowserItem*>(i);
-		if (type_ == TextureType::Texture)
-			item->setUsage(map_->sides().texUsageCount(item->name().ToStdString()));
+		auto name = item->name().ToStdString();
+		if (mixed)
+			item->setUsage(map_->sides().texUsageCount(name) + map_->sectors().texUsageCount(name));
+		else if (type_ == TextureType::Texture)
+			item->setUsage(map_->sides().texUsageCount(name));
 		else
-			item->setUsage(map_->sectors().texUsageCount(item->name().ToStdString()));
+			item->setUsage(map_->sectors().texUsageCount(name));
 	}
 }
@@ -20,6 +20,7 @@ public:
 
 	bool     loadImage() override;
 	wxString itemInfo() override;
+	bool     thumbnailSource(thumbnails::Source& source) override;
 	int      usageCount() const { return usage_count_; }
 	void     setUsage(int count) { usage_count_ = count; }
 
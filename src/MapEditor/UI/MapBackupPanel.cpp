@@ -34,6 +34,7 @@
 #include "App.h"
 #include "Archive/Formats/WadArchive.h"
 #include "Archive/Formats/ZipArchive.h"
+#include "MapEditor/MapBackupManager.h"
 #include "UI/Canvas/MapPreviewCanvas.h"
 #include "UI/Lists/ListView.h"
 #include "UI/WxUtils.h"
@@ -129,9 +130,8 @@ void MapBackupPanel::updateMapPreview()
 
 	// Load map data to temporary wad
 	archive_mapdata_ = std::make_unique<WadArchive>();
-	auto dir         = dir_current_->subdirAt(selection);
-	for (unsigned a = 0; a < dir->numEntries(); a++)
-		archive_mapdata_->addEntry(std::make_shared<ArchiveEntry>(*dir->entryAt(a)), "");
+	for (auto& entry : MapBackupManager::backupEntries(dir_current_, selection))
+		archive_mapdata_->addEntry(entry, "");
 
 	// Open map preview
 	auto maps = archive_mapdata_->detectMaps();
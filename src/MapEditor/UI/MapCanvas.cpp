@@ -38,6 +38,7 @@
 #include "OpenGL/Drawing.h"
 #include "UI/WxUtils.h"
 #include "Utility/MathStuff.h"
+#include "Utility/Profiler.h"
 
 using namespace slade;
 
@@ -51,6 +52,12 @@ using mapeditor::Mode;
 // -----------------------------------------------------------------------------
 CVAR(Int, map_bg_ms, 15, CVar::Flag::Save)
 
+namespace
+{
+// Number of recent frames to keep timing stats for
+constexpr unsigned FRAME_STATS_COUNT = 60;
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -111,11 +118,66 @@ void MapCanvas::draw()
 	if (!IsEnabled())
 		return;
 
+	auto start = sf_clock_.getElapsedTime().asMicroseconds();
+
 	context_->renderer().draw();
 
 	SwapBuffers();
 
 	glFinish();
+
+	// Record frame time
+	auto time = (sf_clock_.getElapsedTime().asMicroseconds() - start) / 1000.;
+	if (frame_times_.size() < FRAME_STATS_COUNT)
+		frame_times_.push_back(time);
+	else
+		frame_times_[frame_times_next_] = time;
+	frame_times_next_ = (frame_times_next_ + 1) % FRAME_STATS_COUNT;
+
+	// Everything timed up to here is shown in the profiler overlay next frame
+	if (profiler::enabled())
+		profiler::endFrame();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the average and maximum time taken to draw recent frames
+// -----------------------------------------------------------------------------
+MapCanvas::FrameStats MapCanvas::frameStats() const
+{
+	FrameStats stats;
+	if (frame_times_.empty())
+		return stats;
+
+	for (auto time : frame_times_)
+	{
+		stats.avg_ms += time;
+		stats.max_ms = std::max(stats.max_ms, time);
+	}
+	stats.avg_ms /= frame_times_.size();
+
+	return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Runs a single frame: samples input (3d mode mouselook), updates the edit
+// context (hilight, object moving and animations) and then redraws the canvas
+// if the update is due and anything needs redrawing
+// -----------------------------------------------------------------------------
+void MapCanvas::updateFrame()
+{
+	// Input
+	mouseLook3d();
+
+	// Update (only if enough time has passed since the last redraw)
+	auto now       = sf_clock_.getElapsedTime().asMilliseconds();
+	long frametime = now - last_time_;
+	if (!context_->update(frametime))
+		return;
+
+	// Render
+	last_time_ = now;
+	context_->renderer().beginFrame();
+	Refresh();
 }
 
 // -----------------------------------------------------------------------------
@@ -487,17 +549,7 @@ void MapCanvas::onMouseEnter(wxMouseEvent& e)
 // -----------------------------------------------------------------------------
 void MapCanvas::onIdle(wxIdleEvent& e)
 {
-	// Handle 3d mode mouselook
-	mouseLook3d();
-
-	// Get time since last redraw
-	long frametime = (sf_clock_.getElapsedTime().asMilliseconds()) - last_time_;
-
-	if (context_->update(frametime))
-	{
-		last_time_ = (sf_clock_.getElapsedTime().asMilliseconds());
-		Refresh();
-	}
+	updateFrame();
 }
 
 // -----------------------------------------------------------------------------
@@ -505,17 +557,7 @@ void MapCanvas::onIdle(wxIdleEvent& e)
 // -----------------------------------------------------------------------------
 void MapCanvas::onRTimer(wxTimerEvent& e)
 {
-	// Handle 3d mode mouselook
-	mouseLook3d();
-
-	// Get time since last redraw
-	long frametime = (sf_clock_.getElapsedTime().asMilliseconds()) - last_time_;
-
-	if (context_->update(frametime))
-	{
-		last_time_ = (sf_clock_.getElapsedTime().asMilliseconds());
-		Refresh();
-	}
+	updateFrame();
 
 	timer_.Start(map_bg_ms, true);
 }
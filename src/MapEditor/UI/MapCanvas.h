@@ -9,6 +9,13 @@ namespace slade
 class MapCanvas : public OGLCanvas, public KeyBindHandler
 {
 public:
+	// Timing of recently drawn frames
+	struct FrameStats
+	{
+		double avg_ms = 0.;
+		double max_ms = 0.;
+	};
+
 	MapCanvas(wxWindow* parent, int id, MapEditContext* context);
 	~MapCanvas() = default;
 
@@ -20,15 +27,21 @@ public:
 	void lockMouse(bool lock);
 	void mouseLook3d();
 
+	// Frame timing
+	FrameStats frameStats() const;
+
 	// Keybind handling
 	void onKeyBindPress(string_view name) override;
 
 private:
 	MapEditContext* context_    = nullptr;
 	bool            mouse_warp_ = false;
-	vector<int>     fps_avg_;
+	vector<double>  frame_times_; // Time taken to draw recent frames (ms)
+	unsigned        frame_times_next_ = 0;
 	sf::Clock       sf_clock_;
 
+	void updateFrame();
+
 	// Events
 	void onSize(wxSizeEvent& e);
 	void onKeyDown(wxKeyEvent& e);
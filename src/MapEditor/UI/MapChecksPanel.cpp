@@ -33,9 +33,12 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapChecksPanel.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
 #include "MapEditor/MapChecks.h"
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
+#include "MapEditor/UI/MapEditorWindow.h"
 #include "SLADEMap/SLADEMap.h"
 #include "UI/WxUtils.h"
 #include "Utility/SFileDialog.h"
@@ -67,7 +70,34 @@ vector<std::pair<MapCheck::StandardCheck, wxString>> std_checks = {
 	{ MapCheck::UnknownSpecial, "Check for unknown line and thing specials" },
 	{ MapCheck::ObsoleteThing, "Check for obsolete things" },
 };
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Switches to the edit mode for map objects of [type] and shows the object at
+// [index] in the map editor
+// -----------------------------------------------------------------------------
+void showObject(MapObject::Type type, unsigned index)
+{
+	switch (type)
+	{
+	case MapObject::Type::Vertex: mapeditor::editContext().setEditMode(mapeditor::Mode::Vertices); break;
+	case MapObject::Type::Line: mapeditor::editContext().setEditMode(mapeditor::Mode::Lines); break;
+	case MapObject::Type::Sector: mapeditor::editContext().setEditMode(mapeditor::Mode::Sectors); break;
+	case MapObject::Type::Thing: mapeditor::editContext().setEditMode(mapeditor::Mode::Things); break;
+	default: break;
+	}
+
+	mapeditor::editContext().showItem(index);
 }
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -88,9 +118,14 @@ MapChecksPanel::MapChecksPanel(wxWindow* parent, SLADEMap* map) : DockPanel{ par
 	btn_edit_object_   = new wxButton(this, -1, "Edit Object Properties");
 	btn_fix1_          = new wxButton(this, -1, "(Fix1)");
 	btn_fix2_          = new wxButton(this, -1, "(Fix2)");
+	btn_fix1_all_      = new wxButton(this, -1, "(Fix1 All)");
+	btn_fix2_all_      = new wxButton(this, -1, "(Fix2 All)");
 	label_status_      = new wxStaticText(this, -1, "Click Check to begin");
 	btn_export_        = new wxButton(this, -1, "Export Results");
 	btn_check_         = new wxButton(this, -1, "Check");
+	btn_check_all_     = new wxButton(this, -1, "Check All Maps");
+	btn_check_all_->SetToolTip("Check every map in the archive (as saved), opening the map of a problem when it is "
+							   "double-clicked");
 
 	// Populate checks list
 	for (auto& check : std_checks)
@@ -98,10 +133,14 @@ MapChecksPanel::MapChecksPanel(wxWindow* parent, SLADEMap* map) : DockPanel{ par
 
 	// Bind events
 	btn_check_->Bind(wxEVT_BUTTON, &MapChecksPanel::onBtnCheck, this);
+	btn_check_all_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { checkAllMaps(); });
 	lb_errors_->Bind(wxEVT_LISTBOX, &MapChecksPanel::onListBoxItem, this);
+	lb_errors_->Bind(wxEVT_LISTBOX_DCLICK, &MapChecksPanel::onListBoxDClick, this);
 	btn_edit_object_->Bind(wxEVT_BUTTON, &MapChecksPanel::onBtnEditObject, this);
 	btn_fix1_->Bind(wxEVT_BUTTON, &MapChecksPanel::onBtnFix1, this);
 	btn_fix2_->Bind(wxEVT_BUTTON, &MapChecksPanel::onBtnFix2, this);
+	btn_fix1_all_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { fixAll(0); });
+	btn_fix2_all_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { fixAll(1); });
 	btn_export_->Bind(wxEVT_BUTTON, &MapChecksPanel::onBtnExport, this);
 
 	// Init default selected checks
@@ -113,6 +152,8 @@ MapChecksPanel::MapChecksPanel(wxWindow* parent, SLADEMap* map) : DockPanel{ par
 	// Init buttons
 	btn_fix1_->Show(false);
 	btn_fix2_->Show(false);
+	btn_fix1_all_->Show(false);
+	btn_fix2_all_->Show(false);
 	btn_edit_object_->Enable(false);
 	btn_export_->Enable(false);
 }
@@ -136,19 +177,9 @@ void MapChecksPanel::showCheckItem(unsigned index)
 {
 	if (index < check_items_.size())
 	{
-		// Set edit mode to object type
+		// Show object
 		auto obj = check_items_[index].check->getObject(check_items_[index].index);
-		switch (obj->objType())
-		{
-		case MapObject::Type::Vertex: mapeditor::editContext().setEditMode(mapeditor::Mode::Vertices); break;
-		case MapObject::Type::Line: mapeditor::editContext().setEditMode(mapeditor::Mode::Lines); break;
-		case MapObject::Type::Sector: mapeditor::editContext().setEditMode(mapeditor::Mode::Sectors); break;
-		case MapObject::Type::Thing: mapeditor::editContext().setEditMode(mapeditor::Mode::Things); break;
-		default: break;
-		}
-
-		// Scroll to object
-		mapeditor::editContext().showItem(obj->index());
+		showObject(obj->objType(), obj->index());
 
 		// Update UI
 		btn_edit_object_->Enable(true);
@@ -172,12 +203,22 @@ void MapChecksPanel::showCheckItem(unsigned index)
 		}
 		else
 			btn_fix2_->Show(false);
+
+		// Fix all buttons (if the check can fix all its problems at once)
+		wxString fix1_all = check_items_[index].check->fixAllText(0);
+		btn_fix1_all_->SetLabel(fix1_all);
+		btn_fix1_all_->Show(!fix1_all.empty());
+		wxString fix2_all = check_items_[index].check->fixAllText(1);
+		btn_fix2_all_->SetLabel(fix2_all);
+		btn_fix2_all_->Show(!fix2_all.empty());
 	}
 	else
 	{
 		btn_edit_object_->Enable(false);
 		btn_fix1_->Show(false);
 		btn_fix2_->Show(false);
+		btn_fix1_all_->Show(false);
+		btn_fix2_all_->Show(false);
 	}
 
 	Layout();
@@ -229,16 +270,187 @@ void MapChecksPanel::reset()
 	lb_errors_->Clear();
 	btn_fix1_->Show(false);
 	btn_fix2_->Show(false);
+	btn_fix1_all_->Show(false);
+	btn_fix2_all_->Show(false);
 	btn_edit_object_->Enable(false);
 	check_items_.clear();
 
 	// Clear previous checks
 	active_checks_.clear();
+	active_check_types_.clear();
+	last_check_time_ = -1;
 
 	refreshList();
+
+	// Keep the results of checking all maps if the map is in the same archive
+	if (!map_reports_.empty())
+	{
+		auto head = mapeditor::editContext().mapDesc().head.lock();
+		if (head && head->parent() == reports_archive_.lock().get())
+			refreshReportList();
+		else
+		{
+			map_reports_.clear();
+			report_items_.clear();
+			reports_archive_.reset();
+		}
+	}
+
 	lb_errors_->Show(true);
 }
 
+// -----------------------------------------------------------------------------
+// Fixes all problems found by the check of the selected problem with
+// [fix_type], as one batch edit (and undo level), then rechecks anything the
+// fixes modified
+// -----------------------------------------------------------------------------
+void MapChecksPanel::fixAll(unsigned fix_type)
+{
+	int selected = lb_errors_->GetSelection();
+	if (selected < 0 || selected >= (int)check_items_.size())
+		return;
+
+	auto  check   = check_items_[selected].check;
+	auto& context = mapeditor::editContext();
+	auto  since   = app::runTimer();
+
+	context.beginBatchEdit(check->fixAllText(fix_type));
+	context.selection().clear();
+	auto fixed = check->fixAll(fix_type, &context);
+	context.endBatchEdit(fixed > 0);
+	if (fixed == 0)
+		return;
+
+	// Recheck what was modified (fixes can cause or leave other problems)
+	updateStatusText("Checking...");
+	MapCheck::runChecks({ check }, since - 1);
+
+	refreshList();
+	showCheckItem(lb_errors_->GetSelection());
+	updateStatusText(wxString::Format("%d problems fixed, %d remaining", fixed, lb_errors_->GetCount()));
+}
+
+// -----------------------------------------------------------------------------
+// Runs the selected checks on every map in the current map's archive (as
+// saved), and lists the problems found in all of them
+// -----------------------------------------------------------------------------
+void MapChecksPanel::checkAllMaps()
+{
+	auto head    = mapeditor::editContext().mapDesc().head.lock();
+	auto archive = head ? app::archiveManager().shareArchive(head->parent()) : nullptr;
+	if (!archive)
+	{
+		updateStatusText("The map must be saved to an archive first");
+		return;
+	}
+
+	// Clear current results
+	map_reports_.clear();
+	reset();
+	btn_export_->Enable(false);
+
+	// Run checks
+	updateStatusText("Checking all maps...");
+	map_reports_     = MapCheck::checkArchiveMaps(*archive, selectedChecks(), &mapeditor::textureManager());
+	reports_archive_ = archive;
+	refreshReportList();
+
+	unsigned n_maps = 0;
+	for (const auto& report : map_reports_)
+		if (!report.problems.empty() || !report.error.empty())
+			++n_maps;
+	if (report_items_.empty())
+		updateStatusText(wxString::Format("No problems found in %lu maps", map_reports_.size()));
+	else
+	{
+		updateStatusText(wxString::Format("%lu problems found in %d maps", report_items_.size(), n_maps));
+		btn_export_->Enable(true);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the standard checks selected in the checks list
+// -----------------------------------------------------------------------------
+vector<MapCheck::StandardCheck> MapChecksPanel::selectedChecks() const
+{
+	vector<MapCheck::StandardCheck> checks;
+	for (auto a = 0u; a < std_checks.size(); ++a)
+		if (clb_active_checks_->IsChecked(a))
+			checks.push_back(std_checks[a].first);
+
+	return checks;
+}
+
+// -----------------------------------------------------------------------------
+// Refreshes the problems list with the results of checking all maps
+// -----------------------------------------------------------------------------
+void MapChecksPanel::refreshReportList()
+{
+	lb_errors_->Clear();
+	report_items_.clear();
+
+	for (unsigned a = 0; a < map_reports_.size(); ++a)
+	{
+		auto& report = map_reports_[a];
+		if (!report.error.empty())
+		{
+			lb_errors_->Append(wxString::FromUTF8(report.map_name + ": " + report.error));
+			report_items_.push_back({ a, -1 });
+		}
+
+		for (unsigned p = 0; p < report.problems.size(); ++p)
+		{
+			lb_errors_->Append(wxString::FromUTF8(report.map_name + ": " + report.problems[p].description));
+			report_items_.push_back({ a, static_cast<int>(p) });
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Shows the problem at [index] in the all maps results list, opening its map
+// first if [open_map] is true and it isn't the current map
+// -----------------------------------------------------------------------------
+void MapChecksPanel::showReportItem(unsigned index, bool open_map)
+{
+	auto archive = reports_archive_.lock();
+	if (index >= report_items_.size() || !archive)
+		return;
+
+	auto  item    = report_items_[index];
+	auto& report  = map_reports_[item.report];
+	auto& context = mapeditor::editContext();
+
+	// Open the problem's map if needed
+	if (report.map_name != context.mapDesc().name)
+	{
+		if (!open_map)
+		{
+			updateStatusText(wxString::FromUTF8("Double-click to open map " + report.map_name));
+			return;
+		}
+
+		for (const auto& desc : archive->detectMaps())
+			if (desc.name == report.map_name)
+			{
+				mapeditor::window()->openMap(desc);
+				break;
+			}
+
+		// Opening the map resets the list, so re-select the problem
+		if (context.mapDesc().name != report.map_name)
+			return;
+		lb_errors_->SetSelection(index);
+	}
+
+	// Show the problem's object
+	if (item.problem >= 0)
+	{
+		auto& problem = report.problems[item.problem];
+		if (problem.object_type != MapObject::Type::Object)
+			showObject(problem.object_type, problem.object_index);
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Lays out panel controls vertically
 // (for when the panel is docked vertically)
@@ -250,7 +462,11 @@ void MapChecksPanel::layoutVertical()
 
 	// Checks
 	sizer->Add(wxutil::createLabelVBox(this, "Check for:", clb_active_checks_), 0, wxEXPAND | wxALL, ui::pad());
-	sizer->Add(btn_check_, 0, wxALIGN_RIGHT | wxLEFT | wxRIGHT | wxBOTTOM, ui::pad());
+	sizer->Add(
+		wxutil::layoutHorizontally(vector<wxObject*>{ btn_check_all_, btn_check_ }),
+		0,
+		wxALIGN_RIGHT | wxLEFT | wxRIGHT | wxBOTTOM,
+		ui::pad());
 
 	// Results
 	sizer->Add(label_status_, 0, wxEXPAND | wxLEFT | wxRIGHT, ui::pad());
@@ -268,6 +484,11 @@ void MapChecksPanel::layoutVertical()
 		0,
 		wxLEFT | wxRIGHT | wxBOTTOM,
 		ui::pad());
+	sizer->Add(
+		wxutil::layoutHorizontally(vector<wxObject*>{ btn_fix1_all_, btn_fix2_all_ }),
+		0,
+		wxLEFT | wxRIGHT | wxBOTTOM,
+		ui::pad());
 }
 
 // -----------------------------------------------------------------------------
@@ -283,14 +504,16 @@ void MapChecksPanel::layoutHorizontal()
 	// Checks
 	sizer->Add(new wxStaticText(this, -1, "Check for:"), { 0, 0 }, { 1, 1 }, wxEXPAND);
 	sizer->Add(clb_active_checks_, { 1, 0 }, { 1, 1 }, wxEXPAND);
-	sizer->Add(btn_check_, { 2, 0 }, { 1, 1 }, wxALIGN_RIGHT);
+	sizer->Add(
+		wxutil::layoutHorizontally(vector<wxObject*>{ btn_check_all_, btn_check_ }), { 2, 0 }, { 1, 1 }, wxALIGN_RIGHT);
 
 	// Results
 	sizer->Add(label_status_, { 0, 1 }, { 1, 1 }, wxEXPAND);
 	sizer->Add(lb_errors_, { 1, 1 }, { 2, 1 }, wxEXPAND);
 
 	// Result actions
-	auto layout = wxutil::layoutVertically(vector<wxObject*>{ btn_export_, btn_edit_object_, btn_fix1_, btn_fix2_ });
+	auto layout = wxutil::layoutVertically(vector<wxObject*>{
+		btn_export_, btn_edit_object_, btn_fix1_, btn_fix2_, btn_fix1_all_, btn_fix2_all_ });
 	sizer->Add(layout, { 1, 2 }, { 2, 1 }, wxEXPAND);
 
 	sizer->AddGrowableCol(1, 1);
@@ -315,31 +538,46 @@ void MapChecksPanel::onBtnCheck(wxCommandEvent& e)
 	lb_errors_->Clear();
 	btn_fix1_->Show(false);
 	btn_fix2_->Show(false);
+	btn_fix1_all_->Show(false);
+	btn_fix2_all_->Show(false);
 	btn_edit_object_->Enable(false);
 	btn_export_->Enable(false);
 	check_items_.clear();
+	map_reports_.clear();
+	report_items_.clear();
+	reports_archive_.reset();
 
-	// Clear previous checks
-	active_checks_.clear();
-
-	// Setup checks
+	// Get checks to run
+	vector<unsigned> check_types;
 	for (auto a = 0u; a < std_checks.size(); ++a)
-	{
 		if (clb_active_checks_->IsChecked(a))
-		{
+			check_types.push_back(a);
+
+	// If the same checks were run previously, only recheck what was modified
+	// since then, otherwise setup new checks
+	long since = -1;
+	if (check_types == active_check_types_ && last_check_time_ >= 0)
+		since = last_check_time_ - 1;
+	else
+	{
+		active_checks_.clear();
+		for (auto type : check_types)
 			active_checks_.emplace_back(
-				MapCheck::standardCheck(static_cast<MapCheck::StandardCheck>(a), map_, &mapeditor::textureManager()));
-		}
+				MapCheck::standardCheck(static_cast<MapCheck::StandardCheck>(type), map_, &mapeditor::textureManager()));
+		active_check_types_ = check_types;
 	}
 
 	// Run checks
+	vector<MapCheck*> checks;
 	for (auto& check : active_checks_)
-	{
-		// Check
-		updateStatusText(check->progressText());
-		check->doCheck();
+		checks.push_back(check.get());
+	updateStatusText("Checking...");
+	last_check_time_ = app::runTimer();
+	MapCheck::runChecks(checks, since);
 
-		// Add results to list
+	// Add results to list
+	for (auto& check : active_checks_)
+	{
 		for (unsigned b = 0; b < check->nProblems(); b++)
 		{
 			lb_errors_->Append(check->problemDesc(b));
@@ -366,6 +604,18 @@ void MapChecksPanel::onListBoxItem(wxCommandEvent& e)
 	int selected = lb_errors_->GetSelection();
 	if (selected >= 0 && selected < (int)check_items_.size())
 		showCheckItem(selected);
+	else if (selected >= 0 && selected < (int)report_items_.size())
+		showReportItem(selected, false);
+}
+
+// -----------------------------------------------------------------------------
+// Called when a list item is double-clicked
+// -----------------------------------------------------------------------------
+void MapChecksPanel::onListBoxDClick(wxCommandEvent& e)
+{
+	int selected = lb_errors_->GetSelection();
+	if (selected >= 0 && selected < (int)report_items_.size())
+		showReportItem(selected, true);
 }
 
 // -----------------------------------------------------------------------------
@@ -429,6 +679,37 @@ void MapChecksPanel::onBtnEditObject(wxCommandEvent& e)
 // -----------------------------------------------------------------------------
 void MapChecksPanel::onBtnExport(wxCommandEvent& e)
 {
+	// Results of checking all maps
+	if (!report_items_.empty())
+	{
+		auto archive = reports_archive_.lock();
+		auto name    = archive ? archive->filename(false) : string{};
+
+		filedialog::FDInfo info;
+		if (filedialog::saveFile(
+				info, "Export Map Check Results", "Text Files (*.txt)|*.txt", mapeditor::windowWx(), name + "-Problems"))
+		{
+			auto text = fmt::format("{} problems found in {}:\n", report_items_.size(), name);
+			for (const auto& report : map_reports_)
+			{
+				if (report.problems.empty() && report.error.empty())
+					continue;
+
+				text += fmt::format("\n{}:\n", report.map_name);
+				if (!report.error.empty())
+					text += report.error + "\n";
+				for (const auto& problem : report.problems)
+					text += problem.description + "\n";
+			}
+			wxFile file;
+			file.Open(info.filenames[0], wxFile::write);
+			if (file.IsOpened())
+				file.Write(text);
+			file.Close();
+		}
+		return;
+	}
+
 	auto               map_name = mapeditor::editContext().mapDesc().name;
 	filedialog::FDInfo info;
 	if (filedialog::saveFile(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MapEditor/MapChecks.h"
 #include "UI/Controls/DockPanel.h"
 
 class wxListBox;
@@ -7,7 +8,6 @@ class wxListBox;
 namespace slade
 {
 class SLADEMap;
-class MapCheck;
 
 class MapChecksPanel : public DockPanel
 {
@@ -19,6 +19,8 @@ public:
 	void showCheckItem(unsigned index);
 	void refreshList();
 	void reset();
+	void fixAll(unsigned fix_type);
+	void checkAllMaps();
 
 	// DockPanel overrides
 	void layoutNormal() override { layoutHorizontal(); }
@@ -28,13 +30,18 @@ public:
 private:
 	SLADEMap*                    map_ = nullptr;
 	vector<unique_ptr<MapCheck>> active_checks_;
+	vector<unsigned>             active_check_types_;
+	long                         last_check_time_ = -1;
 
 	wxCheckListBox* clb_active_checks_ = nullptr;
 	wxListBox*      lb_errors_         = nullptr;
 	wxButton*       btn_check_         = nullptr;
+	wxButton*       btn_check_all_     = nullptr;
 	wxStaticText*   label_status_      = nullptr;
 	wxButton*       btn_fix1_          = nullptr;
 	wxButton*       btn_fix2_          = nullptr;
+	wxButton*       btn_fix1_all_      = nullptr;
+	wxButton*       btn_fix2_all_      = nullptr;
 	wxButton*       btn_edit_object_   = nullptr;
 	wxButton*       btn_export_        = nullptr;
 
@@ -46,9 +53,24 @@ private:
 	};
 	vector<CheckItem> check_items_;
 
+	// Results of checking all maps in the archive (see checkAllMaps)
+	struct ReportItem
+	{
+		unsigned report;
+		int      problem; // -1 if the map couldn't be read
+	};
+	vector<MapCheck::MapReport> map_reports_;
+	vector<ReportItem>          report_items_;
+	weak_ptr<Archive>           reports_archive_;
+
+	vector<MapCheck::StandardCheck> selectedChecks() const;
+	void                            refreshReportList();
+	void                            showReportItem(unsigned index, bool open_map);
+
 	// Events
 	void onBtnCheck(wxCommandEvent& e);
 	void onListBoxItem(wxCommandEvent& e);
+	void onListBoxDClick(wxCommandEvent& e);
 	void onBtnFix1(wxCommandEvent& e);
 	void onBtnFix2(wxCommandEvent& e);
 	void onBtnEditObject(wxCommandEvent& e);
@@ -42,13 +42,16 @@
 #include "MapEditor/MapEditContext.h"
 #include "MapEditor/MapEditor.h"
 #include "MapEditor/MapTextureManager.h"
+#include "MapEditor/NodeBuilder.h"
 #include "MapEditor/NodeBuilders.h"
 #include "MapEditor/UI/MapCanvas.h"
 #include "MapEditor/UI/MapChecksPanel.h"
+#include "MapEditor/UI/MapViewCanvas.h"
 #include "MapEditor/UI/ObjectEditPanel.h"
 #include "MapEditor/UI/PropsPanel/MapObjectPropsPanel.h"
 #include "MapEditor/UI/ScriptEditorPanel.h"
 #include "MapEditor/UI/ShapeDrawPanel.h"
+#include "SLADEMap/MapSnapshot.h"
 #include "SLADEWxApp.h"
 #include "Scripting/ScriptManager.h"
 #include "UI/Controls/ConsolePanel.h"
@@ -61,6 +64,8 @@
 #include "UI/SToolBar/SToolBar.h"
 #include "UI/WxUtils.h"
 #include "Utility/SFileDialog.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 
 using namespace slade;
@@ -73,7 +78,8 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-bool nb_warned = false;
+bool     nb_warned        = false;
+unsigned node_build_count = 0;
 }
 CVAR(Bool, mew_maximized, true, CVar::Flag::Save);
 CVAR(String, nodebuilder_id, "zdbsp", CVar::Flag::Save);
@@ -89,6 +95,250 @@ CVAR(Bool, save_archive_with_map, true, CVar::Flag::Save);
 EXTERN_CVAR(Int, flat_drawtype);
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Adds the contents of [stream] that can be read without blocking to [out]
+// -----------------------------------------------------------------------------
+void readStream(wxInputStream* stream, string& out)
+{
+	char buf[4096];
+	while (stream && stream->CanRead())
+	{
+		stream->Read(buf, sizeof(buf));
+		if (stream->LastRead() == 0)
+			break;
+		out.append(buf, stream->LastRead());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Swaps the map entries from [built] (a nodebuilder output wad) into the map
+// at [head] in [archive], where [entries] are the map's current data entries.
+// Entries in both keep their place (and are updated if the nodebuilder changed
+// them), new (node) entries are added in the order they appear in [built] and
+// any entries the nodebuilder didn't output are removed.
+// Returns the new last entry of the map
+// -----------------------------------------------------------------------------
+shared_ptr<ArchiveEntry> mergeBuiltMap(
+	Archive&                     archive,
+	ArchiveEntry*                head,
+	const vector<ArchiveEntry*>& entries,
+	Archive&                     built)
+{
+	auto     end      = head->getShared();
+	unsigned index    = archive.entryIndex(head) + 1;
+	unsigned existing = 0;
+	for (unsigned a = 1; a < built.numEntries(); ++a, ++index)
+	{
+		auto built_entry = built.entryAt(a);
+		if (existing < entries.size() && entries[existing]->name() == built_entry->name())
+		{
+			auto entry = entries[existing++];
+			if (entry->contentHash() != built_entry->contentHash())
+				entry->importMemChunk(built_entry->data());
+			end = entry->getShared();
+		}
+		else
+			end = archive.addEntry(std::make_shared<ArchiveEntry>(*built_entry), index, nullptr);
+	}
+
+	while (existing < entries.size())
+		archive.removeEntry(entries[existing++]);
+
+	return end;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+// NodeBuildProcess Class
+//
+// Nodebuilder process run asynchronously after a map is saved. Its output is
+// read as it runs (so the pipes don't fill up), and when it terminates the
+// built node entries are swapped into the saved map (if it hasn't changed
+// since) and the process deletes itself
+// -----------------------------------------------------------------------------
+class MapEditorWindow::NodeBuildProcess : public wxProcess
+{
+public:
+	NodeBuildProcess(
+		MapEditorWindow*             window,
+		const wxString&              filename,
+		ArchiveEntry*                head,
+		const vector<ArchiveEntry*>& entries,
+		bool                         map_archive) :
+		wxProcess{ wxPROCESS_REDIRECT },
+		window_{ window },
+		filename_{ filename },
+		head_{ head->getShared() },
+		map_archive_{ map_archive },
+		timer_{ this }
+	{
+		for (auto entry : entries)
+			entries_.push_back({ entry->getShared(), entry->contentHash() });
+
+		Bind(wxEVT_TIMER, [&](wxTimerEvent&) { readOutput(); });
+	}
+
+	bool start(const wxString& command)
+	{
+		log::info(wxString::Format("execute \"%s\"", command));
+		pid_ = wxExecute(command, wxEXEC_ASYNC | wxEXEC_HIDE_CONSOLE, this);
+		if (pid_ == 0)
+			return false;
+
+		timer_.Start(100);
+		time_.Start();
+		return true;
+	}
+
+	// Kills the nodebuilder, its output will be discarded
+	void cancel()
+	{
+		cancelled_ = true;
+		window_    = nullptr;
+		Kill(pid_, wxSIGKILL, wxKILL_CHILDREN);
+	}
+
+	// Stops the process from updating [window_] (eg. if it's being destroyed)
+	void detach() { window_ = nullptr; }
+
+	void OnTerminate(int pid, int status) override
+	{
+		timer_.Stop();
+		readOutput();
+
+		// Log output
+		log::info(1, "Nodebuilder output:");
+		for (const auto& line : strutil::splitV(output_, '\n'))
+			log::message(log::MessageType::Info, line);
+
+		// Apply built nodes
+		string message;
+		if (cancelled_)
+			message = "Node building cancelled";
+		else if (status != 0)
+			message = fmt::format("Nodebuilder failed (exit code {}), nodes were not built", status);
+		else if (applyNodes())
+			message = fmt::format("Nodes built ({:.1f}s)", time_.Time() / 1000.);
+		else
+			message = "Map entries changed while building, nodes were discarded";
+		log::info(message);
+
+		if (window_)
+		{
+			window_->node_build_ = nullptr;
+			window_->SetStatusText(message, 0);
+			if (mapeditor::editContext().mapDesc().head.lock() == head_.lock())
+				mapeditor::editContext().addEditorMessage(message);
+		}
+
+		wxRemoveFile(filename_);
+		delete this;
+	}
+
+private:
+	struct SavedEntry
+	{
+		weak_ptr<ArchiveEntry> entry;
+		uint32_t               hash;
+	};
+
+	MapEditorWindow*       window_;
+	wxString               filename_;
+	weak_ptr<ArchiveEntry> head_;
+	vector<SavedEntry>     entries_; // Saved map data entries, or the map itself if map_archive_ is true
+	bool                   map_archive_;
+	long                   pid_       = 0;
+	bool                   cancelled_ = false;
+	wxTimer                timer_;
+	wxStopWatch            time_;
+	string                 output_;
+
+	void readOutput()
+	{
+		readStream(GetInputStream(), output_);
+		readStream(GetErrorStream(), output_);
+
+		if (window_)
+			window_->SetStatusText(wxString::Format("Building nodes... (%lds)", time_.Time() / 1000), 0);
+	}
+
+	// Swaps the nodebuilder output into the saved map entries, returns false
+	// if the map was modified or removed since it was saved
+	bool applyNodes() const
+	{
+		// Check the saved map entries are unchanged
+		auto head    = head_.lock();
+		auto archive = head ? head->parent() : nullptr;
+		if (!archive)
+			return false;
+		vector<ArchiveEntry*> entries;
+		auto                  index = archive->entryIndex(head.get()) + 1;
+		for (const auto& saved : entries_)
+		{
+			auto entry = saved.entry.lock();
+			if (!entry || entry->parent() != archive || entry->contentHash() != saved.hash)
+				return false;
+			if (!map_archive_ && archive->entryIndex(entry.get()) != index++)
+				return false;
+			entries.push_back(entry.get());
+		}
+
+		// Open nodebuilder output
+		WadArchive built;
+		if (!built.open(filename_.ToStdString()) || built.numEntries() == 0)
+		{
+			log::error("Unable to open nodebuilder output file {}", filename_.ToStdString());
+			return false;
+		}
+
+		// If the archive was saved along with the map, save it again afterwards
+		bool save_archive = save_archive_with_map && !archive->isModified();
+
+		if (map_archive_)
+		{
+			// Map in a zip, update the map wad and write it back to the map entry
+			WadArchive map_wad;
+			if (!map_wad.open(head.get()))
+				return false;
+			auto maps = map_wad.detectMaps();
+			if (maps.empty())
+				return false;
+			auto map_head = maps[0].head.lock();
+			mergeBuiltMap(map_wad, map_head.get(), maps[0].entries(map_wad), built);
+
+			bool locked = head->isLocked();
+			head->unlock();
+			map_wad.save();
+			if (locked)
+				head->lock();
+		}
+		else
+		{
+			auto end = mergeBuiltMap(*archive, head.get(), entries, built);
+			archive->mapDesc(head.get()).updateMapFormatHints();
+
+			// Update the map description if the map is open in the editor
+			auto& mdesc = mapeditor::editContext().mapDesc();
+			if (mdesc.head.lock() == head)
+				mdesc.end = end;
+		}
+
+		if (save_archive)
+			archive->save();
+
+		return true;
+	}
+};
+
+
 // -----------------------------------------------------------------------------
 //
 // MapEditorWindow Class Functions
@@ -123,6 +373,9 @@ MapEditorWindow::MapEditorWindow() : STopWindow{ "SLADE", "map" }
 // -----------------------------------------------------------------------------
 MapEditorWindow::~MapEditorWindow()
 {
+	if (node_build_)
+		node_build_->detach();
+
 	wxAuiManager::GetManager(this)->UnInit();
 }
 
@@ -190,6 +443,11 @@ void MapEditorWindow::saveLayout()
 	pinf = m_mgr->SavePaneInfo(m_mgr->GetPane("undo_history"));
 	file.Write(wxString::Format("\"%s\"\n", pinf));
 
+	// 3d view pane
+	file.Write("\"map_view_3d\" ");
+	pinf = m_mgr->SavePaneInfo(m_mgr->GetPane("map_view_3d"));
+	file.Write(wxString::Format("\"%s\"\n", pinf));
+
 	// Close file
 	file.Close();
 }
@@ -220,6 +478,7 @@ void MapEditorWindow::setupMenu()
 	SAction::fromId("mapw_saveas")->addToMenu(menu_map);
 	//SAction::fromId("mapw_rename")->addToMenu(menu_map);
 	SAction::fromId("mapw_backup")->addToMenu(menu_map);
+	SAction::fromId("mapw_cancel_nodebuild")->addToMenu(menu_map);
 	menu_map->AppendSeparator();
 	SAction::fromId("mapw_run_map")->addToMenu(menu_map);
 	menu->Append(menu_map, "&Map");
@@ -250,6 +509,7 @@ void MapEditorWindow::setupMenu()
 	SAction::fromId("mapw_showundohistory")->addToMenu(menu_window);
 	SAction::fromId("mapw_showchecks")->addToMenu(menu_window);
 	SAction::fromId("mapw_showscripteditor")->addToMenu(menu_window);
+	SAction::fromId("mapw_show3dview")->addToMenu(menu_window);
 	toolbar_menu_ = new wxMenu();
 	menu_view->AppendSubMenu(toolbar_menu_, "Toolbars");
 	menu_view->AppendSeparator();
@@ -490,6 +750,23 @@ void MapEditorWindow::setupLayout()
 	m_mgr->AddPane(panel_undo_history_, p_inf);
 
 
+	// -- 3D View --
+	map_view_3d_ = new MapViewCanvas(this, &mapeditor::editContext());
+
+	// Setup panel info & add panel
+	p_inf.DefaultPane();
+	p_inf.Right();
+	p_inf.BestSize(wxutil::scaledSize(400, 300));
+	p_inf.FloatingSize(wxutil::scaledSize(400, 300));
+	p_inf.FloatingPosition(180, 180);
+	p_inf.MinSize(wxutil::scaledSize(160, 120));
+	p_inf.Caption("3D View");
+	p_inf.Name("map_view_3d");
+	p_inf.Show(false);
+	p_inf.Dock();
+	m_mgr->AddPane(map_view_3d_, p_inf);
+
+
 	// Load previously saved window layout
 	loadLayout();
 
@@ -645,6 +922,9 @@ bool MapEditorWindow::openMap(Archive::MapDesc map)
 		// Reset map checks panel
 		panel_checks_->reset();
 
+		// Start 3d view at the 3d mode camera
+		map_view_3d_->resetCamera();
+
 		mapeditor::editContext().renderer().viewFitToMap(true);
 		map_canvas_->Refresh();
 
@@ -727,14 +1007,11 @@ void MapEditorWindow::loadMapScripts(Archive::MapDesc map)
 }
 
 // -----------------------------------------------------------------------------
-// Builds nodes for the maps in [wad]
+// Returns the command line to run the current nodebuilder on the wad at
+// [filename], or an empty string if no (valid) nodebuilder is configured
 // -----------------------------------------------------------------------------
-void MapEditorWindow::buildNodes(Archive* wad)
+wxString MapEditorWindow::nodeBuilderCommand(const wxString& filename)
 {
-	// Save wad to disk
-	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
-	wad->save(filename);
-
 	// Get current nodebuilder
 	auto     builder = nodebuilders::builder(nodebuilder_id);
 	wxString command = builder.command;
@@ -742,7 +1019,7 @@ void MapEditorWindow::buildNodes(Archive* wad)
 
 	// Don't build if none selected
 	if (builder.id == "none")
-		return;
+		return {};
 
 	// Switch to ZDBSP if UDMF
 	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF && nodebuilder_id != "zdbsp")
@@ -771,45 +1048,227 @@ void MapEditorWindow::buildNodes(Archive* wad)
 		}
 	}
 
+	if (!wxFileExists(builder.path))
+	{
+		if (nb_warned)
+			log::info(1, "Nodebuilder path not set up, no nodes were built");
+		return {};
+	}
+
 	// Build command line
 	command.Replace("$f", wxString::Format("\"%s\"", filename));
 	command.Replace("$o", wxString(options));
 
-	// Run nodebuilder
-	if (wxFileExists(builder.path))
-	{
-		wxArrayString out;
-		log::info(wxString::Format("execute \"%s %s\"", builder.path, command));
-		wxGetApp().SetTopWindow(this);
-		auto focus = wxWindow::FindFocus();
-		wxExecute(wxString::Format("\"%s\" %s", builder.path, command), out, wxEXEC_HIDE_CONSOLE);
-		wxGetApp().SetTopWindow(maineditor::windowWx());
-		if (focus)
-			focus->SetFocusFromKbd();
-		log::info(1, "Nodebuilder output:");
-		for (const auto& line : out)
-			log::info(line);
+	return wxString::Format("\"%s\" %s", builder.path, command);
+}
+
+// -----------------------------------------------------------------------------
+// Runs the current nodebuilder on the wad at [filename], waiting for it to
+// finish. Returns false if no nodebuilder is configured
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::runNodeBuilder(const wxString& filename)
+{
+	auto command = nodeBuilderCommand(filename);
+	if (command.empty())
+		return false;
 
-		// Re-load wad
+	wxArrayString out;
+	log::info(wxString::Format("execute \"%s\"", command));
+	wxGetApp().SetTopWindow(this);
+	auto focus = wxWindow::FindFocus();
+	wxExecute(command, out, wxEXEC_HIDE_CONSOLE);
+	wxGetApp().SetTopWindow(maineditor::windowWx());
+	if (focus)
+		focus->SetFocusFromKbd();
+	log::info(1, "Nodebuilder output:");
+	for (const auto& line : out)
+		log::info(line);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Builds nodes for the maps in [wad], waiting for the nodebuilder to finish
+// -----------------------------------------------------------------------------
+void MapEditorWindow::buildNodes(Archive* wad)
+{
+	// Save wad to disk
+	auto filename = app::path("sladetemp.wad", app::Dir::Temp);
+	wad->save(filename);
+
+	// Run nodebuilder and re-load wad
+	if (runNodeBuilder(filename))
+	{
 		wad->close();
 		wad->open(filename);
 	}
-	else if (nb_warned)
-		log::info(1, "Nodebuilder path not set up, no nodes were built");
 }
 
 // -----------------------------------------------------------------------------
-// Writes the current map as [name] to a wad archive and returns it
+// Starts building GL nodes for the current map with the built-in node builder
+// in the background, from a snapshot of the map data. The built nodes are
+// written to [nodes] (left empty if they couldn't be built). If [fast] is
+// true, unoptimised nodes are built regardless of the configured options.
+// Returns the build job, or nullptr if the map format isn't supported
+// -----------------------------------------------------------------------------
+shared_ptr<Job> MapEditorWindow::startInternalNodeBuild(const shared_ptr<MemChunk>& nodes, bool fast) const
+{
+	auto& mdesc = mapeditor::editContext().mapDesc();
+	if (mdesc.format == MapFormat::Doom64)
+	{
+		log::warning("The built-in node builder doesn't support Doom64 format maps, no nodes were built");
+		return nullptr;
+	}
+
+	NodeBuilder::Options options;
+	options.fast                = fast || strutil::contains(nodebuilder_options, " --fast ");
+	options.compress            = !strutil::contains(nodebuilder_options, " --uncompressed ");
+	options.fractional_vertices = mdesc.format == MapFormat::UDMF;
+
+	// The snapshot is taken here (on the main thread), the job only reads it
+	auto snapshot = mapeditor::editContext().map().mapData().snapshot();
+	return Job::start([snapshot, nodes, options](Job&) {
+		NodeBuilder builder(options);
+		wxStopWatch timer;
+		if (!builder.build(*snapshot))
+		{
+			log::warning("Unable to build nodes: {}", builder.error());
+			return;
+		}
+		builder.write(*nodes);
+		log::info(
+			2,
+			"Built {} nodes, {} subsectors and {} segs in {}ms",
+			builder.nNodes(),
+			builder.nSubsectors(),
+			builder.nSegs(),
+			timer.Time());
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Adds GL [nodes] built by the built-in node builder (see
+// startInternalNodeBuild) to the map in [wad]
+// -----------------------------------------------------------------------------
+void MapEditorWindow::addInternalNodes(WadArchive& wad, MemChunk& nodes) const
+{
+	if (!nodes.hasData())
+		return;
+
+	auto& mdesc = mapeditor::editContext().mapDesc();
+	if (mdesc.format == MapFormat::UDMF)
+	{
+		// UDMF: ZNODES, before ENDMAP
+		auto entry = std::make_shared<ArchiveEntry>("ZNODES");
+		entry->importMemChunk(nodes);
+		wad.addEntry(entry, wad.entryIndex(wad.entry("ENDMAP")), nullptr);
+	}
+	else
+	{
+		// Binary formats: SSECTORS (with empty SEGS and NODES), after VERTEXES
+		auto index    = wad.entryIndex(wad.entry("VERTEXES")) + 1;
+		auto ssectors = std::make_shared<ArchiveEntry>("SSECTORS");
+		ssectors->importMemChunk(nodes);
+		wad.addEntry(std::make_shared<ArchiveEntry>("SEGS"), index, nullptr);
+		wad.addEntry(ssectors, index + 1, nullptr);
+		wad.addEntry(std::make_shared<ArchiveEntry>("NODES"), index + 2, nullptr);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Starts building nodes for the current (saved) map in the background. When
+// the nodebuilder finishes, the built nodes are swapped into the map entries
+// -----------------------------------------------------------------------------
+void MapEditorWindow::startNodeBuild()
+{
+	// A build of any previous save is now out of date
+	cancelNodeBuild();
+
+	// The built-in node builder is run when writing the map
+	if (nodebuilders::builder(nodebuilder_id).internal)
+		return;
+
+	auto& mdesc = mapeditor::editContext().mapDesc();
+	auto  head  = mdesc.head.lock();
+	if (!head || !head->parent())
+		return;
+
+	// Get nodebuilder command line
+	auto filename = app::path(fmt::format("sladetemp_nodes{}.wad", ++node_build_count), app::Dir::Temp);
+	auto command  = nodeBuilderCommand(filename);
+	if (command.empty())
+		return;
+
+	// Write the map to a temp wad
+	vector<ArchiveEntry*> entries;
+	if (mdesc.archive)
+	{
+		head->exportFile(filename);
+		entries.push_back(head.get());
+	}
+	else
+	{
+		WadArchive wad;
+		entries = mdesc.entries(*head->parent());
+		wad.addEntry(std::make_shared<ArchiveEntry>(*head), "");
+		for (auto entry : entries)
+			wad.addEntry(std::make_shared<ArchiveEntry>(*entry), "");
+		wad.save(filename);
+	}
+
+	// Run nodebuilder
+	auto process = new NodeBuildProcess(this, filename, head.get(), entries, mdesc.archive);
+	if (!process->start(command))
+	{
+		log::error("Unable to execute nodebuilder command: {}", command.ToStdString());
+		wxRemoveFile(filename);
+		delete process;
+		return;
+	}
+
+	node_build_ = process;
+	SetStatusText("Building nodes...", 0);
+}
+
+// -----------------------------------------------------------------------------
+// Cancels the current background node build, returns false if there wasn't
+// one running
 // -----------------------------------------------------------------------------
-bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes)
+bool MapEditorWindow::cancelNodeBuild()
+{
+	if (!node_build_)
+		return false;
+
+	node_build_->cancel();
+	node_build_ = nullptr;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the current map as [name] to a wad archive and returns it.
+// If [fast_nodes] is true and the built-in node builder is selected, it will
+// build unoptimised nodes
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes, bool fast_nodes)
 {
 	auto& mdesc_current = mapeditor::editContext().mapDesc();
 	auto& map           = mapeditor::editContext().map();
 
+	// Start building nodes with the built-in node builder, it works from a
+	// snapshot of the map so it can run while the map data is written
+	shared_ptr<Job> node_job;
+	auto            internal_nodes = std::make_shared<MemChunk>();
+	if (nodes && nodebuilders::builder(nodebuilder_id).internal)
+		node_job = startInternalNodeBuild(internal_nodes, fast_nodes);
+
 	// Get map data entries
 	vector<ArchiveEntry*> new_map_data;
 	if (!map.writeMap(new_map_data))
+	{
+		if (node_job)
+			node_job->wait();
 		return false;
+	}
 
 	// Check script language
 	bool acs = false;
@@ -847,7 +1306,18 @@ bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes
 
 	// Build nodes
 	if (nodes)
-		buildNodes(&wad);
+	{
+		if (nodebuilders::builder(nodebuilder_id).internal)
+		{
+			if (node_job)
+			{
+				node_job->wait();
+				addInternalNodes(wad, *internal_nodes);
+			}
+		}
+		else
+			buildNodes(&wad);
+	}
 
 	// Clear current map data
 	map_data_.clear();
@@ -859,22 +1329,67 @@ bool MapEditorWindow::writeMap(WadArchive& wad, const wxString& name, bool nodes
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Writes the current map as [name] to a temp wad for running alongside its
+// (on-disk) archive, and returns the wad's path (empty if writing failed).
+// Only the map itself is written, and nodes are either built quickly with the
+// built-in node builder or by running the nodebuilder directly on the temp wad
+// -----------------------------------------------------------------------------
+wxString MapEditorWindow::writeRunMap(const wxString& name)
+{
+	wxStopWatch timer;
+	bool        internal = nodebuilders::builder(nodebuilder_id).internal;
+
+	WadArchive wad;
+	if (!writeMap(wad, name, internal, true))
+		return {};
+
+	auto filename = app::path("sladetemp_run.wad", app::Dir::Temp);
+	if (!wad.save(filename))
+	{
+		log::error("Unable to write map to {}", filename);
+		return {};
+	}
+
+	if (!internal)
+		runNodeBuilder(filename);
+
+	log::info(2, "Wrote test map {} in {}ms", name.ToStdString(), timer.Time());
+
+	return filename;
+}
+
 // -----------------------------------------------------------------------------
 // Saves the current map to its archive, or opens the 'save as' dialog if it
-// doesn't currently belong to one
+// doesn't currently belong to one.
+// External node builders are run in the background after saving
 // -----------------------------------------------------------------------------
 bool MapEditorWindow::saveMap()
 {
-	auto& mdesc_current = mapeditor::editContext().mapDesc();
-
 	// Check for newly created map
-	auto current_head = mdesc_current.head.lock();
-	if (!current_head)
+	if (!mapeditor::editContext().mapDesc().head.lock())
 		return saveMapAs();
 
-	// Write map to temp wad
+	if (!saveMapEntries())
+		return false;
+
+	startNodeBuild();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the current map to its entries in its archive. Nodes are only written
+// if the built-in node builder is selected
+// -----------------------------------------------------------------------------
+bool MapEditorWindow::saveMapEntries()
+{
+	auto& mdesc_current = mapeditor::editContext().mapDesc();
+	auto  current_head  = mdesc_current.head.lock();
+
+	// Write map to temp wad (external node builders are run after saving)
 	WadArchive wad;
-	if (!writeMap(wad))
+	if (!writeMap(wad, "MAP01", nodebuilders::builder(nodebuilder_id).internal))
 		return false;
 
 	// Check for map archive
@@ -962,7 +1477,7 @@ bool MapEditorWindow::saveMapAs()
 	mdesc_current.head    = head;
 	mdesc_current.archive = false;
 	mdesc_current.end     = end;
-	saveMap();
+	saveMapEntries();
 
 	// Write wad to file
 	wad.save(info.filenames[0]);
@@ -981,6 +1496,9 @@ bool MapEditorWindow::saveMapAs()
 	// Set window title
 	SetTitle(wxString::Format("SLADE - %s of %s", mdesc_current.name, wad.filename(false)));
 
+	// Build nodes for the map in its new archive
+	startNodeBuild();
+
 	return true;
 }
 
@@ -1166,6 +1684,14 @@ bool MapEditorWindow::handleAction(string_view id)
 		return true;
 	}
 
+	// Map->Cancel Node Building
+	if (id == "mapw_cancel_nodebuild")
+	{
+		if (cancelNodeBuild())
+			SetStatusText("Node building cancelled", 0);
+		return true;
+	}
+
 	// Map->Restore Backup
 	if (id == "mapw_backup")
 	{
@@ -1303,6 +1829,26 @@ bool MapEditorWindow::handleAction(string_view id)
 		return true;
 	}
 
+	// View->3D View
+	else if (id == "mapw_show3dview")
+	{
+		auto  m_mgr = wxAuiManager::GetManager(this);
+		auto& p_inf = m_mgr->GetPane("map_view_3d");
+
+		// Toggle view, starting at the 3d mode camera
+		if (p_inf.IsShown())
+			p_inf.Show(false);
+		else
+		{
+			map_view_3d_->resetCamera();
+			p_inf.Show(true);
+		}
+
+		m_mgr->Update();
+		map_canvas_->SetFocus();
+		return true;
+	}
+
 	// View->Undo History
 	else if (id == "mapw_showundohistory")
 	{
@@ -1333,15 +1879,13 @@ bool MapEditorWindow::handleAction(string_view id)
 				edit_context.swapPlayerStart3d();
 
 			// Write temp wad
-			WadArchive wad;
-			if (writeMap(wad, mdesc_current.name))
-				wad.save(app::path("sladetemp_run.wad", app::Dir::Temp));
+			auto map_file = writeRunMap(mdesc_current.name);
 
 			// Reset player 1 start if moved
 			if (dlg.start3dModeChecked() || id == "mapw_run_map_here")
 				mapeditor::editContext().resetPlayerStart();
 
-			wxString command = dlg.selectedCommandLine(archive, mdesc_current.name, wad.filename());
+			wxString command = dlg.selectedCommandLine(archive, mdesc_current.name, map_file);
 			if (!command.IsEmpty())
 			{
 				// Set working directory
@@ -12,8 +12,10 @@ class ScriptEditorPanel;
 class ObjectEditPanel;
 class ObjectEditGroup;
 class WadArchive;
+class Job;
 class MapCanvas;
 class MapChecksPanel;
+class MapViewCanvas;
 class UndoManagerHistoryPanel;
 class UndoManager;
 class ArchiveEntry;
@@ -33,7 +35,7 @@ public:
 	bool chooseMap(Archive* archive = nullptr);
 	bool openMap(Archive::MapDesc map);
 	void loadMapScripts(Archive::MapDesc map);
-	bool writeMap(WadArchive& wad, const wxString& name = "MAP01", bool nodes = true);
+	bool writeMap(WadArchive& wad, const wxString& name = "MAP01", bool nodes = true, bool fast_nodes = false);
 	bool saveMap();
 	bool saveMapAs();
 	void closeMap() const;
@@ -54,6 +56,8 @@ public:
 	bool handleAction(string_view id) override;
 
 private:
+	class NodeBuildProcess;
+
 	MapCanvas*                       map_canvas_          = nullptr;
 	MapObjectPropsPanel*             panel_obj_props_     = nullptr;
 	ScriptEditorPanel*               panel_script_editor_ = nullptr;
@@ -61,10 +65,20 @@ private:
 	ObjectEditPanel*                 panel_obj_edit_     = nullptr;
 	MapChecksPanel*                  panel_checks_       = nullptr;
 	UndoManagerHistoryPanel*         panel_undo_history_ = nullptr;
+	MapViewCanvas*                   map_view_3d_        = nullptr;
 	wxMenu*                          menu_scripts_       = nullptr;
+	NodeBuildProcess*                node_build_         = nullptr;
 
-	void buildNodes(Archive* wad);
-	void lockMapEntries(bool lock = true) const;
+	bool            saveMapEntries();
+	wxString        writeRunMap(const wxString& name);
+	wxString        nodeBuilderCommand(const wxString& filename);
+	bool            runNodeBuilder(const wxString& filename);
+	void            buildNodes(Archive* wad);
+	shared_ptr<Job> startInternalNodeBuild(const shared_ptr<MemChunk>& nodes, bool fast) const;
+	void            addInternalNodes(WadArchive& wad, MemChunk& nodes) const;
+	void            startNodeBuild();
+	bool            cancelNodeBuild();
+	void            lockMapEntries(bool lock = true) const;
 
 	// Events
 	void onClose(wxCloseEvent& e);
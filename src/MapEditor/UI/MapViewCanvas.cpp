@@ -0,0 +1,215 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         https://slade.mancubus.net
+// Filename:    MapViewCanvas.cpp
+// Description: MapViewCanvas class, an OpenGL canvas showing an additional 3d
+//              view of the map being edited with its own camera, sharing all
+//              map rendering data with the map editor's 3d renderer
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapViewCanvas.h"
+#include "General/ColourConfiguration.h"
+#include "MapEditor/MapEditContext.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Int, map_bg_ms)
+
+
+// -----------------------------------------------------------------------------
+//
+// MapViewCanvas Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MapViewCanvas class constructor
+// -----------------------------------------------------------------------------
+MapViewCanvas::MapViewCanvas(wxWindow* parent, MapEditContext* context) :
+	OGLCanvas{ parent, -1, false },
+	context_{ context }
+{
+	resetCamera();
+
+	// Bind Events
+	Bind(wxEVT_LEFT_DOWN, &MapViewCanvas::onMouseDown, this);
+	Bind(wxEVT_RIGHT_DOWN, &MapViewCanvas::onMouseDown, this);
+	Bind(wxEVT_MIDDLE_DOWN, &MapViewCanvas::onMouseDown, this);
+	Bind(wxEVT_MOTION, &MapViewCanvas::onMouseMotion, this);
+	Bind(wxEVT_MOUSEWHEEL, &MapViewCanvas::onMouseWheel, this);
+	Bind(wxEVT_TIMER, &MapViewCanvas::onRTimer, this);
+	Bind(wxEVT_SIZE, [&](wxSizeEvent& e) {
+		redraw_ = true;
+		e.Skip();
+	});
+
+	timer_.Start(map_bg_ms, true);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the view's camera to [camera]
+// -----------------------------------------------------------------------------
+void MapViewCanvas::setCamera(const MapRenderer3D::Camera& camera)
+{
+	camera_ = camera;
+	redraw_ = true;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the view's camera to the map editor's 3d mode camera
+// -----------------------------------------------------------------------------
+void MapViewCanvas::resetCamera()
+{
+	setCamera(context_->renderer().renderer3D().camera());
+}
+
+// -----------------------------------------------------------------------------
+// Draws the map in 3d from the view's camera
+// -----------------------------------------------------------------------------
+void MapViewCanvas::draw()
+{
+	if (!IsEnabled())
+		return;
+
+	auto width  = GetSize().x;
+	auto height = GetSize().y;
+
+	// Setup the viewport
+	glViewport(0, 0, width, height);
+
+	// Setup GL state
+	auto col_bg = colourconfig::colour("map_background");
+	glClearColor(col_bg.fr(), col_bg.fg(), col_bg.fb(), 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+
+	// Render map
+	if (context_->map().nLines() > 0 && width > 0 && height > 0)
+		context_->renderer().renderer3D().renderView(camera_, width, height);
+
+	SwapBuffers();
+
+	last_frame_ = context_->renderer().frame();
+	redraw_     = false;
+}
+
+// -----------------------------------------------------------------------------
+// Applies [move] to the view's camera, using the 3d renderer's camera movement
+// functions
+// -----------------------------------------------------------------------------
+void MapViewCanvas::moveCamera(const std::function<void(MapRenderer3D&)>& move)
+{
+	auto& renderer = context_->renderer().renderer3D();
+	auto  prev     = renderer.camera();
+
+	renderer.setCamera(camera_);
+	move(renderer);
+	camera_ = renderer.camera();
+	renderer.setCamera(prev);
+
+	redraw_ = true;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapViewCanvas Class Events
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Called when a mouse button is pressed within the canvas
+// -----------------------------------------------------------------------------
+void MapViewCanvas::onMouseDown(wxMouseEvent& e)
+{
+	mouse_prev_ = e.GetPosition();
+	SetFocus();
+
+	e.Skip();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the mouse cursor is moved within the canvas. Dragging with the
+// left button looks around, with the right button moves forward/back and
+// strafes, and with the middle button moves up/down and strafes
+// -----------------------------------------------------------------------------
+void MapViewCanvas::onMouseMotion(wxMouseEvent& e)
+{
+	auto delta  = e.GetPosition() - mouse_prev_;
+	mouse_prev_ = e.GetPosition();
+	if (!e.Dragging() || (delta.x == 0 && delta.y == 0))
+		return;
+
+	if (e.LeftIsDown())
+		moveCamera([&](MapRenderer3D& renderer) { renderer.cameraLook(delta.x, delta.y); });
+	else if (e.RightIsDown())
+		moveCamera([&](MapRenderer3D& renderer) {
+			renderer.cameraMove(-delta.y * 2.0, false);
+			renderer.cameraStrafe(delta.x * 2.0);
+		});
+	else if (e.MiddleIsDown())
+		moveCamera([&](MapRenderer3D& renderer) {
+			renderer.cameraMoveUp(-delta.y * 2.0);
+			renderer.cameraStrafe(delta.x * 2.0);
+		});
+}
+
+// -----------------------------------------------------------------------------
+// Called when the mouse wheel is moved within the canvas, moves the camera
+// forward/back
+// -----------------------------------------------------------------------------
+void MapViewCanvas::onMouseWheel(wxMouseEvent& e)
+{
+	if (e.GetWheelRotation() == 0)
+		return;
+
+	auto distance = e.GetWheelRotation() > 0 ? 64.0 : -64.0;
+	moveCamera([&](MapRenderer3D& renderer) { renderer.cameraMove(distance); });
+}
+
+// -----------------------------------------------------------------------------
+// Called when the canvas timer is triggered, redraws the view if the camera
+// has moved or the map editor has started a new frame since it was last drawn
+// -----------------------------------------------------------------------------
+void MapViewCanvas::onRTimer(wxTimerEvent& e)
+{
+	if (IsShownOnScreen() && (redraw_ || last_frame_ != context_->renderer().frame()))
+		Refresh();
+
+	timer_.Start(map_bg_ms, true);
+}
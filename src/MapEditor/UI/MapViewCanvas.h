@@ -0,0 +1,42 @@
+#pragma once
+
+#include "MapEditor/Renderer/MapRenderer3D.h"
+#include "UI/Canvas/OGLCanvas.h"
+
+namespace slade
+{
+class MapEditContext;
+
+// An additional view of the map being edited, rendered in 3d from its own
+// camera. All map data (VBOs, textures and built walls/flats/things) is shared
+// with the map editor's 3d renderer, so any number of these can be shown
+// alongside the main map canvas without duplicating it
+class MapViewCanvas : public OGLCanvas
+{
+public:
+	MapViewCanvas(wxWindow* parent, MapEditContext* context);
+	~MapViewCanvas() = default;
+
+	const MapRenderer3D::Camera& camera() const { return camera_; }
+	void                         setCamera(const MapRenderer3D::Camera& camera);
+	void                         resetCamera();
+
+	// Drawing
+	void draw() override;
+
+private:
+	MapEditContext*       context_ = nullptr;
+	MapRenderer3D::Camera camera_;
+	unsigned long         last_frame_ = 0;
+	bool                  redraw_     = true;
+	wxPoint               mouse_prev_;
+
+	void moveCamera(const std::function<void(MapRenderer3D&)>& move);
+
+	// Events
+	void onMouseDown(wxMouseEvent& e);
+	void onMouseMotion(wxMouseEvent& e);
+	void onMouseWheel(wxMouseEvent& e);
+	void onRTimer(wxTimerEvent& e);
+};
+} // namespace slade
@@ -70,56 +70,108 @@ void MOPGProperty::resetValue()
 	openObjects(parent_->objects());
 }
 
-
-// -----------------------------------------------------------------------------
-//
-// MOPGBoolProperty Class Functions
-//
-// -----------------------------------------------------------------------------
-
-
-// -----------------------------------------------------------------------------
-// MOPGBoolProperty class constructor
-// -----------------------------------------------------------------------------
-MOPGBoolProperty::MOPGBoolProperty(const wxString& label, const wxString& name) :
-	MOPGProperty{ name }, wxBoolProperty(label, name, false)
-{
-}
-
 // -----------------------------------------------------------------------------
-// Reads the value of this boolean property from [objects]
+// Reads the value of this property from [objects]
 // (if the value differs between objects, it is set to unspecified)
 // -----------------------------------------------------------------------------
-void MOPGBoolProperty::openObjects(vector<MapObject*>& objects)
+void MOPGProperty::openObjects(vector<MapObject*>& objects)
 {
 	// Set unspecified if no objects given
 	if (objects.empty())
 	{
-		SetValueToUnspecified();
+		showReadValue(false);
 		return;
 	}
 
-	// Get property of first object
-	bool first = objects[0]->boolProperty(GetName().ToStdString());
-
 	// Check whether all objects share the same value
+	readFirstValue(objects[0]);
 	for (unsigned a = 1; a < objects.size(); a++)
 	{
-		if (objects[a]->boolProperty(GetName().ToStdString()) != first)
+		if (!readValueMatches(objects[a]))
 		{
 			// Different value found, set unspecified
-			SetValueToUnspecified();
+			showReadValue(false);
 			return;
 		}
 	}
 
 	// Set to common value
+	showReadValue(true);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the property value has been changed in the grid since the
+// object(s) were opened
+// -----------------------------------------------------------------------------
+bool MOPGProperty::isModified()
+{
+	auto pg_prop = dynamic_cast<wxPGProperty*>(this);
+	return pg_prop && pg_prop->HasFlag(wxPG_PROP_MODIFIED);
+}
+
+// -----------------------------------------------------------------------------
+// Sets the property to the value last read from the object(s) if [all_match]
+// is true, otherwise sets it to unspecified
+// -----------------------------------------------------------------------------
+void MOPGProperty::showReadValue(bool all_match)
+{
+	auto pg_prop = dynamic_cast<wxPGProperty*>(this);
+	if (!pg_prop)
+		return;
+
+	if (!all_match)
+	{
+		pg_prop->SetValueToUnspecified();
+		return;
+	}
+
 	noupdate_ = true;
-	SetValue(first);
+	setReadValue();
 	updateVisibility();
 	noupdate_ = false;
 }
 
+
+// -----------------------------------------------------------------------------
+//
+// MOPGBoolProperty Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MOPGBoolProperty class constructor
+// -----------------------------------------------------------------------------
+MOPGBoolProperty::MOPGBoolProperty(const wxString& label, const wxString& name) :
+	MOPGProperty{ name }, wxBoolProperty(label, name, false)
+{
+}
+
+// -----------------------------------------------------------------------------
+// Reads the value of this boolean property from [object]
+// -----------------------------------------------------------------------------
+void MOPGBoolProperty::readFirstValue(MapObject* object)
+{
+	value_ = object->boolProperty(key_);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGBoolProperty::readValueMatches(MapObject* object)
+{
+	return object->boolProperty(key_) == value_;
+}
+
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGBoolProperty::setReadValue()
+{
+	SetValue(value_);
+}
+
 // -----------------------------------------------------------------------------
 // Default to hiding this property if set to its default value.
 // -----------------------------------------------------------------------------
@@ -169,37 +221,28 @@ MOPGIntProperty::MOPGIntProperty(const wxString& label, const wxString& name) :
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this integer property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this integer property from [object]
 // -----------------------------------------------------------------------------
-void MOPGIntProperty::openObjects(vector<MapObject*>& objects)
+void MOPGIntProperty::readFirstValue(MapObject* object)
 {
-	// Assume unspecified until we see otherwise
-	SetValueToUnspecified();
-
-	// Set unspecified if no objects given
-	if (objects.empty())
-		return;
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	value_ = object->intProperty(key_);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGIntProperty::readValueMatches(MapObject* object)
+{
+	return object->intProperty(key_) == value_;
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGIntProperty::setReadValue()
+{
+	SetValue(value_);
 }
 
 // -----------------------------------------------------------------------------
@@ -251,37 +294,28 @@ MOPGFloatProperty::MOPGFloatProperty(const wxString& label, const wxString& name
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this float property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this float property from [object]
 // -----------------------------------------------------------------------------
-void MOPGFloatProperty::openObjects(vector<MapObject*>& objects)
+void MOPGFloatProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	double first = objects[0]->floatProperty(GetName().ToStdString());
+	value_ = object->floatProperty(key_);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->floatProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGFloatProperty::readValueMatches(MapObject* object)
+{
+	return object->floatProperty(key_) == value_;
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGFloatProperty::setReadValue()
+{
+	SetValue(value_);
 }
 
 // -----------------------------------------------------------------------------
@@ -355,37 +389,28 @@ void MOPGStringProperty::setUDMFProp(game::UDMFProperty* prop)
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this string property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this string property from [object]
 // -----------------------------------------------------------------------------
-void MOPGStringProperty::openObjects(vector<MapObject*>& objects)
+void MOPGStringProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	wxString first = objects[0]->stringProperty(GetName().ToStdString());
+	value_ = object->stringProperty(key_);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->stringProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGStringProperty::readValueMatches(MapObject* object)
+{
+	return object->stringProperty(key_) == value_;
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGStringProperty::setReadValue()
+{
+	SetValue(wxString(value_));
 }
 
 // -----------------------------------------------------------------------------
@@ -662,37 +687,20 @@ MOPGLineFlagProperty::MOPGLineFlagProperty(const wxString& label, const wxString
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this line flag property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this line flag property from [object]
 // -----------------------------------------------------------------------------
-void MOPGLineFlagProperty::openObjects(vector<MapObject*>& objects)
+void MOPGLineFlagProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Check flag against first object
-	bool first = game::configuration().lineFlagSet(index_, (MapLine*)objects[0]);
-
-	// Check whether all objects share the same flag setting
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (game::configuration().lineFlagSet(index_, (MapLine*)objects[a]) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+	value_ = game::configuration().lineFlagSet(index_, (MapLine*)object);
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGLineFlagProperty::readValueMatches(MapObject* object)
+{
+	return game::configuration().lineFlagSet(index_, (MapLine*)object) == value_;
 }
 
 // -----------------------------------------------------------------------------
@@ -732,37 +740,20 @@ MOPGThingFlagProperty::MOPGThingFlagProperty(const wxString& label, const wxStri
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this thing flag property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this thing flag property from [object]
 // -----------------------------------------------------------------------------
-void MOPGThingFlagProperty::openObjects(vector<MapObject*>& objects)
+void MOPGThingFlagProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Check flag against first object
-	bool first = game::configuration().thingFlagSet(index_, (MapThing*)objects[0]);
-
-	// Check whether all objects share the same flag setting
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (game::configuration().thingFlagSet(index_, (MapThing*)objects[a]) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+	value_ = game::configuration().thingFlagSet(index_, (MapThing*)object);
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGThingFlagProperty::readValueMatches(MapObject* object)
+{
+	return game::configuration().thingFlagSet(index_, (MapThing*)object) == value_;
 }
 
 // -----------------------------------------------------------------------------
@@ -823,37 +814,28 @@ MOPGAngleProperty::MOPGAngleProperty(const wxString& label, const wxString& name
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this angle property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this angle property from [object]
 // -----------------------------------------------------------------------------
-void MOPGAngleProperty::openObjects(vector<MapObject*>& objects)
+void MOPGAngleProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	value_ = object->intProperty(key_);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGAngleProperty::readValueMatches(MapObject* object)
+{
+	return object->intProperty(key_) == value_;
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGAngleProperty::setReadValue()
+{
+	SetValue(value_);
 }
 
 // -----------------------------------------------------------------------------
@@ -926,41 +908,32 @@ MOPGColourProperty::MOPGColourProperty(const wxString& label, const wxString& na
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this colour property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this colour property from [object]
 // -----------------------------------------------------------------------------
-void MOPGColourProperty::openObjects(vector<MapObject*>& objects)
+void MOPGColourProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
+	value_ = object->intProperty(key_);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGColourProperty::readValueMatches(MapObject* object)
+{
+	return object->intProperty(key_) == value_;
+}
 
-	// Set to common value
-	noupdate_ = true;
-	wxColour col(first);
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGColourProperty::setReadValue()
+{
+	wxColour col(value_);
 	col.Set(col.Blue(), col.Green(), col.Red());
 	wxVariant var_value;
 	var_value << col;
 	SetValue(var_value);
-	updateVisibility();
-	noupdate_ = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -1012,40 +985,6 @@ MOPGTextureProperty::MOPGTextureProperty(TextureType textype, const wxString& la
 	SetEditor(wxPGEditor_TextCtrlAndButton);
 }
 
-// -----------------------------------------------------------------------------
-// Reads the value of this texture property from [objects]
-// (if the value differs between objects, it is set to unspecified)
-// -----------------------------------------------------------------------------
-void MOPGTextureProperty::openObjects(vector<MapObject*>& objects)
-{
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	wxString first = objects[0]->stringProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->stringProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
-}
-
 // -----------------------------------------------------------------------------
 // Called when an event is raised for the control
 // -----------------------------------------------------------------------------
@@ -1094,38 +1033,30 @@ MOPGSPACTriggerProperty::MOPGSPACTriggerProperty(const wxString& label, const wx
 }
 
 // -----------------------------------------------------------------------------
-// Reads the value of this SPAC trigger property from [objects]
-// (if the value differs between objects, it is set to unspecified)
+// Reads the value of this SPAC trigger property from [object]
 // -----------------------------------------------------------------------------
-void MOPGSPACTriggerProperty::openObjects(vector<MapObject*>& objects)
+void MOPGSPACTriggerProperty::readFirstValue(MapObject* object)
 {
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	auto     map_format = mapeditor::editContext().mapDesc().format;
-	wxString first      = game::configuration().spacTriggerString(dynamic_cast<MapLine*>(objects[0]), map_format);
+	auto map_format = mapeditor::editContext().mapDesc().format;
+	value_          = game::configuration().spacTriggerString(dynamic_cast<MapLine*>(object), map_format);
+}
 
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (game::configuration().spacTriggerString(dynamic_cast<MapLine*>(objects[a]), map_format) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
+// -----------------------------------------------------------------------------
+// Returns true if [object]'s value for this property matches the value read
+// from the first object
+// -----------------------------------------------------------------------------
+bool MOPGSPACTriggerProperty::readValueMatches(MapObject* object)
+{
+	auto map_format = mapeditor::editContext().mapDesc().format;
+	return game::configuration().spacTriggerString(dynamic_cast<MapLine*>(object), map_format) == value_;
+}
 
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
+// -----------------------------------------------------------------------------
+// Sets the property to the value read from the object(s)
+// -----------------------------------------------------------------------------
+void MOPGSPACTriggerProperty::setReadValue()
+{
+	SetValue(wxString(value_));
 }
 
 // -----------------------------------------------------------------------------
@@ -1179,40 +1110,6 @@ MOPGTagProperty::MOPGTagProperty(IdType id_type, const wxString& label, const wx
 	SetEditor(wxPGEditor_TextCtrlAndButton);
 }
 
-// -----------------------------------------------------------------------------
-// Reads the value of this tag/id property from [objects]
-// (if the value differs between objects, it is set to unspecified)
-// -----------------------------------------------------------------------------
-void MOPGTagProperty::openObjects(vector<MapObject*>& objects)
-{
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
-}
-
 // -----------------------------------------------------------------------------
 // Called when an event is raised for the control
 // -----------------------------------------------------------------------------
@@ -1260,40 +1157,6 @@ MOPGSectorSpecialProperty::MOPGSectorSpecialProperty(const wxString& label, cons
 	SetEditor(wxPGEditor_TextCtrlAndButton);
 }
 
-// -----------------------------------------------------------------------------
-// Reads the value of this sector special property from [objects]
-// (if the value differs between objects, it is set to unspecified)
-// -----------------------------------------------------------------------------
-void MOPGSectorSpecialProperty::openObjects(vector<MapObject*>& objects)
-{
-	// Set unspecified if no objects given
-	if (objects.empty())
-	{
-		SetValueToUnspecified();
-		return;
-	}
-
-	// Get property of first object
-	int first = objects[0]->intProperty(GetName().ToStdString());
-
-	// Check whether all objects share the same value
-	for (unsigned a = 1; a < objects.size(); a++)
-	{
-		if (objects[a]->intProperty(GetName().ToStdString()) != first)
-		{
-			// Different value found, set unspecified
-			SetValueToUnspecified();
-			return;
-		}
-	}
-
-	// Set to common value
-	noupdate_ = true;
-	SetValue(first);
-	updateVisibility();
-	noupdate_ = false;
-}
-
 // -----------------------------------------------------------------------------
 // Returns the sector special value as a string
 // -----------------------------------------------------------------------------
@@ -15,7 +15,7 @@ class MapObjectPropsPanel;
 class MOPGProperty
 {
 public:
-	MOPGProperty(const wxString& prop_name) : propname_{ prop_name } {}
+	MOPGProperty(const wxString& prop_name) : propname_{ prop_name }, key_{ prop_name.ToStdString() } {}
 	virtual ~MOPGProperty() = default;
 
 	enum class Type
@@ -40,17 +40,29 @@ public:
 	void         setParent(MapObjectPropsPanel* parent) { parent_ = parent; }
 	virtual void setUDMFProp(game::UDMFProperty* prop) { udmf_prop_ = prop; }
 
-	virtual Type type()                                   = 0;
-	virtual void openObjects(vector<MapObject*>& objects) = 0;
-	virtual void updateVisibility()                       = 0;
+	virtual Type type()             = 0;
+	virtual void updateVisibility() = 0;
 	virtual void applyValue() {}
 	virtual void resetValue();
 
+	void openObjects(vector<MapObject*>& objects);
+	bool isModified();
+
+	// Reading the value from multiple objects: the value of the first object is
+	// read, then checked against each other object. If all objects had the
+	// same value it is shown, otherwise the value is set to unspecified
+	virtual void readFirstValue(MapObject* object)   = 0;
+	virtual bool readValueMatches(MapObject* object) = 0;
+	void         showReadValue(bool all_match);
+
 protected:
 	MapObjectPropsPanel* parent_    = nullptr;
 	bool                 noupdate_  = false;
 	game::UDMFProperty*  udmf_prop_ = nullptr;
 	wxString             propname_;
+	string               key_; // Property name for MapObject property access
+
+	virtual void setReadValue() = 0;
 };
 
 class MOPGBoolProperty : public MOPGProperty, public wxBoolProperty
@@ -59,9 +71,15 @@ public:
 	MOPGBoolProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Boolean; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
+
+protected:
+	bool value_ = false;
+
+	void setReadValue() override;
 };
 
 class MOPGIntProperty : public MOPGProperty, public wxIntProperty
@@ -70,9 +88,15 @@ public:
 	MOPGIntProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Integer; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
+
+protected:
+	int value_ = 0;
+
+	void setReadValue() override;
 };
 
 class MOPGFloatProperty : public MOPGProperty, public wxFloatProperty
@@ -81,9 +105,15 @@ public:
 	MOPGFloatProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Float; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
+
+protected:
+	double value_ = 0.;
+
+	void setReadValue() override;
 };
 
 class MOPGStringProperty : public MOPGProperty, public wxStringProperty
@@ -94,9 +124,15 @@ public:
 	void setUDMFProp(game::UDMFProperty* prop) override;
 
 	Type type() override { return Type::String; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
+
+protected:
+	string value_;
+
+	void setReadValue() override;
 };
 
 class MOPGIntWithArgsProperty : public MOPGIntProperty
@@ -157,8 +193,9 @@ public:
 	MOPGLineFlagProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL, int index = -1);
 
 	Type type() override { return Type::LineFlag; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
 
 private:
 	int index_;
@@ -170,8 +207,9 @@ public:
 	MOPGThingFlagProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL, int index = -1);
 
 	Type type() override { return Type::ThingFlag; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
 
 private:
 	int index_;
@@ -183,12 +221,18 @@ public:
 	MOPGAngleProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Angle; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
 
 	// wxPGProperty overrides
 	wxString ValueToString(wxVariant& value, int arg_flags = 0) const override;
+
+protected:
+	int value_ = 0;
+
+	void setReadValue() override;
 };
 
 class MOPGColourProperty : public MOPGProperty, public wxColourProperty
@@ -197,9 +241,15 @@ public:
 	MOPGColourProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Colour; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
+
+protected:
+	int value_ = 0;
+
+	void setReadValue() override;
 };
 
 class MOPGTextureProperty : public MOPGStringProperty
@@ -211,7 +261,6 @@ public:
 		const wxString&        name    = wxPG_LABEL);
 
 	Type type() override { return Type::Texture; }
-	void openObjects(vector<MapObject*>& objects) override;
 
 	// wxPGProperty overrides
 	bool OnEvent(wxPropertyGrid* propgrid, wxWindow* window, wxEvent& e) override;
@@ -226,9 +275,15 @@ public:
 	MOPGSPACTriggerProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::SPACTrigger; }
-	void openObjects(vector<MapObject*>& objects) override;
 	void updateVisibility() override;
 	void applyValue() override;
+	void readFirstValue(MapObject* object) override;
+	bool readValueMatches(MapObject* object) override;
+
+protected:
+	string value_;
+
+	void setReadValue() override;
 };
 
 class MOPGTagProperty : public MOPGIntProperty
@@ -244,7 +299,6 @@ public:
 	MOPGTagProperty(IdType id_type, const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::Id; }
-	void openObjects(vector<MapObject*>& objects) override;
 
 	// wxPGProperty overrides
 	bool OnEvent(wxPropertyGrid* propgrid, wxWindow* window, wxEvent& e) override;
@@ -259,7 +313,6 @@ public:
 	MOPGSectorSpecialProperty(const wxString& label = wxPG_LABEL, const wxString& name = wxPG_LABEL);
 
 	Type type() override { return Type::SectorSpecial; }
-	void openObjects(vector<MapObject*>& objects) override;
 
 	// wxPGProperty overrides
 	wxString ValueToString(wxVariant& value, int argFlags = 0) const override;
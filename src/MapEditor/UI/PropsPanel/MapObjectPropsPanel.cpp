@@ -964,53 +964,76 @@ void MapObjectPropsPanel::openObjects(vector<MapObject*>& objects)
 	// Find any custom properties (UDMF only)
 	if (mapeditor::editContext().mapDesc().format == MapFormat::UDMF)
 	{
+		std::set<string> prop_names;
+		for (auto& property : properties_)
+			prop_names.insert(property->propName().ToStdString());
+
 		for (auto& object : objects)
 		{
 			// Go through object properties
-			auto objprops = object->props().properties();
-			for (auto& prop : objprops)
+			for (auto& prop : object->props().properties())
 			{
+				const auto& name = prop.name();
+
 				// Ignore side property
-				if (strutil::startsWith(prop.name, "side1.") || strutil::startsWith(prop.name, "side2."))
+				if (strutil::startsWith(name, "side1.") || strutil::startsWith(name, "side2."))
+					continue;
+
+				// Check if property is already on the list
+				if (!prop_names.insert(name).second)
 					continue;
 
 				// Check if hidden
-				if (VECTOR_EXISTS(hide_props_, prop.name))
+				if (VECTOR_EXISTS(hide_props_, name))
 					continue;
 
-				// Check if property is already on the list
-				bool exists = false;
-				for (auto& property : properties_)
-				{
-					if (property->propName() == prop.name)
-					{
-						exists = true;
-						break;
-					}
-				}
+				// Create custom group if needed
+				if (!group_custom_)
+					group_custom_ = pg_properties_->Append(new wxPropertyCategory("Custom"));
 
-				if (!exists)
+				// Add property
+				switch (property::valueType(prop.value))
 				{
-					// Create custom group if needed
-					if (!group_custom_)
-						group_custom_ = pg_properties_->Append(new wxPropertyCategory("Custom"));
-
-					// Add property
-					switch (property::valueType(prop.value))
-					{
-					case property::ValueType::Bool: addBoolProperty(group_custom_, prop.name, prop.name); break;
-					case property::ValueType::Int: addIntProperty(group_custom_, prop.name, prop.name); break;
-					case property::ValueType::Float: addFloatProperty(group_custom_, prop.name, prop.name); break;
-					default: addStringProperty(group_custom_, prop.name, prop.name); break;
-					}
+				case property::ValueType::Bool: addBoolProperty(group_custom_, name, name); break;
+				case property::ValueType::Int: addIntProperty(group_custom_, name, name); break;
+				case property::ValueType::Float: addFloatProperty(group_custom_, name, name); break;
+				default: addStringProperty(group_custom_, name, name); break;
 				}
 			}
 		}
 	}
 
-	// Generic properties
-	for (auto& property : properties_)
-		property->openObjects(objects);
+	// Generic properties.
+	// All property values are read in a single pass over the objects, once an
+	// object with a different value is found a property isn't checked further
+	vector<unsigned> reading(properties_.size());
+	vector<bool>     all_match(properties_.size(), true);
+	for (unsigned p = 0; p < properties_.size(); ++p)
+	{
+		properties_[p]->readFirstValue(objects[0]);
+		reading[p] = p;
+	}
+	for (unsigned a = 1; a < objects.size() && !reading.empty(); ++a)
+	{
+		for (unsigned r = 0; r < reading.size();)
+		{
+			if (properties_[reading[r]]->readValueMatches(objects[a]))
+				++r;
+			else
+			{
+				all_match[reading[r]] = false;
+				reading[r]            = reading.back();
+				reading.pop_back();
+			}
+		}
+	}
+	for (unsigned p = 0; p < properties_.size(); ++p)
+		properties_[p]->showReadValue(all_match[p]);
+
+	// Nothing has been changed yet
+	pg_properties_->ClearModifiedStatus();
+	pg_props_side1_->ClearModifiedStatus();
+	pg_props_side2_->ClearModifiedStatus();
 
 	// Handle line sides
 	if (objects[0]->objType() == MapObject::Type::Line)
@@ -1087,9 +1110,11 @@ void MapObjectPropsPanel::updateArgs(MOPGIntWithArgsProperty* source)
 // -----------------------------------------------------------------------------
 void MapObjectPropsPanel::applyChanges()
 {
-	// Go through all current properties and apply the current value
+	// Go through all current properties and apply the current value, if it
+	// was changed (unchanged values are already the same for all objects)
 	for (auto& property : properties_)
-		property->applyValue();
+		if (property->isModified())
+			property->applyValue();
 }
 
 // -----------------------------------------------------------------------------
@@ -38,14 +38,184 @@ bool PropertyChangeUS::doRedo()
 }
 
 
+namespace
+{
+// Value type byte written in place of a property that isn't set
+constexpr uint8_t NO_VALUE = 0xFF;
+
+template<typename T> void pack(vector<uint8_t>& data, T value)
+{
+	auto pos = data.size();
+	data.resize(pos + sizeof(T));
+	memcpy(data.data() + pos, &value, sizeof(T));
+}
+
+template<typename T> T unpack(const uint8_t*& pos)
+{
+	T value;
+	memcpy(&value, pos, sizeof(T));
+	pos += sizeof(T);
+	return value;
+}
+
+// Writes [value] to [data] as its type byte followed by the value itself
+void packValue(vector<uint8_t>& data, const Property* value)
+{
+	if (!value)
+	{
+		data.push_back(NO_VALUE);
+		return;
+	}
+
+	data.push_back(static_cast<uint8_t>(value->index()));
+	switch (property::valueType(*value))
+	{
+	case property::ValueType::Bool:   data.push_back(std::get<bool>(*value) ? 1 : 0); break;
+	case property::ValueType::Int:    pack(data, std::get<int>(*value)); break;
+	case property::ValueType::UInt:   pack(data, std::get<unsigned>(*value)); break;
+	case property::ValueType::Float:  pack(data, std::get<double>(*value)); break;
+	case property::ValueType::String:
+	{
+		auto& str = std::get<string>(*value);
+		pack(data, static_cast<uint32_t>(str.size()));
+		data.insert(data.end(), str.begin(), str.end());
+		break;
+	}
+	}
+}
+
+// Reads a value written by packValue at [pos] and sets (or removes) property
+// [key] in [list] to it. If [list] is null the value is just skipped over
+void unpackValue(const uint8_t*& pos, PropertyList* list, property::Key key)
+{
+	auto type = *pos++;
+	if (type == NO_VALUE)
+	{
+		if (list)
+			list->remove(property::keyName(key));
+		return;
+	}
+
+	Property value;
+	switch (static_cast<property::ValueType>(type))
+	{
+	case property::ValueType::Bool:   value = *pos++ != 0; break;
+	case property::ValueType::Int:    value = unpack<int>(pos); break;
+	case property::ValueType::UInt:   value = unpack<unsigned>(pos); break;
+	case property::ValueType::Float:  value = unpack<double>(pos); break;
+	case property::ValueType::String:
+	{
+		auto length = unpack<uint32_t>(pos);
+		value       = string{ reinterpret_cast<const char*>(pos), length };
+		pos += length;
+		break;
+	}
+	}
+
+	if (list)
+		(*list)[property::keyName(key)] = std::move(value);
+}
+
+// Writes the properties that differ between [before] and [after] to [data]:
+//   [u32 object id][u32 field count]
+//   per field: [u8 list (0 = properties, 1 = internal)][u32 key][before][after]
+// Nothing is written if no properties differ
+void packDiff(vector<uint8_t>& data, const MapObject::Backup& before, const MapObject::Backup& after)
+{
+	auto start = data.size();
+	pack(data, static_cast<uint32_t>(before.id));
+	pack(data, static_cast<uint32_t>(0));
+
+	uint32_t count    = 0;
+	auto     add_diff = [&](uint8_t list, property::Key key, const Property* from, const Property* to) {
+		if (from && to && *from == *to)
+			return;
+
+		data.push_back(list);
+		pack(data, key);
+		packValue(data, from);
+		packValue(data, to);
+		++count;
+	};
+	auto diff_lists = [&](uint8_t list, const PropertyList& from, const PropertyList& to) {
+		for (auto& prop : from.properties())
+			add_diff(list, prop.key, &prop.value, to.find(prop.key));
+		for (auto& prop : to.properties())
+			if (!from.find(prop.key))
+				add_diff(list, prop.key, nullptr, &prop.value);
+	};
+	diff_lists(0, before.properties, after.properties);
+	diff_lists(1, before.props_internal, after.props_internal);
+
+	if (count == 0)
+		data.resize(start);
+	else
+		memcpy(data.data() + start + 4, &count, 4);
+}
+
+// Returns [ids] as [first id, count] runs of consecutive ids
+vector<unsigned> packIds(const vector<unsigned>& ids)
+{
+	vector<unsigned> runs;
+	for (auto id : ids)
+	{
+		if (!runs.empty() && runs[runs.size() - 2] + runs.back() == id)
+			++runs.back();
+		else
+		{
+			runs.push_back(id);
+			runs.push_back(1);
+		}
+	}
+
+	return runs;
+}
+
+// Returns the ids in [runs] (from packIds)
+vector<unsigned> unpackIds(const vector<unsigned>& runs)
+{
+	vector<unsigned> ids;
+	for (unsigned a = 0; a + 1 < runs.size(); a += 2)
+		for (unsigned i = 0; i < runs[a + 1]; ++i)
+			ids.push_back(runs[a] + i);
+
+	return ids;
+}
+
+// Returns the (packed) ids of all objects of [type] in [map], in index order
+vector<unsigned> objectIds(SLADEMap* map, MapObject::Type type)
+{
+	vector<unsigned> ids;
+	map->mapData().putObjectIdList(type, ids);
+	return packIds(ids);
+}
+
+bool writeIds(MemChunk& mc, const vector<unsigned>& list)
+{
+	auto count = static_cast<uint32_t>(list.size());
+	return mc.write(&count, 4) && (count == 0 || mc.write(list.data(), count * 4));
+}
+
+bool readIds(MemChunk& mc, vector<unsigned>& list)
+{
+	uint32_t count = 0;
+	if (!mc.read(&count, 4))
+		return false;
+
+	list.resize(count);
+	return count == 0 || mc.read(list.data(), count * 4);
+}
+} // namespace
+
+
 MapObjectCreateDeleteUS::MapObjectCreateDeleteUS()
 {
-	auto map = undoredo::currentMap();
-	map->mapData().putObjectIdList(MapObject::Type::Vertex, vertices_);
-	map->mapData().putObjectIdList(MapObject::Type::Line, lines_);
-	map->mapData().putObjectIdList(MapObject::Type::Side, sides_);
-	map->mapData().putObjectIdList(MapObject::Type::Sector, sectors_);
-	map->mapData().putObjectIdList(MapObject::Type::Thing, things_);
+	auto map  = undoredo::currentMap();
+	vertices_ = objectIds(map, MapObject::Type::Vertex);
+	lines_    = objectIds(map, MapObject::Type::Line);
+	sides_    = objectIds(map, MapObject::Type::Side);
+	sectors_  = objectIds(map, MapObject::Type::Sector);
+	things_   = objectIds(map, MapObject::Type::Thing);
 }
 
 void MapObjectCreateDeleteUS::swapLists()
@@ -58,42 +228,47 @@ void MapObjectCreateDeleteUS::swapLists()
 	vector<unsigned> things;
 	auto             map = undoredo::currentMap();
 	if (isValid(vertices_))
-		map->mapData().putObjectIdList(MapObject::Type::Vertex, vertices);
+		vertices = objectIds(map, MapObject::Type::Vertex);
 	if (isValid(lines_))
-		map->mapData().putObjectIdList(MapObject::Type::Line, lines);
+		lines = objectIds(map, MapObject::Type::Line);
 	if (isValid(sides_))
-		map->mapData().putObjectIdList(MapObject::Type::Side, sides);
+		sides = objectIds(map, MapObject::Type::Side);
 	if (isValid(sectors_))
-		map->mapData().putObjectIdList(MapObject::Type::Sector, sectors);
+		sectors = objectIds(map, MapObject::Type::Sector);
 	if (isValid(things_))
-		map->mapData().putObjectIdList(MapObject::Type::Thing, things);
+		things = objectIds(map, MapObject::Type::Thing);
 
 	// Restore
 	if (isValid(vertices_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Vertex, vertices_);
+		auto ids = unpackIds(vertices_);
+		map->restoreObjectIdList(MapObject::Type::Vertex, ids);
 		vertices_ = vertices;
 		map->updateGeometryInfo(0);
 	}
 	if (isValid(lines_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Line, lines_);
+		auto ids = unpackIds(lines_);
+		map->restoreObjectIdList(MapObject::Type::Line, ids);
 		lines_ = lines;
 		map->updateGeometryInfo(0);
 	}
 	if (isValid(sides_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Side, sides_);
+		auto ids = unpackIds(sides_);
+		map->restoreObjectIdList(MapObject::Type::Side, ids);
 		sides_ = sides;
 	}
 	if (isValid(sectors_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Sector, sectors_);
+		auto ids = unpackIds(sectors_);
+		map->restoreObjectIdList(MapObject::Type::Sector, ids);
 		sectors_ = sectors;
 	}
 	if (isValid(things_))
 	{
-		map->restoreObjectIdList(MapObject::Type::Thing, things_);
+		auto ids = unpackIds(things_);
+		map->restoreObjectIdList(MapObject::Type::Thing, ids);
 		things_ = things;
 	}
 }
@@ -114,99 +289,28 @@ void MapObjectCreateDeleteUS::checkChanges()
 {
 	auto map = undoredo::currentMap();
 
-	// Check vertices changed
-	bool vertices_changed = false;
-	if (map->nVertices() != vertices_.size())
-		vertices_changed = true;
-	else
-		for (unsigned a = 0; a < map->nVertices(); a++)
-			if (map->vertex(a)->objId() != vertices_[a])
-			{
-				vertices_changed = true;
-				break;
-			}
-	if (!vertices_changed)
-	{
-		// No change, clear
-		vertices_.clear();
-		vertices_.push_back(0);
-		log::info(3, "MapObjectCreateDeleteUS: No vertices added/deleted");
-	}
-
-	// Check lines changed
-	bool lines_changed = false;
-	if (map->nLines() != lines_.size())
-		lines_changed = true;
-	else
-		for (unsigned a = 0; a < map->nLines(); a++)
-			if (map->line(a)->objId() != lines_[a])
-			{
-				lines_changed = true;
-				break;
-			}
-	if (!lines_changed)
+	// Packed id lists are the same if the object ids (in order) are the same,
+	// clear any lists with no changes
+	struct IdList
 	{
-		// No change, clear
-		lines_.clear();
-		lines_.push_back(0);
-		log::info(3, "MapObjectCreateDeleteUS: No lines added/deleted");
-	}
-
-	// Check sides changed
-	bool sides_changed = false;
-	if (map->nSides() != sides_.size())
-		sides_changed = true;
-	else
-		for (unsigned a = 0; a < map->nSides(); a++)
-			if (map->side(a)->objId() != sides_[a])
-			{
-				sides_changed = true;
-				break;
-			}
-	if (!sides_changed)
-	{
-		// No change, clear
-		sides_.clear();
-		sides_.push_back(0);
-		log::info(3, "MapObjectCreateDeleteUS: No sides added/deleted");
-	}
-
-	// Check sectors changed
-	bool sectors_changed = false;
-	if (map->nSectors() != sectors_.size())
-		sectors_changed = true;
-	else
-		for (unsigned a = 0; a < map->nSectors(); a++)
-			if (map->sector(a)->objId() != sectors_[a])
-			{
-				sectors_changed = true;
-				break;
-			}
-	if (!sectors_changed)
+		vector<unsigned>* ids;
+		MapObject::Type   type;
+		const char*       name;
+	};
+	IdList lists[] = { { &vertices_, MapObject::Type::Vertex, "vertices" },
+					   { &lines_, MapObject::Type::Line, "lines" },
+					   { &sides_, MapObject::Type::Side, "sides" },
+					   { &sectors_, MapObject::Type::Sector, "sectors" },
+					   { &things_, MapObject::Type::Thing, "things" } };
+	for (auto& list : lists)
 	{
-		// No change, clear
-		sectors_.clear();
-		sectors_.push_back(0);
-		log::info(3, "MapObjectCreateDeleteUS: No sectors added/deleted");
-	}
+		if (*list.ids != objectIds(map, list.type))
+			continue;
 
-	// Check things changed
-	bool things_changed = false;
-	if (map->nThings() != things_.size())
-		things_changed = true;
-	else
-		for (unsigned a = 0; a < map->nThings(); a++)
-			if (map->thing(a)->objId() != things_[a])
-			{
-				things_changed = true;
-				break;
-			}
-	if (!things_changed)
-	{
 		// No change, clear
-		things_.clear();
-		things_.push_back(0);
-		log::info(3, "MapObjectCreateDeleteUS: No things added/deleted");
+		list.ids->clear();
+		list.ids->push_back(0);
+		log::info(3, "MapObjectCreateDeleteUS: No {} added/deleted", list.name);
 	}
 }
 
@@ -218,60 +322,115 @@ bool MapObjectCreateDeleteUS::isOk()
 		&& sides_[0] == 0 && sectors_.size() == 1 && sectors_[0] == 0 && things_.size() == 1 && things_[0] == 0);
 }
 
+unsigned MapObjectCreateDeleteUS::memoryUsage() const
+{
+	return (vertices_.size() + lines_.size() + sides_.size() + sectors_.size() + things_.size()) * sizeof(unsigned);
+}
+
+bool MapObjectCreateDeleteUS::writeFile(MemChunk& mc)
+{
+	return writeIds(mc, vertices_) && writeIds(mc, lines_) && writeIds(mc, sides_) && writeIds(mc, sectors_)
+		   && writeIds(mc, things_);
+}
+
+bool MapObjectCreateDeleteUS::readFile(MemChunk& mc)
+{
+	return readIds(mc, vertices_) && readIds(mc, lines_) && readIds(mc, sides_) && readIds(mc, sectors_)
+		   && readIds(mc, things_);
+}
+
+void MapObjectCreateDeleteUS::clearData()
+{
+	vertices_ = {};
+	lines_    = {};
+	sides_    = {};
+	sectors_  = {};
+	things_   = {};
+}
+
 
 
 MultiMapObjectPropertyChangeUS::MultiMapObjectPropertyChangeUS()
 {
-	// Get backups of recently modified map objects
-	auto objects = undoredo::currentMap()->mapData().allModifiedObjects(MapObject::propBackupTime());
+	// Get the changes to recently modified map objects since they were backed up
+	auto             objects = undoredo::currentMap()->mapData().allModifiedObjects(MapObject::propBackupTime());
+	vector<unsigned> ids;
 	for (auto& object : objects)
 	{
-		auto bak = object->backup(true);
-		if (bak)
-		{
-			backups_.emplace_back(bak);
-			// log::info(1, "%s #%d modified", objects[a]->getTypeName(), objects[a]->getIndex());
-		}
+		unique_ptr<MapObject::Backup> before{ object->backup(true) };
+		if (!before)
+			continue;
+
+		MapObject::Backup after;
+		object->backupTo(&after);
+
+		auto size = diffs_.size();
+		packDiff(diffs_, *before, after);
+		if (diffs_.size() > size)
+			ids.push_back(before->id);
 	}
+	diffs_.shrink_to_fit();
 
 	if (log::verbosity() >= 2)
 	{
 		string msg = "Modified ids: ";
-		for (auto& backup : backups_)
-			msg += fmt::format("{}, ", backup->id);
+		for (auto id : ids)
+			msg += fmt::format("{}, ", id);
 		log::info(msg);
 	}
 }
 
-void MultiMapObjectPropertyChangeUS::doSwap(MapObject* obj, unsigned index)
+void MultiMapObjectPropertyChangeUS::applyDiffs(bool undo) const
 {
-	auto temp = std::make_unique<MapObject::Backup>();
-	obj->backupTo(temp.get());
-	obj->loadFromBackup(backups_[index].get());
-	backups_[index].swap(temp);
-}
-
-bool MultiMapObjectPropertyChangeUS::doUndo()
-{
-	for (unsigned a = 0; a < backups_.size(); a++)
+	auto&             map_data = undoredo::currentMap()->mapData();
+	auto              pos      = diffs_.data();
+	auto              end      = pos + diffs_.size();
+	MapObject::Backup backup;
+	while (pos < end)
 	{
-		auto obj = undoredo::currentMap()->mapData().getObjectById(backups_[a]->id);
+		auto id    = unpack<uint32_t>(pos);
+		auto count = unpack<uint32_t>(pos);
+		auto obj   = map_data.getObjectById(id);
+		if (obj)
+			obj->backupTo(&backup);
+
+		for (unsigned a = 0; a < count; ++a)
+		{
+			auto list = *pos++ == 0 ? &backup.properties : &backup.props_internal;
+			auto key  = unpack<property::Key>(pos);
+			unpackValue(pos, obj && undo ? list : nullptr, key);
+			unpackValue(pos, obj && !undo ? list : nullptr, key);
+		}
+
 		if (obj)
-			doSwap(obj, a);
+			obj->loadFromBackup(&backup);
 	}
+}
 
+bool MultiMapObjectPropertyChangeUS::doUndo()
+{
+	applyDiffs(true);
 	return true;
 }
 
 bool MultiMapObjectPropertyChangeUS::doRedo()
 {
-	// log::info(2, "Restore %lu objects", backups.size());
-	for (unsigned a = 0; a < backups_.size(); a++)
-	{
-		auto obj = undoredo::currentMap()->mapData().getObjectById(backups_[a]->id);
-		if (obj)
-			doSwap(obj, a);
-	}
-
+	applyDiffs(false);
 	return true;
 }
+
+bool MultiMapObjectPropertyChangeUS::writeFile(MemChunk& mc)
+{
+	auto size = static_cast<uint32_t>(diffs_.size());
+	return mc.write(&size, 4) && (size == 0 || mc.write(diffs_.data(), size));
+}
+
+bool MultiMapObjectPropertyChangeUS::readFile(MemChunk& mc)
+{
+	uint32_t size = 0;
+	if (!mc.read(&size, 4))
+		return false;
+
+	diffs_.resize(size);
+	return size == 0 || mc.read(diffs_.data(), size);
+}
@@ -34,7 +34,13 @@ public:
 	void checkChanges();
 	bool isOk() override;
 
+	unsigned memoryUsage() const override;
+	bool     writeFile(MemChunk& mc) override;
+	bool     readFile(MemChunk& mc) override;
+	void     clearData() override;
+
 private:
+	// Object id lists, stored as [first id, count] runs of consecutive ids
 	vector<unsigned> vertices_;
 	vector<unsigned> lines_;
 	vector<unsigned> sides_;
@@ -49,12 +55,20 @@ public:
 	MultiMapObjectPropertyChangeUS();
 	~MultiMapObjectPropertyChangeUS() = default;
 
-	void doSwap(MapObject* obj, unsigned index);
 	bool doUndo() override;
 	bool doRedo() override;
-	bool isOk() override { return !backups_.empty(); }
+	bool isOk() override { return !diffs_.empty(); }
+
+	unsigned memoryUsage() const override { return diffs_.size(); }
+	bool     writeFile(MemChunk& mc) override;
+	bool     readFile(MemChunk& mc) override;
+	void     clearData() override { diffs_ = {}; }
 
 private:
-	vector<unique_ptr<MapObject::Backup>> backups_;
+	// The properties that changed for each modified object, with their values
+	// before and after the change (see packDiff in UndoSteps.cpp)
+	vector<uint8_t> diffs_;
+
+	void applyDiffs(bool undo) const;
 };
 } // namespace slade::mapeditor
@@ -88,6 +88,7 @@ int drawing::fontSize()
 // -----------------------------------------------------------------------------
 void drawing::drawLine(Vec2d start, Vec2d end)
 {
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(start.x, start.y);
 	glVertex2d(end.x, end.y);
@@ -99,6 +100,7 @@ void drawing::drawLine(Vec2d start, Vec2d end)
 // -----------------------------------------------------------------------------
 void drawing::drawLine(double x1, double y1, double x2, double y2)
 {
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(x1, y1);
 	glVertex2d(x2, y2);
@@ -111,6 +113,7 @@ void drawing::drawLine(double x1, double y1, double x2, double y2)
 void drawing::drawLineTabbed(Vec2d start, Vec2d end, double tab, double tab_max)
 {
 	// Draw line
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(start.x, start.y);
 	glVertex2d(end.x, end.y);
@@ -133,6 +136,7 @@ void drawing::drawLineTabbed(Vec2d start, Vec2d end, double tab, double tab_max)
 	invdir.normalize();
 
 	// Draw tab
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(mid.x, mid.y);
 	glVertex2d(mid.x - invdir.x * tablen, mid.y - invdir.y * tablen);
@@ -164,6 +168,7 @@ void drawing::drawArrow(Vec2d p1, Vec2d p2, const ColRGBA& color, bool twoway, d
 		a2r.y -= arrowhead_length * cos(angle + arrowhead_angle);
 	}
 	gl::setColour(color);
+	gl::countDrawCall();
 	glBegin(GL_LINES);
 	glVertex2d(p1.x, p1.y);
 	glVertex2d(p2.x, p2.y);
@@ -174,10 +179,12 @@ void drawing::drawArrow(Vec2d p1, Vec2d p2, const ColRGBA& color, bool twoway, d
 	glEnd();
 	if (twoway)
 	{
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(p2.x, p2.y);
 		glVertex2d(a2l.x, a2l.y);
 		glEnd();
+		gl::countDrawCall();
 		glBegin(GL_LINES);
 		glVertex2d(p2.x, p2.y);
 		glVertex2d(a2r.x, a2r.y);
@@ -190,6 +197,7 @@ void drawing::drawArrow(Vec2d p1, Vec2d p2, const ColRGBA& color, bool twoway, d
 // -----------------------------------------------------------------------------
 void drawing::drawRect(Vec2d tl, Vec2d br)
 {
+	gl::countDrawCall();
 	glBegin(GL_LINE_LOOP);
 	glVertex2d(tl.x, tl.y);
 	glVertex2d(tl.x, br.y);
@@ -203,6 +211,7 @@ void drawing::drawRect(Vec2d tl, Vec2d br)
 // -----------------------------------------------------------------------------
 void drawing::drawRect(double x1, double y1, double x2, double y2)
 {
+	gl::countDrawCall();
 	glBegin(GL_LINE_LOOP);
 	glVertex2d(x1, y1);
 	glVertex2d(x1, y2);
@@ -216,6 +225,7 @@ void drawing::drawRect(double x1, double y1, double x2, double y2)
 // -----------------------------------------------------------------------------
 void drawing::drawFilledRect(Vec2d tl, Vec2d br)
 {
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glVertex2d(tl.x, tl.y);
 	glVertex2d(tl.x, br.y);
@@ -229,6 +239,7 @@ void drawing::drawFilledRect(Vec2d tl, Vec2d br)
 // -----------------------------------------------------------------------------
 void drawing::drawFilledRect(double x1, double y1, double x2, double y2)
 {
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glVertex2d(x1, y1);
 	glVertex2d(x1, y2);
@@ -258,6 +269,7 @@ void drawing::drawBorderedRect(
 {
 	// Rect
 	gl::setColour(colour);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glVertex2d(x1, y1);
 	glVertex2d(x1, y2);
@@ -267,6 +279,7 @@ void drawing::drawBorderedRect(
 
 	// Border
 	gl::setColour(border_colour);
+	gl::countDrawCall();
 	glBegin(GL_LINE_LOOP);
 	glVertex2d(x1, y1);
 	glVertex2d(x1, y2 - 1);
@@ -284,6 +297,7 @@ void drawing::drawEllipse(Vec2d mid, double radius_x, double radius_y, int sides
 	gl::setColour(colour);
 
 	// Draw circle as line loop
+	gl::countDrawCall();
 	glBegin(GL_LINE_LOOP);
 	double rot = 0;
 	for (int a = 0; a < sides; a++)
@@ -303,6 +317,7 @@ void drawing::drawFilledEllipse(Vec2d mid, double radius_x, double radius_y, int
 	gl::setColour(colour);
 
 	// Draw circle as triangle fan
+	gl::countDrawCall();
 	glBegin(GL_TRIANGLE_FAN);
 	glVertex2d(mid.x, mid.y);
 	double rot = 0;
@@ -346,6 +361,7 @@ void drawing::drawTexture(unsigned id, double x, double y, bool flipx, bool flip
 	glTranslated(x, y, 0);
 
 	// Draw
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2d(0, 0);
 	glVertex2d(0, 0);
@@ -378,6 +394,7 @@ void drawing::drawTextureTiled(unsigned id, uint32_t width, uint32_t height)
 	double tex_y    = (double)height / (double)tex_info.size.y;
 
 	// Draw
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2d(0, 0);
 	glVertex2d(0, 0);
@@ -478,6 +495,7 @@ void drawing::drawTextureWithin(
 	glTranslated(x1 + width * 0.5, y1 + height * 0.5, 0); // Translate to middle of area
 	glScaled(scale, scale, scale);                        // Scale to fit within area
 	glTranslated(x_dim * -0.5, y_dim * -0.5, 0);
+	gl::countDrawCall();
 	glBegin(GL_QUADS);
 	glTexCoord2d(0, 0);
 	glVertex2d(0, 0);
@@ -93,6 +93,8 @@ namespace drawing
 		Align         alignment = Align::Left,
 		Rectd*        bounds    = nullptr);
 	Vec2d textExtents(const string& text, Font font = Font::Normal);
+	void  beginTextBatch();
+	void  endTextBatch();
 	void  enableTextStateReset(bool enable = true);
 	void  setTextState(bool set = true);
 	void  setTextOutline(double thickness, const ColRGBA& colour = ColRGBA::BLACK);
@@ -0,0 +1,319 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    DrawingFreeType.cpp
+// Description: FreeType (glyph atlas) implementation of OpenGL text drawing
+//              functions. Text is drawn as textured quads from a GlyphAtlas
+//              for each font, and text drawn between beginTextBatch and
+//              endTextBatch is drawn all at once, with one draw call per font
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#ifndef USE_SFML_RENDERWINDOW
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/ArchiveManager.h"
+#include "Drawing.h"
+#include "GLTexture.h"
+#include "General/UI.h"
+#include "GlyphAtlas.h"
+#include "OpenGL.h"
+#include "Utility/MathStuff.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace slade::drawing
+{
+// Vertex of a queued glyph quad
+struct TextVertex
+{
+	float   x, y;
+	float   u, v;
+	uint8_t r, g, b, a;
+};
+
+// A font's glyph atlas and the text queued to be drawn with it
+struct FontText
+{
+	unique_ptr<gl::GlyphAtlas> atlas;
+	vector<TextVertex>         vertices;
+	unsigned                   vbo = 0;
+};
+
+FontText fonts[6]; // Normal, Condensed, Bold, BoldCondensed, Monospace, Small
+bool     text_batch = false;
+} // namespace slade::drawing
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+namespace slade::drawing
+{
+extern double  text_outline_width;
+extern ColRGBA outline_colour;
+} // namespace slade::drawing
+EXTERN_CVAR(Int, gl_font_size)
+
+
+// -----------------------------------------------------------------------------
+//
+// drawing Namespace Functions
+//
+// -----------------------------------------------------------------------------
+namespace slade::drawing
+{
+// -----------------------------------------------------------------------------
+// Loads all needed fonts for rendering. Non-SFML implementation
+// -----------------------------------------------------------------------------
+int initFonts()
+{
+	struct FontDef
+	{
+		Font        font;
+		const char* path;
+		unsigned    size;
+	};
+	unsigned size   = ui::scalePx(gl_font_size);
+	FontDef  defs[] = {
+		{ Font::Normal, "fonts/dejavu_sans.ttf", size },
+		{ Font::Condensed, "fonts/dejavu_sans_c.ttf", size },
+		{ Font::Bold, "fonts/dejavu_sans_b.ttf", size },
+		{ Font::BoldCondensed, "fonts/dejavu_sans_cb.ttf", size },
+		{ Font::Monospace, "fonts/dejavu_mono.ttf", size },
+		{ Font::Small, "fonts/dejavu_sans.ttf", static_cast<unsigned>(size * 0.6) + 1 },
+	};
+
+	// --- Load general fonts ---
+	int ret = 0;
+	cleanupFonts();
+	for (const auto& def : defs)
+	{
+		auto entry = app::archiveManager().programResourceArchive()->entryAtPath(def.path);
+		if (!entry)
+			continue;
+
+		// Open font, checking it loaded ok
+		auto atlas = std::make_unique<gl::GlyphAtlas>();
+		if (atlas->open(entry->rawData(), entry->size(), def.size))
+		{
+			fonts[static_cast<int>(def.font)].atlas = std::move(atlas);
+			++ret;
+		}
+	}
+
+	return ret;
+}
+
+// -----------------------------------------------------------------------------
+// Cleans up all created fonts
+// -----------------------------------------------------------------------------
+void cleanupFonts()
+{
+	for (auto& font : fonts)
+	{
+		font.atlas.reset();
+		font.vertices.clear();
+		if (font.vbo)
+			glDeleteBuffers(1, &font.vbo);
+		font.vbo = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the requested [font], or nullptr if it isn't loaded
+// -----------------------------------------------------------------------------
+FontText* getFont(Font font)
+{
+	auto& text = fonts[static_cast<int>(font)];
+	return text.atlas ? &text : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds the glyph quads in [layout] at [x,y] with [colour] to the text queued
+// for [font]
+// -----------------------------------------------------------------------------
+void queueText(FontText& font, const gl::GlyphAtlas::Layout& layout, float x, float y, const ColRGBA& colour)
+{
+	for (const auto& vertex : layout.vertices)
+		font.vertices.push_back(
+			{ vertex.x + x, vertex.y + y, vertex.u, vertex.v, colour.r, colour.g, colour.b, colour.a });
+}
+
+// -----------------------------------------------------------------------------
+// Draws all text queued for [font]
+// -----------------------------------------------------------------------------
+void drawQueued(FontText& font)
+{
+	if (font.vertices.empty())
+		return;
+
+	font.atlas->updateTexture();
+
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+	glEnable(GL_BLEND);
+	glEnable(GL_TEXTURE_2D);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	gl::Texture::bind(font.atlas->texture());
+
+	// Upload to the font's VBO if supported (otherwise draw from memory)
+	auto base = reinterpret_cast<const char*>(font.vertices.data());
+	if (gl::vboSupport())
+	{
+		auto bytes = font.vertices.size() * sizeof(TextVertex);
+		if (!font.vbo)
+			glGenBuffers(1, &font.vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, font.vbo);
+		glBufferData(GL_ARRAY_BUFFER, bytes, base, GL_STREAM_DRAW);
+		gl::countUpload(bytes);
+		base = nullptr;
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), base);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), base + offsetof(TextVertex, u));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), base + offsetof(TextVertex, r));
+	gl::countDrawCall();
+	glDrawArrays(GL_QUADS, 0, font.vertices.size());
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glPopAttrib();
+	font.vertices.clear();
+}
+} // namespace slade::drawing
+
+// -----------------------------------------------------------------------------
+// Draws [text] at [x,y]. If [bounds] is not null, the bounding coordinates of
+// the rendered text string are written to it.
+// -----------------------------------------------------------------------------
+void drawing::drawText(const string& text, int x, int y, ColRGBA colour, Font font, Align alignment, Rectd* bounds)
+{
+	// Get desired font
+	auto font_text = getFont(font);
+
+	// If font is invalid, do nothing
+	if (!font_text)
+		return;
+
+	// Setup alignment
+	auto& layout = font_text->atlas->layout(text);
+	float xpos   = x;
+	float ypos   = y;
+	float width  = layout.width();
+	if (alignment != Align::Left)
+	{
+		if (alignment == Align::Center)
+			xpos -= math::round(width * 0.5);
+		else
+			xpos -= width;
+	}
+
+	// Set bounds rect
+	if (bounds)
+		bounds->set(xpos + layout.left, ypos, xpos + layout.right, ypos + font_text->atlas->lineHeight());
+
+	// Queue the string (and outline if set)
+	xpos -= 0.375f;
+	ypos -= 0.375f;
+	if (text_outline_width > 0)
+	{
+		queueText(*font_text, layout, xpos - 2.0f, ypos + 1.0f, outline_colour);
+		queueText(*font_text, layout, xpos - 2.0f, ypos - 1.0f, outline_colour);
+		queueText(*font_text, layout, xpos + 2.0f, ypos - 1.0f, outline_colour);
+		queueText(*font_text, layout, xpos + 2.0f, ypos + 1.0f, outline_colour);
+	}
+	queueText(*font_text, layout, xpos, ypos, colour);
+
+	// Draw now unless batching
+	if (!text_batch)
+		drawQueued(*font_text);
+	gl::setColour(colour);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the width and height of [text] when drawn with [font]
+// -----------------------------------------------------------------------------
+Vec2d drawing::textExtents(const string& text, Font font)
+{
+	// Get desired font
+	auto font_text = getFont(font);
+
+	// If font is invalid, return empty
+	if (!font_text)
+		return { 0, 0 };
+
+	// Return width and height of text
+	return Vec2d(font_text->atlas->layout(text).width(), font_text->atlas->lineHeight());
+}
+
+// -----------------------------------------------------------------------------
+// Starts a text batch - text drawn with drawText is queued and drawn all at
+// once (one draw call per font) when endTextBatch is called. The modelview
+// matrix must not change until then
+// -----------------------------------------------------------------------------
+void drawing::beginTextBatch()
+{
+	text_batch = true;
+}
+
+// -----------------------------------------------------------------------------
+// Ends the current text batch, drawing all text queued since beginTextBatch
+// -----------------------------------------------------------------------------
+void drawing::endTextBatch()
+{
+	text_batch = false;
+	for (auto& font : fonts)
+		if (font.atlas)
+			drawQueued(font);
+}
+
+// -----------------------------------------------------------------------------
+// Sets or restores (depending on [set]) the OpenGL state for SFML text
+// rendering (does nothing for FreeType)
+// -----------------------------------------------------------------------------
+void drawing::setTextState(bool set) {}
+
+// -----------------------------------------------------------------------------
+// When enabled, the OpenGL state is set for text rendering each time drawText
+// is called and restored after (SFML only, does nothing for FreeType)
+// -----------------------------------------------------------------------------
+void drawing::enableTextStateReset(bool enable) {}
+
+#endif
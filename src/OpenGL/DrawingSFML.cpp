@@ -225,6 +225,16 @@ Vec2d drawing::textExtents(const string& text, Font font)
 	return { rect.width, rect.height };
 }
 
+// -----------------------------------------------------------------------------
+// Starts a text batch (does nothing for SFML, text is always drawn immediately)
+// -----------------------------------------------------------------------------
+void drawing::beginTextBatch() {}
+
+// -----------------------------------------------------------------------------
+// Ends the current text batch (does nothing for SFML)
+// -----------------------------------------------------------------------------
+void drawing::endTextBatch() {}
+
 // -----------------------------------------------------------------------------
 // Sets or restores (depending on [set]) the OpenGL state for SFML text
 // rendering
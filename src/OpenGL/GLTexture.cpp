@@ -33,6 +33,7 @@
 #include "GLTexture.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL.h"
+#include "TexCompress.h"
 
 using namespace slade;
 
@@ -49,7 +50,9 @@ namespace
 std::map<unsigned, gl::Texture> textures;
 gl::Texture                     tex_missing;
 gl::Texture                     tex_background;
-unsigned                        last_bound_tex = 0;
+unsigned                        last_bound_tex  = 0;
+gl::Texture*                    last_bound_info = nullptr;
+unsigned                        current_frame   = 0;
 } // namespace
 
 
@@ -185,10 +188,10 @@ unsigned gl::Texture::createFromData(
 // -----------------------------------------------------------------------------
 // Creates a new OpenGL texture from [image], using [pal] if necessary
 // -----------------------------------------------------------------------------
-unsigned gl::Texture::createFromImage(const SImage& image, Palette* pal, TexFilter filter, bool tiling)
+unsigned gl::Texture::createFromImage(const SImage& image, Palette* pal, TexFilter filter, bool tiling, bool compress)
 {
 	auto id = create(filter, tiling);
-	if (!loadImage(id, image, pal))
+	if (!loadImage(id, image, pal, compress))
 	{
 		clear(id);
 		return 0;
@@ -268,7 +271,117 @@ bool gl::Texture::loadData(unsigned id, const uint8_t* data, unsigned width, uns
 		glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	}
 
-	tex_info.size = { (int)width, (int)height };
+	tex_info.size       = { (int)width, (int)height };
+	tex_info.compressed = false;
+	tex_info.evicted    = false;
+	tex_info.memory     = static_cast<size_t>(width) * height * 4;
+	if (tex_info.filter == TexFilter::Mipmap || tex_info.filter == TexFilter::LinearMipmap
+		|| tex_info.filter == TexFilter::NearestMipmap)
+		tex_info.memory = tex_info.memory * 4 / 3;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads RGBA [data] of [width]x[height] to the OpenGL texture [id], block
+// compressed (BC1, or BC3 if it has any translucent pixels) to use less video
+// memory. Mipmaps (if the texture filter uses them) are generated and
+// compressed on the CPU across the thread pool.
+// If texture compression isn't supported or enabled, this is the same as
+// loadData
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadCompressedData(unsigned id, const uint8_t* data, unsigned width, unsigned height)
+{
+	if (!textureCompressionSupport())
+		return loadData(id, data, width, height);
+
+	// Check given id
+	if (id == 0 || id == tex_missing.id || id == tex_background.id)
+	{
+		log::warning("Unable to load OpenGL texture with id {} - invalid or built-in texture", id);
+		return false;
+	}
+
+	// Check image dimensions
+	if (!validTexDimension(width) || !validTexDimension(height))
+	{
+		log::warning("Attempt to create OpenGL texture of invalid size {}x{}", width, height);
+		return false;
+	}
+
+	bind(id);
+
+	// Set texture params
+	auto& tex_info = textures[id];
+	auto  wrap     = tex_info.tiling ? GL_REPEAT : GL_CLAMP;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+	GLint mag     = GL_NEAREST;
+	GLint min     = GL_NEAREST;
+	bool  mipmaps = false;
+	switch (tex_info.filter)
+	{
+	case TexFilter::Linear: mag = min = GL_LINEAR; break;
+	case TexFilter::Mipmap:
+	case TexFilter::LinearMipmap:
+		mag     = GL_LINEAR;
+		min     = GL_LINEAR_MIPMAP_LINEAR;
+		mipmaps = true;
+		break;
+	case TexFilter::NearestMipmap:
+		min     = GL_LINEAR_MIPMAP_LINEAR;
+		mipmaps = true;
+		break;
+	case TexFilter::NearestLinearMin: min = GL_LINEAR; break;
+	default: break;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
+
+	// Generate mipmaps and compress each level
+	auto levels    = generateMipmaps(data, width, height, mipmaps);
+	auto format    = hasTranslucency(levels[0]) ? BlockFormat::BC3 : BlockFormat::BC1;
+	auto gl_format = format == BlockFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	tex_info.memory = 0;
+	for (unsigned a = 0; a < levels.size(); ++a)
+	{
+		auto blocks = compressBlocks(levels[a], format);
+		glCompressedTexImage2D(
+			GL_TEXTURE_2D, a, gl_format, levels[a].width, levels[a].height, 0, blocks.size(), blocks.data());
+		tex_info.memory += blocks.size();
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels.size() - 1);
+
+	tex_info.size       = { (int)width, (int)height };
+	tex_info.compressed = true;
+	tex_info.evicted    = false;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Replaces the [width]x[height] area at [x],[y] of the (already loaded)
+// OpenGL texture [id] with RGBA [data]. Mipmaps are not regenerated, so this
+// is intended for textures without them (eg. atlases)
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadSubData(unsigned id, const uint8_t* data, int x, int y, unsigned width, unsigned height)
+{
+	// Check OpenGL is initialised
+	if (!gl::isInitialised())
+		return false;
+
+	// Check the area is within the texture
+	auto& tex_info = info(id);
+	if (tex_info.id != id || x < 0 || y < 0 || x + (int)width > tex_info.size.x || y + (int)height > tex_info.size.y)
+	{
+		log::warning("Unable to update area {},{} {}x{} of OpenGL texture with id {}", x, y, width, height, id);
+		return false;
+	}
+
+	bind(id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
 
 	return true;
 }
@@ -276,7 +389,7 @@ bool gl::Texture::loadData(unsigned id, const uint8_t* data, unsigned width, uns
 // -----------------------------------------------------------------------------
 // Loads [image] to the OpenGL texture [id], using [pal] if necessary
 // -----------------------------------------------------------------------------
-bool gl::Texture::loadImage(unsigned id, const SImage& image, Palette* pal)
+bool gl::Texture::loadImage(unsigned id, const SImage& image, Palette* pal, bool compress)
 {
 	// Check image dimensions
 	if (validTexDimension(image.width()) && validTexDimension(image.height()))
@@ -286,6 +399,8 @@ bool gl::Texture::loadImage(unsigned id, const SImage& image, Palette* pal)
 		image.putRGBAData(rgba, pal);
 
 		// Generate GL texture from rgba data
+		if (compress)
+			return loadCompressedData(id, rgba.data(), image.width(), image.height());
 		return loadData(id, rgba.data(), image.width(), image.height());
 	}
 
@@ -293,6 +408,124 @@ bool gl::Texture::loadImage(unsigned id, const SImage& image, Palette* pal)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Loads [data] of [width]x[height] palette index + alpha pairs to the OpenGL
+// texture [id] as a luminance+alpha texture. The texture is always nearest
+// filtered, since palette indices can't be interpolated. [id] should only
+// be used for index data, since it is updated in place if the size matches
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadIndexedData(unsigned id, const uint8_t* data, unsigned width, unsigned height)
+{
+	// Check OpenGL is initialised
+	if (!gl::isInitialised())
+		return false;
+
+	// Check given id
+	if (id == 0 || id == tex_missing.id || id == tex_background.id)
+	{
+		log::warning("Unable to load OpenGL texture with id {} - invalid or built-in texture", id);
+		return false;
+	}
+
+	// Check image dimensions
+	if (!validTexDimension(width) || !validTexDimension(height))
+	{
+		log::warning("Attempt to create OpenGL texture of invalid size {}x{}", width, height);
+		return false;
+	}
+
+	bind(id);
+
+	// Set texture params
+	auto& tex_info = textures[id];
+	auto  wrap     = tex_info.tiling ? GL_REPEAT : GL_CLAMP;
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+	// Generate the texture, or just update it if the size hasn't changed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	auto same_size = tex_info.size.x == static_cast<int>(width) && tex_info.size.y == static_cast<int>(height);
+	if (same_size && !tex_info.compressed)
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, data);
+	else
+		glTexImage2D(
+			GL_TEXTURE_2D, 0, GL_LUMINANCE8_ALPHA8, width, height, 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, data);
+
+	tex_info.size       = { (int)width, (int)height };
+	tex_info.compressed = false;
+	tex_info.evicted    = false;
+	tex_info.memory     = static_cast<size_t>(width) * height * 2;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Loads RGBA [data] containing [layers] images of [width]x[height] (one after
+// the other) to the OpenGL texture [id] as an array texture
+// -----------------------------------------------------------------------------
+bool gl::Texture::loadArrayData(unsigned id, const uint8_t* data, unsigned width, unsigned height, unsigned layers)
+{
+	// Check OpenGL is initialised
+	if (!gl::isInitialised() || !arrayTextureSupport())
+		return false;
+
+	// Check given id
+	if (id == 0 || id == tex_missing.id || id == tex_background.id)
+	{
+		log::warning("Unable to load OpenGL array texture with id {} - invalid or built-in texture", id);
+		return false;
+	}
+
+	// Check dimensions
+	if (!validTexDimension(width) || !validTexDimension(height) || layers == 0 || layers > maxArrayTextureLayers())
+	{
+		log::warning("Attempt to create OpenGL array texture of invalid size {}x{}x{}", width, height, layers);
+		return false;
+	}
+
+	bindArray(id);
+
+	// Set texture params
+	auto& tex_info = textures[id];
+	auto  wrap     = tex_info.tiling ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+	glTexParameteri(GL_TEXTURE_2D_ARRAY_EXT, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY_EXT, GL_TEXTURE_WRAP_T, wrap);
+
+	// Get filters (mipmaps can only be generated for array textures with
+	// glGenerateMipmap, otherwise the equivalent non-mipmapped filter is used)
+	GLint mag = GL_NEAREST;
+	GLint min = GL_NEAREST;
+	switch (tex_info.filter)
+	{
+	case TexFilter::Linear: mag = min = GL_LINEAR; break;
+	case TexFilter::Mipmap:
+	case TexFilter::LinearMipmap:
+		mag = GL_LINEAR;
+		min = glGenerateMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+		break;
+	case TexFilter::NearestMipmap: min = glGenerateMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST; break;
+	case TexFilter::NearestLinearMin: min = GL_LINEAR; break;
+	default: break;
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY_EXT, GL_TEXTURE_MAG_FILTER, mag);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY_EXT, GL_TEXTURE_MIN_FILTER, min);
+
+	// Generate the texture
+	glTexImage3D(GL_TEXTURE_2D_ARRAY_EXT, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	if (min == GL_LINEAR_MIPMAP_LINEAR)
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY_EXT);
+
+	tex_info.size   = { (int)width, (int)height };
+	tex_info.layers = layers;
+	tex_info.memory = static_cast<size_t>(width) * height * layers * 4;
+	if (min == GL_LINEAR_MIPMAP_LINEAR)
+		tex_info.memory = tex_info.memory * 4 / 3;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Generates a 'chequerboard' texture using colours [col1] and [col2] and loads
 // it to OpenGL texture [id]
@@ -409,20 +642,32 @@ ColRGBA gl::Texture::averageColour(unsigned id, Recti area)
 }
 
 // -----------------------------------------------------------------------------
-// Binds the OpenGL texture [id] for use (unless it is already bound)
+// Binds the OpenGL texture [id] for use (unless it is already bound), and
+// marks it as used in the current frame
 // -----------------------------------------------------------------------------
 void gl::Texture::bind(unsigned id, bool force)
 {
-	if (force)
-	{
-		glBindTexture(GL_TEXTURE_2D, id);
-		last_bound_tex = id;
-	}
-	else if (id != last_bound_tex)
+	if (force || id != last_bound_tex)
 	{
 		glBindTexture(GL_TEXTURE_2D, id);
+		gl::countTextureBind();
 		last_bound_tex = id;
+
+		auto i          = textures.find(id);
+		last_bound_info = i != textures.end() ? &i->second : nullptr;
 	}
+
+	if (last_bound_info)
+		last_bound_info->last_used = current_frame;
+}
+
+// -----------------------------------------------------------------------------
+// Binds the OpenGL array texture [id] for use
+// -----------------------------------------------------------------------------
+void gl::Texture::bindArray(unsigned id)
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY_EXT, id);
+	gl::countTextureBind();
 }
 
 // -----------------------------------------------------------------------------
@@ -446,6 +691,73 @@ void gl::Texture::clearAll()
 		glDeleteTextures(1, &tex.second.id);
 
 	textures.clear();
-	tex_missing    = {};
-	tex_background = {};
+	tex_missing     = {};
+	tex_background  = {};
+	last_bound_tex  = 0;
+	last_bound_info = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Frees the video memory used by the OpenGL texture [id], but keeps the id
+// (and its info) so that it can be reloaded later with the same id. Anything
+// still drawing it will draw nothing until it is reloaded
+// -----------------------------------------------------------------------------
+void gl::Texture::evict(unsigned id)
+{
+	if (id == 0 || id == tex_missing.id || id == tex_background.id)
+		return;
+
+	auto& tex_info = textures[id];
+	if (tex_info.id == 0 || tex_info.evicted || tex_info.layers > 0)
+		return;
+
+	// Replace all mip levels with empty images (without marking it as used)
+	auto last_used = tex_info.last_used;
+	bind(id);
+	for (int level = 0; (tex_info.size.x >> level) > 0 || (tex_info.size.y >> level) > 0; ++level)
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	tex_info.last_used = last_used;
+
+	tex_info.memory     = 0;
+	tex_info.compressed = false;
+	tex_info.evicted    = true;
+}
+
+// -----------------------------------------------------------------------------
+// Starts a new frame, textures bound after this are marked as used in it
+// -----------------------------------------------------------------------------
+void gl::Texture::nextFrame()
+{
+	++current_frame;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the current frame number (see nextFrame)
+// -----------------------------------------------------------------------------
+unsigned gl::Texture::currentFrame()
+{
+	return current_frame;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (estimated) video memory used by all currently loaded textures
+// -----------------------------------------------------------------------------
+gl::MemoryUsage gl::Texture::memoryUsage()
+{
+	MemoryUsage usage;
+	for (auto& tex : textures)
+	{
+		if (tex.second.id == 0 || tex.second.memory == 0)
+			continue;
+
+		usage.total += tex.second.memory;
+		usage.n_textures++;
+		if (tex.second.compressed)
+		{
+			usage.compressed += tex.second.memory;
+			usage.n_compressed++;
+		}
+	}
+
+	return usage;
 }
@@ -20,12 +20,26 @@ namespace gl
 		NearestMipmap,
 	};
 
+	// Estimated video memory used by all textures
+	struct MemoryUsage
+	{
+		size_t   total        = 0; // Bytes
+		size_t   compressed   = 0; // Bytes used by compressed textures
+		unsigned n_textures   = 0;
+		unsigned n_compressed = 0;
+	};
+
 	struct Texture
 	{
-		unsigned  id     = 0;
-		Vec2i     size   = { 0, 0 };
-		TexFilter filter = TexFilter::Nearest;
-		bool      tiling = true;
+		unsigned  id         = 0;
+		Vec2i     size       = { 0, 0 };
+		TexFilter filter     = TexFilter::Nearest;
+		bool      tiling     = true;
+		unsigned  layers     = 0;     // Number of layers if this is an array texture
+		bool      compressed = false; // True if the texture is block compressed (see loadCompressedData)
+		size_t    memory     = 0;     // Estimated video memory used (bytes)
+		unsigned  last_used  = 0;     // Frame the texture was last bound in (see nextFrame)
+		bool      evicted    = false; // True if the texture's video memory was freed (see evict)
 
 		static bool isCreated(unsigned id); // const { return id > 0; }
 		static bool isLoaded(unsigned id);  // const { return id > 0 && size.x > 0 && size.y > 0; }
@@ -33,6 +47,7 @@ namespace gl
 		static const Texture& info(unsigned id);
 		static ColRGBA        averageColour(unsigned id, Recti area);
 		static void           bind(unsigned id, bool force = true);
+		static void           bindArray(unsigned id);
 
 		static unsigned missingTexture();
 		static unsigned backgroundTexture();
@@ -47,14 +62,25 @@ namespace gl
 			bool           tiling = true);
 		static unsigned createFromImage(
 			const SImage& image,
-			Palette*      pal    = nullptr,
-			TexFilter     filter = TexFilter::Nearest,
-			bool          tiling = true);
+			Palette*      pal      = nullptr,
+			TexFilter     filter   = TexFilter::Nearest,
+			bool          tiling   = true,
+			bool          compress = false);
 		static bool loadData(unsigned id, const uint8_t* data, unsigned width, unsigned height);
-		static bool loadImage(unsigned id, const SImage& image, Palette* pal = nullptr);
+		static bool loadCompressedData(unsigned id, const uint8_t* data, unsigned width, unsigned height);
+		static bool loadSubData(unsigned id, const uint8_t* data, int x, int y, unsigned width, unsigned height);
+		static bool loadImage(unsigned id, const SImage& image, Palette* pal = nullptr, bool compress = false);
+		static bool loadIndexedData(unsigned id, const uint8_t* data, unsigned width, unsigned height);
+		static bool loadArrayData(unsigned id, const uint8_t* data, unsigned width, unsigned height, unsigned layers);
 		static bool genChequeredTexture(unsigned id, uint8_t block_size, ColRGBA col1, ColRGBA col2);
 		static void clear(unsigned id);
 		static void clearAll();
+		static void evict(unsigned id);
+
+		static void     nextFrame();
+		static unsigned currentFrame();
+
+		static MemoryUsage memoryUsage();
 	};
 
 } // namespace gl
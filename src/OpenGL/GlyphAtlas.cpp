@@ -0,0 +1,371 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    GlyphAtlas.cpp
+// Description: GlyphAtlas class - a font rendered with FreeType, with glyphs
+//              packed into a single OpenGL texture as they are first used.
+//              Strings are laid out as textured quads so any amount of text in
+//              a font can be drawn in one go
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#ifndef USE_SFML_RENDERWINDOW
+#include "GlyphAtlas.h"
+#include "GLTexture.h"
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+using namespace slade;
+using namespace gl;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Max. height of the atlas texture, glyphs that don't fit aren't drawn
+constexpr unsigned MAX_ATLAS_HEIGHT = 2048;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the unicode character starting at [pos] in the UTF-8 string [text],
+// and moves [pos] to the start of the next character. Invalid bytes are
+// returned as-is
+// -----------------------------------------------------------------------------
+char32_t nextChar(const string& text, size_t& pos)
+{
+	auto lead = static_cast<uint8_t>(text[pos++]);
+
+	unsigned extra;
+	char32_t code;
+	if (lead < 0x80)
+		return lead;
+	else if ((lead & 0xE0) == 0xC0)
+	{
+		extra = 1;
+		code  = lead & 0x1F;
+	}
+	else if ((lead & 0xF0) == 0xE0)
+	{
+		extra = 2;
+		code  = lead & 0x0F;
+	}
+	else if ((lead & 0xF8) == 0xF0)
+	{
+		extra = 3;
+		code  = lead & 0x07;
+	}
+	else
+		return lead;
+
+	for (unsigned a = 0; a < extra; ++a)
+	{
+		if (pos >= text.size() || (static_cast<uint8_t>(text[pos]) & 0xC0) != 0x80)
+			return lead;
+
+		code = (code << 6) | (static_cast<uint8_t>(text[pos++]) & 0x3F);
+	}
+
+	return code;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// GlyphAtlas Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// GlyphAtlas class destructor
+// -----------------------------------------------------------------------------
+GlyphAtlas::~GlyphAtlas()
+{
+	if (texture_)
+		Texture::clear(texture_);
+	if (face_)
+		FT_Done_Face(face_);
+	if (library_)
+		FT_Done_FreeType(library_);
+}
+
+// -----------------------------------------------------------------------------
+// Opens the font file [data] of [size] bytes, rendering glyphs at [face_size]
+// pixels. Any glyphs and layouts from a previously opened font are cleared.
+// Returns false if the font couldn't be opened
+// -----------------------------------------------------------------------------
+bool GlyphAtlas::open(const uint8_t* data, unsigned size, unsigned face_size)
+{
+	if (!library_ && FT_Init_FreeType(&library_) != 0)
+	{
+		log::error("Unable to initialise FreeType");
+		library_ = nullptr;
+		return false;
+	}
+
+	// Clear any current font
+	if (face_)
+		FT_Done_Face(face_);
+	face_ = nullptr;
+	glyphs_.clear();
+	layouts_.clear();
+	pixels_.clear();
+	height_ = texture_height_ = 0;
+	pen_x_ = pen_y_ = row_height_ = 0;
+	dirty_top_ = dirty_bottom_ = -1;
+
+	// Open font (FreeType reads glyphs from the data as they are loaded, so it
+	// needs to be kept)
+	data_.importMem(data, size);
+	if (FT_New_Memory_Face(library_, data_.data(), data_.size(), 0, &face_) != 0
+		|| FT_Set_Pixel_Sizes(face_, 0, face_size) != 0)
+	{
+		if (face_)
+			FT_Done_Face(face_);
+		face_ = nullptr;
+		data_.clear();
+		return false;
+	}
+
+	face_size_   = face_size;
+	line_height_ = face_->size->metrics.height / 64.f;
+	kerning_     = FT_HAS_KERNING(face_);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the layout of the UTF-8 string [text], with the glyphs positioned
+// so that the top of the text is at 0 (and the baseline at faceSize).
+// The returned layout is only valid until the next call to this function
+// -----------------------------------------------------------------------------
+const GlyphAtlas::Layout& GlyphAtlas::layout(const string& text)
+{
+	auto cached = layouts_.find(text);
+	if (cached != layouts_.end())
+		return cached->second;
+
+	// Get glyphs and their positions first, since adding glyphs to the atlas
+	// can change the texture coordinates of existing ones
+	vector<std::pair<const Glyph*, float>> glyphs;
+	float                                  pen      = 0.f;
+	unsigned                               previous = 0;
+	for (size_t pos = 0; face_ && pos < text.size();)
+	{
+		auto glyph = this->glyph(nextChar(text, pos));
+		if (kerning_ && previous && glyph->index)
+		{
+			FT_Vector kerning;
+			if (FT_Get_Kerning(face_, previous, glyph->index, FT_KERNING_DEFAULT, &kerning) == 0)
+				pen += kerning.x / 64.f;
+		}
+
+		glyphs.emplace_back(glyph, pen);
+		pen += glyph->advance;
+		previous = glyph->index;
+	}
+
+	// Build glyph quads
+	Layout layout;
+	bool   ink = false;
+	float  tw  = 1.f / ATLAS_WIDTH;
+	float  th  = height_ > 0 ? 1.f / height_ : 0.f;
+	for (const auto& [glyph, x] : glyphs)
+	{
+		if (glyph->width == 0)
+			continue;
+
+		float x1 = x + glyph->left;
+		float y1 = static_cast<float>(face_size_) - glyph->top;
+		float x2 = x1 + glyph->width;
+		float y2 = y1 + glyph->height;
+		float u1 = glyph->x * tw;
+		float v1 = glyph->y * th;
+		float u2 = (glyph->x + glyph->width) * tw;
+		float v2 = (glyph->y + glyph->height) * th;
+		layout.vertices.push_back({ x1, y1, u1, v1 });
+		layout.vertices.push_back({ x2, y1, u2, v1 });
+		layout.vertices.push_back({ x2, y2, u2, v2 });
+		layout.vertices.push_back({ x1, y2, u1, v2 });
+
+		layout.left  = ink ? std::min(layout.left, x1) : x1;
+		layout.right = ink ? std::max(layout.right, x2) : x2;
+		ink          = true;
+	}
+	if (!ink)
+		layout.right = pen;
+
+	// Cache layout (starting again when there are too many)
+	if (layouts_.size() >= MAX_LAYOUTS)
+		layouts_.clear();
+	return layouts_.emplace(text, std::move(layout)).first->second;
+}
+
+// -----------------------------------------------------------------------------
+// Uploads any glyphs added to the atlas since the last update to its OpenGL
+// texture, creating the texture if needed
+// -----------------------------------------------------------------------------
+void GlyphAtlas::updateTexture()
+{
+	if (pixels_.empty())
+		return;
+
+	// Create texture or upload the whole atlas if it has grown
+	if (!texture_ || !Texture::isCreated(texture_))
+	{
+		texture_        = Texture::createFromData(pixels_.data(), ATLAS_WIDTH, height_, TexFilter::Linear, false);
+		texture_height_ = height_;
+	}
+	else if (texture_height_ != height_)
+	{
+		Texture::loadData(texture_, pixels_.data(), ATLAS_WIDTH, height_);
+		texture_height_ = height_;
+	}
+
+	// Otherwise just the rows with new glyphs
+	else if (dirty_top_ >= 0)
+		Texture::loadSubData(
+			texture_,
+			pixels_.data() + dirty_top_ * ATLAS_WIDTH * 4,
+			0,
+			dirty_top_,
+			ATLAS_WIDTH,
+			dirty_bottom_ - dirty_top_);
+
+	dirty_top_ = dirty_bottom_ = -1;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the glyph for the unicode character [code], rendering it and adding
+// it to the atlas if it hasn't been used yet
+// -----------------------------------------------------------------------------
+const GlyphAtlas::Glyph* GlyphAtlas::glyph(char32_t code)
+{
+	auto existing = glyphs_.find(code);
+	if (existing != glyphs_.end())
+		return &existing->second;
+
+	auto& glyph = glyphs_[code];
+	glyph.index = FT_Get_Char_Index(face_, code);
+	if (FT_Load_Glyph(face_, glyph.index, FT_LOAD_RENDER) != 0)
+		return &glyph;
+
+	auto slot     = face_->glyph;
+	glyph.left    = slot->bitmap_left;
+	glyph.top     = slot->bitmap_top;
+	glyph.advance = slot->advance.x / 64.f;
+
+	// Add the rendered glyph to the atlas (if it has anything to draw)
+	auto& bitmap = slot->bitmap;
+	if (bitmap.pixel_mode == FT_PIXEL_MODE_GRAY && bitmap.width > 0 && bitmap.rows > 0)
+	{
+		glyph.width  = bitmap.width;
+		glyph.height = bitmap.rows;
+		if (!addToAtlas(glyph, bitmap.buffer, bitmap.pitch))
+			glyph.width = glyph.height = 0;
+	}
+
+	return &glyph;
+}
+
+// -----------------------------------------------------------------------------
+// Finds space for [glyph] in the atlas (growing it if needed) and copies its
+// 8-bit coverage [bitmap] there.
+// Returns false if the atlas is full
+// -----------------------------------------------------------------------------
+bool GlyphAtlas::addToAtlas(Glyph& glyph, const uint8_t* bitmap, int pitch)
+{
+	// Glyphs are packed in rows, with a 1 pixel gap so they don't bleed into
+	// each other when filtered
+	if (glyph.width + 1 > static_cast<int>(ATLAS_WIDTH))
+		return false;
+	if (pen_x_ + glyph.width + 1 > static_cast<int>(ATLAS_WIDTH))
+	{
+		pen_x_ = 0;
+		pen_y_ += row_height_ + 1;
+		row_height_ = 0;
+	}
+
+	// Grow the atlas if needed
+	unsigned bottom = pen_y_ + glyph.height + 1;
+	if (bottom > height_)
+	{
+		auto height = std::max(height_, 64u);
+		while (height < bottom)
+			height *= 2;
+		if (height > MAX_ATLAS_HEIGHT)
+			return false;
+
+		// New rows are transparent white
+		pixels_.resize(ATLAS_WIDTH * height * 4);
+		for (auto a = ATLAS_WIDTH * height_ * 4; a < pixels_.size(); a += 4)
+		{
+			pixels_[a]     = 255;
+			pixels_[a + 1] = 255;
+			pixels_[a + 2] = 255;
+			pixels_[a + 3] = 0;
+		}
+		height_ = height;
+
+		// Texture coordinates of cached layouts are now wrong
+		layouts_.clear();
+	}
+
+	// Copy glyph coverage to the alpha channel
+	glyph.x = pen_x_;
+	glyph.y = pen_y_;
+	for (int row = 0; row < glyph.height; ++row)
+	{
+		auto src = bitmap + row * pitch;
+		auto dst = pixels_.data() + ((glyph.y + row) * ATLAS_WIDTH + glyph.x) * 4 + 3;
+		for (int col = 0; col < glyph.width; ++col)
+			dst[col * 4] = src[col];
+	}
+
+	pen_x_ += glyph.width + 1;
+	row_height_ = std::max(row_height_, glyph.height);
+
+	// Mark the rows for upload to the texture
+	dirty_top_    = dirty_top_ < 0 ? glyph.y : std::min(dirty_top_, glyph.y);
+	dirty_bottom_ = std::max(dirty_bottom_, glyph.y + glyph.height);
+
+	return true;
+}
+
+#endif
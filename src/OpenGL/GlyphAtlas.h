@@ -0,0 +1,87 @@
+#pragma once
+
+// FreeType handles
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+namespace slade::gl
+{
+// A font rendered with FreeType, with each glyph packed into a single texture
+// the first time it is used. Strings are laid out as textured quads, and the
+// layouts of recently used strings are cached
+class GlyphAtlas
+{
+public:
+	// Vertex of a laid out glyph quad, relative to the top-left of the text
+	struct Vertex
+	{
+		float x, y;
+		float u, v;
+	};
+
+	// Glyph quads (4 vertices each) of a laid out string, and the horizontal
+	// extents of the drawn glyphs
+	struct Layout
+	{
+		vector<Vertex> vertices;
+		float          left  = 0.f;
+		float          right = 0.f;
+
+		float width() const { return right - left; }
+	};
+
+	GlyphAtlas() = default;
+	~GlyphAtlas();
+
+	bool     isOpen() const { return face_ != nullptr; }
+	unsigned faceSize() const { return face_size_; }
+	float    lineHeight() const { return line_height_; }
+	unsigned texture() const { return texture_; }
+
+	bool          open(const uint8_t* data, unsigned size, unsigned face_size);
+	const Layout& layout(const string& text);
+	void          updateTexture();
+
+private:
+	struct Glyph
+	{
+		unsigned index   = 0; // FreeType glyph index
+		int      x       = 0; // Position and size in the atlas
+		int      y       = 0;
+		int      width   = 0;
+		int      height  = 0;
+		int      left    = 0; // Offset from the pen position (on the baseline)
+		int      top     = 0;
+		float    advance = 0.f;
+	};
+
+	static constexpr unsigned ATLAS_WIDTH = 512;
+	static constexpr unsigned MAX_LAYOUTS = 1024;
+
+	FT_LibraryRec_* library_     = nullptr;
+	FT_FaceRec_*    face_        = nullptr;
+	MemChunk        data_; // Font file data (must exist as long as the face)
+	unsigned        face_size_   = 0;
+	float           line_height_ = 0.f;
+	bool            kerning_     = false;
+
+	// Atlas image (white RGBA, glyph coverage in alpha)
+	vector<uint8_t> pixels_;
+	unsigned        height_     = 0;
+	int             pen_x_      = 0;
+	int             pen_y_      = 0;
+	int             row_height_ = 0;
+
+	// Texture
+	unsigned texture_        = 0;
+	unsigned texture_height_ = 0;
+	int      dirty_top_      = -1;
+	int      dirty_bottom_   = -1;
+
+	std::unordered_map<char32_t, Glyph> glyphs_;
+	std::unordered_map<string, Layout>  layouts_;
+
+	const Glyph* glyph(char32_t code);
+	bool         addToAtlas(Glyph& glyph, const uint8_t* bitmap, int pitch);
+};
+} // namespace slade::gl
@@ -47,6 +47,8 @@ CVAR(Bool, gl_tex_enable_np2, true, CVar::Flag::Save)
 CVAR(Bool, gl_point_sprite, true, CVar::Flag::Save)
 CVAR(Bool, gl_tweak_accuracy, true, CVar::Flag::Save)
 CVAR(Bool, gl_vbo, true, CVar::Flag::Save)
+CVAR(Bool, gl_shaders, true, CVar::Flag::Save)
+CVAR(Bool, gl_tex_compression, false, CVar::Flag::Save)
 CVAR(Int, gl_depth_buffer_size, 24, CVar::Flag::Save)
 
 namespace slade::gl
@@ -58,11 +60,13 @@ int      wx_gl_attrib[] = { WX_GL_RGBA, WX_GL_DOUBLEBUFFER, WX_GL_DEPTH_SIZE, 16
 bool     initialised    = false;
 double   version        = 0;
 unsigned max_tex_size   = 128;
+unsigned max_tex_layers = 0;
 unsigned pow_two[]      = { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768 };
 uint8_t  n_pow_two      = 16;
 float    max_point_size = -1.0f;
 Blend    last_blend     = Blend::Normal;
 Info     info;
+Counters current_counters;
 } // namespace slade::gl
 
 
@@ -139,6 +143,22 @@ bool gl::init()
 		log::info("Framebuffer Objects supported");
 	else
 		log::info("Framebuffer Objects not supported");
+	if (GLEW_VERSION_2_1)
+		log::info("GLSL 1.20 Shaders supported");
+	else
+		log::info("GLSL 1.20 Shaders not supported");
+	if (GLEW_EXT_texture_array)
+	{
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS_EXT, &val);
+		max_tex_layers = val;
+		log::info("Array Textures supported (max {} layers)", max_tex_layers);
+	}
+	else
+		log::info("Array Textures not supported");
+	if (GLEW_EXT_texture_compression_s3tc)
+		log::info("S3TC Texture Compression supported");
+	else
+		log::info("S3TC Texture Compression not supported");
 
 	initialised = true;
 	return true;
@@ -171,6 +191,33 @@ bool gl::vboSupport()
 	return GLEW_ARB_vertex_buffer_object && gl_vbo;
 }
 
+// -----------------------------------------------------------------------------
+// Returns true if the installed OpenGL version supports GLSL 1.20 shaders
+// (and they are enabled), false otherwise
+// -----------------------------------------------------------------------------
+bool gl::shaderSupport()
+{
+	return GLEW_VERSION_2_1 && gl_shaders;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if array textures are supported and can be used (they require
+// shaders to sample from), false otherwise
+// -----------------------------------------------------------------------------
+bool gl::arrayTextureSupport()
+{
+	return GLEW_EXT_texture_array && max_tex_layers > 0 && shaderSupport();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if S3TC (BC1/BC3) compressed textures are supported and
+// texture compression is enabled, false otherwise
+// -----------------------------------------------------------------------------
+bool gl::textureCompressionSupport()
+{
+	return GLEW_EXT_texture_compression_s3tc && gl_tex_compression;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if [dim] is a valid texture dimension on the system OpenGL
 // version
@@ -216,6 +263,14 @@ unsigned gl::maxTextureSize()
 	return max_tex_size;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the maximum number of layers in an array texture
+// -----------------------------------------------------------------------------
+unsigned gl::maxArrayTextureLayers()
+{
+	return max_tex_layers;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if OpenGL has been initialised
 // -----------------------------------------------------------------------------
@@ -227,7 +282,7 @@ bool gl::isInitialised()
 // -----------------------------------------------------------------------------
 // Returns true if the 'accuracy tweak' is enabled.
 // This can fix inaccuracies when rendering 2d textures, but tends to cause
-// fonts to blur when using FTGL
+// fonts to blur
 // -----------------------------------------------------------------------------
 bool gl::accuracyTweak()
 {
@@ -319,3 +374,43 @@ gl::Info gl::sysInfo()
 {
 	return info;
 }
+
+// -----------------------------------------------------------------------------
+// Returns the counts of GL work submitted since the last call to resetCounters
+// -----------------------------------------------------------------------------
+const gl::Counters& gl::counters()
+{
+	return current_counters;
+}
+
+// -----------------------------------------------------------------------------
+// Resets all GL work counters to 0
+// -----------------------------------------------------------------------------
+void gl::resetCounters()
+{
+	current_counters = {};
+}
+
+// -----------------------------------------------------------------------------
+// Counts a draw call (glBegin, glDrawArrays etc.)
+// -----------------------------------------------------------------------------
+void gl::countDrawCall()
+{
+	++current_counters.draw_calls;
+}
+
+// -----------------------------------------------------------------------------
+// Counts a texture bind
+// -----------------------------------------------------------------------------
+void gl::countTextureBind()
+{
+	++current_counters.texture_binds;
+}
+
+// -----------------------------------------------------------------------------
+// Counts [bytes] uploaded to a buffer object (glBufferData/glBufferSubData)
+// -----------------------------------------------------------------------------
+void gl::countUpload(uint64_t bytes)
+{
+	current_counters.upload_bytes += bytes;
+}
@@ -44,6 +44,14 @@ namespace gl
 		Info() { vendor = renderer = version = extensions = "OpenGL not initialised"; }
 	};
 
+	// Counts of GL work submitted since the last reset (for benchmarking)
+	struct Counters
+	{
+		unsigned draw_calls    = 0;
+		unsigned texture_binds = 0;
+		uint64_t upload_bytes  = 0; // Bytes uploaded to buffer objects
+	};
+
 #ifndef USE_SFML_RENDERWINDOW
 	wxGLContext* getContext(wxGLCanvas* canvas);
 #endif
@@ -51,9 +59,13 @@ namespace gl
 	bool     np2TexSupport();
 	bool     pointSpriteSupport();
 	bool     vboSupport();
+	bool     shaderSupport();
+	bool     arrayTextureSupport();
+	bool     textureCompressionSupport();
 	bool     validTexDimension(unsigned dim);
 	float    maxPointSize();
 	unsigned maxTextureSize();
+	unsigned maxArrayTextureLayers();
 	bool     isInitialised();
 	bool     accuracyTweak();
 	int*     getWxGLAttribs();
@@ -62,5 +74,12 @@ namespace gl
 	void     setBlend(Blend blend);
 	void     resetBlend();
 	Info     sysInfo();
+
+	// Counters
+	const Counters& counters();
+	void            resetCounters();
+	void            countDrawCall();
+	void            countTextureBind();
+	void            countUpload(uint64_t bytes);
 } // namespace gl
 } // namespace slade
@@ -0,0 +1,398 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Shader.cpp
+// Description: Shader class - a GLSL shader program, and the set of builtin
+//              shaders used by the map renderers and image previews
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Shader.h"
+#include "OpenGL.h"
+#include "Utility/Colour.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+unsigned last_bound_program = 0;
+
+// The builtin shaders are written against GLSL 1.20 with the compatibility
+// builtins (gl_Color, gl_Fog etc.), so they pick up the regular fixed-function
+// state and vertex arrays set by the renderers
+const char* vs_flat = R"(#version 120
+void main()
+{
+	gl_FrontColor = gl_Color;
+	gl_Position   = ftransform();
+}
+)";
+
+const char* fs_flat = R"(#version 120
+void main()
+{
+	gl_FragColor = gl_Color;
+}
+)";
+
+const char* vs_textured = R"(#version 120
+void main()
+{
+	gl_FrontColor  = gl_Color;
+	gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+	gl_Position    = ftransform();
+}
+)";
+
+const char* fs_textured = R"(#version 120
+uniform sampler2D tex;
+void main()
+{
+	gl_FragColor = texture2D(tex, gl_TexCoord[0].st) * gl_Color;
+}
+)";
+
+const char* vs_textured_fog = R"(#version 120
+void main()
+{
+	gl_FrontColor   = gl_Color;
+	gl_TexCoord[0]  = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+	gl_FogFragCoord = length((gl_ModelViewMatrix * gl_Vertex).xyz);
+	gl_Position     = ftransform();
+}
+)";
+
+const char* fs_textured_fog = R"(#version 120
+uniform sampler2D tex;
+uniform bool      fog;
+void main()
+{
+	vec4 colour = texture2D(tex, gl_TexCoord[0].st) * gl_Color;
+	if (fog)
+	{
+		float f    = clamp((gl_Fog.end - gl_FogFragCoord) * gl_Fog.scale, 0.0, 1.0);
+		colour.rgb = mix(gl_Fog.color.rgb, colour.rgb, f);
+	}
+	gl_FragColor = colour;
+}
+)";
+
+// Array textures need the EXT_texture_array GLSL extension at this version
+const char* fs_textured_array = R"(#version 120
+#extension GL_EXT_texture_array : require
+uniform sampler2DArray tex;
+uniform float          layer;
+void main()
+{
+	gl_FragColor = texture2DArray(tex, vec3(gl_TexCoord[0].st, layer)) * gl_Color;
+}
+)";
+
+// Used for image previews. If 'paletted' is set, the texture holds palette
+// indices (luminance) + alpha, and the colour is looked up in the 256x1
+// 'palette' texture. 'effect' is 1 to tint by 'effect_amount' or 2 to
+// colourise, both with 'effect_colour'
+const char* fs_image = R"(#version 120
+uniform sampler2D tex;
+uniform sampler2D palette;
+uniform bool      paletted;
+uniform int       effect;
+uniform vec4      effect_colour;
+uniform float     effect_amount;
+uniform vec3      greyscale;
+void main()
+{
+	vec4 colour = texture2D(tex, gl_TexCoord[0].st);
+	if (paletted)
+		colour = vec4(texture2D(palette, vec2((colour.r * 255.0 + 0.5) / 256.0, 0.5)).rgb, colour.a);
+	if (effect == 1)
+		colour.rgb = mix(colour.rgb, effect_colour.rgb, effect_amount);
+	else if (effect == 2)
+		colour.rgb = effect_colour.rgb * min(dot(colour.rgb, greyscale), 1.0);
+	gl_FragColor = colour * gl_Color;
+}
+)";
+
+// Builtin shaders are never deleted, since the GL context may already be gone
+// at exit
+std::array<gl::Shader*, static_cast<size_t>(gl::ShaderType::Count)> builtin_shaders{};
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Compiles a shader of [type] from [source].
+// Returns the shader id, or 0 if compilation failed
+// -----------------------------------------------------------------------------
+unsigned compileShader(GLenum type, string_view source, const string& name)
+{
+	auto id     = glCreateShader(type);
+	auto src    = source.data();
+	auto length = static_cast<GLint>(source.size());
+	glShaderSource(id, 1, &src, &length);
+	glCompileShader(id);
+
+	GLint ok = 0;
+	glGetShaderiv(id, GL_COMPILE_STATUS, &ok);
+	if (!ok)
+	{
+		char  info_log[1024];
+		GLint log_length = 0;
+		glGetShaderInfoLog(id, sizeof(info_log), &log_length, info_log);
+		log::error("Unable to compile shader {}: {}", name, string_view{ info_log, (size_t)log_length });
+		glDeleteShader(id);
+		return 0;
+	}
+
+	return id;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Shader Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Shader class destructor
+// -----------------------------------------------------------------------------
+gl::Shader::~Shader()
+{
+	if (id_ > 0)
+	{
+		if (last_bound_program == id_)
+			unbind();
+		glDeleteProgram(id_);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Compiles and links the shader program from [vertex_source] and
+// [fragment_source].
+// Returns false if the program couldn't be compiled or linked
+// -----------------------------------------------------------------------------
+bool gl::Shader::load(string_view vertex_source, string_view fragment_source)
+{
+	if (!gl::shaderSupport())
+		return false;
+
+	// Remove any existing program
+	if (id_ > 0)
+	{
+		if (last_bound_program == id_)
+			unbind();
+		glDeleteProgram(id_);
+		id_ = 0;
+		uniforms_.clear();
+	}
+
+	// Compile shaders
+	auto vs = compileShader(GL_VERTEX_SHADER, vertex_source, name_);
+	auto fs = compileShader(GL_FRAGMENT_SHADER, fragment_source, name_);
+	if (!vs || !fs)
+	{
+		if (vs)
+			glDeleteShader(vs);
+		if (fs)
+			glDeleteShader(fs);
+		return false;
+	}
+
+	// Link program
+	auto id = glCreateProgram();
+	glAttachShader(id, vs);
+	glAttachShader(id, fs);
+	glLinkProgram(id);
+	glDetachShader(id, vs);
+	glDetachShader(id, fs);
+	glDeleteShader(vs);
+	glDeleteShader(fs);
+
+	GLint ok = 0;
+	glGetProgramiv(id, GL_LINK_STATUS, &ok);
+	if (!ok)
+	{
+		char  info_log[1024];
+		GLint log_length = 0;
+		glGetProgramInfoLog(id, sizeof(info_log), &log_length, info_log);
+		log::error("Unable to link shader {}: {}", name_, string_view{ info_log, (size_t)log_length });
+		glDeleteProgram(id);
+		return false;
+	}
+
+	id_ = id;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Binds the shader program for rendering, if it isn't already bound
+// -----------------------------------------------------------------------------
+void gl::Shader::bind() const
+{
+	if (id_ > 0 && last_bound_program != id_)
+	{
+		glUseProgram(id_);
+		last_bound_program = id_;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the location of uniform [name] in the program, or -1 if it doesn't
+// exist. Locations are cached after the first lookup
+// -----------------------------------------------------------------------------
+int gl::Shader::uniformLocation(const string& name)
+{
+	if (id_ == 0)
+		return -1;
+
+	auto i = uniforms_.find(name);
+	if (i != uniforms_.end())
+		return i->second;
+
+	auto location   = glGetUniformLocation(id_, name.c_str());
+	uniforms_[name] = location;
+	return location;
+}
+
+// -----------------------------------------------------------------------------
+// Sets uniform [name] to [value]. The shader must be bound
+// -----------------------------------------------------------------------------
+void gl::Shader::setUniform(const string& name, int value)
+{
+	auto location = uniformLocation(name);
+	if (location >= 0)
+		glUniform1i(location, value);
+}
+
+// -----------------------------------------------------------------------------
+// Sets uniform [name] to [value]. The shader must be bound
+// -----------------------------------------------------------------------------
+void gl::Shader::setUniform(const string& name, float value)
+{
+	auto location = uniformLocation(name);
+	if (location >= 0)
+		glUniform1f(location, value);
+}
+
+// -----------------------------------------------------------------------------
+// Sets vec3 uniform [name] to [x,y,z]. The shader must be bound
+// -----------------------------------------------------------------------------
+void gl::Shader::setUniform(const string& name, float x, float y, float z)
+{
+	auto location = uniformLocation(name);
+	if (location >= 0)
+		glUniform3f(location, x, y, z);
+}
+
+// -----------------------------------------------------------------------------
+// Sets vec4 uniform [name] to [colour]. The shader must be bound
+// -----------------------------------------------------------------------------
+void gl::Shader::setUniform(const string& name, const ColRGBA& colour)
+{
+	auto location = uniformLocation(name);
+	if (location >= 0)
+		glUniform4f(location, colour.fr(), colour.fg(), colour.fb(), colour.fa());
+}
+
+// -----------------------------------------------------------------------------
+// Unbinds any bound shader program, returning to the fixed-function pipeline
+// -----------------------------------------------------------------------------
+void gl::Shader::unbind()
+{
+	if (last_bound_program != 0)
+	{
+		glUseProgram(0);
+		last_bound_program = 0;
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// GL Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the builtin shader of [type], loading it first if needed.
+// Returns nullptr if shaders aren't supported or the shader failed to load
+// -----------------------------------------------------------------------------
+gl::Shader* gl::shader(ShaderType type)
+{
+	if (!shaderSupport() || type == ShaderType::Count)
+		return nullptr;
+
+	auto& shader = builtin_shaders[static_cast<size_t>(type)];
+	if (!shader)
+	{
+		// Only attempt to load once, so a failed shader isn't recompiled every frame
+		switch (type)
+		{
+		case ShaderType::FlatColour:
+			shader = new Shader("flat_colour");
+			shader->load(vs_flat, fs_flat);
+			break;
+		case ShaderType::Textured:
+			shader = new Shader("textured");
+			shader->load(vs_textured, fs_textured);
+			break;
+		case ShaderType::TexturedFog:
+			shader = new Shader("textured_fog");
+			shader->load(vs_textured_fog, fs_textured_fog);
+			break;
+		case ShaderType::TexturedArray:
+			if (!arrayTextureSupport())
+				return nullptr;
+			shader = new Shader("textured_array");
+			shader->load(vs_textured, fs_textured_array);
+			break;
+		case ShaderType::Image:
+			shader = new Shader("image");
+			shader->load(vs_textured, fs_image);
+			break;
+		default: return nullptr;
+		}
+	}
+
+	return shader->isValid() ? shader : nullptr;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+namespace slade
+{
+struct ColRGBA;
+
+namespace gl
+{
+	// A linked GLSL vertex+fragment shader program
+	class Shader
+	{
+	public:
+		Shader(string_view name) : name_{ name } {}
+		~Shader();
+
+		const string& name() const { return name_; }
+		unsigned      id() const { return id_; }
+		bool          isValid() const { return id_ > 0; }
+
+		bool load(string_view vertex_source, string_view fragment_source);
+		void bind() const;
+
+		int  uniformLocation(const string& name);
+		void setUniform(const string& name, int value);
+		void setUniform(const string& name, float value);
+		void setUniform(const string& name, float x, float y, float z);
+		void setUniform(const string& name, const ColRGBA& colour);
+
+		static void unbind();
+
+	private:
+		string                name_;
+		unsigned              id_ = 0;
+		std::map<string, int> uniforms_;
+	};
+
+	// Builtin shaders
+	enum class ShaderType
+	{
+		FlatColour,    // Vertex colour only
+		Textured,      // Texture * vertex colour
+		TexturedFog,   // Texture * vertex colour (sector light), with gl fog applied if the 'fog' uniform is set
+		TexturedArray, // Array texture layer (the 'layer' uniform) * vertex colour
+		Image,         // Texture (or palette lookup of an index texture) with a tint/colourise effect * vertex colour
+
+		Count
+	};
+	Shader* shader(ShaderType type);
+} // namespace gl
+} // namespace slade
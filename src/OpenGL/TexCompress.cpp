@@ -0,0 +1,318 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TexCompress.cpp
+// Description: CPU-side mipmap generation and S3TC (BC1/BC3) block compression
+//              for texture uploads, split across the thread pool
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TexCompress.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned ROWS_PER_TASK = 64; // Rows (of pixels or blocks) per thread pool task
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Calls [func] with each range of rows (first, last + 1) of [height] rows,
+// split into ROWS_PER_TASK sized chunks across the thread pool
+// -----------------------------------------------------------------------------
+void forEachRows(unsigned height, const std::function<void(unsigned, unsigned)>& func)
+{
+	auto n_tasks = (height + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+	threadpool::parallelFor(n_tasks, [&](size_t task) {
+		auto first = static_cast<unsigned>(task) * ROWS_PER_TASK;
+		func(first, std::min(first + ROWS_PER_TASK, height));
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Returns the half-size (box filtered) mipmap level of [level]
+// -----------------------------------------------------------------------------
+gl::MipLevel halfSize(const gl::MipLevel& level)
+{
+	gl::MipLevel half;
+	half.width  = std::max(1u, level.width / 2);
+	half.height = std::max(1u, level.height / 2);
+	half.data.resize(static_cast<size_t>(half.width) * half.height * 4);
+
+	auto src_pitch = static_cast<size_t>(level.width) * 4;
+	forEachRows(half.height, [&](unsigned first, unsigned last) {
+		for (unsigned y = first; y < last; ++y)
+		{
+			auto row0 = level.data.data() + std::min(y * 2, level.height - 1) * src_pitch;
+			auto row1 = level.data.data() + std::min(y * 2 + 1, level.height - 1) * src_pitch;
+			auto dst  = half.data.data() + static_cast<size_t>(y) * half.width * 4;
+			for (unsigned x = 0; x < half.width; ++x)
+			{
+				auto x0 = std::min(x * 2, level.width - 1) * 4;
+				auto x1 = std::min(x * 2 + 1, level.width - 1) * 4;
+				for (unsigned c = 0; c < 4; ++c)
+					*dst++ = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4;
+			}
+		}
+	});
+
+	return half;
+}
+
+// -----------------------------------------------------------------------------
+// Packs an 8-bit per channel colour into 16-bit 5:6:5
+// -----------------------------------------------------------------------------
+uint16_t pack565(const int* rgb)
+{
+	return ((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3);
+}
+
+// -----------------------------------------------------------------------------
+// Unpacks 16-bit 5:6:5 colour [col] to 8 bits per channel in [rgb]
+// -----------------------------------------------------------------------------
+void unpack565(uint16_t col, int* rgb)
+{
+	int r  = (col >> 11) & 31;
+	int g  = (col >> 5) & 63;
+	int b  = col & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the BC1 colour block for the 16 RGBA [pixels] to [out] (8 bytes).
+// The endpoints are the (slightly inset) bounding box of the block's colours,
+// and always use the 4 colour mode so the block is also valid for BC3
+// -----------------------------------------------------------------------------
+void encodeColourBlock(const uint8_t* pixels, uint8_t* out)
+{
+	int min[3] = { 255, 255, 255 };
+	int max[3] = { 0, 0, 0 };
+	for (unsigned p = 0; p < 16; ++p)
+		for (unsigned c = 0; c < 3; ++c)
+		{
+			min[c] = std::min<int>(min[c], pixels[p * 4 + c]);
+			max[c] = std::max<int>(max[c], pixels[p * 4 + c]);
+		}
+	for (unsigned c = 0; c < 3; ++c)
+	{
+		auto inset = (max[c] - min[c]) >> 4;
+		min[c] += inset;
+		max[c] -= inset;
+	}
+
+	auto     col0    = pack565(max);
+	auto     col1    = pack565(min);
+	uint32_t indices = 0;
+	if (col0 < col1)
+		std::swap(col0, col1);
+	if (col0 != col1)
+	{
+		int palette[4][3];
+		unpack565(col0, palette[0]);
+		unpack565(col1, palette[1]);
+		for (unsigned c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (unsigned p = 0; p < 16; ++p)
+		{
+			unsigned best      = 0;
+			int      best_dist = INT_MAX;
+			for (unsigned i = 0; i < 4; ++i)
+			{
+				int dist = 0;
+				for (unsigned c = 0; c < 3; ++c)
+				{
+					int diff = pixels[p * 4 + c] - palette[i][c];
+					dist += diff * diff;
+				}
+				if (dist < best_dist)
+				{
+					best      = i;
+					best_dist = dist;
+				}
+			}
+			indices |= best << (p * 2);
+		}
+	}
+
+	out[0] = col0 & 0xFF;
+	out[1] = col0 >> 8;
+	out[2] = col1 & 0xFF;
+	out[3] = col1 >> 8;
+	for (unsigned b = 0; b < 4; ++b)
+		out[4 + b] = (indices >> (b * 8)) & 0xFF;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the BC3 alpha block for the 16 RGBA [pixels] to [out] (8 bytes),
+// using the block's alpha range as the endpoints
+// -----------------------------------------------------------------------------
+void encodeAlphaBlock(const uint8_t* pixels, uint8_t* out)
+{
+	int min = 255;
+	int max = 0;
+	for (unsigned p = 0; p < 16; ++p)
+	{
+		min = std::min<int>(min, pixels[p * 4 + 3]);
+		max = std::max<int>(max, pixels[p * 4 + 3]);
+	}
+
+	uint64_t indices = 0;
+	if (max > min)
+	{
+		// 8 alpha values between the endpoints (max > min selects this mode)
+		int palette[8] = { max, min };
+		for (int i = 1; i < 7; ++i)
+			palette[i + 1] = ((7 - i) * max + i * min) / 7;
+
+		for (unsigned p = 0; p < 16; ++p)
+		{
+			unsigned best      = 0;
+			int      best_dist = INT_MAX;
+			for (unsigned i = 0; i < 8; ++i)
+			{
+				int dist = std::abs(pixels[p * 4 + 3] - palette[i]);
+				if (dist < best_dist)
+				{
+					best      = i;
+					best_dist = dist;
+				}
+			}
+			indices |= static_cast<uint64_t>(best) << (p * 3);
+		}
+	}
+
+	out[0] = max;
+	out[1] = min;
+	for (unsigned b = 0; b < 6; ++b)
+		out[2 + b] = (indices >> (b * 8)) & 0xFF;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// GL Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns mipmap levels for the [width]x[height] RGBA [data], starting with the
+// full size image. If [full_chain] is false only the full size level is given
+// -----------------------------------------------------------------------------
+vector<gl::MipLevel> gl::generateMipmaps(const uint8_t* data, unsigned width, unsigned height, bool full_chain)
+{
+	vector<MipLevel> levels(1);
+	levels[0].width  = width;
+	levels[0].height = height;
+	levels[0].data.assign(data, data + static_cast<size_t>(width) * height * 4);
+
+	while (full_chain && (levels.back().width > 1 || levels.back().height > 1))
+		levels.push_back(halfSize(levels.back()));
+
+	return levels;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any pixels in [level] aren't fully opaque
+// -----------------------------------------------------------------------------
+bool gl::hasTranslucency(const MipLevel& level)
+{
+	for (size_t a = 3; a < level.data.size(); a += 4)
+		if (level.data[a] < 255)
+			return true;
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the size in bytes of a [width]x[height] image compressed as [format]
+// -----------------------------------------------------------------------------
+size_t gl::compressedSize(unsigned width, unsigned height, BlockFormat format)
+{
+	size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+	return blocks * (format == BlockFormat::BC1 ? 8 : 16);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [level] compressed as [format]. Blocks past the edge of the image
+// (if its size isn't a multiple of 4) repeat the edge pixels
+// -----------------------------------------------------------------------------
+vector<uint8_t> gl::compressBlocks(const MipLevel& level, BlockFormat format)
+{
+	auto            blocks_x   = (level.width + 3) / 4;
+	auto            blocks_y   = (level.height + 3) / 4;
+	auto            block_size = format == BlockFormat::BC1 ? 8u : 16u;
+	vector<uint8_t> out(compressedSize(level.width, level.height, format));
+
+	forEachRows(blocks_y, [&](unsigned first, unsigned last) {
+		uint8_t pixels[64];
+		for (unsigned by = first; by < last; ++by)
+			for (unsigned bx = 0; bx < blocks_x; ++bx)
+			{
+				// Get block pixels
+				for (unsigned p = 0; p < 16; ++p)
+				{
+					auto x = std::min(bx * 4 + p % 4, level.width - 1);
+					auto y = std::min(by * 4 + p / 4, level.height - 1);
+					memcpy(pixels + p * 4, level.data.data() + (static_cast<size_t>(y) * level.width + x) * 4, 4);
+				}
+
+				// Encode
+				auto block = out.data() + (static_cast<size_t>(by) * blocks_x + bx) * block_size;
+				if (format == BlockFormat::BC3)
+				{
+					encodeAlphaBlock(pixels, block);
+					block += 8;
+				}
+				encodeColourBlock(pixels, block);
+			}
+	});
+
+	return out;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+namespace slade
+{
+namespace gl
+{
+	// S3TC block compression formats
+	enum class BlockFormat
+	{
+		BC1, // RGB, 8 bytes per 4x4 block (DXT1)
+		BC3  // RGBA, 16 bytes per 4x4 block (DXT5)
+	};
+
+	// An RGBA image, or one mipmap level of it
+	struct MipLevel
+	{
+		unsigned        width  = 0;
+		unsigned        height = 0;
+		vector<uint8_t> data;
+	};
+
+	vector<MipLevel> generateMipmaps(const uint8_t* data, unsigned width, unsigned height, bool full_chain = true);
+	bool             hasTranslucency(const MipLevel& level);
+	size_t           compressedSize(unsigned width, unsigned height, BlockFormat format);
+	vector<uint8_t>  compressBlocks(const MipLevel& level, BlockFormat format);
+} // namespace gl
+} // namespace slade
@@ -141,13 +141,12 @@ bool Doom64MapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map
 
 	auto     vert_data = (Vertex*)entry->rawData(true);
 	unsigned nv        = entry->size() / sizeof(Vertex);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nv; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
-		map_data.addVertex(
-			std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x / 65536, (double)vert_data[a].y / 65536 }));
-	}
+	auto     vertices  = createObjects<MapVertex>(nv, [vert_data](size_t a) {
+		return std::make_unique<MapVertex>(
+			Vec2d{ (double)vert_data[a].x / 65536, (double)vert_data[a].y / 65536 });
+	});
+	for (auto& vertex : vertices)
+		map_data.addVertex(std::move(vertex));
 
 	log::info(3, "Read {} vertices", map_data.vertices().size());
 
@@ -175,12 +174,9 @@ bool Doom64MapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 
 	auto     side_data = (SideDef*)entry->rawData(true);
 	unsigned ns        = entry->size() / sizeof(SideDef);
-	float    p         = ui::getSplashProgress();
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
-
-		// Add side
+		// Add side (connects to its sector so can't be created in parallel)
 		map_data.addSide(std::make_unique<MapSide>(
 			map_data.sectors().at(side_data[a].sector),
 			ResourceManager::doom64TextureName(side_data[a].tex_upper),
@@ -215,10 +211,8 @@ bool Doom64MapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map
 
 	auto     line_data = (LineDef*)entry->rawData(true);
 	unsigned nl        = entry->size() / sizeof(LineDef);
-	float    p         = ui::getSplashProgress();
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -282,21 +276,21 @@ bool Doom64MapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_
 
 	auto     sect_data = (Sector*)entry->rawData(true);
 	unsigned ns        = entry->size() / sizeof(Sector);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < ns; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+	auto     sectors   = createObjects<MapSector>(ns, [sect_data](size_t a) {
 		const auto& data = sect_data[a];
-
-		// Add sector
-		auto sector = map_data.addSector(std::make_unique<MapSector>(
+		return std::make_unique<MapSector>(
 			data.f_height,
 			ResourceManager::doom64TextureName(data.f_tex),
 			data.c_height,
 			ResourceManager::doom64TextureName(data.c_tex),
 			255,
 			data.special,
-			data.tag));
+			data.tag);
+	});
+	for (size_t a = 0; a < ns; a++)
+	{
+		const auto& data   = sect_data[a];
+		auto        sector = map_data.addSector(std::move(sectors[a]));
 
 		// Set properties
 		sector->setIntProperty("flags", data.flags);
@@ -331,24 +325,20 @@ bool Doom64MapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_d
 		return true;
 	}
 
-	auto              thng_data = (Thing*)entry->rawData(true);
-	unsigned          nt        = entry->size() / sizeof(Thing);
-	float             p         = ui::getSplashProgress();
-	MapObject::ArgSet args;
-	for (size_t a = 0; a < nt; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+	auto     thng_data = (Thing*)entry->rawData(true);
+	unsigned nt        = entry->size() / sizeof(Thing);
+	auto     things    = createObjects<MapThing>(nt, [thng_data](size_t a) {
 		const auto& data = thng_data[a];
-
-		// Create thing
-		auto thing = map_data.addThing(std::make_unique<MapThing>(
+		return std::make_unique<MapThing>(
 			Vec3d{ (double)data.x, (double)data.y, (double)data.z },
 			data.type,
 			data.angle,
 			data.flags,
-			args,
-			data.tid));
-	}
+			MapObject::ArgSet{},
+			data.tid);
+	});
+	for (auto& thing : things)
+		map_data.addThing(std::move(thing));
 
 	log::info(3, "Read {} things", map_data.things().size());
 
@@ -124,12 +124,21 @@ vector<unique_ptr<ArchiveEntry>> DoomMapFormat::writeMap(
 	const MapObjectCollection& map_data,
 	const PropertyList&        map_extra_props)
 {
-	vector<unique_ptr<ArchiveEntry>> map_entries;
-	map_entries.push_back(writeTHINGS(map_data.things()));
-	map_entries.push_back(writeLINEDEFS(map_data.lines()));
-	map_entries.push_back(writeSIDEDEFS(map_data.sides()));
-	map_entries.push_back(writeVERTEXES(map_data.vertices()));
-	map_entries.push_back(writeSECTORS(map_data.sectors()));
+	// Write each entry in parallel (in order: things, lines, sides, vertices, sectors)
+	vector<unique_ptr<ArchiveEntry>> map_entries(5);
+	threadpool::parallelFor(
+		map_entries.size(),
+		[&](size_t index)
+		{
+			switch (index)
+			{
+			case 0: map_entries[0] = writeTHINGS(map_data.things()); break;
+			case 1: map_entries[1] = writeLINEDEFS(map_data.lines()); break;
+			case 2: map_entries[2] = writeSIDEDEFS(map_data.sides()); break;
+			case 3: map_entries[3] = writeVERTEXES(map_data.vertices()); break;
+			default: map_entries[4] = writeSECTORS(map_data.sectors()); break;
+			}
+		});
 	return map_entries;
 }
 
@@ -154,12 +163,11 @@ bool DoomMapFormat::readVERTEXES(ArchiveEntry* entry, MapObjectCollection& map_d
 
 	auto     vert_data = (Vertex*)entry->rawData(true);
 	unsigned nv        = entry->size() / sizeof(Vertex);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nv; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / nv) * 0.2f);
-		map_data.addVertex(std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y }));
-	}
+	auto     vertices  = createObjects<MapVertex>(nv, [vert_data](size_t a) {
+		return std::make_unique<MapVertex>(Vec2d{ (double)vert_data[a].x, (double)vert_data[a].y });
+	});
+	for (auto& vertex : vertices)
+		map_data.addVertex(std::move(vertex));
 
 	log::info(3, "Read {} vertices", map_data.vertices().size());
 
@@ -187,12 +195,9 @@ bool DoomMapFormat::readSIDEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 
 	auto     side_data = (SideDef*)entry->rawData(true);
 	unsigned ns        = entry->size() / sizeof(SideDef);
-	float    p         = ui::getSplashProgress();
 	for (size_t a = 0; a < ns; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
-
-		// Add side
+		// Add side (connects to its sector so can't be created in parallel)
 		map_data.addSide(std::make_unique<MapSide>(
 			map_data.sectors().at(side_data[a].sector),
 			strutil::viewFromChars(side_data[a].tex_upper, 8),
@@ -227,10 +232,8 @@ bool DoomMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_d
 
 	auto     line_data = (LineDef*)entry->rawData(true);
 	unsigned nl        = entry->size() / sizeof(LineDef);
-	float    p         = ui::getSplashProgress();
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -289,22 +292,19 @@ bool DoomMapFormat::readSECTORS(ArchiveEntry* entry, MapObjectCollection& map_da
 
 	auto     sect_data = (Sector*)entry->rawData(true);
 	unsigned ns        = entry->size() / sizeof(Sector);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < ns; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / ns) * 0.2f);
+	auto     sectors   = createObjects<MapSector>(ns, [sect_data](size_t a) {
 		const auto& data = sect_data[a];
-
-		// Add sector
-		map_data.addSector(std::make_unique<MapSector>(
+		return std::make_unique<MapSector>(
 			data.f_height,
 			strutil::viewFromChars(data.f_tex, 8),
 			data.c_height,
 			strutil::viewFromChars(data.c_tex, 8),
 			data.light,
 			data.special,
-			data.tag));
-	}
+			data.tag);
+	});
+	for (auto& sector : sectors)
+		map_data.addSector(std::move(sector));
 
 	log::info(3, "Read {} sectors", map_data.sectors().size());
 
@@ -332,16 +332,15 @@ bool DoomMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_dat
 
 	auto     thng_data = (Thing*)entry->rawData(true);
 	unsigned nt        = entry->size() / sizeof(Thing);
-	float    p         = ui::getSplashProgress();
-	for (size_t a = 0; a < nt; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
-		map_data.addThing(std::make_unique<MapThing>(
+	auto     things    = createObjects<MapThing>(nt, [thng_data](size_t a) {
+		return std::make_unique<MapThing>(
 			Vec3d{ (double)thng_data[a].x, (double)thng_data[a].y, 0. },
 			thng_data[a].type,
 			thng_data[a].angle,
-			thng_data[a].flags));
-	}
+			thng_data[a].flags);
+	});
+	for (auto& thing : things)
+		map_data.addThing(std::move(thing));
 
 	log::info(3, "Read {} things", map_data.things().size());
 
@@ -353,24 +352,14 @@ bool DoomMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_dat
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> DoomMapFormat::writeVERTEXES(const VertexList& vertices) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("VERTEXES");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(vertices.size() * 4, false);
-	entry->seek(0, 0);
-
-	// Write vertex data
-	short x, y;
-	for (auto& vertex : vertices)
-	{
-		x = vertex->xPos();
-		y = vertex->yPos();
-		entry->write(&x, 2);
-		entry->write(&y, 2);
-	}
-
-	return entry;
+	return writeStructs<Vertex>(
+		"VERTEXES",
+		vertices.size(),
+		[&vertices](size_t index, Vertex& data)
+		{
+			data.x = vertices[index]->xPos();
+			data.y = vertices[index]->yPos();
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -378,37 +367,27 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeVERTEXES(const VertexList& vertices
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> DoomMapFormat::writeSIDEDEFS(const SideList& sides) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("SIDEDEFS");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(sides.size() * 30, false);
-	entry->seek(0, 0);
-
-	// Write side data
-	SideDef data;
-	for (auto& side : sides)
-	{
-		memset(&data, 0, 30);
-
-		// Offsets
-		data.x_offset = side->texOffsetX();
-		data.y_offset = side->texOffsetY();
-
-		// Sector
-		data.sector = -1;
-		if (side->sector())
-			data.sector = side->sector()->index();
-
-		// Textures
-		memcpy(data.tex_middle, side->texMiddle().data(), side->texMiddle().size());
-		memcpy(data.tex_upper, side->texUpper().data(), side->texUpper().size());
-		memcpy(data.tex_lower, side->texLower().data(), side->texLower().size());
-
-		entry->write(&data, 30);
-	}
-
-	return entry;
+	return writeStructs<SideDef>(
+		"SIDEDEFS",
+		sides.size(),
+		[&sides](size_t index, SideDef& data)
+		{
+			auto side = sides[index];
+
+			// Offsets
+			data.x_offset = side->texOffsetX();
+			data.y_offset = side->texOffsetY();
+
+			// Sector
+			data.sector = -1;
+			if (side->sector())
+				data.sector = side->sector()->index();
+
+			// Textures
+			memcpy(data.tex_middle, side->texMiddle().data(), std::min<size_t>(side->texMiddle().size(), 8));
+			memcpy(data.tex_upper, side->texUpper().data(), std::min<size_t>(side->texUpper().size(), 8));
+			memcpy(data.tex_lower, side->texLower().data(), std::min<size_t>(side->texLower().size(), 8));
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -416,33 +395,24 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeSIDEDEFS(const SideList& sides) con
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> DoomMapFormat::writeLINEDEFS(const LineList& lines) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("LINEDEFS");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(lines.size() * 14, false);
-	entry->seek(0, 0);
-
-	// Write line data
-	LineDef data;
-	for (auto& line : lines)
-	{
-		data.vertex1 = line->v1Index();
-		data.vertex2 = line->v2Index();
-
-		// Properties
-		data.flags      = line->flags();
-		data.type       = line->special();
-		data.sector_tag = line->arg(0);
-
-		// Sides
-		data.side1 = line->s1Index();
-		data.side2 = line->s2Index();
-
-		entry->write(&data, 14);
-	}
-
-	return entry;
+	return writeStructs<LineDef>(
+		"LINEDEFS",
+		lines.size(),
+		[&lines](size_t index, LineDef& data)
+		{
+			auto line    = lines[index];
+			data.vertex1 = line->v1Index();
+			data.vertex2 = line->v2Index();
+
+			// Properties
+			data.flags      = line->flags();
+			data.type       = line->special();
+			data.sector_tag = line->arg(0);
+
+			// Sides
+			data.side1 = line->s1Index();
+			data.side2 = line->s2Index();
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -450,36 +420,28 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeLINEDEFS(const LineList& lines) con
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> DoomMapFormat::writeSECTORS(const SectorList& sectors) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("SECTORS");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(sectors.size() * 26, false);
-	entry->seek(0, 0);
-
-	// Write sector data
-	Sector data;
-	for (auto& sector : sectors)
-	{
-		memset(&data, 0, 26);
-
-		// Height
-		data.f_height = sector->floor().height;
-		data.c_height = sector->ceiling().height;
-
-		// Textures
-		memcpy(data.f_tex, sector->floor().texture.data(), sector->floor().texture.size());
-		memcpy(data.c_tex, sector->ceiling().texture.data(), sector->ceiling().texture.size());
-
-		// Properties
-		data.light   = sector->lightLevel();
-		data.special = sector->special();
-		data.tag     = sector->tag();
-
-		entry->write(&data, 26);
-	}
-
-	return entry;
+	return writeStructs<Sector>(
+		"SECTORS",
+		sectors.size(),
+		[&sectors](size_t index, Sector& data)
+		{
+			auto  sector  = sectors[index];
+			auto& floor   = sector->floor();
+			auto& ceiling = sector->ceiling();
+
+			// Height
+			data.f_height = floor.height;
+			data.c_height = ceiling.height;
+
+			// Textures
+			memcpy(data.f_tex, floor.texture.data(), std::min<size_t>(floor.texture.size(), 8));
+			memcpy(data.c_tex, ceiling.texture.data(), std::min<size_t>(ceiling.texture.size(), 8));
+
+			// Properties
+			data.light   = sector->lightLevel();
+			data.special = sector->special();
+			data.tag     = sector->tag();
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -487,28 +449,20 @@ unique_ptr<ArchiveEntry> DoomMapFormat::writeSECTORS(const SectorList& sectors)
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> DoomMapFormat::writeTHINGS(const ThingList& things) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("THINGS");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(things.size() * 10, false);
-	entry->seek(0, 0);
-
-	// Write thing data
-	Thing data;
-	for (auto& thing : things)
-	{
-		// Position
-		data.x = thing->xPos();
-		data.y = thing->yPos();
-
-		// Properties
-		data.angle = thing->angle();
-		data.type  = thing->type();
-		data.flags = thing->flags();
+	return writeStructs<Thing>(
+		"THINGS",
+		things.size(),
+		[&things](size_t index, Thing& data)
+		{
+			auto thing = things[index];
 
-		entry->write(&data, 10);
-	}
+			// Position
+			data.x = thing->xPos();
+			data.y = thing->yPos();
 
-	return entry;
+			// Properties
+			data.angle = thing->angle();
+			data.type  = thing->type();
+			data.flags = thing->flags();
+		});
 }
@@ -34,7 +34,6 @@
 #include "Main.h"
 #include "HexenMapFormat.h"
 #include "Game/Configuration.h"
-#include "General/UI.h"
 #include "SLADEMap/MapObject/MapLine.h"
 #include "SLADEMap/MapObjectCollection.h"
 
@@ -69,10 +68,8 @@ bool HexenMapFormat::readLINEDEFS(ArchiveEntry* entry, MapObjectCollection& map_
 
 	auto     line_data = (LineDef*)entry->rawData(true);
 	unsigned nl        = entry->size() / sizeof(LineDef);
-	float    p         = ui::getSplashProgress();
 	for (size_t a = 0; a < nl; a++)
 	{
-		ui::setSplashProgress(p + ((float)a / nl) * 0.2f);
 		const auto& data = line_data[a];
 
 		// Check vertices exist
@@ -148,29 +145,28 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 		return true;
 	}
 
-	auto              thng_data = (Thing*)entry->rawData(true);
-	unsigned          nt        = entry->size() / sizeof(Thing);
-	float             p         = ui::getSplashProgress();
-	MapObject::ArgSet args;
-	for (size_t a = 0; a < nt; a++)
-	{
-		ui::setSplashProgress(p + ((float)a / nt) * 0.2f);
+	auto     thng_data = (Thing*)entry->rawData(true);
+	unsigned nt        = entry->size() / sizeof(Thing);
+	auto     things    = createObjects<MapThing>(nt, [thng_data](size_t a) {
 		const auto& data = thng_data[a];
 
 		// Set args
+		MapObject::ArgSet args;
 		for (unsigned i = 0; i < 5; ++i)
 			args[i] = data.args[i];
 
 		// Create thing
-		map_data.addThing(std::make_unique<MapThing>(
+		return std::make_unique<MapThing>(
 			Vec3d{ (double)data.x, (double)data.y, (double)data.z },
 			data.type,
 			data.angle,
 			data.flags,
 			args,
 			data.tid,
-			data.special));
-	}
+			data.special);
+	});
+	for (auto& thing : things)
+		map_data.addThing(std::move(thing));
 
 	log::info(3, "Read {} things", map_data.things().size());
 
@@ -182,34 +178,25 @@ bool HexenMapFormat::readTHINGS(ArchiveEntry* entry, MapObjectCollection& map_da
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> HexenMapFormat::writeLINEDEFS(const LineList& lines) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("LINEDEFS");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(lines.size() * sizeof(LineDef), false);
-	entry->seek(0, 0);
-
-	// Write line data
-	LineDef data;
-	for (auto& line : lines)
-	{
-		data.vertex1 = line->v1Index();
-		data.vertex2 = line->v2Index();
-
-		// Properties
-		data.flags = line->flags();
-		data.type  = line->special();
-		for (unsigned i = 0; i < 5; ++i)
-			data.args[i] = line->arg(i);
-
-		// Sides
-		data.side1 = line->s1Index();
-		data.side2 = line->s2Index();
-
-		entry->write(&data, sizeof(LineDef));
-	}
-
-	return entry;
+	return writeStructs<LineDef>(
+		"LINEDEFS",
+		lines.size(),
+		[&lines](size_t index, LineDef& data)
+		{
+			auto line    = lines[index];
+			data.vertex1 = line->v1Index();
+			data.vertex2 = line->v2Index();
+
+			// Properties
+			data.flags = line->flags();
+			data.type  = line->special();
+			for (unsigned i = 0; i < 5; ++i)
+				data.args[i] = line->arg(i);
+
+			// Sides
+			data.side1 = line->s1Index();
+			data.side2 = line->s2Index();
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -217,36 +204,25 @@ unique_ptr<ArchiveEntry> HexenMapFormat::writeLINEDEFS(const LineList& lines) co
 // -----------------------------------------------------------------------------
 unique_ptr<ArchiveEntry> HexenMapFormat::writeTHINGS(const ThingList& things) const
 {
-	auto entry = std::make_unique<ArchiveEntry>("THINGS");
-
-	// Init entry data
-	entry->clearData();
-	entry->resize(things.size() * sizeof(Thing), false);
-	entry->seek(0, 0);
-
-	// Write thing data
-	Thing data;
-	for (auto& thing : things)
-	{
-		// Position
-		data.x = thing->xPos();
-		data.y = thing->yPos();
-		data.z = thing->zPos();
-
-		// Properties
-		data.angle   = thing->angle();
-		data.type    = thing->type();
-		data.flags   = thing->flags();
-		data.special = thing->special();
-		data.tid     = thing->id();
-		data.args[0] = thing->arg(0);
-		data.args[1] = thing->arg(1);
-		data.args[2] = thing->arg(2);
-		data.args[3] = thing->arg(3);
-		data.args[4] = thing->arg(4);
-
-		entry->write(&data, sizeof(Thing));
-	}
-
-	return entry;
+	return writeStructs<Thing>(
+		"THINGS",
+		things.size(),
+		[&things](size_t index, Thing& data)
+		{
+			auto thing = things[index];
+
+			// Position
+			data.x = thing->xPos();
+			data.y = thing->yPos();
+			data.z = thing->zPos();
+
+			// Properties
+			data.angle   = thing->angle();
+			data.type    = thing->type();
+			data.flags   = thing->flags();
+			data.special = thing->special();
+			data.tid     = thing->id();
+			for (unsigned i = 0; i < 5; ++i)
+				data.args[i] = thing->arg(i);
+		});
 }
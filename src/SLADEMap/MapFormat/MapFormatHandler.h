@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Archive/Archive.h"
+#include "Utility/ThreadPool.h"
 
 namespace slade
 {
@@ -20,5 +21,42 @@ public:
 	virtual void   setUDMFNamespace(string_view ns) {}
 
 	static unique_ptr<MapFormatHandler> get(MapFormat format);
+
+protected:
+	// Calls [func] for each index from 0 to [count], split into ranges that are
+	// processed in parallel
+	template<class F> static void parallelRange(unsigned count, const F& func)
+	{
+		auto parts = std::min<unsigned>(threadpool::pool().numThreads() + 1, count);
+		threadpool::parallelFor(parts, [&](size_t part) {
+			auto end = (part + 1) * count / parts;
+			for (auto a = part * count / parts; a < end; ++a)
+				func(a);
+		});
+	}
+
+	// Creates [count] map objects in parallel, with [create] returning the
+	// object to create for each index. Only for objects that aren't connected
+	// to other objects on creation (vertices, sectors and things)
+	template<class T, class F> static vector<unique_ptr<T>> createObjects(unsigned count, const F& create)
+	{
+		vector<unique_ptr<T>> objects(count);
+		parallelRange(count, [&](size_t index) { objects[index] = create(index); });
+		return objects;
+	}
+
+	// Creates an entry [name] containing [count] binary map structs of type S,
+	// with [write] filling in the struct for each index (in parallel)
+	template<class S, class F>
+	static unique_ptr<ArchiveEntry> writeStructs(string_view name, unsigned count, const F& write)
+	{
+		vector<S> data(count);
+		parallelRange(count, [&](size_t index) { write(index, data[index]); });
+
+		auto entry = std::make_unique<ArchiveEntry>(name);
+		if (count > 0)
+			entry->importMem(data.data(), count * sizeof(S));
+		return entry;
+	}
 };
 } // namespace slade
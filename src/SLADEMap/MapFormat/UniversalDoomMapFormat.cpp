@@ -39,12 +39,378 @@
 #include "SLADEMap/MapObject/MapVertex.h"
 #include "SLADEMap/MapObjectCollection.h"
 #include "SLADEMap/SLADEMap.h"
-#include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, udmf_parse_parallel, false, CVar::Flag::Save)
+CVAR(Int, udmf_parse_threads, 0, CVar::Flag::Save) // 0 = use all worker threads
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr size_t WRITE_PART_SIZE = 4096; // Objects per part when writing TEXTMAP
+
+// -----------------------------------------------------------------------------
+// Returns the value of the first property named [name] in [props], or null if
+// there is none
+// -----------------------------------------------------------------------------
+const Property* findProp(const MapObject::UDMFProps& props, string_view name)
+{
+	for (const auto& prop : props)
+		if (strutil::equalCI(prop.name, name))
+			return &prop.value;
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [c] is a decimal digit
+// -----------------------------------------------------------------------------
+bool isDigit(char c)
+{
+	return isdigit(static_cast<unsigned char>(c));
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [c] is a hexadecimal digit
+// -----------------------------------------------------------------------------
+bool isHexDigit(char c)
+{
+	return isxdigit(static_cast<unsigned char>(c));
+}
+
+// -----------------------------------------------------------------------------
+// Reads floating point number [token] into [value].
+// Returns false if [token] isn't a valid number
+// -----------------------------------------------------------------------------
+bool parseFloat(string_view token, double& value)
+{
+	if (token.empty() || !(isDigit(token[0]) || token[0] == '-' || token[0] == '+' || token[0] == '.'))
+		return false;
+
+	// strtod needs a null-terminated string
+	char        buf[64];
+	string      long_buf;
+	const char* str = buf;
+	if (token.size() < sizeof(buf))
+	{
+		memcpy(buf, token.data(), token.size());
+		buf[token.size()] = 0;
+	}
+	else
+	{
+		long_buf = token;
+		str      = long_buf.c_str();
+	}
+
+	char* end;
+	value = strtod(str, &end);
+	return end == str + token.size();
+}
+
+// -----------------------------------------------------------------------------
+// Returns unquoted UDMF value [token] as a Property of the appropriate type
+// (the same as Parser would give it)
+// -----------------------------------------------------------------------------
+Property parseValue(string_view token)
+{
+	// Boolean
+	if (strutil::equalCI(token, "true"))
+		return true;
+	if (strutil::equalCI(token, "false"))
+		return false;
+
+	// Integer
+	auto digits = token[0] == '+' || token[0] == '-' ? token.substr(1) : token;
+	if (!digits.empty() && std::all_of(digits.begin(), digits.end(), isDigit))
+		return strutil::asInt(token[0] == '+' ? digits : token);
+
+	// Hex (0xXXXXXX)
+	if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')
+		&& std::all_of(token.begin() + 2, token.end(), isHexDigit))
+		return strutil::asInt(token.substr(2), 16);
+
+	// Floating point
+	double val;
+	if (parseFloat(token, val))
+		return val;
+
+	// Unknown, just treat as (lowercase) string
+	return strutil::lower(token);
+}
+
+// Fast scanner for UDMF text, reading values directly from the text data
+// rather than tokenizing it and building a parse tree first. As with Parser,
+// names and unquoted values are read as lowercase
+class UDMFScanner
+{
+public:
+	UDMFScanner(const MemChunk& data) :
+		start_{ reinterpret_cast<const char*>(data.data()) },
+		pos_{ start_ },
+		end_{ start_ + data.size() }
+	{
+	}
+
+	const char* position() const { return pos_; }
+	void        setPosition(const char* pos) { pos_ = pos; }
+
+	// Returns true if the end of the data has been reached
+	bool atEnd()
+	{
+		skipWhitespace();
+		return pos_ >= end_;
+	}
+
+	// Skips past the next character if it is [c], returns true if it was
+	bool check(char c)
+	{
+		skipWhitespace();
+		if (pos_ < end_ && *pos_ == c)
+		{
+			++pos_;
+			return true;
+		}
+
+		return false;
+	}
+
+	// As check, but logs an error if the next character isn't [c]
+	bool expect(char c)
+	{
+		if (check(c))
+			return true;
+
+		logError(fmt::format("Expected \"{}\"", c));
+		return false;
+	}
+
+	// Reads the next identifier (block or property name) into [id]
+	bool readIdentifier(string_view& id)
+	{
+		skipWhitespace();
+		auto begin = pos_;
+		while (pos_ < end_ && (isalnum(static_cast<unsigned char>(*pos_)) || *pos_ == '_'))
+			++pos_;
+
+		id = { begin, static_cast<size_t>(pos_ - begin) };
+		if (id.empty())
+		{
+			logError(pos_ < end_ ? fmt::format("Unexpected character '{}'", *pos_) : "Unexpected end of data");
+			return false;
+		}
+
+		return true;
+	}
+
+	// Reads the next value into [value]
+	bool readValue(Property& value)
+	{
+		skipWhitespace();
+		if (pos_ >= end_)
+		{
+			logError("Unexpected end of data");
+			return false;
+		}
+
+		// Quoted string
+		if (*pos_ == '"')
+		{
+			auto begin   = ++pos_;
+			bool escaped = false;
+			if (!skipString(escaped))
+				return false;
+
+			string str{ begin, static_cast<size_t>(pos_ - begin - 1) };
+			if (escaped)
+			{
+				// Keep only the character following each backslash
+				unsigned len = 0;
+				for (unsigned a = 0; a < str.size(); ++a, ++len)
+				{
+					if (str[a] == '\\' && a + 1 < str.size())
+						++a;
+					str[len] = str[a];
+				}
+				str.resize(len);
+			}
+
+			value = std::move(str);
+			return true;
+		}
+
+		// Anything else
+		auto begin = pos_;
+		while (pos_ < end_ && !isDelimiter(*pos_))
+			++pos_;
+		if (pos_ == begin)
+		{
+			logError(fmt::format("Unexpected character '{}'", *pos_));
+			return false;
+		}
+
+		value = parseValue({ begin, static_cast<size_t>(pos_ - begin) });
+		return true;
+	}
+
+	// Reads the properties of the block starting at the current position (just
+	// after its opening brace) into [props]
+	bool readBlock(MapObject::UDMFProps& props)
+	{
+		props.clear();
+
+		string_view key;
+		while (!check('}'))
+		{
+			if (!readIdentifier(key) || !expect('='))
+				return false;
+
+			auto& prop = props.emplace_back(key, Property{});
+			for (auto& c : prop.name)
+				c = tolower(c);
+
+			if (!readValue(prop.value) || !expect(';'))
+				return false;
+		}
+
+		return true;
+	}
+
+	// Skips past the end of the block starting at the current position (just
+	// after its opening brace)
+	bool skipBlock()
+	{
+		bool escaped;
+		while (!atEnd())
+		{
+			if (*pos_ == '}')
+			{
+				++pos_;
+				return true;
+			}
+
+			if (*pos_++ == '"' && !skipString(escaped))
+				return false;
+		}
+
+		logError("Unterminated block");
+		return false;
+	}
+
+	// Logs [error] with the line number of the current position
+	void logError(string_view error) const
+	{
+		auto line = std::count(start_, std::min(pos_, end_), '\n') + 1;
+		log::error("Parse Error in TEXTMAP (Line {}): {}", line, error);
+	}
+
+private:
+	const char* start_ = nullptr;
+	const char* pos_   = nullptr;
+	const char* end_   = nullptr;
+
+	// Skips whitespace and comments
+	void skipWhitespace()
+	{
+		while (pos_ < end_)
+		{
+			if (static_cast<unsigned char>(*pos_) <= ' ')
+				++pos_;
+			else if (isCommentStart('/'))
+				pos_ = std::find(pos_ + 2, end_, '\n');
+			else if (isCommentStart('*'))
+			{
+				auto close = string_view{ pos_ + 2, static_cast<size_t>(end_ - pos_ - 2) }.find("*/");
+				pos_       = close == string_view::npos ? end_ : pos_ + 2 + close + 2;
+			}
+			else
+				break;
+		}
+	}
+
+	// Returns true if the current position is the start of a comment ('/'
+	// followed by [c])
+	bool isCommentStart(char c) const { return *pos_ == '/' && pos_ + 1 < end_ && pos_[1] == c; }
+
+	// Returns true if [c] ends an unquoted value
+	bool isDelimiter(char c) const
+	{
+		return static_cast<unsigned char>(c) <= ' ' || c == ';' || c == '}' || c == '{' || c == '=' || c == ','
+			   || c == '"' || (c == '/' && (isCommentStart('/') || isCommentStart('*')));
+	}
+
+	// Skips past the closing quote of the string starting at the current
+	// position (just after its opening quote). [escaped] is set to true if it
+	// contains any escaped characters
+	bool skipString(bool& escaped)
+	{
+		escaped = false;
+		while (pos_ < end_ && *pos_ != '"')
+		{
+			if (*pos_ == '\\')
+			{
+				escaped = true;
+				++pos_;
+			}
+			++pos_;
+		}
+
+		if (pos_ >= end_)
+		{
+			logError("Unterminated string");
+			return false;
+		}
+
+		++pos_;
+		return true;
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Reads the definition blocks starting at [blocks] with [scanner] into [defs],
+// split into [threads] parts that are read in parallel.
+// Returns false if any of the blocks couldn't be read
+// -----------------------------------------------------------------------------
+bool readBlocks(
+	const UDMFScanner&            scanner,
+	const vector<const char*>&    blocks,
+	vector<MapObject::UDMFProps>& defs,
+	unsigned                      threads)
+{
+	defs.clear();
+	defs.resize(blocks.size());
+
+	std::atomic<bool> ok{ true };
+	auto              parts = std::min<size_t>(std::max(threads, 1u), blocks.size());
+	threadpool::parallelFor(parts, [&](size_t part) {
+		// Each part needs its own read position
+		auto scan = scanner;
+		auto end  = (part + 1) * blocks.size() / parts;
+		for (auto a = part * blocks.size() / parts; a < end && ok; ++a)
+		{
+			scan.setPosition(blocks[a]);
+			if (!scan.readBlock(defs[a]))
+				ok = false;
+		}
+	});
+
+	return ok;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // UniversalDoomMapFormat Class Functions
@@ -66,71 +432,100 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 	if (!textmap)
 		return false;
 
-	// --- Parse UDMF text ---
-	ui::setSplashProgressMessage("Parsing TEXTMAP");
-	ui::setSplashProgress(-100.0f);
-	Parser parser;
-	if (!parser.parseText(textmap->data()))
-		return false;
-
-	// --- Process parsed data ---
+	// --- Scan UDMF text ---
 
-	// First we have to sort the definition blocks by type so they can
+	// First we have to find the definition blocks of each type so they can
 	// be created in the correct order (verts->sides->lines->sectors->things),
-	// even if they aren't defined in that order.
-	// Unknown definitions are also kept, just in case
-	ui::setSplashProgressMessage("Sorting definitions");
-	auto                   root = parser.parseTreeRoot();
-	vector<ParseTreeNode*> defs_vertices;
-	vector<ParseTreeNode*> defs_lines;
-	vector<ParseTreeNode*> defs_sides;
-	vector<ParseTreeNode*> defs_sectors;
-	vector<ParseTreeNode*> defs_things;
-	vector<ParseTreeNode*> defs_other;
-	for (unsigned a = 0; a < root->nChildren(); a++)
+	// even if they aren't defined in that order. The blocks themselves are
+	// only read when creating their objects
+	ui::setSplashProgressMessage("Parsing TEXTMAP");
+	ui::setSplashProgress(-100.0f);
+	UDMFScanner         scanner(textmap->data());
+	vector<const char*> defs_vertices;
+	vector<const char*> defs_lines;
+	vector<const char*> defs_sides;
+	vector<const char*> defs_sectors;
+	vector<const char*> defs_things;
+	string_view         name;
+	Property            value;
+	while (!scanner.atEnd())
 	{
-		ui::setSplashProgress((float)a / root->nChildren());
-
-		auto node = root->childPTN(a);
+		if (!scanner.readIdentifier(name))
+			return false;
 
-		// Vertex definition
-		if (strutil::equalCI(node->name(), "vertex"))
-			defs_vertices.push_back(node);
-
-		// Line definition
-		else if (strutil::equalCI(node->name(), "linedef"))
-			defs_lines.push_back(node);
-
-		// Side definition
-		else if (strutil::equalCI(node->name(), "sidedef"))
-			defs_sides.push_back(node);
+		// Definition block
+		if (scanner.check('{'))
+		{
+			auto block = scanner.position();
+			if (!scanner.skipBlock())
+				return false;
+
+			if (strutil::equalCI(name, "vertex"))
+				defs_vertices.push_back(block);
+			else if (strutil::equalCI(name, "linedef"))
+				defs_lines.push_back(block);
+			else if (strutil::equalCI(name, "sidedef"))
+				defs_sides.push_back(block);
+			else if (strutil::equalCI(name, "sector"))
+				defs_sectors.push_back(block);
+			else if (strutil::equalCI(name, "thing"))
+				defs_things.push_back(block);
+
+			// TODO: Unknown blocks
+		}
 
-		// Sector definition
-		else if (strutil::equalCI(node->name(), "sector"))
-			defs_sectors.push_back(node);
+		// Map-scope value
+		else if (scanner.expect('='))
+		{
+			if (!scanner.readValue(value) || !scanner.expect(';'))
+				return false;
 
-		// Thing definition
-		else if (strutil::equalCI(node->name(), "thing"))
-			defs_things.push_back(node);
+			// Namespace
+			if (strutil::equalCI(name, "namespace"))
+				udmf_namespace_ = property::asString(value);
 
-		// Namespace
-		else if (strutil::equalCI(node->name(), "namespace"))
-			udmf_namespace_ = node->stringValue();
+			// Keep any other values
+			else
+				map_extra_props[strutil::lower(name)] = value;
+		}
 
-		// Unknown
 		else
-			defs_other.push_back(node);
+			return false;
 	}
 
-	// Now create map structures from parsed data, in the right order
+	// Now create map structures from the definition blocks, in the right order.
+	// If enabled, the blocks of each type are all read first across multiple
+	// threads, otherwise each is read as its object is created
+	bool                         parallel = udmf_parse_parallel;
+	unsigned                     threads  = std::max<int>(udmf_parse_threads, 0);
+	vector<MapObject::UDMFProps> defs;
+	MapObject::UDMFProps         props;
+	if (parallel && threads == 0)
+		threads = threadpool::pool().numThreads() + 1; // Workers + this thread
+	auto read_defs = [&](const vector<const char*>& blocks) {
+		return !parallel || readBlocks(scanner, blocks, defs, threads);
+	};
+	auto read_def = [&](const vector<const char*>& blocks, unsigned index) -> const MapObject::UDMFProps* {
+		if (parallel)
+			return &defs[index];
+
+		scanner.setPosition(blocks[index]);
+		return scanner.readBlock(props) ? &props : nullptr;
+	};
 
 	// Create vertices from parsed data
 	ui::setSplashProgressMessage("Reading Vertices");
+	if (!read_defs(defs_vertices))
+		return false;
 	for (unsigned a = 0; a < defs_vertices.size(); a++)
 	{
 		ui::setSplashProgress(((float)a / defs_vertices.size()) * 0.2f);
 
-		auto vertex = createVertex(defs_vertices[a]);
+		auto def = read_def(defs_vertices, a);
+		if (!def)
+			return false;
+
+		auto vertex = createVertex(*def);
 		if (!vertex)
 		{
 			log::warning("Invalid UDMF vertex definition {}, not added", a);
@@ -142,11 +537,17 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 	// Create sectors from parsed data
 	ui::setSplashProgressMessage("Reading Sectors");
+	if (!read_defs(defs_sectors))
+		return false;
 	for (unsigned a = 0; a < defs_sectors.size(); a++)
 	{
 		ui::setSplashProgress(0.2f + ((float)a / defs_sectors.size()) * 0.2f);
 
-		auto sector = createSector(defs_sectors[a]);
+		auto def = read_def(defs_sectors, a);
+		if (!def)
+			return false;
+
+		auto sector = createSector(*def);
 		if (!sector)
 		{
 			log::warning("Invalid UDMF sector definition {}, not added", a);
@@ -158,11 +559,17 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 	// Create sides from parsed data
 	ui::setSplashProgressMessage("Reading Sides");
+	if (!read_defs(defs_sides))
+		return false;
 	for (unsigned a = 0; a < defs_sides.size(); a++)
 	{
 		ui::setSplashProgress(0.4f + ((float)a / defs_sides.size()) * 0.2f);
 
-		auto side = createSide(defs_sides[a], map_data);
+		auto def = read_def(defs_sides, a);
+		if (!def)
+			return false;
+
+		auto side = createSide(*def, map_data);
 		if (!side)
 		{
 			log::warning("Invalid UDMF side definition {}, not added", a);
@@ -174,11 +581,17 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 	// Create lines from parsed data
 	ui::setSplashProgressMessage("Reading Lines");
+	if (!read_defs(defs_lines))
+		return false;
 	for (unsigned a = 0; a < defs_lines.size(); a++)
 	{
 		ui::setSplashProgress(0.6f + ((float)a / defs_lines.size()) * 0.2f);
 
-		auto line = createLine(defs_lines[a], map_data);
+		auto def = read_def(defs_lines, a);
+		if (!def)
+			return false;
+
+		auto line = createLine(*def, map_data);
 		if (!line)
 		{
 			log::warning("Invalid UDMF line definition {}, not added", a);
@@ -190,11 +603,17 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 
 	// Create things from parsed data
 	ui::setSplashProgressMessage("Reading Things");
+	if (!read_defs(defs_things))
+		return false;
 	for (unsigned a = 0; a < defs_things.size(); a++)
 	{
 		ui::setSplashProgress(0.8f + ((float)a / defs_things.size()) * 0.2f);
 
-		auto thing = createThing(defs_things[a]);
+		auto def = read_def(defs_things, a);
+		if (!def)
+			return false;
+
+		auto thing = createThing(*def);
 		if (!thing)
 		{
 			log::warning("Invalid UDMF thing definition {}, not added", a);
@@ -204,15 +623,6 @@ bool UniversalDoomMapFormat::readMap(Archive::MapDesc map, MapObjectCollection&
 		map_data.addThing(std::move(thing));
 	}
 
-	// Keep map-scope values
-	for (auto node : defs_other)
-	{
-		if (node->nValues() > 0)
-			map_extra_props[node->name()] = node->value();
-
-		// TODO: Unknown blocks
-	}
-
 	ui::setSplashProgressMessage("Init map data");
 
 	return true;
@@ -229,144 +639,106 @@ vector<unique_ptr<ArchiveEntry>> UniversalDoomMapFormat::writeMap(
 	vector<unique_ptr<ArchiveEntry>> entries;
 	entries.push_back(std::make_unique<ArchiveEntry>("TEXTMAP"));
 
-	// Open temp text file
-	wxFile tempfile(app::path("sladetemp.txt", app::Dir::Temp), wxFile::write);
-
-	// Write map namespace
-	tempfile.Write("// Written by SLADE3\n");
-	tempfile.Write(fmt::format("namespace=\"{}\";\n", udmf_namespace_));
-
-	// Write map-scope props
-	tempfile.Write(map_extra_props.toString(true));
-	tempfile.Write("\n");
-
-	// sf::Clock clock;
+	// Write map namespace and map-scope props
+	string textmap = "// Written by SLADE3\n";
+	fmt::format_to(std::back_inserter(textmap), "namespace=\"{}\";\n", udmf_namespace_);
+	map_extra_props.write(textmap, true);
+	textmap += "\n";
 
 	// Locale for float number format
 	setlocale(LC_NUMERIC, "C");
 
-	// Write things
-	string object_def;
-	for (const auto& thing : map_data.things())
-	{
-		// Cleanup properties
-		if (!thing->props().empty())
+	// Get all objects to write, in order (things, lines, sides, vertices, sectors)
+	vector<MapObject*> objects;
+	objects.reserve(
+		map_data.things().size() + map_data.lines().size() + map_data.sides().size() + map_data.vertices().size()
+		+ map_data.sectors().size());
+	objects.insert(objects.end(), map_data.things().begin(), map_data.things().end());
+	objects.insert(objects.end(), map_data.lines().begin(), map_data.lines().end());
+	objects.insert(objects.end(), map_data.sides().begin(), map_data.sides().end());
+	objects.insert(objects.end(), map_data.vertices().begin(), map_data.vertices().end());
+	objects.insert(objects.end(), map_data.sectors().begin(), map_data.sectors().end());
+
+	// Cleanup and write object definitions in parts across multiple threads,
+	// each part to its own text
+	auto           n_parts = (objects.size() + WRITE_PART_SIZE - 1) / WRITE_PART_SIZE;
+	vector<string> parts(n_parts);
+	threadpool::parallelFor(n_parts, [&](size_t part) {
+		auto  end  = std::min(objects.size(), (part + 1) * WRITE_PART_SIZE);
+		auto& text = parts[part];
+		text.reserve((end - part * WRITE_PART_SIZE) * 128);
+		for (auto a = part * WRITE_PART_SIZE; a < end; ++a)
 		{
-			thing->props().remove("flags");
-			game::configuration().cleanObjectUDMFProps(thing);
-		}
+			auto object = objects[a];
 
-		thing->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing things took %dms", clock.getElapsedTime().asMilliseconds());
+			// Cleanup properties
+			if (!object->props().empty())
+			{
+				if (object->objType() == MapObject::Type::Thing || object->objType() == MapObject::Type::Line)
+					object->props().remove("flags");
+				game::configuration().cleanObjectUDMFProps(object);
+			}
 
-	// Write lines
-	// clock.restart();
-	for (const auto& line : map_data.lines())
-	{
-		// Cleanup properties
-		if (!line->props().empty())
-		{
-			line->props().remove("flags");
-			game::configuration().cleanObjectUDMFProps(line);
+			object->writeUDMF(text);
 		}
+	});
 
-		line->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing lines took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sides
-	// clock.restart();
-	for (const auto& side : map_data.sides())
-	{
-		// Cleanup properties
-		if (!side->props().empty())
-			game::configuration().cleanObjectUDMFProps(side);
-
-		side->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sides took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write vertices
-	// clock.restart();
-	for (const auto& vertex : map_data.vertices())
-	{
-		// Cleanup properties
-		if (!vertex->props().empty())
-			game::configuration().cleanObjectUDMFProps(vertex);
-
-		vertex->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing vertices took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Write sectors
-	// clock.restart();
-	for (const auto& sector : map_data.sectors())
-	{
-		// Cleanup properties
-		if (!sector->props().empty())
-			game::configuration().cleanObjectUDMFProps(sector);
-
-		sector->writeUDMF(object_def);
-		tempfile.Write(object_def);
-	}
-	// log::info(1, "Writing sectors took %dms", clock.getElapsedTime().asMilliseconds());
-
-	// Close file
-	tempfile.Close();
-
-	// Load file to entry
-	entries[0]->importFile(app::path("sladetemp.txt", app::Dir::Temp));
+	// Join everything together into the TEXTMAP entry data
+	auto size = textmap.size();
+	for (const auto& text : parts)
+		size += text.size();
+	textmap.reserve(size);
+	for (const auto& text : parts)
+		textmap += text;
+	entries[0]->importMem(textmap.data(), textmap.size());
 
 	return entries;
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a vertex from parsed UDMF definition [def]
+// Creates and returns a vertex from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(ParseTreeNode* def) const
+unique_ptr<MapVertex> UniversalDoomMapFormat::createVertex(const MapObject::UDMFProps& def) const
 {
 	// Check for required properties
-	auto prop_x = def->childPTN("x");
-	auto prop_y = def->childPTN("y");
+	auto prop_x = findProp(def, MapVertex::PROP_X);
+	auto prop_y = findProp(def, MapVertex::PROP_Y);
 	if (!prop_x || !prop_y)
 		return nullptr;
 
 	// Create vertex
-	return std::make_unique<MapVertex>(Vec2d{ prop_x->floatValue(), prop_y->floatValue() }, def);
+	return std::make_unique<MapVertex>(Vec2d{ property::asFloat(*prop_x), property::asFloat(*prop_y) }, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a sector from parsed UDMF definition [def]
+// Creates and returns a sector from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapSector> UniversalDoomMapFormat::createSector(ParseTreeNode* def) const
+unique_ptr<MapSector> UniversalDoomMapFormat::createSector(const MapObject::UDMFProps& def) const
 {
 	// Check for required properties
-	auto prop_ftex = def->childPTN("texturefloor");
-	auto prop_ctex = def->childPTN("textureceiling");
+	auto prop_ftex = findProp(def, MapSector::PROP_TEXFLOOR);
+	auto prop_ctex = findProp(def, MapSector::PROP_TEXCEILING);
 	if (!prop_ftex || !prop_ctex)
 		return nullptr;
 
 	// Create sector
-	return std::make_unique<MapSector>(prop_ftex->stringValue(), prop_ctex->stringValue(), def);
+	return std::make_unique<MapSector>(property::asString(*prop_ftex), property::asString(*prop_ctex), def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a side from parsed UDMF definition [def]
+// Creates and returns a side from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const
+unique_ptr<MapSide> UniversalDoomMapFormat::createSide(
+	const MapObject::UDMFProps& def,
+	const MapObjectCollection&  map_data) const
 {
 	// Check for required properties
-	auto prop_sector = def->childPTN("sector");
+	auto prop_sector = findProp(def, MapSide::PROP_SECTOR);
 	if (!prop_sector)
 		return nullptr;
 
 	// Check sector exists
-	auto sector = map_data.sectors().at(prop_sector->intValue());
+	auto sector = map_data.sectors().at(property::asInt(*prop_sector));
 	if (!sector)
 		return nullptr;
 
@@ -375,45 +747,47 @@ unique_ptr<MapSide> UniversalDoomMapFormat::createSide(ParseTreeNode* def, const
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a line from parsed UDMF definition [def]
+// Creates and returns a line from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapLine> UniversalDoomMapFormat::createLine(ParseTreeNode* def, const MapObjectCollection& map_data) const
+unique_ptr<MapLine> UniversalDoomMapFormat::createLine(
+	const MapObject::UDMFProps& def,
+	const MapObjectCollection&  map_data) const
 {
 	// Check for required properties
-	auto prop_v1 = def->childPTN(MapLine::PROP_V1);
-	auto prop_v2 = def->childPTN(MapLine::PROP_V2);
-	auto prop_s1 = def->childPTN(MapLine::PROP_S1);
-	auto prop_s2 = def->childPTN(MapLine::PROP_S2);
+	auto prop_v1 = findProp(def, MapLine::PROP_V1);
+	auto prop_v2 = findProp(def, MapLine::PROP_V2);
+	auto prop_s1 = findProp(def, MapLine::PROP_S1);
+	auto prop_s2 = findProp(def, MapLine::PROP_S2);
 	if (!prop_v1 || !prop_v2 || !prop_s1)
 		return nullptr;
 
 	// Check vertices
-	auto v1 = map_data.vertices().at(prop_v1->intValue());
-	auto v2 = map_data.vertices().at(prop_v2->intValue());
+	auto v1 = map_data.vertices().at(property::asInt(*prop_v1));
+	auto v2 = map_data.vertices().at(property::asInt(*prop_v2));
 	if (!v1 || !v2)
 		return nullptr;
 
 	// Get sides
-	auto s1 = map_data.sides().at(prop_s1->intValue());
-	auto s2 = prop_s2 ? map_data.sides().at(prop_s2->intValue()) : nullptr;
+	auto s1 = map_data.sides().at(property::asInt(*prop_s1));
+	auto s2 = prop_s2 ? map_data.sides().at(property::asInt(*prop_s2)) : nullptr;
 
 	// Create line
 	return std::make_unique<MapLine>(v1, v2, s1, s2, def);
 }
 
 // -----------------------------------------------------------------------------
-// Creates and returns a thing from parsed UDMF definition [def]
+// Creates and returns a thing from UDMF definition [def]
 // -----------------------------------------------------------------------------
-unique_ptr<MapThing> UniversalDoomMapFormat::createThing(ParseTreeNode* def) const
+unique_ptr<MapThing> UniversalDoomMapFormat::createThing(const MapObject::UDMFProps& def) const
 {
 	// Check for required properties
-	auto prop_x    = def->childPTN(MapThing::PROP_X);
-	auto prop_y    = def->childPTN(MapThing::PROP_Y);
-	auto prop_type = def->childPTN(MapThing::PROP_TYPE);
+	auto prop_x    = findProp(def, MapThing::PROP_X);
+	auto prop_y    = findProp(def, MapThing::PROP_Y);
+	auto prop_type = findProp(def, MapThing::PROP_TYPE);
 	if (!prop_x || !prop_y || !prop_type)
 		return nullptr;
 
 	// Create thing
 	return std::make_unique<MapThing>(
-		Vec3d{ prop_x->floatValue(), prop_y->floatValue(), 0. }, prop_type->intValue(), def);
+		Vec3d{ property::asFloat(*prop_x), property::asFloat(*prop_y), 0. }, property::asInt(*prop_type), def);
 }
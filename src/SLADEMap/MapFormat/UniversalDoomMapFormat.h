@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapFormatHandler.h"
+#include "SLADEMap/MapObject/MapObject.h"
 
 namespace slade
 {
@@ -9,7 +10,6 @@ class MapSector;
 class MapSide;
 class MapLine;
 class MapThing;
-class ParseTreeNode;
 
 class UniversalDoomMapFormat : public MapFormatHandler
 {
@@ -25,10 +25,10 @@ public:
 private:
 	string udmf_namespace_;
 
-	unique_ptr<MapVertex> createVertex(ParseTreeNode* def) const;
-	unique_ptr<MapSector> createSector(ParseTreeNode* def) const;
-	unique_ptr<MapSide>   createSide(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	unique_ptr<MapLine>   createLine(ParseTreeNode* def, const MapObjectCollection& map_data) const;
-	unique_ptr<MapThing>  createThing(ParseTreeNode* def) const;
+	unique_ptr<MapVertex> createVertex(const MapObject::UDMFProps& def) const;
+	unique_ptr<MapSector> createSector(const MapObject::UDMFProps& def) const;
+	unique_ptr<MapSide>   createSide(const MapObject::UDMFProps& def, const MapObjectCollection& map_data) const;
+	unique_ptr<MapLine>   createLine(const MapObject::UDMFProps& def, const MapObjectCollection& map_data) const;
+	unique_ptr<MapThing>  createThing(const MapObject::UDMFProps& def) const;
 };
 } // namespace slade
@@ -31,11 +31,11 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapLine.h"
+#include "MapObjectPool.h"
 #include "MapSide.h"
 #include "MapVertex.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
-#include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -77,7 +77,7 @@ MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, int spe
 // -----------------------------------------------------------------------------
 // MapLine class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTreeNode* udmf_def) :
+MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, const UDMFProps& udmf_props) :
 	MapObject(Type::Line),
 	vertex1_{ v1 },
 	vertex2_{ v2 },
@@ -97,36 +97,50 @@ MapLine::MapLine(MapVertex* v1, MapVertex* v2, MapSide* s1, MapSide* s2, ParseTr
 		s2->parent_ = this;
 
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& prop : udmf_props)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->nameIsCI(PROP_V1) || prop->nameIsCI(PROP_V2) || prop->nameIsCI(PROP_S1) || prop->nameIsCI(PROP_S2))
+		if (strutil::equalCI(prop.name, PROP_V1) || strutil::equalCI(prop.name, PROP_V2)
+			|| strutil::equalCI(prop.name, PROP_S1) || strutil::equalCI(prop.name, PROP_S2))
 			continue;
 
-		if (prop->nameIsCI(PROP_SPECIAL))
-			special_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_ID))
-			id_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_FLAGS))
-			flags_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG0))
-			args_[0] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG1))
-			args_[1] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG2))
-			args_[2] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG3))
-			args_[3] = prop->intValue();
-		else if (prop->nameIsCI(PROP_ARG4))
-			args_[4] = prop->intValue();
+		if (strutil::equalCI(prop.name, PROP_SPECIAL))
+			special_ = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ID))
+			id_ = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_FLAGS))
+			flags_ = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ARG0))
+			args_[0] = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ARG1))
+			args_[1] = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ARG2))
+			args_[2] = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ARG3))
+			args_[3] = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ARG4))
+			args_[4] = property::asInt(prop.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[prop.name] = prop.value;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapLine from the line pool
+// -----------------------------------------------------------------------------
+void* MapLine::operator new(size_t size)
+{
+	return MapObjectPool<MapLine>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the memory used by a MapLine to the line pool
+// -----------------------------------------------------------------------------
+void MapLine::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapLine>::deallocate(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the sector on the front side of the line (if any)
 // -----------------------------------------------------------------------------
@@ -987,29 +1001,29 @@ void MapLine::copy(MapObject* c)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the line as a UDMF text definition to [def]
+// Appends the line as a UDMF text definition to [def]
 // -----------------------------------------------------------------------------
 void MapLine::writeUDMF(string& def)
 {
-	def = fmt::format("linedef//#{}\n{{\n", index_);
+	fmt::format_to(std::back_inserter(def), "linedef//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("v1={};\nv2={};\nsidefront={};\n", v1Index(), v2Index(), s1Index());
+	fmt::format_to(std::back_inserter(def), "v1={};\nv2={};\nsidefront={};\n", v1Index(), v2Index(), s1Index());
 	if (s2())
-		def += fmt::format("sideback={};\n", s2Index());
+		fmt::format_to(std::back_inserter(def), "sideback={};\n", s2Index());
 	if (special_ != 0)
-		def += fmt::format("special={};\n", special_);
+		fmt::format_to(std::back_inserter(def), "special={};\n", special_);
 	if (id_ != 0)
-		def += fmt::format("id={};\n", id_);
+		fmt::format_to(std::back_inserter(def), "id={};\n", id_);
 	if (flags_ != 0)
-		def += fmt::format("flags={};\n", flags_);
+		fmt::format_to(std::back_inserter(def), "flags={};\n", flags_);
 	for (unsigned i = 0; i < 5; ++i)
 		if (args_[i] != 0)
-			def += fmt::format("arg{}={};\n", i, args_[i]);
+			fmt::format_to(std::back_inserter(def), "arg{}={};\n", i, args_[i]);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
@@ -35,6 +35,7 @@
 #include "App.h"
 #include "Game/Configuration.h"
 #include "SLADEMap/SLADEMap.h"
+#include <atomic>
 
 using namespace slade;
 
@@ -46,7 +47,9 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 namespace
 {
-long prop_backup_time = -1;
+long                       prop_backup_time   = -1;
+std::atomic<unsigned long> modification_count = 0; // Incremented whenever any map object is modified, added or removed
+                                                   // (atomic since separate maps can be loaded on worker threads)
 } // namespace
 
 
@@ -103,7 +106,8 @@ void MapObject::setModified()
 		backupTo(obj_backup_.get());
 	}
 
-	modified_time_ = app::runTimer();
+	modified_time_     = app::runTimer();
+	last_modification_ = ++modification_count;
 }
 
 // -----------------------------------------------------------------------------
@@ -348,6 +352,24 @@ void MapObject::endPropBackup()
 	prop_backup_time = -1;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the number of times any map object has been modified (so far), for
+// checking if anything has changed since it was last looked at
+// -----------------------------------------------------------------------------
+unsigned long MapObject::modificationCount()
+{
+	return modification_count;
+}
+
+// -----------------------------------------------------------------------------
+// Increments the map object modification count, for changes that don't modify
+// a specific object (eg. adding or removing objects)
+// -----------------------------------------------------------------------------
+void MapObject::incModificationCount()
+{
+	++modification_count;
+}
+
 
 // -----------------------------------------------------------------------------
 // Checks the boolean property [prop] on all objects in [objects].
@@ -50,7 +50,8 @@ public:
 		Type         type = Type::Object;
 	};
 
-	typedef std::array<int, 5> ArgSet;
+	typedef std::array<int, 5>      ArgSet;
+	typedef vector<Named<Property>> UDMFProps; // Properties of a UDMF definition block, in order
 
 	MapObject(Type type = Type::Object, SLADEMap* parent = nullptr);
 	virtual ~MapObject() = default;
@@ -60,15 +61,16 @@ public:
 	bool operator<(const MapObject& right) const { return (index_ < right.index_); }
 	bool operator>(const MapObject& right) const { return (index_ > right.index_); }
 
-	Type      objType() const { return type_; }
-	unsigned  index() const;
-	SLADEMap* parentMap() const { return parent_map_; }
-	bool      isFiltered() const { return filtered_; }
-	long      modifiedTime() const { return modified_time_; }
-	unsigned  objId() const { return obj_id_; }
-	string    typeName() const;
-	void      setModified();
-	void      setIndex(unsigned index) { index_ = index; }
+	Type          objType() const { return type_; }
+	unsigned      index() const;
+	SLADEMap*     parentMap() const { return parent_map_; }
+	bool          isFiltered() const { return filtered_; }
+	long          modifiedTime() const { return modified_time_; }
+	unsigned long lastModification() const { return last_modification_; }
+	unsigned      objId() const { return obj_id_; }
+	string        typeName() const;
+	void          setModified();
+	void          setIndex(unsigned index) { index_ = index; }
 
 	PropertyList& props() { return properties_; }
 	bool          hasProp(string_view key);
@@ -103,6 +105,9 @@ public:
 	static void beginPropBackup(long current_time);
 	static void endPropBackup();
 
+	static unsigned long modificationCount();
+	static void          incModificationCount();
+
 	static bool multiBoolProperty(vector<MapObject*>& objects, string_view prop, bool& value);
 	static bool multiIntProperty(vector<MapObject*>& objects, string_view prop, int& value);
 	static bool multiFloatProperty(vector<MapObject*>& objects, string_view prop, double& value);
@@ -112,9 +117,10 @@ protected:
 	unsigned           index_      = 0;
 	SLADEMap*          parent_map_ = nullptr;
 	PropertyList       properties_;
-	bool               filtered_      = false;
-	long               modified_time_ = 0;
-	unsigned           obj_id_        = 0;
+	bool               filtered_          = false;
+	long               modified_time_     = 0;
+	unsigned long      last_modification_ = 0; // modificationCount after the last setModified
+	unsigned           obj_id_            = 0;
 	unique_ptr<Backup> obj_backup_;
 
 private:
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <mutex>
+
+namespace slade
+{
+// Pool allocator for map objects of type T, used by the map object classes'
+// operator new/delete. Objects are allocated from chunks of [ChunkSize]
+// objects rather than individually, and the chunks are released all at once
+// when no objects from the pool are in use any more (see releaseUnused)
+template<class T, unsigned ChunkSize = 4096> class MapObjectPool
+{
+public:
+	static void* allocate(size_t size)
+	{
+		// Objects of a derived type can't go in the pool
+		if (size != sizeof(T))
+			return ::operator new(size);
+
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+
+		if (!pool.free_)
+			pool.addChunk();
+
+		auto slot  = pool.free_;
+		pool.free_ = slot->next;
+		++pool.used_;
+
+		return slot;
+	}
+
+	static void deallocate(void* ptr, size_t size)
+	{
+		if (!ptr)
+			return;
+
+		if (size != sizeof(T))
+		{
+			::operator delete(ptr);
+			return;
+		}
+
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+
+		auto slot  = static_cast<Slot*>(ptr);
+		slot->next = pool.free_;
+		pool.free_ = slot;
+		--pool.used_;
+	}
+
+	// Frees all allocated chunks if no objects from the pool are in use
+	static void releaseUnused()
+	{
+		auto&           pool = instance();
+		std::lock_guard lock(pool.mutex_);
+
+		if (pool.used_ > 0)
+			return;
+
+		pool.chunks_.clear();
+		pool.free_ = nullptr;
+	}
+
+private:
+	union Slot
+	{
+		Slot* next;
+		alignas(T) uint8_t object[sizeof(T)];
+	};
+
+	vector<unique_ptr<Slot[]>> chunks_;
+	Slot*                      free_ = nullptr;
+	unsigned                   used_ = 0;
+	std::mutex                 mutex_;
+
+	// The pool is never destroyed, since objects may still be deleted during
+	// static destruction at exit
+	static MapObjectPool& instance()
+	{
+		static auto pool = new MapObjectPool;
+		return *pool;
+	}
+
+	void addChunk()
+	{
+		chunks_.emplace_back(new Slot[ChunkSize]);
+
+		// Add to the free list backwards, so objects are allocated in order
+		auto chunk = chunks_.back().get();
+		for (auto a = ChunkSize; a > 0; --a)
+		{
+			chunk[a - 1].next = free_;
+			free_             = &chunk[a - 1];
+		}
+	}
+};
+} // namespace slade
@@ -31,15 +31,27 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSector.h"
+#include "MapObjectPool.h"
 #include "App.h"
 #include "Game/Configuration.h"
+#include "SLADEMap/MapObjectList/ObjectGrid.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
-#include "Utility/Parser.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned EDGE_GRID_MIN = 64; // Minimum number of edges for a sector to have an edge grid
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapSector Class Functions
@@ -71,7 +83,7 @@ MapSector::MapSector(
 // -----------------------------------------------------------------------------
 // MapSector class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapSector::MapSector(string_view f_tex, string_view c_tex, ParseTreeNode* udmf_def) :
+MapSector::MapSector(string_view f_tex, string_view c_tex, const UDMFProps& udmf_props) :
 	MapObject(Type::Sector),
 	floor_{ f_tex },
 	ceiling_{ c_tex }
@@ -80,30 +92,48 @@ MapSector::MapSector(string_view f_tex, string_view c_tex, ParseTreeNode* udmf_d
 	light_ = 160;
 
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& prop : udmf_props)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->nameIsCI(PROP_TEXFLOOR) || prop->nameIsCI(PROP_TEXCEILING))
+		if (strutil::equalCI(prop.name, PROP_TEXFLOOR) || strutil::equalCI(prop.name, PROP_TEXCEILING))
 			continue;
 
-		if (prop->nameIsCI(PROP_HEIGHTFLOOR))
-			setFloorHeight(prop->intValue());
-		else if (prop->nameIsCI(PROP_HEIGHTCEILING))
-			setCeilingHeight(prop->intValue());
-		else if (prop->nameIsCI(PROP_LIGHTLEVEL))
-			light_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_SPECIAL))
-			special_ = prop->intValue();
-		else if (prop->nameIsCI(PROP_ID))
-			id_ = prop->intValue();
+		if (strutil::equalCI(prop.name, PROP_HEIGHTFLOOR))
+			setFloorHeight(property::asInt(prop.value));
+		else if (strutil::equalCI(prop.name, PROP_HEIGHTCEILING))
+			setCeilingHeight(property::asInt(prop.value));
+		else if (strutil::equalCI(prop.name, PROP_LIGHTLEVEL))
+			light_ = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_SPECIAL))
+			special_ = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_ID))
+			id_ = property::asInt(prop.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[prop.name] = prop.value;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// MapSector class destructor
+// -----------------------------------------------------------------------------
+MapSector::~MapSector() = default;
+
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapSector from the sector pool
+// -----------------------------------------------------------------------------
+void* MapSector::operator new(size_t size)
+{
+	return MapObjectPool<MapSector>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the memory used by a MapSector to the sector pool
+// -----------------------------------------------------------------------------
+void MapSector::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapSector>::deallocate(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // Copies another map object [s]
 // -----------------------------------------------------------------------------
@@ -412,31 +442,61 @@ bool MapSector::containsPoint(Vec2d point)
 		return false;
 
 	// Find nearest line in the sector
-	double   dist;
+	updateEdges();
 	double   min_dist = 999999;
-	MapLine* nline    = nullptr;
-	for (auto& connected_side : connected_sides_)
+	unsigned nearest  = edges_.size();
+	if (edge_grid_)
 	{
-		// Calculate distance to line
-		dist = connected_side->parentLine()->distanceTo(point);
-
-		// Check distance
-		if (dist < min_dist)
+		// Search outwards from the point until a line is found within the
+		// search radius (any nearer line would have to be within it too)
+		auto radius = edge_grid_->cellSize();
+		while (true)
 		{
-			nline    = connected_side->parentLine();
-			min_dist = dist;
+			auto left   = point.x - radius;
+			auto top    = point.y - radius;
+			auto right  = point.x + radius;
+			auto bottom = point.y + radius;
+			edge_grid_->forEachIn(left, top, right, bottom, [&](unsigned index) {
+				auto dist = edgeDistance(edges_[index], point);
+				if (dist < min_dist || dist == min_dist && index < nearest)
+				{
+					nearest  = index;
+					min_dist = dist;
+				}
+			});
+
+			if (nearest < edges_.size() && min_dist <= radius || edge_grid_->covers(left, top, right, bottom))
+				break;
+
+			radius *= 2;
+		}
+	}
+	else
+	{
+		for (unsigned a = 0; a < edges_.size(); ++a)
+		{
+			// Calculate distance to line
+			auto dist = edgeDistance(edges_[a], point);
+
+			// Check distance
+			if (dist < min_dist)
+			{
+				nearest  = a;
+				min_dist = dist;
+			}
 		}
 	}
 
 	// No nearest (shouldn't happen)
-	if (!nline)
+	if (nearest >= edges_.size())
 		return false;
 
 	// Check the side of the nearest line
-	double side = math::lineSide(point, nline->seg());
-	if (side >= 0 && nline->frontSector() == this)
+	auto&  edge = edges_[nearest];
+	double side = math::lineSide(point, { edge.x1, edge.y1, edge.x2, edge.y2 });
+	if (side >= 0 && edge.front)
 		return true;
-	else if (side < 0 && nline->backSector() == this)
+	else if (side < 0 && edge.back)
 		return true;
 	else
 		return false;
@@ -546,6 +606,15 @@ bool MapSector::putVertices(vector<MapObject*>& list)
 // Returns the light level of the sector at [where] - 1 = floor, 2 = ceiling
 // -----------------------------------------------------------------------------
 uint8_t MapSector::lightAt(int where)
+{
+	return lighting().light[where == Floor || where == Ceiling ? where : 0];
+}
+
+// -----------------------------------------------------------------------------
+// Works out the light level of the sector at [where] from its properties
+// (see lightAt)
+// -----------------------------------------------------------------------------
+uint8_t MapSector::resolveLight(int where)
 {
 	// Check for UDMF + flat lighting
 	if (parent_map_->currentFormat() == MapFormat::UDMF
@@ -636,6 +705,19 @@ void MapSector::changeLight(int amount, int where)
 // If [fullbright] is true, light level is ignored
 // -----------------------------------------------------------------------------
 ColRGBA MapSector::colourAt(int where, bool fullbright)
+{
+	auto& lighting = this->lighting();
+	if (fullbright)
+		return lighting.colour_fullbright;
+
+	return lighting.colour[where == Floor || where == Ceiling ? where : 0];
+}
+
+// -----------------------------------------------------------------------------
+// Works out the colour of the sector at [where] from its properties and any
+// map specials (see colourAt)
+// -----------------------------------------------------------------------------
+ColRGBA MapSector::resolveColour(int where, bool fullbright)
 {
 	using game::UDMFFeature;
 
@@ -742,6 +824,15 @@ ColRGBA MapSector::colourAt(int where, bool fullbright)
 // Returns the fog colour of the sector
 // -----------------------------------------------------------------------------
 ColRGBA MapSector::fogColour()
+{
+	return lighting().fog;
+}
+
+// -----------------------------------------------------------------------------
+// Works out the fog colour of the sector from its properties and any map
+// specials (see fogColour)
+// -----------------------------------------------------------------------------
+ColRGBA MapSector::resolveFogColour()
 {
 	ColRGBA color(0, 0, 0, 0);
 
@@ -764,6 +855,31 @@ ColRGBA MapSector::fogColour()
 	return color;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the sector's resolved light levels and colours, working them out
+// again first if the sector or map special colours were modified since they
+// were last resolved
+// -----------------------------------------------------------------------------
+const MapSector::Lighting& MapSector::lighting()
+{
+	auto specials = parent_map_->mapSpecials()->coloursUpdated();
+	if (lighting_.valid && lighting_.modification == last_modification_ && lighting_.specials == specials)
+		return lighting_;
+
+	for (int where = 0; where < 3; ++where)
+	{
+		lighting_.light[where]  = resolveLight(where);
+		lighting_.colour[where] = resolveColour(where, false);
+	}
+	lighting_.colour_fullbright = resolveColour(0, true);
+	lighting_.fog               = resolveFogColour();
+	lighting_.modification      = last_modification_;
+	lighting_.specials          = specials;
+	lighting_.valid             = true;
+
+	return lighting_;
+}
+
 // -----------------------------------------------------------------------------
 // Finds the 'text point' for the sector. This is a point within the sector that
 // is reasonably close to the middle of the sector bbox while still being within
@@ -897,24 +1013,25 @@ void MapSector::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the sector as a UDMF text definition to [def]
+// Appends the sector as a UDMF text definition to [def]
 // -----------------------------------------------------------------------------
 void MapSector::writeUDMF(string& def)
 {
-	def = fmt::format("sector//#{}\n{{\n", index_);
+	fmt::format_to(std::back_inserter(def), "sector//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("texturefloor=\"{}\";\ntextureceiling=\"{}\";\n", floor_.texture, ceiling_.texture);
+	fmt::format_to(
+		std::back_inserter(def), "texturefloor=\"{}\";\ntextureceiling=\"{}\";\n", floor_.texture, ceiling_.texture);
 	if (floor_.height != 0)
-		def += fmt::format("heightfloor={};\n", floor_.height);
+		fmt::format_to(std::back_inserter(def), "heightfloor={};\n", floor_.height);
 	if (ceiling_.height != 0)
-		def += fmt::format("heightceiling={};\n", ceiling_.height);
+		fmt::format_to(std::back_inserter(def), "heightceiling={};\n", ceiling_.height);
 	if (light_ != 160)
-		def += fmt::format("lightlevel={};\n", light_);
+		fmt::format_to(std::back_inserter(def), "lightlevel={};\n", light_);
 	if (special_ != 0)
-		def += fmt::format("special={};\n", special_);
+		fmt::format_to(std::back_inserter(def), "special={};\n", special_);
 	if (id_ != 0)
-		def += fmt::format("id={};\n", id_);
+		fmt::format_to(std::back_inserter(def), "id={};\n", id_);
 
 	// For UDMF sector planes, ALL values must be added, or else GZDoom
 	// will consider them invalid.
@@ -958,15 +1075,15 @@ void MapSector::writeUDMF(string& def)
 
 	// Other properties (that are not related to floor/ceiling planes
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	// Write the floor and ceiling plane values in order
 	if (hasFloorPlane)
 	{
-		def += fmt::format("floorplane_a = {};", floor_a);
-		def += fmt::format("floorplane_b = {};", floor_b);
-		def += fmt::format("floorplane_c = {};", floor_c);
-		def += fmt::format("floorplane_d = {};", floor_d);
+		fmt::format_to(std::back_inserter(def), "floorplane_a = {};", floor_a);
+		fmt::format_to(std::back_inserter(def), "floorplane_b = {};", floor_b);
+		fmt::format_to(std::back_inserter(def), "floorplane_c = {};", floor_c);
+		fmt::format_to(std::back_inserter(def), "floorplane_d = {};", floor_d);
 		// Persist between multiple saves
 		properties_["floorplane_a"] = floor_a;
 		properties_["floorplane_b"] = floor_b;
@@ -975,10 +1092,10 @@ void MapSector::writeUDMF(string& def)
 	}
 	if (hasCeilingPlane)
 	{
-		def += fmt::format("ceilingplane_a = {};", ceiling_a);
-		def += fmt::format("ceilingplane_b = {};", ceiling_b);
-		def += fmt::format("ceilingplane_c = {};", ceiling_c);
-		def += fmt::format("ceilingplane_d = {};", ceiling_d);
+		fmt::format_to(std::back_inserter(def), "ceilingplane_a = {};", ceiling_a);
+		fmt::format_to(std::back_inserter(def), "ceilingplane_b = {};", ceiling_b);
+		fmt::format_to(std::back_inserter(def), "ceilingplane_c = {};", ceiling_c);
+		fmt::format_to(std::back_inserter(def), "ceilingplane_d = {};", ceiling_d);
 		// Persist between multiple saves
 		properties_["ceilingplane_a"] = ceiling_a;
 		properties_["ceilingplane_b"] = ceiling_b;
@@ -988,3 +1105,72 @@ void MapSector::writeUDMF(string& def)
 
 	def += "}\n\n";
 }
+
+// -----------------------------------------------------------------------------
+// Updates the cached sector edges if any map objects have been modified since
+// they were last updated
+// -----------------------------------------------------------------------------
+void MapSector::updateEdges()
+{
+	auto modifications = modificationCount();
+	if (edges_valid_ && edges_updated_ == modifications)
+		return;
+
+	edges_.clear();
+	edges_.reserve(connected_sides_.size());
+	for (auto& side : connected_sides_)
+	{
+		auto line = side->parentLine();
+		Edge edge{ line->x1(), line->y1(), line->x2(), line->y2(), 0, 0, 0 };
+		edge.length = line->seg().length();
+		if (edge.length != 0)
+		{
+			edge.ca = (edge.x2 - edge.x1) / edge.length;
+			edge.sa = (edge.y2 - edge.y1) / edge.length;
+		}
+		edge.front = line->frontSector() == this;
+		edge.back  = line->backSector() == this;
+		edges_.push_back(edge);
+	}
+
+	// Build a grid of the edges if there are enough to be worth it
+	edge_grid_.reset();
+	if (edges_.size() >= EDGE_GRID_MIN)
+	{
+		auto           count = edges_.size();
+		vector<double> left(count), top(count), right(count), bottom(count);
+		for (unsigned a = 0; a < count; ++a)
+		{
+			left[a]   = std::min(edges_[a].x1, edges_[a].x2);
+			top[a]    = std::min(edges_[a].y1, edges_[a].y2);
+			right[a]  = std::max(edges_[a].x1, edges_[a].x2);
+			bottom[a] = std::max(edges_[a].y1, edges_[a].y2);
+		}
+
+		edge_grid_ = std::make_unique<ObjectGrid>();
+		edge_grid_->build(count, left.data(), top.data(), right.data(), bottom.data());
+	}
+
+	edges_updated_ = modifications;
+	edges_valid_   = true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the distance from [point] to [edge] (calculated the same way as
+// MapLine::distanceTo)
+// -----------------------------------------------------------------------------
+double MapSector::edgeDistance(const Edge& edge, Vec2d point) const
+{
+	// Calculate intersection point
+	double mx, ix, iy;
+	mx = (-edge.x1 + point.x) * edge.ca + (-edge.y1 + point.y) * edge.sa;
+	if (mx <= 0)
+		mx = 0.00001; // Clip intersection to line (but not exactly on endpoints)
+	else if (mx >= edge.length)
+		mx = edge.length - 0.00001; // ^^
+	ix = edge.x1 + mx * edge.ca;
+	iy = edge.y1 + mx * edge.sa;
+
+	// Calculate distance to line
+	return sqrt((ix - point.x) * (ix - point.x) + (iy - point.y) * (iy - point.y));
+}
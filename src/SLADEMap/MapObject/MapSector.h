@@ -6,6 +6,8 @@
 
 namespace slade
 {
+class ObjectGrid;
+
 class MapSector : public MapObject
 {
 	friend class SLADEMap;
@@ -32,6 +34,19 @@ public:
 		}
 	};
 
+	// Light levels and colours of the sector, resolved from its properties and
+	// map specials (see lighting). Indexed by 0 = general, 1 = floor, 2 = ceiling
+	struct Lighting
+	{
+		uint8_t       light[3] = { 0, 0, 0 };
+		ColRGBA       colour[3];
+		ColRGBA       colour_fullbright;
+		ColRGBA       fog;
+		unsigned long modification = 0; // MapObject::lastModification when resolved
+		unsigned long specials     = 0; // MapSpecials::coloursUpdated when resolved
+		bool          valid        = false;
+	};
+
 	// UDMF properties
 	inline static const string PROP_TEXFLOOR      = "texturefloor";
 	inline static const string PROP_TEXCEILING    = "textureceiling";
@@ -49,8 +64,12 @@ public:
 		short       light    = 0,
 		short       special  = 0,
 		short       id       = 0);
-	MapSector(string_view f_tex, string_view c_tex, ParseTreeNode* udmf_def);
-	~MapSector() = default;
+	MapSector(string_view f_tex, string_view c_tex, const UDMFProps& udmf_props);
+	~MapSector();
+
+	// Allocated from a MapObjectPool
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
 
 	void copy(MapObject* obj) override;
 
@@ -97,6 +116,7 @@ public:
 	void              changeLight(int amount, int where = 0);
 	ColRGBA           colourAt(int where = 0, bool fullbright = false);
 	ColRGBA           fogColour();
+	const Lighting&   lighting();
 	long              geometryUpdatedTime() const { return geometry_updated_; }
 	void              findTextPoint();
 
@@ -135,7 +155,28 @@ private:
 	long             geometry_updated_ = 0;
 	Vec2d            text_point_;
 
-	void setGeometryUpdated();
+	// Cached sector edges (connected lines), for point-in-sector checks. Sectors
+	// with many edges also get a grid of them
+	struct Edge
+	{
+		double x1, y1, x2, y2;
+		double ca, sa, length; // As in MapLine::distanceTo
+		bool   front, back;    // True if the sector is on the line's front/back side
+	};
+	vector<Edge>           edges_;
+	unique_ptr<ObjectGrid> edge_grid_;
+	unsigned long          edges_updated_ = 0; // MapObject::modificationCount when edges last updated
+	bool                   edges_valid_   = false;
+
+	// Cached light levels and colours
+	Lighting lighting_;
+
+	void    setGeometryUpdated();
+	void    updateEdges();
+	double  edgeDistance(const Edge& edge, Vec2d point) const;
+	uint8_t resolveLight(int where);
+	ColRGBA resolveColour(int where, bool fullbright);
+	ColRGBA resolveFogColour();
 };
 
 // Note: these MUST be inline, or the linker will complain
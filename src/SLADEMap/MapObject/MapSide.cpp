@@ -31,9 +31,9 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSide.h"
+#include "MapObjectPool.h"
 #include "Game/Configuration.h"
 #include "SLADEMap/SLADEMap.h"
-#include "Utility/Parser.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -69,38 +69,51 @@ MapSide::MapSide(
 // -----------------------------------------------------------------------------
 // MapSide class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapSide::MapSide(MapSector* sector, ParseTreeNode* udmf_def) : MapObject{ Type::Side }, sector_{ sector }
+MapSide::MapSide(MapSector* sector, const UDMFProps& udmf_props) : MapObject{ Type::Side }, sector_{ sector }
 {
 	if (sector)
 		sector->connectSide(this);
 
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& prop : udmf_props)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->nameIsCI(PROP_SECTOR))
+		if (strutil::equalCI(prop.name, PROP_SECTOR))
 			continue;
 
-		if (prop->nameIsCI(PROP_TEXUPPER))
-			tex_upper_ = prop->stringValue();
-		else if (prop->nameIsCI(PROP_TEXMIDDLE))
-			tex_middle_ = prop->stringValue();
-		else if (prop->nameIsCI(PROP_TEXLOWER))
-			tex_lower_ = prop->stringValue();
-		else if (prop->nameIsCI(PROP_OFFSETX))
-			tex_offset_.x = prop->intValue();
-		else if (prop->nameIsCI(PROP_OFFSETY))
-			tex_offset_.y = prop->intValue();
+		if (strutil::equalCI(prop.name, PROP_TEXUPPER))
+			tex_upper_ = property::asString(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_TEXMIDDLE))
+			tex_middle_ = property::asString(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_TEXLOWER))
+			tex_lower_ = property::asString(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_OFFSETX))
+			tex_offset_.x = property::asInt(prop.value);
+		else if (strutil::equalCI(prop.name, PROP_OFFSETY))
+			tex_offset_.y = property::asInt(prop.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[prop.name] = prop.value;
 		// log::info(1, "Property %s type %s (%s)", prop->getName(), prop->getValue().typeString(),
 		// prop->getValue().getStringValue());
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapSide from the side pool
+// -----------------------------------------------------------------------------
+void* MapSide::operator new(size_t size)
+{
+	return MapObjectPool<MapSide>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the memory used by a MapSide to the side pool
+// -----------------------------------------------------------------------------
+void MapSide::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapSide>::deallocate(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // Copies another MapSide object [c]
 // -----------------------------------------------------------------------------
@@ -243,6 +256,10 @@ void MapSide::setSector(MapSector* sector)
 	// Add side to new sector
 	sector_ = sector;
 	sector->connectSide(this);
+
+	// Changes what sector areas are covered
+	if (parent_map_)
+		parent_map_->setGeometryUpdated();
 }
 
 // -----------------------------------------------------------------------------
@@ -376,28 +393,28 @@ void MapSide::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the side as a UDMF text definition to [def]
+// Appends the side as a UDMF text definition to [def]
 // -----------------------------------------------------------------------------
 void MapSide::writeUDMF(string& def)
 {
-	def = fmt::format("sidedef//#{}\n{{\n", index_);
+	fmt::format_to(std::back_inserter(def), "sidedef//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("sector={};\n", sector_->index());
+	fmt::format_to(std::back_inserter(def), "sector={};\n", sector_->index());
 	if (tex_upper_ != "-")
-		def += fmt::format("texturetop=\"{}\";\n", tex_upper_);
+		fmt::format_to(std::back_inserter(def), "texturetop=\"{}\";\n", tex_upper_);
 	if (tex_middle_ != "-")
-		def += fmt::format("texturemiddle=\"{}\";\n", tex_middle_);
+		fmt::format_to(std::back_inserter(def), "texturemiddle=\"{}\";\n", tex_middle_);
 	if (tex_lower_ != "-")
-		def += fmt::format("texturebottom=\"{}\";\n", tex_lower_);
+		fmt::format_to(std::back_inserter(def), "texturebottom=\"{}\";\n", tex_lower_);
 	if (tex_offset_.x != 0)
-		def += fmt::format("offsetx={};\n", tex_offset_.x);
+		fmt::format_to(std::back_inserter(def), "offsetx={};\n", tex_offset_.x);
 	if (tex_offset_.y != 0)
-		def += fmt::format("offsety={};\n", tex_offset_.y);
+		fmt::format_to(std::back_inserter(def), "offsety={};\n", tex_offset_.y);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
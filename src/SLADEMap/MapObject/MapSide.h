@@ -27,9 +27,13 @@ public:
 		string_view tex_middle = TEX_NONE,
 		string_view tex_lower  = TEX_NONE,
 		Vec2i       tex_offset = { 0, 0 });
-	MapSide(MapSector* sector, ParseTreeNode* udmf_def);
+	MapSide(MapSector* sector, const UDMFProps& udmf_props);
 	~MapSide() = default;
 
+	// Allocated from a MapObjectPool
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
+
 	void copy(MapObject* c) override;
 
 	bool isOk() const { return !!sector_; }
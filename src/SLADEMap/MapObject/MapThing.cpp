@@ -31,7 +31,9 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapThing.h"
-#include "Utility/Parser.h"
+#include "Game/Configuration.h"
+#include "MapObjectPool.h"
+#include "SLADEMap/SLADEMap.h"
 
 using namespace slade;
 
@@ -62,48 +64,61 @@ MapThing::MapThing(const Vec3d& pos, short type, short angle, short flags, const
 // -----------------------------------------------------------------------------
 // MapThing class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapThing::MapThing(const Vec3d& pos, short type, ParseTreeNode* def) :
+MapThing::MapThing(const Vec3d& pos, short type, const UDMFProps& udmf_props) :
 	MapObject(Type::Thing),
 	type_{ type },
 	position_{ pos.x, pos.y },
 	z_{ pos.z }
 {
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < def->nChildren(); a++)
+	for (const auto& prop : udmf_props)
 	{
-		prop = def->childPTN(a);
-
 		// Skip required properties
-		if (prop->name() == PROP_X || prop->name() == PROP_Y || prop->name() == PROP_TYPE)
+		if (prop.name == PROP_X || prop.name == PROP_Y || prop.name == PROP_TYPE)
 			continue;
 
 		// Builtin properties
-		if (prop->name() == PROP_Z)
-			z_ = prop->floatValue();
-		else if (prop->name() == PROP_ANGLE)
-			angle_ = prop->intValue();
-		else if (prop->name() == PROP_FLAGS)
-			flags_ = prop->intValue();
-		else if (prop->name() == PROP_ARG0)
-			args_[0] = prop->intValue();
-		else if (prop->name() == PROP_ARG1)
-			args_[1] = prop->intValue();
-		else if (prop->name() == PROP_ARG2)
-			args_[2] = prop->intValue();
-		else if (prop->name() == PROP_ARG3)
-			args_[3] = prop->intValue();
-		else if (prop->name() == PROP_ARG4)
-			args_[4] = prop->intValue();
-		else if (prop->name() == PROP_ID)
-			id_ = prop->intValue();
-		else if (prop->name() == PROP_SPECIAL)
-			special_ = prop->intValue();
+		if (prop.name == PROP_Z)
+			z_ = property::asFloat(prop.value);
+		else if (prop.name == PROP_ANGLE)
+			angle_ = property::asInt(prop.value);
+		else if (prop.name == PROP_FLAGS)
+			flags_ = property::asInt(prop.value);
+		else if (prop.name == PROP_ARG0)
+			args_[0] = property::asInt(prop.value);
+		else if (prop.name == PROP_ARG1)
+			args_[1] = property::asInt(prop.value);
+		else if (prop.name == PROP_ARG2)
+			args_[2] = property::asInt(prop.value);
+		else if (prop.name == PROP_ARG3)
+			args_[3] = property::asInt(prop.value);
+		else if (prop.name == PROP_ARG4)
+			args_[4] = property::asInt(prop.value);
+		else if (prop.name == PROP_ID)
+			id_ = property::asInt(prop.value);
+		else if (prop.name == PROP_SPECIAL)
+			special_ = property::asInt(prop.value);
 		else
-			properties_[prop->name()] = prop->value();
+			properties_[prop.name] = prop.value;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapThing from the thing pool
+// -----------------------------------------------------------------------------
+void* MapThing::operator new(size_t size)
+{
+	return MapObjectPool<MapThing>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the memory used by a MapThing to the thing pool
+// -----------------------------------------------------------------------------
+void MapThing::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapThing>::deallocate(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the object point [point].
 // Currently for things this is always the thing position
@@ -172,7 +187,15 @@ void MapThing::setIntProperty(string_view key, int value)
 	setModified();
 
 	if (key == PROP_TYPE)
+	{
+		// Update thing type counts
+		if (parent_map_)
+		{
+			parent_map_->things().updateTypeUsage(type_, -1);
+			parent_map_->things().updateTypeUsage(value, 1);
+		}
 		type_ = value;
+	}
 	else if (key == PROP_X)
 		position_.x = value;
 	else if (key == PROP_Y)
@@ -228,8 +251,15 @@ void MapThing::copy(MapObject* c)
 	if (c->objType() != Type::Thing)
 		return;
 
+	// Update thing type counts
+	auto thing = dynamic_cast<MapThing*>(c);
+	if (parent_map_)
+	{
+		parent_map_->things().updateTypeUsage(type_, -1);
+		parent_map_->things().updateTypeUsage(thing->type_, 1);
+	}
+
 	// Basic variables
-	auto thing  = dynamic_cast<MapThing*>(c);
 	position_.x = thing->position_.x;
 	position_.y = thing->position_.y;
 	type_       = thing->type_;
@@ -244,6 +274,16 @@ void MapThing::copy(MapObject* c)
 	MapObject::copy(c);
 }
 
+// -----------------------------------------------------------------------------
+// Returns the game configuration's type info for the thing. This doesn't
+// modify the thing or the configuration, so is safe to call from any thread
+// while the configuration isn't being changed
+// -----------------------------------------------------------------------------
+const game::ThingType& MapThing::typeInfo() const
+{
+	return game::configuration().thingType(type_);
+}
+
 // -----------------------------------------------------------------------------
 // Sets the position of the thing to [pos].
 // If [modify] is false, the thing won't be marked as modified
@@ -270,6 +310,14 @@ void MapThing::setZ(double z)
 void MapThing::setType(int type)
 {
 	setModified();
+
+	// Update thing type counts
+	if (parent_map_)
+	{
+		parent_map_->things().updateTypeUsage(type_, -1);
+		parent_map_->things().updateTypeUsage(type, 1);
+	}
+
 	type_ = type;
 }
 
@@ -403,7 +451,15 @@ void MapThing::writeBackup(Backup* backup)
 // -----------------------------------------------------------------------------
 void MapThing::readBackup(Backup* backup)
 {
-	type_       = backup->props_internal.get<int>(PROP_TYPE);
+	// Update thing type counts
+	auto type = backup->props_internal.get<int>(PROP_TYPE);
+	if (parent_map_)
+	{
+		parent_map_->things().updateTypeUsage(type_, -1);
+		parent_map_->things().updateTypeUsage(type, 1);
+	}
+
+	type_       = type;
 	position_.x = backup->props_internal.get<double>(PROP_X);
 	position_.y = backup->props_internal.get<double>(PROP_Y);
 	z_          = backup->props_internal.get<double>(PROP_Z);
@@ -419,31 +475,31 @@ void MapThing::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the thing as a UDMF text definition to [def]
+// Appends the thing as a UDMF text definition to [def]
 // -----------------------------------------------------------------------------
 void MapThing::writeUDMF(string& def)
 {
-	def = fmt::format("thing//#{}\n{{\n", index_);
+	fmt::format_to(std::back_inserter(def), "thing//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("x={:1.3f};\ny={:1.3f};\ntype={};\n", position_.x, position_.y, type_);
+	fmt::format_to(std::back_inserter(def), "x={:1.3f};\ny={:1.3f};\ntype={};\n", position_.x, position_.y, type_);
 	if (z_ != 0)
-		def += fmt::format("height={:1.3f};\n", z_);
+		fmt::format_to(std::back_inserter(def), "height={:1.3f};\n", z_);
 	if (angle_ != 0)
-		def += fmt::format("angle={};\n", angle_);
+		fmt::format_to(std::back_inserter(def), "angle={};\n", angle_);
 	if (flags_ != 0)
-		def += fmt::format("flags={};\n", flags_);
+		fmt::format_to(std::back_inserter(def), "flags={};\n", flags_);
 	if (id_ != 0)
-		def += fmt::format("id={};\n", id_);
+		fmt::format_to(std::back_inserter(def), "id={};\n", id_);
 	for (unsigned i = 0; i < 5; ++i)
 		if (args_[i] != 0)
-			def += fmt::format("arg{}={};\n", i, args_[i]);
+			fmt::format_to(std::back_inserter(def), "arg{}={};\n", i, args_[i]);
 	if (special_ != 0)
-		def += fmt::format("special={};\n", special_);
+		fmt::format_to(std::back_inserter(def), "special={};\n", special_);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
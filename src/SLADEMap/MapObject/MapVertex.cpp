@@ -31,8 +31,8 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapVertex.h"
+#include "MapObjectPool.h"
 #include "SLADEMap/SLADEMap.h"
-#include "Utility/Parser.h"
 
 using namespace slade;
 
@@ -52,22 +52,35 @@ MapVertex::MapVertex(const Vec2d& pos) : MapObject(Type::Vertex), position_{ pos
 // -----------------------------------------------------------------------------
 // MapVertex class constructor from UDMF definition
 // -----------------------------------------------------------------------------
-MapVertex::MapVertex(const Vec2d& pos, ParseTreeNode* udmf_def) : MapObject(Type::Vertex), position_{ pos }
+MapVertex::MapVertex(const Vec2d& pos, const UDMFProps& udmf_props) : MapObject(Type::Vertex), position_{ pos }
 {
 	// Set properties from UDMF definition
-	ParseTreeNode* prop;
-	for (unsigned a = 0; a < udmf_def->nChildren(); a++)
+	for (const auto& prop : udmf_props)
 	{
-		prop = udmf_def->childPTN(a);
-
 		// Skip required properties
-		if (prop->name() == PROP_X || prop->name() == PROP_Y)
+		if (prop.name == PROP_X || prop.name == PROP_Y)
 			continue;
 
-		properties_[prop->name()] = prop->value();
+		properties_[prop.name] = prop.value;
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Allocates memory for a new MapVertex from the vertex pool
+// -----------------------------------------------------------------------------
+void* MapVertex::operator new(size_t size)
+{
+	return MapObjectPool<MapVertex>::allocate(size);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the memory used by a MapVertex to the vertex pool
+// -----------------------------------------------------------------------------
+void MapVertex::operator delete(void* ptr, size_t size)
+{
+	MapObjectPool<MapVertex>::deallocate(ptr, size);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the object point [point].
 // Currently for vertices this is always the vertex position
@@ -226,18 +239,18 @@ void MapVertex::readBackup(Backup* backup)
 }
 
 // -----------------------------------------------------------------------------
-// Writes the vertex as a UDMF text definition to [def]
+// Appends the vertex as a UDMF text definition to [def]
 // -----------------------------------------------------------------------------
 void MapVertex::writeUDMF(string& def)
 {
-	def = fmt::format("vertex//#{}\n{{\n", index_);
+	fmt::format_to(std::back_inserter(def), "vertex//#{}\n{{\n", index_);
 
 	// Basic properties
-	def += fmt::format("x={:1.3f};\ny={:1.3f};\n", position_.x, position_.y);
+	fmt::format_to(std::back_inserter(def), "x={:1.3f};\ny={:1.3f};\n", position_.x, position_.y);
 
 	// Other properties
 	if (!properties_.empty())
-		def += properties_.toString(true, 3);
+		properties_.write(def, true, 3);
 
 	def += "}\n\n";
 }
@@ -16,9 +16,13 @@ public:
 	inline static const string PROP_Y = "y";
 
 	MapVertex(const Vec2d& pos);
-	MapVertex(const Vec2d& pos, ParseTreeNode* udmf_def);
+	MapVertex(const Vec2d& pos, const UDMFProps& udmf_props);
 	~MapVertex() = default;
 
+	// Allocated from a MapObjectPool
+	static void* operator new(size_t size);
+	static void  operator delete(void* ptr, size_t size);
+
 	double xPos() const { return position_.x; }
 	double yPos() const { return position_.y; }
 	Vec2d  position() const { return position_; }
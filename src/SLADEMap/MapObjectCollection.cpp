@@ -32,14 +32,44 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapObjectCollection.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "MapObject/MapLine.h"
+#include "MapObject/MapObjectPool.h"
 #include "MapObject/MapSector.h"
+#include "MapObject/MapSide.h"
+#include "MapObject/MapThing.h"
+#include "MapObject/MapVertex.h"
+#include "MapSnapshot.h"
 #include "SLADEMap.h"
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [object] is currently in [list] (at its index)
+// -----------------------------------------------------------------------------
+template<class T> bool inList(const MapObjectList<T>& list, const T* object)
+{
+	return object && object->index() < list.size() && list[object->index()] == object;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapObjectCollection Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
 // -----------------------------------------------------------------------------
 // MapObjectCollection class constructor
 // -----------------------------------------------------------------------------
@@ -223,6 +253,16 @@ void MapObjectCollection::clear()
 
 	// Clear map objects
 	objects_.clear();
+	object_snapshots_.clear();
+	last_snapshot_.reset();
+
+	// Free all pooled map object memory at once (unless some objects are still
+	// in use elsewhere, eg. copied to the clipboard)
+	MapObjectPool<MapVertex>::releaseUnused();
+	MapObjectPool<MapSide>::releaseUnused();
+	MapObjectPool<MapLine>::releaseUnused();
+	MapObjectPool<MapSector>::releaseUnused();
+	MapObjectPool<MapThing>::releaseUnused();
 
 	// Object id 0 is always null
 	objects_.emplace_back(nullptr, false);
@@ -416,6 +456,9 @@ bool MapObjectCollection::removeSide(unsigned index, bool remove_from_line)
 	removeMapObject(sides_[index]);
 	sides_.remove(index);
 
+	if (parent_map_)
+		parent_map_->setGeometryUpdated();
+
 	return true;
 }
 
@@ -444,6 +487,9 @@ bool MapObjectCollection::removeSector(unsigned index)
 	removeMapObject(sectors_[index]);
 	sectors_.remove(index);
 
+	if (parent_map_)
+		parent_map_->setGeometryUpdated();
+
 	return true;
 }
 
@@ -478,6 +524,240 @@ bool MapObjectCollection::removeThing(unsigned index)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Removes all [vertices] from the map at once, along with their connected
+// lines. Returns the number of vertices removed
+// -----------------------------------------------------------------------------
+int MapObjectCollection::removeVertices(const vector<MapVertex*>& vertices)
+{
+	auto marks = newRemovalMarks();
+	for (auto vertex : vertices)
+		if (inList(vertices_, vertex))
+			marks.vertices[vertex->index_] = 1;
+
+	auto count = vertices_.size();
+	removeMarked(marks, false);
+
+	return count - vertices_.size();
+}
+
+// -----------------------------------------------------------------------------
+// Removes all [lines] from the map at once, along with their sides.
+// Returns the number of lines removed
+// -----------------------------------------------------------------------------
+int MapObjectCollection::removeLines(const vector<MapLine*>& lines)
+{
+	auto marks = newRemovalMarks();
+	for (auto line : lines)
+		if (inList(lines_, line))
+			marks.lines[line->index_] = 1;
+
+	auto count = lines_.size();
+	removeMarked(marks, false);
+
+	return count - lines_.size();
+}
+
+// -----------------------------------------------------------------------------
+// Removes all [sides] from the map at once, clearing them from their parent
+// lines if [remove_from_line] is true. Returns the number of sides removed
+// -----------------------------------------------------------------------------
+int MapObjectCollection::removeSides(const vector<MapSide*>& sides, bool remove_from_line)
+{
+	auto marks = newRemovalMarks();
+	for (auto side : sides)
+		if (inList(sides_, side))
+			marks.sides[side->index_] = 1;
+
+	auto count = sides_.size();
+	removeMarked(marks, remove_from_line);
+
+	return count - sides_.size();
+}
+
+// -----------------------------------------------------------------------------
+// Removes all [sectors] from the map at once.
+// Returns the number of sectors removed
+// -----------------------------------------------------------------------------
+int MapObjectCollection::removeSectors(const vector<MapSector*>& sectors)
+{
+	auto marks = newRemovalMarks();
+	for (auto sector : sectors)
+		if (inList(sectors_, sector))
+			marks.sectors[sector->index_] = 1;
+
+	auto count = sectors_.size();
+	removeMarked(marks, false);
+
+	return count - sectors_.size();
+}
+
+// -----------------------------------------------------------------------------
+// Removes all [things] from the map at once.
+// Returns the number of things removed
+// -----------------------------------------------------------------------------
+int MapObjectCollection::removeThings(const vector<MapThing*>& things)
+{
+	vector<uint8_t> marked(things_.size());
+	int             count = 0;
+	for (auto thing : things)
+	{
+		if (inList(things_, thing) && !marked[thing->index_])
+		{
+			marked[thing->index_] = 1;
+			removeMapObject(thing);
+			++count;
+		}
+	}
+
+	if (count > 0)
+	{
+		things_.removeMarked(marked);
+		if (parent_map_)
+			parent_map_->setThingsUpdated();
+	}
+
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a set of removal marks with nothing marked, for the current objects
+// -----------------------------------------------------------------------------
+MapObjectCollection::RemovalMarks MapObjectCollection::newRemovalMarks() const
+{
+	RemovalMarks marks;
+	marks.vertices.resize(vertices_.size());
+	marks.lines.resize(lines_.size());
+	marks.sides.resize(sides_.size());
+	marks.sectors.resize(sectors_.size());
+	return marks;
+}
+
+// -----------------------------------------------------------------------------
+// Removes all objects marked in [marks] from the map at once, along with the
+// objects that depend on them in the same way as the single object remove
+// functions (lines connected to removed vertices, sides of removed lines and
+// sectors left with no sides). Connected object lists are fixed up once per
+// affected object, and each object list is compacted in a single pass.
+// If [remove_sides_from_lines] is true, removed sides are also cleared from
+// their parent lines (if they aren't being removed)
+// -----------------------------------------------------------------------------
+void MapObjectCollection::removeMarked(RemovalMarks& marks, bool remove_sides_from_lines)
+{
+	// Mark lines connected to removed vertices
+	for (unsigned a = 0; a < vertices_.size(); a++)
+		if (marks.vertices[a])
+			for (auto line : vertices_[a]->connectedLines())
+				marks.lines[line->index_] = 1;
+
+	// Mark sides of removed lines, and disconnect the lines from any remaining
+	// vertices
+	vector<uint8_t> vertex_checked(vertices_.size());
+	for (unsigned a = 0; a < lines_.size(); a++)
+	{
+		if (!marks.lines[a])
+			continue;
+
+		auto line = lines_[a];
+		line->resetInternals();
+		if (inList(sides_, line->s1()))
+			marks.sides[line->s1()->index_] = 1;
+		if (inList(sides_, line->s2()))
+			marks.sides[line->s2()->index_] = 1;
+
+		for (auto vertex : { line->v1(), line->v2() })
+		{
+			if (marks.vertices[vertex->index_] || vertex_checked[vertex->index_])
+				continue;
+			vertex_checked[vertex->index_] = 1;
+
+			auto connected = vertex->connectedLines();
+			vertex->clearConnectedLines();
+			for (auto cline : connected)
+				if (!marks.lines[cline->index_])
+					vertex->connectLine(cline);
+		}
+	}
+
+	// Clear removed sides from remaining lines, and find their sectors
+	vector<MapSector*> sectors;
+	vector<uint8_t>    sector_checked(sectors_.size());
+	for (unsigned a = 0; a < sides_.size(); a++)
+	{
+		if (!marks.sides[a])
+			continue;
+
+		auto side = sides_[a];
+		auto line = side->parentLine();
+		if (remove_sides_from_lines && inList(lines_, line) && !marks.lines[line->index_])
+		{
+			line->setModified();
+			if (line->s1() == side)
+				line->setS1(nullptr);
+			if (line->s2() == side)
+				line->setS2(nullptr);
+
+			// Set appropriate line flags
+			if (parent_map_)
+			{
+				game::configuration().setLineBasicFlag("blocking", line, parent_map_->currentFormat(), true);
+				game::configuration().setLineBasicFlag("twosided", line, parent_map_->currentFormat(), false);
+			}
+		}
+
+		auto sector = side->sector();
+		if (inList(sectors_, sector) && !sector_checked[sector->index_])
+		{
+			sector_checked[sector->index_] = 1;
+			sectors.push_back(sector);
+		}
+	}
+
+	// Remove the sides from their sectors, and mark any sectors left with no
+	// sides for removal
+	for (auto sector : sectors)
+	{
+		auto& connected = sector->connectedSides();
+		if (connected.empty())
+			continue;
+
+		connected.erase(
+			std::remove_if(
+				connected.begin(),
+				connected.end(),
+				[&](MapSide* side) { return inList(sides_, side) && marks.sides[side->index_]; }),
+			connected.end());
+		if (connected.empty())
+			marks.sectors[sector->index_] = 1;
+	}
+
+	// Remove all marked objects
+	auto remove_marked = [this](auto& list, const vector<uint8_t>& marked)
+	{
+		unsigned count = 0;
+		for (unsigned a = 0; a < list.size(); a++)
+		{
+			if (marked[a])
+			{
+				removeMapObject(list[a]);
+				++count;
+			}
+		}
+
+		if (count > 0)
+			list.removeMarked(marked);
+
+		return count;
+	};
+	auto removed = remove_marked(sides_, marks.sides);
+	removed += remove_marked(lines_, marks.lines);
+	removed += remove_marked(vertices_, marks.vertices);
+	removed += remove_marked(sectors_, marks.sectors);
+
+	if (removed > 0 && parent_map_)
+		parent_map_->setGeometryUpdated();
+}
+
 // -----------------------------------------------------------------------------
 // Adds [vertex] to the map
 // -----------------------------------------------------------------------------
@@ -619,24 +899,96 @@ bool MapObjectCollection::modifiedSince(long since, MapObject::Type type) const
 }
 
 // -----------------------------------------------------------------------------
-// Removes any vertices not attached to any lines. Returns the number of
-// vertices removed
+// Returns a read-only snapshot of the current state of all objects in the map,
+// which can be used from other threads while the map continues to be edited.
+// Must be called from the thread that edits the map. Objects that haven't
+// been modified since they were last snapshotted share their data with the
+// previous snapshot, and if nothing at all has changed the previous snapshot
+// is returned as-is
 // -----------------------------------------------------------------------------
-int MapObjectCollection::removeDetachedVertices()
+shared_ptr<const MapSnapshot> MapObjectCollection::snapshot() const
 {
-	int count = 0;
-	for (int a = vertices_.size() - 1; a >= 0; a--)
+	auto modifications = MapObject::modificationCount();
+	if (last_snapshot_ && last_snapshot_->modificationCount() == modifications)
+		return last_snapshot_;
+
+	auto time = app::runTimer();
+	auto snap = std::make_shared<MapSnapshot>(modifications);
+	object_snapshots_.resize(objects_.size());
+
+	auto add_objects = [&](const auto& list, vector<MapSnapshot::Object>& objects) {
+		objects.reserve(list.size());
+		for (auto object : list)
+		{
+			// Objects modified in the same timer tick as their last snapshot
+			// may have changed after it was taken, so include them too
+			auto& obj_snap = object_snapshots_[object->objId()];
+			if (!obj_snap.backup || object->modifiedTime() >= obj_snap.time)
+			{
+				auto backup = std::make_shared<MapObject::Backup>();
+				object->backupTo(backup.get());
+				obj_snap.backup = std::move(backup);
+				obj_snap.time   = time;
+			}
+
+			objects.push_back(obj_snap.backup);
+		}
+	};
+	add_objects(vertices_, snap->vertices_);
+	add_objects(lines_, snap->lines_);
+	add_objects(sides_, snap->sides_);
+	add_objects(sectors_, snap->sectors_);
+	add_objects(things_, snap->things_);
+
+	last_snapshot_ = snap;
+	return snap;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the estimated memory used by all objects held by the collection
+// (including removed objects kept for undo) and their properties
+// -----------------------------------------------------------------------------
+MapObjectCollection::MemoryUsage MapObjectCollection::memoryUsage() const
+{
+	MemoryUsage usage;
+	usage.objects = objects_.capacity() * sizeof(MapObjectHolder);
+	for (const auto& holder : objects_)
 	{
-		if (vertices_[a]->nConnectedLines() == 0)
+		if (!holder.object)
+			continue;
+
+		switch (holder.object->objType())
 		{
-			removeVertex(a);
-			count++;
+		case MapObject::Type::Vertex: usage.objects += sizeof(MapVertex); break;
+		case MapObject::Type::Line: usage.objects += sizeof(MapLine); break;
+		case MapObject::Type::Side: usage.objects += sizeof(MapSide); break;
+		case MapObject::Type::Sector: usage.objects += sizeof(MapSector); break;
+		case MapObject::Type::Thing: usage.objects += sizeof(MapThing); break;
+		default: usage.objects += sizeof(MapObject); break;
 		}
+
+		usage.properties += holder.object->props().memoryUsage();
+		++usage.count;
 	}
 
-	refreshIndices();
+	return usage;
+}
 
-	return count;
+// -----------------------------------------------------------------------------
+// Removes any vertices not attached to any lines. Returns the number of
+// vertices removed
+// -----------------------------------------------------------------------------
+int MapObjectCollection::removeDetachedVertices()
+{
+	auto marks = newRemovalMarks();
+	for (unsigned a = 0; a < vertices_.size(); a++)
+		if (vertices_[a]->nConnectedLines() == 0)
+			marks.vertices[a] = 1;
+
+	auto count = vertices_.size();
+	removeMarked(marks, false);
+
+	return count - vertices_.size();
 }
 
 // -----------------------------------------------------------------------------
@@ -645,19 +997,15 @@ int MapObjectCollection::removeDetachedVertices()
 // -----------------------------------------------------------------------------
 int MapObjectCollection::removeDetachedSides()
 {
-	int count = 0;
-	for (int a = sides_.size() - 1; a >= 0; a--)
-	{
+	auto marks = newRemovalMarks();
+	for (unsigned a = 0; a < sides_.size(); a++)
 		if (!sides_[a]->parentLine())
-		{
-			removeSide(a, false);
-			count++;
-		}
-	}
+			marks.sides[a] = 1;
 
-	refreshIndices();
+	auto count = sides_.size();
+	removeMarked(marks, false);
 
-	return count;
+	return count - sides_.size();
 }
 
 // -----------------------------------------------------------------------------
@@ -666,19 +1014,15 @@ int MapObjectCollection::removeDetachedSides()
 // -----------------------------------------------------------------------------
 int MapObjectCollection::removeDetachedSectors()
 {
-	int count = 0;
-	for (int a = sectors_.size() - 1; a >= 0; a--)
-	{
+	auto marks = newRemovalMarks();
+	for (unsigned a = 0; a < sectors_.size(); a++)
 		if (sectors_[a]->connectedSides().empty())
-		{
-			removeSector(a);
-			count++;
-		}
-	}
+			marks.sectors[a] = 1;
 
-	refreshIndices();
+	auto count = sectors_.size();
+	removeMarked(marks, false);
 
-	return count;
+	return count - sectors_.size();
 }
 
 // -----------------------------------------------------------------------------
@@ -687,18 +1031,15 @@ int MapObjectCollection::removeDetachedSectors()
 // -----------------------------------------------------------------------------
 int MapObjectCollection::removeZeroLengthLines()
 {
-	int count = 0;
+	auto marks = newRemovalMarks();
 	for (unsigned a = 0; a < lines_.size(); a++)
-	{
 		if (lines_[a]->v1() == lines_[a]->v2())
-		{
-			removeLine(a);
-			a--;
-			count++;
-		}
-	}
+			marks.lines[a] = 1;
 
-	return count;
+	auto count = lines_.size();
+	removeMarked(marks, false);
+
+	return count - lines_.size();
 }
 
 // -----------------------------------------------------------------------------
@@ -706,18 +1047,15 @@ int MapObjectCollection::removeZeroLengthLines()
 // -----------------------------------------------------------------------------
 int MapObjectCollection::removeInvalidSides()
 {
-	int count = 0;
+	auto marks = newRemovalMarks();
 	for (unsigned a = 0; a < sides_.size(); a++)
-	{
 		if (!sides_[a]->sector())
-		{
-			removeSide(a);
-			a--;
-			count++;
-		}
-	}
+			marks.sides[a] = 1;
 
-	return count;
+	auto count = sides_.size();
+	removeMarked(marks, true);
+
+	return count - sides_.size();
 }
 
 // -----------------------------------------------------------------------------
@@ -753,3 +1091,16 @@ void MapObjectCollection::rebuildConnectedSides()
 			side->sector()->connectSide(side);
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Rebuilds the cached geometry (position arrays and search grids) of all
+// vertex, line, sector and thing lists if anything has changed, so that
+// queries (possibly from multiple threads) don't have to
+// -----------------------------------------------------------------------------
+void MapObjectCollection::updateGeometry() const
+{
+	vertices_.updateGeometry();
+	lines_.updateGeometry();
+	sectors_.updateGeometry();
+	things_.updateGeometry();
+}
@@ -9,6 +9,8 @@
 
 namespace slade
 {
+class MapSnapshot;
+
 class MapObjectCollection
 {
 public:
@@ -60,12 +62,31 @@ public:
 	bool removeThing(MapThing* thing);
 	bool removeThing(unsigned index);
 
+	// Bulk object remove
+	int removeVertices(const vector<MapVertex*>& vertices);
+	int removeLines(const vector<MapLine*>& lines);
+	int removeSides(const vector<MapSide*>& sides, bool remove_from_line = true);
+	int removeSectors(const vector<MapSector*>& sectors);
+	int removeThings(const vector<MapThing*>& things);
+
 	// Modified times
 	vector<MapObject*> modifiedObjects(long since, MapObject::Type type) const;
 	vector<MapObject*> allModifiedObjects(long since) const;
 	long               lastModifiedTime() const;
 	bool               modifiedSince(long since, MapObject::Type type) const;
 
+	// Snapshot
+	shared_ptr<const MapSnapshot> snapshot() const;
+
+	// Memory usage (estimated, in bytes)
+	struct MemoryUsage
+	{
+		size_t   objects    = 0;
+		size_t   properties = 0;
+		unsigned count      = 0; // Number of objects
+	};
+	MemoryUsage memoryUsage() const;
+
 	// Checks
 	int removeDetachedVertices();
 	int removeDetachedSides();
@@ -76,6 +97,7 @@ public:
 	// Cleanup/Extra
 	void rebuildConnectedLines();
 	void rebuildConnectedSides();
+	void updateGeometry() const;
 
 private:
 	struct MapObjectHolder
@@ -86,6 +108,22 @@ private:
 		MapObjectHolder(unique_ptr<MapObject> object, bool in_map) : object{ std::move(object) }, in_map{ in_map } {}
 	};
 
+	// Objects (by index) marked for removal in one go
+	struct RemovalMarks
+	{
+		vector<uint8_t> vertices;
+		vector<uint8_t> lines;
+		vector<uint8_t> sides;
+		vector<uint8_t> sectors;
+	};
+
+	// A snapshot of an object, and the (run timer) time it was taken
+	struct ObjectSnapshot
+	{
+		shared_ptr<const MapObject::Backup> backup;
+		long                                time = 0;
+	};
+
 	SLADEMap*               parent_map_ = nullptr;
 	vector<MapObjectHolder> objects_;
 	VertexList              vertices_;
@@ -93,5 +131,12 @@ private:
 	LineList                lines_;
 	SectorList              sectors_;
 	ThingList               things_;
+
+	// Snapshots are kept to share unchanged objects with the next snapshot
+	mutable vector<ObjectSnapshot>        object_snapshots_; // By object id
+	mutable shared_ptr<const MapSnapshot> last_snapshot_;
+
+	RemovalMarks newRemovalMarks() const;
+	void         removeMarked(RemovalMarks& marks, bool remove_sides_from_lines);
 };
 } // namespace slade
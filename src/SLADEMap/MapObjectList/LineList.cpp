@@ -53,30 +53,46 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 MapLine* LineList::nearest(Vec2d point, double min) const
 {
-	// Go through lines
-	double   dist;
-	double   min_dist = min;
-	MapLine* nearest  = nullptr;
-	for (const auto& line : objects_)
+	updateGeometry();
+
+	// Search outwards from the point until a line is found within the search
+	// radius (any nearer line would have to be within it too), or up to [min]
+	unsigned nearest = count_;
+	auto     radius  = grid_.cellSize();
+	while (true)
 	{
-		// Check with line bounding box first (since we have a minimum distance)
-		auto bbox = line->seg();
-		bbox.expand(min, min);
-		if (!bbox.contains(point))
-			continue;
+		radius  = std::min(radius, min);
+		nearest = count_;
 
-		// Calculate distance to line
-		dist = line->distanceTo(point);
+		double min_dist = min;
+		auto   left     = point.x - radius;
+		auto   top      = point.y - radius;
+		auto   right    = point.x + radius;
+		auto   bottom   = point.y + radius;
+		grid_.forEachIn(left, top, right, bottom, [&](unsigned index) {
+			// Check with line bounding box first (since we have a minimum distance)
+			if (point.x < geometry_.left[index] - min || point.x > geometry_.right[index] + min
+				|| point.y < geometry_.top[index] - min || point.y > geometry_.bottom[index] + min)
+				return;
 
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist && dist < min)
-		{
-			nearest  = line;
-			min_dist = dist;
-		}
+			// Calculate distance to line
+			auto dist = objects_[index]->distanceTo(point);
+
+			// Check if it's nearer than the previous nearest
+			if ((dist < min_dist || dist == min_dist && index < nearest) && dist < min)
+			{
+				nearest  = index;
+				min_dist = dist;
+			}
+		});
+
+		if (nearest < count_ && min_dist <= radius || radius >= min || grid_.covers(left, top, right, bottom))
+			break;
+
+		radius *= 2;
 	}
 
-	return nearest;
+	return nearest < count_ ? objects_[nearest] : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -105,21 +121,27 @@ vector<Vec2d> LineList::cutPoints(const Seg2d& cutter) const
 	Vec2d         intersection;
 
 	// Go through map lines
-	for (const auto& line : objects_)
-	{
+	updateGeometry();
+	grid_.forEachIn(cutter.left(), cutter.top(), cutter.right(), cutter.bottom(), [&](unsigned index) {
+		// Skip if the line's bounding box doesn't overlap the cutter's
+		if (geometry_.right[index] < cutter.left() || geometry_.left[index] > cutter.right()
+			|| geometry_.bottom[index] < cutter.top() || geometry_.top[index] > cutter.bottom())
+			return;
+
 		// Check for intersection
 		intersection = cutter.start();
-		if (math::linesIntersect(cutter, line->seg(), intersection))
+		Seg2d seg{ geometry_.x1[index], geometry_.y1[index], geometry_.x2[index], geometry_.y2[index] };
+		if (math::linesIntersect(cutter, seg, intersection))
 		{
 			// Add intersection point to vector
 			intersect_points.push_back(intersection);
-			LOG_DEBUG("Intersection point", intersection, "valid with", line);
+			LOG_DEBUG("Intersection point", intersection, "valid with", objects_[index]);
 		}
 		else if (intersection != cutter.start())
 		{
 			LOG_DEBUG("Intersection point", intersection, "invalid");
 		}
-	}
+	});
 
 	// Return if no intersections
 	if (intersect_points.empty())
@@ -156,16 +178,35 @@ vector<Vec2d> LineList::cutPoints(const Seg2d& cutter) const
 	return intersect_points;
 }
 
+// -----------------------------------------------------------------------------
+// Adds all lines with a bounding box overlapping [bbox] (inclusive) to [list],
+// in index order
+// -----------------------------------------------------------------------------
+void LineList::putAllInBox(const BBox& bbox, vector<MapLine*>& list) const
+{
+	updateGeometry();
+
+	vector<unsigned> indices;
+	grid_.forEachIn(bbox.min.x, bbox.min.y, bbox.max.x, bbox.max.y, [&](unsigned index) {
+		if (geometry_.right[index] >= bbox.min.x && geometry_.left[index] <= bbox.max.x
+			&& geometry_.bottom[index] >= bbox.min.y && geometry_.top[index] <= bbox.max.y)
+			indices.push_back(index);
+	});
+
+	std::sort(indices.begin(), indices.end());
+	for (auto index : indices)
+		list.push_back(objects_[index]);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the first line found with [id], or null if none found
 // -----------------------------------------------------------------------------
 MapLine* LineList::firstWithId(int id) const
 {
-	for (auto& line : objects_)
-		if (line->id() == id)
-			return line;
+	updateIdIndex();
 
-	return nullptr;
+	auto& indices = id_index_.find(id);
+	return indices.empty() ? nullptr : objects_[indices[0]];
 }
 
 // -----------------------------------------------------------------------------
@@ -173,9 +214,10 @@ MapLine* LineList::firstWithId(int id) const
 // -----------------------------------------------------------------------------
 void LineList::putAllWithId(int id, vector<MapLine*>& list) const
 {
-	for (auto& line : objects_)
-		if (line->id() == id)
-			list.push_back(line);
+	updateIdIndex();
+
+	for (auto index : id_index_.find(id))
+		list.push_back(objects_[index]);
 }
 
 // -----------------------------------------------------------------------------
@@ -196,11 +238,14 @@ void LineList::putAllTaggingWithId(int id, int type, vector<MapLine*>& list) con
 {
 	using game::TagType;
 
-	// Find lines with special affecting matching id
+	// Find lines with special affecting matching id (only lines with an arg
+	// matching id can possibly be affecting it)
+	updateIdIndex();
 	int tag, arg2, arg3, arg4, arg5;
-	for (auto& line : objects_)
+	for (auto index : arg_index_.find(id))
 	{
-		int special = line->special();
+		auto line    = objects_[index];
+		int  special = line->special();
 		if (special)
 		{
 			tag       = line->arg(0);
@@ -293,46 +338,95 @@ void LineList::putAllTaggingWithId(int id, int type, vector<MapLine*>& list) con
 // -----------------------------------------------------------------------------
 int LineList::firstFreeId(MapFormat format) const
 {
+	updateIdIndex();
+
+	// Returns true if any line has [id] as its first arg (and [special], if
+	// it's not 0)
+	auto arg0_used = [this](int id, int special) {
+		for (auto index : arg_index_.find(id))
+			if (objects_[index]->arg(0) == id && (special == 0 || objects_[index]->special() == special))
+				return true;
+
+		return false;
+	};
+
 	int id = 1;
 
 	// UDMF (id property)
 	if (format == MapFormat::UDMF)
 	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->id() == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+		while (id_index_.indices.count(id) > 0)
+			id++;
 	}
 
 	// Hexen (special 121 arg0)
 	else if (format == MapFormat::Hexen)
 	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->special() == 121 && objects_[a]->arg(0) == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+		while (arg0_used(id, 121))
+			id++;
 	}
 
 	// Boom (sector tag (arg0))
 	else if (format == MapFormat::Doom && game::configuration().featureSupported(game::Feature::Boom))
 	{
-		for (unsigned a = 0; a < count_; a++)
-		{
-			if (objects_[a]->arg(0) == id)
-			{
-				id++;
-				a = 0;
-			}
-		}
+		while (arg0_used(id, 0))
+			id++;
 	}
 
 	return id;
 }
+
+// -----------------------------------------------------------------------------
+// Updates the line geometry arrays and grid if any lines have been added,
+// removed or modified (or any vertices moved) since they were last updated.
+// This is done explicitly after map edits (see SLADEMap::updateGeometryInfo),
+// queries only need to rebuild if called partway through an edit
+// -----------------------------------------------------------------------------
+void LineList::updateGeometry() const
+{
+	std::lock_guard lock(geometry_mutex_);
+	if (!updateStamp(geometry_stamp_))
+		return;
+
+	geometry_.resize(count_);
+	for (unsigned a = 0; a < count_; ++a)
+	{
+		auto line = objects_[a];
+
+		geometry_.x1[a]     = line->x1();
+		geometry_.y1[a]     = line->y1();
+		geometry_.x2[a]     = line->x2();
+		geometry_.y2[a]     = line->y2();
+		geometry_.left[a]   = std::min(geometry_.x1[a], geometry_.x2[a]);
+		geometry_.top[a]    = std::min(geometry_.y1[a], geometry_.y2[a]);
+		geometry_.right[a]  = std::max(geometry_.x1[a], geometry_.x2[a]);
+		geometry_.bottom[a] = std::max(geometry_.y1[a], geometry_.y2[a]);
+	}
+
+	grid_.build(count_, geometry_.left.data(), geometry_.top.data(), geometry_.right.data(), geometry_.bottom.data());
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the line id and arg indices if anything in the map has been
+// modified since they were last built
+// -----------------------------------------------------------------------------
+void LineList::updateIdIndex() const
+{
+	if (!updateStamp(id_index_.stamp))
+		return;
+
+	id_index_.indices.clear();
+	arg_index_.indices.clear();
+	for (unsigned a = 0; a < count_; ++a)
+	{
+		auto line = objects_[a];
+		id_index_.add(line->id(), a);
+
+		// Arg 0 can be a negated line id (see TagType::LineNegative)
+		for (int arg = 0; arg < 5; ++arg)
+			if (line->arg(arg) != 0)
+				arg_index_.add(line->arg(arg), a);
+		if (line->arg(0) < 0)
+			arg_index_.add(-line->arg(0), a);
+	}
+}
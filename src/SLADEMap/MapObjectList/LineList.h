@@ -2,6 +2,7 @@
 
 #include "General/Defs.h"
 #include "MapObjectList.h"
+#include "ObjectGrid.h"
 #include "SLADEMap/MapObject/MapLine.h"
 
 namespace slade
@@ -12,10 +13,39 @@ public:
 	MapLine*         nearest(Vec2d point, double min = 64) const;
 	MapLine*         withVertices(MapVertex* v1, MapVertex* v2, bool reverse = true) const;
 	vector<Vec2d>    cutPoints(const Seg2d& cutter) const;
+	void             putAllInBox(const BBox& bbox, vector<MapLine*>& list) const;
 	MapLine*         firstWithId(int id) const;
 	void             putAllWithId(int id, vector<MapLine*>& list) const;
 	vector<MapLine*> allWithId(int id) const;
 	void             putAllTaggingWithId(int id, int type, vector<MapLine*>& list) const;
 	int              firstFreeId(MapFormat format) const;
+
+	void updateGeometry() const;
+
+private:
+	// Contiguous copies of all line vertex positions and bounding boxes (in
+	// list order) and a grid of the bounding boxes, for faster searching.
+	// Updated as needed when anything has changed
+	struct Geometry
+	{
+		vector<double> x1, y1, x2, y2;
+		vector<double> left, top, right, bottom;
+
+		void resize(unsigned size)
+		{
+			for (auto* values : { &x1, &y1, &x2, &y2, &left, &top, &right, &bottom })
+				values->resize(size);
+		}
+	};
+	mutable Geometry    geometry_;
+	mutable ObjectGrid  grid_;
+	mutable ChangeStamp geometry_stamp_;
+
+	// Line indices by id, and by each (non-zero) arg value (for finding lines
+	// with specials that may target an id)
+	mutable IdIndex id_index_;
+	mutable IdIndex arg_index_;
+
+	void updateIdIndex() const;
 };
 } // namespace slade
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+
 namespace slade
 {
 class MapObject;
@@ -26,6 +29,7 @@ public:
 	{
 		objects_.clear();
 		count_ = 0;
+		T::incModificationCount();
 	}
 	T*   back() { return objects_.back(); }
 	bool empty() const { return count_ == 0; }
@@ -40,6 +44,7 @@ public:
 	{
 		objects_.push_back(object);
 		++count_;
+		T::incModificationCount();
 	}
 	virtual void remove(unsigned index)
 	{
@@ -49,12 +54,34 @@ public:
 			objects_[index]->setIndex(index);
 			objects_.pop_back();
 			--count_;
+			T::incModificationCount();
 		}
 	}
 	virtual void removeLast()
 	{
 		objects_.pop_back();
 		--count_;
+		T::incModificationCount();
+	}
+
+	// Removes all objects flagged in [marked] (by index) in one pass, keeping
+	// the remaining objects in order
+	virtual void removeMarked(const vector<uint8_t>& marked)
+	{
+		unsigned kept = 0;
+		for (unsigned index = 0; index < count_; ++index)
+		{
+			if (index < marked.size() && marked[index])
+				continue;
+
+			objects_[kept] = objects_[index];
+			objects_[kept]->setIndex(kept);
+			++kept;
+		}
+
+		objects_.resize(kept);
+		count_ = kept;
+		T::incModificationCount();
 	}
 
 	// Misc
@@ -74,7 +101,55 @@ public:
 	}
 
 protected:
+	// Identifies the state of the map objects at some point, to check if
+	// anything may have changed since then (eg. for cached geometry)
+	struct ChangeStamp
+	{
+		unsigned long modifications = 0;
+		bool          valid         = false;
+	};
+
+	// Lookup of object indices (in list order) by an id value, eg. sector tags.
+	// Rebuilt as needed when anything has changed (see updateStamp)
+	struct IdIndex
+	{
+		std::unordered_map<int, vector<unsigned>> indices;
+		ChangeStamp                               stamp;
+
+		void add(int id, unsigned index)
+		{
+			auto& list = indices[id];
+			if (list.empty() || list.back() != index)
+				list.push_back(index);
+		}
+
+		const vector<unsigned>& find(int id) const
+		{
+			static const vector<unsigned> none;
+
+			auto i = indices.find(id);
+			return i != indices.end() ? i->second : none;
+		}
+	};
+
 	vector<T*> objects_;
 	unsigned   count_ = 0;
+
+	// Guards rebuilding of cached geometry (see updateGeometry in the derived
+	// lists), which queries on other threads may otherwise see half-built
+	mutable std::mutex geometry_mutex_;
+
+	// Returns true if any map object has been modified, added or removed since
+	// [stamp] was taken, and updates [stamp] to now
+	bool updateStamp(ChangeStamp& stamp) const
+	{
+		auto modifications = T::modificationCount();
+		if (stamp.valid && stamp.modifications == modifications)
+			return false;
+
+		stamp.modifications = modifications;
+		stamp.valid         = true;
+		return true;
+	}
 };
 } // namespace slade
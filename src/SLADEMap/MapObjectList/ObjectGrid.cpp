@@ -0,0 +1,238 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ObjectGrid.cpp
+// Description: ObjectGrid class, a uniform grid of object bounding boxes for
+//              quickly finding map objects in or near an area
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ObjectGrid.h"
+#include <limits>
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr double   MIN_CELL_SIZE = 16.;
+constexpr unsigned MAX_CELLS     = 1 << 20;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ObjectGrid Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// (Re)builds the grid from [count] object bounding boxes, given as arrays of
+// each box side. The cell size is picked so there are roughly as many cells as
+// objects
+// -----------------------------------------------------------------------------
+void ObjectGrid::build(unsigned count, const double* left, const double* top, const double* right, const double* bottom)
+{
+	clear();
+	if (count == 0)
+		return;
+
+	// Get bounds of all objects
+	min_x_ = left[0];
+	min_y_ = top[0];
+	max_x_ = right[0];
+	max_y_ = bottom[0];
+	for (unsigned a = 1; a < count; ++a)
+	{
+		min_x_ = std::min(min_x_, left[a]);
+		min_y_ = std::min(min_y_, top[a]);
+		max_x_ = std::max(max_x_, right[a]);
+		max_y_ = std::max(max_y_, bottom[a]);
+	}
+
+	// Determine cell size and grid dimensions
+	auto width  = std::max(max_x_ - min_x_, 1.);
+	auto height = std::max(max_y_ - min_y_, 1.);
+	cell_size_  = std::max(std::sqrt(width * height / std::min(count, MAX_CELLS)), MIN_CELL_SIZE);
+	cols_       = static_cast<unsigned>(width / cell_size_) + 1;
+	rows_       = static_cast<unsigned>(height / cell_size_) + 1;
+	count_      = count;
+
+	// Count objects in each cell
+	cell_start_.assign(cols_ * rows_ + 1, 0);
+	first_col_.resize(count);
+	first_row_.resize(count);
+	for (unsigned a = 0; a < count; ++a)
+	{
+		first_col_[a] = column(left[a]);
+		first_row_[a] = row(top[a]);
+		for (auto r = row(top[a]); r <= row(bottom[a]); ++r)
+			for (auto c = column(left[a]); c <= column(right[a]); ++c)
+				++cell_start_[r * cols_ + c + 1];
+	}
+
+	for (unsigned a = 1; a < cell_start_.size(); ++a)
+		cell_start_[a] += cell_start_[a - 1];
+
+	// Add objects to cells
+	vector<unsigned> fill(cell_start_.begin(), cell_start_.end() - 1);
+	items_.resize(cell_start_.back());
+	for (unsigned a = 0; a < count; ++a)
+		for (auto r = row(top[a]); r <= row(bottom[a]); ++r)
+			for (auto c = column(left[a]); c <= column(right[a]); ++c)
+				items_[fill[r * cols_ + c]++] = a;
+}
+
+// -----------------------------------------------------------------------------
+// Clears the grid
+// -----------------------------------------------------------------------------
+void ObjectGrid::clear()
+{
+	count_ = 0;
+	cols_  = 0;
+	rows_  = 0;
+	cell_start_.clear();
+	items_.clear();
+	first_col_.clear();
+	first_row_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the given box covers the whole grid (all objects)
+// -----------------------------------------------------------------------------
+bool ObjectGrid::covers(double left, double top, double right, double bottom) const
+{
+	return left <= min_x_ && top <= min_y_ && right >= max_x_ && bottom >= max_y_;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the point nearest to [point] by 'quick' (taxicab)
+// distance, where the grid was built from the points [x],[y]. Points further
+// than [max_dist] away are ignored, and if there are multiple nearest points
+// the one with the lowest index is returned (all of them are added to
+// [all_nearest] in order if given). Returns -1 if no point was found
+// -----------------------------------------------------------------------------
+unsigned ObjectGrid::nearestPoint(
+	const double*     x,
+	const double*     y,
+	Vec2d             point,
+	double            max_dist,
+	vector<unsigned>* all_nearest) const
+{
+	if (all_nearest)
+		all_nearest->clear();
+	if (count_ == 0)
+		return -1;
+
+	unsigned nearest  = -1;
+	double   min_dist = 0;
+
+	// Search outwards from [point] until the nearest point found is within the
+	// search box (any nearer point would have to be in it too)
+	auto radius = cell_size_;
+	while (true)
+	{
+		radius   = std::min(radius, max_dist);
+		nearest  = -1;
+		min_dist = std::numeric_limits<double>::max();
+		if (all_nearest)
+			all_nearest->clear();
+
+		auto left   = point.x - radius;
+		auto top    = point.y - radius;
+		auto right  = point.x + radius;
+		auto bottom = point.y + radius;
+		forEachIn(left, top, right, bottom, [&](unsigned index) {
+			auto dist = std::abs(point.x - x[index]) + std::abs(point.y - y[index]);
+			if (dist < min_dist)
+			{
+				nearest  = index;
+				min_dist = dist;
+				if (all_nearest)
+				{
+					all_nearest->clear();
+					all_nearest->push_back(index);
+				}
+			}
+			else if (dist == min_dist)
+			{
+				nearest = std::min(nearest, index);
+				if (all_nearest)
+					all_nearest->push_back(index);
+			}
+		});
+
+		if (min_dist <= radius || radius >= max_dist || covers(left, top, right, bottom))
+			break;
+
+		radius *= 2;
+	}
+
+	if (min_dist > max_dist)
+	{
+		if (all_nearest)
+			all_nearest->clear();
+		return -1;
+	}
+
+	if (all_nearest)
+		std::sort(all_nearest->begin(), all_nearest->end());
+
+	return nearest;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the grid column containing [x] (clamped to the grid)
+// -----------------------------------------------------------------------------
+unsigned ObjectGrid::column(double x) const
+{
+	if (x <= min_x_)
+		return 0;
+	if (x >= max_x_)
+		return cols_ - 1;
+
+	return std::min(static_cast<unsigned>((x - min_x_) / cell_size_), cols_ - 1);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the grid row containing [y] (clamped to the grid)
+// -----------------------------------------------------------------------------
+unsigned ObjectGrid::row(double y) const
+{
+	if (y <= min_y_)
+		return 0;
+	if (y >= max_y_)
+		return rows_ - 1;
+
+	return std::min(static_cast<unsigned>((y - min_y_) / cell_size_), rows_ - 1);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+namespace slade
+{
+// A uniform grid of (map object) bounding boxes, for quickly finding the
+// objects in or near an area without having to check every object.
+// Objects are identified by their index in the arrays the grid was built from
+class ObjectGrid
+{
+public:
+	ObjectGrid()  = default;
+	~ObjectGrid() = default;
+
+	double cellSize() const { return cell_size_; }
+
+	void     build(unsigned count, const double* left, const double* top, const double* right, const double* bottom);
+	void     clear();
+	bool     covers(double left, double top, double right, double bottom) const;
+	unsigned nearestPoint(
+		const double*     x,
+		const double*     y,
+		Vec2d             point,
+		double            max_dist,
+		vector<unsigned>* all_nearest = nullptr) const;
+
+	// Calls [func] once with the index of each object that may overlap the
+	// given box (objects in grid cells the box overlaps). If the box covers
+	// most of the grid, every object is just given instead
+	template<typename F> void forEachIn(double left, double top, double right, double bottom, F&& func) const
+	{
+		if (count_ == 0 || right < min_x_ || left > max_x_ || bottom < min_y_ || top > max_y_)
+			return;
+
+		auto c1 = column(left);
+		auto c2 = column(right);
+		auto r1 = row(top);
+		auto r2 = row(bottom);
+		if ((c2 - c1 + 1) * (r2 - r1 + 1) * 2 > cols_ * rows_)
+		{
+			for (unsigned a = 0; a < count_; ++a)
+				func(a);
+			return;
+		}
+
+		// Objects can be in multiple cells, only give each one from the first
+		// cell (top-left) it shares with the box. This keeps queries free of
+		// any state so they can run on multiple threads at once
+		for (auto r = r1; r <= r2; ++r)
+			for (auto c = c1; c <= c2; ++c)
+			{
+				auto cell = r * cols_ + c;
+				for (auto i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i)
+				{
+					auto index = items_[i];
+					if (std::max(first_col_[index], c1) == c && std::max(first_row_[index], r1) == r)
+						func(index);
+				}
+			}
+	}
+
+private:
+	unsigned         count_     = 0;
+	double           min_x_     = 0;
+	double           min_y_     = 0;
+	double           max_x_     = 0;
+	double           max_y_     = 0;
+	double           cell_size_ = 1;
+	unsigned         cols_      = 0;
+	unsigned         rows_      = 0;
+	vector<unsigned> cell_start_; // Index of each cell's first item in items_ (+ end of the last cell)
+	vector<unsigned> items_;      // Object indices in each cell
+	vector<unsigned> first_col_;  // First column of each object
+	vector<unsigned> first_row_;  // First row of each object
+
+	unsigned column(double x) const;
+	unsigned row(double y) const;
+};
+} // namespace slade
@@ -34,7 +34,7 @@
 #include "Main.h"
 #include "SectorList.h"
 #include "General/UI.h"
-#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -61,8 +61,8 @@ void SectorList::clear()
 void SectorList::add(MapSector* sector)
 {
 	// Update texture counts
-	usage_tex_[strutil::upper(sector->floor().texture)] += 1;
-	usage_tex_[strutil::upper(sector->ceiling().texture)] += 1;
+	usage_tex_.adjust(sector->floor().texture, 1);
+	usage_tex_.adjust(sector->ceiling().texture, 1);
 
 	MapObjectList::add(sector);
 }
@@ -76,27 +76,47 @@ void SectorList::remove(unsigned index)
 		return;
 
 	// Update texture counts
-	usage_tex_[strutil::upper(objects_[index]->floor().texture)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->ceiling().texture)] -= 1;
+	usage_tex_.adjust(objects_[index]->floor().texture, -1);
+	usage_tex_.adjust(objects_[index]->ceiling().texture, -1);
 
 	MapObjectList::remove(index);
 }
 
 // -----------------------------------------------------------------------------
-// Returns the sector at the given [point], or null if not within a sector
+// Removes all objects flagged in [marked] from the list and updates texture usage
 // -----------------------------------------------------------------------------
-MapSector* SectorList::atPos(Vec2d point) const
+void SectorList::removeMarked(const vector<uint8_t>& marked)
 {
-	// Go through sectors
-	for (const auto& sector : objects_)
+	// Update texture counts
+	for (unsigned index = 0; index < objects_.size() && index < marked.size(); ++index)
 	{
-		// Check if point is within sector
-		if (sector->containsPoint(point))
-			return sector;
+		if (!marked[index])
+			continue;
+
+		usage_tex_.adjust(objects_[index]->floor().texture, -1);
+		usage_tex_.adjust(objects_[index]->ceiling().texture, -1);
 	}
 
-	// Not within a sector
-	return nullptr;
+	MapObjectList::removeMarked(marked);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the sector at the given [point], or null if not within a sector
+// -----------------------------------------------------------------------------
+MapSector* SectorList::atPos(Vec2d point) const
+{
+	updateGeometry();
+
+	// Go through sectors with bboxes containing the point, the first (lowest
+	// index) one the point is within is used
+	unsigned found = count_;
+	grid_.forEachIn(point.x, point.y, point.x, point.y, [&](unsigned index) {
+		if (index < found && objects_[index]->containsPoint(point))
+			found = index;
+	});
+
+	// Not within a sector if none found
+	return found < count_ ? objects_[found] : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -129,6 +149,24 @@ BBox SectorList::allSectorBounds() const
 	return bbox;
 }
 
+// -----------------------------------------------------------------------------
+// Adds the indices of all sectors with bounding boxes overlapping [bbox] to
+// [indices], in list order
+// -----------------------------------------------------------------------------
+void SectorList::putIndicesInBox(const BBox& bbox, vector<unsigned>& indices) const
+{
+	updateGeometry();
+
+	auto start = indices.size();
+	grid_.forEachIn(bbox.min.x, bbox.min.y, bbox.max.x, bbox.max.y, [&](unsigned index) {
+		if (bbox_right_[index] >= bbox.min.x && bbox_left_[index] <= bbox.max.x
+			&& bbox_bottom_[index] >= bbox.min.y && bbox_top_[index] <= bbox.max.y)
+			indices.push_back(index);
+	});
+
+	std::sort(indices.begin() + start, indices.end());
+}
+
 // -----------------------------------------------------------------------------
 // Forces building of polygons for all sectors in the list
 // -----------------------------------------------------------------------------
@@ -136,11 +174,10 @@ void SectorList::initPolygons()
 {
 	ui::setSplashProgressMessage("Building sector polygons");
 	ui::setSplashProgress(0.0f);
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		ui::setSplashProgress((float)i / (float)count_);
-		objects_[i]->polygon();
-	}
+
+	// Each sector's polygon only depends on its own lines, so they can be built in parallel
+	threadpool::parallelFor(count_, [this](size_t index) { objects_[index]->polygon(); });
+
 	ui::setSplashProgress(1.0f);
 }
 
@@ -149,8 +186,8 @@ void SectorList::initPolygons()
 // -----------------------------------------------------------------------------
 void SectorList::initBBoxes()
 {
-	for (auto& sector : objects_)
-		sector->updateBBox();
+	// Each sector's bbox only depends on its own lines, so they can be updated in parallel
+	threadpool::parallelFor(count_, [this](size_t index) { objects_[index]->updateBBox(); });
 }
 
 // -----------------------------------------------------------------------------
@@ -158,9 +195,10 @@ void SectorList::initBBoxes()
 // -----------------------------------------------------------------------------
 void SectorList::putAllWithId(int id, vector<MapSector*>& list) const
 {
-	for (auto& sector : objects_)
-		if (sector->tag() == id)
-			list.push_back(sector);
+	updateTagIndex();
+
+	for (auto index : tag_index_.find(id))
+		list.push_back(objects_[index]);
 }
 
 // -----------------------------------------------------------------------------
@@ -178,11 +216,10 @@ vector<MapSector*> SectorList::allWithId(int id) const
 // -----------------------------------------------------------------------------
 MapSector* SectorList::firstWithId(int id) const
 {
-	for (auto& sector : objects_)
-		if (sector->tag() == id)
-			return sector;
+	updateTagIndex();
 
-	return nullptr;
+	auto& indices = tag_index_.find(id);
+	return indices.empty() ? nullptr : objects_[indices[0]];
 }
 
 // -----------------------------------------------------------------------------
@@ -190,15 +227,11 @@ MapSector* SectorList::firstWithId(int id) const
 // -----------------------------------------------------------------------------
 int SectorList::firstFreeId() const
 {
+	updateTagIndex();
+
 	int id = 1;
-	for (unsigned i = 0; i < count_; ++i)
-	{
-		if (objects_[i]->tag() == id)
-		{
-			id++;
-			i = 0;
-		}
-	}
+	while (tag_index_.indices.count(id) > 0)
+		id++;
 
 	return id;
 }
@@ -208,7 +241,7 @@ int SectorList::firstFreeId() const
 // -----------------------------------------------------------------------------
 void SectorList::updateTexUsage(string_view tex, int adjust) const
 {
-	usage_tex_[strutil::upper(tex)] += adjust;
+	usage_tex_.adjust(tex, adjust);
 }
 
 // -----------------------------------------------------------------------------
@@ -216,5 +249,48 @@ void SectorList::updateTexUsage(string_view tex, int adjust) const
 // -----------------------------------------------------------------------------
 int SectorList::texUsageCount(string_view tex) const
 {
-	return usage_tex_[strutil::upper(tex)];
+	return usage_tex_.count(tex);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the sector bbox arrays and grid if any sectors have been added,
+// removed or modified (or any map geometry changed) since they were last
+// updated.
+// This is done explicitly after map edits (see SLADEMap::updateGeometryInfo),
+// queries only need to rebuild if called partway through an edit
+// -----------------------------------------------------------------------------
+void SectorList::updateGeometry() const
+{
+	std::lock_guard lock(geometry_mutex_);
+	if (!updateStamp(geometry_stamp_))
+		return;
+
+	bbox_left_.resize(count_);
+	bbox_top_.resize(count_);
+	bbox_right_.resize(count_);
+	bbox_bottom_.resize(count_);
+	for (unsigned a = 0; a < count_; ++a)
+	{
+		auto bbox       = objects_[a]->boundingBox();
+		bbox_left_[a]   = bbox.min.x;
+		bbox_top_[a]    = bbox.min.y;
+		bbox_right_[a]  = bbox.max.x;
+		bbox_bottom_[a] = bbox.max.y;
+	}
+
+	grid_.build(count_, bbox_left_.data(), bbox_top_.data(), bbox_right_.data(), bbox_bottom_.data());
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the sector tag index if any sectors have been added, removed or
+// modified since it was last built
+// -----------------------------------------------------------------------------
+void SectorList::updateTagIndex() const
+{
+	if (!updateStamp(tag_index_.stamp))
+		return;
+
+	tag_index_.indices.clear();
+	for (unsigned a = 0; a < count_; ++a)
+		tag_index_.add(objects_[a]->tag(), a);
 }
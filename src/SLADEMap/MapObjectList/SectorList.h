@@ -1,7 +1,9 @@
 #pragma once
 
 #include "MapObjectList.h"
+#include "ObjectGrid.h"
 #include "SLADEMap/MapObject/MapSector.h"
+#include "TextureUsage.h"
 
 namespace slade
 {
@@ -12,9 +14,11 @@ public:
 	void clear() override;
 	void add(MapSector* sector) override;
 	void remove(unsigned index) override;
+	void removeMarked(const vector<uint8_t>& marked) override;
 
 	MapSector*         atPos(Vec2d point) const;
 	BBox               allSectorBounds() const;
+	void               putIndicesInBox(const BBox& bbox, vector<unsigned>& indices) const;
 	void               initPolygons();
 	void               initBBoxes();
 	void               putAllWithId(int id, vector<MapSector*>& list) const;
@@ -22,11 +26,25 @@ public:
 	MapSector*         firstWithId(int id) const;
 	int                firstFreeId() const;
 
+	void updateGeometry() const;
+
 	void clearTexUsage() const { usage_tex_.clear(); }
 	void updateTexUsage(string_view tex, int adjust) const;
 	int  texUsageCount(string_view tex) const;
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable TextureUsage usage_tex_;
+
+	// Contiguous copies of all sector bounding boxes (in list order) and a grid
+	// of them, for faster searching. Updated as needed when anything has changed
+	mutable vector<double> bbox_left_;
+	mutable vector<double> bbox_top_;
+	mutable vector<double> bbox_right_;
+	mutable vector<double> bbox_bottom_;
+	mutable ObjectGrid     grid_;
+	mutable ChangeStamp    geometry_stamp_;
+	mutable IdIndex        tag_index_;
+
+	void updateTagIndex() const;
 };
 } // namespace slade
@@ -33,7 +33,6 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "SideList.h"
-#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -60,9 +59,9 @@ void SideList::clear()
 void SideList::add(MapSide* side)
 {
 	// Update texture counts
-	usage_tex_[strutil::upper(side->tex_upper_)] += 1;
-	usage_tex_[strutil::upper(side->tex_middle_)] += 1;
-	usage_tex_[strutil::upper(side->tex_lower_)] += 1;
+	usage_tex_.adjust(side->tex_upper_, 1);
+	usage_tex_.adjust(side->tex_middle_, 1);
+	usage_tex_.adjust(side->tex_lower_, 1);
 
 	MapObjectList::add(side);
 }
@@ -76,19 +75,38 @@ void SideList::remove(unsigned index)
 		return;
 
 	// Update texture counts
-	usage_tex_[strutil::upper(objects_[index]->tex_upper_)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->tex_middle_)] -= 1;
-	usage_tex_[strutil::upper(objects_[index]->tex_lower_)] -= 1;
+	usage_tex_.adjust(objects_[index]->tex_upper_, -1);
+	usage_tex_.adjust(objects_[index]->tex_middle_, -1);
+	usage_tex_.adjust(objects_[index]->tex_lower_, -1);
 
 	MapObjectList::remove(index);
 }
 
+// -----------------------------------------------------------------------------
+// Removes all objects flagged in [marked] from the list and updates texture usage
+// -----------------------------------------------------------------------------
+void SideList::removeMarked(const vector<uint8_t>& marked)
+{
+	// Update texture counts
+	for (unsigned index = 0; index < objects_.size() && index < marked.size(); ++index)
+	{
+		if (!marked[index])
+			continue;
+
+		usage_tex_.adjust(objects_[index]->tex_upper_, -1);
+		usage_tex_.adjust(objects_[index]->tex_middle_, -1);
+		usage_tex_.adjust(objects_[index]->tex_lower_, -1);
+	}
+
+	MapObjectList::removeMarked(marked);
+}
+
 // -----------------------------------------------------------------------------
 // Adjusts the usage count of [tex] by [adjust]
 // -----------------------------------------------------------------------------
 void SideList::updateTexUsage(string_view tex, int adjust) const
 {
-	usage_tex_[strutil::upper(tex)] += adjust;
+	usage_tex_.adjust(tex, adjust);
 }
 
 // -----------------------------------------------------------------------------
@@ -96,5 +114,5 @@ void SideList::updateTexUsage(string_view tex, int adjust) const
 // -----------------------------------------------------------------------------
 int SideList::texUsageCount(string_view tex) const
 {
-	return usage_tex_[strutil::upper(tex)];
+	return usage_tex_.count(tex);
 }
@@ -2,6 +2,7 @@
 
 #include "MapObjectList.h"
 #include "SLADEMap/MapObject/MapSide.h"
+#include "TextureUsage.h"
 
 namespace slade
 {
@@ -12,12 +13,13 @@ public:
 	void clear() override;
 	void add(MapSide* side) override;
 	void remove(unsigned index) override;
+	void removeMarked(const vector<uint8_t>& marked) override;
 
 	void clearTexUsage() const { usage_tex_.clear(); }
 	void updateTexUsage(string_view tex, int adjust) const;
 	int  texUsageCount(string_view tex) const;
 
 private:
-	mutable std::map<string, int> usage_tex_;
+	mutable TextureUsage usage_tex_;
 };
 } // namespace slade
@@ -0,0 +1,76 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextureUsage.cpp
+// Description: TextureUsage class, keeps count of how many times each texture
+//              is used by map objects
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextureUsage.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// TextureUsage Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Adjusts the usage count of [texture] by [amount]
+// -----------------------------------------------------------------------------
+void TextureUsage::adjust(string_view texture, int amount)
+{
+	auto i = counts_.find(key(texture));
+	if (i != counts_.end())
+		i->second += amount;
+	else
+		counts_.emplace(key_, amount);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the usage count of [texture]
+// -----------------------------------------------------------------------------
+int TextureUsage::count(string_view texture) const
+{
+	auto i = counts_.find(key(texture));
+	return i != counts_.end() ? i->second : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [texture] uppercased (in the reused key buffer)
+// -----------------------------------------------------------------------------
+const string& TextureUsage::key(string_view texture) const
+{
+	key_.assign(texture.data(), texture.size());
+	for (auto& c : key_)
+		c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+
+	return key_;
+}
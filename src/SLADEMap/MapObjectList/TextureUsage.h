@@ -0,0 +1,26 @@
+#pragma once
+
+#include <unordered_map>
+
+namespace slade
+{
+// Counts how many times each texture (by name, case-insensitive) is used.
+// Counts are adjusted as textures are changed rather than being recounted, and
+// names are uppercased into a reused buffer so lookups don't allocate
+class TextureUsage
+{
+public:
+	TextureUsage()  = default;
+	~TextureUsage() = default;
+
+	void clear() { counts_.clear(); }
+	void adjust(string_view texture, int amount);
+	int  count(string_view texture) const;
+
+private:
+	std::unordered_map<string, int> counts_; // Uppercase texture name -> usage count
+	mutable string                  key_;
+
+	const string& key(string_view texture) const;
+};
+} // namespace slade
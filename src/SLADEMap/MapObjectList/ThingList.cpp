@@ -36,10 +36,48 @@
 #include "Game/Configuration.h"
 #include "SLADEMap/SLADEMap.h"
 #include "Utility/MathStuff.h"
+#include <unordered_set>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the id of the next thing in [thing]'s path (from the args given by
+// its type's 'next_args'), or 0 if it has none
+// -----------------------------------------------------------------------------
+int nextPathId(const MapThing& thing)
+{
+	int next_args = thing.typeInfo().nextArgs();
+	int id        = 0;
+	if (next_args % 10 > 0)
+		id = thing.arg(next_args % 10 - 1);
+	if (next_args >= 10)
+		id += 256 * thing.arg(next_args / 10 - 1);
+
+	return id;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if any of [thing]'s args are [id]
+// -----------------------------------------------------------------------------
+bool argsReference(const MapThing& thing, int id)
+{
+	for (int a = 0; a < 5; ++a)
+		if (thing.arg(a) == id)
+			return true;
+
+	return false;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // ThingList Class Functions
@@ -47,39 +85,82 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// Clears the list (and thing type usage)
+// -----------------------------------------------------------------------------
+void ThingList::clear()
+{
+	usage_type_.clear();
+	MapObjectList::clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [thing] to the list and updates thing type usage
+// -----------------------------------------------------------------------------
+void ThingList::add(MapThing* thing)
+{
+	usage_type_[thing->type()] += 1;
+	MapObjectList::add(thing);
+}
+
+// -----------------------------------------------------------------------------
+// Removes [thing] from the list and updates thing type usage
+// -----------------------------------------------------------------------------
+void ThingList::remove(unsigned index)
+{
+	if (index >= objects_.size())
+		return;
+
+	usage_type_[objects_[index]->type()] -= 1;
+	MapObjectList::remove(index);
+}
+
+// -----------------------------------------------------------------------------
+// Removes all objects flagged in [marked] from the list and updates type usage
+// -----------------------------------------------------------------------------
+void ThingList::removeMarked(const vector<uint8_t>& marked)
+{
+	for (unsigned index = 0; index < objects_.size() && index < marked.size(); ++index)
+		if (marked[index])
+			usage_type_[objects_[index]->type()] -= 1;
+
+	MapObjectList::removeMarked(marked);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of things in the list of [type]
+// -----------------------------------------------------------------------------
+int ThingList::typeUsageCount(int type) const
+{
+	auto i = usage_type_.find(type);
+	return i != usage_type_.end() ? i->second : 0;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the thing closest to the point, or null if none found.
 // Igonres any thing further away than [min]
 // -----------------------------------------------------------------------------
 MapThing* ThingList::nearest(Vec2d point, double min) const
 {
-	// Go through things
-	double    dist;
-	double    min_dist = 999999999;
-	MapThing* nearest  = nullptr;
-	for (const auto& thing : objects_)
-	{
-		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicabDistanceTo(thing->position());
+	updateGeometry();
 
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
-		{
-			nearest  = thing;
-			min_dist = dist;
-		}
-	}
+	// Get the thing with the lowest 'quick' distance (no need to get real
+	// distance). The real distance can't be more than [min] if the quick
+	// distance is over min * sqrt(2), so only look that far
+	auto nearest = grid_.nearestPoint(pos_x_.data(), pos_y_.data(), point, min * std::sqrt(2.));
 
 	// Now determine the real distance to the closest thing,
 	// to check for minimum hilight distance
-	if (nearest)
+	if (nearest < count_)
 	{
-		double rdist = math::distance(nearest->position(), point);
+		double rdist = math::distance(objects_[nearest]->position(), point);
 		if (rdist > min)
 			return nullptr;
+
+		return objects_[nearest];
 	}
 
-	return nearest;
+	return nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -88,26 +169,15 @@ MapThing* ThingList::nearest(Vec2d point, double min) const
 // -----------------------------------------------------------------------------
 vector<MapThing*> ThingList::multiNearest(Vec2d point) const
 {
-	vector<MapThing*> ret;
+	updateGeometry();
 
-	// Go through things
-	double min_dist = 999999999;
-	double dist     = 0;
-	for (const auto& thing : objects_)
-	{
-		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicabDistanceTo(thing->position());
+	// Get all things with the lowest 'quick' distance (no need to get real distance)
+	vector<unsigned> nearest;
+	grid_.nearestPoint(pos_x_.data(), pos_y_.data(), point, std::numeric_limits<double>::max(), &nearest);
 
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
-		{
-			ret.clear();
-			ret.push_back(thing);
-			min_dist = dist;
-		}
-		else if (dist == min_dist)
-			ret.push_back(thing);
-	}
+	vector<MapThing*> ret;
+	for (auto index : nearest)
+		ret.push_back(objects_[index]);
 
 	return ret;
 }
@@ -127,14 +197,34 @@ BBox ThingList::allThingBounds() const
 	return bbox;
 }
 
+// -----------------------------------------------------------------------------
+// Adds the indices of all things positioned within [bbox] to [indices], in
+// list order
+// -----------------------------------------------------------------------------
+void ThingList::putIndicesInBox(const BBox& bbox, vector<unsigned>& indices) const
+{
+	updateGeometry();
+
+	auto start = indices.size();
+	grid_.forEachIn(bbox.min.x, bbox.min.y, bbox.max.x, bbox.max.y, [&](unsigned index) {
+		if (pos_x_[index] >= bbox.min.x && pos_x_[index] <= bbox.max.x && pos_y_[index] >= bbox.min.y
+			&& pos_y_[index] <= bbox.max.y)
+			indices.push_back(index);
+	});
+
+	std::sort(indices.begin() + start, indices.end());
+}
+
 // -----------------------------------------------------------------------------
 // Adds all things with TID [id] to [list].
 // If [type] is not 0, only checks things of that type
 // -----------------------------------------------------------------------------
 void ThingList::putAllWithId(int id, vector<MapThing*>& list, unsigned start, int type) const
 {
-	for (unsigned i = start; i < count_; ++i)
-		if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
+	updateIdIndex();
+
+	for (auto i : id_index_.find(id))
+		if (i >= start && (type == 0 || objects_[i]->type() == type))
 			list.push_back(objects_[i]);
 }
 
@@ -155,12 +245,14 @@ vector<MapThing*> ThingList::allWithId(int id, unsigned start, int type) const
 // -----------------------------------------------------------------------------
 MapThing* ThingList::firstWithId(int id, unsigned start, int type, bool ignore_dragon) const
 {
-	for (unsigned i = start; i < count_; ++i)
-		if (objects_[i]->id() == id && (type == 0 || objects_[i]->type() == type))
+	updateIdIndex();
+
+	for (auto i : id_index_.find(id))
+		if (i >= start && (type == 0 || objects_[i]->type() == type))
 		{
 			if (ignore_dragon)
 			{
-				auto& tt = game::configuration().thingType(objects_[i]->type());
+				auto& tt = objects_[i]->typeInfo();
 				if (tt.flags() & game::ThingType::Flags::Dragon)
 					continue;
 			}
@@ -179,7 +271,7 @@ void ThingList::putAllPathed(vector<MapThing*>& list) const
 	// Find things that need to be pathed
 	for (const auto& thing : objects_)
 	{
-		auto& tt = game::configuration().thingType(thing->type());
+		auto& tt = thing->typeInfo();
 		if (tt.flags() & (game::ThingType::Flags::Pathed | game::ThingType::Flags::Dragon))
 			list.push_back(thing);
 	}
@@ -193,11 +285,14 @@ void ThingList::putAllTaggingWithId(int id, int type, vector<MapThing*>& list, i
 {
 	using game::TagType;
 
-	// Find things with special affecting matching id
+	// Find things with special affecting matching id (only things with an arg
+	// or id matching id can possibly be affecting it)
+	updateIdIndex();
 	int tag, arg2, arg3, arg4, arg5, tid;
-	for (auto& thing : objects_)
+	for (auto index : arg_index_.find(id))
 	{
-		auto& tt        = game::configuration().thingType(thing->type());
+		auto  thing     = objects_[index];
+		auto& tt        = thing->typeInfo();
 		auto  needs_tag = tt.needsTag();
 		if (needs_tag != TagType::None || (thing->special() && !(tt.flags() & game::ThingType::Flags::Script)))
 		{
@@ -296,20 +391,200 @@ void ThingList::putAllTaggingWithId(int id, int type, vector<MapThing*>& list, i
 }
 #undef IDEQ
 
+// -----------------------------------------------------------------------------
+// Adds [first] and all things it leads to via the ids in their args to [list]
+// (ie. the targets of a dragon starting at [first])
+// -----------------------------------------------------------------------------
+void ThingList::putDragonTargets(MapThing* first, vector<MapThing*>& list) const
+{
+	updateIdIndex();
+
+	std::unordered_set<int>      used_ids;
+	std::unordered_set<unsigned> added{ first->index() };
+	list.clear();
+	list.push_back(first);
+	for (unsigned i = 0; i < list.size(); ++i)
+	{
+		for (int a = 0; a < 5; ++a)
+		{
+			int id = list[i]->arg(a);
+			if (id == 0 || !used_ids.insert(id).second)
+				continue;
+
+			for (auto index : id_index_.find(id))
+				if (added.insert(index).second)
+					list.push_back(objects_[index]);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the paths between all pathed things (eg. patrol or interpolation
+// points) and dragon targets in the list
+// -----------------------------------------------------------------------------
+const vector<ThingList::Path>& ThingList::paths() const
+{
+	updatePaths();
+	return paths_;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the lowest unused thing id
 // -----------------------------------------------------------------------------
 int ThingList::firstFreeId() const
 {
+	updateIdIndex();
+
 	int id = 1;
-	for (unsigned i = 0; i < count_; ++i)
+	while (id_index_.indices.count(id) > 0)
+		id++;
+
+	return id;
+}
+
+// -----------------------------------------------------------------------------
+// Updates the thing position arrays and grid if any things have been added,
+// removed or modified since they were last updated.
+// This is done explicitly after map edits (see SLADEMap::updateGeometryInfo),
+// queries only need to rebuild if called partway through an edit
+// -----------------------------------------------------------------------------
+void ThingList::updateGeometry() const
+{
+	std::lock_guard lock(geometry_mutex_);
+	if (!updateStamp(geometry_stamp_))
+		return;
+
+	pos_x_.resize(count_);
+	pos_y_.resize(count_);
+	for (unsigned a = 0; a < count_; ++a)
 	{
-		if (objects_[i]->id() == id)
+		pos_x_[a] = objects_[a]->xPos();
+		pos_y_[a] = objects_[a]->yPos();
+	}
+
+	grid_.build(count_, pos_x_.data(), pos_y_.data(), pos_x_.data(), pos_y_.data());
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the thing id and arg indices if anything in the map has been
+// modified since they were last built
+// -----------------------------------------------------------------------------
+void ThingList::updateIdIndex() const
+{
+	if (!updateStamp(id_index_.stamp))
+		return;
+
+	id_index_.indices.clear();
+	arg_index_.indices.clear();
+	for (unsigned a = 0; a < count_; ++a)
+	{
+		auto thing = objects_[a];
+		id_index_.add(thing->id(), a);
+
+		// Arg 0 can be a negated line id (see TagType::LineNegative), and
+		// patrol/interpolation points are matched by their own id
+		for (int arg = 0; arg < 5; ++arg)
+			if (thing->arg(arg) != 0)
+				arg_index_.add(thing->arg(arg), a);
+		if (thing->arg(0) < 0)
+			arg_index_.add(-thing->arg(0), a);
+		if (thing->id() != 0)
+			arg_index_.add(thing->id(), a);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the thing paths list if anything in the map or the thing type
+// definitions have been modified since it was last built
+// -----------------------------------------------------------------------------
+void ThingList::updatePaths() const
+{
+	auto types_version = game::configuration().thingTypesVersion();
+	if (!updateStamp(paths_stamp_) && paths_types_version_ == types_version)
+		return;
+
+	paths_types_version_ = types_version;
+	paths_.clear();
+	updateIdIndex();
+
+	std::unordered_set<int> dragon_ids;
+	for (unsigned a = 0; a < count_; ++a)
+	{
+		auto  thing = objects_[a];
+		auto& tt    = thing->typeInfo();
+
+		// Dragon, path to the first thing with its id and between all targets
+		// from there (only once for each id)
+		if (tt.flags() & game::ThingType::Flags::Dragon)
 		{
-			id++;
-			i = 0;
+			auto first = firstWithId(thing->id());
+			if (!first)
+				continue;
+
+			paths_.push_back({ a, first->index(), false, true });
+			if (dragon_ids.insert(thing->id()).second)
+				addDragonPaths(first);
+			continue;
+		}
+
+		if (!(tt.flags() & game::ThingType::Flags::Pathed))
+			continue;
+
+		// Pathed thing, path to the next thing(s) with the next type and id
+		int next_id = nextPathId(*thing);
+		if (next_id <= 0)
+			continue;
+		for (auto index : id_index_.find(next_id))
+		{
+			auto  next    = objects_[index];
+			auto& next_tt = next->typeInfo();
+			if (index == a || next->type() != tt.nextType() || !(next_tt.flags() & game::ThingType::Flags::Pathed))
+				continue;
+
+			// Paths going both ways are added once, from the lower index
+			bool both = next_tt.nextType() == thing->type() && nextPathId(*next) == thing->id();
+			if (both && index < a)
+				continue;
+
+			paths_.push_back({ a, index, both, false });
 		}
 	}
+}
 
-	return id;
+// -----------------------------------------------------------------------------
+// Adds paths between the (non-dragon) targets of a dragon starting at [first]
+// -----------------------------------------------------------------------------
+void ThingList::addDragonPaths(MapThing* first) const
+{
+	vector<MapThing*> targets;
+	putDragonTargets(first, targets);
+
+	for (auto target : targets)
+	{
+		if (target->typeInfo().flags() & game::ThingType::Flags::Dragon)
+			continue;
+
+		// Path from each thing [target] refers to in its args
+		int ids[5];
+		for (int a = 0; a < 5; ++a)
+		{
+			int id = ids[a] = target->arg(a);
+			if (id == 0 || std::find(ids, ids + a, id) != ids + a)
+				continue;
+
+			for (auto index : id_index_.find(id))
+			{
+				auto from = objects_[index];
+				if (from == target || (from->typeInfo().flags() & game::ThingType::Flags::Dragon))
+					continue;
+
+				// Paths going both ways are added once, from the higher index
+				bool both = argsReference(*from, target->id());
+				if (both && index < target->index())
+					continue;
+
+				paths_.push_back({ index, target->index(), both, true });
+			}
+		}
+	}
 }
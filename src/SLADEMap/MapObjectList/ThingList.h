@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapObjectList.h"
+#include "ObjectGrid.h"
 #include "SLADEMap/MapObject/MapThing.h"
 
 namespace slade
@@ -8,14 +9,63 @@ namespace slade
 class ThingList : public MapObjectList<MapThing>
 {
 public:
-	MapThing*         nearest(Vec2d point, double min = 64) const;
-	vector<MapThing*> multiNearest(Vec2d point) const;
-	BBox              allThingBounds() const;
-	void              putAllWithId(int id, vector<MapThing*>& list, unsigned start = 0, int type = 0) const;
-	vector<MapThing*> allWithId(int id, unsigned start = 0, int type = 0) const;
-	MapThing*         firstWithId(int id, unsigned start = 0, int type = 0, bool ignore_dragon = false) const;
-	void              putAllPathed(vector<MapThing*>& list) const;
-	void              putAllTaggingWithId(int id, int type, vector<MapThing*>& list, int ttype) const;
-	int               firstFreeId() const;
+	// A path between two things (indices), eg. from a patrol point to the next
+	struct Path
+	{
+		unsigned from;
+		unsigned to;
+		bool     both   = false; // True if [to] also leads back to [from]
+		bool     dragon = false; // True if this is part of a dragon's path
+	};
+
+	// MapObjectList overrides
+	void clear() override;
+	void add(MapThing* thing) override;
+	void remove(unsigned index) override;
+	void removeMarked(const vector<uint8_t>& marked) override;
+
+	MapThing*           nearest(Vec2d point, double min = 64) const;
+	vector<MapThing*>   multiNearest(Vec2d point) const;
+	BBox                allThingBounds() const;
+	void                putIndicesInBox(const BBox& bbox, vector<unsigned>& indices) const;
+	void                putAllWithId(int id, vector<MapThing*>& list, unsigned start = 0, int type = 0) const;
+	vector<MapThing*>   allWithId(int id, unsigned start = 0, int type = 0) const;
+	MapThing*           firstWithId(int id, unsigned start = 0, int type = 0, bool ignore_dragon = false) const;
+	void                putAllPathed(vector<MapThing*>& list) const;
+	void                putAllTaggingWithId(int id, int type, vector<MapThing*>& list, int ttype) const;
+	void                putDragonTargets(MapThing* first, vector<MapThing*>& list) const;
+	const vector<Path>& paths() const;
+	int                 firstFreeId() const;
+
+	void updateGeometry() const;
+
+	void updateTypeUsage(int type, int adjust) const { usage_type_[type] += adjust; }
+	int  typeUsageCount(int type) const;
+
+private:
+	mutable std::unordered_map<int, int> usage_type_;
+
+	// Contiguous copies of all thing x and y positions (in list order) and a
+	// grid of them, for faster searching. Updated as needed when anything has
+	// changed
+	mutable vector<double> pos_x_;
+	mutable vector<double> pos_y_;
+	mutable ObjectGrid     grid_;
+	mutable ChangeStamp    geometry_stamp_;
+
+	// Thing indices by id, and by each (non-zero) arg value or id (for finding
+	// things with specials that may target an id)
+	mutable IdIndex id_index_;
+	mutable IdIndex arg_index_;
+
+	// Paths between pathed things and dragon targets, rebuilt as needed when
+	// anything (or the thing type definitions) has changed
+	mutable vector<Path> paths_;
+	mutable ChangeStamp  paths_stamp_;
+	mutable unsigned     paths_types_version_ = 0;
+
+	void updateIdIndex() const;
+	void updatePaths() const;
+	void addDragonPaths(MapThing* first) const;
 };
 } // namespace slade
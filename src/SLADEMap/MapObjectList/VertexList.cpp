@@ -51,33 +51,25 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::nearest(Vec2d point, double min) const
 {
-	// Go through vertices
-	double     dist;
-	double     min_dist = 999999999;
-	MapVertex* nearest  = nullptr;
-	for (const auto& vertex : objects_)
-	{
-		// Get 'quick' distance (no need to get real distance)
-		dist = point.taxicabDistanceTo(vertex->position());
+	updateGeometry();
 
-		// Check if it's nearer than the previous nearest
-		if (dist < min_dist)
-		{
-			nearest  = vertex;
-			min_dist = dist;
-		}
-	}
+	// Get the vertex with the lowest 'quick' distance (no need to get real
+	// distance). The real distance can't be more than [min] if the quick
+	// distance is over min * sqrt(2), so only look that far
+	auto nearest = grid_.nearestPoint(pos_x_.data(), pos_y_.data(), point, min * std::sqrt(2.));
 
 	// Now determine the real distance to the closest vertex,
 	// to check for minimum hilight distance
-	if (nearest)
+	if (nearest < count_)
 	{
-		double rdist = math::distance(nearest->position(), point);
+		double rdist = math::distance(objects_[nearest]->position(), point);
 		if (rdist > min)
 			return nullptr;
+
+		return objects_[nearest];
 	}
 
-	return nearest;
+	return nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -85,15 +77,17 @@ MapVertex* VertexList::nearest(Vec2d point, double min) const
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::vertexAt(double x, double y) const
 {
-	// Go through all vertices
-	for (auto& vertex : objects_)
-	{
-		if (vertex->position_.x == x && vertex->position_.y == y)
-			return vertex;
-	}
+	updateGeometry();
 
-	// No vertex at [x,y]
-	return nullptr;
+	// Check all vertices near [x,y], the first (lowest index) one there is used
+	unsigned found = count_;
+	grid_.forEachIn(x, y, x, y, [&](unsigned index) {
+		if (pos_x_[index] == x && pos_y_[index] == y)
+			found = std::min(found, index);
+	});
+
+	// No vertex at [x,y] if none found
+	return found < count_ ? objects_[found] : nullptr;
 }
 
 // -----------------------------------------------------------------------------
@@ -101,34 +95,76 @@ MapVertex* VertexList::vertexAt(double x, double y) const
 // -----------------------------------------------------------------------------
 MapVertex* VertexList::firstCrossed(const Seg2d& line) const
 {
-	// Go through vertices
-	MapVertex* cv       = nullptr;
-	double     min_dist = 999999;
-	for (const auto& vertex : objects_)
-	{
-		auto point = vertex->position();
+	updateGeometry();
+
+	// Go through vertices within the line bbox
+	unsigned cv       = count_;
+	double   min_dist = 999999;
+	grid_.forEachIn(line.left(), line.top(), line.right(), line.bottom(), [&](unsigned index) {
+		Vec2d point{ pos_x_[index], pos_y_[index] };
 
 		// Skip if outside line bbox
 		if (!line.contains(point))
-			continue;
+			return;
 
 		// Skip if it's at an end of the line
 		if (point == line.start() || point == line.end())
-			continue;
+			return;
 
 		// Check if on line
 		if (math::distanceToLineFast(point, line) == 0)
 		{
 			// Check distance between line start and vertex
 			double dist = math::distance(line.start(), point);
-			if (dist < min_dist)
+			if (dist < min_dist || dist == min_dist && index < cv)
 			{
-				cv       = vertex;
+				cv       = index;
 				min_dist = dist;
 			}
 		}
-	}
+	});
 
 	// Return closest overlapping vertex to line start
-	return cv;
+	return cv < count_ ? objects_[cv] : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds all vertices within [bbox] (inclusive) to [list], in index order
+// -----------------------------------------------------------------------------
+void VertexList::putAllInBox(const BBox& bbox, vector<MapVertex*>& list) const
+{
+	updateGeometry();
+
+	vector<unsigned> indices;
+	grid_.forEachIn(bbox.min.x, bbox.min.y, bbox.max.x, bbox.max.y, [&](unsigned index) {
+		if (bbox.pointWithin(pos_x_[index], pos_y_[index]))
+			indices.push_back(index);
+	});
+
+	std::sort(indices.begin(), indices.end());
+	for (auto index : indices)
+		list.push_back(objects_[index]);
+}
+
+// -----------------------------------------------------------------------------
+// Updates the vertex position arrays and grid if any vertices have been added,
+// removed or modified since they were last updated.
+// This is done explicitly after map edits (see SLADEMap::updateGeometryInfo),
+// queries only need to rebuild if called partway through an edit
+// -----------------------------------------------------------------------------
+void VertexList::updateGeometry() const
+{
+	std::lock_guard lock(geometry_mutex_);
+	if (!updateStamp(geometry_stamp_))
+		return;
+
+	pos_x_.resize(count_);
+	pos_y_.resize(count_);
+	for (unsigned a = 0; a < count_; ++a)
+	{
+		pos_x_[a] = objects_[a]->xPos();
+		pos_y_[a] = objects_[a]->yPos();
+	}
+
+	grid_.build(count_, pos_x_.data(), pos_y_.data(), pos_x_.data(), pos_y_.data());
 }
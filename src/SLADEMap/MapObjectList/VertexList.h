@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MapObjectList.h"
+#include "ObjectGrid.h"
 #include "SLADEMap/MapObject/MapVertex.h"
 
 namespace slade
@@ -11,5 +12,17 @@ public:
 	MapVertex* nearest(Vec2d point, double min = 64) const;
 	MapVertex* vertexAt(double x, double y) const;
 	MapVertex* firstCrossed(const Seg2d& line) const;
+	void       putAllInBox(const BBox& bbox, vector<MapVertex*>& list) const;
+
+	void updateGeometry() const;
+
+private:
+	// Contiguous copies of all vertex x and y positions (in list order) and a
+	// grid of them, for faster searching. Updated as needed when anything has
+	// changed
+	mutable vector<double> pos_x_;
+	mutable vector<double> pos_y_;
+	mutable ObjectGrid     grid_;
+	mutable ChangeStamp    geometry_stamp_;
 };
 } // namespace slade
@@ -0,0 +1,452 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapPreviewData.cpp
+// Description: Functions for reading the basic geometry of a map for map
+//              previews. Reading can be done on any thread, and read previews
+//              are cached by their map data's hash
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapPreviewData.h"
+#include "Archive/EntryType/EntryType.h"
+#include "Archive/Formats/WadArchive.h"
+#include "SLADEMap/MapFormat/Doom64MapFormat.h"
+#include "SLADEMap/MapFormat/DoomMapFormat.h"
+#include "SLADEMap/MapFormat/HexenMapFormat.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+#include "Utility/Tokenizer.h"
+#include <list>
+#include <mutex>
+
+using namespace slade;
+using namespace mappreview;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr unsigned CACHE_SIZE = 32; // Max number of map previews to keep cached
+
+std::mutex                                                  cache_mutex;
+std::list<std::pair<uint64_t, shared_ptr<MapPreviewData>>> cache; // Most recently used first
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a key identifying the map data in [source], for the preview cache
+// -----------------------------------------------------------------------------
+uint64_t sourceKey(const Source& source)
+{
+	uint64_t key = static_cast<uint64_t>(source.format);
+	for (auto mc :
+		 { &source.vertexes, &source.linedefs, &source.things, &source.sidedefs, &source.sectors, &source.textmap })
+		key = (key * 1099511628211ull) ^ ((static_cast<uint64_t>(mc->size()) << 32) | mc->crc());
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the cached preview matching [key], or nullptr if there isn't one
+// -----------------------------------------------------------------------------
+shared_ptr<MapPreviewData> cachedPreview(uint64_t key)
+{
+	std::lock_guard lock(cache_mutex);
+	for (auto i = cache.begin(); i != cache.end(); ++i)
+	{
+		if (i->first == key)
+		{
+			cache.splice(cache.begin(), cache, i);
+			return cache.front().second;
+		}
+	}
+
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Adds [preview] to the cache with [key], removing the least recently used
+// preview if the cache is full
+// -----------------------------------------------------------------------------
+void cachePreview(uint64_t key, const shared_ptr<MapPreviewData>& preview)
+{
+	std::lock_guard lock(cache_mutex);
+	cache.emplace_front(key, preview);
+	if (cache.size() > CACHE_SIZE)
+		cache.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each [T] struct in [mc]
+// -----------------------------------------------------------------------------
+template<typename T, typename F> void forEachStruct(const MemChunk& mc, F func)
+{
+	T        value;
+	unsigned count = mc.size() / sizeof(T);
+	for (unsigned a = 0; a < count; ++a)
+	{
+		memcpy(&value, mc.data() + a * sizeof(T), sizeof(T));
+		func(value);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reads non-UDMF map data from [source] into [data]
+// -----------------------------------------------------------------------------
+bool readBinaryMap(const Source& source, MapPreviewData& data)
+{
+	// Can't open a map without vertices or lines
+	if (!source.vertexes.hasData() || !source.linedefs.hasData())
+		return false;
+
+	// Vertices
+	if (source.format == MapFormat::Doom64)
+		forEachStruct<Doom64MapFormat::Vertex>(source.vertexes, [&](const Doom64MapFormat::Vertex& v) {
+			data.verts.push_back({ static_cast<double>(v.x) / 65536, static_cast<double>(v.y) / 65536 });
+		});
+	else
+		forEachStruct<DoomMapFormat::Vertex>(source.vertexes, [&](const DoomMapFormat::Vertex& v) {
+			data.verts.push_back({ static_cast<double>(v.x), static_cast<double>(v.y) });
+		});
+
+	// Lines
+	if (source.format == MapFormat::Doom)
+		forEachStruct<DoomMapFormat::LineDef>(source.linedefs, [&](const DoomMapFormat::LineDef& l) {
+			data.lines.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0 });
+		});
+	else if (source.format == MapFormat::Doom64)
+		forEachStruct<Doom64MapFormat::LineDef>(source.linedefs, [&](const Doom64MapFormat::LineDef& l) {
+			bool macro = l.type > 0 && (l.type & 0x100);
+			data.lines.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0 && !macro, macro });
+		});
+	else if (source.format == MapFormat::Hexen)
+		forEachStruct<HexenMapFormat::LineDef>(source.linedefs, [&](const HexenMapFormat::LineDef& l) {
+			data.lines.push_back({ l.vertex1, l.vertex2, l.side2 != 0xFFFF, l.type > 0 });
+		});
+
+	// Things
+	if (source.format == MapFormat::Doom)
+		forEachStruct<DoomMapFormat::Thing>(
+			source.things, [&](const DoomMapFormat::Thing& t) { data.things.push_back({ 1. * t.x, 1. * t.y }); });
+	else if (source.format == MapFormat::Doom64)
+		forEachStruct<Doom64MapFormat::Thing>(
+			source.things, [&](const Doom64MapFormat::Thing& t) { data.things.push_back({ 1. * t.x, 1. * t.y }); });
+	else if (source.format == MapFormat::Hexen)
+		forEachStruct<HexenMapFormat::Thing>(
+			source.things, [&](const HexenMapFormat::Thing& t) { data.things.push_back({ 1. * t.x, 1. * t.y }); });
+
+	// Sides & sectors (count only)
+	if (source.sidedefs.hasData() && source.sectors.hasData())
+	{
+		// Doom/Hexen map
+		if (source.format != MapFormat::Doom64)
+		{
+			data.n_sides   = source.sidedefs.size() / 30;
+			data.n_sectors = source.sectors.size() / 26;
+		}
+
+		// Doom64 map
+		else
+		{
+			data.n_sides   = source.sidedefs.size() / 12;
+			data.n_sectors = source.sectors.size() / 16;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Skips tokens in [tz] up to and including [end] (or the end of the data)
+// -----------------------------------------------------------------------------
+void skipPast(Tokenizer& tz, string& token, const char* end)
+{
+	do
+	{
+		token = tz.getToken();
+	} while (token != end && !token.empty());
+}
+
+// -----------------------------------------------------------------------------
+// Reads the [x] and [y] properties of the UDMF block currently being read in
+// [tz], returns false if they weren't both found
+// -----------------------------------------------------------------------------
+bool readUDMFPosition(Tokenizer& tz, double& x, double& y)
+{
+	bool   gotx = false;
+	bool   goty = false;
+	string token;
+	do
+	{
+		token = tz.getToken();
+		if (strutil::equalCI(token, "x") || strutil::equalCI(token, "y"))
+		{
+			bool isx = strutil::equalCI(token, "x");
+			if (tz.getToken() != "=")
+				return false;
+			if (isx)
+				x = tz.getDouble(), gotx = true;
+			else
+				y = tz.getDouble(), goty = true;
+
+			// Skip to end of declaration after each key
+			skipPast(tz, token, ";");
+		}
+	} while (token != "}" && !token.empty());
+
+	return gotx && goty;
+}
+
+// -----------------------------------------------------------------------------
+// Reads UDMF map data from [source] into [data]
+// -----------------------------------------------------------------------------
+bool readUDMFMap(const Source& source, MapPreviewData& data, const Job* job)
+{
+	if (!source.textmap.hasData())
+		return false;
+
+	Tokenizer tz;
+	tz.openMem(source.textmap, source.name);
+
+	auto token = tz.getToken();
+	while (!token.empty())
+	{
+		if (job && job->cancelled())
+			return false;
+
+		if (strutil::equalCI(token, "namespace"))
+		{
+			// Skip till we reach the ';'
+			skipPast(tz, token, ";");
+		}
+		else if (strutil::equalCI(token, "vertex"))
+		{
+			double x = 0., y = 0.;
+			if (!readUDMFPosition(tz, x, y))
+			{
+				log::error("Invalid vertex {} in UDMF map data", data.verts.size());
+				return false;
+			}
+			data.verts.push_back({ x, y });
+		}
+		else if (strutil::equalCI(token, "linedef"))
+		{
+			MapPreviewData::Line line;
+			bool                 gotv1 = false, gotv2 = false;
+			do
+			{
+				token = tz.getToken();
+				if (strutil::equalCI(token, "v1") || strutil::equalCI(token, "v2"))
+				{
+					bool isv1 = strutil::equalCI(token, "v1");
+					if (tz.getToken() != "=")
+					{
+						log::error("Bad syntax for linedef {} in UDMF map data", data.lines.size());
+						return false;
+					}
+					if (isv1)
+						line.v1 = tz.getInteger(), gotv1 = true;
+					else
+						line.v2 = tz.getInteger(), gotv2 = true;
+					skipPast(tz, token, ";");
+				}
+				else if (strutil::equalCI(token, "special"))
+				{
+					line.special = true;
+					skipPast(tz, token, ";");
+				}
+				else if (strutil::equalCI(token, "sideback"))
+				{
+					line.twosided = true;
+					skipPast(tz, token, ";");
+				}
+			} while (token != "}" && !token.empty());
+
+			if (!gotv1 || !gotv2)
+			{
+				log::error("Invalid line {} in UDMF map data", data.lines.size());
+				return false;
+			}
+			data.lines.push_back(line);
+		}
+		else if (strutil::equalCI(token, "thing"))
+		{
+			double x = 0., y = 0.;
+			if (!readUDMFPosition(tz, x, y))
+			{
+				log::error("Invalid thing {} in UDMF map data", data.things.size());
+				return false;
+			}
+			data.things.push_back({ x, y });
+		}
+		else
+		{
+			// Check for side or sector definition (increase counts)
+			if (strutil::equalCI(token, "sidedef"))
+				data.n_sides++;
+			else if (strutil::equalCI(token, "sector"))
+				data.n_sectors++;
+
+			// Map preview ignores sidedefs, sectors, comments,
+			// unknown fields, etc. so skip to end of block
+			skipPast(tz, token, "}");
+		}
+
+		// Iterate to next token
+		token = tz.getToken();
+	}
+
+	return true;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// MapPreview Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Gets the data needed to read a preview of [map] into [source].
+// Must be called on the main thread, since entry data may need to be loaded.
+// Returns false if the map couldn't be found
+// -----------------------------------------------------------------------------
+bool mappreview::getSource(Archive::MapDesc map, Source& source)
+{
+	auto head = map.head.lock();
+	if (!head)
+		return false;
+
+	// Check if this map is a pk3 map, if so open the wad temporarily to get its
+	// map data
+	unique_ptr<Archive> temp_archive;
+	if (map.archive)
+	{
+		temp_archive = std::make_unique<WadArchive>();
+		if (!temp_archive->open(head->data()))
+			return false;
+
+		auto maps = temp_archive->detectMaps();
+		if (maps.empty())
+			return false;
+
+		map  = maps[0];
+		head = map.head.lock();
+	}
+
+	source.name   = head->name();
+	source.format = map.format;
+
+	// Get data for the map entries
+	auto end = map.end.lock().get();
+	for (auto entry = head.get(); entry; entry = entry->nextEntry())
+	{
+		auto type = entry->type();
+		if (type == EntryType::fromId("map_vertexes"))
+			source.vertexes.importShared(entry->data());
+		else if (type == EntryType::fromId("map_linedefs"))
+			source.linedefs.importShared(entry->data());
+		else if (type == EntryType::fromId("map_things"))
+			source.things.importShared(entry->data());
+		else if (type == EntryType::fromId("map_sidedefs"))
+			source.sidedefs.importShared(entry->data());
+		else if (type == EntryType::fromId("map_sectors"))
+			source.sectors.importShared(entry->data());
+		else if (type == EntryType::fromId("udmf_textmap"))
+			source.textmap.importShared(entry->data());
+
+		// Exit loop if we've reached the end of the map entries
+		if (entry == end)
+			break;
+	}
+
+	if (temp_archive)
+		temp_archive->close();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the map preview for [source], or gets it from the cache if it has
+// already been read. Can be called from any thread; if [job] is given, reading
+// stops if it is cancelled.
+// Returns nullptr if the map data was invalid (or reading was cancelled)
+// -----------------------------------------------------------------------------
+shared_ptr<const MapPreviewData> mappreview::read(const Source& source, const Job* job)
+{
+	auto key = sourceKey(source);
+	if (auto cached = cachedPreview(key))
+		return cached;
+
+	auto data = std::make_shared<MapPreviewData>();
+	bool ok   = source.format == MapFormat::UDMF ? readUDMFMap(source, *data, job) : readBinaryMap(source, *data);
+	if (!ok || (job && job->cancelled()))
+		return nullptr;
+
+	// Count attached vertices
+	vector<bool> used(data->verts.size());
+	for (const auto& line : data->lines)
+	{
+		if (line.v1 < used.size())
+			used[line.v1] = true;
+		if (line.v2 < used.size())
+			used[line.v2] = true;
+	}
+	data->n_vertices = static_cast<unsigned>(std::count(used.begin(), used.end(), true));
+
+	// Find extents
+	if (!data->verts.empty())
+	{
+		data->min = { data->verts[0].x, data->verts[0].y };
+		data->max = data->min;
+		for (const auto& vert : data->verts)
+		{
+			data->min.x = std::min(data->min.x, vert.x);
+			data->min.y = std::min(data->min.y, vert.y);
+			data->max.x = std::max(data->max.x, vert.x);
+			data->max.y = std::max(data->max.y, vert.y);
+		}
+	}
+
+	cachePreview(key, data);
+
+	return data;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Archive/Archive.h"
+
+namespace slade
+{
+class Job;
+
+// Basic geometry of a map (vertices, lines and things), as shown in map
+// previews
+struct MapPreviewData
+{
+	struct Vertex
+	{
+		double x = 0.;
+		double y = 0.;
+	};
+
+	struct Line
+	{
+		unsigned v1       = 0;
+		unsigned v2       = 0;
+		bool     twosided = false;
+		bool     special  = false;
+		bool     macro    = false;
+	};
+
+	struct Thing
+	{
+		double x = 0.;
+		double y = 0.;
+	};
+
+	vector<Vertex> verts;
+	vector<Line>   lines;
+	vector<Thing>  things;
+	unsigned       n_vertices = 0; // Number of vertices attached to lines
+	unsigned       n_sides    = 0;
+	unsigned       n_sectors  = 0;
+	Vec2d          min;
+	Vec2d          max;
+
+	unsigned width() const { return static_cast<unsigned>(max.x - min.x); }
+	unsigned height() const { return static_cast<unsigned>(max.y - min.y); }
+};
+
+namespace mappreview
+{
+	// The data needed to read a map preview. The data is shared (copy-on-write)
+	// with the map's entries so it can be read on any thread
+	struct Source
+	{
+		string    name;
+		MapFormat format = MapFormat::Unknown;
+		MemChunk  vertexes;
+		MemChunk  linedefs;
+		MemChunk  things;
+		MemChunk  sidedefs;
+		MemChunk  sectors;
+		MemChunk  textmap;
+	};
+
+	bool getSource(Archive::MapDesc map, Source& source);
+
+	shared_ptr<const MapPreviewData> read(const Source& source, const Job* job = nullptr);
+} // namespace mappreview
+} // namespace slade
@@ -0,0 +1,115 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapSnapshot.cpp
+// Description: MapSnapshot class, a read-only copy of the state of a map's
+//              objects at a point in time
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapSnapshot.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// MapSnapshot Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the snapshot objects of [type]
+// -----------------------------------------------------------------------------
+const vector<MapSnapshot::Object>& MapSnapshot::objects(MapObject::Type type) const
+{
+	static vector<Object> none;
+
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return vertices_;
+	case MapObject::Type::Line:   return lines_;
+	case MapObject::Type::Side:   return sides_;
+	case MapObject::Type::Sector: return sectors_;
+	case MapObject::Type::Thing:  return things_;
+	default:                      return none;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the snapshot of the object of [type] at [index], or nullptr if
+// [index] is out of range
+// -----------------------------------------------------------------------------
+const MapObject::Backup* MapSnapshot::object(MapObject::Type type, unsigned index) const
+{
+	auto& list = objects(type);
+	return index < list.size() ? list[index].get() : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the snapshot of the object with [id] (eg. a line's vertex or side
+// references), or nullptr if it wasn't in the map
+// -----------------------------------------------------------------------------
+const MapObject::Backup* MapSnapshot::objectById(unsigned id) const
+{
+	buildIndex();
+
+	auto i = index_by_id_.find(id);
+	return i != index_by_id_.end() ? object(i->second.first, i->second.second) : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the object with [id], or -1 if it wasn't in the map
+// -----------------------------------------------------------------------------
+int MapSnapshot::indexOf(unsigned id) const
+{
+	buildIndex();
+
+	auto i = index_by_id_.find(id);
+	return i != index_by_id_.end() ? static_cast<int>(i->second.second) : -1;
+}
+
+// -----------------------------------------------------------------------------
+// Builds the object id lookup, if it hasn't been already.
+// Safe to call from multiple threads at once
+// -----------------------------------------------------------------------------
+void MapSnapshot::buildIndex() const
+{
+	std::call_once(index_flag_, [this]() {
+		for (auto type : { MapObject::Type::Vertex,
+						   MapObject::Type::Line,
+						   MapObject::Type::Side,
+						   MapObject::Type::Sector,
+						   MapObject::Type::Thing })
+		{
+			auto& list = objects(type);
+			for (unsigned a = 0; a < list.size(); ++a)
+				index_by_id_[list[a]->id] = { type, a };
+		}
+	});
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "MapObject/MapObject.h"
+#include <mutex>
+
+namespace slade
+{
+// A read-only copy of the state of all objects in a map at a point in time,
+// for use by background work while the map itself continues to be edited.
+// Each object is stored as a MapObject::Backup (in index order), and backups
+// of objects unchanged between snapshots are shared rather than copied again
+// (see MapObjectCollection::snapshot)
+class MapSnapshot
+{
+public:
+	using Object = shared_ptr<const MapObject::Backup>;
+
+	MapSnapshot(unsigned long modification_count) : modification_count_{ modification_count } {}
+	~MapSnapshot() = default;
+
+	unsigned long modificationCount() const { return modification_count_; }
+
+	const vector<Object>& vertices() const { return vertices_; }
+	const vector<Object>& lines() const { return lines_; }
+	const vector<Object>& sides() const { return sides_; }
+	const vector<Object>& sectors() const { return sectors_; }
+	const vector<Object>& things() const { return things_; }
+
+	const vector<Object>&    objects(MapObject::Type type) const;
+	const MapObject::Backup* object(MapObject::Type type, unsigned index) const;
+	const MapObject::Backup* objectById(unsigned id) const;
+	int                      indexOf(unsigned id) const;
+
+private:
+	friend class MapObjectCollection;
+
+	unsigned long  modification_count_ = 0; // MapObject::modificationCount when the snapshot was taken
+	vector<Object> vertices_;
+	vector<Object> lines_;
+	vector<Object> sides_;
+	vector<Object> sectors_;
+	vector<Object> things_;
+
+	// Object id -> (type, index) lookup, built when first needed
+	mutable std::once_flag                                                     index_flag_;
+	mutable std::unordered_map<unsigned, std::pair<MapObject::Type, unsigned>> index_by_id_;
+
+	void buildIndex() const;
+};
+} // namespace slade
@@ -32,6 +32,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "MapSpecials.h"
+#include "App.h"
 #include "Game/Configuration.h"
 #include "SLADEMap.h"
 #include "Utility/MathStuff.h"
@@ -52,6 +53,44 @@ const double TAU = math::PI * 2; // Number of radians in the unit circle
 } // namespace
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if things of [type] are used for slopes
+// -----------------------------------------------------------------------------
+bool isSlopeThing(int type)
+{
+	switch (type)
+	{
+	case 1500:
+	case 1501:
+	case 1504:
+	case 1505:
+	case 9500:
+	case 9501:
+	case 9502:
+	case 9503:
+	case 9510:
+	case 9511: return true;
+	default: return false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Returns the number of each type of object in [map]
+// -----------------------------------------------------------------------------
+vector<size_t> objectCounts(SLADEMap* map)
+{
+	return { map->nVertices(), map->nLines(), map->nSides(), map->nSectors(), map->nThings() };
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MapSpecials Class Functions
@@ -66,19 +105,60 @@ void MapSpecials::reset()
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+	++colours_updated_;
+
+	processed_port_.clear();
+	processed_time_ = -1;
+	processed_counts_.clear();
+	dirty_.clear();
+	copy_tags_.clear();
+	sector_links_.clear();
+	thing_targets_.clear();
+	line_sectors_.clear();
+	sector_tags_.clear();
 }
 
 // -----------------------------------------------------------------------------
-// Process map specials, depending on the current game/port
+// Process map specials, depending on the current game/port.
+// If the map was processed before, only the sectors affected by objects
+// modified since then are recomputed
 // -----------------------------------------------------------------------------
-void MapSpecials::processMapSpecials(SLADEMap* map) const
+void MapSpecials::processMapSpecials(SLADEMap* map)
 {
-	// ZDoom
-	if (game::configuration().currentPort() == "zdoom")
-		processZDoomMapSpecials(map);
-	// Eternity, currently no need for processEternityMapSpecials
-	else if (game::configuration().currentPort() == "eternity")
-		processEternitySlopes(map);
+	auto& port = game::configuration().currentPort();
+	if (port != "zdoom" && port != "eternity")
+		return;
+
+	// Nothing to do if the map hasn't changed since it was last processed
+	bool same_map = port == processed_port_ && objectCounts(map) == processed_counts_;
+	if (same_map && MapObject::modificationCount() == processed_count_)
+		return;
+
+	auto process = [this, map, &port]() {
+		// ZDoom
+		if (port == "zdoom")
+			processZDoomMapSpecials(map);
+		// Eternity, currently no need for processEternityMapSpecials
+		else
+			processEternitySlopes(map);
+	};
+
+	auto time    = app::runTimer();
+	bool partial = same_map && findDirtySectors(map);
+	if (!partial)
+		clearDependencies(map);
+	process();
+
+	// If a special now depends on a sector that wasn't recomputed, its result
+	// may be wrong so everything needs to be recomputed
+	if (partial && link_escaped_)
+	{
+		log::info(3, "Slope dependencies changed, recomputing all slopes");
+		clearDependencies(map);
+		process();
+	}
+
+	recordState(map, time);
 }
 
 // -----------------------------------------------------------------------------
@@ -176,11 +256,227 @@ void MapSpecials::updateTaggedSectors(SLADEMap* map)
 		setModified(map, sector_fadecolours_[a].tag);
 }
 
+// -----------------------------------------------------------------------------
+// Records a dependency between the slopes of [sector1] and [sector2], so that
+// both are recomputed if either is affected by a change
+// -----------------------------------------------------------------------------
+void MapSpecials::addLink(const MapSector* sector1, const MapSector* sector2)
+{
+	if (!sector1 || !sector2 || sector1 == sector2)
+		return;
+
+	// When recomputing, links between sectors that aren't being recomputed are
+	// already recorded, and a link to one of them from a recomputed sector
+	// means the recomputed result can't be trusted
+	auto index1 = sector1->index();
+	auto index2 = sector2->index();
+	if (!dirty_.empty() && dirty_[index1] != dirty_[index2])
+		link_escaped_ = true;
+	if (!dirty_.empty() && !dirty_[index1])
+		return;
+
+	auto& links = sector_links_[index1];
+	if (std::find(links.begin(), links.end(), index2) == links.end())
+	{
+		links.push_back(index2);
+		sector_links_[index2].push_back(index1);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Records that [thing] affects the slopes of [target]
+// -----------------------------------------------------------------------------
+void MapSpecials::addThingTarget(const MapThing* thing, const MapSector* target)
+{
+	if (target && isDirty(target))
+		thing_targets_[thing->index()].push_back(target->index());
+}
+
+// -----------------------------------------------------------------------------
+// Records that [target] copies slopes from the first sector with [tag]
+// -----------------------------------------------------------------------------
+void MapSpecials::addCopyTag(int tag, const MapSector* target)
+{
+	if (target && isDirty(target))
+		copy_tags_[tag].push_back(target->index());
+}
+
+// -----------------------------------------------------------------------------
+// Clears all recorded slope dependencies in [map], for recomputing all slopes
+// -----------------------------------------------------------------------------
+void MapSpecials::clearDependencies(SLADEMap* map)
+{
+	dirty_.clear();
+	link_escaped_ = false;
+	copy_tags_.clear();
+	sector_links_.assign(map->nSectors(), {});
+	thing_targets_.assign(map->nThings(), {});
+}
+
+// -----------------------------------------------------------------------------
+// Finds all sectors in [map] with slopes that may be affected by objects
+// modified since specials were last processed, along with any sectors their
+// slopes depend on. Returns false if all slopes should be recomputed instead
+// -----------------------------------------------------------------------------
+bool MapSpecials::findDirtySectors(SLADEMap* map)
+{
+	vector<unsigned> seeds;
+	auto             add_sector = [&seeds](const MapSector* sector) {
+		if (sector)
+			seeds.push_back(sector->index());
+	};
+	auto add_line = [this, &seeds, &add_sector](const MapLine* line) {
+		add_sector(line->frontSector());
+		add_sector(line->backSector());
+
+		// Also the sectors the line was in when last processed
+		auto [front, back] = line_sectors_[line->index()];
+		if (front >= 0)
+			seeds.push_back(front);
+		if (back >= 0)
+			seeds.push_back(back);
+	};
+
+	// Geometry changes
+	for (unsigned a = 0; a < map->nVertices(); a++)
+	{
+		auto vertex = map->vertex(a);
+		if (vertex->modifiedTime() >= processed_time_)
+			for (auto line : vertex->connectedLines())
+				add_line(line);
+	}
+	for (unsigned a = 0; a < map->nLines(); a++)
+	{
+		auto line = map->line(a);
+		if (line->modifiedTime() >= processed_time_)
+			add_line(line);
+	}
+	for (unsigned a = 0; a < map->nSides(); a++)
+	{
+		auto side = map->side(a);
+		if (side->modifiedTime() >= processed_time_ && side->parentLine())
+			add_line(side->parentLine());
+	}
+
+	// Sector changes, including any sectors copying slopes by its old or new tag
+	for (unsigned a = 0; a < map->nSectors(); a++)
+	{
+		auto sector = map->sector(a);
+		if (sector->modifiedTime() < processed_time_)
+			continue;
+
+		seeds.push_back(a);
+		for (auto tag : { sector_tags_[a], sector->tag() })
+			if (auto copies = copy_tags_.find(tag); copies != copy_tags_.end())
+				seeds.insert(seeds.end(), copies->second.begin(), copies->second.end());
+	}
+
+	// Thing changes, affecting the sectors the thing used to affect and any
+	// it could affect now
+	for (unsigned a = 0; a < map->nThings(); a++)
+	{
+		auto thing = map->thing(a);
+		if (thing->modifiedTime() < processed_time_)
+			continue;
+
+		seeds.insert(seeds.end(), thing_targets_[a].begin(), thing_targets_[a].end());
+		if (!isSlopeThing(thing->type()))
+			continue;
+
+		add_sector(map->thingSector(thing));
+		if (thing->type() == 9500 || thing->type() == 9501)
+		{
+			for (auto line : map->lines().allWithId(thing->arg(0)))
+				add_line(line);
+		}
+		else if (thing->type() == 1504 || thing->type() == 1505)
+		{
+			if (auto vertex = map->vertices().vertexAt(thing->xPos(), thing->yPos()))
+				for (auto line : vertex->connectedLines())
+					add_line(line);
+		}
+	}
+
+	// Add all sectors linked to the changed sectors
+	dirty_.assign(map->nSectors(), 0);
+	unsigned n_dirty = 0;
+	while (!seeds.empty())
+	{
+		auto index = seeds.back();
+		seeds.pop_back();
+		if (dirty_[index])
+			continue;
+
+		dirty_[index] = 1;
+		seeds.insert(seeds.end(), sector_links_[index].begin(), sector_links_[index].end());
+		++n_dirty;
+	}
+
+	// Not worth it if most of the map needs recomputing anyway
+	if (n_dirty * 2 > map->nSectors())
+		return false;
+
+	// Remove the dirty sectors from the recorded dependencies, they will be
+	// recorded again when recomputed
+	auto remove_dirty = [this](vector<unsigned>& list) {
+		list.erase(
+			std::remove_if(list.begin(), list.end(), [this](unsigned index) { return dirty_[index] != 0; }),
+			list.end());
+	};
+	for (auto& targets : thing_targets_)
+		remove_dirty(targets);
+	for (auto& copies : copy_tags_)
+		remove_dirty(copies.second);
+	dirty_bbox_.reset();
+	for (unsigned a = 0; a < map->nSectors(); a++)
+	{
+		if (!dirty_[a])
+			continue;
+
+		sector_links_[a].clear();
+		auto bbox = map->sector(a)->boundingBox();
+		dirty_bbox_.extend(bbox.min);
+		dirty_bbox_.extend(bbox.max);
+	}
+
+	link_escaped_ = false;
+	log::info(3, "Recomputing slopes for {} changed sectors", n_dirty);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Records the current state of [map] after processing specials at [time], to
+// find what changed next time
+// -----------------------------------------------------------------------------
+void MapSpecials::recordState(SLADEMap* map, long time)
+{
+	dirty_.clear();
+	link_escaped_     = false;
+	processed_port_   = game::configuration().currentPort();
+	processed_time_   = time;
+	processed_count_  = MapObject::modificationCount();
+	processed_counts_ = objectCounts(map);
+
+	line_sectors_.resize(map->nLines());
+	for (unsigned a = 0; a < map->nLines(); a++)
+	{
+		auto front       = map->line(a)->frontSector();
+		auto back        = map->line(a)->backSector();
+		line_sectors_[a] = { front ? static_cast<int>(front->index()) : -1,
+							 back ? static_cast<int>(back->index()) : -1 };
+	}
+
+	sector_tags_.resize(map->nSectors());
+	for (unsigned a = 0; a < map->nSectors(); a++)
+		sector_tags_[a] = map->sector(a)->tag();
+}
+
 // -----------------------------------------------------------------------------
 // Process ZDoom map specials, mostly to convert hexen specials to UDMF
 // counterparts
 // -----------------------------------------------------------------------------
-void MapSpecials::processZDoomMapSpecials(SLADEMap* map) const
+void MapSpecials::processZDoomMapSpecials(SLADEMap* map)
 {
 	// Line specials
 	for (unsigned a = 0; a < map->nLines(); a++)
@@ -222,9 +518,14 @@ void MapSpecials::processZDoomLineSpecial(MapLine* line) const
 		double alpha = (double)args[1] / 255.0;
 		string type  = (args[2] == 0) ? "translucent" : "add";
 
-		// Set transparency
+		// Set transparency (only if changed, to avoid marking the lines as
+		// modified every time specials are processed)
 		for (auto& l : tagged)
 		{
+			if (l->hasProp("alpha") && l->floatProperty("alpha") == alpha && l->hasProp("renderstyle")
+				&& l->stringProperty("renderstyle") == type)
+				continue;
+
 			l->setFloatProperty("alpha", alpha);
 			l->setStringProperty("renderstyle", type);
 
@@ -240,6 +541,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 {
 	sector_colours_.clear();
 	sector_fadecolours_.clear();
+	++colours_updated_;
 
 	if (!entry || entry->size() == 0)
 		return;
@@ -359,7 +661,7 @@ void MapSpecials::processACSScripts(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 // Process ZDoom slope specials
 // -----------------------------------------------------------------------------
-void MapSpecials::processZDoomSlopes(SLADEMap* map) const
+void MapSpecials::processZDoomSlopes(SLADEMap* map)
 {
 	// ZDoom has a variety of slope mechanisms, which must be evaluated in a
 	// specific order.
@@ -372,17 +674,15 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	//  - Plane_Copy, in line order
 
 	// First things first: reset every sector to flat planes
-	for (unsigned a = 0; a < map->nSectors(); a++)
-	{
-		auto target = map->sector(a);
-		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
-		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
-	}
+	resetPlanes(map);
 
 	// Floor/ceiling plane properties
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
-		auto target        = map->sector(a);
+		auto target = map->sector(a);
+		if (!isDirty(target))
+			continue;
+
 		auto floorplane    = Plane::flat(target->floor().height);
 		bool hasFloorplane = false;
 		// Check for floor plane.
@@ -445,37 +745,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	}
 
 	// Plane_Align (line special 181)
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 181)
-			continue;
-
-		auto sector1 = line->frontSector();
-		auto sector2 = line->backSector();
-		if (!sector1 || !sector2)
-		{
-			log::warning("Ignoring Plane_Align on one-sided line {}", line->index());
-			continue;
-		}
-		if (sector1 == sector2)
-		{
-			log::warning("Ignoring Plane_Align on line {}, which has the same sector on both sides", line->index());
-			continue;
-		}
-
-		int floor_arg = line->arg(0);
-		if (floor_arg == 1)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
-		else if (floor_arg == 2)
-			applyPlaneAlign<SurfaceType::Floor>(line, sector2, sector1);
-
-		int ceiling_arg = line->arg(1);
-		if (ceiling_arg == 1)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector1, sector2);
-		else if (ceiling_arg == 2)
-			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
-	}
+	processPlaneAlign(map);
 
 	// Line slope things (9500/9501), sector tilt things (9502/9503), and
 	// vavoom things (1500/1501), all in the same pass
@@ -507,8 +777,12 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 
 		if (thing->type() == 9510 || thing->type() == 9511)
 		{
-			auto target = map->sectors().atPos(thing->position());
-			if (!target)
+			// Only things within the sectors being recomputed can affect them
+			if (!dirty_.empty() && !dirty_bbox_.contains(thing->position()))
+				continue;
+
+			auto target = map->thingSector(thing);
+			if (!target || !isDirty(target))
 				continue;
 
 			// First argument is the tag of a sector whose slope should be copied
@@ -519,6 +793,8 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 				continue;
 			}
 
+			addThingTarget(thing, target);
+			addCopyTag(tag, target);
 			auto tagged_sector = map->sectors().firstWithId(tag);
 			if (!tagged_sector)
 			{
@@ -527,6 +803,7 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 				continue;
 			}
 
+			addLink(target, tagged_sector);
 			if (thing->type() == 9510)
 				target->setFloorPlane(tagged_sector->floor().plane);
 			else
@@ -553,6 +830,12 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 					vertex_floor_heights[vertex] = thing->zPos();
 				else if (thing->type() == 1505)
 					vertex_ceiling_heights[vertex] = thing->zPos();
+
+				for (auto line : vertex->connectedLines())
+				{
+					addThingTarget(thing, line->frontSector());
+					addThingTarget(thing, line->backSector());
+				}
 			}
 		}
 	}
@@ -564,6 +847,9 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
 		auto target = map->sector(a);
+		if (!isDirty(target))
+			continue;
+
 		vertices.clear();
 		target->putVertices(vertices);
 		if (vertices.size() != 3)
@@ -574,59 +860,13 @@ void MapSpecials::processZDoomSlopes(SLADEMap* map) const
 	}
 
 	// Plane_Copy
-	for (unsigned a = 0; a < map->nLines(); a++)
-	{
-		auto line = map->line(a);
-		if (line->special() != 118)
-			continue;
-
-		int  tag;
-		auto front = line->frontSector();
-		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-
-		// The fifth "share" argument copies from one side of the line to the
-		// other
-		if (front && back)
-		{
-			int share = line->arg(4);
-
-			if ((share & 3) == 1)
-				back->setFloorPlane(front->floor().plane);
-			else if ((share & 3) == 2)
-				front->setFloorPlane(back->floor().plane);
-
-			if ((share & 12) == 4)
-				back->setCeilingPlane(front->ceiling().plane);
-			else if ((share & 12) == 8)
-				front->setCeilingPlane(back->ceiling().plane);
-		}
-	}
+	processPlaneCopy(map);
 }
 
 // -----------------------------------------------------------------------------
 // Process Eternity slope specials
 // -----------------------------------------------------------------------------
-void MapSpecials::processEternitySlopes(SLADEMap* map) const
+void MapSpecials::processEternitySlopes(SLADEMap* map)
 {
 	// Eternity plans on having a few slope mechanisms,
 	// which must be evaluated in a specific order.
@@ -635,14 +875,36 @@ void MapSpecials::processEternitySlopes(SLADEMap* map) const
 	//  - Plane_Copy, in line order
 
 	// First things first: reset every sector to flat planes
+	resetPlanes(map);
+
+	// Plane_Align (line special 181)
+	processPlaneAlign(map);
+
+	// Plane_Copy
+	processPlaneCopy(map);
+}
+
+// -----------------------------------------------------------------------------
+// Resets all sectors in [map] being recomputed to flat planes
+// -----------------------------------------------------------------------------
+void MapSpecials::resetPlanes(SLADEMap* map) const
+{
 	for (unsigned a = 0; a < map->nSectors(); a++)
 	{
 		auto target = map->sector(a);
+		if (!isDirty(target))
+			continue;
+
 		target->setPlane<SurfaceType::Floor>(Plane::flat(target->planeHeight<SurfaceType::Floor>()));
 		target->setPlane<SurfaceType::Ceiling>(Plane::flat(target->planeHeight<SurfaceType::Ceiling>()));
 	}
+}
 
-	// Plane_Align (line special 181)
+// -----------------------------------------------------------------------------
+// Process Plane_Align (line special 181) on all lines in [map], in line order
+// -----------------------------------------------------------------------------
+void MapSpecials::processPlaneAlign(SLADEMap* map)
+{
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		auto line = map->line(a);
@@ -653,15 +915,22 @@ void MapSpecials::processEternitySlopes(SLADEMap* map) const
 		auto sector2 = line->backSector();
 		if (!sector1 || !sector2)
 		{
-			log::warning("Ignoring Plane_Align on one-sided line {}", line->index());
+			if (isDirty(sector1) || isDirty(sector2))
+				log::warning("Ignoring Plane_Align on one-sided line {}", line->index());
 			continue;
 		}
 		if (sector1 == sector2)
 		{
-			log::warning("Ignoring Plane_Align on line {}, which has the same sector on both sides", line->index());
+			if (isDirty(sector1))
+				log::warning(
+					"Ignoring Plane_Align on line {}, which has the same sector on both sides", line->index());
 			continue;
 		}
 
+		addLink(sector1, sector2);
+		if (!isDirty(sector1) && !isDirty(sector2))
+			continue;
+
 		int floor_arg = line->arg(0);
 		if (floor_arg == 1)
 			applyPlaneAlign<SurfaceType::Floor>(line, sector1, sector2);
@@ -674,44 +943,51 @@ void MapSpecials::processEternitySlopes(SLADEMap* map) const
 		else if (ceiling_arg == 2)
 			applyPlaneAlign<SurfaceType::Ceiling>(line, sector2, sector1);
 	}
+}
 
-	// Plane_Copy
-	vector<MapSector*> sectors;
+// -----------------------------------------------------------------------------
+// Process Plane_Copy (line special 118) on all lines in [map], in line order
+// -----------------------------------------------------------------------------
+void MapSpecials::processPlaneCopy(SLADEMap* map)
+{
 	for (unsigned a = 0; a < map->nLines(); a++)
 	{
 		auto line = map->line(a);
 		if (line->special() != 118)
 			continue;
 
-		int  tag;
 		auto front = line->frontSector();
 		auto back  = line->backSector();
-		if ((tag = line->arg(0)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(1)) && front)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
-		if ((tag = line->arg(2)) && back)
-		{
-			if (auto sector = map->sectors().firstWithId(tag))
-				front->setFloorPlane(sector->floor().plane);
-		}
-		if ((tag = line->arg(3)) && back)
-		{
+		if (!isDirty(front) && !isDirty(back))
+			continue;
+
+		// Copy to [target] from the first sector with [tag]
+		auto copy_plane = [this, map, front](MapSector* target, int tag, bool floor) {
+			if (!tag || !target || !front || !isDirty(front))
+				return;
+
+			addCopyTag(tag, front);
 			if (auto sector = map->sectors().firstWithId(tag))
-				front->setCeilingPlane(sector->ceiling().plane);
-		}
+			{
+				addLink(front, sector);
+				if (floor)
+					front->setFloorPlane(sector->floor().plane);
+				else
+					front->setCeilingPlane(sector->ceiling().plane);
+			}
+		};
+		copy_plane(front, line->arg(0), true);
+		copy_plane(front, line->arg(1), false);
+		copy_plane(back, line->arg(2), true);
+		copy_plane(back, line->arg(3), false);
 
 		// The fifth "share" argument copies from one side of the line to the
 		// other
 		if (front && back)
 		{
 			int share = line->arg(4);
+			if (share)
+				addLink(front, back);
 
 			if ((share & 3) == 1)
 				back->setFloorPlane(front->floor().plane);
@@ -726,7 +1002,6 @@ void MapSpecials::processEternitySlopes(SLADEMap* map) const
 	}
 }
 
-
 // -----------------------------------------------------------------------------
 // Applies a Plane_Align special on [line], to [target] from [model]
 // -----------------------------------------------------------------------------
@@ -774,7 +1049,7 @@ template<SurfaceType T> void MapSpecials::applyPlaneAlign(MapLine* line, MapSect
 // -----------------------------------------------------------------------------
 // Applies a line slope special on [thing], to its containing sector in [map]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing) const
+template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, MapThing* thing)
 {
 	int lineid = thing->arg(0);
 	if (!lineid)
@@ -797,17 +1072,19 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 			target = line->backSector();
 		else if (side > 0)
 			target = line->frontSector();
-		if (!target)
+		if (!target || !isDirty(target))
 			continue;
 
 		// Need to know the containing sector's height to find the thing's true height
 		if (!containing_sector)
 		{
-			containing_sector = map->sectors().atPos(thing->position());
+			containing_sector = map->thingSector(thing);
 			if (!containing_sector)
 				return;
 			thingz = containing_sector->plane<T>().heightAt(thing->position()) + thing->zPos();
 		}
+		addThingTarget(thing, target);
+		addLink(target, containing_sector);
 
 		// Three points: endpoints of the line, and the thing itself
 		auto  target_plane = target->plane<T>();
@@ -821,13 +1098,18 @@ template<SurfaceType T> void MapSpecials::applyLineSlopeThing(SLADEMap* map, Map
 // -----------------------------------------------------------------------------
 // Applies a tilt slope special on [thing], to its containing sector in [map]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, MapThing* thing) const
+template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, MapThing* thing)
 {
+	// Only things within the sectors being recomputed can affect them
+	if (!dirty_.empty() && !dirty_bbox_.contains(thing->position()))
+		return;
+
 	// TODO should this apply to /all/ sectors at this point, in the case of an
 	// intersection?
-	auto target = map->sectors().atPos(thing->position());
-	if (!target)
+	auto target = map->thingSector(thing);
+	if (!target || !isDirty(target))
 		return;
+	addThingTarget(thing, target);
 
 	// First argument is the tilt angle, but starting with 0 as straight down;
 	// subtracting 90 fixes that.
@@ -866,11 +1148,16 @@ template<SurfaceType T> void MapSpecials::applySectorTiltThing(SLADEMap* map, Ma
 // -----------------------------------------------------------------------------
 // Applies a vavoom slope special on [thing], to its containing sector in [map]
 // -----------------------------------------------------------------------------
-template<SurfaceType T> void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing) const
+template<SurfaceType T> void MapSpecials::applyVavoomSlopeThing(SLADEMap* map, MapThing* thing)
 {
-	auto target = map->sectors().atPos(thing->position());
-	if (!target)
+	// Only things within the sectors being recomputed can affect them
+	if (!dirty_.empty() && !dirty_bbox_.contains(thing->position()))
+		return;
+
+	auto target = map->thingSector(thing);
+	if (!target || !isDirty(target))
 		return;
+	addThingTarget(thing, target);
 
 	int              tid = thing->id();
 	vector<MapLine*> lines;
@@ -15,17 +15,18 @@ class MapSpecials
 public:
 	void reset();
 
-	void processMapSpecials(SLADEMap* map) const;
+	void processMapSpecials(SLADEMap* map);
 	void processLineSpecial(MapLine* line) const;
 
-	bool tagColour(int tag, ColRGBA* colour);
-	bool tagFadeColour(int tag, ColRGBA* colour);
-	bool tagColoursSet() const;
-	bool tagFadeColoursSet() const;
-	void updateTaggedSectors(SLADEMap* map);
+	bool          tagColour(int tag, ColRGBA* colour);
+	bool          tagFadeColour(int tag, ColRGBA* colour);
+	bool          tagColoursSet() const;
+	bool          tagFadeColoursSet() const;
+	unsigned long coloursUpdated() const { return colours_updated_; }
+	void          updateTaggedSectors(SLADEMap* map);
 
 	// ZDoom
-	void processZDoomMapSpecials(SLADEMap* map) const;
+	void processZDoomMapSpecials(SLADEMap* map);
 	void processZDoomLineSpecial(MapLine* line) const;
 	void updateZDoomSector(MapSector* line);
 	void processACSScripts(ArchiveEntry* entry);
@@ -42,15 +43,42 @@ private:
 
 	vector<SectorColour> sector_colours_;
 	vector<SectorColour> sector_fadecolours_;
+	unsigned long        colours_updated_ = 0; // Incremented when the sector colours above change
 
-	void processZDoomSlopes(SLADEMap* map) const;
-	void processEternitySlopes(SLADEMap* map) const;
+	// Slope dependencies, recorded when slopes are processed so that only the
+	// sectors affected by changes since then need to be recomputed next time
+	string                          processed_port_;
+	long                            processed_time_  = -1;
+	unsigned long                   processed_count_ = 0;
+	vector<size_t>                  processed_counts_; // Map object counts (by type)
+	vector<vector<unsigned>>        sector_links_;     // Sectors whose slopes depend on each other
+	vector<vector<unsigned>>        thing_targets_;    // Sectors affected by each thing
+	vector<std::pair<int, int>>     line_sectors_;     // Front and back sector index of each line
+	vector<int>                     sector_tags_;
+	std::map<int, vector<unsigned>> copy_tags_; // Sectors copying slopes from the first sector with each tag
+	vector<uint8_t>                 dirty_;     // Sectors being recomputed, all if empty
+	BBox                            dirty_bbox_;
+	bool                            link_escaped_ = false;
+
+	bool isDirty(const MapSector* sector) const { return dirty_.empty() || (sector && dirty_[sector->index()]); }
+	void addLink(const MapSector* sector1, const MapSector* sector2);
+	void addThingTarget(const MapThing* thing, const MapSector* target);
+	void addCopyTag(int tag, const MapSector* target);
+	void clearDependencies(SLADEMap* map);
+	bool findDirtySectors(SLADEMap* map);
+	void recordState(SLADEMap* map, long time);
+
+	void processZDoomSlopes(SLADEMap* map);
+	void processEternitySlopes(SLADEMap* map);
+	void resetPlanes(SLADEMap* map) const;
+	void processPlaneAlign(SLADEMap* map);
+	void processPlaneCopy(SLADEMap* map);
 
 	template<MapSector::SurfaceType>
 	void applyPlaneAlign(MapLine* line, MapSector* target, MapSector* model_sector) const;
-	template<MapSector::SurfaceType> void   applyLineSlopeThing(SLADEMap* map, MapThing* thing) const;
-	template<MapSector::SurfaceType> void   applySectorTiltThing(SLADEMap* map, MapThing* thing) const;
-	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(SLADEMap* map, MapThing* thing) const;
+	template<MapSector::SurfaceType> void   applyLineSlopeThing(SLADEMap* map, MapThing* thing);
+	template<MapSector::SurfaceType> void   applySectorTiltThing(SLADEMap* map, MapThing* thing);
+	template<MapSector::SurfaceType> void   applyVavoomSlopeThing(SLADEMap* map, MapThing* thing);
 	template<MapSector::SurfaceType> double vertexHeight(MapVertex* vertex, MapSector* sector) const;
 	template<MapSector::SurfaceType>
 	void applyVertexHeightSlope(MapSector* target, vector<MapVertex*>& vertices, VertexHeightMap& heights) const;
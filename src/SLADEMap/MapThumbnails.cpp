@@ -0,0 +1,485 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MapThumbnails.cpp
+// Description: Functions to render thumbnail images of all maps in one or more
+//              archives in parallel, either as individual images or combined
+//              into a single contact sheet image
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MapThumbnails.h"
+#include "App.h"
+#include "Archive/ArchiveManager.h"
+#include "General/ColourConfiguration.h"
+#include "General/Console.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "MainEditor/MainEditor.h"
+#include "MapPreviewData.h"
+#include "Utility/FileUtils.h"
+#include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+using namespace mapthumbnails;
+
+
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Float, map_image_thickness)
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// A map to generate a thumbnail for
+struct Thumbnail
+{
+	string             name;
+	mappreview::Source source;
+	vector<uint8_t>    pixels; // RGBA, only kept for contact sheets
+	unsigned           width  = 0;
+	unsigned           height = 0;
+	string             error;
+};
+
+// -----------------------------------------------------------------------------
+// Blends [colour] with [coverage] (0-1) onto the RGBA pixel at [pixel]
+// -----------------------------------------------------------------------------
+void blendPixel(uint8_t* pixel, const ColRGBA& colour, double coverage)
+{
+	auto alpha = colour.fa() * coverage;
+	pixel[0]   = static_cast<uint8_t>(pixel[0] + (colour.r - pixel[0]) * alpha);
+	pixel[1]   = static_cast<uint8_t>(pixel[1] + (colour.g - pixel[1]) * alpha);
+	pixel[2]   = static_cast<uint8_t>(pixel[2] + (colour.b - pixel[2]) * alpha);
+	pixel[3]   = static_cast<uint8_t>(pixel[3] + (255 - pixel[3]) * alpha);
+}
+
+// -----------------------------------------------------------------------------
+// Draws an antialiased line from [p1] to [p2] with [thickness] onto [pixels]
+// (RGBA, [width]x[height]). Steps along the line's major axis and only covers
+// the pixels within reach of the line on the minor axis, so long diagonal
+// lines don't have to check their whole bounding box
+// -----------------------------------------------------------------------------
+void drawLine(
+	vector<uint8_t>& pixels,
+	int              width,
+	int              height,
+	Vec2d            p1,
+	Vec2d            p2,
+	const ColRGBA&   colour,
+	double           thickness)
+{
+	auto dx     = p2.x - p1.x;
+	auto dy     = p2.y - p1.y;
+	auto len_sq = dx * dx + dy * dy;
+	auto radius = thickness * 0.5;
+	if (len_sq <= 0.)
+		return;
+
+	// Draws the coverage of the line at pixel [x,y]
+	auto plot = [&](int x, int y) {
+		if (x < 0 || y < 0 || x >= width || y >= height)
+			return;
+
+		auto cx       = x + 0.5;
+		auto cy       = y + 0.5;
+		auto t        = std::clamp(((cx - p1.x) * dx + (cy - p1.y) * dy) / len_sq, 0., 1.);
+		auto dist     = std::hypot(cx - (p1.x + t * dx), cy - (p1.y + t * dy));
+		auto coverage = std::min(radius + 0.5 - dist, 1.);
+		if (coverage > 0.)
+			blendPixel(pixels.data() + (y * width + x) * 4, colour, coverage);
+	};
+
+	auto x_major = std::abs(dx) >= std::abs(dy);
+	auto major   = x_major ? dx : dy;
+	auto span    = radius * std::sqrt(len_sq) / std::abs(major) + 1.;
+	auto start   = static_cast<int>(std::floor(std::min(x_major ? p1.x : p1.y, x_major ? p2.x : p2.y) - radius));
+	auto end     = static_cast<int>(std::ceil(std::max(x_major ? p1.x : p1.y, x_major ? p2.x : p2.y) + radius));
+	auto limit   = x_major ? width : height;
+	for (auto a = std::max(start, 0); a <= std::min(end, limit - 1); ++a)
+	{
+		// Position of the line on the minor axis at the centre of [a]
+		auto t      = std::clamp((a + 0.5 - (x_major ? p1.x : p1.y)) / major, 0., 1.);
+		auto centre = x_major ? p1.y + t * dy : p1.x + t * dx;
+		for (auto b = static_cast<int>(std::floor(centre - span)); b <= static_cast<int>(std::ceil(centre + span)); ++b)
+		{
+			if (x_major)
+				plot(a, b);
+			else
+				plot(b, a);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Draws the lines of map [data] to fit within [pixels] (RGBA, [width]x[height])
+// with [style], the same way map preview images are drawn
+// -----------------------------------------------------------------------------
+bool drawThumbnail(
+	const MapPreviewData& data,
+	const Style&          style,
+	unsigned              width,
+	unsigned              height,
+	vector<uint8_t>&      pixels)
+{
+	double map_width  = std::max(data.max.x - data.min.x, 1.);
+	double map_height = std::max(data.max.y - data.min.y, 1.);
+	if (data.lines.empty() || width == 0 || height == 0)
+		return false;
+
+	// Clear to background
+	pixels.resize(width * height * 4);
+	for (unsigned a = 0; a < width * height; ++a)
+	{
+		pixels[a * 4]     = style.background.r;
+		pixels[a * 4 + 1] = style.background.g;
+		pixels[a * 4 + 2] = style.background.b;
+		pixels[a * 4 + 3] = style.background.a;
+	}
+
+	// Zoom/offset to show full map (flipped vertically, map y goes up)
+	auto  scale    = std::min(width / map_width, height / map_height) * 0.95;
+	Vec2d centre   = { data.min.x + map_width * 0.5, data.min.y + map_height * 0.5 };
+	auto  to_image = [&](const MapPreviewData::Vertex& v) {
+		return Vec2d{ width * 0.5 + (v.x - centre.x) * scale, height * 0.5 - (v.y - centre.y) * scale };
+	};
+
+	// Draw lines, 2-sided first so 1-sided lines are drawn on top
+	auto nverts = data.verts.size();
+	for (auto twosided : { true, false })
+	{
+		for (const auto& line : data.lines)
+		{
+			if (line.twosided != twosided || line.v1 >= nverts || line.v2 >= nverts)
+				continue;
+
+			// Get colour
+			auto col = twosided ? style.line_2s : style.line_1s;
+			if (line.special)
+				col = style.line_special;
+			else if (line.macro)
+				col = style.line_macro;
+
+			auto p1 = to_image(data.verts[line.v1]);
+			auto p2 = to_image(data.verts[line.v2]);
+			drawLine(pixels, width, height, p1, p2, col, style.thickness);
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns thumbnails to generate for all maps in [archives], named
+// <archive>_<map>. Must be called on the main thread, since map data may need
+// to be loaded
+// -----------------------------------------------------------------------------
+vector<Thumbnail> mapThumbnails(const vector<Archive*>& archives)
+{
+	vector<Thumbnail>     thumbnails;
+	std::map<string, int> name_count;
+	for (auto archive : archives)
+	{
+		if (!archive)
+			continue;
+
+		string archive_name{ strutil::Path::fileNameOf(archive->filename(), false) };
+		for (auto& map : archive->detectMaps())
+		{
+			Thumbnail thumb;
+			thumb.name = fmt::format("{}_{}", archive_name, map.name);
+
+			// Make sure names are unique (eg. the same map in two archives with
+			// the same name)
+			auto count = ++name_count[strutil::lower(thumb.name)];
+			if (count > 1)
+				thumb.name += fmt::format("_{}", count);
+
+			if (!mappreview::getSource(map, thumb.source))
+				thumb.error = "Unable to read map data";
+
+			thumbnails.push_back(std::move(thumb));
+		}
+	}
+
+	return thumbnails;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [image] to [path] as a png image
+// -----------------------------------------------------------------------------
+bool writePng(SImage& image, const string& path)
+{
+	MemChunk png;
+	if (!SIFormat::getFormat("png")->saveImage(image, png))
+		return false;
+
+	return png.exportFile(path);
+}
+
+// -----------------------------------------------------------------------------
+// Combines all rendered [thumbnails] into a grid of [options].size sized cells
+// and writes it to [path] as a png image
+// -----------------------------------------------------------------------------
+bool writeContactSheet(
+	const vector<Thumbnail>& thumbnails,
+	unsigned                 count,
+	const Options&           options,
+	const ColRGBA&           background,
+	const string&            path)
+{
+	auto columns = options.columns > 0 ? options.columns : static_cast<unsigned>(std::ceil(std::sqrt(count)));
+	columns      = std::min(columns, count);
+	auto rows    = (count + columns - 1) / columns;
+	auto width   = columns * options.size;
+	auto height  = rows * options.size;
+
+	// Clear to background
+	vector<uint8_t> pixels(width * height * 4);
+	for (unsigned a = 0; a < width * height; ++a)
+	{
+		pixels[a * 4]     = background.r;
+		pixels[a * 4 + 1] = background.g;
+		pixels[a * 4 + 2] = background.b;
+		pixels[a * 4 + 3] = background.a;
+	}
+
+	// Copy each thumbnail into the centre of its cell
+	unsigned cell = 0;
+	for (const auto& thumb : thumbnails)
+	{
+		if (thumb.pixels.empty())
+			continue;
+
+		auto x = (cell % columns) * options.size + (options.size - thumb.width) / 2;
+		auto y = (cell / columns) * options.size + (options.size - thumb.height) / 2;
+		for (unsigned row = 0; row < thumb.height; ++row)
+			memcpy(
+				pixels.data() + ((y + row) * width + x) * 4,
+				thumb.pixels.data() + row * thumb.width * 4,
+				thumb.width * 4);
+
+		++cell;
+	}
+
+	SImage image;
+	image.setImageData(pixels, width, height, SImage::Type::RGBA);
+	return writePng(image, path);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Style Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns a thumbnail style from the current map image colour configuration
+// and line thickness
+// -----------------------------------------------------------------------------
+Style Style::fromConfig()
+{
+	Style style;
+	style.background   = colourconfig::colour("map_image_background");
+	style.line_1s      = colourconfig::colour("map_image_line_1s");
+	style.line_2s      = colourconfig::colour("map_image_line_2s");
+	style.line_special = colourconfig::colour("map_image_line_special");
+	style.line_macro   = colourconfig::colour("map_image_line_macro");
+	style.thickness    = map_image_thickness;
+	return style;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MapThumbnails Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Renders the lines of map [data] to [image] ([width]x[height], RGBA) with
+// [style]. Doesn't use OpenGL, so it can be called from any thread
+// -----------------------------------------------------------------------------
+bool mapthumbnails::render(
+	const MapPreviewData& data,
+	const Style&          style,
+	unsigned              width,
+	unsigned              height,
+	SImage&               image)
+{
+	vector<uint8_t> pixels;
+	if (!drawThumbnail(data, style, width, height, pixels))
+		return false;
+
+	return image.setImageData(pixels, width, height, SImage::Type::RGBA);
+}
+
+// -----------------------------------------------------------------------------
+// Generates thumbnail images of all maps in [archives], rendered in parallel.
+// If [output] is a .png file, the thumbnails are combined into a single
+// contact sheet image, otherwise each thumbnail is written to a png file
+// named <archive>_<map> in the [output] directory.
+// Returns the number of thumbnails generated, any maps that couldn't be
+// rendered are added to [errors] (one per line). Must be called on the main
+// thread
+// -----------------------------------------------------------------------------
+unsigned mapthumbnails::generate(
+	const vector<Archive*>& archives,
+	const string&           output,
+	const Options&          options,
+	string*                 errors)
+{
+	auto thumbnails    = mapThumbnails(archives);
+	auto style         = Style::fromConfig();
+	auto contact_sheet = strutil::endsWithCI(output, ".png");
+	if (thumbnails.empty() || options.size == 0)
+		return 0;
+
+	// Create output directory if needed
+	if (!contact_sheet && !fileutil::dirExists(output) && !fileutil::createDir(output))
+	{
+		if (errors)
+			*errors += fmt::format("Unable to create directory {}\n", output);
+		return 0;
+	}
+
+	// Read and render all maps
+	threadpool::parallelFor(thumbnails.size(), [&](size_t index) {
+		auto& thumb = thumbnails[index];
+		if (!thumb.error.empty())
+			return;
+
+		auto data    = mappreview::read(thumb.source);
+		thumb.source = {};
+		if (!data || data->lines.empty())
+		{
+			thumb.error = "Invalid map";
+			return;
+		}
+
+		// Fit to [size], keeping the map's aspect ratio
+		double map_width  = std::max(data->max.x - data->min.x, 1.);
+		double map_height = std::max(data->max.y - data->min.y, 1.);
+		auto   scale      = options.size / std::max(map_width, map_height);
+		thumb.width       = std::max(static_cast<unsigned>(map_width * scale), 1u);
+		thumb.height      = std::max(static_cast<unsigned>(map_height * scale), 1u);
+		if (!drawThumbnail(*data, style, thumb.width, thumb.height, thumb.pixels))
+		{
+			thumb.error = "Invalid map";
+			return;
+		}
+		if (contact_sheet)
+			return;
+
+		SImage image;
+		image.setImageData(thumb.pixels, thumb.width, thumb.height, SImage::Type::RGBA);
+		thumb.pixels.clear();
+		if (!writePng(image, fmt::format("{}/{}.png", output, thumb.name)))
+			thumb.error = "Unable to write image";
+	});
+
+	// Collect results
+	unsigned count = 0;
+	for (const auto& thumb : thumbnails)
+	{
+		if (thumb.error.empty())
+			++count;
+		else if (errors)
+			*errors += fmt::format("{}: {}\n", thumb.name, thumb.error);
+	}
+
+	// Write contact sheet
+	if (contact_sheet && count > 0 && !writeContactSheet(thumbnails, count, options, style.background, output))
+	{
+		if (errors)
+			*errors += fmt::format("Unable to write contact sheet {}\n", output);
+		return 0;
+	}
+
+	return count;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Generates thumbnails of all maps in the current archive (or all open
+// archives if 'all' is given) to the given directory, or a contact sheet if
+// the output is a .png file. An optional thumbnail size can also be given.
+// eg. 'map_thumbnails maps.png 256 all'
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(map_thumbnails, 1, true)
+{
+	Options          options;
+	vector<Archive*> archives;
+	auto             all = false;
+	for (unsigned a = 1; a < args.size(); ++a)
+	{
+		if (strutil::equalCI(args[a], "all"))
+			all = true;
+		else if (strutil::isInteger(args[a], false))
+			options.size = std::max(strutil::asInt(args[a]), 16);
+	}
+
+	if (all)
+	{
+		for (int a = 0; a < app::archiveManager().numArchives(); ++a)
+			archives.push_back(app::archiveManager().getArchive(a).get());
+	}
+	else if (maineditor::currentArchive())
+		archives.push_back(maineditor::currentArchive());
+
+	if (archives.empty())
+	{
+		log::console("No archive open");
+		return;
+	}
+
+	string errors;
+	auto   count = generate(archives, args[0], options, &errors);
+	if (!errors.empty())
+		log::warning(errors);
+	log::console(fmt::format("Generated {} map thumbnail{} to {}", count, count == 1 ? "" : "s", args[0]));
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Utility/Colour.h"
+
+namespace slade
+{
+class Archive;
+class SImage;
+struct MapPreviewData;
+
+namespace mapthumbnails
+{
+	// Colours and line thickness to draw map thumbnails with
+	struct Style
+	{
+		ColRGBA background;
+		ColRGBA line_1s;
+		ColRGBA line_2s;
+		ColRGBA line_special;
+		ColRGBA line_macro;
+		double  thickness = 1.5;
+
+		static Style fromConfig(); // From the map_image_* colours, main thread only
+	};
+
+	struct Options
+	{
+		unsigned size    = 512; // Max width/height of each thumbnail (in pixels)
+		unsigned columns = 0;   // Number of contact sheet columns, 0 to fit to a square
+	};
+
+	bool render(const MapPreviewData& data, const Style& style, unsigned width, unsigned height, SImage& image);
+
+	unsigned generate(
+		const vector<Archive*>& archives,
+		const string&           output,
+		const Options&          options = {},
+		string*                 errors  = nullptr);
+} // namespace mapthumbnails
+} // namespace slade
@@ -37,6 +37,7 @@
 #include "MapEditor/SectorBuilder.h"
 #include "MapFormat/MapFormatHandler.h"
 #include "Utility/MathStuff.h"
+#include <unordered_set>
 
 using namespace slade;
 
@@ -49,6 +50,49 @@ using namespace slade;
 CVAR(Bool, map_split_auto_offset, true, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a bounding box around [seg], expanded by [margin] on all sides
+// -----------------------------------------------------------------------------
+BBox nearBox(const Seg2d& seg, double margin)
+{
+	BBox bbox;
+	bbox.min = { seg.left() - margin, seg.top() - margin };
+	bbox.max = { seg.right() + margin, seg.bottom() + margin };
+	return bbox;
+}
+
+// -----------------------------------------------------------------------------
+// Returns all lines connected to any of [vertices] (each only once, in the
+// order found), where [n_lines] is the number of lines in the map
+// -----------------------------------------------------------------------------
+vector<MapLine*> connectedLines(const vector<MapVertex*>& vertices, size_t n_lines)
+{
+	vector<MapLine*> lines;
+	vector<uint8_t>  added(n_lines);
+	for (auto* vertex : vertices)
+	{
+		for (auto* line : vertex->connectedLines())
+		{
+			if (!added[line->index()])
+			{
+				added[line->index()] = 1;
+				lines.push_back(line);
+			}
+		}
+	}
+
+	return lines;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // SLADEMap Class Functions
@@ -158,6 +202,7 @@ bool SLADEMap::readMap(const Archive::MapDesc& map)
 
 	data_.sectors().initBBoxes();
 	data_.sectors().initPolygons();
+	data_.updateGeometry();
 	recomputeSpecials();
 
 	opened_time_ = app::runTimer() + 10;
@@ -171,13 +216,11 @@ bool SLADEMap::readMap(const Archive::MapDesc& map)
 void SLADEMap::clearMap()
 {
 	map_specials_.reset();
+	thing_sectors_.clear();
 
 	// Clear map objects
 	data_.clear();
 
-	// Clear usage counts
-	usage_thing_type_.clear();
-
 	// Clear UDMF extra entries
 	for (auto& entry : udmf_extra_entries_)
 		delete entry;
@@ -205,31 +248,111 @@ BBox SLADEMap::bounds(bool include_things)
 // -----------------------------------------------------------------------------
 void SLADEMap::updateGeometryInfo(long modified_time)
 {
+	// Defer until the current geometry edit ends
+	if (geometry_edit_depth_ > 0)
+	{
+		geometry_edit_time_ = std::min(geometry_edit_time_, modified_time);
+		return;
+	}
+
+	// Find affected lines and sectors first, so that each is only updated once
+	// no matter how many of its vertices were modified
+	vector<uint8_t>    line_updated(data_.lines().size());
+	vector<uint8_t>    sector_updated(data_.sectors().size());
+	vector<MapSector*> sectors;
+	auto               add_sector = [&](MapSector* sector) {
+		if (sector && !sector_updated[sector->index_])
+		{
+			sector_updated[sector->index_] = 1;
+			sectors.push_back(sector);
+		}
+	};
 	for (auto& vertex : data_.vertices())
 	{
-		if (vertex->modifiedTime() > modified_time)
+		if (vertex->modifiedTime() <= modified_time)
+			continue;
+
+		for (auto* line : vertex->connected_lines_)
 		{
-			for (auto* line : vertex->connected_lines_)
-			{
-				// Update line geometry
-				line->resetInternals();
+			if (line_updated[line->index_])
+				continue;
 
-				// Update front sector
-				if (line->frontSector())
-				{
-					line->frontSector()->resetPolygon();
-					line->frontSector()->updateBBox();
-				}
+			// Update line geometry
+			line->resetInternals();
+			line_updated[line->index_] = 1;
 
-				// Update back sector
-				if (line->backSector())
-				{
-					line->backSector()->resetPolygon();
-					line->backSector()->updateBBox();
-				}
-			}
+			add_sector(line->frontSector());
+			add_sector(line->backSector());
 		}
 	}
+
+	// Update sectors
+	for (auto* sector : sectors)
+	{
+		sector->resetPolygon();
+		sector->updateBBox();
+	}
+
+	// Rebuild search grids
+	data_.updateGeometry();
+}
+
+// -----------------------------------------------------------------------------
+// Begins a geometry edit transaction. Until the matching endGeometryEdit call,
+// connected lines/sides rebuilds and geometry info updates are deferred and
+// done once at the end for everything changed during the edit.
+// Transactions can be nested, only the outermost one applies the updates
+// -----------------------------------------------------------------------------
+void SLADEMap::beginGeometryEdit()
+{
+	if (geometry_edit_depth_++ > 0)
+		return;
+
+	geometry_edit_time_   = app::runTimer() - 1;
+	rebuild_lines_needed_ = false;
+	rebuild_sides_needed_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Ends the current geometry edit transaction, applying any deferred updates if
+// it was the outermost one
+// -----------------------------------------------------------------------------
+void SLADEMap::endGeometryEdit()
+{
+	if (geometry_edit_depth_ == 0 || --geometry_edit_depth_ > 0)
+		return;
+
+	if (rebuild_lines_needed_)
+		data_.rebuildConnectedLines();
+	if (rebuild_sides_needed_)
+		data_.rebuildConnectedSides();
+
+	updateGeometryInfo(geometry_edit_time_);
+	setGeometryUpdated();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the connected lines lists for all map vertices (deferred until the
+// end of the current geometry edit, if any)
+// -----------------------------------------------------------------------------
+void SLADEMap::rebuildConnectedLines()
+{
+	if (geometry_edit_depth_ > 0)
+		rebuild_lines_needed_ = true;
+	else
+		data_.rebuildConnectedLines();
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the connected sides lists for all map sectors (deferred until the
+// end of the current geometry edit, if any)
+// -----------------------------------------------------------------------------
+void SLADEMap::rebuildConnectedSides()
+{
+	if (geometry_edit_depth_ > 0)
+		rebuild_sides_needed_ = true;
+	else
+		data_.rebuildConnectedSides();
 }
 
 // -----------------------------------------------------------------------------
@@ -292,41 +415,21 @@ void SLADEMap::putThingsWithIdInSectorTag(int id, int tag, vector<MapThing*>& li
 		return;
 
 	// Find things with matching id contained in sector with matching tag
-	for (auto& thing : data_.things())
+	for (auto* thing : data_.things().allWithId(id))
 	{
-		if (thing->id() == id)
-		{
-			auto* sector = data_.sectors().atPos(thing->position());
-			if (sector && sector->id_ == tag)
-				list.push_back(thing);
-		}
+		auto* sector = thingSector(thing);
+		if (sector && sector->id_ == tag)
+			list.push_back(thing);
 	}
 }
 
 // -----------------------------------------------------------------------------
-// Gets dragon targets (needs better description)
+// Adds [first] and all things it leads to via the ids in their args to [list]
+// (ie. the targets of a dragon starting at [first])
 // -----------------------------------------------------------------------------
-void SLADEMap::putDragonTargets(MapThing* first, vector<MapThing*>& list)
+void SLADEMap::putDragonTargets(MapThing* first, vector<MapThing*>& list) const
 {
-	std::map<int, int> used;
-	list.clear();
-	list.push_back(first);
-	unsigned i = 0;
-	while (i < list.size())
-	{
-		string prop = "arg_";
-		for (int a = 0; a < 5; ++a)
-		{
-			prop[3] = ('0' + a);
-			int val = list[i]->intProperty(prop);
-			if (val && used[val] == 0)
-			{
-				used[val] = 1;
-				data_.things().putAllWithId(val, list);
-			}
-		}
-		++i;
-	}
+	data_.things().putDragonTargets(first, list);
 }
 
 // -----------------------------------------------------------------------------
@@ -470,6 +573,32 @@ MapSector* SLADEMap::lineSideSector(MapLine* line, bool front)
 	return nullptr;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the sector containing [thing], or null if it isn't in a sector.
+// The result is cached until the thing is modified or the map geometry changes
+// -----------------------------------------------------------------------------
+MapSector* SLADEMap::thingSector(const MapThing* thing) const
+{
+	if (!thing || thing->parentMap() != this)
+		return nullptr;
+
+	auto index = thing->index();
+	if (index >= thing_sectors_.size())
+		thing_sectors_.resize(std::max<size_t>(index + 1, data_.things().size()));
+
+	// Check the cached sector is still valid. Anything modified at the same
+	// time as it was found may have been modified after, so isn't trusted
+	auto& cached = thing_sectors_[index];
+	if (cached.thing == thing && thing->modifiedTime() < cached.time && geometry_updated_ < cached.time)
+		return cached.sector;
+
+	cached.thing  = thing;
+	cached.sector = data_.sectors().atPos(thing->position());
+	cached.time   = app::runTimer();
+
+	return cached.sector;
+}
+
 // -----------------------------------------------------------------------------
 // Returns true if any map object has been modified since it was opened or last
 // saved
@@ -803,24 +932,192 @@ MapLine* SLADEMap::splitLine(MapLine* line, MapVertex* vertex)
 // -----------------------------------------------------------------------------
 void SLADEMap::splitLinesAt(MapVertex* vertex, double split_dist)
 {
+	// Only lines near the vertex can be split by it
+	vector<MapLine*> lines;
+	data_.lines().putAllInBox(nearBox({ vertex->position_, vertex->position_ }, split_dist), lines);
+
 	// Check if this vertex splits any lines (if needed)
-	auto nlines = data_.lines().size();
-	for (unsigned i = 0; i < nlines; ++i)
+	for (auto* line : lines)
 	{
-		auto* line = this->line(i);
-
 		// Skip line if it shares the vertex
 		if (line->v1() == vertex || line->v2() == vertex)
 			continue;
 
 		if (line->distanceTo(vertex->position()) < split_dist)
 		{
-			log::info(2, "Vertex at ({:1.2f},{:1.2f}) splits line {}", vertex->position_.x, vertex->position_.y, i);
+			log::info(
+				2,
+				"Vertex at ({:1.2f},{:1.2f}) splits line {}",
+				vertex->position_.x,
+				vertex->position_.y,
+				line->index_);
 			splitLine(line, vertex);
 		}
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Splits lines at any vertices within [split_dist] of them, in bulk for a set
+// of (moved) [vertices] and their connected [lines]:
+// - Any line near one of [vertices] is split at that vertex
+// - Any of [lines] near any other vertex is split at that vertex, which is then
+//   added to [vertices]. New lines from these splits are added to [lines]
+//
+// Rather than checking each vertex against all lines and each line against all
+// vertices, [vertices] and [lines] are put in hash grids and candidates are
+// found with a single pass over all lines and all vertices
+// -----------------------------------------------------------------------------
+void SLADEMap::splitLinesNear(vector<MapVertex*>& vertices, vector<MapLine*>& lines, double split_dist)
+{
+	// Cells need to be much larger than the split distance, otherwise long
+	// lines would cover a huge number of cells
+	using CellMap          = std::unordered_map<uint64_t, vector<unsigned>>;
+	const double cell_size = 64.;
+
+	auto cell = [cell_size](double pos) { return static_cast<int>(std::floor(pos / cell_size)); };
+	auto key  = [](int x, int y) {
+		return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+	};
+
+	// Pieces each candidate line has been split into so far (including itself)
+	std::unordered_map<MapLine*, vector<MapLine*>> pieces;
+	auto pieces_of = [&pieces](MapLine* line) -> vector<MapLine*>& {
+		auto& list = pieces[line];
+		if (list.empty())
+			list.push_back(line);
+		return list;
+	};
+
+	// --- Split existing lines that vertices moved onto ---
+
+	// Hash the vertices
+	CellMap vertex_cells;
+	BBox    vertices_box;
+	for (unsigned a = 0; a < vertices.size(); ++a)
+	{
+		auto pos = vertices[a]->position_;
+		vertex_cells[key(cell(pos.x), cell(pos.y))].push_back(a);
+		if (a == 0)
+			vertices_box = nearBox({ pos, pos }, 0.);
+		else
+		{
+			vertices_box.min = { std::min(vertices_box.min.x, pos.x), std::min(vertices_box.min.y, pos.y) };
+			vertices_box.max = { std::max(vertices_box.max.x, pos.x), std::max(vertices_box.max.y, pos.y) };
+		}
+	}
+
+	// Find candidate lines for each vertex, in index order
+	vector<vector<MapLine*>> vertex_lines(vertices.size());
+	for (auto* line : data_.lines())
+	{
+		auto near = nearBox(line->seg(), split_dist);
+		if (vertices.empty() || near.max.x < vertices_box.min.x || near.min.x > vertices_box.max.x
+			|| near.max.y < vertices_box.min.y || near.min.y > vertices_box.max.y)
+			continue;
+
+		auto x1 = cell(std::max(near.min.x, vertices_box.min.x));
+		auto x2 = cell(std::min(near.max.x, vertices_box.max.x));
+		auto y1 = cell(std::max(near.min.y, vertices_box.min.y));
+		auto y2 = cell(std::min(near.max.y, vertices_box.max.y));
+		for (auto x = x1; x <= x2; ++x)
+			for (auto y = y1; y <= y2; ++y)
+			{
+				auto found = vertex_cells.find(key(x, y));
+				if (found == vertex_cells.end())
+					continue;
+
+				for (auto index : found->second)
+					if (near.contains(vertices[index]->position_))
+						vertex_lines[index].push_back(line);
+			}
+	}
+
+	// Split
+	for (unsigned a = 0; a < vertices.size(); ++a)
+	{
+		auto* vertex = vertices[a];
+		for (auto* candidate : vertex_lines[a])
+		{
+			auto& split = pieces_of(candidate);
+			for (unsigned p = 0; p < split.size(); ++p)
+			{
+				auto* line = split[p];
+
+				// Skip line if it shares the vertex
+				if (line->v1() == vertex || line->v2() == vertex)
+					continue;
+
+				if (line->distanceTo(vertex->position()) < split_dist)
+				{
+					log::info(
+						2,
+						"Vertex at ({:1.2f},{:1.2f}) splits line {}",
+						vertex->position_.x,
+						vertex->position_.y,
+						line->index_);
+					split.push_back(splitLine(line, vertex));
+					break;
+				}
+			}
+		}
+	}
+
+	// --- Split lines that moved onto existing vertices ---
+
+	// Hash the lines
+	CellMap line_cells;
+	BBox    lines_box;
+	for (unsigned a = 0; a < lines.size(); ++a)
+	{
+		auto near = nearBox(lines[a]->seg(), split_dist);
+		for (auto x = cell(near.min.x); x <= cell(near.max.x); ++x)
+			for (auto y = cell(near.min.y); y <= cell(near.max.y); ++y)
+				line_cells[key(x, y)].push_back(a);
+
+		if (a == 0)
+			lines_box = near;
+		else
+			lines_box.extend(near);
+	}
+
+	// Find candidate vertices for each line, in index order
+	vector<vector<MapVertex*>> line_vertices(lines.size());
+	for (auto* vertex : data_.vertices())
+	{
+		auto pos = vertex->position_;
+		if (lines.empty() || !lines_box.contains(pos))
+			continue;
+
+		auto found = line_cells.find(key(cell(pos.x), cell(pos.y)));
+		if (found == line_cells.end())
+			continue;
+
+		for (auto index : found->second)
+			if (nearBox(lines[index]->seg(), split_dist).contains(pos))
+				line_vertices[index].push_back(vertex);
+	}
+
+	// Split. Lines split off a candidate line are checked against the same
+	// candidate vertices afterwards
+	for (unsigned a = 0; a < lines.size(); ++a)
+	{
+		auto candidates = line_vertices[a];
+		for (auto* vertex : candidates)
+		{
+			// Skip line if it shares the vertex
+			if (lines[a]->v1() == vertex || lines[a]->v2() == vertex)
+				continue;
+
+			if (lines[a]->distanceTo(vertex->position()) < split_dist)
+			{
+				lines.push_back(splitLine(lines[a], vertex));
+				line_vertices.push_back(candidates);
+				VECTOR_ADD_UNIQUE(vertices, vertex);
+			}
+		}
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Sets the front or back side of the line at index [line] to be part of
 // [sector]. Returns true if a new side was created
@@ -992,61 +1289,58 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	auto*    last_vertex = this->vertices().last();
 	auto*    last_line   = lines().last();
 
-	// Merge vertices
-	vector<MapVertex*> merged_vertices;
+	// Defer geometry updates until everything is merged
+	beginGeometryEdit();
+
+	// Merge vertices. All vertices at each of the given vertices' positions are
+	// found in one pass first, rather than searching all vertices for each
+	std::map<std::pair<double, double>, vector<MapVertex*>> vertices_at;
+	vector<std::pair<double, double>>                       positions;
 	for (auto& vertex : vertices)
 	{
-		auto* v = mergeVerticesPoint(vertex->position_);
-		if (v)
-			VECTOR_ADD_UNIQUE(merged_vertices, v);
+		positions.emplace_back(vertex->position_.x, vertex->position_.y);
+		vertices_at[positions.back()];
 	}
+	for (auto* vertex : data_.vertices())
+		if (auto at = vertices_at.find({ vertex->position_.x, vertex->position_.y }); at != vertices_at.end())
+			at->second.push_back(vertex);
 
-	// Get all connected lines
-	vector<MapLine*> connected_lines_;
-	for (auto& vertex : merged_vertices)
+	vector<MapVertex*> merged_vertices;
+	for (auto& position : positions)
 	{
-		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines_, connected_line);
+		// Merge all vertices at the position into the lowest indexed one
+		auto& at = vertices_at[position];
+		if (at.empty())
+			continue;
+		auto* v = *std::min_element(
+			at.begin(), at.end(), [](MapVertex* left, MapVertex* right) { return left->index_ < right->index_; });
+		for (auto* other : at)
+			if (other != v)
+				mergeVertices(v->index_, other->index_);
+		at.clear();
+
+		merged_vertices.push_back(v);
 	}
 
-	// Split lines (by vertices)
-	const double split_dist = 0.1;
-	// Split existing lines that vertices moved onto
-	for (auto& merged_vertice : merged_vertices)
-		splitLinesAt(merged_vertice, split_dist);
-
-	// Split lines that moved onto existing vertices
-	for (unsigned a = 0; a < connected_lines_.size(); a++)
-	{
-		unsigned nvertices = nVertices();
-		for (unsigned b = 0; b < nvertices; b++)
-		{
-			auto* vertex = this->vertex(b);
-
-			// Skip line if it shares the vertex
-			if (connected_lines_[a]->v1() == vertex || connected_lines_[a]->v2() == vertex)
-				continue;
+	// Get all connected lines
+	auto connected_lines_ = connectedLines(merged_vertices, nLines());
 
-			if (connected_lines_[a]->distanceTo(vertex->position()) < split_dist)
-			{
-				connected_lines_.push_back(splitLine(connected_lines_[a], vertex));
-				VECTOR_ADD_UNIQUE(merged_vertices, vertex);
-			}
-		}
-	}
+	// Split lines (by vertices)
+	splitLinesNear(merged_vertices, connected_lines_, 0.1);
 
 	// Split lines (by lines)
-	Seg2d seg1;
+	Seg2d            seg1;
+	vector<MapLine*> near_lines;
 	for (unsigned a = 0; a < connected_lines_.size(); a++)
 	{
 		auto* line1 = connected_lines_[a];
 		seg1        = line1->seg();
 
-		unsigned n_lines = nLines();
-		for (unsigned b = 0; b < n_lines; b++)
+		// Only lines with overlapping bounding boxes can intersect
+		near_lines.clear();
+		data_.lines().putAllInBox(nearBox(seg1, 0.), near_lines);
+		for (auto* line2 : near_lines)
 		{
-			auto* line2 = line(b);
-
 			// Can't intersect if they share a vertex
 			if (line1->vertex1_ == line2->vertex1_ || line1->vertex1_ == line2->vertex2_
 				|| line2->vertex1_ == line1->vertex2_ || line2->vertex2_ == line1->vertex2_)
@@ -1075,36 +1369,42 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	}
 
 	// Refresh connected lines
-	connected_lines_.clear();
-	for (auto& vertex : merged_vertices)
-	{
-		for (auto* connected_line : vertex->connected_lines_)
-			VECTOR_ADD_UNIQUE(connected_lines_, connected_line);
-	}
+	connected_lines_ = connectedLines(merged_vertices, nLines());
 
-	// Find overlapping lines
-	vector<MapLine*> remove_lines;
-	for (unsigned a = 0; a < connected_lines_.size(); a++)
-	{
-		auto* line1 = connected_lines_[a];
+	// Find overlapping lines. Lines are grouped by the vertices they are
+	// between, so only lines in the same group need to be checked
+	std::map<std::pair<MapVertex*, MapVertex*>, vector<MapLine*>> lines_between;
+	for (auto* line : connected_lines_)
+		lines_between[std::minmax(line->vertex1_, line->vertex2_)].push_back(line);
 
-		// Skip if removing already
-		if (VECTOR_EXISTS(remove_lines, line1))
+	vector<MapLine*>             remove_lines;
+	std::unordered_set<MapLine*> removing;
+	for (auto* line : connected_lines_)
+	{
+		// Check each group once, at its first line
+		auto& group = lines_between[std::minmax(line->vertex1_, line->vertex2_)];
+		if (group.size() < 2 || group[0] != line)
 			continue;
 
-		for (unsigned l = a + 1; l < connected_lines_.size(); l++)
+		for (unsigned a = 0; a < group.size(); a++)
 		{
-			auto* line2 = connected_lines_[l];
+			auto* line1 = group[a];
 
 			// Skip if removing already
-			if (VECTOR_EXISTS(remove_lines, line2))
+			if (removing.count(line1) > 0)
 				continue;
 
-			if ((line1->vertex1_ == line2->vertex1_ && line1->vertex2_ == line2->vertex2_)
-				|| (line1->vertex1_ == line2->vertex2_ && line1->vertex2_ == line2->vertex1_))
+			for (unsigned l = a + 1; l < group.size(); l++)
 			{
+				auto* line2 = group[l];
+
+				// Skip if removing already
+				if (removing.count(line2) > 0)
+					continue;
+
 				auto* remove_line = mergeOverlappingLines(line2, line1);
-				VECTOR_ADD_UNIQUE(remove_lines, remove_line);
+				if (removing.insert(remove_line).second)
+					remove_lines.push_back(remove_line);
 
 				// Don't check against any more lines if we just decided to remove this one
 				if (remove_line == line1)
@@ -1121,7 +1421,7 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 	}
 	for (unsigned a = 0; a < connected_lines_.size(); a++)
 	{
-		if (VECTOR_EXISTS(remove_lines, connected_lines_[a]))
+		if (removing.count(connected_lines_[a]) > 0)
 		{
 			connected_lines_[a] = connected_lines_.back();
 			connected_lines_.pop_back();
@@ -1168,6 +1468,8 @@ bool SLADEMap::mergeArch(const vector<MapVertex*>& vertices)
 			connected_line->flip();
 	}
 
+	endGeometryEdit();
+
 	if (merged)
 	{
 		log::info(4, "Architecture merged");
@@ -1267,6 +1569,11 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 			sides_correct.push_back(edge.line->side2_);
 	}
 
+	// Edge indices by line, to find which traced edges are ours
+	std::unordered_map<MapLine*, vector<unsigned>> line_edges;
+	for (unsigned a = 0; a < edges.size(); a++)
+		line_edges[edges[a].line].push_back(a);
+
 	// Build sectors
 	SectorBuilder      builder;
 	int                runs      = 0;
@@ -1298,17 +1605,15 @@ void SLADEMap::correctSectors(vector<MapLine*> lines, bool existing_only)
 			bool  is_front = builder.edgeIsFront(b);
 
 			bool line_is_ours = false;
-			for (unsigned e = 0; e < edges.size(); e++)
+			if (auto i = line_edges.find(line); i != line_edges.end())
 			{
-				if (edges[e].line == line)
-				{
-					line_is_ours = true;
+				line_is_ours = true;
+				for (auto e : i->second)
 					if (edges[e].front == is_front)
 					{
 						edges_in_sector.push_back(e);
 						break;
 					}
-				}
 			}
 
 			if (line_is_ours)
@@ -1597,19 +1902,3 @@ bool SLADEMap::convertToUDMF()
 	current_format_ = MapFormat::UDMF;
 	return true;
 }
-
-// -----------------------------------------------------------------------------
-// Adjusts the usage count for thing type [type] by [adjust]
-// -----------------------------------------------------------------------------
-void SLADEMap::updateThingTypeUsage(int type, int adjust)
-{
-	usage_thing_type_[type] += adjust;
-}
-
-// -----------------------------------------------------------------------------
-// Returns the usage count for the thing type [type]
-// -----------------------------------------------------------------------------
-int SLADEMap::thingTypeUsageCount(int type)
-{
-	return usage_thing_type_[type];
-}
@@ -89,18 +89,34 @@ public:
 	bool removeThing(unsigned index) { return data_.removeThing(index); }
 	int  removeDetachedVertices() { return data_.removeDetachedVertices(); }
 
+	// Bulk removal
+	int removeVertices(const vector<MapVertex*>& vertices) { return data_.removeVertices(vertices); }
+	int removeLines(const vector<MapLine*>& lines) { return data_.removeLines(lines); }
+	int removeSides(const vector<MapSide*>& sides, bool remove_from_line = true)
+	{
+		return data_.removeSides(sides, remove_from_line);
+	}
+	int removeSectors(const vector<MapSector*>& sectors) { return data_.removeSectors(sectors); }
+	int removeThings(const vector<MapThing*>& things) { return data_.removeThings(things); }
+
 	// Geometry
 	BBox     bounds(bool include_things = true);
 	void     updateGeometryInfo(long modified_time);
 	MapLine* lineVectorIntersect(MapLine* line, bool front, double& hit_x, double& hit_y) const;
 
+	// Geometry edit transactions
+	void beginGeometryEdit();
+	void endGeometryEdit();
+	bool inGeometryEdit() const { return geometry_edit_depth_ > 0; }
+
 	// Tags/Ids
 	void putThingsWithIdInSectorTag(int id, int tag, vector<MapThing*>& list);
-	void putDragonTargets(MapThing* first, vector<MapThing*>& list);
+	void putDragonTargets(MapThing* first, vector<MapThing*>& list) const;
 
 	// Info
 	string     adjacentLineTexture(MapVertex* vertex, int tex_part = 255) const;
 	MapSector* lineSideSector(MapLine* line, bool front = true);
+	MapSector* thingSector(const MapThing* thing) const;
 	bool       isModified() const;
 	void       setOpenedTime();
 
@@ -109,6 +125,7 @@ public:
 	MapVertex* mergeVerticesPoint(const Vec2d& pos);
 	MapLine*   splitLine(MapLine* line, MapVertex* vertex);
 	void       splitLinesAt(MapVertex* vertex, double split_dist = 0);
+	void       splitLinesNear(vector<MapVertex*>& vertices, vector<MapLine*>& lines, double split_dist);
 	bool       setLineSector(unsigned line_index, unsigned sector_index, bool front = true);
 	int        mergeLine(unsigned index);
 	bool       correctLineSectors(MapLine* line);
@@ -123,19 +140,14 @@ public:
 	void mapOpenChecks();
 
 	// Misc. map data access
-	void rebuildConnectedLines() { data_.rebuildConnectedLines(); }
-	void rebuildConnectedSides() { data_.rebuildConnectedSides(); }
+	void rebuildConnectedLines();
+	void rebuildConnectedSides();
 	void restoreObjectIdList(MapObject::Type type, vector<unsigned>& list) { data_.restoreObjectIdList(type, list); }
 
 	// Convert
 	bool convertToHexen() const;
 	bool convertToUDMF();
 
-	// Usage counts
-	void clearThingTypeUsage() { usage_thing_type_.clear(); }
-	void updateThingTypeUsage(int type, int adjust);
-	int  thingTypeUsageCount(int type);
-
 private:
 	MapObjectCollection data_;
 	string              udmf_namespace_;
@@ -150,7 +162,22 @@ private:
 	long geometry_updated_ = 0; // The last time the map geometry was updated
 	long things_updated_   = 0; // The last time the thing list was modified
 
-	// Usage counts
-	std::map<int, int> usage_thing_type_;
+	// Geometry edit transaction state. While a transaction is open, connected
+	// lines/sides rebuilds and geometry info updates are deferred until the
+	// outermost transaction ends
+	unsigned geometry_edit_depth_  = 0;
+	long     geometry_edit_time_   = 0; // Update geometry info for anything modified after this
+	bool     rebuild_lines_needed_ = false;
+	bool     rebuild_sides_needed_ = false;
+
+	// Sector containing each thing (by index), found when needed and kept until
+	// the thing is modified or the map geometry changes
+	struct ThingSector
+	{
+		const MapThing* thing  = nullptr;
+		MapSector*      sector = nullptr;
+		long            time   = 0; // When the sector was found
+	};
+	mutable vector<ThingSector> thing_sectors_;
 };
 } // namespace slade
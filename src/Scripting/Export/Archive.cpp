@@ -34,8 +34,11 @@
 #include "Archive/Archive.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryIO.h"
 #include "Archive/Formats/All.h"
 #include "General/Misc.h"
+#include "MainEditor/EntryOperations.h"
+#include "SLADEMap/MapThumbnails.h"
 #include "Utility/StringUtils.h"
 #include "thirdparty/sol/sol.hpp"
 
@@ -141,6 +144,26 @@ vector<shared_ptr<ArchiveEntry>> archiveFindAll(Archive& self, Archive::SearchOp
 	return found_shared;
 }
 
+// -----------------------------------------------------------------------------
+// Imports each file in [filenames] to a new entry in archive [self], in the
+// directory at [dir_path] (created if needed). Returns the created entries and
+// the errors for any files that couldn't be imported
+// -----------------------------------------------------------------------------
+std::tuple<vector<shared_ptr<ArchiveEntry>>, string> archiveImportFiles(
+	Archive&              self,
+	const vector<string>& filenames,
+	string_view           dir_path)
+{
+	ArchiveDir* dir = nullptr;
+	if (!dir_path.empty() && self.formatDesc().supports_dirs)
+		dir = self.createDir(dir_path).get();
+
+	string errors;
+	auto   entries = entryio::importFiles(self, entryio::filesToImport(filenames), dir, 0xFFFFFFFF, &errors);
+
+	return std::make_tuple(entries, errors);
+}
+
 // -----------------------------------------------------------------------------
 // Registers the ArchiveFormat type with lua
 // -----------------------------------------------------------------------------
@@ -206,9 +229,12 @@ void registerArchive(sol::state& lua)
 	lua_archive["Save"]                   = sol::overload(
         [](Archive& self) { return std::make_tuple(self.save(), global::error); },
         [](Archive& self, const string& filename) { return std::make_tuple(self.save(filename), global::error); });
-	lua_archive["FindFirst"] = &archiveFindFirst;
-	lua_archive["FindLast"]  = &archiveFindLast;
-	lua_archive["FindAll"]   = &archiveFindAll;
+	lua_archive["FindFirst"]   = &archiveFindFirst;
+	lua_archive["FindLast"]    = &archiveFindLast;
+	lua_archive["FindAll"]     = &archiveFindAll;
+	lua_archive["ImportFiles"] = sol::overload(
+		&archiveImportFiles,
+		[](Archive& self, const vector<string>& filenames) { return archiveImportFiles(self, filenames, {}); });
 
 	// Register all subclasses
 	// (perhaps it'd be a good idea to make Archive not abstract and handle
@@ -365,6 +391,21 @@ void registerEntryType(sol::state& lua)
 	lua_etype["category"]  = sol::property(&EntryType::category);
 }
 
+// -----------------------------------------------------------------------------
+// Generates thumbnails of all maps in [archives] to [output] (a directory, or
+// a contact sheet if it is a .png file), each at most [size] pixels wide/high.
+// Returns the number of thumbnails generated and any error messages
+// -----------------------------------------------------------------------------
+std::tuple<unsigned, string> createMapThumbnails(const vector<Archive*>& archives, const string& output, unsigned size)
+{
+	mapthumbnails::Options options;
+	options.size = size;
+
+	string errors;
+	auto   count = mapthumbnails::generate(archives, output, options, &errors);
+	return std::make_tuple(count, errors);
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Archives namespace with lua
 // -----------------------------------------------------------------------------
@@ -395,6 +436,20 @@ void registerArchivesNamespace(sol::state& lua)
 	archives["AddBookmark"]    = [](ArchiveEntry* entry) { app::archiveManager().addBookmark(entry->getShared()); };
 	archives["RemoveBookmark"] = [](ArchiveEntry* entry) { app::archiveManager().deleteBookmark(entry); };
 	archives["EntryType"]      = &EntryType::fromId;
+
+	archives["CreateMapThumbnails"] = sol::overload(
+		&createMapThumbnails,
+		[](const vector<Archive*>& archives, const string& output) {
+			return createMapThumbnails(archives, output, mapthumbnails::Options{}.size);
+		});
+
+	archives["ConvertSounds"] = sol::overload(
+		[](const vector<ArchiveEntry*>& entries, string_view format, unsigned samplerate) {
+			return entryoperations::convertSounds(entries, format, samplerate);
+		},
+		[](const vector<ArchiveEntry*>& entries, string_view format) {
+			return entryoperations::convertSounds(entries, format);
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -36,7 +36,9 @@
 #include "Graphics/CTexture/CTexture.h"
 #include "Graphics/CTexture/PatchTable.h"
 #include "Graphics/CTexture/TextureXList.h"
+#include "Graphics/GfxConvert.h"
 #include "Graphics/Palette/Palette.h"
+#include "Graphics/Palette/PaletteTables.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "Scripting/Lua.h"
@@ -315,6 +317,9 @@ void registerPaletteType(sol::state& lua)
 	lua_palette["MATCH_C76"]     = sol::property([]() { return Palette::ColourMatch::C76; });
 	lua_palette["MATCH_C94"]     = sol::property([]() { return Palette::ColourMatch::C94; });
 	lua_palette["MATCH_C2K"]     = sol::property([]() { return Palette::ColourMatch::C2K; });
+	lua_palette["BLEND_TRANSLUCENT"] = sol::property([]() { return palettetables::BlendMode::Translucent; });
+	lua_palette["BLEND_ADDITIVE"]    = sol::property([]() { return palettetables::BlendMode::Additive; });
+	lua_palette["BLEND_SUBTRACTIVE"] = sol::property([]() { return palettetables::BlendMode::Subtractive; });
 
 	// Functions
 	// -------------------------------------------------------------------------
@@ -344,6 +349,59 @@ void registerPaletteType(sol::state& lua)
 	lua_palette["Gradient"] = [](Palette& self, const ColRGBA& startC, const ColRGBA& endC, int startI, int endI) {
 		self.setGradient(startI, endI, startC, endC);
 	};
+
+	// Lookup table generation
+	lua_palette["GenerateColormap"] = sol::overload(
+		[](Palette& self, const ColRGBA& fade, Palette::ColourMatch match)
+		{
+			MemChunk mc;
+			palettetables::colormap(self, mc, fade, match);
+			return mc;
+		},
+		[](Palette& self, const ColRGBA& fade)
+		{
+			MemChunk mc;
+			palettetables::colormap(self, mc, fade);
+			return mc;
+		},
+		[](Palette& self)
+		{
+			MemChunk mc;
+			palettetables::colormap(self, mc);
+			return mc;
+		});
+	lua_palette["GenerateBlendTable"] = sol::overload(
+		[](Palette& self, float amount, palettetables::BlendMode mode, Palette::ColourMatch match)
+		{
+			MemChunk mc;
+			palettetables::blendTable(self, mc, amount, mode, match);
+			return mc;
+		},
+		[](Palette& self, float amount, palettetables::BlendMode mode)
+		{
+			MemChunk mc;
+			palettetables::blendTable(self, mc, amount, mode);
+			return mc;
+		},
+		[](Palette& self, float amount)
+		{
+			MemChunk mc;
+			palettetables::blendTable(self, mc, amount);
+			return mc;
+		});
+	lua_palette["GenerateTranslationTable"] = sol::overload(
+		[](Palette& self, Translation& translation, Palette::ColourMatch match)
+		{
+			MemChunk mc;
+			palettetables::translationTable(self, translation, mc, match);
+			return mc;
+		},
+		[](Palette& self, Translation& translation)
+		{
+			MemChunk mc;
+			palettetables::translationTable(self, translation, mc);
+			return mc;
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -771,6 +829,20 @@ sol::table getImageInfo(MemChunk& data, int index)
 		info.has_palette);
 }
 
+// -----------------------------------------------------------------------------
+// Converts the image entries in the [entries] table to [format] with conversion
+// options [opt] (see gfx::convertEntries)
+// -----------------------------------------------------------------------------
+unsigned convertEntries(const sol::table& entries, SIFormat* format, const SIFormat::ConvertOptions& opt)
+{
+	vector<ArchiveEntry*> list;
+	for (const auto& pair : entries)
+		if (pair.second.is<ArchiveEntry*>())
+			list.push_back(pair.second.as<ArchiveEntry*>());
+
+	return gfx::convertEntries(list, format, opt);
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Graphics function namespace with lua
 // -----------------------------------------------------------------------------
@@ -796,6 +868,7 @@ void registerGraphicsNamespace(sol::state& lua)
 	};
 	gfx["DetectImageFormat"] = [](MemChunk& mc) { return SIFormat::determineFormat(mc); };
 	gfx["GetImageInfo"]      = sol::overload(&getImageInfo, [](MemChunk& data) { return getImageInfo(data, 0); });
+	gfx["ConvertEntries"]    = &convertEntries;
 }
 
 } // namespace slade::lua
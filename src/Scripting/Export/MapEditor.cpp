@@ -95,6 +95,135 @@ void objectSetStringProperty(MapObject& self, string_view key, string_view value
 		log::warning("{} string property \"{}\" can not be modified via script", self.typeName(), key);
 }
 
+// -----------------------------------------------------------------------------
+// Returns all objects of [type] in [map]
+// -----------------------------------------------------------------------------
+vector<MapObject*> mapObjectsOfType(SLADEMap& map, MapObject::Type type)
+{
+	switch (type)
+	{
+	case MapObject::Type::Vertex: return { map.vertices().begin(), map.vertices().end() };
+	case MapObject::Type::Line: return { map.lines().begin(), map.lines().end() };
+	case MapObject::Type::Side: return { map.sides().begin(), map.sides().end() };
+	case MapObject::Type::Sector: return { map.sectors().begin(), map.sectors().end() };
+	case MapObject::Type::Thing: return { map.things().begin(), map.things().end() };
+	default: return {};
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds the objects in [objects] to [list] if it is a list of [T] objects (as
+// returned from eg. Map.linedefs). Returns false if it isn't
+// -----------------------------------------------------------------------------
+template<typename T> bool getObjectList(const sol::object& objects, vector<MapObject*>& list)
+{
+	if (!objects.is<vector<T*>>())
+		return false;
+
+	auto& typed = objects.as<vector<T*>&>();
+	list.assign(typed.begin(), typed.end());
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the map objects given to a bulk property function from a script,
+// [objects] can be a MapObject.TYPE_* constant (all objects of that type in
+// [map]), a list of objects from the map or a table of objects
+// -----------------------------------------------------------------------------
+vector<MapObject*> scriptMapObjects(SLADEMap& map, const sol::object& objects)
+{
+	vector<MapObject*> list;
+	switch (objects.get_type())
+	{
+	case sol::type::number: return mapObjectsOfType(map, objects.as<MapObject::Type>());
+	case sol::type::table:
+	{
+		auto table = objects.as<sol::table>();
+		auto count = table.size();
+		list.reserve(count);
+		for (size_t a = 1; a <= count; ++a)
+		{
+			sol::optional<MapObject*> object = table[a];
+			if (object && *object)
+				list.push_back(*object);
+		}
+		break;
+	}
+	case sol::type::userdata:
+		if (!getObjectList<MapVertex>(objects, list) && !getObjectList<MapLine>(objects, list)
+			&& !getObjectList<MapSide>(objects, list) && !getObjectList<MapSector>(objects, list)
+			&& !getObjectList<MapThing>(objects, list))
+			getObjectList<MapObject>(objects, list);
+		break;
+	default: break;
+	}
+
+	return list;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a table of the values of property [key] for each of [objects] in
+// [map], in order. Reading a whole 'column' of properties in one call avoids
+// crossing between lua and C++ for every object
+// -----------------------------------------------------------------------------
+template<typename T>
+sol::table mapObjectsProperty(
+	SLADEMap&          map,
+	const sol::object& objects,
+	string_view        key,
+	T (MapObject::*getter)(string_view))
+{
+	auto list   = scriptMapObjects(map, objects);
+	auto values = lua::state().create_table(static_cast<int>(list.size()), 0);
+	for (unsigned a = 0; a < list.size(); ++a)
+		values[a + 1] = (list[a]->*getter)(key);
+
+	return values;
+}
+
+// -----------------------------------------------------------------------------
+// Sets property [key] for each of [objects] in [map]. [values] is either a
+// table of values (in the same order as [objects], nil values are skipped) or
+// a single value to set on all objects
+// -----------------------------------------------------------------------------
+template<typename T, typename V>
+void setMapObjectsProperty(
+	SLADEMap&          map,
+	const sol::object& objects,
+	string_view        key,
+	const sol::object& values,
+	void (MapObject::*setter)(string_view, V))
+{
+	sol::table       table;
+	sol::optional<T> single;
+	if (values.get_type() == sol::type::table)
+		table = values.as<sol::table>();
+	else if (values.is<T>())
+		single = values.as<T>();
+	else
+		return;
+
+	unsigned not_allowed = 0;
+	auto     list        = scriptMapObjects(map, objects);
+	for (unsigned a = 0; a < list.size(); ++a)
+	{
+		sol::optional<T> value = table.valid() ? table[a + 1].get<sol::optional<T>>() : single;
+		if (!value)
+			continue;
+
+		if (!list[a]->scriptCanModifyProp(key))
+		{
+			++not_allowed;
+			continue;
+		}
+
+		(list[a]->*setter)(key, *value);
+	}
+
+	if (not_allowed > 0)
+		log::warning("Property \"{}\" can not be modified via script on {} objects", key, not_allowed);
+}
+
 // -----------------------------------------------------------------------------
 // Registers the Map type with lua
 // -----------------------------------------------------------------------------
@@ -112,6 +241,35 @@ void registerSLADEMap(sol::state& lua)
 	lua_map["sidedefs"]      = sol::property([](SLADEMap& self) { return self.sides().all(); });
 	lua_map["sectors"]       = sol::property([](SLADEMap& self) { return self.sectors().all(); });
 	lua_map["things"]        = sol::property([](SLADEMap& self) { return self.things().all(); });
+
+	// Functions (bulk property access)
+	// -------------------------------------------------------------------------
+	using Objects = const sol::object&;
+
+	lua_map["BoolProperties"] = [](SLADEMap& self, Objects objects, string_view key) {
+		return mapObjectsProperty<bool>(self, objects, key, &MapObject::boolProperty);
+	};
+	lua_map["IntProperties"] = [](SLADEMap& self, Objects objects, string_view key) {
+		return mapObjectsProperty<int>(self, objects, key, &MapObject::intProperty);
+	};
+	lua_map["FloatProperties"] = [](SLADEMap& self, Objects objects, string_view key) {
+		return mapObjectsProperty<double>(self, objects, key, &MapObject::floatProperty);
+	};
+	lua_map["StringProperties"] = [](SLADEMap& self, Objects objects, string_view key) {
+		return mapObjectsProperty<string>(self, objects, key, &MapObject::stringProperty);
+	};
+	lua_map["SetBoolProperties"] = [](SLADEMap& self, Objects objects, string_view key, Objects values) {
+		setMapObjectsProperty<bool>(self, objects, key, values, &MapObject::setBoolProperty);
+	};
+	lua_map["SetIntProperties"] = [](SLADEMap& self, Objects objects, string_view key, Objects values) {
+		setMapObjectsProperty<int>(self, objects, key, values, &MapObject::setIntProperty);
+	};
+	lua_map["SetFloatProperties"] = [](SLADEMap& self, Objects objects, string_view key, Objects values) {
+		setMapObjectsProperty<double>(self, objects, key, values, &MapObject::setFloatProperty);
+	};
+	lua_map["SetStringProperties"] = [](SLADEMap& self, Objects objects, string_view key, Objects values) {
+		setMapObjectsProperty<string>(self, objects, key, values, &MapObject::setStringProperty);
+	};
 }
 
 // -----------------------------------------------------------------------------
@@ -136,6 +294,43 @@ void setEditMode(
 		self.setSectorEditMode(sector_mode);
 }
 
+// -----------------------------------------------------------------------------
+// Calls [func], recording all changes it makes to the map as a single undo
+// level named [name] in the map editor [self]. Returns false and the error
+// message if [func] failed (any changes made before the error are kept in the
+// undo level)
+// -----------------------------------------------------------------------------
+std::tuple<bool, string> mapEditorUndoTransaction(
+	MapEditContext&                self,
+	string_view                    name,
+	const sol::protected_function& func)
+{
+	// Nested transactions are part of the outer one
+	static bool recording = false;
+	auto        nested    = recording;
+	if (!nested)
+	{
+		self.beginUndoRecord(name);
+		recording = true;
+	}
+
+	auto result = func();
+
+	if (!nested)
+	{
+		self.endUndoRecord(true);
+		recording = false;
+	}
+
+	if (!result.valid())
+	{
+		sol::error error = result;
+		return std::make_tuple(false, string{ error.what() });
+	}
+
+	return std::make_tuple(true, string{});
+}
+
 // -----------------------------------------------------------------------------
 // Registers the MapEditor type with lua
 // -----------------------------------------------------------------------------
@@ -184,6 +379,7 @@ void registerMapEditor(sol::state& lua)
 		[](MapEditContext& self, mapeditor::Mode mode, mapeditor::SectorMode sector_mode) {
 			setEditMode(self, mode, sector_mode);
 		});
+	lua_mapeditor["UndoTransaction"] = &mapEditorUndoTransaction;
 }
 
 // -----------------------------------------------------------------------------
@@ -1,5 +1,6 @@
 
 #include "Main.h"
+#include "App.h"
 #include "Export.h"
 #include "Scripting/Lua.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
@@ -39,6 +40,13 @@ namespace slade::lua
 // -----------------------------------------------------------------------------
 void messageBox(const string& title, const string& message, MessageBoxIcon icon = MessageBoxIcon::Info)
 {
+	// Just log the message in batch mode
+	if (app::isBatchMode())
+	{
+		log::message(log::MessageType::Script, fmt::format("{}: {}", title, message));
+		return;
+	}
+
 	long style = 4 | wxCENTRE;
 	switch (icon)
 	{
@@ -57,6 +65,12 @@ void messageBox(const string& title, const string& message, MessageBoxIcon icon
 // -----------------------------------------------------------------------------
 void messageBoxExtended(const string& title, const string& message, const string& extra)
 {
+	if (app::isBatchMode())
+	{
+		log::message(log::MessageType::Script, fmt::format("{}: {}\n{}", title, message, extra));
+		return;
+	}
+
 	ExtMessageDialog dlg(currentWindow(), title);
 	dlg.setMessage(message);
 	dlg.setExt(extra);
@@ -69,6 +83,10 @@ void messageBoxExtended(const string& title, const string& message, const string
 // -----------------------------------------------------------------------------
 string promptString(const string& title, const string& message, const string& default_value)
 {
+	// Nothing to prompt in batch mode
+	if (app::isBatchMode())
+		return default_value;
+
 	return wxGetTextFromUser(message, title, default_value, currentWindow()).ToStdString();
 }
 
@@ -77,6 +95,9 @@ string promptString(const string& title, const string& message, const string& de
 // -----------------------------------------------------------------------------
 int promptNumber(const string& title, const string& message, int default_value, int min, int max)
 {
+	if (app::isBatchMode())
+		return default_value;
+
 	return (int)wxGetNumberFromUser(message, "", title, default_value, min, max);
 }
 
@@ -85,6 +106,9 @@ int promptNumber(const string& title, const string& message, int default_value,
 // -----------------------------------------------------------------------------
 bool promptYesNo(const string& title, const string& message)
 {
+	if (app::isBatchMode())
+		return false;
+
 	return (wxMessageBox(message, title, wxYES_NO | wxICON_QUESTION) == wxYES);
 }
 
@@ -93,6 +117,9 @@ bool promptYesNo(const string& title, const string& message)
 // -----------------------------------------------------------------------------
 string browseFile(string_view title, string_view extensions, string_view filename)
 {
+	if (app::isBatchMode())
+		return {};
+
 	filedialog::FDInfo inf;
 	filedialog::openFile(inf, title, extensions, currentWindow(), filename);
 	return inf.filenames.empty() ? "" : inf.filenames[0];
@@ -105,6 +132,9 @@ vector<string> browseFiles(string_view title, string_view extensions)
 {
 	filedialog::FDInfo inf;
 	vector<string>     filenames;
+	if (app::isBatchMode())
+		return filenames;
+
 	if (filedialog::openFiles(inf, title, extensions, currentWindow()))
 		for (const auto& file : inf.filenames)
 			filenames.push_back(file);
@@ -116,6 +146,9 @@ vector<string> browseFiles(string_view title, string_view extensions)
 // -----------------------------------------------------------------------------
 string saveFile(string_view title, string_view extensions, string_view fn_default = {})
 {
+	if (app::isBatchMode())
+		return {};
+
 	filedialog::FDInfo inf;
 	if (filedialog::saveFile(inf, title, extensions, currentWindow(), fn_default))
 		return inf.filenames[0];
@@ -128,6 +161,9 @@ string saveFile(string_view title, string_view extensions, string_view fn_defaul
 // -----------------------------------------------------------------------------
 std::tuple<string, string> saveFiles(string_view title, string_view extensions)
 {
+	if (app::isBatchMode())
+		return { {}, {} };
+
 	filedialog::FDInfo inf;
 	if (filedialog::saveFiles(inf, title, extensions, currentWindow()))
 		return std::make_tuple(inf.path, inf.extension);
@@ -164,6 +200,9 @@ void registerUINamespace(sol::state& lua)
 	ui["SetSplashMessage"]         = &ui::setSplashMessage;
 	ui["SetSplashProgressMessage"] = &ui::setSplashProgressMessage;
 	ui["SetSplashProgress"]        = &ui::setSplashProgress;
+	ui["SetProgress"]              = sol::overload(
+        [](float progress) { setProgress(progress); },
+        [](float progress, const string& message) { setProgress(progress, message); });
 
 	// Constants
 	// -------------------------------------------------------------------------
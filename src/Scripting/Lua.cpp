@@ -31,6 +31,7 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #define SOL_CHECK_ARGUMENTS 1
+#include "App.h"
 #include "Export/Export.h"
 #include "General/Console.h"
 #include "General/Misc.h"
@@ -38,8 +39,11 @@
 #include "SLADEMap/SLADEMap.h"
 #include "UI/Dialogs/ExtMessageDialog.h"
 #include "UI/WxUtils.h"
+#include "Utility/MemoryStats.h"
 #include "Utility/StringUtils.h"
 #include "thirdparty/sol/sol.hpp"
+#include <chrono>
+#include <wx/progdlg.h>
 
 using namespace slade;
 
@@ -55,7 +59,36 @@ sol::state lua;
 wxWindow*  current_window = nullptr;
 Error      script_error;
 time_t     script_start_time;
+
+// Progress of the running script
+constexpr int                HOOK_INSTRUCTIONS = 1000; // Instructions between progress checks
+constexpr long               PROGRESS_INTERVAL = 100;  // Time (ms) between progress dialog updates
+constexpr long               PROGRESS_DELAY    = 1000; // Time (ms) before the progress dialog is shown
+wxStopWatch                  script_timer;
+long                         progress_updated = 0;
+float                        script_progress  = -1.f; // Negative for unknown progress
+string                       script_progress_message;
+unique_ptr<wxProgressDialog> progress_dialog;
+
+// Profiling
+using ProfileClock = std::chrono::steady_clock;
+struct ProfileFrame
+{
+	unsigned                 entry;
+	ProfileClock::time_point start;
+	double                   child_ms = 0.;
+};
+struct ProfileFunction
+{
+	ProfileEntry entry;
+	unsigned     active = 0; // Number of (recursive) calls in progress
+};
+vector<ProfileFunction>                              profile_functions;
+std::unordered_map<const void*, unsigned>            profile_function_ids; // Function -> index in profile_functions
+std::unordered_map<lua_State*, vector<ProfileFrame>> profile_stacks;       // Call stack for each lua thread
+vector<ProfileEntry>                                 profile_result;
 } // namespace slade::lua
+CVAR(Bool, script_profile, false, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
@@ -105,6 +138,184 @@ sol::protected_function_result handleError(lua_State* L, sol::protected_function
 	return pfr;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the script progress dialog if it is due for an update, showing it if
+// the script has been running for long enough. The dialog processes UI events
+// so SLADE doesn't appear frozen while a long script runs.
+// Returns false if the script was cancelled from the dialog
+// -----------------------------------------------------------------------------
+bool updateProgressDialog()
+{
+	// No progress dialog in batch mode
+	if (app::isBatchMode())
+		return true;
+
+	auto time = script_timer.Time();
+	if (time - progress_updated < PROGRESS_INTERVAL || time < PROGRESS_DELAY)
+		return true;
+
+	progress_updated = time;
+	wxString message = "Running script...";
+	if (!script_progress_message.empty())
+		message = wxString::FromUTF8(script_progress_message);
+
+	if (!progress_dialog)
+		progress_dialog = std::make_unique<wxProgressDialog>(
+			"Running Script",
+			message,
+			1000,
+			current_window,
+			wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+
+	if (script_progress < 0.f)
+		return progress_dialog->Pulse(message);
+
+	return progress_dialog->Update(static_cast<int>(std::min(script_progress, 1.f) * 1000), message);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index in profile_functions of the function being called in
+// [state], described by [ar]. The function is added if it hasn't been called
+// before
+// -----------------------------------------------------------------------------
+unsigned profileFunction(lua_State* state, lua_Debug* ar)
+{
+	lua_getinfo(state, "f", ar);
+	auto function = lua_topointer(state, -1);
+	lua_pop(state, 1);
+
+	auto existing = profile_function_ids.find(function);
+	if (existing != profile_function_ids.end())
+		return existing->second;
+
+	ProfileFunction pf;
+	lua_getinfo(state, "Sn", ar);
+	pf.entry.native = ar->what[0] == 'C';
+	if (ar->name)
+		pf.entry.function = ar->name;
+	else if (ar->what[0] == 'm')
+		pf.entry.function = "(main chunk)";
+	else
+		pf.entry.function = "(anonymous)";
+	pf.entry.source = pf.entry.native ? "[C++ binding]" : fmt::format("{}:{}", ar->short_src, ar->linedefined);
+
+	auto id                        = static_cast<unsigned>(profile_functions.size());
+	profile_function_ids[function] = id;
+	profile_functions.push_back(std::move(pf));
+	return id;
+}
+
+// -----------------------------------------------------------------------------
+// Records the time taken by the function call at the top of [stack]
+// (finished at [now]) and removes it from the stack
+// -----------------------------------------------------------------------------
+void profilePop(vector<ProfileFrame>& stack, ProfileClock::time_point now)
+{
+	auto frame = stack.back();
+	stack.pop_back();
+
+	auto  time     = std::chrono::duration<double, std::milli>(now - frame.start).count();
+	auto& function = profile_functions[frame.entry];
+	function.entry.self_ms += time - frame.child_ms;
+	if (--function.active == 0)
+		function.entry.total_ms += time; // Only count the outermost call of recursive functions
+	if (!stack.empty())
+		stack.back().child_ms += time;
+}
+
+// -----------------------------------------------------------------------------
+// Records a function call or return event [ar] in lua thread [state] for the
+// profiler
+// -----------------------------------------------------------------------------
+void profileEvent(lua_State* state, lua_Debug* ar)
+{
+	auto  now   = ProfileClock::now();
+	auto& stack = profile_stacks[state];
+
+	// A tail call replaces the current function
+	if (ar->event == LUA_HOOKRET || ar->event == LUA_HOOKTAILCALL)
+	{
+		if (!stack.empty())
+			profilePop(stack, now);
+		if (ar->event == LUA_HOOKRET)
+			return;
+	}
+
+	auto id = profileFunction(state, ar);
+	profile_functions[id].entry.calls++;
+	profile_functions[id].active++;
+	stack.push_back({ id, ProfileClock::now() });
+}
+
+// -----------------------------------------------------------------------------
+// Finishes profiling the script run, recording any calls still in progress
+// (eg. if the script stopped with an error) and building the results list
+// -----------------------------------------------------------------------------
+void finishProfile()
+{
+	auto now = ProfileClock::now();
+	for (auto& stack : profile_stacks)
+		while (!stack.second.empty())
+			profilePop(stack.second, now);
+
+	profile_result.clear();
+	for (auto& function : profile_functions)
+		profile_result.push_back(function.entry);
+	std::sort(profile_result.begin(), profile_result.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+		return a.self_ms > b.self_ms;
+	});
+
+	profile_functions.clear();
+	profile_function_ids.clear();
+	profile_stacks.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Lua hook called every [HOOK_INSTRUCTIONS] instructions while a script is
+// running (and on every function call/return if profiling), raises an error to
+// stop the script if it has been cancelled.
+// (nothing with a destructor can be in scope here, since lua errors may
+// longjmp out of the hook)
+// -----------------------------------------------------------------------------
+void scriptHook(lua_State* state, lua_Debug* ar)
+{
+	if (ar->event != LUA_HOOKCOUNT)
+		profileEvent(state, ar);
+	else if (!updateProgressDialog())
+		luaL_error(state, "Script cancelled");
+}
+
+// -----------------------------------------------------------------------------
+// Sets up progress reporting and cancellation for a script run, for the
+// lifetime of the object
+// -----------------------------------------------------------------------------
+struct ScriptRun
+{
+	ScriptRun()
+	{
+		script_timer.Start();
+		progress_updated = 0;
+		script_progress  = -1.f;
+		script_progress_message.clear();
+
+		auto mask = LUA_MASKCOUNT;
+		if (script_profile)
+		{
+			mask |= LUA_MASKCALL | LUA_MASKRET;
+			profile_result.clear();
+		}
+		lua_sethook(lua.lua_state(), &scriptHook, mask, HOOK_INSTRUCTIONS);
+	}
+
+	~ScriptRun()
+	{
+		lua_sethook(lua.lua_state(), nullptr, 0, 0);
+		progress_dialog.reset();
+		if (script_profile)
+			finishProfile();
+	}
+};
+
 // -----------------------------------------------------------------------------
 // Template function for Lua::run*Script functions.
 // Loads [script] and runs the 'Execute' function in the script, passing
@@ -114,6 +325,7 @@ template<class T> bool runEditorScript(const string& script, T param)
 {
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
+	ScriptRun run;
 
 	// Load script
 	sol::environment sandbox(lua, sol::create, lua.globals());
@@ -209,7 +421,7 @@ void lua::showErrorDialog(wxWindow* parent, string_view title, string_view messa
 	auto   log = log::since(script_start_time, log::MessageType::Script);
 	string output;
 	for (auto msg : log)
-		output += msg->formattedMessageLine() + "\n";
+		output += msg.formattedMessageLine() + "\n";
 
 	ExtMessageDialog dlg(parent ? parent : current_window, wxutil::strFromView(title));
 	dlg.setMessage(wxutil::strFromView(message));
@@ -230,6 +442,7 @@ bool lua::run(const string& program)
 {
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
+	ScriptRun run;
 
 	sol::environment sandbox(lua, sol::create, lua.globals());
 	auto             result = lua.script(program, sandbox, handleError);
@@ -253,6 +466,7 @@ bool lua::runFile(const string& filename)
 {
 	resetError();
 	script_start_time = wxDateTime::Now().GetTicks();
+	ScriptRun run;
 
 	sol::environment sandbox(lua, sol::create, lua.globals());
 	auto             result = lua.script_file(filename, sandbox, handleError);
@@ -296,6 +510,25 @@ bool lua::runMapScript(const string& script, SLADEMap* map)
 	return runEditorScript<SLADEMap*>(script, map);
 }
 
+// -----------------------------------------------------------------------------
+// Sets the progress of the running script to [progress] (0-1, or negative if
+// unknown), shown with [message] in the script progress dialog
+// -----------------------------------------------------------------------------
+void lua::setProgress(float progress, string_view message)
+{
+	script_progress         = progress;
+	script_progress_message = message;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the time spent in each function called by the last script run with
+// profiling enabled (script_profile cvar), sorted by self time
+// -----------------------------------------------------------------------------
+const vector<lua::ProfileEntry>& lua::profile()
+{
+	return profile_result;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the active lua state
 // -----------------------------------------------------------------------------
@@ -355,3 +588,19 @@ CONSOLE_COMMAND(lua_mem, 0, false)
 	auto mem = lua::state().memory_used();
 	log::console(fmt::format("Lua state using {} memory", misc::sizeAsString(mem)));
 }
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counts memory used by the lua state
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(lua, "Scripting")
+{
+	usage.push_back({ {}, "Lua state", lua::state().memory_used() });
+}
@@ -32,6 +32,19 @@ namespace lua
 	bool runArchiveScript(const string& script, Archive* archive);
 	bool runEntryScript(const string& script, vector<ArchiveEntry*>& entries);
 	bool runMapScript(const string& script, SLADEMap* map);
+	void setProgress(float progress, string_view message = {});
+
+	// Time spent in a function while profiling a script
+	struct ProfileEntry
+	{
+		string   function;
+		string   source;            // Where the function is defined (file:line)
+		bool     native   = false; // True if it is a C++ binding
+		unsigned calls    = 0;
+		double   total_ms = 0.; // Including time spent in functions it called
+		double   self_ms  = 0.;
+	};
+	const vector<ProfileEntry>& profile();
 
 	sol::state& state();
 
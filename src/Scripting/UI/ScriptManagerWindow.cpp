@@ -63,6 +63,7 @@ int      layout_version = 1;
 } // namespace
 
 CVAR(Bool, sm_maximized, false, CVar::Flag::Save)
+EXTERN_CVAR(Bool, script_profile)
 
 
 // -----------------------------------------------------------------------------
@@ -365,6 +366,7 @@ void ScriptManagerWindow::setupMenu()
 	auto script_menu = new wxMenu();
 	SAction::fromId("scrm_run")->addToMenu(script_menu);
 	SAction::fromId("scrm_save")->addToMenu(script_menu);
+	SAction::fromId("scrm_profile")->addToMenu(script_menu);
 	// SAction::fromId("scrm_rename")->addToMenu(scriptMenu);
 	// SAction::fromId("scrm_delete")->addToMenu(scriptMenu);
 	menu->Append(script_menu, "&Script");
@@ -729,11 +731,18 @@ bool ScriptManagerWindow::handleAction(string_view id)
 		if (!lua::run(script_clicked_ ? script_clicked_->text : currentScriptText()))
 			lua::showErrorDialog();
 
+		if (script_profile && currentPage())
+			currentPage()->showProfile(lua::profile());
+
 		script_clicked_ = nullptr;
 
 		return true;
 	}
 
+	// Script->Profile (the action toggles the script_profile cvar)
+	if (id == "scrm_profile")
+		return true;
+
 	// Script->Rename
 	if (id == "scrm_rename")
 	{
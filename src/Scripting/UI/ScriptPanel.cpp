@@ -37,6 +37,7 @@
 #include "Scripting/ScriptManager.h"
 #include "TextEditor/UI/FindReplacePanel.h"
 #include "TextEditor/UI/TextEditorCtrl.h"
+#include "UI/Lists/VirtualListView.h"
 #include "UI/SToolBar/SToolBar.h"
 #include "UI/SToolBar/SToolBarButton.h"
 #include "UI/WxUtils.h"
@@ -44,6 +45,102 @@
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+// ScriptProfileList Class
+//
+// Virtual list showing the time spent in each function called by a script
+// (from the profiler), sortable by any column
+// -----------------------------------------------------------------------------
+namespace slade
+{
+class ScriptProfileList : public VirtualListView
+{
+public:
+	ScriptProfileList(wxWindow* parent) : VirtualListView(parent)
+	{
+		AppendColumn("Function");
+		AppendColumn("Source");
+		AppendColumn("Calls");
+		AppendColumn("Total (ms)");
+		AppendColumn("Self (ms)");
+
+		// Sort by self time by default
+		sort_column_  = 4;
+		sort_descend_ = true;
+		setColumnHeaderArrow(sort_column_, 2);
+	}
+
+	~ScriptProfileList() override = default;
+
+	void setProfile(const vector<lua::ProfileEntry>& profile)
+	{
+		profile_ = profile;
+		updateList();
+	}
+
+	void updateList(bool clear = false) override
+	{
+		items_.clear();
+		for (unsigned a = 0; a < profile_.size(); ++a)
+			items_.push_back(a);
+		SetItemCount(profile_.size());
+
+		sortItems();
+		Refresh();
+	}
+
+	void sortItems() override
+	{
+		lv_current_ = this;
+		if (sort_column_ < 2)
+		{
+			std::sort(items_.begin(), items_.end(), &VirtualListView::defaultSort);
+			return;
+		}
+
+		// Numeric columns
+		std::sort(items_.begin(), items_.end(), [this](long left, long right) {
+			auto lv = sortValue(profile_[left]);
+			auto rv = sortValue(profile_[right]);
+			if (lv == rv)
+				return left < right;
+			return sort_descend_ ? lv > rv : lv < rv;
+		});
+	}
+
+protected:
+	wxString itemText(long item, long column, long index) const override
+	{
+		if (index < 0 || index >= static_cast<long>(profile_.size()))
+			return "";
+
+		auto& entry = profile_[index];
+		switch (column)
+		{
+		case 0: return wxString::FromUTF8(entry.function);
+		case 1: return wxString::FromUTF8(entry.source);
+		case 2: return wxString::Format("%u", entry.calls);
+		case 3: return wxString::Format("%.2f", entry.total_ms);
+		case 4: return wxString::Format("%.2f", entry.self_ms);
+		default: return "";
+		}
+	}
+
+private:
+	vector<lua::ProfileEntry> profile_;
+
+	double sortValue(const lua::ProfileEntry& entry) const
+	{
+		if (sort_column_ == 2)
+			return entry.calls;
+		if (sort_column_ == 3)
+			return entry.total_ms;
+		return entry.self_ms;
+	}
+};
+} // namespace slade
+
+
 // -----------------------------------------------------------------------------
 //
 // ScriptPanel Class Functions
@@ -81,6 +178,15 @@ ScriptPanel::ScriptPanel(wxWindow* parent, scriptmanager::Script* script) : wxPa
 
 	text_editor_->setFindReplacePanel(find_replace_panel_);
 
+	// Profile report (hidden until a script is profiled)
+	label_profile_ = new wxStaticText(this, -1, "");
+	sizer->Add(label_profile_, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, ui::pad());
+	list_profile_ = new ScriptProfileList(this);
+	list_profile_->SetMinSize(wxSize(-1, ui::scalePx(200)));
+	sizer->Add(list_profile_, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, ui::pad());
+	label_profile_->Show(false);
+	list_profile_->Show(false);
+
 	last_saved_ = app::runTimer();
 }
 
@@ -177,6 +283,38 @@ bool ScriptPanel::handleAction(string_view id)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Shows the [profile] report for the last script run below the editor, with a
+// summary of how much time was spent in lua vs. C++ bindings
+// -----------------------------------------------------------------------------
+void ScriptPanel::showProfile(const vector<lua::ProfileEntry>& profile)
+{
+	double   lua_ms       = 0.;
+	double   native_ms    = 0.;
+	unsigned native_calls = 0;
+	for (const auto& entry : profile)
+	{
+		if (entry.native)
+		{
+			native_ms += entry.self_ms;
+			native_calls += entry.calls;
+		}
+		else
+			lua_ms += entry.self_ms;
+	}
+
+	label_profile_->SetLabel(wxString::Format(
+		"Profile: %.2fms in lua functions, %.2fms in %u C++ binding calls",
+		lua_ms,
+		native_ms,
+		native_calls));
+	list_profile_->setProfile(profile);
+	list_profile_->updateWidth();
+	label_profile_->Show(!profile.empty());
+	list_profile_->Show(!profile.empty());
+	Layout();
+}
+
 // -----------------------------------------------------------------------------
 // Creates and returns the toolbar for this script panel
 // -----------------------------------------------------------------------------
@@ -187,6 +325,7 @@ SToolBar* ScriptPanel::setupToolbar()
 	// Create Script toolbar
 	auto tbg_script = new SToolBarGroup(toolbar, "_Script");
 	tbg_script->addActionButton("scrm_run", "", true);
+	tbg_script->addActionButton("scrm_profile", "", true);
 	tbg_script->addActionButton("scrm_save", "", true)->Enable(!script_->read_only);
 	toolbar->addGroup(tbg_script);
 
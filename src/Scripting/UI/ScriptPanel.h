@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Scripting/Lua.h"
+
 namespace slade
 {
 namespace scriptmanager
@@ -9,6 +11,7 @@ namespace scriptmanager
 class TextEditorCtrl;
 class FindReplacePanel;
 class SToolBar;
+class ScriptProfileList;
 
 class ScriptPanel : public wxPanel
 {
@@ -24,11 +27,14 @@ public:
 	bool save();
 
 	bool handleAction(string_view id);
+	void showProfile(const vector<lua::ProfileEntry>& profile);
 
 private:
 	scriptmanager::Script* script_             = nullptr;
 	TextEditorCtrl*        text_editor_        = nullptr;
 	FindReplacePanel*      find_replace_panel_ = nullptr;
+	wxStaticText*          label_profile_      = nullptr;
+	ScriptProfileList*     list_profile_       = nullptr;
 	long                   last_saved_         = 0;
 
 	SToolBar* setupToolbar();
@@ -46,6 +46,36 @@ using namespace slade;
 CVAR(Bool, debug_lexer, false, CVar::Flag::Secret)
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the style for a word with TextLanguage::wordFlags [flags], or 0 if
+// it isn't in any word list. Keywords take priority, then types, functions,
+// properties and constants
+// -----------------------------------------------------------------------------
+int wordStyle(uint8_t flags)
+{
+	if (flags & TextLanguage::wordFlag(TextLanguage::WordType::Keyword))
+		return Lexer::Style::Keyword;
+	if (flags & TextLanguage::wordFlag(TextLanguage::WordType::Type))
+		return Lexer::Style::Type;
+	if (flags & TextLanguage::FunctionFlag)
+		return Lexer::Style::Function;
+	if (flags & TextLanguage::wordFlag(TextLanguage::WordType::Property))
+		return Lexer::Style::Property;
+	if (flags & TextLanguage::wordFlag(TextLanguage::WordType::Constant))
+		return Lexer::Style::Constant;
+
+	return 0;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Lexer Class Functions
@@ -76,24 +106,12 @@ Lexer::Lexer() :
 void Lexer::loadLanguage(TextLanguage* language)
 {
 	language_ = language;
-	clearWords();
 	comment_blocks_.clear();
+	lines_.clear();
 
 	if (!language)
 		return;
 
-	// Load language words
-	for (const auto& word : language->wordListSorted(TextLanguage::WordType::Constant))
-		addWord(word, Lexer::Style::Constant);
-	for (const auto& word : language->wordListSorted(TextLanguage::WordType::Property))
-		addWord(word, Lexer::Style::Property);
-	for (const auto& word : language->functionsSorted())
-		addWord(word, Lexer::Style::Function);
-	for (const auto& word : language->wordListSorted(TextLanguage::WordType::Type))
-		addWord(word, Lexer::Style::Type);
-	for (const auto& word : language->wordListSorted(TextLanguage::WordType::Keyword))
-		addWord(word, Lexer::Style::Keyword);
-
 	// Load language info
 	preprocessor_char_ = language->preprocessor().empty() ? (char)0 : (char)language->preprocessor()[0];
 }
@@ -101,9 +119,9 @@ void Lexer::loadLanguage(TextLanguage* language)
 // -----------------------------------------------------------------------------
 // Performs text styling on [editor], for characters from [start] to [end].
 // Returns true if the next line needs to be styled (eg. for multi-line
-// comments)
+// comments), ie. the line ends in a different state than when last styled
 // ----------------------------------------------------------------------------
-void Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
+bool Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
 {
 	if (start < 0)
 		start = 0;
@@ -124,13 +142,24 @@ void Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
 	bool done = false;
 	while (!done)
 	{
+		// Comment (only styled up to the end of the line, so that each line's
+		// info is updated)
 		auto cb = isWithinComment(state.position);
 		if (cb >= 0)
 		{
-			editor->SetStyling(comment_blocks_[cb].end_pos - state.position, Style::Comment);
-			state.position = comment_blocks_[cb].end_pos;
+			// Style the single character token before the comment, if any
+			if (state.state == State::Operator)
+				editor->SetStyling(state.length, Style::Operator);
+			else if (state.state == State::Whitespace)
+				editor->SetStyling(state.length, Style::Default);
+
+			auto cb_end = std::min(comment_blocks_[cb].end_pos, state.end + 1);
+			editor->SetStyling(cb_end - state.position, Style::Comment);
+			state.position = cb_end;
 			state.line     = editor->LineFromPosition(state.position);
 			state.state    = State::Unknown;
+			if (state.position > state.end)
+				break;
 			continue;
 		}
 
@@ -145,23 +174,39 @@ void Lexer::doStyling(TextEditorCtrl* editor, int start, int end)
 		}
 	}
 
-	// Set current & next line's info
-	lines_[line].fold_increment = state.fold_increment;
-	lines_[line].has_word       = state.has_word;
+	// Check if the line ends within a block comment (ie. not a line comment)
+	auto next_pos = editor->PositionFromLine(line + 1);
+	if (next_pos < 0)
+		next_pos = editor->GetTextLength();
+	auto cb       = isWithinComment(next_pos - 1);
+	auto in_block = cb >= 0 && !checkToken(editor, comment_blocks_[cb].start_pos, language_->lineCommentL());
+
+	// Set current line's info
+	auto& info          = lineInfo(line);
+	auto  end_state     = in_block ? LineEnd::Comment : LineEnd::Code;
+	auto  changed       = info.end_state != end_state;
+	info.fold_increment = state.fold_increment;
+	info.has_word       = state.has_word;
+	info.end_state      = end_state;
+
+	return changed;
 }
 
 // ----------------------------------------------------------------------------
 // Updates and styles comments in [editor], for characters from [start] to
-// [end].
+// [end]. The range is extended to cover any comment blocks it changes, so
+// that only the affected part of comment_blocks_ is replaced
 // ----------------------------------------------------------------------------
 void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 {
+	// Do not look for comments if no language is loaded
 	if (!language_)
 		return;
 
 	// Block comment handling
 	auto& block_begin = language_->commentBeginL();
 	auto& block_end   = language_->commentEndL();
+	auto  text_end    = editor->GetTextLength();
 	int   token_index;
 
 	// Extend start/end if either is within a comment
@@ -172,26 +217,16 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 	if (cb >= 0)
 		end = comment_blocks_[cb].end_pos;
 
-	// Remove any existing comment blocks within start->end
-	for (int i = comment_blocks_.size() - 1; i >= 0; --i)
-	{
-		if (comment_blocks_[i].start_pos >= start && comment_blocks_[i].end_pos <= end)
-			comment_blocks_.erase(comment_blocks_.begin() + i);
-	}
-
-	// Do not look for comments if no language is loaded
-	if (!language_)
-		return;
-
 	// Scan text
-	auto pos = start;
+	vector<CommentBlock> blocks;
+	auto                 pos = start;
 	while (pos < end)
 	{
-		// Skip quoted strings
+		// Skip quoted strings (up to the end of the line, as when styling)
 		if (editor->GetCharAt(pos) == '\"')
 		{
 			while (pos++ < end)
-				if (editor->GetCharAt(pos) == '\"')
+				if (editor->GetCharAt(pos) == '\"' || editor->GetCharAt(pos) == '\n')
 					break;
 
 			++pos;
@@ -202,56 +237,120 @@ void Lexer::updateComments(TextEditorCtrl* editor, int start, int end)
 		if (checkToken(editor, pos, language_->lineCommentL()))
 		{
 			const auto l_end = editor->GetLineEndPosition(editor->LineFromPosition(pos)) + 1;
-			comment_blocks_.push_back({ pos, l_end });
+			blocks.push_back({ pos, l_end });
 			pos = l_end;
-			continue;
 		}
 
-		// Block comment
-		if (checkToken(editor, pos, block_begin, &token_index))
+		// Block comment (can run past the end of the range if it was opened or extended)
+		else if (checkToken(editor, pos, block_begin, &token_index))
 		{
 			auto& end_token = block_end[token_index];
 			auto  cb_start  = pos;
-			pos += block_begin[token_index].size();
-			while (pos < end)
-			{
-				if (checkToken(editor, pos, end_token))
-				{
-					pos += end_token.size();
-					break;
-				}
-				++pos;
-			}
+			auto  cb_end    = editor->FindText(
+				pos + block_begin[token_index].size(), text_end, end_token, wxSTC_FIND_MATCHCASE);
+			pos = cb_end < 0 ? text_end : cb_end + static_cast<int>(end_token.size());
 
-			comment_blocks_.push_back({ cb_start, pos });
-			continue;
+			blocks.push_back({ cb_start, pos });
 		}
 
-		++pos;
+		else
+			++pos;
+
+		// If a new comment ends partway through an existing one, extend the range to
+		// rescan the rest of it
+		if (pos >= end)
+		{
+			end = std::max(end, pos);
+			cb  = isWithinComment(end);
+			if (cb >= 0 && comment_blocks_[cb].start_pos < end)
+				end = comment_blocks_[cb].end_pos;
+		}
+	}
+
+	// Replace existing comment blocks within start->end with the new ones
+	auto first = std::lower_bound(
+		comment_blocks_.begin(),
+		comment_blocks_.end(),
+		start,
+		[](const CommentBlock& block, int p) { return block.end_pos <= p; });
+	auto last = std::lower_bound(
+		first, comment_blocks_.end(), end, [](const CommentBlock& block, int p) { return block.start_pos < p; });
+	first = comment_blocks_.erase(first, last);
+	comment_blocks_.insert(first, blocks.begin(), blocks.end());
+}
+
+// -----------------------------------------------------------------------------
+// Updates comment block positions and line info after [length] characters were
+// inserted (or deleted if negative) at [position] in [editor], adding
+// [lines_added] lines. The modified lines will need restyling
+// -----------------------------------------------------------------------------
+void Lexer::textModified(TextEditorCtrl* editor, int position, int length, int lines_added)
+{
+	// Shift comment blocks after the modification, clipping any that had text
+	// deleted from them
+	auto del_end = position - length;
+	auto shift   = [&](int pos, bool block_end) {
+		if (length > 0)
+			return pos > position || (pos == position && !block_end) ? pos + length : pos;
+		if (pos <= position)
+			return pos;
+		return pos >= del_end ? pos + length : position;
+	};
+	auto first = std::lower_bound(
+		comment_blocks_.begin(),
+		comment_blocks_.end(),
+		position,
+		[](const CommentBlock& block, int pos) { return block.end_pos < pos; });
+	for (auto i = first; i != comment_blocks_.end(); ++i)
+	{
+		i->start_pos = shift(i->start_pos, false);
+		i->end_pos   = shift(i->end_pos, true);
 	}
+	comment_blocks_.erase(
+		std::remove_if(
+			first, comment_blocks_.end(), [](const CommentBlock& block) { return block.end_pos <= block.start_pos; }),
+		comment_blocks_.end());
+
+	// Insert/remove line info to match, invalidating the modified line
+	auto line = editor->LineFromPosition(position);
+	if (line >= static_cast<int>(lines_.size()))
+		return;
+	if (lines_added > 0)
+		lines_.insert(lines_.begin() + line + 1, lines_added, LineInfo{});
+	else if (lines_added < 0)
+		lines_.erase(
+			lines_.begin() + std::min<int>(line + 1, lines_.size()),
+			lines_.begin() + std::min<int>(line + 1 - lines_added, lines_.size()));
+	lines_[line] = { 0, lines_[line].fold_level };
 }
 
 // -----------------------------------------------------------------------------
-// Sets the [style] for [word]
+// Returns true if [line] has been styled since it was last modified
 // -----------------------------------------------------------------------------
-void Lexer::addWord(string_view word, int style)
+bool Lexer::lineStyled(int line) const
 {
-	word_list_[language_->caseSensitive() ? string{ word } : strutil::lower(word)].style = (char)style;
+	return line < static_cast<int>(lines_.size()) && lines_[line].end_state != LineEnd::Unknown;
 }
 
 // -----------------------------------------------------------------------------
-// Applies a style to [word] in [editor], depending on if it is in the word
-// list, a number or begins with the preprocessor character
+// Applies a style to [word] in [editor], depending on if it is in the
+// language's word lists, a number or begins with the preprocessor character
 // -----------------------------------------------------------------------------
 void Lexer::styleWord(LexerState& state, string_view word)
 {
-	string word_str{ word };
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word_str);
+	applyWordStyle(state, word, language_->wordFlags(word));
+}
 
-	if (word_list_[word_str].style > 0)
-		state.editor->SetStyling(word.length(), word_list_[word_str].style);
-	else if (strutil::startsWith(word_str, language_->preprocessor()))
+// -----------------------------------------------------------------------------
+// Applies a style to [word] in [editor], with [flags] from the language's word
+// table (see TextLanguage::wordFlags)
+// -----------------------------------------------------------------------------
+void Lexer::applyWordStyle(LexerState& state, string_view word, uint8_t flags) const
+{
+	auto style = wordStyle(flags);
+	if (style > 0)
+		state.editor->SetStyling(word.length(), style);
+	else if (strutil::startsWith(word, language_->preprocessor()))
 		state.editor->SetStyling(word.length(), Style::Preprocessor);
 	else
 	{
@@ -671,33 +770,64 @@ bool Lexer::checkToken(TextEditorCtrl* editor, int pos, const vector<string>& to
 // Checks if [pos] is within a block comment, and returns the index for
 // comment_blocks_ if it is (-1 otherwise)
 // ----------------------------------------------------------------------------
-int Lexer::isWithinComment(int pos)
+int Lexer::isWithinComment(int pos) const
+{
+	auto block = std::upper_bound(
+		comment_blocks_.begin(),
+		comment_blocks_.end(),
+		pos,
+		[](int p, const CommentBlock& block) { return p < block.start_pos; });
+	if (block == comment_blocks_.begin() || pos >= (--block)->end_pos)
+		return -1;
+
+	return block - comment_blocks_.begin();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the info for [line], adding it if needed
+// -----------------------------------------------------------------------------
+Lexer::LineInfo& Lexer::lineInfo(int line)
 {
-	for (unsigned i = 0; i < comment_blocks_.size(); ++i)
-		if (pos >= comment_blocks_[i].start_pos && pos < comment_blocks_[i].end_pos)
-			return i;
+	if (line >= static_cast<int>(lines_.size()))
+		lines_.resize(line + 1);
 
-	return -1;
+	return lines_[line];
 }
 
 // ---------------------------------------------------------------------------
-// Updates code folding levels in [editor], starting from line [line_start]
+// Updates code folding levels in [editor], starting from line [line_start].
+// Lines after [line_end] (the last restyled line) are only updated until one
+// starts at the same fold level as it did last time
 // -----------------------------------------------------------------------------
-void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
+void Lexer::updateFolding(TextEditorCtrl* editor, int line_start, int line_end)
 {
-	int fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
+	// Start from the previous line, since it may have [line_start]'s fold header
+	if (line_start > 0)
+		--line_start;
+
+	int fold_level = lineInfo(line_start).fold_level;
+	if (fold_level < 0)
+		fold_level = editor->GetFoldLevel(line_start) & wxSTC_FOLDLEVELNUMBERMASK;
 
 	for (int l = line_start; l < editor->GetLineCount(); l++)
 	{
+		auto& info = lineInfo(l);
+
+		// Following lines are unchanged if this one is (unless its fold header
+		// is on the previous line, which will need to be set again)
+		if (l > line_end && info.fold_level == fold_level && (info.fold_increment <= 0 || info.has_word))
+			break;
+		info.fold_level = fold_level;
+
 		// Determine next line's fold level
-		int next_level = fold_level + lines_[l].fold_increment;
+		int next_level = fold_level + info.fold_increment;
 		if (next_level < wxSTC_FOLDLEVELBASE)
 			next_level = wxSTC_FOLDLEVELBASE;
 
 		// Check if we are going up a fold level
 		if (next_level > fold_level)
 		{
-			if (!lines_[l].has_word)
+			if (!info.has_word)
 			{
 				// Line doesn't have any words (eg. only has an opening brace),
 				// move the fold header up a line
@@ -721,9 +851,7 @@ void Lexer::updateFolding(TextEditorCtrl* editor, int line_start)
 bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 {
 	auto word = editor->GetTextRange(start_pos, end_pos).ToStdString();
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word);
-	return word_list_[word].style == (int)Style::Function;
+	return language_ && wordStyle(language_->wordFlags(word)) == Style::Function;
 }
 
 
@@ -734,56 +862,32 @@ bool Lexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos)
 // -----------------------------------------------------------------------------
 
 
-// -----------------------------------------------------------------------------
-// Sets the [style] for [word], or adds it to the functions list if [style]
-// is Function
-// -----------------------------------------------------------------------------
-void ZScriptLexer::addWord(string_view word, int style)
-{
-	if (style == Style::Function)
-		functions_.push_back(language_->caseSensitive() ? string{ word } : strutil::lower(word));
-	else
-		Lexer::addWord(word, style);
-}
-
 // -----------------------------------------------------------------------------
 // ZScript version of Lexer::styleWord - functions require a following '('
 // -----------------------------------------------------------------------------
 void ZScriptLexer::styleWord(LexerState& state, string_view word)
 {
-	// Skip whitespace after word
-	auto index = state.position;
-	while (index < state.end)
+	auto flags = language_->wordFlags(word);
+	if (flags & TextLanguage::FunctionFlag)
 	{
-		if (!(VECTOR_EXISTS(whitespace_chars_, state.editor->GetCharAt(index))))
-			break;
-		++index;
-	}
-
-	// Check for '(' (possible function)
-	if (state.editor->GetCharAt(index) == '(')
-	{
-		string word_str{ word };
-		if (!language_->caseSensitive())
-			strutil::lowerIP(word_str);
+		// Skip whitespace after word
+		auto index = state.position;
+		while (index < state.end)
+		{
+			if (!(VECTOR_EXISTS(whitespace_chars_, state.editor->GetCharAt(index))))
+				break;
+			++index;
+		}
 
-		if (VECTOR_EXISTS(functions_, word_str))
+		// Check for '('
+		if (state.editor->GetCharAt(index) == '(')
 		{
 			state.editor->SetStyling(word.length(), Style::Function);
 			return;
 		}
 	}
 
-	Lexer::styleWord(state, word);
-}
-
-// -----------------------------------------------------------------------------
-// Clears out all defined words
-// -----------------------------------------------------------------------------
-void ZScriptLexer::clearWords()
-{
-	functions_.clear();
-	Lexer::clearWords();
+	applyWordStyle(state, word, flags & ~TextLanguage::FunctionFlag);
 }
 
 // -----------------------------------------------------------------------------
@@ -808,7 +912,5 @@ bool ZScriptLexer::isFunction(TextEditorCtrl* editor, int start_pos, int end_pos
 
 	// Check if word is a function name
 	auto word = editor->GetTextRange(start_pos, end_pos).ToStdString();
-	if (!language_->caseSensitive())
-		strutil::lowerIP(word);
-	return VECTOR_EXISTS(functions_, word);
+	return language_ && (language_->wordFlags(word) & TextLanguage::FunctionFlag);
 }
@@ -32,17 +32,17 @@ public:
 
 	virtual void loadLanguage(TextLanguage* language);
 
-	virtual void doStyling(TextEditorCtrl* editor, int start, int end);
+	virtual bool doStyling(TextEditorCtrl* editor, int start, int end);
 	void         updateComments(TextEditorCtrl* editor, int start, int end);
+	void         textModified(TextEditorCtrl* editor, int position, int length, int lines_added);
+	bool         lineStyled(int line) const;
 
-	virtual void addWord(string_view word, int style);
-	virtual void clearWords() { word_list_.clear(); }
 	virtual void resetLineInfo() { lines_.clear(); }
 
 	void setWordChars(string_view chars);
 	void setOperatorChars(string_view chars);
 
-	void updateFolding(TextEditorCtrl* editor, int line_start);
+	void updateFolding(TextEditorCtrl* editor, int line_start, int line_end);
 	void foldComments(bool fold) { fold_comments_ = fold; }
 	void foldPreprocessor(bool fold) { fold_preprocessor_ = fold; }
 
@@ -72,27 +72,29 @@ protected:
 	bool                  fold_preprocessor_ = false;
 	char                  preprocessor_char_;
 
-	struct WLIndex
+	// State at the end of a line, to check if styling the next line is needed
+	enum class LineEnd : uint8_t
 	{
-		char style;
-		WLIndex() : style(0) {}
+		Unknown, // Not styled since it was last modified
+		Code,
+		Comment
 	};
-	std::map<string, WLIndex> word_list_;
 
 	struct LineInfo
 	{
-		int  fold_increment;
-		bool has_word;
-		LineInfo() : fold_increment{ 0 }, has_word{ false } {}
+		int     fold_increment = 0;
+		int     fold_level     = -1; // Fold level at the start of the line when folding was last updated
+		bool    has_word       = false;
+		LineEnd end_state      = LineEnd::Unknown;
 	};
-	std::map<int, LineInfo> lines_;
+	vector<LineInfo> lines_;
 
 	struct CommentBlock
 	{
 		int start_pos = -1;
 		int end_pos   = -1;
 	};
-	vector<CommentBlock> comment_blocks_;
+	vector<CommentBlock> comment_blocks_; // Sorted by position, never overlapping
 
 	struct LexerState
 	{
@@ -113,9 +115,12 @@ protected:
 	bool processWhitespace(LexerState& state);
 
 	virtual void styleWord(LexerState& state, string_view word);
+	void         applyWordStyle(LexerState& state, string_view word, uint8_t flags) const;
 	bool         checkToken(TextEditorCtrl* editor, int pos, string_view token) const;
 	bool checkToken(TextEditorCtrl* editor, int pos, const vector<string>& tokens, int* found_idx = nullptr) const;
-	int  isWithinComment(int pos);
+	int  isWithinComment(int pos) const;
+
+	LineInfo& lineInfo(int line);
 };
 
 class ZScriptLexer : public Lexer
@@ -125,12 +130,7 @@ public:
 	virtual ~ZScriptLexer() = default;
 
 protected:
-	void addWord(string_view word, int style) override;
 	void styleWord(LexerState& state, string_view word) override;
-	void clearWords() override;
 	bool isFunction(TextEditorCtrl* editor, int start_pos, int end_pos) override;
-
-private:
-	vector<string> functions_;
 };
 } // namespace slade
@@ -52,6 +52,48 @@ using namespace slade;
 vector<TextLanguage*> text_languages;
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns [c] lowercased if [fold] is true
+// -----------------------------------------------------------------------------
+char foldChar(char c, bool fold)
+{
+	return fold && c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the (FNV-1a) hash of [word], lowercased if [fold] is true
+// -----------------------------------------------------------------------------
+uint32_t wordHash(string_view word, bool fold)
+{
+	uint32_t hash = 2166136261u;
+	for (auto c : word)
+		hash = (hash ^ static_cast<uint8_t>(foldChar(c, fold))) * 16777619u;
+
+	return hash;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [word] (lowercased if [fold] is true) matches the same
+// length of [chars]
+// -----------------------------------------------------------------------------
+bool wordMatches(string_view word, const char* chars, bool fold)
+{
+	for (auto c : word)
+		if (foldChar(c, fold) != *chars++)
+			return false;
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // TLFunction Class Functions
@@ -276,6 +318,7 @@ void TextLanguage::copyTo(TextLanguage* copy)
 
 	// Copy functions
 	copy->functions_ = functions_;
+	copy->word_table_.clear();
 
 	// Copy preprocessor/word block begin/end
 	copy->pp_block_begin_   = pp_block_begin_;
@@ -292,7 +335,10 @@ void TextLanguage::addWord(WordType type, string_view keyword, bool custom)
 	// Add only if it doesn't already exist
 	auto& list = custom ? word_lists_custom_[type].list : word_lists_[type].list;
 	if (std::find(list.begin(), list.end(), keyword) == list.end())
+	{
 		list.emplace_back(keyword);
+		word_table_.clear();
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -325,6 +371,7 @@ void TextLanguage::addFunction(
 	{
 		functions_.emplace_back(func_name);
 		func = &functions_.back();
+		word_table_.clear();
 	}
 	// Clear the function if we're replacing it
 	else if (replace)
@@ -365,6 +412,7 @@ void TextLanguage::loadZScript(zscript::Definitions& defs, bool custom)
 			{
 				functions_.emplace_back(f.name());
 				func = &functions_.back();
+				word_table_.clear();
 			}
 
 			// Add the context
@@ -558,6 +606,89 @@ void TextLanguage::clearCustomDefs()
 
 	for (auto& a : word_lists_custom_)
 		a.list.clear();
+
+	word_table_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Returns flags for the types of [word] in this language: wordFlag(type) for
+// each word list it is in, and FunctionFlag if it is a function name
+// -----------------------------------------------------------------------------
+uint8_t TextLanguage::wordFlags(string_view word)
+{
+	if (word_table_.empty())
+		buildWordTable();
+
+	if (word.empty())
+		return 0;
+
+	return wordTableSlot(word, wordHash(word, !case_sensitive_)).flags;
+}
+
+// -----------------------------------------------------------------------------
+// (Re)builds the word lookup table from all word lists (including custom) and
+// functions
+// -----------------------------------------------------------------------------
+void TextLanguage::buildWordTable()
+{
+	// Size the table to be at most half full
+	auto n_words = functions_.size();
+	for (unsigned a = 0; a < 4; a++)
+		n_words += word_lists_[a].list.size() + word_lists_custom_[a].list.size();
+	size_t size = 16;
+	while (size < n_words * 2)
+		size *= 2;
+
+	word_table_.assign(size, {});
+	word_table_chars_.clear();
+
+	auto fold     = !case_sensitive_;
+	auto add_word = [&](string_view word, uint8_t flag) {
+		if (word.empty())
+			return;
+
+		auto  hash = wordHash(word, fold);
+		auto& slot = wordTableSlot(word, hash);
+		if (slot.length == 0)
+		{
+			slot.hash   = hash;
+			slot.offset = word_table_chars_.size();
+			slot.length = word.size();
+			for (auto c : word)
+				word_table_chars_ += foldChar(c, fold);
+		}
+		slot.flags |= flag;
+	};
+
+	for (unsigned a = 0; a < 4; a++)
+	{
+		for (const auto& word : word_lists_[a].list)
+			add_word(word, wordFlag(static_cast<WordType>(a)));
+		for (const auto& word : word_lists_custom_[a].list)
+			add_word(word, wordFlag(static_cast<WordType>(a)));
+	}
+	for (const auto& func : functions_)
+		add_word(func.name(), FunctionFlag);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the word table slot for [word] (with [hash]), which will be empty if
+// [word] isn't in the table
+// -----------------------------------------------------------------------------
+TextLanguage::WordTableEntry& TextLanguage::wordTableSlot(string_view word, uint32_t hash)
+{
+	auto fold = !case_sensitive_;
+	auto mask = word_table_.size() - 1;
+	for (auto i = hash & mask;; i = (i + 1) & mask)
+	{
+		auto& slot = word_table_[i];
+		if (slot.length == 0)
+			return slot;
+
+		if (slot.hash == hash && slot.length == word.size()
+			&& wordMatches(word, word_table_chars_.data() + slot.offset, fold))
+			return slot;
+	}
 }
 
 
@@ -139,7 +139,11 @@ public:
 	void setCommentEndList(vector<string> token) { comment_end_l_ = std::move(token); };
 	void setPreprocessor(string_view token) { preprocessor_ = token; }
 	void setDocComment(string_view token) { doc_comment_ = token; }
-	void setCaseSensitive(bool cs) { case_sensitive_ = cs; }
+	void setCaseSensitive(bool cs)
+	{
+		case_sensitive_ = cs;
+		word_table_.clear();
+	}
 	void addWord(WordType type, string_view word, bool custom = false);
 	void addFunction(
 		string_view name,
@@ -163,10 +167,24 @@ public:
 	bool isWord(WordType type, string_view word);
 	bool isFunction(string_view word);
 
+	// Word flags (see wordFlags)
+	static constexpr uint8_t FunctionFlag = 1 << 4;
+	static constexpr uint8_t wordFlag(WordType type) { return 1 << type; }
+
+	uint8_t wordFlags(string_view word);
+
 	TLFunction* function(string_view name);
 
-	void clearWordList(WordType type) { word_lists_[type].list.clear(); }
-	void clearFunctions() { functions_.clear(); }
+	void clearWordList(WordType type)
+	{
+		word_lists_[type].list.clear();
+		word_table_.clear();
+	}
+	void clearFunctions()
+	{
+		functions_.clear();
+		word_table_.clear();
+	}
 	void clearCustomDefs();
 
 	// Static functions
@@ -219,5 +237,21 @@ private:
 		string deprecated_f;
 	};
 	std::map<string, ZFuncExProp> zfuncs_ex_props_;
+
+	// Hash table of all words and function names (lowercased if not case
+	// sensitive) for quick lookups when styling text, rebuilt when next needed
+	// after any changes
+	struct WordTableEntry
+	{
+		uint32_t hash   = 0;
+		uint32_t offset = 0; // Offset of the word in word_table_chars_
+		uint32_t length = 0; // 0 if the slot is empty
+		uint8_t  flags  = 0;
+	};
+	vector<WordTableEntry> word_table_;
+	string                 word_table_chars_;
+
+	void            buildWordTable();
+	WordTableEntry& wordTableSlot(string_view word, uint32_t hash);
 };
 } // namespace slade
@@ -40,7 +40,9 @@
 #include "SCallTip.h"
 #include "SLADEWxApp.h"
 #include "UI/WxUtils.h"
+#include "Utility/CodePages.h"
 #include "Utility/StringUtils.h"
+#include "Utility/ThreadPool.h"
 #include "Utility/Tokenizer.h"
 
 using namespace slade;
@@ -76,9 +78,46 @@ CVAR(Bool, txed_tab_spaces, false, CVar::Flag::Save)
 CVAR(Int, txed_show_whitespace, 0, CVar::Flag::Save)
 CVAR(Bool, txed_calltips_argset_kb, true, CVar::Flag::Save)
 
-wxDEFINE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDEFINE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
+namespace
+{
+constexpr unsigned LOAD_CHUNK_SIZE = 1024 * 1024; // Size of the chunks text is added to the editor in
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns true if [point] is before [position], for searching sorted points
+// -----------------------------------------------------------------------------
+bool jumpPointBefore(const JumpToCalculator::JumpPoint& point, int position)
+{
+	return point.position < position;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the size of a chunk of UTF-8 [data] from [pos], of at most
+// LOAD_CHUNK_SIZE bytes and not ending part way through a character
+// -----------------------------------------------------------------------------
+unsigned utf8ChunkSize(const uint8_t* data, unsigned size, unsigned pos)
+{
+	if (size - pos <= LOAD_CHUNK_SIZE)
+		return size - pos;
+
+	auto end = pos + LOAD_CHUNK_SIZE;
+	while (end > pos && (data[end] & 0xC0) == 0x80)
+		--end;
+
+	return end - pos;
+}
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -88,72 +127,82 @@ wxDEFINE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 
 // -----------------------------------------------------------------------------
-// JumpToCalculator thread entry function
+// Finds all jump points in the text. Once a block keyword is reached in the
+// unchanged part of the text where one was found last time, the rest of the
+// points are the same as last time and scanning stops there
 // -----------------------------------------------------------------------------
-wxThread::ExitCode JumpToCalculator::Entry()
+void JumpToCalculator::calculate(const Job& job)
 {
-	wxString jump_points;
+	// Get jump block keywords (and number of tokens to skip after them)
+	vector<std::pair<string, int>> blocks;
+	for (const auto& block : block_names_)
+	{
+		auto sp = strutil::split(block, ':');
+		blocks.emplace_back(sp[0], sp.size() > 1 ? strutil::asInt(sp.back()) : 0);
+	}
 
 	Tokenizer tz;
 	tz.setSpecialCharacters(";,:|={}/()");
 	tz.openString(text_);
 
-	wxString token = tz.getToken();
+	string token;
+	int    token_pos  = 0;
+	auto   next_token = [&]() {
+		token_pos = text_start_ + static_cast<int>(tz.current().pos_start);
+		token     = tz.getToken();
+	};
+
+	auto unchanged = unchanged_.begin();
+	next_token();
 	while (!tz.atEnd())
 	{
+		if (job.cancelled())
+			return;
+
 		if (token == "{")
 		{
 			// Skip block
 			while (!tz.atEnd() && token != "}")
 				token = tz.getToken();
 		}
-
-		for (auto block : block_names_)
+		else if (token_pos >= unchanged_start_)
 		{
-			// Get jump block keyword
-			long skip = 0;
-			if (strutil::contains(block, ':'))
+			// Check for a previously found block keyword
+			while (unchanged != unchanged_.end() && unchanged->position < token_pos)
+				++unchanged;
+			if (unchanged != unchanged_.end() && unchanged->position == token_pos)
 			{
-				auto sp = wxSplit(block, ':');
-				sp.back().ToLong(&skip);
-				block = sp[0];
+				points_.insert(points_.end(), unchanged, unchanged_.end());
+				return;
 			}
+		}
 
-			if (S_CMPNOCASE(token, block))
+		for (const auto& block : blocks)
+		{
+			if (strutil::equalCI(token, block.first))
 			{
-				wxString name = tz.getToken();
-				for (int s = 0; s < skip; s++)
+				string name = tz.getToken();
+				for (int s = 0; s < block.second; s++)
 					name = tz.getToken();
 
 				for (const auto& i : ignore_)
-					if (S_CMPNOCASE(name, i))
+					if (strutil::equalCI(name, i))
 						name = tz.getToken();
 
 				// Numbered block, add block name
-				if (name.IsNumber())
-					name = wxString::Format("%s %s", block, name);
+				if (strutil::isInteger(name, false))
+					name = block.first + " " + name;
 				// Unnamed block, use block name
 				if (name == "{" || name == ";")
-					name = block;
+					name = block.first;
 
 				// Add jump point
-				jump_points += wxString::Format("%d,%s,", tz.lineNo() - 1, name);
+				points_.push_back({ text_line_ + static_cast<int>(tz.lineNo()) - 1, token_pos, name });
 			}
 		}
 
-		token = tz.getToken();
+		next_token();
 	}
-
-	// Remove ending comma
-	if (!jump_points.empty())
-		jump_points.RemoveLast(1);
-
-	// Send event
-	auto event = new wxThreadEvent(wxEVT_COMMAND_JTCALCULATOR_COMPLETED);
-	event->SetString(jump_points);
-	wxQueueEvent(handler_, event);
-
-	return nullptr;
 }
 
 
@@ -184,6 +233,9 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	// Border margin
 	SetMarginWidth(2, 4);
 
+	// Only send modified events for text changes (not styling, markers, etc.)
+	SetModEventMask(wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT);
+
 	// Register icons for autocompletion list
 	RegisterImage(1, icons::getIcon(icons::TextEditor, "key"));
 	RegisterImage(2, icons::getIcon(icons::TextEditor, "const"));
@@ -212,8 +264,8 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 	Bind(wxEVT_KILL_FOCUS, &TextEditorCtrl::onFocusLoss, this);
 	Bind(wxEVT_ACTIVATE, &TextEditorCtrl::onActivate, this);
 	Bind(wxEVT_STC_MARGINCLICK, &TextEditorCtrl::onMarginClick, this);
-	Bind(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, &TextEditorCtrl::onJumpToCalculateComplete, this);
 	Bind(wxEVT_STC_CHANGE, &TextEditorCtrl::onModified, this);
+	Bind(wxEVT_STC_MODIFIED, &TextEditorCtrl::onTextModified, this);
 	Bind(wxEVT_TIMER, &TextEditorCtrl::onUpdateTimer, this);
 	Bind(wxEVT_STC_STYLENEEDED, &TextEditorCtrl::onStyleNeeded, this);
 }
@@ -224,6 +276,9 @@ TextEditorCtrl::TextEditorCtrl(wxWindow* parent, int id) :
 TextEditorCtrl::~TextEditorCtrl()
 {
 	StyleSet::removeEditor(this);
+
+	if (jump_to_job_)
+		jump_to_job_->cancel();
 }
 
 // -----------------------------------------------------------------------------
@@ -284,7 +339,8 @@ void TextEditorCtrl::setup()
 	setupFolding();
 
 	// Re-colour text
-	Colourise(0, GetTextLength());
+	lexer_->resetLineInfo();
+	colouriseVisible();
 
 	// Set word wrapping
 	if (txed_word_wrap)
@@ -383,14 +439,25 @@ bool TextEditorCtrl::setLanguage(TextLanguage* lang)
 	language_ = lang;
 
 	// Re-colour text
-	Colourise(0, GetTextLength());
+	colouriseVisible();
 
 	// Update Jump To list
+	clearJumpToPoints();
 	updateJumpToList();
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Styles the text up to the last visible line. The rest is styled when it is
+// scrolled into view (via onStyleNeeded), so large text isn't lexed up front
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::colouriseVisible()
+{
+	auto last_line = DocLineFromVisible(GetFirstVisibleLine() + LinesOnScreen());
+	Colourise(0, GetLineEndPosition(last_line));
+}
+
 // -----------------------------------------------------------------------------
 // Applies the styleset [style] to the text editor
 // -----------------------------------------------------------------------------
@@ -426,14 +493,33 @@ bool TextEditorCtrl::loadEntry(ArchiveEntry* entry)
 	if (entry->size() == 0 || !entry->rawData())
 		return true;
 
-	// Get character entry data
-	wxString text = wxString::FromUTF8((const char*)entry->rawData(), entry->size());
-	// If opening as UTF8 failed for some reason, try again as 8-bit data
-	if (text.length() == 0)
-		text = wxString::From8BitData((const char*)entry->rawData(), entry->size());
-
-	// Load text into editor
-	SetText(text);
+	// Add the entry data directly to the editor in chunks, rather than via a
+	// (full size) wxString. If it isn't valid UTF-8 it is read as 8-bit text
+	auto data = entry->rawData();
+	auto size = entry->size();
+	auto utf8 = codepages::isUTF8(data, size);
+	SetUndoCollection(false);
+	Allocate(utf8 ? size + 1 : size * 2 + 1);
+	string   chunk;
+	unsigned pos = 0;
+	while (pos < size)
+	{
+		if (utf8)
+		{
+			auto chunk_size = utf8ChunkSize(data, size, pos);
+			AddTextRaw(reinterpret_cast<const char*>(data + pos), chunk_size);
+			pos += chunk_size;
+		}
+		else
+		{
+			auto chunk_size = std::min(size - pos, LOAD_CHUNK_SIZE);
+			chunk.clear();
+			codepages::latin1ToUTF8(data + pos, chunk_size, chunk);
+			AddTextRaw(chunk.data(), chunk.size());
+			pos += chunk_size;
+		}
+	}
+	SetUndoCollection(true);
 	last_modified_ = app::runTimer();
 
 	// Update line numbers margin width
@@ -448,9 +534,9 @@ bool TextEditorCtrl::loadEntry(ArchiveEntry* entry)
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::getRawText(MemChunk& mc) const
 {
+	// The editor holds the text as UTF-8 already, so it can be copied directly
 	mc.clear();
-	wxString text = GetText();
-	mc.importMem((const uint8_t*)text.ToUTF8().data(), text.ToUTF8().length());
+	mc.importMem(reinterpret_cast<const uint8_t*>(GetCharacterPointer()), GetTextLength());
 }
 
 // -----------------------------------------------------------------------------
@@ -987,27 +1073,138 @@ void TextEditorCtrl::setJumpToControl(wxChoice* jump_to)
 {
 	choice_jump_to_ = jump_to;
 	choice_jump_to_->Bind(wxEVT_CHOICE, &TextEditorCtrl::onJumpToChoiceSelected, this);
+
+	wxArrayString items;
+	for (const auto& point : jump_to_points_)
+		items.push_back(wxString::FromUTF8(point.name));
+	choice_jump_to_->Set(items);
 }
 
 // -----------------------------------------------------------------------------
-// Begin updating the 'Jump To' list
+// Begin updating the 'Jump To' list (in the background). Only the text from
+// the last jump point before the text changed since the last update is
+// scanned again, and any update already running is cancelled
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::updateJumpToList()
 {
 	if (!choice_jump_to_)
 		return;
 
-	if (!language_ || jump_to_calculator_ || GetText().length() == 0)
+	if (!language_ || GetTextLength() == 0)
 	{
-		choice_jump_to_->Clear();
+		clearJumpToPoints();
+		return;
+	}
+
+	// Check anything changed
+	if (jump_to_changed_start_ < 0)
 		return;
+
+	if (jump_to_job_)
+		jump_to_job_->cancel();
+
+	// Rescan from the last jump point before the change (its block keyword is
+	// always read outside of any block, so scanning can safely start there)
+	auto     points = jump_to_points_.begin();
+	unsigned keep   = std::lower_bound(points, jump_to_points_.end(), jump_to_changed_start_, jumpPointBefore) - points;
+	int      start  = 0;
+	if (keep > 0)
+		start = jump_to_points_[--keep].position;
+
+	// Points after the change can be reused if they are reached again
+	auto unchanged = std::lower_bound(points + keep, jump_to_points_.end(), jump_to_changed_end_, jumpPointBefore);
+
+	auto text       = GetTextRangeRaw(start, GetTextLength());
+	auto calculator = std::make_shared<JumpToCalculator>(
+		string_view{ text.data(), text.length() },
+		start,
+		LineFromPosition(start),
+		language_->jumpBlocks(),
+		language_->jumpBlocksIgnored(),
+		jump_to_changed_end_,
+		vector<JumpToCalculator::JumpPoint>{ unchanged, jump_to_points_.end() });
+
+	// Begin calculation, any text change will cancel it
+	jump_to_job_ = Job::start([calculator](Job& job) { calculator->calculate(job); });
+	jump_to_job_->onComplete([this, calculator, keep]() { onJumpToCalculateComplete(calculator->points(), keep); });
+}
+
+// -----------------------------------------------------------------------------
+// Clears the 'Jump To' list, the next update will scan all of the text
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::clearJumpToPoints()
+{
+	if (jump_to_job_)
+	{
+		jump_to_job_->cancel();
+		jump_to_job_.reset();
+	}
+
+	jump_to_points_.clear();
+	jump_to_changed_start_ = 0;
+	jump_to_changed_end_   = GetTextLength();
+
+	if (choice_jump_to_)
+		choice_jump_to_->Clear();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the 'Jump To' points and changed text range after [length]
+// characters were inserted (or deleted if negative) at [position]
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::jumpToTextModified(int position, int length, int lines_added)
+{
+	// Any update in progress is now out of date
+	if (jump_to_job_)
+	{
+		jump_to_job_->cancel();
+		jump_to_job_.reset();
+	}
+
+	// Remove points within deleted text
+	auto point = std::lower_bound(jump_to_points_.begin(), jump_to_points_.end(), position, jumpPointBefore);
+	if (length < 0)
+	{
+		auto last = std::lower_bound(point, jump_to_points_.end(), position - length, jumpPointBefore);
+		if (choice_jump_to_)
+			for (auto i = last - jump_to_points_.begin(); i > point - jump_to_points_.begin(); --i)
+				choice_jump_to_->Delete(i - 1);
+		point = jump_to_points_.erase(point, last);
+	}
+
+	// Move points after the change
+	for (; point != jump_to_points_.end(); ++point)
+	{
+		point->position += length;
+		point->line += lines_added;
+	}
+
+	// Extend changed range
+	int change_end = std::max(position, position + length);
+	if (jump_to_changed_start_ < 0)
+	{
+		jump_to_changed_start_ = position;
+		jump_to_changed_end_   = change_end;
+	}
+	else
+	{
+		if (jump_to_changed_end_ >= position)
+			jump_to_changed_end_ = std::max(position, jump_to_changed_end_ + length);
+		jump_to_changed_start_ = std::min(jump_to_changed_start_, position);
+		jump_to_changed_end_   = std::max(jump_to_changed_end_, change_end);
 	}
+}
 
-	// Begin jump to calculation thread
-	choice_jump_to_->Enable(false);
-	jump_to_calculator_ = new JumpToCalculator(
-		this, wxutil::strToView(GetText()), language_->jumpBlocks(), language_->jumpBlocksIgnored());
-	jump_to_calculator_->Run();
+// -----------------------------------------------------------------------------
+// Moves the cursor to the end of [line] and scrolls to show it at the top
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::showLine(int line)
+{
+	int pos = GetLineEndPosition(line);
+	SetCurrentPos(pos);
+	SetSelection(pos, pos);
+	SetFirstVisibleLine(line);
+	SetFocus();
 }
 
 // -----------------------------------------------------------------------------
@@ -1048,6 +1245,8 @@ void TextEditorCtrl::foldAll(bool fold)
 	// FoldAll is only available in wxWidgets 3.1+
 	FoldAll(fold ? wxSTC_FOLDACTION_CONTRACT : wxSTC_FOLDACTION_EXPAND);
 #else
+	// Fold levels are only set for lines that have been styled
+	Colourise(0, GetTextLength());
 	for (int a = 0; a < GetNumberOfLines(); a++)
 	{
 		int level = GetFoldLevel(a);
@@ -1505,13 +1704,6 @@ void TextEditorCtrl::onCharAdded(wxStyledTextEvent& e)
 		// Comma, possibly update calltip
 		if (e.GetKey() == ',' && txed_calltips_parenthesis)
 			updateCalltip();
-
-		// Block comment ended
-		for (auto& end_token : language_->commentEndL())
-		{
-			if (GetTextRange(GetCurrentPos() - end_token.size(), GetCurrentPos()) == end_token)
-				block_comment_closed_ = true;
-		}
 	}
 
 	// Continue
@@ -1718,40 +1910,47 @@ void TextEditorCtrl::onMarginClick(wxStyledTextEvent& e)
 }
 
 // -----------------------------------------------------------------------------
-// Called when the 'Jump To' calculation thread completes
+// Called when the 'Jump To' calculation job completes with the [points] found
+// after the first [keep] existing points
 // -----------------------------------------------------------------------------
-void TextEditorCtrl::onJumpToCalculateComplete(wxThreadEvent& e)
+void TextEditorCtrl::onJumpToCalculateComplete(const vector<JumpToCalculator::JumpPoint>& points, unsigned keep)
 {
-	if (!choice_jump_to_)
-	{
-		jump_to_calculator_ = nullptr;
-		return;
-	}
-
-	choice_jump_to_->Clear();
-	jump_to_lines_.clear();
+	jump_to_job_.reset();
+	jump_to_changed_start_ = -1;
+	jump_to_changed_end_   = -1;
 
-	auto split = wxSplit(e.GetString(), ',');
+	vector<JumpToCalculator::JumpPoint> updated{ jump_to_points_.begin(), jump_to_points_.begin() + keep };
+	updated.insert(updated.end(), points.begin(), points.end());
 
-	wxArrayString items;
-	for (unsigned a = 0; a < split.size(); a += 2)
+	if (choice_jump_to_)
 	{
-		if (a == split.size() - 1)
-			break;
-
-		long line;
-		if (!split[a].ToLong(&line))
-			line = 0;
-		wxString name = split[a + 1];
-
-		items.push_back(name);
-		jump_to_lines_.push_back(line);
+		// Only update the items that changed (between any unchanged items at the start and end)
+		auto   old_count = jump_to_points_.size();
+		auto   count     = std::min(old_count, updated.size());
+		size_t first     = keep;
+		size_t suffix    = 0;
+		while (first < count && jump_to_points_[first].name == updated[first].name)
+			first++;
+		while (suffix < count - first
+			   && jump_to_points_[old_count - suffix - 1].name == updated[updated.size() - suffix - 1].name)
+			suffix++;
+
+		wxArrayString items;
+		for (auto a = first; a < updated.size() - suffix; ++a)
+			items.push_back(wxString::FromUTF8(updated[a].name));
+
+		if (first == 0 && suffix == 0)
+			choice_jump_to_->Set(items);
+		else
+		{
+			for (auto a = old_count - suffix; a > first; --a)
+				choice_jump_to_->Delete(a - 1);
+			if (!items.empty())
+				choice_jump_to_->Insert(items, first);
+		}
 	}
 
-	choice_jump_to_->Append(items);
-	choice_jump_to_->Enable(true);
-
-	jump_to_calculator_ = nullptr;
+	jump_to_points_ = std::move(updated);
 }
 
 // -----------------------------------------------------------------------------
@@ -1759,13 +1958,11 @@ void TextEditorCtrl::onJumpToCalculateComplete(wxThreadEvent& e)
 // -----------------------------------------------------------------------------
 void TextEditorCtrl::onJumpToChoiceSelected(wxCommandEvent& e)
 {
-	// Move to line
-	int line = jump_to_lines_[choice_jump_to_->GetSelection()];
-	int pos  = GetLineEndPosition(line);
-	SetCurrentPos(pos);
-	SetSelection(pos, pos);
-	SetFirstVisibleLine(line);
-	SetFocus();
+	auto selection = choice_jump_to_->GetSelection();
+	if (selection < 0 || selection >= static_cast<int>(jump_to_points_.size()))
+		return;
+
+	showLine(jump_to_points_[selection].line);
 	choice_jump_to_->SetSelection(-1);
 }
 
@@ -1789,6 +1986,23 @@ void TextEditorCtrl::onModified(wxStyledTextEvent& e)
 	e.Skip();
 }
 
+// -----------------------------------------------------------------------------
+// Called when text is inserted or deleted
+// -----------------------------------------------------------------------------
+void TextEditorCtrl::onTextModified(wxStyledTextEvent& e)
+{
+	// Keep lexer comment blocks, line info and jump to points in sync with the text
+	auto type = e.GetModificationType();
+	if (type & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))
+	{
+		int length = type & wxSTC_MOD_INSERTTEXT ? e.GetLength() : -e.GetLength();
+		lexer_->textModified(this, e.GetPosition(), length, e.GetLinesAdded());
+		jumpToTextModified(e.GetPosition(), length, e.GetLinesAdded());
+	}
+
+	e.Skip();
+}
+
 // -----------------------------------------------------------------------------
 // Called when the update timer finishes
 // -----------------------------------------------------------------------------
@@ -1812,36 +2026,50 @@ void TextEditorCtrl::onStyleNeeded(wxStyledTextEvent& e)
 	int line_start = LineFromPosition(GetEndStyled());
 	int line_end   = LineFromPosition(e.GetPosition());
 
-	// If a block comment was just closed, we need to style to the end of the text
-	if (block_comment_closed_)
-	{
-		lexer_->resetLineInfo();
-		line_end              = GetNumberOfLines();
-		block_comment_closed_ = false;
-	}
-
 	// Update comment block info
 	lexer_->updateComments(
 		this, line_start == 0 ? 0 : GetLineEndPosition(line_start - 1), GetLineEndPosition(line_end));
 
-	// Lex until done (end of lines, end of file or end of block comment)
-	int l = line_start;
-	while (l <= GetNumberOfLines() && (l <= line_end))
+	// Lex until done (end of lines or end of file). Once a line ends in the same
+	// state as when it was last styled, any following lines that haven't been
+	// modified since are already styled correctly and can be skipped
+	int  l         = line_start;
+	int  last      = line_start;
+	bool converged = false;
+	while (l < GetNumberOfLines() && (l <= line_end))
 	{
-		int end   = GetLineEndPosition(l) - 1;
-		int start = end - GetLineLength(l) + 1;
+		if (converged && lexer_->lineStyled(l))
+		{
+			l++;
+			continue;
+		}
+
+		int start = PositionFromLine(l);
+		int end   = PositionFromLine(l + 1) - 1;
 
 		if (start > end)
 			end = start;
 
-		lexer_->doStyling(this, start, end);
+		converged = !lexer_->doStyling(this, start, end);
+		last      = l;
 		l++;
 	}
 
+	// Mark any skipped lines at the end as styled
+	if (last < line_end && GetEndStyled() < e.GetPosition())
+	{
+#if wxMAJOR_VERSION < 3 || (wxMAJOR_VERSION == 3 && wxMINOR_VERSION < 1) \
+	|| (wxMAJOR_VERSION == 3 && wxMINOR_VERSION == 1 && wxRELEASE_NUMBER == 0)
+		StartStyling(e.GetPosition(), 31);
+#else
+		StartStyling(e.GetPosition());
+#endif
+	}
+
 	if (txed_fold_enable)
 	{
 		auto modified = last_modified_;
-		lexer_->updateFolding(this, line_start);
+		lexer_->updateFolding(this, line_start, last);
 		last_modified_ = modified;
 	}
 }
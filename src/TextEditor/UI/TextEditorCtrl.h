@@ -11,33 +11,57 @@ class wxCheckBox;
 class wxTextCtrl;
 class wxChoice;
 
-wxDECLARE_EVENT(wxEVT_COMMAND_JTCALCULATOR_COMPLETED, wxThreadEvent);
 wxDECLARE_EVENT(wxEVT_TEXT_CHANGED, wxCommandEvent);
 
 namespace slade
 {
 class FindReplacePanel;
 class SCallTip;
+class Job;
 
-class JumpToCalculator : public wxThread
+// Finds the 'Jump To' points (named blocks) in a section of text, from the
+// start of a block keyword to the end of the text. Runs in the background
+class JumpToCalculator
 {
 public:
-	JumpToCalculator(wxEvtHandler* handler, string_view text, vector<string> block_names, vector<string> ignore) :
-		handler_(handler),
+	struct JumpPoint
+	{
+		int    line     = 0; // Line to jump to
+		int    position = 0; // Position of the block keyword
+		string name;
+	};
+
+	JumpToCalculator(
+		string_view       text,
+		int               text_start,
+		int               text_line,
+		vector<string>    block_names,
+		vector<string>    ignore,
+		int               unchanged_start,
+		vector<JumpPoint> unchanged) :
 		text_(text),
+		text_start_(text_start),
+		text_line_(text_line),
 		block_names_(std::move(block_names)),
-		ignore_(std::move(ignore))
+		ignore_(std::move(ignore)),
+		unchanged_start_(unchanged_start),
+		unchanged_(std::move(unchanged))
 	{
 	}
-	virtual ~JumpToCalculator() = default;
 
-	ExitCode Entry() override;
+	const vector<JumpPoint>& points() const { return points_; }
+
+	void calculate(const Job& job);
 
 private:
-	wxEvtHandler*  handler_;
-	string         text_;
-	vector<string> block_names_;
-	vector<string> ignore_;
+	string            text_;
+	int               text_start_; // Editor position of the start of text_
+	int               text_line_;  // Editor line of the start of text_
+	vector<string>    block_names_;
+	vector<string>    ignore_;
+	int               unchanged_start_; // Editor position from which the text is unchanged since the last run
+	vector<JumpPoint> unchanged_;       // Points found from unchanged_start_ in the last run
+	vector<JumpPoint> points_;
 };
 
 class TextEditorCtrl : public wxStyledTextCtrl
@@ -53,6 +77,7 @@ public:
 
 	void setup();
 	void setupFoldMargin(TextStyle* margin_style = nullptr);
+	void colouriseVisible();
 	bool applyStyleSet(StyleSet* style);
 	bool loadEntry(ArchiveEntry* entry);
 	void getRawText(MemChunk& mc) const;
@@ -82,6 +107,7 @@ public:
 	// Jump To
 	void setJumpToControl(wxChoice* jump_to);
 	void updateJumpToList();
+	void showLine(int line);
 	void jumpToLine();
 
 	// Folding
@@ -98,24 +124,30 @@ private:
 	FindReplacePanel* panel_fr_           = nullptr;
 	SCallTip*         call_tip_           = nullptr;
 	wxChoice*         choice_jump_to_     = nullptr;
-	JumpToCalculator* jump_to_calculator_ = nullptr;
 	unique_ptr<Lexer> lexer_;
 	wxString          prev_word_match_;
 	wxString          autocomp_list_;
-	vector<int>       jump_to_lines_;
 	long              last_modified_ = 0;
 
 	// State tracking for updates
-	int  prev_cursor_pos_      = -1;
-	int  prev_text_length_     = -1;
-	int  prev_brace_match_     = -1;
-	bool block_comment_closed_ = false;
+	int prev_cursor_pos_  = -1;
+	int prev_text_length_ = -1;
+	int prev_brace_match_ = -1;
 
 	// Timed update stuff
 	wxTimer timer_update_;
 	bool    update_jump_to_    = false;
 	bool    update_word_match_ = false;
 
+	// Jump To stuff
+	vector<JumpToCalculator::JumpPoint> jump_to_points_;
+	shared_ptr<Job>                     jump_to_job_;
+	int                                 jump_to_changed_start_ = -1; // Range of text changed since the last update
+	int                                 jump_to_changed_end_   = -1; // (-1 if unchanged)
+
+	void clearJumpToPoints();
+	void jumpToTextModified(int position, int length, int lines_added);
+
 	// Calltip stuff
 	TLFunction* ct_function_ = nullptr;
 	int         ct_argset_   = 0;
@@ -139,9 +171,10 @@ private:
 	void onFocusLoss(wxFocusEvent& e);
 	void onActivate(wxActivateEvent& e);
 	void onMarginClick(wxStyledTextEvent& e);
-	void onJumpToCalculateComplete(wxThreadEvent& e);
+	void onJumpToCalculateComplete(const vector<JumpToCalculator::JumpPoint>& points, unsigned keep);
 	void onJumpToChoiceSelected(wxCommandEvent& e);
 	void onModified(wxStyledTextEvent& e);
+	void onTextModified(wxStyledTextEvent& e);
 	void onUpdateTimer(wxTimerEvent& e);
 	void onStyleNeeded(wxStyledTextEvent& e);
 };
@@ -36,6 +36,9 @@
 #include "BrowserItem.h"
 #include "General/UI.h"
 #include "OpenGL/Drawing.h"
+#include "Thumbnails.h"
+#include "Utility/StringUtils.h"
+#include <unordered_map>
 
 using namespace slade;
 
@@ -100,6 +103,8 @@ int BrowserCanvas::getViewedIndex()
 void BrowserCanvas::addItem(BrowserItem* item)
 {
 	items_.push_back(item);
+	name_index_.clear();
+	sorted_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -108,6 +113,11 @@ void BrowserCanvas::addItem(BrowserItem* item)
 void BrowserCanvas::clearItems()
 {
 	items_.clear();
+	name_index_.clear();
+	sorted_.clear();
+	filter_.clear();
+	filter_matches_.clear();
+	items_filter_.clear();
 }
 
 // -----------------------------------------------------------------------------
@@ -198,6 +208,9 @@ void BrowserCanvas::draw()
 	if (browser_bg_type == 0)
 		drawCheckeredBackground();
 
+	// Add any newly generated thumbnails to the atlas
+	thumbnails::update();
+
 	// Init for texture drawing
 	glEnable(GL_TEXTURE_2D);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
@@ -435,6 +448,35 @@ void BrowserCanvas::selectItem(int index)
 	GetEventHandler()->ProcessEvent(e);
 }
 
+// -----------------------------------------------------------------------------
+// Sorts the items with [compare]. If [cache] is true, the resulting order is
+// kept as sort [type] until the item list changes, so switching back to it
+// doesn't need to sort again
+// -----------------------------------------------------------------------------
+void BrowserCanvas::sortItems(unsigned type, const SortFunc& compare, bool cache)
+{
+	int  viewed_index = getViewedIndex();
+	auto viewed_item  = viewed_index >= 0 && viewed_index < (int)items_.size() ? items_[viewed_index] : nullptr;
+
+	auto cached = sorted_.find(type);
+	if (cached != sorted_.end() && cached->second.size() == items_.size())
+		items_ = cached->second;
+	else
+	{
+		std::sort(items_.begin(), items_.end(), compare);
+		if (cache)
+			sorted_[type] = items_;
+	}
+
+	// Item positions have changed, so rebuild the filtered list
+	updateIndexPositions();
+	updateFilterList();
+
+	if (viewed_item)
+		viewed_index = std::find(items_.begin(), items_.end(), viewed_item) - items_.begin();
+	updateLayout(viewed_index);
+}
+
 // -----------------------------------------------------------------------------
 // Filters the visible items by [filter], by name
 // -----------------------------------------------------------------------------
@@ -443,30 +485,55 @@ void BrowserCanvas::filterItems(wxString filter)
 	// Find the currently-viewed item before we change the item list
 	int viewed_index = getViewedIndex();
 
-	// Clear current filter list
-	items_filter_.clear();
+	// Setup filter string
+	filter.MakeLower();
+	auto filter_new = filter.ToStdString();
 
-	// If the filter is empty, just add all items to the filter
-	if (filter.IsEmpty())
+	if (!filter_new.empty())
 	{
-		for (unsigned a = 0; a < items_.size(); a++)
-			items_filter_.push_back(a);
-	}
-	else
-	{
-		// Setup filter string
-		filter.MakeLower();
-		filter += "*";
+		bool refine = !filter_.empty() && !name_index_.empty() && strutil::startsWith(filter_new, filter_);
+		if (name_index_.size() != items_.size())
+		{
+			buildNameIndex();
+			refine = false;
+		}
 
-		// Go through items
-		for (unsigned a = 0; a < items_.size(); a++)
+		// Find matching items
+		if (filter_new.find_first_of("*?") == string::npos)
 		{
-			// Add to filter list if name matches
-			if (items_[a]->name().Lower().Matches(filter))
-				items_filter_.push_back(a);
+			// No wildcards, so the matching names are all together in the index
+			auto i = std::lower_bound(
+				name_index_.begin(),
+				name_index_.end(),
+				filter_new,
+				[](const IndexedName& indexed, const string& name) { return indexed.name < name; });
+			filter_matches_.clear();
+			for (; i != name_index_.end() && strutil::startsWith(i->name, filter_new); ++i)
+				filter_matches_.push_back(i - name_index_.begin());
+		}
+		else
+		{
+			// If the filter was only added to, nothing that didn't match
+			// before can match now, so only the previous matches need checking
+			filter += "*";
+			if (!refine)
+			{
+				filter_matches_.resize(name_index_.size());
+				for (unsigned a = 0; a < name_index_.size(); a++)
+					filter_matches_[a] = a;
+			}
+			filter_matches_.erase(
+				std::remove_if(
+					filter_matches_.begin(),
+					filter_matches_.end(),
+					[&](unsigned index) { return !wxMatchWild(filter, name_index_[index].name, false); }),
+				filter_matches_.end());
 		}
 	}
 
+	filter_ = filter_new;
+	updateFilterList();
+
 	// Update scrollbar and refresh
 	updateLayout(viewed_index);
 }
@@ -552,6 +619,76 @@ bool BrowserCanvas::searchItemFrom(int from)
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Builds the sorted index of (lower case) item names used for filtering
+// -----------------------------------------------------------------------------
+void BrowserCanvas::buildNameIndex()
+{
+	name_index_.clear();
+	name_index_.reserve(items_.size());
+	for (unsigned a = 0; a < items_.size(); a++)
+		name_index_.push_back({ items_[a]->name().Lower().ToStdString(), items_[a], static_cast<int>(a) });
+
+	std::sort(
+		name_index_.begin(),
+		name_index_.end(),
+		[](const IndexedName& left, const IndexedName& right) { return left.name < right.name; });
+
+	// Any previous filter matches are no longer valid
+	filter_matches_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Updates the item positions in the name index after the items were reordered
+// -----------------------------------------------------------------------------
+void BrowserCanvas::updateIndexPositions()
+{
+	if (name_index_.size() != items_.size())
+		return;
+
+	std::unordered_map<BrowserItem*, int> positions;
+	positions.reserve(items_.size());
+	for (unsigned a = 0; a < items_.size(); a++)
+		positions[items_[a]] = a;
+	for (auto& indexed : name_index_)
+		indexed.position = positions[indexed.item];
+}
+
+// -----------------------------------------------------------------------------
+// Rebuilds the list of visible items from the current filter matches, in the
+// current sort order
+// -----------------------------------------------------------------------------
+void BrowserCanvas::updateFilterList()
+{
+	items_filter_.clear();
+
+	// No filter, all items are visible
+	if (filter_.empty())
+	{
+		items_filter_.resize(items_.size());
+		for (unsigned a = 0; a < items_.size(); a++)
+			items_filter_[a] = a;
+		return;
+	}
+
+	// The index is out of date (items were added), so filter again
+	if (name_index_.size() != items_.size())
+	{
+		wxString filter = filter_;
+		filter_.clear();
+		filterItems(filter);
+		return;
+	}
+
+	items_filter_.reserve(filter_matches_.size());
+	for (auto index : filter_matches_)
+		items_filter_.push_back(name_index_[index].position);
+	std::sort(items_filter_.begin(), items_filter_.end());
+}
+
+// -----------------------------------------------------------------------------
+// Returns the width of the longest item name text
+// -----------------------------------------------------------------------------
 int BrowserCanvas::longestItemTextWidth() const
 {
 	return 144;
@@ -28,29 +28,33 @@ public:
 		None
 	};
 
-	vector<BrowserItem*>& itemList() { return items_; }
-	int                   getViewedIndex();
-	void                  addItem(BrowserItem* item);
-	void                  clearItems();
-	int                   fullItemSizeX() const;
-	int                   fullItemSizeY() const;
-	void                  draw() override;
-	void                  setScrollBar(wxScrollBar* scrollbar);
-	void                  updateLayout(int viewed_index = -1);
-	BrowserItem*          selectedItem() const;
-	BrowserItem*          itemAt(int index);
-	int                   itemIndex(BrowserItem* item);
-	void                  selectItem(int index);
-	void                  selectItem(BrowserItem* item);
-	void                  filterItems(wxString filter);
-	void                  showItem(int item, int where);
-	void                  showSelectedItem();
-	bool                  searchItemFrom(int from);
-	void                  setFont(drawing::Font font) { this->font_ = font; }
-	void                  setItemNameType(NameType type) { this->show_names_ = type; }
-	void                  setItemSize(int size) { this->item_size_ = size; }
-	void                  setItemViewType(ItemView type) { this->item_type_ = type; }
-	int                   longestItemTextWidth() const;
+	using SortFunc = std::function<bool(BrowserItem*, BrowserItem*)>;
+
+	const vector<BrowserItem*>& itemList() const { return items_; }
+	int                         getViewedIndex();
+	void                        addItem(BrowserItem* item);
+	void                        clearItems();
+	int                         fullItemSizeX() const;
+	int                         fullItemSizeY() const;
+	void                        draw() override;
+	void                        setScrollBar(wxScrollBar* scrollbar);
+	void                        updateLayout(int viewed_index = -1);
+	BrowserItem*                selectedItem() const;
+	BrowserItem*                itemAt(int index);
+	int                         itemIndex(BrowserItem* item);
+	void                        selectItem(int index);
+	void                        selectItem(BrowserItem* item);
+	void                        sortItems(unsigned type, const SortFunc& compare, bool cache = true);
+	void                        filterItems(wxString filter);
+	void                        showItem(int item, int where);
+	void                        showSelectedItem();
+	bool                        searchItemFrom(int from);
+	void                        setFont(drawing::Font font) { this->font_ = font; }
+	void                        setItemNameType(NameType type) { this->show_names_ = type; }
+	void                        setItemSize(int size) { this->item_size_ = size; }
+	void                        setItemViewType(ItemView type) { this->item_type_ = type; }
+	int                         longestItemTextWidth() const;
+	void                        buildNameIndex();
 
 	// Events
 	void onSize(wxSizeEvent& e);
@@ -66,6 +70,21 @@ public:
 private:
 	vector<BrowserItem*> items_;
 	vector<int>          items_filter_;
+
+	// Lower case item names sorted alphabetically, for filtering
+	struct IndexedName
+	{
+		string       name;
+		BrowserItem* item;
+		int          position; // Index in items_ (in the current sort order)
+	};
+	vector<IndexedName> name_index_;
+	vector<unsigned>    filter_matches_; // name_index_ entries matching filter_
+	string              filter_;         // Current filter (lower case)
+
+	// Item orders for each sort type (see sortItems)
+	std::map<unsigned, vector<BrowserItem*>> sorted_;
+
 	wxScrollBar*         scrollbar_ = nullptr;
 	wxString             search_;
 	BrowserItem*         item_selected_ = nullptr;
@@ -80,6 +99,9 @@ private:
 	int           top_y_       = 0;
 	ItemView      item_type_   = ItemView::Normal;
 	int           num_cols_    = -1;
+
+	void updateIndexPositions();
+	void updateFilterList();
 };
 } // namespace slade
 
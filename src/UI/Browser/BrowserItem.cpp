@@ -38,6 +38,7 @@
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
 #include "OpenGL/OpenGL.h"
+#include "Thumbnails.h"
 #include "Utility/StringUtils.h"
 
 using namespace slade;
@@ -45,6 +46,14 @@ using NameType = BrowserCanvas::NameType;
 using ItemView = BrowserCanvas::ItemView;
 
 
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Bool, browser_thumbnails)
+
+
 // -----------------------------------------------------------------------------
 //
 // BrowserItem Class Functions
@@ -71,6 +80,50 @@ bool BrowserItem::loadImage()
 	return false;
 }
 
+// -----------------------------------------------------------------------------
+// Clears the item's thumbnail, so it is requested again next time it is drawn
+// (eg. if the palette changed)
+// -----------------------------------------------------------------------------
+void BrowserItem::clearThumbnail()
+{
+	thumb_key_.clear();
+	no_thumbnail_ = false;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the item's thumbnail, requesting it first if needed (see
+// thumbnailSource). If the thumbnail isn't ready yet, [pending] is set to true
+// and nullptr is returned. Also returns nullptr if the item has no thumbnail
+// -----------------------------------------------------------------------------
+const thumbnails::Thumbnail* BrowserItem::thumbnail(bool& pending)
+{
+	pending = false;
+	if (!browser_thumbnails || no_thumbnail_)
+		return nullptr;
+
+	// Request the thumbnail if it hasn't been yet (or was removed from the
+	// atlas since)
+	if (thumb_key_.empty() || thumbnails::state(thumb_key_) == thumbnails::State::None)
+	{
+		thumbnails::Source source;
+		if (!thumbnailSource(source))
+		{
+			no_thumbnail_ = true;
+			return nullptr;
+		}
+
+		thumb_key_ = source.key;
+		thumbnails::request(std::move(source));
+	}
+
+	switch (thumbnails::state(thumb_key_))
+	{
+	case thumbnails::State::Ready: return thumbnails::get(thumb_key_);
+	case thumbnails::State::Pending: pending = true; return nullptr;
+	default: no_thumbnail_ = true; return nullptr;
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Draws the item in a [size]x[size] box, keeping the correct aspect ratio of
 // it's image
@@ -140,12 +193,18 @@ void BrowserItem::draw(
 	if (blank_)
 		return;
 
-	// Try to load image if it isn't already
-	if (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_)))
+	// Use the item's thumbnail if it has one (nothing is drawn until it's ready)
+	bool pending = false;
+	auto thumb   = thumbnail(pending);
+	if (pending)
+		return;
+
+	// Otherwise try to load image if it isn't already
+	if (!thumb && (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_))))
 		loadImage();
 
 	// If it still isn't just draw a red box with an X
-	if (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_)))
+	if (!thumb && (!image_tex_ || (image_tex_ && !gl::Texture::isLoaded(image_tex_))))
 	{
 		glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
 
@@ -173,10 +232,10 @@ void BrowserItem::draw(
 		return;
 	}
 
-	// Determine texture dimensions
-	auto&  tex_info = gl::Texture::info(image_tex_);
-	double width    = tex_info.size.x;
-	double height   = tex_info.size.y;
+	// Determine image dimensions
+	Vec2i  image_size = thumb ? thumb->image_size : gl::Texture::info(image_tex_).size;
+	double width      = image_size.x;
+	double height     = image_size.y;
 
 	// Scale up if size > 128
 	if (size > 128)
@@ -212,17 +271,24 @@ void BrowserItem::draw(
 	double left = x + ((double)size * 0.5) - (width * 0.5);
 
 	// Draw
-	gl::Texture::bind(image_tex_);
+	Rectf tex_coords{ 0.0f, 0.0f, 1.0f, 1.0f };
+	if (thumb)
+	{
+		gl::Texture::bind(thumb->texture);
+		tex_coords = thumb->tex_coords;
+	}
+	else
+		gl::Texture::bind(image_tex_);
 	gl::setColour(ColRGBA::WHITE);
 
 	glBegin(GL_QUADS);
-	glTexCoord2f(0.0f, 0.0f);
+	glTexCoord2f(tex_coords.tl.x, tex_coords.tl.y);
 	glVertex2d(left, top);
-	glTexCoord2f(0.0f, 1.0f);
+	glTexCoord2f(tex_coords.tl.x, tex_coords.br.y);
 	glVertex2d(left, top + height);
-	glTexCoord2f(1.0f, 1.0f);
+	glTexCoord2f(tex_coords.br.x, tex_coords.br.y);
 	glVertex2d(left + width, top + height);
-	glTexCoord2f(1.0f, 0.0f);
+	glTexCoord2f(tex_coords.br.x, tex_coords.tl.y);
 	glVertex2d(left + width, top);
 	glEnd();
 }
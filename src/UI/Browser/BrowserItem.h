@@ -6,6 +6,11 @@
 namespace slade
 {
 class BrowserWindow;
+namespace thumbnails
+{
+	struct Source;
+	struct Thumbnail;
+} // namespace thumbnails
 
 class BrowserItem
 {
@@ -15,8 +20,8 @@ public:
 	BrowserItem(const wxString& name, unsigned index = 0, const wxString& type = "item");
 	virtual ~BrowserItem() = default;
 
-	wxString name() const { return name_; }
-	unsigned index() const { return index_; }
+	const wxString& name() const { return name_; }
+	unsigned        index() const { return index_; }
 
 	virtual bool loadImage();
 	void         draw(
@@ -30,6 +35,8 @@ public:
 				bool                    text_shadow = true);
 	virtual void     clearImage() {}
 	virtual wxString itemInfo() { return ""; }
+	virtual bool     thumbnailSource(thumbnails::Source& source) { return false; }
+	void             clearThumbnail();
 
 protected:
 	wxString            type_;
@@ -39,5 +46,9 @@ protected:
 	BrowserWindow*      parent_    = nullptr;
 	bool                blank_     = false;
 	unique_ptr<TextBox> text_box_;
+	string              thumb_key_;            // Key of the item's thumbnail, if requested
+	bool                no_thumbnail_ = false; // True if the item has no thumbnail (use the full image)
+
+	const thumbnails::Thumbnail* thumbnail(bool& pending);
 };
 } // namespace slade
@@ -338,7 +338,10 @@ void BrowserWindow::reloadItems(BrowserTreeNode* node) const
 
 	// Go through items in this node
 	for (unsigned a = 0; a < node->nItems(); a++)
+	{
 		node->item(a)->clearImage();
+		node->item(a)->clearThumbnail();
+	}
 
 	// Go through child nodes
 	for (unsigned a = 0; a < node->nChildren(); a++)
@@ -429,18 +432,15 @@ unsigned BrowserWindow::addSortType(const wxString& name) const
 // -----------------------------------------------------------------------------
 void BrowserWindow::doSort(unsigned sort_type)
 {
-	// Get item list
-	auto& items = canvas_->itemList();
-
 	// Do sorting
 
 	// 0: By Index
 	if (sort_type == 0)
-		std::sort(items.begin(), items.end(), sortBIIndex);
+		canvas_->sortItems(sort_type, sortBIIndex);
 
 	// 1: By Name (Alphabetical)
 	else if (sort_type == 1)
-		std::sort(items.begin(), items.end(), sortBIName);
+		canvas_->sortItems(sort_type, sortBIName);
 
 	// Refresh canvas
 	canvas_->showSelectedItem();
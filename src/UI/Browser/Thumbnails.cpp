@@ -0,0 +1,569 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Thumbnails.cpp
+// Description: Browser item thumbnails - downscaled images generated on worker
+//              threads, kept in an on-disk cache (by resource hash) and packed
+//              into a shared GL texture atlas for drawing
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Thumbnails.h"
+#include "App.h"
+#include "Archive/ArchiveEntry.h"
+#include "Archive/EntryType/EntryType.h"
+#include "General/Misc.h"
+#include "Graphics/CTexture/CTexture.h"
+#include "Graphics/Palette/Palette.h"
+#include "Graphics/SImage/SIFormat.h"
+#include "Graphics/SImage/SImage.h"
+#include "OpenGL/GLTexture.h"
+#include "Utility/MemoryStats.h"
+#include "Utility/ThreadPool.h"
+#include <mutex>
+
+using namespace slade;
+using thumbnails::State;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, browser_thumbnails, true, CVar::Flag::Save)
+CVAR(Bool, browser_thumbnail_cache, true, CVar::Flag::Save)
+CVAR(Int, browser_thumbnail_pages, 16, CVar::Flag::Save) // Max atlas pages (each 1024x1024, 64 thumbnails)
+namespace
+{
+constexpr int  PAGE_SIZE      = 1024;
+constexpr int  PAGE_CELLS     = PAGE_SIZE / thumbnails::MAX_SIZE; // Cells per page row/column
+constexpr char CACHE_MAGIC[4] = { 'S', 'T', 'H', 'B' };
+
+// A generated (or cached) thumbnail, waiting to be added to the atlas
+struct Result
+{
+	string          key;
+	bool            ok    = false;
+	bool            retry = false; // True if the thumbnail needs to be requested again
+	Vec2i           image_size;
+	Vec2i           size;
+	vector<uint8_t> data; // RGBA
+};
+
+// A full image loaded on the main thread (see thumbnails::Source)
+struct LoadedImage
+{
+	SImage  image;
+	Palette palette;
+};
+
+struct Item
+{
+	State                 state = State::None;
+	int                   cell  = -1;
+	thumbnails::Thumbnail thumb;
+};
+
+struct Cell
+{
+	string key; // Thumbnail in the cell (empty if the cell is free)
+	long   last_used = 0;
+};
+
+// Only accessed on the main thread
+std::map<string, Item> items;
+vector<unsigned>       pages;
+vector<Cell>           cells;
+string                 cache_dir;
+
+// Shared with worker threads
+vector<Result> results;
+std::mutex     results_mutex;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the path to the disk cache file for thumbnail [key], creating the
+// cache directory if needed. Returns an empty string if the disk cache is
+// disabled
+// -----------------------------------------------------------------------------
+string cachePath(const string& key)
+{
+	if (!browser_thumbnail_cache)
+		return {};
+
+	if (cache_dir.empty())
+	{
+		cache_dir = app::path("thumbnails", app::Dir::User);
+		if (!wxDirExists(cache_dir))
+			wxMkdir(cache_dir);
+	}
+
+	return fmt::format("{}/{}.thumb", cache_dir, key);
+}
+
+// -----------------------------------------------------------------------------
+// Scales [image] (using [palette]) down to fit the maximum thumbnail size and
+// writes the RGBA thumbnail to [result].
+// Each thumbnail pixel is the average of the image pixels it covers, weighted
+// by alpha so transparent pixels don't darken the edges
+// -----------------------------------------------------------------------------
+bool makeThumbnail(const SImage& image, Palette* palette, Result& result)
+{
+	int width  = image.width();
+	int height = image.height();
+	if (width <= 0 || height <= 0)
+		return false;
+
+	MemChunk rgba;
+	if (!image.putRGBAData(rgba, palette))
+		return false;
+
+	auto scale        = std::min(1.0, static_cast<double>(thumbnails::MAX_SIZE) / std::max(width, height));
+	auto tw           = std::max(1, static_cast<int>(width * scale + 0.5));
+	auto th           = std::max(1, static_cast<int>(height * scale + 0.5));
+	result.image_size = { width, height };
+	result.size       = { tw, th };
+	result.data.resize(static_cast<size_t>(tw) * th * 4);
+
+	// Not scaled
+	if (tw == width && th == height)
+	{
+		memcpy(result.data.data(), rgba.data(), result.data.size());
+		return true;
+	}
+
+	auto src = rgba.data();
+	auto dst = result.data.data();
+	for (int y = 0; y < th; ++y)
+	{
+		int sy1 = y * height / th;
+		int sy2 = std::max(sy1 + 1, (y + 1) * height / th);
+		for (int x = 0; x < tw; ++x)
+		{
+			int sx1 = x * width / tw;
+			int sx2 = std::max(sx1 + 1, (x + 1) * width / tw);
+
+			unsigned r = 0, g = 0, b = 0, a = 0, n = 0;
+			for (int sy = sy1; sy < sy2; ++sy)
+			{
+				auto p = src + (static_cast<size_t>(sy) * width + sx1) * 4;
+				for (int sx = sx1; sx < sx2; ++sx, p += 4)
+				{
+					r += p[0] * p[3];
+					g += p[1] * p[3];
+					b += p[2] * p[3];
+					a += p[3];
+					++n;
+				}
+			}
+
+			if (a > 0)
+			{
+				dst[0] = r / a;
+				dst[1] = g / a;
+				dst[2] = b / a;
+			}
+			dst[3] = a / n;
+			dst += 4;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reads the thumbnail in cache file [path] to [result].
+// Cache files are the full image size followed by the thumbnail as a PNG
+// -----------------------------------------------------------------------------
+bool readCacheFile(const string& path, Result& result)
+{
+	MemChunk mc;
+	if (path.empty() || !wxFileExists(path) || !mc.importFile(path))
+		return false;
+	if (mc.size() < 12 || memcmp(mc.data(), CACHE_MAGIC, 4) != 0)
+		return false;
+
+	MemChunk png;
+	SImage   image;
+	png.importMem(mc.data() + 12, mc.size() - 12);
+	if (!image.open(png, 0, "png") || !makeThumbnail(image, nullptr, result))
+		return false;
+
+	result.image_size = { static_cast<int>(mc.readL32(4)), static_cast<int>(mc.readL32(8)) };
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Writes the thumbnail in [result] to cache file [path]
+// -----------------------------------------------------------------------------
+bool writeCacheFile(const string& path, const Result& result)
+{
+	auto   format = SIFormat::getFormat("png");
+	SImage image;
+	if (path.empty() || !image.setImageData(result.data, result.size.x, result.size.y, SImage::Type::RGBA))
+		return false;
+
+	MemChunk png;
+	if (!format->saveImage(image, png))
+		return false;
+
+	uint32_t header[2] = { wxUINT32_SWAP_ON_BE(static_cast<uint32_t>(result.image_size.x)),
+						   wxUINT32_SWAP_ON_BE(static_cast<uint32_t>(result.image_size.y)) };
+	MemChunk mc;
+	mc.write(CACHE_MAGIC, 4);
+	mc.write(header, 8);
+	mc.write(png.data(), png.size());
+	return mc.exportFile(path);
+}
+
+// -----------------------------------------------------------------------------
+// Generates the thumbnail for [source] (on a worker thread) to [result], from
+// the disk cache file [path] if it exists, otherwise from the full image
+// ([loaded] if it was already loaded on the main thread)
+// -----------------------------------------------------------------------------
+void generate(
+	const thumbnails::Source&      source,
+	const string&                  path,
+	const shared_ptr<LoadedImage>& loaded,
+	Result&                        result)
+{
+	if (!loaded)
+	{
+		// Use the cached thumbnail if there is one
+		if (readCacheFile(path, result))
+		{
+			result.ok = true;
+			return;
+		}
+
+		// The source can't be loaded here, so the request has to be made again
+		// (see request)
+		if (source.main_thread)
+		{
+			wxRemoveFile(path);
+			result.retry = true;
+			return;
+		}
+	}
+
+	// Load the full image if needed
+	auto full = loaded ? loaded : std::make_shared<LoadedImage>();
+	if (!loaded && !source.load(full->image, full->palette))
+		return;
+
+	// Generate and cache the thumbnail
+	if (!makeThumbnail(full->image, &full->palette, result))
+		return;
+	result.ok = true;
+	writeCacheFile(path, result);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of a free cell in the atlas, adding a new page if
+// there are none. If the atlas already has the maximum number of pages, the
+// least recently drawn thumbnail is removed to make room.
+// Returns -1 if no atlas page could be created
+// -----------------------------------------------------------------------------
+int allocateCell()
+{
+	for (unsigned a = 0; a < cells.size(); ++a)
+		if (cells[a].key.empty())
+			return a;
+
+	// Add a page
+	if (static_cast<int>(pages.size()) < std::max(1, static_cast<int>(browser_thumbnail_pages)))
+	{
+		vector<uint8_t> blank(PAGE_SIZE * PAGE_SIZE * 4);
+		auto page = gl::Texture::createFromData(blank.data(), PAGE_SIZE, PAGE_SIZE, gl::TexFilter::Nearest, false);
+		if (!page)
+			return -1;
+
+		pages.push_back(page);
+		cells.resize(pages.size() * PAGE_CELLS * PAGE_CELLS);
+		return cells.size() - PAGE_CELLS * PAGE_CELLS;
+	}
+
+	// Evict the least recently used thumbnail
+	if (cells.empty())
+		return -1;
+	unsigned lru = 0;
+	for (unsigned a = 1; a < cells.size(); ++a)
+		if (cells[a].last_used < cells[lru].last_used)
+			lru = a;
+	items.erase(cells[lru].key);
+	cells[lru].key.clear();
+
+	return lru;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Thumbnails Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the state of thumbnail [key]
+// -----------------------------------------------------------------------------
+State thumbnails::state(const string& key)
+{
+	auto i = items.find(key);
+	return i == items.end() ? State::None : i->second.state;
+}
+
+// -----------------------------------------------------------------------------
+// Returns thumbnail [key], or nullptr if it isn't in the atlas (yet)
+// -----------------------------------------------------------------------------
+const thumbnails::Thumbnail* thumbnails::get(const string& key)
+{
+	auto i = items.find(key);
+	if (i == items.end() || i->second.state != State::Ready)
+		return nullptr;
+
+	cells[i->second.cell].last_used = app::runTimer();
+	return &i->second.thumb;
+}
+
+// -----------------------------------------------------------------------------
+// Requests the thumbnail for [source], if it hasn't been already.
+// The thumbnail is generated (or read from the disk cache) on a worker thread,
+// and is added to the atlas on the next call to update when ready
+// -----------------------------------------------------------------------------
+void thumbnails::request(Source source)
+{
+	auto& item = items[source.key];
+	if (item.state != State::None)
+		return;
+	item.state = State::Pending;
+
+	// Load the full image now if it isn't cached and can't be loaded on a
+	// worker thread
+	auto                    path = cachePath(source.key);
+	shared_ptr<LoadedImage> loaded;
+	if (source.main_thread && (path.empty() || !wxFileExists(path)))
+	{
+		loaded = std::make_shared<LoadedImage>();
+		if (!source.load(loaded->image, loaded->palette))
+		{
+			item.state = State::Failed;
+			return;
+		}
+	}
+
+	threadpool::pool().push([source = std::move(source), path, loaded]() {
+		Result result;
+		result.key = source.key;
+		generate(source, path, loaded, result);
+
+		std::lock_guard lock(results_mutex);
+		results.push_back(std::move(result));
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Adds any thumbnails finished since the last call to the atlas. Must be
+// called on the main thread with a GL context active.
+// Returns true if any thumbnails were added
+// -----------------------------------------------------------------------------
+bool thumbnails::update()
+{
+	vector<Result> done;
+	{
+		std::lock_guard lock(results_mutex);
+		done.swap(results);
+	}
+
+	bool added = false;
+	for (auto& result : done)
+	{
+		auto i = items.find(result.key);
+		if (i == items.end() || i->second.state != State::Pending)
+			continue;
+
+		auto& item = i->second;
+		if (!result.ok)
+		{
+			if (result.retry)
+				items.erase(i);
+			else
+				item.state = State::Failed;
+			continue;
+		}
+
+		// Add to the atlas
+		auto cell = allocateCell();
+		if (cell < 0)
+		{
+			item.state = State::Failed;
+			continue;
+		}
+		auto page  = cell / (PAGE_CELLS * PAGE_CELLS);
+		auto index = cell % (PAGE_CELLS * PAGE_CELLS);
+		auto x     = (index % PAGE_CELLS) * MAX_SIZE;
+		auto y     = (index / PAGE_CELLS) * MAX_SIZE;
+		if (!gl::Texture::loadSubData(pages[page], result.data.data(), x, y, result.size.x, result.size.y))
+		{
+			item.state = State::Failed;
+			continue;
+		}
+
+		cells[cell].key       = result.key;
+		cells[cell].last_used = app::runTimer();
+		item.state            = State::Ready;
+		item.cell             = cell;
+		item.thumb.texture    = pages[page];
+		item.thumb.image_size = result.image_size;
+		item.thumb.tex_coords = { static_cast<float>(x) / PAGE_SIZE,
+								  static_cast<float>(y) / PAGE_SIZE,
+								  static_cast<float>(x + result.size.x) / PAGE_SIZE,
+								  static_cast<float>(y + result.size.y) / PAGE_SIZE };
+		added                 = true;
+	}
+
+	return added;
+}
+
+// -----------------------------------------------------------------------------
+// Sets up [source] to generate a thumbnail of the image in [entry], displayed
+// with [palette]. The image is loaded on a worker thread.
+// Returns false if [entry] is invalid or not in an archive
+// -----------------------------------------------------------------------------
+bool thumbnails::entrySource(Source& source, ArchiveEntry* entry, const Palette* palette)
+{
+	auto entry_ref = entry ? entry->getShared() : nullptr;
+	if (!entry_ref || !palette)
+		return false;
+
+	// Entry type and data need to be ready before it can be loaded on a worker
+	// thread
+	if (entry->type() == EntryType::unknownType())
+		EntryType::detectEntryType(*entry);
+	entry->data();
+
+	auto pal = std::make_shared<Palette>();
+	pal->copyPalette(palette);
+
+	source.key         = fmt::format("e{:08x}{:08x}{}", entry->contentHash(), entry->size(), paletteHash(*pal));
+	source.main_thread = false;
+	source.load        = [entry_ref, pal](SImage& image, Palette& image_palette) {
+		image_palette.copyPalette(pal.get());
+		return misc::loadImageFromEntry(&image, entry_ref.get());
+	};
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Sets up [source] to generate a thumbnail of composite [texture] (with its
+// patches from [archive]), displayed with [palette]. Composite textures are
+// built on the main thread, since the patches are looked up in the resource
+// manager. The key includes the patch content hashes, so the thumbnail is
+// regenerated if any of its patches change.
+// Returns false if [texture] is invalid
+// -----------------------------------------------------------------------------
+bool thumbnails::textureSource(Source& source, CTexture* texture, Archive* archive, const Palette* palette)
+{
+	if (!texture || !palette)
+		return false;
+
+	auto definition = texture->asText();
+	for (size_t a = 0; a < texture->nPatches(); ++a)
+		if (auto entry = texture->patch(a)->patchEntry(archive))
+			definition += fmt::format(",{:08x}", entry->contentHash());
+
+	auto pal = std::make_shared<Palette>();
+	pal->copyPalette(palette);
+
+	source.key         = fmt::format("t{}{}", hash(definition), paletteHash(*pal));
+	source.main_thread = true;
+	source.load        = [texture, archive, pal](SImage& image, Palette& image_palette) {
+		image_palette.copyPalette(pal.get());
+		return texture->toImage(image, archive, pal.get(), true);
+	};
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of [data], for use in thumbnail keys
+// -----------------------------------------------------------------------------
+string thumbnails::hash(string_view data)
+{
+	auto crc = misc::crc(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+	return fmt::format("{:08x}{:08x}", crc, data.size());
+}
+
+// -----------------------------------------------------------------------------
+// Returns a hash of the colours in [palette], for use in thumbnail keys
+// -----------------------------------------------------------------------------
+string thumbnails::paletteHash(const Palette& palette)
+{
+	uint8_t rgb[768];
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		auto col       = palette.colour(a);
+		rgb[a * 3]     = col.r;
+		rgb[a * 3 + 1] = col.g;
+		rgb[a * 3 + 2] = col.b;
+	}
+
+	return fmt::format("{:08x}", misc::crc(rgb, 768));
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Memory Counters
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counts video memory used by the thumbnail atlas pages
+// -----------------------------------------------------------------------------
+MEMORY_COUNTER(thumbnails, "Thumbnails")
+{
+	unsigned ready = 0;
+	for (const auto& [key, item] : items)
+		if (item.state == State::Ready)
+			++ready;
+
+	uint64_t page_bytes = PAGE_SIZE * PAGE_SIZE * 4;
+	usage.push_back({ {}, fmt::format("Atlas ({} pages)", pages.size()), pages.size() * page_bytes, ready, true });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace slade
+{
+class Archive;
+class ArchiveEntry;
+class CTexture;
+class Palette;
+class SImage;
+
+namespace thumbnails
+{
+	// Maximum thumbnail width/height (images larger than this are scaled down)
+	static constexpr int MAX_SIZE = 128;
+
+	enum class State
+	{
+		None,    // Not requested (or removed from the atlas since)
+		Pending, // Being generated or loaded from the disk cache
+		Ready,   // In the atlas
+		Failed   // The image couldn't be loaded
+	};
+
+	// A thumbnail in the atlas
+	struct Thumbnail
+	{
+		unsigned texture = 0; // GL id of the atlas page the thumbnail is in
+		Rectf    tex_coords;  // Area of the atlas page containing the thumbnail
+		Vec2i    image_size;  // Size of the full image the thumbnail was made from
+	};
+
+	// What to generate a thumbnail from (see request)
+	struct Source
+	{
+		string key;                 // Unique hash of the resource (and anything else affecting its image)
+		bool   main_thread = false; // True if [load] can only be called on the main thread
+
+		// Loads the full image, and the palette to display it with
+		std::function<bool(SImage& image, Palette& palette)> load;
+	};
+
+	State            state(const string& key);
+	const Thumbnail* get(const string& key);
+	void             request(Source source);
+	bool             update();
+
+	bool   entrySource(Source& source, ArchiveEntry* entry, const Palette* palette);
+	bool   textureSource(Source& source, CTexture* texture, Archive* archive, const Palette* palette);
+	string hash(string_view data);
+	string paletteHash(const Palette& palette);
+} // namespace thumbnails
+} // namespace slade
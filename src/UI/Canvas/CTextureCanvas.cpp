@@ -50,6 +50,53 @@ wxDEFINE_EVENT(EVT_DRAG_END, wxCommandEvent);
 CVAR(Bool, tx_arc, false, CVar::Flag::Save)
 EXTERN_CVAR(Bool, gfx_show_border)
 
+namespace
+{
+// Time to wait after the texture was last changed before regenerating the
+// full preview (ms)
+constexpr int PREVIEW_DELAY = 250;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns a string identifying the colour settings (translation, blend or
+// tint) of [patch], used to check if its patch texture needs reloading
+// -----------------------------------------------------------------------------
+string patchColourKey(CTPatchEx& patch)
+{
+	auto col = patch.colour();
+	switch (patch.blendType())
+	{
+	case CTPatchEx::BlendType::Translation: return "t" + patch.translation().asText();
+	case CTPatchEx::BlendType::Blend: return fmt::format("b{},{},{}", col.r, col.g, col.b);
+	case CTPatchEx::BlendType::Tint: return fmt::format("c{},{},{},{}", col.r, col.g, col.b, col.a);
+	default: return {};
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Applies the colour settings (translation, blend or tint) of [patch] to
+// [image], as done by CTexture::toImage
+// -----------------------------------------------------------------------------
+void applyPatchColour(CTPatchEx& patch, SImage& image, Palette* pal)
+{
+	switch (patch.blendType())
+	{
+	case CTPatchEx::BlendType::Translation: image.applyTranslation(&patch.translation(), pal); break;
+	case CTPatchEx::BlendType::Blend: image.colourise(patch.colour(), pal); break;
+	case CTPatchEx::BlendType::Tint: image.tint(patch.colour(), patch.colour().fa(), pal); break;
+	default: break;
+	}
+}
+} // namespace
+
 
 // -----------------------------------------------------------------------------
 //
@@ -67,6 +114,14 @@ CTextureCanvas::CTextureCanvas(wxWindow* parent, int id) : OGLCanvas(parent, id)
 	Bind(wxEVT_MOTION, &CTextureCanvas::onMouseEvent, this);
 	Bind(wxEVT_LEFT_UP, &CTextureCanvas::onMouseEvent, this);
 	Bind(wxEVT_LEAVE_WINDOW, &CTextureCanvas::onMouseEvent, this);
+	timer_preview_.Bind(
+		wxEVT_TIMER,
+		[&](wxTimerEvent&)
+		{
+			preview_pending_ = false;
+			updateTexturePreview();
+			Refresh();
+		});
 }
 
 // -----------------------------------------------------------------------------
@@ -129,7 +184,9 @@ void CTextureCanvas::clearTexture()
 
 	// Clear full preview
 	gl::Texture::clear(tex_preview_);
-	tex_preview_ = 0;
+	tex_preview_     = 0;
+	preview_pending_ = false;
+	timer_preview_.Stop();
 
 	// Refresh canvas
 	Refresh();
@@ -141,6 +198,8 @@ void CTextureCanvas::clearTexture()
 void CTextureCanvas::clearPatchTextures()
 {
 	patch_textures_.clear();
+	patch_colour_keys_.clear();
+	patch_image_offsets_.clear();
 
 	// Refresh canvas
 	Refresh();
@@ -191,6 +250,8 @@ bool CTextureCanvas::openTexture(CTexture* tex, Archive* parent)
 	{
 		// Create GL texture
 		patch_textures_.push_back(gl::Texture::create());
+		patch_colour_keys_.emplace_back();
+		patch_image_offsets_.emplace_back();
 
 		// Set selection
 		selected_patches_.push_back(false);
@@ -206,6 +267,8 @@ bool CTextureCanvas::openTexture(CTexture* tex, Archive* parent)
 		{
 			// Create GL texture
 			patch_textures_.push_back(gl::Texture::create());
+			patch_colour_keys_.emplace_back();
+			patch_image_offsets_.emplace_back();
 
 			// Set selection
 			selected_patches_.push_back(false);
@@ -320,8 +383,10 @@ void CTextureCanvas::drawTexture()
 	// Reset colouring
 	gl::setColour(ColRGBA::WHITE, gl::Blend::Normal);
 
-	// If we're currently dragging, draw a 'basic' preview of the texture using opengl
-	if (dragging_)
+	// If we're currently dragging (or the texture was just changed), draw a
+	// 'basic' preview of the texture using opengl, since generating the full
+	// preview can be slow for large textures with many patches
+	if (dragging_ || preview_pending_)
 	{
 		glEnable(GL_SCISSOR_TEST);
 		glScissor(
@@ -446,17 +511,30 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	if (!patch)
 		return;
 
-	// Load the patch as an opengl texture if it isn't already
-	if (!gl::Texture::isLoaded(patch_textures_[num]))
+	// Load the patch as an opengl texture if it isn't already, or if its
+	// colour settings have changed since it was loaded
+	auto epatch     = texture_->isExtended() ? dynamic_cast<CTPatchEx*>(patch) : nullptr;
+	auto colour_key = epatch ? patchColourKey(*epatch) : string{};
+	if (!gl::Texture::isLoaded(patch_textures_[num]) || colour_key != patch_colour_keys_[num])
 	{
+		if (!patch_textures_[num] || patch_textures_[num] == gl::Texture::missingTexture())
+			patch_textures_[num] = gl::Texture::create();
+
 		SImage temp(SImage::Type::PalMask);
 		if (texture_->loadPatchImage(num, temp, parent_, &palette_))
 		{
+			// Apply colour settings (everything else is done when drawing)
+			if (epatch)
+				applyPatchColour(*epatch, temp, &palette_);
+
 			// Load the image as a texture
 			gl::Texture::loadImage(patch_textures_[num], temp, &palette_);
+			patch_image_offsets_[num] = temp.offset();
 		}
 		else
 			patch_textures_[num] = gl::Texture::missingTexture();
+
+		patch_colour_keys_[num] = colour_key;
 	}
 
 	// Translate to position
@@ -472,10 +550,36 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	double alpha        = 1.0;
 	bool   shade_select = true;
 	auto   col          = ColRGBA::WHITE;
-	if (texture_->isExtended())
+	if (epatch)
 	{
-		// Get extended patch
-		auto epatch = dynamic_cast<CTPatchEx*>(patch);
+		// Patch image offsets
+		if (epatch->useOffsets())
+			glTranslated(-patch_image_offsets_[num].x, -patch_image_offsets_[num].y, 0);
+
+		// Transparency style (approximated with GL blending)
+		auto style = epatch->style();
+		if (!outside)
+		{
+			if (style == "Translucent" || style == "CopyNewAlpha")
+				alpha = epatch->alpha();
+			else if (style == "Add")
+			{
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+				alpha = epatch->alpha();
+			}
+			else if (style == "Subtract" || style == "ReverseSubtract")
+			{
+				glBlendEquation(style == "Subtract" ? GL_FUNC_REVERSE_SUBTRACT : GL_FUNC_SUBTRACT);
+				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+				alpha = epatch->alpha();
+			}
+			else if (style == "Modulate")
+			{
+				glEnable(GL_ALPHA_TEST);
+				glAlphaFunc(GL_GREATER, 0.0f);
+				glBlendFunc(GL_DST_COLOR, GL_ZERO);
+			}
+		}
 
 		// Flips
 		if (epatch->flipX())
@@ -511,6 +615,14 @@ void CTextureCanvas::drawPatch(int num, bool outside)
 	// Draw the patch
 	drawing::drawTexture(patch_textures_[num], 0, 0, flipx, flipy);
 
+	// Reset blending
+	if (epatch)
+	{
+		glBlendEquation(GL_FUNC_ADD);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glDisable(GL_ALPHA_TEST);
+	}
+
 	glPopMatrix();
 }
 
@@ -653,8 +765,13 @@ void CTextureCanvas::drawOffsetLines() const
 // -----------------------------------------------------------------------------
 void CTextureCanvas::redraw(bool update_texture)
 {
+	// The full preview is regenerated once the texture hasn't changed for a
+	// moment (eg. when a spin control is released)
 	if (update_texture)
-		updateTexturePreview();
+	{
+		preview_pending_ = true;
+		timer_preview_.StartOnce(PREVIEW_DELAY);
+	}
 
 	Refresh();
 }
@@ -63,7 +63,11 @@ private:
 	CTexture*        texture_ = nullptr;
 	Archive*         parent_  = nullptr;
 	vector<unsigned> patch_textures_;
+	vector<string>   patch_colour_keys_; // Colour settings each patch texture was loaded with
+	vector<Vec2i>    patch_image_offsets_;
 	unsigned         tex_preview_;
+	bool             preview_pending_ = false; // Full preview is regenerated when timer_preview_ fires
+	wxTimer          timer_preview_;
 	vector<bool>     selected_patches_;
 	int              hilight_patch_ = -1;
 	Vec2d            offset_;
@@ -37,6 +37,7 @@
 #include "Graphics/Translation.h"
 #include "OpenGL/Drawing.h"
 #include "OpenGL/GLTexture.h"
+#include "OpenGL/Shader.h"
 #include "UI/SBrush.h"
 #include "Utility/MathStuff.h"
 
@@ -56,6 +57,16 @@ CVAR(Bool, gfx_hilight_mouseover, true, CVar::Flag::Save)
 CVAR(Bool, gfx_arc, false, CVar::Flag::Save)
 
 
+// -----------------------------------------------------------------------------
+//
+// External Variables
+//
+// -----------------------------------------------------------------------------
+EXTERN_CVAR(Float, col_greyscale_r)
+EXTERN_CVAR(Float, col_greyscale_g)
+EXTERN_CVAR(Float, col_greyscale_b)
+
+
 // -----------------------------------------------------------------------------
 //
 // GfxCanvas Class Functions
@@ -171,7 +182,6 @@ void GfxCanvas::drawOffsetLines() const
 
 // -----------------------------------------------------------------------------
 // Draws the image
-// (reloads the image as a texture each time, will change this later...)
 // -----------------------------------------------------------------------------
 void GfxCanvas::drawImage()
 {
@@ -211,10 +221,37 @@ void GfxCanvas::drawImage()
 			memset(drawing_mask_, false, image_.width() * image_.height());
 		}
 
-		gl::Texture::clear(tex_image_);
-		tex_image_ = gl::Texture::createFromImage(image_, &palette_);
-
+		uploadImage();
 		update_texture_ = false;
+		update_palette_ = false;
+	}
+	else if (update_palette_)
+	{
+		// Only the palette needs uploading for paletted images, otherwise the
+		// image is only re-uploaded if the effect can't be done by the shader
+		if (tex_indexed_)
+			uploadPalette();
+		else if (!gl::shader(gl::ShaderType::Image))
+			uploadImage();
+		update_palette_ = false;
+	}
+
+	// Setup shader for paletted images and effects
+	auto shader = gl::shader(gl::ShaderType::Image);
+	if (shader && (tex_indexed_ || effect_ != Effect::None))
+	{
+		shader->bind();
+		shader->setUniform("tex", 0);
+		shader->setUniform("palette", 1);
+		shader->setUniform("paletted", tex_indexed_ ? 1 : 0);
+		shader->setUniform("effect", tex_indexed_ ? 0 : static_cast<int>(effect_));
+		shader->setUniform("effect_colour", effect_colour_);
+		shader->setUniform("effect_amount", effect_amount_);
+		shader->setUniform("greyscale", col_greyscale_r, col_greyscale_g, col_greyscale_b);
+
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, tex_indexed_ ? tex_palette_ : 0);
+		glActiveTexture(GL_TEXTURE0);
 	}
 
 	// Determine (texture)coordinates
@@ -258,6 +295,8 @@ void GfxCanvas::drawImage()
 		gl::setColour(255, 255, 255, 255, gl::Blend::Normal);
 		drawing::drawTexture(tex_image_);
 	}
+	gl::Shader::unbind();
+
 	// Draw brush shadow when in editing mode
 	if (editing_mode_ != EditMode::None && cursor_pos_ != Vec2i{ -1, -1 })
 	{
@@ -294,6 +333,179 @@ void GfxCanvas::updateImageTexture()
 	Refresh();
 }
 
+// -----------------------------------------------------------------------------
+// Updates the image's palette (or preview effect/translation) without
+// re-uploading the whole image, if it is paletted
+// -----------------------------------------------------------------------------
+void GfxCanvas::updatePalette()
+{
+	update_palette_ = true;
+	Refresh();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the palette to draw the image with
+// -----------------------------------------------------------------------------
+void GfxCanvas::setPalette(Palette* pal)
+{
+	OGLCanvas::setPalette(pal);
+	updatePalette();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the colour [effect] to preview on the image, with [colour] and [amount]
+// (tint only). The image itself isn't modified
+// -----------------------------------------------------------------------------
+void GfxCanvas::setPreviewEffect(Effect effect, const ColRGBA& colour, float amount)
+{
+	effect_        = effect;
+	effect_colour_ = colour;
+	effect_amount_ = amount;
+	updatePalette();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the [translation] to preview on the image (nullptr for none). If
+// [truecolour] is true, translated colours aren't matched to the palette.
+// The image itself isn't modified, if the translation is changed this should
+// be called again to update the preview
+// -----------------------------------------------------------------------------
+void GfxCanvas::setPreviewTranslation(Translation* translation, bool truecolour)
+{
+	preview_translation_ = translation;
+	preview_truecolour_  = truecolour;
+
+	// Translations of truecolour images are applied on the CPU
+	if (tex_indexed_)
+		updatePalette();
+	else
+		updateImageTexture();
+}
+
+// -----------------------------------------------------------------------------
+// Uploads the image to the image texture. Paletted images are uploaded as
+// palette indices (+ alpha) if shaders are supported, and drawn via the
+// palette texture so palette, effect and translation changes only need the
+// palette to be uploaded again.
+// Otherwise the image is uploaded as RGBA, with the preview translation (and
+// effect, if shaders aren't supported) applied to a copy of it
+// -----------------------------------------------------------------------------
+void GfxCanvas::uploadImage()
+{
+	auto shader  = gl::shader(gl::ShaderType::Image);
+	auto indexed = shader && image_.type() == SImage::Type::PalMask;
+
+	// (Re)create the texture if its format is changing
+	if (tex_image_ == 0 || indexed != tex_indexed_)
+	{
+		gl::Texture::clear(tex_image_);
+		tex_image_ = gl::Texture::create();
+	}
+	tex_indexed_ = indexed;
+
+	if (indexed)
+	{
+		MemChunk data;
+		image_.putIndexedMaskData(data);
+		gl::Texture::loadIndexedData(tex_image_, data.data(), image_.width(), image_.height());
+		uploadPalette();
+		return;
+	}
+
+	// Apply preview translation/effect to a copy of the image if needed
+	SImage  preview;
+	SImage* image = &image_;
+	if (preview_translation_ || (effect_ != Effect::None && !shader))
+	{
+		preview.copyImage(&image_);
+		if (preview_translation_)
+			preview.applyTranslation(preview_translation_, &palette_, preview_truecolour_);
+		if (!shader)
+			applyPreviewEffect(preview);
+		image = &preview;
+	}
+
+	// Update the existing texture if the size hasn't changed
+	auto& tex_info = gl::Texture::info(tex_image_);
+	if (tex_info.size.x == image->width() && tex_info.size.y == image->height() && !tex_info.compressed)
+	{
+		MemChunk rgba;
+		image->putRGBAData(rgba, &palette_);
+		gl::Texture::loadSubData(tex_image_, rgba.data(), 0, 0, image->width(), image->height());
+	}
+	else
+		gl::Texture::loadImage(tex_image_, *image, &palette_);
+}
+
+// -----------------------------------------------------------------------------
+// Uploads the palette (with the preview translation and effect applied) to
+// the palette lookup texture
+// -----------------------------------------------------------------------------
+void GfxCanvas::uploadPalette()
+{
+	auto pal   = image_.hasPalette() ? image_.palette() : &palette_;
+	auto trans = preview_translation_ ? preview_translation_->table(pal) : nullptr;
+
+	uint8_t table[256 * 4];
+	for (unsigned a = 0; a < 256; ++a)
+	{
+		auto col = pal->colour(a);
+		if (trans)
+			col = preview_truecolour_ ? trans[a] : pal->colour(trans[a].index);
+
+		// Effects on paletted images are matched to the palette, the same as
+		// SImage::tint/colourise (unless the translation is truecolour)
+		col = previewColour(col, *pal, !(trans && preview_truecolour_));
+
+		table[a * 4]     = col.r;
+		table[a * 4 + 1] = col.g;
+		table[a * 4 + 2] = col.b;
+		table[a * 4 + 3] = 255;
+	}
+
+	if (tex_palette_ == 0)
+		tex_palette_ = gl::Texture::create(gl::TexFilter::Nearest, false);
+	gl::Texture::loadData(tex_palette_, table, 256, 1);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [colour] with the preview effect applied. If [match] is true, the
+// result is the nearest matching colour in [palette]
+// -----------------------------------------------------------------------------
+ColRGBA GfxCanvas::previewColour(ColRGBA colour, Palette& palette, bool match) const
+{
+	if (effect_ == Effect::Tint)
+	{
+		auto inv_amt = 1.0f - effect_amount_;
+		colour.set(
+			colour.r * inv_amt + effect_colour_.r * effect_amount_,
+			colour.g * inv_amt + effect_colour_.g * effect_amount_,
+			colour.b * inv_amt + effect_colour_.b * effect_amount_,
+			colour.a);
+	}
+	else if (effect_ == Effect::Colourise)
+	{
+		float grey = (colour.r * col_greyscale_r + colour.g * col_greyscale_g + colour.b * col_greyscale_b) / 255.0f;
+		grey       = std::min(grey, 1.0f);
+		colour.set(effect_colour_.r * grey, effect_colour_.g * grey, effect_colour_.b * grey, colour.a);
+	}
+	else
+		return colour;
+
+	return match ? palette.colour(palette.nearestColour(colour)) : colour;
+}
+
+// -----------------------------------------------------------------------------
+// Applies the preview effect to [image]
+// -----------------------------------------------------------------------------
+void GfxCanvas::applyPreviewEffect(SImage& image)
+{
+	if (effect_ == Effect::Tint)
+		image.tint(effect_colour_, effect_amount_, &palette_);
+	else if (effect_ == Effect::Colourise)
+		image.colourise(effect_colour_, &palette_);
+}
+
 // -----------------------------------------------------------------------------
 // Scales the image to fit within the gfx canvas.
 // If mag is false, the image will not be stretched to fit the canvas
@@ -31,6 +31,14 @@ public:
 		Translate
 	};
 
+	// Colour effect to preview on the image (without modifying it)
+	enum class Effect
+	{
+		None,
+		Tint,
+		Colourise
+	};
+
 	GfxCanvas(wxWindow* parent, int id);
 	~GfxCanvas() = default;
 
@@ -50,10 +58,15 @@ public:
 	SBrush* brush() const { return brush_; }
 	ColRGBA paintColour() const { return paint_colour_; }
 
+	void setPalette(Palette* pal) override;
+	void setPreviewEffect(Effect effect, const ColRGBA& colour = ColRGBA::WHITE, float amount = 1.f);
+	void setPreviewTranslation(Translation* translation, bool truecolour = false);
+
 	void draw() override;
 	void drawImage();
 	void drawOffsetLines() const;
 	void updateImageTexture();
+	void updatePalette();
 	void endOffsetDrag();
 	void paintPixel(int x, int y);
 	void brushCanvas(int x, int y);
@@ -72,7 +85,10 @@ private:
 	double       scale_     = 1.;
 	Vec2d        offset_; // panning offsets (not image offsets)
 	unsigned     tex_image_      = 0;
+	unsigned     tex_palette_    = 0;     // Palette lookup texture for paletted images
+	bool         tex_indexed_    = false; // True if tex_image_ contains palette indices
 	bool         update_texture_ = false;
+	bool         update_palette_ = false;
 	bool         image_hilight_  = false;
 	bool         allow_drag_     = false;
 	bool         allow_scroll_   = false;
@@ -89,6 +105,18 @@ private:
 	Vec2i        prev_pos_     = { -1, -1 };     // previous position of cursor
 	unsigned     tex_brush_    = 0;              // preview the effect of the brush
 
+	// Preview effect/translation
+	Effect       effect_              = Effect::None;
+	ColRGBA      effect_colour_       = ColRGBA::WHITE;
+	float        effect_amount_       = 1.f;
+	Translation* preview_translation_ = nullptr;
+	bool         preview_truecolour_  = false;
+
+	void    uploadImage();
+	void    uploadPalette();
+	ColRGBA previewColour(ColRGBA colour, Palette& palette, bool match) const;
+	void    applyPreviewEffect(SImage& image);
+
 	// Signal connections
 	sigslot::scoped_connection sc_image_changed_;
 
@@ -34,16 +34,12 @@
 #include "MapPreviewCanvas.h"
 #include "App.h"
 #include "Archive/ArchiveManager.h"
-#include "Archive/Formats/WadArchive.h"
 #include "General/ColourConfiguration.h"
 #include "Graphics/SImage/SIFormat.h"
 #include "Graphics/SImage/SImage.h"
 #include "OpenGL/GLTexture.h"
-#include "SLADEMap/MapFormat/Doom64MapFormat.h"
-#include "SLADEMap/MapFormat/DoomMapFormat.h"
-#include "SLADEMap/MapFormat/HexenMapFormat.h"
-#include "SLADEMap/MapObject/MapThing.h"
-#include "Utility/Tokenizer.h"
+#include "SLADEMap/MapPreviewData.h"
+#include "Utility/ThreadPool.h"
 
 using namespace slade;
 
@@ -55,6 +51,10 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 CVAR(Float, map_image_thickness, 1.5, CVar::Flag::Save)
 CVAR(Bool, map_view_things, true, CVar::Flag::Save)
+namespace
+{
+constexpr float THING_RADIUS = 20.f;
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -65,587 +65,256 @@ CVAR(Bool, map_view_things, true, CVar::Flag::Save)
 
 
 // -----------------------------------------------------------------------------
-// Adds a vertex to the map data
+// MapPreviewCanvas class destructor
 // -----------------------------------------------------------------------------
-void MapPreviewCanvas::addVertex(double x, double y)
+MapPreviewCanvas::~MapPreviewCanvas()
 {
-	verts_.emplace_back(x, y);
-}
+	if (load_job_)
+		load_job_->cancel();
 
-// -----------------------------------------------------------------------------
-// Adds a line to the map data
-// -----------------------------------------------------------------------------
-void MapPreviewCanvas::addLine(unsigned v1, unsigned v2, bool twosided, bool special, bool macro)
-{
-	lines_.emplace_back(v1, v2, twosided, special, macro);
+	if (vbo_lines_ > 0)
+		glDeleteBuffers(1, &vbo_lines_);
+	if (vbo_things_ > 0)
+		glDeleteBuffers(1, &vbo_things_);
 }
 
 // -----------------------------------------------------------------------------
-// Adds a thing to the map data
-// -----------------------------------------------------------------------------
-void MapPreviewCanvas::addThing(double x, double y)
-{
-	things_.emplace_back(x, y);
-}
-
-// -----------------------------------------------------------------------------
-// Opens a map from a mapdesc_t
+// Opens a preview of [map]. The map data is read in the background, the
+// preview is shown (and the map loaded callback called) when it is done.
+// Returns false if the map couldn't be opened
 // -----------------------------------------------------------------------------
 bool MapPreviewCanvas::openMap(Archive::MapDesc map)
 {
-	auto m_head = map.head.lock();
-	if (!m_head)
-		return false;
+	clearMap();
 
 	// All errors = invalid map
 	global::error = "Invalid map";
 
-	// Init
-	std::unique_ptr<Archive> temp_archive;
-
-	// Check if this map is a pk3 map
-	bool map_archive = false;
-	if (map.archive)
-	{
-		map_archive = true;
-
-		// Attempt to open entry as wad archive
-		temp_archive_ = std::make_unique<WadArchive>();
-		if (!temp_archive_->open(m_head->data()))
-		{
-			temp_archive_.reset();
-			return false;
-		}
-
-		// Detect maps
-		auto maps = temp_archive_->detectMaps();
-
-		// Set map if there are any in the archive
-		if (!maps.empty())
-			map = maps[0];
-		else
-			return false;
-
-		m_head = maps[0].head.lock();
-	}
-
-	// Parse UDMF map
-	if (map.format == MapFormat::UDMF)
-	{
-		ArchiveEntry* udmfdata  = nullptr;
-		auto          archive   = m_head->parent();
-		auto          index     = archive->entryIndex(m_head.get());
-		auto          end_index = archive->entryIndex(map.end.lock().get());
-		while (index <= end_index)
-		{
-			// Check entry type
-			auto entry = archive->entryAt(index);
-			if (entry->type() == EntryType::fromId("udmf_textmap"))
-			{
-				udmfdata = entry;
-				break;
-			}
-			++index;
-		}
-		if (udmfdata == nullptr)
-			return false;
-
-		// Start parsing
-		Tokenizer tz;
-		tz.openMem(udmfdata->data(), m_head->name());
-
-		// Get first token
-		wxString token       = tz.getToken();
-		size_t   vertcounter = 0, linecounter = 0, thingcounter = 0;
-		while (!token.IsEmpty())
-		{
-			if (!token.CmpNoCase("namespace"))
-			{
-				//  skip till we reach the ';'
-				do
-				{
-					token = tz.getToken();
-				} while (token.Cmp(";"));
-			}
-			else if (!token.CmpNoCase("vertex"))
-			{
-				// Get X and Y properties
-				bool   gotx = false;
-				bool   goty = false;
-				double x    = 0.;
-				double y    = 0.;
-				do
-				{
-					token = tz.getToken();
-					if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
-					{
-						bool isx = !token.CmpNoCase("x");
-						token    = tz.getToken();
-						if (token.Cmp("="))
-						{
-							log::error(wxString::Format("Bad syntax for vertex %i in UDMF map data", vertcounter));
-							return false;
-						}
-						if (isx)
-							x = tz.getDouble(), gotx = true;
-						else
-							y = tz.getDouble(), goty = true;
-						// skip to end of declaration after each key
-						do
-						{
-							token = tz.getToken();
-						} while (token.Cmp(";"));
-					}
-				} while (token.Cmp("}"));
-				if (gotx && goty)
-					addVertex(x, y);
-				else
-				{
-					log::error(wxString::Format("Wrong vertex %i in UDMF map data", vertcounter));
-					return false;
-				}
-				vertcounter++;
-			}
-			else if (!token.CmpNoCase("linedef"))
-			{
-				bool   special  = false;
-				bool   twosided = false;
-				bool   gotv1 = false, gotv2 = false;
-				size_t v1 = 0, v2 = 0;
-				do
-				{
-					token = tz.getToken();
-					if (!token.CmpNoCase("v1") || !token.CmpNoCase("v2"))
-					{
-						bool isv1 = !token.CmpNoCase("v1");
-						token     = tz.getToken();
-						if (token.Cmp("="))
-						{
-							log::error(wxString::Format("Bad syntax for linedef %i in UDMF map data", linecounter));
-							return false;
-						}
-						if (isv1)
-							v1 = tz.getInteger(), gotv1 = true;
-						else
-							v2 = tz.getInteger(), gotv2 = true;
-						// skip to end of declaration after each key
-						do
-						{
-							token = tz.getToken();
-						} while (token.Cmp(";"));
-					}
-					else if (!token.CmpNoCase("special"))
-					{
-						special = true;
-						// skip to end of declaration after each key
-						do
-						{
-							token = tz.getToken();
-						} while (token.Cmp(";"));
-					}
-					else if (!token.CmpNoCase("sideback"))
-					{
-						twosided = true;
-						// skip to end of declaration after each key
-						do
-						{
-							token = tz.getToken();
-						} while (token.Cmp(";"));
-					}
-				} while (token.Cmp("}"));
-				if (gotv1 && gotv2)
-					addLine(v1, v2, twosided, special);
-				else
-				{
-					log::error(wxString::Format("Wrong line %i in UDMF map data", linecounter));
-					return false;
-				}
-				linecounter++;
-			}
-			else if (S_CMPNOCASE(token, "thing"))
-			{
-				// Get X and Y properties
-				bool   gotx = false;
-				bool   goty = false;
-				double x    = 0.;
-				double y    = 0.;
-				do
-				{
-					token = tz.getToken();
-					if (!token.CmpNoCase("x") || !token.CmpNoCase("y"))
-					{
-						bool isx = !token.CmpNoCase("x");
-						token    = tz.getToken();
-						if (token.Cmp("="))
-						{
-							log::error(wxString::Format("Bad syntax for thing %i in UDMF map data", vertcounter));
-							return false;
-						}
-						if (isx)
-							x = tz.getDouble(), gotx = true;
-						else
-							y = tz.getDouble(), goty = true;
-						// skip to end of declaration after each key
-						do
-						{
-							token = tz.getToken();
-						} while (token.Cmp(";"));
-					}
-				} while (token.Cmp("}"));
-				if (gotx && goty)
-					addThing(x, y);
-				else
-				{
-					log::error(wxString::Format("Wrong thing %i in UDMF map data", vertcounter));
-					return false;
-				}
-				vertcounter++;
-			}
-			else
-			{
-				// Check for side or sector definition (increase counts)
-				if (S_CMPNOCASE(token, "sidedef"))
-					n_sides_++;
-				else if (S_CMPNOCASE(token, "sector"))
-					n_sectors_++;
-
-				// map preview ignores sidedefs, sectors, comments,
-				// unknown fields, etc. so skip to end of block
-				do
-				{
-					token = tz.getToken();
-				} while (token.Cmp("}") && !token.empty());
-			}
-			// Iterate to next token
-			token = tz.getToken();
-		}
-	}
-
-	// Non-UDMF map
-	if (map.format != MapFormat::UDMF)
-	{
-		auto m_head = map.head.lock().get();
-		auto m_end  = map.end.lock().get();
-
-		// Read vertices (required)
-		if (!readVertices(m_head, m_end, map.format))
-			return false;
-
-		// Read linedefs (required)
-		if (!readLines(m_head, m_end, map.format))
-			return false;
-
-		// Read things
-		if (map.format != MapFormat::UDMF)
-			readThings(m_head, m_end, map.format);
-
-		// Read sides & sectors (count only)
-		ArchiveEntry* sidedefs = nullptr;
-		ArchiveEntry* sectors  = nullptr;
-		while (m_head)
-		{
-			// Check entry type
-			if (m_head->type() == EntryType::fromId("map_sidedefs"))
-				sidedefs = m_head;
-			if (m_head->type() == EntryType::fromId("map_sectors"))
-				sectors = m_head;
-
-			// Exit loop if we've reached the end of the map entries
-			if (m_head == m_end)
-				break;
-			else
-				m_head = m_head->nextEntry();
-		}
-		if (sidedefs && sectors)
-		{
-			// Doom64 map
-			if (map.format != MapFormat::Doom64)
-			{
-				n_sides_   = sidedefs->size() / 30;
-				n_sectors_ = sectors->size() / 26;
-			}
-
-			// Doom/Hexen map
-			else
-			{
-				n_sides_   = sidedefs->size() / 12;
-				n_sectors_ = sectors->size() / 16;
-			}
-		}
-	}
-
-	// Clean up
-	if (map_archive)
-	{
-		temp_archive_->close();
-		temp_archive_ = nullptr;
-	}
+	// Get the map data to read
+	auto source = std::make_shared<mappreview::Source>();
+	if (!mappreview::getSource(map, *source))
+		return false;
 
-	// Refresh map
-	Refresh();
+	// Read the map preview in the background
+	auto result  = std::make_shared<shared_ptr<const MapPreviewData>>();
+	load_result_ = result;
+	load_job_    = Job::start([source, result](Job& job) { *result = mappreview::read(*source, &job); });
+	load_job_->onComplete([this, job = load_job_.get()]() {
+		if (job == load_job_.get())
+			finishLoading();
+	});
 
 	return true;
 }
 
 // -----------------------------------------------------------------------------
-// Reads non-UDMF vertex data
+// Clears map data, cancelling any map currently being read
 // -----------------------------------------------------------------------------
-bool MapPreviewCanvas::readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+void MapPreviewCanvas::clearMap()
 {
-	// Find VERTEXES entry
-	ArchiveEntry* vertexes = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->type() == EntryType::fromId("map_vertexes"))
-		{
-			vertexes = map_head;
-			break;
-		}
+	if (load_job_)
+		load_job_->cancel();
+	load_job_.reset();
+	load_result_.reset();
 
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
-	}
+	data_.reset();
+	vbo_outdated_ = true;
+	Refresh();
+}
 
-	// Can't open a map without vertices
-	if (!vertexes)
-		return false;
+// -----------------------------------------------------------------------------
+// Waits for the map currently being read (if any) and shows it
+// -----------------------------------------------------------------------------
+void MapPreviewCanvas::finishLoading()
+{
+	if (!load_job_)
+		return;
 
-	// Read vertex data
-	auto& mc = vertexes->data();
-	mc.seek(0, SEEK_SET);
+	load_job_->wait();
+	data_ = *load_result_;
+	load_job_.reset();
+	load_result_.reset();
 
-	if (map_format == MapFormat::Doom64)
-	{
-		Doom64MapFormat::Vertex v;
-		while (true)
-		{
-			// Read vertex
-			if (!mc.read(&v, 8))
-				break;
+	vbo_outdated_ = true;
+	Refresh();
 
-			// Add vertex
-			addVertex((double)v.x / 65536, (double)v.y / 65536);
-		}
-	}
-	else
-	{
-		DoomMapFormat::Vertex v;
-		while (true)
-		{
-			// Read vertex
-			if (!mc.read(&v, 4))
-				break;
+	if (on_map_loaded_)
+		on_map_loaded_(data_ != nullptr);
+}
 
-			// Add vertex
-			addVertex((double)v.x, (double)v.y);
-		}
-	}
+// -----------------------------------------------------------------------------
+// Adjusts zoom and offset to show the whole map in a [width]x[height] view
+// -----------------------------------------------------------------------------
+void MapPreviewCanvas::showMap(int width, int height)
+{
+	// Offset to center of map
+	double map_width  = data_->max.x - data_->min.x;
+	double map_height = data_->max.y - data_->min.y;
+	offset_           = { data_->min.x + (map_width * 0.5), data_->min.y + (map_height * 0.5) };
 
-	return true;
+	// Zoom to fit whole map
+	double x_scale = static_cast<double>(width) / map_width;
+	double y_scale = static_cast<double>(height) / map_height;
+	zoom_          = std::min<double>(x_scale, y_scale);
+	zoom_ *= 0.95;
 }
 
 // -----------------------------------------------------------------------------
-// Reads non-UDMF line data
+// Rebuilds the line vertices with the given colours (if they have changed) and
+// the thing vertices (if the map has changed), and uploads them to VBOs if
+// supported. Two-sided lines are first so one-sided lines are drawn over them
 // -----------------------------------------------------------------------------
-bool MapPreviewCanvas::readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+void MapPreviewCanvas::updateBuffers(
+	const ColRGBA& col_1s,
+	const ColRGBA& col_2s,
+	const ColRGBA& col_special,
+	const ColRGBA& col_macro)
 {
-	// Find LINEDEFS entry
-	ArchiveEntry* linedefs = nullptr;
-	while (map_head)
+	ColRGBA colours[4]      = { col_1s, col_2s, col_special, col_macro };
+	bool    colours_changed = false;
+	for (unsigned a = 0; a < 4; ++a)
+		if (!colours[a].equals(line_colours_[a], true))
+			colours_changed = true;
+
+	if (!vbo_outdated_ && !colours_changed)
+		return;
+
+	// Lines
+	line_verts_.clear();
+	if (data_)
 	{
-		// Check entry type
-		if (map_head->type() == EntryType::fromId("map_linedefs"))
+		auto nverts = data_->verts.size();
+		line_verts_.reserve(data_->lines.size() * 2);
+		for (auto twosided : { true, false })
 		{
-			linedefs = map_head;
-			break;
+			for (const auto& line : data_->lines)
+			{
+				if (line.twosided != twosided || line.v1 >= nverts || line.v2 >= nverts)
+					continue;
+
+				// Get colour
+				auto col = twosided ? col_2s : col_1s;
+				if (line.special)
+					col = col_special;
+				else if (line.macro)
+					col = col_macro;
+
+				auto& v1 = data_->verts[line.v1];
+				auto& v2 = data_->verts[line.v2];
+				line_verts_.push_back({ float(v1.x), float(v1.y), col.fr(), col.fg(), col.fb(), col.fa() });
+				line_verts_.push_back({ float(v2.x), float(v2.y), col.fr(), col.fg(), col.fb(), col.fa() });
+			}
 		}
-
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
 	}
+	for (unsigned a = 0; a < 4; ++a)
+		line_colours_[a] = colours[a];
 
-	// Can't open a map without linedefs
-	if (!linedefs)
-		return false;
-
-	// Read line data
-	auto& mc = linedefs->data();
-	mc.seek(0, SEEK_SET);
-	if (map_format == MapFormat::Doom)
+	// Things (as textured quads)
+	if (vbo_outdated_)
 	{
-		while (true)
+		thing_verts_.clear();
+		if (data_)
 		{
-			// Read line
-			DoomMapFormat::LineDef l;
-			if (!mc.read(&l, sizeof(DoomMapFormat::LineDef)))
-				break;
-
-			// Check properties
-			bool special  = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-				special = true;
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special);
-		}
-	}
-	else if (map_format == MapFormat::Doom64)
-	{
-		while (true)
-		{
-			// Read line
-			Doom64MapFormat::LineDef l;
-			if (!mc.read(&l, sizeof(Doom64MapFormat::LineDef)))
-				break;
-
-			// Check properties
-			bool macro    = false;
-			bool special  = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
+			thing_verts_.reserve(data_->things.size() * 4);
+			for (const auto& thing : data_->things)
 			{
-				if (l.type & 0x100)
-					macro = true;
-				else
-					special = true;
+				float x = thing.x, y = thing.y, r = THING_RADIUS;
+				thing_verts_.push_back({ x - r, y - r, 0.f, 0.f });
+				thing_verts_.push_back({ x - r, y + r, 0.f, 1.f });
+				thing_verts_.push_back({ x + r, y + r, 1.f, 1.f });
+				thing_verts_.push_back({ x + r, y - r, 1.f, 0.f });
 			}
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special, macro);
 		}
 	}
-	else if (map_format == MapFormat::Hexen)
+
+	// Upload to VBOs
+	if (gl::vboSupport())
 	{
-		while (true)
+		if (vbo_lines_ == 0)
+			glGenBuffers(1, &vbo_lines_);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(LineVert) * line_verts_.size(), line_verts_.data(), GL_STATIC_DRAW);
+
+		if (vbo_outdated_)
 		{
-			// Read line
-			HexenMapFormat::LineDef l;
-			if (!mc.read(&l, sizeof(HexenMapFormat::LineDef)))
-				break;
-
-			// Check properties
-			bool special  = false;
-			bool twosided = false;
-			if (l.side2 != 0xFFFF)
-				twosided = true;
-			if (l.type > 0)
-				special = true;
-
-			// Add line
-			addLine(l.vertex1, l.vertex2, twosided, special);
+			if (vbo_things_ == 0)
+				glGenBuffers(1, &vbo_things_);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_things_);
+			glBufferData(
+				GL_ARRAY_BUFFER, sizeof(ThingVert) * thing_verts_.size(), thing_verts_.data(), GL_STATIC_DRAW);
 		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
-	return true;
+	vbo_outdated_ = false;
 }
 
 // -----------------------------------------------------------------------------
-// Reads non-UDMF thing data
+// Draws the map lines, from the lines VBO if supported (otherwise from the
+// line vertices in memory)
 // -----------------------------------------------------------------------------
-bool MapPreviewCanvas::readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format)
+void MapPreviewCanvas::drawLines() const
 {
-	// Find THINGS entry
-	ArchiveEntry* things = nullptr;
-	while (map_head)
-	{
-		// Check entry type
-		if (map_head->type() == EntryType::fromId("map_things"))
-		{
-			things = map_head;
-			break;
-		}
+	if (line_verts_.empty())
+		return;
 
-		// Exit loop if we've reached the end of the map entries
-		if (map_head == map_end)
-			break;
-		else
-			map_head = map_head->nextEntry();
-	}
-
-	// No things
-	if (!things)
-		return false;
-
-	// Read things data
-	if (map_format == MapFormat::Doom)
-	{
-		auto     thng_data = (DoomMapFormat::Thing*)things->rawData(true);
-		unsigned nt        = things->size() / sizeof(DoomMapFormat::Thing);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-	else if (map_format == MapFormat::Doom64)
+	auto base = reinterpret_cast<const char*>(line_verts_.data());
+	if (vbo_lines_ > 0)
 	{
-		auto     thng_data = (Doom64MapFormat::Thing*)things->rawData(true);
-		unsigned nt        = things->size() / sizeof(Doom64MapFormat::Thing);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
-	}
-	else if (map_format == MapFormat::Hexen)
-	{
-		auto     thng_data = (HexenMapFormat::Thing*)things->rawData(true);
-		unsigned nt        = things->size() / sizeof(HexenMapFormat::Thing);
-		for (size_t a = 0; a < nt; a++)
-			addThing(thng_data[a].x, thng_data[a].y);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_lines_);
+		base = nullptr;
 	}
 
-	return true;
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(LineVert), base);
+	glColorPointer(4, GL_FLOAT, sizeof(LineVert), base + offsetof(LineVert, r));
+	glDrawArrays(GL_LINES, 0, line_verts_.size());
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 // -----------------------------------------------------------------------------
-// Clears map data
+// Draws the map things (with the current colour), from the things VBO if
+// supported (otherwise from the thing vertices in memory)
 // -----------------------------------------------------------------------------
-void MapPreviewCanvas::clearMap()
+void MapPreviewCanvas::drawThings() const
 {
-	verts_.clear();
-	lines_.clear();
-	things_.clear();
-	n_sides_   = 0;
-	n_sectors_ = 0;
-}
+	if (thing_verts_.empty())
+		return;
 
-// -----------------------------------------------------------------------------
-// Adjusts zoom and offset to show the whole map
-// -----------------------------------------------------------------------------
-void MapPreviewCanvas::showMap()
-{
-	// Find extents of map
-	Vertex m_min(999999.0, 999999.0);
-	Vertex m_max(-999999.0, -999999.0);
-	for (auto& vert : verts_)
+	// Draw as points if there is no thing texture
+	if (!tex_thing_)
 	{
-		if (vert.x < m_min.x)
-			m_min.x = vert.x;
-		if (vert.x > m_max.x)
-			m_max.x = vert.x;
-		if (vert.y < m_min.y)
-			m_min.y = vert.y;
-		if (vert.y > m_max.y)
-			m_max.y = vert.y;
+		glEnable(GL_POINT_SMOOTH);
+		glPointSize(8.0f);
+		glBegin(GL_POINTS);
+		for (auto& thing : data_->things)
+			glVertex2d(thing.x, thing.y);
+		glEnd();
+		return;
 	}
 
-	// Offset to center of map
-	double width  = m_max.x - m_min.x;
-	double height = m_max.y - m_min.y;
-	offset_       = { m_min.x + (width * 0.5), m_min.y + (height * 0.5) };
+	auto base = reinterpret_cast<const char*>(thing_verts_.data());
+	if (vbo_things_ > 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_things_);
+		base = nullptr;
+	}
 
-	// Zoom to fit whole map
-	double x_scale = ((double)GetClientSize().x) / width;
-	double y_scale = ((double)GetClientSize().y) / height;
-	zoom_          = std::min<double>(x_scale, y_scale);
-	zoom_ *= 0.95;
+	glEnable(GL_TEXTURE_2D);
+	gl::Texture::bind(tex_thing_);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(ThingVert), base);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(ThingVert), base + offsetof(ThingVert, tx));
+	glDrawArrays(GL_QUADS, 0, thing_verts_.size());
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDisable(GL_TEXTURE_2D);
 }
 
 // -----------------------------------------------------------------------------
@@ -654,12 +323,7 @@ void MapPreviewCanvas::showMap()
 void MapPreviewCanvas::draw()
 {
 	// Setup colours
-	auto col_view_background   = colourconfig::colour("map_view_background");
-	auto col_view_line_1s      = colourconfig::colour("map_view_line_1s");
-	auto col_view_line_2s      = colourconfig::colour("map_view_line_2s");
-	auto col_view_line_special = colourconfig::colour("map_view_line_special");
-	auto col_view_line_macro   = colourconfig::colour("map_view_line_macro");
-	auto col_view_thing        = colourconfig::colour("map_view_thing");
+	auto col_view_background = colourconfig::colour("map_view_background");
 
 	// Setup the viewport
 	glViewport(0, 0, GetSize().x, GetSize().y);
@@ -680,12 +344,26 @@ void MapPreviewCanvas::draw()
 		((double)col_view_background.a) / 255.f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	// Nothing more to draw if no map is loaded
+	if (!data_)
+	{
+		SwapBuffers();
+		return;
+	}
+
+	// Update vertex buffers if needed
+	updateBuffers(
+		colourconfig::colour("map_view_line_1s"),
+		colourconfig::colour("map_view_line_2s"),
+		colourconfig::colour("map_view_line_special"),
+		colourconfig::colour("map_view_line_macro"));
+
 	// Translate to inside of pixel (otherwise inaccuracies can occur on certain gl implementations)
 	if (gl::accuracyTweak())
 		glTranslatef(0.375f, 0.375f, 0);
 
 	// Zoom/offset to show full map
-	showMap();
+	showMap(GetClientSize().x, GetClientSize().y);
 
 	// Translate to middle of canvas
 	glTranslated(GetSize().x * 0.5, GetSize().y * 0.5, 0);
@@ -703,32 +381,7 @@ void MapPreviewCanvas::draw()
 	glEnable(GL_LINE_SMOOTH);
 
 	// Draw lines
-	for (auto& line : lines_)
-	{
-		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
-			continue;
-
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_view_line_special);
-		else if (line.macro)
-			gl::setColour(col_view_line_macro);
-		else if (line.twosided)
-			gl::setColour(col_view_line_2s);
-		else
-			gl::setColour(col_view_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
-	}
+	drawLines();
 
 	// Load thing texture if needed
 	if (!tex_loaded_)
@@ -750,38 +403,8 @@ void MapPreviewCanvas::draw()
 	// Draw things
 	if (map_view_things)
 	{
-		gl::setColour(col_view_thing);
-		if (tex_thing_)
-		{
-			double radius = 20;
-			glEnable(GL_TEXTURE_2D);
-			gl::Texture::bind(tex_thing_);
-			for (auto& thing : things_)
-			{
-				glPushMatrix();
-				glTranslated(thing.x, thing.y, 0);
-				glBegin(GL_QUADS);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex2d(-radius, -radius);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex2d(-radius, radius);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex2d(radius, radius);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex2d(radius, -radius);
-				glEnd();
-				glPopMatrix();
-			}
-		}
-		else
-		{
-			glEnable(GL_POINT_SMOOTH);
-			glPointSize(8.0f);
-			glBegin(GL_POINTS);
-			for (auto& thing : things_)
-				glVertex2d(thing.x, thing.y);
-			glEnd();
-		}
+		gl::setColour(colourconfig::colour("map_view_thing"));
+		drawThings();
 	}
 
 	glLineWidth(1.0f);
@@ -793,28 +416,20 @@ void MapPreviewCanvas::draw()
 
 
 // -----------------------------------------------------------------------------
-// Draws the map in an image
-// TODO: Factorize code with normal draw() and showMap() functions.
+// Draws the map in an image, and imports it to [ae] as a png.
+// A [width] or [height] of 0 or less means the map size divided by its
+// absolute value (or 5 if 0).
 // TODO: Find a way to generate an arbitrary-sized image through tiled rendering
 // -----------------------------------------------------------------------------
 void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 {
-	// Find extents of map
-	Vertex m_min(999999.0, 999999.0);
-	Vertex m_max(-999999.0, -999999.0);
-	for (auto& vert : verts_)
-	{
-		if (vert.x < m_min.x)
-			m_min.x = vert.x;
-		if (vert.x > m_max.x)
-			m_max.x = vert.x;
-		if (vert.y < m_min.y)
-			m_min.y = vert.y;
-		if (vert.y > m_max.y)
-			m_max.y = vert.y;
-	}
-	double mapwidth  = m_max.x - m_min.x;
-	double mapheight = m_max.y - m_min.y;
+	// Make sure the map has been read
+	finishLoading();
+	if (!data_)
+		return;
+
+	double mapwidth  = data_->max.x - data_->min.x;
+	double mapheight = data_->max.y - data_->min.y;
 
 	if (width == 0)
 		width = -5;
@@ -826,11 +441,7 @@ void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 		height = mapheight / abs(height);
 
 	// Setup colours
-	auto col_save_background   = colourconfig::colour("map_image_background");
-	auto col_save_line_1s      = colourconfig::colour("map_image_line_1s");
-	auto col_save_line_2s      = colourconfig::colour("map_image_line_2s");
-	auto col_save_line_special = colourconfig::colour("map_image_line_special");
-	auto col_save_line_macro   = colourconfig::colour("map_image_line_macro");
+	auto col_save_background = colourconfig::colour("map_image_background");
 
 	// Setup OpenGL rigmarole
 	GLuint tex_id, fbo_id;
@@ -872,14 +483,7 @@ void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 		glTranslatef(0.375f, 0.375f, 0);
 
 	// Zoom/offset to show full map
-	// Offset to center of map
-	offset_ = { m_min.x + (mapwidth * 0.5), m_min.y + (mapheight * 0.5) };
-
-	// Zoom to fit whole map
-	double x_scale = ((double)width) / mapwidth;
-	double y_scale = ((double)height) / mapheight;
-	zoom_          = std::min<double>(x_scale, y_scale);
-	zoom_ *= 0.95;
+	showMap(width, height);
 
 	// Translate to middle of canvas
 	glTranslated(width >> 1, height >> 1, 0);
@@ -896,65 +500,13 @@ void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 	glLineWidth(map_image_thickness);
 	glEnable(GL_LINE_SMOOTH);
 
-	// Draw 2s lines
-	for (auto& line : lines_)
-	{
-		if (!line.twosided)
-			continue;
-
-		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
-			continue;
-
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_save_line_special);
-		else if (line.macro)
-			gl::setColour(col_save_line_macro);
-		else if (line.twosided)
-			gl::setColour(col_save_line_2s);
-		else
-			gl::setColour(col_save_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
-	}
-
-	// Draw 1s lines
-	for (auto& line : lines_)
-	{
-		if (line.twosided)
-			continue;
-
-		// Check ends
-		if (line.v1 >= verts_.size() || line.v2 >= verts_.size())
-			continue;
-
-		// Get vertices
-		auto v1 = verts_[line.v1];
-		auto v2 = verts_[line.v2];
-
-		// Set colour
-		if (line.special)
-			gl::setColour(col_save_line_special);
-		else if (line.macro)
-			gl::setColour(col_save_line_macro);
-		else
-			gl::setColour(col_save_line_1s);
-
-		// Draw line
-		glBegin(GL_LINES);
-		glVertex2d(v1.x, v1.y);
-		glVertex2d(v2.x, v2.y);
-		glEnd();
-	}
+	// Draw lines (with the image colours)
+	updateBuffers(
+		colourconfig::colour("map_image_line_1s"),
+		colourconfig::colour("map_image_line_2s"),
+		colourconfig::colour("map_image_line_special"),
+		colourconfig::colour("map_image_line_macro"));
+	drawLines();
 
 	glLineWidth(1.0f);
 	glDisable(GL_LINE_SMOOTH);
@@ -979,63 +531,55 @@ void MapPreviewCanvas::createImage(ArchiveEntry& ae, int width, int height)
 // -----------------------------------------------------------------------------
 // Returns the number of (attached) vertices in the map
 // -----------------------------------------------------------------------------
-unsigned MapPreviewCanvas::nVertices()
+unsigned MapPreviewCanvas::nVertices() const
 {
-	// Get list of used vertices
-	vector<bool> v_used;
-	for (unsigned a = 0; a < verts_.size(); a++)
-		v_used.push_back(false);
-	for (auto& line : lines_)
-	{
-		v_used[line.v1] = true;
-		v_used[line.v2] = true;
-	}
+	return data_ ? data_->n_vertices : 0;
+}
 
-	// Get count of used vertices
-	unsigned count = 0;
-	for (auto&& a : v_used)
-	{
-		if (a)
-			count++;
-	}
+// -----------------------------------------------------------------------------
+// Returns the number of sides in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::nSides() const
+{
+	return data_ ? data_->n_sides : 0;
+}
 
-	return count;
+// -----------------------------------------------------------------------------
+// Returns the number of lines in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::nLines() const
+{
+	return data_ ? data_->lines.size() : 0;
 }
 
 // -----------------------------------------------------------------------------
-// Returns the width (in map units) of the map
+// Returns the number of sectors in the map
 // -----------------------------------------------------------------------------
-unsigned MapPreviewCanvas::width()
+unsigned MapPreviewCanvas::nSectors() const
 {
-	int min_x = wxINT32_MAX;
-	int max_x = wxINT32_MIN;
+	return data_ ? data_->n_sectors : 0;
+}
 
-	for (auto& vertex : verts_)
-	{
-		if (vertex.x < min_x)
-			min_x = vertex.x;
-		if (vertex.x > max_x)
-			max_x = vertex.x;
-	}
+// -----------------------------------------------------------------------------
+// Returns the number of things in the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::nThings() const
+{
+	return data_ ? data_->things.size() : 0;
+}
 
-	return max_x - min_x;
+// -----------------------------------------------------------------------------
+// Returns the width (in map units) of the map
+// -----------------------------------------------------------------------------
+unsigned MapPreviewCanvas::width() const
+{
+	return data_ ? data_->width() : 0;
 }
 
 // -----------------------------------------------------------------------------
 // Returns the height (in map units) of the map
 // -----------------------------------------------------------------------------
-unsigned MapPreviewCanvas::height()
+unsigned MapPreviewCanvas::height() const
 {
-	int min_y = wxINT32_MAX;
-	int max_y = wxINT32_MIN;
-
-	for (auto& vertex : verts_)
-	{
-		if (vertex.y < min_y)
-			min_y = vertex.y;
-		if (vertex.y > max_y)
-			max_y = vertex.y;
-	}
-
-	return max_y - min_y;
+	return data_ ? data_->height() : 0;
 }
@@ -5,89 +5,73 @@
 
 namespace slade
 {
-class GLTexture;
+class Job;
+struct MapPreviewData;
 
+// Canvas showing a preview of a map's geometry. Maps are read in the background
+// (see mappreview::read), and drawn from vertex buffers
 class MapPreviewCanvas : public OGLCanvas
 {
 public:
 	MapPreviewCanvas(wxWindow* parent) : OGLCanvas(parent, -1) {}
-	~MapPreviewCanvas() = default;
+	~MapPreviewCanvas() override;
+
+	bool isLoading() const { return load_job_ != nullptr; }
+	void setOnMapLoaded(std::function<void(bool)> callback) { on_map_loaded_ = std::move(callback); }
 
-	void addVertex(double x, double y);
-	void addLine(unsigned v1, unsigned v2, bool twosided, bool special, bool macro = false);
-	void addThing(double x, double y);
 	bool openMap(Archive::MapDesc map);
-	bool readVertices(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format);
-	bool readLines(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format);
-	bool readThings(ArchiveEntry* map_head, ArchiveEntry* map_end, MapFormat map_format);
 	void clearMap();
-	void showMap();
+	void finishLoading();
 	void draw() override;
 	void createImage(ArchiveEntry& ae, int width, int height);
 
-	unsigned nVertices();
-	unsigned nSides() const { return n_sides_; }
-	unsigned nLines() const { return lines_.size(); }
-	unsigned nSectors() const { return n_sectors_; }
-	unsigned nThings() const { return things_.size(); }
-	unsigned width();
-	unsigned height();
+	unsigned nVertices() const;
+	unsigned nSides() const;
+	unsigned nLines() const;
+	unsigned nSectors() const;
+	unsigned nThings() const;
+	unsigned width() const;
+	unsigned height() const;
 
 private:
-	// Structs for basic map features
-	struct Vertex
+	// Vertex for drawing lines
+	struct LineVert
 	{
-		double x;
-		double y;
-		Vertex(double x, double y)
-		{
-			this->x = x;
-			this->y = y;
-		}
+		float x, y;
+		float r, g, b, a;
 	};
 
-	struct Line
+	// Vertex for drawing (textured) things
+	struct ThingVert
 	{
-		unsigned v1       = 0;
-		unsigned v2       = 0;
-		bool     twosided = false;
-		bool     special  = false;
-		bool     macro    = false;
-		bool     segment  = false;
-
-		Line(
-			unsigned v1,
-			unsigned v2,
-			bool     twosided = false,
-			bool     special  = false,
-			bool     macro    = false,
-			bool     segment  = false) :
-			v1{ v1 },
-			v2{ v2 },
-			twosided{ twosided },
-			special{ special },
-			macro{ macro },
-			segment{ segment }
-		{
-		}
+		float x, y;
+		float tx, ty;
 	};
 
-	struct Thing
-	{
-		double x;
-		double y;
-		Thing(double x, double y) : x{ x }, y{ y } {}
-	};
+	shared_ptr<const MapPreviewData>             data_;
+	shared_ptr<Job>                              load_job_;
+	shared_ptr<shared_ptr<const MapPreviewData>> load_result_; // Set by [load_job_] when it completes
+	std::function<void(bool)>                    on_map_loaded_;
+
+	// Drawing
+	vector<LineVert>  line_verts_;
+	vector<ThingVert> thing_verts_;
+	unsigned          vbo_lines_    = 0;
+	unsigned          vbo_things_   = 0;
+	bool              vbo_outdated_ = true;
+	ColRGBA           line_colours_[4]; // Colours used in [line_verts_] (1s, 2s, special, macro)
+	double            zoom_ = 1.;
+	Vec2d             offset_;
+	unsigned          tex_thing_;
+	bool              tex_loaded_ = false;
 
-	vector<Vertex>      verts_;
-	vector<Line>        lines_;
-	vector<Thing>       things_;
-	unsigned            n_sides_   = 0;
-	unsigned            n_sectors_ = 0;
-	double              zoom_      = 1.;
-	Vec2d               offset_;
-	unique_ptr<Archive> temp_archive_;
-	unsigned            tex_thing_;
-	bool                tex_loaded_ = false;
+	void showMap(int width, int height);
+	void updateBuffers(
+		const ColRGBA& col_1s,
+		const ColRGBA& col_2s,
+		const ColRGBA& col_special,
+		const ColRGBA& col_macro);
+	void drawLines() const;
+	void drawThings() const;
 };
 } // namespace slade
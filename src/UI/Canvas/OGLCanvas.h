@@ -19,7 +19,7 @@ public:
 	~OGLCanvas() = default;
 
 	virtual Palette& palette() { return palette_; }
-	void             setPalette(Palette* pal) { palette_.copyPalette(pal); }
+	virtual void     setPalette(Palette* pal) { palette_.copyPalette(pal); }
 	bool             setContext();
 	bool             createSFML();
 	void             init();
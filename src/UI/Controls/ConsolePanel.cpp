@@ -126,8 +126,9 @@ void ConsolePanel::update()
 	setupTextArea();
 
 	// Check if any new log messages were added since the last update
-	auto& log = log::history();
-	if (log.size() <= next_message_index_)
+	vector<log::Message> log;
+	next_message_index_ = log::history(next_message_index_, log);
+	if (log.empty())
 	{
 		// None added, check again in 500ms
 		timer_update_.Start(500);
@@ -136,20 +137,20 @@ void ConsolePanel::update()
 
 	// Add new log messages to log text area
 	text_log_->SetEditable(true);
-	int line_no = next_message_index_;
-	for (auto a = next_message_index_; a < log.size(); ++a)
+	for (auto& msg : log)
 	{
-		if (a > 0)
+		if (!text_log_->IsEmpty())
 			text_log_->AppendText("\n");
 
 		// Add message line + timestamp margin
-		text_log_->AppendText(log[a].message);
-		text_log_->MarginSetText(line_no, wxDateTime(log[a].timestamp).FormatISOTime());
+		int line_no = text_log_->GetLineCount() - 1;
+		text_log_->AppendText(msg.message);
+		text_log_->MarginSetText(line_no, wxDateTime(msg.timestamp).FormatISOTime());
 		text_log_->MarginSetStyle(line_no, wxSTC_STYLE_LINENUMBER);
 
 		// Set line colour depending on message type
 		text_log_->StartStyling(text_log_->GetLineEndPosition(line_no) - text_log_->GetLineLength(line_no), 0);
-		switch (log[a].type)
+		switch (msg.type)
 		{
 		case log::MessageType::Error: text_log_->SetStyling(text_log_->GetLineLength(line_no), 200); break;
 		case log::MessageType::Warning: text_log_->SetStyling(text_log_->GetLineLength(line_no), 201); break;
@@ -157,12 +158,8 @@ void ConsolePanel::update()
 		case log::MessageType::Debug: text_log_->SetStyling(text_log_->GetLineLength(line_no), 203); break;
 		default: break;
 		}
-
-		++line_no;
 	}
 	text_log_->SetEditable(false);
-
-	next_message_index_ = log::history().size();
 	text_log_->ScrollToEnd();
 
 	// Check again in 100ms
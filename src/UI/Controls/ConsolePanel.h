@@ -17,7 +17,7 @@ private:
 	wxTextCtrl*       text_command_  = nullptr;
 	int               cmd_log_index_ = 0;
 	wxTimer           timer_update_;
-	unsigned          next_message_index_ = 0;
+	size_t            next_message_index_ = 0;
 
 	// Events
 	void onCommandEnter(wxCommandEvent& e);
@@ -33,8 +33,10 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "HexEditorPanel.h"
+#include "Archive/EntryDataReader.h"
 #include "UI/WxUtils.h"
 #include "Utility/CodePages.h"
+#include "Utility/StringUtils.h"
 
 using namespace slade;
 
@@ -45,6 +47,11 @@ using namespace slade;
 //
 // -----------------------------------------------------------------------------
 CVAR(Int, hex_grid_width, 16, CVar::Flag::Save)
+namespace
+{
+constexpr unsigned HEX_PAGE_SIZE   = 1 << 16; // Size of the cached page of data read for displayed cells
+constexpr unsigned FIND_CHUNK_SIZE = 1 << 20; // Size of the chunks of data searched at once
+} // namespace
 
 
 // -----------------------------------------------------------------------------
@@ -54,12 +61,25 @@ CVAR(Int, hex_grid_width, 16, CVar::Flag::Save)
 // -----------------------------------------------------------------------------
 
 
+// -----------------------------------------------------------------------------
+// HexTable class destructor
+// -----------------------------------------------------------------------------
+HexTable::~HexTable() = default;
+
+// -----------------------------------------------------------------------------
+// Returns the size of the loaded data
+// -----------------------------------------------------------------------------
+unsigned HexTable::size() const
+{
+	return reader_ ? reader_->size() : 0;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the number of rows in the grid
 // -----------------------------------------------------------------------------
 int HexTable::GetNumberRows()
 {
-	return (data_.size() / hex_grid_width) + 1;
+	return (size() / hex_grid_width) + 1;
 }
 
 // -----------------------------------------------------------------------------
@@ -75,11 +95,11 @@ int HexTable::GetNumberCols()
 // -----------------------------------------------------------------------------
 wxString HexTable::GetValue(int row, int col)
 {
-	if (unsigned(row * hex_grid_width + col) >= data_.size())
+	if (unsigned(row * hex_grid_width + col) >= size())
 		return "";
 	else
 	{
-		uint8_t val = data_[row * hex_grid_width + col];
+		uint8_t val = uByteValue(row * hex_grid_width + col);
 
 		// Hex
 		if (view_type_ == 0)
@@ -107,11 +127,35 @@ void HexTable::SetValue(int row, int col, const wxString& value)
 }
 
 // -----------------------------------------------------------------------------
-// Loads in data from [mc]. Returns true on success, false otherwise
+// Loads in data from [mc]. The data is shared with [mc] rather than copied
+// (or read directly from the file if [mc] is a memory-mapped file view).
+// Returns true on success, false otherwise
 // -----------------------------------------------------------------------------
 bool HexTable::loadData(MemChunk& mc)
 {
-	data_.importMem(mc.data(), mc.size());
+	if (mc.isMapped())
+	{
+		data_.clear();
+		return loadData(std::make_unique<MemDataReader>(mc));
+	}
+
+	data_.importShared(mc);
+	return loadData(std::make_unique<MemDataReader>(data_));
+}
+
+// -----------------------------------------------------------------------------
+// Loads in data to be read from [reader] as needed.
+// Returns true on success, false otherwise
+// -----------------------------------------------------------------------------
+bool HexTable::loadData(unique_ptr<EntryDataReader> reader)
+{
+	if (!reader)
+		return false;
+
+	reader_ = std::move(reader);
+	page_.clear();
+	page_offset_ = 0;
+
 	return true;
 }
 
@@ -123,15 +167,92 @@ uint32_t HexTable::offset(int row, int col) const
 	return row * hex_grid_width + col;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the offset of the first occurrence of [bytes] in the data from
+// [from] onwards, or -1 if it wasn't found. The data is searched in chunks
+// directly from the reader, bypassing the page cache
+// -----------------------------------------------------------------------------
+int64_t HexTable::find(const vector<uint8_t>& bytes, uint32_t from) const
+{
+	auto n = bytes.size();
+	if (n == 0 || n > FIND_CHUNK_SIZE || !reader_)
+		return -1;
+
+	vector<uint8_t> buffer;
+	while (from + n <= size())
+	{
+		auto count = std::min(FIND_CHUNK_SIZE, size() - from);
+		buffer.resize(count);
+		if (!reader_->seekFromStart(from) || !reader_->read(buffer.data(), count))
+			return -1;
+
+		// Find first byte with memchr, then check the rest
+		auto data = buffer.data();
+		auto end  = data + count - n + 1;
+		for (auto pos = data; pos < end; ++pos)
+		{
+			pos = static_cast<uint8_t*>(memchr(pos, bytes[0], end - pos));
+			if (!pos)
+				break;
+			if (memcmp(pos + 1, bytes.data() + 1, n - 1) == 0)
+				return from + (pos - data);
+		}
+
+		// Next chunk (overlapping so matches across chunks are found)
+		if (from + count >= size())
+			break;
+		from += count - (n - 1);
+	}
+
+	return -1;
+}
+
+// -----------------------------------------------------------------------------
+// Reads [count] bytes at [offset] into [buffer], via the cached page of data.
+// Returns false if the data couldn't be read
+// -----------------------------------------------------------------------------
+bool HexTable::readData(uint32_t offset, void* buffer, unsigned count) const
+{
+	if (!reader_ || count > HEX_PAGE_SIZE || offset + count > size())
+		return false;
+
+	// Read the page containing the data if it isn't cached (starting at
+	// [offset] if the data goes past the end of the page)
+	if (offset < page_offset_ || offset + count > page_offset_ + page_.size())
+	{
+		auto page_offset = offset - offset % HEX_PAGE_SIZE;
+		if (offset + count > page_offset + HEX_PAGE_SIZE)
+			page_offset = offset;
+
+		page_.resize(std::min(HEX_PAGE_SIZE, size() - page_offset));
+		page_offset_ = page_offset;
+		if (!reader_->seekFromStart(page_offset) || !reader_->read(page_.data(), page_.size()))
+		{
+			page_.clear();
+			return false;
+		}
+	}
+
+	memcpy(buffer, page_.data() + (offset - page_offset_), count);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the value of type T at [offset], or 0 if it is out of bounds
+// -----------------------------------------------------------------------------
+template<typename T> T HexTable::value(uint32_t offset) const
+{
+	T val = 0;
+	readData(offset, &val, sizeof(T));
+	return val;
+}
+
 // -----------------------------------------------------------------------------
 // Returns the value at [offset] as an unsigned byte
 // -----------------------------------------------------------------------------
 uint8_t HexTable::uByteValue(uint32_t offset) const
 {
-	if (offset < data_.size())
-		return data_[offset];
-	else
-		return 0;
+	return value<uint8_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -139,10 +260,7 @@ uint8_t HexTable::uByteValue(uint32_t offset) const
 // -----------------------------------------------------------------------------
 uint16_t HexTable::uShortValue(uint32_t offset)
 {
-	uint16_t val = 0;
-	if (offset < data_.size() - 1)
-		memcpy(&val, data_.data() + offset, 2);
-	return val;
+	return value<uint16_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -150,10 +268,7 @@ uint16_t HexTable::uShortValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 uint32_t HexTable::uInt32Value(uint32_t offset)
 {
-	uint32_t val = 0;
-	if (offset < data_.size() - 3)
-		memcpy(&val, data_.data() + offset, 4);
-	return val;
+	return value<uint32_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -161,10 +276,7 @@ uint32_t HexTable::uInt32Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 uint64_t HexTable::uInt64Value(uint32_t offset)
 {
-	uint64_t val = 0;
-	if (offset < data_.size() - 7)
-		memcpy(&val, data_.data() + offset, 8);
-	return val;
+	return value<uint64_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -172,10 +284,7 @@ uint64_t HexTable::uInt64Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 int8_t HexTable::byteValue(uint32_t offset)
 {
-	int8_t val = 0;
-	if (offset < data_.size())
-		val = *(data_.data() + offset);
-	return val;
+	return value<int8_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -183,10 +292,7 @@ int8_t HexTable::byteValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 int16_t HexTable::shortValue(uint32_t offset)
 {
-	int16_t val = 0;
-	if (offset < data_.size() - 1)
-		memcpy(&val, data_.data() + offset, 2);
-	return val;
+	return value<int16_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -194,10 +300,7 @@ int16_t HexTable::shortValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 int32_t HexTable::int32Value(uint32_t offset)
 {
-	int32_t val = 0;
-	if (offset < data_.size() - 3)
-		memcpy(&val, data_.data() + offset, 4);
-	return val;
+	return value<int32_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -205,10 +308,7 @@ int32_t HexTable::int32Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 int64_t HexTable::int64Value(uint32_t offset)
 {
-	int64_t val = 0;
-	if (offset < data_.size() - 7)
-		memcpy(&val, data_.data() + offset, 8);
-	return val;
+	return value<int64_t>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -216,10 +316,7 @@ int64_t HexTable::int64Value(uint32_t offset)
 // -----------------------------------------------------------------------------
 float HexTable::floatValue(uint32_t offset)
 {
-	float val = 0;
-	if (offset < data_.size() - 3)
-		val = *(data_.data() + offset);
-	return val;
+	return value<float>(offset);
 }
 
 // -----------------------------------------------------------------------------
@@ -227,10 +324,7 @@ float HexTable::floatValue(uint32_t offset)
 // -----------------------------------------------------------------------------
 double HexTable::doubleValue(uint32_t offset)
 {
-	double val = 0;
-	if (offset < data_.size() - 7)
-		val = *(data_.data() + offset);
-	return val;
+	return value<double>(offset);
 }
 
 
@@ -265,6 +359,7 @@ HexEditorPanel::HexEditorPanel(wxWindow* parent) : wxPanel(parent, -1)
 	label_int32_be_   = new wxStaticText(this, -1, "Signed Integer (32bit):");
 	label_uint32_be_  = new wxStaticText(this, -1, "Unsigned Integer (32bit):");
 	btn_go_to_offset_ = new wxButton(this, -1, "Go to Offset...");
+	btn_find_         = new wxButton(this, -1, "Find...");
 
 	// Setup hex grid
 	auto cellsize      = ui::scalePx(28);
@@ -284,6 +379,7 @@ HexEditorPanel::HexEditorPanel(wxWindow* parent) : wxPanel(parent, -1)
 	// Bind events
 	grid_hex_->Bind(wxEVT_GRID_SELECT_CELL, &HexEditorPanel::onCellSelected, this);
 	btn_go_to_offset_->Bind(wxEVT_BUTTON, &HexEditorPanel::onBtnGoToOffset, this);
+	btn_find_->Bind(wxEVT_BUTTON, &HexEditorPanel::onBtnFind, this);
 	rb_view_hex_->Bind(wxEVT_RADIOBUTTON, &HexEditorPanel::onRBViewType, this);
 	rb_view_dec_->Bind(wxEVT_RADIOBUTTON, &HexEditorPanel::onRBViewType, this);
 	rb_view_ascii_->Bind(wxEVT_RADIOBUTTON, &HexEditorPanel::onRBViewType, this);
@@ -299,15 +395,37 @@ bool HexEditorPanel::loadData(MemChunk& mc)
 {
 	if (table_hex_->loadData(mc))
 	{
-		grid_hex_->SetTable(table_hex_);
-		Layout();
-		grid_hex_->Refresh();
+		dataLoaded();
+		return true;
+	}
+	else
+		return false;
+}
+
+// -----------------------------------------------------------------------------
+// Loads data to be read from [reader] (as needed) into the hex grid
+// -----------------------------------------------------------------------------
+bool HexEditorPanel::loadData(unique_ptr<EntryDataReader> reader)
+{
+	if (table_hex_->loadData(std::move(reader)))
+	{
+		dataLoaded();
 		return true;
 	}
 	else
 		return false;
 }
 
+// -----------------------------------------------------------------------------
+// Updates the hex grid after new data has been loaded into the table
+// -----------------------------------------------------------------------------
+void HexEditorPanel::dataLoaded()
+{
+	grid_hex_->SetTable(table_hex_);
+	Layout();
+	grid_hex_->Refresh();
+}
+
 // -----------------------------------------------------------------------------
 // Lays out the controls on the panel
 // -----------------------------------------------------------------------------
@@ -359,8 +477,9 @@ void HexEditorPanel::setupLayout()
 		wxSizerFlags(1).Expand().Border(wxALL, ui::pad()));
 	vbox->Add(framesizer, 0, wxEXPAND | wxBOTTOM, ui::pad());
 
-	// 'Go to Offset' button
-	vbox->Add(btn_go_to_offset_, 0, wxBOTTOM, ui::pad());
+	// 'Go to Offset' and 'Find' buttons
+	wxutil::layoutHorizontally(
+		vbox, vector<wxObject*>{ btn_go_to_offset_, btn_find_ }, wxSizerFlags(0).Border(wxBOTTOM, ui::pad()));
 }
 
 
@@ -383,7 +502,7 @@ void HexEditorPanel::onCellSelected(wxGridEvent& e)
 	uint32_t offset = table_hex_->offset(e.GetRow(), e.GetCol());
 
 	// Check offset
-	if (offset > table_hex_->getData().size())
+	if (offset > table_hex_->size())
 		return;
 
 	// Reset labels
@@ -409,7 +528,7 @@ void HexEditorPanel::onCellSelected(wxGridEvent& e)
 	// label_double_be->SetLabel("Double:");
 
 	// Get values
-	uint32_t size    = table_hex_->getData().size() - offset;
+	uint32_t size    = table_hex_->size() - offset;
 	int8_t   vbyte   = 0;
 	uint8_t  vubyte  = 0;
 	int16_t  vshort  = 0;
@@ -480,11 +599,11 @@ void HexEditorPanel::onCellSelected(wxGridEvent& e)
 void HexEditorPanel::onBtnGoToOffset(wxCommandEvent& e)
 {
 	// Do nothing if no data
-	if (table_hex_->getData().size() == 0)
+	if (table_hex_->size() == 0)
 		return;
 
 	// Pop up dialog to prompt user for an offset
-	int ofs = wxGetNumberFromUser("Enter Offset", "Offset", "Go to Offset", 0, 0, table_hex_->getData().size() - 1);
+	int ofs = wxGetNumberFromUser("Enter Offset", "Offset", "Go to Offset", 0, 0, table_hex_->size() - 1);
 	if (ofs >= 0)
 	{
 		// Determine row/col of offset
@@ -497,6 +616,63 @@ void HexEditorPanel::onBtnGoToOffset(wxCommandEvent& e)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Called when the 'Find' button is clicked
+// -----------------------------------------------------------------------------
+void HexEditorPanel::onBtnFind(wxCommandEvent& e)
+{
+	// Do nothing if no data
+	if (table_hex_->size() == 0)
+		return;
+
+	// Prompt for the bytes to find, as text in ASCII view or hex otherwise
+	bool ascii  = table_hex_->viewType() == 2;
+	auto prompt = ascii ? "Enter text to find" : "Enter bytes to find in hex (eg. \"FF 00 7A\")";
+	auto find   = wxGetTextFromUser(prompt, "Find", last_find_, this).ToStdString();
+	if (find.empty())
+		return;
+	last_find_ = find;
+
+	vector<uint8_t> bytes;
+	if (ascii)
+		bytes.assign(find.begin(), find.end());
+	else
+	{
+		strutil::replaceIP(find, " ", "");
+		for (unsigned a = 0; a + 1 < find.size(); a += 2)
+		{
+			if (!isxdigit(find[a]) || !isxdigit(find[a + 1]))
+			{
+				bytes.clear();
+				break;
+			}
+			bytes.push_back(static_cast<uint8_t>(std::stoi(find.substr(a, 2), nullptr, 16)));
+		}
+
+		if (bytes.empty() || find.size() % 2 != 0)
+		{
+			wxMessageBox("Invalid hex value, enter bytes as pairs of hex digits", "Find", wxICON_ERROR, this);
+			return;
+		}
+	}
+
+	// Search from after the current cell, wrapping around to the start
+	wxBusyCursor busy;
+	auto         from  = table_hex_->offset(grid_hex_->GetGridCursorRow(), grid_hex_->GetGridCursorCol()) + 1;
+	auto         found = table_hex_->find(bytes, from);
+	if (found < 0)
+		found = table_hex_->find(bytes, 0);
+	if (found < 0)
+	{
+		wxMessageBox("No matches found", "Find", wxICON_INFORMATION, this);
+		return;
+	}
+
+	// Go to the match
+	grid_hex_->GoToCell(found / hex_grid_width, found % hex_grid_width);
+	grid_hex_->SetFocus();
+}
+
 // -----------------------------------------------------------------------------
 // Called when one of the 'View As' radio buttons is selected
 // -----------------------------------------------------------------------------
@@ -2,13 +2,18 @@
 
 namespace slade
 {
+class EntryDataReader;
+
+// Grid table for the hex view. Values are only read from the data (via a
+// reader, so the data doesn't need to be in memory) for the cells that are
+// displayed, with the most recently read page of data cached
 class HexTable : public wxGridTableBase
 {
 public:
-	HexTable()  = default;
-	~HexTable() = default;
+	HexTable() = default;
+	~HexTable() override;
 
-	MemChunk& getData() { return data_; }
+	unsigned size() const;
 
 	// Overrides
 	int      GetNumberRows() override;
@@ -17,8 +22,11 @@ public:
 	void     SetValue(int row, int col, const wxString& value) override;
 
 	bool     loadData(MemChunk& mc);
+	bool     loadData(unique_ptr<EntryDataReader> reader);
 	uint32_t offset(int row, int col) const;
 	void     setViewType(int type) { view_type_ = type; }
+	int      viewType() const { return view_type_; }
+	int64_t  find(const vector<uint8_t>& bytes, uint32_t from) const;
 
 	// Get values
 	uint8_t  uByteValue(uint32_t offset) const;
@@ -33,8 +41,14 @@ public:
 	double   doubleValue(uint32_t offset);
 
 private:
-	MemChunk data_;
-	int      view_type_ = 0;
+	MemChunk                    data_; // Shared (copy-on-write) with the loaded data, if it was in memory
+	unique_ptr<EntryDataReader> reader_;
+	mutable vector<uint8_t>     page_;
+	mutable uint32_t            page_offset_ = 0;
+	int                         view_type_   = 0;
+
+	bool readData(uint32_t offset, void* buffer, unsigned count) const;
+	template<typename T> T value(uint32_t offset) const;
 };
 
 class HexEditorPanel : public wxPanel
@@ -44,11 +58,13 @@ public:
 	~HexEditorPanel() = default;
 
 	bool loadData(MemChunk& mc);
+	bool loadData(unique_ptr<EntryDataReader> reader);
 
 private:
 	wxGrid*        grid_hex_         = nullptr;
 	HexTable*      table_hex_        = nullptr;
 	wxButton*      btn_go_to_offset_ = nullptr;
+	wxButton*      btn_find_         = nullptr;
 	wxRadioButton* rb_view_hex_      = nullptr;
 	wxRadioButton* rb_view_dec_      = nullptr;
 	wxRadioButton* rb_view_ascii_    = nullptr;
@@ -75,11 +91,15 @@ private:
 	wxStaticText* label_float_be_  = nullptr;
 	wxStaticText* label_double_be_ = nullptr;
 
+	string last_find_;
+
 	void setupLayout();
+	void dataLoaded();
 
 	// Events
 	void onCellSelected(wxGridEvent& e);
 	void onBtnGoToOffset(wxCommandEvent& e);
+	void onBtnFind(wxCommandEvent& e);
 	void onRBViewType(wxCommandEvent& e);
 };
 } // namespace slade
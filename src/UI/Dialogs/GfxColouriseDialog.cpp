@@ -90,9 +90,7 @@ GfxColouriseDialog::GfxColouriseDialog(wxWindow* parent, ArchiveEntry* entry, co
 	gfx_preview_->setPalette(&palette_);
 	gfx_preview_->SetInitialSize(wxSize(192, 192));
 	misc::loadImageFromEntry(&gfx_preview_->image(), entry);
-	auto col = cb_colour_->colour();
-	gfx_preview_->image().colourise(col, &palette_);
-	gfx_preview_->updateImageTexture();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Colourise, cb_colour_->colour());
 
 	// Init layout
 	wxWindowBase::Layout();
@@ -122,9 +120,7 @@ void GfxColouriseDialog::setColour(const wxString& col)
 {
 	auto rgba = ColRGBA(wxColour(col));
 	cb_colour_->setColour(rgba);
-	gfx_preview_->image().colourise(rgba, &palette_);
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Colourise, rgba);
 }
 
 
@@ -140,10 +136,7 @@ void GfxColouriseDialog::setColour(const wxString& col)
 // -----------------------------------------------------------------------------
 void GfxColouriseDialog::onColourChanged(wxEvent& e)
 {
-	misc::loadImageFromEntry(&gfx_preview_->image(), entry_);
-	gfx_preview_->image().colourise(cb_colour_->colour(), &palette_);
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Colourise, cb_colour_->colour());
 }
 
 // -----------------------------------------------------------------------------
@@ -36,6 +36,7 @@
 #include "General/Misc.h"
 #include "General/UI.h"
 #include "Graphics/CTexture/CTexture.h"
+#include "Graphics/GfxConvert.h"
 #include "Graphics/Icons.h"
 #include "Graphics/Palette/PaletteManager.h"
 #include "Graphics/SImage/SIFormat.h"
@@ -102,29 +103,8 @@ bool GfxConvDialog::nextItem()
 	}
 
 	// Load image if needed
-	if (!items_[current_item_].image.isValid())
-	{
-		// If loading images from entries
-		if (items_[current_item_].entry != nullptr)
-		{
-			if (!misc::loadImageFromEntry(&(items_[current_item_].image), items_[current_item_].entry))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		// If loading images from textures
-		else if (items_[current_item_].texture != nullptr)
-		{
-			if (items_[current_item_].force_rgba)
-				items_[current_item_].image.convertRGBA(items_[current_item_].palette);
-			if (!items_[current_item_].texture->toImage(
-					items_[current_item_].image,
-					items_[current_item_].archive,
-					items_[current_item_].palette,
-					items_[current_item_].force_rgba))
-				return nextItem(); // Skip if not a valid image entry
-		}
-		else
-			return nextItem(); // Skip if not a valid image entry
-	}
+	if (!loadItemImage(items_[current_item_]))
+		return nextItem(); // Skip if not a valid image entry
 
 	// Update valid formats
 	combo_target_format_->Clear();
@@ -370,6 +350,30 @@ void GfxConvDialog::setupLayout()
 	SetMinClientSize(msizer->GetMinSize());
 }
 
+// -----------------------------------------------------------------------------
+// Loads the image for [item] from its entry or texture, if it isn't already
+// loaded. Returns false if the image couldn't be loaded
+// -----------------------------------------------------------------------------
+bool GfxConvDialog::loadItemImage(ConvItem& item) const
+{
+	if (item.image.isValid())
+		return true;
+
+	// If loading images from entries
+	if (item.entry != nullptr)
+		return misc::loadImageFromEntry(&item.image, item.entry);
+
+	// If loading images from textures
+	if (item.texture != nullptr)
+	{
+		if (item.force_rgba)
+			item.image.convertRGBA(item.palette);
+		return item.texture->toImage(item.image, item.archive, item.palette, item.force_rgba);
+	}
+
+	return false;
+}
+
 // -----------------------------------------------------------------------------
 // Opens an image entry to be converted
 // -----------------------------------------------------------------------------
@@ -627,16 +631,47 @@ void GfxConvDialog::onBtnConvertAll(wxCommandEvent& e)
 	// Show splash window
 	ui::showSplash("Converting Gfx...", true);
 
-	// Convert all images
-	for (size_t a = current_item_; a < items_.size(); a++)
+	// Convert the current image as previewed
+	applyConversion();
+
+	// Convert the remaining images with the same options. Entry images are
+	// loaded as part of the conversion (across worker threads), textures have
+	// to be built here first
+	SIFormat::ConvertOptions opt;
+	convertOptions(opt);
+	vector<gfx::ConvertItem> conv_items(items_.size() - current_item_ - 1);
+	for (size_t a = 0; a < conv_items.size(); a++)
+	{
+		auto& item            = items_[current_item_ + a + 1];
+		auto& conv_item       = conv_items[a];
+		conv_item.pal_current = pal_chooser_current_->selectedPalette(item.entry);
+		conv_item.pal_target  = pal_chooser_target_->selectedPalette(item.entry);
+
+		if (item.entry && !item.image.isValid())
+			conv_item.entry = item.entry;
+		else if (loadItemImage(item))
+			conv_item.image.copyImage(&item.image);
+	}
+	gfx::convertImages(conv_items, current_format_.format, opt);
+
+	// Update items
+	for (size_t a = 0; a < conv_items.size(); a++)
 	{
-		applyConversion();
-		if (!nextItem())
-			break;
+		auto& conv_item = conv_items[a];
+		if (!conv_item.converted)
+			continue;
+
+		auto& item = items_[current_item_ + a + 1];
+		item.image.copyImage(&conv_item.image);
+		item.modified   = true;
+		item.new_format = conv_item.format;
+		item.palette    = conv_item.pal_target;
 	}
 
 	// Hide splash window
 	ui::hideSplash();
+
+	Close(true);
 }
 
 // -----------------------------------------------------------------------------
@@ -123,6 +123,7 @@ private:
 	Palette target_pal_;
 	ColRGBA colour_trans_;
 
+	bool loadItemImage(ConvItem& item) const;
 	bool nextItem();
 
 	// Static
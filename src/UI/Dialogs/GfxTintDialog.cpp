@@ -100,8 +100,7 @@ GfxTintDialog::GfxTintDialog(wxWindow* parent, ArchiveEntry* entry, const Palett
 	gfx_preview_->setPalette(&palette_);
 	gfx_preview_->SetInitialSize(wxSize(256, 256));
 	misc::loadImageFromEntry(&gfx_preview_->image(), entry);
-	gfx_preview_->image().tint(colour(), amount(), &palette_);
-	gfx_preview_->updateImageTexture();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Tint, colour(), amount());
 
 	// Init layout
 	wxWindowBase::Layout();
@@ -144,9 +143,7 @@ void GfxTintDialog::setValues(const wxString& col, int val)
 	cb_colour_->setColour(ColRGBA(wxColour(col)));
 	slider_amount_->SetValue(val);
 	label_amount_->SetLabel(wxString::Format("%d%% ", slider_amount_->GetValue()));
-	gfx_preview_->image().tint(colour(), amount(), &palette_);
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Tint, colour(), amount());
 }
 
 
@@ -162,10 +159,7 @@ void GfxTintDialog::setValues(const wxString& col, int val)
 // -----------------------------------------------------------------------------
 void GfxTintDialog::onColourChanged(wxEvent& e)
 {
-	misc::loadImageFromEntry(&gfx_preview_->image(), entry_);
-	gfx_preview_->image().tint(colour(), amount(), &palette_);
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Tint, colour(), amount());
 }
 
 // -----------------------------------------------------------------------------
@@ -173,10 +167,7 @@ void GfxTintDialog::onColourChanged(wxEvent& e)
 // -----------------------------------------------------------------------------
 void GfxTintDialog::onAmountChanged(wxCommandEvent& e)
 {
-	misc::loadImageFromEntry(&gfx_preview_->image(), entry_);
-	gfx_preview_->image().tint(colour(), amount(), &palette_);
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	gfx_preview_->setPreviewEffect(GfxCanvas::Effect::Tint, colour(), amount());
 	label_amount_->SetLabel(wxString::Format("%d%% ", slider_amount_->GetValue()));
 }
 
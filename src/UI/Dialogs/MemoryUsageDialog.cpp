@@ -0,0 +1,131 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MemoryUsageDialog.cpp
+// Description: Dialog showing the (estimated) memory used by each subsystem,
+//              see MemoryStats.cpp
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MemoryUsageDialog.h"
+#include "General/UI.h"
+#include "UI/Lists/ListView.h"
+#include "Utility/MemoryStats.h"
+#include "Utility/SFileDialog.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// MemoryUsageDialog Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// MemoryUsageDialog class constructor
+// -----------------------------------------------------------------------------
+MemoryUsageDialog::MemoryUsageDialog(wxWindow* parent) : SDialog(parent, "Memory Usage", "memoryusage", 600, 500)
+{
+	// Setup sizer
+	auto sizer = new wxBoxSizer(wxVERTICAL);
+	SetSizer(sizer);
+
+	// Usage list
+	list_usage_ = new ListView(this, -1);
+	list_usage_->showIcons(false);
+	list_usage_->AppendColumn("Subsystem");
+	list_usage_->AppendColumn("Name");
+	list_usage_->AppendColumn("Count", wxLIST_FORMAT_RIGHT);
+	list_usage_->AppendColumn("Size", wxLIST_FORMAT_RIGHT);
+	sizer->Add(list_usage_, 1, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, ui::padLarge());
+	label_total_ = new wxStaticText(this, -1, "");
+	sizer->Add(label_total_, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, ui::padLarge());
+
+	// Dialog buttons
+	btn_refresh_ = new wxButton(this, -1, "Refresh");
+	btn_export_  = new wxButton(this, -1, "Export CSV...");
+	btn_close_   = new wxButton(this, wxID_CANCEL, "Close");
+	auto hbox    = new wxBoxSizer(wxHORIZONTAL);
+	hbox->Add(btn_refresh_, 0, wxEXPAND | wxRIGHT, ui::pad());
+	hbox->Add(btn_export_, 0, wxEXPAND);
+	hbox->AddStretchSpacer();
+	hbox->Add(btn_close_, 0, wxEXPAND);
+	sizer->AddSpacer(ui::pad());
+	sizer->Add(hbox, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, ui::padLarge());
+
+	// Bind events
+	btn_refresh_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { refresh(); });
+	btn_export_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { exportCSV(); });
+	btn_close_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { Show(false); });
+
+	// Setup dialog layout
+	wxWindowBase::Layout();
+	CenterOnParent();
+
+	refresh();
+}
+
+// -----------------------------------------------------------------------------
+// Refreshes the list with the current memory usage of all subsystems
+// -----------------------------------------------------------------------------
+void MemoryUsageDialog::refresh()
+{
+	auto usage = memstats::usage();
+
+	list_usage_->enableSizeUpdate(false);
+	list_usage_->DeleteAllItems();
+	for (const auto& item : usage)
+	{
+		wxArrayString text;
+		text.Add(wxString::FromUTF8(item.subsystem));
+		text.Add(wxString::FromUTF8(item.name));
+		text.Add(item.count > 0 ? wxString::Format("%u", item.count) : wxString{});
+		text.Add(memstats::sizeString(item.bytes) + (item.vram ? " (VRAM)" : ""));
+		list_usage_->addItem(list_usage_->GetItemCount(), text);
+	}
+	list_usage_->enableSizeUpdate(true);
+	list_usage_->updateSize();
+
+	label_total_->SetLabel(wxString::Format(
+		"Total: %s memory, %s video memory (estimated)",
+		memstats::sizeString(memstats::total(usage)),
+		memstats::sizeString(memstats::total(usage, true))));
+}
+
+// -----------------------------------------------------------------------------
+// Prompts for a file and appends the current memory usage to it as CSV
+// -----------------------------------------------------------------------------
+void MemoryUsageDialog::exportCSV()
+{
+	filedialog::FDInfo info;
+	if (!filedialog::saveFile(info, "Export Memory Usage", "CSV Files (*.csv)|*.csv", this, "memory_usage.csv"))
+		return;
+
+	if (!memstats::writeCSV(memstats::usage(), info.filenames[0]))
+		wxMessageBox(wxString::FromUTF8(global::error), "Export Failed", wxICON_ERROR, this);
+}
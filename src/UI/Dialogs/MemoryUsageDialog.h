@@ -0,0 +1,26 @@
+#pragma once
+
+#include "UI/SDialog.h"
+
+namespace slade
+{
+class ListView;
+
+class MemoryUsageDialog : public SDialog
+{
+public:
+	MemoryUsageDialog(wxWindow* parent);
+	~MemoryUsageDialog() = default;
+
+	void refresh();
+
+private:
+	ListView*     list_usage_  = nullptr;
+	wxStaticText* label_total_ = nullptr;
+	wxButton*     btn_refresh_ = nullptr;
+	wxButton*     btn_export_  = nullptr;
+	wxButton*     btn_close_   = nullptr;
+
+	void exportCSV();
+};
+} // namespace slade
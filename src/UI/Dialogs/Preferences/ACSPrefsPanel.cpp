@@ -47,6 +47,7 @@ using namespace slade;
 EXTERN_CVAR(String, path_acc)
 EXTERN_CVAR(String, path_acc_libs)
 EXTERN_CVAR(Bool, acc_always_show_output)
+EXTERN_CVAR(Bool, acc_cache_output)
 
 
 // -----------------------------------------------------------------------------
@@ -73,6 +74,7 @@ ACSPrefsPanel::ACSPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 	btn_incpath_add_       = new wxButton(this, -1, "Add");
 	btn_incpath_remove_    = new wxButton(this, -1, "Remove");
 	cb_always_show_output_ = new wxCheckBox(this, -1, "Always Show Compiler Output");
+	cb_cache_output_       = new wxCheckBox(this, -1, "Reuse Compiled Output for Unchanged Scripts");
 
 	setupLayout();
 
@@ -88,6 +90,7 @@ void ACSPrefsPanel::init()
 {
 	flp_acc_path_->setLocation(path_acc);
 	cb_always_show_output_->SetValue(acc_always_show_output);
+	cb_cache_output_->SetValue(acc_cache_output);
 
 	// Populate include paths list
 	list_inc_paths_->Set(wxSplit(path_acc_libs, ';'));
@@ -110,6 +113,7 @@ void ACSPrefsPanel::applyPreferences()
 
 	path_acc_libs          = wxutil::strToView(paths_string);
 	acc_always_show_output = cb_always_show_output_->GetValue();
+	acc_cache_output       = cb_cache_output_->GetValue();
 }
 
 // -----------------------------------------------------------------------------
@@ -140,7 +144,10 @@ void ACSPrefsPanel::setupLayout()
 	vbox->Add(btn_incpath_remove_, 0, wxEXPAND | wxBOTTOM, ui::pad());
 
 	// 'Always Show Output' checkbox
-	sizer->Add(cb_always_show_output_, 0, wxEXPAND);
+	sizer->Add(cb_always_show_output_, 0, wxEXPAND | wxBOTTOM, ui::pad());
+
+	// 'Cache Output' checkbox
+	sizer->Add(cb_cache_output_, 0, wxEXPAND);
 }
 
 
@@ -25,6 +25,7 @@ private:
 	wxButton*          btn_incpath_remove_    = nullptr;
 	wxListBox*         list_inc_paths_        = nullptr;
 	wxCheckBox*        cb_always_show_output_ = nullptr;
+	wxCheckBox*        cb_cache_output_       = nullptr;
 
 	void setupLayout();
 
@@ -43,6 +43,8 @@ using namespace slade;
 // -----------------------------------------------------------------------------
 EXTERN_CVAR(Bool, close_archive_with_tab)
 EXTERN_CVAR(Bool, archive_load_data)
+EXTERN_CVAR(Bool, archive_map_files)
+EXTERN_CVAR(Bool, archive_type_cache)
 EXTERN_CVAR(Bool, auto_open_wads_root)
 EXTERN_CVAR(Bool, update_check)
 EXTERN_CVAR(Bool, update_check_beta)
@@ -65,6 +67,8 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 	// Create + Layout controls
 	SetSizer(wxutil::layoutVertically(
 		{ cb_archive_load_      = new wxCheckBox(this, -1, "Load all archive entry data to memory when opened"),
+		  cb_archive_map_       = new wxCheckBox(this, -1, "Memory-map archive files when opened"),
+		  cb_type_cache_        = new wxCheckBox(this, -1, "Cache detected entry types for unchanged archive files"),
 		  cb_archive_close_tab_ = new wxCheckBox(this, -1, "Close archive when its tab is closed"),
 		  cb_wads_root_         = new wxCheckBox(this, -1, "Auto open nested wad archives"),
 #ifdef __WXMSW__
@@ -74,6 +78,12 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 		  cb_confirm_exit_    = new wxCheckBox(this, -1, "Show confirmation dialog on exit"),
 		  cb_backup_archives_ = new wxCheckBox(this, -1, "Back up archives") }));
 
+	cb_archive_map_->SetToolTip(
+		"Where supported (wad, dat, grp, pak), unmodified entry data is read directly from the archive file "
+		"instead of being copied into memory");
+	cb_type_cache_->SetToolTip(
+		"Re-use the entry types detected the last time an archive file was opened, for any entries that haven't "
+		"changed since");
 	cb_wads_root_->SetToolTip(
 		"When opening a zip or folder archive, automatically open all wad entries in the root directory");
 }
@@ -84,6 +94,8 @@ GeneralPrefsPanel::GeneralPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 void GeneralPrefsPanel::init()
 {
 	cb_archive_load_->SetValue(archive_load_data);
+	cb_archive_map_->SetValue(archive_map_files);
+	cb_type_cache_->SetValue(archive_type_cache);
 	cb_archive_close_tab_->SetValue(close_archive_with_tab);
 	cb_wads_root_->SetValue(auto_open_wads_root);
 #ifdef __WXMSW__
@@ -100,6 +112,8 @@ void GeneralPrefsPanel::init()
 void GeneralPrefsPanel::applyPreferences()
 {
 	archive_load_data      = cb_archive_load_->GetValue();
+	archive_map_files      = cb_archive_map_->GetValue();
+	archive_type_cache     = cb_type_cache_->GetValue();
 	close_archive_with_tab = cb_archive_close_tab_->GetValue();
 	auto_open_wads_root    = cb_wads_root_->GetValue();
 #ifdef __WXMSW__
@@ -16,6 +16,8 @@ public:
 private:
 	wxCheckBox* cb_gl_np2_            = nullptr;
 	wxCheckBox* cb_archive_load_      = nullptr;
+	wxCheckBox* cb_archive_map_       = nullptr;
+	wxCheckBox* cb_type_cache_        = nullptr;
 	wxCheckBox* cb_archive_close_tab_ = nullptr;
 	wxCheckBox* cb_wads_root_         = nullptr;
 	wxCheckBox* cb_update_check_      = nullptr;
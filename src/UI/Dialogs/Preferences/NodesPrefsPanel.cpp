@@ -127,7 +127,7 @@ void NodesPrefsPanel::populateOptions(const wxString& options) const
 {
 	// Get current builder
 	auto& builder = nodebuilders::builder(choice_nodebuilder_->GetSelection());
-	btn_browse_path_->Enable(builder.id != "none");
+	btn_browse_path_->Enable(builder.id != "none" && !builder.internal);
 
 	// Set builder path
 	text_path_->SetValue(builder.path);
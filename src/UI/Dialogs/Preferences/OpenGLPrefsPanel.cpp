@@ -31,7 +31,9 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "OpenGLPrefsPanel.h"
+#include "General/Misc.h"
 #include "OpenGL/Drawing.h"
+#include "OpenGL/GLTexture.h"
 #include "UI/Controls/NumberTextCtrl.h"
 #include "UI/WxUtils.h"
 
@@ -46,6 +48,7 @@ using namespace slade;
 EXTERN_CVAR(Bool, gl_tex_enable_np2)
 EXTERN_CVAR(Bool, gl_point_sprite)
 EXTERN_CVAR(Bool, gl_vbo)
+EXTERN_CVAR(Bool, gl_tex_compression)
 EXTERN_CVAR(Int, gl_font_size)
 
 
@@ -70,12 +73,17 @@ OpenGLPrefsPanel::OpenGLPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent), l
 		vector<wxObject*>{ cb_gl_np2_ = new wxCheckBox(this, -1, "Enable Non-power-of-two textures if supported"),
 						   cb_gl_point_sprite_ = new wxCheckBox(this, -1, "Enable point sprites if supported"),
 						   cb_gl_use_vbo_      = new wxCheckBox(this, -1, "Use Vertex Buffer Objects if supported"),
-						   wxutil::createLabelHBox(this, "Font Size:", ntc_font_size_ = new NumberTextCtrl(this)) },
+						   cb_gl_compression_  = new wxCheckBox(this, -1, "Compress map textures if supported"),
+						   wxutil::createLabelHBox(this, "Font Size:", ntc_font_size_ = new NumberTextCtrl(this)),
+						   label_tex_memory_ = new wxStaticText(this, -1, "") },
 		wxSizerFlags(0).Expand());
 
 	cb_gl_point_sprite_->SetToolTip(
 		"Only disable this if you are experiencing graphical glitches like things disappearing");
 	ntc_font_size_->SetToolTip("The size of the font to use in OpenGL, eg. for info overlays in the map editor");
+	cb_gl_compression_->SetToolTip(
+		"Uses much less video memory for large (eg. hi-res) texture sets, at a slight loss of quality. "
+		"Takes effect for textures loaded after changing this");
 }
 
 // -----------------------------------------------------------------------------
@@ -86,7 +94,17 @@ void OpenGLPrefsPanel::init()
 	cb_gl_np2_->SetValue(gl_tex_enable_np2);
 	cb_gl_point_sprite_->SetValue(gl_point_sprite);
 	cb_gl_use_vbo_->SetValue(gl_vbo);
+	cb_gl_compression_->SetValue(gl_tex_compression);
 	ntc_font_size_->setNumber(gl_font_size);
+
+	// Texture memory use
+	auto usage = gl::Texture::memoryUsage();
+	label_tex_memory_->SetLabel(fmt::format(
+		"Texture memory used: {} in {} textures ({} in {} compressed textures)",
+		misc::sizeAsString(usage.total),
+		usage.n_textures,
+		misc::sizeAsString(usage.compressed),
+		usage.n_compressed));
 }
 
 // -----------------------------------------------------------------------------
@@ -94,10 +112,11 @@ void OpenGLPrefsPanel::init()
 // -----------------------------------------------------------------------------
 void OpenGLPrefsPanel::applyPreferences()
 {
-	gl_tex_enable_np2 = cb_gl_np2_->GetValue();
-	gl_point_sprite   = cb_gl_point_sprite_->GetValue();
-	gl_vbo            = cb_gl_use_vbo_->GetValue();
-	gl_font_size      = ntc_font_size_->number();
+	gl_tex_enable_np2  = cb_gl_np2_->GetValue();
+	gl_point_sprite    = cb_gl_point_sprite_->GetValue();
+	gl_vbo             = cb_gl_use_vbo_->GetValue();
+	gl_tex_compression = cb_gl_compression_->GetValue();
+	gl_font_size       = ntc_font_size_->number();
 
 	if (gl_font_size != last_font_size_)
 		drawing::initFonts();
@@ -19,7 +19,9 @@ private:
 	wxCheckBox*     cb_gl_np2_          = nullptr;
 	wxCheckBox*     cb_gl_point_sprite_ = nullptr;
 	wxCheckBox*     cb_gl_use_vbo_      = nullptr;
+	wxCheckBox*     cb_gl_compression_  = nullptr;
 	NumberTextCtrl* ntc_font_size_      = nullptr;
+	wxStaticText*   label_tex_memory_   = nullptr;
 	int             last_font_size_     = 0;
 };
 } // namespace slade
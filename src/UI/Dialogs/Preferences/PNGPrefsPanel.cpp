@@ -45,6 +45,7 @@ using namespace slade;
 EXTERN_CVAR(String, path_pngout)
 EXTERN_CVAR(String, path_pngcrush)
 EXTERN_CVAR(String, path_deflopt)
+EXTERN_CVAR(Int, png_compression)
 CVAR(String, dir_last_pngtool, "", CVar::Flag::Save)
 
 
@@ -64,9 +65,15 @@ PNGPrefsPanel::PNGPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 	auto sizer = new wxBoxSizer(wxVERTICAL);
 	SetSizer(sizer);
 
+	choice_compression_ = new wxChoice(this, -1);
+	choice_compression_->Append(wxutil::arrayString({ "Fast", "Normal", "Best (slower)" }));
+	choice_compression_->SetToolTip(
+		"Compression effort used when saving PNG images. Use Optimize PNG on entries to recompress them further");
+
 	wxutil::layoutVertically(
 		sizer,
-		vector<wxObject*>{ wxutil::createLabelVBox(
+		vector<wxObject*>{ wxutil::createLabelHBox(this, "PNG compression when saving:", choice_compression_),
+						   wxutil::createLabelVBox(
 							   this,
 							   "Location of PNGout:",
 							   flp_pngout_ = new FileLocationPanel(
@@ -104,6 +111,7 @@ PNGPrefsPanel::PNGPrefsPanel(wxWindow* parent) : PrefsPanelBase(parent)
 // -----------------------------------------------------------------------------
 void PNGPrefsPanel::init()
 {
+	choice_compression_->SetSelection(std::clamp<int>(png_compression, 0, 2));
 	flp_pngout_->setLocation(path_pngout);
 	flp_pngcrush_->setLocation(path_pngcrush);
 	flp_deflopt_->setLocation(path_deflopt);
@@ -114,7 +122,8 @@ void PNGPrefsPanel::init()
 // -----------------------------------------------------------------------------
 void PNGPrefsPanel::applyPreferences()
 {
-	path_pngout   = wxutil::strToView(flp_pngout_->location());
-	path_pngcrush = wxutil::strToView(flp_pngcrush_->location());
-	path_deflopt  = wxutil::strToView(flp_deflopt_->location());
+	png_compression = choice_compression_->GetSelection();
+	path_pngout     = wxutil::strToView(flp_pngout_->location());
+	path_pngcrush   = wxutil::strToView(flp_pngcrush_->location());
+	path_deflopt    = wxutil::strToView(flp_deflopt_->location());
 }
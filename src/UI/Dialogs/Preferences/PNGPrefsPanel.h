@@ -15,11 +15,12 @@ public:
 	void init() override;
 	void applyPreferences() override;
 
-	wxString pageTitle() override { return "PNG Optimization Tools"; }
+	wxString pageTitle() override { return "PNG Compression and Optimization Tools"; }
 
 private:
-	FileLocationPanel* flp_pngout_   = nullptr;
-	FileLocationPanel* flp_pngcrush_ = nullptr;
-	FileLocationPanel* flp_deflopt_  = nullptr;
+	wxChoice*          choice_compression_ = nullptr;
+	FileLocationPanel* flp_pngout_         = nullptr;
+	FileLocationPanel* flp_pngcrush_       = nullptr;
+	FileLocationPanel* flp_deflopt_        = nullptr;
 };
 } // namespace slade
@@ -0,0 +1,437 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    TextSearchDialog.cpp
+// Description: Dialog for finding and replacing text in the text entries of
+//              the current archive, all open archives or all resources
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "TextSearchDialog.h"
+#include "Archive/ArchiveEntry.h"
+#include "General/UI.h"
+#include "General/UndoRedo.h"
+#include "MainEditor/MainEditor.h"
+#include "MainEditor/UI/ArchiveManagerPanel.h"
+#include "MainEditor/UI/ArchivePanel.h"
+#include "MainEditor/UI/EntryPanel/TextEntryPanel.h"
+#include "MainEditor/UI/MainWindow.h"
+#include "UI/Lists/VirtualListView.h"
+#include "Utility/ThreadPool.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, textsearch_match_case, false, CVar::Flag::Save)
+CVAR(Bool, textsearch_whole_word, false, CVar::Flag::Save)
+CVAR(Int, textsearch_scope, 0, CVar::Flag::Save)
+EXTERN_CVAR(Bool, textsearch_use_index)
+
+
+// -----------------------------------------------------------------------------
+// TextSearchResultList Class
+//
+// Virtual list showing the results of a text search
+// -----------------------------------------------------------------------------
+namespace slade
+{
+class TextSearchResultList : public VirtualListView
+{
+public:
+	TextSearchResultList(wxWindow* parent) : VirtualListView(parent)
+	{
+		AppendColumn("Entry");
+		AppendColumn("Line");
+		AppendColumn("Text");
+	}
+
+	~TextSearchResultList() override = default;
+
+	void setSearch(TextSearchDialog::Search* search)
+	{
+		search_ = search;
+		updateResults();
+	}
+
+	void updateResults()
+	{
+		SetItemCount(search_ ? search_->results.size() : 0);
+		Refresh();
+	}
+
+	wxString itemText(long item, long column, long index) const override
+	{
+		if (!search_ || item < 0 || item >= static_cast<long>(search_->results.size()))
+			return "";
+
+		auto& result = search_->results[item];
+		if (column == 0)
+		{
+			auto entry = search_->sources[result.source].entry.get();
+			if (!entry->parent())
+				return wxString::FromUTF8(entry->name()) + " (deleted)";
+			return wxString::FromUTF8(entry->parent()->filename(false) + ":" + entry->path(true));
+		}
+		if (column == 1)
+			return wxString::Format("%d", result.line + 1);
+		if (column == 2)
+			return wxString::FromUTF8(result.line_text);
+
+		return "";
+	}
+
+private:
+	TextSearchDialog::Search* search_ = nullptr;
+};
+} // namespace slade
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearchDialog Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// TextSearchDialog class constructor
+// -----------------------------------------------------------------------------
+TextSearchDialog::TextSearchDialog(wxWindow* parent) :
+	SDialog(parent, "Find in Archives", "textsearch", 700, 500),
+	timer_results_{ this }
+{
+	// Setup sizer
+	auto sizer = new wxBoxSizer(wxVERTICAL);
+	SetSizer(sizer);
+
+	auto gb_sizer = new wxGridBagSizer(ui::pad(), ui::pad());
+	sizer->Add(gb_sizer, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, ui::padLarge());
+
+	// Find/Replace
+	gb_sizer->Add(new wxStaticText(this, -1, "Find:"), wxGBPosition(0, 0), wxDefaultSpan, wxALIGN_CENTER_VERTICAL);
+	text_find_ = new wxTextCtrl(this, -1, "", wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
+	gb_sizer->Add(text_find_, wxGBPosition(0, 1), wxGBSpan(1, 2), wxEXPAND);
+	gb_sizer->Add(new wxStaticText(this, -1, "Replace:"), wxGBPosition(1, 0), wxDefaultSpan, wxALIGN_CENTER_VERTICAL);
+	text_replace_ = new wxTextCtrl(this, -1, "");
+	gb_sizer->Add(text_replace_, wxGBPosition(1, 1), wxGBSpan(1, 2), wxEXPAND);
+
+	// Options
+	cb_match_case_ = new wxCheckBox(this, -1, "Match Case");
+	cb_match_case_->SetValue(textsearch_match_case);
+	gb_sizer->Add(cb_match_case_, wxGBPosition(2, 1));
+	cb_whole_word_ = new wxCheckBox(this, -1, "Match Whole Word");
+	cb_whole_word_->SetValue(textsearch_whole_word);
+	gb_sizer->Add(cb_whole_word_, wxGBPosition(2, 2));
+	gb_sizer->Add(new wxStaticText(this, -1, "Search In:"), wxGBPosition(3, 0), wxDefaultSpan, wxALIGN_CENTER_VERTICAL);
+	wxString scopes[] = { "Current Archive", "All Open Archives", "Base Resource and Resource Archives" };
+	choice_scope_     = new wxChoice(this, -1, wxDefaultPosition, wxDefaultSize, 3, scopes);
+	choice_scope_->SetSelection(std::clamp<int>(textsearch_scope, 0, 2));
+	gb_sizer->Add(choice_scope_, wxGBPosition(3, 1), wxGBSpan(1, 2), wxEXPAND);
+	cb_use_index_ = new wxCheckBox(this, -1, "Use Search Index");
+	cb_use_index_->SetValue(textsearch_use_index);
+	cb_use_index_->SetToolTip(
+		"Keep an index of the text in searched archives, so that searches only need to look in entries that could "
+		"contain the text");
+	gb_sizer->Add(cb_use_index_, wxGBPosition(4, 1), wxGBSpan(1, 2));
+	gb_sizer->AddGrowableCol(2, 1);
+
+	// Results
+	list_results_ = new TextSearchResultList(this);
+	sizer->Add(list_results_, 1, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, ui::padLarge());
+	label_status_ = new wxStaticText(this, -1, "");
+	sizer->Add(label_status_, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, ui::padLarge());
+
+	// Dialog buttons
+	btn_find_    = new wxButton(this, -1, "Find All");
+	btn_replace_ = new wxButton(this, -1, "Replace All");
+	btn_close_   = new wxButton(this, wxID_CANCEL, "Close");
+	auto hbox    = new wxBoxSizer(wxHORIZONTAL);
+	hbox->AddStretchSpacer();
+	hbox->Add(btn_find_, 0, wxEXPAND | wxRIGHT, ui::pad());
+	hbox->Add(btn_replace_, 0, wxEXPAND | wxRIGHT, ui::pad());
+	hbox->Add(btn_close_, 0, wxEXPAND);
+	sizer->AddSpacer(ui::pad());
+	sizer->Add(hbox, 0, wxLEFT | wxRIGHT | wxBOTTOM | wxEXPAND, ui::padLarge());
+
+	// Bind events
+	btn_find_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { startSearch(); });
+	text_find_->Bind(wxEVT_TEXT_ENTER, [&](wxCommandEvent&) { startSearch(); });
+	btn_replace_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { replaceAll(); });
+	btn_close_->Bind(wxEVT_BUTTON, [&](wxCommandEvent&) { Show(false); });
+	list_results_->Bind(wxEVT_LIST_ITEM_ACTIVATED, [&](wxListEvent& e) { openResult(e.GetIndex()); });
+	cb_match_case_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { textsearch_match_case = cb_match_case_->GetValue(); });
+	cb_whole_word_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { textsearch_whole_word = cb_whole_word_->GetValue(); });
+	choice_scope_->Bind(wxEVT_CHOICE, [&](wxCommandEvent&) { textsearch_scope = choice_scope_->GetSelection(); });
+	cb_use_index_->Bind(wxEVT_CHECKBOX, [&](wxCommandEvent&) { textsearch_use_index = cb_use_index_->GetValue(); });
+	Bind(wxEVT_TIMER, &TextSearchDialog::onResultsTimer, this);
+
+	// Setup dialog layout
+	wxWindowBase::Layout();
+	CenterOnParent();
+	text_find_->SetFocus();
+}
+
+// -----------------------------------------------------------------------------
+// TextSearchDialog class destructor
+// -----------------------------------------------------------------------------
+TextSearchDialog::~TextSearchDialog()
+{
+	cancelSearch();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the search options currently set in the dialog
+// -----------------------------------------------------------------------------
+textsearch::Options TextSearchDialog::searchOptions() const
+{
+	textsearch::Options options;
+	options.find       = text_find_->GetValue().ToStdString();
+	options.match_case = cb_match_case_->GetValue();
+	options.whole_word = cb_whole_word_->GetValue();
+
+	return options;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the text entries to search for [find] in the currently selected scope
+// -----------------------------------------------------------------------------
+vector<textsearch::Source> TextSearchDialog::scopeSources(string_view find) const
+{
+	switch (choice_scope_->GetSelection())
+	{
+	case 0:
+	{
+		auto archive = maineditor::currentArchive();
+		return archive ? textsearch::archiveSources(archive, find) : vector<textsearch::Source>{};
+	}
+	case 1: return textsearch::openArchiveSources(find);
+	case 2: return textsearch::resourceSources(find);
+	default: return {};
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Cancels the current search if it is still running
+// -----------------------------------------------------------------------------
+void TextSearchDialog::cancelSearch()
+{
+	timer_results_.Stop();
+
+	if (search_job_)
+	{
+		search_job_->cancel();
+		search_job_.reset();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Begins searching for the current find text (in the background), results are
+// added to the list as they are found
+// -----------------------------------------------------------------------------
+void TextSearchDialog::startSearch()
+{
+	cancelSearch();
+
+	auto options = searchOptions();
+	if (options.find.empty())
+		return;
+
+	// The list refers to the search so it must be cleared before it is replaced
+	list_results_->setSearch(nullptr);
+	search_          = std::make_shared<Search>();
+	search_->sources = scopeSources(options.find);
+	list_results_->setSearch(search_.get());
+
+	label_status_->SetLabel(wxString::Format("Searching %d entries...", static_cast<int>(search_->sources.size())));
+
+	search_job_ = Job::start([search = search_, options](Job& job) {
+		textsearch::search(search->sources, options, job, [&](vector<textsearch::Match> matches) {
+			std::lock_guard lock(search->mutex);
+			search->found.insert(search->found.end(), matches.begin(), matches.end());
+		});
+	});
+
+	timer_results_.Start(100);
+}
+
+// -----------------------------------------------------------------------------
+// Replaces all occurrences of the find text in the currently selected scope.
+// Each modified entry gets its own undo step in its archive's undo history
+// -----------------------------------------------------------------------------
+void TextSearchDialog::replaceAll()
+{
+	auto options = searchOptions();
+	if (options.find.empty())
+		return;
+
+	if (wxMessageBox(
+			wxString::Format(
+				"Replace all occurrences of \"%s\" with \"%s\" in %s?",
+				text_find_->GetValue(),
+				text_replace_->GetValue(),
+				choice_scope_->GetStringSelection()),
+			"Replace All",
+			wxICON_QUESTION | wxYES_NO,
+			this)
+		== wxNO)
+		return;
+
+	cancelSearch();
+	list_results_->setSearch(nullptr);
+	search_.reset();
+
+	// Get replaced text for all entries (in parallel)
+	auto                sources     = scopeSources(options.find);
+	auto                replacement = text_replace_->GetValue().ToStdString();
+	textsearch::Matcher matcher{ options };
+	vector<string>      replaced(sources.size());
+	vector<unsigned>    counts(sources.size());
+	threadpool::parallelFor(sources.size(), [&](size_t index) {
+		counts[index] = textsearch::replace(sources[index].text(), matcher, replacement, replaced[index]);
+	});
+
+	// Update entries
+	unsigned total     = 0;
+	unsigned n_entries = 0;
+	auto     current   = maineditor::currentEntryPanel();
+	for (unsigned a = 0; a < sources.size(); ++a)
+	{
+		auto entry   = sources[a].entry.get();
+		auto archive = entry->parent();
+		if (counts[a] == 0 || !archive || archive->isReadOnly() || entry->isLocked())
+			continue;
+
+		auto panel        = theMainWindow->archiveManagerPanel()->tabForArchive(archive);
+		auto undo_manager = panel ? panel->undoManager() : nullptr;
+		if (undo_manager)
+		{
+			undo_manager->beginRecord("Replace Text");
+			undo_manager->recordUndoStep(std::make_unique<EntryDataUS>(entry));
+		}
+
+		entry->importMem(replaced[a].data(), replaced[a].size());
+
+		if (undo_manager)
+			undo_manager->endRecord(true);
+
+		// Reload entry if currently open
+		if (current && current->entry() == entry)
+			current->openEntry(entry);
+
+		total += counts[a];
+		n_entries++;
+	}
+
+	label_status_->SetLabel(wxString::Format("Replaced %d occurrences in %d entries", total, n_entries));
+}
+
+// -----------------------------------------------------------------------------
+// Opens the entry of the result at [index] in the list and shows the line the
+// result is on
+// -----------------------------------------------------------------------------
+void TextSearchDialog::openResult(long index) const
+{
+	if (!search_ || index < 0 || index >= static_cast<long>(search_->results.size()))
+		return;
+
+	auto& result  = search_->results[index];
+	auto  entry   = search_->sources[result.source].entry.get();
+	auto  archive = entry->parent();
+	if (!archive)
+		return;
+
+	// Open in the archive's tab if possible, otherwise in its own tab
+	auto manager = theMainWindow->archiveManagerPanel();
+	manager->openTab(archive);
+	auto panel = manager->tabForArchive(archive);
+	if (panel)
+	{
+		panel->focusOnEntry(entry);
+		panel->openEntry(entry);
+	}
+	else
+		maineditor::openEntry(entry);
+
+	if (auto text_panel = dynamic_cast<TextEntryPanel*>(maineditor::currentEntryPanel()))
+		if (text_panel->entry() == entry)
+			text_panel->showLine(result.line);
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// TextSearchDialog Class Events
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Called periodically while searching, adds any new results to the list
+// -----------------------------------------------------------------------------
+void TextSearchDialog::onResultsTimer(wxTimerEvent& e)
+{
+	if (!search_)
+		return;
+
+	// Check if finished before getting results, so none are missed
+	auto finished = !search_job_ || search_job_->finished();
+	{
+		std::lock_guard lock(search_->mutex);
+		search_->results.insert(search_->results.end(), search_->found.begin(), search_->found.end());
+		search_->found.clear();
+	}
+
+	if (!finished)
+	{
+		list_results_->updateResults();
+		label_status_->SetLabel(wxString::Format("Searching... %d matches", static_cast<int>(search_->results.size())));
+		return;
+	}
+
+	// Finished, sort results by entry and position
+	cancelSearch();
+	std::sort(
+		search_->results.begin(),
+		search_->results.end(),
+		[](const textsearch::Match& left, const textsearch::Match& right) {
+			return left.source < right.source || (left.source == right.source && left.position < right.position);
+		});
+	list_results_->updateResults();
+
+	unsigned n_entries = 0;
+	for (unsigned a = 0; a < search_->results.size(); ++a)
+		if (a == 0 || search_->results[a].source != search_->results[a - 1].source)
+			n_entries++;
+
+	label_status_->SetLabel(
+		wxString::Format("Found %d matches in %d entries", static_cast<int>(search_->results.size()), n_entries));
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Archive/TextSearch.h"
+#include "UI/SDialog.h"
+#include <mutex>
+
+namespace slade
+{
+class Job;
+class TextSearchResultList;
+
+class TextSearchDialog : public SDialog
+{
+public:
+	TextSearchDialog(wxWindow* parent);
+	~TextSearchDialog();
+
+	// Shared state of a search, results are added from the search job
+	struct Search
+	{
+		vector<textsearch::Source> sources;
+		vector<textsearch::Match>  results;
+		std::mutex                 mutex;
+		vector<textsearch::Match>  found; // Results not yet added to [results]
+	};
+
+private:
+	wxTextCtrl*           text_find_     = nullptr;
+	wxTextCtrl*           text_replace_  = nullptr;
+	wxCheckBox*           cb_match_case_ = nullptr;
+	wxCheckBox*           cb_whole_word_ = nullptr;
+	wxCheckBox*           cb_use_index_  = nullptr;
+	wxChoice*             choice_scope_  = nullptr;
+	TextSearchResultList* list_results_  = nullptr;
+	wxStaticText*         label_status_  = nullptr;
+	wxButton*             btn_find_      = nullptr;
+	wxButton*             btn_replace_   = nullptr;
+	wxButton*             btn_close_     = nullptr;
+	wxTimer               timer_results_;
+
+	shared_ptr<Search> search_;
+	shared_ptr<Job>    search_job_;
+
+	textsearch::Options        searchOptions() const;
+	vector<textsearch::Source> scopeSources(string_view find) const;
+	void                       cancelSearch();
+	void                       startSearch();
+	void                       replaceAll();
+	void                       openResult(long index) const;
+
+	// Events
+	void onResultsTimer(wxTimerEvent& e);
+};
+} // namespace slade
@@ -798,12 +798,7 @@ void TranslationEditorDialog::updatePreviews()
 	pal_canvas_preview_->Refresh();
 
 	// Update image preview
-	gfx_preview_->image().copyImage(&image_preview_);
-	gfx_preview_->image().applyTranslation(&translation_, &palette_, cb_truecolor_->GetValue());
-
-	// Update UI
-	gfx_preview_->updateImageTexture();
-	gfx_preview_->Refresh();
+	gfx_preview_->setPreviewTranslation(&translation_, cb_truecolor_->GetValue());
 
 	// Update text string
 	if (cb_paletteonly_->GetValue())
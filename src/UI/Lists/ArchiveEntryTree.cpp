@@ -37,6 +37,7 @@
 #include "Archive/Archive.h"
 #include "Archive/ArchiveEntry.h"
 #include "Archive/ArchiveManager.h"
+#include "Archive/EntryType/EntryType.h"
 #include "General/ColourConfiguration.h"
 #include "General/SAction.h"
 #include "General/UndoRedo.h"
@@ -59,6 +60,11 @@ wxColour col_text_new(0, 0, 0, 0);
 wxColour col_text_locked(0, 0, 0, 0);
 } // namespace slade::ui
 
+namespace
+{
+constexpr size_t BATCH_RESORT_COUNT = 100; // Added items above which the tree is resorted once instead
+} // namespace
+
 CVAR(Int, elist_colsize_name_tree, 150, CVar::Save)
 CVAR(Int, elist_colsize_name_list, 150, CVar::Save)
 CVAR(Int, elist_colsize_size, 80, CVar::Save)
@@ -118,6 +124,7 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 {
 	archive_      = archive;
 	undo_manager_ = undo_manager;
+	sort_by_name_ = archive->formatId() == "folder";
 
 	// Add root items
 	wxDataViewItemArray items;
@@ -129,49 +136,51 @@ void ArchiveViewModel::openArchive(shared_ptr<Archive> archive, UndoManager* und
 
 	// Entry added
 	connections_ += archive->signals().entry_added.connect([this](Archive& archive, ArchiveEntry& entry) {
-		ItemAdded(createItemForDirectory(*entry.parentDir()), wxDataViewItem(&entry));
+		queueAdded(createItemForDirectory(*entry.parentDir()), wxDataViewItem(&entry));
 	});
 
 	// Entry removed
 	connections_ += archive->signals().entry_removed.connect(
 		[this](Archive& archive, ArchiveDir& dir, ArchiveEntry& entry) {
+			flushPendingChanges();
+			sort_index_.erase(&entry);
 			ItemDeleted(createItemForDirectory(dir), wxDataViewItem(&entry));
 		});
 
 	// Entry modified
 	connections_ += archive->signals().entry_state_changed.connect(
-		[this](Archive& archive, ArchiveEntry& entry) { ItemChanged(wxDataViewItem(&entry)); });
+		[this](Archive& archive, ArchiveEntry& entry) { queueChanged(wxDataViewItem(&entry)); });
 
 	// Dir added
 	connections_ += archive->signals().dir_added.connect([this](Archive& archive, ArchiveDir& dir) {
-		ItemAdded(createItemForDirectory(*dir.parent()), wxDataViewItem(dir.dirEntry()));
+		queueAdded(createItemForDirectory(*dir.parent()), wxDataViewItem(dir.dirEntry()));
 	});
 
 	// Dir removed
 	connections_ += archive->signals().dir_removed.connect(
 		[this](Archive& archive, ArchiveDir& parent, ArchiveDir& dir) {
+			flushPendingChanges();
+			sort_index_.clear();
 			ItemDeleted(createItemForDirectory(parent), wxDataViewItem(dir.dirEntry()));
 		});
 
 	// Entries reordered within dir
 	connections_ += archive->signals().entries_swapped.connect(
 		[this](Archive& archive, ArchiveDir& dir, unsigned index1, unsigned index2) {
-			ItemChanged(wxDataViewItem(dir.entryAt(index1)));
-			ItemChanged(wxDataViewItem(dir.entryAt(index2)));
+			queueChanged(wxDataViewItem(dir.entryAt(index1)));
+			queueChanged(wxDataViewItem(dir.entryAt(index2)));
 		});
 
 	// Bookmark added
 	connections_ += app::archiveManager().signals().bookmark_added.connect(
-		[this](ArchiveEntry* entry) { ItemChanged(wxDataViewItem(entry)); });
+		[this](ArchiveEntry* entry) { queueChanged(wxDataViewItem(entry)); });
 
 	// Bookmark(s) removed
 	connections_ += app::archiveManager().signals().bookmarks_removed.connect(
 		[this](const vector<ArchiveEntry*>& removed) {
-			wxDataViewItemArray items;
 			for (auto* entry : removed)
 				if (entry)
-					items.push_back(wxDataViewItem{ entry });
-			ItemsChanged(items);
+					queueChanged(wxDataViewItem{ entry });
 		});
 }
 
@@ -184,15 +193,26 @@ void ArchiveViewModel::setFilter(string_view name, string_view category)
 	if (name.empty() && filter_name_.empty() && filter_category_ == category)
 		return;
 
+	// Apply any queued changes first, so the items removed below are all known
+	flushPendingChanges();
+
 	// Get current root items (to remove)
 	wxDataViewItemArray prev_items;
 	if (auto* archive = archive_.lock().get())
 		getDirChildItems(prev_items, *archive->rootDir());
 
+	// Get the types in the filter category, so entries can be checked by type
+	// rather than comparing category names
 	filter_category_ = category;
+	filter_types_.clear();
+	if (!filter_category_.empty())
+		for (auto* type : EntryType::allTypes())
+			if (strutil::equalCI(type->category(), filter_category_))
+				filter_types_.insert(type);
 
 	// Process filter string
 	filter_name_.clear();
+	filter_prefix_.clear();
 	if (!name.empty())
 	{
 		auto filter_parts = strutil::splitV(name, ',');
@@ -203,8 +223,12 @@ void ArchiveViewModel::setFilter(string_view name, string_view category)
 				continue;
 
 			strutil::upperIP(filter_part);
-			filter_part += '*';
-			filter_name_.push_back(filter_part);
+
+			// Filters without wildcards only need to match the start of the name
+			if (filter_part.find_first_of("*?") == string::npos)
+				filter_prefix_.push_back(filter_part);
+			else
+				filter_name_.push_back(filter_part + '*');
 		}
 	}
 
@@ -225,6 +249,49 @@ void ArchiveViewModel::setFilter(string_view name, string_view category)
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Notifies the control of all queued added and changed items
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::flushPendingChanges()
+{
+	// Items are no longer valid if the archive has gone
+	if (archive_.expired())
+	{
+		pending_added_.clear();
+		pending_changed_.clear();
+		pending_changed_set_.clear();
+		return;
+	}
+
+	if (!pending_added_.empty())
+	{
+		// When many items are added, sort once afterwards rather than inserting
+		// each in sorted order
+		size_t count = 0;
+		for (const auto& added : pending_added_)
+			count += added.second.size();
+		bool resort = count > BATCH_RESORT_COUNT;
+
+		if (resort)
+			sort_enabled_ = false;
+		for (const auto& added : pending_added_)
+			ItemsAdded(added.first, added.second);
+		pending_added_.clear();
+		if (resort)
+		{
+			sort_enabled_ = true;
+			Resort();
+		}
+	}
+
+	if (!pending_changed_.empty())
+	{
+		ItemsChanged(pending_changed_);
+		pending_changed_.clear();
+		pending_changed_set_.clear();
+	}
+}
+
 // -----------------------------------------------------------------------------
 // Returns the wxVariant type for the column [col]
 // -----------------------------------------------------------------------------
@@ -545,7 +612,7 @@ int ArchiveViewModel::Compare(
 		// Type column (order by type name -> name)
 		else if (column == 2)
 		{
-			cmpval = e1_type->name().compare(e2_type->name());
+			cmpval = e1_type == e2_type ? 0 : e1_type->name().compare(e2_type->name());
 			if (cmpval == 0)
 				cmpval = e1->upperName().compare(e2->upperName());
 		}
@@ -554,12 +621,12 @@ int ArchiveViewModel::Compare(
 		else
 		{
 			// Directory archives default to alphabetical order
-			if (auto archive = archive_.lock(); archive->formatId() == "folder")
+			if (sort_by_name_)
 				cmpval = e1->upperName().compare(e2->upperName());
 
 			// Everything else defaults to index order
 			else
-				cmpval = e1->index() > e2->index() ? 1 : -1;
+				cmpval = sortIndex(*e1) > sortIndex(*e2) ? 1 : -1;
 		}
 
 		return ascending ? cmpval : -cmpval;
@@ -588,8 +655,11 @@ wxDataViewItem ArchiveViewModel::createItemForDirectory(const ArchiveDir& dir) c
 bool ArchiveViewModel::matchesFilter(const ArchiveEntry& entry) const
 {
 	// Check for name match if needed
-	if (!filter_name_.empty())
+	if (!filter_name_.empty() || !filter_prefix_.empty())
 	{
+		for (const auto& f : filter_prefix_)
+			if (strutil::startsWith(entry.upperName(), f))
+				return true;
 		for (const auto& f : filter_name_)
 			if (strutil::matches(entry.upperName(), f))
 				return true;
@@ -599,12 +669,76 @@ bool ArchiveViewModel::matchesFilter(const ArchiveEntry& entry) const
 
 	// Check for category match if needed
 	if (!filter_category_.empty() && entry.type() != EntryType::folderType())
-		if (!strutil::equalCI(entry.type()->category(), filter_category_))
+		if (filter_types_.count(entry.type()) == 0)
 			return false;
 
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the index of [entry] within its parent dir, for sorting.
+// Indices are cached for the whole dir at once, so that sorting isn't slowed
+// down by searching the dir for each entry after entries have been added or
+// removed before it
+// -----------------------------------------------------------------------------
+unsigned ArchiveViewModel::sortIndex(const ArchiveEntry& entry) const
+{
+	auto* dir = entry.parentDir();
+	if (!dir)
+		return 0;
+
+	auto cached = sort_index_.find(&entry);
+	if (cached != sort_index_.end() && dir->entryAt(cached->second) == &entry)
+		return cached->second;
+
+	// Rebuild indices for the dir
+	const auto& entries = dir->entries();
+	for (unsigned a = 0; a < entries.size(); ++a)
+		sort_index_[entries[a].get()] = a;
+
+	return sort_index_[&entry];
+}
+
+// -----------------------------------------------------------------------------
+// Queues [item] to be added to the control under [parent]
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::queueAdded(const wxDataViewItem& parent, const wxDataViewItem& item)
+{
+	if (pending_added_.empty() || pending_added_.back().first != parent)
+		pending_added_.emplace_back(parent, wxDataViewItemArray{});
+	pending_added_.back().second.push_back(item);
+
+	queueFlush();
+}
+
+// -----------------------------------------------------------------------------
+// Queues [item] to be updated in the control
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::queueChanged(const wxDataViewItem& item)
+{
+	if (!item.IsOk() || !pending_changed_set_.insert(item.GetID()).second)
+		return;
+
+	pending_changed_.push_back(item);
+	queueFlush();
+}
+
+// -----------------------------------------------------------------------------
+// Queues a flush of pending changes on the next event loop iteration (if one
+// isn't already queued)
+// -----------------------------------------------------------------------------
+void ArchiveViewModel::queueFlush()
+{
+	if (flush_queued_ || !owner_)
+		return;
+
+	flush_queued_ = true;
+	owner_->CallAfter([this]() {
+		flush_queued_ = false;
+		flushPendingChanges();
+	});
+}
+
 // -----------------------------------------------------------------------------
 // Populates [items] with all child entries/subrirs of [dir].
 // If [filtered] is true, only adds children matching the current filter
@@ -648,7 +782,7 @@ ArchiveEntryTree::ArchiveEntryTree(wxWindow* parent, shared_ptr<Archive> archive
 		SetFont(wxutil::monospaceFont(GetFont()));
 
 	// Create & associate model
-	model_ = new ArchiveViewModel();
+	model_ = new ArchiveViewModel(this);
 	model_->openArchive(archive, undo_manager);
 	AssociateModel(model_);
 	model_->DecRef();
@@ -732,6 +866,33 @@ ArchiveEntryTree::ArchiveEntryTree(wxWindow* parent, shared_ptr<Archive> archive
 	});
 }
 
+// -----------------------------------------------------------------------------
+// Ensures [item] is visible, after applying any queued model changes
+// -----------------------------------------------------------------------------
+void ArchiveEntryTree::EnsureVisible(const wxDataViewItem& item, const wxDataViewColumn* column)
+{
+	model_->flushPendingChanges();
+	wxDataViewCtrl::EnsureVisible(item, column);
+}
+
+// -----------------------------------------------------------------------------
+// Selects the items in [sel], after applying any queued model changes
+// -----------------------------------------------------------------------------
+void ArchiveEntryTree::SetSelections(const wxDataViewItemArray& sel)
+{
+	model_->flushPendingChanges();
+	wxDataViewCtrl::SetSelections(sel);
+}
+
+// -----------------------------------------------------------------------------
+// Selects [item], after applying any queued model changes
+// -----------------------------------------------------------------------------
+void ArchiveEntryTree::Select(const wxDataViewItem& item)
+{
+	model_->flushPendingChanges();
+	wxDataViewCtrl::Select(item);
+}
+
 // -----------------------------------------------------------------------------
 // Returns the ArchiveDir that [item] represents, or nullptr if it isn't a valid
 // directory item
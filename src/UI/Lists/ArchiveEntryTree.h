@@ -1,6 +1,8 @@
 #pragma once
 
 #include "General/Sigslot.h"
+#include <unordered_map>
+#include <unordered_set>
 #include <wx/dataview.h>
 
 namespace slade
@@ -8,6 +10,7 @@ namespace slade
 class Archive;
 class ArchiveEntry;
 class ArchiveDir;
+class EntryType;
 class UndoManager;
 
 namespace ui
@@ -15,18 +18,35 @@ namespace ui
 	class ArchiveViewModel : public wxDataViewModel
 	{
 	public:
-		ArchiveViewModel() = default;
+		ArchiveViewModel(wxEvtHandler* owner) : owner_{ owner } {}
 
 		void openArchive(shared_ptr<Archive> archive, UndoManager* undo_manager);
 		void setFilter(string_view name, string_view category);
+		void flushPendingChanges();
 
 	private:
-		weak_ptr<Archive>    archive_;
-		ScopedConnectionList connections_;
-		vector<string>       filter_name_;
-		string               filter_category_;
-		UndoManager*         undo_manager_ = nullptr;
-		bool                 sort_enabled_ = true;
+		weak_ptr<Archive>              archive_;
+		wxEvtHandler*                  owner_ = nullptr;
+		ScopedConnectionList           connections_;
+		vector<string>                 filter_name_;
+		vector<string>                 filter_prefix_; // Name filters that are a simple prefix match
+		string                         filter_category_;
+		std::unordered_set<EntryType*> filter_types_; // Types in [filter_category_]
+		UndoManager*                   undo_manager_ = nullptr;
+		bool                           sort_enabled_ = true;
+		bool                           sort_by_name_ = false; // Default order is alphabetical rather than by index
+
+		// Added and changed items are queued and notified together (per parent
+		// for added items) once per event loop iteration, or before any items
+		// are removed
+		vector<std::pair<wxDataViewItem, wxDataViewItemArray>> pending_added_;
+		wxDataViewItemArray                                    pending_changed_;
+		std::unordered_set<void*>                              pending_changed_set_;
+		bool                                                   flush_queued_ = false;
+
+		// Entry indices within their dir for sorting, rebuilt for a whole dir at
+		// a time when an entry's index is found to be out of date
+		mutable std::unordered_map<const ArchiveEntry*, unsigned> sort_index_;
 
 		// wxDataViewModel
 		unsigned int   GetColumnCount() const override { return 4; }
@@ -44,6 +64,10 @@ namespace ui
 
 		wxDataViewItem createItemForDirectory(const ArchiveDir& dir) const;
 		bool           matchesFilter(const ArchiveEntry& entry) const;
+		unsigned       sortIndex(const ArchiveEntry& entry) const;
+		void           queueAdded(const wxDataViewItem& parent, const wxDataViewItem& item);
+		void           queueChanged(const wxDataViewItem& item);
+		void           queueFlush();
 		void           getDirChildItems(wxDataViewItemArray& items, const ArchiveDir& dir, bool filter = true) const;
 	};
 
@@ -58,6 +82,12 @@ namespace ui
 		}
 		ArchiveDir* dirForDirItem(const wxDataViewItem& item) const;
 
+		// Make sure any queued model changes are applied before items are
+		// selected or shown
+		void EnsureVisible(const wxDataViewItem& item, const wxDataViewColumn* column = nullptr) override;
+		void SetSelections(const wxDataViewItemArray& sel) override;
+		void Select(const wxDataViewItem& item) override;
+
 		bool isSortedByName() const { return GetSortingColumn() == col_name_; }
 		bool isSortedBySize() const { return GetSortingColumn() == col_size_; }
 		bool isSortedByType() const { return GetSortingColumn() == col_type_; }
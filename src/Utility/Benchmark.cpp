@@ -0,0 +1,191 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Benchmark.cpp
+// Description: Common functions for the built-in benchmarks (see
+//              ArchiveBenchmark and MapBenchmark) - timing phases, latency
+//              percentiles of repeated operations, memory usage and output
+//              of results in a tab-separated format that can be diffed
+//              between builds
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Benchmark.h"
+#include "Utility/StringUtils.h"
+#include <numeric>
+#ifdef __WXMSW__
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace slade;
+using namespace benchmark;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the value at [percentile] (0-1) of sorted [samples]
+// -----------------------------------------------------------------------------
+double percentile(const vector<double>& samples, double percentile)
+{
+	if (samples.empty())
+		return 0.;
+
+	auto index = static_cast<size_t>(std::ceil(percentile * samples.size()));
+	return samples[std::min(std::max<size_t>(index, 1), samples.size()) - 1];
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Benchmark Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the time elapsed since [start] in milliseconds
+// -----------------------------------------------------------------------------
+double benchmark::elapsedMs(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the peak memory usage (resident set size) of the process in MB
+// -----------------------------------------------------------------------------
+double benchmark::peakRssMB()
+{
+#ifdef __WXMSW__
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize / (1024. * 1024.);
+	return 0.;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0.;
+#ifdef __APPLE__
+	return usage.ru_maxrss / (1024. * 1024.); // Bytes
+#else
+	return usage.ru_maxrss / 1024.; // KB
+#endif
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Runs [func] once and adds the time it took as [phase] of [corpus] to
+// [results]. [func] returns the number of bytes it processed (or 0)
+// -----------------------------------------------------------------------------
+void benchmark::timePhase(
+	vector<Result>&           results,
+	string_view               corpus,
+	string_view               phase,
+	unsigned                  count,
+	std::function<uint64_t()> func)
+{
+	auto start = Clock::now();
+	auto bytes = func();
+	auto ms    = elapsedMs(start);
+
+	results.push_back({ string{ corpus }, string{ phase }, count, bytes, ms, ms, ms, ms, ms, peakRssMB() });
+	log::info(2, "Benchmark: {} {} took {:.2f}ms", corpus, phase, ms);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the times taken by each run of a repeated operation ([samples_ms]) as
+// [phase] of [corpus] to [results], with latency percentiles
+// -----------------------------------------------------------------------------
+void benchmark::addSampled(vector<Result>& results, string_view corpus, string_view phase, vector<double> samples_ms)
+{
+	std::sort(samples_ms.begin(), samples_ms.end());
+
+	Result result;
+	result.corpus      = corpus;
+	result.phase       = phase;
+	result.count       = samples_ms.size();
+	result.ms          = std::accumulate(samples_ms.begin(), samples_ms.end(), 0.);
+	result.p50_ms      = percentile(samples_ms, 0.5);
+	result.p95_ms      = percentile(samples_ms, 0.95);
+	result.p99_ms      = percentile(samples_ms, 0.99);
+	result.max_ms      = samples_ms.empty() ? 0. : samples_ms.back();
+	result.peak_rss_mb = peakRssMB();
+	results.push_back(result);
+
+	log::info(2, "Benchmark: {} {} x{} took {:.2f}ms", corpus, phase, result.count, result.ms);
+}
+
+// -----------------------------------------------------------------------------
+// Returns [results] formatted as tab-separated text, with one line for each
+// result. Throughput is given in items/s and MB/s (where applicable), GL draw
+// calls and texture binds are given per item (eg. per frame)
+// -----------------------------------------------------------------------------
+string benchmark::formatResults(const vector<Result>& results)
+{
+	string out =
+		"corpus\tphase\tcount\tms\tper_s\tmb_per_s\tp50_ms\tp95_ms\tp99_ms\tmax_ms\tpeak_rss_mb\tdraws\ttex_binds\n";
+	for (const auto& result : results)
+	{
+		auto seconds = std::max(result.ms, 0.001) / 1000.;
+		auto count   = std::max(result.count, 1u);
+		out += fmt::format(
+			"{}\t{}\t{}\t{:.2f}\t{:.0f}\t{:.2f}\t{:.3f}\t{:.3f}\t{:.3f}\t{:.3f}\t{:.1f}\t{:.1f}\t{:.1f}\n",
+			result.corpus,
+			result.phase,
+			result.count,
+			result.ms,
+			result.count / seconds,
+			result.bytes / (1024. * 1024.) / seconds,
+			result.p50_ms,
+			result.p95_ms,
+			result.p99_ms,
+			result.max_ms,
+			result.peak_rss_mb,
+			static_cast<double>(result.draw_calls) / count,
+			static_cast<double>(result.texture_binds) / count);
+	}
+
+	return out;
+}
+
+// -----------------------------------------------------------------------------
+// Writes formatted [results] to the console log, one line per result
+// -----------------------------------------------------------------------------
+void benchmark::logResults(const vector<Result>& results)
+{
+	for (const auto& line : strutil::splitV(formatResults(results), '\n'))
+		if (!line.empty())
+			log::console(string{ line });
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+
+namespace slade::benchmark
+{
+// The time taken by a benchmark phase, either a single run or a number of
+// timed samples of a repeated operation
+struct Result
+{
+	string   corpus;           // Archive path, map name, or name of generated data
+	string   phase;            // Name of the operation timed
+	unsigned count       = 0;  // Number of entries/objects processed, or samples taken
+	uint64_t bytes       = 0;  // Number of bytes processed (0 if not applicable)
+	double   ms          = 0.; // Total time taken
+	double   p50_ms      = 0.; // Sample latency percentiles (single run time if not sampled)
+	double   p95_ms      = 0.;
+	double   p99_ms      = 0.;
+	double   max_ms      = 0.;
+	double   peak_rss_mb = 0.; // Peak memory usage of the process after the phase
+
+	// GL work submitted (renderer benchmarks only)
+	uint64_t draw_calls    = 0;
+	uint64_t texture_binds = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start);
+double peakRssMB();
+void   timePhase(
+	vector<Result>&           results,
+	string_view               corpus,
+	string_view               phase,
+	unsigned                  count,
+	std::function<uint64_t()> func);
+void   addSampled(vector<Result>& results, string_view corpus, string_view phase, vector<double> samples_ms);
+string formatResults(const vector<Result>& results);
+void   logResults(const vector<Result>& results);
+} // namespace slade::benchmark
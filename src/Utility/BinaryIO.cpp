@@ -0,0 +1,76 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    BinaryIO.cpp
+// Description: Functions for reading and writing the simple binary formats
+//              used by the various on-disk caches (length-prefixed strings
+//              etc.)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "BinaryIO.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// BinaryIO Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Appends [str] to [out], prefixed with its length
+// -----------------------------------------------------------------------------
+void binaryio::writeString(string& out, string_view str)
+{
+	writeRaw(out, static_cast<uint32_t>(str.size()));
+	out += str;
+}
+
+// -----------------------------------------------------------------------------
+// Reads a length-prefixed string from [mc] into [str]. Returns false if the
+// string would run past the end of the data
+// -----------------------------------------------------------------------------
+bool binaryio::readString(MemChunk& mc, string& str)
+{
+	uint32_t size = 0;
+	if (!mc.read(&size, 4) || size > mc.size() - mc.currentPos())
+		return false;
+
+	str.assign(reinterpret_cast<const char*>(std::as_const(mc).data()) + mc.currentPos(), size);
+	return mc.seek(size, SEEK_CUR);
+}
+
+// -----------------------------------------------------------------------------
+// Reads a count from [mc] into [count], which can't be larger than the
+// remaining data (each counted item takes at least a byte)
+// -----------------------------------------------------------------------------
+bool binaryio::readCount(MemChunk& mc, uint32_t& count)
+{
+	return mc.read(&count, 4) && count <= mc.size() - mc.currentPos();
+}
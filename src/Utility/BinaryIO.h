@@ -0,0 +1,14 @@
+#pragma once
+
+namespace slade::binaryio
+{
+// Appends the raw bytes of [value] to [out]
+template<typename T> void writeRaw(string& out, const T& value)
+{
+	out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(string& out, string_view str);
+bool readString(MemChunk& mc, string& str);
+bool readCount(MemChunk& mc, uint32_t& count);
+} // namespace slade::binaryio
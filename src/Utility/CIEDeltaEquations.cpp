@@ -229,6 +229,191 @@ double cie::CIEDE2000(const ColLAB& col1, const ColLAB& col2)
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// LABArray Struct Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Sets the array to the [count] LAB [colours] given
+// -----------------------------------------------------------------------------
+void cie::LABArray::set(const ColLAB* colours, unsigned count)
+{
+	l.resize(count);
+	a.resize(count);
+	b.resize(count);
+	c.resize(count);
+	for (unsigned i = 0; i < count; ++i)
+	{
+		l[i] = static_cast<float>(colours[i].l);
+		a[i] = static_cast<float>(colours[i].a);
+		b[i] = static_cast<float>(colours[i].b);
+		c[i] = static_cast<float>(sqrt(colours[i].a * colours[i].a + colours[i].b * colours[i].b));
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// CIE Namespace Batch Functions
+//
+// The loops below are kept free of branches and function calls where possible
+// (using selects and precalculated values instead) so the compiler can
+// vectorise them for whatever instruction set is being built for
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Writes the CIE76 difference between [col] and each colour in [colours] to
+// [out]
+// -----------------------------------------------------------------------------
+void cie::CIE76(const ColLAB& col, const LABArray& colours, float* out)
+{
+	const auto  l1 = static_cast<float>(col.l);
+	const auto  a1 = static_cast<float>(col.a);
+	const auto  b1 = static_cast<float>(col.b);
+	const auto* l2 = colours.l.data();
+	const auto* a2 = colours.a.data();
+	const auto* b2 = colours.b.data();
+	const auto  n  = colours.size();
+
+	for (unsigned i = 0; i < n; ++i)
+	{
+		float dl = l1 - l2[i];
+		float da = a1 - a2[i];
+		float db = b1 - b2[i];
+		out[i]   = dl * dl + da * da + db * db;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes the CIE94 difference between [col] and each colour in [colours] to
+// [out]
+// -----------------------------------------------------------------------------
+void cie::CIE94(const ColLAB& col, const LABArray& colours, float* out)
+{
+	const auto  l1 = static_cast<float>(col.l);
+	const auto  a1 = static_cast<float>(col.a);
+	const auto  b1 = static_cast<float>(col.b);
+	const auto  c1 = sqrtf(a1 * a1 + b1 * b1);
+	const auto* l2 = colours.l.data();
+	const auto* a2 = colours.a.data();
+	const auto* b2 = colours.b.data();
+	const auto* c2 = colours.c.data();
+	const auto  n  = colours.size();
+
+	// The divisors only depend on [col], and dh is only needed squared
+	const float kl = col_cie_kl;
+	const float sc = 1.f + col_cie_k1 * c1;
+	const float sh = 1.f + col_cie_k2 * c1;
+	const float fl = 1.f / (kl * kl);
+	const float fc = 1.f / (sc * sc);
+	const float fh = 1.f / (sh * sh);
+
+	for (unsigned i = 0; i < n; ++i)
+	{
+		float dl  = l1 - l2[i];
+		float da  = a1 - a2[i];
+		float db  = b1 - b2[i];
+		float dc  = c1 - c2[i];
+		float dh2 = std::max(0.f, da * da + db * db - dc * dc);
+		out[i]    = dl * dl * fl + dc * dc * fc + dh2 * fh;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Writes the CIEDE2000 difference between [col] and each colour in [colours]
+// to [out]. Follows the single colour version above step by step
+// -----------------------------------------------------------------------------
+void cie::CIEDE2000(const ColLAB& col, const LABArray& colours, float* out)
+{
+	constexpr float pi       = static_cast<float>(math::PI);
+	constexpr float doublePi = 2.f * pi;
+	constexpr float pi6      = pi / 6.f;
+	constexpr float pi30     = pi / 30.f;
+	constexpr float pi2160   = 21.f * pi / 60.f;
+	constexpr float rad2deg  = 180.f / pi;
+	constexpr float deg2rad  = pi / 180.f;
+	const float     p257     = static_cast<float>(P257);
+
+	const auto  l1 = static_cast<float>(col.l);
+	const auto  a1 = static_cast<float>(col.a);
+	const auto  b1 = static_cast<float>(col.b);
+	const auto  c1 = sqrtf(a1 * a1 + b1 * b1);
+	const auto* l2 = colours.l.data();
+	const auto* a2 = colours.a.data();
+	const auto* b2 = colours.b.data();
+	const auto* c2 = colours.c.data();
+	const auto  n  = colours.size();
+	const float kl = col_cie_kl;
+	const float kc = col_cie_kc;
+	const float kh = col_cie_kh;
+
+	for (unsigned i = 0; i < n; ++i)
+	{
+		// Compute G
+		float cavg  = (c1 + c2[i]) * 0.5f;
+		float cavg2 = cavg * cavg;
+		float c7    = cavg2 * cavg2 * cavg2 * cavg;
+		float g     = 0.5f * (1.f - sqrtf(c7 / (c7 + p257)));
+
+		// Compute a', C' and h' for both colours
+		float ap1 = (1.f + g) * a1;
+		float ap2 = (1.f + g) * a2[i];
+		float cp1 = sqrtf(ap1 * ap1 + b1 * b1);
+		float cp2 = sqrtf(ap2 * ap2 + b2[i] * b2[i]);
+		float hp1 = atan2f(b1, ap1);
+		float hp2 = atan2f(b2[i], ap2);
+		hp1 += (b1 <= 0.f && (b1 != 0.f || ap1 != 0.f)) ? doublePi : 0.f;
+		hp2 += (b2[i] <= 0.f && (b2[i] != 0.f || ap2 != 0.f)) ? doublePi : 0.f;
+
+		// Compute Delta-L', Delta-C' and Delta-h'
+		float dlp     = l2[i] - l1;
+		float dcp     = cp2 - cp1;
+		float cpp     = cp1 * cp2;
+		bool  has_hue = cpp != 0.f;
+		float dhmp    = hp2 - hp1;
+		dhmp += dhmp > pi ? -doublePi : (dhmp < -pi ? doublePi : 0.f);
+		dhmp = has_hue ? dhmp : 0.f;
+
+		// Compute Delta-H'
+		float dhp = 2.f * sqrtf(cpp) * sinf(dhmp * 0.5f);
+
+		// Compute L', C' and h' averages
+		float lpavg = (l1 + l2[i]) * 0.5f;
+		float cpavg = (cp1 + cp2) * 0.5f;
+		float hpsum = hp1 + hp2;
+		float hpadj = fabsf(hp1 - hp2) > pi ? (hpsum < doublePi ? doublePi : -doublePi) : 0.f;
+		float hpavg = has_hue ? (hpsum + hpadj) * 0.5f : hpsum;
+
+		// Compute T and Delta-Theta
+		float t = 1.f - 0.17f * cosf(hpavg - pi6) + 0.24f * cosf(hpavg * 2.f) + 0.32f * cosf(hpavg * 3.f + pi30)
+				  - 0.20f * cosf(hpavg * 4.f - pi2160);
+		float dtdegree = hpavg * rad2deg - 275.f;
+		float dt       = 30.f * expf(-dtdegree * dtdegree / 625.f);
+
+		// Compute RC, SL, SC, SH and RT
+		float cpavg2   = cpavg * cpavg;
+		float cp7      = cpavg2 * cpavg2 * cpavg2 * cpavg;
+		float rc       = 2.f * sqrtf(cp7 / (cp7 + p257));
+		float lpavg502 = (lpavg - 50.f) * (lpavg - 50.f);
+		float sl       = 1.f + (0.015f * lpavg502) / sqrtf(20.f + lpavg502);
+		float sc       = 1.f + 0.045f * cpavg;
+		float sh       = 1.f + 0.015f * cpavg * t;
+		float rt       = -sinf(2.f * dt * deg2rad) * rc;
+
+		// Delta-E (without sqrt)
+		float d1 = dlp / (kl * sl);
+		float d2 = dcp / (kc * sc);
+		float d3 = dhp / (kh * sh);
+		out[i]   = d1 * d1 + d2 * d2 + d3 * d3 + rt * d2 * d3;
+	}
+}
+
+
 #ifdef DEBUGCIEDE2000
 // This can be moved to before the "return" line in CIE::CIEDE2000() and de-commented to investigate incorrect results.
 /*	log::info(wxString::Format(	// Fun fact: this call hits the parameter limit for wx's log system. One more and it
@@ -4,7 +4,23 @@
 
 namespace slade::cie
 {
+// LAB colours stored as separate float arrays (along with the chroma of each
+// colour), for comparing one colour against many at once
+struct LABArray
+{
+	vector<float> l, a, b, c;
+
+	void     set(const ColLAB* colours, unsigned count);
+	unsigned size() const { return static_cast<unsigned>(l.size()); }
+};
+
 double CIE76(const ColLAB& col1, const ColLAB& col2);
 double CIE94(const ColLAB& col1, const ColLAB& col2);
 double CIEDE2000(const ColLAB& col1, const ColLAB& col2);
+
+// Batch versions, writing the difference between [col] and each colour in
+// [colours] to [out] (with float precision)
+void CIE76(const ColLAB& col, const LABArray& colours, float* out);
+void CIE94(const ColLAB& col, const LABArray& colours, float* out);
+void CIEDE2000(const ColLAB& col, const LABArray& colours, float* out);
 } // namespace slade::cie
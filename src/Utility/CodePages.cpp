@@ -175,3 +175,73 @@ ColRGBA codepages::ansiColor(uint8_t val)
 		val = ((val >> 4) & 7);
 	return ColRGBA(ansicolors[val][0], ansicolors[val][1], ansicolors[val][2]);
 }
+
+// -----------------------------------------------------------------------------
+// Returns true if [data] is valid UTF-8 (no overlong encodings, surrogates or
+// codepoints above U+10FFFF)
+// -----------------------------------------------------------------------------
+bool codepages::isUTF8(const uint8_t* data, unsigned size)
+{
+	unsigned pos = 0;
+	while (pos < size)
+	{
+		uint8_t c = data[pos];
+		if (c < 0x80)
+		{
+			++pos;
+			continue;
+		}
+
+		// Get sequence length and valid range of the second byte
+		unsigned len;
+		uint8_t  min = 0x80, max = 0xBF;
+		if (c >= 0xC2 && c <= 0xDF)
+			len = 2;
+		else if (c >= 0xE0 && c <= 0xEF)
+		{
+			len = 3;
+			if (c == 0xE0)
+				min = 0xA0;
+			else if (c == 0xED)
+				max = 0x9F;
+		}
+		else if (c >= 0xF0 && c <= 0xF4)
+		{
+			len = 4;
+			if (c == 0xF0)
+				min = 0x90;
+			else if (c == 0xF4)
+				max = 0x8F;
+		}
+		else
+			return false;
+
+		if (pos + len > size || data[pos + 1] < min || data[pos + 1] > max)
+			return false;
+		for (unsigned a = 2; a < len; ++a)
+			if ((data[pos + a] & 0xC0) != 0x80)
+				return false;
+
+		pos += len;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Appends [data], as 8-bit (ISO-8859-1) text, to [out] encoded as UTF-8
+// -----------------------------------------------------------------------------
+void codepages::latin1ToUTF8(const uint8_t* data, unsigned size, string& out)
+{
+	out.reserve(out.size() + size + size / 8);
+	for (unsigned a = 0; a < size; ++a)
+	{
+		if (data[a] < 0x80)
+			out.push_back(static_cast<char>(data[a]));
+		else
+		{
+			out.push_back(static_cast<char>(0xC0 | (data[a] >> 6)));
+			out.push_back(static_cast<char>(0x80 | (data[a] & 0x3F)));
+		}
+	}
+}
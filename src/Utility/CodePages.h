@@ -7,4 +7,6 @@ namespace slade::codepages
 wxString fromASCII(uint8_t val);
 wxString fromCP437(uint8_t val);
 ColRGBA  ansiColor(uint8_t val);
+bool     isUTF8(const uint8_t* data, unsigned size);
+void     latin1ToUTF8(const uint8_t* data, unsigned size, string& out);
 }; // namespace slade::codepages
@@ -32,11 +32,123 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Compression.h"
+#include "ThreadPool.h"
 #include "thirdparty/zreaders/files.h"
+#ifndef NO_ZSTD
+#include <zstd.h>
+#endif
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, compress_internal_zstd, false, CVar::Flag::Save) // For backups, undo spill files and caches
+
+namespace
+{
+// Input block size for parallel deflate. Each block is compressed separately
+// (primed with the preceding 32kb as a dictionary, as pigz does), so smaller
+// blocks allow more parallelism at the cost of slightly worse compression
+constexpr size_t DEFLATE_BLOCK_SIZE = 128 * 1024;
+constexpr size_t DEFLATE_DICT_SIZE  = 32 * 1024;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Deflates [size] bytes at [data] as a raw deflate block (primed with
+// [dict_size] bytes preceding it as a dictionary) to [out], ending with a sync
+// flush so that the next block can follow it, or with the end of stream marker
+// if it is the [last] block.
+// Returns the zlib error code (Z_OK if successful)
+// -----------------------------------------------------------------------------
+int deflateBlock(const uint8_t* data, size_t size, size_t dict_size, int level, bool last, vector<uint8_t>& out)
+{
+	z_stream strm{};
+	auto     ret = deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 9, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK)
+		return ret;
+
+	if (dict_size > 0)
+		deflateSetDictionary(&strm, data - dict_size, dict_size);
+
+	// The bound doesn't include the sync flush marker (5 bytes)
+	out.resize(deflateBound(&strm, size) + 16);
+	strm.next_in   = const_cast<Bytef*>(data);
+	strm.avail_in  = size;
+	strm.next_out  = out.data();
+	strm.avail_out = out.size();
+	ret            = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+	out.resize(strm.total_out);
+	deflateEnd(&strm);
+
+	if (last)
+		return ret == Z_STREAM_END ? Z_OK : Z_BUF_ERROR;
+	return ret == Z_OK && strm.avail_in == 0 ? Z_OK : Z_BUF_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [value] to [out] as a 32bit integer, in big or little endian
+// -----------------------------------------------------------------------------
+void write32(MemChunk& out, uint32_t value, bool big_endian)
+{
+	uint8_t bytes[4];
+	for (unsigned a = 0; a < 4; ++a)
+		bytes[a] = (value >> (big_endian ? 24 - a * 8 : a * 8)) & 0xFF;
+	out.write(bytes, 4);
+}
+
+// -----------------------------------------------------------------------------
+// Decompresses the bzip2 stream(s) in [in] with [strm], which must have its
+// output buffer set up. [flush] is called whenever the output buffer is full
+// (and at the end of each stream), and must make room for more output or
+// return false if there is none. Multiple concatenated streams (as written by
+// bzip2CompressParallel or pbzip2) are decompressed one after another.
+// Returns true if all streams were decompressed successfully
+// -----------------------------------------------------------------------------
+bool bzip2DecompressStreams(const MemChunk& in, bz_stream& strm, const std::function<bool(bz_stream&)>& flush)
+{
+	strm.next_in  = reinterpret_cast<char*>(const_cast<uint8_t*>(in.data()));
+	strm.avail_in = in.size();
+	for (unsigned streams = 0; streams == 0 || strm.avail_in > 0; ++streams)
+	{
+		if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK)
+			return false;
+
+		int ret = BZ_OK;
+		do
+		{
+			if (strm.avail_out == 0 && !flush(strm))
+				break;
+			ret = BZ2_bzDecompress(&strm);
+		} while (ret == BZ_OK && (strm.avail_out == 0 || strm.avail_in > 0));
+		BZ2_bzDecompressEnd(&strm);
+
+		// Anything following the last stream that isn't another stream is
+		// ignored
+		if (ret == BZ_DATA_ERROR_MAGIC && streams > 0)
+			return true;
+		if (ret != BZ_STREAM_END)
+			return false;
+
+		flush(strm);
+	}
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // Compression Namespace Functions
@@ -207,28 +319,223 @@ bool compression::zlibDeflate(MemChunk& in, MemChunk& out, int level)
 }
 
 // -----------------------------------------------------------------------------
-// Decompress the content of [in] as a bzip2 stream to [out]
+// Deflates the content of [in] to [out] in the same format as genericDeflate
+// (determined by [windowbits]), but with blocks of the data compressed in
+// parallel. Each block is primed with the data preceding it so compression is
+// only slightly worse than a single stream
 // -----------------------------------------------------------------------------
-bool compression::bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize)
+bool compression::genericDeflateParallel(
+	const MemChunk& in,
+	MemChunk&       out,
+	int             level,
+	int             windowbits,
+	const char*     function)
 {
-	in.seek(0, SEEK_SET);
 	out.clear();
 
-	MemoryReader  source(in);
-	FileReaderBZ2 stream(source);
-	uint8_t       buffer[4096];
-	size_t        gotten;
+	// Compress blocks (and get their checksums) in parallel
+	auto                    data     = in.data();
+	size_t                  size     = in.size();
+	size_t                  n_blocks = std::max<size_t>(1, (size + DEFLATE_BLOCK_SIZE - 1) / DEFLATE_BLOCK_SIZE);
+	bool                    gzip     = windowbits > MAX_WBITS;
+	bool                    zlib     = windowbits == 0;
+	vector<vector<uint8_t>> blocks(n_blocks);
+	vector<uLong>           checksums(n_blocks);
+	vector<int>             results(n_blocks, Z_OK);
+	threadpool::parallelFor(
+		n_blocks,
+		[&](size_t index)
+		{
+			auto offset    = index * DEFLATE_BLOCK_SIZE;
+			auto length    = std::min(DEFLATE_BLOCK_SIZE, size - offset);
+			auto dict_size = std::min(offset, DEFLATE_DICT_SIZE);
+			results[index] = deflateBlock(data + offset, length, dict_size, level, index == n_blocks - 1, blocks[index]);
+			if (gzip)
+				checksums[index] = crc32(crc32(0, nullptr, 0), data + offset, length);
+			else if (zlib)
+				checksums[index] = adler32(adler32(0, nullptr, 0), data + offset, length);
+		});
+
+	size_t total = 0;
+	for (unsigned a = 0; a < n_blocks; ++a)
+	{
+		if (results[a] != Z_OK)
+		{
+			log::error("{} error {}", function, results[a]);
+			return false;
+		}
+		total += blocks[a].size();
+	}
+	out.reserve(total + 18);
+
+	// Header
+	if (gzip)
+	{
+		uint8_t xfl        = level == 9 ? 2 : level == 1 ? 4 : 0;
+		uint8_t header[10] = { 0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, xfl, 3 };
+		out.write(header, 10);
+	}
+	else if (zlib)
+	{
+		int     flevel   = level == Z_DEFAULT_COMPRESSION || level == 6 ? 2 : level < 2 ? 0 : level < 6 ? 1 : 3;
+		int     header   = 0x7800 | (flevel << 6);
+		uint8_t bytes[2] = { 0x78, static_cast<uint8_t>((header | (31 - header % 31)) & 0xFF) };
+		out.write(bytes, 2);
+	}
+
+	// Blocks
+	for (auto& block : blocks)
+		out.write(block.data(), block.size());
+
+	// Trailer (checksum of all blocks combined, and size for gzip)
+	uLong checksum = gzip ? crc32(0, nullptr, 0) : adler32(0, nullptr, 0);
+	for (unsigned a = 0; a < n_blocks; ++a)
+	{
+		auto length = std::min(DEFLATE_BLOCK_SIZE, size - a * DEFLATE_BLOCK_SIZE);
+		checksum    = gzip ? crc32_combine(checksum, checksums[a], length) :
+		                     adler32_combine(checksum, checksums[a], length);
+	}
+	if (gzip)
+	{
+		write32(out, checksum, false);
+		write32(out, size, false);
+	}
+	else if (zlib)
+		write32(out, checksum, true);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Parallel versions of zipDeflate, gzipDeflate and zlibDeflate, see
+// genericDeflateParallel
+// -----------------------------------------------------------------------------
+bool compression::zipDeflateParallel(const MemChunk& in, MemChunk& out, int level)
+{
+	return genericDeflateParallel(in, out, level, -MAX_WBITS, "ZipDeflate");
+}
+bool compression::gzipDeflateParallel(const MemChunk& in, MemChunk& out, int level)
+{
+	return genericDeflateParallel(in, out, level, 16 + MAX_WBITS, "GZipDeflate");
+}
+bool compression::zlibDeflateParallel(const MemChunk& in, MemChunk& out, int level)
+{
+	return genericDeflateParallel(in, out, level, 0, "ZlibDeflate");
+}
+
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] directly into the [size] bytes at [out], with
+// no intermediate buffers. The stream format is determined by [windowbits] as
+// for genericInflate. If given, [written] is set to the number of bytes
+// inflated.
+// Returns false if the stream is invalid or doesn't fit in [out]
+// -----------------------------------------------------------------------------
+bool compression::genericInflateTo(const MemChunk& in, uint8_t* out, size_t size, int windowbits, size_t* written)
+{
+	z_stream strm{};
+	if (inflateInit2(&strm, windowbits == 0 ? MAX_WBITS : windowbits) != Z_OK)
+		return false;
+
+	strm.next_in   = const_cast<Bytef*>(in.data());
+	strm.avail_in  = in.size();
+	strm.next_out  = out;
+	strm.avail_out = size;
+	auto ret       = inflate(&strm, Z_FINISH);
+	if (written)
+		*written = strm.total_out;
+	inflateEnd(&strm);
+
+	return ret == Z_STREAM_END;
+}
+
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] as a zip, gzip or zlib stream directly into
+// the [size] bytes at [out], see genericInflateTo
+// -----------------------------------------------------------------------------
+bool compression::zipInflateTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written)
+{
+	return genericInflateTo(in, out, size, -MAX_WBITS, written);
+}
+bool compression::gzipInflateTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written)
+{
+	return genericInflateTo(in, out, size, 16 + MAX_WBITS, written);
+}
+bool compression::zlibInflateTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written)
+{
+	return genericInflateTo(in, out, size, 0, written);
+}
+
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] in chunks, passing each chunk of output to
+// [write] rather than keeping it all in memory. The stream format is
+// determined by [windowbits] as for genericInflate.
+// Returns false if the stream is invalid or [write] returns false
+// -----------------------------------------------------------------------------
+bool compression::genericInflateStream(const MemChunk& in, int windowbits, const ChunkWriter& write)
+{
+	z_stream strm{};
+	if (inflateInit2(&strm, windowbits == 0 ? MAX_WBITS : windowbits) != Z_OK)
+		return false;
+
+	vector<uint8_t> buffer(CHUNK * 16);
+	strm.next_in  = const_cast<Bytef*>(in.data());
+	strm.avail_in = in.size();
+	int ret;
 	do
 	{
-		gotten = stream.Read(buffer, 4096);
-		if (gotten > 0)
-			out.write(buffer, gotten);
-	} while (gotten == 4096 && stream.Status == BZ_OK);
+		strm.next_out  = buffer.data();
+		strm.avail_out = buffer.size();
+		ret            = inflate(&strm, Z_NO_FLUSH);
+		if (ret != Z_OK && ret != Z_STREAM_END)
+			break;
+
+		auto have = buffer.size() - strm.avail_out;
+		if (have > 0 && !write(buffer.data(), have))
+		{
+			ret = Z_ERRNO;
+			break;
+		}
+	} while (ret == Z_OK && (strm.avail_in > 0 || strm.avail_out == 0));
+	inflateEnd(&strm);
+
+	return ret == Z_STREAM_END;
+}
+
+// -----------------------------------------------------------------------------
+// Inflates the content of [in] as a gzip stream in chunks, see
+// genericInflateStream
+// -----------------------------------------------------------------------------
+bool compression::gzipInflateStream(const MemChunk& in, const ChunkWriter& write)
+{
+	return genericInflateStream(in, 16 + MAX_WBITS, write);
+}
+
+// -----------------------------------------------------------------------------
+// Decompress the content of [in] as a bzip2 stream to [out]
+// -----------------------------------------------------------------------------
+bool compression::bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize)
+{
+	out.clear();
+	if (maxsize)
+		out.reserve(maxsize);
+
+	uint8_t   buffer[CHUNK * 4];
+	bz_stream strm{};
+	strm.next_out  = reinterpret_cast<char*>(buffer);
+	strm.avail_out = sizeof(buffer);
+	auto flush     = [&](bz_stream& stream)
+	{
+		out.write(buffer, sizeof(buffer) - stream.avail_out);
+		stream.next_out  = reinterpret_cast<char*>(buffer);
+		stream.avail_out = sizeof(buffer);
+		return true;
+	};
+	auto ok = bzip2DecompressStreams(in, strm, flush);
 
 	if (maxsize && out.size() != maxsize)
 		log::warning("bzip2 stream inflated to {}, expected {}", out.size(), maxsize);
 
-	return (stream.Status == BZ_OK || stream.Status == BZ_STREAM_END);
+	return ok;
 }
 
 // -----------------------------------------------------------------------------
@@ -260,23 +567,286 @@ bool compression::bzip2Compress(MemChunk& in, MemChunk& out)
 	return (ok == BZ_OK);
 }
 
+// -----------------------------------------------------------------------------
+// Decompress the content of [in] as a bzip2 stream directly into the [size]
+// bytes at [out]. If given, [written] is set to the number of bytes
+// decompressed.
+// Returns false if the stream is invalid or doesn't fit in [out]
+// -----------------------------------------------------------------------------
+bool compression::bzip2DecompressTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written)
+{
+	bz_stream strm{};
+	strm.next_out  = reinterpret_cast<char*>(out);
+	strm.avail_out = size;
+	auto ok        = bzip2DecompressStreams(in, strm, [](bz_stream&) { return false; });
+	if (written)
+		*written = size - strm.avail_out;
+
+	return ok;
+}
+
+// -----------------------------------------------------------------------------
+// Decompress the content of [in] as a bzip2 stream in chunks, passing each
+// chunk of output to [write] rather than keeping it all in memory.
+// Returns false if the stream is invalid or [write] returns false
+// -----------------------------------------------------------------------------
+bool compression::bzip2DecompressStream(const MemChunk& in, const ChunkWriter& write)
+{
+	vector<uint8_t> buffer(CHUNK * 16);
+	bz_stream       strm{};
+	bool            aborted = false;
+	strm.next_out           = reinterpret_cast<char*>(buffer.data());
+	strm.avail_out          = buffer.size();
+	auto flush              = [&](bz_stream& stream)
+	{
+		auto have = buffer.size() - stream.avail_out;
+		if (have > 0 && !write(buffer.data(), have))
+		{
+			aborted = true;
+			return false;
+		}
+		stream.next_out  = reinterpret_cast<char*>(buffer.data());
+		stream.avail_out = buffer.size();
+		return true;
+	};
+
+	return bzip2DecompressStreams(in, strm, flush) && !aborted;
+}
+
+// -----------------------------------------------------------------------------
+// Compress the content of [in] to [out] as a series of bzip2 streams, one per
+// [level] * 100kb block of the data, compressed in parallel (as pbzip2 does).
+// The streams are decompressed in sequence by bzip2Decompress and most other
+// bzip2 tools
+// -----------------------------------------------------------------------------
+bool compression::bzip2CompressParallel(const MemChunk& in, MemChunk& out, int level)
+{
+	out.clear();
+
+	// Compress blocks in parallel
+	auto                 data       = in.data();
+	size_t               size       = in.size();
+	size_t               block_size = 100000 * level;
+	size_t               n_blocks   = std::max<size_t>(1, (size + block_size - 1) / block_size);
+	vector<vector<char>> streams(n_blocks);
+	vector<int>          results(n_blocks, BZ_OK);
+	threadpool::parallelFor(
+		n_blocks,
+		[&](size_t index)
+		{
+			auto     offset      = index * block_size;
+			auto     length      = std::min(block_size, size - offset);
+			unsigned stream_size = length + (length >> 6) + 1024;
+			char     empty       = 0; // Source can't be null, even when empty
+			streams[index].resize(stream_size);
+			results[index] = BZ2_bzBuffToBuffCompress(
+				streams[index].data(),
+				&stream_size,
+				length > 0 ? reinterpret_cast<char*>(const_cast<uint8_t*>(data + offset)) : &empty,
+				length,
+				level,
+				0,
+				0);
+			streams[index].resize(stream_size);
+		});
+
+	size_t total = 0;
+	for (unsigned a = 0; a < n_blocks; ++a)
+	{
+		if (results[a] != BZ_OK)
+			return false;
+		total += streams[a].size();
+	}
+
+	out.reserve(total);
+	for (auto& stream : streams)
+		out.write(stream.data(), stream.size());
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Decompress the content of [in] as an LZMA stream to [out]
 // -----------------------------------------------------------------------------
 bool compression::lzmaDecompress(MemChunk& in, MemChunk& out, size_t size)
 {
-	in.seek(0, SEEK_SET);
 	out.clear();
+	if (size == 0)
+		return true;
+
+	// Decompress straight into [out]
+	if (!out.reSize(size, false) || !lzmaDecompressTo(in, out.data(), size))
+	{
+		out.clear();
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Decompress the content of [in] as an LZMA stream directly into the [size]
+// bytes at [out]
+// -----------------------------------------------------------------------------
+bool compression::lzmaDecompressTo(MemChunk& in, uint8_t* out, size_t size)
+{
+	in.seek(0, SEEK_SET);
 
 	MemoryReader   source(in);
 	FileReaderLZMA stream(source, size, true);
-	uint8_t*       cache = new uint8_t[size];
-	if (stream.Read(cache, size))
+	return stream.Read(out, size) != 0;
+}
+
+// -----------------------------------------------------------------------------
+// Compress the content of [in] as a zstd frame to [out], at compression
+// [level] (1-19, or negative for faster, lz4-like compression)
+// -----------------------------------------------------------------------------
+bool compression::zstdCompress(const MemChunk& in, MemChunk& out, int level)
+{
+	out.clear();
+
+#ifndef NO_ZSTD
+	vector<uint8_t> buffer(ZSTD_compressBound(in.size()));
+	auto            size = ZSTD_compress(buffer.data(), buffer.size(), in.data(), in.size(), level);
+	if (ZSTD_isError(size))
 	{
-		out.write(cache, size);
-		delete[] cache;
-		return true;
+		log::error("zstd compression failed: {}", ZSTD_getErrorName(size));
+		return false;
 	}
-	delete[] cache;
+
+	return out.importMem(buffer.data(), size);
+#else
+	log::error("zstd compression failed: SLADE was built without zstd support");
 	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Decompress the content of [in] as (one or more) zstd frames to [out]
+// -----------------------------------------------------------------------------
+bool compression::zstdDecompress(const MemChunk& in, MemChunk& out, size_t maxsize)
+{
+	out.clear();
+
+#ifndef NO_ZSTD
+	// The decompressed size is usually stored in the frame header, if so the
+	// data can be decompressed straight into [out]
+	auto size = ZSTD_getFrameContentSize(in.data(), in.size());
+	if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR && size > 0 && size <= 0xFFFFFFFF
+		&& ZSTD_findFrameCompressedSize(in.data(), in.size()) == in.size())
+	{
+		if (!out.reSize(size, false) || !zstdDecompressTo(in, out.data(), size))
+		{
+			out.clear();
+			return false;
+		}
+	}
+	else
+	{
+		auto dctx = ZSTD_createDCtx();
+		if (maxsize)
+			out.reserve(maxsize);
+
+		ZSTD_inBuffer   input = { in.data(), in.size(), 0 };
+		vector<uint8_t> buffer(ZSTD_DStreamOutSize());
+		size_t          ret = 0;
+		while (input.pos < input.size)
+		{
+			ZSTD_outBuffer output = { buffer.data(), buffer.size(), 0 };
+			ret                   = ZSTD_decompressStream(dctx, &output, &input);
+			if (ZSTD_isError(ret))
+				break;
+			out.write(buffer.data(), output.pos);
+		}
+		ZSTD_freeDCtx(dctx);
+
+		if (ZSTD_isError(ret) || ret != 0)
+		{
+			log::error("zstd decompression failed: {}", ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "truncated data");
+			return false;
+		}
+	}
+
+	if (maxsize && out.size() != maxsize)
+		log::warning("zstd stream decompressed to {}, expected {}", out.size(), maxsize);
+
+	return true;
+#else
+	log::error("zstd decompression failed: SLADE was built without zstd support");
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Decompress the content of [in] as (one or more) zstd frames directly into
+// the [size] bytes at [out]. If given, [written] is set to the number of bytes
+// decompressed.
+// Returns false if the data is invalid or doesn't fit in [out]
+// -----------------------------------------------------------------------------
+bool compression::zstdDecompressTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written)
+{
+#ifndef NO_ZSTD
+	auto ret = ZSTD_decompress(out, size, in.data(), in.size());
+	if (ZSTD_isError(ret))
+		return false;
+
+	if (written)
+		*written = ret;
+	return true;
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if [data] begins with a zstd frame
+// -----------------------------------------------------------------------------
+bool compression::isZstd(const MemChunk& data)
+{
+	return data.size() >= 4 && data.readL32(0) == 0xFD2FB528;
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if internal-only data (backups, undo spill files and caches)
+// should be compressed with zstd
+// -----------------------------------------------------------------------------
+bool compression::zstdInternal()
+{
+#ifndef NO_ZSTD
+	return compress_internal_zstd;
+#else
+	return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Compresses internal-only [data] in place with (fast) zstd compression if it
+// is enabled, otherwise leaves it as-is
+// -----------------------------------------------------------------------------
+bool compression::compressInternal(MemChunk& data)
+{
+	if (!zstdInternal() || data.size() == 0)
+		return true;
+
+	MemChunk compressed;
+	if (!zstdCompress(data, compressed, 1))
+		return false;
+
+	return data.importShared(compressed);
+}
+
+// -----------------------------------------------------------------------------
+// Decompresses internal-only [data] in place if it was compressed by
+// compressInternal
+// -----------------------------------------------------------------------------
+bool compression::decompressInternal(MemChunk& data)
+{
+	if (!isZstd(data))
+		return true;
+
+	MemChunk decompressed;
+	if (!zstdDecompress(data, decompressed))
+		return false;
+
+	return data.importShared(decompressed);
 }
@@ -15,4 +15,37 @@ bool zipUnshrink(MemChunk& in, MemChunk& out, size_t maxsize);
 bool bzip2Decompress(MemChunk& in, MemChunk& out, size_t maxsize = 0);
 bool bzip2Compress(MemChunk& in, MemChunk& out);
 bool lzmaDecompress(MemChunk& in, MemChunk& out, size_t size);
-} // namespace slade::compression
+
+// Block-parallel compression
+bool genericDeflateParallel(const MemChunk& in, MemChunk& out, int level, int windowbits, const char* function);
+bool gzipDeflateParallel(const MemChunk& in, MemChunk& out, int level = -1);
+bool zipDeflateParallel(const MemChunk& in, MemChunk& out, int level = -1);
+bool zlibDeflateParallel(const MemChunk& in, MemChunk& out, int level = -1);
+bool bzip2CompressParallel(const MemChunk& in, MemChunk& out, int level = 9);
+
+// Decompression directly into a buffer of known size
+bool genericInflateTo(const MemChunk& in, uint8_t* out, size_t size, int windowbits, size_t* written = nullptr);
+bool gzipInflateTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written = nullptr);
+bool zipInflateTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written = nullptr);
+bool zlibInflateTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written = nullptr);
+bool bzip2DecompressTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written = nullptr);
+bool lzmaDecompressTo(MemChunk& in, uint8_t* out, size_t size);
+
+// Streaming decompression, [write] is given each chunk of output as it is
+// decompressed (and can return false to stop)
+using ChunkWriter = std::function<bool(const uint8_t* data, size_t size)>;
+bool genericInflateStream(const MemChunk& in, int windowbits, const ChunkWriter& write);
+bool gzipInflateStream(const MemChunk& in, const ChunkWriter& write);
+bool bzip2DecompressStream(const MemChunk& in, const ChunkWriter& write);
+
+// Zstandard (not available if built with NO_ZSTD)
+bool zstdCompress(const MemChunk& in, MemChunk& out, int level = 3);
+bool zstdDecompress(const MemChunk& in, MemChunk& out, size_t maxsize = 0);
+bool zstdDecompressTo(const MemChunk& in, uint8_t* out, size_t size, size_t* written = nullptr);
+bool isZstd(const MemChunk& data);
+
+// Compression of internal-only data (backups, undo spill files, caches)
+bool zstdInternal();
+bool compressInternal(MemChunk& data);
+bool decompressInternal(MemChunk& data);
+}// namespace slade::compression
@@ -7,8 +7,9 @@
 // Web:         http://slade.mancubus.net
 // Filename:    FileMonitor.cpp
 // Description: FileMonitor class, keeps track of a file and checks it for any
-//              modifications every second, also tracks an external process, and
-//              deletes itself when this process is terminated.
+//              modifications when the OS reports a change to it (or every
+//              second if it can't be watched), also tracks an external
+//              process, and deletes itself when this process is terminated.
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -38,10 +39,139 @@
 #include "FileUtils.h"
 #include "StringUtils.h"
 #include <filesystem>
+#include <wx/fswatcher.h>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+constexpr int POLL_INTERVAL  = 1000; // Interval to check unwatched files for changes (ms)
+constexpr int CHANGE_DELAY   = 250;  // Delay after a change is reported before checking the file (ms)
+constexpr int WATCHED_EVENTS = wxFSW_EVENT_CREATE | wxFSW_EVENT_MODIFY | wxFSW_EVENT_RENAME;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// FileWatcher Class
+//
+// Watches the directories of all monitored files with a single (shared)
+// wxFileSystemWatcher, which uses the native OS change notifications, and
+// passes on changes to the FileMonitors for the changed files. Directories are
+// watched rather than the files themselves, since many programs save files by
+// replacing them
+// -----------------------------------------------------------------------------
+namespace
+{
+class FileWatcher : public wxEvtHandler
+{
+public:
+	FileWatcher() : watcher_{ std::make_unique<wxFileSystemWatcher>() }
+	{
+		watcher_->SetOwner(this);
+		Bind(wxEVT_FSWATCHER, &FileWatcher::onFileSystemEvent, this);
+	}
+
+	~FileWatcher() override { watcher_->RemoveAll(); }
+
+	// Returns [fn] as a normalized absolute path, for comparing paths
+	static string normalizedPath(wxFileName fn)
+	{
+		fn.Normalize(wxPATH_NORM_ABSOLUTE | wxPATH_NORM_DOTS | wxPATH_NORM_CASE);
+		return fn.GetFullPath().ToStdString();
+	}
+
+	// Starts watching [path] for [monitor], returns false if it can't be watched
+	bool add(FileMonitor* monitor, const string& path)
+	{
+		auto dir   = wxFileName(path).GetPath();
+		auto count = dirs_.find(dir);
+		if (count == dirs_.end())
+		{
+			// Watching can fail if eg. the system's watch limit is reached
+			wxLogNull no_log;
+			if (!watcher_->Add(wxFileName::DirName(dir), WATCHED_EVENTS))
+				return false;
+
+			count = dirs_.emplace(dir, 0).first;
+		}
+
+		++count->second;
+		monitors_.emplace(path, monitor);
+		return true;
+	}
+
+	// Stops watching [path] for [monitor]
+	void remove(FileMonitor* monitor, const string& path)
+	{
+		auto range = monitors_.equal_range(path);
+		for (auto i = range.first; i != range.second; ++i)
+		{
+			if (i->second == monitor)
+			{
+				monitors_.erase(i);
+				break;
+			}
+		}
+
+		auto dir   = wxFileName(path).GetPath();
+		auto count = dirs_.find(dir);
+		if (count != dirs_.end() && --count->second == 0)
+		{
+			wxLogNull no_log;
+			watcher_->Remove(wxFileName::DirName(dir));
+			dirs_.erase(count);
+		}
+	}
+
+private:
+	unique_ptr<wxFileSystemWatcher>     watcher_;
+	std::map<wxString, unsigned>        dirs_; // Watched dir -> number of monitored files in it
+	std::multimap<string, FileMonitor*> monitors_;
+
+	void onFileSystemEvent(wxFileSystemWatcherEvent& e)
+	{
+		// Notifications may have been lost, check all files
+		if (e.GetChangeType() == wxFSW_EVENT_WARNING)
+		{
+			for (auto& monitor : monitors_)
+				monitor.second->fileChanged();
+			return;
+		}
+
+		// Watching failed, fall back to polling all files
+		if (e.GetChangeType() == wxFSW_EVENT_ERROR)
+		{
+			auto monitors = monitors_;
+			for (auto& monitor : monitors)
+				monitor.second->fallBackToPolling();
+			return;
+		}
+
+		changed(e.GetPath());
+		if (e.GetChangeType() == wxFSW_EVENT_RENAME)
+			changed(e.GetNewPath());
+	}
+
+	void changed(const wxFileName& fn)
+	{
+		auto range = monitors_.equal_range(normalizedPath(fn));
+		for (auto i = range.first; i != range.second; ++i)
+			i->second->fileChanged();
+	}
+};
+
+// Created when first needed, stays alive until the program exits
+FileWatcher* file_watcher = nullptr;
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // FileMonitor Class Fucntions
@@ -57,17 +187,74 @@ FileMonitor::FileMonitor(string_view filename, bool start) : filename_{ filename
 	// Create process
 	process_ = std::make_unique<wxProcess>(this);
 
-	// Start timer (updates every 1 sec)
+	// Start monitoring the file
 	if (start)
-	{
-		file_modified_ = fileutil::fileModifiedTime(filename);
-		wxTimer::Start(1000);
-	}
+		startMonitoring();
 
 	// Bind events
 	Bind(wxEVT_END_PROCESS, &FileMonitor::onEndProcess, this);
 }
 
+// -----------------------------------------------------------------------------
+// FileMonitor class destructor
+// -----------------------------------------------------------------------------
+FileMonitor::~FileMonitor()
+{
+	unwatch();
+}
+
+// -----------------------------------------------------------------------------
+// Starts monitoring the file for modifications, via the shared file watcher if
+// possible, otherwise by checking it every second
+// -----------------------------------------------------------------------------
+void FileMonitor::startMonitoring()
+{
+	unwatch();
+	file_modified_ = fileutil::fileModifiedTime(filename_);
+
+	if (!file_watcher)
+		file_watcher = new FileWatcher();
+
+	auto path = FileWatcher::normalizedPath(wxFileName(filename_));
+	if (file_watcher->add(this, path))
+		watched_path_ = path;
+	else
+	{
+		log::warning("Unable to watch file {} for changes, checking it every second instead", filename_);
+		wxTimer::Start(POLL_INTERVAL);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Stops watching the file and checks it every second instead
+// -----------------------------------------------------------------------------
+void FileMonitor::fallBackToPolling()
+{
+	unwatch();
+	wxTimer::Start(POLL_INTERVAL);
+}
+
+// -----------------------------------------------------------------------------
+// Stops watching the file for changes (if it is being watched)
+// -----------------------------------------------------------------------------
+void FileMonitor::unwatch()
+{
+	if (watched_path_.empty())
+		return;
+
+	file_watcher->remove(this, watched_path_);
+	watched_path_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Called when the file has (possibly) been changed, checks it after a short
+// delay (restarted on each change, so the file isn't read while being written)
+// -----------------------------------------------------------------------------
+void FileMonitor::fileChanged()
+{
+	wxTimer::StartOnce(CHANGE_DELAY);
+}
+
 // -----------------------------------------------------------------------------
 // Override of wxTimer::Notify, called each time the timer updates
 // -----------------------------------------------------------------------------
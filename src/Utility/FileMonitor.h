@@ -4,11 +4,15 @@ namespace slade
 {
 class Archive;
 
+// Keeps track of a file and checks it for modifications when the OS reports
+// that it has changed (or every second, if it can't be watched). The timer is
+// used to check the file shortly after a change is reported, so that it isn't
+// read while still being written
 class FileMonitor : public wxTimer
 {
 public:
 	FileMonitor(string_view filename, bool start = true);
-	virtual ~FileMonitor() = default;
+	virtual ~FileMonitor();
 
 	wxProcess*    process() const { return process_.get(); }
 	const string& filename() const { return filename_; }
@@ -16,15 +20,23 @@ public:
 	virtual void fileModified() {}
 	virtual void processTerminated() {}
 
+	void fileChanged();
+	void fallBackToPolling();
+
 	void Notify() override;
 	void onEndProcess(wxProcessEvent& e);
 
 protected:
 	string filename_;
-	time_t file_modified_;
+	time_t file_modified_ = 0;
+
+	void startMonitoring();
 
 private:
 	unique_ptr<wxProcess> process_;
+	string                watched_path_; // Empty if not being watched (is polled instead)
+
+	void unwatch();
 };
 
 class DB2MapFileMonitor : public FileMonitor
@@ -35,6 +35,13 @@
 #include "FileUtils.h"
 #include <filesystem>
 #include <fstream>
+#ifdef __WXMSW__
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace slade;
 namespace fs = std::filesystem;
@@ -70,7 +77,7 @@ bool fileutil::dirExists(string_view path)
 // -----------------------------------------------------------------------------
 bool fileutil::removeFile(string_view path)
 {
-	static std::error_code ec;
+	std::error_code ec;
 	if (!fs::remove(path, ec))
 	{
 		log::warning("Unable to remove file \"{}\": {}", path, ec.message());
@@ -86,8 +93,8 @@ bool fileutil::removeFile(string_view path)
 // -----------------------------------------------------------------------------
 bool fileutil::copyFile(string_view from, string_view to, bool overwrite)
 {
-	static std::error_code ec;
-	auto                   options = overwrite ? fs::copy_options::overwrite_existing : fs::copy_options::none;
+	std::error_code ec;
+	auto            options = overwrite ? fs::copy_options::overwrite_existing : fs::copy_options::none;
 	if (!fs::copy_file(from, to, options, ec))
 	{
 		log::warning("Unable to copy file from \"{}\" to \"{}\": {}", from, to, ec.message());
@@ -324,3 +331,121 @@ bool SFile::writeStr(string_view str) const
 
 	return false;
 }
+
+
+
+// -----------------------------------------------------------------------------
+//
+// MappedFile Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Maps the file at [path] into memory.
+// Returns false if the file couldn't be opened or mapped, or is empty
+// -----------------------------------------------------------------------------
+bool MappedFile::open(string_view path)
+{
+	// Needs to be closed first if already open
+	if (data_)
+		return false;
+
+#ifdef __WXMSW__
+	auto wpath = fs::path{ path }.wstring();
+	file_handle_ = CreateFileW(
+		wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle_ == INVALID_HANDLE_VALUE)
+	{
+		file_handle_ = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart == 0 || file_size.HighPart != 0)
+	{
+		close();
+		return false;
+	}
+
+	map_handle_ = CreateFileMappingW(file_handle_, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (!map_handle_)
+	{
+		close();
+		return false;
+	}
+
+	data_ = static_cast<uint8_t*>(MapViewOfFile(map_handle_, FILE_MAP_COPY, 0, 0, 0));
+	if (!data_)
+	{
+		close();
+		return false;
+	}
+
+	size_ = file_size.LowPart;
+#else
+	auto fd = ::open(string{ path }.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0 || file_stat.st_size > 0xFFFFFFFF)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// Private mapping, so any writes are copy-on-write and never hit the file
+	auto mapped = mmap(nullptr, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapped == MAP_FAILED)
+		return false;
+
+	data_ = static_cast<uint8_t*>(mapped);
+	size_ = static_cast<unsigned>(file_stat.st_size);
+#endif
+
+	path_ = path;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Unmaps the file
+// -----------------------------------------------------------------------------
+void MappedFile::close()
+{
+#ifdef __WXMSW__
+	if (data_)
+		UnmapViewOfFile(data_);
+	if (map_handle_)
+		CloseHandle(map_handle_);
+	if (file_handle_)
+		CloseHandle(file_handle_);
+	map_handle_  = nullptr;
+	file_handle_ = nullptr;
+#else
+	if (data_)
+		munmap(data_, size_);
+#endif
+
+	data_ = nullptr;
+	size_ = 0;
+	path_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Returns a new MappedFile for the file at [path], or nullptr if it couldn't be
+// mapped
+// -----------------------------------------------------------------------------
+shared_ptr<MappedFile> MappedFile::map(string_view path)
+{
+	auto file = std::make_shared<MappedFile>();
+	if (!file->open(path))
+	{
+		log::warning("Unable to memory-map file \"{}\"", path);
+		return nullptr;
+	}
+
+	return file;
+}
@@ -55,4 +55,38 @@ private:
 	FILE*       handle_ = nullptr;
 	struct stat stat_;
 };
+
+// A read-only view of a file's contents, mapped into memory. The mapping is
+// private (copy-on-write), so writing to the mapped data will never modify the
+// file on disk.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(string_view path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool          isOpen() const { return data_ != nullptr; }
+	const string& path() const { return path_; }
+	uint8_t*      data() const { return data_; }
+	unsigned      size() const { return size_; }
+
+	bool open(string_view path);
+	void close();
+
+	static shared_ptr<MappedFile> map(string_view path);
+
+private:
+	string   path_;
+	uint8_t* data_ = nullptr;
+	unsigned size_ = 0;
+
+#ifdef __WXMSW__
+	void* file_handle_ = nullptr;
+	void* map_handle_  = nullptr;
+#endif
+};
 } // namespace slade
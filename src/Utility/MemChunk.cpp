@@ -34,10 +34,22 @@
 #include "MemChunk.h"
 #include "FileUtils.h"
 #include "General/Misc.h"
+#include <atomic>
 
 using namespace slade;
 
 
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+std::atomic<uint64_t> n_allocations{ 0 };
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // MemChunk Class Functions
@@ -72,7 +84,7 @@ MemChunk::MemChunk(const uint8_t* data, uint32_t size) : size_{ size }
 MemChunk::~MemChunk()
 {
 	// Free memory
-	delete[] data_;
+	freeData();
 }
 
 // -----------------------------------------------------------------------------
@@ -83,22 +95,32 @@ bool MemChunk::hasData() const
 	return size_ > 0 && data_;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the offset of the data within the mapped file, if the MemChunk is a
+// view into a memory-mapped file (0 otherwise)
+// -----------------------------------------------------------------------------
+uint32_t MemChunk::mappedOffset() const
+{
+	return mapping_ ? static_cast<uint32_t>(data_ - mapping_->data()) : 0;
+}
+
 // -----------------------------------------------------------------------------
 // Deletes the memory chunk.
 // Returns false if no data exists, true otherwise.
 // -----------------------------------------------------------------------------
 bool MemChunk::clear()
 {
-	if (hasData())
+	bool had_data = hasData();
+
+	if (data_)
 	{
-		delete[] data_;
-		data_    = nullptr;
-		size_    = 0;
-		cur_ptr_ = 0;
-		return true;
+		freeData();
+		data_ = nullptr;
 	}
+	size_    = 0;
+	cur_ptr_ = 0;
 
-	return false;
+	return had_data;
 }
 
 // -----------------------------------------------------------------------------
@@ -114,28 +136,31 @@ bool MemChunk::reSize(uint32_t new_size, bool preserve_data)
 		return false;
 	}
 
+	if (!preserve_data)
+		cur_ptr_ = 0;
+
+	// Resize in place if the new size fits in the allocated memory (unless
+	// it is shrinking to much less than it, in which case the memory is freed)
+	if (canWriteInPlace() && new_size <= capacity_ && new_size >= capacity_ / 2)
+	{
+		size_ = new_size;
+		if (cur_ptr_ > size_)
+			cur_ptr_ = size_;
+
+		return true;
+	}
+
 	// Attempt to allocate memory for new size
 	auto ndata = allocData(new_size, false);
 	if (!ndata)
 		return false;
 
 	// Preserve existing data if specified
-	if (!preserve_data)
-	{
-		clear();
-		data_ = ndata;
-	}
-	else if (data_ != nullptr)
-	{
-		memcpy(ndata, data_, size_ * sizeof(uint8_t));
-		delete[] data_;
-		data_ = ndata;
-	}
-	else
-	{
-		memset(ndata, 0, size_ * sizeof(uint8_t));
-		data_ = ndata;
-	}
+	if (preserve_data && data_ != nullptr)
+		memcpy(ndata, data_, std::min(size_, new_size) * sizeof(uint8_t));
+	freeData();
+	data_     = ndata;
+	capacity_ = new_size;
 
 	// Update variables
 	size_ = new_size;
@@ -147,6 +172,36 @@ bool MemChunk::reSize(uint32_t new_size, bool preserve_data)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Allocates memory for at least [capacity] bytes of data, so that the data can
+// be written or resized up to that size without reallocating.
+// Data that is shared or a view into a memory-mapped file is copied.
+// Returns false if the memory couldn't be allocated, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::reserve(uint32_t capacity)
+{
+	if (capacity <= capacity_ && canWriteInPlace())
+		return true;
+
+	capacity = std::max(capacity, size_);
+	if (capacity == 0)
+		return true;
+
+	// Attempt to allocate memory for new capacity
+	auto ndata = allocData(capacity, false);
+	if (!ndata)
+		return false;
+
+	// Copy existing data
+	if (data_)
+		memcpy(ndata, data_, size_);
+	freeData();
+	data_     = ndata;
+	capacity_ = capacity;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Loads a file (or part of it) into the MemChunk.
 // Returns false if file couldn't be opened, true otherwise
@@ -298,6 +353,86 @@ bool MemChunk::importMem(const uint8_t* start, uint32_t len)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Sets the MemChunk to be a view of [len] bytes at [offset] in the
+// memory-mapped [file], rather than copying the data.
+// The data is only copied ('detached') when the MemChunk is written to or
+// resized
+// -----------------------------------------------------------------------------
+bool MemChunk::importMapped(const shared_ptr<MappedFile>& file, uint32_t offset, uint32_t len)
+{
+	// Check the mapping and requested range are valid
+	if (!file || !file->isOpen() || offset + len > file->size() || offset + len < offset)
+		return false;
+
+	// Clear current data if it exists
+	clear();
+
+	if (len > 0)
+	{
+		mapping_ = file;
+		data_    = file->data() + offset;
+		size_    = len;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Makes the MemChunk share the data of [other] rather than copying it. The
+// data is only copied when either MemChunk is written to or resized (or its
+// data is accessed non-const).
+// Data that is a view into a memory-mapped file is copied instead, since it
+// can be written to in place
+// -----------------------------------------------------------------------------
+bool MemChunk::importShared(MemChunk& other)
+{
+	if (&other == this)
+		return true;
+
+	if (other.isMapped())
+		return importMem(other.data_, other.size_);
+
+	// Clear current data if it exists
+	clear();
+
+	if (!other.hasData())
+		return true;
+
+	// Hand ownership of the other MemChunk's data to a shared buffer
+	if (!other.shared_)
+		other.shared_.reset(other.data_);
+
+	shared_   = other.shared_;
+	data_     = other.data_;
+	size_     = other.size_;
+	capacity_ = other.capacity_;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// If the MemChunk is a view into a memory-mapped file or shares its data with
+// other MemChunks, copies the data into memory owned by the MemChunk.
+// Returns false if the data couldn't be copied
+// -----------------------------------------------------------------------------
+bool MemChunk::detach()
+{
+	if (!mapping_)
+		return shared_.use_count() > 1 ? unshare() : true;
+
+	auto ndata = allocData(size_, false);
+	if (!ndata)
+		return false;
+
+	memcpy(ndata, data_, size_);
+	mapping_.reset();
+	data_     = ndata;
+	capacity_ = size_;
+
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 // Writes the MemChunk data to a new file of [filename], starting from [start]
 // to [start+size].
@@ -366,14 +501,16 @@ bool MemChunk::write(unsigned offset, const void* data, unsigned size, bool expa
 	if (!data)
 		return false;
 
+	// Copy mapped data before modifying it
+	if (!detach())
+		return false;
+
 	// If we're trying to write past the end of the memory chunk,
-	// resize it so we can write at this point
+	// expand it so we can write at this point
 	// (or return false if expanding is disallowed)
 	if (offset + size > size_)
 	{
-		if (expand)
-			reSize(offset + size, true);
-		else
+		if (!expand || !this->expand(offset + size))
 			return false;
 	}
 
@@ -415,10 +552,14 @@ bool MemChunk::write(const void* buffer, uint32_t count)
 	if (!buffer)
 		return false;
 
+	// Copy mapped data before modifying it
+	if (!detach())
+		return false;
+
 	// If we're trying to write past the end of the memory chunk,
-	// resize it so we can write at this point
-	if (cur_ptr_ + count > size_)
-		reSize(cur_ptr_ + count, true);
+	// expand it so we can write at this point
+	if (cur_ptr_ + count > size_ && !expand(cur_ptr_ + count))
+		return false;
 
 	// Write the data and move to the byte after what was written
 	memcpy(data_ + cur_ptr_, buffer, count);
@@ -529,10 +670,10 @@ bool MemChunk::readMC(MemChunk& mc, uint32_t size)
 // Overwrites all data bytes with [val] (basically is memset).
 // Returns false if no data exists, true otherwise
 // -----------------------------------------------------------------------------
-bool MemChunk::fillData(uint8_t val) const
+bool MemChunk::fillData(uint8_t val)
 {
 	// Check data exists
-	if (!hasData())
+	if (!hasData() || !detach())
 		return false;
 
 	// Fill data with value
@@ -551,6 +692,14 @@ uint32_t MemChunk::crc() const
 	return hasData() ? misc::crc(data_, size_) : 0;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the total number of data allocations made by all MemChunks so far
+// -----------------------------------------------------------------------------
+uint64_t MemChunk::allocationCount()
+{
+	return n_allocations.load(std::memory_order_relaxed);
+}
+
 
 // -----------------------------------------------------------------------------
 // Allocates [size] bytes of data and returns it, or null if the allocation
@@ -578,8 +727,72 @@ uint8_t* MemChunk::allocData(uint32_t size, bool set_data)
 		return nullptr;
 	}
 
+	n_allocations.fetch_add(1, std::memory_order_relaxed);
 	if (set_data)
-		data_ = ndata;
+	{
+		data_     = ndata;
+		capacity_ = size;
+	}
 
 	return ndata;
 }
+
+// -----------------------------------------------------------------------------
+// Frees the current data, or releases the file mapping if the data is a view
+// into a memory-mapped file (or the shared buffer if it is shared)
+// -----------------------------------------------------------------------------
+void MemChunk::freeData()
+{
+	if (mapping_)
+		mapping_.reset();
+	else if (shared_)
+		shared_.reset();
+	else
+		delete[] data_;
+
+	capacity_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Copies shared data into memory owned only by this MemChunk.
+// Returns false if the data couldn't be copied
+// -----------------------------------------------------------------------------
+bool MemChunk::unshare()
+{
+	if (!shared_)
+		return true;
+
+	auto ndata = allocData(size_, false);
+	if (!ndata)
+		return false;
+
+	memcpy(ndata, data_, size_);
+	shared_.reset();
+	data_     = ndata;
+	capacity_ = size_;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Expands the data to [min_size] bytes for writing past the end of it.
+// The allocated memory grows geometrically (by half again each time), so that
+// building data with many small sequential writes doesn't copy it every time.
+// Returns false if the memory couldn't be allocated, true otherwise
+// -----------------------------------------------------------------------------
+bool MemChunk::expand(uint32_t min_size)
+{
+	if (min_size <= size_)
+		return true;
+
+	if (min_size > capacity_ || !canWriteInPlace())
+	{
+		uint64_t grow = std::max<uint64_t>(min_size, (uint64_t)size_ + size_ / 2);
+		if (!reserve(std::min<uint64_t>(grow, UINT32_MAX)))
+			return false;
+	}
+
+	size_ = min_size;
+
+	return true;
+}
@@ -5,6 +5,7 @@
 namespace slade
 {
 class SFile;
+class MappedFile;
 
 class MemChunk : public SeekableData
 {
@@ -14,14 +15,21 @@ public:
 	MemChunk(const uint8_t* data, uint32_t size);
 	~MemChunk();
 
-	uint8_t& operator[](int a) const { return data_[a]; }
+	const uint8_t& operator[](int a) const { return data_[a]; }
+	uint8_t&       operator[](int a) { return data()[a]; }
 
-	// Accessors
+	// Accessors (non-const access to shared or mapped data copies it first)
 	const uint8_t* data() const { return data_; }
-	uint8_t*       data() { return data_; }
+	uint8_t*       data()
+	{
+		if (!canWriteInPlace())
+			detach();
+		return data_;
+	}
 
 	// SeekableData
 	unsigned size() const override { return size_; }
+	unsigned capacity() const { return capacity_; }
 	unsigned currentPos() const override { return cur_ptr_; }
 	bool     seek(unsigned offset) override { return seek(offset, SEEK_CUR); }
 	bool     seekFromStart(unsigned offset) override { return seek(offset, SEEK_SET); }
@@ -30,9 +38,15 @@ public:
 	bool     write(const void* buffer, unsigned count) override;
 
 	bool hasData() const;
+	bool isMapped() const { return mapping_ != nullptr; }
+	bool isShared() const { return shared_.use_count() > 1; }
+
+	const shared_ptr<MappedFile>& mapping() const { return mapping_; }
+	uint32_t                      mappedOffset() const;
 
 	bool clear();
 	bool reSize(uint32_t new_size, bool preserve_data = true);
+	bool reserve(uint32_t capacity);
 
 	// Data import
 	bool importFile(string_view filename, uint32_t offset = 0, uint32_t len = 0);
@@ -40,6 +54,9 @@ public:
 	bool importFileStream(SFile& file, unsigned len = 0);
 	bool importMem(const uint8_t* start, uint32_t len);
 	bool importMem(const MemChunk& other) { return importMem(other.data_, other.size_); }
+	bool importMapped(const shared_ptr<MappedFile>& file, uint32_t offset, uint32_t len);
+	bool importShared(MemChunk& other);
+	bool detach();
 
 	// Data export
 	bool exportFile(string_view filename, uint32_t start = 0, uint32_t size = 0) const;
@@ -58,9 +75,12 @@ public:
 	bool readMC(MemChunk& mc, uint32_t size);
 
 	// Misc
-	bool     fillData(uint8_t val) const;
+	bool     fillData(uint8_t val);
 	uint32_t crc() const;
 
+	// Total number of data allocations made by all MemChunks (for benchmarking)
+	static uint64_t allocationCount();
+
 	// Platform-independent functions to read values in little (L##) or big (B##) endian
 	uint16_t readL16(unsigned i) const { return data_[i] + (data_[i + 1] << 8); }
 	uint32_t readL24(unsigned i) const { return data_[i] + (data_[i + 1] << 8) + (data_[i + 2] << 16); }
@@ -76,10 +96,23 @@ public:
 	}
 
 protected:
-	uint8_t* data_    = nullptr;
-	uint32_t cur_ptr_ = 0;
-	uint32_t size_    = 0;
+	uint8_t* data_     = nullptr;
+	uint32_t cur_ptr_  = 0;
+	uint32_t size_     = 0;
+	uint32_t capacity_ = 0; // Allocated size of data_ (0 if it isn't allocated by the MemChunk)
+
+	// If set, data_ points into this (copy-on-write) file mapping rather than
+	// being allocated/owned by the MemChunk
+	shared_ptr<MappedFile> mapping_;
+
+	// If set, data_ is owned by this reference-counted buffer, which can be
+	// shared (copy-on-write) with other MemChunks via importShared
+	shared_ptr<uint8_t[]> shared_;
 
 	uint8_t* allocData(uint32_t size, bool set_data = true);
+	void     freeData();
+	bool     unshare();
+	bool     canWriteInPlace() const { return !mapping_ && shared_.use_count() <= 1; }
+	bool     expand(uint32_t min_size);
 };
 } // namespace slade
@@ -0,0 +1,220 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    MemoryStats.cpp
+// Description: Memory accounting. Subsystems register counters (see
+//              MEMORY_COUNTER) that report how much memory they are holding
+//              when asked, so there is no cost until usage is requested. Usage
+//              can be shown in the console (memory_usage), the Memory Usage
+//              dialog, or exported as CSV for tracking over time
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "MemoryStats.h"
+#include "General/Console.h"
+#include "Utility/StringUtils.h"
+#include <fstream>
+
+using namespace slade;
+using namespace memstats;
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the list of all registered counters (as a function so that it exists
+// before any counters are constructed)
+// -----------------------------------------------------------------------------
+vector<Counter*>& counters()
+{
+	static vector<Counter*> list;
+	return list;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Counter Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Counter class constructor, registers the counter
+// -----------------------------------------------------------------------------
+Counter::Counter(string_view subsystem, Func func) : subsystem_{ subsystem }, func_{ func }
+{
+	counters().push_back(this);
+}
+
+// -----------------------------------------------------------------------------
+// Adds the current memory usage of the counter's subsystem to [usage]
+// -----------------------------------------------------------------------------
+void Counter::count(vector<Usage>& usage) const
+{
+	auto first = usage.size();
+	func_(usage);
+	for (auto a = first; a < usage.size(); ++a)
+		usage[a].subsystem = subsystem_;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// MemStats Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the current memory usage of all subsystems, sorted by subsystem.
+// Must be called from the main thread
+// -----------------------------------------------------------------------------
+vector<Usage> memstats::usage()
+{
+	auto sorted = counters();
+	std::stable_sort(
+		sorted.begin(),
+		sorted.end(),
+		[](const Counter* left, const Counter* right) { return left->subsystem() < right->subsystem(); });
+
+	vector<Usage> usage;
+	for (auto counter : sorted)
+		counter->count(usage);
+
+	return usage;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the total bytes of main memory (or video memory if [vram] is true)
+// in [usage]
+// -----------------------------------------------------------------------------
+uint64_t memstats::total(const vector<Usage>& usage, bool vram)
+{
+	uint64_t bytes = 0;
+	for (const auto& item : usage)
+		if (item.vram == vram)
+			bytes += item.bytes;
+
+	return bytes;
+}
+
+// -----------------------------------------------------------------------------
+// Returns [bytes] as a human-readable string
+// -----------------------------------------------------------------------------
+string memstats::sizeString(uint64_t bytes)
+{
+	if (bytes < 1024)
+		return fmt::format("{}B", bytes);
+	if (bytes < 1024 * 1024)
+		return fmt::format("{:.1f}KB", bytes / 1024.);
+	if (bytes < 1024ull * 1024 * 1024)
+		return fmt::format("{:.1f}MB", bytes / (1024. * 1024.));
+
+	return fmt::format("{:.2f}GB", bytes / (1024. * 1024. * 1024.));
+}
+
+// -----------------------------------------------------------------------------
+// Returns [usage] formatted as a table, with totals
+// -----------------------------------------------------------------------------
+string memstats::formatUsage(const vector<Usage>& usage)
+{
+	auto out = fmt::format("{:<24} {:<40} {:>8} {:>12}\n", "Subsystem", "Name", "Count", "Size");
+	for (const auto& item : usage)
+		out += fmt::format(
+			"{:<24} {:<40} {:>8} {:>12}\n",
+			item.subsystem,
+			item.name,
+			item.count > 0 ? std::to_string(item.count) : "",
+			sizeString(item.bytes) + (item.vram ? " (VRAM)" : ""));
+	out += fmt::format("Total: {} memory, {} video memory", sizeString(total(usage)), sizeString(total(usage, true)));
+
+	return out;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [usage] to [filename] as CSV, with a timestamp on each row so that
+// exports can be appended to one another for tracking
+// -----------------------------------------------------------------------------
+bool memstats::writeCSV(const vector<Usage>& usage, string_view filename)
+{
+	auto exists = wxFileExists(wxString::FromUTF8(filename.data(), filename.size()));
+
+	std::ofstream file{ string{ filename }, std::ios::app };
+	if (!file.is_open())
+	{
+		global::error = fmt::format("Unable to open file {} for writing", filename);
+		return false;
+	}
+
+	if (!exists)
+		file << "time,subsystem,name,count,bytes,vram\n";
+
+	auto time = wxDateTime::Now().FormatISOCombined(' ').ToStdString();
+	for (const auto& item : usage)
+	{
+		auto name = item.name;
+		strutil::replaceIP(name, "\"", "\"\"");
+		file << fmt::format(
+			"{},{},\"{}\",{},{},{}\n", time, item.subsystem, name, item.count, item.bytes, item.vram ? 1 : 0);
+	}
+
+	return file.good();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Shows the current memory usage of all subsystems. Usage:
+// memory_usage [csv file to append to]
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(memory_usage, 0, true)
+{
+	auto usage = memstats::usage();
+	if (args.empty())
+	{
+		for (const auto& line : strutil::splitV(formatUsage(usage), '\n'))
+			log::console(string{ line });
+		return;
+	}
+
+	if (writeCSV(usage, args[0]))
+		log::console(fmt::format("Appended memory usage to {}", args[0]));
+	else
+		log::console(global::error);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+namespace slade::memstats
+{
+// Memory held by (part of) a subsystem
+struct Usage
+{
+	string   subsystem;
+	string   name;          // What was counted, eg. an archive filename (can be empty)
+	uint64_t bytes = 0;     // Estimated size
+	unsigned count = 0;     // Number of objects counted (0 if not applicable)
+	bool     vram  = false; // True if [bytes] is (estimated) video memory
+};
+
+// Adds the current memory usage of a subsystem to a list whenever memory usage
+// is requested. Counters register themselves when constructed, use the
+// MEMORY_COUNTER macro to define one
+class Counter
+{
+public:
+	using Func = void (*)(vector<Usage>&);
+
+	Counter(string_view subsystem, Func func);
+	~Counter() = default;
+
+	const string& subsystem() const { return subsystem_; }
+	void          count(vector<Usage>& usage) const;
+
+private:
+	string subsystem_;
+	Func   func_;
+};
+
+vector<Usage> usage();
+uint64_t      total(const vector<Usage>& usage, bool vram = false);
+string        sizeString(uint64_t bytes);
+string        formatUsage(const vector<Usage>& usage);
+bool          writeCSV(const vector<Usage>& usage, string_view filename);
+} // namespace slade::memstats
+
+// Defines a memory counter function for [subsystem], which adds Usage items
+// (with only the name, bytes, count and vram set) to 'usage'
+#define MEMORY_COUNTER(name, subsystem)                                    \
+	void                     mc_##name(vector<slade::memstats::Usage>& usage); \
+	slade::memstats::Counter memory_counter_##name(subsystem, &mc_##name);     \
+	void                     mc_##name(vector<slade::memstats::Usage>& usage)
@@ -35,6 +35,7 @@
 #include "Parser.h"
 #include "Archive/Archive.h"
 #include "StringUtils.h"
+#include "Utility/BinaryIO.h"
 #include "Utility/Tokenizer.h"
 
 using namespace slade;
@@ -524,6 +525,119 @@ void ParseTreeNode::write(string& out, int indent) const
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Writes this node (and all its children) to [out] in a compact binary form
+// that can be read back with readBinary.
+// Values are written in native byte order, this is only meant for caching
+// -----------------------------------------------------------------------------
+void ParseTreeNode::writeBinary(string& out) const
+{
+	binaryio::writeString(out, name_);
+	binaryio::writeString(out, type_);
+	binaryio::writeString(out, inherit_);
+
+	// Values (type index followed by the value)
+	binaryio::writeRaw(out, static_cast<uint32_t>(values_.size()));
+	for (const auto& value : values_)
+	{
+		out += static_cast<char>(value.index());
+		switch (property::valueType(value))
+		{
+		case property::ValueType::Bool: out += std::get<bool>(value) ? '\1' : '\0'; break;
+		case property::ValueType::Int: binaryio::writeRaw(out, std::get<int>(value)); break;
+		case property::ValueType::UInt: binaryio::writeRaw(out, std::get<unsigned int>(value)); break;
+		case property::ValueType::Float: binaryio::writeRaw(out, std::get<double>(value)); break;
+		default: binaryio::writeString(out, std::get<string>(value)); break;
+		}
+	}
+
+	// Children
+	binaryio::writeRaw(out, static_cast<uint32_t>(children_.size()));
+	for (auto* node : children_)
+		dynamic_cast<ParseTreeNode*>(node)->writeBinary(out);
+}
+
+// -----------------------------------------------------------------------------
+// Reads this node (and all its children) from binary data written by
+// writeBinary, at the current position in [mc].
+// Returns false if the data is invalid
+// -----------------------------------------------------------------------------
+bool ParseTreeNode::readBinary(MemChunk& mc)
+{
+	if (!binaryio::readString(mc, name_) || !binaryio::readString(mc, type_) || !binaryio::readString(mc, inherit_))
+		return false;
+
+	// Values
+	uint32_t n_values = 0;
+	if (!binaryio::readCount(mc, n_values))
+		return false;
+	values_.clear();
+	values_.reserve(n_values);
+	for (uint32_t a = 0; a < n_values; a++)
+	{
+		uint8_t type = 0;
+		if (!mc.read(&type, 1))
+			return false;
+
+		bool ok = true;
+		switch (static_cast<property::ValueType>(type))
+		{
+		case property::ValueType::Bool:
+		{
+			uint8_t value = 0;
+			ok            = mc.read(&value, 1);
+			values_.emplace_back(value != 0);
+			break;
+		}
+		case property::ValueType::Int:
+		{
+			int value = 0;
+			ok        = mc.read(&value, sizeof(int));
+			values_.emplace_back(value);
+			break;
+		}
+		case property::ValueType::UInt:
+		{
+			unsigned int value = 0;
+			ok                 = mc.read(&value, sizeof(unsigned int));
+			values_.emplace_back(value);
+			break;
+		}
+		case property::ValueType::Float:
+		{
+			double value = 0;
+			ok           = mc.read(&value, sizeof(double));
+			values_.emplace_back(value);
+			break;
+		}
+		case property::ValueType::String:
+		{
+			string value;
+			ok = binaryio::readString(mc, value);
+			values_.emplace_back(std::move(value));
+			break;
+		}
+		default: return false;
+		}
+
+		if (!ok)
+			return false;
+	}
+
+	// Children
+	uint32_t n_children = 0;
+	if (!binaryio::readCount(mc, n_children))
+		return false;
+	for (uint32_t a = 0; a < n_children; a++)
+	{
+		auto child = new ParseTreeNode(this, parser_, archive_dir_);
+		if (!child->readBinary(mc))
+			return false;
+	}
+
+	return true;
+}
+
 
 // -----------------------------------------------------------------------------
 //
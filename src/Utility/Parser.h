@@ -49,6 +49,8 @@ public:
 
 	bool parse(Tokenizer& tz);
 	void write(string& out, int indent = 0) const;
+	void writeBinary(string& out) const;
+	bool readBinary(MemChunk& mc);
 
 protected:
 	STreeNode* createChild(string_view name) override
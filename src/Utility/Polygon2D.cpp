@@ -7,8 +7,9 @@
 // Web:         http://slade.mancubus.net
 // Filename:    Polygon2D.cpp
 // Description: Polygon2D and related classes for representing and handling a
-//              2-dimensional polygon, including PolygonSplitter class which
-//              splits a polygon into multiple convex sub-polygons
+//              2-dimensional polygon, including PolygonTriangulator and
+//              PolygonSplitter classes which split a polygon into multiple
+//              convex sub-polygons
 //
 // This program is free software; you can redistribute it and/or modify it
 // under the terms of the GNU General Public License as published by the Free
@@ -121,7 +122,8 @@ bool Polygon2D::openSector(MapSector* sector)
 		return false;
 
 	// Init
-	PolygonSplitter splitter;
+	PolygonTriangulator triangulator;
+	PolygonSplitter     splitter;
 	clear();
 
 	// Get list of sides connected to this sector
@@ -137,25 +139,37 @@ bool Polygon2D::openSector(MapSector* sector)
 		if (!line || line->doubleSector())
 			continue;
 
-		// Add the edge to the splitter (direction depends on what side of the line this is)
-		if (line->s1() == side)
-			splitter.addEdge(line->v1()->xPos(), line->v1()->yPos(), line->v2()->xPos(), line->v2()->yPos());
-		else
-			splitter.addEdge(line->v2()->xPos(), line->v2()->yPos(), line->v1()->xPos(), line->v1()->yPos());
+		// Add the edge (direction depends on what side of the line this is)
+		auto v1 = line->s1() == side ? line->v1() : line->v2();
+		auto v2 = line->s1() == side ? line->v2() : line->v1();
+		triangulator.addEdge(v1->xPos(), v1->yPos(), v2->xPos(), v2->yPos());
+		splitter.addEdge(v1->xPos(), v1->yPos(), v2->xPos(), v2->yPos());
 	}
 
-	// Split the polygon into convex sub-polygons
+	// Triangulate the polygon into convex sub-polygons
+	if (triangulator.triangulate(this))
+		return true;
+
+	// Triangulation needs closed outlines, so fall back to the splitter (which
+	// can cope with unclosed sectors) if it failed
+	clear();
 	return splitter.doSplitting(this);
 }
 
-void Polygon2D::updateTextureCoords(double scale_x, double scale_y, double offset_x, double offset_y, double rotation)
+// -----------------------------------------------------------------------------
+// Returns the transform from map coordinates to texture coordinates for a flat
+// with [texture] at the given scale, offset and rotation
+// -----------------------------------------------------------------------------
+Polygon2D::TexTransform Polygon2D::textureTransform(
+	unsigned texture,
+	double   scale_x,
+	double   scale_y,
+	double   offset_x,
+	double   offset_y,
+	double   rotation)
 {
-	// Can't do this if there is no texture
-	if (!texture_)
-		return;
-
 	// Check dimensions and scale
-	auto&  tex_info = gl::Texture::info(texture_);
+	auto&  tex_info = gl::Texture::info(texture);
 	double width    = tex_info.size.x;
 	double height   = tex_info.size.y;
 	if (scale_x == 0)
@@ -171,29 +185,50 @@ void Polygon2D::updateTextureCoords(double scale_x, double scale_y, double offse
 	double owidth  = 1.0 / scale_x / width;
 	double oheight = 1.0 / scale_y / height;
 
+	// Rotate, then offset (y is flipped)
+	double srot = rotation != 0 ? sin(math::degToRad(rotation)) : 0.;
+	double crot = rotation != 0 ? cos(math::degToRad(rotation)) : 1.;
+
+	TexTransform transform;
+	transform.xx = crot * owidth;
+	transform.xy = -srot * owidth;
+	transform.xo = scale_x * offset_x * owidth;
+	transform.yx = -srot * oheight;
+	transform.yy = -crot * oheight;
+	transform.yo = scale_y * offset_y * oheight;
+	return transform;
+}
+
+// -----------------------------------------------------------------------------
+// Writes [transform] to [matrix] as a column-major 4x4 OpenGL texture matrix
+// -----------------------------------------------------------------------------
+void Polygon2D::TexTransform::toMatrix(float* matrix) const
+{
+	std::fill(matrix, matrix + 16, 0.f);
+	matrix[0]  = xx;
+	matrix[1]  = yx;
+	matrix[4]  = xy;
+	matrix[5]  = yy;
+	matrix[10] = 1.f;
+	matrix[12] = xo;
+	matrix[13] = yo;
+	matrix[15] = 1.f;
+}
+
+void Polygon2D::updateTextureCoords(double scale_x, double scale_y, double offset_x, double offset_y, double rotation)
+{
+	// Can't do this if there is no texture
+	if (!texture_)
+		return;
+
 	// Set texture coordinates
-	double x, y;
+	auto transform = textureTransform(texture_, scale_x, scale_y, offset_x, offset_y, rotation);
 	for (auto& subpoly : subpolys_)
 	{
 		for (auto& v : subpoly.vertices)
 		{
-			x = v.x;
-			y = v.y;
-
-			// Apply rotation if any
-			if (rotation != 0)
-			{
-				Vec2d np = math::rotatePoint(Vec2d(0, 0), Vec2d(x, y), rotation);
-				x        = np.x;
-				y        = np.y;
-			}
-
-			x = (scale_x * offset_x) + x;
-			y = (scale_y * offset_y) - y;
-
-			// Set texture coordinate for vertex
-			v.tx = x * owidth;
-			v.ty = y * oheight;
+			v.tx = v.x * transform.xx + v.y * transform.xy + transform.xo;
+			v.ty = v.x * transform.yx + v.y * transform.yy + transform.yo;
 		}
 	}
 
@@ -209,7 +244,14 @@ unsigned Polygon2D::vboDataSize()
 	return total;
 }
 
-unsigned Polygon2D::writeToVBO(unsigned offset, unsigned index)
+// -----------------------------------------------------------------------------
+// Writes the vertex data of all subpolygons to the currently bound VBO,
+// starting at [offset] bytes (and vertex [index]). If [world_tex_coords] is
+// true, the map x,y position of each vertex is written as its texture
+// coordinates (to be transformed by the texture matrix when rendering).
+// Returns the offset to the end of the written data
+// -----------------------------------------------------------------------------
+unsigned Polygon2D::writeToVBO(unsigned offset, unsigned index, bool world_tex_coords)
 {
 	// Go through subpolys
 	unsigned ofs = offset;
@@ -217,7 +259,7 @@ unsigned Polygon2D::writeToVBO(unsigned offset, unsigned index)
 	for (auto& subpoly : subpolys_)
 	{
 		// Write subpoly data to VBO at the correct offset
-		glBufferSubData(GL_ARRAY_BUFFER, ofs, subpoly.vertices.size() * 20, subpoly.vertices.data());
+		writeSubPoly(subpoly, ofs, world_tex_coords);
 
 		// Update the subpoly vbo offset
 		subpoly.vbo_offset = ofs;
@@ -233,25 +275,33 @@ unsigned Polygon2D::writeToVBO(unsigned offset, unsigned index)
 	return ofs;
 }
 
-void Polygon2D::updateVBOData()
+// -----------------------------------------------------------------------------
+// Rewrites the vertex data of all subpolygons at their existing offsets in the
+// currently bound VBO (see writeToVBO)
+// -----------------------------------------------------------------------------
+void Polygon2D::updateVBOData(bool world_tex_coords)
 {
 	// Go through subpolys
 	for (auto& subpoly : subpolys_)
-		glBufferSubData(GL_ARRAY_BUFFER, subpoly.vbo_offset, subpoly.vertices.size() * 20, subpoly.vertices.data());
+		writeSubPoly(subpoly, subpoly.vbo_offset, world_tex_coords);
 
 	// Update variables
 	vbo_update_ = 0;
 }
 
-void Polygon2D::render()
+void Polygon2D::render(bool world_tex_coords)
 {
 	// Go through sub-polys
 	for (auto& poly : subpolys_)
 	{
+		gl::countDrawCall();
 		glBegin(GL_TRIANGLE_FAN);
 		for (auto& v : poly.vertices)
 		{
-			glTexCoord2f(v.tx, v.ty);
+			if (world_tex_coords)
+				glTexCoord2f(v.x, v.y);
+			else
+				glTexCoord2f(v.tx, v.ty);
 			glVertex3d(v.x, v.y, v.z);
 		}
 		glEnd();
@@ -263,6 +313,7 @@ void Polygon2D::renderWireframe()
 	// Go through sub-polys
 	for (auto& poly : subpolys_)
 	{
+		gl::countDrawCall();
 		glBegin(GL_LINE_LOOP);
 		for (auto& v : poly.vertices)
 		{
@@ -278,11 +329,53 @@ void Polygon2D::renderVBO(bool colour)
 	// Render
 	// glColor4f(this->colour[0], this->colour[1], this->colour[2], this->colour[3]);
 	for (const auto& subpoly : subpolys_)
+	{
+		gl::countDrawCall();
 		glDrawArrays(GL_TRIANGLE_FAN, subpoly.vbo_index, subpoly.vertices.size());
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Adds the first VBO vertex index and vertex count of each subpolygon to
+// [firsts] and [counts], for rendering many polygons at once with
+// glMultiDrawArrays (as triangle fans)
+// -----------------------------------------------------------------------------
+void Polygon2D::putVBORanges(vector<int>& firsts, vector<int>& counts) const
+{
+	for (const auto& subpoly : subpolys_)
+	{
+		firsts.push_back(subpoly.vbo_index);
+		counts.push_back(subpoly.vertices.size());
+	}
 }
 
 void Polygon2D::renderWireframeVBO(bool colour) const {}
 
+// -----------------------------------------------------------------------------
+// Writes the vertex data of [subpoly] to the currently bound VBO at [offset]
+// bytes, optionally with map x,y positions as texture coordinates
+// -----------------------------------------------------------------------------
+void Polygon2D::writeSubPoly(const SubPoly& subpoly, unsigned offset, bool world_tex_coords)
+{
+	auto size = subpoly.vertices.size() * 20;
+	if (!world_tex_coords)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, subpoly.vertices.data());
+		gl::countUpload(size);
+		return;
+	}
+
+	static vector<Vertex> vertices;
+	vertices.assign(subpoly.vertices.begin(), subpoly.vertices.end());
+	for (auto& v : vertices)
+	{
+		v.tx = v.x;
+		v.ty = v.y;
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices.data());
+	gl::countUpload(size);
+}
+
 void Polygon2D::setupVBOPointers()
 {
 	glVertexPointer(3, GL_FLOAT, 20, nullptr);
@@ -293,6 +386,438 @@ void Polygon2D::setupVBOPointers()
 }
 
 
+// -----------------------------------------------------------------------------
+//
+// PolygonTriangulator Class Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Returns twice the signed area of triangle [a,b,c] (positive if anticlockwise)
+double cross(const Vec2d& a, const Vec2d& b, const Vec2d& c)
+{
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// Returns true if [p] is inside or on the edge of anticlockwise triangle [a,b,c]
+bool pointInTriangle(const Vec2d& p, const Vec2d& a, const Vec2d& b, const Vec2d& c)
+{
+	return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+// Returns true if [p] is inside the polygon outline [points] (by crossings)
+bool pointInOutline(const Vec2d& p, const vector<Vec2d>& all_points, const vector<unsigned>& points)
+{
+	bool inside = false;
+	for (unsigned a = 0, b = points.size() - 1; a < points.size(); b = a++)
+	{
+		auto& pa = all_points[points[a]];
+		auto& pb = all_points[points[b]];
+		if ((pa.y > p.y) != (pb.y > p.y) && p.x < (pb.x - pa.x) * (p.y - pa.y) / (pb.y - pa.y) + pa.x)
+			inside = !inside;
+	}
+
+	return inside;
+}
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Clears all edges
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::clear()
+{
+	points_.clear();
+	point_index_.clear();
+	edges_.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Adds an edge from [x1,y1] to [x2,y2], with the polygon interior on its right
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::addEdge(double x1, double y1, double x2, double y2)
+{
+	auto v1 = addPoint(x1, y1);
+	auto v2 = addPoint(x2, y2);
+	if (v1 != v2)
+		edges_.emplace_back(v1, v2);
+}
+
+// -----------------------------------------------------------------------------
+// Triangulates the polygon and adds the resulting convex sub-polygons to
+// [poly]. Returns false if the edges don't form closed outlines, in which case
+// nothing is added
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::triangulate(Polygon2D* poly)
+{
+	if (!poly)
+		return false;
+
+	vector<Outline> outlines;
+	if (!traceOutlines(outlines))
+		return false;
+
+	// Find the outer outline each hole is within (the smallest one containing
+	// its rightmost point), holes not within any outer outline are invalid
+	for (unsigned a = 0; a < outlines.size(); a++)
+	{
+		if (outlines[a].area >= 0)
+			continue;
+
+		auto point = points_[outlines[a].points[0]];
+		for (auto index : outlines[a].points)
+			if (points_[index].x > point.x)
+				point = points_[index];
+
+		int outer = -1;
+		for (unsigned b = 0; b < outlines.size(); b++)
+			if (outlines[b].area > 0 && (outer < 0 || outlines[b].area < outlines[outer].area)
+				&& pointInOutline(point, points_, outlines[b].points))
+				outer = b;
+
+		if (outer >= 0)
+			outlines[outer].holes.push_back(a);
+	}
+
+	// Triangulate each outer outline (with its holes bridged in)
+	vector<vector<unsigned>> polys;
+	for (auto& outline : outlines)
+	{
+		if (outline.area <= 0)
+			continue;
+
+		// Bridge holes from right to left, so each bridge can't cross another hole
+		std::sort(outline.holes.begin(), outline.holes.end(), [&](unsigned l, unsigned r) {
+			auto max_x = [&](unsigned hole) {
+				double x = points_[outlines[hole].points[0]].x;
+				for (auto point : outlines[hole].points)
+					x = std::max(x, points_[point].x);
+				return x;
+			};
+			auto lx = max_x(l);
+			auto rx = max_x(r);
+			return lx > rx || (lx == rx && l < r);
+		});
+		auto points = outline.points;
+		for (auto hole : outline.holes)
+			bridgeHole(points, outlines[hole].points);
+
+		earClip(points, polys);
+	}
+
+	// Merge triangles into convex polygons, to render as fewer fans
+	mergeConvex(polys);
+
+	// Add sub-polygons (clockwise, like the sector edges they were built from)
+	for (auto& points : polys)
+	{
+		if (points.empty())
+			continue;
+
+		poly->addSubPoly();
+		auto& vertices = poly->subPoly(poly->nSubPolys() - 1)->vertices;
+		for (auto i = points.rbegin(); i != points.rend(); ++i)
+			vertices.emplace_back(points_[*i].x, points_[*i].y);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the index of the point at [x,y], adding it if needed
+// -----------------------------------------------------------------------------
+unsigned PolygonTriangulator::addPoint(double x, double y)
+{
+	auto [i, added] = point_index_.emplace(std::make_pair(x, y), points_.size());
+	if (added)
+		points_.emplace_back(x, y);
+
+	return i->second;
+}
+
+// -----------------------------------------------------------------------------
+// Traces all edges into closed outlines, reversed so that outer outlines are
+// anticlockwise (positive area) and holes are clockwise (negative area).
+// Returns false if any edges aren't part of a closed outline
+// -----------------------------------------------------------------------------
+bool PolygonTriangulator::traceOutlines(vector<Outline>& outlines) const
+{
+	// Get edges leaving each point
+	vector<vector<unsigned>> edges_out(points_.size());
+	for (unsigned a = 0; a < edges_.size(); a++)
+		edges_out[edges_[a].first].push_back(a);
+
+	vector<bool> used(edges_.size(), false);
+	for (unsigned start = 0; start < edges_.size(); start++)
+	{
+		if (used[start])
+			continue;
+
+		Outline outline;
+		auto    edge = start;
+		while (true)
+		{
+			used[edge] = true;
+			outline.points.push_back(edges_[edge].first);
+
+			// Next edge is the one turning furthest right (the least angle
+			// anticlockwise from the way back), to keep to the same area
+			auto&    prev    = points_[edges_[edge].first];
+			auto&    point   = points_[edges_[edge].second];
+			double   back    = std::atan2(prev.y - point.y, prev.x - point.x);
+			int      next    = -1;
+			double   min_rot = 0;
+			for (auto out : edges_out[edges_[edge].second])
+			{
+				if (used[out] && out != start)
+					continue;
+
+				auto&  to  = points_[edges_[out].second];
+				double rot = std::atan2(to.y - point.y, to.x - point.x) - back;
+				while (rot <= 0)
+					rot += 2 * math::PI;
+				if (next < 0 || rot < min_rot)
+				{
+					next    = out;
+					min_rot = rot;
+				}
+			}
+
+			// Unclosed
+			if (next < 0)
+				return false;
+
+			if (next == static_cast<int>(start))
+				break;
+
+			edge = next;
+		}
+
+		// Reverse so outer outlines are anticlockwise, and get its area
+		std::reverse(outline.points.begin(), outline.points.end());
+		for (unsigned a = 0, b = outline.points.size() - 1; a < outline.points.size(); b = a++)
+			outline.area += points_[outline.points[b]].x * points_[outline.points[a]].y
+							- points_[outline.points[a]].x * points_[outline.points[b]].y;
+		outline.area *= 0.5;
+
+		// Ignore degenerate outlines (eg. a line with the sector on both sides)
+		if (outline.points.size() >= 3 && outline.area != 0)
+			outlines.push_back(std::move(outline));
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// Joins the (clockwise) [hole] outline into the (anticlockwise) [outer]
+// outline, via a bridge from the hole's rightmost point to a visible point on
+// the outer outline
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::bridgeHole(vector<unsigned>& outer, const vector<unsigned>& hole) const
+{
+	// Get rightmost hole point
+	unsigned m = 0;
+	for (unsigned a = 1; a < hole.size(); a++)
+		if (points_[hole[a]].x > points_[hole[m]].x)
+			m = a;
+	auto& mp = points_[hole[m]];
+
+	// Find the nearest outer edge crossed by a ray east from it
+	int    hit   = -1;
+	double hit_x = 0;
+	for (unsigned a = 0; a < outer.size(); a++)
+	{
+		auto& p1 = points_[outer[a]];
+		auto& p2 = points_[outer[(a + 1) % outer.size()]];
+		if (p1.y > mp.y || p2.y < mp.y || p1.y == p2.y)
+			continue;
+
+		double x = p1.x + (mp.y - p1.y) * (p2.x - p1.x) / (p2.y - p1.y);
+		if (x >= mp.x && (hit < 0 || x < hit_x))
+		{
+			hit   = a;
+			hit_x = x;
+		}
+	}
+
+	// Shouldn't happen if the hole is within the outline, just leave it out
+	if (hit < 0)
+		return;
+
+	// Use the edge point furthest right, unless a reflex point of the outline
+	// is within the triangle between it, the hole point and the ray hit (then
+	// use the one of those closest in angle to the ray)
+	Vec2d    ip{ hit_x, mp.y };
+	unsigned next = (hit + 1) % outer.size();
+	unsigned p    = points_[outer[hit]].x > points_[outer[next]].x ? hit : next;
+	if (points_[outer[hit]] == ip)
+		p = hit;
+	else if (points_[outer[next]] == ip)
+		p = next;
+	else
+	{
+		auto   pp       = points_[outer[p]];
+		double best_tan = -1;
+		for (unsigned a = 0; a < outer.size(); a++)
+		{
+			auto& point = points_[outer[a]];
+			auto& prev  = points_[outer[(a + outer.size() - 1) % outer.size()]];
+			auto& next  = points_[outer[(a + 1) % outer.size()]];
+			if (a == p || cross(prev, point, next) >= 0 || point.x < mp.x)
+				continue;
+
+			bool inside = pp.y < mp.y ? pointInTriangle(point, mp, pp, ip) : pointInTriangle(point, mp, ip, pp);
+			if (!inside)
+				continue;
+
+			double tan = std::abs(point.y - mp.y) / (point.x - mp.x);
+			if (best_tan < 0 || tan < best_tan)
+			{
+				best_tan = tan;
+				p        = a;
+			}
+		}
+	}
+
+	// Insert the hole after the outer point, returning back along the bridge
+	vector<unsigned> joined;
+	joined.reserve(outer.size() + hole.size() + 2);
+	joined.insert(joined.end(), outer.begin(), outer.begin() + p + 1);
+	for (unsigned a = 0; a <= hole.size(); a++)
+		joined.push_back(hole[(m + a) % hole.size()]);
+	joined.insert(joined.end(), outer.begin() + p, outer.end());
+	outer = std::move(joined);
+}
+
+// -----------------------------------------------------------------------------
+// Triangulates the (anticlockwise, simple or bridged) [outline] by ear
+// clipping, and adds the (anticlockwise) triangles to [triangles]
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::earClip(const vector<unsigned>& outline, vector<vector<unsigned>>& triangles) const
+{
+	auto             count = static_cast<unsigned>(outline.size());
+	vector<unsigned> prev(count), next(count);
+	for (unsigned a = 0; a < count; a++)
+	{
+		prev[a] = (a + count - 1) % count;
+		next[a] = (a + 1) % count;
+	}
+
+	auto pos    = [&](unsigned i) -> const Vec2d& { return points_[outline[i]]; };
+	auto is_ear = [&](unsigned i) {
+		auto& a = pos(prev[i]);
+		auto& b = pos(i);
+		auto& c = pos(next[i]);
+		if (cross(a, b, c) <= 0)
+			return false;
+
+		// No other (reflex) point can be within the triangle
+		for (auto j = next[next[i]]; j != prev[i]; j = next[j])
+		{
+			auto& p = pos(j);
+			if (p == a || p == b || p == c)
+				continue;
+			if (cross(pos(prev[j]), p, pos(next[j])) <= 0 && pointInTriangle(p, a, b, c))
+				return false;
+		}
+
+		return true;
+	};
+
+	unsigned i     = 0;
+	unsigned tries = 0;
+	while (count > 3)
+	{
+		if (is_ear(i))
+			triangles.push_back({ outline[prev[i]], outline[i], outline[next[i]] });
+		else if (++tries <= count)
+		{
+			i = next[i];
+			continue;
+		}
+		else
+		{
+			// No ears left (degenerate or self-intersecting outline), drop the
+			// flattest point and carry on
+			auto flattest = i;
+			auto j        = i;
+			do
+			{
+				if (std::abs(cross(pos(prev[j]), pos(j), pos(next[j])))
+					< std::abs(cross(pos(prev[flattest]), pos(flattest), pos(next[flattest]))))
+					flattest = j;
+				j = next[j];
+			} while (j != i);
+			i = flattest;
+		}
+
+		// Clip the point
+		next[prev[i]] = next[i];
+		prev[next[i]] = prev[i];
+		i             = prev[i];
+		tries         = 0;
+		count--;
+	}
+
+	if (cross(pos(prev[i]), pos(i), pos(next[i])) > 0)
+		triangles.push_back({ outline[prev[i]], outline[i], outline[next[i]] });
+}
+
+// -----------------------------------------------------------------------------
+// Merges adjacent (anticlockwise) polygons in [polys] where the result is still
+// convex. Merged polygons are left empty
+// -----------------------------------------------------------------------------
+void PolygonTriangulator::mergeConvex(vector<vector<unsigned>>& polys) const
+{
+	// Get the polygon each edge belongs to
+	std::map<std::pair<unsigned, unsigned>, unsigned> edge_poly;
+	for (unsigned a = 0; a < polys.size(); a++)
+		for (unsigned e = 0; e < polys[a].size(); e++)
+			edge_poly.emplace(std::make_pair(polys[a][e], polys[a][(e + 1) % polys[a].size()]), a);
+
+	for (unsigned a = 0; a < polys.size(); a++)
+	{
+		for (unsigned e = 0; e < polys[a].size(); e++)
+		{
+			auto& poly = polys[a];
+			auto  pa   = poly[e];
+			auto  pb   = poly[(e + 1) % poly.size()];
+			auto  i    = edge_poly.find({ pb, pa });
+			if (i == edge_poly.end() || i->second == a || polys[i->second].empty())
+				continue;
+
+			// Find the shared edge in the other polygon
+			auto& other = polys[i->second];
+			auto  oe    = static_cast<unsigned>(std::find(other.begin(), other.end(), pb) - other.begin());
+			if (oe == other.size() || other[(oe + 1) % other.size()] != pa)
+				continue;
+
+			// Build the merged polygon (from b around to a, then the rest of
+			// the other polygon)
+			vector<unsigned> merged;
+			for (unsigned p = 1; p <= poly.size(); p++)
+				merged.push_back(poly[(e + p) % poly.size()]);
+			for (unsigned p = 2; p < other.size(); p++)
+				merged.push_back(other[(oe + p) % other.size()]);
+
+			// Check it's convex where the polygons join
+			auto n     = merged.size();
+			auto at_a  = poly.size() - 1;
+			auto point = [&](size_t index) -> const Vec2d& { return points_[merged[index % n]]; };
+			if (cross(point(at_a + n - 1), point(at_a), point(at_a + 1)) < 0
+				|| cross(point(n - 1), point(0), point(1)) < 0)
+				continue;
+
+			// Merge
+			for (unsigned p = 0; p < n; p++)
+				edge_poly[{ merged[p], merged[(p + 1) % n] }] = a;
+			other.clear();
+			poly = std::move(merged);
+			e    = static_cast<unsigned>(-1); // Check all edges again
+		}
+	}
+}
+
+
 // -----------------------------------------------------------------------------
 //
 // PolygonSplitter Class Functions
@@ -21,6 +21,16 @@ public:
 		unsigned       vbo_index  = 0;
 	};
 
+	// Affine transform from map x,y to flat texture coordinates:
+	// tx = x * xx + y * xy + xo, ty = x * yx + y * yy + yo
+	struct TexTransform
+	{
+		double xx = 1., xy = 0., xo = 0.;
+		double yx = 0., yy = 1., yo = 0.;
+
+		void toMatrix(float* matrix) const;
+	};
+
 	Polygon2D() = default;
 	~Polygon2D() { clear(); }
 
@@ -53,15 +63,23 @@ public:
 		double rotation = 0);
 
 	unsigned vboDataSize();
-	unsigned writeToVBO(unsigned offset, unsigned index);
-	void     updateVBOData();
+	unsigned writeToVBO(unsigned offset, unsigned index, bool world_tex_coords = false);
+	void     updateVBOData(bool world_tex_coords = false);
 
-	void render();
+	void render(bool world_tex_coords = false);
 	void renderWireframe();
 	void renderVBO(bool colour = true);
+	void putVBORanges(vector<int>& firsts, vector<int>& counts) const;
 	void renderWireframeVBO(bool colour = true) const;
 
-	static void setupVBOPointers();
+	static void         setupVBOPointers();
+	static TexTransform textureTransform(
+		unsigned texture,
+		double   scale_x  = 1,
+		double   scale_y  = 1,
+		double   offset_x = 0,
+		double   offset_y = 0,
+		double   rotation = 0);
 
 private:
 	// Polygon data
@@ -70,6 +88,43 @@ private:
 	float           colour_[4] = { 1.f, 1.f, 1.f, 1.f };
 
 	int vbo_update_ = 2;
+
+	static void writeSubPoly(const SubPoly& subpoly, unsigned offset, bool world_tex_coords);
+};
+
+
+// Triangulates a polygon (with any number of holes and separate parts) given as
+// a set of directed edges with the polygon interior on their right, as with map
+// lines and their front sides. Holes are bridged into their outer outline and
+// the result is ear clipped, then the triangles are merged back into convex
+// sub-polygons. The result only depends on the edges given (and their order)
+class PolygonTriangulator
+{
+public:
+	PolygonTriangulator()  = default;
+	~PolygonTriangulator() = default;
+
+	void clear();
+	void addEdge(double x1, double y1, double x2, double y2);
+	bool triangulate(Polygon2D* poly);
+
+private:
+	struct Outline
+	{
+		vector<unsigned> points; // Point indices, anticlockwise for outer outlines
+		double           area = 0.;
+		vector<unsigned> holes;  // Indices of outlines that are holes in this one
+	};
+
+	vector<Vec2d>                                 points_;
+	std::map<std::pair<double, double>, unsigned> point_index_;
+	vector<std::pair<unsigned, unsigned>>         edges_;
+
+	unsigned addPoint(double x, double y);
+	bool     traceOutlines(vector<Outline>& outlines) const;
+	void     bridgeHole(vector<unsigned>& outer, const vector<unsigned>& hole) const;
+	void     earClip(const vector<unsigned>& outline, vector<vector<unsigned>>& triangles) const;
+	void     mergeConvex(vector<vector<unsigned>>& polys) const;
 };
 
 
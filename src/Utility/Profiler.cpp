@@ -0,0 +1,310 @@
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    Profiler.cpp
+// Description: Simple instrumentation profiler. Scopes marked with
+//              PROFILE_SCOPE are timed when the profiler_enabled cvar is set,
+//              and the results can be shown per-frame (see the map editor
+//              overlay), dumped to the console or exported as a Chrome trace
+//              (chrome://tracing or ui.perfetto.dev)
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "Profiler.h"
+#include "General/Console.h"
+#include "Utility/StringUtils.h"
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+using namespace slade;
+using namespace profiler;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Bool, profiler_enabled, false, 0)
+
+namespace
+{
+// A single timed scope, times are in microseconds since the profiler started
+struct Event
+{
+	const char* name;
+	unsigned    thread;
+	int64_t     start;
+	int64_t     duration;
+};
+
+// Max number of events kept for trace export, older events are discarded
+constexpr size_t MAX_TRACE_EVENTS = 1000000;
+
+std::mutex                            mutex;
+vector<Event>                         events;
+size_t                                events_next = 0; // Next event to overwrite once events is full
+std::unordered_map<string_view, Stat> stat_totals;
+std::unordered_map<string_view, Stat> stat_frame;
+vector<Stat>                          last_frame;
+std::atomic<unsigned>                 next_thread_index = 0;
+const auto                            start_time        = std::chrono::steady_clock::now();
+thread_local unsigned                 thread_index      = next_thread_index++;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// -----------------------------------------------------------------------------
+// Returns the current time in microseconds since the profiler started
+// -----------------------------------------------------------------------------
+int64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time)
+		.count();
+}
+
+// -----------------------------------------------------------------------------
+// Adds a time of [ms] to [stat]
+// -----------------------------------------------------------------------------
+void addToStat(Stat& stat, string_view name, double ms)
+{
+	stat.name = name;
+	stat.count++;
+	stat.total_ms += ms;
+	stat.max_ms = std::max(stat.max_ms, ms);
+}
+
+// -----------------------------------------------------------------------------
+// Returns the stats in [map] sorted by total time (longest first)
+// -----------------------------------------------------------------------------
+vector<Stat> sortedStats(const std::unordered_map<string_view, Stat>& map)
+{
+	vector<Stat> stats;
+	stats.reserve(map.size());
+	for (const auto& i : map)
+		stats.push_back(i.second);
+	std::sort(stats.begin(), stats.end(), [](const Stat& a, const Stat& b) { return a.total_ms > b.total_ms; });
+	return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Records a timed scope [event]
+// -----------------------------------------------------------------------------
+void record(const Event& event)
+{
+	std::lock_guard lock(mutex);
+
+	if (events.size() < MAX_TRACE_EVENTS)
+		events.push_back(event);
+	else
+	{
+		events[events_next] = event;
+		events_next         = (events_next + 1) % MAX_TRACE_EVENTS;
+	}
+
+	auto ms = event.duration / 1000.;
+	addToStat(stat_totals[event.name], event.name, ms);
+	addToStat(stat_frame[event.name], event.name, ms);
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ScopedTimer Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ScopedTimer class constructor
+// -----------------------------------------------------------------------------
+ScopedTimer::ScopedTimer(const char* name) : name_{ name }
+{
+	if (profiler_enabled)
+		start_ = now();
+}
+
+// -----------------------------------------------------------------------------
+// ScopedTimer class destructor
+// -----------------------------------------------------------------------------
+ScopedTimer::~ScopedTimer()
+{
+	if (start_ >= 0)
+		record({ name_, thread_index, start_, now() - start_ });
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Profiler Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns true if profiling is enabled
+// -----------------------------------------------------------------------------
+bool profiler::enabled()
+{
+	return profiler_enabled;
+}
+
+// -----------------------------------------------------------------------------
+// Marks the end of a frame, the stats for everything timed since the previous
+// call are then available from frameStats
+// -----------------------------------------------------------------------------
+void profiler::endFrame()
+{
+	std::lock_guard lock(mutex);
+	last_frame = sortedStats(stat_frame);
+	stat_frame.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Returns the stats for everything timed during the last frame, sorted by
+// total time
+// -----------------------------------------------------------------------------
+vector<Stat> profiler::frameStats()
+{
+	std::lock_guard lock(mutex);
+	return last_frame;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the stats for everything timed since the profiler was last reset,
+// sorted by total time
+// -----------------------------------------------------------------------------
+vector<Stat> profiler::totals()
+{
+	std::lock_guard lock(mutex);
+	return sortedStats(stat_totals);
+}
+
+// -----------------------------------------------------------------------------
+// Clears all recorded timings
+// -----------------------------------------------------------------------------
+void profiler::reset()
+{
+	std::lock_guard lock(mutex);
+	events.clear();
+	events_next = 0;
+	stat_totals.clear();
+	stat_frame.clear();
+	last_frame.clear();
+}
+
+// -----------------------------------------------------------------------------
+// Writes all recorded events to [filename] in Chrome trace event (JSON)
+// format. Returns false if the file couldn't be written
+// -----------------------------------------------------------------------------
+bool profiler::writeTrace(string_view filename)
+{
+	std::ofstream file{ string{ filename } };
+	if (!file.is_open())
+	{
+		global::error = fmt::format("Unable to open file {} for writing", filename);
+		return false;
+	}
+
+	std::lock_guard lock(mutex);
+
+	file << "{\"traceEvents\":[\n";
+	for (size_t a = 0; a < events.size(); ++a)
+	{
+		// Write in order, starting from the oldest event
+		auto& event = events[(events_next + a) % events.size()];
+		file << fmt::format(
+			"{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{}}}\n",
+			a > 0 ? "," : "",
+			strutil::escapedString(event.name),
+			event.thread,
+			event.start,
+			event.duration);
+	}
+	file << "],\"displayTimeUnit\":\"ms\"}\n";
+
+	return file.good();
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Console Commands
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Writes the profiler totals to the console
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(profiler_dump, 0, true)
+{
+	auto stats = totals();
+	if (stats.empty())
+	{
+		log::console(profiler_enabled ? "No profiler data recorded" : "Profiler is disabled (see profiler_enabled)");
+		return;
+	}
+
+	log::console(fmt::format("{:<40} {:>8} {:>12} {:>10} {:>10}", "Scope", "Calls", "Total (ms)", "Avg (ms)", "Max (ms)"));
+	for (const auto& stat : stats)
+		log::console(fmt::format(
+			"{:<40} {:>8} {:>12.2f} {:>10.3f} {:>10.3f}",
+			stat.name,
+			stat.count,
+			stat.total_ms,
+			stat.total_ms / stat.count,
+			stat.max_ms));
+}
+
+// -----------------------------------------------------------------------------
+// Clears all recorded profiler data
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(profiler_reset, 0, true)
+{
+	reset();
+}
+
+// -----------------------------------------------------------------------------
+// Writes recorded profiler events to a Chrome trace file. Usage:
+// profiler_trace <filename>
+// -----------------------------------------------------------------------------
+CONSOLE_COMMAND(profiler_trace, 1, true)
+{
+	if (writeTrace(args[0]))
+		log::console(fmt::format("Wrote profiler trace to {}", args[0]));
+	else
+		log::console(global::error);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace slade::profiler
+{
+// Records the time taken by the scope it is created in, if profiling is
+// enabled (the profiler_enabled cvar). [name] must be a string literal (or
+// otherwise remain valid)
+class ScopedTimer
+{
+public:
+	ScopedTimer(const char* name);
+	~ScopedTimer();
+
+private:
+	const char* name_;
+	int64_t     start_ = -1;
+};
+
+// Timing totals for a named scope
+struct Stat
+{
+	string_view name;
+	unsigned    count    = 0;
+	double      total_ms = 0.;
+	double      max_ms   = 0.;
+};
+
+bool         enabled();
+void         endFrame();
+vector<Stat> frameStats();
+vector<Stat> totals();
+void         reset();
+bool         writeTrace(string_view filename);
+} // namespace slade::profiler
+
+#define SLADE_PROFILE_CONCAT_(a, b) a##b
+#define SLADE_PROFILE_CONCAT(a, b)  SLADE_PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)         slade::profiler::ScopedTimer SLADE_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
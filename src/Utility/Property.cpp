@@ -33,9 +33,59 @@
 // -----------------------------------------------------------------------------
 #include "Main.h"
 #include "Property.h"
+#include <deque>
+#include <iterator>
+#include <shared_mutex>
+#include <unordered_map>
 
 using namespace slade;
 
+
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Case-insensitive hash and comparison for property names
+struct KeyHash
+{
+	size_t operator()(string_view name) const
+	{
+		size_t hash = 2166136261u;
+		for (auto c : name)
+			hash = (hash ^ static_cast<unsigned char>(tolower(c))) * 16777619u;
+		return hash;
+	}
+};
+struct KeyEqual
+{
+	bool operator()(string_view left, string_view right) const { return strutil::equalCI(left, right); }
+};
+
+// Global table of interned property names. Names are kept in a deque so the
+// string_view map keys (and references from keyName) stay valid as it grows
+struct KeyTable
+{
+	std::shared_mutex                                                 mutex;
+	std::deque<string>                                                names;
+	std::unordered_map<string_view, property::Key, KeyHash, KeyEqual> keys;
+};
+
+KeyTable& keyTable()
+{
+	static KeyTable table;
+	return table;
+}
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// Property Namespace Functions
+//
+// -----------------------------------------------------------------------------
 namespace slade::property
 {
 bool asBool(const Property& prop)
@@ -108,35 +158,117 @@ string asString(const Property& prop, int float_precision)
 	default: return {};
 	}
 }
+
+// -----------------------------------------------------------------------------
+// Returns the key for property [name], adding it to the (global) key table if
+// it isn't there already. Names are case-insensitive, the first spelling seen
+// is the one kept
+// -----------------------------------------------------------------------------
+Key internKey(string_view name)
+{
+	auto& table = keyTable();
+
+	{
+		std::shared_lock lock(table.mutex);
+		if (auto i = table.keys.find(name); i != table.keys.end())
+			return i->second;
+	}
+
+	std::unique_lock lock(table.mutex);
+	if (auto i = table.keys.find(name); i != table.keys.end())
+		return i->second; // Added by another thread in the meantime
+
+	auto key = static_cast<Key>(table.names.size());
+	table.names.emplace_back(name);
+	table.keys.emplace(table.names.back(), key);
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the key for property [name], or NO_KEY if no property with that name
+// has been used yet
+// -----------------------------------------------------------------------------
+Key findKey(string_view name)
+{
+	auto&            table = keyTable();
+	std::shared_lock lock(table.mutex);
+
+	auto i = table.keys.find(name);
+	return i != table.keys.end() ? i->second : NO_KEY;
+}
+
+// -----------------------------------------------------------------------------
+// Returns the property name for [key]
+// -----------------------------------------------------------------------------
+const string& keyName(Key key)
+{
+	static string invalid;
+
+	auto&            table = keyTable();
+	std::shared_lock lock(table.mutex);
+
+	return key < table.names.size() ? table.names[key] : invalid;
+}
 } // namespace slade::property
 
 
-string PropertyList::toString(bool condensed, int float_precision) const
+// -----------------------------------------------------------------------------
+// Appends all properties to [out] as "key = value;" lines ("key=value;" if
+// [condensed] is true)
+// -----------------------------------------------------------------------------
+void PropertyList::write(string& out, bool condensed, int float_precision) const
 {
-	// Init return string
-	string ret;
+	auto inserter = std::back_inserter(out);
+	auto sep      = condensed ? "=" : " = ";
 
-	// Go through all properties
 	for (const auto& prop : properties_)
 	{
-		// Add "key = value;\n" to the return string
-		auto val = property::asString(prop.value, float_precision);
-
-		if (property::valueType(prop.value) == property::ValueType::String)
+		const auto& name = prop.name();
+		switch (prop.value.index())
 		{
-			val.insert(val.begin(), '\"');
-			val.push_back('\"');
+		case 0:
+			fmt::format_to(inserter, "{}{}{};\n", name, sep, std::get<bool>(prop.value) ? "true" : "false");
+			break;
+		case 1: fmt::format_to(inserter, "{}{}{};\n", name, sep, std::get<int>(prop.value)); break;
+		case 2: fmt::format_to(inserter, "{}{}{};\n", name, sep, std::get<unsigned>(prop.value)); break;
+		case 3:
+			if (float_precision <= 0)
+				fmt::format_to(inserter, "{}{}{};\n", name, sep, std::get<double>(prop.value));
+			else
+				fmt::format_to(inserter, "{}{}{:.{}f};\n", name, sep, std::get<double>(prop.value), float_precision);
+			break;
+		case 4: fmt::format_to(inserter, "{}{}\"{}\";\n", name, sep, std::get<string>(prop.value)); break;
+		default: break;
 		}
-
-		if (condensed)
-			ret += fmt::format("{}={};\n", prop.name, val);
-		else
-			ret += fmt::format("{} = {};\n", prop.name, val);
 	}
+}
 
+// -----------------------------------------------------------------------------
+// Returns a string representation of all properties, one "key = value;" line
+// per property ("key=value;" if [condensed] is true)
+// -----------------------------------------------------------------------------
+string PropertyList::toString(bool condensed, int float_precision) const
+{
+	string ret;
+	write(ret, condensed, float_precision);
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+// Returns the (estimated) memory used by the list, including any string values
+// too long to be stored in the string itself
+// -----------------------------------------------------------------------------
+size_t PropertyList::memoryUsage() const
+{
+	auto bytes = properties_.capacity() * sizeof(Entry);
+	for (const auto& prop : properties_)
+		if (auto str = std::get_if<string>(&prop.value); str && str->capacity() >= sizeof(string))
+			bytes += str->capacity() + 1;
+
+	return bytes;
+}
+
 
 
 
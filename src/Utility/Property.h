@@ -51,66 +51,71 @@ namespace property
 	double       asFloat(const Property& prop);
 	string       asString(const Property& prop, int float_precision = 0);
 
+	// Interned property names (keys), compared case-insensitively
+	using Key            = uint32_t;
+	constexpr Key NO_KEY = 0xFFFFFFFF;
+
+	Key           internKey(string_view name);
+	Key           findKey(string_view name);
+	const string& keyName(Key key);
+
 } // namespace property
 
 class PropertyList
 {
 public:
-	const vector<Named<Property>>& properties() const { return properties_; }
-	
+	struct Entry
+	{
+		property::Key key;
+		Property      value;
+
+		const string& name() const { return property::keyName(key); }
+	};
+
+	const vector<Entry>& properties() const { return properties_; }
+
 	Property& operator[](string_view key)
 	{
-		for (auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return prop.value;
+		auto pkey = property::internKey(key);
+		if (auto prop = find(pkey))
+			return *prop;
 
-		properties_.emplace_back(key, Property{});
+		properties_.push_back({ pkey, Property{} });
 		return properties_.back().value;
 	}
 
 	bool empty() const { return properties_.empty(); }
 
-	bool contains(string_view key) const
-	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return true;
-
-		return false;
-	}
+	bool contains(string_view key) const { return find(property::findKey(key)) != nullptr; }
 
 	template<typename T> T get(string_view key) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return std::get<T>(prop.value);
+		if (auto prop = find(property::findKey(key)))
+			return std::get<T>(*prop);
 
 		return T{};
 	}
-	
+
 	std::optional<Property> getIf(string_view key) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return prop.value;
+		if (auto prop = find(property::findKey(key)))
+			return *prop;
 
 		return {};
 	}
 
 	template<typename T> std::optional<T> getIf(string_view key) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return property::value<T>(prop.value);
+		if (auto prop = find(property::findKey(key)))
+			return property::value<T>(*prop);
 
 		return {};
 	}
 
 	template<typename T> T getOr(string_view key, T default_val) const
 	{
-		for (const auto& prop : properties_)
-			if (strutil::equalCI(key, prop.name))
-				return property::value<T>(prop.value, default_val);
+		if (auto prop = find(property::findKey(key)))
+			return property::value<T>(*prop, default_val);
 
 		return default_val;
 	}
@@ -124,16 +129,20 @@ public:
 	void allPropertyNames(vector<string>& list)
 	{
 		for (const auto& prop : properties_)
-			list.push_back(prop.name);
+			list.push_back(prop.name());
 	}
 
 	void clear() { properties_.clear(); }
 
 	bool remove(string_view key)
 	{
+		auto pkey = property::findKey(key);
+		if (pkey == property::NO_KEY)
+			return false;
+
 		const auto count = properties_.size();
 		for (unsigned i = 0; i < count; ++i)
-			if (strutil::equalCI(key, properties_[i].name))
+			if (properties_[i].key == pkey)
 			{
 				properties_.erase(properties_.begin() + i);
 				return true;
@@ -142,10 +151,27 @@ public:
 		return false;
 	}
 
+	void   write(string& out, bool condensed = false, int float_precision = 0) const;
 	string toString(bool condensed = false, int float_precision = 0) const;
+	size_t memoryUsage() const;
+
+	const Property* find(property::Key key) const
+	{
+		if (key != property::NO_KEY)
+			for (const auto& prop : properties_)
+				if (prop.key == key)
+					return &prop.value;
+
+		return nullptr;
+	}
+
+	Property* find(property::Key key)
+	{
+		return const_cast<Property*>(static_cast<const PropertyList*>(this)->find(key));
+	}
 
 private:
-	vector<Named<Property>> properties_;
+	vector<Entry> properties_;
 };
 } // namespace slade
 
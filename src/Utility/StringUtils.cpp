@@ -55,13 +55,94 @@ wxRegEx re_float{ "^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$", wxRE_DEFAULT | wxRE
 
 namespace slade::strutil
 {
-std::regex re_int1{ "^[+-]?[0-9]+[0-9]*$" };
-std::regex re_int2{ "^0[0-9]+$" };
-std::regex re_int3{ "^0x[0-9A-Fa-f]+$" };
 std::regex re_float{ "^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$" };
 } // namespace slade::strutil
 
 
+// -----------------------------------------------------------------------------
+//
+// Functions
+//
+// -----------------------------------------------------------------------------
+namespace
+{
+// Case conversion here only affects ASCII letters, which is all tolower and
+// toupper change for single bytes anyway, without the locale lookup per char.
+// The loops are branch-free so the compiler can vectorise them
+
+// -----------------------------------------------------------------------------
+// Returns [c] in lower case
+// -----------------------------------------------------------------------------
+inline char asciiLower(char c)
+{
+	return static_cast<char>(c | ((static_cast<uint8_t>(c - 'A') < 26) << 5));
+}
+
+// -----------------------------------------------------------------------------
+// Returns [c] in upper case
+// -----------------------------------------------------------------------------
+inline char asciiUpper(char c)
+{
+	return static_cast<char>(c & ~((static_cast<uint8_t>(c - 'a') < 26) << 5));
+}
+
+// -----------------------------------------------------------------------------
+// Returns the 8 bytes at [data] with any upper case ASCII letters in lower case
+// -----------------------------------------------------------------------------
+inline uint64_t asciiLower8(const char* data)
+{
+	constexpr uint64_t ones = 0x0101010101010101ull;
+	constexpr uint64_t high = 0x8080808080808080ull;
+
+	uint64_t block;
+	memcpy(&block, data, 8);
+
+	// Set the high bit of each byte in 'A'-'Z' (ignoring bytes >= 0x80), then
+	// move it to the 0x20 (lower case) bit
+	auto low7     = block & ~high;
+	auto ge_a     = low7 + ones * (0x80 - 'A');
+	auto gt_z     = low7 + ones * (0x7F - 'Z');
+	auto is_upper = ge_a & ~gt_z & ~block & high;
+	return block | (is_upper >> 2);
+}
+
+// -----------------------------------------------------------------------------
+// Copies [count] chars from [src] to [dst] in lower case
+// -----------------------------------------------------------------------------
+void lowerChars(const char* src, char* dst, size_t count)
+{
+	for (size_t a = 0; a < count; ++a)
+		dst[a] = asciiLower(src[a]);
+}
+
+// -----------------------------------------------------------------------------
+// Copies [count] chars from [src] to [dst] in upper case
+// -----------------------------------------------------------------------------
+void upperChars(const char* src, char* dst, size_t count)
+{
+	for (size_t a = 0; a < count; ++a)
+		dst[a] = asciiUpper(src[a]);
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if the [count] chars at [left] and [right] are equal, ignoring
+// case. Compares 8 chars at a time
+// -----------------------------------------------------------------------------
+bool equalCIChars(const char* left, const char* right, size_t count)
+{
+	size_t a = 0;
+	for (; a + 8 <= count; a += 8)
+		if (asciiLower8(left + a) != asciiLower8(right + a))
+			return false;
+	for (; a < count; ++a)
+		if (asciiLower(left[a]) != asciiLower(right[a]))
+			return false;
+
+	return true;
+}
+} // namespace
+
+
 // -----------------------------------------------------------------------------
 //
 // strutil Namespace Functions
@@ -75,8 +156,18 @@ std::regex re_float{ "^[-+]?[0-9]*.?[0-9]+([eE][-+]?[0-9]+)?$" };
 // -----------------------------------------------------------------------------
 bool strutil::isInteger(string_view str, bool allow_hex)
 {
-	return std::regex_search(str.data(), re_int1) || std::regex_search(str.data(), re_int2)
-		   || (allow_hex && std::regex_search(str.data(), re_int3));
+	if (allow_hex && isHex(str))
+		return true;
+
+	// [+-]?[0-9]+
+	size_t start = !str.empty() && (str[0] == '+' || str[0] == '-') ? 1 : 0;
+	if (start >= str.size())
+		return false;
+	for (auto a = start; a < str.size(); ++a)
+		if (str[a] < '0' || str[a] > '9')
+			return false;
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -84,7 +175,14 @@ bool strutil::isInteger(string_view str, bool allow_hex)
 // -----------------------------------------------------------------------------
 bool strutil::isHex(string_view str)
 {
-	return std::regex_search(str.data(), re_int3);
+	// 0x[0-9A-Fa-f]+
+	if (str.size() < 3 || str[0] != '0' || str[1] != 'x')
+		return false;
+	for (auto a = 2u; a < str.size(); ++a)
+		if (!isxdigit(static_cast<unsigned char>(str[a])))
+			return false;
+
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -100,15 +198,7 @@ bool strutil::isFloat(string_view str)
 
 bool strutil::equalCI(string_view left, string_view right)
 {
-	auto sz = left.size();
-	if (right.size() != sz)
-		return false;
-
-	for (auto a = 0u; a < sz; ++a)
-		if (tolower(left[a]) != tolower(right[a]))
-			return false;
-
-	return true;
+	return left.size() == right.size() && equalCIChars(left.data(), right.data(), left.size());
 }
 
 // This one is a bit tricky - the string_view == string_view one above should be sufficient
@@ -131,6 +221,27 @@ bool strutil::equalCI(string_view left, string_view right)
 //	return true;
 //}
 
+// -----------------------------------------------------------------------------
+// Returns a hash of [str] that is the same regardless of case, for use with
+// equalCI in hashed containers
+// -----------------------------------------------------------------------------
+size_t strutil::hashCI(string_view str)
+{
+	// FNV-1a, on 8 chars at a time
+	constexpr uint64_t prime = 0x100000001b3ull;
+	uint64_t           hash  = 0xcbf29ce484222325ull;
+
+	auto   data  = str.data();
+	auto   count = str.size();
+	size_t a     = 0;
+	for (; a + 8 <= count; a += 8)
+		hash = (hash ^ asciiLower8(data + a)) * prime;
+	for (; a < count; ++a)
+		hash = (hash ^ static_cast<uint8_t>(asciiLower(data[a]))) * prime;
+
+	return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
 bool strutil::startsWith(string_view str, string_view check)
 {
 	return check.size() <= str.size() && str.compare(0, check.size(), check) == 0;
@@ -143,20 +254,12 @@ bool strutil::startsWith(string_view str, char check)
 
 bool strutil::startsWithCI(string_view str, string_view check)
 {
-	const auto c_size = check.size();
-	if (c_size > str.size())
-		return false;
-
-	for (unsigned c = 0; c < c_size; ++c)
-		if (tolower(str[c]) != tolower(check[c]))
-			return false;
-
-	return true;
+	return check.size() <= str.size() && equalCIChars(str.data(), check.data(), check.size());
 }
 
 bool strutil::startsWithCI(string_view str, char check)
 {
-	return !str.empty() && tolower(str[0]) == tolower(check);
+	return !str.empty() && asciiLower(str[0]) == asciiLower(check);
 }
 
 bool strutil::endsWith(string_view str, string_view check)
@@ -171,21 +274,13 @@ bool strutil::endsWith(string_view str, char check)
 
 bool strutil::endsWithCI(string_view str, string_view check)
 {
-	const auto c_size = check.size();
-	if (c_size > str.size())
-		return false;
-
-	const auto s_size = str.size();
-	for (unsigned c = 0; c < c_size; ++c)
-		if (tolower(str[s_size - c_size + c]) != tolower(check[c]))
-			return false;
-
-	return true;
+	return check.size() <= str.size()
+		   && equalCIChars(str.data() + str.size() - check.size(), check.data(), check.size());
 }
 
-bool endsWithCI(string_view str, char check)
+bool strutil::endsWithCI(string_view str, char check)
 {
-	return !str.empty() && tolower(str.back()) == tolower(check);
+	return !str.empty() && asciiLower(str.back()) == asciiLower(check);
 }
 
 bool strutil::contains(string_view str, char check)
@@ -195,9 +290,9 @@ bool strutil::contains(string_view str, char check)
 
 bool strutil::containsCI(string_view str, char check)
 {
-	const auto lc = tolower(check);
+	const auto lc = asciiLower(check);
 	for (auto c : str)
-		if (tolower(c) == lc)
+		if (asciiLower(c) == lc)
 			return true;
 
 	return false;
@@ -213,8 +308,11 @@ bool strutil::containsCI(string_view str, string_view check)
 	if (str.size() < check.size())
 		return false;
 
-	// TODO: Could be improved to avoid copying strings - it's currently unused so not a priority
-	return lower(str).find(lower(check)) != string::npos;
+	for (size_t pos = 0; pos + check.size() <= str.size(); ++pos)
+		if (equalCIChars(str.data() + pos, check.data(), check.size()))
+			return true;
+
+	return false;
 }
 
 bool strutil::matches(string_view str, string_view match)
@@ -313,7 +411,7 @@ bool strutil::matchesCI(string_view str, string_view match)
 			if (t_pos == str.size())
 				return false; // Not found, no match
 
-			if (match[m_start + i] == '?' || tolower(str[t_pos]) == tolower(match[m_start + i]))
+			if (match[m_start + i] == '?' || asciiLower(str[t_pos]) == asciiLower(match[m_start + i]))
 				++i;
 			else if (wildcard)
 				i = 0;
@@ -377,30 +475,52 @@ string strutil::replaceFirst(string_view str, string_view from, string_view to)
 
 string& strutil::lowerIP(string& str)
 {
-	transform(str.begin(), str.end(), str.begin(), ::tolower);
+	lowerChars(str.data(), str.data(), str.size());
 	return str;
 }
 
 string& strutil::upperIP(string& str)
 {
-	transform(str.begin(), str.end(), str.begin(), ::toupper);
+	upperChars(str.data(), str.data(), str.size());
 	return str;
 }
 
 string strutil::lower(string_view str)
 {
-	auto s = string{ str };
-	transform(s.begin(), s.end(), s.begin(), ::tolower);
+	string s(str.size(), 0);
+	lowerChars(str.data(), s.data(), str.size());
 	return s;
 }
 
 string strutil::upper(string_view str)
 {
-	auto s = string{ str };
-	transform(s.begin(), s.end(), s.begin(), ::toupper);
+	string s(str.size(), 0);
+	upperChars(str.data(), s.data(), str.size());
 	return s;
 }
 
+// -----------------------------------------------------------------------------
+// Sets [out] to [str] in lower case. Doesn't allocate if [out] already has
+// enough capacity, so a buffer can be reused for repeated lookups
+// -----------------------------------------------------------------------------
+string& strutil::lowerTo(string_view str, string& out)
+{
+	out.resize(str.size());
+	lowerChars(str.data(), out.data(), str.size());
+	return out;
+}
+
+// -----------------------------------------------------------------------------
+// Sets [out] to [str] in upper case. Doesn't allocate if [out] already has
+// enough capacity, so a buffer can be reused for repeated lookups
+// -----------------------------------------------------------------------------
+string& strutil::upperTo(string_view str, string& out)
+{
+	out.resize(str.size());
+	upperChars(str.data(), out.data(), str.size());
+	return out;
+}
+
 string& strutil::ltrimIP(string& str)
 {
 	str.erase(0, str.find_first_not_of(WHITESPACE_CHARACTERS));
@@ -447,8 +567,8 @@ string& strutil::capitalizeIP(string& str)
 	if (str.empty())
 		return str;
 
-	transform(str.begin(), str.end(), str.begin(), ::tolower);
-	str[0] = ::toupper(str[0]);
+	lowerIP(str);
+	str[0] = asciiUpper(str[0]);
 
 	return str;
 }
@@ -458,9 +578,8 @@ string strutil::capitalize(string_view str)
 	if (str.empty())
 		return {};
 
-	auto s = string{ str };
-	transform(s.begin(), s.end(), s.begin(), ::tolower);
-	s[0] = ::toupper(s[0]);
+	auto s = lower(str);
+	s[0]   = asciiUpper(s[0]);
 	return s;
 }
 
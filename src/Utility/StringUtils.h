@@ -34,25 +34,26 @@ namespace strutil
 
 	// String comparisons and checks
 	// CI = Case-Insensitive
-	bool isInteger(string_view str, bool allow_hex = true);
-	bool isHex(string_view str);
-	bool isFloat(string_view str);
-	bool equalCI(string_view left, string_view right);
+	bool   isInteger(string_view str, bool allow_hex = true);
+	bool   isHex(string_view str);
+	bool   isFloat(string_view str);
+	bool   equalCI(string_view left, string_view right);
+	size_t hashCI(string_view str);
 	// bool equalCI(string_view left, const char* right);
-	bool startsWith(string_view str, string_view check);
-	bool startsWith(string_view str, char check);
-	bool startsWithCI(string_view str, string_view check);
-	bool startsWithCI(string_view str, char check);
-	bool endsWith(string_view str, string_view check);
-	bool endsWith(string_view str, char check);
-	bool endsWithCI(string_view str, string_view check);
-	bool endsWithCI(string_view str, char check);
-	bool contains(string_view str, char check);
-	bool containsCI(string_view str, char check);
-	bool contains(string_view str, string_view check);
-	bool containsCI(string_view str, string_view check);
-	bool matches(string_view str, string_view match);
-	bool matchesCI(string_view str, string_view match);
+	bool   startsWith(string_view str, string_view check);
+	bool   startsWith(string_view str, char check);
+	bool   startsWithCI(string_view str, string_view check);
+	bool   startsWithCI(string_view str, char check);
+	bool   endsWith(string_view str, string_view check);
+	bool   endsWith(string_view str, char check);
+	bool   endsWithCI(string_view str, string_view check);
+	bool   endsWithCI(string_view str, char check);
+	bool   contains(string_view str, char check);
+	bool   containsCI(string_view str, char check);
+	bool   contains(string_view str, string_view check);
+	bool   containsCI(string_view str, string_view check);
+	bool   matches(string_view str, string_view match);
+	bool   matchesCI(string_view str, string_view match);
 
 	// String transformations
 	// IP = In-Place
@@ -65,6 +66,8 @@ namespace strutil
 	string& upperIP(string& str);
 	string  lower(string_view str);
 	string  upper(string_view str);
+	string& lowerTo(string_view str, string& out);
+	string& upperTo(string_view str, string& out);
 	string& ltrimIP(string& str);
 	string& rtrimIP(string& str);
 	string& trimIP(string& str);
@@ -128,6 +131,16 @@ namespace strutil
 		return stream.str();
 	}
 
+	// Case-insensitive hash and equality for hashed containers of strings
+	struct HashCI
+	{
+		size_t operator()(string_view str) const { return hashCI(str); }
+	};
+	struct EqualCI
+	{
+		bool operator()(string_view left, string_view right) const { return equalCI(left, right); }
+	};
+
 	// Path class
 	class Path
 	{
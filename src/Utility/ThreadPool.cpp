@@ -0,0 +1,311 @@
+
+// -----------------------------------------------------------------------------
+// SLADE - It's a Doom Editor
+// Copyright(C) 2008 - 2020 Simon Judd
+//
+// Email:       sirjuddington@gmail.com
+// Web:         http://slade.mancubus.net
+// Filename:    ThreadPool.cpp
+// Description: ThreadPool class, a simple fixed-size pool of worker threads
+//              that run queued tasks, a global pool for general use, and
+//              Job class for background tasks with completion callbacks
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301, USA.
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+//
+// Includes
+//
+// -----------------------------------------------------------------------------
+#include "Main.h"
+#include "ThreadPool.h"
+
+using namespace slade;
+
+
+// -----------------------------------------------------------------------------
+//
+// Variables
+//
+// -----------------------------------------------------------------------------
+CVAR(Int, max_worker_threads, 0, CVar::Flag::Save) // 0 = use number of hardware threads
+namespace
+{
+unique_ptr<ThreadPool> global_pool;
+std::mutex             global_pool_mutex;
+} // namespace
+
+
+// -----------------------------------------------------------------------------
+//
+// ThreadPool Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// ThreadPool class constructor, creates [num_threads] worker threads.
+// If [num_threads] is 0, the number of hardware threads is used
+// -----------------------------------------------------------------------------
+ThreadPool::ThreadPool(unsigned num_threads)
+{
+	if (num_threads == 0)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	workers_.reserve(num_threads);
+	for (unsigned a = 0; a < num_threads; ++a)
+		workers_.emplace_back([this]() { workerLoop(); });
+}
+
+// -----------------------------------------------------------------------------
+// ThreadPool class destructor, waits for any running tasks to finish and
+// stops all worker threads. Any tasks still queued will not be run
+// -----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(mutex_);
+		stopping_ = true;
+	}
+	cv_task_.notify_all();
+
+	for (auto& worker : workers_)
+		worker.join();
+}
+
+// -----------------------------------------------------------------------------
+// Adds [task] to the queue, it will be run on the next available worker
+// -----------------------------------------------------------------------------
+void ThreadPool::push(std::function<void()> task)
+{
+	{
+		std::lock_guard lock(mutex_);
+		tasks_.push(std::move(task));
+	}
+	cv_task_.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Blocks until all queued tasks have finished running
+// -----------------------------------------------------------------------------
+void ThreadPool::waitForAll()
+{
+	std::unique_lock lock(mutex_);
+	cv_idle_.wait(lock, [this]() { return tasks_.empty() && active_ == 0; });
+}
+
+// -----------------------------------------------------------------------------
+// Returns true if no tasks are queued or currently running
+// -----------------------------------------------------------------------------
+bool ThreadPool::idle()
+{
+	std::lock_guard lock(mutex_);
+	return tasks_.empty() && active_ == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Worker thread loop, runs queued tasks until the pool is stopped
+// -----------------------------------------------------------------------------
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock lock(mutex_);
+			cv_task_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+			if (stopping_)
+				return;
+
+			task = std::move(tasks_.front());
+			tasks_.pop();
+			++active_;
+		}
+
+		task();
+
+		{
+			std::lock_guard lock(mutex_);
+			--active_;
+			if (active_ == 0 && tasks_.empty())
+				cv_idle_.notify_all();
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// Job Class Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Blocks until the job has finished running
+// -----------------------------------------------------------------------------
+void Job::wait()
+{
+	std::unique_lock lock(mutex_);
+	cv_finished_.wait(lock, [this]() { return finished_.load(); });
+}
+
+// -----------------------------------------------------------------------------
+// Adds [callback] to be called on the main thread once the job has finished
+// (straight away if it already has). Callbacks aren't called if the job was
+// cancelled
+// -----------------------------------------------------------------------------
+void Job::onComplete(std::function<void()> callback)
+{
+	{
+		std::lock_guard lock(mutex_);
+		if (!finished_)
+		{
+			callbacks_.push_back(std::move(callback));
+			return;
+		}
+	}
+
+	queueCallback(std::move(callback));
+}
+
+// -----------------------------------------------------------------------------
+// Queues [callback] to be called on the main thread (if the job wasn't
+// cancelled by then)
+// -----------------------------------------------------------------------------
+void Job::queueCallback(std::function<void()> callback)
+{
+	if (!wxTheApp)
+		return;
+
+	wxTheApp->CallAfter([job = shared_from_this(), callback = std::move(callback)]() {
+		if (!job->cancelled())
+			callback();
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Starts a new job running [func] on the global thread pool. [func] should
+// check the job's cancelled() state where it can stop early
+// -----------------------------------------------------------------------------
+shared_ptr<Job> Job::start(std::function<void(Job&)> func)
+{
+	auto job = std::make_shared<Job>();
+
+	threadpool::pool().push([job, func = std::move(func)]() {
+		if (!job->cancelled())
+			func(*job);
+
+		vector<std::function<void()>> callbacks;
+		{
+			std::lock_guard lock(job->mutex_);
+			job->finished_ = true;
+			callbacks.swap(job->callbacks_);
+		}
+		job->cv_finished_.notify_all();
+
+		for (auto& callback : callbacks)
+			job->queueCallback(std::move(callback));
+	});
+
+	return job;
+}
+
+
+// -----------------------------------------------------------------------------
+//
+// ThreadPool Namespace Functions
+//
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Returns the global thread pool, creating it if needed
+// -----------------------------------------------------------------------------
+ThreadPool& threadpool::pool()
+{
+	std::lock_guard lock(global_pool_mutex);
+	if (!global_pool)
+		global_pool = std::make_unique<ThreadPool>(std::max<int>(max_worker_threads, 0));
+
+	return *global_pool;
+}
+
+// -----------------------------------------------------------------------------
+// Stops and destroys the global thread pool (if it was created)
+// -----------------------------------------------------------------------------
+void threadpool::shutdown()
+{
+	std::lock_guard lock(global_pool_mutex);
+	global_pool.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Calls [func] for each index from 0 to [count]-1, spread across the global
+// thread pool and the calling thread. Blocks until all calls have completed.
+// Indices are only claimed by threads that are actually running, so this is
+// safe to call from within a task running on the pool
+// -----------------------------------------------------------------------------
+void threadpool::parallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+	if (count == 0)
+		return;
+
+	// Just run on the calling thread if there's nothing to split up
+	auto& tp        = pool();
+	auto  n_helpers = std::min<size_t>(tp.numThreads(), count - 1);
+	if (n_helpers == 0)
+	{
+		for (size_t a = 0; a < count; ++a)
+			func(a);
+		return;
+	}
+
+	// Shared state (helper tasks may start after this function has returned)
+	struct State
+	{
+		std::function<void(size_t)> func;
+		size_t                      count;
+		std::atomic<size_t>         next{ 0 };
+		std::atomic<size_t>         done{ 0 };
+		std::mutex                  mutex;
+		std::condition_variable     cv_done;
+	};
+	auto state   = std::make_shared<State>();
+	state->func  = func;
+	state->count = count;
+
+	auto work = [state]() {
+		size_t index;
+		while ((index = state->next++) < state->count)
+		{
+			state->func(index);
+			if (++state->done == state->count)
+			{
+				std::lock_guard lock(state->mutex);
+				state->cv_done.notify_all();
+			}
+		}
+	};
+
+	for (size_t a = 0; a < n_helpers; ++a)
+		tp.push(work);
+	work();
+
+	std::unique_lock lock(state->mutex);
+	state->cv_done.wait(lock, [&state]() { return state->done == state->count; });
+}
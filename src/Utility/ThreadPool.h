@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace slade
+{
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned num_threads = 0);
+	~ThreadPool();
+
+	unsigned numThreads() const { return static_cast<unsigned>(workers_.size()); }
+
+	void push(std::function<void()> task);
+	void waitForAll();
+	bool idle();
+
+private:
+	vector<std::thread>               workers_;
+	std::queue<std::function<void()>> tasks_;
+	std::mutex                        mutex_;
+	std::condition_variable           cv_task_;
+	std::condition_variable           cv_idle_;
+	unsigned                          active_   = 0;
+	bool                              stopping_ = false;
+
+	void workerLoop();
+};
+
+// A task run in the background on the global thread pool, started with
+// Job::start. It can be waited on, cancelled, or given callbacks to run on
+// the main thread when it completes
+class Job : public std::enable_shared_from_this<Job>
+{
+public:
+	bool finished() const { return finished_; }
+	bool cancelled() const { return cancelled_; }
+
+	void cancel() { cancelled_ = true; }
+	void wait();
+	void onComplete(std::function<void()> callback);
+
+	static shared_ptr<Job> start(std::function<void(Job&)> func);
+
+private:
+	std::atomic<bool>             finished_  = false;
+	std::atomic<bool>             cancelled_ = false;
+	std::mutex                    mutex_;
+	std::condition_variable       cv_finished_;
+	vector<std::function<void()>> callbacks_;
+
+	void queueCallback(std::function<void()> callback);
+};
+
+namespace threadpool
+{
+	ThreadPool& pool();
+	void        shutdown();
+	void        parallelFor(size_t count, const std::function<void(size_t)>& func);
+} // namespace threadpool
+} // namespace slade
@@ -52,13 +52,26 @@ Tokenizer::Token Tokenizer::invalid_token_{ "", 0, false, 0, 0, 0, false };
 // -----------------------------------------------------------------------------
 namespace
 {
+// Bits in Token::numeric_checks for each check, the result of a check is
+// stored in the bit above it
+enum NumericCheck : uint8_t
+{
+	CheckInteger    = 1,
+	CheckIntegerHex = 4,
+	CheckHex        = 16,
+	CheckFloat      = 64,
+};
+
 // -----------------------------------------------------------------------------
-// Returns true if [p] is a whitespace character
+// Returns the result of numeric [check] on [token], running [func] on its text
+// only if it hasn't been checked already
 // -----------------------------------------------------------------------------
-bool isWhitespace(char p)
+template<typename F> bool cachedCheck(const Tokenizer::Token& token, NumericCheck check, F&& func)
 {
-	// Whitespace is either a newline, tab character or space
-	return p == '\n' || p == 13 || p == ' ' || p == '\t';
+	if (!(token.numeric_checks & check))
+		token.numeric_checks |= func(token.text) ? check | (check << 1) : check;
+
+	return token.numeric_checks & (check << 1);
 }
 } // namespace
 
@@ -76,7 +89,9 @@ bool isWhitespace(char p)
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isInteger(bool allow_hex) const
 {
-	return strutil::isInteger(text, allow_hex);
+	return cachedCheck(*this, allow_hex ? CheckIntegerHex : CheckInteger, [allow_hex](const string& str) {
+		return strutil::isInteger(str, allow_hex);
+	});
 }
 
 // -----------------------------------------------------------------------------
@@ -84,7 +99,7 @@ bool Tokenizer::Token::isInteger(bool allow_hex) const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isHex() const
 {
-	return strutil::isHex(text);
+	return cachedCheck(*this, CheckHex, [](const string& str) { return strutil::isHex(str); });
 }
 
 // -----------------------------------------------------------------------------
@@ -92,7 +107,7 @@ bool Tokenizer::Token::isHex() const
 // -----------------------------------------------------------------------------
 bool Tokenizer::Token::isFloat() const
 {
-	return strutil::isFloat(text);
+	return cachedCheck(*this, CheckFloat, [](const string& str) { return strutil::isFloat(str); });
 }
 
 // ----------------------------------------------------------------------------
@@ -168,8 +183,28 @@ void Tokenizer::Token::toFloat(float& val) const
 // -----------------------------------------------------------------------------
 Tokenizer::Tokenizer(int comments, const string& special_characters) :
 	comment_types_{ comments },
-	special_characters_{ special_characters.begin(), special_characters.end() }
+	special_characters_{ special_characters }
 {
+	updateCharClasses();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the comment types to skip to [types] (see CommentTypes)
+// -----------------------------------------------------------------------------
+void Tokenizer::setCommentTypes(int types)
+{
+	comment_types_ = types;
+	updateCharClasses();
+}
+
+// -----------------------------------------------------------------------------
+// Sets the special characters (always read as separate tokens) to
+// [characters]
+// -----------------------------------------------------------------------------
+void Tokenizer::setSpecialCharacters(string_view characters)
+{
+	special_characters_ = characters;
+	updateCharClasses();
 }
 
 // -----------------------------------------------------------------------------
@@ -191,8 +226,7 @@ const Tokenizer::Token& Tokenizer::next()
 	if (!token_next_.valid)
 		return invalid_token_;
 
-	token_current_ = token_next_;
-	readNext();
+	shiftNext();
 	return token_current_;
 }
 
@@ -207,8 +241,7 @@ void Tokenizer::adv(size_t inc)
 	for (size_t a = 0; a < inc - 1; a++)
 		readNext();
 
-	token_current_ = token_next_;
-	readNext();
+	shiftNext();
 }
 
 // -----------------------------------------------------------------------------
@@ -341,8 +374,7 @@ void Tokenizer::advToNextLine()
 	// If the next token is on the next line just move to it
 	if (token_next_.line_no > token_current_.line_no)
 	{
-		token_current_ = token_next_;
-		readNext();
+		shiftNext();
 		return;
 	}
 
@@ -663,6 +695,10 @@ void Tokenizer::reset()
 // -----------------------------------------------------------------------------
 unsigned Tokenizer::checkCommentBegin()
 {
+	// Quick check for a character that can't begin any comment
+	if (!(char_classes_[static_cast<uint8_t>(data_[state_.position])] & CharClass::CommentBegin))
+		return 0;
+
 	// C-Style comment (/*)
 	if (comment_types_ & CStyle && state_.position + 1 < state_.size && data_[state_.position] == '/'
 		&& data_[state_.position + 1] == '*')
@@ -777,6 +813,12 @@ void Tokenizer::tokenizeToken()
 		return;
 	}
 
+	// Skip to the next character that could end the token
+	while (state_.position < state_.size && !char_classes_[static_cast<uint8_t>(data_[state_.position])])
+		++state_.position;
+	if (state_.position >= state_.size)
+		return;
+
 	// Check for end of token
 	if (isWhitespace(data_[state_.position]) ||       // Whitespace
 		isSpecialCharacter(data_[state_.position]) || // Special character
@@ -820,6 +862,16 @@ void Tokenizer::tokenizeComment()
 		return;
 	}
 
+	// Skip straight to the end of the line for end of line comments (unless
+	// a decorate //$ token could still begin)
+	if (state_.comment_type != CStyle && !(decorate_ && state_.comment_type == CPPStyle))
+	{
+		auto eol = static_cast<const char*>(
+			memchr(data_.data() + state_.position, '\n', state_.size - state_.position));
+		state_.position = static_cast<unsigned>(eol ? eol - data_.data() : state_.size);
+		return;
+	}
+
 	// Check for end of C-Style multi line comment
 	if (state_.comment_type == CStyle)
 	{
@@ -879,21 +931,32 @@ bool Tokenizer::readNext(Token* target)
 	// Write to target token (if specified)
 	if (target)
 	{
-		target->text.clear();
-		for (unsigned a = state_.current_token.pos_start; a < state_.position; ++a)
+		// Copy token text (reusing the target token's buffer), only quoted
+		// strings with escaped characters need copying character by character
+		auto start = state_.current_token.pos_start;
+		auto end   = std::min<size_t>(state_.position, state_.size);
+		auto text  = data_.data() + start;
+		if (!state_.current_token.quoted_string || !memchr(text, '\\', end - start))
+			target->text.assign(text, end - start);
+		else
 		{
-			if (state_.current_token.quoted_string && data_[a] == '\\')
-				++a;
-
-			target->text += data_[a];
+			target->text.clear();
+			for (auto a = start; a < end; ++a)
+			{
+				if (data_[a] == '\\')
+					++a;
+
+				target->text += data_[a];
+			}
 		}
 
 		target->line_no       = state_.current_token.line_no;
 		target->quoted_string = state_.current_token.quoted_string;
 		target->pos_start     = state_.current_token.pos_start;
 		target->pos_end       = state_.position;
-		target->length        = target->pos_end - target->pos_start;
-		target->valid         = true;
+		target->length         = target->pos_end - target->pos_start;
+		target->valid          = true;
+		target->numeric_checks = 0;
 
 		// Convert to lowercase if configured to and it isn't a quoted string
 		if (read_lowercase_ && !target->quoted_string)
@@ -910,6 +973,24 @@ bool Tokenizer::readNext(Token* target)
 	return true;
 }
 
+// -----------------------------------------------------------------------------
+// Moves the 'next' token to the current token and reads the token after it.
+// The tokens are swapped rather than copied so their text buffers get reused
+// -----------------------------------------------------------------------------
+void Tokenizer::shiftNext()
+{
+	std::swap(token_current_, token_next_);
+	if (!readNext())
+	{
+		// At the end, 'next' is an invalid copy of the current token
+		token_next_       = token_current_;
+		token_next_.valid = false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Resets the state to the start of the current token's line
+// -----------------------------------------------------------------------------
 void Tokenizer::resetToLineStart()
 {
 	// Reset state to start of current token
@@ -931,6 +1012,29 @@ void Tokenizer::resetToLineStart()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Rebuilds the CharClass lookup table from the current special characters and
+// comment types
+// -----------------------------------------------------------------------------
+void Tokenizer::updateCharClasses()
+{
+	char_classes_.fill(0);
+
+	// Whitespace is either a newline, tab character or space
+	for (auto c : { '\n', '\r', ' ', '\t' })
+		char_classes_[static_cast<uint8_t>(c)] |= CharClass::Whitespace;
+
+	for (auto c : special_characters_)
+		char_classes_[static_cast<uint8_t>(c)] |= CharClass::Special;
+
+	if (comment_types_ & (CStyle | CPPStyle))
+		char_classes_['/'] |= CharClass::CommentBegin;
+	if (comment_types_ & (Hash | DoubleHash))
+		char_classes_['#'] |= CharClass::CommentBegin;
+	if (comment_types_ & Shell)
+		char_classes_[';'] |= CharClass::CommentBegin;
+}
+
 
 // Testing
 
@@ -949,8 +1053,9 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 	if (!args.empty())
 		num = strutil::asInt(args[0]);
 
-	bool lower = (VECTOR_EXISTS(args, "lower"));
-	bool dump  = (VECTOR_EXISTS(args, "dump"));
+	bool lower   = (VECTOR_EXISTS(args, "lower"));
+	bool dump    = (VECTOR_EXISTS(args, "dump"));
+	bool numeric = (VECTOR_EXISTS(args, "numeric")); // Also check each token is a number, like Parser does
 
 	struct TestToken
 	{
@@ -965,6 +1070,7 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 	tz.setReadLowerCase(lower);
 	long time = app::runTimer();
 	tz.openMem(entry->data(), entry->name());
+	unsigned numbers = 0;
 	for (long a = 0; a < num; a++)
 	{
 		while (!tz.atEnd())
@@ -972,6 +1078,10 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 			if (a == 0)
 				t_new.push_back({ tz.current().text, tz.current().quoted_string, tz.current().line_no });
 
+			if (numeric && !tz.current().quoted_string
+				&& (tz.current().isInteger() || tz.current().isHex() || tz.current().isFloat()))
+				++numbers;
+
 			tz.next();
 		}
 		tz.reset();
@@ -979,7 +1089,12 @@ CONSOLE_COMMAND(test_tokenizer, 0, false)
 
 	long new_time = app::runTimer() - time;
 
-	log::info("Tokenize x{} took {}ms", num, new_time);
+	log::info(
+		"Tokenize x{} took {}ms ({} tokens, {} numeric)",
+		num,
+		new_time,
+		t_new.size(),
+		numbers / std::max(num, 1));
 
 
 	// Test old tokenizer also
@@ -26,6 +26,8 @@ public:
 		unsigned length;
 		bool     valid;
 
+		mutable uint8_t numeric_checks = 0; // Cached isInteger/isHex/isFloat results
+
 		explicit operator string() const { return text; }
 		explicit operator const string() const { return text; }
 		explicit operator const char*() const { return text.c_str(); }
@@ -81,11 +83,8 @@ public:
 	const Token&  peek() const;
 
 	// Modifiers
-	void setCommentTypes(int types) { comment_types_ = types; }
-	void setSpecialCharacters(string_view characters)
-	{
-		special_characters_.assign(characters.data(), characters.data() + characters.size());
-	}
+	void setCommentTypes(int types);
+	void setSpecialCharacters(string_view characters);
 	void setSource(const wxString& source) { source_ = source; }
 	void setReadLowerCase(bool lower) { read_lowercase_ = lower; }
 	void enableDecorate(bool enable) { decorate_ = enable; }
@@ -137,7 +136,8 @@ public:
 	bool openMem(const MemChunk& mc, string_view source);
 
 	// General
-	bool isSpecialCharacter(char p) const { return VECTOR_EXISTS(special_characters_, p); }
+	bool isSpecialCharacter(char p) const { return char_classes_[static_cast<uint8_t>(p)] & CharClass::Special; }
+	bool isWhitespace(char p) const { return char_classes_[static_cast<uint8_t>(p)] & CharClass::Whitespace; }
 	bool atEnd() const { return !token_next_.valid; }
 	void reset();
 
@@ -207,14 +207,23 @@ private:
 	Token         token_next_    = {};
 	TokenizeState state_         = {};
 
+	// Character classes (bit flags) for char_classes_
+	enum CharClass : uint8_t
+	{
+		Whitespace   = 1,
+		Special      = 2,
+		CommentBegin = 4, // First character of an enabled comment type
+	};
+
 	// Configuration
-	int          comment_types_;          // Types of comments to skip
-	vector<char> special_characters_;     // These will always be read as separate tokens
-	string       source_;                 // What file/entry/chunk is being tokenized
-	bool         decorate_       = false; // Special handling for //$ comments
-	bool         read_lowercase_ = false; // If true, tokens will all be read in lowercase
-										  // (except for quoted strings, obviously)
-	bool debug_ = false;                  // Log each token read
+	int                      comment_types_;          // Types of comments to skip
+	string                   special_characters_;     // These will always be read as separate tokens
+	std::array<uint8_t, 256> char_classes_;           // CharClass flags for each character
+	string                   source_;                 // What file/entry/chunk is being tokenized
+	bool                     decorate_       = false; // Special handling for //$ comments
+	bool                     read_lowercase_ = false; // If true, tokens will all be read in lowercase
+													  // (except for quoted strings, obviously)
+	bool debug_ = false;                              // Log each token read
 
 	// Static
 	static Token invalid_token_;
@@ -227,6 +236,8 @@ private:
 	void     tokenizeWhitespace();
 	bool     readNext(Token* target);
 	bool     readNext() { return readNext(&token_next_); }
+	void     shiftNext();
 	void     resetToLineStart();
+	void     updateCharClasses();
 };
 } // namespace slade